@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef IOTHUB_CLIENT_CONNECTION_GOVERNOR_H
+#define IOTHUB_CLIENT_CONNECTION_GOVERNOR_H
+
+#include <stddef.h>
+#include "umock_c/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Process-wide token bucket that paces connection attempts across every client and transport.
+// It is created by IoTHub_Init and is disabled (every attempt allowed) until a rate is set.
+MOCKABLE_FUNCTION(, int, connection_governor_init);
+MOCKABLE_FUNCTION(, void, connection_governor_deinit);
+MOCKABLE_FUNCTION(, int, connection_governor_set_rate, size_t, connections_per_second, size_t, burst_size);
+
+// Returns 0 if a connection attempt may start now, non-zero if the caller should try again later.
+MOCKABLE_FUNCTION(, int, connection_governor_acquire);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTHUB_CLIENT_CONNECTION_GOVERNOR_H
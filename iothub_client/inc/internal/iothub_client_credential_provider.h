@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef IOTHUB_CLIENT_CREDENTIAL_PROVIDER_H
+#define IOTHUB_CLIENT_CREDENTIAL_PROVIDER_H
+
+#include <stddef.h>
+#include "umock_c/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum CREDENTIAL_TOKEN_STATE_TAG
+{
+    CREDENTIAL_TOKEN_STATE_NONE,
+    CREDENTIAL_TOKEN_STATE_PENDING,
+    CREDENTIAL_TOKEN_STATE_READY,
+    CREDENTIAL_TOKEN_STATE_FAILED
+} CREDENTIAL_TOKEN_STATE;
+
+// Signs a sas token for scope and key_name that expires at expiry_time (seconds since epoch).
+// The returned string is owned by the caller; NULL indicates failure. The callback may block.
+typedef char*(*CREDENTIAL_SIGN_CALLBACK)(void* context, const char* scope, const char* key_name, size_t expiry_time);
+
+struct CREDENTIAL_PROVIDER_INSTANCE_TAG;
+typedef struct CREDENTIAL_PROVIDER_INSTANCE_TAG* CREDENTIAL_PROVIDER_HANDLE;
+
+// Every provider of the process is served by one worker thread and one HSM lock. The worker is
+// created by credential_provider_init, which IoTHub_Init calls; credential_provider_create fails
+// until it has been called.
+MOCKABLE_FUNCTION(, int, credential_provider_init);
+MOCKABLE_FUNCTION(, void, credential_provider_deinit);
+
+MOCKABLE_FUNCTION(, CREDENTIAL_PROVIDER_HANDLE, credential_provider_create, CREDENTIAL_SIGN_CALLBACK, sign_callback, void*, sign_context);
+MOCKABLE_FUNCTION(, void, credential_provider_destroy, CREDENTIAL_PROVIDER_HANDLE, provider_handle);
+// expiry_time is the expiry to sign with; when an identical request already signed the token, it is
+// returned instead and expiry_time is set to the expiry of that token
+MOCKABLE_FUNCTION(, char*, credential_provider_sign, CREDENTIAL_PROVIDER_HANDLE, provider_handle, const char*, scope, const char*, key_name, size_t*, expiry_time);
+MOCKABLE_FUNCTION(, int, credential_provider_request, CREDENTIAL_PROVIDER_HANDLE, provider_handle, const char*, scope, const char*, key_name, size_t, expiry_time);
+MOCKABLE_FUNCTION(, CREDENTIAL_TOKEN_STATE, credential_provider_take, CREDENTIAL_PROVIDER_HANDLE, provider_handle, const char*, scope, const char*, key_name, char**, sas_token, size_t*, expiry_time);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTHUB_CLIENT_CREDENTIAL_PROVIDER_H
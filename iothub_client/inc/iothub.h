@@ -4,6 +4,7 @@
 #ifndef IOTHUB_H
 #define IOTHUB_H
 
+#include <stddef.h>
 #include "umock_c/umock_c_prod.h"
 
 #ifdef __cplusplus
@@ -24,6 +25,22 @@ extern "C"
     */
     MOCKABLE_FUNCTION(, void, IoTHub_Deinit);
 
+    /**
+    * @brief    IoTHub_SetConnectionRateLimit Limits how fast the clients in this process may open connections.
+    *
+    * @param    connections_per_second  Sustained number of connection attempts allowed per second, shared by all
+    *                                   clients and transports in the process. Zero (the default) removes the limit.
+    * @param    burst_size              Number of connection attempts allowed back-to-back before the sustained
+    *                                   rate applies. Must be at least 1 if @p connections_per_second is not zero.
+    *
+    * @remarks  Meant for gateways and other processes hosting many devices, so that reconnecting all of them after
+    *           an outage spreads the TLS handshakes over time. Attempts held back by the limit are retried by the
+    *           transport on a later DoWork. Must be called after IoTHub_Init.
+    *
+    * @return   int zero upon success, any other value upon failure.
+    */
+    MOCKABLE_FUNCTION(, int, IoTHub_SetConnectionRateLimit, size_t, connections_per_second, size_t, burst_size);
+
 #ifdef __cplusplus
 }
 #endif
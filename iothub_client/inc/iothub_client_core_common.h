@@ -45,7 +45,8 @@ extern "C"
     IOTHUB_CLIENT_RETRY_LINEAR_BACKOFF,      \
     IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF,                 \
     IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER,                 \
-    IOTHUB_CLIENT_RETRY_RANDOM
+    IOTHUB_CLIENT_RETRY_RANDOM,                 \
+    IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER
 
     /** @brief Enumeration passed in by the IoT Hub when the event confirmation
     *           callback is invoked to indicate status of the event processing in
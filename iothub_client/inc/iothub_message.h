@@ -204,6 +204,64 @@ MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_RESULT, IoTHubMessage_SetProperty, IOTHUB_MES
 */
 MOCKABLE_FUNCTION(, const char*, IoTHubMessage_GetProperty, IOTHUB_MESSAGE_HANDLE, iotHubMessageHandle, const char*, key);
 
+/**
+* @brief   Sets several properties on a Iothub Message, as @c IoTHubMessage_SetProperty would for each key and value.
+*
+* @param   iotHubMessageHandle Handle to the message.
+*
+* @param   keys Array of @p count names of the properties to set.
+*
+* @param   values Array of @p count values of the properties to set, in the same order as @p keys.
+*
+* @param   count Number of properties to set.
+*
+* @return  An @c IOTHUB_MESSAGE_RESULT value. If a property cannot be set, the properties set before it are kept.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_RESULT, IoTHubMessage_SetProperties, IOTHUB_MESSAGE_HANDLE, iotHubMessageHandle, const char* const*, keys, const char* const*, values, size_t, count);
+
+/**
+* @brief   Gets several IotHub Message's properties items without allocating memory.
+*
+* @param   iotHubMessageHandle Handle to the message.
+*
+* @param   keys Array of @p count names of the properties to retrieve.
+*
+* @param   values Array of @p count entries that receive the value of each property, or NULL if it does not exist.
+*          The values are owned by the message.
+*
+* @param   count Number of properties to retrieve.
+*
+* @return  An @c IOTHUB_MESSAGE_RESULT value.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_RESULT, IoTHubMessage_GetProperties, IOTHUB_MESSAGE_HANDLE, iotHubMessageHandle, const char* const*, keys, const char**, values, size_t, count);
+
+/**
+* @brief   Gets the number of application properties of a Iothub Message, to walk them with @c IoTHubMessage_GetPropertyAt.
+*          Unlike @c IoTHubMessage_Properties, this does not create a properties map.
+*
+* @param   iotHubMessageHandle Handle to the message.
+*
+* @param   count Receives the number of application properties.
+*
+* @return  An @c IOTHUB_MESSAGE_RESULT value.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_RESULT, IoTHubMessage_GetPropertyCount, IOTHUB_MESSAGE_HANDLE, iotHubMessageHandle, size_t*, count);
+
+/**
+* @brief   Gets the application property at a position of a Iothub Message without allocating memory.
+*
+* @param   iotHubMessageHandle Handle to the message.
+*
+* @param   index Position of the property, lower than the count returned by @c IoTHubMessage_GetPropertyCount.
+*
+* @param   key Receives the name of the property. It is owned by the message.
+*
+* @param   value Receives the value of the property. It is owned by the message.
+*
+* @return  An @c IOTHUB_MESSAGE_RESULT value.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_RESULT, IoTHubMessage_GetPropertyAt, IOTHUB_MESSAGE_HANDLE, iotHubMessageHandle, size_t, index, const char**, key, const char**, value);
+
 /**
 * @brief   Gets the MessageId from the IOTHUB_MESSAGE_HANDLE.
 *
@@ -6,6 +6,8 @@
 #include "azure_c_shared_utility/platform.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_macro_utils/macro_utils.h"
+#include "internal/iothub_client_connection_governor.h"
+#include "internal/iothub_client_credential_provider.h"
 #include "iothub.h"
 
 int IoTHub_Init(void)
@@ -16,6 +18,20 @@ int IoTHub_Init(void)
         LogError("Platform initialization failed");
         result = MU_FAILURE;
     }
+    else if (connection_governor_init() != 0)
+    {
+        LogError("Connection governor initialization failed");
+        platform_deinit();
+        result = MU_FAILURE;
+    }
+    // Created up front so that clients signing with an HSM can then be created from any thread
+    else if (credential_provider_init() != 0)
+    {
+        LogError("Credential provider initialization failed");
+        connection_governor_deinit();
+        platform_deinit();
+        result = MU_FAILURE;
+    }
     else
     {
         result = 0;
@@ -25,5 +41,22 @@ int IoTHub_Init(void)
 
 void IoTHub_Deinit(void)
 {
+    credential_provider_deinit();
+    connection_governor_deinit();
     platform_deinit();
 }
+
+int IoTHub_SetConnectionRateLimit(size_t connections_per_second, size_t burst_size)
+{
+    int result;
+    if (connection_governor_set_rate(connections_per_second, burst_size) != 0)
+    {
+        LogError("Failed setting the connection rate limit");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
@@ -11,9 +11,14 @@
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/sastoken.h"
 #include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/azure_base64.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/urlencode.h"
+#include "azure_c_shared_utility/sha.h"
 
 #ifdef USE_PROV_MODULE
 #include "azure_prov_client/internal/iothub_auth_client.h"
+#include "internal/iothub_client_credential_provider.h"
 #endif
 
 #include "internal/iothub_client_authorization.h"
@@ -21,6 +26,27 @@
 #define DEFAULT_SAS_TOKEN_EXPIRY_TIME_SECS          3600
 #define INDEFINITE_TIME                             ((time_t)(-1))
 #define MIN_SAS_EXPIRY_TIME                         5  // 5 seconds
+#define HMAC_SHA256_BLOCK_SIZE                      64
+#define HMAC_INNER_PAD_BYTE                         0x36
+#define HMAC_OUTER_PAD_BYTE                         0x5c
+#define SAS_TOKEN_CACHE_SIZE                        4
+// The transports renew their credentials once 80% of the token lifetime has elapsed since they
+// obtained the token, so a cached token may only be handed out during the first 20% of its life.
+#define SAS_TOKEN_CACHE_REUSE_PERCENT               20
+// A device auth token handed out past half of the reuse window is requested again from the credential
+// provider, so its worker signs the replacement before the cached token goes stale
+#define SAS_TOKEN_CACHE_PRESIGN_PERCENT             10
+#define MAX_EXPIRY_TEXT_LENGTH                      24
+
+typedef struct SAS_TOKEN_CACHE_ENTRY_TAG
+{
+    char* scope;
+    char* key_name;
+    char* sas_token;
+    size_t create_time;
+    size_t lifetime;
+    size_t last_access_time;
+} SAS_TOKEN_CACHE_ENTRY;
 
 typedef struct IOTHUB_AUTHORIZATION_DATA_TAG
 {
@@ -32,7 +58,12 @@ typedef struct IOTHUB_AUTHORIZATION_DATA_TAG
     IOTHUB_CREDENTIAL_TYPE cred_type;
 #ifdef USE_PROV_MODULE
     IOTHUB_SECURITY_HANDLE device_auth_handle;
+    CREDENTIAL_PROVIDER_HANDLE credential_provider;
 #endif
+    bool is_key_pad_computed;
+    SHA256Context inner_key_pad;
+    SHA256Context outer_key_pad;
+    SAS_TOKEN_CACHE_ENTRY sas_token_cache[SAS_TOKEN_CACHE_SIZE];
 } IOTHUB_AUTHORIZATION_DATA;
 
 static int get_seconds_since_epoch(size_t* seconds)
@@ -52,6 +83,488 @@ static int get_seconds_since_epoch(size_t* seconds)
     return result;
 }
 
+static void size_t_to_text(size_t value, char text[MAX_EXPIRY_TEXT_LENGTH])
+{
+    char reversed[MAX_EXPIRY_TEXT_LENGTH];
+    size_t length = 0;
+    size_t index;
+
+    do
+    {
+        reversed[length++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    for (index = 0; index < length; index++)
+    {
+        text[index] = reversed[length - index - 1];
+    }
+    text[length] = '\0';
+}
+
+// Hashes the device key into the HMAC inner and outer pads once, so every subsequent
+// signature only needs to process the string to sign and the inner digest (RFC 2104).
+static int compute_key_pads(IOTHUB_AUTHORIZATION_DATA* handle)
+{
+    int result;
+    BUFFER_HANDLE decoded_key;
+
+    if ((decoded_key = Azure_Base64_Decode(handle->device_key)) == NULL)
+    {
+        LogError("Failed decoding the device key");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        uint8_t key_block[HMAC_SHA256_BLOCK_SIZE];
+        uint8_t pad[HMAC_SHA256_BLOCK_SIZE];
+        const unsigned char* key = BUFFER_u_char(decoded_key);
+        size_t key_length = BUFFER_length(decoded_key);
+        size_t index;
+
+        memset(key_block, 0, sizeof(key_block));
+        if (key_length > HMAC_SHA256_BLOCK_SIZE)
+        {
+            // Keys longer than the block size are replaced by their digest
+            SHA256Context key_ctx;
+            if (SHA256Reset(&key_ctx) != 0 ||
+                SHA256Input(&key_ctx, key, (unsigned int)key_length) != 0 ||
+                SHA256Result(&key_ctx, key_block) != 0)
+            {
+                LogError("Failed hashing the device key");
+                key_length = 0;
+            }
+            else
+            {
+                key_length = SHA256HashSize;
+            }
+        }
+        else
+        {
+            memcpy(key_block, key, key_length);
+        }
+
+        if (key_length == 0)
+        {
+            result = MU_FAILURE;
+        }
+        else
+        {
+            for (index = 0; index < HMAC_SHA256_BLOCK_SIZE; index++)
+            {
+                pad[index] = key_block[index] ^ HMAC_INNER_PAD_BYTE;
+            }
+
+            if (SHA256Reset(&handle->inner_key_pad) != 0 ||
+                SHA256Input(&handle->inner_key_pad, pad, HMAC_SHA256_BLOCK_SIZE) != 0)
+            {
+                LogError("Failed computing the inner key pad");
+                result = MU_FAILURE;
+            }
+            else
+            {
+                for (index = 0; index < HMAC_SHA256_BLOCK_SIZE; index++)
+                {
+                    pad[index] = key_block[index] ^ HMAC_OUTER_PAD_BYTE;
+                }
+
+                if (SHA256Reset(&handle->outer_key_pad) != 0 ||
+                    SHA256Input(&handle->outer_key_pad, pad, HMAC_SHA256_BLOCK_SIZE) != 0)
+                {
+                    LogError("Failed computing the outer key pad");
+                    result = MU_FAILURE;
+                }
+                else
+                {
+                    handle->is_key_pad_computed = true;
+                    result = 0;
+                }
+            }
+            memset(pad, 0, sizeof(pad));
+        }
+        memset(key_block, 0, sizeof(key_block));
+        BUFFER_delete(decoded_key);
+    }
+    return result;
+}
+
+static char* create_sas_token_from_key(IOTHUB_AUTHORIZATION_DATA* handle, const char* scope, const char* key_name, size_t expiry_time)
+{
+    char* result;
+    char expiry_text[MAX_EXPIRY_TEXT_LENGTH];
+    uint8_t inner_digest[SHA256HashSize];
+    uint8_t signature[SHA256HashSize];
+    SHA256Context hash_ctx;
+
+    size_t_to_text(expiry_time, expiry_text);
+
+    if (!handle->is_key_pad_computed && compute_key_pads(handle) != 0)
+    {
+        LogError("Failed computing the key pads");
+        result = NULL;
+    }
+    else
+    {
+        // Resume from the precomputed pads instead of rehashing the key for every token
+        hash_ctx = handle->inner_key_pad;
+        if (SHA256Input(&hash_ctx, (const uint8_t*)scope, (unsigned int)strlen(scope)) != 0 ||
+            SHA256Input(&hash_ctx, (const uint8_t*)"\n", 1) != 0 ||
+            SHA256Input(&hash_ctx, (const uint8_t*)expiry_text, (unsigned int)strlen(expiry_text)) != 0 ||
+            SHA256Result(&hash_ctx, inner_digest) != 0)
+        {
+            LogError("Failed computing the inner digest");
+            result = NULL;
+        }
+        else
+        {
+            hash_ctx = handle->outer_key_pad;
+            if (SHA256Input(&hash_ctx, inner_digest, SHA256HashSize) != 0 ||
+                SHA256Result(&hash_ctx, signature) != 0)
+            {
+                LogError("Failed computing the signature");
+                result = NULL;
+            }
+            else
+            {
+                STRING_HANDLE encoded_signature;
+                STRING_HANDLE url_encoded_signature;
+                STRING_HANDLE sas_token;
+
+                if ((encoded_signature = Azure_Base64_Encode_Bytes(signature, SHA256HashSize)) == NULL)
+                {
+                    LogError("Failed encoding the signature");
+                    result = NULL;
+                }
+                else
+                {
+                    if ((url_encoded_signature = URL_Encode(encoded_signature)) == NULL)
+                    {
+                        LogError("Failed url encoding the signature");
+                        result = NULL;
+                    }
+                    else
+                    {
+                        if ((sas_token = STRING_construct_sprintf("SharedAccessSignature sr=%s&sig=%s&se=%s%s%s", scope, STRING_c_str(url_encoded_signature), expiry_text,
+                            key_name == NULL ? "" : "&skn=", key_name == NULL ? "" : key_name)) == NULL)
+                        {
+                            LogError("Failed constructing the sas token");
+                            result = NULL;
+                        }
+                        else
+                        {
+                            if (mallocAndStrcpy_s(&result, STRING_c_str(sas_token)) != 0)
+                            {
+                                LogError("Failed copying the sas token");
+                                result = NULL;
+                            }
+                            STRING_delete(sas_token);
+                        }
+                        STRING_delete(url_encoded_signature);
+                    }
+                    STRING_delete(encoded_signature);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+#ifdef USE_PROV_MODULE
+static char* sign_with_device_auth(void* context, const char* scope, const char* key_name, size_t expiry_time)
+{
+    char* result;
+    IOTHUB_AUTHORIZATION_DATA* handle = (IOTHUB_AUTHORIZATION_DATA*)context;
+    DEVICE_AUTH_CREDENTIAL_INFO dev_auth_cred;
+    CREDENTIAL_RESULT* cred_result;
+
+    memset(&dev_auth_cred, 0, sizeof(DEVICE_AUTH_CREDENTIAL_INFO));
+    dev_auth_cred.sas_info.expiry_seconds = expiry_time;
+    dev_auth_cred.sas_info.token_scope = scope;
+    dev_auth_cred.sas_info.key_name = key_name;
+    dev_auth_cred.dev_auth_type = AUTH_TYPE_SAS;
+
+    if ((cred_result = iothub_device_auth_generate_credentials(handle->device_auth_handle, &dev_auth_cred)) == NULL)
+    {
+        LogError("failure getting credentials from device auth module");
+        result = NULL;
+    }
+    else
+    {
+        if (mallocAndStrcpy_s(&result, cred_result->auth_cred_result.sas_result.sas_token) != 0)
+        {
+            LogError("failure allocating Sas Token");
+            result = NULL;
+        }
+        free(cred_result);
+    }
+    return result;
+}
+#endif
+
+// The credential provider can hand out a token an identical pre-sign request already signed, so
+// expiry_time is updated to the expiry of the token actually returned
+static char* create_sas_token(IOTHUB_AUTHORIZATION_DATA* handle, const char* scope, const char* key_name, size_t* expiry_time)
+{
+    char* result;
+    if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH)
+    {
+#ifdef USE_PROV_MODULE
+        /* Codes_SRS_IoTHub_Authorization_07_029: [ IoTHubClient_Auth_Get_SasToken shall sign device auth tokens through the credential provider, which serializes access to the HSM. ] */
+        result = credential_provider_sign(handle->credential_provider, scope, key_name, expiry_time);
+#else
+        (void)scope;
+        (void)key_name;
+        (void)expiry_time;
+        LogError("Failed HSM module is not supported");
+        result = NULL;
+#endif
+    }
+    else
+    {
+        /* Codes_SRS_IoTHub_Authorization_07_011: [ IoTHubClient_Auth_Get_SasToken shall sign the sas token with the key pads computed from the device key. ] */
+        result = create_sas_token_from_key(handle, scope, key_name, *expiry_time);
+    }
+    return result;
+}
+
+static size_t get_sas_token_create_time(IOTHUB_AUTHORIZATION_DATA* handle, size_t expiry_time)
+{
+    return (expiry_time > handle->token_expiry_time_sec) ? expiry_time - handle->token_expiry_time_sec : 0;
+}
+
+static void clear_sas_token_cache_entry(SAS_TOKEN_CACHE_ENTRY* entry)
+{
+    if (entry->sas_token != NULL)
+    {
+        free(entry->scope);
+        free(entry->key_name);
+        free(entry->sas_token);
+        memset(entry, 0, sizeof(SAS_TOKEN_CACHE_ENTRY));
+    }
+}
+
+static void clear_sas_token_cache(IOTHUB_AUTHORIZATION_DATA* handle)
+{
+    size_t index;
+    for (index = 0; index < SAS_TOKEN_CACHE_SIZE; index++)
+    {
+        clear_sas_token_cache_entry(&handle->sas_token_cache[index]);
+    }
+}
+
+static bool is_within_lifetime_percent(size_t create_time, size_t lifetime, size_t current_time, size_t percent)
+{
+    // A clock that jumped backwards invalidates the token as well
+    return (current_time >= create_time &&
+        (current_time - create_time) * 100 < lifetime * percent);
+}
+
+static bool is_sas_token_cache_entry_reusable(const SAS_TOKEN_CACHE_ENTRY* entry, size_t current_time)
+{
+    return (entry->sas_token != NULL &&
+        is_within_lifetime_percent(entry->create_time, entry->lifetime, current_time, SAS_TOKEN_CACHE_REUSE_PERCENT));
+}
+
+static SAS_TOKEN_CACHE_ENTRY* find_sas_token_cache_entry(IOTHUB_AUTHORIZATION_DATA* handle, const char* scope, const char* key_name)
+{
+    SAS_TOKEN_CACHE_ENTRY* result = NULL;
+    size_t index;
+    for (index = 0; index < SAS_TOKEN_CACHE_SIZE; index++)
+    {
+        SAS_TOKEN_CACHE_ENTRY* entry = &handle->sas_token_cache[index];
+        if (entry->sas_token != NULL &&
+            strcmp(entry->scope, scope) == 0 &&
+            ((entry->key_name == NULL && key_name == NULL) || (entry->key_name != NULL && key_name != NULL && strcmp(entry->key_name, key_name) == 0)))
+        {
+            result = entry;
+            break;
+        }
+    }
+    return result;
+}
+
+static SAS_TOKEN_CACHE_ENTRY* get_free_sas_token_cache_entry(IOTHUB_AUTHORIZATION_DATA* handle)
+{
+    SAS_TOKEN_CACHE_ENTRY* result = &handle->sas_token_cache[0];
+    size_t index;
+    for (index = 0; index < SAS_TOKEN_CACHE_SIZE; index++)
+    {
+        SAS_TOKEN_CACHE_ENTRY* entry = &handle->sas_token_cache[index];
+        if (entry->sas_token == NULL)
+        {
+            result = entry;
+            break;
+        }
+        else if (entry->last_access_time < result->last_access_time)
+        {
+            result = entry;
+        }
+    }
+    // Evict the least recently used token when every slot is taken
+    clear_sas_token_cache_entry(result);
+    return result;
+}
+
+static int store_sas_token_cache_entry(IOTHUB_AUTHORIZATION_DATA* handle, const char* scope, const char* key_name, char* sas_token, size_t create_time, size_t current_time)
+{
+    int result;
+    SAS_TOKEN_CACHE_ENTRY* entry = get_free_sas_token_cache_entry(handle);
+
+    if (mallocAndStrcpy_s(&entry->scope, scope) != 0)
+    {
+        LogError("Failed caching the token scope");
+        entry->scope = NULL;
+        result = MU_FAILURE;
+    }
+    else if (key_name != NULL && mallocAndStrcpy_s(&entry->key_name, key_name) != 0)
+    {
+        LogError("Failed caching the token key name");
+        free(entry->scope);
+        entry->scope = NULL;
+        entry->key_name = NULL;
+        result = MU_FAILURE;
+    }
+    else
+    {
+        entry->sas_token = sas_token;
+        entry->create_time = create_time;
+        entry->lifetime = handle->token_expiry_time_sec;
+        entry->last_access_time = current_time;
+        result = 0;
+    }
+    return result;
+}
+
+#ifdef USE_PROV_MODULE
+static char* take_presigned_sas_token(IOTHUB_AUTHORIZATION_DATA* handle, const char* scope, const char* key_name, size_t current_time, size_t* create_time)
+{
+    char* result = NULL;
+    char* sas_token;
+    size_t expiry_time;
+
+    if (credential_provider_take(handle->credential_provider, scope, key_name, &sas_token, &expiry_time) == CREDENTIAL_TOKEN_STATE_READY)
+    {
+        size_t token_create_time = get_sas_token_create_time(handle, expiry_time);
+        if (is_within_lifetime_percent(token_create_time, handle->token_expiry_time_sec, current_time, SAS_TOKEN_CACHE_REUSE_PERCENT))
+        {
+            *create_time = token_create_time;
+            result = sas_token;
+        }
+        else
+        {
+            free(sas_token);
+        }
+    }
+    return result;
+}
+#endif
+
+static char* sign_sas_token(IOTHUB_AUTHORIZATION_DATA* handle, const char* scope, const char* key_name, size_t current_time, size_t* create_time)
+{
+    size_t expiry_time = current_time + handle->token_expiry_time_sec;
+    char* result = create_sas_token(handle, scope, key_name, &expiry_time);
+
+    if (result != NULL &&
+        !is_within_lifetime_percent(get_sas_token_create_time(handle, expiry_time), handle->token_expiry_time_sec, current_time, SAS_TOKEN_CACHE_REUSE_PERCENT))
+    {
+        // Joined a pre-sign request that waited too long for the HSM, that token is signed afresh
+        free(result);
+        expiry_time = current_time + handle->token_expiry_time_sec;
+        result = create_sas_token(handle, scope, key_name, &expiry_time);
+    }
+
+    if (result != NULL)
+    {
+        *create_time = get_sas_token_create_time(handle, expiry_time);
+    }
+    return result;
+}
+
+static char* get_cached_sas_token(IOTHUB_AUTHORIZATION_DATA* handle, const char* scope, const char* key_name)
+{
+    char* result;
+    size_t sec_since_epoch;
+
+    /* Codes_SRS_IoTHub_Authorization_07_010: [ IoTHubClient_Auth_Get_SasToken` shall construct the expiration time using the handle->token_expiry_time_sec added to epoch time. ] */
+    if (get_seconds_since_epoch(&sec_since_epoch) != 0)
+    {
+        /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
+        LogError("failure getting seconds from epoch");
+        result = NULL;
+    }
+    else
+    {
+        SAS_TOKEN_CACHE_ENTRY* entry;
+
+        if (key_name != NULL && *key_name == '\0')
+        {
+            key_name = NULL;
+        }
+
+        entry = find_sas_token_cache_entry(handle, scope, key_name);
+        if (entry != NULL && is_sas_token_cache_entry_reusable(entry, sec_since_epoch))
+        {
+            /* Codes_SRS_IoTHub_Authorization_07_025: [ If a token for the same scope and key name was created within the reuse window, IoTHubClient_Auth_Get_SasToken shall return a copy of the cached token. ] */
+            entry->last_access_time = sec_since_epoch;
+            if (mallocAndStrcpy_s(&result, entry->sas_token) != 0)
+            {
+                LogError("Failed copying the cached sas token");
+                result = NULL;
+            }
+#ifdef USE_PROV_MODULE
+            else if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH &&
+                !is_within_lifetime_percent(entry->create_time, entry->lifetime, sec_since_epoch, SAS_TOKEN_CACHE_PRESIGN_PERCENT))
+            {
+                /* Codes_SRS_IoTHub_Authorization_07_031: [ If the cached device auth token is past half of the reuse window, IoTHubClient_Auth_Get_SasToken shall request a replacement from the credential provider without waiting for it. ] */
+                if (credential_provider_request(handle->credential_provider, scope, key_name, sec_since_epoch + handle->token_expiry_time_sec) != 0)
+                {
+                    // Not fatal, the replacement is signed on demand once the cached token goes stale
+                    LogError("Failed requesting a pre-signed sas token");
+                }
+            }
+#endif
+        }
+        else
+        {
+            char* sas_token = NULL;
+            size_t create_time = sec_since_epoch;
+
+            if (entry != NULL)
+            {
+                clear_sas_token_cache_entry(entry);
+            }
+
+#ifdef USE_PROV_MODULE
+            if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH)
+            {
+                /* Codes_SRS_IoTHub_Authorization_07_030: [ If the credential provider holds a pre-signed device auth token that is within the reuse window, IoTHubClient_Auth_Get_SasToken shall use it instead of signing. ] */
+                sas_token = take_presigned_sas_token(handle, scope, key_name, sec_since_epoch, &create_time);
+            }
+#endif
+
+            if (sas_token == NULL && (sas_token = sign_sas_token(handle, scope, key_name, sec_since_epoch, &create_time)) == NULL)
+            {
+                /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
+                LogError("Failed creating sas_token");
+                result = NULL;
+            }
+            else if (store_sas_token_cache_entry(handle, scope, key_name, sas_token, create_time, sec_since_epoch) != 0)
+            {
+                // Not being able to cache the token is not fatal, the caller takes ownership of it instead
+                LogError("Failed caching sas token");
+                result = sas_token;
+            }
+            /* Codes_SRS_IoTHub_Authorization_07_012: [ On success IoTHubClient_Auth_Get_ConnString shall allocate and return the sas token in a char*. ] */
+            else if (mallocAndStrcpy_s(&result, sas_token) != 0)
+            {
+                LogError("Failed copying result");
+                result = NULL;
+            }
+        }
+    }
+    return result;
+}
+
 static IOTHUB_AUTHORIZATION_DATA* initialize_auth_client(const char* device_id, const char* module_id)
 {
     IOTHUB_AUTHORIZATION_DATA* result;
@@ -181,6 +694,15 @@ IOTHUB_AUTHORIZATION_HANDLE IoTHubClient_Auth_CreateFromDeviceAuth(const char* d
                 if (auth_type == AUTH_TYPE_SAS || auth_type == AUTH_TYPE_SYMM_KEY)
                 {
                     result->cred_type = IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH;
+                    if ((result->credential_provider = credential_provider_create(sign_with_device_auth, result)) == NULL)
+                    {
+                        LogError("Failed creating the credential provider");
+                        iothub_device_auth_destroy(result->device_auth_handle);
+                        free(result->device_id);
+                        free(result->module_id);
+                        free(result);
+                        result = NULL;
+                    }
                 }
                 else
                 {
@@ -204,8 +726,14 @@ void IoTHubClient_Auth_Destroy(IOTHUB_AUTHORIZATION_HANDLE handle)
     {
         /* Codes_SRS_IoTHub_Authorization_07_006: [ IoTHubClient_Auth_Destroy shall free all resources associated with the IOTHUB_AUTHORIZATION_HANDLE handle. ] */
 #ifdef USE_PROV_MODULE
+        // The provider worker signs with the device auth handle, stop it first
+        if (handle->credential_provider != NULL)
+        {
+            credential_provider_destroy(handle->credential_provider);
+        }
         iothub_device_auth_destroy(handle->device_auth_handle);
 #endif
+        clear_sas_token_cache(handle);
         free(handle->device_key);
         free(handle->device_id);
         free(handle->module_id);
@@ -375,38 +903,14 @@ char* IoTHubClient_Auth_Get_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const c
         if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH)
         {
 #ifdef USE_PROV_MODULE
-            DEVICE_AUTH_CREDENTIAL_INFO dev_auth_cred;
-            size_t sec_since_epoch;
-
-            if (get_seconds_since_epoch(&sec_since_epoch) != 0)
+            if (scope == NULL)
             {
-                LogError("failure getting seconds from epoch");
+                LogError("Invalid Parameter scope: %p", scope);
                 result = NULL;
             }
             else
             {
-                memset(&dev_auth_cred, 0, sizeof(DEVICE_AUTH_CREDENTIAL_INFO));
-                size_t expiry_time = sec_since_epoch + handle->token_expiry_time_sec;
-                dev_auth_cred.sas_info.expiry_seconds = expiry_time;
-                dev_auth_cred.sas_info.token_scope = scope;
-                dev_auth_cred.sas_info.key_name = key_name;
-                dev_auth_cred.dev_auth_type = AUTH_TYPE_SAS;
-
-                CREDENTIAL_RESULT* cred_result = iothub_device_auth_generate_credentials(handle->device_auth_handle, &dev_auth_cred);
-                if (cred_result == NULL)
-                {
-                    LogError("failure getting credentials from device auth module");
-                    result = NULL;
-                }
-                else
-                {
-                    if (mallocAndStrcpy_s(&result, cred_result->auth_cred_result.sas_result.sas_token) != 0)
-                    {
-                        LogError("failure allocating Sas Token");
-                        result = NULL;
-                    }
-                    free(cred_result);
-                }
+                result = get_cached_sas_token(handle, scope, key_name);
             }
 #else
             LogError("Failed HSM module is not supported");
@@ -440,38 +944,7 @@ char* IoTHubClient_Auth_Get_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const c
             }
             else
             {
-                STRING_HANDLE sas_token;
-                size_t sec_since_epoch;
-
-                /* Codes_SRS_IoTHub_Authorization_07_010: [ IoTHubClient_Auth_Get_SasToken` shall construct the expiration time using the handle->token_expiry_time_sec added to epoch time. ] */
-                if (get_seconds_since_epoch(&sec_since_epoch) != 0)
-                {
-                    /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
-                    LogError("failure getting seconds from epoch");
-                    result = NULL;
-                }
-                else
-                {
-                    /* Codes_SRS_IoTHub_Authorization_07_011: [ IoTHubClient_Auth_Get_ConnString shall call SASToken_CreateString to construct the sas token. ] */
-                    size_t expiry_time = sec_since_epoch + handle->token_expiry_time_sec;
-                    if ( (sas_token = SASToken_CreateString(handle->device_key, scope, key_name, expiry_time)) == NULL)
-                    {
-                        /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
-                        LogError("Failed creating sas_token");
-                        result = NULL;
-                    }
-                    else
-                    {
-                        /* Codes_SRS_IoTHub_Authorization_07_012: [ On success IoTHubClient_Auth_Get_ConnString shall allocate and return the sas token in a char*. ] */
-                        if (mallocAndStrcpy_s(&result, STRING_c_str(sas_token) ) != 0)
-                        {
-                            /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
-                            LogError("Failed copying result");
-                            result = NULL;
-                        }
-                        STRING_delete(sas_token);
-                    }
-                }
+                result = get_cached_sas_token(handle, scope, key_name);
             }
         }
         else
@@ -684,11 +1157,84 @@ int IoTHubClient_Auth_Set_SasToken_Expiry(IOTHUB_AUTHORIZATION_HANDLE handle, si
     else
     {
         handle->token_expiry_time_sec = expiry_time_seconds;
+        // Cached tokens were issued for the previous lifetime
+        clear_sas_token_cache(handle);
         result = 0;
     }
     return result;
 }
 
+static void refresh_sas_token_cache_entry(IOTHUB_AUTHORIZATION_DATA* handle, SAS_TOKEN_CACHE_ENTRY* entry, size_t current_time)
+{
+#ifdef USE_PROV_MODULE
+    if (handle->cred_type == IOTHUB_CREDENTIAL_TYPE_DEVICE_AUTH)
+    {
+        char* sas_token;
+        size_t expiry_time;
+        CREDENTIAL_TOKEN_STATE token_state = credential_provider_take(handle->credential_provider, entry->scope, entry->key_name, &sas_token, &expiry_time);
+
+        if (token_state == CREDENTIAL_TOKEN_STATE_READY)
+        {
+            /* Codes_SRS_IoTHub_Authorization_07_032: [ IoTHubClient_Auth_Refresh_SasToken_Cache shall replace the cached token with the pre-signed token once the credential provider completes it. ] */
+            free(entry->sas_token);
+            entry->sas_token = sas_token;
+            entry->create_time = get_sas_token_create_time(handle, expiry_time);
+            entry->lifetime = handle->token_expiry_time_sec;
+        }
+        else if (token_state == CREDENTIAL_TOKEN_STATE_FAILED)
+        {
+            LogError("Failed pre-signing sas token");
+        }
+    }
+#else
+    (void)handle;
+#endif
+
+    if (!is_sas_token_cache_entry_reusable(entry, current_time))
+    {
+        /* Codes_SRS_IoTHub_Authorization_07_028: [ IoTHubClient_Auth_Refresh_SasToken_Cache shall never sign a token, it shall evict tokens that left the reuse window so the next IoTHubClient_Auth_Get_SasToken signs them on demand. ] */
+        clear_sas_token_cache_entry(entry);
+    }
+}
+
+void IoTHubClient_Auth_Refresh_SasToken_Cache(IOTHUB_AUTHORIZATION_HANDLE handle)
+{
+    /* Codes_SRS_IoTHub_Authorization_07_026: [ if handle is NULL, IoTHubClient_Auth_Refresh_SasToken_Cache shall do nothing. ] */
+    if (handle != NULL)
+    {
+        size_t index;
+        size_t sec_since_epoch = 0;
+        bool has_current_time = false;
+
+        for (index = 0; index < SAS_TOKEN_CACHE_SIZE; index++)
+        {
+            SAS_TOKEN_CACHE_ENTRY* entry = &handle->sas_token_cache[index];
+            if (entry->sas_token != NULL)
+            {
+                if (!has_current_time)
+                {
+                    if (get_seconds_since_epoch(&sec_since_epoch) != 0)
+                    {
+                        LogError("failure getting seconds from epoch");
+                        break;
+                    }
+                    has_current_time = true;
+                }
+
+                if (sec_since_epoch < entry->last_access_time || sec_since_epoch - entry->last_access_time >= entry->lifetime)
+                {
+                    /* Codes_SRS_IoTHub_Authorization_07_027: [ IoTHubClient_Auth_Refresh_SasToken_Cache shall evict tokens that have not been requested for a whole token lifetime. ] */
+                    clear_sas_token_cache_entry(entry);
+                }
+                else
+                {
+                    refresh_sas_token_cache_entry(handle, entry, sec_since_epoch);
+                }
+            }
+        }
+    }
+}
+
 size_t IoTHubClient_Auth_Get_SasToken_Expiry(IOTHUB_AUTHORIZATION_HANDLE handle)
 {
     size_t result;
@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_macro_utils/macro_utils.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/tickcounter.h"
+
+#include "internal/iothub_client_connection_governor.h"
+
+// Tokens are kept in thousandths so rates below one connection per millisecond refill smoothly
+#define MILLITOKENS_PER_TOKEN       1000
+
+typedef struct CONNECTION_GOVERNOR_TAG
+{
+    LOCK_HANDLE lock;
+    TICK_COUNTER_HANDLE tick_counter;
+    size_t connections_per_second;
+    size_t burst_size;
+    uint64_t available_millitokens;
+    tickcounter_ms_t last_refill_time;
+} CONNECTION_GOVERNOR;
+
+static CONNECTION_GOVERNOR g_governor;
+
+
+// ========== Helper Functions ========== //
+
+static void refill_tokens(tickcounter_ms_t current_time)
+{
+    uint64_t capacity = (uint64_t)g_governor.burst_size * MILLITOKENS_PER_TOKEN;
+
+    if (current_time > g_governor.last_refill_time)
+    {
+        // One token per second per connection is one millitoken per millisecond per connection
+        uint64_t refill = (uint64_t)(current_time - g_governor.last_refill_time) * g_governor.connections_per_second;
+
+        g_governor.available_millitokens = (refill >= capacity - g_governor.available_millitokens) ? capacity : g_governor.available_millitokens + refill;
+    }
+
+    g_governor.last_refill_time = current_time;
+}
+
+
+// ========== Public API ========== //
+
+int connection_governor_init(void)
+{
+    int result;
+
+    // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_001: [If the governor is already initialized, `connection_governor_init` shall return 0]
+    if (g_governor.lock != NULL)
+    {
+        result = 0;
+    }
+    // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_002: [`connection_governor_init` shall create the governor lock and tick counter]
+    else if ((g_governor.lock = Lock_Init()) == NULL)
+    {
+        // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_003: [If any of them fails to be created, `connection_governor_init` shall release what it created and return non-zero]
+        LogError("Failed initializing the connection governor (Lock_Init failed)");
+        result = MU_FAILURE;
+    }
+    else if ((g_governor.tick_counter = tickcounter_create()) == NULL)
+    {
+        LogError("Failed initializing the connection governor (tickcounter_create failed)");
+        Lock_Deinit(g_governor.lock);
+        g_governor.lock = NULL;
+        result = MU_FAILURE;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_004: [The governor shall start disabled, allowing every connection attempt]
+        g_governor.connections_per_second = 0;
+        g_governor.burst_size = 0;
+        g_governor.available_millitokens = 0;
+        g_governor.last_refill_time = 0;
+        result = 0;
+    }
+
+    return result;
+}
+
+void connection_governor_deinit(void)
+{
+    // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_005: [If the governor is not initialized, `connection_governor_deinit` shall do nothing]
+    if (g_governor.lock != NULL)
+    {
+        // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_006: [`connection_governor_deinit` shall destroy the tick counter and the lock]
+        tickcounter_destroy(g_governor.tick_counter);
+        Lock_Deinit(g_governor.lock);
+        memset(&g_governor, 0, sizeof(g_governor));
+    }
+}
+
+int connection_governor_set_rate(size_t connections_per_second, size_t burst_size)
+{
+    int result;
+
+    // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_007: [If the governor is not initialized, `connection_governor_set_rate` shall fail and return non-zero]
+    if (g_governor.lock == NULL)
+    {
+        LogError("Failed setting the connection rate (IoTHub_Init has not been called)");
+        result = MU_FAILURE;
+    }
+    // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_008: [If `connections_per_second` is not 0 and `burst_size` is 0, `connection_governor_set_rate` shall fail and return non-zero]
+    else if (connections_per_second != 0 && burst_size == 0)
+    {
+        LogError("Failed setting the connection rate (burst_size must be at least 1)");
+        result = MU_FAILURE;
+    }
+    else if (Lock(g_governor.lock) != LOCK_OK)
+    {
+        LogError("Failed setting the connection rate (Lock failed)");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        tickcounter_ms_t current_time;
+
+        // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_009: [`connection_governor_set_rate` shall save the rate and fill the bucket with `burst_size` tokens]
+        if (tickcounter_get_current_ms(g_governor.tick_counter, &current_time) != 0)
+        {
+            LogError("Failed setting the connection rate (tickcounter_get_current_ms failed)");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_010: [A `connections_per_second` of 0 shall disable the governor]
+            g_governor.connections_per_second = connections_per_second;
+            g_governor.burst_size = burst_size;
+            g_governor.available_millitokens = (uint64_t)burst_size * MILLITOKENS_PER_TOKEN;
+            g_governor.last_refill_time = current_time;
+            result = 0;
+        }
+
+        (void)Unlock(g_governor.lock);
+    }
+
+    return result;
+}
+
+int connection_governor_acquire(void)
+{
+    int result;
+
+    // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_011: [If the governor is not initialized or is disabled, `connection_governor_acquire` shall return 0]
+    if (g_governor.lock == NULL)
+    {
+        result = 0;
+    }
+    else if (Lock(g_governor.lock) != LOCK_OK)
+    {
+        // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_012: [If the governor cannot be evaluated, `connection_governor_acquire` shall return 0 so connections are never blocked by its own failures]
+        LogError("Failed evaluating the connection governor (Lock failed)");
+        result = 0;
+    }
+    else
+    {
+        tickcounter_ms_t current_time;
+
+        if (g_governor.connections_per_second == 0)
+        {
+            result = 0;
+        }
+        else if (tickcounter_get_current_ms(g_governor.tick_counter, &current_time) != 0)
+        {
+            LogError("Failed evaluating the connection governor (tickcounter_get_current_ms failed)");
+            result = 0;
+        }
+        else
+        {
+            // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_013: [`connection_governor_acquire` shall refill the bucket at `connections_per_second` tokens per second, up to `burst_size` tokens]
+            refill_tokens(current_time);
+
+            // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_014: [If a whole token is available, `connection_governor_acquire` shall take it and return 0]
+            if (g_governor.available_millitokens >= MILLITOKENS_PER_TOKEN)
+            {
+                g_governor.available_millitokens -= MILLITOKENS_PER_TOKEN;
+                result = 0;
+            }
+            // Codes_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_015: [Otherwise `connection_governor_acquire` shall return non-zero]
+            else
+            {
+                result = MU_FAILURE;
+            }
+        }
+
+        (void)Unlock(g_governor.lock);
+    }
+
+    return result;
+}
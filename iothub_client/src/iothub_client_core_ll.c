@@ -2081,6 +2081,9 @@ void IoTHubClientCore_LL_DoWork(IOTHUB_CLIENT_CORE_LL_HANDLE iotHubClientHandle)
 
         /*Codes_SRS_IOTHUBCLIENT_LL_02_021: [Otherwise, IoTHubClientCore_LL_DoWork shall invoke the underlaying layer's _DoWork function.]*/
         handleData->IoTHubTransport_DoWork(handleData->transportHandle);
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_07_041: [ IoTHubClientCore_LL_DoWork shall call IoTHubClient_Auth_Refresh_SasToken_Cache so stale SAS tokens are evicted and the device auth tokens signed in the background are collected. ]*/
+        IoTHubClient_Auth_Refresh_SasToken_Cache(handleData->authorization_module);
     }
 }
 
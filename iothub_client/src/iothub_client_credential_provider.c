@@ -0,0 +1,652 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_macro_utils/macro_utils.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
+#include "azure_c_shared_utility/threadapi.h"
+
+#include "internal/iothub_client_credential_provider.h"
+
+#define CREDENTIAL_PROVIDER_MAX_REQUESTS            4
+// Waiting for a token being signed also polls, so a post that woke somebody else never stalls a waiter
+#define CREDENTIAL_PROVIDER_SIGNING_WAIT_MS         100
+#define CREDENTIAL_WORKER_LOCK_RETRY_MS             10
+
+typedef enum CREDENTIAL_REQUEST_STATE_TAG
+{
+    CREDENTIAL_REQUEST_STATE_FREE,
+    CREDENTIAL_REQUEST_STATE_PENDING,
+    CREDENTIAL_REQUEST_STATE_SIGNING,
+    CREDENTIAL_REQUEST_STATE_READY,
+    CREDENTIAL_REQUEST_STATE_FAILED
+} CREDENTIAL_REQUEST_STATE;
+
+typedef struct CREDENTIAL_REQUEST_TAG
+{
+    CREDENTIAL_REQUEST_STATE state;
+    char* scope;
+    char* key_name;
+    size_t expiry_time;
+    char* sas_token;
+    struct CREDENTIAL_PROVIDER_INSTANCE_TAG* provider;
+    struct CREDENTIAL_REQUEST_TAG* next_pending;
+} CREDENTIAL_REQUEST;
+
+typedef struct CREDENTIAL_PROVIDER_INSTANCE_TAG
+{
+    CREDENTIAL_SIGN_CALLBACK sign_callback;
+    void* sign_context;
+    CREDENTIAL_REQUEST requests[CREDENTIAL_PROVIDER_MAX_REQUESTS];
+} CREDENTIAL_PROVIDER_INSTANCE;
+
+// Each started thread has its own stop flag, so a thread still winding down after the last provider
+// was destroyed never picks up the work of the one started for the next provider
+typedef struct CREDENTIAL_WORKER_THREAD_TAG
+{
+    THREAD_HANDLE thread_handle;
+    bool is_running;
+    bool stop_thread;
+} CREDENTIAL_WORKER_THREAD;
+
+// A single worker signs for every provider of the process: a gateway with thousands of device and
+// module clients runs one signing thread, and never calls into the HSM from two threads at once
+typedef struct CREDENTIAL_WORKER_TAG
+{
+    // Guards the queue, the request slots of every provider, the provider count and the thread
+    LOCK_HANDLE lock;
+    // Serializes every call into a sign callback, HSM adapters are not re-entrant
+    LOCK_HANDLE hsm_lock;
+    // Posted when a request is queued or when the thread has to stop
+    COND_HANDLE request_condition;
+    // Posted when a token is done signing
+    COND_HANDLE signed_condition;
+    size_t provider_count;
+    CREDENTIAL_WORKER_THREAD* thread;
+    CREDENTIAL_REQUEST* pending_head;
+    CREDENTIAL_REQUEST* pending_tail;
+} CREDENTIAL_WORKER;
+
+static CREDENTIAL_WORKER g_worker;
+
+
+// ========== Helper Functions ========== //
+
+static void clear_request(CREDENTIAL_REQUEST* request)
+{
+    CREDENTIAL_PROVIDER_INSTANCE* provider = request->provider;
+
+    free(request->scope);
+    free(request->key_name);
+    free(request->sas_token);
+    memset(request, 0, sizeof(CREDENTIAL_REQUEST));
+    request->provider = provider;
+}
+
+static CREDENTIAL_REQUEST* find_request(CREDENTIAL_PROVIDER_INSTANCE* provider, const char* scope, const char* key_name)
+{
+    CREDENTIAL_REQUEST* result = NULL;
+    size_t index;
+    for (index = 0; index < CREDENTIAL_PROVIDER_MAX_REQUESTS; index++)
+    {
+        CREDENTIAL_REQUEST* request = &provider->requests[index];
+        if (request->state != CREDENTIAL_REQUEST_STATE_FREE &&
+            strcmp(request->scope, scope) == 0 &&
+            ((request->key_name == NULL && key_name == NULL) || (request->key_name != NULL && key_name != NULL && strcmp(request->key_name, key_name) == 0)))
+        {
+            result = request;
+            break;
+        }
+    }
+    return result;
+}
+
+static CREDENTIAL_REQUEST* get_free_request(CREDENTIAL_PROVIDER_INSTANCE* provider)
+{
+    CREDENTIAL_REQUEST* result = NULL;
+    size_t index;
+    for (index = 0; index < CREDENTIAL_PROVIDER_MAX_REQUESTS; index++)
+    {
+        CREDENTIAL_REQUEST* request = &provider->requests[index];
+        if (request->state == CREDENTIAL_REQUEST_STATE_FREE)
+        {
+            result = request;
+            break;
+        }
+        else if (result == NULL && (request->state == CREDENTIAL_REQUEST_STATE_READY || request->state == CREDENTIAL_REQUEST_STATE_FAILED))
+        {
+            // Completed slots are reused before giving up, outstanding requests are never dropped
+            result = request;
+        }
+    }
+    return result;
+}
+
+static bool is_provider_signing(CREDENTIAL_PROVIDER_INSTANCE* provider)
+{
+    bool result = false;
+    size_t index;
+    for (index = 0; index < CREDENTIAL_PROVIDER_MAX_REQUESTS; index++)
+    {
+        if (provider->requests[index].state == CREDENTIAL_REQUEST_STATE_SIGNING)
+        {
+            result = true;
+            break;
+        }
+    }
+    return result;
+}
+
+static void enqueue_pending_request(CREDENTIAL_REQUEST* request)
+{
+    request->next_pending = NULL;
+    if (g_worker.pending_tail == NULL)
+    {
+        g_worker.pending_head = request;
+    }
+    else
+    {
+        g_worker.pending_tail->next_pending = request;
+    }
+    g_worker.pending_tail = request;
+}
+
+static CREDENTIAL_REQUEST* dequeue_pending_request(void)
+{
+    CREDENTIAL_REQUEST* result = g_worker.pending_head;
+    if (result != NULL)
+    {
+        g_worker.pending_head = result->next_pending;
+        if (g_worker.pending_head == NULL)
+        {
+            g_worker.pending_tail = NULL;
+        }
+        result->next_pending = NULL;
+    }
+    return result;
+}
+
+static void remove_pending_request(CREDENTIAL_REQUEST* request)
+{
+    CREDENTIAL_REQUEST* previous = NULL;
+    CREDENTIAL_REQUEST* current = g_worker.pending_head;
+
+    while (current != NULL && current != request)
+    {
+        previous = current;
+        current = current->next_pending;
+    }
+
+    if (current != NULL)
+    {
+        if (previous == NULL)
+        {
+            g_worker.pending_head = current->next_pending;
+        }
+        else
+        {
+            previous->next_pending = current->next_pending;
+        }
+        if (g_worker.pending_tail == current)
+        {
+            g_worker.pending_tail = previous;
+        }
+        current->next_pending = NULL;
+    }
+}
+
+static char* sign_token(CREDENTIAL_PROVIDER_INSTANCE* provider, const char* scope, const char* key_name, size_t expiry_time)
+{
+    char* result;
+    if (Lock(g_worker.hsm_lock) != LOCK_OK)
+    {
+        LogError("Failed locking the HSM");
+        result = NULL;
+    }
+    else
+    {
+        result = provider->sign_callback(provider->sign_context, scope, key_name, expiry_time);
+        (void)Unlock(g_worker.hsm_lock);
+    }
+    return result;
+}
+
+static void lock_worker(void)
+{
+    // The worker publishes every token and request state under the lock, and a request left SIGNING would block
+    // the destroy of its provider forever, so the worker waits for the lock instead of giving up on it
+    while (Lock(g_worker.lock) != LOCK_OK)
+    {
+        LogError("Failed locking the credential worker, retrying");
+        ThreadAPI_Sleep(CREDENTIAL_WORKER_LOCK_RETRY_MS);
+    }
+}
+
+static int credential_provider_worker(void* argument)
+{
+    CREDENTIAL_WORKER_THREAD* thread = (CREDENTIAL_WORKER_THREAD*)argument;
+    CREDENTIAL_REQUEST* request;
+
+    // is_running and stop_thread are only read and written under the worker lock
+    lock_worker();
+
+    while (thread->is_running && !thread->stop_thread)
+    {
+        request = dequeue_pending_request();
+        if (request == NULL)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_021: [ When nothing is pending the worker shall wait on the condition. ] */
+            COND_RESULT cond_result = Condition_Wait(g_worker.request_condition, g_worker.lock, 0);
+            if (cond_result != COND_OK && cond_result != COND_TIMEOUT)
+            {
+                /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_022: [ If waiting fails, the worker shall stop and mark the pending requests as failed. ] */
+                LogError("Failed waiting for credential requests, worker stopping");
+                thread->is_running = false;
+            }
+        }
+        else
+        {
+            CREDENTIAL_PROVIDER_INSTANCE* provider = request->provider;
+            char* sas_token;
+
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_020: [ The worker shall sign the pending requests of every provider in the order they were queued, one at a time, releasing the worker lock while sign_callback runs. ] */
+            // The slot keeps its scope and key name while signing, neither take nor destroy release a signing slot
+            request->state = CREDENTIAL_REQUEST_STATE_SIGNING;
+            (void)Unlock(g_worker.lock);
+
+            sas_token = sign_token(provider, request->scope, request->key_name, request->expiry_time);
+
+            lock_worker();
+            request->sas_token = sas_token;
+            request->state = (sas_token == NULL) ? CREDENTIAL_REQUEST_STATE_FAILED : CREDENTIAL_REQUEST_STATE_READY;
+            (void)Condition_Post(g_worker.signed_condition);
+        }
+    }
+
+    // Callers fall back to signing on demand once the worker is gone
+    thread->is_running = false;
+    while ((request = dequeue_pending_request()) != NULL)
+    {
+        request->state = CREDENTIAL_REQUEST_STATE_FAILED;
+    }
+    (void)Unlock(g_worker.lock);
+
+    return 0;
+}
+
+static void start_worker_thread(void)
+{
+    CREDENTIAL_WORKER_THREAD* thread;
+
+    if ((thread = (CREDENTIAL_WORKER_THREAD*)malloc(sizeof(CREDENTIAL_WORKER_THREAD))) == NULL)
+    {
+        LogError("Failed allocating the credential worker, tokens will be signed on demand");
+    }
+    else
+    {
+        thread->is_running = true;
+        thread->stop_thread = false;
+        if (ThreadAPI_Create(&thread->thread_handle, credential_provider_worker, thread) != THREADAPI_OK)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_005: [ If the worker thread cannot be started, credential_provider_create shall still succeed and only sign tokens on demand. ] */
+            LogError("Failed creating the credential worker, tokens will be signed on demand");
+            free(thread);
+        }
+        else
+        {
+            g_worker.thread = thread;
+        }
+    }
+}
+
+static void deinit_worker(void)
+{
+    if (g_worker.signed_condition != NULL)
+    {
+        Condition_Deinit(g_worker.signed_condition);
+    }
+    if (g_worker.request_condition != NULL)
+    {
+        Condition_Deinit(g_worker.request_condition);
+    }
+    if (g_worker.hsm_lock != NULL)
+    {
+        Lock_Deinit(g_worker.hsm_lock);
+    }
+    if (g_worker.lock != NULL)
+    {
+        Lock_Deinit(g_worker.lock);
+    }
+    memset(&g_worker, 0, sizeof(CREDENTIAL_WORKER));
+}
+
+
+// ========== Public API ========== //
+
+int credential_provider_init(void)
+{
+    int result;
+
+    if (g_worker.lock != NULL)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_023: [ If the worker is already initialized, credential_provider_init shall return 0. ] */
+        result = 0;
+    }
+    /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_024: [ credential_provider_init shall create the worker lock, the HSM lock and the worker conditions. ] */
+    else if ((g_worker.lock = Lock_Init()) == NULL ||
+        (g_worker.hsm_lock = Lock_Init()) == NULL ||
+        (g_worker.request_condition = Condition_Init()) == NULL ||
+        (g_worker.signed_condition = Condition_Init()) == NULL)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_025: [ If any of them fails to be created, credential_provider_init shall release what it created and return a non-zero value. ] */
+        LogError("Failed initializing the credential worker");
+        deinit_worker();
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+void credential_provider_deinit(void)
+{
+    if (g_worker.provider_count != 0)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_027: [ If providers are still alive, credential_provider_deinit shall leave the worker untouched. ] */
+        LogError("Credential providers still in use, the credential worker is kept");
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_026: [ credential_provider_deinit shall release the worker locks and conditions. ] */
+        deinit_worker();
+    }
+}
+
+CREDENTIAL_PROVIDER_HANDLE credential_provider_create(CREDENTIAL_SIGN_CALLBACK sign_callback, void* sign_context)
+{
+    CREDENTIAL_PROVIDER_INSTANCE* result;
+
+    if (sign_callback == NULL)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_001: [ If sign_callback is NULL, credential_provider_create shall fail and return NULL. ] */
+        LogError("Invalid argument sign_callback: NULL");
+        result = NULL;
+    }
+    /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_028: [ If the worker is not initialized, credential_provider_create shall fail and return NULL. ] */
+    else if (g_worker.lock == NULL)
+    {
+        // Initializing it here could race with another client being created, it is only done by IoTHub_Init
+        LogError("The credential worker is not initialized, IoTHub_Init must be called first");
+        result = NULL;
+    }
+    else if ((result = (CREDENTIAL_PROVIDER_INSTANCE*)malloc(sizeof(CREDENTIAL_PROVIDER_INSTANCE))) == NULL)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_003: [ If any allocation fails, credential_provider_create shall fail and return NULL. ] */
+        LogError("Failed allocating credential provider");
+    }
+    else if (Lock(g_worker.lock) != LOCK_OK)
+    {
+        LogError("Failed locking the credential worker");
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        size_t index;
+
+        /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_002: [ credential_provider_create shall allocate the provider and add it to the providers served by the worker. ] */
+        memset(result, 0, sizeof(CREDENTIAL_PROVIDER_INSTANCE));
+        result->sign_callback = sign_callback;
+        result->sign_context = sign_context;
+        for (index = 0; index < CREDENTIAL_PROVIDER_MAX_REQUESTS; index++)
+        {
+            result->requests[index].provider = result;
+        }
+
+        if (g_worker.thread == NULL)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_004: [ If the worker thread is not started, credential_provider_create shall start it. Every provider shares that one thread. ] */
+            start_worker_thread();
+        }
+        g_worker.provider_count++;
+        (void)Unlock(g_worker.lock);
+    }
+    return result;
+}
+
+void credential_provider_destroy(CREDENTIAL_PROVIDER_HANDLE provider_handle)
+{
+    /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_006: [ If provider_handle is NULL, credential_provider_destroy shall do nothing. ] */
+    if (provider_handle != NULL)
+    {
+        if (Lock(g_worker.lock) != LOCK_OK)
+        {
+            // The worker may still reach the requests of the provider, leaking it is safer than freeing it
+            LogError("Failed locking the credential worker, the credential provider is not released");
+        }
+        else
+        {
+            CREDENTIAL_WORKER_THREAD* stopped_thread = NULL;
+            size_t index;
+
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_007: [ credential_provider_destroy shall remove the queued requests of the provider and wait for the one being signed before releasing its requests, tokens and the provider. ] */
+            for (index = 0; index < CREDENTIAL_PROVIDER_MAX_REQUESTS; index++)
+            {
+                if (provider_handle->requests[index].state == CREDENTIAL_REQUEST_STATE_PENDING)
+                {
+                    remove_pending_request(&provider_handle->requests[index]);
+                }
+            }
+            while (is_provider_signing(provider_handle))
+            {
+                (void)Condition_Wait(g_worker.signed_condition, g_worker.lock, CREDENTIAL_PROVIDER_SIGNING_WAIT_MS);
+            }
+            for (index = 0; index < CREDENTIAL_PROVIDER_MAX_REQUESTS; index++)
+            {
+                clear_request(&provider_handle->requests[index]);
+            }
+
+            g_worker.provider_count--;
+            if (g_worker.provider_count == 0 && g_worker.thread != NULL)
+            {
+                /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_029: [ When the last provider is destroyed, credential_provider_destroy shall stop and join the worker thread. ] */
+                stopped_thread = g_worker.thread;
+                g_worker.thread = NULL;
+                stopped_thread->stop_thread = true;
+                (void)Condition_Post(g_worker.request_condition);
+            }
+            (void)Unlock(g_worker.lock);
+
+            if (stopped_thread != NULL)
+            {
+                int thread_result;
+                if (ThreadAPI_Join(stopped_thread->thread_handle, &thread_result) != THREADAPI_OK)
+                {
+                    LogError("Failed joining the credential worker");
+                }
+                free(stopped_thread);
+            }
+            free(provider_handle);
+        }
+    }
+}
+
+char* credential_provider_sign(CREDENTIAL_PROVIDER_HANDLE provider_handle, const char* scope, const char* key_name, size_t* expiry_time)
+{
+    char* result;
+    if (provider_handle == NULL || scope == NULL || expiry_time == NULL)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_008: [ If provider_handle, scope or expiry_time are NULL, credential_provider_sign shall return NULL. ] */
+        LogError("Invalid argument provider_handle: %p, scope: %p, expiry_time: %p", provider_handle, scope, expiry_time);
+        result = NULL;
+    }
+    else if (Lock(g_worker.lock) != LOCK_OK)
+    {
+        LogError("Failed locking the credential worker");
+        result = NULL;
+    }
+    else
+    {
+        CREDENTIAL_REQUEST* request = find_request(provider_handle, scope, key_name);
+
+        if (request != NULL && request->state == CREDENTIAL_REQUEST_STATE_PENDING)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_030: [ If a request for the same scope and key_name is pending, credential_provider_sign shall take it out of the queue and sign it itself. ] */
+            remove_pending_request(request);
+            clear_request(request);
+            request = NULL;
+        }
+
+        while (request != NULL && request->state == CREDENTIAL_REQUEST_STATE_SIGNING)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_031: [ If a request for the same scope and key_name is being signed, credential_provider_sign shall wait for it instead of signing the token a second time. ] */
+            (void)Condition_Wait(g_worker.signed_condition, g_worker.lock, CREDENTIAL_PROVIDER_SIGNING_WAIT_MS);
+            request = find_request(provider_handle, scope, key_name);
+        }
+
+        if (request != NULL && request->state == CREDENTIAL_REQUEST_STATE_READY)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_032: [ If a token for the same scope and key_name is signed, credential_provider_sign shall return it, release the request and set expiry_time to the expiry time of that token. ] */
+            result = request->sas_token;
+            *expiry_time = request->expiry_time;
+            request->sas_token = NULL;
+            clear_request(request);
+            (void)Unlock(g_worker.lock);
+        }
+        else
+        {
+            if (request != NULL)
+            {
+                // A failed attempt, signed again below
+                clear_request(request);
+            }
+            (void)Unlock(g_worker.lock);
+
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_009: [ Otherwise credential_provider_sign shall call sign_callback with expiry_time while holding the HSM lock and return its result. ] */
+            result = sign_token(provider_handle, scope, key_name, *expiry_time);
+        }
+    }
+    return result;
+}
+
+int credential_provider_request(CREDENTIAL_PROVIDER_HANDLE provider_handle, const char* scope, const char* key_name, size_t expiry_time)
+{
+    int result;
+    if (provider_handle == NULL || scope == NULL)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_010: [ If provider_handle or scope are NULL, credential_provider_request shall fail and return a non-zero value. ] */
+        LogError("Invalid argument provider_handle: %p, scope: %p", provider_handle, scope);
+        result = MU_FAILURE;
+    }
+    else if (Lock(g_worker.lock) != LOCK_OK)
+    {
+        LogError("Failed locking the credential worker");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        CREDENTIAL_REQUEST* request;
+
+        if (g_worker.thread == NULL || !g_worker.thread->is_running)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_011: [ If the worker thread is not running, credential_provider_request shall fail and return a non-zero value. ] */
+            LogError("Credential worker is not running");
+            result = MU_FAILURE;
+        }
+        else if ((request = find_request(provider_handle, scope, key_name)) != NULL && request->state != CREDENTIAL_REQUEST_STATE_FAILED)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_012: [ If a request for the same scope and key_name is pending, being signed or ready, credential_provider_request shall return 0 without queuing another one. ] */
+            // Coalesced with the request already outstanding (or completed) for the same scope and key name
+            result = 0;
+        }
+        else if (request == NULL && (request = get_free_request(provider_handle)) == NULL)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_014: [ If every slot holds an outstanding request, credential_provider_request shall fail and return a non-zero value. ] */
+            LogError("Too many outstanding credential requests");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            // Drops a failed attempt or a token nobody collected
+            clear_request(request);
+            if (mallocAndStrcpy_s(&request->scope, scope) != 0)
+            {
+                LogError("Failed copying the token scope");
+                clear_request(request);
+                result = MU_FAILURE;
+            }
+            else if (key_name != NULL && mallocAndStrcpy_s(&request->key_name, key_name) != 0)
+            {
+                LogError("Failed copying the token key name");
+                clear_request(request);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_013: [ Otherwise credential_provider_request shall add the request to the queue of the worker, signal it and return 0 without waiting for the signature. ] */
+                request->expiry_time = expiry_time;
+                request->state = CREDENTIAL_REQUEST_STATE_PENDING;
+                enqueue_pending_request(request);
+                (void)Condition_Post(g_worker.request_condition);
+                result = 0;
+            }
+        }
+        (void)Unlock(g_worker.lock);
+    }
+    return result;
+}
+
+CREDENTIAL_TOKEN_STATE credential_provider_take(CREDENTIAL_PROVIDER_HANDLE provider_handle, const char* scope, const char* key_name, char** sas_token, size_t* expiry_time)
+{
+    CREDENTIAL_TOKEN_STATE result;
+    if (provider_handle == NULL || scope == NULL || sas_token == NULL || expiry_time == NULL)
+    {
+        /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_015: [ If any argument other than key_name is NULL, credential_provider_take shall return CREDENTIAL_TOKEN_STATE_FAILED. ] */
+        LogError("Invalid argument provider_handle: %p, scope: %p, sas_token: %p, expiry_time: %p", provider_handle, scope, sas_token, expiry_time);
+        result = CREDENTIAL_TOKEN_STATE_FAILED;
+    }
+    else if (Lock(g_worker.lock) != LOCK_OK)
+    {
+        LogError("Failed locking the credential worker");
+        result = CREDENTIAL_TOKEN_STATE_FAILED;
+    }
+    else
+    {
+        CREDENTIAL_REQUEST* request = find_request(provider_handle, scope, key_name);
+        if (request == NULL)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_016: [ If there is no request for scope and key_name, credential_provider_take shall return CREDENTIAL_TOKEN_STATE_NONE. ] */
+            result = CREDENTIAL_TOKEN_STATE_NONE;
+        }
+        else if (request->state == CREDENTIAL_REQUEST_STATE_PENDING || request->state == CREDENTIAL_REQUEST_STATE_SIGNING)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_017: [ If the request is pending or being signed, credential_provider_take shall return CREDENTIAL_TOKEN_STATE_PENDING. ] */
+            result = CREDENTIAL_TOKEN_STATE_PENDING;
+        }
+        else if (request->state == CREDENTIAL_REQUEST_STATE_READY)
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_018: [ If the token is signed, credential_provider_take shall hand ownership of it and its expiry time to the caller, release the request and return CREDENTIAL_TOKEN_STATE_READY. ] */
+            *sas_token = request->sas_token;
+            *expiry_time = request->expiry_time;
+            request->sas_token = NULL;
+            clear_request(request);
+            result = CREDENTIAL_TOKEN_STATE_READY;
+        }
+        else
+        {
+            /* Codes_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_019: [ If signing failed, credential_provider_take shall release the request and return CREDENTIAL_TOKEN_STATE_FAILED. ] */
+            clear_request(request);
+            result = CREDENTIAL_TOKEN_STATE_FAILED;
+        }
+        (void)Unlock(g_worker.lock);
+    }
+    return result;
+}
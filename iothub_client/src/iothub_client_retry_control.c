@@ -3,7 +3,9 @@
 
 #include "internal/iothub_client_retry_control.h"
 
-#include <math.h>
+#include <limits.h>
+#include <stdint.h>
+#include <time.h>
 
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/agenttime.h"
@@ -12,6 +14,8 @@
 
 #define RESULT_OK           0
 #define INDEFINITE_TIME     ((time_t)-1)
+#define DEFAULT_MAX_WAIT_TIME_IN_SECS   60
+#define DECORRELATED_JITTER_MULTIPLIER  3
 
 typedef struct RETRY_CONTROL_INSTANCE_TAG
 {
@@ -20,6 +24,9 @@ typedef struct RETRY_CONTROL_INSTANCE_TAG
 
     unsigned int initial_wait_time_in_secs;
     unsigned int max_jitter_percent;
+    unsigned int max_wait_time_in_secs;
+
+    uint32_t random_state;
 
     unsigned int retry_count;
     time_t first_retry_time;
@@ -44,7 +51,8 @@ static void* retry_control_clone_option(const char* name, const void* value)
         result = NULL;
     }
     else if (strcmp(RETRY_CONTROL_OPTION_INITIAL_WAIT_TIME_IN_SECS, name) == 0 ||
-            strcmp(RETRY_CONTROL_OPTION_MAX_JITTER_PERCENT, name) == 0)
+            strcmp(RETRY_CONTROL_OPTION_MAX_JITTER_PERCENT, name) == 0 ||
+            strcmp(RETRY_CONTROL_OPTION_MAX_WAIT_TIME_IN_SECS, name) == 0)
     {
         unsigned int* cloned_value;
 
@@ -76,7 +84,8 @@ static void retry_control_destroy_option(const char* name, const void* value)
         LogError("Failed to destroy option (either name (%p) or value (%p) are NULL)", name, value);
     }
     else if (strcmp(RETRY_CONTROL_OPTION_INITIAL_WAIT_TIME_IN_SECS, name) == 0 ||
-        strcmp(RETRY_CONTROL_OPTION_MAX_JITTER_PERCENT, name) == 0)
+        strcmp(RETRY_CONTROL_OPTION_MAX_JITTER_PERCENT, name) == 0 ||
+        strcmp(RETRY_CONTROL_OPTION_MAX_WAIT_TIME_IN_SECS, name) == 0)
     {
         free((void*)value);
     }
@@ -86,6 +95,56 @@ static void retry_control_destroy_option(const char* name, const void* value)
     }
 }
 
+// ---------- Random Number Helpers ----------//
+
+// rand() is never seeded by the SDK, so every process built from the same image would draw the
+// same "random" wait times and a fleet disconnected by one outage would reconnect in lockstep.
+static uint32_t create_random_seed(const void* instance)
+{
+    uint64_t seed = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32) ^ (uint64_t)(uintptr_t)instance;
+
+    // splitmix64 finalizer, spreads the few bits that differ between processes over the whole seed.
+    seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebULL;
+    seed = seed ^ (seed >> 31);
+
+    return ((uint32_t)seed == 0) ? 0x9e3779b9 : (uint32_t)seed;
+}
+
+static uint32_t get_next_random(RETRY_CONTROL_INSTANCE* retry_control)
+{
+    // xorshift32
+    uint32_t x = retry_control->random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    retry_control->random_state = x;
+    return x;
+}
+
+static double get_random_fraction(RETRY_CONTROL_INSTANCE* retry_control)
+{
+    return (double)get_next_random(retry_control) / (double)UINT32_MAX;
+}
+
+static unsigned int get_exponential_wait_time(RETRY_CONTROL_INSTANCE* retry_control)
+{
+    unsigned int result;
+    unsigned int exponent = retry_control->retry_count - 1;
+
+    if (exponent >= (sizeof(unsigned int) * CHAR_BIT) ||
+        retry_control->initial_wait_time_in_secs > (UINT_MAX >> exponent))
+    {
+        result = UINT_MAX;
+    }
+    else
+    {
+        result = retry_control->initial_wait_time_in_secs << exponent;
+    }
+
+    return result;
+}
+
 // ========== _should_retry() Auxiliary Functions ========== //
 
 static int evaluate_retry_action(RETRY_CONTROL_INSTANCE* retry_control, RETRY_ACTION* retry_action)
@@ -171,20 +230,36 @@ static unsigned int calculate_next_wait_time(RETRY_CONTROL_INSTANCE* retry_contr
     // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_031: [If `retry_control->policy` is IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF, `calculate_next_wait_time` shall return (pow(2, `retry_control->retry_count` - 1) * `retry_control->initial_wait_time_in_secs`)]
     else if (retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF)
     {
-        result = (unsigned int)(pow(2, retry_control->retry_count - 1) * retry_control->initial_wait_time_in_secs);
+        result = get_exponential_wait_time(retry_control);
     }
-    // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_032: [If `retry_control->policy` is IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, `calculate_next_wait_time` shall return ((pow(2, `retry_control->retry_count` - 1) * `retry_control->initial_wait_time_in_secs`) * (1 + (`retry_control->max_jitter_percent` / 100) * (rand() / RAND_MAX)))]
+    // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_032: [If `retry_control->policy` is IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, `calculate_next_wait_time` shall return ((pow(2, `retry_control->retry_count` - 1) * `retry_control->initial_wait_time_in_secs`) * (1 + (`retry_control->max_jitter_percent` / 100) * `random`)), where `random` is drawn from the per-instance generator in the range 0 to 1]
     else if (retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER)
     {
-        double jitter_percent = (retry_control->max_jitter_percent / 100.0) * (rand() / ((double)RAND_MAX));
+        double jitter_percent = (retry_control->max_jitter_percent / 100.0) * get_random_fraction(retry_control);
+        double wait_time = get_exponential_wait_time(retry_control) * (1 + jitter_percent);
 
-        result = (unsigned int)(pow(2, retry_control->retry_count - 1) * retry_control->initial_wait_time_in_secs * (1 + jitter_percent));
+        result = (wait_time >= (double)UINT_MAX) ? UINT_MAX : (unsigned int)wait_time;
     }
-    // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_033: [If `retry_control->policy` is IOTHUB_CLIENT_RETRY_RANDOM, `calculate_next_wait_time` shall return (`retry_control->initial_wait_time_in_secs` * (rand() / RAND_MAX))]
+    // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_033: [If `retry_control->policy` is IOTHUB_CLIENT_RETRY_RANDOM, `calculate_next_wait_time` shall return (`retry_control->initial_wait_time_in_secs` * `random`), where `random` is drawn from the per-instance generator in the range 0 to 1]
     else if (retry_control->policy == IOTHUB_CLIENT_RETRY_RANDOM)
     {
-        double random_percent = ((double)rand() / (double)RAND_MAX);
-        result = (unsigned int)(retry_control->initial_wait_time_in_secs * random_percent);
+        result = (unsigned int)(retry_control->initial_wait_time_in_secs * get_random_fraction(retry_control));
+    }
+    // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_064: [If `retry_control->policy` is IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER, `calculate_next_wait_time` shall return a random value between `retry_control->initial_wait_time_in_secs` and 3 times the previous wait time (or `retry_control->initial_wait_time_in_secs` on the first retry), drawn from the per-instance generator]
+    else if (retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER)
+    {
+        unsigned int lower_bound = retry_control->initial_wait_time_in_secs;
+        unsigned int previous_wait = (retry_control->current_wait_time_in_secs == 0 ? lower_bound : retry_control->current_wait_time_in_secs);
+        unsigned int upper_bound = (previous_wait > UINT_MAX / DECORRELATED_JITTER_MULTIPLIER ? UINT_MAX : previous_wait * DECORRELATED_JITTER_MULTIPLIER);
+        unsigned int range = (upper_bound > lower_bound ? upper_bound - lower_bound : 0);
+
+        result = lower_bound + (range == 0 ? 0 : (unsigned int)(get_next_random(retry_control) % ((uint64_t)range + 1)));
+
+        // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_065: [If the decorrelated jitter wait time is greater than `retry_control->max_wait_time_in_secs`, `calculate_next_wait_time` shall return `retry_control->max_wait_time_in_secs`]
+        if (result > retry_control->max_wait_time_in_secs)
+        {
+            result = retry_control->max_wait_time_in_secs;
+        }
     }
     else
     {
@@ -283,9 +358,10 @@ RETRY_CONTROL_HANDLE retry_control_create(IOTHUB_CLIENT_RETRY_POLICY policy, uns
         retry_control->policy = policy;
         retry_control->max_retry_time_in_secs = max_retry_time_in_secs;
 
-        // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_005: [If `policy` is IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF or IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, `retry_control->initial_wait_time_in_secs` shall be set to 1]
+        // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_005: [If `policy` is IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF, IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER or IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER, `retry_control->initial_wait_time_in_secs` shall be set to 1]
         if (retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF ||
-            retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER)
+            retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER ||
+            retry_control->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER)
         {
             retry_control->initial_wait_time_in_secs = 1;
         }
@@ -298,6 +374,12 @@ RETRY_CONTROL_HANDLE retry_control_create(IOTHUB_CLIENT_RETRY_POLICY policy, uns
         // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_007: [`retry_control->max_jitter_percent` shall be set to 5]
         retry_control->max_jitter_percent = 5;
 
+        // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_066: [`retry_control->max_wait_time_in_secs` shall be set to 60]
+        retry_control->max_wait_time_in_secs = DEFAULT_MAX_WAIT_TIME_IN_SECS;
+
+        // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_067: [`retry_control->random_state` shall be seeded from the current time, the processor time and the address of `retry_control`]
+        retry_control->random_state = create_random_seed(retry_control);
+
         // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_008: [The remaining fields in `retry_control` shall be initialized according to retry_control_reset()]
         retry_control_reset(retry_control);
     }
@@ -431,6 +513,25 @@ int retry_control_set_option(RETRY_CONTROL_HANDLE retry_control_handle, const ch
                 result = RESULT_OK;
             }
         }
+        else if (strcmp(RETRY_CONTROL_OPTION_MAX_WAIT_TIME_IN_SECS, name) == 0)
+        {
+            unsigned int cast_value = *((unsigned int*)value);
+
+            // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_068: [If `name` is "max_wait_time_in_secs" and `value` is less than 1, `retry_control_set_option` shall fail and return non-zero]
+            if (cast_value < 1)
+            {
+                LogError("Failed to set option '%s' (value must be equal or greater to 1)", name);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_069: [If `name` is "max_wait_time_in_secs", `value` shall be saved on `retry_control->max_wait_time_in_secs`]
+                retry_control->max_wait_time_in_secs = cast_value;
+
+                // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_044: [If no errors occur, retry_control_set_option shall return 0]
+                result = RESULT_OK;
+            }
+        }
         else if (strcmp(RETRY_CONTROL_OPTION_SAVED_OPTIONS, name) == 0)
         {
             // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_041: [If `name` is "retry_control_options", value shall be fed to `retry_control` using OptionHandler_FeedOptions]
@@ -496,6 +597,13 @@ OPTIONHANDLER_HANDLE retry_control_retrieve_options(RETRY_CONTROL_HANDLE retry_c
                 LogError("Failed to retrieve options (OptionHandler_Create failed for option '%s')", RETRY_CONTROL_OPTION_INITIAL_WAIT_TIME_IN_SECS);
                 result = NULL;
             }
+            // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_070: [`retry_control->max_wait_time_in_secs` shall be added to `options` using OptionHandler_Add]
+            else if (OptionHandler_AddOption(options, RETRY_CONTROL_OPTION_MAX_WAIT_TIME_IN_SECS, (void*)&retry_control->max_wait_time_in_secs) != OPTIONHANDLER_OK)
+            {
+                // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_052: [If any call to OptionHandler_Add fails, `retry_control_retrieve_options` shall fail and return NULL]
+                LogError("Failed to retrieve options (OptionHandler_Create failed for option '%s')", RETRY_CONTROL_OPTION_MAX_WAIT_TIME_IN_SECS);
+                result = NULL;
+            }
             else
             {
                 // Codes_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_054: [If no errors occur, `retry_control_retrieve_options` shall return the OPTIONHANDLER_HANDLE instance]
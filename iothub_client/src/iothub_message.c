@@ -2,6 +2,8 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/xlogging.h"
@@ -16,6 +18,16 @@ MU_DEFINE_ENUM_STRINGS(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_CONTENT_TYPE_VA
     LogError("(result = %s)", ENUM_TO_STRING(IOTHUB_MESSAGE_RESULT, result));
 static const char* SECURITY_CLIENT_JSON_ENCODING = "application/json";
 
+// Messages with at least this many properties get a hash index over the keys of the properties map
+#define PROPERTY_INDEX_THRESHOLD        8
+
+typedef struct PROPERTY_INDEX_BUCKET_TAG
+{
+    // Position of the key in the properties map + 1, 0 is an empty bucket
+    size_t slot;
+    size_t hash;
+} PROPERTY_INDEX_BUCKET;
+
 typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG
 {
     IOTHUBMESSAGE_CONTENT_TYPE contentType;
@@ -35,22 +47,51 @@ typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG
     char* connectionDeviceId;
     IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE diagnosticData;
     bool is_security_message;
+    // Open addressing table sized to at least twice the properties it indexes, kept up by the property setters
+    PROPERTY_INDEX_BUCKET* property_index;
+    size_t property_index_capacity;
+    size_t property_index_count;
+    // Set once IoTHubMessage_Properties handed out the map, which can then change behind the index
+    bool properties_exposed;
 }IOTHUB_MESSAGE_HANDLE_DATA;
 
+// Byte-wise masks for checking a whole machine word of a string at once
+#define ASCII_ONES          ((size_t)-1 / 0xFF)
+#define ASCII_HIGH_BITS     (ASCII_ONES * 0x80)
+
 static bool ContainsOnlyUsAscii(const char* asciiValue)
 {
     bool result = true;
-    const char* iterator = asciiValue;
-    while (iterator != NULL && *iterator != '\0')
+
+    if (asciiValue != NULL)
     {
-        // Allow only printable ascii char
-        if (*iterator < ' ' || *iterator > '~')
+        size_t length = strlen(asciiValue);
+        size_t i = 0;
+
+        // A byte is outside 32-126 if its high bit is set, if adding 0x60 does not set it (< 32)
+        // or if adding 1 sets it (127). Bytes below 0x80 never carry into their neighbours.
+        for (; i + sizeof(size_t) <= length; i += sizeof(size_t))
         {
-            result = false;
-            break;
+            size_t word;
+            (void)memcpy(&word, asciiValue + i, sizeof(size_t));
+
+            if (((word | ~(word + ASCII_ONES * 0x60) | (word + ASCII_ONES)) & ASCII_HIGH_BITS) != 0)
+            {
+                result = false;
+                break;
+            }
+        }
+
+        for (; result && i < length; i++)
+        {
+            // Allow only printable ascii char
+            if (asciiValue[i] < ' ' || asciiValue[i] > '~')
+            {
+                result = false;
+            }
         }
-        iterator++;
     }
+
     return result;
 }
 
@@ -102,9 +143,155 @@ static void DestroyMessageData(IOTHUB_MESSAGE_HANDLE_DATA* handleData)
     free(handleData->inputName);
     free(handleData->connectionModuleId);
     free(handleData->connectionDeviceId);
+    free(handleData->property_index);
     free(handleData);
 }
 
+// FNV-1a
+static size_t hash_key(const char* key)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*key != '\0')
+    {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+
+    return (size_t)hash;
+}
+
+static void insert_property_index(IOTHUB_MESSAGE_HANDLE_DATA* handleData, const char* const* keys, size_t slot)
+{
+    size_t mask = handleData->property_index_capacity - 1;
+    size_t hash = hash_key(keys[slot]);
+    size_t bucket = hash & mask;
+
+    while (handleData->property_index[bucket].slot != 0)
+    {
+        bucket = (bucket + 1) & mask;
+    }
+
+    handleData->property_index[bucket].slot = slot + 1;
+    handleData->property_index[bucket].hash = hash;
+}
+
+static void update_property_index(IOTHUB_MESSAGE_HANDLE_DATA* handleData, const char* const* keys, size_t count)
+{
+    size_t i;
+
+    // Properties are only ever appended through this API, so new keys are indexed where they are.
+    // A map that shrank or was handed out by IoTHubMessage_Properties is indexed again from scratch.
+    if (handleData->properties_exposed || count < handleData->property_index_count)
+    {
+        if (handleData->property_index != NULL)
+        {
+            (void)memset(handleData->property_index, 0, handleData->property_index_capacity * sizeof(PROPERTY_INDEX_BUCKET));
+        }
+        handleData->property_index_count = 0;
+    }
+
+    if (handleData->property_index != NULL && handleData->property_index_capacity >= 2 * count)
+    {
+        for (i = handleData->property_index_count; i < count; i++)
+        {
+            insert_property_index(handleData, keys, i);
+        }
+        handleData->property_index_count = count;
+    }
+    else
+    {
+        size_t capacity = 2 * PROPERTY_INDEX_THRESHOLD;
+
+        while (capacity < 2 * count)
+        {
+            capacity *= 2;
+        }
+
+        free(handleData->property_index);
+        handleData->property_index_capacity = 0;
+        handleData->property_index_count = 0;
+
+        if ((handleData->property_index = (PROPERTY_INDEX_BUCKET*)malloc(capacity * sizeof(PROPERTY_INDEX_BUCKET))) == NULL)
+        {
+            LogError("Failed building the property index, falling back to the properties map");
+        }
+        else
+        {
+            (void)memset(handleData->property_index, 0, capacity * sizeof(PROPERTY_INDEX_BUCKET));
+            handleData->property_index_capacity = capacity;
+
+            for (i = 0; i < count; i++)
+            {
+                insert_property_index(handleData, keys, i);
+            }
+            handleData->property_index_count = count;
+        }
+    }
+}
+
+static void index_properties(IOTHUB_MESSAGE_HANDLE_DATA* handleData)
+{
+    const char* const* keys;
+    const char* const* values;
+    size_t count;
+
+    if (Map_GetInternals(handleData->properties, &keys, &values, &count) != MAP_OK)
+    {
+        LogError("Failure reading the properties map, dropping the property index");
+        free(handleData->property_index);
+        handleData->property_index = NULL;
+        handleData->property_index_capacity = 0;
+        handleData->property_index_count = 0;
+    }
+    // Codes_SRS_IOTHUBMESSAGE_09_126: [Once a message has 8 application properties, IoTHubMessage_SetProperty and IoTHubMessage_SetProperties shall keep a hash index over the keys of the properties map.]
+    else if (count >= PROPERTY_INDEX_THRESHOLD)
+    {
+        update_property_index(handleData, keys, count);
+    }
+}
+
+static const char* find_indexed_property(const IOTHUB_MESSAGE_HANDLE_DATA* handleData, const char* const* keys, const char* const* values, size_t count, const char* key)
+{
+    const char* result = NULL;
+    size_t mask = handleData->property_index_capacity - 1;
+    size_t hash = hash_key(key);
+    size_t bucket = hash & mask;
+
+    while (handleData->property_index[bucket].slot != 0)
+    {
+        size_t slot = handleData->property_index[bucket].slot - 1;
+
+        if (handleData->property_index[bucket].hash == hash && slot < count && strcmp(keys[slot], key) == 0)
+        {
+            result = values[slot];
+            break;
+        }
+
+        bucket = (bucket + 1) & mask;
+    }
+
+    return result;
+}
+
+static const char* get_property_from_map(MAP_HANDLE properties, const char* key)
+{
+    const char* result;
+    bool key_exists = false;
+
+    // The return value is not neccessary, just check the key_exist variable
+    if ((Map_ContainsKey(properties, key, &key_exists) == MAP_OK) && key_exists)
+    {
+        result = Map_GetValueFromKey(properties, key);
+    }
+    else
+    {
+        result = NULL;
+    }
+
+    return result;
+}
+
 static int set_content_encoding(IOTHUB_MESSAGE_HANDLE_DATA* handleData, const char* encoding)
 {
     int result;
@@ -495,6 +682,7 @@ MAP_HANDLE IoTHubMessage_Properties(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
     {
         /*Codes_SRS_IOTHUBMESSAGE_02_002: [Otherwise, for any non-NULL iotHubMessageHandle it shall return a non-NULL MAP_HANDLE.]*/
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = (IOTHUB_MESSAGE_HANDLE_DATA*)iotHubMessageHandle;
+        handleData->properties_exposed = true;
         result = handleData->properties;
     }
     return result;
@@ -517,6 +705,7 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetProperty(IOTHUB_MESSAGE_HANDLE msg_handle
         }
         else
         {
+            index_properties(msg_handle);
             result = IOTHUB_MESSAGE_OK;
         }
     }
@@ -533,16 +722,173 @@ const char* IoTHubMessage_GetProperty(IOTHUB_MESSAGE_HANDLE msg_handle, const ch
     }
     else
     {
-        bool key_exists = false;
-        // The return value is not neccessary, just check the key_exist variable
-        if ((Map_ContainsKey(msg_handle->properties, key, &key_exists) == MAP_OK) && key_exists)
+        const char* const* map_keys;
+        const char* const* map_values;
+        size_t map_count;
+
+        // Codes_SRS_IOTHUBMESSAGE_09_127: [If the index was not built or does not cover every property of the map, IoTHubMessage_GetProperty shall look the key up in the properties map.]
+        if (Map_GetInternals(msg_handle->properties, &map_keys, &map_values, &map_count) != MAP_OK ||
+            msg_handle->property_index == NULL ||
+            msg_handle->property_index_count != map_count)
         {
-            result = Map_GetValueFromKey(msg_handle->properties, key);
+            result = get_property_from_map(msg_handle->properties, key);
         }
-        else
+        // Codes_SRS_IOTHUBMESSAGE_09_129: [Otherwise IoTHubMessage_GetProperty shall look the key up through the index, comparing the key it finds, without changing the message.]
+        else if ((result = find_indexed_property(msg_handle, map_keys, map_values, map_count, key)) == NULL && msg_handle->properties_exposed)
         {
-            result = NULL;
+            // Codes_SRS_IOTHUBMESSAGE_09_128: [If the key is not in the index and the map was returned by IoTHubMessage_Properties, IoTHubMessage_GetProperty shall look the key up in the properties map.]
+            result = get_property_from_map(msg_handle->properties, key);
+        }
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetProperties(IOTHUB_MESSAGE_HANDLE msg_handle, const char* const* keys, const char* const* values, size_t count)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    size_t i;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_110: [If `msg_handle` is NULL, or `keys` or `values` is NULL while `count` is not 0, or any key or value is NULL, IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_INVALID_ARG without setting any property.]
+    if (msg_handle == NULL || (count > 0 && (keys == NULL || values == NULL)))
+    {
+        LogError("invalid parameter to IoTHubMessage_SetProperties iotHubMessageHandle=%p, keys=%p, values=%p, count=%lu", msg_handle, keys, values, (unsigned long)count);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        result = IOTHUB_MESSAGE_OK;
+
+        for (i = 0; i < count; i++)
+        {
+            if (keys[i] == NULL || values[i] == NULL)
+            {
+                LogError("invalid parameter (NULL) to IoTHubMessage_SetProperties at index %lu", (unsigned long)i);
+                result = IOTHUB_MESSAGE_INVALID_ARG;
+                break;
+            }
+        }
+
+        for (i = 0; i < count && result == IOTHUB_MESSAGE_OK; i++)
+        {
+            // Codes_SRS_IOTHUBMESSAGE_09_111: [IoTHubMessage_SetProperties shall set each key and value, in order, as IoTHubMessage_SetProperty does.]
+            if (Map_AddOrUpdate(msg_handle->properties, keys[i], values[i]) != MAP_OK)
+            {
+                // Codes_SRS_IOTHUBMESSAGE_09_112: [If a property cannot be set, IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_ERROR and keep the properties set before it.]
+                LogError("Failure adding property %s to internal map", keys[i]);
+                result = IOTHUB_MESSAGE_ERROR;
+            }
+        }
+
+        if (count > 0 && result != IOTHUB_MESSAGE_INVALID_ARG)
+        {
+            index_properties(msg_handle);
+        }
+        // Codes_SRS_IOTHUBMESSAGE_09_113: [IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_OK if all properties are set.]
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_GetProperties(IOTHUB_MESSAGE_HANDLE msg_handle, const char* const* keys, const char** values, size_t count)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    const char* const* map_keys;
+    const char* const* map_values;
+    size_t map_count;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_114: [If `msg_handle` is NULL, or `keys` or `values` is NULL while `count` is not 0, IoTHubMessage_GetProperties shall return IOTHUB_MESSAGE_INVALID_ARG.]
+    if (msg_handle == NULL || (count > 0 && (keys == NULL || values == NULL)))
+    {
+        LogError("invalid parameter to IoTHubMessage_GetProperties iotHubMessageHandle=%p, keys=%p, values=%p, count=%lu", msg_handle, keys, values, (unsigned long)count);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else if (Map_GetInternals(msg_handle->properties, &map_keys, &map_values, &map_count) != MAP_OK)
+    {
+        LogError("Failure reading the properties map");
+        result = IOTHUB_MESSAGE_ERROR;
+    }
+    else
+    {
+        size_t i;
+        size_t j;
+
+        // Codes_SRS_IOTHUBMESSAGE_09_115: [IoTHubMessage_GetProperties shall set `values[i]` to the value of the property `keys[i]`, or NULL if it does not exist, without allocating memory.]
+        for (i = 0; i < count; i++)
+        {
+            values[i] = NULL;
+
+            if (keys[i] != NULL)
+            {
+                for (j = 0; j < map_count; j++)
+                {
+                    if (strcmp(map_keys[j], keys[i]) == 0)
+                    {
+                        values[i] = map_values[j];
+                        break;
+                    }
+                }
+            }
         }
+
+        // Codes_SRS_IOTHUBMESSAGE_09_116: [IoTHubMessage_GetProperties shall return IOTHUB_MESSAGE_OK.]
+        result = IOTHUB_MESSAGE_OK;
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_GetPropertyCount(IOTHUB_MESSAGE_HANDLE msg_handle, size_t* count)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    const char* const* map_keys;
+    const char* const* map_values;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_122: [If `msg_handle` or `count` is NULL, IoTHubMessage_GetPropertyCount shall return IOTHUB_MESSAGE_INVALID_ARG.]
+    if (msg_handle == NULL || count == NULL)
+    {
+        LogError("invalid parameter (NULL) to IoTHubMessage_GetPropertyCount iotHubMessageHandle=%p, count=%p", msg_handle, count);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    // Codes_SRS_IOTHUBMESSAGE_09_123: [IoTHubMessage_GetPropertyCount shall set `*count` to the number of application properties of the message without creating a properties map.]
+    else if (Map_GetInternals(msg_handle->properties, &map_keys, &map_values, count) != MAP_OK)
+    {
+        LogError("Failure reading the properties map");
+        result = IOTHUB_MESSAGE_ERROR;
+    }
+    else
+    {
+        result = IOTHUB_MESSAGE_OK;
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_GetPropertyAt(IOTHUB_MESSAGE_HANDLE msg_handle, size_t index, const char** key, const char** value)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    const char* const* map_keys;
+    const char* const* map_values;
+    size_t map_count;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_124: [If `msg_handle`, `key` or `value` is NULL, or `index` is not lower than the count returned by IoTHubMessage_GetPropertyCount, IoTHubMessage_GetPropertyAt shall return IOTHUB_MESSAGE_INVALID_ARG.]
+    if (msg_handle == NULL || key == NULL || value == NULL)
+    {
+        LogError("invalid parameter (NULL) to IoTHubMessage_GetPropertyAt iotHubMessageHandle=%p, key=%p, value=%p", msg_handle, key, value);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else if (Map_GetInternals(msg_handle->properties, &map_keys, &map_values, &map_count) != MAP_OK)
+    {
+        LogError("Failure reading the properties map");
+        result = IOTHUB_MESSAGE_ERROR;
+    }
+    else if (index >= map_count)
+    {
+        LogError("property index %lu out of range (%lu properties)", (unsigned long)index, (unsigned long)map_count);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_09_125: [IoTHubMessage_GetPropertyAt shall set `*key` and `*value` to the application property at `index`, in the order the properties were added, without allocating memory.]
+        *key = map_keys[index];
+        *value = map_values[index];
+        result = IOTHUB_MESSAGE_OK;
     }
     return result;
 }
@@ -0,0 +1,1654 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Alternative implementation of iothub_message.h, selected with the use_compact_message cmake option.
+//
+// The message header, its system properties, its application properties and small bodies all live in
+// one allocation: the handle is followed by an arena where every string is stored back to back and
+// referenced by offset. When the arena fills up its live data is compacted into a larger heap block.
+// Creating a message, setting a few properties and cloning it costs one allocation per message instead
+// of one per string.
+//
+// The block an arena outgrew is kept until the message is destroyed, so a pointer returned by a getter
+// stays valid for the lifetime of the message no matter what is set afterwards.
+//
+// A MAP_HANDLE is only created if IoTHubMessage_Properties is called; from then on the map holds the
+// application properties of the message. Transports walk the properties with IoTHubMessage_GetPropertyAt,
+// which does not create the map.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#include "iothub_message.h"
+
+MU_DEFINE_ENUM_STRINGS(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_RESULT_VALUES);
+MU_DEFINE_ENUM_STRINGS(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_CONTENT_TYPE_VALUES);
+
+static const char* SECURITY_CLIENT_JSON_ENCODING = "application/json";
+
+// Offset used for values that are not set
+#define ARENA_NO_VALUE                  ((size_t)-1)
+// Room left in the arena at creation and clone time for system and application properties
+#define ARENA_INITIAL_FREE_SPACE        256
+// Bodies larger than this get their own allocation so growing the arena never copies them
+#define INLINE_BODY_MAX_SIZE            512
+#define INITIAL_PROPERTY_CAPACITY       4
+// Messages with at least this many properties get a hash index over the property table
+#define PROPERTY_INDEX_THRESHOLD        8
+// Byte-wise masks for checking a whole machine word of a string at once
+#define ASCII_ONES                      ((size_t)-1 / 0xFF)
+#define ASCII_HIGH_BITS                 (ASCII_ONES * 0x80)
+
+typedef enum SYSTEM_PROPERTY_TAG
+{
+    SYSTEM_PROPERTY_MESSAGE_ID,
+    SYSTEM_PROPERTY_CORRELATION_ID,
+    SYSTEM_PROPERTY_CONTENT_TYPE,
+    SYSTEM_PROPERTY_CONTENT_ENCODING,
+    SYSTEM_PROPERTY_OUTPUT_NAME,
+    SYSTEM_PROPERTY_INPUT_NAME,
+    SYSTEM_PROPERTY_CONNECTION_MODULE_ID,
+    SYSTEM_PROPERTY_CONNECTION_DEVICE_ID,
+    SYSTEM_PROPERTY_DIAGNOSTIC_ID,
+    SYSTEM_PROPERTY_DIAGNOSTIC_CREATION_TIME_UTC,
+    SYSTEM_PROPERTY_COUNT
+} SYSTEM_PROPERTY;
+
+// Heap arenas are preceded by this header, which links the blocks an arena outgrew
+typedef union ARENA_BLOCK_HEADER_TAG
+{
+    union ARENA_BLOCK_HEADER_TAG* previous;
+    size_t alignment;
+} ARENA_BLOCK_HEADER;
+
+typedef struct MESSAGE_PROPERTY_TAG
+{
+    size_t key;
+    size_t value;
+    size_t hash;
+} MESSAGE_PROPERTY;
+
+typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG
+{
+    IOTHUBMESSAGE_CONTENT_TYPE contentType;
+    bool is_security_message;
+
+    // Points right after this struct until the arena outgrows it, then to a heap block
+    unsigned char* arena;
+    size_t arena_size;
+    size_t arena_capacity;
+    // Heap arenas outgrown by this one, freed by IoTHubMessage_Destroy
+    ARENA_BLOCK_HEADER* retired_arenas;
+
+    size_t body;
+    unsigned char* external_body;
+    size_t body_size;
+
+    size_t system_properties[SYSTEM_PROPERTY_COUNT];
+    IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA diagnostic_data;
+
+    size_t property_table;
+    size_t property_count;
+    size_t property_capacity;
+    // Open addressing table of property indexes + 1 (0 is an empty bucket), sized to twice the property table
+    size_t property_index;
+    size_t property_index_capacity;
+    MAP_HANDLE properties;
+} IOTHUB_MESSAGE_HANDLE_DATA;
+
+#define INLINE_ARENA(handle_data) ((unsigned char*)((IOTHUB_MESSAGE_HANDLE_DATA*)(handle_data) + 1))
+#define ARENA_BLOCK(arena) ((ARENA_BLOCK_HEADER*)(arena) - 1)
+
+static bool ContainsOnlyUsAscii(const char* asciiValue)
+{
+    bool result = true;
+
+    if (asciiValue != NULL)
+    {
+        size_t length = strlen(asciiValue);
+        size_t i = 0;
+
+        // A byte is outside 32-126 if its high bit is set, if adding 0x60 does not set it (< 32)
+        // or if adding 1 sets it (127). Bytes below 0x80 never carry into their neighbours.
+        for (; i + sizeof(size_t) <= length; i += sizeof(size_t))
+        {
+            size_t word;
+            (void)memcpy(&word, asciiValue + i, sizeof(size_t));
+
+            if (((word | ~(word + ASCII_ONES * 0x60) | (word + ASCII_ONES)) & ASCII_HIGH_BITS) != 0)
+            {
+                result = false;
+                break;
+            }
+        }
+
+        for (; result && i < length; i++)
+        {
+            // Allow only printable ascii char
+            if (asciiValue[i] < ' ' || asciiValue[i] > '~')
+            {
+                result = false;
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Codes_SRS_IOTHUBMESSAGE_07_008: [ValidateAsciiCharactersFilter shall loop through the mapKey and mapValue strings to ensure that they only contain valid US-Ascii characters Ascii value 32 - 126.] */
+static int ValidateAsciiCharactersFilter(const char* mapKey, const char* mapValue)
+{
+    int result;
+    if (!ContainsOnlyUsAscii(mapKey) || !ContainsOnlyUsAscii(mapValue))
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+
+// ========== Arena Helpers ========== //
+
+static size_t align_offset(size_t offset, size_t alignment)
+{
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+static size_t copy_arena_string(const unsigned char* source_arena, size_t source_offset, unsigned char* buffer, size_t* buffer_size)
+{
+    size_t result;
+
+    if (source_offset == ARENA_NO_VALUE)
+    {
+        result = ARENA_NO_VALUE;
+    }
+    else
+    {
+        size_t length = strlen((const char*)source_arena + source_offset) + 1;
+
+        if (buffer != NULL)
+        {
+            (void)memcpy(buffer + *buffer_size, source_arena + source_offset, length);
+        }
+
+        result = *buffer_size;
+        *buffer_size += length;
+    }
+
+    return result;
+}
+
+// Copies the live data of `source` into `buffer` and stores the new offsets in `destination`.
+// If `buffer` is NULL nothing is written and only the size needed is returned.
+// `destination` may be `source`, which is how the arena is compacted.
+static size_t compact_arena(const IOTHUB_MESSAGE_HANDLE_DATA* source, IOTHUB_MESSAGE_HANDLE_DATA* destination, unsigned char* buffer)
+{
+    const unsigned char* source_arena = source->arena;
+    size_t size = 0;
+    size_t offset;
+    size_t i;
+
+    if (source->body != ARENA_NO_VALUE)
+    {
+        if (buffer != NULL)
+        {
+            (void)memcpy(buffer, source_arena + source->body, source->body_size + (source->contentType == IOTHUBMESSAGE_STRING ? 1 : 0));
+            destination->body = 0;
+        }
+
+        size = source->body_size + (source->contentType == IOTHUBMESSAGE_STRING ? 1 : 0);
+    }
+
+    for (i = 0; i < SYSTEM_PROPERTY_COUNT; i++)
+    {
+        offset = copy_arena_string(source_arena, source->system_properties[i], buffer, &size);
+
+        if (buffer != NULL)
+        {
+            destination->system_properties[i] = offset;
+        }
+    }
+
+    if (source->properties != NULL)
+    {
+        // The map holds the properties now, so the table is dropped
+        if (buffer != NULL)
+        {
+            destination->property_table = ARENA_NO_VALUE;
+            destination->property_capacity = 0;
+            destination->property_index = ARENA_NO_VALUE;
+            destination->property_index_capacity = 0;
+        }
+    }
+    else if (source->property_table != ARENA_NO_VALUE)
+    {
+        const MESSAGE_PROPERTY* source_table = (const MESSAGE_PROPERTY*)(source_arena + source->property_table);
+        size_t property_count = source->property_count;
+
+        offset = align_offset(size, sizeof(size_t));
+        size = offset + source->property_capacity * sizeof(MESSAGE_PROPERTY);
+
+        for (i = 0; i < property_count; i++)
+        {
+            size_t key = copy_arena_string(source_arena, source_table[i].key, buffer, &size);
+            size_t value = copy_arena_string(source_arena, source_table[i].value, buffer, &size);
+
+            if (buffer != NULL)
+            {
+                MESSAGE_PROPERTY* destination_table = (MESSAGE_PROPERTY*)(buffer + offset);
+                destination_table[i].key = key;
+                destination_table[i].value = value;
+                destination_table[i].hash = source_table[i].hash;
+            }
+        }
+
+        if (buffer != NULL)
+        {
+            destination->property_table = offset;
+        }
+
+        // The index refers to positions in the table, which are kept, so it is copied as is
+        if (source->property_index != ARENA_NO_VALUE)
+        {
+            offset = align_offset(size, sizeof(size_t));
+
+            if (buffer != NULL)
+            {
+                (void)memcpy(buffer + offset, source_arena + source->property_index, source->property_index_capacity * sizeof(size_t));
+                destination->property_index = offset;
+            }
+
+            size = offset + source->property_index_capacity * sizeof(size_t);
+        }
+    }
+
+    return size;
+}
+
+static int grow_arena(IOTHUB_MESSAGE_HANDLE_DATA* handleData, size_t needed_size)
+{
+    int result;
+    size_t live_size = compact_arena(handleData, handleData, NULL);
+    size_t new_capacity = handleData->arena_capacity * 2;
+    ARENA_BLOCK_HEADER* new_block;
+
+    if (new_capacity < live_size + needed_size + ARENA_INITIAL_FREE_SPACE)
+    {
+        new_capacity = live_size + needed_size + ARENA_INITIAL_FREE_SPACE;
+    }
+
+    if ((new_block = (ARENA_BLOCK_HEADER*)malloc(sizeof(ARENA_BLOCK_HEADER) + new_capacity)) == NULL)
+    {
+        LogError("Failed growing the message arena to %lu bytes", (unsigned long)new_capacity);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        unsigned char* new_arena = (unsigned char*)(new_block + 1);
+
+        handleData->arena_size = compact_arena(handleData, handleData, new_arena);
+
+        // Codes_SRS_IOTHUBMESSAGE_09_121: [When the arena grows, the block it outgrew shall be kept until IoTHubMessage_Destroy, so strings and bodies returned by the getters stay valid for the lifetime of the message.]
+        if (handleData->arena != INLINE_ARENA(handleData))
+        {
+            ARENA_BLOCK_HEADER* old_block = ARENA_BLOCK(handleData->arena);
+            old_block->previous = handleData->retired_arenas;
+            handleData->retired_arenas = old_block;
+        }
+
+        handleData->arena = new_arena;
+        handleData->arena_capacity = new_capacity;
+        result = 0;
+    }
+
+    return result;
+}
+
+// Returns the offset of `size` free bytes in the arena, or ARENA_NO_VALUE.
+// Offsets stay valid across calls. Pointers into the arena keep pointing at the data as it was before a growth.
+static size_t reserve_arena(IOTHUB_MESSAGE_HANDLE_DATA* handleData, size_t size, size_t alignment)
+{
+    size_t result;
+
+    if (align_offset(handleData->arena_size, alignment) + size > handleData->arena_capacity &&
+        grow_arena(handleData, size + alignment) != 0)
+    {
+        result = ARENA_NO_VALUE;
+    }
+    else
+    {
+        result = align_offset(handleData->arena_size, alignment);
+        handleData->arena_size = result + size;
+    }
+
+    return result;
+}
+
+static size_t store_string(IOTHUB_MESSAGE_HANDLE_DATA* handleData, const char* value)
+{
+    size_t result;
+    size_t length = strlen(value) + 1;
+
+    if ((result = reserve_arena(handleData, length, 1)) != ARENA_NO_VALUE)
+    {
+        (void)memcpy(handleData->arena + result, value, length);
+    }
+
+    return result;
+}
+
+// Appends the new value rather than overwriting the current one, which a getter may have handed out.
+// The old bytes become dead and are dropped by the next growth.
+static int replace_string(IOTHUB_MESSAGE_HANDLE_DATA* handleData, size_t* offset, const char* value)
+{
+    int result;
+    size_t new_offset = store_string(handleData, value);
+
+    if (new_offset == ARENA_NO_VALUE)
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        *offset = new_offset;
+        result = 0;
+    }
+
+    return result;
+}
+
+static const char* get_arena_string(const IOTHUB_MESSAGE_HANDLE_DATA* handleData, size_t offset)
+{
+    return (offset == ARENA_NO_VALUE ? NULL : (const char*)handleData->arena + offset);
+}
+
+static MESSAGE_PROPERTY* get_property_table(const IOTHUB_MESSAGE_HANDLE_DATA* handleData)
+{
+    return (MESSAGE_PROPERTY*)(handleData->arena + handleData->property_table);
+}
+
+// FNV-1a
+static size_t hash_key(const char* key)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*key != '\0')
+    {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+
+    return (size_t)hash;
+}
+
+static size_t find_property(const IOTHUB_MESSAGE_HANDLE_DATA* handleData, const char* key, size_t hash)
+{
+    size_t result = ARENA_NO_VALUE;
+
+    if (handleData->property_count > 0)
+    {
+        const MESSAGE_PROPERTY* table = get_property_table(handleData);
+
+        // Codes_SRS_IOTHUBMESSAGE_09_118: [Once a message has 8 application properties, they shall be looked up through a hash index stored in the arena.]
+        if (handleData->property_index != ARENA_NO_VALUE)
+        {
+            const size_t* buckets = (const size_t*)(handleData->arena + handleData->property_index);
+            size_t mask = handleData->property_index_capacity - 1;
+            size_t bucket = hash & mask;
+
+            while (buckets[bucket] != 0)
+            {
+                const MESSAGE_PROPERTY* property = &table[buckets[bucket] - 1];
+
+                if (property->hash == hash && strcmp((const char*)handleData->arena + property->key, key) == 0)
+                {
+                    result = buckets[bucket] - 1;
+                    break;
+                }
+
+                bucket = (bucket + 1) & mask;
+            }
+        }
+        else
+        {
+            size_t i;
+
+            for (i = 0; i < handleData->property_count; i++)
+            {
+                if (table[i].hash == hash && strcmp((const char*)handleData->arena + table[i].key, key) == 0)
+                {
+                    result = i;
+                    break;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+static void insert_property_index(IOTHUB_MESSAGE_HANDLE_DATA* handleData, size_t property)
+{
+    size_t* buckets = (size_t*)(handleData->arena + handleData->property_index);
+    size_t mask = handleData->property_index_capacity - 1;
+    size_t bucket = get_property_table(handleData)[property].hash & mask;
+
+    while (buckets[bucket] != 0)
+    {
+        bucket = (bucket + 1) & mask;
+    }
+
+    buckets[bucket] = property + 1;
+}
+
+// Called after properties are appended to the table
+static void update_property_index(IOTHUB_MESSAGE_HANDLE_DATA* handleData, size_t first_new_property)
+{
+    size_t i;
+
+    if (handleData->property_index != ARENA_NO_VALUE && handleData->property_index_capacity >= 2 * handleData->property_capacity)
+    {
+        for (i = first_new_property; i < handleData->property_count; i++)
+        {
+            insert_property_index(handleData, i);
+        }
+    }
+    else if (handleData->property_count >= PROPERTY_INDEX_THRESHOLD)
+    {
+        size_t capacity = 2 * handleData->property_capacity;
+        size_t index;
+
+        // Dropped first so a growth of the arena does not copy the outdated index
+        handleData->property_index = ARENA_NO_VALUE;
+        handleData->property_index_capacity = 0;
+
+        // Codes_SRS_IOTHUBMESSAGE_09_119: [If the index cannot be built, properties shall be looked up by a linear search.]
+        if ((index = reserve_arena(handleData, capacity * sizeof(size_t), sizeof(size_t))) == ARENA_NO_VALUE)
+        {
+            LogError("Failed building the property index, falling back to linear lookup");
+        }
+        else
+        {
+            (void)memset(handleData->arena + index, 0, capacity * sizeof(size_t));
+            handleData->property_index = index;
+            handleData->property_index_capacity = capacity;
+
+            for (i = 0; i < handleData->property_count; i++)
+            {
+                insert_property_index(handleData, i);
+            }
+        }
+    }
+}
+
+// The property table grows by doubling, so the index capacity stays a power of 2
+static size_t get_property_capacity(const IOTHUB_MESSAGE_HANDLE_DATA* handleData, size_t needed)
+{
+    size_t result = (handleData->property_capacity == 0 ? INITIAL_PROPERTY_CAPACITY : handleData->property_capacity);
+
+    while (result < needed)
+    {
+        result *= 2;
+    }
+
+    return result;
+}
+
+// Grows the property table to hold `needed` properties
+static int ensure_property_capacity(IOTHUB_MESSAGE_HANDLE_DATA* handleData, size_t needed)
+{
+    int result;
+
+    if (needed <= handleData->property_capacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        size_t new_capacity = get_property_capacity(handleData, needed);
+        size_t new_table;
+
+        if ((new_table = reserve_arena(handleData, new_capacity * sizeof(MESSAGE_PROPERTY), sizeof(size_t))) == ARENA_NO_VALUE)
+        {
+            LogError("Failed growing the property table");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            if (handleData->property_count > 0)
+            {
+                (void)memcpy(handleData->arena + new_table, get_property_table(handleData), handleData->property_count * sizeof(MESSAGE_PROPERTY));
+            }
+
+            handleData->property_table = new_table;
+            handleData->property_capacity = new_capacity;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+// Appends a property to a table that has room for it
+static int append_property(IOTHUB_MESSAGE_HANDLE_DATA* handleData, const char* key, const char* value, size_t hash)
+{
+    int result;
+    size_t key_length = strlen(key) + 1;
+    size_t value_length = strlen(value) + 1;
+    // Key and value are reserved together, as a growth in between would move the key
+    size_t key_offset = reserve_arena(handleData, key_length + value_length, 1);
+
+    if (key_offset == ARENA_NO_VALUE)
+    {
+        LogError("Failed storing the property");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        MESSAGE_PROPERTY* table = get_property_table(handleData);
+
+        (void)memcpy(handleData->arena + key_offset, key, key_length);
+        (void)memcpy(handleData->arena + key_offset + key_length, value, value_length);
+
+        table[handleData->property_count].key = key_offset;
+        table[handleData->property_count].value = key_offset + key_length;
+        table[handleData->property_count].hash = hash;
+        handleData->property_count++;
+        result = 0;
+    }
+
+    return result;
+}
+
+// Sets one property whose key and value are not stored in this message's arena
+static int set_property(IOTHUB_MESSAGE_HANDLE_DATA* handleData, const char* key, const char* value)
+{
+    int result;
+    size_t hash = hash_key(key);
+    size_t index = find_property(handleData, key, hash);
+
+    if (index == ARENA_NO_VALUE)
+    {
+        size_t first_new_property = handleData->property_count;
+
+        // Codes_SRS_IOTHUBMESSAGE_09_107: [New properties shall be appended to the property table in the arena.]
+        if (ensure_property_capacity(handleData, handleData->property_count + 1) != 0 ||
+            append_property(handleData, key, value, hash) != 0)
+        {
+            result = MU_FAILURE;
+        }
+        else
+        {
+            update_property_index(handleData, first_new_property);
+            result = 0;
+        }
+    }
+    else
+    {
+        size_t value_offset = get_property_table(handleData)[index].value;
+
+        // Codes_SRS_IOTHUBMESSAGE_09_108: [The value of an existing property shall be replaced the same way as a system property.]
+        if (replace_string(handleData, &value_offset, value) != 0)
+        {
+            result = MU_FAILURE;
+        }
+        else
+        {
+            get_property_table(handleData)[index].value = value_offset;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+// Makes room for `count` more properties and their strings, so setting them grows the arena at most once
+static int reserve_properties(IOTHUB_MESSAGE_HANDLE_DATA* handleData, const char* const* keys, const char* const* values, size_t count)
+{
+    int result;
+    size_t needed = handleData->property_count + count;
+    size_t property_capacity = get_property_capacity(handleData, needed);
+    size_t reserved_size = 0;
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        reserved_size += strlen(keys[i]) + strlen(values[i]) + 2;
+    }
+
+    // Room for the new property table and for the index update_property_index will build, if any
+    if (property_capacity > handleData->property_capacity)
+    {
+        reserved_size += (property_capacity + 1) * sizeof(MESSAGE_PROPERTY);
+    }
+
+    if (needed >= PROPERTY_INDEX_THRESHOLD && handleData->property_index_capacity < 2 * property_capacity)
+    {
+        reserved_size += (2 * property_capacity + 1) * sizeof(size_t);
+    }
+
+    if (handleData->arena_size + reserved_size > handleData->arena_capacity && grow_arena(handleData, reserved_size) != 0)
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = ensure_property_capacity(handleData, needed);
+    }
+
+    return result;
+}
+
+static IOTHUB_MESSAGE_HANDLE_DATA* allocate_message(size_t arena_capacity)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_100: [The message, its properties and bodies of up to 512 bytes shall be stored in a single allocation.]
+    if ((result = (IOTHUB_MESSAGE_HANDLE_DATA*)malloc(sizeof(IOTHUB_MESSAGE_HANDLE_DATA) + arena_capacity)) == NULL)
+    {
+        LogError("unable to malloc");
+    }
+    else
+    {
+        size_t i;
+
+        memset(result, 0, sizeof(IOTHUB_MESSAGE_HANDLE_DATA));
+        result->arena = INLINE_ARENA(result);
+        result->arena_capacity = arena_capacity;
+        result->body = ARENA_NO_VALUE;
+        result->property_table = ARENA_NO_VALUE;
+        result->property_index = ARENA_NO_VALUE;
+
+        for (i = 0; i < SYSTEM_PROPERTY_COUNT; i++)
+        {
+            result->system_properties[i] = ARENA_NO_VALUE;
+        }
+    }
+
+    return result;
+}
+
+static IOTHUB_MESSAGE_HANDLE_DATA* create_message(IOTHUBMESSAGE_CONTENT_TYPE contentType, const unsigned char* body, size_t body_size)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result;
+    size_t stored_size = body_size + (contentType == IOTHUBMESSAGE_STRING ? 1 : 0);
+    bool is_inline = (body_size <= INLINE_BODY_MAX_SIZE);
+
+    if ((result = allocate_message((is_inline ? stored_size : 0) + ARENA_INITIAL_FREE_SPACE)) != NULL)
+    {
+        result->contentType = contentType;
+        result->body_size = body_size;
+
+        if (is_inline)
+        {
+            result->body = 0;
+            result->arena_size = stored_size;
+
+            if (body_size > 0)
+            {
+                (void)memcpy(result->arena, body, body_size);
+            }
+
+            if (contentType == IOTHUBMESSAGE_STRING)
+            {
+                result->arena[body_size] = '\0';
+            }
+        }
+        // Codes_SRS_IOTHUBMESSAGE_09_101: [Bodies larger than 512 bytes shall be stored in their own allocation.]
+        else if ((result->external_body = (unsigned char*)malloc(stored_size)) == NULL)
+        {
+            LogError("Failed allocating the message body");
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            (void)memcpy(result->external_body, body, body_size);
+
+            if (contentType == IOTHUBMESSAGE_STRING)
+            {
+                result->external_body[body_size] = '\0';
+            }
+        }
+    }
+
+    return result;
+}
+
+static const unsigned char* get_body(const IOTHUB_MESSAGE_HANDLE_DATA* handleData)
+{
+    return (handleData->body != ARENA_NO_VALUE ? handleData->arena + handleData->body : handleData->external_body);
+}
+
+static IOTHUB_MESSAGE_RESULT set_system_property(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, SYSTEM_PROPERTY property, const char* value)
+{
+    IOTHUB_MESSAGE_RESULT result;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_102: [A new value of a system property shall be appended to the arena, leaving the previous value untouched.]
+    if (replace_string(iotHubMessageHandle, &iotHubMessageHandle->system_properties[property], value) != 0)
+    {
+        LogError("Failed saving a copy of the system property");
+        result = IOTHUB_MESSAGE_ERROR;
+    }
+    else
+    {
+        result = IOTHUB_MESSAGE_OK;
+    }
+
+    return result;
+}
+
+
+// ========== Public API ========== //
+
+IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromByteArray(const unsigned char* byteArray, size_t size)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result;
+    /*Codes_SRS_IOTHUBMESSAGE_06_002: [If size is NOT zero then byteArray MUST NOT be NULL*/
+    if ((byteArray == NULL) && (size != 0))
+    {
+        LogError("Invalid argument - byteArray is NULL");
+        result = NULL;
+    }
+    /*Codes_SRS_IOTHUBMESSAGE_02_026: [The type of the new message shall be IOTHUBMESSAGE_BYTEARRAY.] */
+    else if ((result = create_message(IOTHUBMESSAGE_BYTEARRAY, byteArray, size)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_02_024: [If there are any errors then IoTHubMessage_CreateFromByteArray shall return NULL.] */
+        LogError("Failed creating the message");
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromString(const char* source)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result;
+    if (source == NULL)
+    {
+        LogError("Invalid argument - source is NULL");
+        result = NULL;
+    }
+    /*Codes_SRS_IOTHUBMESSAGE_02_032: [The type of the new message shall be IOTHUBMESSAGE_STRING.] */
+    else if ((result = create_message(IOTHUBMESSAGE_STRING, (const unsigned char*)source, strlen(source))) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_02_029: [If there are any encountered in the execution of IoTHubMessage_CreateFromString then IoTHubMessage_CreateFromString shall return NULL.] */
+        LogError("Failed creating the message");
+    }
+    return result;
+}
+
+/*Codes_SRS_IOTHUBMESSAGE_03_001: [IoTHubMessage_Clone shall create a new IoT hub message with data content identical to that of the iotHubMessageHandle parameter.]*/
+IOTHUB_MESSAGE_HANDLE IoTHubMessage_Clone(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result;
+    const IOTHUB_MESSAGE_HANDLE_DATA* source = (const IOTHUB_MESSAGE_HANDLE_DATA*)iotHubMessageHandle;
+    /* Codes_SRS_IOTHUBMESSAGE_03_005: [IoTHubMessage_Clone shall return NULL if iotHubMessageHandle is NULL.] */
+    if (source == NULL)
+    {
+        result = NULL;
+        LogError("iotHubMessageHandle parameter cannot be NULL for IoTHubMessage_Clone");
+    }
+    // Codes_SRS_IOTHUBMESSAGE_09_103: [IoTHubMessage_Clone shall copy only the live data of the source arena into a single new allocation.]
+    else if ((result = allocate_message(compact_arena(source, NULL, NULL) + ARENA_INITIAL_FREE_SPACE)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
+        LogError("unable to malloc");
+    }
+    else
+    {
+        result->contentType = source->contentType;
+        result->is_security_message = source->is_security_message;
+        result->body_size = source->body_size;
+        result->property_count = source->property_count;
+        result->property_capacity = source->property_capacity;
+        result->property_index_capacity = source->property_index_capacity;
+        result->arena_size = compact_arena(source, result, result->arena);
+
+        if (source->external_body != NULL &&
+            (result->external_body = (unsigned char*)malloc(source->body_size + (source->contentType == IOTHUBMESSAGE_STRING ? 1 : 0))) == NULL)
+        {
+            /*Codes_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
+            LogError("unable to copy the message body");
+            free(result);
+            result = NULL;
+        }
+        /*Codes_SRS_IOTHUBMESSAGE_02_005: [IoTHubMessage_Clone shall clone the properties map by using Map_Clone.] */
+        else if (source->properties != NULL && (result->properties = Map_Clone(source->properties)) == NULL)
+        {
+            /*Codes_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
+            LogError("unable to Map_Clone");
+            free(result->external_body);
+            free(result);
+            result = NULL;
+        }
+        else if (source->external_body != NULL)
+        {
+            (void)memcpy(result->external_body, source->external_body, source->body_size + (source->contentType == IOTHUBMESSAGE_STRING ? 1 : 0));
+        }
+        /*Codes_SRS_IOTHUBMESSAGE_03_002: [IoTHubMessage_Clone shall return upon success a non-NULL handle to the newly created IoT hub message.]*/
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_GetByteArray(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const unsigned char** buffer, size_t* size)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    if (
+        (iotHubMessageHandle == NULL) ||
+        (buffer == NULL) ||
+        (size == NULL)
+        )
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_01_014: [If any of the arguments passed to IoTHubMessage_GetByteArray  is NULL IoTHubMessage_GetByteArray shall return IOTHUBMESSAGE_INVALID_ARG.] */
+        LogError("invalid parameter (NULL) to IoTHubMessage_GetByteArray IOTHUB_MESSAGE_HANDLE iotHubMessageHandle=%p, const unsigned char** buffer=%p, size_t* size=%p", iotHubMessageHandle, buffer, size);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else if (iotHubMessageHandle->contentType != IOTHUBMESSAGE_BYTEARRAY)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_02_021: [If iotHubMessageHandle is not a iothubmessage containing BYTEARRAY data, then IoTHubMessage_GetData shall write in *buffer NULL and shall set *size to 0.] */
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+        LogError("invalid type of message %s", MU_ENUM_TO_STRING(IOTHUBMESSAGE_CONTENT_TYPE, iotHubMessageHandle->contentType));
+    }
+    else
+    {
+        *buffer = get_body(iotHubMessageHandle);
+        *size = iotHubMessageHandle->body_size;
+        result = IOTHUB_MESSAGE_OK;
+    }
+    return result;
+}
+
+const char* IoTHubMessage_GetString(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    const char* result;
+    /*Codes_SRS_IOTHUBMESSAGE_02_016: [If any parameter is NULL then IoTHubMessage_GetString  shall return NULL.] */
+    /*Codes_SRS_IOTHUBMESSAGE_02_017: [IoTHubMessage_GetString shall return NULL if the iotHubMessageHandle does not refer to a IOTHUBMESSAGE of type STRING.] */
+    if (iotHubMessageHandle == NULL || iotHubMessageHandle->contentType != IOTHUBMESSAGE_STRING)
+    {
+        result = NULL;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_02_018: [IoTHubMessage_GetStringData shall return the currently stored null terminated string.] */
+        result = (const char*)get_body(iotHubMessageHandle);
+    }
+    return result;
+}
+
+IOTHUBMESSAGE_CONTENT_TYPE IoTHubMessage_GetContentType(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    IOTHUBMESSAGE_CONTENT_TYPE result;
+    /*Codes_SRS_IOTHUBMESSAGE_02_008: [If any parameter is NULL then IoTHubMessage_GetContentType shall return IOTHUBMESSAGE_UNKNOWN.] */
+    if (iotHubMessageHandle == NULL)
+    {
+        result = IOTHUBMESSAGE_UNKNOWN;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_02_009: [Otherwise IoTHubMessage_GetContentType shall return the type of the message.] */
+        result = iotHubMessageHandle->contentType;
+    }
+    return result;
+}
+
+MAP_HANDLE IoTHubMessage_Properties(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    MAP_HANDLE result;
+    /*Codes_SRS_IOTHUBMESSAGE_02_001: [If iotHubMessageHandle is NULL then IoTHubMessage_Properties shall return NULL.]*/
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("invalid arg (NULL) passed to IoTHubMessage_Properties");
+        result = NULL;
+    }
+    else if (iotHubMessageHandle->properties != NULL)
+    {
+        result = iotHubMessageHandle->properties;
+    }
+    // Codes_SRS_IOTHUBMESSAGE_09_104: [The first call to IoTHubMessage_Properties shall create a map with the application properties of the message; from then on the map shall hold them.]
+    else if ((result = Map_Create(ValidateAsciiCharactersFilter)) == NULL)
+    {
+        LogError("Map_Create for properties failed");
+    }
+    else
+    {
+        size_t i;
+
+        for (i = 0; i < iotHubMessageHandle->property_count; i++)
+        {
+            const MESSAGE_PROPERTY* table = get_property_table(iotHubMessageHandle);
+
+            if (Map_AddOrUpdate(result, get_arena_string(iotHubMessageHandle, table[i].key), get_arena_string(iotHubMessageHandle, table[i].value)) != MAP_OK)
+            {
+                // Codes_SRS_IOTHUBMESSAGE_09_105: [If the map cannot be filled, IoTHubMessage_Properties shall return NULL and keep the properties in the arena.]
+                LogError("Failed copying the message properties into a map");
+                Map_Destroy(result);
+                result = NULL;
+                break;
+            }
+        }
+
+        if (result != NULL)
+        {
+            iotHubMessageHandle->properties = result;
+            iotHubMessageHandle->property_count = 0;
+            iotHubMessageHandle->property_index = ARENA_NO_VALUE;
+            iotHubMessageHandle->property_index_capacity = 0;
+        }
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetProperty(IOTHUB_MESSAGE_HANDLE msg_handle, const char* key, const char* value)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    if (msg_handle == NULL || key == NULL || value == NULL)
+    {
+        LogError("invalid parameter (NULL) to IoTHubMessage_SetProperty iotHubMessageHandle=%p, key=%p, value=%p", msg_handle, key, value);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else if (msg_handle->properties != NULL)
+    {
+        if (Map_AddOrUpdate(msg_handle->properties, key, value) != MAP_OK)
+        {
+            LogError("Failure adding property to internal map");
+            result = IOTHUB_MESSAGE_ERROR;
+        }
+        else
+        {
+            result = IOTHUB_MESSAGE_OK;
+        }
+    }
+    // Codes_SRS_IOTHUBMESSAGE_09_106: [IoTHubMessage_SetProperty shall reject keys and values that are not printable US-Ascii with IOTHUB_MESSAGE_ERROR.]
+    else if (ValidateAsciiCharactersFilter(key, value) != 0)
+    {
+        LogError("Failure adding property (invalid characters)");
+        result = IOTHUB_MESSAGE_ERROR;
+    }
+    else if (set_property(msg_handle, key, value) != 0)
+    {
+        LogError("Failure adding property");
+        result = IOTHUB_MESSAGE_ERROR;
+    }
+    else
+    {
+        result = IOTHUB_MESSAGE_OK;
+    }
+
+    return result;
+}
+
+const char* IoTHubMessage_GetProperty(IOTHUB_MESSAGE_HANDLE msg_handle, const char* key)
+{
+    const char* result;
+    if (msg_handle == NULL || key == NULL)
+    {
+        LogError("invalid parameter (NULL) to IoTHubMessage_GetProperty iotHubMessageHandle=%p, key=%p", msg_handle, key);
+        result = NULL;
+    }
+    else if (msg_handle->properties != NULL)
+    {
+        bool key_exists = false;
+        // The return value is not neccessary, just check the key_exist variable
+        if ((Map_ContainsKey(msg_handle->properties, key, &key_exists) == MAP_OK) && key_exists)
+        {
+            result = Map_GetValueFromKey(msg_handle->properties, key);
+        }
+        else
+        {
+            result = NULL;
+        }
+    }
+    else
+    {
+        size_t index = find_property(msg_handle, key, hash_key(key));
+        result = (index == ARENA_NO_VALUE ? NULL : get_arena_string(msg_handle, get_property_table(msg_handle)[index].value));
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetProperties(IOTHUB_MESSAGE_HANDLE msg_handle, const char* const* keys, const char* const* values, size_t count)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    size_t i;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_110: [If `msg_handle` is NULL, or `keys` or `values` is NULL while `count` is not 0, or any key or value is NULL, IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_INVALID_ARG without setting any property.]
+    if (msg_handle == NULL || (count > 0 && (keys == NULL || values == NULL)))
+    {
+        LogError("invalid parameter to IoTHubMessage_SetProperties iotHubMessageHandle=%p, keys=%p, values=%p, count=%lu", msg_handle, keys, values, (unsigned long)count);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        result = IOTHUB_MESSAGE_OK;
+
+        for (i = 0; i < count; i++)
+        {
+            if (keys[i] == NULL || values[i] == NULL)
+            {
+                LogError("invalid parameter (NULL) to IoTHubMessage_SetProperties at index %lu", (unsigned long)i);
+                result = IOTHUB_MESSAGE_INVALID_ARG;
+                break;
+            }
+            // Codes_SRS_IOTHUBMESSAGE_09_106: [IoTHubMessage_SetProperty shall reject keys and values that are not printable US-Ascii with IOTHUB_MESSAGE_ERROR.]
+            else if (msg_handle->properties == NULL && ValidateAsciiCharactersFilter(keys[i], values[i]) != 0)
+            {
+                LogError("Failure adding property %lu (invalid characters)", (unsigned long)i);
+                result = IOTHUB_MESSAGE_ERROR;
+                break;
+            }
+        }
+
+        if (result != IOTHUB_MESSAGE_OK)
+        {
+            // Error already logged
+        }
+        else if (msg_handle->properties != NULL)
+        {
+            for (i = 0; i < count && result == IOTHUB_MESSAGE_OK; i++)
+            {
+                // Codes_SRS_IOTHUBMESSAGE_09_111: [IoTHubMessage_SetProperties shall set each key and value, in order, as IoTHubMessage_SetProperty does.]
+                if (Map_AddOrUpdate(msg_handle->properties, keys[i], values[i]) != MAP_OK)
+                {
+                    // Codes_SRS_IOTHUBMESSAGE_09_112: [If a property cannot be set, IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_ERROR and keep the properties set before it.]
+                    LogError("Failure adding property %s to internal map", keys[i]);
+                    result = IOTHUB_MESSAGE_ERROR;
+                }
+            }
+        }
+        // Codes_SRS_IOTHUBMESSAGE_09_120: [IoTHubMessage_SetProperties shall reserve room in the arena for all the properties before copying them.]
+        else if (reserve_properties(msg_handle, keys, values, count) != 0)
+        {
+            LogError("Failure reserving room for %lu properties", (unsigned long)count);
+            result = IOTHUB_MESSAGE_ERROR;
+        }
+        else
+        {
+            for (i = 0; i < count && result == IOTHUB_MESSAGE_OK; i++)
+            {
+                // Codes_SRS_IOTHUBMESSAGE_09_111: [IoTHubMessage_SetProperties shall set each key and value, in order, as IoTHubMessage_SetProperty does.]
+                if (set_property(msg_handle, keys[i], values[i]) != 0)
+                {
+                    // Codes_SRS_IOTHUBMESSAGE_09_112: [If a property cannot be set, IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_ERROR and keep the properties set before it.]
+                    LogError("Failure adding property %s", keys[i]);
+                    result = IOTHUB_MESSAGE_ERROR;
+                }
+            }
+        }
+        // Codes_SRS_IOTHUBMESSAGE_09_113: [IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_OK if all properties are set.]
+    }
+
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_GetProperties(IOTHUB_MESSAGE_HANDLE msg_handle, const char* const* keys, const char** values, size_t count)
+{
+    IOTHUB_MESSAGE_RESULT result;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_114: [If `msg_handle` is NULL, or `keys` or `values` is NULL while `count` is not 0, IoTHubMessage_GetProperties shall return IOTHUB_MESSAGE_INVALID_ARG.]
+    if (msg_handle == NULL || (count > 0 && (keys == NULL || values == NULL)))
+    {
+        LogError("invalid parameter to IoTHubMessage_GetProperties iotHubMessageHandle=%p, keys=%p, values=%p, count=%lu", msg_handle, keys, values, (unsigned long)count);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else if (msg_handle->properties != NULL)
+    {
+        const char* const* map_keys;
+        const char* const* map_values;
+        size_t map_count;
+
+        if (Map_GetInternals(msg_handle->properties, &map_keys, &map_values, &map_count) != MAP_OK)
+        {
+            LogError("Failure reading the properties map");
+            result = IOTHUB_MESSAGE_ERROR;
+        }
+        else
+        {
+            size_t i;
+            size_t j;
+
+            // Codes_SRS_IOTHUBMESSAGE_09_115: [IoTHubMessage_GetProperties shall set `values[i]` to the value of the property `keys[i]`, or NULL if it does not exist, without allocating memory.]
+            for (i = 0; i < count; i++)
+            {
+                values[i] = NULL;
+
+                for (j = 0; keys[i] != NULL && j < map_count; j++)
+                {
+                    if (strcmp(map_keys[j], keys[i]) == 0)
+                    {
+                        values[i] = map_values[j];
+                        break;
+                    }
+                }
+            }
+
+            // Codes_SRS_IOTHUBMESSAGE_09_116: [IoTHubMessage_GetProperties shall return IOTHUB_MESSAGE_OK.]
+            result = IOTHUB_MESSAGE_OK;
+        }
+    }
+    else
+    {
+        size_t i;
+
+        // Codes_SRS_IOTHUBMESSAGE_09_115: [IoTHubMessage_GetProperties shall set `values[i]` to the value of the property `keys[i]`, or NULL if it does not exist, without allocating memory.]
+        for (i = 0; i < count; i++)
+        {
+            size_t index = (keys[i] == NULL ? ARENA_NO_VALUE : find_property(msg_handle, keys[i], hash_key(keys[i])));
+            values[i] = (index == ARENA_NO_VALUE ? NULL : get_arena_string(msg_handle, get_property_table(msg_handle)[index].value));
+        }
+
+        // Codes_SRS_IOTHUBMESSAGE_09_116: [IoTHubMessage_GetProperties shall return IOTHUB_MESSAGE_OK.]
+        result = IOTHUB_MESSAGE_OK;
+    }
+
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_GetPropertyCount(IOTHUB_MESSAGE_HANDLE msg_handle, size_t* count)
+{
+    IOTHUB_MESSAGE_RESULT result;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_122: [If `msg_handle` or `count` is NULL, IoTHubMessage_GetPropertyCount shall return IOTHUB_MESSAGE_INVALID_ARG.]
+    if (msg_handle == NULL || count == NULL)
+    {
+        LogError("invalid parameter (NULL) to IoTHubMessage_GetPropertyCount iotHubMessageHandle=%p, count=%p", msg_handle, count);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else if (msg_handle->properties != NULL)
+    {
+        const char* const* map_keys;
+        const char* const* map_values;
+
+        if (Map_GetInternals(msg_handle->properties, &map_keys, &map_values, count) != MAP_OK)
+        {
+            LogError("Failure reading the properties map");
+            result = IOTHUB_MESSAGE_ERROR;
+        }
+        else
+        {
+            result = IOTHUB_MESSAGE_OK;
+        }
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_09_123: [IoTHubMessage_GetPropertyCount shall set `*count` to the number of application properties of the message without creating a properties map.]
+        *count = msg_handle->property_count;
+        result = IOTHUB_MESSAGE_OK;
+    }
+
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_GetPropertyAt(IOTHUB_MESSAGE_HANDLE msg_handle, size_t index, const char** key, const char** value)
+{
+    IOTHUB_MESSAGE_RESULT result;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_124: [If `msg_handle`, `key` or `value` is NULL, or `index` is not lower than the count returned by IoTHubMessage_GetPropertyCount, IoTHubMessage_GetPropertyAt shall return IOTHUB_MESSAGE_INVALID_ARG.]
+    if (msg_handle == NULL || key == NULL || value == NULL)
+    {
+        LogError("invalid parameter (NULL) to IoTHubMessage_GetPropertyAt iotHubMessageHandle=%p, key=%p, value=%p", msg_handle, key, value);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else if (msg_handle->properties != NULL)
+    {
+        const char* const* map_keys;
+        const char* const* map_values;
+        size_t map_count;
+
+        if (Map_GetInternals(msg_handle->properties, &map_keys, &map_values, &map_count) != MAP_OK)
+        {
+            LogError("Failure reading the properties map");
+            result = IOTHUB_MESSAGE_ERROR;
+        }
+        else if (index >= map_count)
+        {
+            LogError("property index %lu out of range (%lu properties)", (unsigned long)index, (unsigned long)map_count);
+            result = IOTHUB_MESSAGE_INVALID_ARG;
+        }
+        else
+        {
+            *key = map_keys[index];
+            *value = map_values[index];
+            result = IOTHUB_MESSAGE_OK;
+        }
+    }
+    else if (index >= msg_handle->property_count)
+    {
+        LogError("property index %lu out of range (%lu properties)", (unsigned long)index, (unsigned long)msg_handle->property_count);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        const MESSAGE_PROPERTY* table = get_property_table(msg_handle);
+
+        // Codes_SRS_IOTHUBMESSAGE_09_125: [IoTHubMessage_GetPropertyAt shall set `*key` and `*value` to the application property at `index`, in the order the properties were added, without allocating memory.]
+        *key = get_arena_string(msg_handle, table[index].key);
+        *value = get_arena_string(msg_handle, table[index].value);
+        result = IOTHUB_MESSAGE_OK;
+    }
+
+    return result;
+}
+
+const char* IoTHubMessage_GetCorrelationId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    const char* result;
+    /* Codes_SRS_IOTHUBMESSAGE_07_016: [if the iotHubMessageHandle parameter is NULL then IoTHubMessage_GetCorrelationId shall return a NULL value.] */
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("invalid arg (NULL) passed to IoTHubMessage_GetCorrelationId");
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUBMESSAGE_07_017: [IoTHubMessage_GetCorrelationId shall return the correlationId as a const char*.] */
+        result = get_arena_string(iotHubMessageHandle, iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_CORRELATION_ID]);
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetCorrelationId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* correlationId)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    /* Codes_SRS_IOTHUBMESSAGE_07_018: [if any of the parameters are NULL then IoTHubMessage_SetCorrelationId shall return a IOTHUB_MESSAGE_INVALID_ARG value.]*/
+    if (iotHubMessageHandle == NULL || correlationId == NULL)
+    {
+        LogError("invalid arg (NULL) passed to IoTHubMessage_SetCorrelationId");
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUBMESSAGE_07_020: [If the allocation or the copying of the correlationId fails, then IoTHubMessage_SetCorrelationId shall return IOTHUB_MESSAGE_ERROR.] */
+        /* Codes_SRS_IOTHUBMESSAGE_07_021: [IoTHubMessage_SetCorrelationId finishes successfully it shall return IOTHUB_MESSAGE_OK.] */
+        result = set_system_property(iotHubMessageHandle, SYSTEM_PROPERTY_CORRELATION_ID, correlationId);
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetMessageId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* messageId)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    /* Codes_SRS_IOTHUBMESSAGE_07_012: [if any of the parameters are NULL then IoTHubMessage_SetMessageId shall return a IOTHUB_MESSAGE_INVALID_ARG value.] */
+    if (iotHubMessageHandle == NULL || messageId == NULL)
+    {
+        LogError("invalid arg (NULL) passed to IoTHubMessage_SetMessageId");
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUBMESSAGE_07_014: [If the allocation or the copying of the messageId fails, then IoTHubMessage_SetMessageId shall return IOTHUB_MESSAGE_ERROR.] */
+        result = set_system_property(iotHubMessageHandle, SYSTEM_PROPERTY_MESSAGE_ID, messageId);
+    }
+    return result;
+}
+
+const char* IoTHubMessage_GetMessageId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    const char* result;
+    /* Codes_SRS_IOTHUBMESSAGE_07_010: [if the iotHubMessageHandle parameter is NULL then IoTHubMessage_MessageId shall return a NULL value.] */
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("invalid arg (NULL) passed to IoTHubMessage_GetMessageId");
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUBMESSAGE_07_011: [IoTHubMessage_MessageId shall return the messageId as a const char*.] */
+        result = get_arena_string(iotHubMessageHandle, iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_MESSAGE_ID]);
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetContentTypeSystemProperty(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* contentType)
+{
+    IOTHUB_MESSAGE_RESULT result;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_001: [If any of the parameters are NULL then IoTHubMessage_SetContentTypeSystemProperty shall return a IOTHUB_MESSAGE_INVALID_ARG value.]
+    if (iotHubMessageHandle == NULL || contentType == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle=%p, contentType=%p)", iotHubMessageHandle, contentType);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_09_003: [If the allocation or the copying of `contentType` fails, then IoTHubMessage_SetContentTypeSystemProperty shall return IOTHUB_MESSAGE_ERROR.]
+        // Codes_SRS_IOTHUBMESSAGE_09_004: [If IoTHubMessage_SetContentTypeSystemProperty finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+        result = set_system_property(iotHubMessageHandle, SYSTEM_PROPERTY_CONTENT_TYPE, contentType);
+    }
+
+    return result;
+}
+
+const char* IoTHubMessage_GetContentTypeSystemProperty(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    const char* result;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_005: [If any of the parameters are NULL then IoTHubMessage_GetContentTypeSystemProperty shall return a IOTHUB_MESSAGE_INVALID_ARG value.]
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle is NULL)");
+        result = NULL;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_09_006: [IoTHubMessage_GetContentTypeSystemProperty shall return the `contentType` as a const char* ]
+        result = get_arena_string(iotHubMessageHandle, iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_CONTENT_TYPE]);
+    }
+
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetContentEncodingSystemProperty(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* contentEncoding)
+{
+    IOTHUB_MESSAGE_RESULT result;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_006: [If any of the parameters are NULL then IoTHubMessage_SetContentEncodingSystemProperty shall return a IOTHUB_MESSAGE_INVALID_ARG value.]
+    if (iotHubMessageHandle == NULL || contentEncoding == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle=%p, contentEncoding=%p)", iotHubMessageHandle, contentEncoding);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_09_008: [If the allocation or the copying of `contentEncoding` fails, then IoTHubMessage_SetContentEncodingSystemProperty shall return IOTHUB_MESSAGE_ERROR.]
+        // Codes_SRS_IOTHUBMESSAGE_09_009: [If IoTHubMessage_SetContentEncodingSystemProperty finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+        result = set_system_property(iotHubMessageHandle, SYSTEM_PROPERTY_CONTENT_ENCODING, contentEncoding);
+    }
+    return result;
+}
+
+const char* IoTHubMessage_GetContentEncodingSystemProperty(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    const char* result;
+
+    // Codes_SRS_IOTHUBMESSAGE_09_010: [If any of the parameters are NULL then IoTHubMessage_GetContentEncodingSystemProperty shall return a IOTHUB_MESSAGE_INVALID_ARG value.]
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle is NULL)");
+        result = NULL;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_09_011: [IoTHubMessage_GetContentEncodingSystemProperty shall return the `contentEncoding` as a const char* ]
+        result = get_arena_string(iotHubMessageHandle, iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_CONTENT_ENCODING]);
+    }
+
+    return result;
+}
+
+const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA* IoTHubMessage_GetDiagnosticPropertyData(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA* result;
+    // Codes_SRS_IOTHUBMESSAGE_10_001: [If any of the parameters are NULL then IoTHubMessage_GetDiagnosticPropertyData shall return a NULL value.]
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle is NULL)");
+        result = NULL;
+    }
+    else if (iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_DIAGNOSTIC_ID] == ARENA_NO_VALUE)
+    {
+        result = NULL;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_09_109: [IoTHubMessage_GetDiagnosticPropertyData shall point the returned structure at the current location of the diagnostic strings in the arena.]
+        iotHubMessageHandle->diagnostic_data.diagnosticId = (char*)get_arena_string(iotHubMessageHandle, iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_DIAGNOSTIC_ID]);
+        iotHubMessageHandle->diagnostic_data.diagnosticCreationTimeUtc = (char*)get_arena_string(iotHubMessageHandle, iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_DIAGNOSTIC_CREATION_TIME_UTC]);
+        /* Codes_SRS_IOTHUBMESSAGE_10_002: [IoTHubMessage_GetDiagnosticPropertyData shall return the diagnosticData as a const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA*.] */
+        result = &iotHubMessageHandle->diagnostic_data;
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetDiagnosticPropertyData(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA* diagnosticData)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    // Codes_SRS_IOTHUBMESSAGE_10_003: [If any of the parameters are NULL then IoTHubMessage_SetDiagnosticId shall return a IOTHUB_MESSAGE_INVALID_ARG value.]
+    if (iotHubMessageHandle == NULL ||
+        diagnosticData == NULL ||
+        diagnosticData->diagnosticCreationTimeUtc == NULL ||
+        diagnosticData->diagnosticId == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle=%p, diagnosticData=%p, diagnosticData->diagnosticId=%p, diagnosticData->diagnosticCreationTimeUtc=%p)",
+            iotHubMessageHandle, diagnosticData,
+            diagnosticData == NULL ? NULL : diagnosticData->diagnosticId,
+            diagnosticData == NULL ? NULL : diagnosticData->diagnosticCreationTimeUtc);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_10_005: [If the allocation or the copying of `diagnosticData` fails, then IoTHubMessage_SetDiagnosticPropertyData shall return IOTHUB_MESSAGE_ERROR.]
+        if (set_system_property(iotHubMessageHandle, SYSTEM_PROPERTY_DIAGNOSTIC_ID, diagnosticData->diagnosticId) != IOTHUB_MESSAGE_OK ||
+            set_system_property(iotHubMessageHandle, SYSTEM_PROPERTY_DIAGNOSTIC_CREATION_TIME_UTC, diagnosticData->diagnosticCreationTimeUtc) != IOTHUB_MESSAGE_OK)
+        {
+            LogError("Failed saving a copy of diagnosticData");
+            iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_DIAGNOSTIC_ID] = ARENA_NO_VALUE;
+            iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_DIAGNOSTIC_CREATION_TIME_UTC] = ARENA_NO_VALUE;
+            result = IOTHUB_MESSAGE_ERROR;
+        }
+        else
+        {
+            // Codes_SRS_IOTHUBMESSAGE_10_006: [If IoTHubMessage_SetDiagnosticPropertyData finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+            result = IOTHUB_MESSAGE_OK;
+        }
+    }
+    return result;
+}
+
+const char* IoTHubMessage_GetOutputName(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    const char* result;
+    // Codes_SRS_IOTHUBMESSAGE_31_034: [If the iotHubMessageHandle parameter is NULL then IoTHubMessage_GetOutputName shall return a NULL value.]
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle is NULL)");
+        result = NULL;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_31_035: [IoTHubMessage_GetOutputName shall return the OutputName as a const char*.]
+        result = get_arena_string(iotHubMessageHandle, iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_OUTPUT_NAME]);
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetOutputName(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* outputName)
+{
+    IOTHUB_MESSAGE_RESULT result;
+
+    // Codes_SRS_IOTHUBMESSAGE_31_036: [If any of the parameters are NULL then IoTHubMessage_SetOutputName shall return a IOTHUB_MESSAGE_INVALID_ARG value.]
+    if ((iotHubMessageHandle == NULL) || (outputName == NULL))
+    {
+        LogError("Invalid argument (iotHubMessageHandle=%p, outputName=%p)", iotHubMessageHandle, outputName);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_31_038: [If the allocation or the copying of the OutputName fails, then IoTHubMessage_SetOutputName shall return IOTHUB_MESSAGE_ERROR.]
+        // Codes_SRS_IOTHUBMESSAGE_31_039: [IoTHubMessage_SetOutputName finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+        result = set_system_property(iotHubMessageHandle, SYSTEM_PROPERTY_OUTPUT_NAME, outputName);
+    }
+
+    return result;
+}
+
+const char* IoTHubMessage_GetInputName(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    const char* result;
+    // Codes_SRS_IOTHUBMESSAGE_31_040: [if the iotHubMessageHandle parameter is NULL then IoTHubMessage_GetInputName shall return a NULL value.]
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle is NULL)");
+        result = NULL;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_31_041: [IoTHubMessage_GetInputName shall return the InputName as a const char*.]
+        result = get_arena_string(iotHubMessageHandle, iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_INPUT_NAME]);
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetInputName(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* inputName)
+{
+    IOTHUB_MESSAGE_RESULT result;
+
+    // Codes_SRS_IOTHUBMESSAGE_31_042: [if any of the parameters are NULL then IoTHubMessage_SetInputName shall return a IOTHUB_MESSAGE_INVALID_ARG value.]
+    if ((iotHubMessageHandle == NULL) || (inputName == NULL))
+    {
+        LogError("Invalid argument (iotHubMessageHandle=%p, inputName=%p)", iotHubMessageHandle, inputName);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_31_044: [If the allocation or the copying of the InputName fails, then IoTHubMessage_SetInputName shall return IOTHUB_MESSAGE_ERROR.]
+        // Codes_SRS_IOTHUBMESSAGE_31_045: [IoTHubMessage_SetInputName finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+        result = set_system_property(iotHubMessageHandle, SYSTEM_PROPERTY_INPUT_NAME, inputName);
+    }
+
+    return result;
+}
+
+const char* IoTHubMessage_GetConnectionModuleId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    const char* result;
+    // Codes_SRS_IOTHUBMESSAGE_31_046: [if the iotHubMessageHandle parameter is NULL then IoTHubMessage_GetConnectionModuleId shall return a NULL value.]
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle is NULL)");
+        result = NULL;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_31_047: [IoTHubMessage_GetConnectionModuleId shall return the ConnectionModuleId as a const char*.]
+        result = get_arena_string(iotHubMessageHandle, iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_CONNECTION_MODULE_ID]);
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetConnectionModuleId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* connectionModuleId)
+{
+    IOTHUB_MESSAGE_RESULT result;
+
+    // Codes_SRS_IOTHUBMESSAGE_31_048: [if any of the parameters are NULL then IoTHubMessage_SetConnectionModuleId shall return a IOTHUB_MESSAGE_INVALID_ARG value.]
+    if ((iotHubMessageHandle == NULL) || (connectionModuleId == NULL))
+    {
+        LogError("Invalid argument (iotHubMessageHandle=%p, connectionModuleId=%p)", iotHubMessageHandle, connectionModuleId);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_31_050: [If the allocation or the copying of the ConnectionModuleId fails, then IoTHubMessage_SetConnectionModuleId shall return IOTHUB_MESSAGE_ERROR.]
+        // Codes_SRS_IOTHUBMESSAGE_31_051: [IoTHubMessage_SetConnectionModuleId finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+        result = set_system_property(iotHubMessageHandle, SYSTEM_PROPERTY_CONNECTION_MODULE_ID, connectionModuleId);
+    }
+
+    return result;
+}
+
+const char* IoTHubMessage_GetConnectionDeviceId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    const char* result;
+    // Codes_SRS_IOTHUBMESSAGE_31_052: [if the iotHubMessageHandle parameter is NULL then IoTHubMessage_GetConnectionDeviceId shall return a NULL value.]
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle is NULL)");
+        result = NULL;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_31_053: [IoTHubMessage_GetConnectionDeviceId shall return the ConnectionDeviceId as a const char*.]
+        result = get_arena_string(iotHubMessageHandle, iotHubMessageHandle->system_properties[SYSTEM_PROPERTY_CONNECTION_DEVICE_ID]);
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetConnectionDeviceId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const char* connectionDeviceId)
+{
+    IOTHUB_MESSAGE_RESULT result;
+
+    // Codes_SRS_IOTHUBMESSAGE_31_054: [if any of the parameters are NULL then IoTHubMessage_SetConnectionDeviceId shall return a IOTHUB_MESSAGE_INVALID_ARG value.]
+    if ((iotHubMessageHandle == NULL) || (connectionDeviceId == NULL))
+    {
+        LogError("Invalid argument (iotHubMessageHandle=%p, connectionDeviceId=%p)", iotHubMessageHandle, connectionDeviceId);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBMESSAGE_31_056: [If the allocation or the copying of the ConnectionDeviceId fails, then IoTHubMessage_SetConnectionDeviceId shall return IOTHUB_MESSAGE_ERROR.]
+        // Codes_SRS_IOTHUBMESSAGE_31_057: [IoTHubMessage_SetConnectionDeviceId finishes successfully it shall return IOTHUB_MESSAGE_OK.]
+        result = set_system_property(iotHubMessageHandle, SYSTEM_PROPERTY_CONNECTION_DEVICE_ID, connectionDeviceId);
+    }
+
+    return result;
+}
+
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetAsSecurityMessage(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle is NULL)");
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else if (set_system_property(iotHubMessageHandle, SYSTEM_PROPERTY_CONTENT_ENCODING, SECURITY_CLIENT_JSON_ENCODING) != IOTHUB_MESSAGE_OK)
+    {
+        LogError("Failure setting security message content encoding");
+        result = IOTHUB_MESSAGE_ERROR;
+    }
+    else
+    {
+        iotHubMessageHandle->is_security_message = true;
+        result = IOTHUB_MESSAGE_OK;
+    }
+    return result;
+}
+
+bool IoTHubMessage_IsSecurityMessage(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    bool result;
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle is NULL)");
+        result = false;
+    }
+    else
+    {
+        result = iotHubMessageHandle->is_security_message;
+    }
+    return result;
+}
+
+void IoTHubMessage_Destroy(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    /*Codes_SRS_IOTHUBMESSAGE_01_004: [If iotHubMessageHandle is NULL, IoTHubMessage_Destroy shall do nothing.] */
+    if (iotHubMessageHandle != NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_01_003: [IoTHubMessage_Destroy shall free all resources associated with iotHubMessageHandle.]  */
+        if (iotHubMessageHandle->arena != INLINE_ARENA(iotHubMessageHandle))
+        {
+            free(ARENA_BLOCK(iotHubMessageHandle->arena));
+        }
+
+        while (iotHubMessageHandle->retired_arenas != NULL)
+        {
+            ARENA_BLOCK_HEADER* previous = iotHubMessageHandle->retired_arenas->previous;
+            free(iotHubMessageHandle->retired_arenas);
+            iotHubMessageHandle->retired_arenas = previous;
+        }
+
+        if (iotHubMessageHandle->properties != NULL)
+        {
+            Map_Destroy(iotHubMessageHandle->properties);
+        }
+
+        free(iotHubMessageHandle->external_body);
+        free(iotHubMessageHandle);
+    }
+}
@@ -31,6 +31,7 @@
 #include "internal/iothub_client_private.h"
 #include "internal/iothubtransportamqp_methods.h"
 #include "internal/iothub_client_retry_control.h"
+#include "internal/iothub_client_connection_governor.h"
 #include "internal/iothubtransport_amqp_common.h"
 #include "internal/iothubtransport_amqp_connection.h"
 #include "internal/iothubtransport_amqp_device.h"
@@ -1585,13 +1586,17 @@ void IoTHubTransport_AMQP_Common_DoWork(TRANSPORT_LL_HANDLE handle)
                 // We need to check if there are devices, otherwise the amqp_connection won't be able to be created since
                 // there is not a preferred authentication mode set yet on the transport.
 
-                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_019: [If `instance->amqp_connection` is NULL, it shall be established]
-                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_12_003: [AMQP connection will be configured using the `svc2cl_keep_alive_timeout_secs` value from SetOption ]
-                if (transport_instance->amqp_connection == NULL && establish_amqp_connection(transport_instance) != RESULT_OK)
+                if (transport_instance->amqp_connection == NULL)
                 {
-                    LogError("AMQP transport failed to establish connection with service.");
+                    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_160: [If `instance->amqp_connection` is NULL and connection_governor_acquire() fails, IoTHubTransport_AMQP_Common_DoWork shall postpone establishing it to a later call]
+                    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_019: [If `instance->amqp_connection` is NULL, it shall be established]
+                    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_12_003: [AMQP connection will be configured using the `svc2cl_keep_alive_timeout_secs` value from SetOption ]
+                    if (connection_governor_acquire() == 0 && establish_amqp_connection(transport_instance) != RESULT_OK)
+                    {
+                        LogError("AMQP transport failed to establish connection with service.");
 
-                    update_state(transport_instance, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
+                        update_state(transport_instance, AMQP_TRANSPORT_STATE_RECONNECTION_REQUIRED);
+                    }
                 }
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_020: [If the amqp_connection is OPENED, the transport shall iterate through each registered device and perform a device-specific do_work on each]
                 else if (transport_instance->amqp_connection_state == AMQP_CONNECTION_STATE_OPENED)
@@ -22,6 +22,7 @@
 
 #include "internal/iothub_client_private.h"
 #include "internal/iothub_client_retry_control.h"
+#include "internal/iothub_client_connection_governor.h"
 #include "internal/iothub_transport_ll_private.h"
 #include "internal/iothubtransport_mqtt_common.h"
 #include "internal/iothubtransport.h"
@@ -46,8 +47,6 @@
 #define SAS_TOKEN_DEFAULT_LEN               10
 #define RESEND_TIMEOUT_VALUE_MIN            1*60
 #define MAX_SEND_RECOUNT_LIMIT              2
-#define DEFAULT_CONNECTION_INTERVAL         30
-#define FAILED_CONN_BACKOFF_VALUE           5
 #define STATUS_CODE_FAILURE_VALUE           500
 #define STATUS_CODE_TIMEOUT_VALUE           408
 
@@ -196,6 +195,7 @@ typedef struct MQTTTRANSPORT_HANDLE_DATA_TAG
     bool device_twin_get_sent;
     bool twin_resp_sub_recv;
     bool isRecoverableError;
+    bool isConnectionThrottled;
     uint16_t keepAliveValue;
     uint16_t connect_timeout_in_sec;
     tickcounter_ms_t mqtt_connect_time;
@@ -591,49 +591,50 @@ static void sendMsgComplete(IOTHUB_MESSAGE_LIST* iothubMsgList, PMQTTTRANSPORT_H
 static int addUserPropertiesTouMqttMessage(IOTHUB_MESSAGE_HANDLE iothub_message_handle, STRING_HANDLE topic_string, size_t* index_ptr, bool urlencode)
 {
     int result = 0;
-    const char* const* propertyKeys;
-    const char* const* propertyValues;
     size_t propertyCount;
     size_t index = *index_ptr;
-    MAP_HANDLE properties_map = IoTHubMessage_Properties(iothub_message_handle);
-    if (properties_map != NULL)
+
+    // Walks the properties in place so a compact message does not have to build a MAP_HANDLE for them
+    if (IoTHubMessage_GetPropertyCount(iothub_message_handle, &propertyCount) != IOTHUB_MESSAGE_OK)
     {
-        if (Map_GetInternals(properties_map, &propertyKeys, &propertyValues, &propertyCount) != MAP_OK)
-        {
-            LogError("Failed to get the internals of the property map.");
-            result = MU_FAILURE;
-        }
-        else
+        LogError("Failed to get the property count of the message.");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        for (index = 0; index < propertyCount && result == 0; index++)
         {
-            if (propertyCount != 0)
+            const char* propertyKey;
+            const char* propertyValue;
+
+            if (IoTHubMessage_GetPropertyAt(iothub_message_handle, index, &propertyKey, &propertyValue) != IOTHUB_MESSAGE_OK)
+            {
+                LogError("Failed to get the property at index %lu.", (unsigned long)index);
+                result = MU_FAILURE;
+            }
+            else if (urlencode)
             {
-                for (index = 0; index < propertyCount && result == 0; index++)
+                STRING_HANDLE property_key = URL_EncodeString(propertyKey);
+                STRING_HANDLE property_value = URL_EncodeString(propertyValue);
+                if ((property_key == NULL) || (property_value == NULL))
                 {
-                    if (urlencode)
-                    {
-                        STRING_HANDLE property_key = URL_EncodeString(propertyKeys[index]);
-                        STRING_HANDLE property_value = URL_EncodeString(propertyValues[index]);
-                        if ((property_key == NULL) || (property_value == NULL))
-                        {
-                            LogError("Failed URL Encoding properties");
-                            result = MU_FAILURE;
-                        }
-                        else if (STRING_sprintf(topic_string, "%s=%s%s", STRING_c_str(property_key), STRING_c_str(property_value), propertyCount - 1 == index ? "" : PROPERTY_SEPARATOR) != 0)
-                        {
-                            LogError("Failed constructing property string.");
-                            result = MU_FAILURE;
-                        }
-                        STRING_delete(property_key);
-                        STRING_delete(property_value);
-                    }
-                    else
-                    {
-                        if (STRING_sprintf(topic_string, "%s=%s%s", propertyKeys[index], propertyValues[index], propertyCount - 1 == index ? "" : PROPERTY_SEPARATOR) != 0)
-                        {
-                            LogError("Failed constructing property string.");
-                            result = MU_FAILURE;
-                        }
-                    }
+                    LogError("Failed URL Encoding properties");
+                    result = MU_FAILURE;
+                }
+                else if (STRING_sprintf(topic_string, "%s=%s%s", STRING_c_str(property_key), STRING_c_str(property_value), propertyCount - 1 == index ? "" : PROPERTY_SEPARATOR) != 0)
+                {
+                    LogError("Failed constructing property string.");
+                    result = MU_FAILURE;
+                }
+                STRING_delete(property_key);
+                STRING_delete(property_value);
+            }
+            else
+            {
+                if (STRING_sprintf(topic_string, "%s=%s%s", propertyKey, propertyValue, propertyCount - 1 == index ? "" : PROPERTY_SEPARATOR) != 0)
+                {
+                    LogError("Failed constructing property string.");
+                    result = MU_FAILURE;
                 }
             }
         }
@@ -2314,43 +2315,73 @@ static int InitializeConnection(PMQTTTRANSPORT_HANDLE_DATA transport_data)
         // Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_007: [ IoTHubTransport_MQTT_Common_DoWork shall try to reconnect according to the current retry policy set ]
         if (transport_data->mqttClientStatus == MQTT_CLIENT_STATUS_NOT_CONNECTED && transport_data->isRecoverableError)
         {
-            // Note: in case retry_control_should_retry fails, the reconnection shall be attempted anyway (defaulting to policy IOTHUB_CLIENT_RETRY_IMMEDIATE).
-            if (retry_control_should_retry(transport_data->retry_control_handle, &retry_action) != 0 || retry_action == RETRY_ACTION_RETRY_NOW)
+            bool attempt_connection;
+
+            // Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_017: [ If a reconnection was held back by the connection governor, IoTHubTransport_MQTT_Common_DoWork shall only ask the governor again, without calling retry_control_should_retry, until the governor lets it through ]
+            if (transport_data->isConnectionThrottled)
+            {
+                // The retry policy already allowed this attempt; evaluating it again would advance its backoff while the governor holds it
+                attempt_connection = true;
+            }
+            else
+            {
+                // Note: in case retry_control_should_retry fails, the reconnection shall be attempted anyway (defaulting to policy IOTHUB_CLIENT_RETRY_IMMEDIATE).
+                int retry_result = retry_control_should_retry(transport_data->retry_control_handle, &retry_action);
+
+                if (retry_result == 0 && retry_action == RETRY_ACTION_STOP_RETRYING)
+                {
+                    // Set callback if retry expired
+                    if (!transport_data->isRetryExpiredCallbackSet)
+                    {
+                        transport_data->transport_callbacks.connection_status_cb(IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED, IOTHUB_CLIENT_CONNECTION_RETRY_EXPIRED, transport_data->transport_ctx);
+                        transport_data->isRetryExpiredCallbackSet = true;
+                    }
+                    attempt_connection = false;
+                }
+                else
+                {
+                    attempt_connection = (retry_result != 0 || retry_action == RETRY_ACTION_RETRY_NOW);
+                }
+            }
+
+            if (attempt_connection)
             {
-                if (tickcounter_get_current_ms(transport_data->msgTickCounter, &transport_data->connectTick) != 0)
+                // Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_016: [ IoTHubTransport_MQTT_Common_DoWork shall not start the connection if connection_governor_acquire() fails ]
+                if (connection_governor_acquire() != 0)
                 {
-                    transport_data->connectFailCount++;
+                    transport_data->isConnectionThrottled = true;
                     result = MU_FAILURE;
                 }
                 else
                 {
-                    ResetConnectionIfNecessary(transport_data);
+                    transport_data->isConnectionThrottled = false;
 
-                    if (SendMqttConnectMsg(transport_data) != 0)
+                    if (tickcounter_get_current_ms(transport_data->msgTickCounter, &transport_data->connectTick) != 0)
                     {
                         transport_data->connectFailCount++;
                         result = MU_FAILURE;
                     }
                     else
                     {
-                        transport_data->mqttClientStatus = MQTT_CLIENT_STATUS_CONNECTING;
-                        transport_data->connectFailCount = 0;
-                        result = 0;
+                        ResetConnectionIfNecessary(transport_data);
+
+                        if (SendMqttConnectMsg(transport_data) != 0)
+                        {
+                            transport_data->connectFailCount++;
+                            result = MU_FAILURE;
+                        }
+                        else
+                        {
+                            transport_data->mqttClientStatus = MQTT_CLIENT_STATUS_CONNECTING;
+                            transport_data->connectFailCount = 0;
+                            result = 0;
+                        }
                     }
                 }
-            }   
-            else if (retry_action == RETRY_ACTION_STOP_RETRYING)
-            {
-                // Set callback if retry expired
-                if (!transport_data->isRetryExpiredCallbackSet)
-                {
-                    transport_data->transport_callbacks.connection_status_cb(IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED, IOTHUB_CLIENT_CONNECTION_RETRY_EXPIRED, transport_data->transport_ctx);
-                    transport_data->isRetryExpiredCallbackSet = true;
-                }
-                result = MU_FAILURE;
             }
-            else if (retry_action == RETRY_ACTION_RETRY_LATER)
+            else
             {
+                // RETRY_ACTION_RETRY_LATER or RETRY_ACTION_STOP_RETRYING
                 result = MU_FAILURE;
             }
         }
@@ -2564,6 +2595,7 @@ static PMQTTTRANSPORT_HANDLE_DATA InitializeTransportHandleData(const IOTHUB_CLI
 
                         state->isDestroyCalled = false;
                         state->isRetryExpiredCallbackSet = false;
+                        state->isConnectionThrottled = false;
                         state->isRegistered = false;
                         state->device_twin_get_sent = false;
                         state->xioTransport = NULL;
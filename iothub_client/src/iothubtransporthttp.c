@@ -549,6 +549,7 @@ static void destroy_SASObject(HTTPTRANSPORT_PERDEVICE_DATA* handleData)
     handleData->sasObject = NULL;
 }
 
+/*HTTPAPIEX_SAS signs a new token for every request, it does not use the token cache of the authorization module*/
 static bool create_deviceSASObject(HTTPTRANSPORT_PERDEVICE_DATA* handleData, STRING_HANDLE hostName, const char * deviceId, const char * deviceKey)
 {
     STRING_HANDLE keyName;
@@ -224,7 +224,7 @@ static int create_message_properties_to_encode(IOTHUB_MESSAGE_HANDLE messageHand
 }
 
 // Adds fault injection properties to an AMQP message.
-static int add_fault_injection_properties(MESSAGE_HANDLE message_batch_container, const char* const* property_keys, const char* const* property_values, size_t property_count)
+static int add_fault_injection_properties(MESSAGE_HANDLE message_batch_container, IOTHUB_MESSAGE_HANDLE messageHandle, size_t property_count)
 {
     int result;
     AMQP_VALUE uamqp_map;
@@ -240,15 +240,22 @@ static int add_fault_injection_properties(MESSAGE_HANDLE message_batch_container
 
         for (size_t i = 0; result == RESULT_OK && i < property_count; i++)
         {
+            const char* property_key;
+            const char* property_value;
             AMQP_VALUE map_key_value = NULL;
             AMQP_VALUE map_value_value = NULL;
 
-            if ((map_key_value = amqpvalue_create_string(property_keys[i])) == NULL)
+            if (IoTHubMessage_GetPropertyAt(messageHandle, i, &property_key, &property_value) != IOTHUB_MESSAGE_OK)
+            {
+                LogError("Failed to get the message property at index %lu.", (unsigned long)i);
+                result = MU_FAILURE;
+            }
+            else if ((map_key_value = amqpvalue_create_string(property_key)) == NULL)
             {
                 LogError("Failed to create uAMQP property key name.");
                 result = MU_FAILURE;
             }
-            else if ((map_value_value = amqpvalue_create_string(property_values[i])) == NULL)
+            else if ((map_value_value = amqpvalue_create_string(property_value)) == NULL)
             {
                 LogError("Failed to create uAMQP property key value.");
                 result = MU_FAILURE;
@@ -287,11 +294,24 @@ static int add_fault_injection_properties(MESSAGE_HANDLE message_batch_container
 // To test AMQP fault injection, we currently must have the error properties be specified on the batch_container
 // (not one of the messages sent in this container).  As the SDK layer does not support options for configuring
 // this envelope (this is AMQP/batching specific), we will instead intercept fault messages and apply to the container.
-static int override_fault_injection_properties_if_needed(MESSAGE_HANDLE message_batch_container,  const char* const* property_keys, const char* const* property_values, size_t property_count, bool *override_for_fault_injection)
+static int override_fault_injection_properties_if_needed(MESSAGE_HANDLE message_batch_container, IOTHUB_MESSAGE_HANDLE messageHandle, size_t property_count, bool *override_for_fault_injection)
 {
     int result;
+    const char* first_key;
+    const char* first_value;
 
-    if ((property_count == 0) || (strcmp(property_keys[0], "AzIoTHub_FaultOperationType") != 0))
+    if (property_count == 0)
+    {
+        *override_for_fault_injection = false;
+        result = RESULT_OK;
+    }
+    else if (IoTHubMessage_GetPropertyAt(messageHandle, 0, &first_key, &first_value) != IOTHUB_MESSAGE_OK)
+    {
+        LogError("Failed to get the first message property.");
+        *override_for_fault_injection = false;
+        result = MU_FAILURE;
+    }
+    else if (strcmp(first_key, "AzIoTHub_FaultOperationType") != 0)
     {
         *override_for_fault_injection = false;
         result = RESULT_OK;
@@ -299,7 +319,7 @@ static int override_fault_injection_properties_if_needed(MESSAGE_HANDLE message_
     else
     {
         *override_for_fault_injection = true;
-        result = add_fault_injection_properties(message_batch_container,  property_keys, property_values, property_count);
+        result = add_fault_injection_properties(message_batch_container, messageHandle, property_count);
     }
 
     return result;
@@ -308,21 +328,14 @@ static int override_fault_injection_properties_if_needed(MESSAGE_HANDLE message_
 // Codes_SRS_UAMQP_MESSAGING_31_117: [Get application message properties associated with the IOTHUB_MESSAGE_HANDLE to encode, returning the properties and their encoded length.]
 static int create_application_properties_to_encode(MESSAGE_HANDLE message_batch_container, IOTHUB_MESSAGE_HANDLE messageHandle, AMQP_VALUE *application_properties, size_t *application_properties_length)
 {
-    MAP_HANDLE properties_map;
-    const char* const* property_keys;
-    const char* const* property_values;
     size_t property_count = 0;
     AMQP_VALUE uamqp_properties_map = NULL;
     int result;
 
-    if ((properties_map = IoTHubMessage_Properties(messageHandle)) == NULL)
-    {
-        LogError("Failed to get property map from IoTHub message.");
-        result = MU_FAILURE;
-    }
-    else if (Map_GetInternals(properties_map, &property_keys, &property_values, &property_count) != 0)
+    // The properties are walked in place so a compact message does not have to build a MAP_HANDLE for them
+    if (IoTHubMessage_GetPropertyCount(messageHandle, &property_count) != IOTHUB_MESSAGE_OK)
     {
-        LogError("Failed reading the incoming uAMQP message properties");
+        LogError("Failed to get the property count of the IoTHub message.");
         result = MU_FAILURE;
     }
     else if (property_count > 0)
@@ -336,23 +349,32 @@ static int create_application_properties_to_encode(MESSAGE_HANDLE message_batch_
         else
         {
             bool override_for_fault_injection = false;
-            result = override_fault_injection_properties_if_needed(message_batch_container, property_keys, property_values, property_count, &override_for_fault_injection);
+            result = override_fault_injection_properties_if_needed(message_batch_container, messageHandle, property_count, &override_for_fault_injection);
 
-            if (override_for_fault_injection == false)
+            if (result == RESULT_OK && override_for_fault_injection == false)
             {
                 for (i = 0; i < property_count; i++)
                 {
+                    const char* property_key;
+                    const char* property_value;
                     AMQP_VALUE map_property_key;
                     AMQP_VALUE map_property_value;
 
-                    if ((map_property_key = amqpvalue_create_string(property_keys[i])) == NULL)
+                    if (IoTHubMessage_GetPropertyAt(messageHandle, i, &property_key, &property_value) != IOTHUB_MESSAGE_OK)
+                    {
+                        LogError("Failed IoTHubMessage_GetPropertyAt");
+                        result = MU_FAILURE;
+                        break;
+                    }
+
+                    if ((map_property_key = amqpvalue_create_string(property_key)) == NULL)
                     {
                         LogError("Failed amqpvalue_create_string for key");
                         result = MU_FAILURE;
                         break;
                     }
 
-                    if ((map_property_value = amqpvalue_create_string(property_values[i])) == NULL)
+                    if ((map_property_value = amqpvalue_create_string(property_value)) == NULL)
                     {
                         LogError("Failed amqpvalue_create_string for value");
                         amqpvalue_destroy(map_property_key);
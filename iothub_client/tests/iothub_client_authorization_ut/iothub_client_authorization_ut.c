@@ -30,9 +30,18 @@ static void my_gballoc_free(void* ptr)
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/sastoken.h"
 #include "azure_c_shared_utility/xio.h"
+#include "azure_c_shared_utility/azure_base64.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/urlencode.h"
+#include "azure_c_shared_utility/sha.h"
+
+MOCKABLE_FUNCTION(, int, SHA256Reset, SHA256Context*, ctx);
+MOCKABLE_FUNCTION(, int, SHA256Input, SHA256Context*, ctx, const uint8_t*, bytes, unsigned int, bytecount);
+MOCKABLE_FUNCTION(, int, SHA256Result, SHA256Context*, ctx, uint8_t*, Message_Digest);
 
 #ifdef USE_PROV_MODULE
 #include "azure_prov_client/internal/iothub_auth_client.h"
+#include "internal/iothub_client_credential_provider.h"
 #endif
 
 #include "umock_c/umock_c_prod.h"
@@ -50,6 +59,13 @@ static const char* TEST_KEYNAME_VALUE = "Test_keyname_value";
 static const char* TEST_REG_CERT = "Test_certificate";
 static const char* TEST_REG_PK = "Test_private_key";
 static size_t TEST_EXPIRY_TIME = 1;
+static unsigned char TEST_DECODED_KEY[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10 };
+static BUFFER_HANDLE TEST_BUFFER_HANDLE = (BUFFER_HANDLE)0x4242;
+
+#define TEST_REUSE_WINDOW_TIME              (double)100
+#define TEST_PRESIGN_TOKEN_TIME             (double)500
+#define TEST_STALE_TOKEN_TIME               (double)1000
+#define TEST_IDLE_TOKEN_TIME                (double)4000
 
 #define TEST_TIME_VALUE                     (time_t)123456
 
@@ -70,12 +86,31 @@ static int my_mallocAndStrcpy_s(char** destination, const char* source)
     return 0;
 }
 
-static STRING_HANDLE my_SASToken_CreateString(const char* key, const char* scope, const char* keyName, size_t expiry)
+#ifdef __cplusplus
+extern "C"
 {
-    (void)key;
-    (void)scope;
-    (void)keyName;
-    (void)expiry;
+#endif
+    STRING_HANDLE STRING_construct_sprintf(const char* format, ...);
+
+    STRING_HANDLE STRING_construct_sprintf(const char* format, ...)
+    {
+        (void)format;
+        return (STRING_HANDLE)my_gballoc_malloc(1);
+    }
+#ifdef __cplusplus
+}
+#endif
+
+static STRING_HANDLE my_Azure_Base64_Encode_Bytes(const unsigned char* source, size_t size)
+{
+    (void)source;
+    (void)size;
+    return (STRING_HANDLE)my_gballoc_malloc(1);
+}
+
+static STRING_HANDLE my_URL_Encode(STRING_HANDLE input)
+{
+    (void)input;
     return (STRING_HANDLE)my_gballoc_malloc(1);
 }
 
@@ -102,6 +137,37 @@ static void my_iothub_device_auth_destroy(IOTHUB_SECURITY_HANDLE handle)
     my_gballoc_free(handle);
 }
 
+static CREDENTIAL_PROVIDER_HANDLE my_credential_provider_create(CREDENTIAL_SIGN_CALLBACK sign_callback, void* sign_context)
+{
+    (void)sign_callback;
+    (void)sign_context;
+    return (CREDENTIAL_PROVIDER_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_credential_provider_destroy(CREDENTIAL_PROVIDER_HANDLE provider_handle)
+{
+    my_gballoc_free(provider_handle);
+}
+
+static char* my_credential_provider_sign(CREDENTIAL_PROVIDER_HANDLE provider_handle, const char* scope, const char* key_name, size_t* expiry_time)
+{
+    char* result;
+    (void)provider_handle;
+    (void)scope;
+    (void)key_name;
+    (void)expiry_time;
+    result = (char*)my_gballoc_malloc(strlen(TEST_SAS_TOKEN) + 1);
+    strcpy(result, TEST_SAS_TOKEN);
+    return result;
+}
+
+static char* create_presigned_token(void)
+{
+    char* result = (char*)my_gballoc_malloc(strlen(TEST_SAS_TOKEN) + 1);
+    strcpy(result, TEST_SAS_TOKEN);
+    return result;
+}
+
 static CREDENTIAL_RESULT* my_iothub_device_auth_generate_credentials(IOTHUB_SECURITY_HANDLE handle, const DEVICE_AUTH_CREDENTIAL_INFO* dev_auth_cred)
 {
     (void)handle;
@@ -139,6 +205,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_AUTHORIZATION_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(time_t, long long);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(XDA_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SECURITY_HANDLE, void*);
 
@@ -149,8 +216,22 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __LINE__);
 
-    REGISTER_GLOBAL_MOCK_HOOK(SASToken_CreateString, my_SASToken_CreateString);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(SASToken_CreateString, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Azure_Base64_Decode, TEST_BUFFER_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Azure_Base64_Decode, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(BUFFER_u_char, TEST_DECODED_KEY);
+    REGISTER_GLOBAL_MOCK_RETURN(BUFFER_length, sizeof(TEST_DECODED_KEY));
+
+    REGISTER_GLOBAL_MOCK_RETURN(SHA256Reset, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(SHA256Reset, __LINE__);
+    REGISTER_GLOBAL_MOCK_RETURN(SHA256Input, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(SHA256Input, __LINE__);
+    REGISTER_GLOBAL_MOCK_RETURN(SHA256Result, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(SHA256Result, __LINE__);
+
+    REGISTER_GLOBAL_MOCK_HOOK(Azure_Base64_Encode_Bytes, my_Azure_Base64_Encode_Bytes);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Azure_Base64_Encode_Bytes, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(URL_Encode, my_URL_Encode);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(URL_Encode, NULL);
 
     REGISTER_GLOBAL_MOCK_RETURN(get_time, TEST_TIME_VALUE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(get_time, ((time_t)(-1)));
@@ -170,6 +251,19 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_GLOBAL_MOCK_HOOK(iothub_device_auth_generate_credentials, my_iothub_device_auth_generate_credentials);
     REGISTER_GLOBAL_MOCK_RETURN(iothub_device_auth_generate_credentials, NULL);
+
+    REGISTER_UMOCK_ALIAS_TYPE(CREDENTIAL_PROVIDER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(CREDENTIAL_SIGN_CALLBACK, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(CREDENTIAL_TOKEN_STATE, int);
+
+    REGISTER_GLOBAL_MOCK_HOOK(credential_provider_create, my_credential_provider_create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(credential_provider_create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(credential_provider_destroy, my_credential_provider_destroy);
+    REGISTER_GLOBAL_MOCK_HOOK(credential_provider_sign, my_credential_provider_sign);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(credential_provider_sign, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(credential_provider_request, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(credential_provider_request, __LINE__);
+    REGISTER_GLOBAL_MOCK_RETURN(credential_provider_take, CREDENTIAL_TOKEN_STATE_NONE);
 #endif
 }
 
@@ -205,6 +299,10 @@ static void setup_IoTHubClient_Auth_CreateFromDeviceAuth_mocks(bool module_id, D
     }
     STRICT_EXPECTED_CALL(iothub_device_auth_create());
     STRICT_EXPECTED_CALL(iothub_device_auth_get_type(IGNORED_PTR_ARG)).SetReturn(auth_type);
+    if (auth_type == AUTH_TYPE_SAS || auth_type == AUTH_TYPE_SYMM_KEY)
+    {
+        STRICT_EXPECTED_CALL(credential_provider_create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    }
 }
 #endif
 
@@ -222,14 +320,51 @@ static void setup_IoTHubClient_Auth_Create_mocks(bool device_key, bool module_id
     }
 }
 
-static void setup_IoTHubClient_Auth_Get_ConnString_mocks()
+static void setup_compute_key_pads_mocks()
 {
-    STRICT_EXPECTED_CALL(get_time(NULL));
-    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(SASToken_CreateString(IGNORED_PTR_ARG, SCOPE_NAME, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Azure_Base64_Decode(DEVICE_KEY));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_BUFFER_HANDLE));
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_BUFFER_HANDLE));
+    STRICT_EXPECTED_CALL(SHA256Reset(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(SHA256Input(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 64));
+    STRICT_EXPECTED_CALL(SHA256Reset(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(SHA256Input(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 64));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_BUFFER_HANDLE));
+}
+
+static void setup_create_sas_token_from_key_mocks(bool compute_key_pads)
+{
+    if (compute_key_pads)
+    {
+        setup_compute_key_pads_mocks();
+    }
+    STRICT_EXPECTED_CALL(SHA256Input(IGNORED_PTR_ARG, IGNORED_PTR_ARG, (unsigned int)strlen(SCOPE_NAME)));
+    STRICT_EXPECTED_CALL(SHA256Input(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1));
+    STRICT_EXPECTED_CALL(SHA256Input(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(SHA256Result(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(SHA256Input(IGNORED_PTR_ARG, IGNORED_PTR_ARG, SHA256HashSize));
+    STRICT_EXPECTED_CALL(SHA256Result(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Azure_Base64_Encode_Bytes(IGNORED_PTR_ARG, SHA256HashSize));
+    STRICT_EXPECTED_CALL(URL_Encode(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+}
+
+static void setup_IoTHubClient_Auth_Get_ConnString_mocks(const char* key_name)
+{
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
+    setup_create_sas_token_from_key_mocks(true);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME));
+    if (key_name != NULL)
+    {
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, key_name));
+    }
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 }
 
 static int should_skip_index(size_t current_index, const size_t skip_array[], size_t length)
@@ -450,8 +585,14 @@ TEST_FUNCTION(IoTHubClient_Auth_CreateFromDeviceAuth_fail)
 
     //act
     size_t count = umock_c_negative_tests_call_count();
-    for (size_t index = 0; index < count-1; index++)
+    for (size_t index = 0; index < count; index++)
     {
+        // iothub_device_auth_get_type cannot fail
+        if (index == count - 2)
+        {
+            continue;
+        }
+
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
@@ -776,8 +917,9 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_scope_NULL_fail)
 
 #ifdef USE_PROV_MODULE
 /* Codes_SRS_IoTHub_Authorization_07_010: [ IoTHubClient_Auth_Get_ConnString shall construct the expiration time using the expire_time. ] */
-/* Codes_SRS_IoTHub_Authorization_07_011: [ IoTHubClient_Auth_Get_ConnString shall call SASToken_CreateString to construct the sas token. ] */
+/* Codes_SRS_IoTHub_Authorization_07_011: [ IoTHubClient_Auth_Get_SasToken shall sign the sas token with the HMAC key pads computed once from the device key. ] */
 /* Codes_SRS_IoTHub_Authorization_07_012: [ On success IoTHubClient_Auth_Get_ConnString shall allocate and return the sas token in a char*. ] */
+/* Codes_SRS_IoTHub_Authorization_07_029: [ IoTHubClient_Auth_Get_SasToken shall sign device auth tokens through the credential provider, which serializes access to the HSM. ] */
 TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_device_auth_succeed)
 {
     //arrange
@@ -787,9 +929,10 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_device_auth_succeed)
     STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
 
-    STRICT_EXPECTED_CALL(iothub_device_auth_generate_credentials(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(credential_provider_take(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(credential_provider_sign(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME));
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     //act
     char* conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
@@ -802,6 +945,325 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_device_auth_succeed)
     free(conn_string);
     IoTHubClient_Auth_Destroy(handle);
 }
+/* Codes_SRS_IoTHub_Authorization_07_030: [ If the credential provider holds a pre-signed device auth token that is within the reuse window, IoTHubClient_Auth_Get_SasToken shall use it instead of signing. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_device_auth_presigned_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    char* presigned_token = create_presigned_token();
+    size_t presigned_expiry = (size_t)TEST_REUSE_WINDOW_TIME + 3600;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_REUSE_WINDOW_TIME);
+    STRICT_EXPECTED_CALL(credential_provider_take(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_sas_token(&presigned_token, sizeof(presigned_token))
+        .CopyOutArgumentBuffer_expiry_time(&presigned_expiry, sizeof(presigned_expiry))
+        .SetReturn(CREDENTIAL_TOKEN_STATE_READY);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SAS_TOKEN));
+
+    //act
+    char* sas_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SAS_TOKEN, sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(sas_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_device_auth_stale_presigned_token_signs_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    char* presigned_token = create_presigned_token();
+    size_t presigned_expiry = 3600;
+    size_t stale_token_expiry = (size_t)TEST_STALE_TOKEN_TIME + 3600;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_STALE_TOKEN_TIME);
+    STRICT_EXPECTED_CALL(credential_provider_take(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_sas_token(&presigned_token, sizeof(presigned_token))
+        .CopyOutArgumentBuffer_expiry_time(&presigned_expiry, sizeof(presigned_expiry))
+        .SetReturn(CREDENTIAL_TOKEN_STATE_READY);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(credential_provider_sign(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(4, &stale_token_expiry, sizeof(stale_token_expiry));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SAS_TOKEN));
+
+    //act
+    char* sas_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(sas_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_device_auth_joined_stale_token_signs_again_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    size_t joined_expiry = 3600;
+    size_t stale_token_expiry = (size_t)TEST_STALE_TOKEN_TIME + 3600;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_STALE_TOKEN_TIME);
+    STRICT_EXPECTED_CALL(credential_provider_take(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(credential_provider_sign(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_expiry_time(&joined_expiry, sizeof(joined_expiry));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(credential_provider_sign(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG))
+        .ValidateArgumentBuffer(4, &stale_token_expiry, sizeof(stale_token_expiry));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SAS_TOKEN));
+
+    //act
+    char* sas_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(sas_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_Cache_device_auth_fresh_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_REUSE_WINDOW_TIME);
+    STRICT_EXPECTED_CALL(credential_provider_take(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken_Cache(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_device_auth_fresh_cached_token_no_request_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_REUSE_WINDOW_TIME);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    char* sas_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(sas_token);
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_07_031: [ If the cached device auth token is past half of the reuse window, IoTHubClient_Auth_Get_SasToken shall request a replacement from the credential provider without waiting for it. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_device_auth_requests_presigned_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_PRESIGN_TOKEN_TIME);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(credential_provider_request(IGNORED_PTR_ARG, SCOPE_NAME, NULL, (size_t)TEST_PRESIGN_TOKEN_TIME + 3600));
+
+    //act
+    char* sas_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(sas_token);
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_device_auth_request_fail_returns_cached_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_PRESIGN_TOKEN_TIME);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(credential_provider_request(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_NUM_ARG)).SetReturn(__LINE__);
+
+    //act
+    char* sas_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(sas_token);
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_07_028: [ IoTHubClient_Auth_Refresh_SasToken_Cache shall never sign a token, it shall evict tokens that left the reuse window so the next IoTHubClient_Auth_Get_SasToken signs them on demand. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_Cache_device_auth_does_not_request_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_PRESIGN_TOKEN_TIME);
+    STRICT_EXPECTED_CALL(credential_provider_take(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken_Cache(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_07_028: [ IoTHubClient_Auth_Refresh_SasToken_Cache shall never sign a token, it shall evict tokens that left the reuse window so the next IoTHubClient_Auth_Get_SasToken signs them on demand. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_Cache_device_auth_pending_token_evicts_stale_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_STALE_TOKEN_TIME);
+    STRICT_EXPECTED_CALL(credential_provider_take(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(CREDENTIAL_TOKEN_STATE_PENDING);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken_Cache(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_07_032: [ IoTHubClient_Auth_Refresh_SasToken_Cache shall replace the cached token with the pre-signed token once the credential provider completes it. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_Cache_device_auth_takes_presigned_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    char* presigned_token = create_presigned_token();
+    size_t presigned_expiry = (size_t)TEST_PRESIGN_TOKEN_TIME + 3600;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_STALE_TOKEN_TIME);
+    STRICT_EXPECTED_CALL(credential_provider_take(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_sas_token(&presigned_token, sizeof(presigned_token))
+        .CopyOutArgumentBuffer_expiry_time(&presigned_expiry, sizeof(presigned_expiry))
+        .SetReturn(CREDENTIAL_TOKEN_STATE_READY);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken_Cache(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_Cache_device_auth_presign_failed_evicts_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_STALE_TOKEN_TIME);
+    STRICT_EXPECTED_CALL(credential_provider_take(IGNORED_PTR_ARG, SCOPE_NAME, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(CREDENTIAL_TOKEN_STATE_FAILED);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken_Cache(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Destroy_device_auth_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_CreateFromDeviceAuth(DEVICE_ID, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(credential_provider_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(iothub_device_auth_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_Auth_Destroy(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
 #endif
 
 TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_succeed)
@@ -810,7 +1272,7 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_succeed)
     IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
     umock_c_reset_all_calls();
 
-    setup_IoTHubClient_Auth_Get_ConnString_mocks();
+    setup_IoTHubClient_Auth_Get_ConnString_mocks(NULL);
 
     //act
     char* conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
@@ -849,20 +1311,28 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ModuleId_succeed)
 TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_fail)
 {
     //arrange
-    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    // Every iteration needs a handle with neither key pads nor cached tokens
+    IOTHUB_AUTHORIZATION_HANDLE handles[32];
+    size_t handle_count = sizeof(handles) / sizeof(handles[0]);
+    for (size_t index = 0; index < handle_count; index++)
+    {
+        handles[index] = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    }
     umock_c_reset_all_calls();
 
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
-    setup_IoTHubClient_Auth_Get_ConnString_mocks();
+    setup_IoTHubClient_Auth_Get_ConnString_mocks(TEST_KEYNAME_VALUE);
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 1, 3, 5 };
+    // get_difftime, BUFFER_u_char, BUFFER_length, BUFFER_delete, STRING_c_str, STRING_delete and caching the token cannot fail the call
+    size_t calls_cannot_fail[] = { 1, 3, 4, 9, 18, 19, 21, 22, 23, 24, 25 };
 
     //act
     size_t count = umock_c_negative_tests_call_count();
+    ASSERT_IS_TRUE(count <= handle_count);
     for (size_t index = 0; index < count; index++)
     {
         if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail)/sizeof(calls_cannot_fail[0])) != 0)
@@ -874,16 +1344,247 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_fail)
         umock_c_negative_tests_fail_call(index);
 
         //act
-        char* conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, TEST_KEYNAME_VALUE);
+        char* conn_string = IoTHubClient_Auth_Get_SasToken(handles[index], SCOPE_NAME, TEST_EXPIRY_TIME, TEST_KEYNAME_VALUE);
 
         //assert
         ASSERT_IS_NULL(conn_string, "IoTHubClient_Auth_Get_ConnString failure in test %lu/%lu", (unsigned long)index, (unsigned long)count);
     }
     //cleanup
-    IoTHubClient_Auth_Destroy(handle);
+    for (size_t index = 0; index < handle_count; index++)
+    {
+        IoTHubClient_Auth_Destroy(handles[index]);
+    }
     umock_c_negative_tests_deinit();
 }
 
+/* Codes_SRS_IoTHub_Authorization_07_025: [ If a token for the same scope and key name was created within the reuse window, IoTHubClient_Auth_Get_SasToken shall return a copy of the cached token. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_returns_cached_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_REUSE_WINDOW_TIME);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    char* conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(conn_string);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    free(conn_string);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_different_key_name_not_cached_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
+    setup_create_sas_token_from_key_mocks(false);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_KEYNAME_VALUE));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    char* conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, TEST_KEYNAME_VALUE);
+
+    //assert
+    ASSERT_IS_NOT_NULL(conn_string);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    free(conn_string);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_stale_token_reuses_key_pads_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_STALE_TOKEN_TIME);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    setup_create_sas_token_from_key_mocks(false);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    char* conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(conn_string);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    free(conn_string);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_cache_failure_returns_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
+    setup_create_sas_token_from_key_mocks(true);
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME)).SetReturn(__LINE__);
+
+    //act
+    char* conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(conn_string);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(conn_string);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_07_026: [ if handle is NULL, IoTHubClient_Auth_Refresh_SasToken_Cache shall do nothing. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_Cache_handle_NULL_succeed)
+{
+    //arrange
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken_Cache(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_Cache_empty_cache_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken_Cache(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_Cache_fresh_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_REUSE_WINDOW_TIME);
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken_Cache(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_07_028: [ IoTHubClient_Auth_Refresh_SasToken_Cache shall never sign a token, it shall evict tokens that left the reuse window so the next IoTHubClient_Auth_Get_SasToken signs them on demand. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_Cache_stale_token_evicted_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_STALE_TOKEN_TIME);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken_Cache(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_07_027: [ IoTHubClient_Auth_Refresh_SasToken_Cache shall evict tokens that have not been requested for a whole token lifetime. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Refresh_SasToken_Cache_idle_token_evicted_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(TEST_IDLE_TOKEN_TIME);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_Auth_Refresh_SasToken_Cache(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+TEST_FUNCTION(IoTHubClient_Auth_Set_SasToken_Expiry_clears_cache_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL, NULL);
+    char* first_token = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    int result = IoTHubClient_Auth_Set_SasToken_Expiry(handle, 4800);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_token);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
 /* Codes_SRS_IoTHub_Authorization_07_013: [ if handle is NULL, IoTHubClient_Auth_Get_DeviceId shall return NULL. ] */
 TEST_FUNCTION(IoTHubClient_Auth_Get_DeviceId_handle_NULL)
 {
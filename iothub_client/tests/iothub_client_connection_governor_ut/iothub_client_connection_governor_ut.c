@@ -0,0 +1,456 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#else
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "umock_c/umocktypes_stdint.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "umock_c/umock_c_prod.h"
+#undef ENABLE_MOCKS
+
+#include "internal/iothub_client_connection_governor.h"
+
+#define TEST_LOCK_HANDLE                    (LOCK_HANDLE)0x4243
+#define TEST_TICK_COUNTER_HANDLE            (TICK_COUNTER_HANDLE)0x4244
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static tickcounter_ms_t g_current_ms;
+
+static int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t* current_ms)
+{
+    (void)tick_counter;
+    *current_ms = g_current_ms;
+    return 0;
+}
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static void initialize_governor(size_t connections_per_second, size_t burst_size)
+{
+    ASSERT_ARE_EQUAL(int, 0, connection_governor_init());
+    if (connections_per_second != 0)
+    {
+        ASSERT_ARE_EQUAL(int, 0, connection_governor_set_rate(connections_per_second, burst_size));
+    }
+    umock_c_reset_all_calls();
+}
+
+static size_t count_granted_connections(size_t attempts)
+{
+    size_t result = 0;
+    size_t index;
+    for (index = 0; index < attempts; index++)
+    {
+        if (connection_governor_acquire() == 0)
+        {
+            result++;
+        }
+    }
+    return result;
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+BEGIN_TEST_SUITE(iothub_client_connection_governor_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
+
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, TEST_LOCK_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock, LOCK_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Deinit, LOCK_OK);
+
+    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_create, TEST_TICK_COUNTER_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, my_tickcounter_get_current_ms);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_get_current_ms, __LINE__);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+    umock_c_reset_all_calls();
+
+    g_current_ms = 0;
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    // The governor is process-wide, every test starts from an uninitialized one
+    connection_governor_deinit();
+
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_002: [`connection_governor_init` shall create the governor lock and tick counter]
+TEST_FUNCTION(connection_governor_init_succeed)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(tickcounter_create());
+
+    //act
+    int result = connection_governor_init();
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_001: [If the governor is already initialized, `connection_governor_init` shall return 0]
+TEST_FUNCTION(connection_governor_init_twice_succeed)
+{
+    //arrange
+    initialize_governor(0, 0);
+
+    //act
+    int result = connection_governor_init();
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_003: [If any of them fails to be created, `connection_governor_init` shall release what it created and return non-zero]
+TEST_FUNCTION(connection_governor_init_fail)
+{
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(tickcounter_create());
+
+    umock_c_negative_tests_snapshot();
+
+    size_t index;
+    for (index = 0; index < umock_c_negative_tests_call_count(); index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int result = connection_governor_init();
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result, "connection_governor_init failure in test %lu", (unsigned long)index);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_005: [If the governor is not initialized, `connection_governor_deinit` shall do nothing]
+TEST_FUNCTION(connection_governor_deinit_not_initialized_succeed)
+{
+    //arrange
+
+    //act
+    connection_governor_deinit();
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_006: [`connection_governor_deinit` shall destroy the tick counter and the lock]
+TEST_FUNCTION(connection_governor_deinit_succeed)
+{
+    //arrange
+    initialize_governor(0, 0);
+
+    STRICT_EXPECTED_CALL(tickcounter_destroy(TEST_TICK_COUNTER_HANDLE));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+
+    //act
+    connection_governor_deinit();
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_007: [If the governor is not initialized, `connection_governor_set_rate` shall fail and return non-zero]
+TEST_FUNCTION(connection_governor_set_rate_not_initialized_fail)
+{
+    //arrange
+
+    //act
+    int result = connection_governor_set_rate(10, 10);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_008: [If `connections_per_second` is not 0 and `burst_size` is 0, `connection_governor_set_rate` shall fail and return non-zero]
+TEST_FUNCTION(connection_governor_set_rate_zero_burst_fail)
+{
+    //arrange
+    initialize_governor(0, 0);
+
+    //act
+    int result = connection_governor_set_rate(10, 0);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_009: [`connection_governor_set_rate` shall save the rate and fill the bucket with `burst_size` tokens]
+TEST_FUNCTION(connection_governor_set_rate_succeed)
+{
+    //arrange
+    initialize_governor(0, 0);
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    int result = connection_governor_set_rate(10, 10);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_009: [`connection_governor_set_rate` shall save the rate and fill the bucket with `burst_size` tokens]
+TEST_FUNCTION(connection_governor_set_rate_fail)
+{
+    //arrange
+    initialize_governor(0, 0);
+
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_PTR_ARG));
+
+    umock_c_negative_tests_snapshot();
+
+    size_t index;
+    for (index = 0; index < umock_c_negative_tests_call_count(); index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int result = connection_governor_set_rate(10, 10);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result, "connection_governor_set_rate failure in test %lu", (unsigned long)index);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_011: [If the governor is not initialized or is disabled, `connection_governor_acquire` shall return 0]
+TEST_FUNCTION(connection_governor_acquire_not_initialized_succeed)
+{
+    //arrange
+
+    //act
+    int result = connection_governor_acquire();
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_004: [The governor shall start disabled, allowing every connection attempt]
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_011: [If the governor is not initialized or is disabled, `connection_governor_acquire` shall return 0]
+TEST_FUNCTION(connection_governor_acquire_disabled_succeed)
+{
+    //arrange
+    initialize_governor(0, 0);
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    int result = connection_governor_acquire();
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1000, count_granted_connections(1000));
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_010: [A `connections_per_second` of 0 shall disable the governor]
+TEST_FUNCTION(connection_governor_set_rate_zero_disables_succeed)
+{
+    //arrange
+    initialize_governor(1, 1);
+    ASSERT_ARE_EQUAL(int, 0, connection_governor_acquire());
+    ASSERT_ARE_NOT_EQUAL(int, 0, connection_governor_acquire());
+
+    //act
+    int result = connection_governor_set_rate(0, 0);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 100, count_granted_connections(100));
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_014: [If a whole token is available, `connection_governor_acquire` shall take it and return 0]
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_015: [Otherwise `connection_governor_acquire` shall return non-zero]
+TEST_FUNCTION(connection_governor_acquire_burst_succeed)
+{
+    //arrange
+    initialize_governor(10, 25);
+
+    //act
+    size_t granted = count_granted_connections(5000);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 25, granted);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_013: [`connection_governor_acquire` shall refill the bucket at `connections_per_second` tokens per second, up to `burst_size` tokens]
+TEST_FUNCTION(connection_governor_acquire_refills_at_rate_succeed)
+{
+    //arrange
+    initialize_governor(10, 1);
+    ASSERT_ARE_EQUAL(size_t, 1, count_granted_connections(100));
+
+    //act
+    g_current_ms = 99;
+    size_t granted_before_refill = count_granted_connections(100);
+    g_current_ms = 100;
+    size_t granted_after_refill = count_granted_connections(100);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 0, granted_before_refill);
+    ASSERT_ARE_EQUAL(size_t, 1, granted_after_refill);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_013: [`connection_governor_acquire` shall refill the bucket at `connections_per_second` tokens per second, up to `burst_size` tokens]
+TEST_FUNCTION(connection_governor_acquire_spreads_reconnect_storm_succeed)
+{
+    //arrange
+    // A gateway reconnecting 5000 devices, each retrying on every 10ms DoWork
+    size_t remaining_devices = 5000;
+    size_t max_per_second = 0;
+    size_t granted_this_second = 0;
+    initialize_governor(50, 50);
+
+    //act
+    while (remaining_devices > 0 && g_current_ms < 200000)
+    {
+        size_t granted = count_granted_connections(remaining_devices);
+        remaining_devices -= granted;
+        granted_this_second += granted;
+
+        g_current_ms += 10;
+        if (g_current_ms % 1000 == 0)
+        {
+            max_per_second = (granted_this_second > max_per_second ? granted_this_second : max_per_second);
+            granted_this_second = 0;
+        }
+    }
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 0, remaining_devices);
+    // The first second may hold the full burst on top of the sustained rate
+    ASSERT_IS_TRUE(max_per_second <= 100);
+    ASSERT_IS_TRUE(g_current_ms >= 99000);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_013: [`connection_governor_acquire` shall refill the bucket at `connections_per_second` tokens per second, up to `burst_size` tokens]
+TEST_FUNCTION(connection_governor_acquire_refill_capped_at_burst_succeed)
+{
+    //arrange
+    initialize_governor(10, 3);
+    ASSERT_ARE_EQUAL(size_t, 3, count_granted_connections(100));
+
+    //act
+    g_current_ms = 3600000;
+    size_t granted = count_granted_connections(100);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 3, granted);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CONNECTION_GOVERNOR_09_012: [If the governor cannot be evaluated, `connection_governor_acquire` shall return 0 so connections are never blocked by its own failures]
+TEST_FUNCTION(connection_governor_acquire_fails_open)
+{
+    //arrange
+    initialize_governor(1, 1);
+    ASSERT_ARE_EQUAL(int, 0, connection_governor_acquire());
+    umock_c_reset_all_calls();
+
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(TEST_TICK_COUNTER_HANDLE, IGNORED_PTR_ARG));
+
+    umock_c_negative_tests_snapshot();
+
+    size_t index;
+    for (index = 0; index < umock_c_negative_tests_call_count(); index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int result = connection_governor_acquire();
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result, "connection_governor_acquire failure in test %lu", (unsigned long)index);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+}
+
+END_TEST_SUITE(iothub_client_connection_governor_ut)
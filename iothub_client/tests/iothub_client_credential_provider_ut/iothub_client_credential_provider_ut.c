@@ -0,0 +1,1108 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#else
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "umock_c/umock_c_prod.h"
+#undef ENABLE_MOCKS
+
+#include "internal/iothub_client_credential_provider.h"
+
+static const char* TEST_SCOPE = "contoso.azure-devices.net/devices/device_id";
+static const char* TEST_OTHER_SCOPE = "contoso.azure-devices.net/devices/other_id";
+static const char* TEST_KEY_NAME = "key_name";
+static const size_t TEST_EXPIRY_TIME = 1000;
+static const size_t TEST_LATER_EXPIRY_TIME = 2000;
+static const unsigned int TEST_HSM_LATENCY_MS = 40;
+
+#define TEST_LOCK_HANDLE                    (LOCK_HANDLE)0x4243
+#define TEST_HSM_LOCK_HANDLE                (LOCK_HANDLE)0x4244
+#define TEST_COND_HANDLE                    (COND_HANDLE)0x4245
+#define TEST_SIGNED_COND_HANDLE             (COND_HANDLE)0x4246
+#define TEST_THREAD_HANDLE                  (THREAD_HANDLE)0x4247
+#define TEST_MAX_SIGN_CONTEXTS              8
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static int g_lock_init_count;
+static int g_cond_init_count;
+static THREAD_START_FUNC g_thread_func;
+static void* g_thread_func_arg;
+
+// Software HSM: signs with a fixed format and accounts for the time a real HSM would take
+static size_t g_hsm_sign_count;
+static unsigned int g_hsm_elapsed_ms;
+static bool g_hsm_fail;
+static void* g_hsm_sign_contexts[TEST_MAX_SIGN_CONTEXTS];
+
+// Lets a test queue a request from "another thread" while the HSM is busy
+static CREDENTIAL_PROVIDER_HANDLE g_request_while_signing_handle;
+static size_t g_request_while_signing_at;
+static int g_request_while_signing_result;
+
+static char* software_hsm_sign(void* context, const char* scope, const char* key_name, size_t expiry_time)
+{
+    char* result;
+    (void)key_name;
+
+    if (g_hsm_sign_count < TEST_MAX_SIGN_CONTEXTS)
+    {
+        g_hsm_sign_contexts[g_hsm_sign_count] = context;
+    }
+    g_hsm_sign_count++;
+    ThreadAPI_Sleep(TEST_HSM_LATENCY_MS);
+
+    if (g_request_while_signing_handle != NULL && g_hsm_sign_count == g_request_while_signing_at)
+    {
+        g_request_while_signing_result = credential_provider_request(g_request_while_signing_handle, "contoso.azure-devices.net/devices/other_id", NULL, expiry_time);
+    }
+
+    if (g_hsm_fail)
+    {
+        result = NULL;
+    }
+    else if ((result = (char*)my_gballoc_malloc(strlen(scope) + 32)) != NULL)
+    {
+        (void)sprintf(result, "sr=%s&se=%lu", scope, (unsigned long)expiry_time);
+    }
+    return result;
+}
+
+static int my_mallocAndStrcpy_s(char** destination, const char* source)
+{
+    size_t src_len = strlen(source);
+    *destination = (char*)my_gballoc_malloc(src_len + 1);
+    strcpy(*destination, source);
+    return 0;
+}
+
+static LOCK_HANDLE my_Lock_Init(void)
+{
+    // The worker creates its own lock before the HSM lock
+    return (g_lock_init_count++ % 2 == 0) ? TEST_LOCK_HANDLE : TEST_HSM_LOCK_HANDLE;
+}
+
+static COND_HANDLE my_Condition_Init(void)
+{
+    // The request condition is created before the signed condition
+    return (g_cond_init_count++ % 2 == 0) ? TEST_COND_HANDLE : TEST_SIGNED_COND_HANDLE;
+}
+
+static THREADAPI_RESULT my_ThreadAPI_Create(THREAD_HANDLE* threadHandle, THREAD_START_FUNC func, void* arg)
+{
+    *threadHandle = TEST_THREAD_HANDLE;
+    g_thread_func = func;
+    g_thread_func_arg = arg;
+    return THREADAPI_OK;
+}
+
+static void my_ThreadAPI_Sleep(unsigned int milliseconds)
+{
+    g_hsm_elapsed_ms += milliseconds;
+}
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static void run_worker_until_idle(void)
+{
+    // Condition_Wait fails by default, which makes the worker return once nothing is pending
+    ASSERT_IS_NOT_NULL(g_thread_func);
+    (void)g_thread_func(g_thread_func_arg);
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+BEGIN_TEST_SUITE(iothub_client_credential_provider_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(COND_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(COND_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(THREAD_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(THREAD_START_FUNC, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(THREADAPI_RESULT, int);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __LINE__);
+
+    REGISTER_GLOBAL_MOCK_HOOK(Lock_Init, my_Lock_Init);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock, LOCK_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Deinit, LOCK_OK);
+
+    REGISTER_GLOBAL_MOCK_HOOK(Condition_Init, my_Condition_Init);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Condition_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Condition_Post, COND_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Condition_Wait, COND_ERROR);
+
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Create, my_ThreadAPI_Create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(ThreadAPI_Create, THREADAPI_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(ThreadAPI_Join, THREADAPI_OK);
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Sleep, my_ThreadAPI_Sleep);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+    umock_c_reset_all_calls();
+
+    g_lock_init_count = 0;
+    g_cond_init_count = 0;
+    g_thread_func = NULL;
+    g_thread_func_arg = NULL;
+    g_hsm_sign_count = 0;
+    g_hsm_elapsed_ms = 0;
+    g_hsm_fail = false;
+    memset(g_hsm_sign_contexts, 0, sizeof(g_hsm_sign_contexts));
+    g_request_while_signing_handle = NULL;
+    g_request_while_signing_at = 0;
+    g_request_while_signing_result = -1;
+
+    // IoTHub_Init initializes the worker before any client creates a provider
+    ASSERT_ARE_EQUAL(int, 0, credential_provider_init());
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    // The worker is process wide, every test starts from an uninitialized one
+    credential_provider_deinit();
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+static void setup_credential_provider_init_mocks(void)
+{
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Condition_Init());
+}
+
+static void setup_credential_provider_create_mocks(bool is_first_provider)
+{
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    if (is_first_provider)
+    {
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    }
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+}
+
+static void setup_clear_requests_mocks(void)
+{
+    size_t index;
+    for (index = 0; index < 4; index++)
+    {
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    }
+}
+
+static void setup_sign_token_mocks(void)
+{
+    STRICT_EXPECTED_CALL(Lock(TEST_HSM_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(TEST_HSM_LATENCY_MS));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_HSM_LOCK_HANDLE));
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_024: [ credential_provider_init shall create the worker lock, the HSM lock and the worker conditions. ] */
+TEST_FUNCTION(credential_provider_init_succeed)
+{
+    //arrange
+    credential_provider_deinit();
+    g_lock_init_count = 0;
+    g_cond_init_count = 0;
+    umock_c_reset_all_calls();
+    setup_credential_provider_init_mocks();
+
+    //act
+    int result = credential_provider_init();
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_023: [ If the worker is already initialized, credential_provider_init shall return 0. ] */
+TEST_FUNCTION(credential_provider_init_already_initialized_succeed)
+{
+    //arrange
+
+    //act
+    int result = credential_provider_init();
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_025: [ If any of them fails to be created, credential_provider_init shall release what it created and return a non-zero value. ] */
+TEST_FUNCTION(credential_provider_init_fail)
+{
+    //arrange
+    credential_provider_deinit();
+    umock_c_reset_all_calls();
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    setup_credential_provider_init_mocks();
+
+    umock_c_negative_tests_snapshot();
+
+    //act
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+        g_lock_init_count = 0;
+        g_cond_init_count = 0;
+
+        int result = credential_provider_init();
+
+        char tmp_msg[64];
+        sprintf(tmp_msg, "credential_provider_init failure in test %lu/%lu", (unsigned long)index, (unsigned long)count);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result, tmp_msg);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_026: [ credential_provider_deinit shall release the worker locks and conditions. ] */
+TEST_FUNCTION(credential_provider_deinit_succeed)
+{
+    //arrange
+
+    STRICT_EXPECTED_CALL(Condition_Deinit(TEST_SIGNED_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Condition_Deinit(TEST_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_HSM_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+
+    //act
+    credential_provider_deinit();
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_027: [ If providers are still alive, credential_provider_deinit shall leave the worker untouched. ] */
+TEST_FUNCTION(credential_provider_deinit_providers_alive_keeps_worker_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    umock_c_reset_all_calls();
+
+    //act
+    credential_provider_deinit();
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, credential_provider_request(handle, TEST_SCOPE, NULL, TEST_EXPIRY_TIME));
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_001: [ If sign_callback is NULL, credential_provider_create shall fail and return NULL. ] */
+TEST_FUNCTION(credential_provider_create_sign_callback_NULL_fail)
+{
+    //arrange
+
+    //act
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(NULL, NULL);
+
+    //assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_002: [ credential_provider_create shall allocate the provider and add it to the providers served by the worker. ] */
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_004: [ If the worker thread is not started, credential_provider_create shall start it. Every provider shares that one thread. ] */
+TEST_FUNCTION(credential_provider_create_succeed)
+{
+    //arrange
+    setup_credential_provider_create_mocks(true);
+
+    //act
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_IS_NOT_NULL(g_thread_func);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_028: [ If the worker is not initialized, credential_provider_create shall fail and return NULL. ] */
+TEST_FUNCTION(credential_provider_create_not_initialized_fail)
+{
+    //arrange
+    credential_provider_deinit();
+    umock_c_reset_all_calls();
+
+    //act
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+
+    //assert
+    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_004: [ If the worker thread is not started, credential_provider_create shall start it. Every provider shares that one thread. ] */
+TEST_FUNCTION(credential_provider_create_second_provider_shares_worker_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle1 = credential_provider_create(software_hsm_sign, NULL);
+    umock_c_reset_all_calls();
+
+    setup_credential_provider_create_mocks(false);
+
+    //act
+    CREDENTIAL_PROVIDER_HANDLE handle2 = credential_provider_create(software_hsm_sign, NULL);
+
+    //assert
+    ASSERT_IS_NOT_NULL(handle2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    credential_provider_destroy(handle2);
+    credential_provider_destroy(handle1);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_003: [ If any allocation fails, credential_provider_create shall fail and return NULL. ] */
+TEST_FUNCTION(credential_provider_create_fail)
+{
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    setup_credential_provider_create_mocks(true);
+
+    umock_c_negative_tests_snapshot();
+
+    //act
+    // Failing to start the worker (allocating and creating its thread) is not fatal
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count - 3; index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+
+        char tmp_msg[64];
+        sprintf(tmp_msg, "credential_provider_create failure in test %lu/%lu", (unsigned long)index, (unsigned long)count);
+
+        //assert
+        ASSERT_IS_NULL(handle, tmp_msg);
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_005: [ If the worker thread cannot be started, credential_provider_create shall still succeed and only sign tokens on demand. ] */
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_011: [ If the worker thread is not running, credential_provider_request shall fail and return a non-zero value. ] */
+TEST_FUNCTION(credential_provider_create_thread_fail_signs_on_demand_succeed)
+{
+    //arrange
+    size_t expiry_time = TEST_EXPIRY_TIME;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(THREADAPI_ERROR);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    int request_result = credential_provider_request(handle, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+    char* sas_token = credential_provider_sign(handle, TEST_SCOPE, NULL, &expiry_time);
+
+    //assert
+    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_NOT_EQUAL(int, 0, request_result);
+    ASSERT_IS_NOT_NULL(sas_token);
+    ASSERT_ARE_EQUAL(size_t, 1, g_hsm_sign_count);
+
+    //cleanup
+    free(sas_token);
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_006: [ If provider_handle is NULL, credential_provider_destroy shall do nothing. ] */
+TEST_FUNCTION(credential_provider_destroy_handle_NULL_succeed)
+{
+    //arrange
+
+    //act
+    credential_provider_destroy(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_007: [ credential_provider_destroy shall remove the queued requests of the provider and wait for the one being signed before releasing its requests, tokens and the provider. ] */
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_029: [ When the last provider is destroyed, credential_provider_destroy shall stop and join the worker thread. ] */
+TEST_FUNCTION(credential_provider_destroy_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    (void)credential_provider_request(handle, TEST_SCOPE, TEST_KEY_NAME, TEST_EXPIRY_TIME);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    setup_clear_requests_mocks();
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(ThreadAPI_Join(TEST_THREAD_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    credential_provider_destroy(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_hsm_sign_count);
+
+    //cleanup
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_029: [ When the last provider is destroyed, credential_provider_destroy shall stop and join the worker thread. ] */
+TEST_FUNCTION(credential_provider_destroy_not_last_provider_keeps_worker_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle1 = credential_provider_create(software_hsm_sign, NULL);
+    CREDENTIAL_PROVIDER_HANDLE handle2 = credential_provider_create(software_hsm_sign, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    setup_clear_requests_mocks();
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    credential_provider_destroy(handle1);
+    int result = credential_provider_request(handle2, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    //cleanup
+    credential_provider_destroy(handle2);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_007: [ credential_provider_destroy shall remove the queued requests of the provider and wait for the one being signed before releasing its requests, tokens and the provider. ] */
+TEST_FUNCTION(credential_provider_destroy_drops_queued_requests_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle1 = credential_provider_create(software_hsm_sign, NULL);
+    CREDENTIAL_PROVIDER_HANDLE handle2 = credential_provider_create(software_hsm_sign, NULL);
+    (void)credential_provider_request(handle1, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+    (void)credential_provider_request(handle1, TEST_OTHER_SCOPE, NULL, TEST_EXPIRY_TIME);
+
+    //act
+    credential_provider_destroy(handle1);
+    run_worker_until_idle();
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 0, g_hsm_sign_count);
+
+    //cleanup
+    credential_provider_destroy(handle2);
+}
+
+TEST_FUNCTION(credential_provider_destroy_lock_fail_does_not_unlock)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE)).SetReturn(LOCK_ERROR);
+
+    //act
+    credential_provider_destroy(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_008: [ If provider_handle, scope or expiry_time are NULL, credential_provider_sign shall return NULL. ] */
+TEST_FUNCTION(credential_provider_sign_scope_NULL_fail)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    size_t expiry_time = TEST_EXPIRY_TIME;
+    umock_c_reset_all_calls();
+
+    //act
+    char* sas_token = credential_provider_sign(handle, NULL, NULL, &expiry_time);
+
+    //assert
+    ASSERT_IS_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_008: [ If provider_handle, scope or expiry_time are NULL, credential_provider_sign shall return NULL. ] */
+TEST_FUNCTION(credential_provider_sign_expiry_time_NULL_fail)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    umock_c_reset_all_calls();
+
+    //act
+    char* sas_token = credential_provider_sign(handle, TEST_SCOPE, NULL, NULL);
+
+    //assert
+    ASSERT_IS_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_009: [ Otherwise credential_provider_sign shall call sign_callback with expiry_time while holding the HSM lock and return its result. ] */
+TEST_FUNCTION(credential_provider_sign_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    size_t expiry_time = TEST_EXPIRY_TIME;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    setup_sign_token_mocks();
+
+    //act
+    char* sas_token = credential_provider_sign(handle, TEST_SCOPE, NULL, &expiry_time);
+
+    //assert
+    ASSERT_IS_NOT_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, "sr=contoso.azure-devices.net/devices/device_id&se=1000", sas_token);
+    ASSERT_ARE_EQUAL(size_t, TEST_EXPIRY_TIME, expiry_time);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(sas_token);
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_030: [ If a request for the same scope and key_name is pending, credential_provider_sign shall take it out of the queue and sign it itself. ] */
+TEST_FUNCTION(credential_provider_sign_claims_pending_request_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    size_t expiry_time = TEST_LATER_EXPIRY_TIME;
+    char* taken_token = NULL;
+    size_t taken_expiry_time;
+    (void)credential_provider_request(handle, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    setup_sign_token_mocks();
+
+    //act
+    char* sas_token = credential_provider_sign(handle, TEST_SCOPE, NULL, &expiry_time);
+    run_worker_until_idle();
+    CREDENTIAL_TOKEN_STATE state = credential_provider_take(handle, TEST_SCOPE, NULL, &taken_token, &taken_expiry_time);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, "sr=contoso.azure-devices.net/devices/device_id&se=2000", sas_token);
+    ASSERT_ARE_EQUAL(size_t, TEST_LATER_EXPIRY_TIME, expiry_time);
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_NONE, state);
+    ASSERT_ARE_EQUAL(size_t, 1, g_hsm_sign_count);
+
+    //cleanup
+    free(sas_token);
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_032: [ If a token for the same scope and key_name is signed, credential_provider_sign shall return it, release the request and set expiry_time to the expiry time of that token. ] */
+TEST_FUNCTION(credential_provider_sign_returns_ready_token_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    size_t expiry_time = TEST_LATER_EXPIRY_TIME;
+    (void)credential_provider_request(handle, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+    run_worker_until_idle();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    char* sas_token = credential_provider_sign(handle, TEST_SCOPE, NULL, &expiry_time);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, "sr=contoso.azure-devices.net/devices/device_id&se=1000", sas_token);
+    ASSERT_ARE_EQUAL(size_t, TEST_EXPIRY_TIME, expiry_time);
+    ASSERT_ARE_EQUAL(size_t, 1, g_hsm_sign_count);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(sas_token);
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_009: [ Otherwise credential_provider_sign shall call sign_callback with expiry_time while holding the HSM lock and return its result. ] */
+TEST_FUNCTION(credential_provider_sign_after_failed_request_signs_again_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    size_t expiry_time = TEST_EXPIRY_TIME;
+    (void)credential_provider_request(handle, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+    g_hsm_fail = true;
+    run_worker_until_idle();
+    g_hsm_fail = false;
+
+    //act
+    char* sas_token = credential_provider_sign(handle, TEST_SCOPE, NULL, &expiry_time);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, "sr=contoso.azure-devices.net/devices/device_id&se=1000", sas_token);
+    ASSERT_ARE_EQUAL(size_t, 2, g_hsm_sign_count);
+
+    //cleanup
+    free(sas_token);
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_010: [ If provider_handle or scope are NULL, credential_provider_request shall fail and return a non-zero value. ] */
+TEST_FUNCTION(credential_provider_request_scope_NULL_fail)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    umock_c_reset_all_calls();
+
+    //act
+    int result = credential_provider_request(handle, NULL, NULL, TEST_EXPIRY_TIME);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_013: [ Otherwise credential_provider_request shall add the request to the queue of the worker, signal it and return 0 without waiting for the signature. ] */
+TEST_FUNCTION(credential_provider_request_does_not_wait_for_hsm_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SCOPE));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_KEY_NAME));
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    int result = credential_provider_request(handle, TEST_SCOPE, TEST_KEY_NAME, TEST_EXPIRY_TIME);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_hsm_sign_count);
+    ASSERT_ARE_EQUAL(int, 0, (int)g_hsm_elapsed_ms);
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_012: [ If a request for the same scope and key_name is pending, being signed or ready, credential_provider_request shall return 0 without queuing another one. ] */
+TEST_FUNCTION(credential_provider_request_coalesces_identical_scope_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    char* sas_token = NULL;
+    size_t expiry_time = 0;
+
+    //act
+    int result1 = credential_provider_request(handle, TEST_SCOPE, TEST_KEY_NAME, TEST_EXPIRY_TIME);
+    int result2 = credential_provider_request(handle, TEST_SCOPE, TEST_KEY_NAME, TEST_EXPIRY_TIME);
+    run_worker_until_idle();
+    CREDENTIAL_TOKEN_STATE state = credential_provider_take(handle, TEST_SCOPE, TEST_KEY_NAME, &sas_token, &expiry_time);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result1);
+    ASSERT_ARE_EQUAL(int, 0, result2);
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_READY, state);
+    ASSERT_ARE_EQUAL(size_t, 1, g_hsm_sign_count);
+    ASSERT_ARE_EQUAL(int, (int)TEST_HSM_LATENCY_MS, (int)g_hsm_elapsed_ms);
+
+    //cleanup
+    free(sas_token);
+    credential_provider_destroy(handle);
+}
+
+TEST_FUNCTION(credential_provider_request_different_scopes_not_coalesced_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    char* sas_token1 = NULL;
+    char* sas_token2 = NULL;
+    char* sas_token3 = NULL;
+    size_t expiry_time;
+
+    //act
+    (void)credential_provider_request(handle, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+    (void)credential_provider_request(handle, TEST_SCOPE, TEST_KEY_NAME, TEST_EXPIRY_TIME);
+    (void)credential_provider_request(handle, TEST_OTHER_SCOPE, NULL, TEST_EXPIRY_TIME);
+    run_worker_until_idle();
+    CREDENTIAL_TOKEN_STATE state1 = credential_provider_take(handle, TEST_SCOPE, NULL, &sas_token1, &expiry_time);
+    CREDENTIAL_TOKEN_STATE state2 = credential_provider_take(handle, TEST_SCOPE, TEST_KEY_NAME, &sas_token2, &expiry_time);
+    CREDENTIAL_TOKEN_STATE state3 = credential_provider_take(handle, TEST_OTHER_SCOPE, NULL, &sas_token3, &expiry_time);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_READY, state1);
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_READY, state2);
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_READY, state3);
+    ASSERT_ARE_EQUAL(char_ptr, "sr=contoso.azure-devices.net/devices/other_id&se=1000", sas_token3);
+    ASSERT_ARE_EQUAL(size_t, 3, g_hsm_sign_count);
+
+    //cleanup
+    free(sas_token1);
+    free(sas_token2);
+    free(sas_token3);
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_014: [ If every slot holds an outstanding request, credential_provider_request shall fail and return a non-zero value. ] */
+TEST_FUNCTION(credential_provider_request_too_many_outstanding_fail)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    const char* key_names[] = { "key1", "key2", "key3", "key4", "key5" };
+    int results[5];
+
+    //act
+    for (size_t index = 0; index < 5; index++)
+    {
+        results[index] = credential_provider_request(handle, TEST_SCOPE, key_names[index], TEST_EXPIRY_TIME);
+    }
+    run_worker_until_idle();
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, results[0]);
+    ASSERT_ARE_EQUAL(int, 0, results[3]);
+    ASSERT_ARE_NOT_EQUAL(int, 0, results[4]);
+    ASSERT_ARE_EQUAL(size_t, 4, g_hsm_sign_count);
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+TEST_FUNCTION(credential_provider_request_replaces_uncollected_token_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    const char* key_names[] = { "key1", "key2", "key3", "key4" };
+    char* sas_token = NULL;
+    size_t expiry_time;
+    for (size_t index = 0; index < 4; index++)
+    {
+        (void)credential_provider_request(handle, TEST_SCOPE, key_names[index], TEST_EXPIRY_TIME);
+    }
+    // While the last one is being signed the other three are ready but never collected
+    g_request_while_signing_handle = handle;
+    g_request_while_signing_at = 4;
+
+    //act
+    run_worker_until_idle();
+    CREDENTIAL_TOKEN_STATE state = credential_provider_take(handle, TEST_OTHER_SCOPE, NULL, &sas_token, &expiry_time);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, g_request_while_signing_result);
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_READY, state);
+    ASSERT_ARE_EQUAL(size_t, 5, g_hsm_sign_count);
+
+    //cleanup
+    free(sas_token);
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_015: [ If any argument other than key_name is NULL, credential_provider_take shall return CREDENTIAL_TOKEN_STATE_FAILED. ] */
+TEST_FUNCTION(credential_provider_take_sas_token_NULL_fail)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    size_t expiry_time;
+    umock_c_reset_all_calls();
+
+    //act
+    CREDENTIAL_TOKEN_STATE state = credential_provider_take(handle, TEST_SCOPE, NULL, NULL, &expiry_time);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_FAILED, state);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_016: [ If there is no request for scope and key_name, credential_provider_take shall return CREDENTIAL_TOKEN_STATE_NONE. ] */
+TEST_FUNCTION(credential_provider_take_no_request_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    char* sas_token = NULL;
+    size_t expiry_time;
+    (void)credential_provider_request(handle, TEST_SCOPE, TEST_KEY_NAME, TEST_EXPIRY_TIME);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    CREDENTIAL_TOKEN_STATE state = credential_provider_take(handle, TEST_SCOPE, NULL, &sas_token, &expiry_time);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_NONE, state);
+    ASSERT_IS_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_017: [ If the request is pending or being signed, credential_provider_take shall return CREDENTIAL_TOKEN_STATE_PENDING. ] */
+TEST_FUNCTION(credential_provider_take_pending_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    char* sas_token = NULL;
+    size_t expiry_time;
+    (void)credential_provider_request(handle, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+    umock_c_reset_all_calls();
+
+    //act
+    CREDENTIAL_TOKEN_STATE state = credential_provider_take(handle, TEST_SCOPE, NULL, &sas_token, &expiry_time);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_PENDING, state);
+    ASSERT_IS_NULL(sas_token);
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_018: [ If the token is signed, credential_provider_take shall hand ownership of it and its expiry time to the caller, release the request and return CREDENTIAL_TOKEN_STATE_READY. ] */
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_020: [ The worker shall sign the pending requests of every provider in the order they were queued, one at a time, releasing the worker lock while sign_callback runs. ] */
+TEST_FUNCTION(credential_provider_take_ready_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    char* sas_token = NULL;
+    size_t expiry_time = 0;
+    (void)credential_provider_request(handle, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    setup_sign_token_mocks();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_SIGNED_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Condition_Wait(TEST_COND_HANDLE, TEST_LOCK_HANDLE, 0));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    run_worker_until_idle();
+    CREDENTIAL_TOKEN_STATE state = credential_provider_take(handle, TEST_SCOPE, NULL, &sas_token, &expiry_time);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_READY, state);
+    ASSERT_ARE_EQUAL(char_ptr, "sr=contoso.azure-devices.net/devices/device_id&se=1000", sas_token);
+    ASSERT_ARE_EQUAL(size_t, TEST_EXPIRY_TIME, expiry_time);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(sas_token);
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_019: [ If signing failed, credential_provider_take shall release the request and return CREDENTIAL_TOKEN_STATE_FAILED. ] */
+TEST_FUNCTION(credential_provider_take_sign_failed_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    char* sas_token = NULL;
+    size_t expiry_time;
+    (void)credential_provider_request(handle, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+    g_hsm_fail = true;
+    run_worker_until_idle();
+    umock_c_reset_all_calls();
+
+    //act
+    CREDENTIAL_TOKEN_STATE state1 = credential_provider_take(handle, TEST_SCOPE, NULL, &sas_token, &expiry_time);
+    CREDENTIAL_TOKEN_STATE state2 = credential_provider_take(handle, TEST_SCOPE, NULL, &sas_token, &expiry_time);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_FAILED, state1);
+    ASSERT_ARE_EQUAL(int, CREDENTIAL_TOKEN_STATE_NONE, state2);
+    ASSERT_IS_NULL(sas_token);
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_020: [ The worker shall sign the pending requests of every provider in the order they were queued, one at a time, releasing the worker lock while sign_callback runs. ] */
+TEST_FUNCTION(credential_provider_worker_signs_every_provider_in_queue_order_succeed)
+{
+    //arrange
+    int context1;
+    int context2;
+    CREDENTIAL_PROVIDER_HANDLE handle1 = credential_provider_create(software_hsm_sign, &context1);
+    CREDENTIAL_PROVIDER_HANDLE handle2 = credential_provider_create(software_hsm_sign, &context2);
+    (void)credential_provider_request(handle1, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+    (void)credential_provider_request(handle2, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+    (void)credential_provider_request(handle1, TEST_OTHER_SCOPE, NULL, TEST_EXPIRY_TIME);
+
+    //act
+    run_worker_until_idle();
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 3, g_hsm_sign_count);
+    ASSERT_ARE_EQUAL(void_ptr, &context1, g_hsm_sign_contexts[0]);
+    ASSERT_ARE_EQUAL(void_ptr, &context2, g_hsm_sign_contexts[1]);
+    ASSERT_ARE_EQUAL(void_ptr, &context1, g_hsm_sign_contexts[2]);
+
+    //cleanup
+    credential_provider_destroy(handle1);
+    credential_provider_destroy(handle2);
+}
+
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_021: [ When nothing is pending the worker shall wait on the condition. ] */
+/* Tests_SRS_IOTHUB_CLIENT_CREDENTIAL_PROVIDER_07_022: [ If waiting fails, the worker shall stop and mark the pending requests as failed. ] */
+TEST_FUNCTION(credential_provider_worker_wait_fail_stops_worker_succeed)
+{
+    //arrange
+    CREDENTIAL_PROVIDER_HANDLE handle = credential_provider_create(software_hsm_sign, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Condition_Wait(TEST_COND_HANDLE, TEST_LOCK_HANDLE, 0));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    run_worker_until_idle();
+    int result = credential_provider_request(handle, TEST_SCOPE, NULL, TEST_EXPIRY_TIME);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, g_hsm_sign_count);
+
+    //cleanup
+    credential_provider_destroy(handle);
+}
+
+END_TEST_SUITE(iothub_client_credential_provider_ut)
@@ -489,6 +489,8 @@ TEST_FUNCTION(Retrieve_Options_NULL_handle)
 // Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_046: [An instance of OPTIONHANDLER_HANDLE (a.k.a. `options`) shall be created using OptionHandler_Create]
 // Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_050: [`retry_control->initial_wait_time_in_secs` shall be added to `options` using OptionHandler_Add]
 // Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_051: [`retry_control->max_jitter_percent` shall be added to `options` using OptionHandler_Add]
+// Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_066: [`retry_control->max_wait_time_in_secs` shall be set to 60]
+// Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_070: [`retry_control->max_wait_time_in_secs` shall be added to `options` using OptionHandler_Add]
 // Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_054: [If no errors occur, `retry_control_retrieve_options` shall return the OPTIONHANDLER_HANDLE instance]
 TEST_FUNCTION(Retrieve_Options_success)
 {
@@ -503,6 +505,8 @@ TEST_FUNCTION(Retrieve_Options_success)
         .IgnoreArgument_value();
     STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, RETRY_CONTROL_OPTION_MAX_JITTER_PERCENT, IGNORED_PTR_ARG))
         .IgnoreArgument_value();
+    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, RETRY_CONTROL_OPTION_MAX_WAIT_TIME_IN_SECS, IGNORED_PTR_ARG))
+        .IgnoreArgument_value();
 
     // act
     OPTIONHANDLER_HANDLE result = retry_control_retrieve_options(handle);
@@ -510,7 +514,7 @@ TEST_FUNCTION(Retrieve_Options_success)
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(void_ptr, TEST_OPTIONHANDLER_HANDLE, result);
-    ASSERT_ARE_EQUAL(int, 5, TEST_OptionHandler_AddOption_saved_value);
+    ASSERT_ARE_EQUAL(int, 60, TEST_OptionHandler_AddOption_saved_value);
 
     // cleanup
     retry_control_destroy(handle);
@@ -534,6 +538,8 @@ TEST_FUNCTION(Retrieve_Options_failure_checks)
         .IgnoreArgument_value();
     STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, RETRY_CONTROL_OPTION_MAX_JITTER_PERCENT, IGNORED_PTR_ARG))
         .IgnoreArgument_value();
+    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, RETRY_CONTROL_OPTION_MAX_WAIT_TIME_IN_SECS, IGNORED_PTR_ARG))
+        .IgnoreArgument_value();
     umock_c_negative_tests_snapshot();
 
     // act
@@ -653,6 +659,26 @@ TEST_FUNCTION(Set_Options_INVALID_max_jitter_percent)
     retry_control_destroy(handle);
 }
 
+// Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_068: [If `name` is "max_wait_time_in_secs" and `value` is less than 1, `retry_control_set_option` shall fail and return non-zero]
+TEST_FUNCTION(Set_Options_INVALID_max_wait_time_in_secs)
+{
+    // arrange
+    RETRY_CONTROL_HANDLE handle = create_retry_control(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER, 10);
+
+    umock_c_reset_all_calls();
+
+    // act
+    unsigned int value = 0;
+    int result = retry_control_set_option(handle, RETRY_CONTROL_OPTION_MAX_WAIT_TIME_IN_SECS, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    retry_control_destroy(handle);
+}
+
 // Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_041: [If `name` is "retry_control_options", value shall be fed to `retry_control` using OptionHandler_FeedOptions]
 // Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_044: [If no errors occur, `retry_control_set_option` shall return 0]
 TEST_FUNCTION(Set_Options_success)
@@ -936,6 +962,48 @@ TEST_FUNCTION(Should_Retry_EXPONENTIAL_BACKOFF_success)
     retry_control_destroy(handle);
 }
 
+// Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_064: [If `retry_control->policy` is IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER, `calculate_next_wait_time` shall return a random value between `retry_control->initial_wait_time_in_secs` and 3 times the previous wait time (or `retry_control->initial_wait_time_in_secs` on the first retry), drawn from the per-instance generator]
+// Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_065: [If the decorrelated jitter wait time is greater than `retry_control->max_wait_time_in_secs`, `calculate_next_wait_time` shall return `retry_control->max_wait_time_in_secs`]
+// Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_069: [If `name` is "max_wait_time_in_secs", `value` shall be saved on `retry_control->max_wait_time_in_secs`]
+TEST_FUNCTION(Should_Retry_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER_success)
+{
+    // arrange
+    unsigned int initial_wait_time_in_secs = 2;
+    unsigned int max_wait_time_in_secs = 10;
+    unsigned int max_retry_time_in_secs = 3600;
+    RETRY_CONTROL_HANDLE handle = create_retry_control(IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER, max_retry_time_in_secs);
+
+    int set_option_result1 = retry_control_set_option(handle, RETRY_CONTROL_OPTION_INITIAL_WAIT_TIME_IN_SECS, &initial_wait_time_in_secs);
+    int set_option_result2 = retry_control_set_option(handle, RETRY_CONTROL_OPTION_MAX_WAIT_TIME_IN_SECS, &max_wait_time_in_secs);
+
+    time_t first_time = TEST_current_time;
+    time_t last_time = TEST_current_time;
+    time_t current_time = TEST_current_time;
+
+    run_and_verify_should_retry(handle, INDEFINITE_TIME, INDEFINITE_TIME, current_time, 0, 0, RETRY_ACTION_RETRY_NOW, true);
+
+    // act
+    // assert
+    int i;
+    for (i = 0; i < 20; i++)
+    {
+        // Never sooner than the initial wait time...
+        current_time = add_seconds(last_time, initial_wait_time_in_secs - 1);
+        run_and_verify_should_retry(handle, first_time, last_time, current_time, i * max_wait_time_in_secs + initial_wait_time_in_secs - 1, initial_wait_time_in_secs - 1, RETRY_ACTION_RETRY_LATER, false);
+
+        // ... and never later than the cap.
+        current_time = add_seconds(last_time, max_wait_time_in_secs);
+        run_and_verify_should_retry(handle, first_time, last_time, current_time, (i + 1) * max_wait_time_in_secs, max_wait_time_in_secs, RETRY_ACTION_RETRY_NOW, false);
+        last_time = current_time;
+    }
+
+    ASSERT_ARE_EQUAL(int, 0, set_option_result1);
+    ASSERT_ARE_EQUAL(int, 0, set_option_result2);
+
+    // cleanup
+    retry_control_destroy(handle);
+}
+
 // Tests_SRS_IOTHUB_CLIENT_RETRY_CONTROL_09_029: [If `retry_control->policy_name` is IOTHUB_CLIENT_RETRY_INTERVAL, `calculate_next_wait_time` shall return `retry_control->initial_wait_time_in_secs`]
 TEST_FUNCTION(Should_Retry_INTERVAL_success)
 {
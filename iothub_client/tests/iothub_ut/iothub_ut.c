@@ -19,6 +19,8 @@
 
 #define ENABLE_MOCKS
 #include "azure_c_shared_utility/platform.h"
+#include "internal/iothub_client_connection_governor.h"
+#include "internal/iothub_client_credential_provider.h"
 #undef ENABLE_MOCKS
 
 #include "iothub.h"
@@ -44,6 +46,12 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_GLOBAL_MOCK_RETURN(platform_init, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(platform_init, __LINE__);
+    REGISTER_GLOBAL_MOCK_RETURN(connection_governor_init, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(connection_governor_init, __LINE__);
+    REGISTER_GLOBAL_MOCK_RETURN(credential_provider_init, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(credential_provider_init, __LINE__);
+    REGISTER_GLOBAL_MOCK_RETURN(connection_governor_set_rate, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(connection_governor_set_rate, __LINE__);
 }
 
 TEST_SUITE_CLEANUP(suite_cleanup)
@@ -52,10 +60,17 @@ TEST_SUITE_CLEANUP(suite_cleanup)
     TEST_MUTEX_DESTROY(test_serialize_mutex);
 }
 
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    umock_c_reset_all_calls();
+}
+
 TEST_FUNCTION(IoTHub_Init_succeed)
 {
     //arrange
     STRICT_EXPECTED_CALL(platform_init());
+    STRICT_EXPECTED_CALL(connection_governor_init());
+    STRICT_EXPECTED_CALL(credential_provider_init());
 
     //act
     int result = IoTHub_Init();
@@ -78,9 +93,43 @@ TEST_FUNCTION(IoTHub_Init_fail)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
+TEST_FUNCTION(IoTHub_Init_governor_fail)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(platform_init());
+    STRICT_EXPECTED_CALL(connection_governor_init()).SetReturn(__LINE__);
+    STRICT_EXPECTED_CALL(platform_deinit());
+
+    //act
+    int result = IoTHub_Init();
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHub_Init_credential_provider_fail)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(platform_init());
+    STRICT_EXPECTED_CALL(connection_governor_init());
+    STRICT_EXPECTED_CALL(credential_provider_init()).SetReturn(__LINE__);
+    STRICT_EXPECTED_CALL(connection_governor_deinit());
+    STRICT_EXPECTED_CALL(platform_deinit());
+
+    //act
+    int result = IoTHub_Init();
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 TEST_FUNCTION(IoTHub_Deinit_succeed)
 {
     //arrange
+    STRICT_EXPECTED_CALL(credential_provider_deinit());
+    STRICT_EXPECTED_CALL(connection_governor_deinit());
     STRICT_EXPECTED_CALL(platform_deinit());
 
     //act
@@ -90,4 +139,30 @@ TEST_FUNCTION(IoTHub_Deinit_succeed)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
+TEST_FUNCTION(IoTHub_SetConnectionRateLimit_succeed)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(connection_governor_set_rate(50, 100));
+
+    //act
+    int result = IoTHub_SetConnectionRateLimit(50, 100);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(IoTHub_SetConnectionRateLimit_fail)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(connection_governor_set_rate(50, 0)).SetReturn(__LINE__);
+
+    //act
+    int result = IoTHub_SetConnectionRateLimit(50, 0);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(iothub_ut)
@@ -2965,6 +2965,8 @@ TEST_FUNCTION(IoTHubClientCore_LL_DoWork_calls_underlying_succeeds)
 
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
+
     //act
     IoTHubClientCore_LL_DoWork(handle);
 
@@ -3848,6 +3850,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_calls_timeout_callbac
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*destroying the IOTHUB_MESSAGE_LIST*/
         .IgnoreArgument(1);
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
 
     //act
     IoTHubClientCore_LL_DoWork(handle);
@@ -3883,6 +3886,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_defaults_to_zero)
         .IgnoreArgument(1)
         .CopyOutArgumentBuffer(2, &twelve, sizeof(twelve));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
 
     //act
     IoTHubClientCore_LL_DoWork(handle);
@@ -3927,6 +3931,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_only_removes_the_mess
 
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
 
     //act
     IoTHubClientCore_LL_DoWork(handle);
@@ -3962,6 +3967,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_when_exactly_on_the_e
 
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
 
     //act
     IoTHubClientCore_LL_DoWork(handle);
@@ -4009,6 +4015,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_with_timeouts_at_11_and_1
 
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
 
     /*because we're at time = 12 in this test, the second message is untouched*/
 
@@ -4068,6 +4075,8 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_with_timeouts_at_11_and_1
 
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
+
     timeIsNow = 13; /*13 > 10 (receive time) + 2 (timeout) => timeout!!!*/
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreArgument(1)
@@ -4083,6 +4092,8 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_with_timeouts_at_11_and_1
 
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
+
 
     /*because we're at time = 13 in this test, the second message times out too*/
 
@@ -4143,6 +4154,8 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_one_with_timeout_one_with
 
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
+
     {/*this scope happen in the second _DoWork call*/
         tickcounter_ms_t timeIsNow = 999999999UL; /*some very big number*/
         STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -4150,6 +4163,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_2_messages_one_with_timeout_one_with
             .CopyOutArgumentBuffer(2, &timeIsNow, sizeof(timeIsNow));
     }
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
 
     //act
     IoTHubClientCore_LL_DoWork(handle);
@@ -4193,6 +4207,7 @@ TEST_FUNCTION(IoTHubClientCore_LL_SetOption_messageTimeout_when_tickcounter_fail
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
 
     //act
     IoTHubClientCore_LL_DoWork(handle);
@@ -4496,6 +4511,8 @@ TEST_FUNCTION(IoTHubClientCore_LL_DoWork_SendReportedState_succeed)
 
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
+
     //act
     IoTHubClientCore_LL_DoWork(h);
 
@@ -4527,6 +4544,8 @@ TEST_FUNCTION(IoTHubClientCore_LL_DoWork_SendReportedState_continue_processing_s
 
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG));
 
+    EXPECTED_CALL(IoTHubClient_Auth_Refresh_SasToken_Cache(IGNORED_PTR_ARG));
+
     //act
     IoTHubClientCore_LL_DoWork(h);
 
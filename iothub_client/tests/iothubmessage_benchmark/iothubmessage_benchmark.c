@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Measures the cost of the typical life of a telemetry message: create, set 5 application properties,
+// clone (as IoTHubDeviceClient_LL_SendEventAsync does) and destroy both copies.
+// It is built once against iothub_message.c and once against iothub_message_compact.c so the two
+// layouts can be compared on the same machine.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "iothub_message.h"
+
+#define ITERATION_COUNT         200000
+#define PROPERTY_COUNT          5
+
+static const unsigned char TELEMETRY_BODY[] = "{\"temperature\":21.5,\"humidity\":48.25}";
+
+static const char* PROPERTY_KEYS[PROPERTY_COUNT] = { "temperatureAlert", "sensorId", "firmware", "batch", "priority" };
+static const char* PROPERTY_VALUES[PROPERTY_COUNT] = { "false", "sensor-0042", "1.4.2", "17", "normal" };
+
+typedef struct BENCHMARK_SCENARIO_TAG
+{
+    const char* name;
+    bool get_properties_map;
+} BENCHMARK_SCENARIO;
+
+static const BENCHMARK_SCENARIO scenarios[] =
+{
+    { "create + 5 properties + clone + destroy", false },
+    // What the transports do when sending the message
+    { "create + 5 properties + clone + IoTHubMessage_Properties + destroy", true }
+};
+
+static int run_iteration(const BENCHMARK_SCENARIO* scenario)
+{
+    int result;
+    IOTHUB_MESSAGE_HANDLE message;
+
+    if ((message = IoTHubMessage_CreateFromByteArray(TELEMETRY_BODY, sizeof(TELEMETRY_BODY) - 1)) == NULL)
+    {
+        LogError("Failed creating the message");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        IOTHUB_MESSAGE_HANDLE clone;
+        size_t i;
+
+        result = 0;
+
+        for (i = 0; i < PROPERTY_COUNT && result == 0; i++)
+        {
+            if (IoTHubMessage_SetProperty(message, PROPERTY_KEYS[i], PROPERTY_VALUES[i]) != IOTHUB_MESSAGE_OK)
+            {
+                LogError("Failed setting property %s", PROPERTY_KEYS[i]);
+                result = MU_FAILURE;
+            }
+        }
+
+        if (result != 0)
+        {
+            // Error already logged
+        }
+        else if ((clone = IoTHubMessage_Clone(message)) == NULL)
+        {
+            LogError("Failed cloning the message");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            if (scenario->get_properties_map && IoTHubMessage_Properties(clone) == NULL)
+            {
+                LogError("Failed getting the message properties");
+                result = MU_FAILURE;
+            }
+
+            IoTHubMessage_Destroy(clone);
+        }
+
+        IoTHubMessage_Destroy(message);
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int result;
+    TICK_COUNTER_HANDLE tick_counter;
+
+    (void)argc;
+
+    if ((tick_counter = tickcounter_create()) == NULL)
+    {
+        LogError("Failed creating the tick counter");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        size_t i;
+
+        result = 0;
+
+        (void)printf("%s: %d iterations\r\n", argv[0], ITERATION_COUNT);
+
+        for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]) && result == 0; i++)
+        {
+            tickcounter_ms_t start_ms;
+            tickcounter_ms_t end_ms;
+            size_t iteration;
+
+            (void)tickcounter_get_current_ms(tick_counter, &start_ms);
+
+            for (iteration = 0; iteration < ITERATION_COUNT && result == 0; iteration++)
+            {
+                result = run_iteration(&scenarios[i]);
+            }
+
+            (void)tickcounter_get_current_ms(tick_counter, &end_ms);
+
+            if (result == 0)
+            {
+                (void)printf("%-70s %8lu ms %8.1f ns/iteration\r\n", scenarios[i].name,
+                    (unsigned long)(end_ms - start_ms), (double)(end_ms - start_ms) * 1000000.0 / ITERATION_COUNT);
+            }
+        }
+
+        tickcounter_destroy(tick_counter);
+    }
+
+    return result;
+}
@@ -0,0 +1,1433 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#endif
+
+#include <stdio.h>
+
+#include "testrunnerswitcher.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "umock_c/umocktypes_stdint.h"
+
+static bool g_fail_malloc = false;
+static size_t g_live_allocations = 0;
+
+static void* my_gballoc_malloc(size_t size)
+{
+    void* result = (g_fail_malloc ? NULL : malloc(size));
+    if (result != NULL)
+    {
+        g_live_allocations++;
+    }
+    return result;
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    if (ptr != NULL)
+    {
+        g_live_allocations--;
+    }
+    free(ptr);
+}
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/map.h"
+
+#undef ENABLE_MOCKS
+
+#include "iothub_message.h"
+
+static const unsigned char c[1] = { '3' };
+static const char* TEST_STRING_VALUE = "aaaa";
+static const char* TEST_MESSAGE_ID = "3820ADAE-E3CA-4065-843A-A6BDE950D8DC";
+static const char* TEST_CORRELATION_ID = "052BA01A-ECBF-48CF-BC7B-64B315D898B7";
+static const char* TEST_CONTENT_TYPE = "text/plain";
+static const char* TEST_CONTENT_ENCODING = "utf8";
+static const char* TEST_PROPERTY_KEY = "property_key";
+static const char* TEST_PROPERTY_VALUE = "property_value";
+static const char* TEST_PROPERTY_VALUE_SHORT = "short";
+static const char* TEST_PROPERTY_VALUE_LONG = "a property value that is longer than the one it replaces";
+static const char* TEST_INVALID_MAP_KEY = "Inval\nd_key";
+static const char* TEST_MAP_VALUE = "map_value";
+
+static IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA TEST_DIAGNOSTIC_DATA = { "12345678",  "1506054179" };
+
+#define TEST_LARGE_BODY_SIZE        2048
+#define TEST_MANY_PROPERTIES        64
+
+TEST_DEFINE_ENUM_TYPE(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_RESULT_VALUES);
+
+TEST_DEFINE_ENUM_TYPE(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_CONTENT_TYPE_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_CONTENT_TYPE_VALUES);
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+static MAP_HANDLE my_Map_Create(MAP_FILTER_CALLBACK mapFilterFunc)
+{
+    (void)mapFilterFunc;
+    return (MAP_HANDLE)my_gballoc_malloc(1);
+}
+
+static MAP_HANDLE my_Map_Clone(MAP_HANDLE handle)
+{
+    (void)handle;
+    return (MAP_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_Map_Destroy(MAP_HANDLE handle)
+{
+    my_gballoc_free(handle);
+}
+
+static MAP_RESULT my_Map_ContainsKey(MAP_HANDLE handle, const char* key, bool* keyExists)
+{
+    (void)handle;
+    (void)key;
+    *keyExists = true;
+    return MAP_OK;
+}
+
+static MAP_RESULT my_Map_GetInternals(MAP_HANDLE handle, const char*const** keys, const char*const** values, size_t* count)
+{
+    (void)handle;
+    *keys = &TEST_PROPERTY_KEY;
+    *values = &TEST_MAP_VALUE;
+    *count = 1;
+    return MAP_OK;
+}
+
+typedef const char*(*PFN_MESSAGE_GET_STRING)(IOTHUB_MESSAGE_HANDLE handle);
+typedef IOTHUB_MESSAGE_RESULT(*PFN_MESSAGE_SET_STRING)(IOTHUB_MESSAGE_HANDLE handle, const char *string);
+
+typedef struct SYSTEM_PROPERTY_ACCESSORS_TAG
+{
+    PFN_MESSAGE_SET_STRING set;
+    PFN_MESSAGE_GET_STRING get;
+    const char* value;
+} SYSTEM_PROPERTY_ACCESSORS;
+
+static const SYSTEM_PROPERTY_ACCESSORS system_property_accessors[] =
+{
+    { IoTHubMessage_SetMessageId, IoTHubMessage_GetMessageId, "3820ADAE-E3CA-4065-843A-A6BDE950D8DC" },
+    { IoTHubMessage_SetCorrelationId, IoTHubMessage_GetCorrelationId, "052BA01A-ECBF-48CF-BC7B-64B315D898B7" },
+    { IoTHubMessage_SetContentTypeSystemProperty, IoTHubMessage_GetContentTypeSystemProperty, "text/plain" },
+    { IoTHubMessage_SetContentEncodingSystemProperty, IoTHubMessage_GetContentEncodingSystemProperty, "utf8" },
+    { IoTHubMessage_SetOutputName, IoTHubMessage_GetOutputName, "outputname" },
+    { IoTHubMessage_SetInputName, IoTHubMessage_GetInputName, "inputname" },
+    { IoTHubMessage_SetConnectionModuleId, IoTHubMessage_GetConnectionModuleId, "connectionmoduleid" },
+    { IoTHubMessage_SetConnectionDeviceId, IoTHubMessage_GetConnectionDeviceId, "connectiondeviceid" }
+};
+
+#define SYSTEM_PROPERTY_ACCESSORS_COUNT (sizeof(system_property_accessors) / sizeof(system_property_accessors[0]))
+
+static void set_all_system_properties(IOTHUB_MESSAGE_HANDLE h)
+{
+    size_t i;
+
+    for (i = 0; i < SYSTEM_PROPERTY_ACCESSORS_COUNT; i++)
+    {
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, system_property_accessors[i].set(h, system_property_accessors[i].value));
+    }
+}
+
+static void assert_all_system_properties(IOTHUB_MESSAGE_HANDLE h)
+{
+    size_t i;
+
+    for (i = 0; i < SYSTEM_PROPERTY_ACCESSORS_COUNT; i++)
+    {
+        ASSERT_ARE_EQUAL(char_ptr, system_property_accessors[i].value, system_property_accessors[i].get(h), "system property %lu", (unsigned long)i);
+    }
+}
+
+static void make_property(size_t index, char* key, size_t key_size, char* value, size_t value_size)
+{
+    (void)snprintf(key, key_size, "key_%lu", (unsigned long)index);
+    (void)snprintf(value, value_size, "value_%lu_with_some_padding", (unsigned long)index);
+}
+
+static char g_keys[TEST_MANY_PROPERTIES][32];
+static char g_values[TEST_MANY_PROPERTIES][64];
+static const char* g_key_list[TEST_MANY_PROPERTIES];
+static const char* g_value_list[TEST_MANY_PROPERTIES];
+
+static void make_property_lists(void)
+{
+    size_t i;
+
+    for (i = 0; i < TEST_MANY_PROPERTIES; i++)
+    {
+        make_property(i, g_keys[i], sizeof(g_keys[i]), g_values[i], sizeof(g_values[i]));
+        g_key_list[i] = g_keys[i];
+        g_value_list[i] = g_values[i];
+    }
+}
+
+static void set_many_properties(IOTHUB_MESSAGE_HANDLE h, size_t count)
+{
+    size_t i;
+    char key[32];
+    char value[64];
+
+    for (i = 0; i < count; i++)
+    {
+        make_property(i, key, sizeof(key), value, sizeof(value));
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperty(h, key, value));
+    }
+}
+
+static void assert_many_properties(IOTHUB_MESSAGE_HANDLE h, size_t count)
+{
+    size_t i;
+    char key[32];
+    char value[64];
+
+    for (i = 0; i < count; i++)
+    {
+        make_property(i, key, sizeof(key), value, sizeof(value));
+        ASSERT_ARE_EQUAL(char_ptr, value, IoTHubMessage_GetProperty(h, key));
+    }
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+BEGIN_TEST_SUITE(iothubmessage_compact_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(MAP_FILTER_CALLBACK, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(MAP_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(MAP_RESULT, int);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_HOOK(Map_Create, my_Map_Create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_Create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(Map_Clone, my_Map_Clone);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_Clone, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(Map_Destroy, my_Map_Destroy);
+    REGISTER_GLOBAL_MOCK_RETURN(Map_AddOrUpdate, MAP_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_AddOrUpdate, MAP_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(Map_ContainsKey, my_Map_ContainsKey);
+    REGISTER_GLOBAL_MOCK_RETURN(Map_GetValueFromKey, TEST_MAP_VALUE);
+    REGISTER_GLOBAL_MOCK_HOOK(Map_GetInternals, my_Map_GetInternals);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+    umock_c_reset_all_calls();
+    g_fail_malloc = false;
+    g_live_allocations = 0;
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_02_026: [The type of the new message shall be IOTHUBMESSAGE_BYTEARRAY.] */
+/*Tests_SRS_IOTHUBMESSAGE_09_100: [The message, its properties and bodies of up to 512 bytes shall be stored in a single allocation.]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_single_allocation_succeeds)
+{
+    // arrange
+    const unsigned char* buffer;
+    size_t size;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+
+    //assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_BYTEARRAY, IoTHubMessage_GetContentType(h));
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(h, &buffer, &size));
+    ASSERT_ARE_EQUAL(size_t, 1, size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(buffer, c, 1));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_06_001: [If size is zero then byteArray may be NULL.]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_NULL_and_zero_size_succeeds)
+{
+    // arrange
+    const unsigned char* buffer;
+    size_t size = 1;
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(NULL, 0);
+
+    //assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(h, &buffer, &size));
+    ASSERT_ARE_EQUAL(size_t, 0, size);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_06_002: [If size is NOT zero then byteArray MUST NOT be NULL*/
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_NULL_and_non_zero_size_fails)
+{
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(NULL, 1);
+
+    //assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_02_024: [If there are any errors then IoTHubMessage_CreateFromByteArray shall return NULL.] */
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_malloc_fails)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+
+    //assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_101: [Bodies larger than 512 bytes shall be stored in their own allocation.]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_large_body_succeeds)
+{
+    // arrange
+    unsigned char body[TEST_LARGE_BODY_SIZE];
+    const unsigned char* buffer;
+    size_t size;
+    memset(body, 'x', sizeof(body));
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(TEST_LARGE_BODY_SIZE));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(body, sizeof(body));
+
+    //assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(h, &buffer, &size));
+    ASSERT_ARE_EQUAL(size_t, TEST_LARGE_BODY_SIZE, size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(buffer, body, sizeof(body)));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_large_body_malloc_fails)
+{
+    // arrange
+    unsigned char body[TEST_LARGE_BODY_SIZE];
+    memset(body, 'x', sizeof(body));
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(TEST_LARGE_BODY_SIZE))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(body, sizeof(body));
+
+    //assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_02_032: [The type of the new message shall be IOTHUBMESSAGE_STRING.] */
+/*Tests_SRS_IOTHUBMESSAGE_02_018: [IoTHubMessage_GetStringData shall return the currently stored null terminated string.] */
+TEST_FUNCTION(IoTHubMessage_CreateFromString_single_allocation_succeeds)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromString(TEST_STRING_VALUE);
+
+    //assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_STRING, IoTHubMessage_GetContentType(h));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_STRING_VALUE, IoTHubMessage_GetString(h));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_CreateFromString_NULL_fails)
+{
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromString(NULL);
+
+    //assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_02_017: [IoTHubMessage_GetString shall return NULL if the iotHubMessageHandle does not refer to a IOTHUBMESSAGE of type STRING.] */
+/*Tests_SRS_IOTHUBMESSAGE_02_021: [If iotHubMessageHandle is not a iothubmessage containing BYTEARRAY data, then IoTHubMessage_GetData shall write in *buffer NULL and shall set *size to 0.] */
+TEST_FUNCTION(IoTHubMessage_body_getters_check_content_type)
+{
+    // arrange
+    const unsigned char* buffer;
+    size_t size;
+    IOTHUB_MESSAGE_HANDLE bytes = IoTHubMessage_CreateFromByteArray(c, 1);
+    IOTHUB_MESSAGE_HANDLE text = IoTHubMessage_CreateFromString(TEST_STRING_VALUE);
+
+    //act
+    const char* string_result = IoTHubMessage_GetString(bytes);
+    IOTHUB_MESSAGE_RESULT bytes_result = IoTHubMessage_GetByteArray(text, &buffer, &size);
+
+    //assert
+    ASSERT_IS_NULL(string_result);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, bytes_result);
+
+    //cleanup
+    IoTHubMessage_Destroy(bytes);
+    IoTHubMessage_Destroy(text);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_102: [A new value of a system property shall be appended to the arena, leaving the previous value untouched.]*/
+TEST_FUNCTION(IoTHubMessage_system_properties_succeed_without_allocations)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    set_all_system_properties(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    assert_all_system_properties(h);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_system_properties_NULL_handle_fail)
+{
+    size_t i;
+
+    for (i = 0; i < SYSTEM_PROPERTY_ACCESSORS_COUNT; i++)
+    {
+        //act
+        IOTHUB_MESSAGE_RESULT result = system_property_accessors[i].set(NULL, system_property_accessors[i].value);
+        const char* value = system_property_accessors[i].get(NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result);
+        ASSERT_IS_NULL(value);
+    }
+}
+
+TEST_FUNCTION(IoTHubMessage_system_properties_NULL_value_fail)
+{
+    // arrange
+    size_t i;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    for (i = 0; i < SYSTEM_PROPERTY_ACCESSORS_COUNT; i++)
+    {
+        //act
+        IOTHUB_MESSAGE_RESULT result = system_property_accessors[i].set(h, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result);
+        ASSERT_IS_NULL(system_property_accessors[i].get(h));
+    }
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_SetMessageId_replaces_value)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetMessageId(h, TEST_PROPERTY_VALUE_SHORT));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetMessageId(h, TEST_MESSAGE_ID);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_SetMessageId(h, TEST_PROPERTY_VALUE_SHORT);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result2);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE_SHORT, IoTHubMessage_GetMessageId(h));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_SetCorrelationId_with_value_from_same_message_succeeds)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetMessageId(h, TEST_MESSAGE_ID));
+    set_many_properties(h, TEST_MANY_PROPERTIES);
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetCorrelationId(h, IoTHubMessage_GetMessageId(h));
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MESSAGE_ID, IoTHubMessage_GetCorrelationId(h));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MESSAGE_ID, IoTHubMessage_GetMessageId(h));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_SetProperty_with_values_from_same_message_when_arena_grows_succeeds)
+{
+    // arrange
+    char long_value[301];
+    memset(long_value, 'm', sizeof(long_value) - 1);
+    long_value[sizeof(long_value) - 1] = '\0';
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetMessageId(h, long_value));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetCorrelationId(h, IoTHubMessage_GetMessageId(h));
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_SetProperty(h, IoTHubMessage_GetMessageId(h), IoTHubMessage_GetCorrelationId(h));
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result2);
+    ASSERT_ARE_EQUAL(char_ptr, long_value, IoTHubMessage_GetCorrelationId(h));
+    ASSERT_ARE_EQUAL(char_ptr, long_value, IoTHubMessage_GetProperty(h, long_value));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_107: [New properties shall be appended to the property table in the arena.]*/
+/*Tests_SRS_IOTHUBMESSAGE_09_121: [When the arena grows, the block it outgrew shall be kept until IoTHubMessage_Destroy, so strings and bodies returned by the getters stay valid for the lifetime of the message.]*/
+TEST_FUNCTION(IoTHubMessage_getter_results_stay_valid_when_the_arena_grows)
+{
+    // arrange
+    const unsigned char* body;
+    size_t body_size;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetMessageId(h, TEST_MESSAGE_ID));
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE));
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(h, &body, &body_size));
+    const char* message_id = IoTHubMessage_GetMessageId(h);
+    const char* property_value = IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY);
+
+    //act
+    set_many_properties(h, TEST_MANY_PROPERTIES);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetCorrelationId(h, TEST_CORRELATION_ID));
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MESSAGE_ID, message_id);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE, property_value);
+    ASSERT_ARE_EQUAL(size_t, 1, body_size);
+    ASSERT_ARE_EQUAL(int, (int)c[0], (int)body[0]);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MESSAGE_ID, IoTHubMessage_GetMessageId(h));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_SetProperty_succeeds_without_allocations)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE, IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY));
+    ASSERT_IS_NULL(IoTHubMessage_GetProperty(h, TEST_CONTENT_TYPE));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_SetProperty_NULL_params_fail)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetProperty(NULL, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_SetProperty(h, NULL, TEST_PROPERTY_VALUE);
+    IOTHUB_MESSAGE_RESULT result3 = IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result3);
+    ASSERT_IS_NULL(IoTHubMessage_GetProperty(NULL, TEST_PROPERTY_KEY));
+    ASSERT_IS_NULL(IoTHubMessage_GetProperty(h, NULL));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_106: [IoTHubMessage_SetProperty shall reject keys and values that are not printable US-Ascii with IOTHUB_MESSAGE_ERROR.]*/
+TEST_FUNCTION(IoTHubMessage_SetProperty_invalid_characters_fails)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetProperty(h, TEST_INVALID_MAP_KEY, TEST_PROPERTY_VALUE);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_INVALID_MAP_KEY);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_ERROR, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_ERROR, result2);
+    ASSERT_IS_NULL(IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_108: [The value of an existing property shall be replaced the same way as a system property.]*/
+TEST_FUNCTION(IoTHubMessage_SetProperty_existing_key_replaces_value)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE_SHORT);
+    const char* value1 = IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE_LONG);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result1);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE_SHORT, value1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result2);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE_LONG, IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_SetProperty_many_properties_grows_arena)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromString(TEST_STRING_VALUE);
+    set_all_system_properties(h);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetDiagnosticPropertyData(h, &TEST_DIAGNOSTIC_DATA));
+
+    //act
+    set_many_properties(h, TEST_MANY_PROPERTIES);
+
+    //assert
+    assert_many_properties(h, TEST_MANY_PROPERTIES);
+    assert_all_system_properties(h);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_STRING_VALUE, IoTHubMessage_GetString(h));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_DIAGNOSTIC_DATA.diagnosticId, IoTHubMessage_GetDiagnosticPropertyData(h)->diagnosticId);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_SetProperty_arena_growth_fails)
+{
+    // arrange
+    size_t i;
+    IOTHUB_MESSAGE_RESULT result = IOTHUB_MESSAGE_OK;
+    char key[32];
+    char value[64];
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    g_fail_malloc = true;
+
+    //act
+    for (i = 0; i < TEST_MANY_PROPERTIES && result == IOTHUB_MESSAGE_OK; i++)
+    {
+        make_property(i, key, sizeof(key), value, sizeof(value));
+        result = IoTHubMessage_SetProperty(h, key, value);
+    }
+
+    //assert
+    g_fail_malloc = false;
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_ERROR, result);
+    ASSERT_IS_TRUE(i > 1);
+    assert_many_properties(h, i - 1);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_118: [Once a message has 8 application properties, they shall be looked up through a hash index stored in the arena.]*/
+TEST_FUNCTION(IoTHubMessage_SetProperty_existing_key_with_index_replaces_value)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_properties(h, TEST_MANY_PROPERTIES);
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetProperty(h, "key_7", TEST_PROPERTY_VALUE_LONG);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_SetProperty(h, "key_63", TEST_PROPERTY_VALUE_SHORT);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result2);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE_LONG, IoTHubMessage_GetProperty(h, "key_7"));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE_SHORT, IoTHubMessage_GetProperty(h, "key_63"));
+    ASSERT_IS_NULL(IoTHubMessage_GetProperty(h, "key_64"));
+    ASSERT_ARE_EQUAL(char_ptr, "value_8_with_some_padding", IoTHubMessage_GetProperty(h, "key_8"));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_119: [If the index cannot be built, properties shall be looked up by a linear search.]*/
+TEST_FUNCTION(IoTHubMessage_SetProperty_index_allocation_fails_uses_linear_lookup)
+{
+    // arrange
+    size_t i;
+    char key[32];
+    char value[64];
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+
+    // Fill the arena so the index for the 8th property needs a growth
+    for (i = 0; i < 7; i++)
+    {
+        make_property(i, key, sizeof(key), value, sizeof(value));
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperty(h, key, value));
+    }
+    umock_c_reset_all_calls();
+
+    //act
+    g_fail_malloc = true;
+    make_property(7, key, sizeof(key), value, sizeof(value));
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperty(h, key, value);
+    g_fail_malloc = false;
+
+    //assert
+    // Either the property fit and the index was skipped, or the property itself could not be stored
+    if (result == IOTHUB_MESSAGE_OK)
+    {
+        assert_many_properties(h, 8);
+    }
+    else
+    {
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_ERROR, result);
+        assert_many_properties(h, 7);
+    }
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_111: [IoTHubMessage_SetProperties shall set each key and value, in order, as IoTHubMessage_SetProperty does.]*/
+/*Tests_SRS_IOTHUBMESSAGE_09_120: [IoTHubMessage_SetProperties shall reserve room in the arena for all the properties before copying them.]*/
+TEST_FUNCTION(IoTHubMessage_SetProperties_grows_arena_once)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    make_property_lists();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperties(h, g_key_list, g_value_list, TEST_MANY_PROPERTIES);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    assert_many_properties(h, TEST_MANY_PROPERTIES);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_110: [If `msg_handle` is NULL, or `keys` or `values` is NULL while `count` is not 0, or any key or value is NULL, IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_INVALID_ARG without setting any property.]*/
+TEST_FUNCTION(IoTHubMessage_SetProperties_NULL_params_fail)
+{
+    // arrange
+    const char* keys[] = { TEST_PROPERTY_KEY, TEST_CONTENT_TYPE };
+    const char* values[] = { TEST_PROPERTY_VALUE, NULL };
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetProperties(NULL, keys, values, 1);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_SetProperties(h, NULL, values, 1);
+    IOTHUB_MESSAGE_RESULT result3 = IoTHubMessage_SetProperties(h, keys, values, 2);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result3);
+    ASSERT_IS_NULL(IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_106: [IoTHubMessage_SetProperty shall reject keys and values that are not printable US-Ascii with IOTHUB_MESSAGE_ERROR.]*/
+TEST_FUNCTION(IoTHubMessage_SetProperties_invalid_characters_sets_nothing)
+{
+    // arrange
+    const char* keys[] = { TEST_PROPERTY_KEY, TEST_CONTENT_TYPE };
+    const char* values[] = { TEST_PROPERTY_VALUE, TEST_INVALID_MAP_KEY };
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperties(h, keys, values, 2);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_ERROR, result);
+    ASSERT_IS_NULL(IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_SetProperties_with_values_from_same_message_succeeds)
+{
+    // arrange
+    const char* keys[2];
+    const char* values[2];
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE));
+    make_property_lists();
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperties(h, g_key_list, g_value_list, TEST_MANY_PROPERTIES));
+    keys[0] = TEST_CONTENT_TYPE;
+    values[0] = IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY);
+    keys[1] = IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY);
+    values[1] = TEST_PROPERTY_VALUE_LONG;
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperties(h, keys, values, 2);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE, IoTHubMessage_GetProperty(h, TEST_CONTENT_TYPE));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE_LONG, IoTHubMessage_GetProperty(h, TEST_PROPERTY_VALUE));
+    assert_many_properties(h, TEST_MANY_PROPERTIES);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_115: [IoTHubMessage_GetProperties shall set `values[i]` to the value of the property `keys[i]`, or NULL if it does not exist, without allocating memory.]*/
+/*Tests_SRS_IOTHUBMESSAGE_09_116: [IoTHubMessage_GetProperties shall return IOTHUB_MESSAGE_OK.]*/
+TEST_FUNCTION(IoTHubMessage_GetProperties_succeeds_without_allocations)
+{
+    // arrange
+    size_t i;
+    const char* values[TEST_MANY_PROPERTIES + 1];
+    const char* keys[TEST_MANY_PROPERTIES + 1];
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    make_property_lists();
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperties(h, g_key_list, g_value_list, TEST_MANY_PROPERTIES));
+    for (i = 0; i < TEST_MANY_PROPERTIES; i++)
+    {
+        keys[i] = g_key_list[TEST_MANY_PROPERTIES - 1 - i];
+    }
+    keys[TEST_MANY_PROPERTIES] = TEST_PROPERTY_KEY;
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_GetProperties(h, keys, values, TEST_MANY_PROPERTIES + 1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    for (i = 0; i < TEST_MANY_PROPERTIES; i++)
+    {
+        ASSERT_ARE_EQUAL(char_ptr, g_value_list[TEST_MANY_PROPERTIES - 1 - i], values[i]);
+    }
+    ASSERT_IS_NULL(values[TEST_MANY_PROPERTIES]);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_114: [If `msg_handle` is NULL, or `keys` or `values` is NULL while `count` is not 0, IoTHubMessage_GetProperties shall return IOTHUB_MESSAGE_INVALID_ARG.]*/
+TEST_FUNCTION(IoTHubMessage_GetProperties_NULL_params_fail)
+{
+    // arrange
+    const char* keys[] = { TEST_PROPERTY_KEY };
+    const char* values[1];
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_GetProperties(NULL, keys, values, 1);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_GetProperties(h, keys, NULL, 1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result2);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_123: [IoTHubMessage_GetPropertyCount shall set `*count` to the number of application properties of the message without creating a properties map.]*/
+/*Tests_SRS_IOTHUBMESSAGE_09_125: [IoTHubMessage_GetPropertyAt shall set `*key` and `*value` to the application property at `index`, in the order the properties were added, without allocating memory.]*/
+TEST_FUNCTION(IoTHubMessage_GetPropertyAt_walks_properties_without_allocations)
+{
+    // arrange
+    size_t i;
+    size_t count = 0;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_properties(h, TEST_MANY_PROPERTIES);
+    make_property_lists();
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_GetPropertyCount(h, &count);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(size_t, TEST_MANY_PROPERTIES, count);
+    for (i = 0; i < count; i++)
+    {
+        const char* key = NULL;
+        const char* value = NULL;
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetPropertyAt(h, i, &key, &value));
+        ASSERT_ARE_EQUAL(char_ptr, g_key_list[i], key);
+        ASSERT_ARE_EQUAL(char_ptr, g_value_list[i], value);
+    }
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_122: [If `msg_handle` or `count` is NULL, IoTHubMessage_GetPropertyCount shall return IOTHUB_MESSAGE_INVALID_ARG.]*/
+/*Tests_SRS_IOTHUBMESSAGE_09_124: [If `msg_handle`, `key` or `value` is NULL, or `index` is not lower than the count returned by IoTHubMessage_GetPropertyCount, IoTHubMessage_GetPropertyAt shall return IOTHUB_MESSAGE_INVALID_ARG.]*/
+TEST_FUNCTION(IoTHubMessage_GetPropertyAt_invalid_params_fail)
+{
+    // arrange
+    size_t count;
+    const char* key;
+    const char* value;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_GetPropertyCount(NULL, &count);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_GetPropertyCount(h, NULL);
+    IOTHUB_MESSAGE_RESULT result3 = IoTHubMessage_GetPropertyAt(NULL, 0, &key, &value);
+    IOTHUB_MESSAGE_RESULT result4 = IoTHubMessage_GetPropertyAt(h, 0, NULL, &value);
+    IOTHUB_MESSAGE_RESULT result5 = IoTHubMessage_GetPropertyAt(h, 0, &key, NULL);
+    IOTHUB_MESSAGE_RESULT result6 = IoTHubMessage_GetPropertyAt(h, 1, &key, &value);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result3);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result4);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result5);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result6);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_GetPropertyAt_after_Properties_uses_map)
+{
+    // arrange
+    size_t count = 0;
+    const char* key = NULL;
+    const char* value = NULL;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    (void)IoTHubMessage_Properties(h);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_GetPropertyCount(h, &count);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_GetPropertyAt(h, 0, &key, &value);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result2);
+    ASSERT_ARE_EQUAL(size_t, 1, count);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_KEY, key);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MAP_VALUE, value);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_bulk_properties_after_Properties_use_map)
+{
+    // arrange
+    const char* keys[] = { TEST_PROPERTY_KEY, TEST_CONTENT_TYPE };
+    const char* values[] = { TEST_PROPERTY_VALUE, TEST_CONTENT_ENCODING };
+    const char* read_values[2];
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    MAP_HANDLE map = IoTHubMessage_Properties(h);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(map, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE));
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(map, TEST_CONTENT_TYPE, TEST_CONTENT_ENCODING));
+    STRICT_EXPECTED_CALL(Map_GetInternals(map, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetProperties(h, keys, values, 2);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_GetProperties(h, keys, read_values, 2);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result2);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MAP_VALUE, read_values[0]);
+    ASSERT_IS_NULL(read_values[1]);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_03_001: [IoTHubMessage_Clone shall create a new IoT hub message with data content identical to that of the iotHubMessageHandle parameter.]*/
+/*Tests_SRS_IOTHUBMESSAGE_09_103: [IoTHubMessage_Clone shall copy only the live data of the source arena into a single new allocation.]*/
+TEST_FUNCTION(IoTHubMessage_Clone_single_allocation_succeeds)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromString(TEST_STRING_VALUE);
+    set_all_system_properties(h);
+    set_many_properties(h, 5);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetDiagnosticPropertyData(h, &TEST_DIAGNOSTIC_DATA));
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetAsSecurityMessage(h));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE clone = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NOT_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, TEST_STRING_VALUE, IoTHubMessage_GetString(clone));
+    ASSERT_IS_TRUE(IoTHubMessage_IsSecurityMessage(clone));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_DIAGNOSTIC_DATA.diagnosticCreationTimeUtc, IoTHubMessage_GetDiagnosticPropertyData(clone)->diagnosticCreationTimeUtc);
+    assert_many_properties(clone, 5);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+    IoTHubMessage_Destroy(clone);
+}
+
+TEST_FUNCTION(IoTHubMessage_Clone_is_independent_from_source)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_all_system_properties(h);
+    set_many_properties(h, TEST_MANY_PROPERTIES);
+    IOTHUB_MESSAGE_HANDLE clone = IoTHubMessage_Clone(h);
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetProperty(clone, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_SetMessageId(h, TEST_CORRELATION_ID);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result2);
+    ASSERT_IS_NULL(IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MESSAGE_ID, IoTHubMessage_GetMessageId(clone));
+    assert_many_properties(clone, TEST_MANY_PROPERTIES);
+    assert_many_properties(h, TEST_MANY_PROPERTIES);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+    IoTHubMessage_Destroy(clone);
+}
+
+TEST_FUNCTION(IoTHubMessage_Clone_large_body_succeeds)
+{
+    // arrange
+    unsigned char body[TEST_LARGE_BODY_SIZE];
+    const unsigned char* buffer;
+    size_t size;
+    memset(body, 'x', sizeof(body));
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(body, sizeof(body));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(TEST_LARGE_BODY_SIZE));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE clone = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NOT_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(clone, &buffer, &size));
+    ASSERT_ARE_EQUAL(size_t, TEST_LARGE_BODY_SIZE, size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(buffer, body, sizeof(body)));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+    IoTHubMessage_Destroy(clone);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
+TEST_FUNCTION(IoTHubMessage_Clone_malloc_fails)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    //act
+    IOTHUB_MESSAGE_HANDLE clone = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_03_005: [IoTHubMessage_Clone shall return NULL if iotHubMessageHandle is NULL.]*/
+TEST_FUNCTION(IoTHubMessage_Clone_NULL_fails)
+{
+    //act
+    IOTHUB_MESSAGE_HANDLE clone = IoTHubMessage_Clone(NULL);
+
+    //assert
+    ASSERT_IS_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_02_005: [IoTHubMessage_Clone shall clone the properties map by using Map_Clone.] */
+TEST_FUNCTION(IoTHubMessage_Clone_with_map_succeeds)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    MAP_HANDLE map = IoTHubMessage_Properties(h);
+    ASSERT_IS_NOT_NULL(map);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Clone(map));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE clone = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NOT_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+    IoTHubMessage_Destroy(clone);
+}
+
+TEST_FUNCTION(IoTHubMessage_Clone_Map_Clone_fails)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    MAP_HANDLE map = IoTHubMessage_Properties(h);
+    ASSERT_IS_NOT_NULL(map);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Clone(map))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE clone = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_104: [The first call to IoTHubMessage_Properties shall create a map with the application properties of the message; from then on the map shall hold them.]*/
+TEST_FUNCTION(IoTHubMessage_Properties_creates_map_with_properties)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE));
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperty(h, TEST_CONTENT_TYPE, TEST_CONTENT_ENCODING));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE));
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, TEST_CONTENT_TYPE, TEST_CONTENT_ENCODING));
+
+    //act
+    MAP_HANDLE result = IoTHubMessage_Properties(h);
+
+    //assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // a second call returns the same map
+    umock_c_reset_all_calls();
+    ASSERT_ARE_EQUAL(void_ptr, result, IoTHubMessage_Properties(h));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_02_001: [If iotHubMessageHandle is NULL then IoTHubMessage_Properties shall return NULL.]*/
+TEST_FUNCTION(IoTHubMessage_Properties_NULL_fails)
+{
+    //act
+    MAP_HANDLE result = IoTHubMessage_Properties(NULL);
+
+    //assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_105: [If the map cannot be filled, IoTHubMessage_Properties shall return NULL and keep the properties in the arena.]*/
+TEST_FUNCTION(IoTHubMessage_Properties_Map_AddOrUpdate_fails)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE))
+        .SetReturn(MAP_ERROR);
+    STRICT_EXPECTED_CALL(Map_Destroy(IGNORED_PTR_ARG));
+
+    //act
+    MAP_HANDLE result = IoTHubMessage_Properties(h);
+
+    //assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE, IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_Properties_Map_Create_fails)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG))
+        .SetReturn(NULL);
+
+    //act
+    MAP_HANDLE result = IoTHubMessage_Properties(h);
+
+    //assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_SetProperty_after_Properties_uses_map)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    MAP_HANDLE map = IoTHubMessage_Properties(h);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(map, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE));
+    STRICT_EXPECTED_CALL(Map_ContainsKey(map, TEST_PROPERTY_KEY, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_GetValueFromKey(map, TEST_PROPERTY_KEY));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE);
+    const char* value = IoTHubMessage_GetProperty(h, TEST_PROPERTY_KEY);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MAP_VALUE, value);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_109: [IoTHubMessage_GetDiagnosticPropertyData shall point the returned structure at the current location of the diagnostic strings in the arena.]*/
+TEST_FUNCTION(IoTHubMessage_DiagnosticPropertyData_succeeds)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_IS_NULL(IoTHubMessage_GetDiagnosticPropertyData(h));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetDiagnosticPropertyData(h, &TEST_DIAGNOSTIC_DATA);
+    set_many_properties(h, TEST_MANY_PROPERTIES);
+    const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA* data = IoTHubMessage_GetDiagnosticPropertyData(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_IS_NOT_NULL(data);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_DIAGNOSTIC_DATA.diagnosticId, data->diagnosticId);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_DIAGNOSTIC_DATA.diagnosticCreationTimeUtc, data->diagnosticCreationTimeUtc);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_10_003: [If any of the parameters are NULL then IoTHubMessage_SetDiagnosticId shall return a IOTHUB_MESSAGE_INVALID_ARG value.]*/
+TEST_FUNCTION(IoTHubMessage_SetDiagnosticPropertyData_NULL_fails)
+{
+    // arrange
+    IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA incomplete = { NULL, "1506054179" };
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetDiagnosticPropertyData(NULL, &TEST_DIAGNOSTIC_DATA);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_SetDiagnosticPropertyData(h, NULL);
+    IOTHUB_MESSAGE_RESULT result3 = IoTHubMessage_SetDiagnosticPropertyData(h, &incomplete);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result3);
+    ASSERT_IS_NULL(IoTHubMessage_GetDiagnosticPropertyData(h));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_SetAsSecurityMessage_succeeds)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_IS_FALSE(IoTHubMessage_IsSecurityMessage(h));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetAsSecurityMessage(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_IS_TRUE(IoTHubMessage_IsSecurityMessage(h));
+    ASSERT_ARE_EQUAL(char_ptr, "application/json", IoTHubMessage_GetContentEncodingSystemProperty(h));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_004: [If iotHubMessageHandle is NULL, IoTHubMessage_Destroy shall do nothing.] */
+TEST_FUNCTION(IoTHubMessage_Destroy_NULL_does_nothing)
+{
+    //act
+    IoTHubMessage_Destroy(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_003: [IoTHubMessage_Destroy shall free all resources associated with iotHubMessageHandle.]  */
+TEST_FUNCTION(IoTHubMessage_Destroy_grown_message_with_map_frees_all)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_properties(h, TEST_MANY_PROPERTIES);
+    (void)IoTHubMessage_Properties(h);
+    ASSERT_IS_TRUE(g_live_allocations > 3);
+
+    //act
+    IoTHubMessage_Destroy(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 0, g_live_allocations);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_01_003: [IoTHubMessage_Destroy shall free all resources associated with iotHubMessageHandle.]  */
+TEST_FUNCTION(IoTHubMessage_Destroy_message_grown_once_frees_all)
+{
+    // arrange
+    char long_value[301];
+    memset(long_value, 'm', sizeof(long_value) - 1);
+    long_value[sizeof(long_value) - 1] = '\0';
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetMessageId(h, long_value));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(h));
+
+    //act
+    IoTHubMessage_Destroy(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_live_allocations);
+}
+
+END_TEST_SUITE(iothubmessage_compact_ut)
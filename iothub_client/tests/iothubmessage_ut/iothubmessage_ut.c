@@ -82,6 +82,17 @@ static const char* TEST_CONNECTION_MODULE_ID = "connectionmoduleid";
 static const char* TEST_CONNECTION_MODULE_ID2 = "connectionmoduleid2";
 static const char* TEST_PROPERTY_KEY = "property_key";
 static const char* TEST_PROPERTY_VALUE = "property_value";
+static const char* TEST_PROPERTY_KEY2 = "property_key2";
+static const char* TEST_PROPERTY_VALUE2 = "property_value2";
+static const char* TEST_MISSING_PROPERTY_KEY = "missing_key";
+static const char* TEST_MAP_KEYS[] = { "property_key", "property_key2" };
+static const char* TEST_MAP_VALUES[] = { "property_value", "property_value2" };
+static const char* TEST_MANY_MAP_KEYS[] = { "key0", "key1", "key2", "key3", "key4", "key5", "key6", "key7", "key8" };
+static const char* TEST_MANY_MAP_VALUES[] = { "value0", "value1", "value2", "value3", "value4", "value5", "value6", "value7", "value8" };
+
+static const char** g_map_keys;
+static const char** g_map_values;
+static size_t g_map_count;
 
 static IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA TEST_DIAGNOSTIC_DATA = { "12345678",  "1506054179"};
 static IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA TEST_DIAGNOSTIC_DATA2 = { "87654321", "1506054179.100" };
@@ -116,6 +127,15 @@ static void my_Map_Destroy(MAP_HANDLE handle)
     my_gballoc_free(handle);
 }
 
+static MAP_RESULT my_Map_GetInternals(MAP_HANDLE handle, const char*const** keys, const char*const** values, size_t* count)
+{
+    (void)handle;
+    *keys = (const char*const*)g_map_keys;
+    *values = (const char*const*)g_map_values;
+    *count = g_map_count;
+    return MAP_OK;
+}
+
 static int my_mallocAndStrcpy_s(char** destination, const char* source)
 {
     *destination = (char*)my_gballoc_malloc(strlen(source)+1);
@@ -301,6 +321,8 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_RETURN(Map_AddOrUpdate, MAP_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_AddOrUpdate, MAP_ERROR);
     REGISTER_GLOBAL_MOCK_RETURN(Map_ContainsKey, MAP_OK);
+    REGISTER_GLOBAL_MOCK_HOOK(Map_GetInternals, my_Map_GetInternals);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_GetInternals, MAP_ERROR);
 
     REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, MU_FAILURE);
@@ -316,6 +338,22 @@ TEST_SUITE_CLEANUP(suite_cleanup)
 static void reset_test_data()
 {
     g_mapFilterFunc = NULL;
+    g_map_keys = TEST_MAP_KEYS;
+    g_map_values = TEST_MAP_VALUES;
+    g_map_count = sizeof(TEST_MAP_KEYS) / sizeof(TEST_MAP_KEYS[0]);
+}
+
+static void set_many_map_properties(void)
+{
+    g_map_keys = TEST_MANY_MAP_KEYS;
+    g_map_values = TEST_MANY_MAP_VALUES;
+    g_map_count = sizeof(TEST_MANY_MAP_KEYS) / sizeof(TEST_MANY_MAP_KEYS[0]);
+}
+
+static void set_many_properties(IOTHUB_MESSAGE_HANDLE h)
+{
+    set_many_map_properties();
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperty(h, "key8", "value8"));
 }
 
 TEST_FUNCTION_INITIALIZE(method_init)
@@ -567,6 +605,64 @@ TEST_FUNCTION(IoTHubMessage_Map_Filter_invalidate_Ascii_value_fail)
     IoTHubMessage_Destroy(h);
 }
 
+/* Tests_SRS_IOTHUBMESSAGE_07_008: [ValidateAsciiCharactersFilter shall loop through the mapKey and mapValue strings to ensure that they only contain valid US-Ascii characters Ascii value 32 - 126.] */
+TEST_FUNCTION(IoTHubMessage_Map_Filter_invalid_char_in_any_position_fail)
+{
+    //arrange
+    static const char invalid_chars[] = { '\x01', '\x1F', '\x7F', '\x80', '\xFF' };
+    char value[24];
+    size_t position;
+    size_t i;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromString(TEST_STRING_VALUE);
+    umock_c_reset_all_calls();
+
+    for (position = 0; position < sizeof(value) - 1; position++)
+    {
+        for (i = 0; i < sizeof(invalid_chars); i++)
+        {
+            (void)memset(value, '~', sizeof(value) - 1);
+            value[sizeof(value) - 1] = '\0';
+            value[0] = ' ';
+            value[position] = invalid_chars[i];
+
+            //act
+            int result = g_mapFilterFunc(TEST_VALID_MAP_KEY, value);
+
+            //assert
+            ASSERT_ARE_NOT_EQUAL(int, 0, result, "invalid char %d at position %lu accepted", (int)(unsigned char)invalid_chars[i], (unsigned long)position);
+        }
+    }
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_Map_Filter_all_printable_chars_SUCCEED)
+{
+    //arrange
+    char value[96];
+    size_t i;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromString(TEST_STRING_VALUE);
+    umock_c_reset_all_calls();
+
+    for (i = 0; i < sizeof(value) - 1; i++)
+    {
+        value[i] = (char)(' ' + i);
+    }
+    value[sizeof(value) - 1] = '\0';
+
+    //act
+    int result = g_mapFilterFunc(value, value + 7);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
 /*Tests_SRS_IOTHUBMESSAGE_01_004: [If iotHubMessageHandle is NULL, IoTHubMessage_Destroy shall do nothing.] */
 TEST_FUNCTION(IoTHubMessage_Destroy_With_NULL_handle_does_nothing)
 {
@@ -1793,6 +1889,7 @@ TEST_FUNCTION(IoTHubMessage_SetProperty_Succeed)
     umock_c_reset_all_calls();
 
     STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     //act
     IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperty(h, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE);
@@ -1843,6 +1940,7 @@ TEST_FUNCTION(IoTHubMessage_GetProperty_Succeed)
     umock_c_reset_all_calls();
 
     bool key_exist = true;
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Map_ContainsKey(IGNORED_PTR_ARG, TEST_PROPERTY_KEY, IGNORED_PTR_ARG)).CopyOutArgumentBuffer_keyExists(&key_exist, sizeof(bool));
     STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, TEST_PROPERTY_KEY)).SetReturn(TEST_PROPERTY_VALUE);
 
@@ -1865,6 +1963,7 @@ TEST_FUNCTION(IoTHubMessage_GetProperty_Fail)
     umock_c_reset_all_calls();
 
     bool key_exist = false;
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Map_ContainsKey(IGNORED_PTR_ARG, TEST_PROPERTY_KEY, IGNORED_PTR_ARG)).CopyOutArgumentBuffer_keyExists(&key_exist, sizeof(bool));
 
     //act
@@ -1878,6 +1977,587 @@ TEST_FUNCTION(IoTHubMessage_GetProperty_Fail)
     IoTHubMessage_Destroy(h);
 }
 
+// Tests_SRS_IOTHUBMESSAGE_09_126: [Once a message has 8 application properties, IoTHubMessage_SetProperty and IoTHubMessage_SetProperties shall keep a hash index over the keys of the properties map.]
+TEST_FUNCTION(IoTHubMessage_SetProperty_with_many_properties_builds_the_index)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_map_properties();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, "key8", "value8"));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, "key8", "value8"));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetProperty(h, "key8", "value8");
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_SetProperty(h, "key8", "value8");
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_126: [Once a message has 8 application properties, IoTHubMessage_SetProperty and IoTHubMessage_SetProperties shall keep a hash index over the keys of the properties map.]
+TEST_FUNCTION(IoTHubMessage_SetProperties_with_many_properties_builds_the_index_once)
+{
+    //arrange
+    const char* keys[] = { "key7", "key8" };
+    const char* values[] = { "value7", "value8" };
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_map_properties();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, "key7", "value7"));
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, "key8", "value8"));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperties(h, keys, values, 2);
+    const char* value = IoTHubMessage_GetProperty(h, "key7");
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, "value7", value);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_129: [Otherwise IoTHubMessage_GetProperty shall look the key up through the index, comparing the key it finds, without changing the message.]
+TEST_FUNCTION(IoTHubMessage_GetProperty_with_many_properties_uses_the_index)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_properties(h);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    const char* result1 = IoTHubMessage_GetProperty(h, "key5");
+    const char* result2 = IoTHubMessage_GetProperty(h, "key8");
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, "value5", result1);
+    ASSERT_ARE_EQUAL(char_ptr, "value8", result2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_129: [Otherwise IoTHubMessage_GetProperty shall look the key up through the index, comparing the key it finds, without changing the message.]
+TEST_FUNCTION(IoTHubMessage_GetProperty_with_many_properties_missing_key_returns_NULL)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_properties(h);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    const char* result = IoTHubMessage_GetProperty(h, TEST_MISSING_PROPERTY_KEY);
+
+    //assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_127: [If the index was not built or does not cover every property of the map, IoTHubMessage_GetProperty shall look the key up in the properties map.]
+TEST_FUNCTION(IoTHubMessage_GetProperty_with_many_properties_index_malloc_fails_looks_up_the_map)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_map_properties();
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, "key8", "value8"));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).SetReturn(NULL);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_SetProperty(h, "key8", "value8"));
+    umock_c_reset_all_calls();
+
+    bool key_exist = true;
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_ContainsKey(IGNORED_PTR_ARG, "key5", IGNORED_PTR_ARG)).CopyOutArgumentBuffer_keyExists(&key_exist, sizeof(bool));
+    STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "key5")).SetReturn("value5");
+
+    //act
+    const char* result = IoTHubMessage_GetProperty(h, "key5");
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, "value5", result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_127: [If the index was not built or does not cover every property of the map, IoTHubMessage_GetProperty shall look the key up in the properties map.]
+TEST_FUNCTION(IoTHubMessage_GetProperty_with_many_properties_not_set_through_the_message_looks_up_the_map)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_map_properties();
+    umock_c_reset_all_calls();
+
+    bool key_exist = true;
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_ContainsKey(IGNORED_PTR_ARG, "key5", IGNORED_PTR_ARG)).CopyOutArgumentBuffer_keyExists(&key_exist, sizeof(bool));
+    STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "key5")).SetReturn("value5");
+
+    //act
+    const char* result = IoTHubMessage_GetProperty(h, "key5");
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, "value5", result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_128: [If the key is not in the index and the map was returned by IoTHubMessage_Properties, IoTHubMessage_GetProperty shall look the key up in the properties map.]
+TEST_FUNCTION(IoTHubMessage_GetProperty_with_many_properties_exposed_map_missing_key_looks_up_the_map)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_properties(h);
+    (void)IoTHubMessage_Properties(h);
+    umock_c_reset_all_calls();
+
+    bool key_exist = false;
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_ContainsKey(IGNORED_PTR_ARG, TEST_MISSING_PROPERTY_KEY, IGNORED_PTR_ARG)).CopyOutArgumentBuffer_keyExists(&key_exist, sizeof(bool));
+
+    //act
+    const char* result = IoTHubMessage_GetProperty(h, TEST_MISSING_PROPERTY_KEY);
+
+    //assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_128: [If the key is not in the index and the map was returned by IoTHubMessage_Properties, IoTHubMessage_GetProperty shall look the key up in the properties map.]
+TEST_FUNCTION(IoTHubMessage_GetProperty_with_many_properties_exposed_map_reordered_keys_are_found)
+{
+    //arrange
+    static const char* reordered_keys[] = { "key8", "key7", "key6", "key5", "key4", "key3", "key2", "key1", "key0" };
+    static const char* reordered_values[] = { "value8", "value7", "value6", "value5", "value4", "value3", "value2", "value1", "value0" };
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_properties(h);
+    (void)IoTHubMessage_Properties(h);
+    g_map_keys = reordered_keys;
+    g_map_values = reordered_values;
+    umock_c_reset_all_calls();
+
+    bool key_exist = true;
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_ContainsKey(IGNORED_PTR_ARG, "key1", IGNORED_PTR_ARG)).CopyOutArgumentBuffer_keyExists(&key_exist, sizeof(bool));
+    STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "key1")).SetReturn("value1");
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_ContainsKey(IGNORED_PTR_ARG, "key1", IGNORED_PTR_ARG)).CopyOutArgumentBuffer_keyExists(&key_exist, sizeof(bool));
+    STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "key1")).SetReturn("value1");
+
+    //act
+    const char* result1 = IoTHubMessage_GetProperty(h, "key1");
+    const char* result2 = IoTHubMessage_GetProperty(h, "key1");
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, "value1", result1);
+    ASSERT_ARE_EQUAL(char_ptr, "value1", result2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_128: [If the key is not in the index and the map was returned by IoTHubMessage_Properties, IoTHubMessage_GetProperty shall look the key up in the properties map.]
+TEST_FUNCTION(IoTHubMessage_GetProperty_with_many_properties_exposed_map_delete_then_add_looks_up_the_map)
+{
+    //arrange
+    static const char* changed_keys[] = { "key0", "key1", "key3", "key4", "key5", "key6", "key7", "key8", "key9" };
+    static const char* changed_values[] = { "value0", "value1", "value3", "value4", "value5", "value6", "value7", "value8", "value9" };
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_properties(h);
+    MAP_HANDLE properties = IoTHubMessage_Properties(h);
+    ASSERT_ARE_EQUAL(int, (int)MAP_OK, (int)Map_Delete(properties, "key2"));
+    ASSERT_ARE_EQUAL(int, (int)MAP_OK, (int)Map_AddOrUpdate(properties, "key9", "value9"));
+    g_map_keys = changed_keys;
+    g_map_values = changed_values;
+    umock_c_reset_all_calls();
+
+    bool key_exist = true;
+    bool key_missing = false;
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_ContainsKey(IGNORED_PTR_ARG, "key9", IGNORED_PTR_ARG)).CopyOutArgumentBuffer_keyExists(&key_exist, sizeof(bool));
+    STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "key9")).SetReturn("value9");
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_ContainsKey(IGNORED_PTR_ARG, "key5", IGNORED_PTR_ARG)).CopyOutArgumentBuffer_keyExists(&key_exist, sizeof(bool));
+    STRICT_EXPECTED_CALL(Map_GetValueFromKey(IGNORED_PTR_ARG, "key5")).SetReturn("value5");
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_ContainsKey(IGNORED_PTR_ARG, "key2", IGNORED_PTR_ARG)).CopyOutArgumentBuffer_keyExists(&key_missing, sizeof(bool));
+
+    //act
+    const char* added = IoTHubMessage_GetProperty(h, "key9");
+    const char* moved = IoTHubMessage_GetProperty(h, "key5");
+    const char* deleted = IoTHubMessage_GetProperty(h, "key2");
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, "value9", added);
+    ASSERT_ARE_EQUAL(char_ptr, "value5", moved);
+    ASSERT_IS_NULL(deleted);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_126: [Once a message has 8 application properties, IoTHubMessage_SetProperty and IoTHubMessage_SetProperties shall keep a hash index over the keys of the properties map.]
+TEST_FUNCTION(IoTHubMessage_SetProperty_after_exposed_map_changed_indexes_the_map_again)
+{
+    //arrange
+    static const char* changed_keys[] = { "key0", "key1", "key3", "key4", "key5", "key6", "key7", "key8", "key9" };
+    static const char* changed_values[] = { "value0", "value1", "value3", "value4", "value5", "value6", "value7", "value8", "value9" };
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    set_many_properties(h);
+    MAP_HANDLE properties = IoTHubMessage_Properties(h);
+    ASSERT_ARE_EQUAL(int, (int)MAP_OK, (int)Map_Delete(properties, "key2"));
+    ASSERT_ARE_EQUAL(int, (int)MAP_OK, (int)Map_AddOrUpdate(properties, "key9", "value9"));
+    g_map_keys = changed_keys;
+    g_map_values = changed_values;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, "key9", "value9"));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperty(h, "key9", "value9");
+    const char* moved = IoTHubMessage_GetProperty(h, "key5");
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, "value5", moved);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_110: [If `msg_handle` is NULL, or `keys` or `values` is NULL while `count` is not 0, or any key or value is NULL, IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_INVALID_ARG without setting any property.]
+TEST_FUNCTION(IoTHubMessage_SetProperties_handle_NULL_Fail)
+{
+    //arrange
+    const char* keys[] = { TEST_PROPERTY_KEY };
+    const char* values[] = { TEST_PROPERTY_VALUE };
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperties(NULL, keys, values, 1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_110: [If `msg_handle` is NULL, or `keys` or `values` is NULL while `count` is not 0, or any key or value is NULL, IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_INVALID_ARG without setting any property.]
+TEST_FUNCTION(IoTHubMessage_SetProperties_arrays_NULL_Fail)
+{
+    //arrange
+    const char* keys[] = { TEST_PROPERTY_KEY };
+    const char* values[] = { TEST_PROPERTY_VALUE };
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_SetProperties(h, NULL, values, 1);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_SetProperties(h, keys, NULL, 1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_110: [If `msg_handle` is NULL, or `keys` or `values` is NULL while `count` is not 0, or any key or value is NULL, IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_INVALID_ARG without setting any property.]
+TEST_FUNCTION(IoTHubMessage_SetProperties_value_NULL_sets_nothing)
+{
+    //arrange
+    const char* keys[] = { TEST_PROPERTY_KEY, TEST_PROPERTY_KEY2 };
+    const char* values[] = { TEST_PROPERTY_VALUE, NULL };
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperties(h, keys, values, 2);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_111: [IoTHubMessage_SetProperties shall set each key and value, in order, as IoTHubMessage_SetProperty does.]
+// Tests_SRS_IOTHUBMESSAGE_09_113: [IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_OK if all properties are set.]
+TEST_FUNCTION(IoTHubMessage_SetProperties_Succeed)
+{
+    //arrange
+    const char* keys[] = { TEST_PROPERTY_KEY, TEST_PROPERTY_KEY2 };
+    const char* values[] = { TEST_PROPERTY_VALUE, TEST_PROPERTY_VALUE2 };
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE));
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, TEST_PROPERTY_KEY2, TEST_PROPERTY_VALUE2));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperties(h, keys, values, 2);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_SetProperties_zero_count_Succeed)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperties(h, NULL, NULL, 0);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_112: [If a property cannot be set, IoTHubMessage_SetProperties shall return IOTHUB_MESSAGE_ERROR and keep the properties set before it.]
+TEST_FUNCTION(IoTHubMessage_SetProperties_Map_AddOrUpdate_Fail)
+{
+    //arrange
+    const char* keys[] = { TEST_PROPERTY_KEY, TEST_PROPERTY_KEY2, TEST_VALID_MAP_KEY };
+    const char* values[] = { TEST_PROPERTY_VALUE, TEST_PROPERTY_VALUE2, TEST_VALID_MAP_VALUE };
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, TEST_PROPERTY_KEY, TEST_PROPERTY_VALUE));
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(IGNORED_PTR_ARG, TEST_PROPERTY_KEY2, TEST_PROPERTY_VALUE2)).SetReturn(MAP_ERROR);
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetProperties(h, keys, values, 3);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_114: [If `msg_handle` is NULL, or `keys` or `values` is NULL while `count` is not 0, IoTHubMessage_GetProperties shall return IOTHUB_MESSAGE_INVALID_ARG.]
+TEST_FUNCTION(IoTHubMessage_GetProperties_NULL_params_Fail)
+{
+    //arrange
+    const char* keys[] = { TEST_PROPERTY_KEY };
+    const char* values[1];
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_GetProperties(NULL, keys, values, 1);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_GetProperties(h, NULL, values, 1);
+    IOTHUB_MESSAGE_RESULT result3 = IoTHubMessage_GetProperties(h, keys, NULL, 1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result3);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_115: [IoTHubMessage_GetProperties shall set `values[i]` to the value of the property `keys[i]`, or NULL if it does not exist, without allocating memory.]
+// Tests_SRS_IOTHUBMESSAGE_09_116: [IoTHubMessage_GetProperties shall return IOTHUB_MESSAGE_OK.]
+TEST_FUNCTION(IoTHubMessage_GetProperties_Succeed)
+{
+    //arrange
+    const char* keys[] = { TEST_PROPERTY_KEY2, TEST_MISSING_PROPERTY_KEY, TEST_PROPERTY_KEY };
+    const char* values[3];
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_GetProperties(h, keys, values, 3);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE2, values[0]);
+    ASSERT_IS_NULL(values[1]);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_PROPERTY_VALUE, values[2]);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_GetProperties_Map_GetInternals_Fail)
+{
+    //arrange
+    const char* keys[] = { TEST_PROPERTY_KEY };
+    const char* values[1];
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(MAP_ERROR);
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_GetProperties(h, keys, values, 1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_122: [If `msg_handle` or `count` is NULL, IoTHubMessage_GetPropertyCount shall return IOTHUB_MESSAGE_INVALID_ARG.]
+// Tests_SRS_IOTHUBMESSAGE_09_124: [If `msg_handle`, `key` or `value` is NULL, or `index` is not lower than the count returned by IoTHubMessage_GetPropertyCount, IoTHubMessage_GetPropertyAt shall return IOTHUB_MESSAGE_INVALID_ARG.]
+TEST_FUNCTION(IoTHubMessage_GetPropertyAt_NULL_params_Fail)
+{
+    //arrange
+    size_t count;
+    const char* key;
+    const char* value;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_GetPropertyCount(NULL, &count);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_GetPropertyCount(h, NULL);
+    IOTHUB_MESSAGE_RESULT result3 = IoTHubMessage_GetPropertyAt(NULL, 0, &key, &value);
+    IOTHUB_MESSAGE_RESULT result4 = IoTHubMessage_GetPropertyAt(h, 0, NULL, &value);
+    IOTHUB_MESSAGE_RESULT result5 = IoTHubMessage_GetPropertyAt(h, 0, &key, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result3);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result4);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result5);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_123: [IoTHubMessage_GetPropertyCount shall set `*count` to the number of application properties of the message without creating a properties map.]
+// Tests_SRS_IOTHUBMESSAGE_09_125: [IoTHubMessage_GetPropertyAt shall set `*key` and `*value` to the application property at `index`, in the order the properties were added, without allocating memory.]
+TEST_FUNCTION(IoTHubMessage_GetPropertyAt_Succeed)
+{
+    //arrange
+    size_t count = 0;
+    const char* key = NULL;
+    const char* value = NULL;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result1 = IoTHubMessage_GetPropertyCount(h, &count);
+    IOTHUB_MESSAGE_RESULT result2 = IoTHubMessage_GetPropertyAt(h, 1, &key, &value);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result1);
+    ASSERT_ARE_EQUAL(size_t, 2, count);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result2);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MAP_KEYS[1], key);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MAP_VALUES[1], value);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+// Tests_SRS_IOTHUBMESSAGE_09_124: [If `msg_handle`, `key` or `value` is NULL, or `index` is not lower than the count returned by IoTHubMessage_GetPropertyCount, IoTHubMessage_GetPropertyAt shall return IOTHUB_MESSAGE_INVALID_ARG.]
+TEST_FUNCTION(IoTHubMessage_GetPropertyAt_index_out_of_range_Fail)
+{
+    //arrange
+    const char* key;
+    const char* value;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_GetPropertyAt(h, 2, &key, &value);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+TEST_FUNCTION(IoTHubMessage_GetPropertyCount_Map_GetInternals_Fail)
+{
+    //arrange
+    size_t count;
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(MAP_ERROR);
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_GetPropertyCount(h, &count);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
 // Tests_SRS_IOTHUBMESSAGE_31_036: [If any of the parameters are NULL then IoTHubMessage_SetOutputName shall return a IOTHUB_MESSAGE_INVALID_ARG value.]
 TEST_FUNCTION(IoTHubMessage_SetOutputName_NULL_handle_Fails)
 {
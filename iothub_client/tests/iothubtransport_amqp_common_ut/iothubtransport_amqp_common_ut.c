@@ -109,6 +109,7 @@ extern "C"
 #include "internal/iothub_client_private.h"
 #include "iothub_client_version.h"
 #include "internal/iothub_client_retry_control.h"
+#include "internal/iothub_client_connection_governor.h"
 #include "internal/iothubtransportamqp_methods.h"
 #include "internal/iothubtransport_amqp_connection.h"
 #include "internal/iothubtransport_amqp_device.h"
@@ -709,6 +710,11 @@ static void set_expected_calls_for_DoWork2(PDLIST_ENTRY wts, int wts_length, DEV
 {
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
 
+    if (!is_connection_created)
+    {
+        STRICT_EXPECTED_CALL(connection_governor_acquire());
+    }
+
     if (!is_tls_io_acquired)
     {
         set_expected_calls_for_get_new_underlying_io_transport(feed_options);
@@ -1213,6 +1219,9 @@ static void register_global_mock_returns()
 
     REGISTER_GLOBAL_MOCK_RETURN(retry_control_create, TEST_RETRY_CONTROL_HANDLE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(retry_control_create, NULL);
+
+    REGISTER_GLOBAL_MOCK_RETURN(connection_governor_acquire, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(connection_governor_acquire, MU_FAILURE);
 }
 
 static void reset_test_data()
@@ -4120,6 +4129,7 @@ TEST_FUNCTION(DoWork_get_underlying_io_transport_provider_fails)
 
     umock_c_reset_all_calls();
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+    STRICT_EXPECTED_CALL(connection_governor_acquire());
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE))
         .SetReturn(TEST_IOTHUB_HOST_FQDN_CHAR_PTR);
     TEST_amqp_get_io_transport_result = NULL;
@@ -4134,6 +4144,42 @@ TEST_FUNCTION(DoWork_get_underlying_io_transport_provider_fails)
     destroy_transport(handle, device_handle, NULL);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_160: [If `instance->amqp_connection` is NULL and connection_governor_acquire() fails, IoTHubTransport_AMQP_Common_DoWork shall postpone establishing it to a later call]
+TEST_FUNCTION(DoWork_connection_governor_throttled_postpones_connection)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+    STRICT_EXPECTED_CALL(connection_governor_acquire())
+        .SetReturn(MU_FAILURE);
+
+    // act
+    IoTHubTransport_AMQP_Common_DoWork(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // arrange
+    umock_c_reset_all_calls();
+    set_expected_calls_for_DoWork(&TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, false, true, false, false, 1, TEST_current_time, false);
+
+    // act
+    IoTHubTransport_AMQP_Common_DoWork(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_028: [If `transport->preferred_credential_method` is X509, AMQP_CONNECTION_CONFIG shall be set with `create_sasl_io` = false and `create_cbs_connection` = false]
 TEST_FUNCTION(DoWork_sets_amqp_connection_for_X509)
 {
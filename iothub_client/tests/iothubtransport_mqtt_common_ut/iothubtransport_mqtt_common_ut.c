@@ -57,6 +57,7 @@ void* my_gballoc_realloc(void* ptr, size_t size)
 #include "internal/iothub_client_private.h"
 #include "iothub_client_options.h"
 #include "internal/iothub_client_retry_control.h"
+#include "internal/iothub_client_connection_governor.h"
 
 #include "azure_c_shared_utility/xio.h"
 #include "azure_c_shared_utility/tlsio.h"
@@ -571,6 +572,13 @@ static MAP_RESULT my_Map_GetInternals(MAP_HANDLE handle, const char*const** keys
     return MAP_OK;
 }
 
+static IOTHUB_MESSAGE_RESULT my_IoTHubMessage_GetPropertyCount(IOTHUB_MESSAGE_HANDLE msg_handle, size_t* count)
+{
+    (void)msg_handle;
+    *count = 0;
+    return IOTHUB_MESSAGE_OK;
+}
+
 static XIO_HANDLE my_xio_create(const IO_INTERFACE_DESCRIPTION* io_interface_description, const void* xio_create_parameters)
 {
     (void)io_interface_description;
@@ -818,6 +826,11 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(Map_GetInternals, my_Map_GetInternals);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_GetInternals, MAP_ERROR);
 
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetPropertyCount, my_IoTHubMessage_GetPropertyCount);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_GetPropertyCount, IOTHUB_MESSAGE_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_GetPropertyAt, IOTHUB_MESSAGE_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_GetPropertyAt, IOTHUB_MESSAGE_ERROR);
+
     REGISTER_GLOBAL_MOCK_RETURN(Map_AddOrUpdate, MAP_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_GetInternals, MAP_ERROR);
 
@@ -929,6 +942,9 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_RETURN(retry_control_should_retry, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(retry_control_should_retry, 1);
 
+    REGISTER_GLOBAL_MOCK_RETURN(connection_governor_acquire, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(connection_governor_acquire, MU_FAILURE);
+
     REGISTER_UMOCK_ALIAS_TYPE(RETRY_CONTROL_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(RETRY_ACTION, int);
 }
@@ -1143,11 +1159,9 @@ static void setup_connection_success_mocks()
     STRICT_EXPECTED_CALL(Transport_ConnectionStatusCallBack(IOTHUB_CLIENT_CONNECTION_AUTHENTICATED, IOTHUB_CLIENT_CONNECTION_OK, IGNORED_PTR_ARG));
 }
 
-static void setup_initialize_reconnection_mocks()
+static void setup_connection_governor_released_mocks()
 {
-    RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
-    STRICT_EXPECTED_CALL(retry_control_should_retry(TEST_RETRY_CONTROL_HANDLE, IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(retry_action));
+    STRICT_EXPECTED_CALL(connection_governor_acquire());
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(xio_retrieveoptions(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG));
@@ -1166,6 +1180,14 @@ static void setup_initialize_reconnection_mocks()
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)).IgnoreArgument_handle();
 }
 
+static void setup_initialize_reconnection_mocks()
+{
+    RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
+    STRICT_EXPECTED_CALL(retry_control_should_retry(TEST_RETRY_CONTROL_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(retry_action));
+    setup_connection_governor_released_mocks();
+}
+
 static void setup_devicemethod_response_mocks()
 {
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
@@ -1191,6 +1213,7 @@ static void setup_initialize_connection_mocks()
     RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
     STRICT_EXPECTED_CALL(retry_control_should_retry(TEST_RETRY_CONTROL_HANDLE, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(retry_action));
+    STRICT_EXPECTED_CALL(connection_governor_acquire());
 
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG));
@@ -1258,8 +1281,7 @@ static void setup_IoTHubTransport_MQTT_Common_DoWork_emtpy_msg_mocks(void)
     STRICT_EXPECTED_CALL(STRING_construct(IGNORED_PTR_ARG));
 
     //Add Properties
-    STRICT_EXPECTED_CALL(IoTHubMessage_Properties(IGNORED_PTR_ARG));
-        EXPECTED_CALL(Map_GetInternals(TEST_MESSAGE_PROP_MAP, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetPropertyCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubMessage_IsSecurityMessage(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubMessage_GetCorrelationId(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubMessage_GetMessageId(IGNORED_PTR_ARG));
@@ -1323,29 +1345,21 @@ static void setup_IoTHubTransport_MQTT_Common_DoWork_resend_events_mocks(
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(STRING_construct(IGNORED_PTR_ARG));
     //Add Properties
-    STRICT_EXPECTED_CALL(IoTHubMessage_Properties(msg_handle));
-    if (propCount == 0)
-    {
-        EXPECTED_CALL(Map_GetInternals(TEST_MESSAGE_PROP_MAP, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    }
-    else
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetPropertyCount(msg_handle, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &propCount, sizeof(propCount));
+    for (size_t i = 0; i < propCount; i++)
     {
-        STRICT_EXPECTED_CALL(Map_GetInternals(TEST_MESSAGE_PROP_MAP, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .CopyOutArgumentBuffer(2, &ppKeys, sizeof(ppKeys))
-            .CopyOutArgumentBuffer(3, &ppValues, sizeof(ppValues))
-            .CopyOutArgumentBuffer(4, &propCount, sizeof(propCount));
-
-        for (size_t i = 0; i < propCount; i++)
+        STRICT_EXPECTED_CALL(IoTHubMessage_GetPropertyAt(msg_handle, i, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(3, &ppKeys[i], sizeof(ppKeys[i]))
+            .CopyOutArgumentBuffer(4, &ppValues[i], sizeof(ppValues[i]));
+        if (auto_urlencode)
         {
-            if (auto_urlencode)
-            {
-                STRICT_EXPECTED_CALL(URL_EncodeString((const char*)ppKeys[i]));
-                STRICT_EXPECTED_CALL(URL_EncodeString((const char*)ppValues[i]));
-                STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-                STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-                STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-                STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-            }
+            STRICT_EXPECTED_CALL(URL_EncodeString((const char*)ppKeys[i]));
+            STRICT_EXPECTED_CALL(URL_EncodeString((const char*)ppValues[i]));
+            STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
         }
     }
     STRICT_EXPECTED_CALL(IoTHubMessage_IsSecurityMessage(IGNORED_PTR_ARG)).SetReturn(security_msg);
@@ -1468,29 +1482,21 @@ static void setup_IoTHubTransport_MQTT_Common_DoWork_events_mocks(
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(STRING_construct(IGNORED_PTR_ARG));
     //Add Properties
-    STRICT_EXPECTED_CALL(IoTHubMessage_Properties(msg_handle));
-    if (propCount == 0)
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetPropertyCount(msg_handle, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &propCount, sizeof(propCount));
+    for (size_t i = 0; i < propCount; i++)
     {
-        EXPECTED_CALL(Map_GetInternals(TEST_MESSAGE_PROP_MAP, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    }
-    else
-    {
-        STRICT_EXPECTED_CALL(Map_GetInternals(TEST_MESSAGE_PROP_MAP, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .CopyOutArgumentBuffer(2, &ppKeys, sizeof(ppKeys))
-            .CopyOutArgumentBuffer(3, &ppValues, sizeof(ppValues))
-            .CopyOutArgumentBuffer(4, &propCount, sizeof(propCount));
-
-        for (size_t i=0; i < propCount; i++)
+        STRICT_EXPECTED_CALL(IoTHubMessage_GetPropertyAt(msg_handle, i, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(3, &ppKeys[i], sizeof(ppKeys[i]))
+            .CopyOutArgumentBuffer(4, &ppValues[i], sizeof(ppValues[i]));
+        if (auto_urlencode)
         {
-            if (auto_urlencode)
-            {
-                STRICT_EXPECTED_CALL(URL_EncodeString((const char*)ppKeys[i]));
-                STRICT_EXPECTED_CALL(URL_EncodeString((const char*)ppValues[i]));
-                STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-                STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-                STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-                STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-            }
+            STRICT_EXPECTED_CALL(URL_EncodeString((const char*)ppKeys[i]));
+            STRICT_EXPECTED_CALL(URL_EncodeString((const char*)ppValues[i]));
+            STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
         }
     }
     STRICT_EXPECTED_CALL(IoTHubMessage_IsSecurityMessage(IGNORED_PTR_ARG)).SetReturn(security_msg);
@@ -3796,6 +3802,7 @@ TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_mqtt_client_connect_fail)
     RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
     EXPECTED_CALL(retry_control_should_retry(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(retry_action));
+    STRICT_EXPECTED_CALL(connection_governor_acquire());
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG));
@@ -4018,6 +4025,96 @@ TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_Retry_Policy_First_Connect_Fail
     IoTHubTransport_MQTT_Common_Destroy(handle);
 }
 
+// Tests_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_016: [ IoTHubTransport_MQTT_Common_DoWork shall not start the connection if connection_governor_acquire() fails ]
+// Tests_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_017: [ If a reconnection was held back by the connection governor, IoTHubTransport_MQTT_Common_DoWork shall only ask the governor again, without calling retry_control_should_retry, until the governor lets it through ]
+TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_Connection_Governor_Throttled_Success)
+{
+    // arrange
+    IOTHUBTRANSPORT_CONFIG config = { 0 };
+    SetupIothubTransportConfig(&config, TEST_DEVICE_ID, TEST_DEVICE_KEY, TEST_IOTHUB_NAME, TEST_IOTHUB_SUFFIX, TEST_PROTOCOL_GATEWAY_HOSTNAME, NULL);
+
+    TRANSPORT_LL_HANDLE handle = setup_iothub_mqtt_connection(&config);
+    IoTHubTransport_MQTT_Common_SetRetryPolicy(handle, TEST_RETRY_POLICY, TEST_RETRY_TIMEOUT_SECS);
+
+    umock_c_reset_all_calls();
+    /*First Do_Work*/
+    RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
+    EXPECTED_CALL(retry_control_should_retry(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(retry_action));
+    STRICT_EXPECTED_CALL(connection_governor_acquire()).SetReturn(MU_FAILURE);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    // removeExpiredPendingGetTwinRequests
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    // removeExpiredGetTwinRequestsPendingAck
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    /*Second Do_Work, the retry policy already allowed this attempt and is not evaluated again*/
+    STRICT_EXPECTED_CALL(connection_governor_acquire()).SetReturn(MU_FAILURE);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    // removeExpiredPendingGetTwinRequests
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    // removeExpiredGetTwinRequestsPendingAck
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    // act
+    /* Break Connection */
+    g_fnMqttOperationCallback(TEST_MQTT_CLIENT_HANDLE, MQTT_CLIENT_ON_DISCONNECT, NULL, g_callbackCtx);
+    /* Retry connecting */
+    IoTHubTransport_MQTT_Common_DoWork(handle);
+    IoTHubTransport_MQTT_Common_DoWork(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransport_MQTT_Common_Destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_017: [ If a reconnection was held back by the connection governor, IoTHubTransport_MQTT_Common_DoWork shall only ask the governor again, without calling retry_control_should_retry, until the governor lets it through ]
+TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_Connection_Governor_Released_Connects_Without_Retry_Policy)
+{
+    // arrange
+    IOTHUBTRANSPORT_CONFIG config = { 0 };
+    SetupIothubTransportConfig(&config, TEST_DEVICE_ID, TEST_DEVICE_KEY, TEST_IOTHUB_NAME, TEST_IOTHUB_SUFFIX, TEST_PROTOCOL_GATEWAY_HOSTNAME, NULL);
+
+    TRANSPORT_LL_HANDLE handle = setup_iothub_mqtt_connection(&config);
+    IoTHubTransport_MQTT_Common_SetRetryPolicy(handle, TEST_RETRY_POLICY, TEST_RETRY_TIMEOUT_SECS);
+
+    umock_c_reset_all_calls();
+    /*First Do_Work*/
+    RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
+    EXPECTED_CALL(retry_control_should_retry(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(retry_action));
+    STRICT_EXPECTED_CALL(connection_governor_acquire()).SetReturn(MU_FAILURE);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    // removeExpiredPendingGetTwinRequests
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    // removeExpiredGetTwinRequestsPendingAck
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    /*Second Do_Work, the governor lets the held back attempt through*/
+    setup_connection_governor_released_mocks();
+    STRICT_EXPECTED_CALL(mqtt_client_dowork(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    // removeExpiredPendingGetTwinRequests
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    // removeExpiredGetTwinRequestsPendingAck
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    // act
+    /* Break Connection */
+    g_fnMqttOperationCallback(TEST_MQTT_CLIENT_HANDLE, MQTT_CLIENT_ON_DISCONNECT, NULL, g_callbackCtx);
+    /* Retry connecting */
+    IoTHubTransport_MQTT_Common_DoWork(handle);
+    IoTHubTransport_MQTT_Common_DoWork(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransport_MQTT_Common_Destroy(handle);
+}
+
 // Tests_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_007: [ IoTHubTransport_MQTT_Common_DoWork shall try to reconnect according to the current retry policy set ]
 TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_Retry_Policy_Connection_Break_Wait_2_Times_Success)
 {
@@ -4282,6 +4379,7 @@ TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_SAS_token_from_user_succeed)
     RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
     EXPECTED_CALL(retry_control_should_retry(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(retry_action));
+    STRICT_EXPECTED_CALL(connection_governor_acquire());
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG)).SetReturn(IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN);
     STRICT_EXPECTED_CALL(IoTHubClient_Auth_Is_SasToken_Valid(IGNORED_PTR_ARG));
@@ -4332,6 +4430,7 @@ TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_SAS_token_from_user_invalid_cal
     RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
     EXPECTED_CALL(retry_control_should_retry(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(retry_action));
+    STRICT_EXPECTED_CALL(connection_governor_acquire());
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG)).SetReturn(IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN);
@@ -4365,6 +4464,7 @@ TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_SAS_token_from_user_failed_call
     RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
     EXPECTED_CALL(retry_control_should_retry(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(retry_action));
+    STRICT_EXPECTED_CALL(connection_governor_acquire());
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG)).SetReturn(IOTHUB_CREDENTIAL_TYPE_SAS_TOKEN);
@@ -4399,6 +4499,7 @@ TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_x509_succeed)
     RETRY_ACTION retry_action = RETRY_ACTION_RETRY_NOW;
     EXPECTED_CALL(retry_control_should_retry(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .CopyOutArgumentBuffer_retry_action(&retry_action, sizeof(retry_action));
+    STRICT_EXPECTED_CALL(connection_governor_acquire());
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG)).SetReturn(IOTHUB_CREDENTIAL_TYPE_X509);
     STRICT_EXPECTED_CALL(Transport_GetOption_Product_Info_Callback(IGNORED_PTR_ARG));
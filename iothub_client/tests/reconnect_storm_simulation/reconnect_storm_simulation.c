@@ -0,0 +1,238 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Simulates a fleet of device clients losing their connection at the same moment (e.g., an IoT Hub outage)
+// and prints, for each retry policy, how their re-connection attempts are distributed over time.
+// Connections are not opened; each attempt made before the outage ends fails, and any attempt after succeeds.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "iothub_client_core_common.h"
+#include "internal/iothub_client_retry_control.h"
+#include "internal/iothub_client_connection_governor.h"
+
+#define DEVICE_COUNT                    1000
+#define OUTAGE_DURATION_IN_SECS         20
+#define SIMULATION_DURATION_IN_SECS     90
+#define INITIAL_WAIT_TIME_IN_SECS       1
+#define MAX_WAIT_TIME_IN_SECS           30
+#define CONNECTIONS_PER_SECOND          50
+#define BURST_SIZE                      50
+#define DOWORK_INTERVAL_IN_MS           10
+#define HISTOGRAM_BAR_WIDTH             60
+
+typedef struct SIMULATION_SCENARIO_TAG
+{
+    const char* name;
+    IOTHUB_CLIENT_RETRY_POLICY policy;
+    size_t connections_per_second;
+} SIMULATION_SCENARIO;
+
+typedef struct SIMULATION_RESULT_TAG
+{
+    size_t attempts_per_second[SIMULATION_DURATION_IN_SECS];
+    size_t total_attempts;
+    size_t connected_devices;
+    size_t peak_attempts;
+    size_t last_connection_second;
+} SIMULATION_RESULT;
+
+static const SIMULATION_SCENARIO scenarios[] =
+{
+    { "EXPONENTIAL_BACKOFF", IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF, 0 },
+    { "EXPONENTIAL_BACKOFF_WITH_JITTER", IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER, 0 },
+    { "EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER", IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER, 0 },
+    { "EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER + connection rate limit", IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER, CONNECTIONS_PER_SECOND }
+};
+
+static SIMULATION_RESULT simulation_result;
+
+static int create_devices(const SIMULATION_SCENARIO* scenario, RETRY_CONTROL_HANDLE* devices)
+{
+    int result = 0;
+    unsigned int initial_wait_time = INITIAL_WAIT_TIME_IN_SECS;
+    unsigned int max_wait_time = MAX_WAIT_TIME_IN_SECS;
+    size_t i;
+
+    for (i = 0; i < DEVICE_COUNT; i++)
+    {
+        if ((devices[i] = retry_control_create(scenario->policy, 0)) == NULL)
+        {
+            LogError("Failed creating the retry control for device %lu", (unsigned long)i);
+            result = MU_FAILURE;
+            break;
+        }
+        else if (retry_control_set_option(devices[i], RETRY_CONTROL_OPTION_INITIAL_WAIT_TIME_IN_SECS, &initial_wait_time) != 0 ||
+            (scenario->policy == IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_DECORRELATED_JITTER &&
+             retry_control_set_option(devices[i], RETRY_CONTROL_OPTION_MAX_WAIT_TIME_IN_SECS, &max_wait_time) != 0))
+        {
+            LogError("Failed setting the retry control options for device %lu", (unsigned long)i);
+            retry_control_destroy(devices[i]);
+            devices[i] = NULL;
+            result = MU_FAILURE;
+            break;
+        }
+    }
+
+    return result;
+}
+
+static void destroy_devices(RETRY_CONTROL_HANDLE* devices)
+{
+    size_t i;
+
+    for (i = 0; i < DEVICE_COUNT; i++)
+    {
+        if (devices[i] != NULL)
+        {
+            retry_control_destroy(devices[i]);
+            devices[i] = NULL;
+        }
+    }
+}
+
+static void run_scenario(RETRY_CONTROL_HANDLE* devices, bool* is_connected)
+{
+    time_t start_time = get_time(NULL);
+    size_t elapsed_secs = 0;
+
+    memset(&simulation_result, 0, sizeof(simulation_result));
+    memset(is_connected, 0, sizeof(bool) * DEVICE_COUNT);
+
+    while (simulation_result.connected_devices < DEVICE_COUNT && elapsed_secs < SIMULATION_DURATION_IN_SECS)
+    {
+        size_t i;
+
+        for (i = 0; i < DEVICE_COUNT; i++)
+        {
+            RETRY_ACTION retry_action;
+
+            // Same order as the transports: the retry policy first, then the process-wide rate limit.
+            if (!is_connected[i] &&
+                retry_control_should_retry(devices[i], &retry_action) == 0 &&
+                retry_action == RETRY_ACTION_RETRY_NOW &&
+                connection_governor_acquire() == 0)
+            {
+                simulation_result.attempts_per_second[elapsed_secs]++;
+                simulation_result.total_attempts++;
+
+                if (elapsed_secs >= OUTAGE_DURATION_IN_SECS)
+                {
+                    is_connected[i] = true;
+                    simulation_result.connected_devices++;
+                    simulation_result.last_connection_second = elapsed_secs;
+                    retry_control_reset(devices[i]);
+                }
+            }
+        }
+
+        ThreadAPI_Sleep(DOWORK_INTERVAL_IN_MS);
+        elapsed_secs = (size_t)get_difftime(get_time(NULL), start_time);
+    }
+}
+
+static void print_result(const SIMULATION_SCENARIO* scenario)
+{
+    size_t i;
+    size_t last_second = 0;
+
+    for (i = 0; i < SIMULATION_DURATION_IN_SECS; i++)
+    {
+        if (simulation_result.attempts_per_second[i] > simulation_result.peak_attempts)
+        {
+            simulation_result.peak_attempts = simulation_result.attempts_per_second[i];
+        }
+
+        if (simulation_result.attempts_per_second[i] > 0)
+        {
+            last_second = i;
+        }
+    }
+
+    (void)printf("\r\n%s\r\n", scenario->name);
+    (void)printf("devices: %d, outage: %d secs, attempts: %lu, peak: %lu/sec, connected: %lu, last connection at: %lu secs\r\n\r\n",
+        DEVICE_COUNT, OUTAGE_DURATION_IN_SECS,
+        (unsigned long)simulation_result.total_attempts, (unsigned long)simulation_result.peak_attempts,
+        (unsigned long)simulation_result.connected_devices, (unsigned long)simulation_result.last_connection_second);
+
+    for (i = 0; i <= last_second; i++)
+    {
+        size_t bar_length = (simulation_result.peak_attempts == 0 ? 0 :
+            (simulation_result.attempts_per_second[i] * HISTOGRAM_BAR_WIDTH + simulation_result.peak_attempts - 1) / simulation_result.peak_attempts);
+
+        (void)printf("%3lus %6lu |", (unsigned long)i, (unsigned long)simulation_result.attempts_per_second[i]);
+
+        while (bar_length-- > 0)
+        {
+            (void)putchar('#');
+        }
+
+        (void)printf("\r\n");
+    }
+}
+
+int main(void)
+{
+    int result;
+    RETRY_CONTROL_HANDLE* devices;
+    bool* is_connected;
+
+    if ((devices = (RETRY_CONTROL_HANDLE*)calloc(DEVICE_COUNT, sizeof(RETRY_CONTROL_HANDLE))) == NULL)
+    {
+        LogError("Failed allocating the devices");
+        result = MU_FAILURE;
+    }
+    else if ((is_connected = (bool*)calloc(DEVICE_COUNT, sizeof(bool))) == NULL)
+    {
+        LogError("Failed allocating the device states");
+        free(devices);
+        result = MU_FAILURE;
+    }
+    else if (connection_governor_init() != 0)
+    {
+        LogError("Failed initializing the connection governor");
+        free(is_connected);
+        free(devices);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        size_t i;
+
+        result = 0;
+
+        for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+        {
+            if (connection_governor_set_rate(scenarios[i].connections_per_second, BURST_SIZE) != 0)
+            {
+                LogError("Failed setting the connection rate for scenario %s", scenarios[i].name);
+                result = MU_FAILURE;
+            }
+            else if (create_devices(&scenarios[i], devices) != 0)
+            {
+                LogError("Failed creating the devices for scenario %s", scenarios[i].name);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                run_scenario(devices, is_connected);
+                print_result(&scenarios[i]);
+            }
+
+            destroy_devices(devices);
+        }
+
+        connection_governor_deinit();
+        free(is_connected);
+        free(devices);
+    }
+
+    return result;
+}
@@ -270,18 +270,22 @@ static void set_exp_calls_for_create_encoded_application_properties(size_t numbe
 {
     size_t encoding_size = TEST_AMQP_ENCODING_SIZE;
 
-    STRICT_EXPECTED_CALL(IoTHubMessage_Properties(TEST_IOTHUB_MESSAGE_HANDLE)); //16
-    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .CopyOutArgumentBuffer(2, &TEST_MAP_KEYS, sizeof(TEST_MAP_KEYS))
-        .CopyOutArgumentBuffer(3, &TEST_MAP_VALUES, sizeof(TEST_MAP_VALUES))
-        .CopyOutArgumentBuffer(4, &number_of_app_properties, sizeof(number_of_app_properties));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetPropertyCount(TEST_IOTHUB_MESSAGE_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &number_of_app_properties, sizeof(number_of_app_properties));
 
     if (number_of_app_properties > 0)
     {
         STRICT_EXPECTED_CALL(amqpvalue_create_map());
+        // fault injection check on the first key
+        STRICT_EXPECTED_CALL(IoTHubMessage_GetPropertyAt(TEST_IOTHUB_MESSAGE_HANDLE, 0, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(3, &TEST_MAP_KEYS[0], sizeof(char*))
+            .CopyOutArgumentBuffer(4, &TEST_MAP_VALUES[0], sizeof(char*));
 
         for (size_t i = 0; i < number_of_app_properties; i++)
         {
+            STRICT_EXPECTED_CALL(IoTHubMessage_GetPropertyAt(TEST_IOTHUB_MESSAGE_HANDLE, i, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .CopyOutArgumentBuffer(3, &TEST_MAP_KEYS[i], sizeof(char*))
+                .CopyOutArgumentBuffer(4, &TEST_MAP_VALUES[i], sizeof(char*));
             STRICT_EXPECTED_CALL(amqpvalue_create_string(TEST_MAP_KEYS[i]));
             STRICT_EXPECTED_CALL(amqpvalue_create_string(TEST_MAP_VALUES[i]));
             STRICT_EXPECTED_CALL(amqpvalue_set_map_value(TEST_AMQP_VALUE, TEST_AMQP_VALUE, TEST_AMQP_VALUE));
@@ -578,6 +582,10 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
 
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_Properties, TEST_MAP_HANDLE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_Properties, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_GetPropertyCount, IOTHUB_MESSAGE_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_GetPropertyCount, IOTHUB_MESSAGE_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_GetPropertyAt, IOTHUB_MESSAGE_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_GetPropertyAt, IOTHUB_MESSAGE_ERROR);
 
     REGISTER_GLOBAL_MOCK_RETURN(amqpvalue_create_map, TEST_AMQP_VALUE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(amqpvalue_create_map, NULL);
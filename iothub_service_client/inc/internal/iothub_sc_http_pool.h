@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef IOTHUB_SC_HTTP_POOL_H
+#define IOTHUB_SC_HTTP_POOL_H
+
+#include <stddef.h>
+#include "azure_macro_utils/macro_utils.h"
+#include "umock_c/umock_c_prod.h"
+#include "azure_c_shared_utility/httpapiex.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#include "azure_c_shared_utility/buffer_.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief  Number of connections a pool is created with when the caller does not set one.
+*/
+#define SC_HTTP_POOL_DEFAULT_MAX_CONNECTIONS    4
+
+/** @brief  Handle to a set of persistent HTTPAPIEX connections to one IoT Hub, sharing one SAS token.
+*/
+typedef struct SC_HTTP_POOL_TAG* SC_HTTP_POOL_HANDLE;
+
+/** @brief  Handle to one connection of a pool, only ever used by one thread at a time.
+*/
+typedef struct SC_HTTP_CONNECTION_TAG* SC_HTTP_CONNECTION_HANDLE;
+
+/** @brief  Called by sc_http_pool_run once for every request index, on the thread that owns @p connection.
+*/
+typedef void(*SC_HTTP_POOL_REQUEST_CALLBACK)(void* context, size_t index, SC_HTTP_CONNECTION_HANDLE connection);
+
+/** @brief  Creates a pool of up to @p maxConnections connections to @p hostname.
+*
+* @param    hostname            The IoT Hub host name.
+* @param    keyName             The name of the shared access policy.
+* @param    sharedAccessKey     The key of the policy, or a shared access signature prefixed with "sas=".
+* @param    maxConnections      The number of connections, and so of requests run at the same time.
+*
+* @return   A non-NULL @c SC_HTTP_POOL_HANDLE upon success, @c NULL upon failure.
+*/
+MOCKABLE_FUNCTION(, SC_HTTP_POOL_HANDLE, sc_http_pool_create, const char*, hostname, const char*, keyName, const char*, sharedAccessKey, size_t, maxConnections);
+
+/** @brief  Closes every connection of the pool and frees it.
+*
+* @param    pool    The pool created by sc_http_pool_create.
+*/
+MOCKABLE_FUNCTION(, void, sc_http_pool_destroy, SC_HTTP_POOL_HANDLE, pool);
+
+/** @brief  Calls @p requestCallback for every index below @p requestCount, running as many of them at a time as
+*           the pool has connections, and returns once all of them have returned.
+*
+* @param    pool                The pool created by sc_http_pool_create.
+* @param    requestCount        The number of requests.
+* @param    requestCallback     Runs the request of one index on the given connection.
+* @param    context             Passed to every call of @p requestCallback.
+*
+* @return   0 once every request has run, a non-zero number if none of them could be started.
+*/
+MOCKABLE_FUNCTION(, int, sc_http_pool_run, SC_HTTP_POOL_HANDLE, pool, size_t, requestCount, SC_HTTP_POOL_REQUEST_CALLBACK, requestCallback, void*, context);
+
+/** @brief  Signs @p requestHeaders with the SAS token of the pool and executes the request on @p connection,
+*           reusing the connection opened by the previous request if there was one.
+*
+* @param    connection          The connection handed to the request callback.
+* @param    requestType         The HTTP method.
+* @param    relativePath        The path and query of the request.
+* @param    requestHeaders      The headers of the request, the Authorization header is replaced.
+* @param    requestContent      The body of the request, may be NULL. It is only read.
+* @param    statusCode          Receives the HTTP status code.
+* @param    responseContent     Receives the body of the response.
+*
+* @return   0 once a response has been received, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, sc_http_pool_execute, SC_HTTP_CONNECTION_HANDLE, connection, HTTPAPI_REQUEST_TYPE, requestType, const char*, relativePath, HTTP_HEADERS_HANDLE, requestHeaders, BUFFER_HANDLE, requestContent, unsigned int*, statusCode, BUFFER_HANDLE, responseContent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTHUB_SC_HTTP_POOL_H
@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Single pass JSON reader of the service client, used for the device and module lists of the registry manager.
+// It is not part of the provisioning service client, whose models are still parsed with parson.
+
+#ifndef IOTHUB_SC_JSON_READER_H
+#define IOTHUB_SC_JSON_READER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "azure_macro_utils/macro_utils.h"
+#include "umock_c/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SC_JSON_READER_MAX_DEPTH    32
+
+#define SC_JSON_TOKEN_VALUES        \
+    SC_JSON_TOKEN_BEGIN_OBJECT,     \
+    SC_JSON_TOKEN_END_OBJECT,       \
+    SC_JSON_TOKEN_BEGIN_ARRAY,      \
+    SC_JSON_TOKEN_END_ARRAY,        \
+    SC_JSON_TOKEN_NAME,             \
+    SC_JSON_TOKEN_STRING,           \
+    SC_JSON_TOKEN_NUMBER,           \
+    SC_JSON_TOKEN_TRUE,             \
+    SC_JSON_TOKEN_FALSE,            \
+    SC_JSON_TOKEN_NULL,             \
+    SC_JSON_TOKEN_END,              \
+    SC_JSON_TOKEN_ERROR
+
+MU_DEFINE_ENUM(SC_JSON_TOKEN, SC_JSON_TOKEN_VALUES);
+
+/** @brief  Raw text of the last token read, pointing into the JSON being read. For names and strings it excludes
+*           the quotes and is still escaped.
+*/
+typedef struct SC_JSON_VALUE_TAG
+{
+    const char* text;
+    size_t length;
+    bool is_escaped;
+} SC_JSON_VALUE;
+
+/** @brief  State of a single pass over a JSON text. The reader never allocates: it lives on the stack of its
+*           caller and hands out SC_JSON_VALUEs that point into the text, which must outlive the reader.
+*/
+typedef struct SC_JSON_READER_TAG
+{
+    const char* json;
+    size_t length;
+    size_t position;
+    int state;
+    size_t depth;
+    char containers[SC_JSON_READER_MAX_DEPTH];
+    SC_JSON_VALUE value;
+} SC_JSON_READER;
+
+/** @brief  Prepares reader for a pass over the first length characters of json.
+*
+* @param    reader  The reader to initialize.
+* @param    json    The JSON text. It does not need to be NULL terminated.
+* @param    length  The number of characters of json to read.
+*
+* @return   0 upon success, a non-zero number otherwise.
+*/
+MOCKABLE_FUNCTION(, int, sc_json_reader_init, SC_JSON_READER*, reader, const char*, json, size_t, length);
+
+/** @brief  Reads the next token. A SC_JSON_TOKEN_NAME is always followed by the token of its value.
+*
+* @param    reader  The reader.
+*
+* @return   The token read, SC_JSON_TOKEN_END once the whole text has been read, or SC_JSON_TOKEN_ERROR if the text
+*           is not valid JSON. Once SC_JSON_TOKEN_END or SC_JSON_TOKEN_ERROR has been returned, every later call
+*           returns it again.
+*/
+MOCKABLE_FUNCTION(, SC_JSON_TOKEN, sc_json_reader_next, SC_JSON_READER*, reader);
+
+/** @brief  Gets the text of the last SC_JSON_TOKEN_NAME, SC_JSON_TOKEN_STRING or SC_JSON_TOKEN_NUMBER read.
+*
+* @param    reader  The reader.
+*
+* @return   A pointer to the value, or NULL if the last token has no text. The next call to sc_json_reader_next
+*           overwrites the value, copy the structure to keep it.
+*/
+MOCKABLE_FUNCTION(, const SC_JSON_VALUE*, sc_json_reader_get_value, SC_JSON_READER*, reader);
+
+/** @brief  Skips the value whose first token was just read. Objects and arrays are skipped up to and including
+*           their closing token, for any other token this does nothing.
+*
+* @param    reader  The reader.
+* @param    token   The token just read.
+*
+* @return   0 upon success, a non-zero number if the skipped value is not valid JSON.
+*/
+MOCKABLE_FUNCTION(, int, sc_json_reader_skip, SC_JSON_READER*, reader, SC_JSON_TOKEN, token);
+
+/** @brief  Compares a value with a NULL terminated string, without allocating.
+*
+* @param    value   The value, as returned by sc_json_reader_get_value.
+* @param    text    The string to compare with.
+*
+* @return   true if the unescaped value is equal to text, false otherwise.  A value holding an escaped NUL
+*           character is never equal to text.
+*/
+MOCKABLE_FUNCTION(, bool, sc_json_value_equals, const SC_JSON_VALUE*, value, const char*, text);
+
+/** @brief  Copies the unescaped value into a newly allocated, NULL terminated string.
+*
+* @param    value       The value, as returned by sc_json_reader_get_value.
+* @param    destination Receives the copy. The caller must free it.
+*
+* @return   0 upon success, a non-zero number otherwise.
+*/
+MOCKABLE_FUNCTION(, int, sc_json_value_copy, const SC_JSON_VALUE*, value, char**, destination);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTHUB_SC_JSON_READER_H */
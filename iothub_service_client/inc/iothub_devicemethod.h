@@ -28,6 +28,18 @@ MU_DEFINE_ENUM(IOTHUB_DEVICE_METHOD_RESULT, IOTHUB_DEVICE_METHOD_RESULT_VALUES);
 */
 typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_TAG* IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE;
 
+/** @brief  Reports the outcome of the call on one device of IoTHubDeviceMethod_InvokeMany.
+*
+* @param    userContext             The context given to IoTHubDeviceMethod_InvokeMany.
+* @param    index                   The index of the device in deviceIds.
+* @param    deviceId                The device name (id) the method was called on.
+* @param    result                  IOTHUB_DEVICE_METHOD_OK if the device answered, the reason it did not otherwise.
+* @param    responseStatus          Response status code from invocation.
+* @param    responsePayload         Response payload, only valid until the callback returns.
+* @param    responsePayloadSize     String length of responsePayload.
+*/
+typedef void(*IOTHUB_DEVICE_METHOD_INVOKE_MANY_CALLBACK)(void* userContext, size_t index, const char* deviceId, IOTHUB_DEVICE_METHOD_RESULT result, int responseStatus, const unsigned char* responsePayload, size_t responsePayloadSize);
+
 /** @brief    Creates a IoT Hub Service Client DeviceMethod handle for use it in consequent APIs.
 *
 * @param    serviceClientHandle    Service client handle.
@@ -75,6 +87,35 @@ MOCKABLE_FUNCTION(, IOTHUB_DEVICE_METHOD_RESULT, IoTHubDeviceMethod_Invoke, IOTH
 */
 MOCKABLE_FUNCTION(, IOTHUB_DEVICE_METHOD_RESULT, IoTHubDeviceMethod_InvokeModule, IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, serviceClientDeviceMethodHandle, const char*, deviceId, const char*, moduleId, const char*, methodName, const char*, methodPayload, unsigned int, timeout, int*, responseStatus, unsigned char**, responsePayload, size_t*, responsePayloadSize);
 
+/** @brief    Calls a method with a given payload on many devices, running the calls concurrently on a pool of
+*             connections kept open between calls.
+*
+* @details   The pool is opened by the first call and closed by IoTHubDeviceMethod_Destroy. The SAS token is
+*            created once and shared by all the requests until it is about to expire. Calls on the handle
+*            must not run concurrently.
+*
+* @param    serviceClientDeviceMethodHandle    The handle created by a call to the create function.
+* @param    deviceIds                       The device names (ids) to call the method on.
+* @param    deviceCount                     The number of devices in deviceIds.
+* @param    methodName                      The method name to call.
+* @param    methodPayload                   The message payload to send to every device.
+* @param    timeout                         Time before the call on each device times out.
+* @param    invokeManyCallback              Called once per device from a pool thread, never for two devices at once.
+* @param    userContext                     Passed to every call of invokeManyCallback.
+*
+* @return    IOTHUB_DEVICE_METHOD_OK once every device has been reported, whatever the results, or the reason no
+*            device could be called.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_DEVICE_METHOD_RESULT, IoTHubDeviceMethod_InvokeMany, IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, serviceClientDeviceMethodHandle, const char* const*, deviceIds, size_t, deviceCount, const char*, methodName, const char*, methodPayload, unsigned int, timeout, IOTHUB_DEVICE_METHOD_INVOKE_MANY_CALLBACK, invokeManyCallback, void*, userContext);
+
+/** @brief    Sets how many connections IoTHubDeviceMethod_InvokeMany opens, and so how many devices it calls at once (default 4).
+*
+* @param    serviceClientDeviceMethodHandle    The handle created by a call to the create function.
+* @param    maxConnections                  The maximum number of connections, at least 1.
+*
+* @return    An IOTHUB_DEVICE_METHOD_RESULT containing the return status.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_DEVICE_METHOD_RESULT, IoTHubDeviceMethod_SetMaxConnections, IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, serviceClientDeviceMethodHandle, size_t, maxConnections);
 
 #ifdef __cplusplus
 }
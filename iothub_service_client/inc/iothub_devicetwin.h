@@ -32,6 +32,16 @@ MU_DEFINE_ENUM(IOTHUB_DEVICE_TWIN_RESULT, IOTHUB_DEVICE_TWIN_RESULT_VALUES);
 */
 typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_TAG* IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE;
 
+/** @brief  Reports the outcome of the update of one device of IoTHubDeviceTwin_UpdateMany.
+*
+* @param    userContext         The context given to IoTHubDeviceTwin_UpdateMany.
+* @param    index               The index of the device in deviceIds.
+* @param    deviceId            The device name (id) whose twin was updated.
+* @param    result              IOTHUB_DEVICE_TWIN_OK if the twin was updated, the reason it was not otherwise.
+* @param    updatedTwinJson     The updated device twin upon success, NULL otherwise. Only valid until the callback returns.
+*/
+typedef void(*IOTHUB_DEVICE_TWIN_UPDATE_MANY_CALLBACK)(void* userContext, size_t index, const char* deviceId, IOTHUB_DEVICE_TWIN_RESULT result, const char* updatedTwinJson);
+
 
 /** @brief    Creates a IoT Hub Service Client DeviceTwin handle for use it in consequent APIs.
 *
@@ -92,6 +102,34 @@ MOCKABLE_FUNCTION(, char*,  IoTHubDeviceTwin_GetModuleTwin, IOTHUB_SERVICE_CLIEN
 */
 MOCKABLE_FUNCTION(, char*,  IoTHubDeviceTwin_UpdateModuleTwin, IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, serviceClientDeviceTwinHandle, const char*, deviceId, const char*, moduleId, const char*, moduleTwinJson);
 
+/** @brief  Updates (partial update) the twin of many devices with the same patch, running the updates
+*           concurrently on a pool of connections kept open between calls.
+*
+* @details  The pool is opened by the first call and closed by IoTHubDeviceTwin_Destroy. The SAS token is
+*           created once and shared by all the requests until it is about to expire. Calls on the handle
+*           must not run concurrently.
+*
+* @param    serviceClientDeviceTwinHandle   The handle created by a call to the create function.
+* @param    deviceIds                       The device names (ids) to update the twin info for.
+* @param    deviceCount                     The number of devices in deviceIds.
+* @param    deviceTwinJson                  DeviceTwin JSon string containing the info (tags, desired properties) to update.
+* @param    updateManyCallback              Called once per device from a pool thread, never for two devices at once.
+* @param    userContext                     Passed to every call of updateManyCallback.
+*
+* @return   IOTHUB_DEVICE_TWIN_OK once every device has been reported, whatever the results, or the reason no
+*           device could be updated.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_DEVICE_TWIN_RESULT, IoTHubDeviceTwin_UpdateMany, IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, serviceClientDeviceTwinHandle, const char* const*, deviceIds, size_t, deviceCount, const char*, deviceTwinJson, IOTHUB_DEVICE_TWIN_UPDATE_MANY_CALLBACK, updateManyCallback, void*, userContext);
+
+/** @brief  Sets how many connections IoTHubDeviceTwin_UpdateMany opens, and so how many twins it updates at once (default 4).
+*
+* @param    serviceClientDeviceTwinHandle   The handle created by a call to the create function.
+* @param    maxConnections                  The maximum number of connections, at least 1.
+*
+* @return   An IOTHUB_DEVICE_TWIN_RESULT containing the return status.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_DEVICE_TWIN_RESULT, IoTHubDeviceTwin_SetMaxConnections, IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, serviceClientDeviceTwinHandle, size_t, maxConnections);
+
 #ifdef __cplusplus
 }
 #endif
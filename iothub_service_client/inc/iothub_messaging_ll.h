@@ -43,7 +43,8 @@ MU_DEFINE_ENUM(IOTHUB_MESSAGE_SEND_STATE, IOTHUB_MESSAGE_SEND_STATE_VALUES);
     IOTHUB_MESSAGING_ERROR,                  \
     IOTHUB_MESSAGING_INVALID_JSON,           \
     IOTHUB_MESSAGING_DEVICE_EXIST,           \
-    IOTHUB_MESSAGING_CALLBACK_NOT_SET        \
+    IOTHUB_MESSAGING_CALLBACK_NOT_SET,       \
+    IOTHUB_MESSAGING_QUEUE_FULL              \
 
 MU_DEFINE_ENUM(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_RESULT_VALUES);
 
@@ -70,6 +71,8 @@ typedef struct IOTHUB_MESSAGING_TAG* IOTHUB_MESSAGING_HANDLE;
 typedef void(*IOTHUB_OPEN_COMPLETE_CALLBACK)(void* context);
 typedef void(*IOTHUB_SEND_COMPLETE_CALLBACK)(void* context, IOTHUB_MESSAGING_RESULT messagingResult);
 typedef void(*IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK)(void* context, IOTHUB_SERVICE_FEEDBACK_BATCH* feedbackBatch);
+typedef void(*IOTHUB_SEND_MANY_COMPLETE_CALLBACK)(void* context, size_t index, IOTHUB_MESSAGING_RESULT messagingResult);
+typedef void(*IOTHUB_SEND_QUEUE_CALLBACK)(void* context, size_t messagesInFlight, size_t messagesQueued);
 
 /** @brief    Creates a IoT Hub Service Client Messaging handle for use it in consequent APIs.
 *
@@ -122,10 +125,81 @@ MOCKABLE_FUNCTION(, void, IoTHubMessaging_LL_Close, IOTHUB_MESSAGING_HANDLE, mes
 *            @b NOTE: The application behavior is undefined if the user calls
 *            the ::IoTHubMessaging_Destroy or IoTHubMessaging_Close function from within any callback.
 *
-* @return    IOTHUB_MESSAGING_OK upon success or an error code upon failure.
+* @return    IOTHUB_MESSAGING_OK upon success, IOTHUB_MESSAGING_QUEUE_FULL if the message would have to
+*            wait in a queue that already holds the number of messages set by
+*            IoTHubMessaging_LL_SetMaxMessagesQueued, or an error code upon failure.
 */
 MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_Send, IOTHUB_MESSAGING_HANDLE, messagingHandle, const char*, deviceId, IOTHUB_MESSAGE_HANDLE, message, IOTHUB_SEND_COMPLETE_CALLBACK, sendCompleteCallback, void*, userContextCallback);
 
+/**
+* @brief    Sends one message to many devices. The message is encoded once, and only its
+*           destination changes from one device to the next.
+*
+* @param    messagingHandle         The handle created by a call to the create function.
+* @param    deviceIds               The names (Ids) of the devices to send the message to.
+* @param    deviceCount             The number of entries in @p deviceIds.
+* @param    message                 The message to send.
+* @param    sendCompleteCallback    The callback specified by the user for receiving
+*                                   confirmation of the delivery of the message to each device,
+*                                   with the index of the device in @p deviceIds.
+*                                   The user can specify a @c NULL value here to
+*                                   indicate that no callback is required.
+* @param    userContextCallback     User specified context that will be provided to the
+*                                   callback. This can be @c NULL.
+*
+*            @b NOTE: If the message cannot be sent to one of the devices, the callback is called
+*            for that device with IOTHUB_MESSAGING_ERROR, or IOTHUB_MESSAGING_QUEUE_FULL if the
+*            limit set by IoTHubMessaging_LL_SetMaxMessagesQueued is reached, before this function
+*            returns, and the message is still sent to the others.
+*
+* @return    IOTHUB_MESSAGING_OK if the message was sent or queued for every device or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_SendMany, IOTHUB_MESSAGING_HANDLE, messagingHandle, const char* const*, deviceIds, size_t, deviceCount, IOTHUB_MESSAGE_HANDLE, message, IOTHUB_SEND_MANY_COMPLETE_CALLBACK, sendCompleteCallback, void*, userContextCallback);
+
+/**
+* @brief    Limits the number of messages handed to AMQP that have not been acknowledged yet.
+*           The messages sent beyond that limit wait in the messaging handle, in the order
+*           they were sent, and are handed to AMQP by IoTHubMessaging_LL_DoWork as the
+*           earlier ones are acknowledged.
+*
+* @param    messagingHandle         The handle created by a call to the create function.
+* @param    maxMessagesInFlight     The maximum number of messages in flight, or 0 for no
+*                                   limit, which is the default.
+*
+* @return    IOTHUB_MESSAGING_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_SetMaxMessagesInFlight, IOTHUB_MESSAGING_HANDLE, messagingHandle, size_t, maxMessagesInFlight);
+
+/**
+* @brief    Limits the number of messages waiting for room in the window set by
+*           IoTHubMessaging_LL_SetMaxMessagesInFlight. Once the limit is reached, the send
+*           functions give IOTHUB_MESSAGING_QUEUE_FULL instead of queueing more, and the caller
+*           should call IoTHubMessaging_LL_DoWork before sending again.
+*
+* @param    messagingHandle         The handle created by a call to the create function.
+* @param    maxMessagesQueued       The maximum number of queued messages, or 0 for no
+*                                   limit, which is the default.
+*
+* @return    IOTHUB_MESSAGING_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_SetMaxMessagesQueued, IOTHUB_MESSAGING_HANDLE, messagingHandle, size_t, maxMessagesQueued);
+
+/**
+* @brief    Sets a callback that reports the number of messages in flight and the number of
+*           messages waiting for room in the window, so that the caller can stop sending while
+*           the queue grows.
+*
+* @param    messagingHandle         The handle created by a call to the create function.
+* @param    sendQueueCallback       The callback, called from the send functions and from
+*                                   IoTHubMessaging_LL_DoWork whenever either number changed.
+*                                   The user can specify a @c NULL value here to stop the reports.
+* @param    userContextCallback     User specified context that will be provided to the
+*                                   callback. This can be @c NULL.
+*
+* @return    IOTHUB_MESSAGING_OK upon success or an error code upon failure.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGING_RESULT, IoTHubMessaging_LL_SetSendQueueCallback, IOTHUB_MESSAGING_HANDLE, messagingHandle, IOTHUB_SEND_QUEUE_CALLBACK, sendQueueCallback, void*, userContextCallback);
+
 /**
 * @brief    This API specifies a callback to be used when the device receives the message.
 *
@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <ctype.h>
+#include <stdbool.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/string_tokenizer.h"
@@ -14,10 +15,12 @@
 #include "azure_c_shared_utility/azure_base64.h"
 #include "azure_c_shared_utility/uniqueid.h"
 #include "azure_c_shared_utility/connection_string_parser.h"
+#include "azure_c_shared_utility/lock.h"
 
 #include "parson.h"
 #include "iothub_devicemethod.h"
 #include "iothub_sc_version.h"
+#include "internal/iothub_sc_http_pool.h"
 
 MU_DEFINE_ENUM_STRINGS(IOTHUB_DEVICE_METHOD_RESULT, IOTHUB_DEVICE_METHOD_RESULT_VALUES);
 
@@ -50,8 +53,21 @@ typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_TAG
     char* hostname;
     char* sharedAccessKey;
     char* keyName;
+    SC_HTTP_POOL_HANDLE httpPool;
+    size_t maxConnections;
 } IOTHUB_SERVICE_CLIENT_DEVICE_METHOD;
 
+/** @brief Shared by the requests of one IoTHubDeviceMethod_InvokeMany call
+*/
+typedef struct IOTHUB_DEVICE_METHOD_INVOKE_MANY_TAG
+{
+    const char* const* deviceIds;
+    BUFFER_HANDLE httpPayloadBuffer;
+    LOCK_HANDLE callbackLock;
+    IOTHUB_DEVICE_METHOD_INVOKE_MANY_CALLBACK invokeManyCallback;
+    void* userContext;
+} IOTHUB_DEVICE_METHOD_INVOKE_MANY;
+
 static IOTHUB_DEVICE_METHOD_RESULT parseResponseJson(BUFFER_HANDLE responseJson, int* responseStatus, unsigned char** responsePayload, size_t* responsePayloadSize)
 {
     IOTHUB_DEVICE_METHOD_RESULT result;
@@ -357,6 +373,96 @@ static IOTHUB_DEVICE_METHOD_RESULT sendHttpRequestDeviceMethod(IOTHUB_SERVICE_CL
     return result;
 }
 
+static IOTHUB_DEVICE_METHOD_RESULT sendHttpRequestOnConnection(SC_HTTP_CONNECTION_HANDLE connection, const char* deviceId, BUFFER_HANDLE deviceJsonBuffer, BUFFER_HANDLE responseBuffer)
+{
+    IOTHUB_DEVICE_METHOD_RESULT result;
+    HTTP_HEADERS_HANDLE httpHeader;
+    STRING_HANDLE relativePath;
+    unsigned int statusCode = 0;
+
+    if ((httpHeader = createHttpHeader()) == NULL)
+    {
+        LogError("HttpHeader creation failed");
+        result = IOTHUB_DEVICE_METHOD_ERROR;
+    }
+    else if ((relativePath = createRelativePath(IOTHUB_DEVICEMETHOD_REQUEST_INVOKE, deviceId, NULL)) == NULL)
+    {
+        LogError("Failure creating relative path");
+        HTTPHeaders_Free(httpHeader);
+        result = IOTHUB_DEVICE_METHOD_ERROR;
+    }
+    else
+    {
+        if (sc_http_pool_execute(connection, HTTPAPI_REQUEST_POST, STRING_c_str(relativePath), httpHeader, deviceJsonBuffer, &statusCode, responseBuffer) != 0)
+        {
+            LogError("sc_http_pool_execute failed");
+            result = IOTHUB_DEVICE_METHOD_HTTPAPI_ERROR;
+        }
+        else if (statusCode != 200)
+        {
+            LogError("Http Failure status code %d.", statusCode);
+            result = IOTHUB_DEVICE_METHOD_ERROR;
+        }
+        else
+        {
+            result = IOTHUB_DEVICE_METHOD_OK;
+        }
+        STRING_delete(relativePath);
+        HTTPHeaders_Free(httpHeader);
+    }
+    return result;
+}
+
+static void invokeManyOnConnection(void* context, size_t index, SC_HTTP_CONNECTION_HANDLE connection)
+{
+    IOTHUB_DEVICE_METHOD_INVOKE_MANY* invokeMany = (IOTHUB_DEVICE_METHOD_INVOKE_MANY*)context;
+    const char* deviceId = invokeMany->deviceIds[index];
+    IOTHUB_DEVICE_METHOD_RESULT result;
+    int responseStatus = 0;
+    unsigned char* responsePayload = NULL;
+    size_t responsePayloadSize = 0;
+    BUFFER_HANDLE responseBuffer;
+    bool isLocked;
+
+    if (deviceId == NULL)
+    {
+        /*Codes_SRS_IOTHUBDEVICEMETHOD_09_009: [ If a device id is NULL, IoTHubDeviceMethod_InvokeMany shall report IOTHUB_DEVICE_METHOD_INVALID_ARG for it without sending anything. ]*/
+        LogError("The device id at index %lu is NULL", (unsigned long)index);
+        result = IOTHUB_DEVICE_METHOD_INVALID_ARG;
+    }
+    else if ((responseBuffer = BUFFER_new()) == NULL)
+    {
+        LogError("BUFFER_new failed for responseBuffer");
+        result = IOTHUB_DEVICE_METHOD_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBDEVICEMETHOD_09_007: [ IoTHubDeviceMethod_InvokeMany shall send the request of every device with sc_http_pool_execute, on the connection the pool runs it on, and parse the response as IoTHubDeviceMethod_Invoke does. ]*/
+        if ((result = sendHttpRequestOnConnection(connection, deviceId, invokeMany->httpPayloadBuffer, responseBuffer)) != IOTHUB_DEVICE_METHOD_OK)
+        {
+            LogError("Failure sending HTTP request for device method invoke on %s", deviceId);
+        }
+        else if (parseResponseJson(responseBuffer, &responseStatus, &responsePayload, &responsePayloadSize) != IOTHUB_DEVICE_METHOD_OK)
+        {
+            LogError("Failure parsing response of %s", deviceId);
+            result = IOTHUB_DEVICE_METHOD_ERROR;
+        }
+        BUFFER_delete(responseBuffer);
+    }
+
+    /*Codes_SRS_IOTHUBDEVICEMETHOD_09_008: [ IoTHubDeviceMethod_InvokeMany shall report the result, status and payload of every device to invokeManyCallback, one call at a time, and free the payload once the callback returns. ]*/
+    if (!(isLocked = (Lock(invokeMany->callbackLock) == LOCK_OK)))
+    {
+        LogError("Lock failed, reporting the result of device %lu anyway", (unsigned long)index);
+    }
+    invokeMany->invokeManyCallback(invokeMany->userContext, index, deviceId, result, responseStatus, responsePayload, responsePayloadSize);
+    if (isLocked)
+    {
+        (void)Unlock(invokeMany->callbackLock);
+    }
+    free(responsePayload);
+}
+
 IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE IoTHubDeviceMethod_Create(IOTHUB_SERVICE_CLIENT_AUTH_HANDLE serviceClientHandle)
 {
     IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE result;
@@ -436,6 +542,12 @@ IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE IoTHubDeviceMethod_Create(IOTHUB_SERV
                     free(result);
                     result = NULL;
                 }
+                else
+                {
+                    /*Codes_SRS_IOTHUBDEVICEMETHOD_09_001: [ IoTHubDeviceMethod_Create shall not open any connection, and shall set the number of connections used by IoTHubDeviceMethod_InvokeMany to 4. ]*/
+                    result->httpPool = NULL;
+                    result->maxConnections = SC_HTTP_POOL_DEFAULT_MAX_CONNECTIONS;
+                }
             }
         }
     }
@@ -450,6 +562,11 @@ void IoTHubDeviceMethod_Destroy(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE servi
         /*Codes_SRS_IOTHUBDEVICEMETHOD_12_017: [ If the serviceClientDeviceMethodHandle input parameter is not NULL IoTHubDeviceMethod_Destroy shall free the memory of it and return ]*/
         IOTHUB_SERVICE_CLIENT_DEVICE_METHOD* serviceClientDeviceMethod = (IOTHUB_SERVICE_CLIENT_DEVICE_METHOD*)serviceClientDeviceMethodHandle;
 
+        if (serviceClientDeviceMethod->httpPool != NULL)
+        {
+            /*Codes_SRS_IOTHUBDEVICEMETHOD_09_013: [ IoTHubDeviceMethod_Destroy shall close the connections opened by IoTHubDeviceMethod_InvokeMany by calling sc_http_pool_destroy. ]*/
+            sc_http_pool_destroy(serviceClientDeviceMethod->httpPool);
+        }
         free(serviceClientDeviceMethod->hostname);
         free(serviceClientDeviceMethod->sharedAccessKey);
         free(serviceClientDeviceMethod->keyName);
@@ -547,3 +664,87 @@ IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_InvokeModule(IOTHUB_SERVICE_CLIEN
     return result;
 }
 
+IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_InvokeMany(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, const char* const* deviceIds, size_t deviceCount, const char* methodName, const char* methodPayload, unsigned int timeout, IOTHUB_DEVICE_METHOD_INVOKE_MANY_CALLBACK invokeManyCallback, void* userContext)
+{
+    IOTHUB_DEVICE_METHOD_RESULT result;
+
+    /*Codes_SRS_IOTHUBDEVICEMETHOD_09_002: [ If serviceClientDeviceMethodHandle, methodName, methodPayload or invokeManyCallback is NULL, or deviceIds is NULL while deviceCount is not 0, IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_INVALID_ARG. ]*/
+    if ((serviceClientDeviceMethodHandle == NULL) || (deviceIds == NULL && deviceCount > 0) || (methodName == NULL) || (methodPayload == NULL) || (invokeManyCallback == NULL))
+    {
+        LogError("Input parameter cannot be NULL");
+        result = IOTHUB_DEVICE_METHOD_INVALID_ARG;
+    }
+    else
+    {
+        IOTHUB_DEVICE_METHOD_INVOKE_MANY invokeMany;
+
+        invokeMany.deviceIds = deviceIds;
+        invokeMany.invokeManyCallback = invokeManyCallback;
+        invokeMany.userContext = userContext;
+
+        /*Codes_SRS_IOTHUBDEVICEMETHOD_09_003: [ IoTHubDeviceMethod_InvokeMany shall create the request body from methodName, timeout and methodPayload once, and send it to every device. ]*/
+        if ((invokeMany.httpPayloadBuffer = createMethodPayloadJson(methodName, timeout, methodPayload)) == NULL)
+        {
+            /*Codes_SRS_IOTHUBDEVICEMETHOD_09_010: [ If the request body, the lock or the pool cannot be created, or sc_http_pool_run fails, IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_ERROR. ]*/
+            LogError("BUFFER creation failed for httpPayloadBuffer");
+            result = IOTHUB_DEVICE_METHOD_ERROR;
+        }
+        else if ((invokeMany.callbackLock = Lock_Init()) == NULL)
+        {
+            /*Codes_SRS_IOTHUBDEVICEMETHOD_09_010: [ If the request body, the lock or the pool cannot be created, or sc_http_pool_run fails, IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_ERROR. ]*/
+            LogError("Lock_Init failed");
+            BUFFER_delete(invokeMany.httpPayloadBuffer);
+            result = IOTHUB_DEVICE_METHOD_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBDEVICEMETHOD_09_004: [ On its first call IoTHubDeviceMethod_InvokeMany shall create a pool of connections with sc_http_pool_create, which later calls reuse until IoTHubDeviceMethod_Destroy. ]*/
+            if (serviceClientDeviceMethodHandle->httpPool == NULL &&
+                (serviceClientDeviceMethodHandle->httpPool = sc_http_pool_create(serviceClientDeviceMethodHandle->hostname, serviceClientDeviceMethodHandle->keyName, serviceClientDeviceMethodHandle->sharedAccessKey, serviceClientDeviceMethodHandle->maxConnections)) == NULL)
+            {
+                /*Codes_SRS_IOTHUBDEVICEMETHOD_09_010: [ If the request body, the lock or the pool cannot be created, or sc_http_pool_run fails, IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_ERROR. ]*/
+                LogError("sc_http_pool_create failed");
+                result = IOTHUB_DEVICE_METHOD_ERROR;
+            }
+            /*Codes_SRS_IOTHUBDEVICEMETHOD_09_005: [ IoTHubDeviceMethod_InvokeMany shall run one request per device with sc_http_pool_run, as many at a time as the pool has connections. ]*/
+            else if (sc_http_pool_run(serviceClientDeviceMethodHandle->httpPool, deviceCount, invokeManyOnConnection, &invokeMany) != 0)
+            {
+                /*Codes_SRS_IOTHUBDEVICEMETHOD_09_010: [ If the request body, the lock or the pool cannot be created, or sc_http_pool_run fails, IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_ERROR. ]*/
+                LogError("sc_http_pool_run failed");
+                result = IOTHUB_DEVICE_METHOD_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBDEVICEMETHOD_09_006: [ IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_OK once the result of every device has been reported, whatever the results. ]*/
+                result = IOTHUB_DEVICE_METHOD_OK;
+            }
+            (void)Lock_Deinit(invokeMany.callbackLock);
+            BUFFER_delete(invokeMany.httpPayloadBuffer);
+        }
+    }
+    return result;
+}
+
+IOTHUB_DEVICE_METHOD_RESULT IoTHubDeviceMethod_SetMaxConnections(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE serviceClientDeviceMethodHandle, size_t maxConnections)
+{
+    IOTHUB_DEVICE_METHOD_RESULT result;
+
+    /*Codes_SRS_IOTHUBDEVICEMETHOD_09_011: [ If serviceClientDeviceMethodHandle is NULL or maxConnections is 0, IoTHubDeviceMethod_SetMaxConnections shall return IOTHUB_DEVICE_METHOD_INVALID_ARG. ]*/
+    if ((serviceClientDeviceMethodHandle == NULL) || (maxConnections == 0))
+    {
+        LogError("Invalid parameter serviceClientDeviceMethodHandle: %p, maxConnections: %lu", serviceClientDeviceMethodHandle, (unsigned long)maxConnections);
+        result = IOTHUB_DEVICE_METHOD_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBDEVICEMETHOD_09_012: [ IoTHubDeviceMethod_SetMaxConnections shall close the connections opened so far with sc_http_pool_destroy, so that the next IoTHubDeviceMethod_InvokeMany opens up to maxConnections, and return IOTHUB_DEVICE_METHOD_OK. ]*/
+        if (serviceClientDeviceMethodHandle->httpPool != NULL)
+        {
+            sc_http_pool_destroy(serviceClientDeviceMethodHandle->httpPool);
+            serviceClientDeviceMethodHandle->httpPool = NULL;
+        }
+        serviceClientDeviceMethodHandle->maxConnections = maxConnections;
+        result = IOTHUB_DEVICE_METHOD_OK;
+    }
+    return result;
+}
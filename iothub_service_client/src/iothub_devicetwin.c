@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <ctype.h>
+#include <stdbool.h>
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
@@ -15,10 +16,12 @@
 #include "azure_c_shared_utility/azure_base64.h"
 #include "azure_c_shared_utility/uniqueid.h"
 #include "azure_c_shared_utility/connection_string_parser.h"
+#include "azure_c_shared_utility/lock.h"
 
 #include "parson.h"
 #include "iothub_devicetwin.h"
 #include "iothub_sc_version.h"
+#include "internal/iothub_sc_http_pool.h"
 
 #define IOTHUB_TWIN_REQUEST_MODE_VALUES    \
     IOTHUB_TWIN_REQUEST_GET,               \
@@ -56,8 +59,21 @@ typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_TAG
     char* hostname;
     char* sharedAccessKey;
     char* keyName;
+    SC_HTTP_POOL_HANDLE httpPool;
+    size_t maxConnections;
 } IOTHUB_SERVICE_CLIENT_DEVICE_TWIN;
 
+/** @brief Shared by the requests of one IoTHubDeviceTwin_UpdateMany call
+*/
+typedef struct IOTHUB_DEVICE_TWIN_UPDATE_MANY_TAG
+{
+    const char* const* deviceIds;
+    BUFFER_HANDLE updateJson;
+    LOCK_HANDLE callbackLock;
+    IOTHUB_DEVICE_TWIN_UPDATE_MANY_CALLBACK updateManyCallback;
+    void* userContext;
+} IOTHUB_DEVICE_TWIN_UPDATE_MANY;
+
 static const char* generateGuid(void)
 {
     char* result;
@@ -301,6 +317,11 @@ static IOTHUB_DEVICE_TWIN_RESULT sendHttpRequestTwin(IOTHUB_SERVICE_CLIENT_DEVIC
 
 static void free_devicetwin_handle(IOTHUB_SERVICE_CLIENT_DEVICE_TWIN* deviceTwin)
 {
+    if (deviceTwin->httpPool != NULL)
+    {
+        /*Codes_SRS_IOTHUBDEVICETWIN_09_012: [ IoTHubDeviceTwin_Destroy shall close the connections opened by IoTHubDeviceTwin_UpdateMany by calling sc_http_pool_destroy. ]*/
+        sc_http_pool_destroy(deviceTwin->httpPool);
+    }
     free(deviceTwin->hostname);
     free(deviceTwin->sharedAccessKey);
     free(deviceTwin->keyName);
@@ -385,6 +406,11 @@ IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE IoTHubDeviceTwin_Create(IOTHUB_SERVICE_
                     free_devicetwin_handle(result);
                     result = NULL;
                 }
+                else
+                {
+                    /*Codes_SRS_IOTHUBDEVICETWIN_09_001: [ IoTHubDeviceTwin_Create shall not open any connection, and shall set the number of connections used by IoTHubDeviceTwin_UpdateMany to 4. ]*/
+                    result->maxConnections = SC_HTTP_POOL_DEFAULT_MAX_CONNECTIONS;
+                }
             }
         }
     }
@@ -580,6 +606,174 @@ char* IoTHubDeviceTwin_UpdateModuleTwin(IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE
     return result;
 }
 
+static IOTHUB_DEVICE_TWIN_RESULT sendHttpRequestTwinOnConnection(SC_HTTP_CONNECTION_HANDLE connection, const char* deviceId, BUFFER_HANDLE deviceJsonBuffer, BUFFER_HANDLE responseBuffer)
+{
+    IOTHUB_DEVICE_TWIN_RESULT result;
+    HTTP_HEADERS_HANDLE httpHeader;
+    STRING_HANDLE relativePath;
+    unsigned int statusCode = 0;
 
+    if ((httpHeader = createHttpHeader(IOTHUB_TWIN_REQUEST_UPDATE)) == NULL)
+    {
+        LogError("HttpHeader creation failed");
+        result = IOTHUB_DEVICE_TWIN_ERROR;
+    }
+    else if ((relativePath = createRelativePath(IOTHUB_TWIN_REQUEST_UPDATE, deviceId, NULL)) == NULL)
+    {
+        LogError("Failure creating relative path");
+        HTTPHeaders_Free(httpHeader);
+        result = IOTHUB_DEVICE_TWIN_ERROR;
+    }
+    else
+    {
+        if (sc_http_pool_execute(connection, HTTPAPI_REQUEST_PATCH, STRING_c_str(relativePath), httpHeader, deviceJsonBuffer, &statusCode, responseBuffer) != 0)
+        {
+            LogError("sc_http_pool_execute failed");
+            result = IOTHUB_DEVICE_TWIN_HTTPAPI_ERROR;
+        }
+        else if (statusCode != 200)
+        {
+            LogError("Http Failure status code %d.", statusCode);
+            result = IOTHUB_DEVICE_TWIN_ERROR;
+        }
+        else
+        {
+            result = IOTHUB_DEVICE_TWIN_OK;
+        }
+        STRING_delete(relativePath);
+        HTTPHeaders_Free(httpHeader);
+    }
+    return result;
+}
+
+static void updateManyOnConnection(void* context, size_t index, SC_HTTP_CONNECTION_HANDLE connection)
+{
+    IOTHUB_DEVICE_TWIN_UPDATE_MANY* updateMany = (IOTHUB_DEVICE_TWIN_UPDATE_MANY*)context;
+    const char* deviceId = updateMany->deviceIds[index];
+    IOTHUB_DEVICE_TWIN_RESULT result;
+    char* updatedTwinJson = NULL;
+    BUFFER_HANDLE responseBuffer;
+    bool isLocked;
 
+    if (deviceId == NULL)
+    {
+        /*Codes_SRS_IOTHUBDEVICETWIN_09_008: [ If a device id is NULL, IoTHubDeviceTwin_UpdateMany shall report IOTHUB_DEVICE_TWIN_INVALID_ARG for it without sending anything. ]*/
+        LogError("The device id at index %lu is NULL", (unsigned long)index);
+        result = IOTHUB_DEVICE_TWIN_INVALID_ARG;
+    }
+    else if ((responseBuffer = BUFFER_new()) == NULL)
+    {
+        LogError("BUFFER_new failed for responseBuffer");
+        result = IOTHUB_DEVICE_TWIN_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBDEVICETWIN_09_006: [ IoTHubDeviceTwin_UpdateMany shall send the PATCH request of every device with sc_http_pool_execute, on the connection the pool runs it on. ]*/
+        if ((result = sendHttpRequestTwinOnConnection(connection, deviceId, updateMany->updateJson, responseBuffer)) != IOTHUB_DEVICE_TWIN_OK)
+        {
+            LogError("Failure sending HTTP request for twin update on %s", deviceId);
+        }
+        else if (malloc_and_copy_uchar(&updatedTwinJson, responseBuffer) != 0)
+        {
+            LogError("failed to copy response of %s", deviceId);
+            result = IOTHUB_DEVICE_TWIN_ERROR;
+        }
+        BUFFER_delete(responseBuffer);
+    }
 
+    /*Codes_SRS_IOTHUBDEVICETWIN_09_007: [ IoTHubDeviceTwin_UpdateMany shall report the result and the updated twin of every device to updateManyCallback, one call at a time, and free the twin once the callback returns. ]*/
+    if (!(isLocked = (Lock(updateMany->callbackLock) == LOCK_OK)))
+    {
+        LogError("Lock failed, reporting the result of device %lu anyway", (unsigned long)index);
+    }
+    updateMany->updateManyCallback(updateMany->userContext, index, deviceId, result, updatedTwinJson);
+    if (isLocked)
+    {
+        (void)Unlock(updateMany->callbackLock);
+    }
+    free(updatedTwinJson);
+}
+
+IOTHUB_DEVICE_TWIN_RESULT IoTHubDeviceTwin_UpdateMany(IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE serviceClientDeviceTwinHandle, const char* const* deviceIds, size_t deviceCount, const char* deviceTwinJson, IOTHUB_DEVICE_TWIN_UPDATE_MANY_CALLBACK updateManyCallback, void* userContext)
+{
+    IOTHUB_DEVICE_TWIN_RESULT result;
+
+    /*Codes_SRS_IOTHUBDEVICETWIN_09_002: [ If serviceClientDeviceTwinHandle, deviceTwinJson or updateManyCallback is NULL, or deviceIds is NULL while deviceCount is not 0, IoTHubDeviceTwin_UpdateMany shall return IOTHUB_DEVICE_TWIN_INVALID_ARG. ]*/
+    if ((serviceClientDeviceTwinHandle == NULL) || (deviceIds == NULL && deviceCount > 0) || (deviceTwinJson == NULL) || (updateManyCallback == NULL))
+    {
+        LogError("Input parameter cannot be NULL");
+        result = IOTHUB_DEVICE_TWIN_INVALID_ARG;
+    }
+    else
+    {
+        IOTHUB_DEVICE_TWIN_UPDATE_MANY updateMany;
+
+        updateMany.deviceIds = deviceIds;
+        updateMany.updateManyCallback = updateManyCallback;
+        updateMany.userContext = userContext;
+
+        /*Codes_SRS_IOTHUBDEVICETWIN_09_003: [ IoTHubDeviceTwin_UpdateMany shall create the request body from deviceTwinJson once with BUFFER_create, and send it to every device. ]*/
+        if ((updateMany.updateJson = BUFFER_create((const unsigned char*)deviceTwinJson, strlen(deviceTwinJson))) == NULL)
+        {
+            /*Codes_SRS_IOTHUBDEVICETWIN_09_009: [ If the request body, the lock or the pool cannot be created, or sc_http_pool_run fails, IoTHubDeviceTwin_UpdateMany shall return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+            LogError("BUFFER_create failed for deviceTwinJson");
+            result = IOTHUB_DEVICE_TWIN_ERROR;
+        }
+        else if ((updateMany.callbackLock = Lock_Init()) == NULL)
+        {
+            /*Codes_SRS_IOTHUBDEVICETWIN_09_009: [ If the request body, the lock or the pool cannot be created, or sc_http_pool_run fails, IoTHubDeviceTwin_UpdateMany shall return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+            LogError("Lock_Init failed");
+            BUFFER_delete(updateMany.updateJson);
+            result = IOTHUB_DEVICE_TWIN_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBDEVICETWIN_09_004: [ On its first call IoTHubDeviceTwin_UpdateMany shall create a pool of connections with sc_http_pool_create, which later calls reuse until IoTHubDeviceTwin_Destroy. ]*/
+            if (serviceClientDeviceTwinHandle->httpPool == NULL &&
+                (serviceClientDeviceTwinHandle->httpPool = sc_http_pool_create(serviceClientDeviceTwinHandle->hostname, serviceClientDeviceTwinHandle->keyName, serviceClientDeviceTwinHandle->sharedAccessKey, serviceClientDeviceTwinHandle->maxConnections)) == NULL)
+            {
+                /*Codes_SRS_IOTHUBDEVICETWIN_09_009: [ If the request body, the lock or the pool cannot be created, or sc_http_pool_run fails, IoTHubDeviceTwin_UpdateMany shall return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+                LogError("sc_http_pool_create failed");
+                result = IOTHUB_DEVICE_TWIN_ERROR;
+            }
+            /*Codes_SRS_IOTHUBDEVICETWIN_09_005: [ IoTHubDeviceTwin_UpdateMany shall run one request per device with sc_http_pool_run, as many at a time as the pool has connections, and return IOTHUB_DEVICE_TWIN_OK once every device has been reported, whatever the results. ]*/
+            else if (sc_http_pool_run(serviceClientDeviceTwinHandle->httpPool, deviceCount, updateManyOnConnection, &updateMany) != 0)
+            {
+                /*Codes_SRS_IOTHUBDEVICETWIN_09_009: [ If the request body, the lock or the pool cannot be created, or sc_http_pool_run fails, IoTHubDeviceTwin_UpdateMany shall return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+                LogError("sc_http_pool_run failed");
+                result = IOTHUB_DEVICE_TWIN_ERROR;
+            }
+            else
+            {
+                result = IOTHUB_DEVICE_TWIN_OK;
+            }
+            (void)Lock_Deinit(updateMany.callbackLock);
+            BUFFER_delete(updateMany.updateJson);
+        }
+    }
+    return result;
+}
+
+IOTHUB_DEVICE_TWIN_RESULT IoTHubDeviceTwin_SetMaxConnections(IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE serviceClientDeviceTwinHandle, size_t maxConnections)
+{
+    IOTHUB_DEVICE_TWIN_RESULT result;
+
+    /*Codes_SRS_IOTHUBDEVICETWIN_09_010: [ If serviceClientDeviceTwinHandle is NULL or maxConnections is 0, IoTHubDeviceTwin_SetMaxConnections shall return IOTHUB_DEVICE_TWIN_INVALID_ARG. ]*/
+    if ((serviceClientDeviceTwinHandle == NULL) || (maxConnections == 0))
+    {
+        LogError("Invalid parameter serviceClientDeviceTwinHandle: %p, maxConnections: %lu", serviceClientDeviceTwinHandle, (unsigned long)maxConnections);
+        result = IOTHUB_DEVICE_TWIN_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBDEVICETWIN_09_011: [ IoTHubDeviceTwin_SetMaxConnections shall close the connections opened so far with sc_http_pool_destroy, so that the next IoTHubDeviceTwin_UpdateMany opens up to maxConnections, and return IOTHUB_DEVICE_TWIN_OK. ]*/
+        if (serviceClientDeviceTwinHandle->httpPool != NULL)
+        {
+            sc_http_pool_destroy(serviceClientDeviceTwinHandle->httpPool);
+            serviceClientDeviceTwinHandle->httpPool = NULL;
+        }
+        serviceClientDeviceTwinHandle->maxConnections = maxConnections;
+        result = IOTHUB_DEVICE_TWIN_OK;
+    }
+    return result;
+}
@@ -35,13 +35,40 @@ MU_DEFINE_ENUM_STRINGS(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_RESULT_VALUES);
 typedef struct CALLBACK_DATA_TAG
 {
     IOTHUB_OPEN_COMPLETE_CALLBACK openCompleteCompleteCallback;
-    IOTHUB_SEND_COMPLETE_CALLBACK sendCompleteCallback;
     IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK feedbackMessageCallback;
+    IOTHUB_SEND_QUEUE_CALLBACK sendQueueCallback;
     void* openUserContext;
-    void* sendUserContext;
     void* feedbackUserContext;
+    void* sendQueueUserContext;
 } CALLBACK_DATA;
 
+// The uAMQP message encoded once by a send call, with the buffer its TO property is formatted
+// in. It is shared by every device of the call that waits for room in the window, and freed
+// once the call has returned and the last of them was handed to the message sender.
+typedef struct SHARED_MESSAGE_TAG
+{
+    MESSAGE_HANDLE message;
+    PROPERTIES_HANDLE properties;
+    char* deviceDestination;
+    size_t deviceDestinationSize;
+    size_t refCount;
+} SHARED_MESSAGE;
+
+// One message sent to one device, from the send call to its acknowledgement. While it waits
+// for room in the window it only holds the device id and a reference to the shared message;
+// once handed to the message sender, which keeps its own copy, only the callback is left.
+typedef struct OUTGOING_MESSAGE_TAG
+{
+    struct IOTHUB_MESSAGING_TAG* messaging;
+    SHARED_MESSAGE* sharedMessage;
+    char* deviceId;
+    IOTHUB_SEND_COMPLETE_CALLBACK sendCompleteCallback;
+    IOTHUB_SEND_MANY_COMPLETE_CALLBACK sendManyCompleteCallback;
+    size_t index;
+    void* userContext;
+    struct OUTGOING_MESSAGE_TAG* next;
+} OUTGOING_MESSAGE;
+
 typedef struct IOTHUB_MESSAGING_TAG
 {
     int isOpened;
@@ -68,6 +95,15 @@ typedef struct IOTHUB_MESSAGING_TAG
 
     CALLBACK_DATA* callback_data;
 
+    size_t maxMessagesInFlight;
+    size_t maxMessagesQueued;
+    size_t messagesInFlight;
+    size_t messagesQueued;
+    size_t reportedMessagesInFlight;
+    size_t reportedMessagesQueued;
+    OUTGOING_MESSAGE* queueHead;
+    OUTGOING_MESSAGE* queueTail;
+
 } IOTHUB_MESSAGING;
 
 
@@ -159,22 +195,23 @@ static int setCorrelationId(IOTHUB_MESSAGE_HANDLE iothub_message_handle, PROPERT
     return result;
 }
 
-static int addPropertiesToAMQPMessage(IOTHUB_MESSAGE_HANDLE iothub_message_handle, MESSAGE_HANDLE uamqp_message, AMQP_VALUE to_amqp_value)
+static int createAMQPMessageProperties(IOTHUB_MESSAGE_HANDLE iothub_message_handle, MESSAGE_HANDLE uamqp_message, PROPERTIES_HANDLE* uamqp_message_properties)
 {
     int result;
-    PROPERTIES_HANDLE uamqp_message_properties = NULL; /* This initialization is forced by Valgrind */
     int api_call_result;
 
+    *uamqp_message_properties = NULL; /* This initialization is forced by Valgrind */
+
     /*Codes_SRS_IOTHUBMESSAGING_12_079: [ The uAMQP message properties shall be retrieved using message_get_properties ] */
-    if ((api_call_result = message_get_properties(uamqp_message, &uamqp_message_properties)) != 0)
+    if ((api_call_result = message_get_properties(uamqp_message, uamqp_message_properties)) != 0)
     {
         /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
         LogError("Failed to get properties map from uAMQP message (error code %d).", api_call_result);
         result = MU_FAILURE;
     }
     /*Codes_SRS_IOTHUBMESSAGING_12_080: [ If UAMQP message properties were not present then a new properties container shall be created using properties_create ] */
-    else if (uamqp_message_properties == NULL &&
-        (uamqp_message_properties = properties_create()) == NULL)
+    else if (*uamqp_message_properties == NULL &&
+        (*uamqp_message_properties = properties_create()) == NULL)
     {
         /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
         LogError("Failed to create properties map for uAMQP message (error code %d).", api_call_result);
@@ -184,40 +221,65 @@ static int addPropertiesToAMQPMessage(IOTHUB_MESSAGE_HANDLE iothub_message_handl
     {
         /*Codes_SRS_IOTHUBMESSAGING_12_081: [ Message-id from the IOTHUB_MESSAGE shall be read using IoTHubMessage_GetMessageId ] */
         /*Codes_SRS_IOTHUBMESSAGING_12_082: [ As message-id is optional field, if it is not set on the IOTHUB_MESSAGE, message_create_from_iothub_message shall ignore it and continue normally ] */
-        if (setMessageId(iothub_message_handle, uamqp_message_properties) != 0)
+        if (setMessageId(iothub_message_handle, *uamqp_message_properties) != 0)
         {
             LogError("Failed to set uampq messageId.");
             result = MU_FAILURE;
         }
         /*Codes_SRS_IOTHUBMESSAGING_12_084: [ Correlation-id from the IOTHUB_MESSAGE shall be read using IoTHubMessage_GetCorrelationId ] */
         /*Codes_SRS_IOTHUBMESSAGING_12_085: [ As correlation-id is optional field, if it is not set on the IOTHUB_MESSAGE, message_create_from_iothub_message() shall ignore it and continue normally ] */
-        else if (setCorrelationId(iothub_message_handle, uamqp_message_properties) != 0)
+        else if (setCorrelationId(iothub_message_handle, *uamqp_message_properties) != 0)
         {
             LogError("Failed to set uampq correlationId.");
             result = MU_FAILURE;
         }
         else
         {
-            /*Codes_SRS_IOTHUBMESSAGING_12_87: [ IoTHubMessaging_LL_SendMessage shall set the uAMQP message TO property to the given message properties by calling properties_set_to ] */
-            if ((properties_set_to(uamqp_message_properties, to_amqp_value)) != 0)
-            {
-                /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
-                LogError("Could not create properties for message - properties_set_to failed");
-                result = MU_FAILURE;
-            }
-            /*Codes_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_LL_SendMessage shall set the uAMQP message properties to the given message properties by calling message_set_properties ] */
-            else if ((api_call_result = message_set_properties(uamqp_message, uamqp_message_properties)) != 0)
-            {
-                /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
-                LogError("Failed to set properties map on uAMQP message (error code %d).", api_call_result);
-                result = MU_FAILURE;
-            }
-            else
-            {
-                result = 0;
-            }
+            result = 0;
+        }
+
+        if (result != 0)
+        {
+            properties_destroy(*uamqp_message_properties);
+            *uamqp_message_properties = NULL;
+        }
+    }
+    return result;
+}
+
+static int setAMQPMessageDestination(MESSAGE_HANDLE uamqp_message, PROPERTIES_HANDLE uamqp_message_properties, const char* deviceDestination)
+{
+    int result;
+    AMQP_VALUE to_amqp_value;
+    int api_call_result;
+
+    if ((to_amqp_value = amqpvalue_create_string(deviceDestination)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+        LogError("Could not create properties for message - amqpvalue_create_string");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_12_87: [ IoTHubMessaging_LL_SendMessage shall set the uAMQP message TO property to the given message properties by calling properties_set_to ] */
+        if ((properties_set_to(uamqp_message_properties, to_amqp_value)) != 0)
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+            LogError("Could not create properties for message - properties_set_to failed");
+            result = MU_FAILURE;
+        }
+        /*Codes_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_LL_SendMessage shall set the uAMQP message properties to the given message properties by calling message_set_properties ] */
+        else if ((api_call_result = message_set_properties(uamqp_message, uamqp_message_properties)) != 0)
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+            LogError("Failed to set properties map on uAMQP message (error code %d).", api_call_result);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            result = 0;
         }
-        properties_destroy(uamqp_message_properties);
+        amqpvalue_destroy(to_amqp_value);
     }
     return result;
 }
@@ -552,44 +614,28 @@ static char* createSendTargetAddress(IOTHUB_MESSAGING_HANDLE messagingHandle)
     return result;
 }
 
-static char* createDeviceDestinationString(const char* deviceId, const char* moduleId)
+static size_t getDeviceDestinationSize(const char* deviceId, const char* moduleId)
 {
-    char* result;
+    return strlen(AMQP_ADDRESS_PATH_MODULE_FMT) + strlen(deviceId) + (moduleId == NULL ? 0 : strlen(moduleId)) + 1;
+}
 
-    if (deviceId == NULL)
+static int formatDeviceDestination(char* buffer, size_t bufferSize, const char* deviceId, const char* moduleId)
+{
+    int result;
+
+    if ((moduleId == NULL) && (snprintf(buffer, bufferSize, AMQP_ADDRESS_PATH_FMT, deviceId)) < 0)
     {
-        LogError("createDeviceDestinationString failed - deviceId cannot be NULL");
-        result = NULL;
+        LogError("sprintf_s failed for deviceDestinationString.");
+        result = MU_FAILURE;
+    }
+    else if ((moduleId != NULL) && (snprintf(buffer, bufferSize, AMQP_ADDRESS_PATH_MODULE_FMT, deviceId, moduleId)) < 0)
+    {
+        LogError("sprintf_s failed for deviceDestinationString for module.");
+        result = MU_FAILURE;
     }
     else
     {
-        size_t deviceDestLen = strlen(AMQP_ADDRESS_PATH_MODULE_FMT) + strlen(deviceId) + (moduleId == NULL ? 0 : strlen(moduleId)) + 1;
-
-        char* buffer = (char*)malloc(deviceDestLen);
-        if (buffer == NULL)
-        {
-            LogError("Could not create device destination string.");
-            result = NULL;
-        }
-        else
-        {
-            if ((moduleId == NULL) && (snprintf(buffer, deviceDestLen, AMQP_ADDRESS_PATH_FMT, deviceId)) < 0)
-            {
-                LogError("sprintf_s failed for deviceDestinationString.");
-                free((char*)buffer);
-                result = NULL;
-            }
-            else if ((moduleId != NULL) && (snprintf(buffer, deviceDestLen, AMQP_ADDRESS_PATH_MODULE_FMT, deviceId, moduleId)) < 0)
-            {
-                LogError("sprintf_s failed for deviceDestinationString for module.");
-                free((char*)buffer);
-                result = NULL;
-            }
-            else
-            {
-                result = buffer;
-            }
-        }
+        result = 0;
     }
     return result;
 }
@@ -646,6 +692,19 @@ static void IoTHubMessaging_LL_ReceiverStateChanged(const void* context, MESSAGE
     }
 }
 
+static void completeOutgoingMessage(OUTGOING_MESSAGE* outgoingMessage, IOTHUB_MESSAGING_RESULT messagingResult)
+{
+    if (outgoingMessage->sendManyCompleteCallback != NULL)
+    {
+        (outgoingMessage->sendManyCompleteCallback)(outgoingMessage->userContext, outgoingMessage->index, messagingResult);
+    }
+    else if (outgoingMessage->sendCompleteCallback != NULL)
+    {
+        (outgoingMessage->sendCompleteCallback)(outgoingMessage->userContext, messagingResult);
+    }
+    free(outgoingMessage);
+}
+
 static void IoTHubMessaging_LL_SendMessageComplete(void* context, MESSAGE_SEND_RESULT send_result, AMQP_VALUE delivery_state)
 {
     (void)delivery_state;
@@ -653,25 +712,157 @@ static void IoTHubMessaging_LL_SendMessageComplete(void* context, MESSAGE_SEND_R
     if (context != NULL)
     {
         /*Codes_SRS_IOTHUBMESSAGING_12_055: [ If context is not NULL and IoTHubMessaging_LL_SendMessageComplete shall call user callback with user context and messaging result ] */
-        IOTHUB_MESSAGING* messagingData = (IOTHUB_MESSAGING*)context;
-        if (messagingData->callback_data->sendCompleteCallback != NULL)
+        /*Codes_SRS_IOTHUBMESSAGING_09_009: [ IoTHubMessaging_LL_SendMessageComplete shall call the callback given to the send call of that message, and free the room the message took in the window ] */
+        OUTGOING_MESSAGE* outgoingMessage = (OUTGOING_MESSAGE*)context;
+        IOTHUB_MESSAGING_RESULT msg_result;
+
+        if (outgoingMessage->messaging->messagesInFlight > 0)
         {
-            // Convert a send result to an
-            IOTHUB_MESSAGING_RESULT msg_result;
-            switch (send_result)
-            {
-                case MESSAGE_SEND_OK:
-                    msg_result = IOTHUB_MESSAGING_OK;
-                    break;
-                case MESSAGE_SEND_ERROR:
-                case MESSAGE_SEND_TIMEOUT:
-                case MESSAGE_SEND_CANCELLED:
-                default:
-                    msg_result = IOTHUB_MESSAGING_ERROR;
-                    break;
-            }
-            (messagingData->callback_data->sendCompleteCallback)(messagingData->callback_data->sendUserContext, msg_result);
+            outgoingMessage->messaging->messagesInFlight--;
         }
+
+        // Convert a send result to an
+        switch (send_result)
+        {
+            case MESSAGE_SEND_OK:
+                msg_result = IOTHUB_MESSAGING_OK;
+                break;
+            case MESSAGE_SEND_ERROR:
+            case MESSAGE_SEND_TIMEOUT:
+            case MESSAGE_SEND_CANCELLED:
+            default:
+                msg_result = IOTHUB_MESSAGING_ERROR;
+                break;
+        }
+        completeOutgoingMessage(outgoingMessage, msg_result);
+    }
+}
+
+static bool isSendWindowFull(IOTHUB_MESSAGING* messagingData)
+{
+    // Messages already waiting go first, so that they reach the device in the order they were sent
+    return (messagingData->queueHead != NULL) ||
+        (messagingData->maxMessagesInFlight != 0 && messagingData->messagesInFlight >= messagingData->maxMessagesInFlight);
+}
+
+static void enqueueOutgoingMessage(IOTHUB_MESSAGING* messagingData, OUTGOING_MESSAGE* outgoingMessage)
+{
+    outgoingMessage->next = NULL;
+    if (messagingData->queueTail == NULL)
+    {
+        messagingData->queueHead = outgoingMessage;
+    }
+    else
+    {
+        messagingData->queueTail->next = outgoingMessage;
+    }
+    messagingData->queueTail = outgoingMessage;
+    messagingData->messagesQueued++;
+}
+
+static OUTGOING_MESSAGE* dequeueOutgoingMessage(IOTHUB_MESSAGING* messagingData)
+{
+    OUTGOING_MESSAGE* result = messagingData->queueHead;
+
+    if (result != NULL)
+    {
+        messagingData->queueHead = result->next;
+        if (messagingData->queueHead == NULL)
+        {
+            messagingData->queueTail = NULL;
+        }
+        messagingData->messagesQueued--;
+        result->next = NULL;
+    }
+    return result;
+}
+
+static void releaseSharedMessage(SHARED_MESSAGE* sharedMessage)
+{
+    if (--sharedMessage->refCount == 0)
+    {
+        properties_destroy(sharedMessage->properties);
+        message_destroy(sharedMessage->message);
+        free(sharedMessage);
+    }
+}
+
+static int dispatchOutgoingMessage(IOTHUB_MESSAGING* messagingData, SHARED_MESSAGE* sharedMessage, const char* deviceId, OUTGOING_MESSAGE* outgoingMessage)
+{
+    int result;
+    // There is no support for module sending message for callers, but most of plumbing is available should this be enabled via a new API.
+    const char* moduleId = NULL;
+
+    if (formatDeviceDestination(sharedMessage->deviceDestination, sharedMessage->deviceDestinationSize, deviceId, moduleId) != 0)
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+        LogError("Could not create the destination of the message.");
+        result = MU_FAILURE;
+    }
+    /*Codes_SRS_IOTHUBMESSAGING_09_001: [ The message shall be encoded once per send call, and only its TO property shall be set again for each device, right before the message is handed to messagesender_send_async ] */
+    else if (setAMQPMessageDestination(sharedMessage->message, sharedMessage->properties, sharedMessage->deviceDestination) != 0)
+    {
+        LogError("Failed setting the destination of the uAMQP message.");
+        result = MU_FAILURE;
+    }
+    /*Codes_SRS_IOTHUBMESSAGING_12_039: [ IoTHubMessaging_LL_SendMessage shall call uAMQP messagesender_send with the created message with IoTHubMessaging_LL_SendMessageComplete callback by which IoTHubMessaging is notified of completition of send ] */
+    /*Codes_SRS_IOTHUBMESSAGING_09_002: [ Each message shall be handed to messagesender_send_async with its own context, holding the callback and the user context of its send call ] */
+    else if (messagesender_send_async(messagingData->message_sender, sharedMessage->message, IoTHubMessaging_LL_SendMessageComplete, outgoingMessage, 0) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+        LogError("Could not send the message.");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        // The message sender keeps its own copy of the message, so the same one is reused for the next device
+        messagingData->messagesInFlight++;
+        result = 0;
+    }
+    return result;
+}
+
+static void sendQueuedMessages(IOTHUB_MESSAGING* messagingData)
+{
+    while (messagingData->queueHead != NULL &&
+        (messagingData->maxMessagesInFlight == 0 || messagingData->messagesInFlight < messagingData->maxMessagesInFlight))
+    {
+        OUTGOING_MESSAGE* outgoingMessage = dequeueOutgoingMessage(messagingData);
+        SHARED_MESSAGE* sharedMessage = outgoingMessage->sharedMessage;
+        char* deviceId = outgoingMessage->deviceId;
+
+        outgoingMessage->sharedMessage = NULL;
+        outgoingMessage->deviceId = NULL;
+        if (dispatchOutgoingMessage(messagingData, sharedMessage, deviceId, outgoingMessage) != 0)
+        {
+            LogError("Could not send a queued message.");
+            completeOutgoingMessage(outgoingMessage, IOTHUB_MESSAGING_ERROR);
+        }
+        free(deviceId);
+        releaseSharedMessage(sharedMessage);
+    }
+}
+
+static void abandonQueuedMessages(IOTHUB_MESSAGING* messagingData)
+{
+    OUTGOING_MESSAGE* outgoingMessage;
+
+    while ((outgoingMessage = dequeueOutgoingMessage(messagingData)) != NULL)
+    {
+        free(outgoingMessage->deviceId);
+        releaseSharedMessage(outgoingMessage->sharedMessage);
+        completeOutgoingMessage(outgoingMessage, IOTHUB_MESSAGING_ERROR);
+    }
+}
+
+static void reportSendQueue(IOTHUB_MESSAGING* messagingData)
+{
+    if (messagingData->callback_data->sendQueueCallback != NULL &&
+        (messagingData->messagesInFlight != messagingData->reportedMessagesInFlight || messagingData->messagesQueued != messagingData->reportedMessagesQueued))
+    {
+        messagingData->reportedMessagesInFlight = messagingData->messagesInFlight;
+        messagingData->reportedMessagesQueued = messagingData->messagesQueued;
+        (messagingData->callback_data->sendQueueCallback)(messagingData->callback_data->sendQueueUserContext, messagingData->messagesInFlight, messagingData->messagesQueued);
     }
 }
 
@@ -971,11 +1162,11 @@ IOTHUB_MESSAGING_HANDLE IoTHubMessaging_LL_Create(IOTHUB_SERVICE_CLIENT_AUTH_HAN
             {
                 /*Codes_SRS_IOTHUBMESSAGING_12_076: [ If create successfull IoTHubMessaging_LL_Create shall save the callback data return the valid messaging handle ] */
                 callback_data->openCompleteCompleteCallback = NULL;
-                callback_data->sendCompleteCallback = NULL;
                 callback_data->feedbackMessageCallback = NULL;
+                callback_data->sendQueueCallback = NULL;
                 callback_data->openUserContext = NULL;
-                callback_data->sendUserContext = NULL;
                 callback_data->feedbackUserContext = NULL;
+                callback_data->sendQueueUserContext = NULL;
 
                 result->callback_data = callback_data;
             }
@@ -992,6 +1183,9 @@ void IoTHubMessaging_LL_Destroy(IOTHUB_MESSAGING_HANDLE messagingHandle)
         /*Codes_SRS_IOTHUBMESSAGING_12_006: [ If the messagingHandle input parameter is not NULL IoTHubMessaging_LL_Destroy shall free all resources (memory) allocated by IoTHubMessaging_LL_Create ] */
         IOTHUB_MESSAGING* messHandle = (IOTHUB_MESSAGING*)messagingHandle;
 
+        /*Codes_SRS_IOTHUBMESSAGING_09_016: [ IoTHubMessaging_LL_Close and IoTHubMessaging_LL_Destroy shall call the callback of every message still waiting for room in the window with IOTHUB_MESSAGING_ERROR and free it ] */
+        abandonQueuedMessages(messHandle);
+
         free(messHandle->callback_data);
         free(messHandle->hostname);
         free(messHandle->iothubName);
@@ -1428,6 +1622,10 @@ void IoTHubMessaging_LL_Close(IOTHUB_MESSAGING_HANDLE messagingHandle)
         {
             free((char*)messagingHandle->sasl_plain_config.authzid);
         }
+
+        /*Codes_SRS_IOTHUBMESSAGING_09_016: [ IoTHubMessaging_LL_Close and IoTHubMessaging_LL_Destroy shall call the callback of every message still waiting for room in the window with IOTHUB_MESSAGING_ERROR and free it ] */
+        abandonQueuedMessages(messagingHandle);
+        messagingHandle->messagesInFlight = 0;
         messagingHandle->isOpened = false;
     }
 }
@@ -1454,14 +1652,151 @@ IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetFeedbackMessageCallback(IOTHUB_MES
 }
 
 
-IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_Send(IOTHUB_MESSAGING_HANDLE messagingHandle, const char* deviceId, IOTHUB_MESSAGE_HANDLE message, IOTHUB_SEND_COMPLETE_CALLBACK sendCompleteCallback, void* userContextCallback)
+static int createAMQPMessage(IOTHUB_MESSAGE_HANDLE message, MESSAGE_HANDLE* amqpMessage, PROPERTIES_HANDLE* amqpMessageProperties)
+{
+    int result;
+    unsigned const char* messageContent;
+    size_t messageContentSize;
+
+    if (getMessageContentAndSize(message, &messageContent, &messageContentSize) != 0)
+    {
+        LogError("Failed getting the message content and message size from IOTHUB_MESSAGE_HANDLE instance.");
+        result = MU_FAILURE;
+    }
+    /*Codes_SRS_IOTHUBMESSAGING_12_036: [ IoTHubMessaging_LL_SendMessage shall create a uAMQP message by calling message_create ] */
+    else if ((*amqpMessage = message_create()) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+        LogError("Could not create a message.");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        BINARY_DATA binary_data;
+
+        binary_data.bytes = messageContent;
+        binary_data.length = messageContentSize;
+
+        /*Codes_SRS_IOTHUBMESSAGING_12_037: [ IoTHubMessaging_LL_SendMessage shall set the uAMQP message body to the given message content by calling message_add_body_amqp_data ] */
+        if (message_add_body_amqp_data(*amqpMessage, binary_data) != 0)
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+            LogError("Failed setting the body of the uAMQP message.");
+            result = MU_FAILURE;
+        }
+        else if (createAMQPMessageProperties(message, *amqpMessage, amqpMessageProperties) != 0)
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+            LogError("Failed setting properties of the uAMQP message.");
+            result = MU_FAILURE;
+        }
+        else if (addApplicationPropertiesToAMQPMessage(message, *amqpMessage) != 0)
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+            LogError("Failed setting application properties of the uAMQP message.");
+            properties_destroy(*amqpMessageProperties);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            result = 0;
+        }
+
+        if (result != 0)
+        {
+            message_destroy(*amqpMessage);
+        }
+    }
+    return result;
+}
+
+static SHARED_MESSAGE* createSharedMessage(IOTHUB_MESSAGE_HANDLE message, size_t deviceDestinationSize)
+{
+    SHARED_MESSAGE* result;
+
+    // The destination buffer lives in the same allocation, right after the structure
+    if ((result = (SHARED_MESSAGE*)malloc(sizeof(SHARED_MESSAGE) + deviceDestinationSize)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+        LogError("Could not allocate the message and its destination string.");
+    }
+    else if (createAMQPMessage(message, &result->message, &result->properties) != 0)
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+        LogError("Could not create a message.");
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        result->deviceDestination = (char*)(result + 1);
+        result->deviceDestinationSize = deviceDestinationSize;
+        result->refCount = 1;
+    }
+    return result;
+}
+
+static IOTHUB_MESSAGING_RESULT sendAMQPMessageToDevice(IOTHUB_MESSAGING* messagingData, SHARED_MESSAGE* sharedMessage, const char* deviceId, const OUTGOING_MESSAGE* callbackData)
 {
     IOTHUB_MESSAGING_RESULT result;
+    OUTGOING_MESSAGE* outgoingMessage;
 
-    // There is no support for module sending message for callers, but most of plumbing is available should this be enabled via a new API.
-    const char* moduleId = NULL;
+    if ((outgoingMessage = (OUTGOING_MESSAGE*)malloc(sizeof(OUTGOING_MESSAGE))) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+        LogError("Malloc failed for the outgoing message.");
+        result = IOTHUB_MESSAGING_ERROR;
+    }
+    else
+    {
+        *outgoingMessage = *callbackData;
+        outgoingMessage->messaging = messagingData;
+        outgoingMessage->sharedMessage = NULL;
+        outgoingMessage->deviceId = NULL;
+        outgoingMessage->next = NULL;
+
+        if (!isSendWindowFull(messagingData))
+        {
+            if (dispatchOutgoingMessage(messagingData, sharedMessage, deviceId, outgoingMessage) != 0)
+            {
+                free(outgoingMessage);
+                result = IOTHUB_MESSAGING_ERROR;
+            }
+            else
+            {
+                result = IOTHUB_MESSAGING_OK;
+            }
+        }
+        /*Codes_SRS_IOTHUBMESSAGING_09_019: [ If the window is full and maxMessagesQueued messages already wait for room in it, the message shall not be queued and the result for that device shall be IOTHUB_MESSAGING_QUEUE_FULL ] */
+        else if (messagingData->maxMessagesQueued != 0 && messagingData->messagesQueued >= messagingData->maxMessagesQueued)
+        {
+            LogError("The send queue is full, %lu messages wait for room in the window.", (unsigned long)messagingData->messagesQueued);
+            free(outgoingMessage);
+            result = IOTHUB_MESSAGING_QUEUE_FULL;
+        }
+        /*Codes_SRS_IOTHUBMESSAGING_09_003: [ If the window is full, or other messages already wait for room in it, only a copy of the device id and a reference to the message encoded by the send call shall be queued until IoTHubMessaging_LL_DoWork can hand it to AMQP ] */
+        else if (mallocAndStrcpy_s(&outgoingMessage->deviceId, deviceId) != 0)
+        {
+            /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+            LogError("Could not queue the message.");
+            free(outgoingMessage);
+            result = IOTHUB_MESSAGING_ERROR;
+        }
+        else
+        {
+            outgoingMessage->sharedMessage = sharedMessage;
+            sharedMessage->refCount++;
+            enqueueOutgoingMessage(messagingData, outgoingMessage);
+            result = IOTHUB_MESSAGING_OK;
+        }
+    }
+    return result;
+}
 
-    char* deviceDestinationString;
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_Send(IOTHUB_MESSAGING_HANDLE messagingHandle, const char* deviceId, IOTHUB_MESSAGE_HANDLE message, IOTHUB_SEND_COMPLETE_CALLBACK sendCompleteCallback, void* userContextCallback)
+{
+    IOTHUB_MESSAGING_RESULT result;
+    SHARED_MESSAGE* sharedMessage;
 
     /*Codes_SRS_IOTHUBMESSAGING_12_034: [ IoTHubMessaging_LL_SendMessage shall verify the messagingHandle, deviceId, message input parameters and if any of them are NULL then return NULL ] */
     if (messagingHandle == NULL)
@@ -1487,8 +1822,7 @@ IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_Send(IOTHUB_MESSAGING_HANDLE messagin
         LogError("Messaging is not opened - call IoTHubMessaging_LL_Open to open");
         result = IOTHUB_MESSAGING_ERROR;
     }
-    /*Codes_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_LL_SendMessage shall set the uAMQP message properties to the given message properties by calling message_set_properties ] */
-    else if ((deviceDestinationString = createDeviceDestinationString(deviceId, moduleId)) == NULL)
+    else if ((sharedMessage = createSharedMessage(message, getDeviceDestinationSize(deviceId, NULL))) == NULL)
     {
         /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
         LogError("Could not create a message.");
@@ -1496,91 +1830,174 @@ IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_Send(IOTHUB_MESSAGING_HANDLE messagin
     }
     else
     {
-        unsigned const char* messageContent;
-        size_t messageContentSize;
+        OUTGOING_MESSAGE callbackData;
+
+        memset(&callbackData, 0, sizeof(callbackData));
+        callbackData.sendCompleteCallback = sendCompleteCallback;
+        callbackData.userContext = userContextCallback;
 
-        if (getMessageContentAndSize(message, &messageContent, &messageContentSize) != 0)
+        /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+        /*Codes_SRS_IOTHUBMESSAGING_12_041: [ If all uAMQP call return 0 then IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_OK  ] */
+        if ((result = sendAMQPMessageToDevice(messagingHandle, sharedMessage, deviceId, &callbackData)) != IOTHUB_MESSAGING_OK)
         {
-            LogError("Failed getting the message content and message size from IOTHUB_MESSAGE_HANDLE instance.");
+            LogError("Could not send the message to device %s.", deviceId);
+        }
+
+        /*Codes_SRS_IOTHUBMESSAGING_09_015: [ The send functions and IoTHubMessaging_LL_DoWork shall call the send queue callback, if one is set, with the number of messages in flight and the number of queued messages whenever either changed since the last call ] */
+        reportSendQueue(messagingHandle);
+
+        releaseSharedMessage(sharedMessage);
+    }
+    return result;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SendMany(IOTHUB_MESSAGING_HANDLE messagingHandle, const char* const* deviceIds, size_t deviceCount, IOTHUB_MESSAGE_HANDLE message, IOTHUB_SEND_MANY_COMPLETE_CALLBACK sendCompleteCallback, void* userContextCallback)
+{
+    IOTHUB_MESSAGING_RESULT result;
+    size_t deviceDestinationSize = 0;
+    size_t i;
+
+    /*Codes_SRS_IOTHUBMESSAGING_09_004: [ If messagingHandle, deviceIds or message is NULL, or deviceCount is 0, IoTHubMessaging_LL_SendMany shall return IOTHUB_MESSAGING_INVALID_ARG ] */
+    if (messagingHandle == NULL || deviceIds == NULL || deviceCount == 0 || message == NULL)
+    {
+        LogError("Invalid argument messagingHandle: %p deviceIds: %p deviceCount: %lu message: %p", messagingHandle, deviceIds, (unsigned long)deviceCount, message);
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    else
+    {
+        for (i = 0; i < deviceCount; i++)
+        {
+            size_t size;
+
+            if (deviceIds[i] == NULL)
+            {
+                break;
+            }
+            else if ((size = getDeviceDestinationSize(deviceIds[i], NULL)) > deviceDestinationSize)
+            {
+                deviceDestinationSize = size;
+            }
+        }
+
+        /*Codes_SRS_IOTHUBMESSAGING_09_005: [ If any of the device ids is NULL, IoTHubMessaging_LL_SendMany shall return IOTHUB_MESSAGING_INVALID_ARG without sending the message to any device ] */
+        if (i < deviceCount)
+        {
+            LogError("Invalid argument deviceIds[%lu] cannot be NULL", (unsigned long)i);
+            result = IOTHUB_MESSAGING_INVALID_ARG;
+        }
+        /*Codes_SRS_IOTHUBMESSAGING_09_006: [ If messaging is not opened, IoTHubMessaging_LL_SendMany shall return IOTHUB_MESSAGING_ERROR ] */
+        else if (messagingHandle->isOpened == 0)
+        {
+            LogError("Messaging is not opened - call IoTHubMessaging_LL_Open to open");
             result = IOTHUB_MESSAGING_ERROR;
         }
         else
         {
-            MESSAGE_HANDLE amqpMessage;
-            AMQP_VALUE to_amqp_value;
+            SHARED_MESSAGE* sharedMessage;
 
-            /*Codes_SRS_IOTHUBMESSAGING_12_036: [ IoTHubMessaging_LL_SendMessage shall create a uAMQP message by calling message_create ] */
-            if ((amqpMessage = message_create()) == NULL)
+            /*Codes_SRS_IOTHUBMESSAGING_09_007: [ IoTHubMessaging_LL_SendMany shall encode the message once, in one buffer for the destination of the longest device id, and send it to every device like IoTHubMessaging_LL_Send does ] */
+            if ((sharedMessage = createSharedMessage(message, deviceDestinationSize)) == NULL)
             {
-                /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
+                /*Codes_SRS_IOTHUBMESSAGING_09_008: [ If the message cannot be encoded, IoTHubMessaging_LL_SendMany shall return IOTHUB_MESSAGING_ERROR without calling the callback ] */
                 LogError("Could not create a message.");
                 result = IOTHUB_MESSAGING_ERROR;
             }
-            /*Codes_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_LL_SendMessage shall set the uAMQP message properties to the given message properties by calling message_set_properties ] */
-            else if ((to_amqp_value = amqpvalue_create_string(deviceDestinationString)) == NULL)
-            {
-                /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
-                LogError("Could not create properties for message - amqpvalue_create_string");
-                message_destroy(amqpMessage);
-                result = IOTHUB_MESSAGING_ERROR;
-            }
             else
             {
-                BINARY_DATA binary_data;
+                OUTGOING_MESSAGE callbackData;
 
-                binary_data.bytes = messageContent;
-                binary_data.length = messageContentSize;
+                memset(&callbackData, 0, sizeof(callbackData));
+                callbackData.sendManyCompleteCallback = sendCompleteCallback;
+                callbackData.userContext = userContextCallback;
 
-                /*Codes_SRS_IOTHUBMESSAGING_12_037: [ IoTHubMessaging_LL_SendMessage shall set the uAMQP message body to the given message content by calling message_add_body_amqp_data ] */
-                if (message_add_body_amqp_data(amqpMessage, binary_data) != 0)
-                {
-                    /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
-                    LogError("Failed setting the body of the uAMQP message.");
-                    result = IOTHUB_MESSAGING_ERROR;
-                }
-                /*Codes_SRS_IOTHUBMESSAGING_12_038: [ IoTHubMessaging_LL_SendMessage shall set the uAMQP message properties to the given message properties by calling message_set_properties ] */
-                else if (addPropertiesToAMQPMessage(message, amqpMessage, to_amqp_value) != 0)
+                for (i = 0; i < deviceCount; i++)
                 {
-                    /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
-                    message_destroy(amqpMessage);
-                    LogError("Failed setting properties of the uAMQP message.");
-                    result = IOTHUB_MESSAGING_ERROR;
-                }
-                else if (addApplicationPropertiesToAMQPMessage(message, amqpMessage) != 0)
-                {
-                    /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
-                    message_destroy(amqpMessage);
-                    LogError("Failed setting application properties of the uAMQP message.");
-                    result = IOTHUB_MESSAGING_ERROR;
-                }
-                else
-                {
-                    messagingHandle->callback_data->sendCompleteCallback = sendCompleteCallback;
-                    messagingHandle->callback_data->sendUserContext = userContextCallback;
+                    IOTHUB_MESSAGING_RESULT deviceResult;
 
-                    /*Codes_SRS_IOTHUBMESSAGING_12_039: [ IoTHubMessaging_LL_SendMessage shall call uAMQP messagesender_send with the created message with IoTHubMessaging_LL_SendMessageComplete callback by which IoTHubMessaging is notified of completition of send ] */
-                    if (messagesender_send_async(messagingHandle->message_sender, amqpMessage, IoTHubMessaging_LL_SendMessageComplete, messagingHandle, 0) == NULL)
-                    {
-                        /*Codes_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_ERROR ] */
-                        LogError("Could not set outgoing window.");
-                        message_destroy(amqpMessage);
-                        result = IOTHUB_MESSAGING_ERROR;
-                    }
-                    else
+                    callbackData.index = i;
+                    if ((deviceResult = sendAMQPMessageToDevice(messagingHandle, sharedMessage, deviceIds[i], &callbackData)) != IOTHUB_MESSAGING_OK)
                     {
-                        /*Codes_SRS_IOTHUBMESSAGING_12_041: [ If all uAMQP call return 0 then IoTHubMessaging_LL_SendMessage shall return IOTHUB_MESSAGING_OK  ] */
-                        result = IOTHUB_MESSAGING_OK;
+                        /*Codes_SRS_IOTHUBMESSAGING_09_010: [ If the message cannot be sent to a device, IoTHubMessaging_LL_SendMany shall call the callback for that device with IOTHUB_MESSAGING_ERROR, or IOTHUB_MESSAGING_QUEUE_FULL, and go on with the next device ] */
+                        LogError("Could not send the message to device %s.", deviceIds[i]);
+                        if (sendCompleteCallback != NULL)
+                        {
+                            sendCompleteCallback(userContextCallback, i, deviceResult);
+                        }
                     }
                 }
-                message_destroy(amqpMessage);
-                amqpvalue_destroy(to_amqp_value);
+
+                /*Codes_SRS_IOTHUBMESSAGING_09_015: [ The send functions and IoTHubMessaging_LL_DoWork shall call the send queue callback, if one is set, with the number of messages in flight and the number of queued messages whenever either changed since the last call ] */
+                reportSendQueue(messagingHandle);
+
+                releaseSharedMessage(sharedMessage);
+
+                /*Codes_SRS_IOTHUBMESSAGING_09_011: [ Otherwise IoTHubMessaging_LL_SendMany shall return IOTHUB_MESSAGING_OK ] */
+                result = IOTHUB_MESSAGING_OK;
             }
         }
-        free(deviceDestinationString);
     }
     return result;
 }
 
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetMaxMessagesInFlight(IOTHUB_MESSAGING_HANDLE messagingHandle, size_t maxMessagesInFlight)
+{
+    IOTHUB_MESSAGING_RESULT result;
+
+    /*Codes_SRS_IOTHUBMESSAGING_09_012: [ If messagingHandle is NULL, IoTHubMessaging_LL_SetMaxMessagesInFlight shall return IOTHUB_MESSAGING_INVALID_ARG ] */
+    if (messagingHandle == NULL)
+    {
+        LogError("Input parameter messagingHandle cannot be NULL");
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_09_013: [ IoTHubMessaging_LL_SetMaxMessagesInFlight shall save maxMessagesInFlight, where 0 removes the limit, and return IOTHUB_MESSAGING_OK ] */
+        messagingHandle->maxMessagesInFlight = maxMessagesInFlight;
+        result = IOTHUB_MESSAGING_OK;
+    }
+    return result;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetMaxMessagesQueued(IOTHUB_MESSAGING_HANDLE messagingHandle, size_t maxMessagesQueued)
+{
+    IOTHUB_MESSAGING_RESULT result;
+
+    /*Codes_SRS_IOTHUBMESSAGING_09_020: [ If messagingHandle is NULL, IoTHubMessaging_LL_SetMaxMessagesQueued shall return IOTHUB_MESSAGING_INVALID_ARG ] */
+    if (messagingHandle == NULL)
+    {
+        LogError("Input parameter messagingHandle cannot be NULL");
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_09_021: [ IoTHubMessaging_LL_SetMaxMessagesQueued shall save maxMessagesQueued, where 0 removes the limit, and return IOTHUB_MESSAGING_OK; messages already queued stay queued ] */
+        messagingHandle->maxMessagesQueued = maxMessagesQueued;
+        result = IOTHUB_MESSAGING_OK;
+    }
+    return result;
+}
+
+IOTHUB_MESSAGING_RESULT IoTHubMessaging_LL_SetSendQueueCallback(IOTHUB_MESSAGING_HANDLE messagingHandle, IOTHUB_SEND_QUEUE_CALLBACK sendQueueCallback, void* userContextCallback)
+{
+    IOTHUB_MESSAGING_RESULT result;
+
+    /*Codes_SRS_IOTHUBMESSAGING_09_017: [ If messagingHandle is NULL, IoTHubMessaging_LL_SetSendQueueCallback shall return IOTHUB_MESSAGING_INVALID_ARG ] */
+    if (messagingHandle == NULL)
+    {
+        LogError("Input parameter messagingHandle cannot be NULL");
+        result = IOTHUB_MESSAGING_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGING_09_018: [ IoTHubMessaging_LL_SetSendQueueCallback shall save the callback and its context and return IOTHUB_MESSAGING_OK ] */
+        messagingHandle->callback_data->sendQueueCallback = sendQueueCallback;
+        messagingHandle->callback_data->sendQueueUserContext = userContextCallback;
+        messagingHandle->reportedMessagesInFlight = 0;
+        messagingHandle->reportedMessagesQueued = 0;
+        result = IOTHUB_MESSAGING_OK;
+    }
+    return result;
+}
 
 void IoTHubMessaging_LL_DoWork(IOTHUB_MESSAGING_HANDLE messagingHandle)
 {
@@ -1591,6 +2008,12 @@ void IoTHubMessaging_LL_DoWork(IOTHUB_MESSAGING_HANDLE messagingHandle)
         /*Codes_SRS_IOTHUBMESSAGING_12_047: [ IoTHubMessaging_LL_SendMessageComplete callback given to messagesender_send will be called with MESSAGE_SEND_RESULT ] */
         /*Codes_SRS_IOTHUBMESSAGING_12_048: [ If message has been received the IoTHubMessaging_LL_FeedbackMessageReceived callback given to messagesender_receive will be called with the received MESSAGE_HANDLE ] */
         connection_dowork(messagingHandle->connection);
+
+        /*Codes_SRS_IOTHUBMESSAGING_09_014: [ After connection_dowork, IoTHubMessaging_LL_DoWork shall set the TO property of the queued messages and hand them to messagesender_send_async, oldest first, while there is room in the window, and call the callback of any that fails with IOTHUB_MESSAGING_ERROR ] */
+        sendQueuedMessages(messagingHandle);
+
+        /*Codes_SRS_IOTHUBMESSAGING_09_015: [ The send functions and IoTHubMessaging_LL_DoWork shall call the send queue callback, if one is set, with the number of messages in flight and the number of queued messages whenever either changed since the last call ] */
+        reportSendQueue(messagingHandle);
     }
 }
 
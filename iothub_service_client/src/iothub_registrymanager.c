@@ -16,6 +16,7 @@
 #include "parson.h"
 #include "iothub_registrymanager.h"
 #include "iothub_sc_version.h"
+#include "internal/iothub_sc_json_reader.h"
 
 #define IOTHUB_DEVICE_EX_VERSION_LATEST IOTHUB_DEVICE_EX_VERSION_1
 #define IOTHUB_REGISTRY_DEVICE_CREATE_EX_VERSION_LATEST IOTHUB_REGISTRY_DEVICE_CREATE_EX_VERSION_1
@@ -66,6 +67,17 @@ static const char* DEVICE_JSON_KEY_DEVICE_PRIMARY_THUMBPRINT = "authentication.x
 static const char* DEVICE_JSON_KEY_DEVICE_SECONDARY_THUMBPRINT = "authentication.x509Thumbprint.secondaryThumbprint";
 static const char* DEVICE_JSON_KEY_CAPABILITIES_IOTEDGE = "capabilities.iotEdge";
 
+static const char* DEVICE_JSON_KEY_AUTHENTICATION = "authentication";
+static const char* DEVICE_JSON_KEY_TYPE = "type";
+static const char* DEVICE_JSON_KEY_SYMMETRIC_KEY = "symmetricKey";
+static const char* DEVICE_JSON_KEY_X509_THUMBPRINT = "x509Thumbprint";
+static const char* DEVICE_JSON_KEY_PRIMARY_KEY = "primaryKey";
+static const char* DEVICE_JSON_KEY_SECONDARY_KEY = "secondaryKey";
+static const char* DEVICE_JSON_KEY_PRIMARY_THUMBPRINT = "primaryThumbprint";
+static const char* DEVICE_JSON_KEY_SECONDARY_THUMBPRINT = "secondaryThumbprint";
+static const char* DEVICE_JSON_KEY_CAPABILITIES = "capabilities";
+static const char* DEVICE_JSON_KEY_IOTEDGE = "iotEdge";
+
 static const char* DEVICE_JSON_KEY_DEVICE_GENERATION_ID = "generationId";
 static const char* DEVICE_JSON_KEY_DEVICE_ETAG = "etag";
 
@@ -890,14 +902,274 @@ static int addDeviceOrModuleToLinkedListAsModule(IOTHUB_DEVICE_OR_MODULE* iothub
     return result;
 }
 
+// Members of one device or module of a list response, pointing into the response until they are copied
+typedef struct DEVICE_OR_MODULE_JSON_VALUES_TAG
+{
+    SC_JSON_VALUE deviceId;
+    SC_JSON_VALUE moduleId;
+    SC_JSON_VALUE managedBy;
+    SC_JSON_VALUE authType;
+    SC_JSON_VALUE primaryKey;
+    SC_JSON_VALUE secondaryKey;
+    SC_JSON_VALUE primaryThumbprint;
+    SC_JSON_VALUE secondaryThumbprint;
+    SC_JSON_VALUE generationId;
+    SC_JSON_VALUE eTag;
+    SC_JSON_VALUE connectionState;
+    SC_JSON_VALUE connectionStateUpdatedTime;
+    SC_JSON_VALUE status;
+    SC_JSON_VALUE statusReason;
+    SC_JSON_VALUE statusUpdatedTime;
+    SC_JSON_VALUE lastActivityTime;
+    SC_JSON_VALUE cloudToDeviceMessageCount;
+    SC_JSON_VALUE isManaged;
+    SC_JSON_VALUE configuration;
+    SC_JSON_VALUE deviceProperties;
+    SC_JSON_VALUE serviceProperties;
+    SC_JSON_VALUE iotEdge;
+} DEVICE_OR_MODULE_JSON_VALUES;
+
+// The JSON objects a device or module is made of
+typedef enum
+{
+    DEVICE_JSON_OBJECT_DEVICE,
+    DEVICE_JSON_OBJECT_AUTHENTICATION,
+    DEVICE_JSON_OBJECT_SYMMETRIC_KEY,
+    DEVICE_JSON_OBJECT_X509_THUMBPRINT,
+    DEVICE_JSON_OBJECT_CAPABILITIES,
+    DEVICE_JSON_OBJECT_UNKNOWN
+} DEVICE_JSON_OBJECT;
+
+static DEVICE_JSON_OBJECT getDeviceJsonNestedObject(DEVICE_JSON_OBJECT parent, const SC_JSON_VALUE* name)
+{
+    DEVICE_JSON_OBJECT result = DEVICE_JSON_OBJECT_UNKNOWN;
+
+    if (parent == DEVICE_JSON_OBJECT_DEVICE)
+    {
+        if (sc_json_value_equals(name, DEVICE_JSON_KEY_AUTHENTICATION))
+        {
+            result = DEVICE_JSON_OBJECT_AUTHENTICATION;
+        }
+        else if (sc_json_value_equals(name, DEVICE_JSON_KEY_CAPABILITIES))
+        {
+            result = DEVICE_JSON_OBJECT_CAPABILITIES;
+        }
+    }
+    else if (parent == DEVICE_JSON_OBJECT_AUTHENTICATION)
+    {
+        if (sc_json_value_equals(name, DEVICE_JSON_KEY_SYMMETRIC_KEY))
+        {
+            result = DEVICE_JSON_OBJECT_SYMMETRIC_KEY;
+        }
+        else if (sc_json_value_equals(name, DEVICE_JSON_KEY_X509_THUMBPRINT))
+        {
+            result = DEVICE_JSON_OBJECT_X509_THUMBPRINT;
+        }
+    }
+
+    return result;
+}
+
+static SC_JSON_VALUE* getDeviceJsonMemberValue(DEVICE_OR_MODULE_JSON_VALUES* values, DEVICE_JSON_OBJECT object, const SC_JSON_VALUE* name)
+{
+    SC_JSON_VALUE* result = NULL;
+
+    switch (object)
+    {
+        case DEVICE_JSON_OBJECT_DEVICE:
+            if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_NAME)) result = &values->deviceId;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_MODULE_NAME)) result = &values->moduleId;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_MANAGED_BY)) result = &values->managedBy;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_GENERATION_ID)) result = &values->generationId;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_ETAG)) result = &values->eTag;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_CONNECTIONSTATE)) result = &values->connectionState;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_CONNECTIONSTATEUPDATEDTIME)) result = &values->connectionStateUpdatedTime;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_STATUS)) result = &values->status;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_STATUSREASON)) result = &values->statusReason;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_STATUSUPDATEDTIME)) result = &values->statusUpdatedTime;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_LASTACTIVITYTIME)) result = &values->lastActivityTime;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_CLOUDTODEVICEMESSAGECOUNT)) result = &values->cloudToDeviceMessageCount;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_ISMANAGED)) result = &values->isManaged;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_CONFIGURATION)) result = &values->configuration;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_DEVICEROPERTIES)) result = &values->deviceProperties;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_DEVICE_SERVICEPROPERTIES)) result = &values->serviceProperties;
+            break;
+
+        case DEVICE_JSON_OBJECT_AUTHENTICATION:
+            if (sc_json_value_equals(name, DEVICE_JSON_KEY_TYPE)) result = &values->authType;
+            break;
+
+        case DEVICE_JSON_OBJECT_SYMMETRIC_KEY:
+            if (sc_json_value_equals(name, DEVICE_JSON_KEY_PRIMARY_KEY)) result = &values->primaryKey;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_SECONDARY_KEY)) result = &values->secondaryKey;
+            break;
+
+        case DEVICE_JSON_OBJECT_X509_THUMBPRINT:
+            if (sc_json_value_equals(name, DEVICE_JSON_KEY_PRIMARY_THUMBPRINT)) result = &values->primaryThumbprint;
+            else if (sc_json_value_equals(name, DEVICE_JSON_KEY_SECONDARY_THUMBPRINT)) result = &values->secondaryThumbprint;
+            break;
+
+        case DEVICE_JSON_OBJECT_CAPABILITIES:
+            if (sc_json_value_equals(name, DEVICE_JSON_KEY_IOTEDGE)) result = &values->iotEdge;
+            break;
+
+        default:
+            break;
+    }
+
+    return result;
+}
+
+// Reads the members of an object whose '{' was just read, keeping the values of the members a device or module is made of
+static int readDeviceOrModuleJsonObject(SC_JSON_READER* reader, DEVICE_JSON_OBJECT object, DEVICE_OR_MODULE_JSON_VALUES* values)
+{
+    int result = 0;
+    SC_JSON_TOKEN token = SC_JSON_TOKEN_ERROR;
+
+    while (result == 0 && (token = sc_json_reader_next(reader)) == SC_JSON_TOKEN_NAME)
+    {
+        SC_JSON_VALUE name = *sc_json_reader_get_value(reader);
+        SC_JSON_VALUE* member_value = getDeviceJsonMemberValue(values, object, &name);
+        DEVICE_JSON_OBJECT nested_object = getDeviceJsonNestedObject(object, &name);
+
+        token = sc_json_reader_next(reader);
+        if (token == SC_JSON_TOKEN_BEGIN_OBJECT && nested_object != DEVICE_JSON_OBJECT_UNKNOWN)
+        {
+            result = readDeviceOrModuleJsonObject(reader, nested_object, values);
+        }
+        else if (member_value != NULL && (token == SC_JSON_TOKEN_STRING || token == SC_JSON_TOKEN_NUMBER))
+        {
+            *member_value = *sc_json_reader_get_value(reader);
+        }
+        else if (member_value != NULL && token == SC_JSON_TOKEN_TRUE)
+        {
+            member_value->text = DEVICE_JSON_DEFAULT_VALUE_TRUE;
+            member_value->length = strlen(DEVICE_JSON_DEFAULT_VALUE_TRUE);
+            member_value->is_escaped = false;
+        }
+        else
+        {
+            result = sc_json_reader_skip(reader, token);
+        }
+    }
+
+    if (result == 0 && token != SC_JSON_TOKEN_END_OBJECT)
+    {
+        LogError("Failed reading the members of a device or module");
+        result = MU_FAILURE;
+    }
+
+    return result;
+}
+
+static IOTHUB_REGISTRYMANAGER_RESULT copyDeviceOrModuleJsonValues(const DEVICE_OR_MODULE_JSON_VALUES* values, IOTHUB_DEVICE_OR_MODULE* deviceOrModuleInfo)
+{
+    IOTHUB_REGISTRYMANAGER_RESULT result = IOTHUB_REGISTRYMANAGER_OK;
+    const SC_JSON_VALUE* primaryKey = NULL;
+    const SC_JSON_VALUE* secondaryKey = NULL;
+
+    if (values->authType.text == NULL)
+    {
+        deviceOrModuleInfo->authMethod = IOTHUB_REGISTRYMANAGER_AUTH_UNKNOWN;
+    }
+    else if (sc_json_value_equals(&values->authType, DEVICE_JSON_KEY_DEVICE_AUTH_SAS))
+    {
+        primaryKey = &values->primaryKey;
+        secondaryKey = &values->secondaryKey;
+        deviceOrModuleInfo->authMethod = IOTHUB_REGISTRYMANAGER_AUTH_SPK;
+    }
+    else if (sc_json_value_equals(&values->authType, DEVICE_JSON_KEY_DEVICE_AUTH_SELF_SIGNED))
+    {
+        primaryKey = &values->primaryThumbprint;
+        secondaryKey = &values->secondaryThumbprint;
+        deviceOrModuleInfo->authMethod = IOTHUB_REGISTRYMANAGER_AUTH_X509_THUMBPRINT;
+    }
+    else if (sc_json_value_equals(&values->authType, DEVICE_JSON_KEY_DEVICE_AUTH_CERTIFICATE_AUTHORITY))
+    {
+        deviceOrModuleInfo->authMethod = IOTHUB_REGISTRYMANAGER_AUTH_X509_CERTIFICATE_AUTHORITY;
+    }
+    else if (sc_json_value_equals(&values->authType, DEVICE_JSON_KEY_DEVICE_AUTH_NONE))
+    {
+        deviceOrModuleInfo->authMethod = IOTHUB_REGISTRYMANAGER_AUTH_NONE;
+    }
+    else
+    {
+        deviceOrModuleInfo->authMethod = IOTHUB_REGISTRYMANAGER_AUTH_UNKNOWN;
+    }
+
+    {
+        const struct
+        {
+            const SC_JSON_VALUE* value;
+            const char** destination;
+            const char* name;
+        } copies[] =
+        {
+            { &values->deviceId, &deviceOrModuleInfo->deviceId, DEVICE_JSON_KEY_DEVICE_NAME },
+            { &values->moduleId, &deviceOrModuleInfo->moduleId, DEVICE_JSON_KEY_MODULE_NAME },
+            { primaryKey, &deviceOrModuleInfo->primaryKey, DEVICE_JSON_KEY_PRIMARY_KEY },
+            { secondaryKey, &deviceOrModuleInfo->secondaryKey, DEVICE_JSON_KEY_SECONDARY_KEY },
+            { &values->generationId, &deviceOrModuleInfo->generationId, DEVICE_JSON_KEY_DEVICE_GENERATION_ID },
+            { &values->eTag, &deviceOrModuleInfo->eTag, DEVICE_JSON_KEY_DEVICE_ETAG },
+            { &values->connectionStateUpdatedTime, &deviceOrModuleInfo->connectionStateUpdatedTime, DEVICE_JSON_KEY_DEVICE_CONNECTIONSTATEUPDATEDTIME },
+            { &values->statusReason, &deviceOrModuleInfo->statusReason, DEVICE_JSON_KEY_DEVICE_STATUSREASON },
+            { &values->statusUpdatedTime, &deviceOrModuleInfo->statusUpdatedTime, DEVICE_JSON_KEY_DEVICE_STATUSUPDATEDTIME },
+            { &values->lastActivityTime, &deviceOrModuleInfo->lastActivityTime, DEVICE_JSON_KEY_DEVICE_LASTACTIVITYTIME },
+            { &values->configuration, &deviceOrModuleInfo->configuration, DEVICE_JSON_KEY_DEVICE_CONFIGURATION },
+            { &values->deviceProperties, &deviceOrModuleInfo->deviceProperties, DEVICE_JSON_KEY_DEVICE_DEVICEROPERTIES },
+            { &values->serviceProperties, &deviceOrModuleInfo->serviceProperties, DEVICE_JSON_KEY_DEVICE_SERVICEPROPERTIES },
+            { &values->managedBy, &deviceOrModuleInfo->managedBy, DEVICE_JSON_KEY_MANAGED_BY }
+        };
+        size_t i;
+
+        for (i = 0; i < sizeof(copies) / sizeof(copies[0]); i++)
+        {
+            if ((copies[i].value != NULL) && (copies[i].value->text != NULL) && (sc_json_value_copy(copies[i].value, (char**)copies[i].destination) != 0))
+            {
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_072: [** If populating the deviceList parameter fails IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_ERROR **] */
+                LogError("sc_json_value_copy failed for %s", copies[i].name);
+                result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+                break;
+            }
+        }
+    }
+
+    if (result == IOTHUB_REGISTRYMANAGER_OK)
+    {
+        if ((values->connectionState.text != NULL) && sc_json_value_equals(&values->connectionState, DEVICE_JSON_DEFAULT_VALUE_CONNECTED))
+        {
+            deviceOrModuleInfo->connectionState = IOTHUB_DEVICE_CONNECTION_STATE_CONNECTED;
+        }
+        if ((values->status.text != NULL) && sc_json_value_equals(&values->status, DEVICE_JSON_DEFAULT_VALUE_ENABLED))
+        {
+            deviceOrModuleInfo->status = IOTHUB_DEVICE_STATUS_ENABLED;
+        }
+        if (values->cloudToDeviceMessageCount.text != NULL)
+        {
+            size_t count = 0;
+            size_t i;
+            for (i = 0; i < values->cloudToDeviceMessageCount.length && isdigit((unsigned char)values->cloudToDeviceMessageCount.text[i]); i++)
+            {
+                count = (count * 10) + (size_t)(values->cloudToDeviceMessageCount.text[i] - '0');
+            }
+            deviceOrModuleInfo->cloudToDeviceMessageCount = count;
+        }
+        if ((values->isManaged.text != NULL) && sc_json_value_equals(&values->isManaged, DEVICE_JSON_DEFAULT_VALUE_TRUE))
+        {
+            deviceOrModuleInfo->isManaged = true;
+        }
+        deviceOrModuleInfo->iotEdge_capable = (values->iotEdge.text != NULL) && sc_json_value_equals(&values->iotEdge, DEVICE_JSON_DEFAULT_VALUE_TRUE);
+    }
+
+    return result;
+}
+
 static IOTHUB_REGISTRYMANAGER_RESULT parseDeviceOrModuleListJson(BUFFER_HANDLE jsonBuffer, SINGLYLINKEDLIST_HANDLE deviceOrModuleList, IOTHUB_REGISTRYMANAGER_MODEL_TYPE struct_type, int struct_version)
 {
     IOTHUB_REGISTRYMANAGER_RESULT result;
 
     const char* bufferStr = NULL;
-    JSON_Value* root_value = NULL;
-    JSON_Array* device_or_module_array = NULL;
-    JSON_Status jsonStatus = JSONFailure;
+    SC_JSON_READER reader;
 
     if (jsonBuffer == NULL)
     {
@@ -917,93 +1189,73 @@ static IOTHUB_REGISTRYMANAGER_RESULT parseDeviceOrModuleListJson(BUFFER_HANDLE j
             LogError("BUFFER_u_char failed");
             result = IOTHUB_REGISTRYMANAGER_ERROR;
         }
-        else if ((root_value = json_parse_string(bufferStr)) == NULL)
+        else if (sc_json_reader_init(&reader, bufferStr, BUFFER_length(jsonBuffer)) != 0)
         {
-            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_070: [** If any of the parson API fails, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR **] */
-            LogError("json_parse_string failed");
-            result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
+            LogError("sc_json_reader_init failed");
+            result = IOTHUB_REGISTRYMANAGER_ERROR;
         }
-        else if ((device_or_module_array = json_value_get_array(root_value)) == NULL)
+        else if (sc_json_reader_next(&reader) != SC_JSON_TOKEN_BEGIN_ARRAY)
         {
-            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_070: [** If any of the parson API fails, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR **] */
-            LogError("json_value_get_object failed");
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If the response is not a JSON array of objects, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ] */
+            LogError("The response is not a JSON array");
             result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
         }
         else
         {
+            SC_JSON_TOKEN token = SC_JSON_TOKEN_ERROR;
+
             result = IOTHUB_REGISTRYMANAGER_OK;
 
-            size_t array_count = json_array_get_count(device_or_module_array);
-            for (size_t i = 0; i < array_count; i++)
+            // Each device or module is copied out of the response as soon as it is read, no JSON tree is built
+            while (result == IOTHUB_REGISTRYMANAGER_OK && (token = sc_json_reader_next(&reader)) == SC_JSON_TOKEN_BEGIN_OBJECT)
             {
-                JSON_Object* device_or_module_object = NULL;
+                DEVICE_OR_MODULE_JSON_VALUES values;
                 IOTHUB_DEVICE_OR_MODULE iothubDeviceOrModule;
 
-                if ((device_or_module_object = json_array_get_object(device_or_module_array, i)) == NULL)
+                memset(&values, 0, sizeof(values));
+                initializeDeviceOrModuleInfoMembers(&iothubDeviceOrModule);
+
+                if (readDeviceOrModuleJsonObject(&reader, DEVICE_JSON_OBJECT_DEVICE, &values) != 0)
                 {
-                    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_070: [** If any of the parson API fails, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR **] */
-                    LogError("json_array_get_object failed");
+                    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If the response is not a JSON array of objects, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ] */
+                    LogError("readDeviceOrModuleJsonObject failed");
                     result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
                 }
+                else if ((result = copyDeviceOrModuleJsonValues(&values, &iothubDeviceOrModule)) != IOTHUB_REGISTRYMANAGER_OK)
+                {
+                    free_deviceOrModule_members(&iothubDeviceOrModule);
+                }
                 else
                 {
-                    initializeDeviceOrModuleInfoMembers(&iothubDeviceOrModule);
-
-                    result = parseDeviceOrModuleJsonObject(device_or_module_object, &iothubDeviceOrModule);
-                    if (IOTHUB_REGISTRYMANAGER_OK != result)
-                    {
-                        free_deviceOrModule_members(&iothubDeviceOrModule);
-                    }
-                    else
+                    if (struct_type == IOTHUB_REGISTRYMANAGER_MODEL_TYPE_DEVICE)
                     {
-                        if (struct_type == IOTHUB_REGISTRYMANAGER_MODEL_TYPE_DEVICE)
+                        result = addDeviceOrModuleToLinkedListAsDevice(&iothubDeviceOrModule, deviceOrModuleList);
+                        if (result == IOTHUB_REGISTRYMANAGER_OK) //only free these if we pass, if we fail, will deal with below
                         {
-                            result = addDeviceOrModuleToLinkedListAsDevice(&iothubDeviceOrModule, deviceOrModuleList);
-                            if (result == IOTHUB_REGISTRYMANAGER_OK) //only free these if we pass, if we fail, will deal with below
-                            {
-                                free_nonDevice_members_from_deviceOrModule(&iothubDeviceOrModule);
-                            }
-                        }
-                        else //IOTHUB_REGISTRYMANAGER_MODEL_TYPE_MODULE
-                        {
-                            result = addDeviceOrModuleToLinkedListAsModule(&iothubDeviceOrModule, deviceOrModuleList, struct_version);
-                            //no nonModule members to free... yet
+                            free_nonDevice_members_from_deviceOrModule(&iothubDeviceOrModule);
                         }
+                    }
+                    else //IOTHUB_REGISTRYMANAGER_MODEL_TYPE_MODULE
+                    {
+                        result = addDeviceOrModuleToLinkedListAsModule(&iothubDeviceOrModule, deviceOrModuleList, struct_version);
+                        //no nonModule members to free... yet
+                    }
 
-                        if (result != IOTHUB_REGISTRYMANAGER_OK)
-                        {
-                            free_deviceOrModule_members(&iothubDeviceOrModule);
-                        }
+                    if (result != IOTHUB_REGISTRYMANAGER_OK)
+                    {
+                        free_deviceOrModule_members(&iothubDeviceOrModule);
                     }
                 }
+            }
 
-                if ((device_or_module_object != NULL) && ((jsonStatus = json_object_clear(device_or_module_object)) != JSONSuccess))
-                {
-                    /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_070: [** If any of the parson API fails, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR **] */
-                    LogError("json_object_clear failed");
-                    result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
-                }
-                if (result != IOTHUB_REGISTRYMANAGER_OK)
-                {
-                    break;
-                }
+            if (result == IOTHUB_REGISTRYMANAGER_OK && (token != SC_JSON_TOKEN_END_ARRAY || sc_json_reader_next(&reader) != SC_JSON_TOKEN_END))
+            {
+                /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If the response is not a JSON array of objects, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ] */
+                LogError("The response is not an array of devices or modules");
+                result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
             }
         }
     }
-    if (device_or_module_array != NULL)
-    {
-        if ((jsonStatus = json_array_clear(device_or_module_array)) != JSONSuccess)
-        {
-            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_070: [** If any of the parson API fails, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR **] */
-            LogError("json_array_clear failed");
-            result = IOTHUB_REGISTRYMANAGER_JSON_ERROR;
-        }
-    }
-
-    if (root_value != NULL)
-    {
-        json_value_free(root_value);
-    }
 
     if (result != IOTHUB_REGISTRYMANAGER_OK)
     {
@@ -2065,8 +2317,8 @@ IOTHUB_REGISTRYMANAGER_RESULT IoTHubRegistryManager_GetModuleOrDeviceList(IOTHUB
         }
         else if (result == IOTHUB_REGISTRYMANAGER_OK)
         {
-            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_069: [ IoTHubRegistryManager_GetDeviceList shall use the following parson APIs to parse the response JSON: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string  ] */
-            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If any of the parson API fails, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ] */
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_069: [ IoTHubRegistryManager_GetDeviceList shall read the response JSON in a single pass with the service client JSON reader (sc_json_reader_init, sc_json_reader_next, sc_json_reader_skip) and copy the members of each device out of the response without building a JSON tree ] */
+            /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If the response is not a JSON array of objects, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ] */
             /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_071: [ IoTHubRegistryManager_GetDeviceList shall populate the deviceList parameter with structures of type "IOTHUB_DEVICE" ] */
             /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_072: [ If populating the deviceList parameter fails IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_ERROR ] */
             /*Codes_SRS_IOTHUBREGISTRYMANAGER_12_073: [ If populating the deviceList parameter successful IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_OK ] */
@@ -0,0 +1,394 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/sastoken.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/lock.h"
+
+#include "internal/iothub_sc_http_pool.h"
+
+#define HTTP_HEADER_KEY_AUTHORIZATION   "Authorization"
+#define SHARED_ACCESS_SIGNATURE_PREFIX  "sas="
+
+// Same lifetime as the tokens HTTPAPIEX_SAS creates for every request; the pool renews its token a while before
+// it expires so that a request does not reach the hub with a token about to expire
+#define SAS_TOKEN_LIFETIME_SECS         3600
+#define SAS_TOKEN_RENEWAL_SECS          300
+
+typedef struct SC_HTTP_CONNECTION_TAG
+{
+    struct SC_HTTP_POOL_TAG* pool;
+    HTTPAPIEX_HANDLE httpApiExHandle;
+} SC_HTTP_CONNECTION;
+
+typedef struct SC_HTTP_POOL_TAG
+{
+    STRING_HANDLE hostname;
+    STRING_HANDLE keyName;
+    STRING_HANDLE sharedAccessKey;
+    STRING_HANDLE sasToken;
+    size_t sasTokenExpiry;
+    bool isSharedAccessSignature;
+    LOCK_HANDLE lock;
+    SC_HTTP_CONNECTION* connections;
+    size_t connectionCount;
+} SC_HTTP_POOL;
+
+typedef struct SC_HTTP_POOL_RUN_TAG
+{
+    SC_HTTP_POOL* pool;
+    size_t requestCount;
+    size_t nextIndex;
+    SC_HTTP_POOL_REQUEST_CALLBACK requestCallback;
+    void* context;
+} SC_HTTP_POOL_RUN;
+
+typedef struct SC_HTTP_POOL_WORKER_TAG
+{
+    SC_HTTP_POOL_RUN* run;
+    SC_HTTP_CONNECTION* connection;
+    THREAD_HANDLE threadHandle;
+} SC_HTTP_POOL_WORKER;
+
+static void free_pool(SC_HTTP_POOL* pool)
+{
+    size_t index;
+
+    if (pool->connections != NULL)
+    {
+        for (index = 0; index < pool->connectionCount; index++)
+        {
+            if (pool->connections[index].httpApiExHandle != NULL)
+            {
+                HTTPAPIEX_Destroy(pool->connections[index].httpApiExHandle);
+            }
+        }
+        free(pool->connections);
+    }
+    if (pool->lock != NULL)
+    {
+        (void)Lock_Deinit(pool->lock);
+    }
+    STRING_delete(pool->sasToken);
+    STRING_delete(pool->sharedAccessKey);
+    STRING_delete(pool->keyName);
+    STRING_delete(pool->hostname);
+    free(pool);
+}
+
+// Must be called with the lock of the pool held
+static const char* get_sas_token(SC_HTTP_POOL* pool)
+{
+    const char* result;
+
+    if (pool->isSharedAccessSignature)
+    {
+        /*Codes_SRS_SC_HTTP_POOL_09_019: [ If the shared access key starts with "sas=", sc_http_pool_execute shall use the rest of it as the SAS token. ]*/
+        result = STRING_c_str(pool->sharedAccessKey) + strlen(SHARED_ACCESS_SIGNATURE_PREFIX);
+    }
+    else
+    {
+        time_t currentTime = get_time(NULL);
+
+        if (currentTime == (time_t)-1)
+        {
+            LogError("get_time failed");
+            result = NULL;
+        }
+        /*Codes_SRS_SC_HTTP_POOL_09_018: [ sc_http_pool_execute shall reuse the SAS token of the pool, and only create a new one with SASToken_Create when there is none yet or the current one expires within 5 minutes. ]*/
+        else if (pool->sasToken == NULL || (size_t)currentTime + SAS_TOKEN_RENEWAL_SECS >= pool->sasTokenExpiry)
+        {
+            size_t expiry = (size_t)currentTime + SAS_TOKEN_LIFETIME_SECS;
+            STRING_HANDLE sasToken;
+
+            if ((sasToken = SASToken_Create(pool->sharedAccessKey, pool->hostname, pool->keyName, expiry)) == NULL)
+            {
+                LogError("SASToken_Create failed");
+                result = NULL;
+            }
+            else
+            {
+                STRING_delete(pool->sasToken);
+                pool->sasToken = sasToken;
+                pool->sasTokenExpiry = expiry;
+                result = STRING_c_str(pool->sasToken);
+            }
+        }
+        else
+        {
+            result = STRING_c_str(pool->sasToken);
+        }
+    }
+
+    return result;
+}
+
+static void run_requests(SC_HTTP_POOL_RUN* run, SC_HTTP_CONNECTION* connection)
+{
+    while (1)
+    {
+        size_t index;
+
+        /*Codes_SRS_SC_HTTP_POOL_09_011: [ Every worker shall take the next index that has not been taken yet and call requestCallback with it and its own connection, until every index has been taken. ]*/
+        if (Lock(run->pool->lock) != LOCK_OK)
+        {
+            LogError("Lock failed, the worker stops");
+            break;
+        }
+        else
+        {
+            index = run->nextIndex;
+            if (index < run->requestCount)
+            {
+                run->nextIndex++;
+            }
+            (void)Unlock(run->pool->lock);
+
+            if (index >= run->requestCount)
+            {
+                break;
+            }
+            else
+            {
+                run->requestCallback(run->context, index, connection);
+            }
+        }
+    }
+}
+
+static int run_requests_thread(void* threadArgument)
+{
+    SC_HTTP_POOL_WORKER* worker = (SC_HTTP_POOL_WORKER*)threadArgument;
+
+    run_requests(worker->run, worker->connection);
+
+    ThreadAPI_Exit(0);
+    return 0;
+}
+
+SC_HTTP_POOL_HANDLE sc_http_pool_create(const char* hostname, const char* keyName, const char* sharedAccessKey, size_t maxConnections)
+{
+    SC_HTTP_POOL* result;
+
+    /*Codes_SRS_SC_HTTP_POOL_09_001: [ If hostname, keyName or sharedAccessKey is NULL, or maxConnections is 0, sc_http_pool_create shall fail and return NULL. ]*/
+    if (hostname == NULL || keyName == NULL || sharedAccessKey == NULL || maxConnections == 0)
+    {
+        LogError("Invalid parameter hostname: %p, keyName: %p, sharedAccessKey: %p, maxConnections: %lu", hostname, keyName, sharedAccessKey, (unsigned long)maxConnections);
+        result = NULL;
+    }
+    /*Codes_SRS_SC_HTTP_POOL_09_002: [ sc_http_pool_create shall allocate the pool and copy hostname, keyName and sharedAccessKey into it. ]*/
+    else if ((result = malloc(sizeof(SC_HTTP_POOL))) == NULL)
+    {
+        /*Codes_SRS_SC_HTTP_POOL_09_005: [ If any of the allocations fails, sc_http_pool_create shall free everything it created and return NULL. ]*/
+        LogError("Malloc failed for SC_HTTP_POOL");
+    }
+    else
+    {
+        memset(result, 0, sizeof(SC_HTTP_POOL));
+
+        if ((result->hostname = STRING_construct(hostname)) == NULL ||
+            (result->keyName = STRING_construct(keyName)) == NULL ||
+            (result->sharedAccessKey = STRING_construct(sharedAccessKey)) == NULL)
+        {
+            /*Codes_SRS_SC_HTTP_POOL_09_005: [ If any of the allocations fails, sc_http_pool_create shall free everything it created and return NULL. ]*/
+            LogError("STRING_construct failed");
+            free_pool(result);
+            result = NULL;
+        }
+        else if ((result->lock = Lock_Init()) == NULL)
+        {
+            /*Codes_SRS_SC_HTTP_POOL_09_005: [ If any of the allocations fails, sc_http_pool_create shall free everything it created and return NULL. ]*/
+            LogError("Lock_Init failed");
+            free_pool(result);
+            result = NULL;
+        }
+        else if ((result->connections = malloc(maxConnections * sizeof(SC_HTTP_CONNECTION))) == NULL)
+        {
+            /*Codes_SRS_SC_HTTP_POOL_09_005: [ If any of the allocations fails, sc_http_pool_create shall free everything it created and return NULL. ]*/
+            LogError("Malloc failed for %lu connections", (unsigned long)maxConnections);
+            free_pool(result);
+            result = NULL;
+        }
+        else
+        {
+            size_t index;
+
+            memset(result->connections, 0, maxConnections * sizeof(SC_HTTP_CONNECTION));
+            result->connectionCount = maxConnections;
+            result->isSharedAccessSignature = (strncmp(sharedAccessKey, SHARED_ACCESS_SIGNATURE_PREFIX, strlen(SHARED_ACCESS_SIGNATURE_PREFIX)) == 0);
+
+            /*Codes_SRS_SC_HTTP_POOL_09_003: [ sc_http_pool_create shall create maxConnections connections to hostname with HTTPAPIEX_Create, which connect on their first request only. ]*/
+            for (index = 0; index < maxConnections; index++)
+            {
+                result->connections[index].pool = result;
+                if ((result->connections[index].httpApiExHandle = HTTPAPIEX_Create(hostname)) == NULL)
+                {
+                    break;
+                }
+            }
+
+            if (index < maxConnections)
+            {
+                /*Codes_SRS_SC_HTTP_POOL_09_005: [ If any of the allocations fails, sc_http_pool_create shall free everything it created and return NULL. ]*/
+                LogError("HTTPAPIEX_Create failed");
+                free_pool(result);
+                result = NULL;
+            }
+            /*Codes_SRS_SC_HTTP_POOL_09_004: [ On success sc_http_pool_create shall return the pool. ]*/
+        }
+    }
+
+    return result;
+}
+
+void sc_http_pool_destroy(SC_HTTP_POOL_HANDLE pool)
+{
+    /*Codes_SRS_SC_HTTP_POOL_09_006: [ If pool is NULL, sc_http_pool_destroy shall do nothing. ]*/
+    if (pool != NULL)
+    {
+        /*Codes_SRS_SC_HTTP_POOL_09_007: [ sc_http_pool_destroy shall close every connection with HTTPAPIEX_Destroy and free the SAS token and the pool. ]*/
+        free_pool(pool);
+    }
+}
+
+int sc_http_pool_run(SC_HTTP_POOL_HANDLE pool, size_t requestCount, SC_HTTP_POOL_REQUEST_CALLBACK requestCallback, void* context)
+{
+    int result;
+
+    /*Codes_SRS_SC_HTTP_POOL_09_008: [ If pool or requestCallback is NULL, sc_http_pool_run shall fail and return a non-zero value. ]*/
+    if (pool == NULL || requestCallback == NULL)
+    {
+        LogError("Invalid parameter pool: %p, requestCallback: %p", pool, requestCallback);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        SC_HTTP_POOL_RUN run;
+        size_t workerCount = (requestCount < pool->connectionCount) ? requestCount : pool->connectionCount;
+
+        run.pool = pool;
+        run.requestCount = requestCount;
+        run.nextIndex = 0;
+        run.requestCallback = requestCallback;
+        run.context = context;
+
+        if (workerCount <= 1)
+        {
+            /*Codes_SRS_SC_HTTP_POOL_09_009: [ If at most one request is to run, sc_http_pool_run shall run it on the first connection from the calling thread and return 0. ]*/
+            run_requests(&run, &pool->connections[0]);
+            result = 0;
+        }
+        else
+        {
+            SC_HTTP_POOL_WORKER* workers;
+
+            if ((workers = malloc(workerCount * sizeof(SC_HTTP_POOL_WORKER))) == NULL)
+            {
+                /*Codes_SRS_SC_HTTP_POOL_09_013: [ If the workers cannot be allocated, or no worker thread can be started, sc_http_pool_run shall run every request on the first connection from the calling thread and return 0. ]*/
+                LogError("Malloc failed for %lu workers, running on the calling thread", (unsigned long)workerCount);
+                run_requests(&run, &pool->connections[0]);
+                result = 0;
+            }
+            else
+            {
+                size_t startedCount;
+                size_t index;
+
+                /*Codes_SRS_SC_HTTP_POOL_09_010: [ Otherwise sc_http_pool_run shall start one worker thread with ThreadAPI_Create for each connection, up to one per request. ]*/
+                for (startedCount = 0; startedCount < workerCount; startedCount++)
+                {
+                    workers[startedCount].run = &run;
+                    workers[startedCount].connection = &pool->connections[startedCount];
+                    if (ThreadAPI_Create(&workers[startedCount].threadHandle, run_requests_thread, &workers[startedCount]) != THREADAPI_OK)
+                    {
+                        /*Codes_SRS_SC_HTTP_POOL_09_014: [ If only some of the worker threads can be started, sc_http_pool_run shall run every request on the ones that could. ]*/
+                        LogError("ThreadAPI_Create failed, running with %lu connections", (unsigned long)startedCount);
+                        break;
+                    }
+                }
+
+                /*Codes_SRS_SC_HTTP_POOL_09_012: [ sc_http_pool_run shall wait for every worker thread with ThreadAPI_Join and return 0. ]*/
+                for (index = 0; index < startedCount; index++)
+                {
+                    int threadResult;
+
+                    if (ThreadAPI_Join(workers[index].threadHandle, &threadResult) != THREADAPI_OK)
+                    {
+                        LogError("ThreadAPI_Join failed");
+                    }
+                }
+
+                if (startedCount == 0)
+                {
+                    /*Codes_SRS_SC_HTTP_POOL_09_013: [ If the workers cannot be allocated, or no worker thread can be started, sc_http_pool_run shall run every request on the first connection from the calling thread and return 0. ]*/
+                    LogError("No worker thread could be started, running on the calling thread");
+                    run_requests(&run, &pool->connections[0]);
+                }
+
+                result = 0;
+                free(workers);
+            }
+        }
+    }
+
+    return result;
+}
+
+int sc_http_pool_execute(SC_HTTP_CONNECTION_HANDLE connection, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHeaders, BUFFER_HANDLE requestContent, unsigned int* statusCode, BUFFER_HANDLE responseContent)
+{
+    int result;
+
+    /*Codes_SRS_SC_HTTP_POOL_09_015: [ If connection, relativePath, requestHeaders or statusCode is NULL, sc_http_pool_execute shall fail and return a non-zero value. ]*/
+    if (connection == NULL || relativePath == NULL || requestHeaders == NULL || statusCode == NULL)
+    {
+        LogError("Invalid parameter connection: %p, relativePath: %p, requestHeaders: %p, statusCode: %p", connection, relativePath, requestHeaders, statusCode);
+        result = MU_FAILURE;
+    }
+    else if (Lock(connection->pool->lock) != LOCK_OK)
+    {
+        /*Codes_SRS_SC_HTTP_POOL_09_020: [ If the token cannot be created or set, sc_http_pool_execute shall fail and return a non-zero value. ]*/
+        LogError("Lock failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        const char* sasToken;
+        HTTP_HEADERS_RESULT headersResult = HTTP_HEADERS_ERROR;
+
+        /*Codes_SRS_SC_HTTP_POOL_09_016: [ sc_http_pool_execute shall set the Authorization header of requestHeaders to the SAS token of the pool with HTTPHeaders_ReplaceHeaderNameValuePair. ]*/
+        if ((sasToken = get_sas_token(connection->pool)) != NULL)
+        {
+            headersResult = HTTPHeaders_ReplaceHeaderNameValuePair(requestHeaders, HTTP_HEADER_KEY_AUTHORIZATION, sasToken);
+        }
+        (void)Unlock(connection->pool->lock);
+
+        if (sasToken == NULL || headersResult != HTTP_HEADERS_OK)
+        {
+            /*Codes_SRS_SC_HTTP_POOL_09_020: [ If the token cannot be created or set, sc_http_pool_execute shall fail and return a non-zero value. ]*/
+            LogError("Failed setting the SAS token");
+            result = MU_FAILURE;
+        }
+        /*Codes_SRS_SC_HTTP_POOL_09_017: [ sc_http_pool_execute shall execute the request with HTTPAPIEX_ExecuteRequest on the connection, which keeps the connection open for the next request. ]*/
+        else if (HTTPAPIEX_ExecuteRequest(connection->httpApiExHandle, requestType, relativePath, requestHeaders, requestContent, statusCode, NULL, responseContent) != HTTPAPIEX_OK)
+        {
+            /*Codes_SRS_SC_HTTP_POOL_09_021: [ If HTTPAPIEX_ExecuteRequest fails, sc_http_pool_execute shall fail and return a non-zero value. ]*/
+            LogError("HTTPAPIEX_ExecuteRequest failed");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            /*Codes_SRS_SC_HTTP_POOL_09_022: [ Otherwise sc_http_pool_execute shall return 0. ]*/
+            result = 0;
+        }
+    }
+
+    return result;
+}
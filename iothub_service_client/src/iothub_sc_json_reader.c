@@ -0,0 +1,635 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <string.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#include "internal/iothub_sc_json_reader.h"
+
+MU_DEFINE_ENUM_STRINGS(SC_JSON_TOKEN, SC_JSON_TOKEN_VALUES);
+
+// What the reader expects to find next
+#define READER_STATE_VALUE          0   // any value: the whole text, after a name or after a ',' in an array
+#define READER_STATE_FIRST_MEMBER   1   // right after '{': a name or '}'
+#define READER_STATE_FIRST_ELEMENT  2   // right after '[': a value or ']'
+#define READER_STATE_AFTER_VALUE    3   // ',' or the end of the current object or array, or the end of the text
+#define READER_STATE_END            4
+#define READER_STATE_ERROR          5
+
+static char peek_char(const SC_JSON_READER* reader)
+{
+    return (reader->position < reader->length) ? reader->json[reader->position] : '\0';
+}
+
+static void skip_whitespace(SC_JSON_READER* reader)
+{
+    char c = peek_char(reader);
+    while (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+    {
+        reader->position++;
+        c = peek_char(reader);
+    }
+}
+
+static bool is_digit(char c)
+{
+    return (c >= '0' && c <= '9');
+}
+
+static int hex_value(char c)
+{
+    int result;
+
+    if (c >= '0' && c <= '9')
+    {
+        result = c - '0';
+    }
+    else if (c >= 'a' && c <= 'f')
+    {
+        result = c - 'a' + 10;
+    }
+    else if (c >= 'A' && c <= 'F')
+    {
+        result = c - 'A' + 10;
+    }
+    else
+    {
+        result = -1;
+    }
+
+    return result;
+}
+
+static SC_JSON_TOKEN fail(SC_JSON_READER* reader, const char* reason)
+{
+    LogError("Invalid JSON at position %lu: %s", (unsigned long)reader->position, reason);
+    reader->state = READER_STATE_ERROR;
+    return SC_JSON_TOKEN_ERROR;
+}
+
+// Reads a string from its opening quote, leaving the value pointing between the quotes
+static int read_string(SC_JSON_READER* reader)
+{
+    int result = MU_FAILURE;
+    size_t start = reader->position + 1;
+    size_t position = start;
+    bool is_escaped = false;
+
+    while (position < reader->length)
+    {
+        unsigned char c = (unsigned char)reader->json[position];
+        if (c == '"')
+        {
+            reader->value.text = reader->json + start;
+            reader->value.length = position - start;
+            reader->value.is_escaped = is_escaped;
+            reader->position = position + 1;
+            result = 0;
+            break;
+        }
+        else if (c < 0x20)
+        {
+            break;
+        }
+        else if (c == '\\')
+        {
+            char escape = (position + 1 < reader->length) ? reader->json[position + 1] : '\0';
+            is_escaped = true;
+            if (escape == 'u')
+            {
+                if (position + 5 >= reader->length ||
+                    hex_value(reader->json[position + 2]) < 0 || hex_value(reader->json[position + 3]) < 0 ||
+                    hex_value(reader->json[position + 4]) < 0 || hex_value(reader->json[position + 5]) < 0)
+                {
+                    break;
+                }
+                position += 6;
+            }
+            else if (escape != '\0' && strchr("\"\\/bfnrt", escape) != NULL)
+            {
+                position += 2;
+            }
+            else
+            {
+                break;
+            }
+        }
+        else
+        {
+            position++;
+        }
+    }
+
+    if (result != 0)
+    {
+        reader->position = position;
+    }
+    return result;
+}
+
+static int read_number(SC_JSON_READER* reader)
+{
+    int result;
+    size_t start = reader->position;
+
+    if (peek_char(reader) == '-')
+    {
+        reader->position++;
+    }
+
+    if (peek_char(reader) == '0')
+    {
+        reader->position++;
+        result = 0;
+    }
+    else if (is_digit(peek_char(reader)))
+    {
+        while (is_digit(peek_char(reader)))
+        {
+            reader->position++;
+        }
+        result = 0;
+    }
+    else
+    {
+        result = MU_FAILURE;
+    }
+
+    if (result == 0 && peek_char(reader) == '.')
+    {
+        reader->position++;
+        if (!is_digit(peek_char(reader)))
+        {
+            result = MU_FAILURE;
+        }
+        while (is_digit(peek_char(reader)))
+        {
+            reader->position++;
+        }
+    }
+
+    if (result == 0 && (peek_char(reader) == 'e' || peek_char(reader) == 'E'))
+    {
+        reader->position++;
+        if (peek_char(reader) == '+' || peek_char(reader) == '-')
+        {
+            reader->position++;
+        }
+        if (!is_digit(peek_char(reader)))
+        {
+            result = MU_FAILURE;
+        }
+        while (is_digit(peek_char(reader)))
+        {
+            reader->position++;
+        }
+    }
+
+    if (result == 0)
+    {
+        reader->value.text = reader->json + start;
+        reader->value.length = reader->position - start;
+        reader->value.is_escaped = false;
+    }
+    return result;
+}
+
+static bool read_literal(SC_JSON_READER* reader, const char* literal)
+{
+    bool result;
+    size_t literal_length = strlen(literal);
+
+    if (reader->length - reader->position >= literal_length && memcmp(reader->json + reader->position, literal, literal_length) == 0)
+    {
+        reader->position += literal_length;
+        result = true;
+    }
+    else
+    {
+        result = false;
+    }
+    return result;
+}
+
+static SC_JSON_TOKEN begin_container(SC_JSON_READER* reader, char container)
+{
+    SC_JSON_TOKEN result;
+
+    if (reader->depth == SC_JSON_READER_MAX_DEPTH)
+    {
+        result = fail(reader, "nested too deep");
+    }
+    else
+    {
+        reader->containers[reader->depth++] = container;
+        reader->position++;
+        if (container == '{')
+        {
+            reader->state = READER_STATE_FIRST_MEMBER;
+            result = SC_JSON_TOKEN_BEGIN_OBJECT;
+        }
+        else
+        {
+            reader->state = READER_STATE_FIRST_ELEMENT;
+            result = SC_JSON_TOKEN_BEGIN_ARRAY;
+        }
+    }
+    return result;
+}
+
+static SC_JSON_TOKEN end_container(SC_JSON_READER* reader)
+{
+    reader->position++;
+    reader->state = READER_STATE_AFTER_VALUE;
+    return (reader->containers[--reader->depth] == '{') ? SC_JSON_TOKEN_END_OBJECT : SC_JSON_TOKEN_END_ARRAY;
+}
+
+static SC_JSON_TOKEN read_member_name(SC_JSON_READER* reader)
+{
+    SC_JSON_TOKEN result;
+
+    if (peek_char(reader) != '"' || read_string(reader) != 0)
+    {
+        result = fail(reader, "expected a member name");
+    }
+    else
+    {
+        skip_whitespace(reader);
+        if (peek_char(reader) != ':')
+        {
+            result = fail(reader, "expected ':'");
+        }
+        else
+        {
+            reader->position++;
+            reader->state = READER_STATE_VALUE;
+            result = SC_JSON_TOKEN_NAME;
+        }
+    }
+    return result;
+}
+
+static SC_JSON_TOKEN read_value(SC_JSON_READER* reader)
+{
+    SC_JSON_TOKEN result;
+    char c = peek_char(reader);
+
+    if (c == '{' || c == '[')
+    {
+        result = begin_container(reader, c);
+    }
+    else
+    {
+        if (c == '"')
+        {
+            result = (read_string(reader) == 0) ? SC_JSON_TOKEN_STRING : SC_JSON_TOKEN_ERROR;
+        }
+        else if (c == '-' || is_digit(c))
+        {
+            result = (read_number(reader) == 0) ? SC_JSON_TOKEN_NUMBER : SC_JSON_TOKEN_ERROR;
+        }
+        else if (read_literal(reader, "true"))
+        {
+            result = SC_JSON_TOKEN_TRUE;
+        }
+        else if (read_literal(reader, "false"))
+        {
+            result = SC_JSON_TOKEN_FALSE;
+        }
+        else if (read_literal(reader, "null"))
+        {
+            result = SC_JSON_TOKEN_NULL;
+        }
+        else
+        {
+            result = SC_JSON_TOKEN_ERROR;
+        }
+
+        if (result == SC_JSON_TOKEN_ERROR)
+        {
+            result = fail(reader, "expected a value");
+        }
+        else
+        {
+            reader->state = READER_STATE_AFTER_VALUE;
+        }
+    }
+    return result;
+}
+
+// Decodes the escaped character at value->text[*position] into UTF-8, returning the number of bytes written
+static size_t unescape_char(const SC_JSON_VALUE* value, size_t* position, unsigned char* utf8)
+{
+    size_t result;
+    const char* text = value->text + *position;
+
+    if (text[0] != '\\')
+    {
+        utf8[0] = (unsigned char)text[0];
+        *position += 1;
+        result = 1;
+    }
+    else if (text[1] != 'u')
+    {
+        switch (text[1])
+        {
+            case 'b': utf8[0] = '\b'; break;
+            case 'f': utf8[0] = '\f'; break;
+            case 'n': utf8[0] = '\n'; break;
+            case 'r': utf8[0] = '\r'; break;
+            case 't': utf8[0] = '\t'; break;
+            default: utf8[0] = (unsigned char)text[1]; break;
+        }
+        *position += 2;
+        result = 1;
+    }
+    else
+    {
+        unsigned long code_point = ((unsigned long)hex_value(text[2]) << 12) | ((unsigned long)hex_value(text[3]) << 8) |
+            ((unsigned long)hex_value(text[4]) << 4) | (unsigned long)hex_value(text[5]);
+        *position += 6;
+
+        // A high surrogate followed by a low surrogate encodes a single code point above U+FFFF
+        if (code_point >= 0xD800 && code_point <= 0xDBFF && *position + 6 <= value->length && text[6] == '\\' && text[7] == 'u')
+        {
+            unsigned long low = ((unsigned long)hex_value(text[8]) << 12) | ((unsigned long)hex_value(text[9]) << 8) |
+                ((unsigned long)hex_value(text[10]) << 4) | (unsigned long)hex_value(text[11]);
+            if (low >= 0xDC00 && low <= 0xDFFF)
+            {
+                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                *position += 6;
+            }
+        }
+
+        if (code_point < 0x80)
+        {
+            utf8[0] = (unsigned char)code_point;
+            result = 1;
+        }
+        else if (code_point < 0x800)
+        {
+            utf8[0] = (unsigned char)(0xC0 | (code_point >> 6));
+            utf8[1] = (unsigned char)(0x80 | (code_point & 0x3F));
+            result = 2;
+        }
+        else if (code_point < 0x10000)
+        {
+            utf8[0] = (unsigned char)(0xE0 | (code_point >> 12));
+            utf8[1] = (unsigned char)(0x80 | ((code_point >> 6) & 0x3F));
+            utf8[2] = (unsigned char)(0x80 | (code_point & 0x3F));
+            result = 3;
+        }
+        else
+        {
+            utf8[0] = (unsigned char)(0xF0 | (code_point >> 18));
+            utf8[1] = (unsigned char)(0x80 | ((code_point >> 12) & 0x3F));
+            utf8[2] = (unsigned char)(0x80 | ((code_point >> 6) & 0x3F));
+            utf8[3] = (unsigned char)(0x80 | (code_point & 0x3F));
+            result = 4;
+        }
+    }
+    return result;
+}
+
+int sc_json_reader_init(SC_JSON_READER* reader, const char* json, size_t length)
+{
+    int result;
+
+    if (reader == NULL || json == NULL)
+    {
+        LogError("Invalid parameter specified reader: %p, json: %p", reader, json);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        // A NULL terminator inside the buffer ends the text
+        const char* terminator = (const char*)memchr(json, '\0', length);
+
+        memset(reader, 0, sizeof(SC_JSON_READER));
+        reader->json = json;
+        reader->length = (terminator != NULL) ? (size_t)(terminator - json) : length;
+        reader->state = READER_STATE_VALUE;
+        result = 0;
+    }
+    return result;
+}
+
+SC_JSON_TOKEN sc_json_reader_next(SC_JSON_READER* reader)
+{
+    SC_JSON_TOKEN result;
+
+    if (reader == NULL)
+    {
+        LogError("Invalid parameter specified reader: NULL");
+        result = SC_JSON_TOKEN_ERROR;
+    }
+    else
+    {
+        char c;
+
+        reader->value.text = NULL;
+        reader->value.length = 0;
+        reader->value.is_escaped = false;
+
+        skip_whitespace(reader);
+        c = peek_char(reader);
+
+        switch (reader->state)
+        {
+            case READER_STATE_VALUE:
+                result = read_value(reader);
+                break;
+
+            case READER_STATE_FIRST_MEMBER:
+                result = (c == '}') ? end_container(reader) : read_member_name(reader);
+                break;
+
+            case READER_STATE_FIRST_ELEMENT:
+                result = (c == ']') ? end_container(reader) : read_value(reader);
+                break;
+
+            case READER_STATE_AFTER_VALUE:
+                if (reader->depth == 0)
+                {
+                    if (reader->position == reader->length)
+                    {
+                        reader->state = READER_STATE_END;
+                        result = SC_JSON_TOKEN_END;
+                    }
+                    else
+                    {
+                        result = fail(reader, "unexpected text after the end");
+                    }
+                }
+                else if (c == ',')
+                {
+                    reader->position++;
+                    skip_whitespace(reader);
+                    if (reader->containers[reader->depth - 1] == '{')
+                    {
+                        result = read_member_name(reader);
+                    }
+                    else
+                    {
+                        result = read_value(reader);
+                    }
+                }
+                else if ((c == '}' && reader->containers[reader->depth - 1] == '{') ||
+                    (c == ']' && reader->containers[reader->depth - 1] == '['))
+                {
+                    result = end_container(reader);
+                }
+                else
+                {
+                    result = fail(reader, "expected ',' or the end of the object or array");
+                }
+                break;
+
+            case READER_STATE_END:
+                result = SC_JSON_TOKEN_END;
+                break;
+
+            default:
+                result = SC_JSON_TOKEN_ERROR;
+                break;
+        }
+    }
+    return result;
+}
+
+const SC_JSON_VALUE* sc_json_reader_get_value(SC_JSON_READER* reader)
+{
+    const SC_JSON_VALUE* result;
+
+    if (reader == NULL)
+    {
+        LogError("Invalid parameter specified reader: NULL");
+        result = NULL;
+    }
+    else if (reader->value.text == NULL)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = &reader->value;
+    }
+    return result;
+}
+
+int sc_json_reader_skip(SC_JSON_READER* reader, SC_JSON_TOKEN token)
+{
+    int result;
+
+    if (reader == NULL)
+    {
+        LogError("Invalid parameter specified reader: NULL");
+        result = MU_FAILURE;
+    }
+    else if (token == SC_JSON_TOKEN_BEGIN_OBJECT || token == SC_JSON_TOKEN_BEGIN_ARRAY)
+    {
+        size_t depth = reader->depth - 1;
+
+        result = 0;
+        while (reader->depth > depth)
+        {
+            SC_JSON_TOKEN skipped = sc_json_reader_next(reader);
+            if (skipped == SC_JSON_TOKEN_ERROR || skipped == SC_JSON_TOKEN_END)
+            {
+                LogError("Failed skipping the value");
+                result = MU_FAILURE;
+                break;
+            }
+        }
+    }
+    else if (token == SC_JSON_TOKEN_ERROR || token == SC_JSON_TOKEN_END_OBJECT || token == SC_JSON_TOKEN_END_ARRAY ||
+        token == SC_JSON_TOKEN_NAME || token == SC_JSON_TOKEN_END)
+    {
+        LogError("Token %s does not start a value", MU_ENUM_TO_STRING(SC_JSON_TOKEN, token));
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+bool sc_json_value_equals(const SC_JSON_VALUE* value, const char* text)
+{
+    bool result;
+
+    if (value == NULL || text == NULL)
+    {
+        LogError("Invalid parameter specified value: %p, text: %p", value, text);
+        result = false;
+    }
+    else if (!value->is_escaped)
+    {
+        result = (strncmp(value->text, text, value->length) == 0 && text[value->length] == '\0');
+    }
+    else
+    {
+        size_t position = 0;
+        size_t compared = 0;
+
+        result = true;
+        while (result && position < value->length)
+        {
+            unsigned char utf8[4];
+            size_t utf8_length = unescape_char(value, &position, utf8);
+            if (utf8[0] == '\0')
+            {
+                /* Codes_SRS_SC_JSON_READER_09_024: [ A value holding an escaped NUL character (\u0000) cannot be equal to a NULL terminated string, sc_json_value_equals shall return false for it. ] */
+                result = false;
+            }
+            else if (strncmp(text + compared, (const char*)utf8, utf8_length) != 0)
+            {
+                result = false;
+            }
+            compared += utf8_length;
+        }
+        result = result && (text[compared] == '\0');
+    }
+    return result;
+}
+
+int sc_json_value_copy(const SC_JSON_VALUE* value, char** destination)
+{
+    int result;
+
+    if (value == NULL || destination == NULL)
+    {
+        LogError("Invalid parameter specified value: %p, destination: %p", value, destination);
+        result = MU_FAILURE;
+    }
+    // Unescaping never makes a value longer
+    else if ((*destination = (char*)malloc(value->length + 1)) == NULL)
+    {
+        LogError("Failed allocating a copy of the value");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (!value->is_escaped)
+        {
+            memcpy(*destination, value->text, value->length);
+            (*destination)[value->length] = '\0';
+        }
+        else
+        {
+            size_t position = 0;
+            size_t copied = 0;
+
+            while (position < value->length)
+            {
+                copied += unescape_char(value, &position, (unsigned char*)*destination + copied);
+            }
+            (*destination)[copied] = '\0';
+        }
+        result = 0;
+    }
+    return result;
+}
@@ -61,6 +61,8 @@ static int my_mallocAndStrcpy_s(char** destination, const char* source)
 #include "azure_c_shared_utility/httpapiex.h"
 #include "azure_c_shared_utility/httpapiexsas.h"
 #include "azure_c_shared_utility/uniqueid.h"
+#include "azure_c_shared_utility/lock.h"
+#include "internal/iothub_sc_http_pool.h"
 #include "parson.h"
 
 MOCKABLE_FUNCTION(, JSON_Value*, json_parse_string, const char *, string);
@@ -202,6 +204,8 @@ typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_TAG
     char* hostname;
     char* sharedAccessKey;
     char* keyName;
+    SC_HTTP_POOL_HANDLE httpPool;
+    size_t maxConnections;
 } IOTHUB_SERVICE_CLIENT_DEVICE_METHOD;
 
 static IOTHUB_SERVICE_CLIENT_AUTH TEST_IOTHUB_SERVICE_CLIENT_AUTH;
@@ -236,10 +240,72 @@ static const char* TEST_HTTP_HEADER_VAL_CONTENT_TYPE = "application/json; charse
 static const char* TEST_HTTP_HEADER_KEY_IFMATCH = "If-Match";
 static const char* TEST_HTTP_HEADER_VAL_IFMATCH = "*";
 
+static SC_HTTP_POOL_HANDLE TEST_SC_HTTP_POOL_HANDLE = (SC_HTTP_POOL_HANDLE)0x4646;
+static SC_HTTP_CONNECTION_HANDLE TEST_SC_HTTP_CONNECTION_HANDLE = (SC_HTTP_CONNECTION_HANDLE)0x4747;
+static LOCK_HANDLE TEST_LOCK_HANDLE = (LOCK_HANDLE)0x4848;
+
+static const char* TEST_DEVICE_IDS[] = { "TEST_DEVICE_ID_1", "TEST_DEVICE_ID_2", "TEST_DEVICE_ID_3" };
+#define TEST_DEVICE_COUNT (sizeof(TEST_DEVICE_IDS) / sizeof(TEST_DEVICE_IDS[0]))
+
+static unsigned int g_execute_status_code;
+static size_t g_invoke_many_callback_count;
+static IOTHUB_DEVICE_METHOD_RESULT g_invoke_many_results[TEST_DEVICE_COUNT];
+static const char* g_invoke_many_device_ids[TEST_DEVICE_COUNT];
+static int g_invoke_many_response_status[TEST_DEVICE_COUNT];
+
 static JSON_Value* TEST_JSON_VALUE = (JSON_Value*)0x5050;
 static JSON_Object* TEST_JSON_OBJECT = (JSON_Object*)0x5151;
 static JSON_Status TEST_JSON_STATUS = 0;
 
+static LOCK_HANDLE my_Lock_Init(void)
+{
+    return TEST_LOCK_HANDLE;
+}
+
+static SC_HTTP_POOL_HANDLE my_sc_http_pool_create(const char* hostname, const char* keyName, const char* sharedAccessKey, size_t maxConnections)
+{
+    (void)hostname;
+    (void)keyName;
+    (void)sharedAccessKey;
+    (void)maxConnections;
+    return TEST_SC_HTTP_POOL_HANDLE;
+}
+
+static int my_sc_http_pool_run(SC_HTTP_POOL_HANDLE pool, size_t requestCount, SC_HTTP_POOL_REQUEST_CALLBACK requestCallback, void* context)
+{
+    size_t index;
+
+    (void)pool;
+    for (index = 0; index < requestCount; index++)
+    {
+        requestCallback(context, index, TEST_SC_HTTP_CONNECTION_HANDLE);
+    }
+    return 0;
+}
+
+static int my_sc_http_pool_execute(SC_HTTP_CONNECTION_HANDLE connection, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHeaders, BUFFER_HANDLE requestContent, unsigned int* statusCode, BUFFER_HANDLE responseContent)
+{
+    (void)connection;
+    (void)requestType;
+    (void)relativePath;
+    (void)requestHeaders;
+    (void)requestContent;
+    (void)responseContent;
+    *statusCode = g_execute_status_code;
+    return 0;
+}
+
+static void test_invoke_many_callback(void* userContext, size_t index, const char* deviceId, IOTHUB_DEVICE_METHOD_RESULT result, int responseStatus, const unsigned char* responsePayload, size_t responsePayloadSize)
+{
+    (void)userContext;
+    (void)responsePayload;
+    (void)responsePayloadSize;
+    g_invoke_many_callback_count++;
+    g_invoke_many_results[index] = result;
+    g_invoke_many_device_ids[index] = deviceId;
+    g_invoke_many_response_status[index] = responseStatus;
+}
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -296,6 +362,11 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_SAS_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(JSON_Value_Type, int);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(SC_HTTP_POOL_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SC_HTTP_CONNECTION_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SC_HTTP_POOL_REQUEST_CALLBACK, void*);
 
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
@@ -370,6 +441,19 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
 
     REGISTER_GLOBAL_MOCK_HOOK(json_serialize_to_string, my_json_serialize_to_string);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_serialize_to_string, NULL);
+
+    REGISTER_GLOBAL_MOCK_HOOK(Lock_Init, my_Lock_Init);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Deinit, LOCK_OK);
+
+    REGISTER_GLOBAL_MOCK_HOOK(sc_http_pool_create, my_sc_http_pool_create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(sc_http_pool_create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(sc_http_pool_run, my_sc_http_pool_run);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(sc_http_pool_run, __LINE__);
+    REGISTER_GLOBAL_MOCK_HOOK(sc_http_pool_execute, my_sc_http_pool_execute);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(sc_http_pool_execute, __LINE__);
 }
 
 TEST_SUITE_CLEANUP(TestClassCleanup)
@@ -393,6 +477,14 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.keyName = TEST_SHAREDACCESSKEYNAME;
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.sharedAccessKey = TEST_SHAREDACCESSKEY;
 
+    TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD.httpPool = NULL;
+    TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD.maxConnections = SC_HTTP_POOL_DEFAULT_MAX_CONNECTIONS;
+
+    g_execute_status_code = httpStatusCodeOk;
+    g_invoke_many_callback_count = 0;
+    memset(g_invoke_many_results, 0, sizeof(g_invoke_many_results));
+    memset(g_invoke_many_device_ids, 0, sizeof(g_invoke_many_device_ids));
+    memset(g_invoke_many_response_status, 0, sizeof(g_invoke_many_response_status));
 }
 
 TEST_FUNCTION_CLEANUP(TestMethodCleanup)
@@ -1302,4 +1394,318 @@ TEST_FUNCTION(IoTHubDeviceMethod_InvokeModule_non_happy_path)
     IoTHubDeviceMethod_Invoke_non_happy_path_impl(true);
 }
 
+static void setup_IoTHubDeviceMethod_InvokeMany_device_mocks(void)
+{
+    EXPECTED_CALL(BUFFER_new());
+
+    EXPECTED_CALL(HTTPHeaders_Alloc());
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_HTTP_HEADER_VAL_AUTHORIZATION))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(UniqueId_Generate(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_REQUEST_ID, TEST_HTTP_HEADER_VAL_REQUEST_ID))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_USER_AGENT, IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_ACCEPT, TEST_HTTP_HEADER_VAL_ACCEPT))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sc_http_pool_execute(TEST_SC_HTTP_CONNECTION_HANDLE, HTTPAPI_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .SetReturn(TEST_UNSIGNED_CHAR_PTR);
+    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_from_byte_array(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG));
+    EXPECTED_CALL(json_value_get_object(TEST_JSON_VALUE));
+    EXPECTED_CALL(json_object_get_value(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    EXPECTED_CALL(json_object_get_value(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    EXPECTED_CALL(json_serialize_to_string(IGNORED_PTR_ARG));
+    EXPECTED_CALL(json_value_get_number(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_002: [ If serviceClientDeviceMethodHandle, methodName, methodPayload or invokeManyCallback is NULL, or deviceIds is NULL while deviceCount is not 0, IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeMany_return_INVALID_ARG_if_input_parameter_serviceClientDeviceMethodHandle_is_NULL)
+{
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeMany(NULL, TEST_DEVICE_IDS, TEST_DEVICE_COUNT, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_002: [ If serviceClientDeviceMethodHandle, methodName, methodPayload or invokeManyCallback is NULL, or deviceIds is NULL while deviceCount is not 0, IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeMany_return_INVALID_ARG_if_input_parameter_deviceIds_is_NULL)
+{
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, NULL, TEST_DEVICE_COUNT, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_002: [ If serviceClientDeviceMethodHandle, methodName, methodPayload or invokeManyCallback is NULL, or deviceIds is NULL while deviceCount is not 0, IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeMany_return_INVALID_ARG_if_input_parameter_methodName_is_NULL)
+{
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, TEST_DEVICE_IDS, TEST_DEVICE_COUNT, NULL, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_002: [ If serviceClientDeviceMethodHandle, methodName, methodPayload or invokeManyCallback is NULL, or deviceIds is NULL while deviceCount is not 0, IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeMany_return_INVALID_ARG_if_input_parameter_methodPayload_is_NULL)
+{
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, TEST_DEVICE_IDS, TEST_DEVICE_COUNT, TEST_METHOD_NAME, NULL, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_002: [ If serviceClientDeviceMethodHandle, methodName, methodPayload or invokeManyCallback is NULL, or deviceIds is NULL while deviceCount is not 0, IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeMany_return_INVALID_ARG_if_input_parameter_invokeManyCallback_is_NULL)
+{
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, TEST_DEVICE_IDS, TEST_DEVICE_COUNT, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, NULL, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_003: [ IoTHubDeviceMethod_InvokeMany shall create the request body from methodName, timeout and methodPayload once, and send it to every device. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_004: [ On its first call IoTHubDeviceMethod_InvokeMany shall create a pool of connections with sc_http_pool_create, which later calls reuse until IoTHubDeviceMethod_Destroy. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_005: [ IoTHubDeviceMethod_InvokeMany shall run one request per device with sc_http_pool_run, as many at a time as the pool has connections. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_006: [ IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_OK once the result of every device has been reported, whatever the results. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_007: [ IoTHubDeviceMethod_InvokeMany shall send the request of every device with sc_http_pool_execute, on the connection the pool runs it on, and parse the response as IoTHubDeviceMethod_Invoke does. ]*/
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_008: [ IoTHubDeviceMethod_InvokeMany shall report the result, status and payload of every device to invokeManyCallback, one call at a time, and free the payload once the callback returns. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeMany_happy_path)
+{
+    // arrange
+    size_t index;
+
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(sc_http_pool_create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, SC_HTTP_POOL_DEFAULT_MAX_CONNECTIONS));
+    STRICT_EXPECTED_CALL(sc_http_pool_run(TEST_SC_HTTP_POOL_HANDLE, TEST_DEVICE_COUNT, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    for (index = 0; index < TEST_DEVICE_COUNT; index++)
+    {
+        setup_IoTHubDeviceMethod_InvokeMany_device_mocks();
+    }
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, TEST_DEVICE_IDS, TEST_DEVICE_COUNT, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, TEST_DEVICE_COUNT, g_invoke_many_callback_count);
+    for (index = 0; index < TEST_DEVICE_COUNT; index++)
+    {
+        ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, g_invoke_many_results[index]);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_DEVICE_IDS[index], g_invoke_many_device_ids[index]);
+        ASSERT_ARE_EQUAL(int, 42, g_invoke_many_response_status[index]);
+    }
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_004: [ On its first call IoTHubDeviceMethod_InvokeMany shall create a pool of connections with sc_http_pool_create, which later calls reuse until IoTHubDeviceMethod_Destroy. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeMany_reuses_the_pool)
+{
+    // arrange
+    (void)IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, TEST_DEVICE_IDS, 0, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(sc_http_pool_run(TEST_SC_HTTP_POOL_HANDLE, 0, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, TEST_DEVICE_IDS, 0, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_invoke_many_callback_count);
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_009: [ If a device id is NULL, IoTHubDeviceMethod_InvokeMany shall report IOTHUB_DEVICE_METHOD_INVALID_ARG for it without sending anything. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeMany_reports_INVALID_ARG_for_a_NULL_device_id)
+{
+    // arrange
+    const char* deviceIds[] = { TEST_DEVICE_ID, NULL };
+
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, deviceIds, 2, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 2, g_invoke_many_callback_count);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, g_invoke_many_results[0]);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, g_invoke_many_results[1]);
+    ASSERT_IS_NULL(g_invoke_many_device_ids[1]);
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_006: [ IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_OK once the result of every device has been reported, whatever the results. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeMany_reports_ERROR_if_http_status_is_not_200)
+{
+    // arrange
+    g_execute_status_code = httpStatusCodeBadRequest;
+
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, TEST_DEVICE_IDS, TEST_DEVICE_COUNT, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, result);
+    ASSERT_ARE_EQUAL(size_t, TEST_DEVICE_COUNT, g_invoke_many_callback_count);
+    for (size_t index = 0; index < TEST_DEVICE_COUNT; index++)
+    {
+        ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_ERROR, g_invoke_many_results[index]);
+    }
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_010: [ If the request body, the lock or the pool cannot be created, or sc_http_pool_run fails, IoTHubDeviceMethod_InvokeMany shall return IOTHUB_DEVICE_METHOD_ERROR. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_InvokeMany_non_happy_path)
+{
+    // arrange
+    int umockc_result = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, umockc_result);
+
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(sc_http_pool_create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, SC_HTTP_POOL_DEFAULT_MAX_CONNECTIONS));
+    STRICT_EXPECTED_CALL(sc_http_pool_run(TEST_SC_HTTP_POOL_HANDLE, 0, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    umock_c_negative_tests_snapshot();
+
+    for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+    {
+        if (umock_c_negative_tests_can_call_fail(i))
+        {
+            umock_c_negative_tests_reset();
+            umock_c_negative_tests_fail_call(i);
+            TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD.httpPool = NULL;
+
+            // act
+            IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, TEST_DEVICE_IDS, 0, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+
+            // assert
+            ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_ERROR, result, "IoTHubDeviceMethod_InvokeMany failure in test %lu", (unsigned long)i);
+        }
+    }
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_011: [ If serviceClientDeviceMethodHandle is NULL or maxConnections is 0, IoTHubDeviceMethod_SetMaxConnections shall return IOTHUB_DEVICE_METHOD_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_SetMaxConnections_return_INVALID_ARG_if_input_parameter_serviceClientDeviceMethodHandle_is_NULL)
+{
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_SetMaxConnections(NULL, 8);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_011: [ If serviceClientDeviceMethodHandle is NULL or maxConnections is 0, IoTHubDeviceMethod_SetMaxConnections shall return IOTHUB_DEVICE_METHOD_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_SetMaxConnections_return_INVALID_ARG_if_input_parameter_maxConnections_is_0)
+{
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_SetMaxConnections(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, 0);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_012: [ IoTHubDeviceMethod_SetMaxConnections shall close the connections opened so far with sc_http_pool_destroy, so that the next IoTHubDeviceMethod_InvokeMany opens up to maxConnections, and return IOTHUB_DEVICE_METHOD_OK. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_SetMaxConnections_closes_the_pool)
+{
+    // arrange
+    (void)IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, TEST_DEVICE_IDS, 0, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(sc_http_pool_destroy(TEST_SC_HTTP_POOL_HANDLE));
+
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_SetMaxConnections(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, 8);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_012: [ IoTHubDeviceMethod_SetMaxConnections shall close the connections opened so far with sc_http_pool_destroy, so that the next IoTHubDeviceMethod_InvokeMany opens up to maxConnections, and return IOTHUB_DEVICE_METHOD_OK. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_SetMaxConnections_applies_to_the_next_pool)
+{
+    // arrange
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, IoTHubDeviceMethod_SetMaxConnections(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, 8));
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(sc_http_pool_create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, 8));
+    STRICT_EXPECTED_CALL(sc_http_pool_run(TEST_SC_HTTP_POOL_HANDLE, 0, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_DEVICE_METHOD_RESULT result = IoTHubDeviceMethod_InvokeMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE, TEST_DEVICE_IDS, 0, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_METHOD_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICEMETHOD_09_013: [ IoTHubDeviceMethod_Destroy shall close the connections opened by IoTHubDeviceMethod_InvokeMany by calling sc_http_pool_destroy. ]*/
+TEST_FUNCTION(IoTHubDeviceMethod_Destroy_closes_the_pool)
+{
+    // arrange
+    IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE handle = IoTHubDeviceMethod_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    (void)IoTHubDeviceMethod_InvokeMany(handle, TEST_DEVICE_IDS, 0, TEST_METHOD_NAME, TEST_METHOD_PAYLOAD, TEST_TIMEOUT, test_invoke_many_callback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(sc_http_pool_destroy(TEST_SC_HTTP_POOL_HANDLE));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    IoTHubDeviceMethod_Destroy(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(iothub_devicemethod_ut)
@@ -55,6 +55,8 @@ static int my_mallocAndStrcpy_s(char** destination, const char* source)
 #include "azure_c_shared_utility/httpapiex.h"
 #include "azure_c_shared_utility/httpapiexsas.h"
 #include "azure_c_shared_utility/uniqueid.h"
+#include "azure_c_shared_utility/lock.h"
+#include "internal/iothub_sc_http_pool.h"
 
 #undef ENABLE_MOCKS
 
@@ -149,6 +151,8 @@ typedef struct IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_TAG
     char* hostname;
     char* sharedAccessKey;
     char* keyName;
+    SC_HTTP_POOL_HANDLE httpPool;
+    size_t maxConnections;
 } IOTHUB_SERVICE_CLIENT_DEVICE_TWIN;
 
 static IOTHUB_SERVICE_CLIENT_AUTH TEST_IOTHUB_SERVICE_CLIENT_AUTH;
@@ -182,6 +186,67 @@ static const char* TEST_HTTP_HEADER_VAL_CONTENT_TYPE = "application/json; charse
 static const char* TEST_HTTP_HEADER_KEY_IFMATCH = "If-Match";
 static const char* TEST_HTTP_HEADER_VAL_IFMATCH = "*";
 
+static SC_HTTP_POOL_HANDLE TEST_SC_HTTP_POOL_HANDLE = (SC_HTTP_POOL_HANDLE)0x4646;
+static SC_HTTP_CONNECTION_HANDLE TEST_SC_HTTP_CONNECTION_HANDLE = (SC_HTTP_CONNECTION_HANDLE)0x4747;
+static LOCK_HANDLE TEST_LOCK_HANDLE = (LOCK_HANDLE)0x4848;
+
+static const char* TEST_DEVICE_IDS[] = { "TEST_DEVICE_ID_1", "TEST_DEVICE_ID_2", "TEST_DEVICE_ID_3" };
+#define TEST_DEVICE_COUNT (sizeof(TEST_DEVICE_IDS) / sizeof(TEST_DEVICE_IDS[0]))
+static const char* TEST_DEVICE_TWIN_JSON = "{\"tags\":{\"region\":\"west\"}}";
+
+static unsigned int g_execute_status_code;
+static size_t g_update_many_callback_count;
+static IOTHUB_DEVICE_TWIN_RESULT g_update_many_results[TEST_DEVICE_COUNT];
+static const char* g_update_many_device_ids[TEST_DEVICE_COUNT];
+static bool g_update_many_has_twin[TEST_DEVICE_COUNT];
+
+static LOCK_HANDLE my_Lock_Init(void)
+{
+    return TEST_LOCK_HANDLE;
+}
+
+static SC_HTTP_POOL_HANDLE my_sc_http_pool_create(const char* hostname, const char* keyName, const char* sharedAccessKey, size_t maxConnections)
+{
+    (void)hostname;
+    (void)keyName;
+    (void)sharedAccessKey;
+    (void)maxConnections;
+    return TEST_SC_HTTP_POOL_HANDLE;
+}
+
+static int my_sc_http_pool_run(SC_HTTP_POOL_HANDLE pool, size_t requestCount, SC_HTTP_POOL_REQUEST_CALLBACK requestCallback, void* context)
+{
+    size_t index;
+
+    (void)pool;
+    for (index = 0; index < requestCount; index++)
+    {
+        requestCallback(context, index, TEST_SC_HTTP_CONNECTION_HANDLE);
+    }
+    return 0;
+}
+
+static int my_sc_http_pool_execute(SC_HTTP_CONNECTION_HANDLE connection, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHeaders, BUFFER_HANDLE requestContent, unsigned int* statusCode, BUFFER_HANDLE responseContent)
+{
+    (void)connection;
+    (void)requestType;
+    (void)relativePath;
+    (void)requestHeaders;
+    (void)requestContent;
+    (void)responseContent;
+    *statusCode = g_execute_status_code;
+    return 0;
+}
+
+static void test_update_many_callback(void* userContext, size_t index, const char* deviceId, IOTHUB_DEVICE_TWIN_RESULT result, const char* updatedTwinJson)
+{
+    (void)userContext;
+    g_update_many_callback_count++;
+    g_update_many_results[index] = result;
+    g_update_many_device_ids[index] = deviceId;
+    g_update_many_has_twin[index] = (updatedTwinJson != NULL);
+}
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -237,6 +302,11 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_SAS_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(SC_HTTP_POOL_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SC_HTTP_CONNECTION_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SC_HTTP_POOL_REQUEST_CALLBACK, void*);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
@@ -281,6 +351,19 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
 
     REGISTER_GLOBAL_MOCK_RETURN(UniqueId_Generate, UNIQUEID_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(UniqueId_Generate, UNIQUEID_ERROR);
+
+    REGISTER_GLOBAL_MOCK_HOOK(Lock_Init, my_Lock_Init);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Deinit, LOCK_OK);
+
+    REGISTER_GLOBAL_MOCK_HOOK(sc_http_pool_create, my_sc_http_pool_create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(sc_http_pool_create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(sc_http_pool_run, my_sc_http_pool_run);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(sc_http_pool_run, __LINE__);
+    REGISTER_GLOBAL_MOCK_HOOK(sc_http_pool_execute, my_sc_http_pool_execute);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(sc_http_pool_execute, __LINE__);
 }
 
 TEST_SUITE_CLEANUP(TestClassCleanup)
@@ -304,6 +387,14 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.keyName = TEST_SHAREDACCESSKEYNAME;
     TEST_IOTHUB_SERVICE_CLIENT_AUTH.sharedAccessKey = TEST_SHAREDACCESSKEY;
 
+    TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN.httpPool = NULL;
+    TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN.maxConnections = SC_HTTP_POOL_DEFAULT_MAX_CONNECTIONS;
+
+    g_execute_status_code = httpStatusCodeOk;
+    g_update_many_callback_count = 0;
+    memset(g_update_many_results, 0, sizeof(g_update_many_results));
+    memset(g_update_many_device_ids, 0, sizeof(g_update_many_device_ids));
+    memset(g_update_many_has_twin, 0, sizeof(g_update_many_has_twin));
 }
 
 TEST_FUNCTION_CLEANUP(TestMethodCleanup)
@@ -1055,4 +1146,290 @@ TEST_FUNCTION(IoTHubDeviceTwin_UpdateModuleTwin_happy_path_status_code_200)
     free((void*)result);
 }
 
+static void set_expected_calls_for_UpdateMany_device()
+{
+    EXPECTED_CALL(BUFFER_new());
+
+    EXPECTED_CALL(HTTPHeaders_Alloc());
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_HTTP_HEADER_VAL_AUTHORIZATION))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(UniqueId_Generate(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_REQUEST_ID, TEST_HTTP_HEADER_VAL_REQUEST_ID))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_USER_AGENT, IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_ACCEPT, TEST_HTTP_HEADER_VAL_ACCEPT))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, TEST_HTTP_HEADER_KEY_IFMATCH, TEST_HTTP_HEADER_VAL_IFMATCH))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(sc_http_pool_execute(TEST_SC_HTTP_CONNECTION_HANDLE, HTTPAPI_REQUEST_PATCH, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+
+    EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .SetReturn(TEST_UNSIGNED_CHAR_PTR);
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+}
+
+static void set_expected_calls_for_UpdateMany(size_t maxConnections, bool createsPool)
+{
+    EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    if (createsPool)
+    {
+        STRICT_EXPECTED_CALL(sc_http_pool_create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, maxConnections));
+    }
+    STRICT_EXPECTED_CALL(sc_http_pool_run(TEST_SC_HTTP_POOL_HANDLE, 0, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_002: [ If serviceClientDeviceTwinHandle, deviceTwinJson or updateManyCallback is NULL, or deviceIds is NULL while deviceCount is not 0, IoTHubDeviceTwin_UpdateMany shall return IOTHUB_DEVICE_TWIN_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_UpdateMany_return_INVALID_ARG_if_input_parameter_serviceClientDeviceTwinHandle_is_NULL)
+{
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_UpdateMany(NULL, TEST_DEVICE_IDS, TEST_DEVICE_COUNT, TEST_DEVICE_TWIN_JSON, test_update_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_002: [ If serviceClientDeviceTwinHandle, deviceTwinJson or updateManyCallback is NULL, or deviceIds is NULL while deviceCount is not 0, IoTHubDeviceTwin_UpdateMany shall return IOTHUB_DEVICE_TWIN_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_UpdateMany_return_INVALID_ARG_if_input_parameter_deviceIds_is_NULL)
+{
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_UpdateMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, NULL, TEST_DEVICE_COUNT, TEST_DEVICE_TWIN_JSON, test_update_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_002: [ If serviceClientDeviceTwinHandle, deviceTwinJson or updateManyCallback is NULL, or deviceIds is NULL while deviceCount is not 0, IoTHubDeviceTwin_UpdateMany shall return IOTHUB_DEVICE_TWIN_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_UpdateMany_return_INVALID_ARG_if_input_parameter_deviceTwinJson_is_NULL)
+{
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_UpdateMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_DEVICE_IDS, TEST_DEVICE_COUNT, NULL, test_update_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_002: [ If serviceClientDeviceTwinHandle, deviceTwinJson or updateManyCallback is NULL, or deviceIds is NULL while deviceCount is not 0, IoTHubDeviceTwin_UpdateMany shall return IOTHUB_DEVICE_TWIN_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_UpdateMany_return_INVALID_ARG_if_input_parameter_updateManyCallback_is_NULL)
+{
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_UpdateMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_DEVICE_IDS, TEST_DEVICE_COUNT, TEST_DEVICE_TWIN_JSON, NULL, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_003: [ IoTHubDeviceTwin_UpdateMany shall create the request body from deviceTwinJson once with BUFFER_create, and send it to every device. ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_09_004: [ On its first call IoTHubDeviceTwin_UpdateMany shall create a pool of connections with sc_http_pool_create, which later calls reuse until IoTHubDeviceTwin_Destroy. ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_09_005: [ IoTHubDeviceTwin_UpdateMany shall run one request per device with sc_http_pool_run, as many at a time as the pool has connections, and return IOTHUB_DEVICE_TWIN_OK once every device has been reported, whatever the results. ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_09_006: [ IoTHubDeviceTwin_UpdateMany shall send the PATCH request of every device with sc_http_pool_execute, on the connection the pool runs it on. ]*/
+/*Tests_SRS_IOTHUBDEVICETWIN_09_007: [ IoTHubDeviceTwin_UpdateMany shall report the result and the updated twin of every device to updateManyCallback, one call at a time, and free the twin once the callback returns. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_UpdateMany_happy_path)
+{
+    // arrange
+    size_t index;
+
+    EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(sc_http_pool_create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, SC_HTTP_POOL_DEFAULT_MAX_CONNECTIONS));
+    STRICT_EXPECTED_CALL(sc_http_pool_run(TEST_SC_HTTP_POOL_HANDLE, TEST_DEVICE_COUNT, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    for (index = 0; index < TEST_DEVICE_COUNT; index++)
+    {
+        set_expected_calls_for_UpdateMany_device();
+    }
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_UpdateMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_DEVICE_IDS, TEST_DEVICE_COUNT, TEST_DEVICE_TWIN_JSON, test_update_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, TEST_DEVICE_COUNT, g_update_many_callback_count);
+    for (index = 0; index < TEST_DEVICE_COUNT; index++)
+    {
+        ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, g_update_many_results[index]);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_DEVICE_IDS[index], g_update_many_device_ids[index]);
+        ASSERT_IS_TRUE(g_update_many_has_twin[index]);
+    }
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_004: [ On its first call IoTHubDeviceTwin_UpdateMany shall create a pool of connections with sc_http_pool_create, which later calls reuse until IoTHubDeviceTwin_Destroy. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_UpdateMany_reuses_the_pool)
+{
+    // arrange
+    (void)IoTHubDeviceTwin_UpdateMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_DEVICE_IDS, 0, TEST_DEVICE_TWIN_JSON, test_update_many_callback, NULL);
+    umock_c_reset_all_calls();
+
+    set_expected_calls_for_UpdateMany(SC_HTTP_POOL_DEFAULT_MAX_CONNECTIONS, false);
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_UpdateMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_DEVICE_IDS, 0, TEST_DEVICE_TWIN_JSON, test_update_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_008: [ If a device id is NULL, IoTHubDeviceTwin_UpdateMany shall report IOTHUB_DEVICE_TWIN_INVALID_ARG for it without sending anything. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_UpdateMany_reports_INVALID_ARG_for_a_NULL_device_id)
+{
+    // arrange
+    const char* deviceIds[] = { NULL, "TEST_DEVICE_ID" };
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_UpdateMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, deviceIds, 2, TEST_DEVICE_TWIN_JSON, test_update_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 2, g_update_many_callback_count);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, g_update_many_results[0]);
+    ASSERT_IS_FALSE(g_update_many_has_twin[0]);
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, g_update_many_results[1]);
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_005: [ IoTHubDeviceTwin_UpdateMany shall run one request per device with sc_http_pool_run, as many at a time as the pool has connections, and return IOTHUB_DEVICE_TWIN_OK once every device has been reported, whatever the results. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_UpdateMany_reports_ERROR_if_http_status_is_not_200)
+{
+    // arrange
+    g_execute_status_code = httpStatusCodeBadRequest;
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_UpdateMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_DEVICE_IDS, TEST_DEVICE_COUNT, TEST_DEVICE_TWIN_JSON, test_update_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, result);
+    ASSERT_ARE_EQUAL(size_t, TEST_DEVICE_COUNT, g_update_many_callback_count);
+    for (size_t index = 0; index < TEST_DEVICE_COUNT; index++)
+    {
+        ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_ERROR, g_update_many_results[index]);
+        ASSERT_IS_FALSE(g_update_many_has_twin[index]);
+    }
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_009: [ If the request body, the lock or the pool cannot be created, or sc_http_pool_run fails, IoTHubDeviceTwin_UpdateMany shall return IOTHUB_DEVICE_TWIN_ERROR. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_UpdateMany_non_happy_path)
+{
+    // arrange
+    int umockc_result = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, umockc_result);
+
+    set_expected_calls_for_UpdateMany(SC_HTTP_POOL_DEFAULT_MAX_CONNECTIONS, true);
+
+    umock_c_negative_tests_snapshot();
+
+    for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+    {
+        if (umock_c_negative_tests_can_call_fail(i))
+        {
+            umock_c_negative_tests_reset();
+            umock_c_negative_tests_fail_call(i);
+            TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN.httpPool = NULL;
+
+            // act
+            IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_UpdateMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_DEVICE_IDS, 0, TEST_DEVICE_TWIN_JSON, test_update_many_callback, NULL);
+
+            // assert
+            ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_ERROR, result, "IoTHubDeviceTwin_UpdateMany failure in test %lu", (unsigned long)i);
+        }
+    }
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_010: [ If serviceClientDeviceTwinHandle is NULL or maxConnections is 0, IoTHubDeviceTwin_SetMaxConnections shall return IOTHUB_DEVICE_TWIN_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_SetMaxConnections_return_INVALID_ARG_if_input_parameter_serviceClientDeviceTwinHandle_is_NULL)
+{
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_SetMaxConnections(NULL, 8);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_010: [ If serviceClientDeviceTwinHandle is NULL or maxConnections is 0, IoTHubDeviceTwin_SetMaxConnections shall return IOTHUB_DEVICE_TWIN_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_SetMaxConnections_return_INVALID_ARG_if_input_parameter_maxConnections_is_0)
+{
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_SetMaxConnections(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, 0);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_011: [ IoTHubDeviceTwin_SetMaxConnections shall close the connections opened so far with sc_http_pool_destroy, so that the next IoTHubDeviceTwin_UpdateMany opens up to maxConnections, and return IOTHUB_DEVICE_TWIN_OK. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_SetMaxConnections_closes_the_pool)
+{
+    // arrange
+    (void)IoTHubDeviceTwin_UpdateMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_DEVICE_IDS, 0, TEST_DEVICE_TWIN_JSON, test_update_many_callback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(sc_http_pool_destroy(TEST_SC_HTTP_POOL_HANDLE));
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_SetMaxConnections(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, 8);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_011: [ IoTHubDeviceTwin_SetMaxConnections shall close the connections opened so far with sc_http_pool_destroy, so that the next IoTHubDeviceTwin_UpdateMany opens up to maxConnections, and return IOTHUB_DEVICE_TWIN_OK. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_SetMaxConnections_applies_to_the_next_pool)
+{
+    // arrange
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, IoTHubDeviceTwin_SetMaxConnections(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, 8));
+    umock_c_reset_all_calls();
+
+    set_expected_calls_for_UpdateMany(8, true);
+
+    // act
+    IOTHUB_DEVICE_TWIN_RESULT result = IoTHubDeviceTwin_UpdateMany(TEST_IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE, TEST_DEVICE_IDS, 0, TEST_DEVICE_TWIN_JSON, test_update_many_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_TWIN_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBDEVICETWIN_09_012: [ IoTHubDeviceTwin_Destroy shall close the connections opened by IoTHubDeviceTwin_UpdateMany by calling sc_http_pool_destroy. ]*/
+TEST_FUNCTION(IoTHubDeviceTwin_Destroy_closes_the_pool)
+{
+    // arrange
+    IOTHUB_SERVICE_CLIENT_DEVICE_TWIN_HANDLE handle = IoTHubDeviceTwin_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+    (void)IoTHubDeviceTwin_UpdateMany(handle, TEST_DEVICE_IDS, 0, TEST_DEVICE_TWIN_JSON, test_update_many_callback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(sc_http_pool_destroy(TEST_SC_HTTP_POOL_HANDLE));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    IoTHubDeviceTwin_Destroy(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(iothub_devicetwin_ut)
@@ -58,6 +58,8 @@ IMPLEMENT_UMOCK_C_ENUM_TYPE(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_RESULT_VAL
 #include "umock_c/umock_c_prod.h"
 MOCKABLE_FUNCTION(, void, TEST_FUNC_IOTHUB_OPEN_COMPLETE_CALLBACK, void*, context);
 MOCKABLE_FUNCTION(, void, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, void*, context, IOTHUB_MESSAGING_RESULT, messagingResult);
+MOCKABLE_FUNCTION(, void, TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK, void*, context, size_t, index, IOTHUB_MESSAGING_RESULT, messagingResult);
+MOCKABLE_FUNCTION(, void, TEST_FUNC_IOTHUB_SEND_QUEUE_CALLBACK, void*, context, size_t, messagesInFlight, size_t, messagesQueued);
 MOCKABLE_FUNCTION(, void, TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, void*, context, IOTHUB_SERVICE_FEEDBACK_BATCH*, feedbackBatch);
 #undef ENABLE_MOCKS
 
@@ -293,17 +295,46 @@ void my_messagereceiver_destroy(MESSAGE_RECEIVER_HANDLE message_receiver)
     }
 }
 
+#define TEST_MAX_SENT_MESSAGES      4
+
 static ON_MESSAGE_SEND_COMPLETE onMessageSendCompleteCallback;
+static void* onMessageSendCompleteContexts[TEST_MAX_SENT_MESSAGES];
+static size_t sentMessageCount;
 static ASYNC_OPERATION_HANDLE my_messagesender_send_async(MESSAGE_SENDER_HANDLE message_sender, MESSAGE_HANDLE message, ON_MESSAGE_SEND_COMPLETE on_message_send_complete, void* callback_context, tickcounter_ms_t timeout)
 {
     (void)timeout;
     (void)message;
     (void)message_sender;
-    (void)callback_context;
     onMessageSendCompleteCallback = on_message_send_complete;
+    if (sentMessageCount < TEST_MAX_SENT_MESSAGES)
+    {
+        onMessageSendCompleteContexts[sentMessageCount++] = callback_context;
+    }
     return TEST_ASYNC_HANDLE;
 }
 
+// Settles every message handed to the message sender, as messagesender_destroy would
+static void complete_sent_messages(MESSAGE_SEND_RESULT send_result)
+{
+    size_t i;
+    for (i = 0; i < sentMessageCount; i++)
+    {
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[i], send_result, NULL);
+    }
+    sentMessageCount = 0;
+}
+
+static size_t sendQueueCallbackCount;
+static size_t reportedMessagesInFlight;
+static size_t reportedMessagesQueued;
+static void my_send_queue_callback(void* context, size_t messagesInFlight, size_t messagesQueued)
+{
+    (void)context;
+    sendQueueCallbackCount++;
+    reportedMessagesInFlight = messagesInFlight;
+    reportedMessagesQueued = messagesQueued;
+}
+
 static ON_MESSAGE_RECEIVED onMessageReceivedCallback;
 static int my_messagereceiver_open(MESSAGE_RECEIVER_HANDLE message_receiver, ON_MESSAGE_RECEIVED on_message_received, void* callback_context)
 {
@@ -408,6 +439,75 @@ static JSON_Status TEST_JSON_STATUS = 0;
 static AMQP_VALUE TEST_AMQP_MAP = ((AMQP_VALUE)0x6258);
 static MAP_HANDLE TEST_MAP_HANDLE = (MAP_HANDLE)0x103;
 static IOTHUB_MESSAGE_HANDLE TEST_IOTHUB_MESSAGE_HANDLE = (IOTHUB_MESSAGE_HANDLE)0x4242;
+static const size_t TEST_PROPERTY_COUNT = 1;
+
+// Indices 0 to 24: the destination buffer and the uAMQP message encoded once per send call
+static void setup_create_amqp_message_mocks(void)
+{
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    STRICT_EXPECTED_CALL(message_create());
+    STRICT_EXPECTED_CALL(message_add_body_amqp_data(IGNORED_PTR_ARG, TEST_BINARY_DATA_INST))
+        .IgnoreAllArguments();
+
+    STRICT_EXPECTED_CALL(message_get_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_properties(&TEST_PROPERTIES_HANDLE_NULL, sizeof(TEST_PROPERTIES_HANDLE_NULL));
+    STRICT_EXPECTED_CALL(properties_create());
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetMessageId(IGNORED_PTR_ARG))
+        .SetReturn(TEST_CONST_CHAR_PTR);
+    STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(properties_set_message_id(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetCorrelationId(IGNORED_PTR_ARG))
+        .SetReturn(TEST_CONST_CHAR_PTR);
+    STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(properties_set_correlation_id(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_Properties(TEST_IOTHUB_MESSAGE_HANDLE))
+        .SetReturn(TEST_MAP_HANDLE);
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_keys(&pTEST_MAP_KEYS, sizeof(pTEST_MAP_KEYS))
+        .CopyOutArgumentBuffer_values(&pTEST_MAP_VALUES, sizeof(pTEST_MAP_VALUES))
+        .CopyOutArgumentBuffer_count(&TEST_PROPERTY_COUNT, sizeof(size_t))
+        .SetReturn(MAP_OK);
+    STRICT_EXPECTED_CALL(amqpvalue_create_map());
+    STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqpvalue_set_map_value(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(message_set_application_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+}
+
+// The TO property, set right before the message is handed to messagesender_send_async
+static void setup_set_amqp_message_destination_mocks(void)
+{
+    STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(properties_set_to(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(message_set_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG));
+}
+
+// Five calls per device sent right away: its context, then its destination
+static void setup_send_amqp_message_to_device_mocks(void)
+{
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    setup_set_amqp_message_destination_mocks();
+}
+
+static void setup_destroy_amqp_message_mocks(void)
+{
+    STRICT_EXPECTED_CALL(properties_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(message_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+}
 
 BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
 
@@ -591,6 +691,7 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         REGISTER_GLOBAL_MOCK_RETURN(messagesender_send_async, (ASYNC_OPERATION_HANDLE)0x64);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(messagesender_send_async, NULL);
 
+
         REGISTER_GLOBAL_MOCK_RETURN(json_parse_string, TEST_JSON_VALUE);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_parse_string, NULL);
 
@@ -647,6 +748,7 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_GetCorrelationId, NULL);
 
         REGISTER_GLOBAL_MOCK_HOOK(TEST_FUNC_IOTHUB_FEEDBACK_MESSAGE_RECEIVED_CALLBACK, my_on_feedback_message_received);
+        REGISTER_GLOBAL_MOCK_HOOK(TEST_FUNC_IOTHUB_SEND_QUEUE_CALLBACK, my_send_queue_callback);
     }
 
     TEST_SUITE_CLEANUP(TestClassCleanup)
@@ -673,6 +775,10 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         onMessageSenderStateChangedCallback = NULL;
         onMessageReceiverStateChangedCallback = NULL;
         onMessageSendCompleteCallback = NULL;
+        sentMessageCount = 0;
+        sendQueueCallbackCount = 0;
+        reportedMessagesInFlight = 0;
+        reportedMessagesQueued = 0;
         onMessageReceivedCallback = NULL;
         messagereceiver_create_return = NULL;
         messagesender_create_return = NULL;
@@ -1157,6 +1263,48 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
+    /*Tests_SRS_IOTHUBMESSAGING_09_016: [ IoTHubMessaging_LL_Close and IoTHubMessaging_LL_Destroy shall call the callback of every message still waiting for room in the window with IOTHUB_MESSAGING_ERROR and free it ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_Close_calls_the_callback_of_queued_messages)
+    {
+        // arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SetMaxMessagesInFlight(iothub_messaging_handle, 1);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)1);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)2);
+        complete_sent_messages(MESSAGE_SEND_OK);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(messagesender_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(messagereceiver_destroy(IGNORED_PTR_ARG));
+
+        STRICT_EXPECTED_CALL(link_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(link_destroy(IGNORED_PTR_ARG));
+
+        STRICT_EXPECTED_CALL(session_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(connection_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(saslmechanism_destroy(IGNORED_PTR_ARG));
+
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        setup_destroy_amqp_message_mocks();
+        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK((void*)2, IOTHUB_MESSAGING_ERROR));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        // act
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+
+        // assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
     /*Tests_SRS_IOTHUBMESSAGING_12_034: [ IoTHubMessaging_LL_Send shall verify the messagingHandle, deviceId, message input parameters and if any of them are NULL then return NULL ] */
     TEST_FUNCTION(IoTHubMessaging_LL_Send_return_IOTHUB_MESSAGING_INVALID_ARG_if_input_parameter_messagingHandle_is_NULL)
     {
@@ -1253,231 +1401,322 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
     TEST_FUNCTION(IoTHubMessaging_LL_Send_happy_path)
     {
         //arrange
-        size_t number_of_arguments = 1;
         IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
         IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
+        setup_create_amqp_message_mocks();
+        setup_send_amqp_message_to_device_mocks();
+        STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        setup_destroy_amqp_message_mocks();
 
-        STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+        //act
+        IOTHUB_MESSAGING_RESULT result;
+        result = IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_CONST_CHAR_PTR, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, TEST_VOID_PTR);
 
-        STRICT_EXPECTED_CALL(message_create());
-        STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(message_add_body_amqp_data(IGNORED_PTR_ARG, TEST_BINARY_DATA_INST))
-            .IgnoreAllArguments();
+        //assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, sentMessageCount);
 
-        STRICT_EXPECTED_CALL(message_get_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments()
-            .CopyOutArgumentBuffer_properties(&TEST_PROPERTIES_HANDLE_NULL, sizeof(TEST_PROPERTIES_HANDLE_NULL));
-        STRICT_EXPECTED_CALL(properties_create());
+        //cleanup
+        complete_sent_messages(MESSAGE_SEND_OK);
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(IoTHubMessage_GetMessageId(IGNORED_PTR_ARG))
-            .IgnoreAllArguments()
-            .SetReturn(TEST_CONST_CHAR_PTR);
-        STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(properties_set_message_id(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+    /*Tests_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_Send shall return IOTHUB_MESSAGING_ERROR ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_Send_non_happy_path)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(IoTHubMessage_GetCorrelationId(IGNORED_PTR_ARG))
-            .IgnoreAllArguments()
-            .SetReturn(TEST_CONST_CHAR_PTR);
-        STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(properties_set_correlation_id(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+        int umockc_result = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, umockc_result);
 
-        STRICT_EXPECTED_CALL(properties_set_to(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(message_set_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(properties_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+        size_t doNotFailCalls[] =
+        {
+            5,  /*message_get_properties*/
+            7,  /*IoTHubMessage_GetMessageId*/
+            9,  /*properties_set_message_id*/
+            10, /*amqpvalue_destroy*/
+            11, /*IoTHubMessage_GetCorrelationId*/
+            13, /*properties_set_correlation_id*/
+            14, /*amqpvalue_destroy*/
+            15, /*IoTHubMessage_Properties*/
+            21, /*amqpvalue_destroy*/
+            22, /*amqpvalue_destroy*/
+            23, /*message_set_application_properties*/
+            24, /*amqpvalue_destroy*/
+            29, /*amqpvalue_destroy*/
+            31, /*properties_destroy*/
+            32, /*message_destroy*/
+            33  /*gballoc_free*/
+        };
 
-        STRICT_EXPECTED_CALL(IoTHubMessage_Properties(TEST_IOTHUB_MESSAGE_HANDLE))
-            .IgnoreAllArguments()
-            .SetReturn(TEST_MAP_HANDLE);
+        umock_c_reset_all_calls();
+        setup_create_amqp_message_mocks();
+        setup_send_amqp_message_to_device_mocks();
+        STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        setup_destroy_amqp_message_mocks();
 
-        STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments()
-            .CopyOutArgumentBuffer_keys(&pTEST_MAP_KEYS, sizeof(pTEST_MAP_KEYS))
-            .CopyOutArgumentBuffer_values(&pTEST_MAP_VALUES, sizeof(pTEST_MAP_VALUES))
-            .CopyOutArgumentBuffer_count(&number_of_arguments, sizeof(size_t))
-            .SetReturn(MAP_OK);
+        umock_c_negative_tests_snapshot();
 
-        STRICT_EXPECTED_CALL(amqpvalue_create_map());
+        //act
+        for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+        {
+            umock_c_negative_tests_reset();
+            size_t j;
+            for ( j = 0; j < sizeof(doNotFailCalls) / sizeof(doNotFailCalls[0]); j++)
+            {
+                if (doNotFailCalls[j] == i)
+                {
+                    break;
+                }
+            }
 
-        STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_set_map_value(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+            if (j == sizeof(doNotFailCalls) / sizeof(doNotFailCalls[0]))
+            {
+                umock_c_negative_tests_fail_call(i);
 
-        STRICT_EXPECTED_CALL(message_set_application_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+                IOTHUB_MESSAGING_RESULT result;
 
-        STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
-            .IgnoreAllArguments();
+                /* If modules are re-enabled, re-enable this code and add testing_module paramater to this function
+                if (testing_module == true)
+                {
+                    result = IoTHubMessaging_LL_SendModule(TEST_IOTHUB_MESSAGING_HANDLE, TEST_CONST_CHAR_PTR, TEST_MODULE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, TEST_VOID_PTR);
+                }
+                */
+                result = IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_CONST_CHAR_PTR, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, TEST_VOID_PTR);
 
-        STRICT_EXPECTED_CALL(message_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+                //assert
+                ASSERT_ARE_NOT_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_OK, result);
+            }
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
+        }
+        umock_c_negative_tests_deinit();
+
+        //cleanup
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_003: [ If the window is full, or other messages already wait for room in it, only a copy of the device id and a reference to the message encoded by the send call shall be queued until IoTHubMessaging_LL_DoWork can hand it to AMQP ] */
+    /*Tests_SRS_IOTHUBMESSAGING_09_013: [ IoTHubMessaging_LL_SetMaxMessagesInFlight shall save maxMessagesInFlight, where 0 removes the limit, and return IOTHUB_MESSAGING_OK ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_Send_queues_the_message_if_the_window_is_full)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SetMaxMessagesInFlight(iothub_messaging_handle, 1);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)1);
+        umock_c_reset_all_calls();
+
+        setup_create_amqp_message_mocks();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_DEVICE_ID));
 
         //act
-        IOTHUB_MESSAGING_RESULT result;
-        result = IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_CONST_CHAR_PTR, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, TEST_VOID_PTR);
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)2);
 
         //assert
-        ASSERT_ARE_EQUAL(int, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_OK, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, sentMessageCount);
 
         //cleanup
+        complete_sent_messages(MESSAGE_SEND_OK);
         IoTHubMessaging_LL_Close(iothub_messaging_handle);
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
-    /*Tests_SRS_IOTHUBMESSAGING_12_040: [ If any of the uAMQP call fails IoTHubMessaging_LL_Send shall return IOTHUB_MESSAGING_ERROR ] */
-    TEST_FUNCTION(IoTHubMessaging_LL_Send_non_happy_path)
+    /*Tests_SRS_IOTHUBMESSAGING_09_004: [ If messagingHandle, deviceIds or message is NULL, or deviceCount is 0, IoTHubMessaging_LL_SendMany shall return IOTHUB_MESSAGING_INVALID_ARG ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SendMany_return_IOTHUB_MESSAGING_INVALID_ARG_if_input_parameter_messagingHandle_is_NULL)
+    {
+        //arrange
+        const char* deviceIds[] = { TEST_DEVICE_ID };
+
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendMany(NULL, deviceIds, 1, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK, TEST_VOID_PTR);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_004: [ If messagingHandle, deviceIds or message is NULL, or deviceCount is 0, IoTHubMessaging_LL_SendMany shall return IOTHUB_MESSAGING_INVALID_ARG ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SendMany_return_IOTHUB_MESSAGING_INVALID_ARG_if_deviceCount_is_0)
     {
         //arrange
+        const char* deviceIds[] = { TEST_DEVICE_ID };
         IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
         IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
         umock_c_reset_all_calls();
 
-        int umockc_result = umock_c_negative_tests_init();
-        ASSERT_ARE_EQUAL(int, 0, umockc_result);
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendMany(iothub_messaging_handle, deviceIds, 0, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK, TEST_VOID_PTR);
 
-        size_t doNotFailCalls[] =
-        {
-            6,  /*contentType*/
-            8,  /*contentType*/
-            9,  /*message_get_properties*/
-            10, /*properties_create*/
-            11, /*properties_set_message_id*/
-            12, /*properties_set_correlation_id*/
-            14, /*message_set_application_properties*/
-            15, /*amqpvalue_destroy*/
-            18, /*amqpvalue_destroy*/
-            19, /*amqpvalue_destroy*/
-            25, /*properties_destroy*/
-            26, /*amqpvalue_destroy*/
-            27, /*amqpvalue_destroy*/
-            28, /*amqpvalue_destroy*/
-            30  /*gballoc_free*/
-        };
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-        size_t number_of_arguments = 1;
+        //cleanup
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
+    /*Tests_SRS_IOTHUBMESSAGING_09_005: [ If any of the device ids is NULL, IoTHubMessaging_LL_SendMany shall return IOTHUB_MESSAGING_INVALID_ARG without sending the message to any device ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SendMany_return_IOTHUB_MESSAGING_INVALID_ARG_if_a_deviceId_is_NULL)
+    {
+        //arrange
+        const char* deviceIds[] = { TEST_DEVICE_ID, NULL };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
         umock_c_reset_all_calls();
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
 
-        STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendMany(iothub_messaging_handle, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK, TEST_VOID_PTR);
 
-        STRICT_EXPECTED_CALL(message_create());
-        STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(message_add_body_amqp_data(IGNORED_PTR_ARG, TEST_BINARY_DATA_INST))
-            .IgnoreAllArguments();
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-        STRICT_EXPECTED_CALL(message_get_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments()
-            .CopyOutArgumentBuffer_properties(&TEST_PROPERTIES_HANDLE_NULL, sizeof(TEST_PROPERTIES_HANDLE_NULL));
-        STRICT_EXPECTED_CALL(properties_create());
+        //cleanup
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(IoTHubMessage_GetMessageId(IGNORED_PTR_ARG))
-            .IgnoreAllArguments()
-            .SetReturn(TEST_CONST_CHAR_PTR);
-        STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(properties_set_message_id(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+    /*Tests_SRS_IOTHUBMESSAGING_09_006: [ If messaging is not opened, IoTHubMessaging_LL_SendMany shall return IOTHUB_MESSAGING_ERROR ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SendMany_return_IOTHUB_MESSAGING_ERROR_if_messaging_is_not_opened)
+    {
+        //arrange
+        const char* deviceIds[] = { TEST_DEVICE_ID };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(IoTHubMessage_GetCorrelationId(IGNORED_PTR_ARG))
-            .IgnoreAllArguments()
-            .SetReturn(TEST_CONST_CHAR_PTR);
-        STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(properties_set_correlation_id(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendMany(iothub_messaging_handle, deviceIds, 1, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK, TEST_VOID_PTR);
 
-        STRICT_EXPECTED_CALL(properties_set_to(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(message_set_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(properties_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-        STRICT_EXPECTED_CALL(IoTHubMessage_Properties(TEST_IOTHUB_MESSAGE_HANDLE))
-            .IgnoreAllArguments()
-            .SetReturn(TEST_MAP_HANDLE);
+        //cleanup
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
-        STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments()
-            .CopyOutArgumentBuffer_keys(&pTEST_MAP_KEYS, sizeof(pTEST_MAP_KEYS))
-            .CopyOutArgumentBuffer_values(&pTEST_MAP_VALUES, sizeof(pTEST_MAP_VALUES))
-            .CopyOutArgumentBuffer_count(&number_of_arguments, sizeof(size_t))
-            .SetReturn(MAP_OK);
+    /*Tests_SRS_IOTHUBMESSAGING_09_001: [ The message shall be encoded once per send call, and only its TO property shall be set again for each device, right before the message is handed to messagesender_send_async ] */
+    /*Tests_SRS_IOTHUBMESSAGING_09_002: [ Each message shall be handed to messagesender_send_async with its own context, holding the callback and the user context of its send call ] */
+    /*Tests_SRS_IOTHUBMESSAGING_09_007: [ IoTHubMessaging_LL_SendMany shall encode the message once, in one buffer for the destination of the longest device id, and send it to every device like IoTHubMessaging_LL_Send does ] */
+    /*Tests_SRS_IOTHUBMESSAGING_09_011: [ Otherwise IoTHubMessaging_LL_SendMany shall return IOTHUB_MESSAGING_OK ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SendMany_happy_path)
+    {
+        //arrange
+        const char* deviceIds[] = { TEST_DEVICE_ID, "aLongerDeviceId" };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(amqpvalue_create_map());
+        setup_create_amqp_message_mocks();
+        setup_send_amqp_message_to_device_mocks();
+        STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        setup_send_amqp_message_to_device_mocks();
+        STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        setup_destroy_amqp_message_mocks();
 
-        STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_create_string(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_set_map_value(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendMany(iothub_messaging_handle, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK, TEST_VOID_PTR);
 
-        STRICT_EXPECTED_CALL(message_set_application_properties(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-        STRICT_EXPECTED_CALL(amqpvalue_destroy(IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 2, sentMessageCount);
+        ASSERT_ARE_NOT_EQUAL(void_ptr, onMessageSendCompleteContexts[0], onMessageSendCompleteContexts[1]);
+
+        //cleanup
+        complete_sent_messages(MESSAGE_SEND_OK);
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
 
+    /*Tests_SRS_IOTHUBMESSAGING_09_010: [ If the message cannot be sent to a device, IoTHubMessaging_LL_SendMany shall call the callback for that device with IOTHUB_MESSAGING_ERROR, or IOTHUB_MESSAGING_QUEUE_FULL, and go on with the next device ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SendMany_calls_the_callback_of_a_device_that_fails_and_sends_to_the_next)
+    {
+        //arrange
+        const char* deviceIds[] = { TEST_DEVICE_ID, TEST_DEVICE_ID };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        umock_c_reset_all_calls();
+
+        setup_create_amqp_message_mocks();
+        setup_send_amqp_message_to_device_mocks();
         STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
-            .IgnoreAllArguments();
+            .SetReturn(NULL);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK(TEST_VOID_PTR, 0, IOTHUB_MESSAGING_ERROR));
+        setup_send_amqp_message_to_device_mocks();
+        STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        setup_destroy_amqp_message_mocks();
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendMany(iothub_messaging_handle, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK, TEST_VOID_PTR);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, sentMessageCount);
+
+        //cleanup
+        complete_sent_messages(MESSAGE_SEND_OK);
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_008: [ If the message cannot be encoded, IoTHubMessaging_LL_SendMany shall return IOTHUB_MESSAGING_ERROR without calling the callback ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SendMany_non_happy_path)
+    {
+        //arrange
+        const char* deviceIds[] = { TEST_DEVICE_ID };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        umock_c_reset_all_calls();
+
+        int umockc_result = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, umockc_result);
+
+        // Only the calls that encode the message fail the whole call; the others fail one device
+        size_t encodeCallCount = 25;
+        size_t doNotFailCalls[] =
+        {
+            5,  /*message_get_properties*/
+            7,  /*IoTHubMessage_GetMessageId*/
+            9,  /*properties_set_message_id*/
+            10, /*amqpvalue_destroy*/
+            11, /*IoTHubMessage_GetCorrelationId*/
+            13, /*properties_set_correlation_id*/
+            14, /*amqpvalue_destroy*/
+            15, /*IoTHubMessage_Properties*/
+            21, /*amqpvalue_destroy*/
+            22, /*amqpvalue_destroy*/
+            23, /*message_set_application_properties*/
+            24  /*amqpvalue_destroy*/
+        };
+
+        setup_create_amqp_message_mocks();
+        setup_send_amqp_message_to_device_mocks();
+        STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        setup_destroy_amqp_message_mocks();
 
         umock_c_negative_tests_snapshot();
 
         //act
-        for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+        for (size_t i = 0; i < encodeCallCount; i++)
         {
             umock_c_negative_tests_reset();
             size_t j;
-            for ( j = 0; j < sizeof(doNotFailCalls) / sizeof(doNotFailCalls[0]); j++)
+            for (j = 0; j < sizeof(doNotFailCalls) / sizeof(doNotFailCalls[0]); j++)
             {
                 if (doNotFailCalls[j] == i)
                 {
@@ -1489,20 +1728,11 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
             {
                 umock_c_negative_tests_fail_call(i);
 
-                IOTHUB_MESSAGING_RESULT result;
-
-                /* If modules are re-enabled, re-enable this code and add testing_module paramater to this function
-                if (testing_module == true)
-                {
-                    result = IoTHubMessaging_LL_SendModule(TEST_IOTHUB_MESSAGING_HANDLE, TEST_CONST_CHAR_PTR, TEST_MODULE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, TEST_VOID_PTR);
-                }
-                */
-                result = IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_CONST_CHAR_PTR, TEST_IOTHUB_MESSAGE_HANDLE, TEST_IOTHUB_SEND_COMPLETE_CALLBACK, TEST_VOID_PTR);
+                IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendMany(iothub_messaging_handle, deviceIds, 1, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK, TEST_VOID_PTR);
 
                 //assert
-                ASSERT_ARE_NOT_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_OK, result);
+                ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_ERROR, result, "IoTHubMessaging_LL_SendMany failure in test %lu", (unsigned long)i);
             }
-
         }
         umock_c_negative_tests_deinit();
 
@@ -1620,6 +1850,89 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
+    /*Tests_SRS_IOTHUBMESSAGING_09_012: [ If messagingHandle is NULL, IoTHubMessaging_LL_SetMaxMessagesInFlight shall return IOTHUB_MESSAGING_INVALID_ARG ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SetMaxMessagesInFlight_return_IOTHUB_MESSAGING_INVALID_ARG_if_input_parameter_messagingHandle_is_NULL)
+    {
+        //arrange
+
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SetMaxMessagesInFlight(NULL, 1);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_013: [ IoTHubMessaging_LL_SetMaxMessagesInFlight shall save maxMessagesInFlight, where 0 removes the limit, and return IOTHUB_MESSAGING_OK ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SetMaxMessagesInFlight_happy_path)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        umock_c_reset_all_calls();
+
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SetMaxMessagesInFlight(iothub_messaging_handle, 0);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_017: [ If messagingHandle is NULL, IoTHubMessaging_LL_SetSendQueueCallback shall return IOTHUB_MESSAGING_INVALID_ARG ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SetSendQueueCallback_return_IOTHUB_MESSAGING_INVALID_ARG_if_input_parameter_messagingHandle_is_NULL)
+    {
+        //arrange
+
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SetSendQueueCallback(NULL, TEST_FUNC_IOTHUB_SEND_QUEUE_CALLBACK, TEST_VOID_PTR);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_015: [ The send functions and IoTHubMessaging_LL_DoWork shall call the send queue callback, if one is set, with the number of messages in flight and the number of queued messages whenever either changed since the last call ] */
+    /*Tests_SRS_IOTHUBMESSAGING_09_018: [ IoTHubMessaging_LL_SetSendQueueCallback shall save the callback and its context and return IOTHUB_MESSAGING_OK ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SetSendQueueCallback_reports_messages_in_flight_and_queued)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SetMaxMessagesInFlight(iothub_messaging_handle, 1);
+        umock_c_reset_all_calls();
+
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SetSendQueueCallback(iothub_messaging_handle, TEST_FUNC_IOTHUB_SEND_QUEUE_CALLBACK, TEST_VOID_PTR);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_OK, result);
+
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)1);
+        ASSERT_ARE_EQUAL(size_t, 1, sendQueueCallbackCount);
+        ASSERT_ARE_EQUAL(size_t, 1, reportedMessagesInFlight);
+        ASSERT_ARE_EQUAL(size_t, 0, reportedMessagesQueued);
+
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)2);
+        ASSERT_ARE_EQUAL(size_t, 2, sendQueueCallbackCount);
+        ASSERT_ARE_EQUAL(size_t, 1, reportedMessagesInFlight);
+        ASSERT_ARE_EQUAL(size_t, 1, reportedMessagesQueued);
+
+        IoTHubMessaging_LL_DoWork(iothub_messaging_handle);
+        ASSERT_ARE_EQUAL(size_t, 2, sendQueueCallbackCount);
+
+        complete_sent_messages(MESSAGE_SEND_OK);
+        IoTHubMessaging_LL_DoWork(iothub_messaging_handle);
+        ASSERT_ARE_EQUAL(size_t, 3, sendQueueCallbackCount);
+        ASSERT_ARE_EQUAL(size_t, 1, reportedMessagesInFlight);
+        ASSERT_ARE_EQUAL(size_t, 0, reportedMessagesQueued);
+
+        //cleanup
+        complete_sent_messages(MESSAGE_SEND_OK);
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
     /*Tests_SRS_IOTHUBMESSAGING_12_045: [ IoTHubMessaging_LL_DoWork shall verify if uAMQP transport has been initialized and if it is not then return immediately ] */
     TEST_FUNCTION(IoTHubMessaging_LL_DoWork_return_if_input_parameter_messagingHandle_is_NULL)
     {
@@ -1656,6 +1969,192 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
+    /*Tests_SRS_IOTHUBMESSAGING_09_020: [ If messagingHandle is NULL, IoTHubMessaging_LL_SetMaxMessagesQueued shall return IOTHUB_MESSAGING_INVALID_ARG ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SetMaxMessagesQueued_return_IOTHUB_MESSAGING_INVALID_ARG_if_input_parameter_messagingHandle_is_NULL)
+    {
+        //arrange
+
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SetMaxMessagesQueued(NULL, 1);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_021: [ IoTHubMessaging_LL_SetMaxMessagesQueued shall save maxMessagesQueued, where 0 removes the limit, and return IOTHUB_MESSAGING_OK; messages already queued stay queued ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SetMaxMessagesQueued_happy_path)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        umock_c_reset_all_calls();
+
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SetMaxMessagesQueued(iothub_messaging_handle, 0);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_019: [ If the window is full and maxMessagesQueued messages already wait for room in it, the message shall not be queued and the result for that device shall be IOTHUB_MESSAGING_QUEUE_FULL ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_Send_returns_IOTHUB_MESSAGING_QUEUE_FULL_if_the_queue_is_full)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SetMaxMessagesInFlight(iothub_messaging_handle, 1);
+        (void)IoTHubMessaging_LL_SetMaxMessagesQueued(iothub_messaging_handle, 1);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)1);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)2);
+        umock_c_reset_all_calls();
+
+        setup_create_amqp_message_mocks();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        setup_destroy_amqp_message_mocks();
+
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)3);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_QUEUE_FULL, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, sentMessageCount);
+
+        //cleanup
+        complete_sent_messages(MESSAGE_SEND_OK);
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_010: [ If the message cannot be sent to a device, IoTHubMessaging_LL_SendMany shall call the callback for that device with IOTHUB_MESSAGING_ERROR, or IOTHUB_MESSAGING_QUEUE_FULL, and go on with the next device ] */
+    /*Tests_SRS_IOTHUBMESSAGING_09_019: [ If the window is full and maxMessagesQueued messages already wait for room in it, the message shall not be queued and the result for that device shall be IOTHUB_MESSAGING_QUEUE_FULL ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SendMany_calls_the_callback_with_IOTHUB_MESSAGING_QUEUE_FULL_if_the_queue_is_full)
+    {
+        //arrange
+        const char* deviceIds[] = { TEST_DEVICE_ID, TEST_DEVICE_ID, TEST_DEVICE_ID };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SetMaxMessagesInFlight(iothub_messaging_handle, 1);
+        (void)IoTHubMessaging_LL_SetMaxMessagesQueued(iothub_messaging_handle, 1);
+        umock_c_reset_all_calls();
+
+        setup_create_amqp_message_mocks();
+        setup_send_amqp_message_to_device_mocks();
+        STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_DEVICE_ID));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK(TEST_VOID_PTR, 2, IOTHUB_MESSAGING_QUEUE_FULL));
+
+        //act
+        IOTHUB_MESSAGING_RESULT result = IoTHubMessaging_LL_SendMany(iothub_messaging_handle, deviceIds, 3, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK, TEST_VOID_PTR);
+
+        //assert
+        ASSERT_ARE_EQUAL(IOTHUB_MESSAGING_RESULT, IOTHUB_MESSAGING_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, sentMessageCount);
+
+        //cleanup
+        complete_sent_messages(MESSAGE_SEND_OK);
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_009: [ IoTHubMessaging_LL_SendMessageComplete shall call the callback given to the send call of that message, and free the room the message took in the window ] */
+    /*Tests_SRS_IOTHUBMESSAGING_09_014: [ After connection_dowork, IoTHubMessaging_LL_DoWork shall set the TO property of the queued messages and hand them to messagesender_send_async, oldest first, while there is room in the window, and call the callback of any that fails with IOTHUB_MESSAGING_ERROR ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_DoWork_sends_queued_messages_when_the_window_has_room)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SetMaxMessagesInFlight(iothub_messaging_handle, 1);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)1);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)2);
+        complete_sent_messages(MESSAGE_SEND_OK);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(connection_dowork(IGNORED_PTR_ARG));
+        setup_set_amqp_message_destination_mocks();
+        STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        setup_destroy_amqp_message_mocks();
+
+        //act
+        IoTHubMessaging_LL_DoWork(iothub_messaging_handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, sentMessageCount);
+
+        //cleanup
+        complete_sent_messages(MESSAGE_SEND_OK);
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_014: [ After connection_dowork, IoTHubMessaging_LL_DoWork shall set the TO property of the queued messages and hand them to messagesender_send_async, oldest first, while there is room in the window, and call the callback of any that fails with IOTHUB_MESSAGING_ERROR ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_DoWork_keeps_queued_messages_while_the_window_is_full)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SetMaxMessagesInFlight(iothub_messaging_handle, 1);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)1);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)2);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(connection_dowork(IGNORED_PTR_ARG));
+
+        //act
+        IoTHubMessaging_LL_DoWork(iothub_messaging_handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        complete_sent_messages(MESSAGE_SEND_OK);
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
+    /*Tests_SRS_IOTHUBMESSAGING_09_014: [ After connection_dowork, IoTHubMessaging_LL_DoWork shall set the TO property of the queued messages and hand them to messagesender_send_async, oldest first, while there is room in the window, and call the callback of any that fails with IOTHUB_MESSAGING_ERROR ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_DoWork_calls_the_callback_of_a_queued_message_that_fails)
+    {
+        //arrange
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SetMaxMessagesInFlight(iothub_messaging_handle, 1);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)1);
+        (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)2);
+        complete_sent_messages(MESSAGE_SEND_OK);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(connection_dowork(IGNORED_PTR_ARG));
+        setup_set_amqp_message_destination_mocks();
+        STRICT_EXPECTED_CALL(messagesender_send_async(IGNORED_PTR_ARG, TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .SetReturn(NULL);
+        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK((void*)2, IOTHUB_MESSAGING_ERROR));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        setup_destroy_amqp_message_mocks();
+
+        //act
+        IoTHubMessaging_LL_DoWork(iothub_messaging_handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 0, sentMessageCount);
+
+        //cleanup
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
     /*Tests_SRS_IOTHUBMESSAGING_12_049: [ IoTHubMessaging_LL_SenderStateChanged shall save the new_state to local variable ] */
     /*Tests_SRS_IOTHUBMESSAGING_12_050: [ If both sender and receiver state is open IoTHubMessaging_LL_SenderStateChanged shall set the isOpened local variable to true ] */
     TEST_FUNCTION(IoTHubMessaging_LL_SenderStateChanged_call_user_callback)
@@ -1826,6 +2325,7 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         //cleanup
+        complete_sent_messages(MESSAGE_SEND_OK);
         IoTHubMessaging_LL_Close(iothub_messaging_handle);
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
@@ -1841,11 +2341,12 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
 
         umock_c_reset_all_calls();
 
-        MESSAGE_SEND_RESULT send_result = MESSAGE_SEND_OK;
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
+        MESSAGE_SEND_RESULT send_result = MESSAGE_SEND_OK;
 
         //act
-        onMessageSendCompleteCallback(iothub_messaging_handle, send_result, TEST_AMQP_VALUE);
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[0], send_result, TEST_AMQP_VALUE);
 
         //assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -1871,12 +2372,13 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         (void)IoTHubMessaging_LL_Send(iothub_messaging_handle, TEST_DEVICE_ID, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK, (void*)1);
         umock_c_reset_all_calls();
 
-        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK(IGNORED_PTR_ARG, IOTHUB_MESSAGING_OK));
+        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_SEND_COMPLETE_CALLBACK((void*)1, IOTHUB_MESSAGING_OK));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         MESSAGE_SEND_RESULT send_result = MESSAGE_SEND_OK;
 
         //act
-        onMessageSendCompleteCallback((void*)iothub_messaging_handle, send_result, TEST_AMQP_VALUE);
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[0], send_result, TEST_AMQP_VALUE);
 
         //assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -1886,6 +2388,33 @@ BEGIN_TEST_SUITE(iothub_messaging_ll_ut)
         IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
     }
 
+    /*Tests_SRS_IOTHUBMESSAGING_09_009: [ IoTHubMessaging_LL_SendMessageComplete shall call the callback given to the send call of that message, and free the room the message took in the window ] */
+    TEST_FUNCTION(IoTHubMessaging_LL_SendMessageComplete_calls_the_send_many_callback_with_the_device_index)
+    {
+        //arrange
+        const char* deviceIds[] = { TEST_DEVICE_ID, TEST_DEVICE_ID };
+        IOTHUB_MESSAGING_HANDLE iothub_messaging_handle = IoTHubMessaging_LL_Create(TEST_IOTHUB_SERVICE_CLIENT_AUTH_HANDLE);
+        (void)IoTHubMessaging_LL_Open(iothub_messaging_handle, NULL, NULL);
+        (void)IoTHubMessaging_LL_SendMany(iothub_messaging_handle, deviceIds, 2, TEST_IOTHUB_MESSAGE_HANDLE, TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK, TEST_VOID_PTR);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK(TEST_VOID_PTR, 1, IOTHUB_MESSAGING_OK));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(TEST_FUNC_IOTHUB_SEND_MANY_COMPLETE_CALLBACK(TEST_VOID_PTR, 0, IOTHUB_MESSAGING_ERROR));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        //act
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[1], MESSAGE_SEND_OK, TEST_AMQP_VALUE);
+        onMessageSendCompleteCallback(onMessageSendCompleteContexts[0], MESSAGE_SEND_TIMEOUT, TEST_AMQP_VALUE);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        IoTHubMessaging_LL_Close(iothub_messaging_handle);
+        IoTHubMessaging_LL_Destroy(iothub_messaging_handle);
+    }
+
 #if 0
     // Modules message sending not available
     TEST_FUNCTION(IoTHubMessaging_LL_SendModuleMessageComplete_call_to_user_callback)
@@ -4,9 +4,11 @@
 #ifdef __cplusplus
 #include <cstdlib>
 #include <cstddef>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -481,6 +483,28 @@ static const char* TEST_DEVICE_JSON_DEFAULT_VALUE_ENABLED = "enabled";
 static const char* TEST_DEVICE_JSON_DEFAULT_VALUE_DISABLED = "disabled";
 static const char* TEST_DEVICE_JSON_DEFAULT_VALUE_CONNECTED = "Connected";
 
+// Device and module lists as returned by the service, one entry per list
+#define TEST_JSON_COMMON_MEMBERS \
+    "\"deviceId\":\"theDeviceId\",\"generationId\":\"theGenerationId\",\"etag\":\"theEtag\"," \
+    "\"connectionState\":\"Connected\",\"connectionStateUpdatedTime\":\"0001-01-01T11:11:11\"," \
+    "\"status\":\"enabled\",\"statusReason\":\"Because...\",\"statusUpdatedTime\":\"0001-01-01T22:22:22\"," \
+    "\"lastActivityTime\":\"0001-01-01T33:33:33\",\"cloudToDeviceMessageCount\":42,\"isManaged\":true," \
+    "\"configuration\":\"theSecondaryKey\",\"deviceProperties\":\"theSecondaryKey\",\"serviceProperties\":\"theSecondaryKey\"," \
+    "\"capabilities\":{\"iotEdge\":false},\"tags\":{\"location\":{\"floor\":[1,2]}}"
+#define TEST_JSON_SAS_AUTHENTICATION \
+    "\"authentication\":{\"symmetricKey\":{\"primaryKey\":\"thePrimaryKey\",\"secondaryKey\":\"theSecondaryKey\"}," \
+    "\"x509Thumbprint\":{\"primaryThumbprint\":null,\"secondaryThumbprint\":null},\"type\":\"sas\"}"
+#define TEST_JSON_THUMBPRINT_AUTHENTICATION \
+    "\"authentication\":{\"symmetricKey\":{\"primaryKey\":null,\"secondaryKey\":null}," \
+    "\"x509Thumbprint\":{\"primaryThumbprint\":\"thePrimaryKey\",\"secondaryThumbprint\":\"theSecondaryKey\"},\"type\":\"selfSigned\"}"
+#define TEST_JSON_MODULE_ID "\"moduleId\":\"theModuleId\","
+#define TEST_JSON_MANAGED_BY "\"managedBy\":\"testManagedBy\","
+
+static const char* TEST_DEVICE_LIST_JSON_SAS = "[ {" TEST_JSON_COMMON_MEMBERS "," TEST_JSON_SAS_AUTHENTICATION "} ]";
+static const char* TEST_DEVICE_LIST_JSON_THUMBPRINT = "[ {" TEST_JSON_COMMON_MEMBERS "," TEST_JSON_THUMBPRINT_AUTHENTICATION "} ]";
+static const char* TEST_MODULE_LIST_JSON_SAS = "[ {" TEST_JSON_MODULE_ID TEST_JSON_COMMON_MEMBERS "," TEST_JSON_SAS_AUTHENTICATION "} ]";
+static const char* TEST_MODULE_LIST_JSON_SAS_MANAGED_BY = "[ {" TEST_JSON_MODULE_ID TEST_JSON_MANAGED_BY TEST_JSON_COMMON_MEMBERS "," TEST_JSON_SAS_AUTHENTICATION "} ]";
+
 static const char* TEST_HTTP_HEADER_KEY_AUTHORIZATION = "Authorization";
 static const char* TEST_HTTP_HEADER_VAL_AUTHORIZATION = " ";
 static const char* TEST_HTTP_HEADER_KEY_REQUEST_ID = "Request-Id";
@@ -652,7 +676,58 @@ static void setupHttpMockCalls(bool updateIfMatch, const unsigned int httpStatus
         .IgnoreArgument(1);
 }
 
-static void setupJsonParseDeviceMockCalls(bool fromDeviceList, IOTHUB_REGISTRYMANAGER_AUTH_METHOD authMethod, bool isModule, const char* managedBy)
+static void setupJsonParseDeviceListMockCalls(IOTHUB_REGISTRYMANAGER_AUTH_METHOD authMethod, bool isModule, const char* managedBy)
+{
+    const char* listJson;
+    if (isModule)
+    {
+        listJson = (managedBy != NULL) ? TEST_MODULE_LIST_JSON_SAS_MANAGED_BY : TEST_MODULE_LIST_JSON_SAS;
+    }
+    else if (authMethod == IOTHUB_REGISTRYMANAGER_AUTH_X509_THUMBPRINT)
+    {
+        listJson = TEST_DEVICE_LIST_JSON_THUMBPRINT;
+    }
+    else
+    {
+        listJson = TEST_DEVICE_LIST_JSON_SAS;
+    }
+
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .SetReturn((unsigned char*)listJson);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .SetReturn(strlen(listJson));
+
+    // One copy for each string member of the list entry, the rest of the response is read in place
+    int expectedMallocs = 12;
+    if (isModule)
+    {
+        expectedMallocs++;
+    }
+    if (managedBy != NULL)
+    {
+        expectedMallocs++;
+    }
+
+    for (int i = 0; i < expectedMallocs; i++)
+    {
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    }
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+
+    if (isModule == false)
+    {
+        // Free module specific members allocated by lower layer but not needed now.
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    }
+}
+
+static void setupJsonParseDeviceMockCalls(IOTHUB_REGISTRYMANAGER_AUTH_METHOD authMethod, bool isModule, const char* managedBy)
 {
     STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .IgnoreArgument(1)
@@ -697,20 +772,8 @@ static void setupJsonParseDeviceMockCalls(bool fromDeviceList, IOTHUB_REGISTRYMA
         .IgnoreArgument(1)
         .SetReturn(TEST_JSON_VALUE);
 
-    if (fromDeviceList == true)
-    {
-        STRICT_EXPECTED_CALL(json_value_get_array(TEST_JSON_VALUE))
-            .SetReturn(TEST_JSON_ARRAY);
-        STRICT_EXPECTED_CALL(json_array_get_count(TEST_JSON_ARRAY))
-            .SetReturn(1);
-        STRICT_EXPECTED_CALL(json_array_get_object(TEST_JSON_ARRAY, 0))
-            .SetReturn(TEST_JSON_OBJECT);
-    }
-    else
-    {
-        STRICT_EXPECTED_CALL(json_value_get_object(TEST_JSON_VALUE))
-            .SetReturn(TEST_JSON_OBJECT);
-    }
+    STRICT_EXPECTED_CALL(json_value_get_object(TEST_JSON_VALUE))
+        .SetReturn(TEST_JSON_OBJECT);
 
     STRICT_EXPECTED_CALL(json_object_get_string(TEST_JSON_OBJECT, TEST_DEVICE_JSON_KEY_DEVICE_NAME))
         .SetReturn(TEST_DEVICE_ID);
@@ -792,30 +855,8 @@ static void setupJsonParseDeviceMockCalls(bool fromDeviceList, IOTHUB_REGISTRYMA
             .IgnoreAllArguments();
     }
 
-    if (true == fromDeviceList)
-    {
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreAllArguments();
-
-        if (isModule == false)
-        {
-            // Free module specific members allocated by lower layer but not needed now.
-            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-        }
-
-        STRICT_EXPECTED_CALL(json_object_clear(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-
-        STRICT_EXPECTED_CALL(json_array_clear(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-    }
-    else
-    {
-        STRICT_EXPECTED_CALL(json_object_clear(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-    }
+    STRICT_EXPECTED_CALL(json_object_clear(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
 
     STRICT_EXPECTED_CALL(json_value_free(IGNORED_NUM_ARG))
         .IgnoreArgument(1);
@@ -2493,7 +2534,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
     {
         ///arrange
         setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
-        setupJsonParseDeviceMockCalls(false, authType, false, NULL);
+        setupJsonParseDeviceMockCalls(authType, false, NULL);
 
         STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
@@ -2530,7 +2571,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
     {
         ///arrange
         setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
-        setupJsonParseDeviceMockCalls(false, authType, false, NULL);
+        setupJsonParseDeviceMockCalls(authType, false, NULL);
 
         STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
@@ -2657,7 +2698,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
     {
         ///arrange
         setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
-        setupJsonParseDeviceMockCalls(false, authType, true, managedBy);
+        setupJsonParseDeviceMockCalls(authType, true, managedBy);
 
         STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
@@ -2716,7 +2757,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         ASSERT_ARE_EQUAL(int, 0, umockc_result);
 
         setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
-        setupJsonParseDeviceMockCalls(false, IOTHUB_REGISTRYMANAGER_AUTH_SPK, false, NULL);
+        setupJsonParseDeviceMockCalls(IOTHUB_REGISTRYMANAGER_AUTH_SPK, false, NULL);
 
         STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
@@ -2788,7 +2829,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         ASSERT_ARE_EQUAL(int, 0, umockc_result);
 
         setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
-        setupJsonParseDeviceMockCalls(false, IOTHUB_REGISTRYMANAGER_AUTH_SPK, false, NULL);
+        setupJsonParseDeviceMockCalls(IOTHUB_REGISTRYMANAGER_AUTH_SPK, false, NULL);
 
         STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
@@ -3704,7 +3745,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         umock_c_reset_all_calls();
 
         setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
-        setupJsonParseDeviceMockCalls(true, IOTHUB_REGISTRYMANAGER_AUTH_SPK, true, NULL);
+        setupJsonParseDeviceListMockCalls(IOTHUB_REGISTRYMANAGER_AUTH_SPK, true, NULL);
 
         STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
@@ -3794,8 +3835,8 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_066: [ IoTHubRegistryManager_GetDeviceList shall execute the HTTP GET request by calling HTTPAPIEX_ExecuteRequest ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_067: [ IoTHubRegistryManager_GetDeviceList shall verify the received HTTP status code and if it is greater than 300 then return IOTHUB_REGISTRYMANAGER_ERROR ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_068: [ IoTHubRegistryManager_GetDeviceList shall verify the received HTTP status code and if it is less or equal than 300 then try to parse the response JSON to deviceList ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_069: [ IoTHubRegistryManager_GetDeviceList shall use the following parson APIs to parse the response JSON: json_parse_string, json_value_get_object, json_object_get_string, json_object_dotget_string  ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If any of the parson API fails, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_069: [ IoTHubRegistryManager_GetDeviceList shall read the response JSON in a single pass with the service client JSON reader (sc_json_reader_init, sc_json_reader_next, sc_json_reader_skip) and copy the members of each device out of the response without building a JSON tree ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If the response is not a JSON array of objects, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_071: [ IoTHubRegistryManager_GetDeviceList shall populate the deviceList parameter with structures of type "IOTHUB_DEVICE" ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_072: [ If populating the deviceList parameter fails IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_ERROR ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_073: [ If populating the deviceList parameter successful IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_OK ]*/
@@ -3808,7 +3849,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         umock_c_reset_all_calls();
 
         setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
-        setupJsonParseDeviceMockCalls(true, IOTHUB_REGISTRYMANAGER_AUTH_SPK, false, NULL);
+        setupJsonParseDeviceListMockCalls(IOTHUB_REGISTRYMANAGER_AUTH_SPK, false, NULL);
 
         STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
@@ -3832,7 +3873,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         umock_c_reset_all_calls();
 
         setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
-        setupJsonParseDeviceMockCalls(true, IOTHUB_REGISTRYMANAGER_AUTH_X509_THUMBPRINT, false, NULL);
+        setupJsonParseDeviceListMockCalls(IOTHUB_REGISTRYMANAGER_AUTH_X509_THUMBPRINT, false, NULL);
 
         STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
@@ -3848,9 +3889,177 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         freeDeviceList(deviceList, IOTHUB_REGISTRYMANAGER_AUTH_X509_THUMBPRINT);
     }
 
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_069: [ IoTHubRegistryManager_GetDeviceList shall read the response JSON in a single pass with the service client JSON reader (sc_json_reader_init, sc_json_reader_next, sc_json_reader_skip) and copy the members of each device out of the response without building a JSON tree ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_071: [ IoTHubRegistryManager_GetDeviceList shall populate the deviceList parameter with structures of type "IOTHUB_DEVICE" ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_GetDeviceList_copies_device_members_from_the_response)
+    {
+        ///arrange
+        SINGLYLINKEDLIST_HANDLE deviceList = singlylinkedlist_create();
+        ASSERT_IS_NOT_NULL(deviceList);
+        umock_c_reset_all_calls();
+
+        setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
+        setupJsonParseDeviceListMockCalls(IOTHUB_REGISTRYMANAGER_AUTH_SPK, false, NULL);
+
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetDeviceList(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, 10, deviceList);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        LIST_ITEM_HANDLE itemHandle = singlylinkedlist_get_head_item(deviceList);
+        ASSERT_IS_NOT_NULL(itemHandle);
+        ASSERT_IS_NULL(singlylinkedlist_get_next_item(itemHandle));
+        IOTHUB_DEVICE* deviceInfo = (IOTHUB_DEVICE*)itemHandle->item;
+        ASSERT_ARE_EQUAL(char_ptr, TEST_DEVICE_ID, deviceInfo->deviceId);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_PRIMARYKEY, deviceInfo->primaryKey);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_SECONDARYKEY, deviceInfo->secondaryKey);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_GENERATIONID, deviceInfo->generationId);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_ETAG, deviceInfo->eTag);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_CONNECTIONSTATEUPDATEDTIME, deviceInfo->connectionStateUpdatedTime);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_STATUSREASON, deviceInfo->statusReason);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_STATUSUPDATEDTIME, deviceInfo->statusUpdatedTime);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_LASTACTIVITYTIME, deviceInfo->lastActivityTime);
+        ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_CONNECTION_STATE_CONNECTED, deviceInfo->connectionState);
+        ASSERT_ARE_EQUAL(int, IOTHUB_DEVICE_STATUS_ENABLED, deviceInfo->status);
+        ASSERT_ARE_EQUAL(size_t, 42, deviceInfo->cloudToDeviceMessageCount);
+        ASSERT_IS_TRUE(deviceInfo->isManaged);
+
+        ///cleanup
+        freeDeviceList(deviceList, IOTHUB_REGISTRYMANAGER_AUTH_SPK);
+    }
+
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_073: [ If populating the deviceList parameter successful IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_OK ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_GetDeviceList_empty_array_succeeds)
+    {
+        ///arrange
+        const char* listJson = " [ ] ";
+        SINGLYLINKEDLIST_HANDLE deviceList = singlylinkedlist_create();
+        ASSERT_IS_NOT_NULL(deviceList);
+        umock_c_reset_all_calls();
+
+        setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .SetReturn((unsigned char*)listJson);
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .SetReturn(strlen(listJson));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetDeviceList(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, 10, deviceList);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_OK, result);
+        ASSERT_IS_NULL(singlylinkedlist_get_head_item(deviceList));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        singlylinkedlist_destroy(deviceList);
+    }
+
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If the response is not a JSON array of objects, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_GetDeviceList_return_IOTHUB_REGISTRYMANAGER_JSON_ERROR_if_response_is_not_an_array)
+    {
+        ///arrange
+        const char* listJson = "{\"deviceId\":\"theDeviceId\"}";
+        SINGLYLINKEDLIST_HANDLE deviceList = singlylinkedlist_create();
+        ASSERT_IS_NOT_NULL(deviceList);
+        umock_c_reset_all_calls();
+
+        setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .SetReturn((unsigned char*)listJson);
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .SetReturn(strlen(listJson));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetDeviceList(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, 10, deviceList);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_JSON_ERROR, result);
+        ASSERT_IS_NULL(singlylinkedlist_get_head_item(deviceList));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        singlylinkedlist_destroy(deviceList);
+    }
+
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If the response is not a JSON array of objects, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_GetDeviceList_return_IOTHUB_REGISTRYMANAGER_JSON_ERROR_if_response_is_truncated)
+    {
+        ///arrange
+        const char* listJson = "[{\"deviceId\":\"theDeviceId\",\"etag\":";
+        SINGLYLINKEDLIST_HANDLE deviceList = singlylinkedlist_create();
+        ASSERT_IS_NOT_NULL(deviceList);
+        umock_c_reset_all_calls();
+
+        setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .SetReturn((unsigned char*)listJson);
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .SetReturn(strlen(listJson));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetDeviceList(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, 10, deviceList);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_JSON_ERROR, result);
+        ASSERT_IS_NULL(singlylinkedlist_get_head_item(deviceList));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        singlylinkedlist_destroy(deviceList);
+    }
+
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If the response is not a JSON array of objects, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ]*/
+    TEST_FUNCTION(IoTHubRegistryManager_GetDeviceList_return_IOTHUB_REGISTRYMANAGER_JSON_ERROR_if_response_is_not_an_array_of_objects)
+    {
+        ///arrange
+        const char* listJson = "[\"theDeviceId\"]";
+        SINGLYLINKEDLIST_HANDLE deviceList = singlylinkedlist_create();
+        ASSERT_IS_NOT_NULL(deviceList);
+        umock_c_reset_all_calls();
+
+        setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .SetReturn((unsigned char*)listJson);
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .SetReturn(strlen(listJson));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+
+        ///act
+        IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetDeviceList(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, 10, deviceList);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, IOTHUB_REGISTRYMANAGER_JSON_ERROR, result);
+        ASSERT_IS_NULL(singlylinkedlist_get_head_item(deviceList));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        singlylinkedlist_destroy(deviceList);
+    }
+
 
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_110: [ If the BUFFER_new fails, IoTHubRegistryManager_GetDeviceList shall do clean up and return NULL ]*/
-    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If any of the parson API fails, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ]*/
+    /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_070: [ If the response is not a JSON array of objects, IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_JSON_ERROR ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_072: [ If populating the deviceList parameter fails IoTHubRegistryManager_GetDeviceList shall return IOTHUB_REGISTRYMANAGER_ERROR ]*/
     /* Tests_SRS_IOTHUBREGISTRYMANAGER_12_115: [ If any of the HTTPAPI call fails IoTHubRegistryManager_GetDeviceList shall fail and return IOTHUB_REGISTRYMANAGER_ERROR ]*/
     TEST_FUNCTION(IoTHubRegistryManager_GetDeviceList_non_happy_path)
@@ -3860,7 +4069,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         ASSERT_ARE_EQUAL(int, 0, umockc_result);
 
         setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
-        setupJsonParseDeviceMockCalls(true, IOTHUB_REGISTRYMANAGER_AUTH_SPK, false, NULL);
+        setupJsonParseDeviceListMockCalls(IOTHUB_REGISTRYMANAGER_AUTH_SPK, false, NULL);
 
         STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
@@ -3887,33 +4096,10 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
                 (i != 16) && /*STRING_delete*/
                 (i != 17) && /*STRING_delete*/
                 (i != 18) && /*STRING_delete*/
-                (i != 22) && /*json_array_get_count*/
-                (i != 24) && /*json_object_get_string*/
-                (i != 25) && /*json_object_get_string*/
-                (i != 26) && /*json_object_dotget_string*/
-                (i != 27) && /*json_object_get_string*/
-                (i != 28) && /*json_object_get_string*/
-                (i != 29) && /*json_object_get_string*/
-                (i != 30) && /*json_object_get_string*/
-                (i != 31) && /*json_object_get_string*/
-                (i != 32) && /*json_object_get_string*/
-                (i != 33) && /*json_object_get_string*/
-                (i != 34) && /*json_object_get_string*/
-                (i != 35) && /*json_object_get_string*/
-                (i != 36) && /*json_object_get_string*/
-                (i != 37) && /*json_object_get_string*/
-                (i != 38) && /*json_object_get_string*/
-                (i != 39) && /*json_object_get_string*/
-                (i != 40) && /*json_object_dotget_string*/
-                (i != 41) && /*json_object_dotget_string*/
-                (i != 42) && /*json_object_dotget_string*/
-                (i != 43) && /*json_object_dotget_boolean*/
-                (i != 58) && /*free*/
-                (i != 59) && /*free*/
-                (i != 60) && /*json_object_clear*/
-                (i != 61) && /*json_array_clear*/
-                (i != 62) && /*json_value_free*/
-                (i != 63) /*BUFFER_delete*/
+                (i != 20) && /*BUFFER_length*/
+                (i != 35) && /*free*/
+                (i != 36) && /*free*/
+                (i != 37) /*BUFFER_delete*/
                 )
             {
                 IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetDeviceList(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, 10, deviceList);
@@ -3939,7 +4125,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         ASSERT_ARE_EQUAL(int, 0, umockc_result);
 
         setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
-        setupJsonParseDeviceMockCalls(true, IOTHUB_REGISTRYMANAGER_AUTH_SPK, true, NULL);
+        setupJsonParseDeviceListMockCalls(IOTHUB_REGISTRYMANAGER_AUTH_SPK, true, NULL);
 
         STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
@@ -3966,29 +4152,8 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
                 (i != 16) && /*STRING_delete*/
                 (i != 17) && /*STRING_delete*/
                 (i != 18) && /*STRING_delete*/
-                (i != 22) && /*json_array_get_count*/
-                (i != 24) && /*json_object_get_string*/
-                (i != 25) && /*json_object_get_string*/
-                (i != 26) && /*json_object_dotget_string*/
-                (i != 27) && /*json_object_get_string*/
-                (i != 28) && /*json_object_get_string*/
-                (i != 29) && /*json_object_get_string*/
-                (i != 30) && /*json_object_get_string*/
-                (i != 31) && /*json_object_get_string*/
-                (i != 32) && /*json_object_get_string*/
-                (i != 33) && /*json_object_get_string*/
-                (i != 34) && /*json_object_get_string*/
-                (i != 35) && /*json_object_get_string*/
-                (i != 36) && /*json_object_get_string*/
-                (i != 37) && /*json_object_get_string*/
-                (i != 38) && /*json_object_get_string*/
-                (i != 39) && /*json_object_get_string*/
-                (i != 40) && /*json_object_dotget_string*/
-                (i != 41) && /*json_object_dotget_string*/
-                (i != 42) && /*json_object_dotget_string*/
-                (i != 43) && /*json_object_dotget_boolean*/
-                (i != 61) && /*json_value_free*/
-                (i != 62) /*BUFFER_delete*/
+                (i != 20) && /*BUFFER_length*/
+                (i != 36) /*BUFFER_delete*/
                 )
             {
                 IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetModuleList(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_DEVICE_ID, moduleList, IOTHUB_MODULE_VERSION_1);
@@ -4015,7 +4180,7 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
         ASSERT_ARE_EQUAL(int, 0, umockc_result);
 
         setupHttpMockCalls(false, httpStatusCodeOk, HTTPAPI_REQUEST_GET);
-        setupJsonParseDeviceMockCalls(true, IOTHUB_REGISTRYMANAGER_AUTH_SPK, true, TEST_MANAGED_BY);
+        setupJsonParseDeviceListMockCalls(IOTHUB_REGISTRYMANAGER_AUTH_SPK, true, TEST_MANAGED_BY);
 
         STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
             .IgnoreArgument(1);
@@ -4042,30 +4207,8 @@ BEGIN_TEST_SUITE(iothub_registrymanager_ut)
                 (i != 16) && /*STRING_delete*/
                 (i != 17) && /*STRING_delete*/
                 (i != 18) && /*STRING_delete*/
-                (i != 22) && /*json_array_get_count*/
-                (i != 24) && /*json_object_get_string*/
-                (i != 25) && /*json_object_get_string*/
-                (i != 25) && /*json_object_get_string*/
-                (i != 26) && /*json_object_dotget_string*/
-                (i != 27) && /*json_object_get_string*/
-                (i != 28) && /*json_object_get_string*/
-                (i != 29) && /*json_object_get_string*/
-                (i != 30) && /*json_object_get_string*/
-                (i != 31) && /*json_object_get_string*/
-                (i != 32) && /*json_object_get_string*/
-                (i != 33) && /*json_object_get_string*/
-                (i != 34) && /*json_object_get_string*/
-                (i != 35) && /*json_object_get_string*/
-                (i != 36) && /*json_object_get_string*/
-                (i != 37) && /*json_object_get_string*/
-                (i != 38) && /*json_object_get_string*/
-                (i != 39) && /*json_object_get_string*/
-                (i != 40) && /*json_object_dotget_string*/
-                (i != 41) && /*json_object_dotget_string*/
-                (i != 42) && /*json_object_dotget_string*/
-                (i != 43) && /*json_object_dotget_boolean*/
-                (i != 62) && /*json_value_free*/
-                (i != 63) /*BUFFER_delete*/
+                (i != 20) && /*BUFFER_length*/
+                (i != 37) /*BUFFER_delete*/
                 )
             {
                 IOTHUB_REGISTRYMANAGER_RESULT result = IoTHubRegistryManager_GetModuleList(TEST_IOTHUB_REGISTRYMANAGER_HANDLE, TEST_DEVICE_ID, moduleList, IOTHUB_MODULE_VERSION_1);
@@ -0,0 +1,544 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Replaces the connection, session and link layers of uAMQP with an in-process hub, so that the
+// benchmark measures the messaging client and not the network. The AMQP values and messages are the
+// real ones of uAMQP. Like the message sender of uAMQP, the sink keeps its own copy of every message
+// handed to it until the message is settled, and only puts link_credit messages on the wire at a
+// time; each of them is settled with MESSAGE_SEND_OK settle_latency_ms after it went on the wire.
+// Settlements are reported from connection_dowork, as uAMQP does.
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/xio.h"
+#include "azure_c_shared_utility/tickcounter.h"
+
+#include "azure_uamqp_c/amqpvalue.h"
+#include "azure_uamqp_c/amqp_definitions.h"
+#include "azure_uamqp_c/message.h"
+#include "azure_uamqp_c/connection.h"
+#include "azure_uamqp_c/session.h"
+#include "azure_uamqp_c/link.h"
+#include "azure_uamqp_c/message_sender.h"
+#include "azure_uamqp_c/message_receiver.h"
+#include "azure_uamqp_c/sasl_mechanism.h"
+#include "azure_uamqp_c/sasl_plain.h"
+#include "azure_uamqp_c/saslclientio.h"
+
+#include "amqp_sink_stub.h"
+
+typedef struct SINK_DELIVERY_TAG
+{
+    MESSAGE_HANDLE message;
+    ON_MESSAGE_SEND_COMPLETE on_message_send_complete;
+    void* callback_context;
+    tickcounter_ms_t sent_at;
+    struct SINK_DELIVERY_TAG* next;
+} SINK_DELIVERY;
+
+typedef struct SINK_SENDER_TAG
+{
+    ON_MESSAGE_SENDER_STATE_CHANGED on_state_changed;
+    void* context;
+    bool opening;
+} SINK_SENDER;
+
+typedef struct SINK_RECEIVER_TAG
+{
+    ON_MESSAGE_RECEIVER_STATE_CHANGED on_state_changed;
+    const void* context;
+    bool opening;
+} SINK_RECEIVER;
+
+typedef struct SINK_HANDLE_TAG
+{
+    int unused;
+} SINK_HANDLE;
+
+static AMQP_SINK_STUB_CONFIG g_config;
+static TICK_COUNTER_HANDLE g_tick_counter;
+
+static SINK_SENDER* g_sender;
+static SINK_RECEIVER* g_receiver;
+
+// Messages held by the sender: waiting for credit, then on the wire until settled
+static SINK_DELIVERY* g_waiting_head;
+static SINK_DELIVERY* g_waiting_tail;
+static SINK_DELIVERY* g_wire_head;
+static SINK_DELIVERY* g_wire_tail;
+static size_t g_waiting_count;
+static size_t g_wire_count;
+
+static size_t g_delivery_count;
+static size_t g_peak_queue_depth;
+static size_t g_encoded_bytes;
+
+static SASL_MECHANISM_INTERFACE_DESCRIPTION g_sasl_plain_interface;
+
+int amqp_sink_stub_init(const AMQP_SINK_STUB_CONFIG* config)
+{
+    int result;
+
+    if ((g_tick_counter = tickcounter_create()) == NULL)
+    {
+        LogError("tickcounter_create failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        g_config = *config;
+        result = 0;
+    }
+
+    return result;
+}
+
+void amqp_sink_stub_deinit(void)
+{
+    if (g_tick_counter != NULL)
+    {
+        tickcounter_destroy(g_tick_counter);
+        g_tick_counter = NULL;
+    }
+}
+
+void amqp_sink_stub_reset_counters(void)
+{
+    g_delivery_count = 0;
+    g_peak_queue_depth = 0;
+    g_encoded_bytes = 0;
+}
+
+size_t amqp_sink_stub_get_delivery_count(void)
+{
+    return g_delivery_count;
+}
+
+size_t amqp_sink_stub_get_peak_queue_depth(void)
+{
+    return g_peak_queue_depth;
+}
+
+size_t amqp_sink_stub_get_encoded_bytes(void)
+{
+    return g_encoded_bytes;
+}
+
+static void append_delivery(SINK_DELIVERY** head, SINK_DELIVERY** tail, SINK_DELIVERY* delivery)
+{
+    delivery->next = NULL;
+    if (*tail == NULL)
+    {
+        *head = delivery;
+    }
+    else
+    {
+        (*tail)->next = delivery;
+    }
+    *tail = delivery;
+}
+
+static SINK_DELIVERY* remove_first_delivery(SINK_DELIVERY** head, SINK_DELIVERY** tail)
+{
+    SINK_DELIVERY* result = *head;
+
+    if (result != NULL)
+    {
+        *head = result->next;
+        if (*head == NULL)
+        {
+            *tail = NULL;
+        }
+    }
+    return result;
+}
+
+static void settle_delivery(SINK_DELIVERY* delivery, MESSAGE_SEND_RESULT send_result)
+{
+    delivery->on_message_send_complete(delivery->callback_context, send_result, NULL);
+    message_destroy(delivery->message);
+    free(delivery);
+}
+
+// What the message sender of uAMQP walks through to encode a message for a transfer
+static size_t get_encoded_message_size(MESSAGE_HANDLE message)
+{
+    size_t result = 0;
+    size_t section_size;
+    PROPERTIES_HANDLE properties;
+    AMQP_VALUE application_properties;
+    BINARY_DATA body;
+
+    if (message_get_properties(message, &properties) == 0 && properties != NULL)
+    {
+        AMQP_VALUE properties_value = amqpvalue_create_properties(properties);
+        if (properties_value != NULL)
+        {
+            if (amqpvalue_get_encoded_size(properties_value, &section_size) == 0)
+            {
+                result += section_size;
+            }
+            amqpvalue_destroy(properties_value);
+        }
+        properties_destroy(properties);
+    }
+
+    if (message_get_application_properties(message, &application_properties) == 0 && application_properties != NULL)
+    {
+        if (amqpvalue_get_encoded_size(application_properties, &section_size) == 0)
+        {
+            result += section_size;
+        }
+        amqpvalue_destroy(application_properties);
+    }
+
+    if (message_get_body_amqp_data_in_place(message, 0, &body) == 0)
+    {
+        result += body.length;
+    }
+
+    return result;
+}
+
+CONNECTION_HANDLE connection_create(XIO_HANDLE io, const char* hostname, const char* container_id, ON_NEW_ENDPOINT on_new_endpoint, void* callback_context)
+{
+    (void)io;
+    (void)hostname;
+    (void)container_id;
+    (void)on_new_endpoint;
+    (void)callback_context;
+    return (CONNECTION_HANDLE)malloc(sizeof(SINK_HANDLE));
+}
+
+void connection_destroy(CONNECTION_HANDLE connection)
+{
+    free(connection);
+}
+
+void connection_dowork(CONNECTION_HANDLE connection)
+{
+    tickcounter_ms_t now;
+
+    (void)connection;
+
+    // The hub attaches both links on the first pass
+    if (g_sender != NULL && g_sender->opening)
+    {
+        g_sender->opening = false;
+        g_sender->on_state_changed(g_sender->context, MESSAGE_SENDER_STATE_OPEN, MESSAGE_SENDER_STATE_OPENING);
+    }
+    if (g_receiver != NULL && g_receiver->opening)
+    {
+        g_receiver->opening = false;
+        g_receiver->on_state_changed(g_receiver->context, MESSAGE_RECEIVER_STATE_OPEN, MESSAGE_RECEIVER_STATE_OPENING);
+    }
+
+    (void)tickcounter_get_current_ms(g_tick_counter, &now);
+
+    while (g_wire_head != NULL && now - g_wire_head->sent_at >= g_config.settle_latency_ms)
+    {
+        SINK_DELIVERY* delivery = remove_first_delivery(&g_wire_head, &g_wire_tail);
+        g_wire_count--;
+        g_delivery_count++;
+        settle_delivery(delivery, MESSAGE_SEND_OK);
+    }
+
+    while (g_waiting_head != NULL && g_wire_count < g_config.link_credit)
+    {
+        SINK_DELIVERY* delivery = remove_first_delivery(&g_waiting_head, &g_waiting_tail);
+        g_waiting_count--;
+        delivery->sent_at = now;
+        append_delivery(&g_wire_head, &g_wire_tail, delivery);
+        g_wire_count++;
+    }
+}
+
+SESSION_HANDLE session_create(CONNECTION_HANDLE connection, ON_LINK_ATTACHED on_link_attached, void* callback_context)
+{
+    (void)connection;
+    (void)on_link_attached;
+    (void)callback_context;
+    return (SESSION_HANDLE)malloc(sizeof(SINK_HANDLE));
+}
+
+void session_destroy(SESSION_HANDLE session)
+{
+    free(session);
+}
+
+int session_set_incoming_window(SESSION_HANDLE session, uint32_t incoming_window)
+{
+    (void)session;
+    (void)incoming_window;
+    return 0;
+}
+
+int session_set_outgoing_window(SESSION_HANDLE session, uint32_t outgoing_window)
+{
+    (void)session;
+    (void)outgoing_window;
+    return 0;
+}
+
+LINK_HANDLE link_create(SESSION_HANDLE session, const char* name, role role, AMQP_VALUE source, AMQP_VALUE target)
+{
+    (void)session;
+    (void)name;
+    (void)role;
+    (void)source;
+    (void)target;
+    return (LINK_HANDLE)malloc(sizeof(SINK_HANDLE));
+}
+
+void link_destroy(LINK_HANDLE link)
+{
+    free(link);
+}
+
+int link_set_snd_settle_mode(LINK_HANDLE link, sender_settle_mode snd_settle_mode)
+{
+    (void)link;
+    (void)snd_settle_mode;
+    return 0;
+}
+
+int link_set_rcv_settle_mode(LINK_HANDLE link, receiver_settle_mode rcv_settle_mode)
+{
+    (void)link;
+    (void)rcv_settle_mode;
+    return 0;
+}
+
+int link_set_attach_properties(LINK_HANDLE link, fields attach_properties)
+{
+    (void)link;
+    (void)attach_properties;
+    return 0;
+}
+
+MESSAGE_SENDER_HANDLE messagesender_create(LINK_HANDLE link, ON_MESSAGE_SENDER_STATE_CHANGED on_message_sender_state_changed, void* context)
+{
+    SINK_SENDER* result;
+
+    (void)link;
+    if ((result = (SINK_SENDER*)malloc(sizeof(SINK_SENDER))) == NULL)
+    {
+        LogError("malloc failed");
+    }
+    else
+    {
+        result->on_state_changed = on_message_sender_state_changed;
+        result->context = context;
+        result->opening = false;
+        g_sender = result;
+    }
+
+    return (MESSAGE_SENDER_HANDLE)result;
+}
+
+void messagesender_destroy(MESSAGE_SENDER_HANDLE message_sender)
+{
+    SINK_DELIVERY* delivery;
+
+    // As uAMQP does, every message the sender still holds is failed
+    while ((delivery = remove_first_delivery(&g_wire_head, &g_wire_tail)) != NULL)
+    {
+        settle_delivery(delivery, MESSAGE_SEND_ERROR);
+    }
+    while ((delivery = remove_first_delivery(&g_waiting_head, &g_waiting_tail)) != NULL)
+    {
+        settle_delivery(delivery, MESSAGE_SEND_ERROR);
+    }
+    g_wire_count = 0;
+    g_waiting_count = 0;
+
+    if ((SINK_SENDER*)message_sender == g_sender)
+    {
+        g_sender = NULL;
+    }
+    free(message_sender);
+}
+
+int messagesender_open(MESSAGE_SENDER_HANDLE message_sender)
+{
+    SINK_SENDER* sender = (SINK_SENDER*)message_sender;
+
+    sender->opening = true;
+    sender->on_state_changed(sender->context, MESSAGE_SENDER_STATE_OPENING, MESSAGE_SENDER_STATE_IDLE);
+    return 0;
+}
+
+ASYNC_OPERATION_HANDLE messagesender_send_async(MESSAGE_SENDER_HANDLE message_sender, MESSAGE_HANDLE message, ON_MESSAGE_SEND_COMPLETE on_message_send_complete, void* callback_context, tickcounter_ms_t timeout)
+{
+    SINK_DELIVERY* result;
+
+    (void)message_sender;
+    (void)timeout;
+
+    if ((result = (SINK_DELIVERY*)malloc(sizeof(SINK_DELIVERY))) == NULL)
+    {
+        LogError("malloc failed");
+    }
+    else if ((result->message = message_clone(message)) == NULL)
+    {
+        LogError("message_clone failed");
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        result->on_message_send_complete = on_message_send_complete;
+        result->callback_context = callback_context;
+        result->sent_at = 0;
+        g_encoded_bytes += get_encoded_message_size(result->message);
+
+        append_delivery(&g_waiting_head, &g_waiting_tail, result);
+        g_waiting_count++;
+        if (g_waiting_count + g_wire_count > g_peak_queue_depth)
+        {
+            g_peak_queue_depth = g_waiting_count + g_wire_count;
+        }
+    }
+
+    // The messaging client only checks the operation against NULL, it never cancels it
+    return (ASYNC_OPERATION_HANDLE)result;
+}
+
+MESSAGE_RECEIVER_HANDLE messagereceiver_create(LINK_HANDLE link, ON_MESSAGE_RECEIVER_STATE_CHANGED on_message_receiver_state_changed, void* context)
+{
+    SINK_RECEIVER* result;
+
+    (void)link;
+    if ((result = (SINK_RECEIVER*)malloc(sizeof(SINK_RECEIVER))) == NULL)
+    {
+        LogError("malloc failed");
+    }
+    else
+    {
+        result->on_state_changed = on_message_receiver_state_changed;
+        result->context = context;
+        result->opening = false;
+        g_receiver = result;
+    }
+
+    return (MESSAGE_RECEIVER_HANDLE)result;
+}
+
+void messagereceiver_destroy(MESSAGE_RECEIVER_HANDLE message_receiver)
+{
+    if ((SINK_RECEIVER*)message_receiver == g_receiver)
+    {
+        g_receiver = NULL;
+    }
+    free(message_receiver);
+}
+
+int messagereceiver_open(MESSAGE_RECEIVER_HANDLE message_receiver, ON_MESSAGE_RECEIVED on_message_received, void* callback_context)
+{
+    SINK_RECEIVER* receiver = (SINK_RECEIVER*)message_receiver;
+
+    // No feedback is sent by the sink
+    (void)on_message_received;
+    (void)callback_context;
+    receiver->opening = true;
+    receiver->on_state_changed(receiver->context, MESSAGE_RECEIVER_STATE_OPENING, MESSAGE_RECEIVER_STATE_IDLE);
+    return 0;
+}
+
+SASL_MECHANISM_HANDLE saslmechanism_create(const SASL_MECHANISM_INTERFACE_DESCRIPTION* sasl_mechanism_interface_description, void* sasl_mechanism_create_parameters)
+{
+    (void)sasl_mechanism_interface_description;
+    (void)sasl_mechanism_create_parameters;
+    return (SASL_MECHANISM_HANDLE)malloc(sizeof(SINK_HANDLE));
+}
+
+void saslmechanism_destroy(SASL_MECHANISM_HANDLE sasl_mechanism)
+{
+    free(sasl_mechanism);
+}
+
+const SASL_MECHANISM_INTERFACE_DESCRIPTION* saslplain_get_interface(void)
+{
+    return &g_sasl_plain_interface;
+}
+
+// xio_create only accepts an interface that implements every call
+static OPTIONHANDLER_HANDLE sink_io_retrieveoptions(CONCRETE_IO_HANDLE io)
+{
+    (void)io;
+    return NULL;
+}
+
+static CONCRETE_IO_HANDLE sink_io_create(void* io_create_parameters)
+{
+    (void)io_create_parameters;
+    return (CONCRETE_IO_HANDLE)malloc(sizeof(SINK_HANDLE));
+}
+
+static void sink_io_destroy(CONCRETE_IO_HANDLE io)
+{
+    free(io);
+}
+
+static int sink_io_open(CONCRETE_IO_HANDLE io, ON_IO_OPEN_COMPLETE on_io_open_complete, void* on_io_open_complete_context, ON_BYTES_RECEIVED on_bytes_received, void* on_bytes_received_context, ON_IO_ERROR on_io_error, void* on_io_error_context)
+{
+    (void)io;
+    (void)on_io_open_complete;
+    (void)on_io_open_complete_context;
+    (void)on_bytes_received;
+    (void)on_bytes_received_context;
+    (void)on_io_error;
+    (void)on_io_error_context;
+    return 0;
+}
+
+static int sink_io_close(CONCRETE_IO_HANDLE io, ON_IO_CLOSE_COMPLETE on_io_close_complete, void* callback_context)
+{
+    (void)io;
+    (void)on_io_close_complete;
+    (void)callback_context;
+    return 0;
+}
+
+static int sink_io_send(CONCRETE_IO_HANDLE io, const void* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    (void)io;
+    (void)buffer;
+    (void)size;
+    (void)on_send_complete;
+    (void)callback_context;
+    return 0;
+}
+
+static void sink_io_dowork(CONCRETE_IO_HANDLE io)
+{
+    (void)io;
+}
+
+static int sink_io_setoption(CONCRETE_IO_HANDLE io, const char* optionName, const void* value)
+{
+    (void)io;
+    (void)optionName;
+    (void)value;
+    return 0;
+}
+
+static const IO_INTERFACE_DESCRIPTION g_sink_io_interface =
+{
+    sink_io_retrieveoptions,
+    sink_io_create,
+    sink_io_destroy,
+    sink_io_open,
+    sink_io_close,
+    sink_io_send,
+    sink_io_dowork,
+    sink_io_setoption
+};
+
+const IO_INTERFACE_DESCRIPTION* saslclientio_get_interface_description(void)
+{
+    return &g_sink_io_interface;
+}
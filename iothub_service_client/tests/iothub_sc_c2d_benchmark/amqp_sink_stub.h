@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef AMQP_SINK_STUB_H
+#define AMQP_SINK_STUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct AMQP_SINK_STUB_CONFIG_TAG
+{
+    // Messages the hub lets on the wire at once, as the link credit it grants
+    uint32_t link_credit;
+    // Time between a message going on the wire and its disposition coming back
+    uint32_t settle_latency_ms;
+} AMQP_SINK_STUB_CONFIG;
+
+int amqp_sink_stub_init(const AMQP_SINK_STUB_CONFIG* config);
+void amqp_sink_stub_deinit(void);
+void amqp_sink_stub_reset_counters(void);
+size_t amqp_sink_stub_get_delivery_count(void);
+size_t amqp_sink_stub_get_peak_queue_depth(void);
+size_t amqp_sink_stub_get_encoded_bytes(void);
+
+#endif // AMQP_SINK_STUB_H
@@ -0,0 +1,285 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Measures how fast one cloud to device message reaches DEVICE_COUNT devices, once with a call of
+// IoTHubMessaging_LL_Send per device and once with IoTHubMessaging_LL_SendMany under different
+// in-flight windows. The hub is replaced by the in-process uAMQP links of amqp_sink_stub.c, which grant
+// LINK_CREDIT messages at a time and settle each of them SETTLE_LATENCY_MS after it went on the wire.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/platform.h"
+
+#include "iothub_message.h"
+#include "iothub_service_client_auth.h"
+#include "iothub_messaging_ll.h"
+
+#include "amqp_sink_stub.h"
+
+#define DEVICE_COUNT            2000
+#define DEVICE_ID_LENGTH        32
+#define LINK_CREDIT             50
+#define SETTLE_LATENCY_MS       20
+#define OPEN_TIMEOUT_MS         5000
+#define SEND_TIMEOUT_MS         120000
+
+static const char* CONNECTION_STRING = "HostName=benchmark.azure-devices.net;SharedAccessKeyName=iothubowner;SharedAccessKey=YmVuY2htYXJrIHNoYXJlZCBhY2Nlc3Mga2V5IDAxMjM0NTY=";
+static const char* MESSAGE_PAYLOAD = "{\"command\":\"firmwareUpdate\",\"version\":\"1.2.3\"}";
+
+static char g_device_id_storage[DEVICE_COUNT][DEVICE_ID_LENGTH];
+static const char* g_device_ids[DEVICE_COUNT];
+
+typedef struct SEND_PROGRESS_TAG
+{
+    size_t completed_count;
+    size_t succeeded_count;
+} SEND_PROGRESS;
+
+static void on_open_complete(void* context)
+{
+    *(int*)context = 1;
+}
+
+static void on_send_complete(void* context, IOTHUB_MESSAGING_RESULT messagingResult)
+{
+    SEND_PROGRESS* progress = (SEND_PROGRESS*)context;
+
+    progress->completed_count++;
+    if (messagingResult == IOTHUB_MESSAGING_OK)
+    {
+        progress->succeeded_count++;
+    }
+}
+
+static void on_send_many_complete(void* context, size_t index, IOTHUB_MESSAGING_RESULT messagingResult)
+{
+    (void)index;
+    on_send_complete(context, messagingResult);
+}
+
+static int send_one_by_one(IOTHUB_MESSAGING_HANDLE messaging, IOTHUB_MESSAGE_HANDLE message, SEND_PROGRESS* progress)
+{
+    int result = 0;
+    size_t i;
+
+    for (i = 0; i < DEVICE_COUNT && result == 0; i++)
+    {
+        if (IoTHubMessaging_LL_Send(messaging, g_device_ids[i], message, on_send_complete, progress) != IOTHUB_MESSAGING_OK)
+        {
+            LogError("IoTHubMessaging_LL_Send failed");
+            result = MU_FAILURE;
+        }
+    }
+
+    return result;
+}
+
+static int send_many(IOTHUB_MESSAGING_HANDLE messaging, IOTHUB_MESSAGE_HANDLE message, SEND_PROGRESS* progress)
+{
+    int result;
+
+    if (IoTHubMessaging_LL_SendMany(messaging, g_device_ids, DEVICE_COUNT, message, on_send_many_complete, progress) != IOTHUB_MESSAGING_OK)
+    {
+        LogError("IoTHubMessaging_LL_SendMany failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+typedef struct BENCHMARK_SCENARIO_TAG
+{
+    const char* name;
+    size_t max_messages_in_flight;
+    int (*send)(IOTHUB_MESSAGING_HANDLE messaging, IOTHUB_MESSAGE_HANDLE message, SEND_PROGRESS* progress);
+} BENCHMARK_SCENARIO;
+
+static int open_messaging(IOTHUB_MESSAGING_HANDLE messaging, TICK_COUNTER_HANDLE tick_counter)
+{
+    int result;
+    int is_open = 0;
+
+    if (IoTHubMessaging_LL_Open(messaging, on_open_complete, &is_open) != IOTHUB_MESSAGING_OK)
+    {
+        LogError("IoTHubMessaging_LL_Open failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        tickcounter_ms_t start_ms;
+        tickcounter_ms_t now_ms;
+
+        (void)tickcounter_get_current_ms(tick_counter, &start_ms);
+        now_ms = start_ms;
+        while (!is_open && now_ms - start_ms < OPEN_TIMEOUT_MS)
+        {
+            IoTHubMessaging_LL_DoWork(messaging);
+            (void)tickcounter_get_current_ms(tick_counter, &now_ms);
+        }
+
+        if (!is_open)
+        {
+            LogError("Messaging did not open in time");
+            IoTHubMessaging_LL_Close(messaging);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int run_scenario(IOTHUB_SERVICE_CLIENT_AUTH_HANDLE service_client, TICK_COUNTER_HANDLE tick_counter, IOTHUB_MESSAGE_HANDLE message, const BENCHMARK_SCENARIO* scenario)
+{
+    int result;
+    IOTHUB_MESSAGING_HANDLE messaging;
+
+    if ((messaging = IoTHubMessaging_LL_Create(service_client)) == NULL)
+    {
+        LogError("IoTHubMessaging_LL_Create failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (open_messaging(messaging, tick_counter) != 0)
+        {
+            result = MU_FAILURE;
+        }
+        else
+        {
+            if (scenario->max_messages_in_flight > 0 && IoTHubMessaging_LL_SetMaxMessagesInFlight(messaging, scenario->max_messages_in_flight) != IOTHUB_MESSAGING_OK)
+            {
+                LogError("IoTHubMessaging_LL_SetMaxMessagesInFlight failed");
+                result = MU_FAILURE;
+            }
+            else
+            {
+                tickcounter_ms_t start_ms;
+                tickcounter_ms_t end_ms;
+                SEND_PROGRESS progress = { 0, 0 };
+
+                amqp_sink_stub_reset_counters();
+                (void)tickcounter_get_current_ms(tick_counter, &start_ms);
+
+                result = scenario->send(messaging, message, &progress);
+
+                end_ms = start_ms;
+                while (result == 0 && progress.completed_count < DEVICE_COUNT && end_ms - start_ms < SEND_TIMEOUT_MS)
+                {
+                    IoTHubMessaging_LL_DoWork(messaging);
+                    ThreadAPI_Sleep(1);
+                    (void)tickcounter_get_current_ms(tick_counter, &end_ms);
+                }
+
+                if (result == 0)
+                {
+                    tickcounter_ms_t elapsed_ms = (end_ms > start_ms) ? (end_ms - start_ms) : 1;
+
+                    (void)printf("%-40s %8lu ms %10.1f messages/s %6lu peak queued %10lu bytes %6lu succeeded\r\n", scenario->name,
+                        (unsigned long)elapsed_ms, (double)DEVICE_COUNT * 1000.0 / (double)elapsed_ms,
+                        (unsigned long)amqp_sink_stub_get_peak_queue_depth(), (unsigned long)amqp_sink_stub_get_encoded_bytes(),
+                        (unsigned long)progress.succeeded_count);
+                }
+            }
+
+            IoTHubMessaging_LL_Close(messaging);
+        }
+
+        IoTHubMessaging_LL_Destroy(messaging);
+    }
+
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    int result;
+
+    (void)argc;
+
+    if (platform_init() != 0)
+    {
+        LogError("platform_init failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        AMQP_SINK_STUB_CONFIG sink_config = { LINK_CREDIT, SETTLE_LATENCY_MS };
+
+        if (amqp_sink_stub_init(&sink_config) != 0)
+        {
+            result = MU_FAILURE;
+        }
+        else
+        {
+            IOTHUB_SERVICE_CLIENT_AUTH_HANDLE service_client;
+            TICK_COUNTER_HANDLE tick_counter;
+            IOTHUB_MESSAGE_HANDLE message;
+
+            if ((service_client = IoTHubServiceClientAuth_CreateFromConnectionString(CONNECTION_STRING)) == NULL)
+            {
+                LogError("IoTHubServiceClientAuth_CreateFromConnectionString failed");
+                result = MU_FAILURE;
+            }
+            else if ((tick_counter = tickcounter_create()) == NULL)
+            {
+                LogError("tickcounter_create failed");
+                IoTHubServiceClientAuth_Destroy(service_client);
+                result = MU_FAILURE;
+            }
+            else if ((message = IoTHubMessage_CreateFromString(MESSAGE_PAYLOAD)) == NULL)
+            {
+                LogError("IoTHubMessage_CreateFromString failed");
+                tickcounter_destroy(tick_counter);
+                IoTHubServiceClientAuth_Destroy(service_client);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                const BENCHMARK_SCENARIO scenarios[] =
+                {
+                    { "IoTHubMessaging_LL_Send per device", 0, send_one_by_one },
+                    { "IoTHubMessaging_LL_SendMany, no window", 0, send_many },
+                    { "IoTHubMessaging_LL_SendMany, window 200", 200, send_many },
+                    { "IoTHubMessaging_LL_SendMany, window 50", LINK_CREDIT, send_many }
+                };
+                size_t i;
+
+                for (i = 0; i < DEVICE_COUNT; i++)
+                {
+                    (void)snprintf(g_device_id_storage[i], DEVICE_ID_LENGTH, "device%04lu", (unsigned long)i);
+                    g_device_ids[i] = g_device_id_storage[i];
+                }
+
+                (void)printf("%s: %d devices, link credit %d, settle latency %d ms\r\n", argv[0], DEVICE_COUNT, LINK_CREDIT, SETTLE_LATENCY_MS);
+
+                result = 0;
+                for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]) && result == 0; i++)
+                {
+                    result = run_scenario(service_client, tick_counter, message, &scenarios[i]);
+                }
+
+                IoTHubMessage_Destroy(message);
+                tickcounter_destroy(tick_counter);
+                IoTHubServiceClientAuth_Destroy(service_client);
+            }
+
+            amqp_sink_stub_deinit();
+        }
+
+        platform_deinit();
+    }
+
+    return result;
+}
@@ -0,0 +1,175 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Replaces the HTTPAPI layer under HTTPAPIEX with an in-process hub, so that the benchmark measures the
+// service client and not the network. Opening a connection costs CONNECT_DELAY_MS, as the TCP and TLS
+// handshakes with a hub would, and every request costs REQUEST_LATENCY_MS. Every request is answered
+// with 200 and a direct method response.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/httpapi.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#include "httpapi_stub.h"
+
+#define CONNECT_DELAY_MS        50
+#define REQUEST_LATENCY_MS      10
+
+static const char* METHOD_RESPONSE = "{\"status\":200,\"payload\":{\"result\":\"ok\"}}";
+
+typedef struct HTTP_HANDLE_DATA_TAG
+{
+    int isConnected;
+} HTTP_HANDLE_DATA;
+
+static LOCK_HANDLE g_counters_lock;
+static size_t g_connection_count;
+static size_t g_request_count;
+
+static void increment_counter(size_t* counter)
+{
+    if (g_counters_lock != NULL && Lock(g_counters_lock) == LOCK_OK)
+    {
+        (*counter)++;
+        (void)Unlock(g_counters_lock);
+    }
+}
+
+int httpapi_stub_init(void)
+{
+    int result;
+
+    if ((g_counters_lock = Lock_Init()) == NULL)
+    {
+        LogError("Lock_Init failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+void httpapi_stub_deinit(void)
+{
+    if (g_counters_lock != NULL)
+    {
+        (void)Lock_Deinit(g_counters_lock);
+        g_counters_lock = NULL;
+    }
+}
+
+void httpapi_stub_reset_counters(void)
+{
+    g_connection_count = 0;
+    g_request_count = 0;
+}
+
+size_t httpapi_stub_get_connection_count(void)
+{
+    return g_connection_count;
+}
+
+size_t httpapi_stub_get_request_count(void)
+{
+    return g_request_count;
+}
+
+HTTPAPI_RESULT HTTPAPI_Init(void)
+{
+    return HTTPAPI_OK;
+}
+
+void HTTPAPI_Deinit(void)
+{
+}
+
+HTTP_HANDLE HTTPAPI_CreateConnection(const char* hostName)
+{
+    HTTP_HANDLE_DATA* result;
+
+    (void)hostName;
+    if ((result = (HTTP_HANDLE_DATA*)malloc(sizeof(HTTP_HANDLE_DATA))) == NULL)
+    {
+        LogError("malloc failed");
+    }
+    else
+    {
+        result->isConnected = 0;
+    }
+
+    return result;
+}
+
+void HTTPAPI_CloseConnection(HTTP_HANDLE handle)
+{
+    free(handle);
+}
+
+HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, const unsigned char* content,
+    size_t contentLength, unsigned int* statusCode,
+    HTTP_HEADERS_HANDLE responseHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    HTTPAPI_RESULT result;
+
+    (void)requestType;
+    (void)relativePath;
+    (void)httpHeadersHandle;
+    (void)content;
+    (void)contentLength;
+    (void)responseHeadersHandle;
+
+    if (handle == NULL || statusCode == NULL)
+    {
+        result = HTTPAPI_INVALID_ARG;
+    }
+    else
+    {
+        // Like the TLS based HTTPAPI, the connection is opened by its first request
+        if (!handle->isConnected)
+        {
+            ThreadAPI_Sleep(CONNECT_DELAY_MS);
+            handle->isConnected = 1;
+            increment_counter(&g_connection_count);
+        }
+
+        ThreadAPI_Sleep(REQUEST_LATENCY_MS);
+        increment_counter(&g_request_count);
+
+        if (responseContent != NULL && BUFFER_build(responseContent, (const unsigned char*)METHOD_RESPONSE, strlen(METHOD_RESPONSE)) != 0)
+        {
+            result = HTTPAPI_ALLOC_FAILED;
+        }
+        else
+        {
+            *statusCode = 200;
+            result = HTTPAPI_OK;
+        }
+    }
+
+    return result;
+}
+
+HTTPAPI_RESULT HTTPAPI_SetOption(HTTP_HANDLE handle, const char* optionName, const void* value)
+{
+    (void)handle;
+    (void)optionName;
+    (void)value;
+    return HTTPAPI_OK;
+}
+
+HTTPAPI_RESULT HTTPAPI_CloneOption(const char* optionName, const void* value, const void** savedValue)
+{
+    (void)optionName;
+    (void)value;
+    (void)savedValue;
+    return HTTPAPI_INVALID_ARG;
+}
@@ -0,0 +1,15 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef HTTPAPI_STUB_H
+#define HTTPAPI_STUB_H
+
+#include <stddef.h>
+
+int httpapi_stub_init(void);
+void httpapi_stub_deinit(void);
+void httpapi_stub_reset_counters(void);
+size_t httpapi_stub_get_connection_count(void);
+size_t httpapi_stub_get_request_count(void);
+
+#endif // HTTPAPI_STUB_H
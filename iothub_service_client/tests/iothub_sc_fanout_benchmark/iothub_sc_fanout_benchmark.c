@@ -0,0 +1,209 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Measures how fast one direct method reaches DEVICE_COUNT devices, once with a call of
+// IoTHubDeviceMethod_Invoke per device and once with IoTHubDeviceMethod_InvokeMany on pools of
+// different sizes. The hub is replaced by the in-process HTTPAPI of httpapi_stub.c, which counts the
+// connections opened and the requests received, and adds a fixed cost to both.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/platform.h"
+
+#include "iothub_service_client_auth.h"
+#include "iothub_devicemethod.h"
+
+#include "httpapi_stub.h"
+
+#define DEVICE_COUNT            200
+#define DEVICE_ID_LENGTH        32
+
+static const char* CONNECTION_STRING = "HostName=benchmark.azure-devices.net;SharedAccessKeyName=iothubowner;SharedAccessKey=YmVuY2htYXJrIHNoYXJlZCBhY2Nlc3Mga2V5IDAxMjM0NTY=";
+static const char* METHOD_NAME = "reboot";
+static const char* METHOD_PAYLOAD = "{\"delay\":0}";
+static const unsigned int METHOD_TIMEOUT = 30;
+
+static char g_device_id_storage[DEVICE_COUNT][DEVICE_ID_LENGTH];
+static const char* g_device_ids[DEVICE_COUNT];
+
+static void on_invoke_many_result(void* userContext, size_t index, const char* deviceId, IOTHUB_DEVICE_METHOD_RESULT result, int responseStatus, const unsigned char* responsePayload, size_t responsePayloadSize)
+{
+    size_t* succeeded_count = (size_t*)userContext;
+
+    (void)index;
+    (void)deviceId;
+    (void)responsePayload;
+    (void)responsePayloadSize;
+    if (result == IOTHUB_DEVICE_METHOD_OK && responseStatus == 200)
+    {
+        (*succeeded_count)++;
+    }
+}
+
+static int invoke_one_by_one(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE device_method, size_t* succeeded_count)
+{
+    size_t i;
+
+    for (i = 0; i < DEVICE_COUNT; i++)
+    {
+        int responseStatus;
+        unsigned char* responsePayload;
+        size_t responsePayloadSize;
+
+        if (IoTHubDeviceMethod_Invoke(device_method, g_device_ids[i], METHOD_NAME, METHOD_PAYLOAD, METHOD_TIMEOUT, &responseStatus, &responsePayload, &responsePayloadSize) == IOTHUB_DEVICE_METHOD_OK)
+        {
+            if (responseStatus == 200)
+            {
+                (*succeeded_count)++;
+            }
+            free(responsePayload);
+        }
+    }
+
+    return 0;
+}
+
+static int invoke_many(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE device_method, size_t* succeeded_count)
+{
+    int result;
+
+    if (IoTHubDeviceMethod_InvokeMany(device_method, g_device_ids, DEVICE_COUNT, METHOD_NAME, METHOD_PAYLOAD, METHOD_TIMEOUT, on_invoke_many_result, succeeded_count) != IOTHUB_DEVICE_METHOD_OK)
+    {
+        LogError("IoTHubDeviceMethod_InvokeMany failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+typedef struct BENCHMARK_SCENARIO_TAG
+{
+    const char* name;
+    size_t max_connections;
+    int (*invoke)(IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE device_method, size_t* succeeded_count);
+} BENCHMARK_SCENARIO;
+
+static int run_scenario(IOTHUB_SERVICE_CLIENT_AUTH_HANDLE service_client, TICK_COUNTER_HANDLE tick_counter, const BENCHMARK_SCENARIO* scenario)
+{
+    int result;
+    IOTHUB_SERVICE_CLIENT_DEVICE_METHOD_HANDLE device_method;
+
+    if ((device_method = IoTHubDeviceMethod_Create(service_client)) == NULL)
+    {
+        LogError("IoTHubDeviceMethod_Create failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (scenario->max_connections > 0 && IoTHubDeviceMethod_SetMaxConnections(device_method, scenario->max_connections) != IOTHUB_DEVICE_METHOD_OK)
+        {
+            LogError("IoTHubDeviceMethod_SetMaxConnections failed");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            tickcounter_ms_t start_ms;
+            tickcounter_ms_t end_ms;
+            size_t succeeded_count = 0;
+
+            httpapi_stub_reset_counters();
+            (void)tickcounter_get_current_ms(tick_counter, &start_ms);
+
+            result = scenario->invoke(device_method, &succeeded_count);
+
+            (void)tickcounter_get_current_ms(tick_counter, &end_ms);
+
+            if (result == 0)
+            {
+                tickcounter_ms_t elapsed_ms = (end_ms > start_ms) ? (end_ms - start_ms) : 1;
+
+                (void)printf("%-40s %8lu ms %10.1f devices/s %6lu connections %6lu requests %6lu succeeded\r\n", scenario->name,
+                    (unsigned long)elapsed_ms, (double)DEVICE_COUNT * 1000.0 / (double)elapsed_ms,
+                    (unsigned long)httpapi_stub_get_connection_count(), (unsigned long)httpapi_stub_get_request_count(), (unsigned long)succeeded_count);
+            }
+        }
+
+        IoTHubDeviceMethod_Destroy(device_method);
+    }
+
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    int result;
+
+    (void)argc;
+
+    if (platform_init() != 0)
+    {
+        LogError("platform_init failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (httpapi_stub_init() != 0)
+        {
+            result = MU_FAILURE;
+        }
+        else
+        {
+            IOTHUB_SERVICE_CLIENT_AUTH_HANDLE service_client;
+            TICK_COUNTER_HANDLE tick_counter;
+
+            if ((service_client = IoTHubServiceClientAuth_CreateFromConnectionString(CONNECTION_STRING)) == NULL)
+            {
+                LogError("IoTHubServiceClientAuth_CreateFromConnectionString failed");
+                result = MU_FAILURE;
+            }
+            else if ((tick_counter = tickcounter_create()) == NULL)
+            {
+                LogError("tickcounter_create failed");
+                IoTHubServiceClientAuth_Destroy(service_client);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                const BENCHMARK_SCENARIO scenarios[] =
+                {
+                    { "IoTHubDeviceMethod_Invoke per device", 0, invoke_one_by_one },
+                    { "IoTHubDeviceMethod_InvokeMany, 1 conn", 1, invoke_many },
+                    { "IoTHubDeviceMethod_InvokeMany, 4 conns", 4, invoke_many },
+                    { "IoTHubDeviceMethod_InvokeMany, 8 conns", 8, invoke_many },
+                    { "IoTHubDeviceMethod_InvokeMany, 16 conns", 16, invoke_many }
+                };
+                size_t i;
+
+                for (i = 0; i < DEVICE_COUNT; i++)
+                {
+                    (void)snprintf(g_device_id_storage[i], DEVICE_ID_LENGTH, "device%04lu", (unsigned long)i);
+                    g_device_ids[i] = g_device_id_storage[i];
+                }
+
+                (void)printf("%s: %d devices\r\n", argv[0], DEVICE_COUNT);
+
+                result = 0;
+                for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]) && result == 0; i++)
+                {
+                    result = run_scenario(service_client, tick_counter, &scenarios[i]);
+                }
+
+                tickcounter_destroy(tick_counter);
+                IoTHubServiceClientAuth_Destroy(service_client);
+            }
+
+            httpapi_stub_deinit();
+        }
+
+        platform_deinit();
+    }
+
+    return result;
+}
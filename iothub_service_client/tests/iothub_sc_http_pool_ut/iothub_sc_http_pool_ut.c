@@ -0,0 +1,847 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <cstdbool>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <stdbool.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umocktypes_stdint.h"
+
+#define ENABLE_MOCKS
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/sastoken.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/httpapiex.h"
+#include "azure_c_shared_utility/httpheaders.h"
+
+#undef ENABLE_MOCKS
+
+#include "internal/iothub_sc_http_pool.h"
+
+TEST_DEFINE_ENUM_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
+TEST_DEFINE_ENUM_TYPE(THREADAPI_RESULT, THREADAPI_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(THREADAPI_RESULT, THREADAPI_RESULT_VALUES);
+
+static const char* TEST_HOSTNAME = "theHostName";
+static const char* TEST_KEYNAME = "theSharedAccessKeyName";
+static const char* TEST_SHAREDACCESSKEY = "theSharedAccessKey";
+static const char* TEST_SHAREDACCESSSIGNATURE_KEY = "sas=SharedAccessSignature sr=theHostName&sig=theSignature&se=1600000000&skn=theSharedAccessKeyName";
+static const char* TEST_SHAREDACCESSSIGNATURE = "SharedAccessSignature sr=theHostName&sig=theSignature&se=1600000000&skn=theSharedAccessKeyName";
+static const char* TEST_SAS_TOKEN = "SharedAccessSignature sr=theHostName&sig=created&se=1600003600&skn=theSharedAccessKeyName";
+static const char* TEST_RELATIVE_PATH = "/twins/theDevice?api-version=2017-11-08-preview";
+static const char* TEST_HTTP_HEADER_KEY_AUTHORIZATION = "Authorization";
+static const time_t TEST_TIME = (time_t)1600000000;
+
+static HTTP_HEADERS_HANDLE TEST_HTTP_HEADERS_HANDLE = (HTTP_HEADERS_HANDLE)0x4545;
+static BUFFER_HANDLE TEST_REQUEST_BUFFER = (BUFFER_HANDLE)0x4646;
+static BUFFER_HANDLE TEST_RESPONSE_BUFFER = (BUFFER_HANDLE)0x4747;
+static LOCK_HANDLE TEST_LOCK_HANDLE = (LOCK_HANDLE)0x4848;
+
+#define TEST_MAX_REQUESTS   8
+#define TEST_MAX_THREADS    4
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+static size_t g_request_count[TEST_MAX_REQUESTS];
+static SC_HTTP_CONNECTION_HANDLE g_request_connection[TEST_MAX_REQUESTS];
+static void* g_request_context;
+
+static THREAD_START_FUNC g_thread_func[TEST_MAX_THREADS];
+static void* g_thread_arg[TEST_MAX_THREADS];
+static size_t g_thread_count;
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    (void)error_code;
+    ASSERT_FAIL("umock_c reported error");
+}
+
+static STRING_HANDLE my_STRING_construct(const char* psz)
+{
+    char* result = (char*)my_gballoc_malloc(strlen(psz) + 1);
+    (void)strcpy(result, psz);
+    return (STRING_HANDLE)result;
+}
+
+static const char* my_STRING_c_str(STRING_HANDLE handle)
+{
+    return (const char*)handle;
+}
+
+static void my_STRING_delete(STRING_HANDLE handle)
+{
+    my_gballoc_free(handle);
+}
+
+static STRING_HANDLE my_SASToken_Create(STRING_HANDLE key, STRING_HANDLE scope, STRING_HANDLE keyName, size_t expiry)
+{
+    (void)key;
+    (void)scope;
+    (void)keyName;
+    (void)expiry;
+    return my_STRING_construct(TEST_SAS_TOKEN);
+}
+
+static LOCK_HANDLE my_Lock_Init(void)
+{
+    return TEST_LOCK_HANDLE;
+}
+
+static HTTPAPIEX_HANDLE my_HTTPAPIEX_Create(const char* hostName)
+{
+    (void)hostName;
+    return (HTTPAPIEX_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
+{
+    my_gballoc_free(handle);
+}
+
+// Worker threads only run when they are joined, one after the other, so that the calls they make are in a known order
+static THREADAPI_RESULT my_ThreadAPI_Create(THREAD_HANDLE* threadHandle, THREAD_START_FUNC func, void* arg)
+{
+    g_thread_func[g_thread_count] = func;
+    g_thread_arg[g_thread_count] = arg;
+    *threadHandle = (THREAD_HANDLE)(g_thread_count + 1);
+    g_thread_count++;
+    return THREADAPI_OK;
+}
+
+static THREADAPI_RESULT my_ThreadAPI_Join(THREAD_HANDLE threadHandle, int* res)
+{
+    size_t index = (size_t)threadHandle - 1;
+    *res = g_thread_func[index](g_thread_arg[index]);
+    return THREADAPI_OK;
+}
+
+static void test_request_callback(void* context, size_t index, SC_HTTP_CONNECTION_HANDLE connection)
+{
+    g_request_context = context;
+    g_request_count[index]++;
+    g_request_connection[index] = connection;
+}
+
+static void test_execute_request_callback(void* context, size_t index, SC_HTTP_CONNECTION_HANDLE connection)
+{
+    unsigned int statusCode;
+
+    test_request_callback(context, index, connection);
+    (void)sc_http_pool_execute(connection, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, TEST_REQUEST_BUFFER, &statusCode, TEST_RESPONSE_BUFFER);
+}
+
+static void setup_create_mock_calls(const char* sharedAccessKey, size_t maxConnections)
+{
+    size_t index;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_construct(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(STRING_construct(TEST_KEYNAME));
+    STRICT_EXPECTED_CALL(STRING_construct(sharedAccessKey));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    for (index = 0; index < maxConnections; index++)
+    {
+        STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME));
+    }
+}
+
+static void setup_take_index_mock_calls(void)
+{
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+}
+
+static void setup_worker_mock_calls(size_t requestCount)
+{
+    size_t index;
+
+    for (index = 0; index < requestCount + 1; index++)
+    {
+        setup_take_index_mock_calls();
+    }
+    STRICT_EXPECTED_CALL(ThreadAPI_Exit(0));
+}
+
+static void setup_execute_mock_calls(bool createsSasToken, const char* sasToken)
+{
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    if (createsSasToken)
+    {
+        STRICT_EXPECTED_CALL(SASToken_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    }
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(TEST_HTTP_HEADERS_HANDLE, TEST_HTTP_HEADER_KEY_AUTHORIZATION, sasToken));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, TEST_REQUEST_BUFFER, IGNORED_PTR_ARG, NULL, TEST_RESPONSE_BUFFER));
+}
+
+BEGIN_TEST_SUITE(iothub_sc_http_pool_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    int result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT);
+    REGISTER_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT);
+    REGISTER_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE);
+    REGISTER_TYPE(THREADAPI_RESULT, THREADAPI_RESULT);
+    REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(THREAD_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(THREAD_START_FUNC, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(time_t, long long);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_construct, my_STRING_construct);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_construct, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_c_str, my_STRING_c_str);
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_delete, my_STRING_delete);
+
+    REGISTER_GLOBAL_MOCK_HOOK(SASToken_Create, my_SASToken_Create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(SASToken_Create, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(get_time, TEST_TIME);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(get_time, (time_t)-1);
+
+    REGISTER_GLOBAL_MOCK_HOOK(Lock_Init, my_Lock_Init);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock, LOCK_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Deinit, LOCK_OK);
+
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Create, my_ThreadAPI_Create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(ThreadAPI_Create, THREADAPI_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Join, my_ThreadAPI_Join);
+
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Create, my_HTTPAPIEX_Create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_Create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Destroy, my_HTTPAPIEX_Destroy);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPAPIEX_ExecuteRequest, HTTPAPIEX_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_ExecuteRequest, HTTPAPIEX_ERROR);
+
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_ReplaceHeaderNameValuePair, HTTP_HEADERS_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_ReplaceHeaderNameValuePair, HTTP_HEADERS_ERROR);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+
+    memset(g_request_count, 0, sizeof(g_request_count));
+    memset(g_request_connection, 0, sizeof(g_request_connection));
+    g_request_context = NULL;
+    g_thread_count = 0;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    umock_c_negative_tests_deinit();
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_001: [ If hostname, keyName or sharedAccessKey is NULL, or maxConnections is 0, sc_http_pool_create shall fail and return NULL. ]*/
+TEST_FUNCTION(sc_http_pool_create_NULL_hostname_fails)
+{
+    // act
+    SC_HTTP_POOL_HANDLE result = sc_http_pool_create(NULL, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 4);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_001: [ If hostname, keyName or sharedAccessKey is NULL, or maxConnections is 0, sc_http_pool_create shall fail and return NULL. ]*/
+TEST_FUNCTION(sc_http_pool_create_NULL_keyName_fails)
+{
+    // act
+    SC_HTTP_POOL_HANDLE result = sc_http_pool_create(TEST_HOSTNAME, NULL, TEST_SHAREDACCESSKEY, 4);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_001: [ If hostname, keyName or sharedAccessKey is NULL, or maxConnections is 0, sc_http_pool_create shall fail and return NULL. ]*/
+TEST_FUNCTION(sc_http_pool_create_NULL_sharedAccessKey_fails)
+{
+    // act
+    SC_HTTP_POOL_HANDLE result = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, NULL, 4);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_001: [ If hostname, keyName or sharedAccessKey is NULL, or maxConnections is 0, sc_http_pool_create shall fail and return NULL. ]*/
+TEST_FUNCTION(sc_http_pool_create_zero_maxConnections_fails)
+{
+    // act
+    SC_HTTP_POOL_HANDLE result = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 0);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_002: [ sc_http_pool_create shall allocate the pool and copy hostname, keyName and sharedAccessKey into it. ]*/
+/*Tests_SRS_SC_HTTP_POOL_09_003: [ sc_http_pool_create shall create maxConnections connections to hostname with HTTPAPIEX_Create, which connect on their first request only. ]*/
+/*Tests_SRS_SC_HTTP_POOL_09_004: [ On success sc_http_pool_create shall return the pool. ]*/
+TEST_FUNCTION(sc_http_pool_create_succeeds)
+{
+    // arrange
+    setup_create_mock_calls(TEST_SHAREDACCESSKEY, 3);
+
+    // act
+    SC_HTTP_POOL_HANDLE result = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 3);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    sc_http_pool_destroy(result);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_005: [ If any of the allocations fails, sc_http_pool_create shall free everything it created and return NULL. ]*/
+TEST_FUNCTION(sc_http_pool_create_fails_when_any_call_fails)
+{
+    // arrange
+    ASSERT_ARE_EQUAL(int, 0, umock_c_negative_tests_init());
+
+    setup_create_mock_calls(TEST_SHAREDACCESSKEY, 2);
+
+    umock_c_negative_tests_snapshot();
+
+    for (size_t index = 0; index < umock_c_negative_tests_call_count(); index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        // act
+        SC_HTTP_POOL_HANDLE result = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 2);
+
+        // assert
+        ASSERT_IS_NULL(result, "sc_http_pool_create failure in test %lu", (unsigned long)index);
+    }
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_006: [ If pool is NULL, sc_http_pool_destroy shall do nothing. ]*/
+TEST_FUNCTION(sc_http_pool_destroy_NULL_does_nothing)
+{
+    // act
+    sc_http_pool_destroy(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_007: [ sc_http_pool_destroy shall close every connection with HTTPAPIEX_Destroy and free the SAS token and the pool. ]*/
+TEST_FUNCTION(sc_http_pool_destroy_closes_every_connection)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 2);
+    (void)sc_http_pool_run(pool, 1, test_execute_request_callback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    sc_http_pool_destroy(pool);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_008: [ If pool or requestCallback is NULL, sc_http_pool_run shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(sc_http_pool_run_NULL_pool_fails)
+{
+    // act
+    int result = sc_http_pool_run(NULL, 2, test_request_callback, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_008: [ If pool or requestCallback is NULL, sc_http_pool_run shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(sc_http_pool_run_NULL_requestCallback_fails)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 2);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = sc_http_pool_run(pool, 2, NULL, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_009: [ If at most one request is to run, sc_http_pool_run shall run it on the first connection from the calling thread and return 0. ]*/
+TEST_FUNCTION(sc_http_pool_run_single_request_runs_on_the_calling_thread)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 4);
+    umock_c_reset_all_calls();
+
+    setup_take_index_mock_calls();
+    setup_take_index_mock_calls();
+
+    // act
+    int result = sc_http_pool_run(pool, 1, test_request_callback, (void*)0x4949);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_request_count[0]);
+    ASSERT_IS_NOT_NULL(g_request_connection[0]);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x4949, g_request_context);
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_009: [ If at most one request is to run, sc_http_pool_run shall run it on the first connection from the calling thread and return 0. ]*/
+TEST_FUNCTION(sc_http_pool_run_no_request_succeeds)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 4);
+    umock_c_reset_all_calls();
+
+    setup_take_index_mock_calls();
+
+    // act
+    int result = sc_http_pool_run(pool, 0, test_request_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_010: [ Otherwise sc_http_pool_run shall start one worker thread with ThreadAPI_Create for each connection, up to one per request. ]*/
+/*Tests_SRS_SC_HTTP_POOL_09_011: [ Every worker shall take the next index that has not been taken yet and call requestCallback with it and its own connection, until every index has been taken. ]*/
+/*Tests_SRS_SC_HTTP_POOL_09_012: [ sc_http_pool_run shall wait for every worker thread with ThreadAPI_Join and return 0. ]*/
+TEST_FUNCTION(sc_http_pool_run_starts_one_worker_per_connection)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    // the first worker to run takes all the requests
+    STRICT_EXPECTED_CALL(ThreadAPI_Join(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    setup_worker_mock_calls(5);
+    STRICT_EXPECTED_CALL(ThreadAPI_Join(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    setup_worker_mock_calls(0);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    int result = sc_http_pool_run(pool, 5, test_request_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, g_thread_count);
+    for (size_t index = 0; index < 5; index++)
+    {
+        ASSERT_ARE_EQUAL(size_t, 1, g_request_count[index]);
+        ASSERT_ARE_EQUAL(void_ptr, g_request_connection[0], g_request_connection[index]);
+    }
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_010: [ Otherwise sc_http_pool_run shall start one worker thread with ThreadAPI_Create for each connection, up to one per request. ]*/
+TEST_FUNCTION(sc_http_pool_run_starts_no_more_workers_than_requests)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 4);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = sc_http_pool_run(pool, 2, test_request_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 2, g_thread_count);
+    ASSERT_ARE_EQUAL(size_t, 1, g_request_count[0]);
+    ASSERT_ARE_EQUAL(size_t, 1, g_request_count[1]);
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_014: [ If only some of the worker threads can be started, sc_http_pool_run shall run every request on the ones that could. ]*/
+TEST_FUNCTION(sc_http_pool_run_runs_every_request_when_some_workers_fail_to_start)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 3);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(THREADAPI_ERROR);
+    STRICT_EXPECTED_CALL(ThreadAPI_Join(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    setup_worker_mock_calls(4);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    int result = sc_http_pool_run(pool, 4, test_request_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    for (size_t index = 0; index < 4; index++)
+    {
+        ASSERT_ARE_EQUAL(size_t, 1, g_request_count[index]);
+    }
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_013: [ If the workers cannot be allocated, or no worker thread can be started, sc_http_pool_run shall run every request on the first connection from the calling thread and return 0. ]*/
+TEST_FUNCTION(sc_http_pool_run_runs_on_the_calling_thread_when_no_worker_starts)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(THREADAPI_ERROR);
+    setup_take_index_mock_calls();
+    setup_take_index_mock_calls();
+    setup_take_index_mock_calls();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    int result = sc_http_pool_run(pool, 2, test_request_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_thread_count);
+    ASSERT_ARE_EQUAL(size_t, 1, g_request_count[0]);
+    ASSERT_ARE_EQUAL(size_t, 1, g_request_count[1]);
+    ASSERT_ARE_EQUAL(void_ptr, g_request_connection[0], g_request_connection[1]);
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_013: [ If the workers cannot be allocated, or no worker thread can be started, sc_http_pool_run shall run every request on the first connection from the calling thread and return 0. ]*/
+TEST_FUNCTION(sc_http_pool_run_runs_on_the_calling_thread_when_workers_cannot_be_allocated)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    setup_take_index_mock_calls();
+    setup_take_index_mock_calls();
+    setup_take_index_mock_calls();
+
+    // act
+    int result = sc_http_pool_run(pool, 2, test_request_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_thread_count);
+    ASSERT_ARE_EQUAL(size_t, 1, g_request_count[0]);
+    ASSERT_ARE_EQUAL(size_t, 1, g_request_count[1]);
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_015: [ If connection, relativePath, requestHeaders or statusCode is NULL, sc_http_pool_execute shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(sc_http_pool_execute_NULL_connection_fails)
+{
+    // arrange
+    unsigned int statusCode;
+
+    // act
+    int result = sc_http_pool_execute(NULL, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, TEST_REQUEST_BUFFER, &statusCode, TEST_RESPONSE_BUFFER);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_016: [ sc_http_pool_execute shall set the Authorization header of requestHeaders to the SAS token of the pool with HTTPHeaders_ReplaceHeaderNameValuePair. ]*/
+/*Tests_SRS_SC_HTTP_POOL_09_017: [ sc_http_pool_execute shall execute the request with HTTPAPIEX_ExecuteRequest on the connection, which keeps the connection open for the next request. ]*/
+/*Tests_SRS_SC_HTTP_POOL_09_022: [ Otherwise sc_http_pool_execute shall return 0. ]*/
+TEST_FUNCTION(sc_http_pool_execute_signs_and_executes_the_request)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 1);
+    umock_c_reset_all_calls();
+
+    setup_take_index_mock_calls();
+    setup_execute_mock_calls(true, TEST_SAS_TOKEN);
+    setup_take_index_mock_calls();
+
+    // act
+    int result = sc_http_pool_run(pool, 1, test_execute_request_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_018: [ sc_http_pool_execute shall reuse the SAS token of the pool, and only create a new one with SASToken_Create when there is none yet or the current one expires within 5 minutes. ]*/
+TEST_FUNCTION(sc_http_pool_execute_reuses_the_sas_token)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 1);
+    (void)sc_http_pool_run(pool, 1, test_execute_request_callback, NULL);
+    umock_c_reset_all_calls();
+
+    setup_take_index_mock_calls();
+    setup_execute_mock_calls(false, TEST_SAS_TOKEN);
+    setup_take_index_mock_calls();
+
+    // act
+    int result = sc_http_pool_run(pool, 1, test_execute_request_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_018: [ sc_http_pool_execute shall reuse the SAS token of the pool, and only create a new one with SASToken_Create when there is none yet or the current one expires within 5 minutes. ]*/
+TEST_FUNCTION(sc_http_pool_execute_renews_the_sas_token_before_it_expires)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 1);
+    (void)sc_http_pool_run(pool, 1, test_execute_request_callback, NULL);
+    umock_c_reset_all_calls();
+
+    setup_take_index_mock_calls();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG))
+        .SetReturn(TEST_TIME + 3300);
+    STRICT_EXPECTED_CALL(SASToken_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(TEST_HTTP_HEADERS_HANDLE, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_SAS_TOKEN));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, TEST_REQUEST_BUFFER, IGNORED_PTR_ARG, NULL, TEST_RESPONSE_BUFFER));
+    setup_take_index_mock_calls();
+
+    // act
+    int result = sc_http_pool_run(pool, 1, test_execute_request_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_019: [ If the shared access key starts with "sas=", sc_http_pool_execute shall use the rest of it as the SAS token. ]*/
+TEST_FUNCTION(sc_http_pool_execute_uses_the_shared_access_signature)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSSIGNATURE_KEY, 1);
+    umock_c_reset_all_calls();
+
+    setup_take_index_mock_calls();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(TEST_HTTP_HEADERS_HANDLE, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_SHAREDACCESSSIGNATURE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, TEST_REQUEST_BUFFER, IGNORED_PTR_ARG, NULL, TEST_RESPONSE_BUFFER));
+    setup_take_index_mock_calls();
+
+    // act
+    int result = sc_http_pool_run(pool, 1, test_execute_request_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_020: [ If the token cannot be created or set, sc_http_pool_execute shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(sc_http_pool_execute_SASToken_Create_fails)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 1);
+    unsigned int statusCode;
+
+    (void)sc_http_pool_run(pool, 1, test_request_callback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(SASToken_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    // act
+    int result = sc_http_pool_execute(g_request_connection[0], HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, TEST_REQUEST_BUFFER, &statusCode, TEST_RESPONSE_BUFFER);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_020: [ If the token cannot be created or set, sc_http_pool_execute shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(sc_http_pool_execute_HTTPHeaders_ReplaceHeaderNameValuePair_fails)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 1);
+    unsigned int statusCode;
+
+    (void)sc_http_pool_run(pool, 1, test_request_callback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(SASToken_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(TEST_HTTP_HEADERS_HANDLE, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_SAS_TOKEN))
+        .SetReturn(HTTP_HEADERS_ERROR);
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    // act
+    int result = sc_http_pool_execute(g_request_connection[0], HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, TEST_REQUEST_BUFFER, &statusCode, TEST_RESPONSE_BUFFER);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+/*Tests_SRS_SC_HTTP_POOL_09_021: [ If HTTPAPIEX_ExecuteRequest fails, sc_http_pool_execute shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(sc_http_pool_execute_HTTPAPIEX_ExecuteRequest_fails)
+{
+    // arrange
+    SC_HTTP_POOL_HANDLE pool = sc_http_pool_create(TEST_HOSTNAME, TEST_KEYNAME, TEST_SHAREDACCESSKEY, 1);
+    unsigned int statusCode;
+
+    (void)sc_http_pool_run(pool, 1, test_request_callback, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(SASToken_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(TEST_HTTP_HEADERS_HANDLE, TEST_HTTP_HEADER_KEY_AUTHORIZATION, TEST_SAS_TOKEN));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, TEST_REQUEST_BUFFER, IGNORED_PTR_ARG, NULL, TEST_RESPONSE_BUFFER))
+        .SetReturn(HTTPAPIEX_ERROR);
+
+    // act
+    int result = sc_http_pool_execute(g_request_connection[0], HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, TEST_HTTP_HEADERS_HANDLE, TEST_REQUEST_BUFFER, &statusCode, TEST_RESPONSE_BUFFER);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    sc_http_pool_destroy(pool);
+}
+
+END_TEST_SUITE(iothub_sc_http_pool_ut)
@@ -0,0 +1,372 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Measures how fast a device list response of DEVICE_COUNT devices is read, and how much memory the
+// parse itself holds on to, once with a parson tree and once in a single pass with the service client
+// JSON reader. Both passes copy every string of the response, as the registry manager copies the
+// members of each device. The response is the recorded fixture in ../iothub_rm_ut, repeated until it
+// holds DEVICE_COUNT devices. The provisioning service client models are not covered, they are still
+// parsed with parson.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "parson.h"
+
+#include "internal/iothub_sc_json_reader.h"
+
+#define DEVICE_COUNT            1000
+#define ITERATION_COUNT         50
+
+#ifndef DEVICE_LIST_FIXTURE_PATH
+#define DEVICE_LIST_FIXTURE_PATH "device_list_response.json"
+#endif
+
+static size_t g_parson_bytes;
+static size_t g_parson_peak_bytes;
+
+// parson is given these so that the size of its tree can be measured
+static void* counting_malloc(size_t size)
+{
+    size_t* block = (size_t*)malloc(sizeof(size_t) + size);
+    void* result;
+
+    if (block == NULL)
+    {
+        result = NULL;
+    }
+    else
+    {
+        block[0] = size;
+        g_parson_bytes += size;
+        if (g_parson_bytes > g_parson_peak_bytes)
+        {
+            g_parson_peak_bytes = g_parson_bytes;
+        }
+        result = block + 1;
+    }
+
+    return result;
+}
+
+static void counting_free(void* ptr)
+{
+    if (ptr != NULL)
+    {
+        size_t* block = (size_t*)ptr - 1;
+        g_parson_bytes -= block[0];
+        free(block);
+    }
+}
+
+static char* read_fixture(const char* path)
+{
+    char* result = NULL;
+    FILE* file = fopen(path, "rb");
+
+    if (file == NULL)
+    {
+        LogError("Failed opening %s", path);
+    }
+    else
+    {
+        long size;
+
+        if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) <= 0 || fseek(file, 0, SEEK_SET) != 0)
+        {
+            LogError("Failed getting the size of %s", path);
+        }
+        else if ((result = (char*)malloc((size_t)size + 1)) == NULL)
+        {
+            LogError("Failed allocating %ld bytes", size);
+        }
+        else if (fread(result, 1, (size_t)size, file) != (size_t)size)
+        {
+            LogError("Failed reading %s", path);
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            result[size] = '\0';
+        }
+        (void)fclose(file);
+    }
+
+    return result;
+}
+
+// Counts the devices of a list and returns the text between its brackets
+static size_t get_fixture_devices(const char* fixture, const char** devices, size_t* devices_length)
+{
+    size_t result = 0;
+    SC_JSON_READER reader;
+    SC_JSON_TOKEN token;
+    const char* begin = strchr(fixture, '[');
+    const char* end = strrchr(fixture, ']');
+
+    if (begin == NULL || end == NULL || end < begin || sc_json_reader_init(&reader, fixture, strlen(fixture)) != 0 || sc_json_reader_next(&reader) != SC_JSON_TOKEN_BEGIN_ARRAY)
+    {
+        LogError("The fixture is not a device list");
+    }
+    else
+    {
+        while ((token = sc_json_reader_next(&reader)) == SC_JSON_TOKEN_BEGIN_OBJECT && sc_json_reader_skip(&reader, token) == 0)
+        {
+            result++;
+        }
+
+        if (token != SC_JSON_TOKEN_END_ARRAY)
+        {
+            LogError("The fixture is not a device list");
+            result = 0;
+        }
+        else
+        {
+            *devices = begin + 1;
+            *devices_length = (size_t)(end - begin - 1);
+        }
+    }
+
+    return result;
+}
+
+static char* build_device_list(const char* fixture, size_t* device_count, size_t* length)
+{
+    char* result = NULL;
+    const char* devices;
+    size_t devices_length;
+    size_t fixture_device_count = get_fixture_devices(fixture, &devices, &devices_length);
+
+    if (fixture_device_count > 0)
+    {
+        size_t repeat_count = (DEVICE_COUNT + fixture_device_count - 1) / fixture_device_count;
+
+        if ((result = (char*)malloc(repeat_count * (devices_length + 1) + 2)) == NULL)
+        {
+            LogError("Failed allocating the device list");
+        }
+        else
+        {
+            size_t position = 0;
+            size_t i;
+
+            result[position++] = '[';
+            for (i = 0; i < repeat_count; i++)
+            {
+                if (i > 0)
+                {
+                    result[position++] = ',';
+                }
+                (void)memcpy(result + position, devices, devices_length);
+                position += devices_length;
+            }
+            result[position++] = ']';
+            result[position] = '\0';
+
+            *device_count = repeat_count * fixture_device_count;
+            *length = position;
+        }
+    }
+
+    return result;
+}
+
+static int copy_strings_from_tree(const JSON_Value* value, size_t* string_count)
+{
+    int result = 0;
+    size_t i;
+    char* copy;
+
+    switch (json_value_get_type(value))
+    {
+        case JSONObject:
+        {
+            const JSON_Object* object = json_value_get_object(value);
+            for (i = 0; i < json_object_get_count(object) && result == 0; i++)
+            {
+                result = copy_strings_from_tree(json_object_get_value_at(object, i), string_count);
+            }
+            break;
+        }
+        case JSONArray:
+        {
+            const JSON_Array* array = json_value_get_array(value);
+            for (i = 0; i < json_array_get_count(array) && result == 0; i++)
+            {
+                result = copy_strings_from_tree(json_array_get_value(array, i), string_count);
+            }
+            break;
+        }
+        case JSONString:
+            if (mallocAndStrcpy_s(&copy, json_value_get_string(value)) != 0)
+            {
+                LogError("mallocAndStrcpy_s failed");
+                result = MU_FAILURE;
+            }
+            else
+            {
+                free(copy);
+                (*string_count)++;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return result;
+}
+
+static int read_with_parson(const char* json, size_t length, size_t* string_count)
+{
+    int result;
+    JSON_Value* root;
+
+    (void)length;
+    if ((root = json_parse_string(json)) == NULL)
+    {
+        LogError("json_parse_string failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = copy_strings_from_tree(root, string_count);
+        json_value_free(root);
+    }
+
+    return result;
+}
+
+static int read_with_reader(const char* json, size_t length, size_t* string_count)
+{
+    int result;
+    SC_JSON_READER reader;
+    SC_JSON_TOKEN token;
+
+    if (sc_json_reader_init(&reader, json, length) != 0)
+    {
+        LogError("sc_json_reader_init failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+        while (result == 0 && (token = sc_json_reader_next(&reader)) != SC_JSON_TOKEN_END)
+        {
+            char* copy;
+
+            if (token == SC_JSON_TOKEN_ERROR)
+            {
+                LogError("The device list is not valid JSON");
+                result = MU_FAILURE;
+            }
+            else if (token == SC_JSON_TOKEN_STRING)
+            {
+                if (sc_json_value_copy(sc_json_reader_get_value(&reader), &copy) != 0)
+                {
+                    LogError("sc_json_value_copy failed");
+                    result = MU_FAILURE;
+                }
+                else
+                {
+                    free(copy);
+                    (*string_count)++;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+typedef struct BENCHMARK_SCENARIO_TAG
+{
+    const char* name;
+    int (*read)(const char* json, size_t length, size_t* string_count);
+} BENCHMARK_SCENARIO;
+
+int main(int argc, char* argv[])
+{
+    int result;
+    const char* fixture_path = (argc > 1) ? argv[1] : DEVICE_LIST_FIXTURE_PATH;
+    char* fixture;
+
+    json_set_allocation_functions(counting_malloc, counting_free);
+
+    if ((fixture = read_fixture(fixture_path)) == NULL)
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        size_t device_count = 0;
+        size_t length = 0;
+        char* device_list;
+
+        if ((device_list = build_device_list(fixture, &device_count, &length)) == NULL)
+        {
+            result = MU_FAILURE;
+        }
+        else
+        {
+            TICK_COUNTER_HANDLE tick_counter;
+
+            if ((tick_counter = tickcounter_create()) == NULL)
+            {
+                LogError("tickcounter_create failed");
+                result = MU_FAILURE;
+            }
+            else
+            {
+                const BENCHMARK_SCENARIO scenarios[] =
+                {
+                    { "parson tree, then copy every string", read_with_parson },
+                    { "sc_json_reader, copy every string as it is read", read_with_reader }
+                };
+                size_t i;
+
+                (void)printf("%s: %lu devices, %lu bytes, %d iterations\r\n", argv[0], (unsigned long)device_count, (unsigned long)length, ITERATION_COUNT);
+
+                result = 0;
+                for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]) && result == 0; i++)
+                {
+                    tickcounter_ms_t start_ms;
+                    tickcounter_ms_t end_ms;
+                    size_t iteration;
+                    size_t string_count = 0;
+
+                    g_parson_peak_bytes = 0;
+                    (void)tickcounter_get_current_ms(tick_counter, &start_ms);
+
+                    for (iteration = 0; iteration < ITERATION_COUNT && result == 0; iteration++)
+                    {
+                        result = scenarios[i].read(device_list, length, &string_count);
+                    }
+
+                    (void)tickcounter_get_current_ms(tick_counter, &end_ms);
+
+                    if (result == 0)
+                    {
+                        // The reader keeps no tree, its whole state is the SC_JSON_READER on the stack
+                        size_t parse_bytes = (scenarios[i].read == read_with_parson) ? g_parson_peak_bytes : sizeof(SC_JSON_READER);
+
+                        (void)printf("%-50s %8lu ms %8.2f ms/list %10lu parse bytes %8lu strings/list\r\n", scenarios[i].name,
+                            (unsigned long)(end_ms - start_ms), (double)(end_ms - start_ms) / ITERATION_COUNT, (unsigned long)parse_bytes, (unsigned long)(string_count / ITERATION_COUNT));
+                    }
+                }
+
+                tickcounter_destroy(tick_counter);
+            }
+
+            free(device_list);
+        }
+
+        free(fixture);
+    }
+
+    return result;
+}
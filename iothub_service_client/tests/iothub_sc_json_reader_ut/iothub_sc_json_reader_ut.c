@@ -0,0 +1,775 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c/umock_c.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#undef ENABLE_MOCKS
+
+#include "internal/iothub_sc_json_reader.h"
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+#define TEST_MAX_TOKENS 64
+
+// Reads tokens until the end or an error, returning how many were read before the last one
+static size_t read_all_tokens(const char* json, SC_JSON_TOKEN* tokens, SC_JSON_TOKEN* last_token)
+{
+    SC_JSON_READER reader;
+    size_t count = 0;
+    SC_JSON_TOKEN token;
+
+    ASSERT_ARE_EQUAL(int, 0, sc_json_reader_init(&reader, json, strlen(json)));
+    while ((token = sc_json_reader_next(&reader)) != SC_JSON_TOKEN_END && token != SC_JSON_TOKEN_ERROR && count < TEST_MAX_TOKENS)
+    {
+        if (tokens != NULL)
+        {
+            tokens[count] = token;
+        }
+        count++;
+    }
+    *last_token = token;
+    return count;
+}
+
+static void assert_invalid_json(const char* json)
+{
+    SC_JSON_TOKEN last_token;
+    (void)read_all_tokens(json, NULL, &last_token);
+    ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_ERROR, last_token, json);
+}
+
+BEGIN_TEST_SUITE(iothub_sc_json_reader_ut)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+
+        umock_c_init(on_umock_c_error);
+
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        umock_c_deinit();
+        TEST_MUTEX_DESTROY(g_testByTest);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+
+        umock_c_reset_all_calls();
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_001: [ If reader or json is NULL, sc_json_reader_init shall fail and return a non-zero value. ] */
+    TEST_FUNCTION(sc_json_reader_init_reader_NULL_fails)
+    {
+        //arrange
+
+        //act
+        int result = sc_json_reader_init(NULL, "{}", 2);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_001: [ If reader or json is NULL, sc_json_reader_init shall fail and return a non-zero value. ] */
+    TEST_FUNCTION(sc_json_reader_init_json_NULL_fails)
+    {
+        //arrange
+        SC_JSON_READER reader;
+
+        //act
+        int result = sc_json_reader_init(&reader, NULL, 2);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_002: [ sc_json_reader_init shall prepare reader to read the first length characters of json, or the characters before the first NULL character if there is one, and return 0. ] */
+    TEST_FUNCTION(sc_json_reader_init_succeeds)
+    {
+        //arrange
+        SC_JSON_READER reader;
+
+        //act
+        int result = sc_json_reader_init(&reader, "[1]", 3);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_BEGIN_ARRAY, sc_json_reader_next(&reader));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_002: [ sc_json_reader_init shall prepare reader to read the first length characters of json, or the characters before the first NULL character if there is one, and return 0. ] */
+    TEST_FUNCTION(sc_json_reader_init_stops_at_length)
+    {
+        //arrange
+        SC_JSON_READER reader;
+        (void)sc_json_reader_init(&reader, "[1]garbage", 3);
+
+        //act
+        SC_JSON_TOKEN first = sc_json_reader_next(&reader);
+        SC_JSON_TOKEN second = sc_json_reader_next(&reader);
+        SC_JSON_TOKEN third = sc_json_reader_next(&reader);
+        SC_JSON_TOKEN fourth = sc_json_reader_next(&reader);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_BEGIN_ARRAY, first);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_NUMBER, second);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END_ARRAY, third);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END, fourth);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_002: [ sc_json_reader_init shall prepare reader to read the first length characters of json, or the characters before the first NULL character if there is one, and return 0. ] */
+    TEST_FUNCTION(sc_json_reader_init_stops_at_NULL_character)
+    {
+        //arrange
+        static const char json[] = "{}\0garbage";
+        SC_JSON_READER reader;
+        (void)sc_json_reader_init(&reader, json, sizeof(json));
+
+        //act
+        SC_JSON_TOKEN first = sc_json_reader_next(&reader);
+        SC_JSON_TOKEN second = sc_json_reader_next(&reader);
+        SC_JSON_TOKEN third = sc_json_reader_next(&reader);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_BEGIN_OBJECT, first);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END_OBJECT, second);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END, third);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_003: [ If reader is NULL, sc_json_reader_next shall return SC_JSON_TOKEN_ERROR. ] */
+    TEST_FUNCTION(sc_json_reader_next_reader_NULL_fails)
+    {
+        //arrange
+
+        //act
+        SC_JSON_TOKEN result = sc_json_reader_next(NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_ERROR, result);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_004: [ sc_json_reader_next shall return the next token of the text, skipping the whitespace between tokens. ] */
+    /* Tests_SRS_SC_JSON_READER_09_005: [ sc_json_reader_next shall return SC_JSON_TOKEN_NAME for the name of an object member, and the token of its value on the next call. ] */
+    /* Tests_SRS_SC_JSON_READER_09_006: [ sc_json_reader_next shall return SC_JSON_TOKEN_END once the single value of the text has been read and only whitespace is left. ] */
+    TEST_FUNCTION(sc_json_reader_next_reads_objects_in_order)
+    {
+        //arrange
+        SC_JSON_TOKEN tokens[TEST_MAX_TOKENS];
+        SC_JSON_TOKEN last_token;
+
+        //act
+        size_t count = read_all_tokens(" {\r\n\t\"a\" : { \"b\" : [ ] } , \"c\" : { } }\n", tokens, &last_token);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END, last_token);
+        ASSERT_ARE_EQUAL(size_t, 11, count);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_BEGIN_OBJECT, tokens[0]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_NAME, tokens[1]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_BEGIN_OBJECT, tokens[2]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_NAME, tokens[3]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_BEGIN_ARRAY, tokens[4]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END_ARRAY, tokens[5]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END_OBJECT, tokens[6]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_NAME, tokens[7]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_BEGIN_OBJECT, tokens[8]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END_OBJECT, tokens[9]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END_OBJECT, tokens[10]);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_004: [ sc_json_reader_next shall return the next token of the text, skipping the whitespace between tokens. ] */
+    TEST_FUNCTION(sc_json_reader_next_reads_every_kind_of_value)
+    {
+        //arrange
+        SC_JSON_TOKEN tokens[TEST_MAX_TOKENS];
+        SC_JSON_TOKEN last_token;
+
+        //act
+        size_t count = read_all_tokens("[\"text\", 0, -12.5e+3, true, false, null]", tokens, &last_token);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END, last_token);
+        ASSERT_ARE_EQUAL(size_t, 8, count);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_BEGIN_ARRAY, tokens[0]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_STRING, tokens[1]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_NUMBER, tokens[2]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_NUMBER, tokens[3]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_TRUE, tokens[4]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_FALSE, tokens[5]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_NULL, tokens[6]);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END_ARRAY, tokens[7]);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_006: [ sc_json_reader_next shall return SC_JSON_TOKEN_END once the single value of the text has been read and only whitespace is left. ] */
+    /* Tests_SRS_SC_JSON_READER_09_009: [ Once sc_json_reader_next has returned SC_JSON_TOKEN_END or SC_JSON_TOKEN_ERROR, it shall return the same token on every later call. ] */
+    TEST_FUNCTION(sc_json_reader_next_keeps_returning_end)
+    {
+        //arrange
+        SC_JSON_READER reader;
+        (void)sc_json_reader_init(&reader, "\"only\"  ", 8);
+        (void)sc_json_reader_next(&reader);
+
+        //act
+        SC_JSON_TOKEN first = sc_json_reader_next(&reader);
+        SC_JSON_TOKEN second = sc_json_reader_next(&reader);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END, first);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END, second);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_007: [ If the text is not valid JSON, sc_json_reader_next shall return SC_JSON_TOKEN_ERROR. ] */
+    TEST_FUNCTION(sc_json_reader_next_empty_text_fails)
+    {
+        assert_invalid_json("");
+        assert_invalid_json("   ");
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_007: [ If the text is not valid JSON, sc_json_reader_next shall return SC_JSON_TOKEN_ERROR. ] */
+    TEST_FUNCTION(sc_json_reader_next_truncated_text_fails)
+    {
+        assert_invalid_json("[");
+        assert_invalid_json("{\"a\":");
+        assert_invalid_json("{\"a\":\"unterminated");
+        assert_invalid_json("[\"\\u00");
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_007: [ If the text is not valid JSON, sc_json_reader_next shall return SC_JSON_TOKEN_ERROR. ] */
+    TEST_FUNCTION(sc_json_reader_next_misplaced_separator_fails)
+    {
+        assert_invalid_json("{\"a\":1,}");
+        assert_invalid_json("[1,]");
+        assert_invalid_json("[,1]");
+        assert_invalid_json("[1 2]");
+        assert_invalid_json("{\"a\" 1}");
+        assert_invalid_json("{1:2}");
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_007: [ If the text is not valid JSON, sc_json_reader_next shall return SC_JSON_TOKEN_ERROR. ] */
+    TEST_FUNCTION(sc_json_reader_next_mismatched_closing_token_fails)
+    {
+        assert_invalid_json("{\"a\":1]");
+        assert_invalid_json("[1}");
+        assert_invalid_json("]");
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_007: [ If the text is not valid JSON, sc_json_reader_next shall return SC_JSON_TOKEN_ERROR. ] */
+    TEST_FUNCTION(sc_json_reader_next_invalid_value_fails)
+    {
+        assert_invalid_json("[01]");
+        assert_invalid_json("[1.]");
+        assert_invalid_json("[1e]");
+        assert_invalid_json("[-]");
+        assert_invalid_json("[tru]");
+        assert_invalid_json("['a']");
+        assert_invalid_json("[\"\\x\"]");
+        assert_invalid_json("[\"\\u12g4\"]");
+        assert_invalid_json("[\"a\tb\"]");
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_007: [ If the text is not valid JSON, sc_json_reader_next shall return SC_JSON_TOKEN_ERROR. ] */
+    TEST_FUNCTION(sc_json_reader_next_text_after_the_value_fails)
+    {
+        assert_invalid_json("[1] [2]");
+        assert_invalid_json("{} x");
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_008: [ If objects and arrays are nested deeper than SC_JSON_READER_MAX_DEPTH, sc_json_reader_next shall return SC_JSON_TOKEN_ERROR. ] */
+    TEST_FUNCTION(sc_json_reader_next_too_deep_fails)
+    {
+        //arrange
+        char json[(SC_JSON_READER_MAX_DEPTH + 1) * 2 + 1];
+        SC_JSON_TOKEN last_token;
+        memset(json, '[', SC_JSON_READER_MAX_DEPTH + 1);
+        memset(json + SC_JSON_READER_MAX_DEPTH + 1, ']', SC_JSON_READER_MAX_DEPTH + 1);
+        json[sizeof(json) - 1] = '\0';
+
+        //act
+        size_t count = read_all_tokens(json, NULL, &last_token);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_ERROR, last_token);
+        ASSERT_ARE_EQUAL(size_t, SC_JSON_READER_MAX_DEPTH, count);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_008: [ If objects and arrays are nested deeper than SC_JSON_READER_MAX_DEPTH, sc_json_reader_next shall return SC_JSON_TOKEN_ERROR. ] */
+    TEST_FUNCTION(sc_json_reader_next_max_depth_succeeds)
+    {
+        //arrange
+        char json[SC_JSON_READER_MAX_DEPTH * 2 + 1];
+        SC_JSON_TOKEN last_token;
+        memset(json, '[', SC_JSON_READER_MAX_DEPTH);
+        memset(json + SC_JSON_READER_MAX_DEPTH, ']', SC_JSON_READER_MAX_DEPTH);
+        json[sizeof(json) - 1] = '\0';
+
+        //act
+        size_t count = read_all_tokens(json, NULL, &last_token);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END, last_token);
+        ASSERT_ARE_EQUAL(size_t, SC_JSON_READER_MAX_DEPTH * 2, count);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_009: [ Once sc_json_reader_next has returned SC_JSON_TOKEN_END or SC_JSON_TOKEN_ERROR, it shall return the same token on every later call. ] */
+    TEST_FUNCTION(sc_json_reader_next_keeps_returning_error)
+    {
+        //arrange
+        SC_JSON_READER reader;
+        (void)sc_json_reader_init(&reader, "[x, 1]", 6);
+        (void)sc_json_reader_next(&reader);
+
+        //act
+        SC_JSON_TOKEN first = sc_json_reader_next(&reader);
+        SC_JSON_TOKEN second = sc_json_reader_next(&reader);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_ERROR, first);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_ERROR, second);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_010: [ If reader is NULL, sc_json_reader_get_value shall return NULL. ] */
+    TEST_FUNCTION(sc_json_reader_get_value_reader_NULL_fails)
+    {
+        //arrange
+
+        //act
+        const SC_JSON_VALUE* result = sc_json_reader_get_value(NULL);
+
+        //assert
+        ASSERT_IS_NULL(result);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_011: [ After a SC_JSON_TOKEN_NAME or a SC_JSON_TOKEN_STRING, sc_json_reader_get_value shall return the text between the quotes, still escaped, and whether it contains escape sequences. ] */
+    TEST_FUNCTION(sc_json_reader_get_value_returns_names_and_strings)
+    {
+        //arrange
+        static const char json[] = "{\"name\":\"a\\\"b\"}";
+        SC_JSON_READER reader;
+        const SC_JSON_VALUE* name;
+        const SC_JSON_VALUE* string;
+        (void)sc_json_reader_init(&reader, json, sizeof(json) - 1);
+        (void)sc_json_reader_next(&reader);
+
+        //act
+        (void)sc_json_reader_next(&reader);
+        name = sc_json_reader_get_value(&reader);
+        ASSERT_IS_NOT_NULL(name);
+        ASSERT_ARE_EQUAL(size_t, 4, name->length);
+        ASSERT_IS_TRUE(strncmp(name->text, "name", 4) == 0);
+        ASSERT_IS_FALSE(name->is_escaped);
+
+        (void)sc_json_reader_next(&reader);
+        string = sc_json_reader_get_value(&reader);
+
+        //assert
+        ASSERT_IS_NOT_NULL(string);
+        ASSERT_ARE_EQUAL(size_t, 4, string->length);
+        ASSERT_IS_TRUE(strncmp(string->text, "a\\\"b", 4) == 0);
+        ASSERT_IS_TRUE(string->is_escaped);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_012: [ After a SC_JSON_TOKEN_NUMBER, sc_json_reader_get_value shall return the text of the number. ] */
+    TEST_FUNCTION(sc_json_reader_get_value_returns_numbers)
+    {
+        //arrange
+        SC_JSON_READER reader;
+        const SC_JSON_VALUE* result;
+        (void)sc_json_reader_init(&reader, "[-1.5e3]", 8);
+        (void)sc_json_reader_next(&reader);
+        (void)sc_json_reader_next(&reader);
+
+        //act
+        result = sc_json_reader_get_value(&reader);
+
+        //assert
+        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(size_t, 6, result->length);
+        ASSERT_IS_TRUE(strncmp(result->text, "-1.5e3", 6) == 0);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_013: [ After any other token, sc_json_reader_get_value shall return NULL. ] */
+    TEST_FUNCTION(sc_json_reader_get_value_returns_NULL_for_other_tokens)
+    {
+        //arrange
+        SC_JSON_READER reader;
+        (void)sc_json_reader_init(&reader, "[\"a\",true]", 10);
+        (void)sc_json_reader_next(&reader);
+        (void)sc_json_reader_next(&reader);
+
+        //act
+        (void)sc_json_reader_next(&reader);
+        const SC_JSON_VALUE* after_true = sc_json_reader_get_value(&reader);
+        (void)sc_json_reader_next(&reader);
+        const SC_JSON_VALUE* after_end_array = sc_json_reader_get_value(&reader);
+
+        //assert
+        ASSERT_IS_NULL(after_true);
+        ASSERT_IS_NULL(after_end_array);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_014: [ If reader is NULL, sc_json_reader_skip shall fail and return a non-zero value. ] */
+    TEST_FUNCTION(sc_json_reader_skip_reader_NULL_fails)
+    {
+        //arrange
+
+        //act
+        int result = sc_json_reader_skip(NULL, SC_JSON_TOKEN_BEGIN_OBJECT);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_015: [ If token is SC_JSON_TOKEN_BEGIN_OBJECT or SC_JSON_TOKEN_BEGIN_ARRAY, sc_json_reader_skip shall read up to and including the matching closing token and return 0. ] */
+    TEST_FUNCTION(sc_json_reader_skip_skips_nested_values)
+    {
+        //arrange
+        static const char json[] = "{\"skipped\":{\"a\":[1,{\"b\":[]}],\"c\":{}},\"kept\":2}";
+        SC_JSON_READER reader;
+        SC_JSON_TOKEN token;
+        (void)sc_json_reader_init(&reader, json, sizeof(json) - 1);
+        (void)sc_json_reader_next(&reader);
+        (void)sc_json_reader_next(&reader);
+        token = sc_json_reader_next(&reader);
+
+        //act
+        int result = sc_json_reader_skip(&reader, token);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_NAME, sc_json_reader_next(&reader));
+        ASSERT_IS_TRUE(sc_json_value_equals(sc_json_reader_get_value(&reader), "kept"));
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_NUMBER, sc_json_reader_next(&reader));
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END_OBJECT, sc_json_reader_next(&reader));
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_END, sc_json_reader_next(&reader));
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_016: [ If the skipped object or array is not valid JSON, sc_json_reader_skip shall fail and return a non-zero value. ] */
+    TEST_FUNCTION(sc_json_reader_skip_invalid_value_fails)
+    {
+        //arrange
+        static const char json[] = "[[1,2}]";
+        SC_JSON_READER reader;
+        SC_JSON_TOKEN token;
+        (void)sc_json_reader_init(&reader, json, sizeof(json) - 1);
+        (void)sc_json_reader_next(&reader);
+        token = sc_json_reader_next(&reader);
+
+        //act
+        int result = sc_json_reader_skip(&reader, token);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_016: [ If the skipped object or array is not valid JSON, sc_json_reader_skip shall fail and return a non-zero value. ] */
+    TEST_FUNCTION(sc_json_reader_skip_truncated_value_fails)
+    {
+        //arrange
+        static const char json[] = "{\"a\":[1,2";
+        SC_JSON_READER reader;
+        SC_JSON_TOKEN token;
+        (void)sc_json_reader_init(&reader, json, sizeof(json) - 1);
+        (void)sc_json_reader_next(&reader);
+        (void)sc_json_reader_next(&reader);
+        token = sc_json_reader_next(&reader);
+
+        //act
+        int result = sc_json_reader_skip(&reader, token);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_017: [ If token is a string, a number, true, false or null, sc_json_reader_skip shall return 0 without reading anything. ] */
+    TEST_FUNCTION(sc_json_reader_skip_scalar_does_nothing)
+    {
+        //arrange
+        SC_JSON_READER reader;
+        SC_JSON_TOKEN token;
+        (void)sc_json_reader_init(&reader, "[null,2]", 8);
+        (void)sc_json_reader_next(&reader);
+        token = sc_json_reader_next(&reader);
+
+        //act
+        int result = sc_json_reader_skip(&reader, token);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(int, SC_JSON_TOKEN_NUMBER, sc_json_reader_next(&reader));
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_018: [ If token does not start a value, sc_json_reader_skip shall fail and return a non-zero value. ] */
+    TEST_FUNCTION(sc_json_reader_skip_closing_token_fails)
+    {
+        //arrange
+        SC_JSON_READER reader;
+        SC_JSON_TOKEN token;
+        (void)sc_json_reader_init(&reader, "[]", 2);
+        (void)sc_json_reader_next(&reader);
+        token = sc_json_reader_next(&reader);
+
+        //act
+        int result = sc_json_reader_skip(&reader, token);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_019: [ If value or text is NULL, sc_json_value_equals shall return false. ] */
+    TEST_FUNCTION(sc_json_value_equals_NULL_fails)
+    {
+        //arrange
+        SC_JSON_VALUE value = { "a", 1, false };
+
+        //act
+        bool value_NULL = sc_json_value_equals(NULL, "a");
+        bool text_NULL = sc_json_value_equals(&value, NULL);
+
+        //assert
+        ASSERT_IS_FALSE(value_NULL);
+        ASSERT_IS_FALSE(text_NULL);
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_020: [ sc_json_value_equals shall return true if the unescaped value is equal to text, and false otherwise, without allocating. ] */
+    TEST_FUNCTION(sc_json_value_equals_compares_plain_values)
+    {
+        //arrange
+        SC_JSON_VALUE value = { "deviceIdAndMore", 8, false };
+
+        //act
+        bool same = sc_json_value_equals(&value, "deviceId");
+        bool longer = sc_json_value_equals(&value, "deviceIdA");
+        bool shorter = sc_json_value_equals(&value, "device");
+        bool different = sc_json_value_equals(&value, "moduleId");
+
+        //assert
+        ASSERT_IS_TRUE(same);
+        ASSERT_IS_FALSE(longer);
+        ASSERT_IS_FALSE(shorter);
+        ASSERT_IS_FALSE(different);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_020: [ sc_json_value_equals shall return true if the unescaped value is equal to text, and false otherwise, without allocating. ] */
+    TEST_FUNCTION(sc_json_value_equals_compares_escaped_values)
+    {
+        //arrange
+        static const char escaped[] = "a\\/b\\u00e9";
+        SC_JSON_VALUE value = { escaped, sizeof(escaped) - 1, true };
+
+        //act
+        bool same = sc_json_value_equals(&value, "a/b\xc3\xa9");
+        bool raw = sc_json_value_equals(&value, escaped);
+        bool shorter = sc_json_value_equals(&value, "a/b");
+
+        //assert
+        ASSERT_IS_TRUE(same);
+        ASSERT_IS_FALSE(raw);
+        ASSERT_IS_FALSE(shorter);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_024: [ A value holding an escaped NUL character (\u0000) cannot be equal to a NULL terminated string, sc_json_value_equals shall return false for it. ] */
+    TEST_FUNCTION(sc_json_value_equals_escaped_NUL_never_matches)
+    {
+        //arrange
+        static const char escaped[] = "ab\\u0000cd";
+        static const char prefix[] = "ab";
+        SC_JSON_VALUE value = { escaped, sizeof(escaped) - 1, true };
+
+        //act
+        bool prefix_only = sc_json_value_equals(&value, prefix);
+        bool whole = sc_json_value_equals(&value, "ab\0cd");
+
+        //assert
+        ASSERT_IS_FALSE(prefix_only);
+        ASSERT_IS_FALSE(whole);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_021: [ If value or destination is NULL, sc_json_value_copy shall fail and return a non-zero value. ] */
+    TEST_FUNCTION(sc_json_value_copy_NULL_fails)
+    {
+        //arrange
+        SC_JSON_VALUE value = { "a", 1, false };
+        char* destination = NULL;
+
+        //act
+        int value_NULL = sc_json_value_copy(NULL, &destination);
+        int destination_NULL = sc_json_value_copy(&value, NULL);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, value_NULL);
+        ASSERT_ARE_NOT_EQUAL(int, 0, destination_NULL);
+        ASSERT_IS_NULL(destination);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_022: [ sc_json_value_copy shall allocate a NULL terminated copy of value in destination, with every escape sequence replaced by the character it stands for, encoded in UTF-8, and return 0. ] */
+    TEST_FUNCTION(sc_json_value_copy_copies_plain_values)
+    {
+        //arrange
+        SC_JSON_VALUE value = { "theDeviceId\",\"etag\"", 11, false };
+        char* destination = NULL;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(12));
+
+        //act
+        int result = sc_json_value_copy(&value, &destination);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, "theDeviceId", destination);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        free(destination);
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_022: [ sc_json_value_copy shall allocate a NULL terminated copy of value in destination, with every escape sequence replaced by the character it stands for, encoded in UTF-8, and return 0. ] */
+    TEST_FUNCTION(sc_json_value_copy_unescapes_values)
+    {
+        //arrange
+        static const char escaped[] = "\\\"\\\\\\/\\b\\f\\n\\r\\t\\u0041\\u00e9\\u20ac\\ud83d\\ude00";
+        SC_JSON_VALUE value = { escaped, sizeof(escaped) - 1, true };
+        char* destination = NULL;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(escaped)));
+
+        //act
+        int result = sc_json_value_copy(&value, &destination);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, "\"\\/\b\f\n\r\tA\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80", destination);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        free(destination);
+    }
+
+    /* Tests_SRS_SC_JSON_READER_09_023: [ If the allocation fails, sc_json_value_copy shall fail and return a non-zero value. ] */
+    TEST_FUNCTION(sc_json_value_copy_malloc_fails)
+    {
+        //arrange
+        SC_JSON_VALUE value = { "a", 1, false };
+        char* destination = NULL;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(2))
+            .SetReturn(NULL);
+
+        //act
+        int result = sc_json_value_copy(&value, &destination);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_IS_NULL(destination);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+END_TEST_SUITE(iothub_sc_json_reader_ut)
@@ -52,6 +52,10 @@ MOCKABLE_FUNCTION(, char*, prov_auth_construct_sas_token, PROV_AUTH_HANDLE, hand
 MOCKABLE_FUNCTION(, char*, prov_auth_get_certificate, PROV_AUTH_HANDLE, handle);
 MOCKABLE_FUNCTION(, char*, prov_auth_get_alias_key, PROV_AUTH_HANDLE, handle);
 
+// Credentials of this handle only, used in place of the ones the secure device holds for the process
+MOCKABLE_FUNCTION(, int, prov_auth_set_symmetric_key_info, PROV_AUTH_HANDLE, handle, const char*, registration_name, const char*, symmetric_key);
+MOCKABLE_FUNCTION(, int, prov_auth_set_x509_identity, PROV_AUTH_HANDLE, handle, const char*, certificate, const char*, private_key);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef PROV_DEVICE_LL_CLIENT_PRIVATE_H
+#define PROV_DEVICE_LL_CLIENT_PRIVATE_H
+
+#include "umock_c/umock_c_prod.h"
+#include "azure_macro_utils/macro_utils.h"
+#include "azure_prov_client/prov_device_ll_client.h"
+#include "azure_prov_client/internal/prov_auth_client.h"
+#include "azure_prov_client/internal/prov_transport_private.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+* @brief    Creates a Provisioning Client whose registration is carried by a link over a transport connection owned by
+*           the caller.  The client does not drive the connection: the owner calls prov_transport_dowork on it once
+*           for all the clients it carries, before calling Prov_Device_LL_DoWork on each of them.
+*
+* @param    id_scope    The customer specific Id Scope
+* @param    protocol    Function pointer for protocol implementation, it must implement prov_transport_create_link
+* @param    connection  The connection created with the prov_transport_create of protocol
+*
+* @return   A non-NULL PROV_DEVICE_LL_HANDLE value, released with Prov_Device_LL_Destroy before the connection is
+*           destroyed, and NULL on Failure
+*/
+MOCKABLE_FUNCTION(, PROV_DEVICE_LL_HANDLE, prov_device_ll_create_on_connection, const char*, id_scope, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, protocol, PROV_DEVICE_TRANSPORT_HANDLE, connection);
+
+/**
+* @brief    Maps the type of the security module to the type the transports are created with
+*/
+MOCKABLE_FUNCTION(, TRANSPORT_HSM_TYPE, prov_device_ll_get_transport_hsm_type, PROV_AUTH_TYPE, auth_type);
+
+/**
+* @brief    Retrieves how long the client waits before it sends its next operation status request.  Until then
+*           Prov_Device_LL_DoWork has nothing to do for a client created on a connection.
+*
+* @param    handle  The handle created by prov_device_ll_create_on_connection
+*
+* @return   The number of milliseconds left before the status request is due, 0 when the client has work to do now
+*/
+MOCKABLE_FUNCTION(, uint32_t, prov_device_ll_get_poll_delay, PROV_DEVICE_LL_HANDLE, handle);
+
+/**
+* @brief    Gives the client the symmetric key of its device, used instead of the one set for the process with
+*           prov_dev_set_symmetric_key_info.  The security module of the process must be SECURE_DEVICE_TYPE_SYMMETRIC_KEY.
+*
+* @param    handle              The handle of the client
+* @param    registration_id     The registration id the key belongs to
+* @param    symmetric_key       The base64 encoded key of the device
+*
+* @return   PROV_DEVICE_RESULT_OK upon success or an error code upon failure
+*/
+MOCKABLE_FUNCTION(, PROV_DEVICE_RESULT, prov_device_ll_set_symmetric_key, PROV_DEVICE_LL_HANDLE, handle, const char*, registration_id, const char*, symmetric_key);
+
+/**
+* @brief    Gives the client the certificate and private key of its device, used instead of the ones of the x509
+*           security module.  The security module of the process must be SECURE_DEVICE_TYPE_X509.
+*
+* @param    handle          The handle of the client
+* @param    certificate     The PEM certificate chain of the device
+* @param    private_key     The PEM private key of the device
+*
+* @return   PROV_DEVICE_RESULT_OK upon success or an error code upon failure
+*/
+MOCKABLE_FUNCTION(, PROV_DEVICE_RESULT, prov_device_ll_set_x509_identity, PROV_DEVICE_LL_HANDLE, handle, const char*, certificate, const char*, private_key);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif // PROV_DEVICE_LL_CLIENT_PRIVATE_H
@@ -70,6 +70,16 @@ extern "C" {
     typedef int(*pfprov_transport_set_proxy)(PROV_DEVICE_TRANSPORT_HANDLE handle, const HTTP_PROXY_OPTIONS* proxy_option);
     typedef int(*pfprov_transport_set_option)(PROV_DEVICE_TRANSPORT_HANDLE handle, const char* option_name, const void* value);
 
+    // A link carries a single registration over a connection created with prov_transport_create.  Links are opened,
+    // registered, polled and closed like a connection, while the connection alone is driven by prov_transport_dowork
+    // and receives the trace, trusted certificate, proxy and transport options.
+    // None of the HTTP, MQTT and AMQP transports implement links: the Device Provisioning Service authenticates every
+    // connection for one registration id (SASL user name, MQTT user name or TLS client certificate), so a connection
+    // cannot carry a second registration.  The hooks are only implemented by transports that front several
+    // registrations themselves, such as the stand-in used by prov_device_fleet_benchmark.
+    typedef PROV_DEVICE_TRANSPORT_HANDLE(*pfprov_transport_create_link)(PROV_DEVICE_TRANSPORT_HANDLE connection, PROV_TRANSPORT_ERROR_CALLBACK error_cb, void* error_ctx);
+    typedef void(*pfprov_transport_destroy_link)(PROV_DEVICE_TRANSPORT_HANDLE link);
+
     struct PROV_DEVICE_TRANSPORT_PROVIDER_TAG
     {
         pfprov_transport_create prov_transport_create;
@@ -84,6 +94,9 @@ extern "C" {
         pfprov_transport_set_trusted_cert prov_transport_trusted_cert;
         pfprov_transport_set_proxy prov_transport_set_proxy;
         pfprov_transport_set_option prov_transport_set_option;
+        // Optional, NULL when every registration needs a connection of its own, as with the HTTP, MQTT and AMQP transports
+        pfprov_transport_create_link prov_transport_create_link;
+        pfprov_transport_destroy_link prov_transport_destroy_link;
     };
 
 #ifdef __cplusplus
@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef PROV_DEVICE_FLEET_LL_CLIENT_H
+#define PROV_DEVICE_FLEET_LL_CLIENT_H
+
+#include "umock_c/umock_c_prod.h"
+#include "azure_macro_utils/macro_utils.h"
+#include "azure_prov_client/prov_transport.h"
+#include "azure_prov_client/prov_device_ll_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#include <cstddef>
+#else
+#include <stddef.h>
+#endif /* __cplusplus */
+
+typedef struct PROV_DEVICE_FLEET_LL_INFO_TAG* PROV_DEVICE_FLEET_LL_HANDLE;
+
+// Maximum number of registrations in progress at the same time (size_t*), 0 removes the limit
+static const char* const PROV_FLEET_OPTION_MAX_IN_FLIGHT = "max_in_flight";
+
+#define PROV_FLEET_DEFAULT_MAX_IN_FLIGHT    256
+
+// Credentials of one device.  The kind of attestation is the one set for the process with prov_dev_security_init:
+// symmetric_key with SECURE_DEVICE_TYPE_SYMMETRIC_KEY, x509_certificate and x509_private_key with SECURE_DEVICE_TYPE_X509.
+typedef struct PROV_DEVICE_FLEET_ATTESTATION_TAG
+{
+    const char* symmetric_key;
+    const char* x509_certificate;
+    const char* x509_private_key;
+} PROV_DEVICE_FLEET_ATTESTATION;
+
+/**
+* @brief    Creates a Provisioning Client that registers many devices with the Device Provisioning Service.
+*           When the transport can carry several registrations over one connection, all the registrations
+*           share a single connection; otherwise each registration gets a connection of its own.  The HTTP,
+*           MQTT and AMQP transports authenticate a connection for one registration, so with them every
+*           registration opens its own connection and only the DoWork loop is shared.
+*
+* @param    uri         The URI of the Device Provisioning Service
+* @param    scope_id    The customer specific Id Scope
+* @param    protocol    Function pointer for protocol implementation
+*
+* @return   A non-NULL PROV_DEVICE_FLEET_LL_HANDLE value that is used when invoking other functions
+*           and NULL on Failure
+*/
+MOCKABLE_FUNCTION(, PROV_DEVICE_FLEET_LL_HANDLE, Prov_Device_Fleet_LL_Create, const char*, uri, const char*, scope_id, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, protocol);
+
+/**
+* @brief    Disposes of resources allocated by the fleet provisioning Client.  The registrations that have not
+*           completed are abandoned without calling their callbacks.
+*
+* @param    handle  The handle created by a call to the create function
+*
+*/
+MOCKABLE_FUNCTION(, void, Prov_Device_Fleet_LL_Destroy, PROV_DEVICE_FLEET_LL_HANDLE, handle);
+
+/**
+* @brief    Queues the registration of a device, started by a later call to Prov_Device_Fleet_LL_DoWork.
+*
+* @param    handle              The handle created by a call to the create function.
+* @param    registration_id     The registration id of the device
+* @param    attestation         The credentials of the device, copied by the call.  NULL uses the credentials held
+*                               for the process (prov_dev_set_symmetric_key_info or the x509 security module)
+* @param    register_callback   The callback that gets called on registration or if an error is encountered
+* @param    user_context        User specified context that will be provided to the callback
+* @param    reg_status_cb       An optional registration status callback used to inform the caller of registration status
+* @param    status_user_ctext   User specified context that will be provided to the registration status callback
+*
+* @return PROV_DEVICE_RESULT_OK upon success or an error code upon failure
+*/
+MOCKABLE_FUNCTION(, PROV_DEVICE_RESULT, Prov_Device_Fleet_LL_Register_Device, PROV_DEVICE_FLEET_LL_HANDLE, handle, const char*, registration_id, const PROV_DEVICE_FLEET_ATTESTATION*, attestation, PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, register_callback, void*, user_context, PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, reg_status_cb, void*, status_user_ctext);
+
+/**
+* @brief    Api to be called by user when work (registering devices) can be done.  Drives the shared connection
+*           once, then the registrations in progress, and starts the queued registrations.
+*
+* @param    handle  The handle created by a call to the create function.
+*
+*/
+MOCKABLE_FUNCTION(, void, Prov_Device_Fleet_LL_DoWork, PROV_DEVICE_FLEET_LL_HANDLE, handle);
+
+/**
+* @brief    API sets a runtime option identified by parameter optionName to a value pointed to by value.
+*           When the registrations do not share a connection, only PROV_OPTION_TIMEOUT, PROV_OPTION_LOG_TRACE,
+*           OPTION_TRUSTED_CERT and PROV_FLEET_OPTION_MAX_IN_FLIGHT are supported, and they apply to the
+*           registrations started afterwards.
+*
+* @param    handle          The handle created by a call to the create function.
+* @param    optionName      The name of the option to be set
+* @param    value           A pointer to the value of the option to be set
+*
+* @return PROV_DEVICE_RESULT_OK upon success or an error code upon failure
+*/
+MOCKABLE_FUNCTION(, PROV_DEVICE_RESULT, Prov_Device_Fleet_LL_SetOption, PROV_DEVICE_FLEET_LL_HANDLE, handle, const char*, optionName, const void*, value);
+
+/**
+* @brief    Retrieves the number of registrations that are queued or in progress
+*
+* @param    handle          The handle created by a call to the create function.
+*
+* @return The number of registrations whose callback has not been called yet
+*/
+MOCKABLE_FUNCTION(, size_t, Prov_Device_Fleet_LL_Get_Pending_Count, PROV_DEVICE_FLEET_LL_HANDLE, handle);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif // PROV_DEVICE_FLEET_LL_CLIENT_H
@@ -42,6 +42,12 @@ MU_DEFINE_ENUM(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_VALUE);
 
 MU_DEFINE_ENUM(PROV_DEVICE_REG_STATUS, PROV_DEVICE_REG_STATUS_VALUES);
 
+#define PROV_DEVICE_CACHE_REVALIDATE_VALUES        \
+    PROV_DEVICE_CACHE_REVALIDATE_ON_FAILURE,       \
+    PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND
+
+MU_DEFINE_ENUM(PROV_DEVICE_CACHE_REVALIDATE, PROV_DEVICE_CACHE_REVALIDATE_VALUES);
+
 static const char* const PROV_REGISTRATION_ID = "registration_id";
 static const char* const PROV_OPTION_LOG_TRACE = "logtrace";
 static const char* const PROV_OPTION_TIMEOUT = "provisioning_timeout";
@@ -49,6 +55,9 @@ static const char* const PROV_OPTION_TIMEOUT = "provisioning_timeout";
 typedef void(*PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK)(PROV_DEVICE_RESULT register_result, const char* iothub_uri, const char* device_id, void* user_context);
 typedef void(*PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK)(PROV_DEVICE_REG_STATUS reg_status, void* user_context);
 
+typedef int(*PROV_DEVICE_CLIENT_CACHE_STORE_CALLBACK)(const char* registration_id, const char* cached_result, void* user_context);
+typedef const char*(*PROV_DEVICE_CLIENT_CACHE_LOAD_CALLBACK)(const char* registration_id, void* user_context);
+
 typedef const PROV_DEVICE_TRANSPORT_PROVIDER*(*PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION)(void);
 
 /**
@@ -84,6 +93,38 @@ MOCKABLE_FUNCTION(, void, Prov_Device_LL_Destroy, PROV_DEVICE_LL_HANDLE, handle)
 */
 MOCKABLE_FUNCTION(, PROV_DEVICE_RESULT, Prov_Device_LL_Register_Device, PROV_DEVICE_LL_HANDLE, handle, PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, register_callback, void*, user_context, PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, reg_status_cb, void*, status_user_ctext);
 
+/**
+* @brief    Sets the storage the outcome of successful registrations is persisted to, so that a later
+*           Prov_Device_LL_Register_Device_Cached can skip the round trip to the service.
+*
+* @param    handle              The handle created by a call to the create function.
+* @param    store_callback      Called with the registration id and the serialized result after each successful registration
+* @param    load_callback       Returns the result last stored for the registration id, or NULL.  The string is only
+*                               read before the call returns.
+* @param    user_context        User specified context that will be provided to both callbacks
+*
+* @return PROV_DEVICE_RESULT_OK upon success or an error code upon failure
+*/
+MOCKABLE_FUNCTION(, PROV_DEVICE_RESULT, Prov_Device_LL_Set_Result_Cache, PROV_DEVICE_LL_HANDLE, handle, PROV_DEVICE_CLIENT_CACHE_STORE_CALLBACK, store_callback, PROV_DEVICE_CLIENT_CACHE_LOAD_CALLBACK, load_callback, void*, user_context);
+
+/**
+* @brief    Asynchronous call that registers a device from the result cache when it holds an assignment
+*           for it, and with the service otherwise.
+*
+* @param    handle              The handle created by a call to the create function.
+* @param    revalidate          PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND registers with the service once the cached
+*                               assignment is delivered; register_callback is only called again if the assignment changed.
+*                               With PROV_DEVICE_CACHE_REVALIDATE_ON_FAILURE the service is only contacted when the
+*                               application calls Prov_Device_LL_Register_Device after failing to connect to the hub.
+* @param    register_callback   The callback that gets called on registration or if an error is encountered
+* @param    user_context        User specified context that will be provided to the callback
+* @param    reg_status_cb       An optional registration status callback used to inform the caller of registration status
+* @param    status_user_ctext   User specified context that will be provided to the registration status callback
+*
+* @return PROV_DEVICE_RESULT_OK upon success or an error code upon failure
+*/
+MOCKABLE_FUNCTION(, PROV_DEVICE_RESULT, Prov_Device_LL_Register_Device_Cached, PROV_DEVICE_LL_HANDLE, handle, PROV_DEVICE_CACHE_REVALIDATE, revalidate, PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, register_callback, void*, user_context, PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, reg_status_cb, void*, status_user_ctext);
+
 /**
 * @brief    Api to be called by user when work (registering device) can be done
 *
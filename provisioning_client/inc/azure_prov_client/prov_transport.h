@@ -57,12 +57,17 @@ extern "C" {
         if (retry_after != NULL)
         {
             // Is the retry after a number
-            if (retry_after[0] >= 0x30 || retry_after[0] <= 0x39)
+            if (retry_after[0] >= 0x30 && retry_after[0] <= 0x39)
             {
-                result = atol(retry_after);
-                if (result < PROV_GET_THROTTLE_TIME || result > MAX_PROV_GET_THROTTLE_TIME)
+                long retry_value = atol(retry_after);
+                // A longer wait than the client accepts is shortened, not dropped to the minimum
+                if (retry_value > MAX_PROV_GET_THROTTLE_TIME)
                 {
-                    result = PROV_GET_THROTTLE_TIME;
+                    result = MAX_PROV_GET_THROTTLE_TIME;
+                }
+                else if (retry_value >= PROV_GET_THROTTLE_TIME)
+                {
+                    result = (uint32_t)retry_value;
                 }
             }
             // Will need to parse the retry after for date information
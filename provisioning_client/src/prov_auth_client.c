@@ -41,6 +41,10 @@ typedef struct PROV_AUTH_INFO_TAG
 
     HSM_CLIENT_GET_SYMMETRICAL_KEY hsm_client_get_symm_key;
     HSM_CLIENT_SET_SYMMETRICAL_KEY_INFO hsm_client_set_symm_key_info;
+
+    // Identity given to this handle only, returned instead of the one of the x509 secure device
+    char* x509_certificate;
+    char* x509_private_key;
 } PROV_AUTH_INFO;
 
 static char* encode_value(const uint8_t* msg_digest, size_t digest_len)
@@ -215,6 +219,35 @@ static int sign_sas_data(PROV_AUTH_INFO* auth_info, const char* payload, unsigne
     return result;
 }
 
+static int set_process_symmetric_key(PROV_AUTH_INFO* auth_info)
+{
+    int result;
+    const char* registration_name = prov_dev_get_symm_registration_name();
+    const char* symmetric_key = prov_dev_get_symmetric_key();
+
+    // A handle that is given its own key with prov_auth_set_symmetric_key_info does not need one for the process
+    if (registration_name == NULL && symmetric_key == NULL)
+    {
+        result = 0;
+    }
+    else
+    {
+        result = auth_info->hsm_client_set_symm_key_info(auth_info->hsm_client_handle, registration_name, symmetric_key);
+    }
+    return result;
+}
+
+static char* copy_identity_value(const char* value)
+{
+    char* result;
+    if (mallocAndStrcpy_s(&result, value) != 0)
+    {
+        LogError("Failure allocating the identity value");
+        result = NULL;
+    }
+    return result;
+}
+
 PROV_AUTH_HANDLE prov_auth_create(void)
 {
     PROV_AUTH_INFO* result;
@@ -308,7 +341,7 @@ PROV_AUTH_HANDLE prov_auth_create(void)
                 free(result);
                 result = NULL;
             }
-            else if (result->sec_type == PROV_AUTH_TYPE_KEY && result->hsm_client_set_symm_key_info(result->hsm_client_handle, prov_dev_get_symm_registration_name(), prov_dev_get_symmetric_key()) != 0)
+            else if (result->sec_type == PROV_AUTH_TYPE_KEY && set_process_symmetric_key(result) != 0)
             {
                 LogError("failed create device auth module.");
                 result->hsm_client_destroy(result->hsm_client_handle);
@@ -327,6 +360,8 @@ void prov_auth_destroy(PROV_AUTH_HANDLE handle)
     {
         /* Codes_SRS_PROV_AUTH_CLIENT_07_007: [ prov_auth_destroy shall free all resources allocated in this module. ] */
         free(handle->registration_id);
+        free(handle->x509_certificate);
+        free(handle->x509_private_key);
         handle->hsm_client_destroy(handle->hsm_client_handle);
         /* Codes_SRS_PROV_AUTH_CLIENT_07_006: [ prov_auth_destroy shall free the PROV_AUTH_HANDLE instance. ] */
         free(handle);
@@ -636,8 +671,16 @@ char* prov_auth_get_certificate(PROV_AUTH_HANDLE handle)
     }
     else
     {
-        /* Codes_SRS_SECURE_ENCLAVE_CLIENT_07_031: [ prov_auth_get_certificate shall import the specified cert into the client using hsm_client_get_cert secure enclave function. ] */
-        result = handle->hsm_client_get_cert(handle->hsm_client_handle);
+        /* Codes_SRS_SECURE_ENCLAVE_CLIENT_09_005: [ If an identity was set with prov_auth_set_x509_identity, prov_auth_get_certificate and prov_auth_get_alias_key shall return a copy of it instead of calling the secure enclave. ] */
+        if (handle->x509_certificate != NULL)
+        {
+            result = copy_identity_value(handle->x509_certificate);
+        }
+        else
+        {
+            /* Codes_SRS_SECURE_ENCLAVE_CLIENT_07_031: [ prov_auth_get_certificate shall import the specified cert into the client using hsm_client_get_cert secure enclave function. ] */
+            result = handle->hsm_client_get_cert(handle->hsm_client_handle);
+        }
     }
     return result;
 }
@@ -659,8 +702,85 @@ char* prov_auth_get_alias_key(PROV_AUTH_HANDLE handle)
     }
     else
     {
-        /* Codes_SRS_SECURE_ENCLAVE_CLIENT_07_034: [ prov_auth_get_alias_key shall import the specified alias key into the client using hsm_client_get_ak secure enclave function. ] */
-        result = handle->hsm_client_get_alias_key(handle->hsm_client_handle);
+        /* Codes_SRS_SECURE_ENCLAVE_CLIENT_09_005: [ If an identity was set with prov_auth_set_x509_identity, prov_auth_get_certificate and prov_auth_get_alias_key shall return a copy of it instead of calling the secure enclave. ] */
+        if (handle->x509_private_key != NULL)
+        {
+            result = copy_identity_value(handle->x509_private_key);
+        }
+        else
+        {
+            /* Codes_SRS_SECURE_ENCLAVE_CLIENT_07_034: [ prov_auth_get_alias_key shall import the specified alias key into the client using hsm_client_get_ak secure enclave function. ] */
+            result = handle->hsm_client_get_alias_key(handle->hsm_client_handle);
+        }
+    }
+    return result;
+}
+
+int prov_auth_set_symmetric_key_info(PROV_AUTH_HANDLE handle, const char* registration_name, const char* symmetric_key)
+{
+    int result;
+    if (handle == NULL || registration_name == NULL || symmetric_key == NULL)
+    {
+        /* Codes_SRS_SECURE_ENCLAVE_CLIENT_09_001: [ If handle, registration_name or symmetric_key is NULL, prov_auth_set_symmetric_key_info shall return a non-zero value. ] */
+        LogError("Invalid parameter specified handle: %p, registration_name: %p, symmetric_key: %p", handle, registration_name, symmetric_key);
+        result = MU_FAILURE;
+    }
+    else if (handle->sec_type != PROV_AUTH_TYPE_KEY)
+    {
+        /* Codes_SRS_SECURE_ENCLAVE_CLIENT_09_002: [ If the sec_type is not PROV_AUTH_TYPE_KEY, prov_auth_set_symmetric_key_info shall return a non-zero value. ] */
+        LogError("Invalid type for operation");
+        result = MU_FAILURE;
+    }
+    else if (handle->hsm_client_set_symm_key_info(handle->hsm_client_handle, registration_name, symmetric_key) != 0)
+    {
+        LogError("Failure setting the symmetric key on the secure enclave");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        /* Codes_SRS_SECURE_ENCLAVE_CLIENT_09_003: [ prov_auth_set_symmetric_key_info shall give the key to the secure enclave of this handle only, with hsm_client_set_symm_key_info. ] */
+        result = 0;
+    }
+    return result;
+}
+
+int prov_auth_set_x509_identity(PROV_AUTH_HANDLE handle, const char* certificate, const char* private_key)
+{
+    int result;
+    if (handle == NULL || certificate == NULL || private_key == NULL)
+    {
+        /* Codes_SRS_SECURE_ENCLAVE_CLIENT_09_004: [ If handle, certificate or private_key is NULL, or the sec_type is not PROV_AUTH_TYPE_X509, prov_auth_set_x509_identity shall return a non-zero value. ] */
+        LogError("Invalid parameter specified handle: %p, certificate: %p, private_key: %p", handle, certificate, private_key);
+        result = MU_FAILURE;
+    }
+    else if (handle->sec_type != PROV_AUTH_TYPE_X509)
+    {
+        /* Codes_SRS_SECURE_ENCLAVE_CLIENT_09_004: [ If handle, certificate or private_key is NULL, or the sec_type is not PROV_AUTH_TYPE_X509, prov_auth_set_x509_identity shall return a non-zero value. ] */
+        LogError("Invalid type for operation");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        char* temp_certificate;
+        char* temp_private_key;
+        if ((temp_certificate = copy_identity_value(certificate)) == NULL)
+        {
+            result = MU_FAILURE;
+        }
+        else if ((temp_private_key = copy_identity_value(private_key)) == NULL)
+        {
+            free(temp_certificate);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            /* Codes_SRS_SECURE_ENCLAVE_CLIENT_09_005: [ If an identity was set with prov_auth_set_x509_identity, prov_auth_get_certificate and prov_auth_get_alias_key shall return a copy of it instead of calling the secure enclave. ] */
+            free(handle->x509_certificate);
+            free(handle->x509_private_key);
+            handle->x509_certificate = temp_certificate;
+            handle->x509_private_key = temp_private_key;
+            result = 0;
+        }
     }
     return result;
 }
@@ -0,0 +1,782 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/tickcounter.h"
+
+#include "azure_prov_client/internal/prov_transport_private.h"
+#include "azure_prov_client/internal/prov_device_ll_client_private.h"
+#include "azure_prov_client/prov_device_ll_client.h"
+#include "azure_prov_client/prov_device_fleet_ll_client.h"
+#include "azure_prov_client/prov_client_const.h"
+#include "azure_prov_client/prov_security_factory.h"
+
+typedef enum FLEET_DEVICE_STATE_TAG
+{
+    FLEET_DEVICE_STATE_QUEUED,
+    FLEET_DEVICE_STATE_REGISTERING,
+    FLEET_DEVICE_STATE_COMPLETE
+} FLEET_DEVICE_STATE;
+
+typedef struct FLEET_DEVICE_INFO_TAG
+{
+    struct PROV_DEVICE_FLEET_LL_INFO_TAG* fleet;
+    FLEET_DEVICE_STATE state;
+
+    char* registration_id;
+    // Credentials of this device, NULL when the ones held for the process are used
+    char* symmetric_key;
+    char* x509_certificate;
+    char* x509_private_key;
+    PROV_DEVICE_LL_HANDLE prov_handle;
+    // Parked in the poll heap, not driven until its operation status request is due
+    bool waiting_for_poll;
+
+    PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK register_callback;
+    void* user_context;
+    PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK register_status_cb;
+    void* status_user_ctx;
+} FLEET_DEVICE_INFO;
+
+typedef struct FLEET_POLL_ENTRY_TAG
+{
+    tickcounter_ms_t deadline;
+    // NULL once the device completed and was destroyed while parked, the entry is dropped when it is popped
+    FLEET_DEVICE_INFO* device;
+} FLEET_POLL_ENTRY;
+
+typedef struct PROV_DEVICE_FLEET_LL_INFO_TAG
+{
+    char* uri;
+    char* scope_id;
+    PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol;
+    const PROV_DEVICE_TRANSPORT_PROVIDER* prov_transport_protocol;
+
+    // The connection every registration is linked to, NULL when the transport has no links (HTTP, MQTT and AMQP)
+    PROV_DEVICE_TRANSPORT_HANDLE connection;
+
+    // Kept in the order the registrations were requested, the ones that completed are removed at the end of DoWork
+    FLEET_DEVICE_INFO** devices;
+    size_t device_count;
+    size_t device_capacity;
+    size_t registering_count;
+
+    // Min-heap on the operation status deadline of the registrations waiting to poll, shared connection only
+    TICK_COUNTER_HANDLE tick_counter;
+    FLEET_POLL_ENTRY* poll_heap;
+    size_t poll_count;
+    size_t poll_capacity;
+
+    size_t max_in_flight;
+    uint8_t prov_timeout;
+    bool log_trace;
+    char* trusted_cert;
+} PROV_DEVICE_FLEET_LL_INFO;
+
+static void on_connection_error(PROV_DEVICE_TRANSPORT_ERROR transport_error, void* user_ctx)
+{
+    (void)user_ctx;
+    LogError("Failure reported by the shared provisioning connection: %d", (int)transport_error);
+}
+
+static void on_fleet_device_registered(PROV_DEVICE_RESULT register_result, const char* iothub_uri, const char* device_id, void* user_context)
+{
+    FLEET_DEVICE_INFO* device = (FLEET_DEVICE_INFO*)user_context;
+
+    /* Codes_SRS_PROV_DEVICE_FLEET_09_016: [ When the registration of a device completes, its register_callback shall be called with the result, the IoTHub uri and the device id. ] */
+    device->state = FLEET_DEVICE_STATE_COMPLETE;
+    device->fleet->registering_count--;
+    device->register_callback(register_result, iothub_uri, device_id, device->user_context);
+}
+
+static void complete_device_with_error(FLEET_DEVICE_INFO* device, PROV_DEVICE_RESULT register_result)
+{
+    device->state = FLEET_DEVICE_STATE_COMPLETE;
+    device->register_callback(register_result, NULL, NULL, device->user_context);
+}
+
+static int apply_device_options(PROV_DEVICE_FLEET_LL_INFO* fleet_info, PROV_DEVICE_LL_HANDLE prov_handle)
+{
+    int result;
+    if (fleet_info->prov_timeout > 0 && Prov_Device_LL_SetOption(prov_handle, PROV_OPTION_TIMEOUT, &fleet_info->prov_timeout) != PROV_DEVICE_RESULT_OK)
+    {
+        LogError("Failure setting the provisioning timeout");
+        result = MU_FAILURE;
+    }
+    else if (fleet_info->connection == NULL && fleet_info->trusted_cert != NULL && Prov_Device_LL_SetOption(prov_handle, OPTION_TRUSTED_CERT, fleet_info->trusted_cert) != PROV_DEVICE_RESULT_OK)
+    {
+        LogError("Failure setting the trusted certificate");
+        result = MU_FAILURE;
+    }
+    else if (fleet_info->connection == NULL && fleet_info->log_trace && Prov_Device_LL_SetOption(prov_handle, PROV_OPTION_LOG_TRACE, &fleet_info->log_trace) != PROV_DEVICE_RESULT_OK)
+    {
+        LogError("Failure setting the log trace");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static int apply_device_credentials(FLEET_DEVICE_INFO* device, PROV_DEVICE_LL_HANDLE prov_handle)
+{
+    int result;
+    if (device->symmetric_key != NULL && prov_device_ll_set_symmetric_key(prov_handle, device->registration_id, device->symmetric_key) != PROV_DEVICE_RESULT_OK)
+    {
+        LogError("Failure setting the symmetric key");
+        result = MU_FAILURE;
+    }
+    else if (device->x509_certificate != NULL && prov_device_ll_set_x509_identity(prov_handle, device->x509_certificate, device->x509_private_key) != PROV_DEVICE_RESULT_OK)
+    {
+        LogError("Failure setting the x509 identity");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static void start_device_registration(PROV_DEVICE_FLEET_LL_INFO* fleet_info, FLEET_DEVICE_INFO* device)
+{
+    PROV_DEVICE_LL_HANDLE prov_handle;
+
+    /* Codes_SRS_PROV_DEVICE_FLEET_09_013: [ To start a registration Prov_Device_Fleet_LL_DoWork shall create a provisioning client with prov_device_ll_create_on_connection when the fleet has a shared connection, with Prov_Device_LL_Create otherwise. ] */
+    if (fleet_info->connection != NULL)
+    {
+        prov_handle = prov_device_ll_create_on_connection(fleet_info->scope_id, fleet_info->protocol, fleet_info->connection);
+    }
+    else
+    {
+        prov_handle = Prov_Device_LL_Create(fleet_info->uri, fleet_info->scope_id, fleet_info->protocol);
+    }
+
+    if (prov_handle == NULL)
+    {
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_015: [ If a registration cannot be started, its register_callback shall be called with PROV_DEVICE_RESULT_ERROR. ] */
+        LogError("Failure creating the provisioning client of %s", device->registration_id);
+        complete_device_with_error(device, PROV_DEVICE_RESULT_ERROR);
+    }
+    else
+    {
+        device->prov_handle = prov_handle;
+
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_014: [ Prov_Device_Fleet_LL_DoWork shall apply the stored options and the registration id to the client, then call Prov_Device_LL_Register_Device. ] */
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_028: [ Before registering, Prov_Device_Fleet_LL_DoWork shall give the client the credentials of the device with prov_device_ll_set_symmetric_key or prov_device_ll_set_x509_identity. ] */
+        if (apply_device_options(fleet_info, prov_handle) != 0 ||
+            Prov_Device_LL_SetOption(prov_handle, PROV_REGISTRATION_ID, device->registration_id) != PROV_DEVICE_RESULT_OK ||
+            apply_device_credentials(device, prov_handle) != 0)
+        {
+            /* Codes_SRS_PROV_DEVICE_FLEET_09_015: [ If a registration cannot be started, its register_callback shall be called with PROV_DEVICE_RESULT_ERROR. ] */
+            LogError("Failure setting the options of %s", device->registration_id);
+            complete_device_with_error(device, PROV_DEVICE_RESULT_ERROR);
+        }
+        else if (Prov_Device_LL_Register_Device(prov_handle, on_fleet_device_registered, device, device->register_status_cb, device->status_user_ctx) != PROV_DEVICE_RESULT_OK)
+        {
+            /* Codes_SRS_PROV_DEVICE_FLEET_09_015: [ If a registration cannot be started, its register_callback shall be called with PROV_DEVICE_RESULT_ERROR. ] */
+            LogError("Failure registering %s", device->registration_id);
+            complete_device_with_error(device, PROV_DEVICE_RESULT_ERROR);
+        }
+        else
+        {
+            device->state = FLEET_DEVICE_STATE_REGISTERING;
+            fleet_info->registering_count++;
+        }
+    }
+}
+
+static int grow_device_list(PROV_DEVICE_FLEET_LL_INFO* fleet_info)
+{
+    int result;
+    size_t new_capacity = (fleet_info->device_capacity == 0) ? 16 : fleet_info->device_capacity * 2;
+    FLEET_DEVICE_INFO** new_devices;
+
+    if (new_capacity > SIZE_MAX / sizeof(FLEET_DEVICE_INFO*))
+    {
+        LogError("too many devices");
+        result = MU_FAILURE;
+    }
+    else if ((new_devices = (FLEET_DEVICE_INFO**)realloc(fleet_info->devices, new_capacity * sizeof(FLEET_DEVICE_INFO*))) == NULL)
+    {
+        LogError("unable to grow the device list");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        fleet_info->devices = new_devices;
+        fleet_info->device_capacity = new_capacity;
+        result = 0;
+    }
+    return result;
+}
+
+static int push_poll_deadline(PROV_DEVICE_FLEET_LL_INFO* fleet_info, tickcounter_ms_t deadline, FLEET_DEVICE_INFO* device)
+{
+    int result;
+
+    if (fleet_info->poll_count == fleet_info->poll_capacity)
+    {
+        size_t new_capacity = (fleet_info->poll_capacity == 0) ? 16 : fleet_info->poll_capacity * 2;
+        FLEET_POLL_ENTRY* new_heap;
+
+        if (new_capacity > SIZE_MAX / sizeof(FLEET_POLL_ENTRY) ||
+            (new_heap = (FLEET_POLL_ENTRY*)realloc(fleet_info->poll_heap, new_capacity * sizeof(FLEET_POLL_ENTRY))) == NULL)
+        {
+            LogError("unable to grow the poll heap");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            fleet_info->poll_heap = new_heap;
+            fleet_info->poll_capacity = new_capacity;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        size_t index = fleet_info->poll_count++;
+
+        // Sift up
+        while (index > 0 && fleet_info->poll_heap[(index - 1) / 2].deadline > deadline)
+        {
+            fleet_info->poll_heap[index] = fleet_info->poll_heap[(index - 1) / 2];
+            index = (index - 1) / 2;
+        }
+        fleet_info->poll_heap[index].deadline = deadline;
+        fleet_info->poll_heap[index].device = device;
+        device->waiting_for_poll = true;
+    }
+    return result;
+}
+
+static void pop_poll_deadline(PROV_DEVICE_FLEET_LL_INFO* fleet_info)
+{
+    FLEET_POLL_ENTRY last = fleet_info->poll_heap[--fleet_info->poll_count];
+    size_t index = 0;
+
+    if (fleet_info->poll_heap[0].device != NULL)
+    {
+        fleet_info->poll_heap[0].device->waiting_for_poll = false;
+    }
+
+    // Sift the last entry down from the root
+    while (2 * index + 1 < fleet_info->poll_count)
+    {
+        size_t child = 2 * index + 1;
+        if (child + 1 < fleet_info->poll_count && fleet_info->poll_heap[child + 1].deadline < fleet_info->poll_heap[child].deadline)
+        {
+            child++;
+        }
+        if (fleet_info->poll_heap[child].deadline >= last.deadline)
+        {
+            break;
+        }
+        fleet_info->poll_heap[index] = fleet_info->poll_heap[child];
+        index = child;
+    }
+    if (fleet_info->poll_count > 0)
+    {
+        fleet_info->poll_heap[index] = last;
+    }
+}
+
+static void release_due_polls(PROV_DEVICE_FLEET_LL_INFO* fleet_info)
+{
+    tickcounter_ms_t current_time;
+
+    if (tickcounter_get_current_ms(fleet_info->tick_counter, &current_time) != 0)
+    {
+        // Without a clock every registration is driven again, they hold their own deadline
+        LogError("Failure getting the current time");
+        while (fleet_info->poll_count > 0)
+        {
+            pop_poll_deadline(fleet_info);
+        }
+    }
+    else
+    {
+        while (fleet_info->poll_count > 0 && fleet_info->poll_heap[0].deadline <= current_time)
+        {
+            pop_poll_deadline(fleet_info);
+        }
+    }
+}
+
+static void park_device_until_poll(PROV_DEVICE_FLEET_LL_INFO* fleet_info, FLEET_DEVICE_INFO* device)
+{
+    uint32_t poll_delay = prov_device_ll_get_poll_delay(device->prov_handle);
+    tickcounter_ms_t current_time;
+
+    if (poll_delay > 0 && tickcounter_get_current_ms(fleet_info->tick_counter, &current_time) == 0)
+    {
+        // On failure the registration is simply driven on every DoWork
+        (void)push_poll_deadline(fleet_info, current_time + poll_delay, device);
+    }
+}
+
+static void forget_poll_deadline(PROV_DEVICE_FLEET_LL_INFO* fleet_info, FLEET_DEVICE_INFO* device)
+{
+    size_t index;
+
+    // Leaves a tombstone so the heap order is untouched, pop_poll_deadline drops it when its deadline comes
+    for (index = 0; index < fleet_info->poll_count; index++)
+    {
+        if (fleet_info->poll_heap[index].device == device)
+        {
+            fleet_info->poll_heap[index].device = NULL;
+            break;
+        }
+    }
+    device->waiting_for_poll = false;
+}
+
+static void destroy_device(FLEET_DEVICE_INFO* device)
+{
+    if (device->prov_handle != NULL)
+    {
+        Prov_Device_LL_Destroy(device->prov_handle);
+    }
+    free(device->registration_id);
+    free(device->symmetric_key);
+    free(device->x509_certificate);
+    free(device->x509_private_key);
+    free(device);
+}
+
+static void remove_completed_devices(PROV_DEVICE_FLEET_LL_INFO* fleet_info)
+{
+    size_t index;
+    size_t kept = 0;
+
+    for (index = 0; index < fleet_info->device_count; index++)
+    {
+        FLEET_DEVICE_INFO* device = fleet_info->devices[index];
+        if (device->state == FLEET_DEVICE_STATE_COMPLETE)
+        {
+            /* Codes_SRS_PROV_DEVICE_FLEET_09_027: [ A registration that completes while it waits to poll shall be removed from the poll schedule before it is destroyed. ] */
+            if (device->waiting_for_poll)
+            {
+                forget_poll_deadline(fleet_info, device);
+            }
+            destroy_device(device);
+        }
+        else
+        {
+            fleet_info->devices[kept++] = device;
+        }
+    }
+    fleet_info->device_count = kept;
+}
+
+static void destroy_fleet(PROV_DEVICE_FLEET_LL_INFO* fleet_info)
+{
+    size_t index;
+    for (index = 0; index < fleet_info->device_count; index++)
+    {
+        destroy_device(fleet_info->devices[index]);
+    }
+    free(fleet_info->devices);
+    free(fleet_info->poll_heap);
+
+    // The links are gone, the connection can follow
+    if (fleet_info->connection != NULL)
+    {
+        fleet_info->prov_transport_protocol->prov_transport_destroy(fleet_info->connection);
+    }
+    if (fleet_info->tick_counter != NULL)
+    {
+        tickcounter_destroy(fleet_info->tick_counter);
+    }
+    free(fleet_info->trusted_cert);
+    free(fleet_info->scope_id);
+    free(fleet_info->uri);
+    free(fleet_info);
+}
+
+static PROV_DEVICE_TRANSPORT_HANDLE create_shared_connection(PROV_DEVICE_FLEET_LL_INFO* fleet_info)
+{
+    PROV_DEVICE_TRANSPORT_HANDLE result;
+    SECURE_DEVICE_TYPE device_type = prov_dev_security_get_type();
+
+    // The connection only needs the kind of attestation its links use, the credentials are given to each device
+    if (device_type == SECURE_DEVICE_TYPE_UNKNOWN)
+    {
+        LogError("the security type has not been set with prov_dev_security_init");
+        result = NULL;
+    }
+    else
+    {
+        TRANSPORT_HSM_TYPE hsm_type;
+        if (device_type == SECURE_DEVICE_TYPE_TPM)
+        {
+            hsm_type = TRANSPORT_HSM_TYPE_TPM;
+        }
+        else if (device_type == SECURE_DEVICE_TYPE_SYMMETRIC_KEY)
+        {
+            hsm_type = TRANSPORT_HSM_TYPE_SYMM_KEY;
+        }
+        else
+        {
+            hsm_type = TRANSPORT_HSM_TYPE_X509;
+        }
+
+        if ((result = fleet_info->prov_transport_protocol->prov_transport_create(fleet_info->uri, hsm_type, fleet_info->scope_id, PROV_API_VERSION, on_connection_error, fleet_info)) == NULL)
+        {
+            LogError("failed calling into transport create");
+        }
+    }
+    return result;
+}
+
+PROV_DEVICE_FLEET_LL_HANDLE Prov_Device_Fleet_LL_Create(const char* uri, const char* scope_id, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol)
+{
+    PROV_DEVICE_FLEET_LL_INFO* result;
+
+    /* Codes_SRS_PROV_DEVICE_FLEET_09_001: [ If uri, scope_id or protocol is NULL, Prov_Device_Fleet_LL_Create shall fail and return NULL. ] */
+    if (uri == NULL || scope_id == NULL || protocol == NULL)
+    {
+        LogError("Invalid parameter specified uri: %p, scope_id: %p, protocol: %p", uri, scope_id, protocol);
+        result = NULL;
+    }
+    else if ((result = (PROV_DEVICE_FLEET_LL_INFO*)malloc(sizeof(PROV_DEVICE_FLEET_LL_INFO))) == NULL)
+    {
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_004: [ If any error is encountered, Prov_Device_Fleet_LL_Create shall return NULL. ] */
+        LogError("unable to allocate fleet info");
+    }
+    else
+    {
+        memset(result, 0, sizeof(PROV_DEVICE_FLEET_LL_INFO));
+        result->protocol = protocol;
+        result->prov_transport_protocol = protocol();
+        result->max_in_flight = PROV_FLEET_DEFAULT_MAX_IN_FLIGHT;
+
+        if (mallocAndStrcpy_s(&result->uri, uri) != 0 || mallocAndStrcpy_s(&result->scope_id, scope_id) != 0)
+        {
+            /* Codes_SRS_PROV_DEVICE_FLEET_09_004: [ If any error is encountered, Prov_Device_Fleet_LL_Create shall return NULL. ] */
+            LogError("failed to copy the uri and the id scope");
+            destroy_fleet(result);
+            result = NULL;
+        }
+        else if (result->prov_transport_protocol->prov_transport_create_link != NULL && result->prov_transport_protocol->prov_transport_destroy_link != NULL)
+        {
+            /* Codes_SRS_PROV_DEVICE_FLEET_09_002: [ If the transport implements prov_transport_create_link, Prov_Device_Fleet_LL_Create shall create the one connection all the registrations are linked to. ] */
+            if ((result->connection = create_shared_connection(result)) == NULL)
+            {
+                /* Codes_SRS_PROV_DEVICE_FLEET_09_004: [ If any error is encountered, Prov_Device_Fleet_LL_Create shall return NULL. ] */
+                destroy_fleet(result);
+                result = NULL;
+            }
+            else if ((result->tick_counter = tickcounter_create()) == NULL)
+            {
+                /* Codes_SRS_PROV_DEVICE_FLEET_09_004: [ If any error is encountered, Prov_Device_Fleet_LL_Create shall return NULL. ] */
+                LogError("failure: allocating tickcounter");
+                destroy_fleet(result);
+                result = NULL;
+            }
+        }
+        else
+        {
+            /* Codes_SRS_PROV_DEVICE_FLEET_09_003: [ Otherwise each registration shall use a connection of its own. ] */
+            // This is the case of every transport shipped with the SDK, the service authenticates a connection for one registration
+            LogInfo("The transport cannot share its connection, every registration opens its own");
+        }
+    }
+    return result;
+}
+
+void Prov_Device_Fleet_LL_Destroy(PROV_DEVICE_FLEET_LL_HANDLE handle)
+{
+    /* Codes_SRS_PROV_DEVICE_FLEET_09_005: [ If handle is NULL, Prov_Device_Fleet_LL_Destroy shall do nothing. ] */
+    if (handle != NULL)
+    {
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_006: [ Prov_Device_Fleet_LL_Destroy shall destroy the provisioning client of every registration, then the shared connection, without calling any callback. ] */
+        destroy_fleet(handle);
+    }
+}
+
+static bool is_attestation_valid(const PROV_DEVICE_FLEET_ATTESTATION* attestation)
+{
+    bool result;
+    if (attestation == NULL)
+    {
+        result = true;
+    }
+    else if ((attestation->x509_certificate == NULL) != (attestation->x509_private_key == NULL))
+    {
+        LogError("the certificate and the private key of a device must be given together");
+        result = false;
+    }
+    else if (attestation->symmetric_key != NULL && attestation->x509_certificate != NULL)
+    {
+        LogError("a device is attested either by a symmetric key or by a certificate");
+        result = false;
+    }
+    else
+    {
+        result = true;
+    }
+    return result;
+}
+
+static int copy_attestation(FLEET_DEVICE_INFO* device, const PROV_DEVICE_FLEET_ATTESTATION* attestation)
+{
+    int result;
+    if (attestation == NULL)
+    {
+        result = 0;
+    }
+    else if (attestation->symmetric_key != NULL && mallocAndStrcpy_s(&device->symmetric_key, attestation->symmetric_key) != 0)
+    {
+        LogError("unable to copy the symmetric key");
+        result = MU_FAILURE;
+    }
+    else if (attestation->x509_certificate != NULL &&
+        (mallocAndStrcpy_s(&device->x509_certificate, attestation->x509_certificate) != 0 ||
+         mallocAndStrcpy_s(&device->x509_private_key, attestation->x509_private_key) != 0))
+    {
+        LogError("unable to copy the x509 identity");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+PROV_DEVICE_RESULT Prov_Device_Fleet_LL_Register_Device(PROV_DEVICE_FLEET_LL_HANDLE handle, const char* registration_id, const PROV_DEVICE_FLEET_ATTESTATION* attestation, PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK register_callback, void* user_context, PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK reg_status_cb, void* status_user_ctext)
+{
+    PROV_DEVICE_RESULT result;
+    FLEET_DEVICE_INFO* device;
+
+    /* Codes_SRS_PROV_DEVICE_FLEET_09_007: [ If handle, registration_id or register_callback is NULL, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    if (handle == NULL || registration_id == NULL || register_callback == NULL)
+    {
+        LogError("Invalid parameter specified handle: %p, registration_id: %p, register_callback: %p", handle, registration_id, register_callback);
+        result = PROV_DEVICE_RESULT_INVALID_ARG;
+    }
+    /* Codes_SRS_PROV_DEVICE_FLEET_09_029: [ If attestation gives only one of x509_certificate and x509_private_key, or both a symmetric key and a certificate, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    else if (!is_attestation_valid(attestation))
+    {
+        result = PROV_DEVICE_RESULT_INVALID_ARG;
+    }
+    else if (handle->device_count == handle->device_capacity && grow_device_list(handle) != 0)
+    {
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_009: [ If any error is encountered, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_MEMORY. ] */
+        result = PROV_DEVICE_RESULT_MEMORY;
+    }
+    else if ((device = (FLEET_DEVICE_INFO*)malloc(sizeof(FLEET_DEVICE_INFO))) == NULL)
+    {
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_009: [ If any error is encountered, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_MEMORY. ] */
+        LogError("unable to allocate the device info");
+        result = PROV_DEVICE_RESULT_MEMORY;
+    }
+    else
+    {
+        memset(device, 0, sizeof(FLEET_DEVICE_INFO));
+        if (mallocAndStrcpy_s(&device->registration_id, registration_id) != 0)
+        {
+            /* Codes_SRS_PROV_DEVICE_FLEET_09_009: [ If any error is encountered, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_MEMORY. ] */
+            LogError("unable to copy the registration id");
+            free(device);
+            result = PROV_DEVICE_RESULT_MEMORY;
+        }
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_030: [ Prov_Device_Fleet_LL_Register_Device shall copy the credentials of attestation; a NULL attestation uses the credentials held for the process. ] */
+        else if (copy_attestation(device, attestation) != 0)
+        {
+            /* Codes_SRS_PROV_DEVICE_FLEET_09_009: [ If any error is encountered, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_MEMORY. ] */
+            destroy_device(device);
+            result = PROV_DEVICE_RESULT_MEMORY;
+        }
+        else
+        {
+            /* Codes_SRS_PROV_DEVICE_FLEET_09_008: [ Prov_Device_Fleet_LL_Register_Device shall queue the registration, to be started by Prov_Device_Fleet_LL_DoWork in the order the registrations were requested, and return PROV_DEVICE_RESULT_OK. ] */
+            device->fleet = handle;
+            device->state = FLEET_DEVICE_STATE_QUEUED;
+            device->register_callback = register_callback;
+            device->user_context = user_context;
+            device->register_status_cb = reg_status_cb;
+            device->status_user_ctx = status_user_ctext;
+            handle->devices[handle->device_count++] = device;
+            result = PROV_DEVICE_RESULT_OK;
+        }
+    }
+    return result;
+}
+
+void Prov_Device_Fleet_LL_DoWork(PROV_DEVICE_FLEET_LL_HANDLE handle)
+{
+    /* Codes_SRS_PROV_DEVICE_FLEET_09_010: [ If handle is NULL, Prov_Device_Fleet_LL_DoWork shall do nothing. ] */
+    if (handle != NULL)
+    {
+        size_t index;
+
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_011: [ Prov_Device_Fleet_LL_DoWork shall call prov_transport_dowork once on the shared connection, then Prov_Device_LL_DoWork on every registration in progress. ] */
+        if (handle->connection != NULL)
+        {
+            handle->prov_transport_protocol->prov_transport_dowork(handle->connection);
+
+            /* Codes_SRS_PROV_DEVICE_FLEET_09_026: [ Prov_Device_Fleet_LL_DoWork shall drive again the registrations whose operation status request is due. ] */
+            release_due_polls(handle);
+        }
+
+        // Callbacks may queue more registrations, the list is indexed again on every step
+        for (index = 0; index < handle->device_count; index++)
+        {
+            FLEET_DEVICE_INFO* device = handle->devices[index];
+            if (device->state == FLEET_DEVICE_STATE_REGISTERING)
+            {
+                if (!device->waiting_for_poll)
+                {
+                    Prov_Device_LL_DoWork(device->prov_handle);
+
+                    /* Codes_SRS_PROV_DEVICE_FLEET_09_025: [ When the registrations share a connection, Prov_Device_Fleet_LL_DoWork shall stop calling Prov_Device_LL_DoWork on a registration until the delay returned by prov_device_ll_get_poll_delay has elapsed. ] */
+                    if (handle->connection != NULL && device->state == FLEET_DEVICE_STATE_REGISTERING)
+                    {
+                        park_device_until_poll(handle, device);
+                    }
+                }
+            }
+            /* Codes_SRS_PROV_DEVICE_FLEET_09_012: [ Prov_Device_Fleet_LL_DoWork shall start the queued registrations while fewer than PROV_FLEET_OPTION_MAX_IN_FLIGHT registrations are in progress. ] */
+            else if (device->state == FLEET_DEVICE_STATE_QUEUED && (handle->max_in_flight == 0 || handle->registering_count < handle->max_in_flight))
+            {
+                start_device_registration(handle, device);
+            }
+        }
+
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_017: [ Prov_Device_Fleet_LL_DoWork shall destroy the provisioning clients of the registrations that completed. ] */
+        remove_completed_devices(handle);
+    }
+}
+
+PROV_DEVICE_RESULT Prov_Device_Fleet_LL_SetOption(PROV_DEVICE_FLEET_LL_HANDLE handle, const char* optionName, const void* value)
+{
+    PROV_DEVICE_RESULT result;
+
+    /* Codes_SRS_PROV_DEVICE_FLEET_09_018: [ If handle or optionName is NULL, Prov_Device_Fleet_LL_SetOption shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    if (handle == NULL || optionName == NULL)
+    {
+        LogError("Invalid parameter specified handle: %p optionName: %p", handle, optionName);
+        result = PROV_DEVICE_RESULT_INVALID_ARG;
+    }
+    else if (strcmp(PROV_REGISTRATION_ID, optionName) == 0)
+    {
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_019: [ PROV_REGISTRATION_ID shall be rejected with PROV_DEVICE_RESULT_INVALID_ARG, the registration id is given to each Prov_Device_Fleet_LL_Register_Device. ] */
+        LogError("the registration id is set for each device by Prov_Device_Fleet_LL_Register_Device");
+        result = PROV_DEVICE_RESULT_INVALID_ARG;
+    }
+    else if (value == NULL)
+    {
+        LogError("value must be set for option %s", optionName);
+        result = PROV_DEVICE_RESULT_ERROR;
+    }
+    /* Codes_SRS_PROV_DEVICE_FLEET_09_020: [ PROV_OPTION_TIMEOUT and PROV_FLEET_OPTION_MAX_IN_FLIGHT shall be stored and apply to the registrations started afterwards. ] */
+    else if (strcmp(PROV_OPTION_TIMEOUT, optionName) == 0)
+    {
+        handle->prov_timeout = *((const uint8_t*)value);
+        result = PROV_DEVICE_RESULT_OK;
+    }
+    else if (strcmp(PROV_FLEET_OPTION_MAX_IN_FLIGHT, optionName) == 0)
+    {
+        handle->max_in_flight = *((const size_t*)value);
+        result = PROV_DEVICE_RESULT_OK;
+    }
+    else if (handle->connection != NULL)
+    {
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_021: [ When the registrations share a connection, any other option shall be set on the connection. ] */
+        int set_result;
+        if (strcmp(OPTION_TRUSTED_CERT, optionName) == 0)
+        {
+            set_result = handle->prov_transport_protocol->prov_transport_trusted_cert(handle->connection, (const char*)value);
+        }
+        else if (strcmp(PROV_OPTION_LOG_TRACE, optionName) == 0)
+        {
+            set_result = handle->prov_transport_protocol->prov_transport_set_trace(handle->connection, *((const bool*)value));
+        }
+        else if (strcmp(OPTION_HTTP_PROXY, optionName) == 0)
+        {
+            set_result = handle->prov_transport_protocol->prov_transport_set_proxy(handle->connection, (const HTTP_PROXY_OPTIONS*)value);
+        }
+        else
+        {
+            set_result = handle->prov_transport_protocol->prov_transport_set_option(handle->connection, optionName, value);
+        }
+
+        if (set_result != 0)
+        {
+            LogError("Failure setting option %s on the connection", optionName);
+            result = PROV_DEVICE_RESULT_ERROR;
+        }
+        else
+        {
+            result = PROV_DEVICE_RESULT_OK;
+        }
+    }
+    /* Codes_SRS_PROV_DEVICE_FLEET_09_022: [ Otherwise OPTION_TRUSTED_CERT and PROV_OPTION_LOG_TRACE shall be stored and apply to the registrations started afterwards, and any other option shall fail with PROV_DEVICE_RESULT_ERROR. ] */
+    else if (strcmp(OPTION_TRUSTED_CERT, optionName) == 0)
+    {
+        char* trusted_cert;
+        if (mallocAndStrcpy_s(&trusted_cert, (const char*)value) != 0)
+        {
+            LogError("Failure copying the trusted certificate");
+            result = PROV_DEVICE_RESULT_ERROR;
+        }
+        else
+        {
+            free(handle->trusted_cert);
+            handle->trusted_cert = trusted_cert;
+            result = PROV_DEVICE_RESULT_OK;
+        }
+    }
+    else if (strcmp(PROV_OPTION_LOG_TRACE, optionName) == 0)
+    {
+        handle->log_trace = *((const bool*)value);
+        result = PROV_DEVICE_RESULT_OK;
+    }
+    else
+    {
+        LogError("option %s needs a transport that shares its connection", optionName);
+        result = PROV_DEVICE_RESULT_ERROR;
+    }
+    return result;
+}
+
+size_t Prov_Device_Fleet_LL_Get_Pending_Count(PROV_DEVICE_FLEET_LL_HANDLE handle)
+{
+    size_t result;
+    /* Codes_SRS_PROV_DEVICE_FLEET_09_023: [ If handle is NULL, Prov_Device_Fleet_LL_Get_Pending_Count shall return 0. ] */
+    if (handle == NULL)
+    {
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_PROV_DEVICE_FLEET_09_024: [ Prov_Device_Fleet_LL_Get_Pending_Count shall return the number of registrations that are queued or in progress. ] */
+        size_t index;
+        result = 0;
+        for (index = 0; index < handle->device_count; index++)
+        {
+            if (handle->devices[index]->state != FLEET_DEVICE_STATE_COMPLETE)
+            {
+                result++;
+            }
+        }
+    }
+    return result;
+}
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <time.h>
 
 #include "parson.h"
 
@@ -22,6 +23,7 @@
 #include "azure_prov_client/internal/prov_auth_client.h"
 #include "azure_prov_client/internal/prov_transport_private.h"
 #include "azure_prov_client/prov_device_ll_client.h"
+#include "azure_prov_client/internal/prov_device_ll_client_private.h"
 #include "azure_prov_client/prov_client_const.h"
 
 static const char* const OPTION_LOG_TRACE = "logtrace";
@@ -55,6 +57,9 @@ static const char* const JSON_STORAGE_ROOT_KEY_NODE = "storageRootKey";
 #define EPOCH_TIME_T_VALUE          (time_t)0
 #define MAX_AUTH_ATTEMPTS           3
 #define PROV_DEFAULT_TIMEOUT        60
+// Status polls are spread over Retry-After and up to this much more, so that the devices of a
+// fleet re-provisioning after one outage do not poll the service in waves
+#define PROV_STATUS_POLL_MAX_JITTER_PERCENT     50
 
 typedef enum CLIENT_STATE_TAG
 {
@@ -68,6 +73,8 @@ typedef enum CLIENT_STATE_TAG
     CLIENT_STATE_STATUS_SENT,
     CLIENT_STATE_STATUS_RECV,
 
+    CLIENT_STATE_CACHED,
+
     CLIENT_STATE_ERROR
 } CLIENT_STATE;
 
@@ -89,12 +96,15 @@ typedef struct PROV_INSTANCE_INFO_TAG
     const PROV_DEVICE_TRANSPORT_PROVIDER* prov_transport_protocol;
     PROV_DEVICE_TRANSPORT_HANDLE transport_handle;
     bool transport_open;
+    // transport_handle is a link over a connection driven by its owner
+    bool shares_connection;
 
     TICK_COUNTER_HANDLE tick_counter;
 
-    tickcounter_ms_t status_throttle;
+    tickcounter_ms_t status_deadline;
     tickcounter_ms_t timeout_value;
-    uint32_t retry_after_value;
+    uint32_t poll_delay_ms;
+    uint32_t random_state;
 
     uint8_t prov_timeout;
 
@@ -117,6 +127,13 @@ typedef struct PROV_INSTANCE_INFO_TAG
 
     char* custom_request_data;
     char* custom_response_data;
+
+    PROV_DEVICE_CLIENT_CACHE_STORE_CALLBACK cache_store_cb;
+    PROV_DEVICE_CLIENT_CACHE_LOAD_CALLBACK cache_load_cb;
+    void* cache_user_ctx;
+    PROV_DEVICE_CACHE_REVALIDATE cache_revalidate;
+    // The registration in progress refreshes the assignment held in iothub_info, which the application already has
+    bool revalidating;
 } PROV_INSTANCE_INFO;
 
 static char* prov_transport_challenge_callback(const unsigned char* nonce, size_t nonce_len, const char* key_name, void* user_ctx)
@@ -708,6 +725,156 @@ static void cleanup_prov_info(PROV_INSTANCE_INFO* prov_info)
     free(prov_info->iothub_info.iothub_url);
     prov_info->iothub_info.iothub_url = NULL;
     prov_info->auth_attempts_made = 0;
+    prov_info->revalidating = false;
+}
+
+static void store_registration_result(PROV_INSTANCE_INFO* prov_info, BUFFER_HANDLE iothub_key, const char* assigned_hub, const char* device_id)
+{
+    JSON_Value* root_value;
+    JSON_Object* root_object;
+    JSON_Value* payload_value = NULL;
+    STRING_HANDLE encoded_key = NULL;
+    char* cached_result;
+
+    if ((root_value = json_value_init_object()) == NULL)
+    {
+        LogError("Failure creating the cached registration result");
+    }
+    else
+    {
+        if ((root_object = json_value_get_object(root_value)) == NULL ||
+            json_object_set_string(root_object, JSON_NODE_ASSIGNED_HUB, assigned_hub) != JSONSuccess ||
+            json_object_set_string(root_object, JSON_NODE_DEVICE_ID, device_id) != JSONSuccess)
+        {
+            LogError("Failure setting the assignment in the cached registration result");
+        }
+        else if (iothub_key != NULL &&
+            ((encoded_key = Azure_Base64_Encode_Bytes(BUFFER_u_char(iothub_key), BUFFER_length(iothub_key))) == NULL ||
+            json_object_set_string(root_object, JSON_NODE_AUTH_KEY, STRING_c_str(encoded_key)) != JSONSuccess))
+        {
+            LogError("Failure setting the key in the cached registration result");
+        }
+        else if (prov_info->custom_response_data != NULL &&
+            ((payload_value = json_parse_string(prov_info->custom_response_data)) == NULL ||
+            json_object_set_value(root_object, JSON_NODE_RETURNED_DATA, payload_value) != JSONSuccess))
+        {
+            LogError("Failure setting the payload in the cached registration result");
+            json_value_free(payload_value);
+        }
+        else if ((cached_result = json_serialize_to_string(root_value)) == NULL)
+        {
+            LogError("Failure serializing the cached registration result");
+        }
+        else
+        {
+            /* Codes_SRS_PROV_CLIENT_09_010: [ After a successful registration, the client shall pass the assigned hub, the device id, the key and the payload returned by the service to the store callback. ] */
+            if (prov_info->cache_store_cb(prov_info->registration_id, cached_result, prov_info->cache_user_ctx) != 0)
+            {
+                LogError("Failure storing the registration result, the next registration will contact the service");
+            }
+            json_free_serialized_string(cached_result);
+        }
+        STRING_delete(encoded_key);
+        json_value_free(root_value);
+    }
+}
+
+static int import_cached_key(PROV_INSTANCE_INFO* prov_info, JSON_Object* root_object)
+{
+    int result;
+    const char* encoded_key;
+    BUFFER_HANDLE decoded_key;
+
+    if ((encoded_key = json_object_get_string(root_object, JSON_NODE_AUTH_KEY)) == NULL)
+    {
+        LogError("The cached registration result has no key");
+        result = MU_FAILURE;
+    }
+    else if ((decoded_key = Azure_Base64_Decode(encoded_key)) == NULL)
+    {
+        LogError("Failure decoding the cached key");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (prov_auth_import_key(prov_info->prov_auth_handle, BUFFER_u_char(decoded_key), BUFFER_length(decoded_key)) != 0)
+        {
+            LogError("Failure to import the cached provisioning key");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            result = 0;
+        }
+        BUFFER_delete(decoded_key);
+    }
+    return result;
+}
+
+static int load_registration_result(PROV_INSTANCE_INFO* prov_info)
+{
+    int result;
+    const char* cached_result;
+    JSON_Value* root_value;
+    JSON_Object* root_object;
+    const char* assigned_hub;
+    const char* device_id;
+
+    if ((cached_result = prov_info->cache_load_cb(prov_info->registration_id, prov_info->cache_user_ctx)) == NULL)
+    {
+        LogInfo("No cached registration result for %s", prov_info->registration_id);
+        result = MU_FAILURE;
+    }
+    else if ((root_value = json_parse_string(cached_result)) == NULL)
+    {
+        LogError("Failure parsing the cached registration result");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if ((root_object = json_value_get_object(root_value)) == NULL ||
+            (assigned_hub = json_object_get_string(root_object, JSON_NODE_ASSIGNED_HUB)) == NULL ||
+            (device_id = json_object_get_string(root_object, JSON_NODE_DEVICE_ID)) == NULL)
+        {
+            LogError("The cached registration result has no assignment");
+            result = MU_FAILURE;
+        }
+        else if (prov_info->hsm_type == PROV_AUTH_TYPE_TPM && import_cached_key(prov_info, root_object) != 0)
+        {
+            result = MU_FAILURE;
+        }
+        else if (mallocAndStrcpy_s(&prov_info->iothub_info.iothub_url, assigned_hub) != 0)
+        {
+            LogError("Failure allocating the cached iothub uri");
+            result = MU_FAILURE;
+        }
+        else if (mallocAndStrcpy_s(&prov_info->iothub_info.device_id, device_id) != 0)
+        {
+            LogError("Failure allocating the cached device id");
+            free(prov_info->iothub_info.iothub_url);
+            prov_info->iothub_info.iothub_url = NULL;
+            result = MU_FAILURE;
+        }
+        else
+        {
+            if (prov_info->custom_response_data != NULL)
+            {
+                json_free_serialized_string(prov_info->custom_response_data);
+                prov_info->custom_response_data = NULL;
+            }
+            retrieve_json_payload(root_object, prov_info);
+            result = 0;
+        }
+        json_value_free(root_value);
+    }
+    return result;
+}
+
+static bool is_assignment_changed(const PROV_INSTANCE_INFO* prov_info, const char* assigned_hub, const char* device_id)
+{
+    return assigned_hub == NULL || device_id == NULL ||
+        strcmp(assigned_hub, prov_info->iothub_info.iothub_url) != 0 ||
+        strcmp(device_id, prov_info->iothub_info.device_id) != 0;
 }
 
 static void on_transport_registration_data(PROV_DEVICE_TRANSPORT_RESULT transport_result, BUFFER_HANDLE iothub_key, const char* assigned_hub, const char* device_id, void* user_ctx)
@@ -749,7 +916,16 @@ static void on_transport_registration_data(PROV_DEVICE_TRANSPORT_RESULT transpor
 
             if (prov_info->prov_state != CLIENT_STATE_ERROR)
             {
-                prov_info->register_callback(PROV_DEVICE_RESULT_OK, assigned_hub, device_id, prov_info->user_context);
+                if (prov_info->cache_store_cb != NULL)
+                {
+                    store_registration_result(prov_info, iothub_key, assigned_hub, device_id);
+                }
+
+                /* Codes_SRS_PROV_CLIENT_09_016: [ When a background revalidation succeeds, the client shall only call register_callback if the assigned hub or the device id differ from the cached ones. ] */
+                if (!prov_info->revalidating || is_assignment_changed(prov_info, assigned_hub, device_id))
+                {
+                    prov_info->register_callback(PROV_DEVICE_RESULT_OK, assigned_hub, device_id, prov_info->user_context);
+                }
                 prov_info->prov_state = CLIENT_STATE_READY;
                 cleanup_prov_info(prov_info);
             }
@@ -772,6 +948,59 @@ static void on_transport_registration_data(PROV_DEVICE_TRANSPORT_RESULT transpor
     }
 }
 
+static uint32_t create_random_seed(const PROV_INSTANCE_INFO* prov_info)
+{
+    // Mix the clock with the instance address, two devices started from the same image must not share a sequence
+    uint32_t result = (uint32_t)time(NULL) ^ (uint32_t)(uintptr_t)prov_info;
+    result ^= result >> 16;
+    result *= 0x7feb352d;
+    result ^= result >> 15;
+    result *= 0x846ca68b;
+    result ^= result >> 16;
+    return (result == 0) ? 0x9e3779b9 : result;
+}
+
+static uint32_t get_next_random(PROV_INSTANCE_INFO* prov_info)
+{
+    // xorshift32
+    uint32_t x = prov_info->random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    prov_info->random_state = x;
+    return x;
+}
+
+static void schedule_status_poll(PROV_INSTANCE_INFO* prov_info, uint32_t retry_interval)
+{
+    tickcounter_ms_t current_time = 0;
+    uint32_t min_delay_ms;
+    uint32_t max_delay_ms;
+    uint32_t upper_delay_ms;
+
+    if (retry_interval < PROV_GET_THROTTLE_TIME)
+    {
+        retry_interval = PROV_GET_THROTTLE_TIME;
+    }
+    else if (retry_interval > MAX_PROV_GET_THROTTLE_TIME)
+    {
+        retry_interval = MAX_PROV_GET_THROTTLE_TIME;
+    }
+    min_delay_ms = retry_interval * 1000;
+    max_delay_ms = min_delay_ms + (min_delay_ms / 100) * PROV_STATUS_POLL_MAX_JITTER_PERCENT;
+
+    // Decorrelated jitter: up to three times the previous delay, never below the service's Retry-After
+    upper_delay_ms = (prov_info->poll_delay_ms < min_delay_ms) ? min_delay_ms : prov_info->poll_delay_ms;
+    upper_delay_ms = (upper_delay_ms > max_delay_ms / 3) ? max_delay_ms : upper_delay_ms * 3;
+    prov_info->poll_delay_ms = min_delay_ms + get_next_random(prov_info) % (upper_delay_ms - min_delay_ms + 1);
+
+    if (tickcounter_get_current_ms(prov_info->tick_counter, &current_time) != 0)
+    {
+        LogError("Failure getting the current time, the status poll is not delayed");
+    }
+    prov_info->status_deadline = current_time + prov_info->poll_delay_ms;
+}
+
 static void on_transport_status(PROV_DEVICE_TRANSPORT_STATUS transport_status, uint32_t retry_interval, void* user_ctx)
 {
     if (user_ctx == NULL)
@@ -782,8 +1011,6 @@ static void on_transport_status(PROV_DEVICE_TRANSPORT_STATUS transport_status, u
     {
         PROV_INSTANCE_INFO* prov_info = (PROV_INSTANCE_INFO*)user_ctx;
 
-        prov_info->retry_after_value = retry_interval;
-
         switch (transport_status)
         {
             case PROV_DEVICE_TRANSPORT_STATUS_CONNECTED:
@@ -796,7 +1023,9 @@ static void on_transport_status(PROV_DEVICE_TRANSPORT_STATUS transport_status, u
             case PROV_DEVICE_TRANSPORT_STATUS_AUTHENTICATED:
             case PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING:
             case PROV_DEVICE_TRANSPORT_STATUS_UNASSIGNED:
+                /* Codes_SRS_PROV_CLIENT_09_004: [ When the service replies that the registration is in progress, on_transport_status shall schedule the operation status request retry_interval seconds later, plus a random delay of at most PROV_STATUS_POLL_MAX_JITTER_PERCENT percent of it. ] */
                 prov_info->prov_state = CLIENT_STATE_STATUS_SEND;
+                schedule_status_poll(prov_info, retry_interval);
                 if (transport_status == PROV_DEVICE_TRANSPORT_STATUS_UNASSIGNED)
                 {
                     if (prov_info->register_status_cb != NULL)
@@ -820,6 +1049,7 @@ static void on_transport_status(PROV_DEVICE_TRANSPORT_STATUS transport_status, u
                 else if (prov_info->prov_state == CLIENT_STATE_STATUS_SENT)
                 {
                     prov_info->prov_state = CLIENT_STATE_STATUS_SEND;
+                    schedule_status_poll(prov_info, retry_interval);
                 }
                 else
                 {
@@ -845,7 +1075,14 @@ static void destroy_instance(PROV_INSTANCE_INFO* prov_info)
         json_free_serialized_string(prov_info->custom_response_data);
         prov_info->custom_response_data = NULL;
     }
-    prov_info->prov_transport_protocol->prov_transport_destroy(prov_info->transport_handle);
+    if (prov_info->shares_connection)
+    {
+        prov_info->prov_transport_protocol->prov_transport_destroy_link(prov_info->transport_handle);
+    }
+    else
+    {
+        prov_info->prov_transport_protocol->prov_transport_destroy(prov_info->transport_handle);
+    }
     prov_info->transport_handle = NULL;
     free(prov_info->scope_id);
     prov_auth_destroy(prov_info->prov_auth_handle);
@@ -853,88 +1090,202 @@ static void destroy_instance(PROV_INSTANCE_INFO* prov_info)
     free(prov_info);
 }
 
-PROV_DEVICE_LL_HANDLE Prov_Device_LL_Create(const char* uri, const char* id_scope, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol)
+TRANSPORT_HSM_TYPE prov_device_ll_get_transport_hsm_type(PROV_AUTH_TYPE auth_type)
+{
+    TRANSPORT_HSM_TYPE result;
+    if (auth_type == PROV_AUTH_TYPE_TPM)
+    {
+        result = TRANSPORT_HSM_TYPE_TPM;
+    }
+    else if (auth_type == PROV_AUTH_TYPE_KEY)
+    {
+        result = TRANSPORT_HSM_TYPE_SYMM_KEY;
+    }
+    else
+    {
+        result = TRANSPORT_HSM_TYPE_X509;
+    }
+    return result;
+}
+
+static PROV_INSTANCE_INFO* create_instance(const char* uri, const char* id_scope, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol, PROV_DEVICE_TRANSPORT_HANDLE connection)
 {
     PROV_INSTANCE_INFO* result;
-    /* Codes_SRS_PROV_CLIENT_07_001: [If uri is NULL Prov_Device_LL_CreateFromUri shall return NULL.] */
-    if (uri == NULL || id_scope == NULL || protocol == NULL)
+    /* Codes_SRS_PROV_CLIENT_07_002: [ Prov_Device_LL_CreateFromUri shall allocate a PROV_DEVICE_LL_HANDLE and initialize all members. ] */
+    result = (PROV_INSTANCE_INFO*)malloc(sizeof(PROV_INSTANCE_INFO));
+    if (result == NULL)
     {
-        LogError("Invalid parameter specified uri: %p, id_scope: %p, protocol: %p", uri, id_scope, protocol);
-        result = NULL;
+        LogError("unable to allocate Instance Info");
     }
     else
     {
-        /* Codes_SRS_PROV_CLIENT_07_002: [ Prov_Device_LL_CreateFromUri shall allocate a PROV_DEVICE_LL_HANDLE and initialize all members. ] */
-        result = (PROV_INSTANCE_INFO*)malloc(sizeof(PROV_INSTANCE_INFO));
-        if (result == NULL)
+        memset(result, 0, sizeof(PROV_INSTANCE_INFO));
+
+        /* Codes_SRS_PROV_CLIENT_07_028: [ CLIENT_STATE_READY is the initial state after the object is created which will send a uhttp_client_open call to the http endpoint. ] */
+        result->prov_state = CLIENT_STATE_READY;
+        result->random_state = create_random_seed(result);
+        result->prov_transport_protocol = protocol();
+
+        /* Codes_SRS_PROV_CLIENT_07_034: [ Prov_Device_LL_Create shall construct a id_scope by base64 encoding the uri. ] */
+        if (mallocAndStrcpy_s(&result->scope_id, id_scope) != 0)
         {
-            LogError("unable to allocate Instance Info");
+            /* Codes_SRS_PROV_CLIENT_07_003: [ If any error is encountered, Prov_Device_LL_CreateFromUri shall return NULL. ] */
+            LogError("failed to construct id_scope");
+            free(result);
+            result = NULL;
+        }
+        else if ((result->prov_auth_handle = prov_auth_create()) == NULL)
+        {
+            /* Codes_SRS_PROV_CLIENT_07_003: [ If any error is encountered, Prov_Device_LL_CreateFromUri shall return NULL. ] */
+            LogError("failed calling prov_auth_create\r\n");
+            destroy_instance(result);
+            result = NULL;
+        }
+        else if ((result->tick_counter = tickcounter_create()) == NULL)
+        {
+            LogError("failure: allocating tickcounter");
+            destroy_instance(result);
+            result = NULL;
         }
         else
         {
-            memset(result, 0, sizeof(PROV_INSTANCE_INFO));
+            result->hsm_type = prov_auth_get_type(result->prov_auth_handle);
 
-            /* Codes_SRS_PROV_CLIENT_07_028: [ CLIENT_STATE_READY is the initial state after the object is created which will send a uhttp_client_open call to the http endpoint. ] */
-            result->prov_state = CLIENT_STATE_READY;
-            result->retry_after_value = PROV_GET_THROTTLE_TIME;
-            result->prov_transport_protocol = protocol();
-
-            /* Codes_SRS_PROV_CLIENT_07_034: [ Prov_Device_LL_Create shall construct a id_scope by base64 encoding the uri. ] */
-            if (mallocAndStrcpy_s(&result->scope_id, id_scope) != 0)
+            if (connection != NULL)
             {
-                /* Codes_SRS_PROV_CLIENT_07_003: [ If any error is encountered, Prov_Device_LL_CreateFromUri shall return NULL. ] */
-                LogError("failed to construct id_scope");
-                free(result);
-                result = NULL;
+                /* Codes_SRS_PROV_CLIENT_09_002: [ prov_device_ll_create_on_connection shall create the transport handle of the client with prov_transport_create_link on connection. ] */
+                if ((result->transport_handle = result->prov_transport_protocol->prov_transport_create_link(connection, on_transport_error, result)) != NULL)
+                {
+                    result->shares_connection = true;
+                }
             }
-            else if ((result->prov_auth_handle = prov_auth_create()) == NULL)
+            else
             {
-                /* Codes_SRS_PROV_CLIENT_07_003: [ If any error is encountered, Prov_Device_LL_CreateFromUri shall return NULL. ] */
-                LogError("failed calling prov_auth_create\r\n");
-                destroy_instance(result);
-                result = NULL;
+                TRANSPORT_HSM_TYPE hsm_type = prov_device_ll_get_transport_hsm_type(result->hsm_type);
+                result->transport_handle = result->prov_transport_protocol->prov_transport_create(uri, hsm_type, result->scope_id, PROV_API_VERSION, on_transport_error, result);
             }
-            else if ((result->tick_counter = tickcounter_create()) == NULL)
+
+            if (result->transport_handle == NULL)
             {
-                LogError("failure: allocating tickcounter");
+                /* Codes_SRS_PROV_CLIENT_07_003: [ If any error is encountered, Prov_Device_LL_CreateFromUri shall return NULL. ] */
+                LogError("failed calling into transport create");
                 destroy_instance(result);
                 result = NULL;
             }
             else
             {
-                TRANSPORT_HSM_TYPE hsm_type;
-                if ((result->hsm_type = prov_auth_get_type(result->prov_auth_handle)) == PROV_AUTH_TYPE_TPM)
-                {
-                    hsm_type = TRANSPORT_HSM_TYPE_TPM;
-                }
-                else if (result->hsm_type == PROV_AUTH_TYPE_KEY)
-                {
-                    hsm_type = TRANSPORT_HSM_TYPE_SYMM_KEY;
-                }
-                else
-                {
-                    hsm_type = TRANSPORT_HSM_TYPE_X509;
-                }
-
-                if ((result->transport_handle = result->prov_transport_protocol->prov_transport_create(uri, hsm_type, result->scope_id, PROV_API_VERSION, on_transport_error, result)) == NULL)
-                {
-                    /* Codes_SRS_PROV_CLIENT_07_003: [ If any error is encountered, Prov_Device_LL_CreateFromUri shall return NULL. ] */
-                    LogError("failed calling into transport create");
-                    destroy_instance(result);
-                    result = NULL;
-                }
-                else
-                {
-                    // Ensure that we are passed the throttling time and send on the first send
-                    (void)tickcounter_get_current_ms(result->tick_counter, &result->status_throttle);
-                    result->status_throttle += (result->retry_after_value * 1000);
-                }
+                // Nothing delays the first status request until the service asks for it
+                (void)tickcounter_get_current_ms(result->tick_counter, &result->status_deadline);
             }
         }
     }
+    return result;
+}
+
+PROV_DEVICE_LL_HANDLE Prov_Device_LL_Create(const char* uri, const char* id_scope, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol)
+{
+    PROV_INSTANCE_INFO* result;
+    /* Codes_SRS_PROV_CLIENT_07_001: [If uri is NULL Prov_Device_LL_CreateFromUri shall return NULL.] */
+    if (uri == NULL || id_scope == NULL || protocol == NULL)
+    {
+        LogError("Invalid parameter specified uri: %p, id_scope: %p, protocol: %p", uri, id_scope, protocol);
+        result = NULL;
+    }
+    else
+    {
+        result = create_instance(uri, id_scope, protocol, NULL);
+    }
     return (PROV_DEVICE_LL_HANDLE)result;
 }
 
+PROV_DEVICE_LL_HANDLE prov_device_ll_create_on_connection(const char* id_scope, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol, PROV_DEVICE_TRANSPORT_HANDLE connection)
+{
+    PROV_INSTANCE_INFO* result;
+    const PROV_DEVICE_TRANSPORT_PROVIDER* transport_provider;
+    /* Codes_SRS_PROV_CLIENT_09_001: [ If id_scope, protocol or connection is NULL, or the transport does not implement links, prov_device_ll_create_on_connection shall return NULL. ] */
+    if (id_scope == NULL || protocol == NULL || connection == NULL)
+    {
+        LogError("Invalid parameter specified id_scope: %p, protocol: %p, connection: %p", id_scope, protocol, connection);
+        result = NULL;
+    }
+    else if ((transport_provider = protocol()) == NULL || transport_provider->prov_transport_create_link == NULL || transport_provider->prov_transport_destroy_link == NULL)
+    {
+        LogError("The transport cannot carry several registrations over one connection");
+        result = NULL;
+    }
+    else
+    {
+        result = create_instance(NULL, id_scope, protocol, connection);
+    }
+    return (PROV_DEVICE_LL_HANDLE)result;
+}
+
+uint32_t prov_device_ll_get_poll_delay(PROV_DEVICE_LL_HANDLE handle)
+{
+    uint32_t result;
+    tickcounter_ms_t current_time;
+    /* Codes_SRS_PROV_CLIENT_09_006: [ If handle is NULL, or the client is not waiting to send its operation status request, prov_device_ll_get_poll_delay shall return 0. ] */
+    if (handle == NULL || !handle->is_connected || handle->prov_state != CLIENT_STATE_STATUS_SEND)
+    {
+        result = 0;
+    }
+    else if (tickcounter_get_current_ms(handle->tick_counter, &current_time) != 0)
+    {
+        LogError("Failure getting the current time");
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_PROV_CLIENT_09_007: [ Otherwise prov_device_ll_get_poll_delay shall return the milliseconds left before the operation status request is due. ] */
+        result = (current_time >= handle->status_deadline) ? 0 : (uint32_t)(handle->status_deadline - current_time);
+    }
+    return result;
+}
+
+PROV_DEVICE_RESULT prov_device_ll_set_symmetric_key(PROV_DEVICE_LL_HANDLE handle, const char* registration_id, const char* symmetric_key)
+{
+    PROV_DEVICE_RESULT result;
+    /* Codes_SRS_PROV_CLIENT_09_017: [ If handle, registration_id or symmetric_key is NULL, prov_device_ll_set_symmetric_key shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    if (handle == NULL || registration_id == NULL || symmetric_key == NULL)
+    {
+        LogError("Invalid parameter specified handle: %p, registration_id: %p, symmetric_key: %p", handle, registration_id, symmetric_key);
+        result = PROV_DEVICE_RESULT_INVALID_ARG;
+    }
+    /* Codes_SRS_PROV_CLIENT_09_018: [ prov_device_ll_set_symmetric_key shall give the key to the security module of this client only with prov_auth_set_symmetric_key_info, and return PROV_DEVICE_RESULT_ERROR if that fails. ] */
+    else if (prov_auth_set_symmetric_key_info(handle->prov_auth_handle, registration_id, symmetric_key) != 0)
+    {
+        LogError("Failure setting the symmetric key of %s", registration_id);
+        result = PROV_DEVICE_RESULT_ERROR;
+    }
+    else
+    {
+        result = PROV_DEVICE_RESULT_OK;
+    }
+    return result;
+}
+
+PROV_DEVICE_RESULT prov_device_ll_set_x509_identity(PROV_DEVICE_LL_HANDLE handle, const char* certificate, const char* private_key)
+{
+    PROV_DEVICE_RESULT result;
+    /* Codes_SRS_PROV_CLIENT_09_019: [ If handle, certificate or private_key is NULL, prov_device_ll_set_x509_identity shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    if (handle == NULL || certificate == NULL || private_key == NULL)
+    {
+        LogError("Invalid parameter specified handle: %p, certificate: %p, private_key: %p", handle, certificate, private_key);
+        result = PROV_DEVICE_RESULT_INVALID_ARG;
+    }
+    /* Codes_SRS_PROV_CLIENT_09_020: [ prov_device_ll_set_x509_identity shall give the certificate and key to the security module of this client only with prov_auth_set_x509_identity, and return PROV_DEVICE_RESULT_ERROR if that fails. ] */
+    else if (prov_auth_set_x509_identity(handle->prov_auth_handle, certificate, private_key) != 0)
+    {
+        LogError("Failure setting the x509 identity");
+        result = PROV_DEVICE_RESULT_ERROR;
+    }
+    else
+    {
+        result = PROV_DEVICE_RESULT_OK;
+    }
+    return result;
+}
+
 void Prov_Device_LL_Destroy(PROV_DEVICE_LL_HANDLE handle)
 {
     /* Codes_SRS_PROV_CLIENT_07_005: [ If handle is NULL Prov_Device_LL_Destroy shall do nothing. ] */
@@ -1101,6 +1452,93 @@ PROV_DEVICE_RESULT Prov_Device_LL_Register_Device(PROV_DEVICE_LL_HANDLE handle,
     return result;
 }
 
+PROV_DEVICE_RESULT Prov_Device_LL_Set_Result_Cache(PROV_DEVICE_LL_HANDLE handle, PROV_DEVICE_CLIENT_CACHE_STORE_CALLBACK store_callback, PROV_DEVICE_CLIENT_CACHE_LOAD_CALLBACK load_callback, void* user_context)
+{
+    PROV_DEVICE_RESULT result;
+    /* Codes_SRS_PROV_CLIENT_09_008: [ If handle is NULL, or only one of store_callback and load_callback is NULL, Prov_Device_LL_Set_Result_Cache shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    if (handle == NULL || (store_callback == NULL) != (load_callback == NULL))
+    {
+        LogError("Invalid parameter specified handle: %p store_callback: %p load_callback: %p", handle, store_callback, load_callback);
+        result = PROV_DEVICE_RESULT_INVALID_ARG;
+    }
+    else
+    {
+        /* Codes_SRS_PROV_CLIENT_09_009: [ Prov_Device_LL_Set_Result_Cache shall keep the callbacks for the following registrations, NULL callbacks disable the cache. ] */
+        handle->cache_store_cb = store_callback;
+        handle->cache_load_cb = load_callback;
+        handle->cache_user_ctx = user_context;
+        result = PROV_DEVICE_RESULT_OK;
+    }
+    return result;
+}
+
+PROV_DEVICE_RESULT Prov_Device_LL_Register_Device_Cached(PROV_DEVICE_LL_HANDLE handle, PROV_DEVICE_CACHE_REVALIDATE revalidate, PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK register_callback, void* user_context, PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK reg_status_cb, void* status_ctx)
+{
+    PROV_DEVICE_RESULT result;
+    /* Codes_SRS_PROV_CLIENT_09_011: [ If handle or register_callback is NULL, Prov_Device_LL_Register_Device_Cached shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    if (handle == NULL || register_callback == NULL)
+    {
+        LogError("Invalid parameter specified handle: %p register_callback: %p", handle, register_callback);
+        result = PROV_DEVICE_RESULT_INVALID_ARG;
+    }
+    else if (handle->cache_load_cb == NULL)
+    {
+        /* Codes_SRS_PROV_CLIENT_09_012: [ If no result cache is set, or it holds no valid result for the registration id, Prov_Device_LL_Register_Device_Cached shall register with the service as Prov_Device_LL_Register_Device does. ] */
+        result = Prov_Device_LL_Register_Device(handle, register_callback, user_context, reg_status_cb, status_ctx);
+    }
+    else if (handle->prov_state != CLIENT_STATE_READY)
+    {
+        LogError("state is invalid");
+        result = PROV_DEVICE_RESULT_ERROR;
+    }
+    else if (handle->registration_id == NULL && (handle->registration_id = prov_auth_get_registration_id(handle->prov_auth_handle)) == NULL)
+    {
+        LogError("failure: Unable to retrieve registration Id from device auth.");
+        result = PROV_DEVICE_RESULT_ERROR;
+    }
+    else if (load_registration_result(handle) != 0)
+    {
+        /* Codes_SRS_PROV_CLIENT_09_012: [ If no result cache is set, or it holds no valid result for the registration id, Prov_Device_LL_Register_Device_Cached shall register with the service as Prov_Device_LL_Register_Device does. ] */
+        result = Prov_Device_LL_Register_Device(handle, register_callback, user_context, reg_status_cb, status_ctx);
+    }
+    else
+    {
+        /* Codes_SRS_PROV_CLIENT_09_013: [ Otherwise Prov_Device_LL_Register_Device_Cached shall not contact the service, and the next Prov_Device_LL_DoWork shall call register_callback with the cached assigned hub and device id. ] */
+        handle->register_callback = register_callback;
+        handle->user_context = user_context;
+        handle->register_status_cb = reg_status_cb;
+        handle->status_user_ctx = status_ctx;
+        handle->cache_revalidate = revalidate;
+        handle->prov_state = CLIENT_STATE_CACHED;
+        result = PROV_DEVICE_RESULT_OK;
+    }
+    return result;
+}
+
+static void deliver_cached_result(PROV_INSTANCE_INFO* prov_info)
+{
+    prov_info->prov_state = CLIENT_STATE_READY;
+    prov_info->register_callback(PROV_DEVICE_RESULT_OK, prov_info->iothub_info.iothub_url, prov_info->iothub_info.device_id, prov_info->user_context);
+
+    if (prov_info->prov_state == CLIENT_STATE_READY && prov_info->cache_revalidate == PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND)
+    {
+        /* Codes_SRS_PROV_CLIENT_09_014: [ With PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND, the client shall then register with the service. ] */
+        if (Prov_Device_LL_Register_Device(prov_info, prov_info->register_callback, prov_info->user_context, prov_info->register_status_cb, prov_info->status_user_ctx) != PROV_DEVICE_RESULT_OK)
+        {
+            LogError("Failure revalidating the cached registration result");
+            cleanup_prov_info(prov_info);
+        }
+        else
+        {
+            prov_info->revalidating = true;
+        }
+    }
+    else
+    {
+        cleanup_prov_info(prov_info);
+    }
+}
+
 void Prov_Device_LL_DoWork(PROV_DEVICE_LL_HANDLE handle)
 {
     /* Codes_SRS_PROV_CLIENT_07_010: [ If handle is NULL, Prov_Device_LL_DoWork shall do nothing. ] */
@@ -1108,11 +1546,12 @@ void Prov_Device_LL_DoWork(PROV_DEVICE_LL_HANDLE handle)
     {
         PROV_INSTANCE_INFO* prov_info = (PROV_INSTANCE_INFO*)handle;
         /* Codes_SRS_PROV_CLIENT_07_011: [ Prov_Device_LL_DoWork shall call the underlying http_client_dowork function ] */
-        if (prov_info->prov_state != CLIENT_STATE_ERROR)
+        /* Codes_SRS_PROV_CLIENT_09_003: [ If the client was created on a connection, Prov_Device_LL_DoWork shall not call prov_transport_dowork, the owner of the connection drives it. ] */
+        if (prov_info->prov_state != CLIENT_STATE_ERROR && prov_info->prov_state != CLIENT_STATE_CACHED && !prov_info->shares_connection)
         {
             prov_info->prov_transport_protocol->prov_transport_dowork(prov_info->transport_handle);
         }
-        if (prov_info->is_connected || prov_info->prov_state == CLIENT_STATE_ERROR)
+        if (prov_info->is_connected || prov_info->prov_state == CLIENT_STATE_ERROR || prov_info->prov_state == CLIENT_STATE_CACHED)
         {
             switch (prov_info->prov_state)
             {
@@ -1145,7 +1584,8 @@ void Prov_Device_LL_DoWork(PROV_DEVICE_LL_HANDLE handle)
                     }
                     else
                     {
-                        if ((current_time - prov_info->status_throttle) / 1000 > prov_info->retry_after_value)
+                        /* Codes_SRS_PROV_CLIENT_09_005: [ Prov_Device_LL_DoWork shall send the operation status request once the time scheduled by on_transport_status is reached. ] */
+                        if (current_time >= prov_info->status_deadline)
                         {
                             /* Codes_SRS_PROV_CLIENT_07_026: [ Upon receiving the reply of the CLIENT_STATE_URL_REQ_SEND message from  iothub_client shall process the the reply of the CLIENT_STATE_URL_REQ_SEND state ] */
                             if (prov_info->prov_transport_protocol->prov_transport_get_op_status(prov_info->transport_handle) != 0)
@@ -1167,7 +1607,6 @@ void Prov_Device_LL_DoWork(PROV_DEVICE_LL_HANDLE handle)
                                     prov_info->prov_state = CLIENT_STATE_ERROR;
                                 }
                             }
-                            prov_info->status_throttle = current_time;
                         }
                     }
                     break;
@@ -1193,9 +1632,21 @@ void Prov_Device_LL_DoWork(PROV_DEVICE_LL_HANDLE handle)
                 case CLIENT_STATE_READY:
                     break;
 
+                case CLIENT_STATE_CACHED:
+                    deliver_cached_result(prov_info);
+                    break;
+
                 case CLIENT_STATE_ERROR:
                 default:
-                    prov_info->register_callback(prov_info->error_reason, NULL, NULL, prov_info->user_context);
+                    /* Codes_SRS_PROV_CLIENT_09_015: [ If a background revalidation fails because the service could not be reached, the client shall keep the cached result and not call register_callback. ] */
+                    if (prov_info->revalidating && (prov_info->error_reason == PROV_DEVICE_RESULT_TRANSPORT || prov_info->error_reason == PROV_DEVICE_RESULT_TIMEOUT))
+                    {
+                        LogError("Failure revalidating the cached registration result, keeping the cached assignment");
+                    }
+                    else
+                    {
+                        prov_info->register_callback(prov_info->error_reason, NULL, NULL, prov_info->user_context);
+                    }
                     prov_info->prov_state = CLIENT_STATE_READY;
                     cleanup_prov_info(prov_info);
                     break;
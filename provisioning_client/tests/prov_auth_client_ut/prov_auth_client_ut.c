@@ -115,6 +115,9 @@ static const char* TEST_KEY_NAME_VALUE = "key_value";
 static const char* TEST_BASE32_VALUE = "aebagbaf";
 
 static const char* TEST_REGISTRATION_ID = "Registration Id";
+static const char* TEST_SYMMETRIC_KEY = "Symmetric Key";
+static const char* TEST_X509_CERT = "Device Certificate";
+static const char* TEST_X509_PRIVATE_KEY = "Device Private Key";
 
 TEST_DEFINE_ENUM_TYPE(PROV_AUTH_RESULT, PROV_AUTH_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(PROV_AUTH_RESULT, PROV_AUTH_RESULT_VALUES);
@@ -1404,4 +1407,188 @@ BEGIN_TEST_SUITE(prov_auth_client_ut)
         prov_auth_destroy(sec_handle);
     }
 
+    static PROV_AUTH_HANDLE create_prov_auth(SECURE_DEVICE_TYPE device_type)
+    {
+        PROV_AUTH_HANDLE result;
+        STRICT_EXPECTED_CALL(prov_dev_security_get_type()).SetReturn(device_type);
+        result = prov_auth_create();
+        umock_c_reset_all_calls();
+        return result;
+    }
+
+    TEST_FUNCTION(prov_auth_set_symmetric_key_info_handle_NULL_fail)
+    {
+        //arrange
+
+        //act
+        int result = prov_auth_set_symmetric_key_info(NULL, TEST_REGISTRATION_ID, TEST_SYMMETRIC_KEY);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    TEST_FUNCTION(prov_auth_set_symmetric_key_info_symmetric_key_NULL_fail)
+    {
+        PROV_AUTH_HANDLE sec_handle = create_prov_auth(SECURE_DEVICE_TYPE_SYMMETRIC_KEY);
+
+        //arrange
+
+        //act
+        int result = prov_auth_set_symmetric_key_info(sec_handle, TEST_REGISTRATION_ID, NULL);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_auth_destroy(sec_handle);
+    }
+
+    TEST_FUNCTION(prov_auth_set_symmetric_key_info_x509_fail)
+    {
+        PROV_AUTH_HANDLE sec_handle = create_prov_auth(SECURE_DEVICE_TYPE_X509);
+
+        //arrange
+
+        //act
+        int result = prov_auth_set_symmetric_key_info(sec_handle, TEST_REGISTRATION_ID, TEST_SYMMETRIC_KEY);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_auth_destroy(sec_handle);
+    }
+
+    TEST_FUNCTION(prov_auth_set_symmetric_key_info_succeed)
+    {
+        PROV_AUTH_HANDLE sec_handle = create_prov_auth(SECURE_DEVICE_TYPE_SYMMETRIC_KEY);
+
+        //arrange
+        STRICT_EXPECTED_CALL(secure_device_set_symmetrical_key_info(IGNORED_PTR_ARG, TEST_REGISTRATION_ID, TEST_SYMMETRIC_KEY));
+
+        //act
+        int result = prov_auth_set_symmetric_key_info(sec_handle, TEST_REGISTRATION_ID, TEST_SYMMETRIC_KEY);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_auth_destroy(sec_handle);
+    }
+
+    TEST_FUNCTION(prov_auth_set_symmetric_key_info_fail)
+    {
+        PROV_AUTH_HANDLE sec_handle = create_prov_auth(SECURE_DEVICE_TYPE_SYMMETRIC_KEY);
+
+        //arrange
+        STRICT_EXPECTED_CALL(secure_device_set_symmetrical_key_info(IGNORED_PTR_ARG, TEST_REGISTRATION_ID, TEST_SYMMETRIC_KEY)).SetReturn(__LINE__);
+
+        //act
+        int result = prov_auth_set_symmetric_key_info(sec_handle, TEST_REGISTRATION_ID, TEST_SYMMETRIC_KEY);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_auth_destroy(sec_handle);
+    }
+
+    TEST_FUNCTION(prov_auth_set_x509_identity_handle_NULL_fail)
+    {
+        //arrange
+
+        //act
+        int result = prov_auth_set_x509_identity(NULL, TEST_X509_CERT, TEST_X509_PRIVATE_KEY);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    TEST_FUNCTION(prov_auth_set_x509_identity_tpm_fail)
+    {
+        PROV_AUTH_HANDLE sec_handle = create_prov_auth(SECURE_DEVICE_TYPE_TPM);
+
+        //arrange
+
+        //act
+        int result = prov_auth_set_x509_identity(sec_handle, TEST_X509_CERT, TEST_X509_PRIVATE_KEY);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        prov_auth_destroy(sec_handle);
+    }
+
+    TEST_FUNCTION(prov_auth_set_x509_identity_fail)
+    {
+        PROV_AUTH_HANDLE sec_handle = create_prov_auth(SECURE_DEVICE_TYPE_X509);
+
+        int negativeTestsInitResult = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+        //arrange
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_X509_CERT));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_X509_PRIVATE_KEY));
+
+        umock_c_negative_tests_snapshot();
+
+        size_t count = umock_c_negative_tests_call_count();
+        for (size_t index = 0; index < count; index++)
+        {
+            if (umock_c_negative_tests_can_call_fail(index))
+            {
+                umock_c_negative_tests_reset();
+                umock_c_negative_tests_fail_call(index);
+
+                //act
+                int result = prov_auth_set_x509_identity(sec_handle, TEST_X509_CERT, TEST_X509_PRIVATE_KEY);
+
+                //assert
+                ASSERT_ARE_NOT_EQUAL(int, 0, result, "prov_auth_set_x509_identity failure in test %zu/%zu", index, count);
+            }
+        }
+
+        //cleanup
+        umock_c_negative_tests_deinit();
+        prov_auth_destroy(sec_handle);
+    }
+
+    TEST_FUNCTION(prov_auth_set_x509_identity_get_certificate_succeed)
+    {
+        PROV_AUTH_HANDLE sec_handle = create_prov_auth(SECURE_DEVICE_TYPE_X509);
+        int set_result = prov_auth_set_x509_identity(sec_handle, TEST_X509_CERT, TEST_X509_PRIVATE_KEY);
+        ASSERT_ARE_EQUAL(int, 0, set_result);
+        umock_c_reset_all_calls();
+
+        //arrange
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_X509_CERT));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_X509_PRIVATE_KEY));
+
+        //act
+        char* certificate = prov_auth_get_certificate(sec_handle);
+        char* private_key = prov_auth_get_alias_key(sec_handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, TEST_X509_CERT, certificate);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_X509_PRIVATE_KEY, private_key);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        my_gballoc_free(certificate);
+        my_gballoc_free(private_key);
+        prov_auth_destroy(sec_handle);
+    }
+
     END_TEST_SUITE(prov_auth_client_ut)
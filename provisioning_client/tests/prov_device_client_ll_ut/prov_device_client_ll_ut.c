@@ -46,11 +46,14 @@ static void my_gballoc_free(void* ptr)
 #undef ENABLE_MOCKS
 
 #include "azure_prov_client/prov_device_ll_client.h"
+#include "azure_prov_client/internal/prov_device_ll_client_private.h"
 
 #define ENABLE_MOCKS
 #include "umock_c/umock_c_prod.h"
 MOCKABLE_FUNCTION(, void, on_prov_register_device_callback, PROV_DEVICE_RESULT, register_result, const char*, iothub_uri, const char*, device_id, void*, user_context);
 MOCKABLE_FUNCTION(, void, on_prov_register_status_callback, PROV_DEVICE_REG_STATUS, reg_status, void*, user_context);
+MOCKABLE_FUNCTION(, int, on_prov_cache_store, const char*, registration_id, const char*, cached_result, void*, user_context);
+MOCKABLE_FUNCTION(, const char*, on_prov_cache_load, const char*, registration_id, void*, user_context);
 MOCKABLE_FUNCTION(, char*, on_prov_transport_challenge_cb, const unsigned char*, nonce, size_t, nonce_len, const char*, key_name, void*, user_ctx);
 
 MOCKABLE_FUNCTION(, PROV_DEVICE_TRANSPORT_HANDLE, prov_transport_create, const char*, uri, TRANSPORT_HSM_TYPE, type, const char*, scope_id, const char*, prov_api_version, PROV_TRANSPORT_ERROR_CALLBACK, error_cb, void*, error_ctx);
@@ -64,6 +67,9 @@ MOCKABLE_FUNCTION(, int, prov_transport_set_trace, PROV_DEVICE_TRANSPORT_HANDLE,
 MOCKABLE_FUNCTION(, int, prov_transport_x509_cert, PROV_DEVICE_TRANSPORT_HANDLE, handle, const char*, certificate, const char*, private_key);
 MOCKABLE_FUNCTION(, int, prov_transport_set_trusted_cert, PROV_DEVICE_TRANSPORT_HANDLE, handle, const char*, certificate);
 MOCKABLE_FUNCTION(, int, prov_transport_set_proxy, PROV_DEVICE_TRANSPORT_HANDLE, handle, const HTTP_PROXY_OPTIONS*, proxy_option);
+MOCKABLE_FUNCTION(, int, prov_transport_set_option, PROV_DEVICE_TRANSPORT_HANDLE, handle, const char*, option_name, const void*, value);
+MOCKABLE_FUNCTION(, PROV_DEVICE_TRANSPORT_HANDLE, prov_transport_create_link, PROV_DEVICE_TRANSPORT_HANDLE, connection, PROV_TRANSPORT_ERROR_CALLBACK, error_cb, void*, error_ctx);
+MOCKABLE_FUNCTION(, void, prov_transport_destroy_link, PROV_DEVICE_TRANSPORT_HANDLE, link);
 
 MOCKABLE_FUNCTION(, JSON_Value*, json_parse_string, const char *, string);
 MOCKABLE_FUNCTION(, JSON_Status, json_serialize_to_file, const JSON_Value*, value, const char *, filename);
@@ -128,6 +134,31 @@ static const PROV_DEVICE_TRANSPORT_PROVIDER* trans_provider(void)
     return &g_prov_transport_func;
 }
 
+static PROV_DEVICE_TRANSPORT_PROVIDER g_prov_transport_link_func =
+{
+    prov_transport_create,
+    prov_transport_destroy,
+    prov_transport_open,
+    prov_transport_close,
+    prov_transport_register_device,
+    prov_transport_get_operation_status,
+    prov_transport_dowork,
+    prov_transport_set_trace,
+    prov_transport_x509_cert,
+    prov_transport_set_trusted_cert,
+    prov_transport_set_proxy,
+    prov_transport_set_option,
+    prov_transport_create_link,
+    prov_transport_destroy_link
+};
+
+static const PROV_DEVICE_TRANSPORT_PROVIDER* link_provider(void)
+{
+    return &g_prov_transport_link_func;
+}
+
+static const PROV_DEVICE_TRANSPORT_HANDLE TEST_CONNECTION_HANDLE = (PROV_DEVICE_TRANSPORT_HANDLE)0x11111120;
+
 static const BUFFER_HANDLE TEST_BUFFER_HANDLE = (BUFFER_HANDLE)0x11111116;
 
 static const char* TEST_JSON_REPLY = "{ json_reply }";
@@ -163,6 +194,8 @@ static int TEST_ERROR_STATUS_CODE = 500;
 #define TEST_DPS_HUB_ERROR_NO_HUB       400208
 #define TEST_DPS_HUB_ERROR_UNAUTH       400209
 #define DEFAULT_RETRY_AFTER             2
+#define DEFAULT_RETRY_AFTER_MS          (DEFAULT_RETRY_AFTER * 1000)
+#define MAX_POLL_DELAY_MS               (DEFAULT_RETRY_AFTER_MS + DEFAULT_RETRY_AFTER_MS / 2)
 
 static unsigned char TEST_ENDORSMENT_KEY[] = { 'k', 'e', 'y' };
 
@@ -254,6 +287,14 @@ static void my_tickcounter_destroy(TICK_COUNTER_HANDLE tick_counter)
     my_gballoc_free(tick_counter);
 }
 
+static tickcounter_ms_t g_current_ms;
+static int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t* current_ms)
+{
+    (void)tick_counter;
+    *current_ms = g_current_ms;
+    return 0;
+}
+
 static void my_BUFFER_delete(BUFFER_HANDLE handle)
 {
     my_gballoc_free(handle);
@@ -291,6 +332,20 @@ static void my_prov_transport_destroy(PROV_DEVICE_TRANSPORT_HANDLE handle)
     my_gballoc_free(handle);
 }
 
+static PROV_DEVICE_TRANSPORT_HANDLE my_prov_transport_create_link(PROV_DEVICE_TRANSPORT_HANDLE connection, PROV_TRANSPORT_ERROR_CALLBACK error_cb, void* error_ctx)
+{
+    (void)connection;
+    (void)error_cb;
+    (void)error_ctx;
+
+    return (PROV_DEVICE_TRANSPORT_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_prov_transport_destroy_link(PROV_DEVICE_TRANSPORT_HANDLE link)
+{
+    my_gballoc_free(link);
+}
+
 static int my_prov_transport_open(PROV_DEVICE_TRANSPORT_HANDLE handle, const char* registration_id, BUFFER_HANDLE ek, BUFFER_HANDLE srk, PROV_DEVICE_TRANSPORT_REGISTER_CALLBACK data_callback, void* user_ctx, PROV_DEVICE_TRANSPORT_STATUS_CALLBACK status_cb, void* status_ctx, PROV_TRANSPORT_CHALLENGE_CALLBACK reg_challenge_cb, void* challenge_ctx)
 {
     (void)handle;
@@ -419,6 +474,30 @@ static void my_json_value_free(JSON_Value* value)
     my_gballoc_free(value);
 }
 
+static JSON_Value* my_json_value_init_object(void)
+{
+    return (JSON_Value*)my_gballoc_malloc(1);
+}
+
+static char g_cached_result[128];
+static bool g_has_cached_result;
+
+static int my_on_prov_cache_store(const char* registration_id, const char* cached_result, void* user_context)
+{
+    (void)registration_id;
+    (void)user_context;
+    (void)snprintf(g_cached_result, sizeof(g_cached_result), "%s", cached_result);
+    g_has_cached_result = true;
+    return 0;
+}
+
+static const char* my_on_prov_cache_load(const char* registration_id, void* user_context)
+{
+    (void)registration_id;
+    (void)user_context;
+    return g_has_cached_result ? g_cached_result : NULL;
+}
+
 BEGIN_TEST_SUITE(prov_device_client_ll_ut)
 
     TEST_SUITE_INITIALIZE(suite_init)
@@ -458,6 +537,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         REGISTER_UMOCK_ALIAS_TYPE(PROV_TRANSPORT_JSON_PARSE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(PROV_TRANSPORT_CREATE_JSON_PAYLOAD, void*);
         REGISTER_UMOCK_ALIAS_TYPE(PROV_TRANSPORT_ERROR_CALLBACK, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(JSON_Status, int);
 
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
@@ -466,10 +546,14 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         REGISTER_GLOBAL_MOCK_HOOK(tickcounter_create, my_tickcounter_create);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_create, NULL);
         REGISTER_GLOBAL_MOCK_HOOK(tickcounter_destroy, my_tickcounter_destroy);
+        REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, my_tickcounter_get_current_ms);
 
         REGISTER_GLOBAL_MOCK_HOOK(prov_transport_create, my_prov_transport_create);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_transport_create, NULL);
         REGISTER_GLOBAL_MOCK_HOOK(prov_transport_destroy, my_prov_transport_destroy);
+        REGISTER_GLOBAL_MOCK_HOOK(prov_transport_create_link, my_prov_transport_create_link);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_transport_create_link, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(prov_transport_destroy_link, my_prov_transport_destroy_link);
         REGISTER_GLOBAL_MOCK_HOOK(prov_transport_open, my_prov_transport_open);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_transport_open, __LINE__);
 
@@ -537,6 +621,13 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
 
         REGISTER_GLOBAL_MOCK_HOOK(json_serialize_to_string, my_json_serialize_to_string);
         REGISTER_GLOBAL_MOCK_HOOK(json_free_serialized_string, my_json_free_serialized_string);
+        REGISTER_GLOBAL_MOCK_HOOK(json_value_init_object, my_json_value_init_object);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_value_init_object, NULL);
+        REGISTER_GLOBAL_MOCK_RETURN(json_object_get_string, TEST_STRING_VALUE);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_object_get_string, NULL);
+
+        REGISTER_GLOBAL_MOCK_HOOK(on_prov_cache_store, my_on_prov_cache_store);
+        REGISTER_GLOBAL_MOCK_HOOK(on_prov_cache_load, my_on_prov_cache_load);
 
     }
 
@@ -562,6 +653,8 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         g_challenge_ctx = NULL;
         g_json_parse_cb = NULL;
         g_json_ctx = NULL;
+        g_current_ms = 0;
+        g_has_cached_result = false;
     }
 
     TEST_FUNCTION_CLEANUP(method_cleanup)
@@ -751,6 +844,74 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         STRICT_EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
     }
 
+    static void setup_store_registration_result_mocks(bool has_key, bool has_payload)
+    {
+        STRICT_EXPECTED_CALL(json_value_init_object());
+        STRICT_EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        if (has_key)
+        {
+            STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG)).CallCannotFail();
+            STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG)).CallCannotFail();
+            STRICT_EXPECTED_CALL(Azure_Base64_Encode_Bytes(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+            STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).CallCannotFail();
+            STRICT_EXPECTED_CALL(json_object_set_string(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        }
+        if (has_payload)
+        {
+            STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(json_object_set_value(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        }
+        STRICT_EXPECTED_CALL(json_serialize_to_string(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(on_prov_cache_store(TEST_REGISTRATION_ID, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_free_serialized_string(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+    }
+
+    static void setup_load_registration_result_mocks(void)
+    {
+        STRICT_EXPECTED_CALL(on_prov_cache_load(TEST_REGISTRATION_ID, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Azure_Base64_Decode(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG)).CallCannotFail();
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG)).CallCannotFail();
+        STRICT_EXPECTED_CALL(prov_auth_import_key(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_object_get_value(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_serialize_to_string(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+    }
+
+    static void setup_register_with_registration_id_mocks(bool has_payload)
+    {
+        STRICT_EXPECTED_CALL(prov_auth_get_endorsement_key(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_auth_get_storage_key(IGNORED_PTR_ARG));
+        if (has_payload)
+        {
+            STRICT_EXPECTED_CALL(json_free_serialized_string(IGNORED_PTR_ARG));
+        }
+        STRICT_EXPECTED_CALL(prov_transport_open(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    }
+
+    static PROV_DEVICE_LL_HANDLE create_cached_handle(PROV_DEVICE_CACHE_REVALIDATE revalidate)
+    {
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Set_Result_Cache(handle, on_prov_cache_store, on_prov_cache_load, NULL);
+        (void)my_on_prov_cache_store(TEST_REGISTRATION_ID, TEST_CUSTOM_DATA, NULL);
+        (void)Prov_Device_LL_Register_Device_Cached(handle, revalidate, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        return handle;
+    }
+
     /* Tests_SRS_PROV_CLIENT_CLIENT_07_001: [If dev_auth_handle or prov_uri is NULL Prov_Device_LL_Create shall return NULL.] */
     TEST_FUNCTION(Prov_Device_LL_Create_uri_NULL_fail)
     {
@@ -817,6 +978,118 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         umock_c_negative_tests_deinit();
     }
 
+    static void setup_prov_device_ll_create_on_connection_mocks(void)
+    {
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(prov_auth_create());
+        STRICT_EXPECTED_CALL(tickcounter_create());
+        STRICT_EXPECTED_CALL(prov_auth_get_type(IGNORED_PTR_ARG)).SetReturn(PROV_AUTH_TYPE_TPM).CallCannotFail();
+        STRICT_EXPECTED_CALL(prov_transport_create_link(TEST_CONNECTION_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).CallCannotFail();
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_001: [ If id_scope, protocol or connection is NULL, or the transport does not implement links, prov_device_ll_create_on_connection shall return NULL. ] */
+    TEST_FUNCTION(prov_device_ll_create_on_connection_connection_NULL_fail)
+    {
+        //arrange
+
+        //act
+        PROV_DEVICE_LL_HANDLE result = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, NULL);
+
+        //assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_001: [ If id_scope, protocol or connection is NULL, or the transport does not implement links, prov_device_ll_create_on_connection shall return NULL. ] */
+    TEST_FUNCTION(prov_device_ll_create_on_connection_no_link_fail)
+    {
+        //arrange
+
+        //act
+        PROV_DEVICE_LL_HANDLE result = prov_device_ll_create_on_connection(TEST_SCOPE_ID, trans_provider, TEST_CONNECTION_HANDLE);
+
+        //assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_002: [ prov_device_ll_create_on_connection shall create the transport handle of the client with prov_transport_create_link on connection. ] */
+    TEST_FUNCTION(prov_device_ll_create_on_connection_succeed)
+    {
+        //arrange
+        setup_prov_device_ll_create_on_connection_mocks();
+
+        //act
+        PROV_DEVICE_LL_HANDLE result = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
+
+        //assert
+        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(result);
+    }
+
+    TEST_FUNCTION(prov_device_ll_create_on_connection_fail)
+    {
+        //arrange
+        int negativeTestsInitResult = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+        setup_prov_device_ll_create_on_connection_mocks();
+
+        umock_c_negative_tests_snapshot();
+
+        //act
+        size_t count = umock_c_negative_tests_call_count();
+        for (size_t index = 0; index < count; index++)
+        {
+            if (umock_c_negative_tests_can_call_fail(index))
+            {
+                umock_c_negative_tests_reset();
+                umock_c_negative_tests_fail_call(index);
+
+                PROV_DEVICE_LL_HANDLE result = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
+
+                // assert
+                ASSERT_IS_NULL(result, "prov_device_ll_create_on_connection failure in test %zu/%zu", index, count);
+            }
+        }
+
+        //cleanup
+        umock_c_negative_tests_deinit();
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_002: [ prov_device_ll_create_on_connection shall create the transport handle of the client with prov_transport_create_link on connection. ] */
+    TEST_FUNCTION(Prov_Device_LL_Destroy_on_connection_destroys_link_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
+        umock_c_reset_all_calls();
+
+        setup_cleanup_prov_info_mocks();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_transport_destroy_link(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_auth_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_LL_Destroy(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
     /* Tests_SRS_PROV_CLIENT_CLIENT_07_005: [ If handle is NULL Prov_Device_LL_Destroy shall do nothing. ] */
     TEST_FUNCTION(Prov_Device_LL_Destroy_handle_NULL)
     {
@@ -1306,6 +1579,23 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         Prov_Device_LL_Destroy(handle);
     }
 
+    /* Tests_SRS_PROV_CLIENT_09_003: [ If the client was created on a connection, Prov_Device_LL_DoWork shall not call prov_transport_dowork, the owner of the connection drives it. ] */
+    TEST_FUNCTION(Prov_Device_LL_DoWork_on_connection_no_transport_dowork_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
+        umock_c_reset_all_calls();
+
+        //act
+        Prov_Device_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
     TEST_FUNCTION(Prov_Device_LL_DoWork_get_operation_status_send_succeed)
     {
         //arrange
@@ -1314,6 +1604,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_AUTHENTICATED, DEFAULT_RETRY_AFTER, g_status_ctx);
+        g_current_ms += MAX_POLL_DELAY_MS;
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
@@ -1339,6 +1630,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
         g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_AUTHENTICATED, DEFAULT_RETRY_AFTER, g_status_ctx);
+        g_current_ms += MAX_POLL_DELAY_MS;
         umock_c_reset_all_calls();
 
         STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
@@ -1359,83 +1651,362 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         Prov_Device_LL_Destroy(handle);
     }
 
-    TEST_FUNCTION(Prov_Device_LL_challenge_cb_nonce_NULL_fail)
+    /* Tests_SRS_PROV_CLIENT_09_004: [ When the service replies that the registration is in progress, on_transport_status shall schedule the operation status request retry_interval seconds later, plus a random delay of at most PROV_STATUS_POLL_MAX_JITTER_PERCENT percent of it. ] */
+    TEST_FUNCTION(Prov_Device_LL_DoWork_get_operation_status_before_retry_after_succeed)
     {
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
         g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING, DEFAULT_RETRY_AFTER, g_status_ctx);
+        g_current_ms += DEFAULT_RETRY_AFTER_MS - 1;
         umock_c_reset_all_calls();
 
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
         //act
-        char* result = g_challenge_callback(NULL, TEST_DATA_LEN, TEST_STRING_HANDLE_VALUE, g_challenge_ctx);
+        Prov_Device_LL_DoWork(handle);
 
         //assert
-        ASSERT_IS_NULL(result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         //cleanup
         Prov_Device_LL_Destroy(handle);
     }
 
-    TEST_FUNCTION(Prov_Device_LL_challenge_cb_user_ctx_NULL_fail)
+    /* Tests_SRS_PROV_CLIENT_09_004: [ When the service replies that the registration is in progress, on_transport_status shall schedule the operation status request retry_interval seconds later, plus a random delay of at most PROV_STATUS_POLL_MAX_JITTER_PERCENT percent of it. ] */
+    /* Tests_SRS_PROV_CLIENT_09_005: [ Prov_Device_LL_DoWork shall send the operation status request once the time scheduled by on_transport_status is reached. ] */
+    TEST_FUNCTION(Prov_Device_LL_DoWork_get_operation_status_assigning_sequence_succeed)
     {
         //arrange
         PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
         g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
+        g_current_ms = 10000;
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING, DEFAULT_RETRY_AFTER, g_status_ctx);
+        g_current_ms += MAX_POLL_DELAY_MS;
+        Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING, DEFAULT_RETRY_AFTER, g_status_ctx);
         umock_c_reset_all_calls();
 
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_transport_get_operation_status(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
         //act
-        char* result = g_challenge_callback(TEST_DATA, TEST_DATA_LEN, TEST_STRING_HANDLE_VALUE, NULL);
+        g_current_ms += DEFAULT_RETRY_AFTER_MS - 1;
+        Prov_Device_LL_DoWork(handle);
+        g_current_ms += MAX_POLL_DELAY_MS - DEFAULT_RETRY_AFTER_MS + 1;
+        Prov_Device_LL_DoWork(handle);
 
         //assert
-        ASSERT_IS_NULL(result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         //cleanup
         Prov_Device_LL_Destroy(handle);
     }
 
-    TEST_FUNCTION(Prov_Device_LL_challenge_cb_succeed)
+    /* Tests_SRS_PROV_CLIENT_09_004: [ When the service replies that the registration is in progress, on_transport_status shall schedule the operation status request retry_interval seconds later, plus a random delay of at most PROV_STATUS_POLL_MAX_JITTER_PERCENT percent of it. ] */
+    TEST_FUNCTION(Prov_Device_LL_status_poll_jitter_spreads_clients_succeed)
     {
         //arrange
-        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        PROV_DEVICE_LL_HANDLE handles[16];
+        uint32_t poll_delays[16];
+        bool all_equal = true;
+        size_t index;
+
+        for (index = 0; index < sizeof(handles) / sizeof(handles[0]); index++)
+        {
+            handles[index] = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
+            (void)Prov_Device_LL_Register_Device(handles[index], on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+            g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
+            Prov_Device_LL_DoWork(handles[index]);
+            g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING, DEFAULT_RETRY_AFTER, g_status_ctx);
+        }
+        umock_c_reset_all_calls();
+
+        //act
+        for (index = 0; index < sizeof(handles) / sizeof(handles[0]); index++)
+        {
+            poll_delays[index] = prov_device_ll_get_poll_delay(handles[index]);
+        }
+
+        //assert
+        for (index = 0; index < sizeof(handles) / sizeof(handles[0]); index++)
+        {
+            ASSERT_IS_TRUE(poll_delays[index] >= DEFAULT_RETRY_AFTER_MS);
+            ASSERT_IS_TRUE(poll_delays[index] <= MAX_POLL_DELAY_MS);
+            if (poll_delays[index] != poll_delays[0])
+            {
+                all_equal = false;
+            }
+        }
+        ASSERT_IS_FALSE(all_equal);
+
+        //cleanup
+        for (index = 0; index < sizeof(handles) / sizeof(handles[0]); index++)
+        {
+            Prov_Device_LL_Destroy(handles[index]);
+        }
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_006: [ If handle is NULL, or the client is not waiting to send its operation status request, prov_device_ll_get_poll_delay shall return 0. ] */
+    TEST_FUNCTION(prov_device_ll_get_poll_delay_handle_NULL_fail)
+    {
+        //arrange
+
+        //act
+        uint32_t poll_delay = prov_device_ll_get_poll_delay(NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(uint32_t, 0, poll_delay);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_006: [ If handle is NULL, or the client is not waiting to send its operation status request, prov_device_ll_get_poll_delay shall return 0. ] */
+    TEST_FUNCTION(prov_device_ll_get_poll_delay_register_send_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
         g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
-        Prov_Device_LL_DoWork(handle);
         umock_c_reset_all_calls();
 
-        setup_challenge_callback_mocks();
-
         //act
-        char* result = g_challenge_callback(TEST_DATA, TEST_DATA_LEN, TEST_STRING_HANDLE_VALUE, g_challenge_ctx);
+        uint32_t poll_delay = prov_device_ll_get_poll_delay(handle);
 
         //assert
-        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(uint32_t, 0, poll_delay);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         //cleanup
         Prov_Device_LL_Destroy(handle);
     }
 
-    TEST_FUNCTION(Prov_Device_LL_challenge_cb_fail)
+    /* Tests_SRS_PROV_CLIENT_09_007: [ Otherwise prov_device_ll_get_poll_delay shall return the milliseconds left before the operation status request is due. ] */
+    TEST_FUNCTION(prov_device_ll_get_poll_delay_succeed)
     {
         //arrange
-        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        PROV_DEVICE_LL_HANDLE handle = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
         (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
         g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
         Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING, DEFAULT_RETRY_AFTER, g_status_ctx);
+        g_current_ms += DEFAULT_RETRY_AFTER_MS / 2;
         umock_c_reset_all_calls();
 
-        int negativeTestsInitResult = umock_c_negative_tests_init();
-        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        setup_challenge_callback_mocks();
+        //act
+        uint32_t poll_delay = prov_device_ll_get_poll_delay(handle);
 
-        umock_c_negative_tests_snapshot();
+        //assert
+        ASSERT_IS_TRUE(poll_delay >= DEFAULT_RETRY_AFTER_MS / 2);
+        ASSERT_IS_TRUE(poll_delay <= MAX_POLL_DELAY_MS - DEFAULT_RETRY_AFTER_MS / 2);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_017: [ If handle, registration_id or symmetric_key is NULL, prov_device_ll_set_symmetric_key shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(prov_device_ll_set_symmetric_key_handle_NULL_fail)
+    {
+        //arrange
+
+        //act
+        PROV_DEVICE_RESULT prov_result = prov_device_ll_set_symmetric_key(NULL, TEST_REGISTRATION_ID, TEST_KEY);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_018: [ prov_device_ll_set_symmetric_key shall give the key to the security module of this client only with prov_auth_set_symmetric_key_info, and return PROV_DEVICE_RESULT_ERROR if that fails. ] */
+    TEST_FUNCTION(prov_device_ll_set_symmetric_key_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_auth_set_symmetric_key_info(IGNORED_PTR_ARG, TEST_REGISTRATION_ID, TEST_KEY));
+
+        //act
+        PROV_DEVICE_RESULT prov_result = prov_device_ll_set_symmetric_key(handle, TEST_REGISTRATION_ID, TEST_KEY);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_018: [ prov_device_ll_set_symmetric_key shall give the key to the security module of this client only with prov_auth_set_symmetric_key_info, and return PROV_DEVICE_RESULT_ERROR if that fails. ] */
+    TEST_FUNCTION(prov_device_ll_set_symmetric_key_fail)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_auth_set_symmetric_key_info(IGNORED_PTR_ARG, TEST_REGISTRATION_ID, TEST_KEY)).SetReturn(__LINE__);
+
+        //act
+        PROV_DEVICE_RESULT prov_result = prov_device_ll_set_symmetric_key(handle, TEST_REGISTRATION_ID, TEST_KEY);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_019: [ If handle, certificate or private_key is NULL, prov_device_ll_set_x509_identity shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(prov_device_ll_set_x509_identity_private_key_NULL_fail)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = prov_device_ll_set_x509_identity(handle, TEST_CERTIFICATE_VAL, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_020: [ prov_device_ll_set_x509_identity shall give the certificate and key to the security module of this client only with prov_auth_set_x509_identity, and return PROV_DEVICE_RESULT_ERROR if that fails. ] */
+    TEST_FUNCTION(prov_device_ll_set_x509_identity_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_auth_set_x509_identity(IGNORED_PTR_ARG, TEST_CERTIFICATE_VAL, TEST_KEY));
+
+        //act
+        PROV_DEVICE_RESULT prov_result = prov_device_ll_set_x509_identity(handle, TEST_CERTIFICATE_VAL, TEST_KEY);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_020: [ prov_device_ll_set_x509_identity shall give the certificate and key to the security module of this client only with prov_auth_set_x509_identity, and return PROV_DEVICE_RESULT_ERROR if that fails. ] */
+    TEST_FUNCTION(prov_device_ll_set_x509_identity_fail)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = prov_device_ll_create_on_connection(TEST_SCOPE_ID, link_provider, TEST_CONNECTION_HANDLE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_auth_set_x509_identity(IGNORED_PTR_ARG, TEST_CERTIFICATE_VAL, TEST_KEY)).SetReturn(__LINE__);
+
+        //act
+        PROV_DEVICE_RESULT prov_result = prov_device_ll_set_x509_identity(handle, TEST_CERTIFICATE_VAL, TEST_KEY);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    TEST_FUNCTION(Prov_Device_LL_challenge_cb_nonce_NULL_fail)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        //act
+        char* result = g_challenge_callback(NULL, TEST_DATA_LEN, TEST_STRING_HANDLE_VALUE, g_challenge_ctx);
+
+        //assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    TEST_FUNCTION(Prov_Device_LL_challenge_cb_user_ctx_NULL_fail)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        //act
+        char* result = g_challenge_callback(TEST_DATA, TEST_DATA_LEN, TEST_STRING_HANDLE_VALUE, NULL);
+
+        //assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    TEST_FUNCTION(Prov_Device_LL_challenge_cb_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        setup_challenge_callback_mocks();
+
+        //act
+        char* result = g_challenge_callback(TEST_DATA, TEST_DATA_LEN, TEST_STRING_HANDLE_VALUE, g_challenge_ctx);
+
+        //assert
+        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    TEST_FUNCTION(Prov_Device_LL_challenge_cb_fail)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        int negativeTestsInitResult = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+        setup_challenge_callback_mocks();
+
+        umock_c_negative_tests_snapshot();
 
         //act
         size_t count = umock_c_negative_tests_call_count();
@@ -2040,4 +2611,344 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         Prov_Device_LL_Destroy(handle);
     }
 
+    /* Tests_SRS_PROV_CLIENT_09_008: [ If handle is NULL, or only one of store_callback and load_callback is NULL, Prov_Device_LL_Set_Result_Cache shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(Prov_Device_LL_Set_Result_Cache_handle_NULL_fail)
+    {
+        //arrange
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_Set_Result_Cache(NULL, on_prov_cache_store, on_prov_cache_load, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_008: [ If handle is NULL, or only one of store_callback and load_callback is NULL, Prov_Device_LL_Set_Result_Cache shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(Prov_Device_LL_Set_Result_Cache_load_callback_NULL_fail)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_Set_Result_Cache(handle, on_prov_cache_store, NULL, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_009: [ Prov_Device_LL_Set_Result_Cache shall keep the callbacks for the following registrations, NULL callbacks disable the cache. ] */
+    TEST_FUNCTION(Prov_Device_LL_Set_Result_Cache_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_Set_Result_Cache(handle, on_prov_cache_store, on_prov_cache_load, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_010: [ After a successful registration, the client shall pass the assigned hub, the device id, the key and the payload returned by the service to the store callback. ] */
+    TEST_FUNCTION(Prov_Device_LL_on_registration_data_stores_result_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Set_Result_Cache(handle, on_prov_cache_store, on_prov_cache_load, NULL);
+        (void)Prov_Device_LL_Register_Device(handle, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        setup_parse_json_assigned_mocks(true, true);
+        PROV_JSON_INFO* parse_info = g_json_parse_cb(TEST_JSON_REPLY, g_json_ctx);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG)).CallCannotFail();
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG)).CallCannotFail();
+        STRICT_EXPECTED_CALL(prov_auth_import_key(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        setup_store_registration_result_mocks(true, true);
+        STRICT_EXPECTED_CALL(on_prov_register_device_callback(PROV_DEVICE_RESULT_OK, TEST_IOTHUB, TEST_DEVICE_ID, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_transport_close(IGNORED_PTR_ARG));
+        setup_cleanup_prov_info_mocks();
+
+        //act
+        g_registration_callback(PROV_DEVICE_TRANSPORT_RESULT_OK, TEST_BUFFER_HANDLE_VALUE, TEST_IOTHUB, TEST_DEVICE_ID, g_registration_ctx);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_IS_TRUE(g_has_cached_result);
+
+        //cleanup
+        free_prov_json_info(parse_info);
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_011: [ If handle or register_callback is NULL, Prov_Device_LL_Register_Device_Cached shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(Prov_Device_LL_Register_Device_Cached_handle_NULL_fail)
+    {
+        //arrange
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_Register_Device_Cached(NULL, PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_011: [ If handle or register_callback is NULL, Prov_Device_LL_Register_Device_Cached shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(Prov_Device_LL_Register_Device_Cached_register_callback_NULL_fail)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_Register_Device_Cached(handle, PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND, NULL, NULL, on_prov_register_status_callback, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_012: [ If no result cache is set, or it holds no valid result for the registration id, Prov_Device_LL_Register_Device_Cached shall register with the service as Prov_Device_LL_Register_Device does. ] */
+    TEST_FUNCTION(Prov_Device_LL_Register_Device_Cached_no_cache_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        setup_Prov_Device_LL_Register_Device_mocks(true);
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_Register_Device_Cached(handle, PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_012: [ If no result cache is set, or it holds no valid result for the registration id, Prov_Device_LL_Register_Device_Cached shall register with the service as Prov_Device_LL_Register_Device does. ] */
+    TEST_FUNCTION(Prov_Device_LL_Register_Device_Cached_cache_miss_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Set_Result_Cache(handle, on_prov_cache_store, on_prov_cache_load, NULL);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_auth_get_registration_id(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(on_prov_cache_load(TEST_REGISTRATION_ID, IGNORED_PTR_ARG));
+        setup_register_with_registration_id_mocks(false);
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_Register_Device_Cached(handle, PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_012: [ If no result cache is set, or it holds no valid result for the registration id, Prov_Device_LL_Register_Device_Cached shall register with the service as Prov_Device_LL_Register_Device does. ] */
+    TEST_FUNCTION(Prov_Device_LL_Register_Device_Cached_import_key_fail_registers)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Set_Result_Cache(handle, on_prov_cache_store, on_prov_cache_load, NULL);
+        (void)my_on_prov_cache_store(TEST_REGISTRATION_ID, TEST_CUSTOM_DATA, NULL);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_auth_get_registration_id(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(on_prov_cache_load(TEST_REGISTRATION_ID, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_object_get_string(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Azure_Base64_Decode(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_auth_import_key(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG)).SetReturn(__LINE__);
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_value_free(IGNORED_PTR_ARG));
+        setup_register_with_registration_id_mocks(false);
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_Register_Device_Cached(handle, PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_013: [ Otherwise Prov_Device_LL_Register_Device_Cached shall not contact the service, and the next Prov_Device_LL_DoWork shall call register_callback with the cached assigned hub and device id. ] */
+    TEST_FUNCTION(Prov_Device_LL_Register_Device_Cached_cache_hit_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        (void)Prov_Device_LL_Set_Result_Cache(handle, on_prov_cache_store, on_prov_cache_load, NULL);
+        (void)my_on_prov_cache_store(TEST_REGISTRATION_ID, TEST_CUSTOM_DATA, NULL);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_auth_get_registration_id(IGNORED_PTR_ARG));
+        setup_load_registration_result_mocks();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_LL_Register_Device_Cached(handle, PROV_DEVICE_CACHE_REVALIDATE_ON_FAILURE, on_prov_register_device_callback, NULL, on_prov_register_status_callback, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(char_ptr, TEST_CUSTOM_DATA, Prov_Device_LL_Get_Provisioning_Payload(handle));
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_013: [ Otherwise Prov_Device_LL_Register_Device_Cached shall not contact the service, and the next Prov_Device_LL_DoWork shall call register_callback with the cached assigned hub and device id. ] */
+    TEST_FUNCTION(Prov_Device_LL_DoWork_cached_on_failure_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = create_cached_handle(PROV_DEVICE_CACHE_REVALIDATE_ON_FAILURE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(on_prov_register_device_callback(PROV_DEVICE_RESULT_OK, TEST_STRING_VALUE, TEST_STRING_VALUE, IGNORED_PTR_ARG));
+        setup_cleanup_prov_info_mocks();
+
+        //act
+        Prov_Device_LL_DoWork(handle);
+        Prov_Device_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_014: [ With PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND, the client shall then register with the service. ] */
+    TEST_FUNCTION(Prov_Device_LL_DoWork_cached_background_registers_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = create_cached_handle(PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(on_prov_register_device_callback(PROV_DEVICE_RESULT_OK, TEST_STRING_VALUE, TEST_STRING_VALUE, IGNORED_PTR_ARG));
+        setup_register_with_registration_id_mocks(true);
+
+        //act
+        Prov_Device_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_016: [ When a background revalidation succeeds, the client shall only call register_callback if the assigned hub or the device id differ from the cached ones. ] */
+    TEST_FUNCTION(Prov_Device_LL_revalidation_same_assignment_no_callback_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = create_cached_handle(PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND);
+        Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG)).CallCannotFail();
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG)).CallCannotFail();
+        STRICT_EXPECTED_CALL(prov_auth_import_key(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        setup_store_registration_result_mocks(true, false);
+        STRICT_EXPECTED_CALL(prov_transport_close(IGNORED_PTR_ARG));
+        setup_cleanup_prov_info_mocks();
+
+        //act
+        g_registration_callback(PROV_DEVICE_TRANSPORT_RESULT_OK, TEST_BUFFER_HANDLE_VALUE, TEST_STRING_VALUE, TEST_STRING_VALUE, g_registration_ctx);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_016: [ When a background revalidation succeeds, the client shall only call register_callback if the assigned hub or the device id differ from the cached ones. ] */
+    TEST_FUNCTION(Prov_Device_LL_revalidation_new_assignment_callback_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = create_cached_handle(PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND);
+        Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG)).CallCannotFail();
+        STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG)).CallCannotFail();
+        STRICT_EXPECTED_CALL(prov_auth_import_key(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        setup_store_registration_result_mocks(true, false);
+        STRICT_EXPECTED_CALL(on_prov_register_device_callback(PROV_DEVICE_RESULT_OK, TEST_IOTHUB, TEST_DEVICE_ID, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_transport_close(IGNORED_PTR_ARG));
+        setup_cleanup_prov_info_mocks();
+
+        //act
+        g_registration_callback(PROV_DEVICE_TRANSPORT_RESULT_OK, TEST_BUFFER_HANDLE_VALUE, TEST_IOTHUB, TEST_DEVICE_ID, g_registration_ctx);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_CLIENT_09_015: [ If a background revalidation fails because the service could not be reached, the client shall keep the cached result and not call register_callback. ] */
+    TEST_FUNCTION(Prov_Device_LL_revalidation_transport_error_no_callback_succeed)
+    {
+        //arrange
+        PROV_DEVICE_LL_HANDLE handle = create_cached_handle(PROV_DEVICE_CACHE_REVALIDATE_BACKGROUND);
+        Prov_Device_LL_DoWork(handle);
+        g_status_callback(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, DEFAULT_RETRY_AFTER, g_status_ctx);
+        Prov_Device_LL_DoWork(handle);
+        g_registration_callback(PROV_DEVICE_TRANSPORT_RESULT_ERROR, NULL, NULL, NULL, g_registration_ctx);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_close(IGNORED_PTR_ARG));
+        setup_cleanup_prov_info_mocks();
+
+        //act
+        Prov_Device_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_IS_TRUE(g_has_cached_result);
+
+        //cleanup
+        Prov_Device_LL_Destroy(handle);
+    }
+
     END_TEST_SUITE(prov_device_client_ll_ut)
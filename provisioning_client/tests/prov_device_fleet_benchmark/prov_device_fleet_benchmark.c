@@ -0,0 +1,230 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Measures how fast a gateway registers a fleet of devices from one thread, against the in-process
+// stand-in of the Device Provisioning Service in prov_transport_stub.c:
+//  - one Prov_Device_LL client per device, every client opening its own connection
+//  - one Prov_Device_Fleet_LL client, every registration linked to one shared connection
+// Only the stand-in implements links.  With the HTTP, MQTT and AMQP transports the fleet opens one connection per
+// registration, so the second figure is not what a gateway gets against the real service.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/threadapi.h"
+
+#include "azure_prov_client/prov_device_ll_client.h"
+#include "azure_prov_client/prov_device_fleet_ll_client.h"
+#include "azure_prov_client/prov_security_factory.h"
+#include "prov_transport_stub.h"
+
+#define DEVICE_COUNT                1000
+#define REGISTRATION_ID_SIZE        32
+#define DOWORK_INTERVAL_IN_MS       1
+
+static const char* const STUB_URI = "global.azure-devices-provisioning.net";
+static const char* const STUB_SCOPE_ID = "0ne00000000";
+static const char* const SYMMETRIC_KEY_REGISTRATION = "fleet-benchmark";
+static const char* const SYMMETRIC_KEY = "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=";
+
+static const PROV_TRANSPORT_STUB_CONFIG stub_config = { 2, 100, 50 };
+
+typedef struct BENCHMARK_RESULT_TAG
+{
+    size_t completed;
+    size_t assigned;
+} BENCHMARK_RESULT;
+
+static void on_device_registered(PROV_DEVICE_RESULT register_result, const char* iothub_uri, const char* device_id, void* user_context)
+{
+    BENCHMARK_RESULT* benchmark_result = (BENCHMARK_RESULT*)user_context;
+    (void)iothub_uri;
+    (void)device_id;
+
+    benchmark_result->completed++;
+    if (register_result == PROV_DEVICE_RESULT_OK)
+    {
+        benchmark_result->assigned++;
+    }
+}
+
+static void get_registration_id(size_t index, char* registration_id)
+{
+    (void)snprintf(registration_id, REGISTRATION_ID_SIZE, "fleet-device-%05lu", (unsigned long)index);
+}
+
+static int run_separate_clients(BENCHMARK_RESULT* benchmark_result)
+{
+    int result;
+    PROV_DEVICE_LL_HANDLE* clients;
+
+    if ((clients = (PROV_DEVICE_LL_HANDLE*)calloc(DEVICE_COUNT, sizeof(PROV_DEVICE_LL_HANDLE))) == NULL)
+    {
+        LogError("Failed allocating the clients");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        size_t i;
+        char registration_id[REGISTRATION_ID_SIZE];
+
+        result = 0;
+
+        for (i = 0; i < DEVICE_COUNT && result == 0; i++)
+        {
+            get_registration_id(i, registration_id);
+            if ((clients[i] = Prov_Device_LL_Create(STUB_URI, STUB_SCOPE_ID, Prov_Device_Stub_Unshared_Protocol)) == NULL)
+            {
+                LogError("Failed creating the client of %s", registration_id);
+                result = MU_FAILURE;
+            }
+            else if (Prov_Device_LL_SetOption(clients[i], PROV_REGISTRATION_ID, registration_id) != PROV_DEVICE_RESULT_OK ||
+                Prov_Device_LL_Register_Device(clients[i], on_device_registered, benchmark_result, NULL, NULL) != PROV_DEVICE_RESULT_OK)
+            {
+                LogError("Failed registering %s", registration_id);
+                result = MU_FAILURE;
+            }
+        }
+
+        while (result == 0 && benchmark_result->completed < DEVICE_COUNT)
+        {
+            for (i = 0; i < DEVICE_COUNT; i++)
+            {
+                Prov_Device_LL_DoWork(clients[i]);
+            }
+            ThreadAPI_Sleep(DOWORK_INTERVAL_IN_MS);
+        }
+
+        for (i = 0; i < DEVICE_COUNT; i++)
+        {
+            Prov_Device_LL_Destroy(clients[i]);
+        }
+        free(clients);
+    }
+
+    return result;
+}
+
+static int run_fleet(BENCHMARK_RESULT* benchmark_result)
+{
+    int result;
+    PROV_DEVICE_FLEET_LL_HANDLE fleet;
+
+    if ((fleet = Prov_Device_Fleet_LL_Create(STUB_URI, STUB_SCOPE_ID, Prov_Device_Stub_Protocol)) == NULL)
+    {
+        LogError("Failed creating the fleet client");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        size_t max_in_flight = DEVICE_COUNT;
+        size_t i;
+        char registration_id[REGISTRATION_ID_SIZE];
+
+        result = 0;
+
+        if (Prov_Device_Fleet_LL_SetOption(fleet, PROV_FLEET_OPTION_MAX_IN_FLIGHT, &max_in_flight) != PROV_DEVICE_RESULT_OK)
+        {
+            LogError("Failed setting the maximum registrations in flight");
+            result = MU_FAILURE;
+        }
+
+        for (i = 0; i < DEVICE_COUNT && result == 0; i++)
+        {
+            get_registration_id(i, registration_id);
+            if (Prov_Device_Fleet_LL_Register_Device(fleet, registration_id, NULL, on_device_registered, benchmark_result, NULL, NULL) != PROV_DEVICE_RESULT_OK)
+            {
+                LogError("Failed registering %s", registration_id);
+                result = MU_FAILURE;
+            }
+        }
+
+        while (result == 0 && Prov_Device_Fleet_LL_Get_Pending_Count(fleet) > 0)
+        {
+            Prov_Device_Fleet_LL_DoWork(fleet);
+            ThreadAPI_Sleep(DOWORK_INTERVAL_IN_MS);
+        }
+
+        Prov_Device_Fleet_LL_Destroy(fleet);
+    }
+
+    return result;
+}
+
+typedef struct BENCHMARK_SCENARIO_TAG
+{
+    const char* name;
+    int(*run)(BENCHMARK_RESULT* benchmark_result);
+} BENCHMARK_SCENARIO;
+
+static const BENCHMARK_SCENARIO scenarios[] =
+{
+    { "one Prov_Device_LL client and connection per device", run_separate_clients },
+    { "Prov_Device_Fleet_LL, one shared connection", run_fleet }
+};
+
+int main(void)
+{
+    int result;
+    TICK_COUNTER_HANDLE tick_counter;
+
+    if (prov_dev_set_symmetric_key_info(SYMMETRIC_KEY_REGISTRATION, SYMMETRIC_KEY) != 0)
+    {
+        LogError("Failed setting the symmetric key");
+        result = MU_FAILURE;
+    }
+    else if (prov_dev_security_init(SECURE_DEVICE_TYPE_SYMMETRIC_KEY) != 0)
+    {
+        LogError("Failed initializing the security module");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if ((tick_counter = tickcounter_create()) == NULL)
+        {
+            LogError("Failed creating the tick counter");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            size_t i;
+
+            result = 0;
+
+            (void)printf("devices: %d, handshake: %lu ms CPU + %lu ms, service latency: %lu ms\r\n",
+                DEVICE_COUNT, (unsigned long)stub_config.handshake_cpu_ms, (unsigned long)stub_config.handshake_latency_ms,
+                (unsigned long)stub_config.service_latency_ms);
+
+            for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]) && result == 0; i++)
+            {
+                BENCHMARK_RESULT benchmark_result = { 0, 0 };
+                tickcounter_ms_t start_ms;
+                tickcounter_ms_t end_ms;
+
+                prov_transport_stub_configure(&stub_config);
+
+                (void)tickcounter_get_current_ms(tick_counter, &start_ms);
+                result = scenarios[i].run(&benchmark_result);
+                (void)tickcounter_get_current_ms(tick_counter, &end_ms);
+
+                if (result == 0)
+                {
+                    tickcounter_ms_t elapsed_ms = (end_ms > start_ms) ? end_ms - start_ms : 1;
+                    (void)printf("%s: %lu assigned in %lu ms (%.1f registrations/sec), %lu handshakes\r\n",
+                        scenarios[i].name, (unsigned long)benchmark_result.assigned, (unsigned long)elapsed_ms,
+                        (double)benchmark_result.assigned * 1000.0 / (double)elapsed_ms,
+                        (unsigned long)prov_transport_stub_get_handshake_count());
+                }
+            }
+
+            tickcounter_destroy(tick_counter);
+        }
+
+        prov_dev_security_deinit();
+    }
+
+    return result;
+}
@@ -0,0 +1,523 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/tickcounter.h"
+
+#include "azure_prov_client/internal/prov_transport_private.h"
+#include "prov_transport_stub.h"
+
+#define STUB_REPLY_SIZE     512
+
+static const char* const KEY_NAME_VALUE = "registration";
+static const char* const STUB_ASSIGNED_HUB = "fleet-benchmark.azure-devices.net";
+
+static const char* const ASSIGNING_REPLY_FMT = "{\"operationId\":\"4.%s\",\"status\":\"assigning\"}";
+static const char* const ASSIGNED_REPLY_FMT = "{\"operationId\":\"4.%s\",\"status\":\"assigned\",\"registrationState\":{\"registrationId\":\"%s\",\"assignedHub\":\"%s\",\"deviceId\":\"%s\",\"status\":\"assigned\"}}";
+
+static PROV_TRANSPORT_STUB_CONFIG g_stub_config = { 2, 100, 50 };
+static size_t g_handshake_count;
+
+typedef enum STUB_REQUEST_TAG
+{
+    STUB_REQUEST_NONE,
+    STUB_REQUEST_REGISTER,
+    STUB_REQUEST_STATUS
+} STUB_REQUEST;
+
+typedef struct STUB_TRANSPORT_INFO_TAG
+{
+    // NULL for a connection, the connection carrying the registration for a link
+    struct STUB_TRANSPORT_INFO_TAG* connection;
+    struct STUB_TRANSPORT_INFO_TAG* first_link;
+    struct STUB_TRANSPORT_INFO_TAG* prev_link;
+    struct STUB_TRANSPORT_INFO_TAG* next_link;
+
+    // Connection only
+    TICK_COUNTER_HANDLE tick_counter;
+    TRANSPORT_HSM_TYPE hsm_type;
+    bool handshake_started;
+    bool connected;
+    tickcounter_ms_t connected_at;
+
+    // The registration, carried by a link or by a connection used without links
+    bool is_open;
+    bool connected_reported;
+    char* registration_id;
+    STUB_REQUEST request;
+    tickcounter_ms_t reply_at;
+
+    PROV_DEVICE_TRANSPORT_REGISTER_CALLBACK register_data_cb;
+    void* user_ctx;
+    PROV_DEVICE_TRANSPORT_STATUS_CALLBACK status_cb;
+    void* status_ctx;
+    PROV_TRANSPORT_CHALLENGE_CALLBACK challenge_cb;
+    void* challenge_ctx;
+    PROV_TRANSPORT_JSON_PARSE json_parse_cb;
+    void* json_ctx;
+} STUB_TRANSPORT_INFO;
+
+void prov_transport_stub_configure(const PROV_TRANSPORT_STUB_CONFIG* config)
+{
+    g_stub_config = *config;
+    g_handshake_count = 0;
+}
+
+size_t prov_transport_stub_get_handshake_count(void)
+{
+    return g_handshake_count;
+}
+
+static STUB_TRANSPORT_INFO* get_connection(STUB_TRANSPORT_INFO* info)
+{
+    return (info->connection != NULL) ? info->connection : info;
+}
+
+static tickcounter_ms_t get_current_ms(STUB_TRANSPORT_INFO* info)
+{
+    tickcounter_ms_t current_ms = 0;
+    (void)tickcounter_get_current_ms(get_connection(info)->tick_counter, &current_ms);
+    return current_ms;
+}
+
+static void free_json_parse_info(PROV_JSON_INFO* parse_info)
+{
+    switch (parse_info->prov_status)
+    {
+        case PROV_DEVICE_TRANSPORT_STATUS_ASSIGNED:
+            BUFFER_delete(parse_info->authorization_key);
+            free(parse_info->iothub_uri);
+            free(parse_info->device_id);
+            break;
+        case PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING:
+            free(parse_info->operation_id);
+            break;
+        default:
+            break;
+    }
+    free(parse_info);
+}
+
+static void send_reply(STUB_TRANSPORT_INFO* info, STUB_REQUEST request)
+{
+    char reply[STUB_REPLY_SIZE];
+    PROV_JSON_INFO* parse_info;
+    int length;
+
+    if (request == STUB_REQUEST_REGISTER)
+    {
+        length = snprintf(reply, sizeof(reply), ASSIGNING_REPLY_FMT, info->registration_id);
+    }
+    else
+    {
+        length = snprintf(reply, sizeof(reply), ASSIGNED_REPLY_FMT, info->registration_id, info->registration_id, STUB_ASSIGNED_HUB, info->registration_id);
+    }
+
+    if (length < 0 || (size_t)length >= sizeof(reply))
+    {
+        LogError("Failure building the reply of %s", info->registration_id);
+        info->register_data_cb(PROV_DEVICE_TRANSPORT_RESULT_ERROR, NULL, NULL, NULL, info->user_ctx);
+    }
+    else if ((parse_info = info->json_parse_cb(reply, info->json_ctx)) == NULL)
+    {
+        LogError("Failure parsing the reply of %s", info->registration_id);
+        info->register_data_cb(PROV_DEVICE_TRANSPORT_RESULT_ERROR, NULL, NULL, NULL, info->user_ctx);
+    }
+    else
+    {
+        switch (parse_info->prov_status)
+        {
+            case PROV_DEVICE_TRANSPORT_STATUS_ASSIGNING:
+                info->status_cb(parse_info->prov_status, 0, info->status_ctx);
+                break;
+            case PROV_DEVICE_TRANSPORT_STATUS_ASSIGNED:
+                info->register_data_cb(PROV_DEVICE_TRANSPORT_RESULT_OK, parse_info->authorization_key, parse_info->iothub_uri, parse_info->device_id, info->user_ctx);
+                break;
+            default:
+                info->register_data_cb(PROV_DEVICE_TRANSPORT_RESULT_ERROR, NULL, NULL, NULL, info->user_ctx);
+                break;
+        }
+        free_json_parse_info(parse_info);
+    }
+}
+
+static void process_registration(STUB_TRANSPORT_INFO* info, tickcounter_ms_t current_ms)
+{
+    if (!info->is_open)
+    {
+        // Nothing to carry
+    }
+    else if (!info->connected_reported)
+    {
+        info->connected_reported = true;
+        info->status_cb(PROV_DEVICE_TRANSPORT_STATUS_CONNECTED, 0, info->status_ctx);
+    }
+    else if (info->request != STUB_REQUEST_NONE && current_ms >= info->reply_at)
+    {
+        STUB_REQUEST request = info->request;
+        info->request = STUB_REQUEST_NONE;
+        send_reply(info, request);
+    }
+}
+
+static bool has_open_registration(STUB_TRANSPORT_INFO* connection)
+{
+    bool result = connection->is_open;
+    STUB_TRANSPORT_INFO* link;
+    for (link = connection->first_link; link != NULL && !result; link = link->next_link)
+    {
+        result = link->is_open;
+    }
+    return result;
+}
+
+static void burn_cpu(STUB_TRANSPORT_INFO* connection, uint32_t duration_ms)
+{
+    tickcounter_ms_t start_ms = get_current_ms(connection);
+    while (get_current_ms(connection) - start_ms < duration_ms)
+    {
+    }
+}
+
+static PROV_DEVICE_TRANSPORT_HANDLE stub_transport_create(const char* uri, TRANSPORT_HSM_TYPE type, const char* scope_id, const char* api_version, PROV_TRANSPORT_ERROR_CALLBACK error_cb, void* error_ctx)
+{
+    STUB_TRANSPORT_INFO* result;
+    (void)uri;
+    (void)scope_id;
+    (void)api_version;
+    (void)error_cb;
+    (void)error_ctx;
+
+    if ((result = (STUB_TRANSPORT_INFO*)malloc(sizeof(STUB_TRANSPORT_INFO))) == NULL)
+    {
+        LogError("Failure allocating the stub connection");
+    }
+    else
+    {
+        memset(result, 0, sizeof(STUB_TRANSPORT_INFO));
+        result->hsm_type = type;
+        if ((result->tick_counter = tickcounter_create()) == NULL)
+        {
+            LogError("Failure creating the tick counter");
+            free(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+static void stub_transport_destroy(PROV_DEVICE_TRANSPORT_HANDLE handle)
+{
+    STUB_TRANSPORT_INFO* connection = (STUB_TRANSPORT_INFO*)handle;
+    if (connection != NULL)
+    {
+        if (connection->first_link != NULL)
+        {
+            LogError("The stub connection is destroyed before its links");
+        }
+        tickcounter_destroy(connection->tick_counter);
+        free(connection->registration_id);
+        free(connection);
+    }
+}
+
+static PROV_DEVICE_TRANSPORT_HANDLE stub_transport_create_link(PROV_DEVICE_TRANSPORT_HANDLE connection, PROV_TRANSPORT_ERROR_CALLBACK error_cb, void* error_ctx)
+{
+    STUB_TRANSPORT_INFO* result;
+    STUB_TRANSPORT_INFO* connection_info = (STUB_TRANSPORT_INFO*)connection;
+    (void)error_cb;
+    (void)error_ctx;
+
+    if (connection_info == NULL)
+    {
+        LogError("Invalid parameter connection is NULL");
+        result = NULL;
+    }
+    else if ((result = (STUB_TRANSPORT_INFO*)malloc(sizeof(STUB_TRANSPORT_INFO))) == NULL)
+    {
+        LogError("Failure allocating the stub link");
+    }
+    else
+    {
+        memset(result, 0, sizeof(STUB_TRANSPORT_INFO));
+        result->connection = connection_info;
+        result->next_link = connection_info->first_link;
+        if (connection_info->first_link != NULL)
+        {
+            connection_info->first_link->prev_link = result;
+        }
+        connection_info->first_link = result;
+    }
+    return result;
+}
+
+static void stub_transport_destroy_link(PROV_DEVICE_TRANSPORT_HANDLE link)
+{
+    STUB_TRANSPORT_INFO* link_info = (STUB_TRANSPORT_INFO*)link;
+    if (link_info != NULL)
+    {
+        if (link_info->prev_link != NULL)
+        {
+            link_info->prev_link->next_link = link_info->next_link;
+        }
+        else
+        {
+            link_info->connection->first_link = link_info->next_link;
+        }
+        if (link_info->next_link != NULL)
+        {
+            link_info->next_link->prev_link = link_info->prev_link;
+        }
+        free(link_info->registration_id);
+        free(link_info);
+    }
+}
+
+static int stub_transport_open(PROV_DEVICE_TRANSPORT_HANDLE handle, const char* registration_id, BUFFER_HANDLE ek, BUFFER_HANDLE srk, PROV_DEVICE_TRANSPORT_REGISTER_CALLBACK data_callback, void* user_ctx, PROV_DEVICE_TRANSPORT_STATUS_CALLBACK status_cb, void* status_ctx, PROV_TRANSPORT_CHALLENGE_CALLBACK reg_challenge_cb, void* challenge_ctx)
+{
+    int result;
+    STUB_TRANSPORT_INFO* info = (STUB_TRANSPORT_INFO*)handle;
+    (void)ek;
+    (void)srk;
+
+    if (info == NULL || registration_id == NULL || data_callback == NULL || status_cb == NULL)
+    {
+        LogError("Invalid parameter specified handle: %p, registration_id: %p, data_callback: %p, status_cb: %p", info, registration_id, data_callback, status_cb);
+        result = MU_FAILURE;
+    }
+    else if (info->is_open)
+    {
+        LogError("The registration is already open");
+        result = MU_FAILURE;
+    }
+    else if (mallocAndStrcpy_s(&info->registration_id, registration_id) != 0)
+    {
+        LogError("Failure copying the registration id");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        info->register_data_cb = data_callback;
+        info->user_ctx = user_ctx;
+        info->status_cb = status_cb;
+        info->status_ctx = status_ctx;
+        info->challenge_cb = reg_challenge_cb;
+        info->challenge_ctx = challenge_ctx;
+        info->connected_reported = false;
+        info->request = STUB_REQUEST_NONE;
+        info->is_open = true;
+        result = 0;
+    }
+    return result;
+}
+
+static int stub_transport_close(PROV_DEVICE_TRANSPORT_HANDLE handle)
+{
+    int result;
+    STUB_TRANSPORT_INFO* info = (STUB_TRANSPORT_INFO*)handle;
+    if (info == NULL)
+    {
+        LogError("Invalid parameter handle is NULL");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        free(info->registration_id);
+        info->registration_id = NULL;
+        info->is_open = false;
+        info->request = STUB_REQUEST_NONE;
+        result = 0;
+    }
+    return result;
+}
+
+static int send_request(STUB_TRANSPORT_INFO* info, STUB_REQUEST request)
+{
+    int result;
+    if (!info->is_open || !info->connected_reported || info->request != STUB_REQUEST_NONE)
+    {
+        LogError("The registration cannot send a request now");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        info->request = request;
+        info->reply_at = get_current_ms(info) + g_stub_config.service_latency_ms;
+        result = 0;
+    }
+    return result;
+}
+
+static int stub_transport_register_device(PROV_DEVICE_TRANSPORT_HANDLE handle, PROV_TRANSPORT_JSON_PARSE json_parse_cb, PROV_TRANSPORT_CREATE_JSON_PAYLOAD json_create_cb, void* json_ctx)
+{
+    int result;
+    STUB_TRANSPORT_INFO* info = (STUB_TRANSPORT_INFO*)handle;
+    char* payload;
+
+    if (info == NULL || json_parse_cb == NULL || json_create_cb == NULL)
+    {
+        LogError("Invalid parameter specified handle: %p, json_parse_cb: %p, json_create_cb: %p", info, json_parse_cb, json_create_cb);
+        result = MU_FAILURE;
+    }
+    else if ((payload = json_create_cb(NULL, NULL, json_ctx)) == NULL)
+    {
+        LogError("Failure creating the registration payload");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        // The payload is built like the real transports do, the stub has no use for it
+        free(payload);
+
+        // The real transports sign every registration with its own SAS token
+        if (get_connection(info)->hsm_type == TRANSPORT_HSM_TYPE_SYMM_KEY && info->challenge_cb != NULL)
+        {
+            free(info->challenge_cb(NULL, 0, KEY_NAME_VALUE, info->challenge_ctx));
+        }
+
+        info->json_parse_cb = json_parse_cb;
+        info->json_ctx = json_ctx;
+        result = send_request(info, STUB_REQUEST_REGISTER);
+    }
+    return result;
+}
+
+static int stub_transport_get_operation_status(PROV_DEVICE_TRANSPORT_HANDLE handle)
+{
+    int result;
+    STUB_TRANSPORT_INFO* info = (STUB_TRANSPORT_INFO*)handle;
+    if (info == NULL)
+    {
+        LogError("Invalid parameter handle is NULL");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = send_request(info, STUB_REQUEST_STATUS);
+    }
+    return result;
+}
+
+static void stub_transport_dowork(PROV_DEVICE_TRANSPORT_HANDLE handle)
+{
+    STUB_TRANSPORT_INFO* connection = (STUB_TRANSPORT_INFO*)handle;
+    if (connection != NULL)
+    {
+        tickcounter_ms_t current_ms = get_current_ms(connection);
+
+        if (connection->connected)
+        {
+            STUB_TRANSPORT_INFO* link = connection->first_link;
+
+            process_registration(connection, current_ms);
+            while (link != NULL)
+            {
+                // The callbacks may close the link, never destroy it
+                STUB_TRANSPORT_INFO* next_link = link->next_link;
+                process_registration(link, current_ms);
+                link = next_link;
+            }
+        }
+        else if (connection->handshake_started)
+        {
+            connection->connected = (current_ms >= connection->connected_at);
+        }
+        else if (has_open_registration(connection))
+        {
+            connection->handshake_started = true;
+            g_handshake_count++;
+            burn_cpu(connection, g_stub_config.handshake_cpu_ms);
+            connection->connected_at = get_current_ms(connection) + g_stub_config.handshake_latency_ms;
+        }
+    }
+}
+
+static int stub_transport_set_trace(PROV_DEVICE_TRANSPORT_HANDLE handle, bool trace_on)
+{
+    (void)handle;
+    (void)trace_on;
+    return 0;
+}
+
+static int stub_transport_x509_cert(PROV_DEVICE_TRANSPORT_HANDLE handle, const char* certificate, const char* private_key)
+{
+    (void)handle;
+    (void)certificate;
+    (void)private_key;
+    return 0;
+}
+
+static int stub_transport_trusted_cert(PROV_DEVICE_TRANSPORT_HANDLE handle, const char* certificate)
+{
+    (void)handle;
+    (void)certificate;
+    return 0;
+}
+
+static int stub_transport_set_proxy(PROV_DEVICE_TRANSPORT_HANDLE handle, const HTTP_PROXY_OPTIONS* proxy_options)
+{
+    (void)handle;
+    (void)proxy_options;
+    return 0;
+}
+
+static int stub_transport_set_option(PROV_DEVICE_TRANSPORT_HANDLE handle, const char* option, const void* value)
+{
+    (void)handle;
+    (void)option;
+    (void)value;
+    return 0;
+}
+
+static PROV_DEVICE_TRANSPORT_PROVIDER stub_func =
+{
+    stub_transport_create,
+    stub_transport_destroy,
+    stub_transport_open,
+    stub_transport_close,
+    stub_transport_register_device,
+    stub_transport_get_operation_status,
+    stub_transport_dowork,
+    stub_transport_set_trace,
+    stub_transport_x509_cert,
+    stub_transport_trusted_cert,
+    stub_transport_set_proxy,
+    stub_transport_set_option,
+    stub_transport_create_link,
+    stub_transport_destroy_link
+};
+
+static PROV_DEVICE_TRANSPORT_PROVIDER stub_unshared_func =
+{
+    stub_transport_create,
+    stub_transport_destroy,
+    stub_transport_open,
+    stub_transport_close,
+    stub_transport_register_device,
+    stub_transport_get_operation_status,
+    stub_transport_dowork,
+    stub_transport_set_trace,
+    stub_transport_x509_cert,
+    stub_transport_trusted_cert,
+    stub_transport_set_proxy,
+    stub_transport_set_option,
+    NULL,
+    NULL
+};
+
+const PROV_DEVICE_TRANSPORT_PROVIDER* Prov_Device_Stub_Protocol(void)
+{
+    return &stub_func;
+}
+
+const PROV_DEVICE_TRANSPORT_PROVIDER* Prov_Device_Stub_Unshared_Protocol(void)
+{
+    return &stub_unshared_func;
+}
@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// In-process stand-in for the Device Provisioning Service, used to measure the client without the network.
+// Every connection pays a simulated TLS handshake, and every request is answered after a fixed service
+// latency: the registration with "assigning" and the following status poll with "assigned".
+
+#ifndef PROV_TRANSPORT_STUB_H
+#define PROV_TRANSPORT_STUB_H
+
+#include "azure_prov_client/prov_transport.h"
+
+#ifdef __cplusplus
+extern "C" {
+#include <cstddef>
+#include <cstdint>
+#else
+#include <stddef.h>
+#include <stdint.h>
+#endif /* __cplusplus */
+
+typedef struct PROV_TRANSPORT_STUB_CONFIG_TAG
+{
+    // CPU spent by the caller's thread on the handshake of every new connection
+    uint32_t handshake_cpu_ms;
+    // Round trips before a new connection can carry requests
+    uint32_t handshake_latency_ms;
+    // Delay between a request and its reply
+    uint32_t service_latency_ms;
+} PROV_TRANSPORT_STUB_CONFIG;
+
+extern void prov_transport_stub_configure(const PROV_TRANSPORT_STUB_CONFIG* config);
+extern size_t prov_transport_stub_get_handshake_count(void);
+
+// Carries any number of registrations over one connection
+extern const PROV_DEVICE_TRANSPORT_PROVIDER* Prov_Device_Stub_Protocol(void);
+// Same service, one connection per registration like the MQTT, AMQP and HTTP transports
+extern const PROV_DEVICE_TRANSPORT_PROVIDER* Prov_Device_Stub_Unshared_Protocol(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif // PROV_TRANSPORT_STUB_H
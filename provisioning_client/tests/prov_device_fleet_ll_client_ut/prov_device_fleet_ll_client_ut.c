@@ -0,0 +1,1376 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#else
+#include <stdlib.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umocktypes_bool.h"
+#include "umock_c/umocktypes_stdint.h"
+#include "umock_c/umock_c_negative_tests.h"
+#include "azure_macro_utils/macro_utils.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/tickcounter.h"
+
+#include "azure_prov_client/internal/prov_auth_client.h"
+#include "azure_prov_client/internal/prov_transport_private.h"
+#include "azure_prov_client/prov_device_ll_client.h"
+#include "azure_prov_client/internal/prov_device_ll_client_private.h"
+#include "azure_prov_client/prov_security_factory.h"
+#undef ENABLE_MOCKS
+
+#include "azure_prov_client/prov_device_fleet_ll_client.h"
+
+#define ENABLE_MOCKS
+#include "umock_c/umock_c_prod.h"
+MOCKABLE_FUNCTION(, void, on_fleet_register_device_callback, PROV_DEVICE_RESULT, register_result, const char*, iothub_uri, const char*, device_id, void*, user_context);
+MOCKABLE_FUNCTION(, void, on_fleet_register_status_callback, PROV_DEVICE_REG_STATUS, reg_status, void*, user_context);
+
+MOCKABLE_FUNCTION(, PROV_DEVICE_TRANSPORT_HANDLE, prov_transport_create, const char*, uri, TRANSPORT_HSM_TYPE, type, const char*, scope_id, const char*, prov_api_version, PROV_TRANSPORT_ERROR_CALLBACK, error_cb, void*, error_ctx);
+MOCKABLE_FUNCTION(, void, prov_transport_destroy, PROV_DEVICE_TRANSPORT_HANDLE, handle);
+MOCKABLE_FUNCTION(, int, prov_transport_open, PROV_DEVICE_TRANSPORT_HANDLE, handle, const char*, registration_id, BUFFER_HANDLE, ek, BUFFER_HANDLE, srk, PROV_DEVICE_TRANSPORT_REGISTER_CALLBACK, data_callback, void*, user_ctx, PROV_DEVICE_TRANSPORT_STATUS_CALLBACK, status_cb, void*, status_ctx, PROV_TRANSPORT_CHALLENGE_CALLBACK, reg_challenge_cb, void*, challenge_ctx);
+MOCKABLE_FUNCTION(, int, prov_transport_close, PROV_DEVICE_TRANSPORT_HANDLE, handle);
+MOCKABLE_FUNCTION(, int, prov_transport_register_device, PROV_DEVICE_TRANSPORT_HANDLE, handle, PROV_TRANSPORT_JSON_PARSE, json_parse_cb, PROV_TRANSPORT_CREATE_JSON_PAYLOAD, json_create_cb, void*, json_ctx);
+MOCKABLE_FUNCTION(, int, prov_transport_get_operation_status, PROV_DEVICE_TRANSPORT_HANDLE, handle);
+MOCKABLE_FUNCTION(, void, prov_transport_dowork, PROV_DEVICE_TRANSPORT_HANDLE, handle);
+MOCKABLE_FUNCTION(, int, prov_transport_set_trace, PROV_DEVICE_TRANSPORT_HANDLE, handle, bool, trace_on);
+MOCKABLE_FUNCTION(, int, prov_transport_x509_cert, PROV_DEVICE_TRANSPORT_HANDLE, handle, const char*, certificate, const char*, private_key);
+MOCKABLE_FUNCTION(, int, prov_transport_set_trusted_cert, PROV_DEVICE_TRANSPORT_HANDLE, handle, const char*, certificate);
+MOCKABLE_FUNCTION(, int, prov_transport_set_proxy, PROV_DEVICE_TRANSPORT_HANDLE, handle, const HTTP_PROXY_OPTIONS*, proxy_option);
+MOCKABLE_FUNCTION(, int, prov_transport_set_option, PROV_DEVICE_TRANSPORT_HANDLE, handle, const char*, option_name, const void*, value);
+MOCKABLE_FUNCTION(, PROV_DEVICE_TRANSPORT_HANDLE, prov_transport_create_link, PROV_DEVICE_TRANSPORT_HANDLE, connection, PROV_TRANSPORT_ERROR_CALLBACK, error_cb, void*, error_ctx);
+MOCKABLE_FUNCTION(, void, prov_transport_destroy_link, PROV_DEVICE_TRANSPORT_HANDLE, link);
+#undef ENABLE_MOCKS
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK g_register_callback;
+static void* g_register_ctx;
+static tickcounter_ms_t g_current_ms;
+
+static PROV_DEVICE_TRANSPORT_PROVIDER g_prov_transport_link_func =
+{
+    prov_transport_create,
+    prov_transport_destroy,
+    prov_transport_open,
+    prov_transport_close,
+    prov_transport_register_device,
+    prov_transport_get_operation_status,
+    prov_transport_dowork,
+    prov_transport_set_trace,
+    prov_transport_x509_cert,
+    prov_transport_set_trusted_cert,
+    prov_transport_set_proxy,
+    prov_transport_set_option,
+    prov_transport_create_link,
+    prov_transport_destroy_link
+};
+
+static PROV_DEVICE_TRANSPORT_PROVIDER g_prov_transport_func =
+{
+    prov_transport_create,
+    prov_transport_destroy,
+    prov_transport_open,
+    prov_transport_close,
+    prov_transport_register_device,
+    prov_transport_get_operation_status,
+    prov_transport_dowork,
+    prov_transport_set_trace,
+    prov_transport_x509_cert,
+    prov_transport_set_trusted_cert,
+    prov_transport_set_proxy,
+    prov_transport_set_option,
+    NULL,
+    NULL
+};
+
+static const PROV_DEVICE_TRANSPORT_PROVIDER* link_provider(void)
+{
+    return &g_prov_transport_link_func;
+}
+
+static const PROV_DEVICE_TRANSPORT_PROVIDER* trans_provider(void)
+{
+    return &g_prov_transport_func;
+}
+
+static const char* TEST_PROV_URI = "www.prov_uri.com";
+static const char* TEST_SCOPE_ID = "scope_id";
+static const char* TEST_REGISTRATION_ID = "A87FA22F-828B-46CA-BA37-D574C32E423E";
+static const char* TEST_REGISTRATION_ID_2 = "0A5A7A2C-1F1E-4D4B-8E41-6D7A7A0E0C11";
+static const char* TEST_IOTHUB = "iothub.value.test";
+static const char* TEST_DEVICE_ID = "device_id";
+static const char* TEST_TRUSTED_CERT = "trusted_cert";
+static const char* TEST_CUSTOM_OPTION = "custom_option";
+static const char* TEST_SYMMETRIC_KEY = "symmetric_key";
+static const char* TEST_X509_CERT = "x509_cert";
+static const char* TEST_X509_PRIVATE_KEY = "x509_private_key";
+static void* TEST_USER_CONTEXT = (void*)0x1598;
+#define TEST_POLL_DELAY_MS  2000
+
+TEST_DEFINE_ENUM_TYPE(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_VALUE);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_VALUE);
+
+TEST_DEFINE_ENUM_TYPE(PROV_DEVICE_REG_STATUS, PROV_DEVICE_REG_STATUS_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(PROV_DEVICE_REG_STATUS, PROV_DEVICE_REG_STATUS_VALUES);
+
+TEST_DEFINE_ENUM_TYPE(SECURE_DEVICE_TYPE, SECURE_DEVICE_TYPE_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(SECURE_DEVICE_TYPE, SECURE_DEVICE_TYPE_VALUES);
+
+TEST_DEFINE_ENUM_TYPE(TRANSPORT_HSM_TYPE, TRANSPORT_HSM_TYPE_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(TRANSPORT_HSM_TYPE, TRANSPORT_HSM_TYPE_VALUES);
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    ASSERT_FAIL("umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+}
+
+static int my_mallocAndStrcpy_s(char** destination, const char* source)
+{
+    size_t src_len = strlen(source);
+    *destination = (char*)my_gballoc_malloc(src_len + 1);
+    strcpy(*destination, source);
+    return 0;
+}
+
+static TICK_COUNTER_HANDLE my_tickcounter_create(void)
+{
+    return (TICK_COUNTER_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_tickcounter_destroy(TICK_COUNTER_HANDLE tick_counter)
+{
+    my_gballoc_free(tick_counter);
+}
+
+static int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t* current_ms)
+{
+    (void)tick_counter;
+    *current_ms = g_current_ms;
+    return 0;
+}
+
+static PROV_DEVICE_TRANSPORT_HANDLE my_prov_transport_create(const char* uri, TRANSPORT_HSM_TYPE type, const char* scope_id, const char* prov_api_version, PROV_TRANSPORT_ERROR_CALLBACK error_cb, void* error_ctx)
+{
+    (void)uri;
+    (void)type;
+    (void)scope_id;
+    (void)prov_api_version;
+    (void)error_cb;
+    (void)error_ctx;
+    return (PROV_DEVICE_TRANSPORT_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_prov_transport_destroy(PROV_DEVICE_TRANSPORT_HANDLE handle)
+{
+    my_gballoc_free(handle);
+}
+
+static PROV_DEVICE_LL_HANDLE my_Prov_Device_LL_Create(const char* uri, const char* scope_id, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol)
+{
+    (void)uri;
+    (void)scope_id;
+    (void)protocol;
+    return (PROV_DEVICE_LL_HANDLE)my_gballoc_malloc(1);
+}
+
+static PROV_DEVICE_LL_HANDLE my_prov_device_ll_create_on_connection(const char* id_scope, PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol, PROV_DEVICE_TRANSPORT_HANDLE connection)
+{
+    (void)id_scope;
+    (void)protocol;
+    (void)connection;
+    return (PROV_DEVICE_LL_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_Prov_Device_LL_Destroy(PROV_DEVICE_LL_HANDLE handle)
+{
+    my_gballoc_free(handle);
+}
+
+static PROV_DEVICE_RESULT my_Prov_Device_LL_Register_Device(PROV_DEVICE_LL_HANDLE handle, PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK register_callback, void* user_context, PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK reg_status_cb, void* status_user_ctext)
+{
+    (void)handle;
+    (void)reg_status_cb;
+    (void)status_user_ctext;
+    g_register_callback = register_callback;
+    g_register_ctx = user_context;
+    return PROV_DEVICE_RESULT_OK;
+}
+
+BEGIN_TEST_SUITE(prov_device_fleet_ll_client_ut)
+
+    TEST_SUITE_INITIALIZE(suite_init)
+    {
+        int result;
+
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+
+        (void)umock_c_init(on_umock_c_error);
+        (void)umocktypes_bool_register_types();
+
+        result = umocktypes_charptr_register_types();
+        ASSERT_ARE_EQUAL(int, 0, result);
+        result = umocktypes_stdint_register_types();
+        ASSERT_ARE_EQUAL(int, 0, result);
+
+        REGISTER_TYPE(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT);
+        REGISTER_TYPE(PROV_DEVICE_REG_STATUS, PROV_DEVICE_REG_STATUS);
+        REGISTER_TYPE(SECURE_DEVICE_TYPE, SECURE_DEVICE_TYPE);
+        REGISTER_TYPE(TRANSPORT_HSM_TYPE, TRANSPORT_HSM_TYPE);
+
+        REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_DEVICE_LL_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_DEVICE_TRANSPORT_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_DEVICE_CLIENT_REGISTER_DEVICE_CALLBACK, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_DEVICE_CLIENT_REGISTER_STATUS_CALLBACK, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_DEVICE_TRANSPORT_REGISTER_CALLBACK, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_DEVICE_TRANSPORT_STATUS_CALLBACK, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_TRANSPORT_CHALLENGE_CALLBACK, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_TRANSPORT_JSON_PARSE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_TRANSPORT_CREATE_JSON_PAYLOAD, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(PROV_TRANSPORT_ERROR_CALLBACK, void*);
+
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+        REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __LINE__);
+
+        REGISTER_GLOBAL_MOCK_HOOK(tickcounter_create, my_tickcounter_create);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(tickcounter_create, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(tickcounter_destroy, my_tickcounter_destroy);
+        REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, my_tickcounter_get_current_ms);
+
+        REGISTER_GLOBAL_MOCK_RETURN(prov_dev_security_get_type, SECURE_DEVICE_TYPE_X509);
+
+        REGISTER_GLOBAL_MOCK_HOOK(prov_transport_create, my_prov_transport_create);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_transport_create, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(prov_transport_destroy, my_prov_transport_destroy);
+        REGISTER_GLOBAL_MOCK_RETURN(prov_transport_set_trusted_cert, 0);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_transport_set_trusted_cert, __LINE__);
+        REGISTER_GLOBAL_MOCK_RETURN(prov_transport_set_option, 0);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_transport_set_option, __LINE__);
+
+        REGISTER_GLOBAL_MOCK_HOOK(Prov_Device_LL_Create, my_Prov_Device_LL_Create);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(Prov_Device_LL_Create, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(prov_device_ll_create_on_connection, my_prov_device_ll_create_on_connection);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_device_ll_create_on_connection, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(Prov_Device_LL_Destroy, my_Prov_Device_LL_Destroy);
+        REGISTER_GLOBAL_MOCK_HOOK(Prov_Device_LL_Register_Device, my_Prov_Device_LL_Register_Device);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(Prov_Device_LL_Register_Device, PROV_DEVICE_RESULT_ERROR);
+        REGISTER_GLOBAL_MOCK_RETURN(Prov_Device_LL_SetOption, PROV_DEVICE_RESULT_OK);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(Prov_Device_LL_SetOption, PROV_DEVICE_RESULT_ERROR);
+        REGISTER_GLOBAL_MOCK_RETURN(prov_device_ll_set_symmetric_key, PROV_DEVICE_RESULT_OK);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_device_ll_set_symmetric_key, PROV_DEVICE_RESULT_ERROR);
+        REGISTER_GLOBAL_MOCK_RETURN(prov_device_ll_set_x509_identity, PROV_DEVICE_RESULT_OK);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_device_ll_set_x509_identity, PROV_DEVICE_RESULT_ERROR);
+    }
+
+    TEST_SUITE_CLEANUP(suite_cleanup)
+    {
+        umock_c_deinit();
+
+        TEST_MUTEX_DESTROY(g_testByTest);
+    }
+
+    TEST_FUNCTION_INITIALIZE(method_init)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("Could not acquire test serialization mutex.");
+        }
+        umock_c_reset_all_calls();
+        g_register_callback = NULL;
+        g_register_ctx = NULL;
+        g_current_ms = 0;
+    }
+
+    TEST_FUNCTION_CLEANUP(method_cleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    static void setup_Prov_Device_Fleet_LL_Create_mocks(bool shared)
+    {
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_PROV_URI));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_SCOPE_ID));
+        if (shared)
+        {
+            STRICT_EXPECTED_CALL(prov_dev_security_get_type()).CallCannotFail();
+            STRICT_EXPECTED_CALL(prov_transport_create(TEST_PROV_URI, TRANSPORT_HSM_TYPE_X509, TEST_SCOPE_ID, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(tickcounter_create());
+        }
+    }
+
+    static void setup_destroy_device_mocks(void)
+    {
+        STRICT_EXPECTED_CALL(Prov_Device_LL_Destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    }
+
+    static void setup_Prov_Device_Fleet_LL_Register_Device_mocks(bool grow)
+    {
+        if (grow)
+        {
+            STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        }
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    }
+
+    static void setup_start_registration_mocks(bool shared, const char* registration_id)
+    {
+        if (shared)
+        {
+            STRICT_EXPECTED_CALL(prov_device_ll_create_on_connection(TEST_SCOPE_ID, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        }
+        else
+        {
+            STRICT_EXPECTED_CALL(Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, IGNORED_PTR_ARG));
+        }
+        STRICT_EXPECTED_CALL(Prov_Device_LL_SetOption(IGNORED_PTR_ARG, PROV_REGISTRATION_ID, IGNORED_PTR_ARG))
+            .ValidateArgumentBuffer(3, registration_id, strlen(registration_id) + 1);
+        STRICT_EXPECTED_CALL(Prov_Device_LL_Register_Device(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    }
+
+    static PROV_DEVICE_FLEET_LL_HANDLE create_fleet_with_attested_device(PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol, const PROV_DEVICE_FLEET_ATTESTATION* attestation)
+    {
+        PROV_DEVICE_FLEET_LL_HANDLE result = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, protocol);
+        (void)Prov_Device_Fleet_LL_Register_Device(result, TEST_REGISTRATION_ID, attestation, on_fleet_register_device_callback, TEST_USER_CONTEXT, on_fleet_register_status_callback, NULL);
+        return result;
+    }
+
+    static PROV_DEVICE_FLEET_LL_HANDLE create_fleet_with_device(PROV_DEVICE_TRANSPORT_PROVIDER_FUNCTION protocol)
+    {
+        return create_fleet_with_attested_device(protocol, NULL);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_001: [ If uri, scope_id or protocol is NULL, Prov_Device_Fleet_LL_Create shall fail and return NULL. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Create_uri_NULL_fail)
+    {
+        //arrange
+
+        //act
+        PROV_DEVICE_FLEET_LL_HANDLE result = Prov_Device_Fleet_LL_Create(NULL, TEST_SCOPE_ID, link_provider);
+
+        //assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_001: [ If uri, scope_id or protocol is NULL, Prov_Device_Fleet_LL_Create shall fail and return NULL. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Create_scope_id_NULL_fail)
+    {
+        //arrange
+
+        //act
+        PROV_DEVICE_FLEET_LL_HANDLE result = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, NULL, link_provider);
+
+        //assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_001: [ If uri, scope_id or protocol is NULL, Prov_Device_Fleet_LL_Create shall fail and return NULL. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Create_protocol_NULL_fail)
+    {
+        //arrange
+
+        //act
+        PROV_DEVICE_FLEET_LL_HANDLE result = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, NULL);
+
+        //assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_002: [ If the transport implements prov_transport_create_link, Prov_Device_Fleet_LL_Create shall create the one connection all the registrations are linked to. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Create_shared_connection_succeed)
+    {
+        //arrange
+        setup_Prov_Device_Fleet_LL_Create_mocks(true);
+
+        //act
+        PROV_DEVICE_FLEET_LL_HANDLE result = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+
+        //assert
+        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(result);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_003: [ Otherwise each registration shall use a connection of its own. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Create_no_link_succeed)
+    {
+        //arrange
+        setup_Prov_Device_Fleet_LL_Create_mocks(false);
+
+        //act
+        PROV_DEVICE_FLEET_LL_HANDLE result = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+
+        //assert
+        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(result);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_004: [ If any error is encountered, Prov_Device_Fleet_LL_Create shall return NULL. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Create_fail)
+    {
+        //arrange
+        int negativeTestsInitResult = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+        setup_Prov_Device_Fleet_LL_Create_mocks(true);
+
+        umock_c_negative_tests_snapshot();
+
+        //act
+        size_t count = umock_c_negative_tests_call_count();
+        for (size_t index = 0; index < count; index++)
+        {
+            if (umock_c_negative_tests_can_call_fail(index))
+            {
+                umock_c_negative_tests_reset();
+                umock_c_negative_tests_fail_call(index);
+
+                PROV_DEVICE_FLEET_LL_HANDLE result = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+
+                // assert
+                ASSERT_IS_NULL(result, "Prov_Device_Fleet_LL_Create failure in test %zu/%zu", index, count);
+            }
+        }
+
+        //cleanup
+        umock_c_negative_tests_deinit();
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_005: [ If handle is NULL, Prov_Device_Fleet_LL_Destroy shall do nothing. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Destroy_handle_NULL)
+    {
+        //arrange
+
+        //act
+        Prov_Device_Fleet_LL_Destroy(NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_006: [ Prov_Device_Fleet_LL_Destroy shall destroy the provisioning client of every registration, then the shared connection, without calling any callback. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Destroy_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        setup_destroy_device_mocks();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_transport_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_Fleet_LL_Destroy(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_007: [ If handle, registration_id or register_callback is NULL, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Register_Device_handle_NULL_fail)
+    {
+        //arrange
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_Register_Device(NULL, TEST_REGISTRATION_ID, NULL, on_fleet_register_device_callback, NULL, NULL, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_007: [ If handle, registration_id or register_callback is NULL, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Register_Device_registration_id_NULL_fail)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_Register_Device(handle, NULL, NULL, on_fleet_register_device_callback, NULL, NULL, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_007: [ If handle, registration_id or register_callback is NULL, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Register_Device_register_callback_NULL_fail)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_Register_Device(handle, TEST_REGISTRATION_ID, NULL, NULL, NULL, NULL, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_008: [ Prov_Device_Fleet_LL_Register_Device shall queue the registration, to be started by Prov_Device_Fleet_LL_DoWork in the order the registrations were requested, and return PROV_DEVICE_RESULT_OK. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Register_Device_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        setup_Prov_Device_Fleet_LL_Register_Device_mocks(true);
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_Register_Device(handle, TEST_REGISTRATION_ID, NULL, on_fleet_register_device_callback, NULL, NULL, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(size_t, 1, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_009: [ If any error is encountered, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_MEMORY. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Register_Device_fail)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        int negativeTestsInitResult = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+        setup_Prov_Device_Fleet_LL_Register_Device_mocks(true);
+
+        umock_c_negative_tests_snapshot();
+
+        //act
+        size_t count = umock_c_negative_tests_call_count();
+        for (size_t index = 0; index < count; index++)
+        {
+            if (umock_c_negative_tests_can_call_fail(index))
+            {
+                umock_c_negative_tests_reset();
+                umock_c_negative_tests_fail_call(index);
+
+                PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_Register_Device(handle, TEST_REGISTRATION_ID, NULL, on_fleet_register_device_callback, NULL, NULL, NULL);
+
+                // assert
+                ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_MEMORY, prov_result, "Prov_Device_Fleet_LL_Register_Device failure in test %zu/%zu", index, count);
+            }
+        }
+
+        //cleanup
+        umock_c_negative_tests_deinit();
+        ASSERT_ARE_EQUAL(size_t, 0, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_029: [ If attestation gives only one of x509_certificate and x509_private_key, or both a symmetric key and a certificate, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Register_Device_certificate_without_key_fail)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_ATTESTATION attestation = { NULL, TEST_X509_CERT, NULL };
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_Register_Device(handle, TEST_REGISTRATION_ID, &attestation, on_fleet_register_device_callback, NULL, NULL, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(size_t, 0, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_029: [ If attestation gives only one of x509_certificate and x509_private_key, or both a symmetric key and a certificate, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Register_Device_symmetric_key_and_certificate_fail)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_ATTESTATION attestation = { TEST_SYMMETRIC_KEY, TEST_X509_CERT, TEST_X509_PRIVATE_KEY };
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_Register_Device(handle, TEST_REGISTRATION_ID, &attestation, on_fleet_register_device_callback, NULL, NULL, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(size_t, 0, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_030: [ Prov_Device_Fleet_LL_Register_Device shall copy the credentials of attestation; a NULL attestation uses the credentials held for the process. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Register_Device_x509_attestation_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_ATTESTATION attestation = { NULL, TEST_X509_CERT, TEST_X509_PRIVATE_KEY };
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        setup_Prov_Device_Fleet_LL_Register_Device_mocks(true);
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_X509_CERT));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_X509_PRIVATE_KEY));
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_Register_Device(handle, TEST_REGISTRATION_ID, &attestation, on_fleet_register_device_callback, NULL, NULL, NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(size_t, 1, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_009: [ If any error is encountered, Prov_Device_Fleet_LL_Register_Device shall return PROV_DEVICE_RESULT_MEMORY. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Register_Device_x509_attestation_fail)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_ATTESTATION attestation = { NULL, TEST_X509_CERT, TEST_X509_PRIVATE_KEY };
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        int negativeTestsInitResult = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+        setup_Prov_Device_Fleet_LL_Register_Device_mocks(true);
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_X509_CERT));
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_X509_PRIVATE_KEY));
+
+        umock_c_negative_tests_snapshot();
+
+        //act
+        size_t count = umock_c_negative_tests_call_count();
+        for (size_t index = 0; index < count; index++)
+        {
+            if (umock_c_negative_tests_can_call_fail(index))
+            {
+                umock_c_negative_tests_reset();
+                umock_c_negative_tests_fail_call(index);
+
+                PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_Register_Device(handle, TEST_REGISTRATION_ID, &attestation, on_fleet_register_device_callback, NULL, NULL, NULL);
+
+                // assert
+                ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_MEMORY, prov_result, "Prov_Device_Fleet_LL_Register_Device failure in test %zu/%zu", index, count);
+            }
+        }
+
+        //cleanup
+        umock_c_negative_tests_deinit();
+        ASSERT_ARE_EQUAL(size_t, 0, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_010: [ If handle is NULL, Prov_Device_Fleet_LL_DoWork shall do nothing. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_handle_NULL)
+    {
+        //arrange
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_011: [ Prov_Device_Fleet_LL_DoWork shall call prov_transport_dowork once on the shared connection, then Prov_Device_LL_DoWork on every registration in progress. ] */
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_013: [ To start a registration Prov_Device_Fleet_LL_DoWork shall create a provisioning client with prov_device_ll_create_on_connection when the fleet has a shared connection, with Prov_Device_LL_Create otherwise. ] */
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_014: [ Prov_Device_Fleet_LL_DoWork shall apply the stored options and the registration id to the client, then call Prov_Device_LL_Register_Device. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_shared_start_registration_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        setup_start_registration_mocks(true, TEST_REGISTRATION_ID);
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_013: [ To start a registration Prov_Device_Fleet_LL_DoWork shall create a provisioning client with prov_device_ll_create_on_connection when the fleet has a shared connection, with Prov_Device_LL_Create otherwise. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_no_link_start_registration_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(trans_provider);
+        umock_c_reset_all_calls();
+
+        setup_start_registration_mocks(false, TEST_REGISTRATION_ID);
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_011: [ Prov_Device_Fleet_LL_DoWork shall call prov_transport_dowork once on the shared connection, then Prov_Device_LL_DoWork on every registration in progress. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_registering_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_DoWork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_device_ll_get_poll_delay(IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_025: [ When the registrations share a connection, Prov_Device_Fleet_LL_DoWork shall stop calling Prov_Device_LL_DoWork on a registration until the delay returned by prov_device_ll_get_poll_delay has elapsed. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_waiting_for_poll_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_DoWork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_device_ll_get_poll_delay(IGNORED_PTR_ARG)).SetReturn(TEST_POLL_DELAY_MS);
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+        g_current_ms += TEST_POLL_DELAY_MS - 1;
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_026: [ Prov_Device_Fleet_LL_DoWork shall drive again the registrations whose operation status request is due. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_poll_due_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        STRICT_EXPECTED_CALL(prov_device_ll_get_poll_delay(IGNORED_PTR_ARG)).SetReturn(TEST_POLL_DELAY_MS);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        g_current_ms += TEST_POLL_DELAY_MS;
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_DoWork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_device_ll_get_poll_delay(IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_026: [ Prov_Device_Fleet_LL_DoWork shall drive again the registrations whose operation status request is due. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_poll_due_in_deadline_order_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        (void)Prov_Device_Fleet_LL_Register_Device(handle, TEST_REGISTRATION_ID_2, NULL, on_fleet_register_device_callback, NULL, NULL, NULL);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        STRICT_EXPECTED_CALL(prov_device_ll_get_poll_delay(IGNORED_PTR_ARG)).SetReturn(2 * TEST_POLL_DELAY_MS);
+        STRICT_EXPECTED_CALL(prov_device_ll_get_poll_delay(IGNORED_PTR_ARG)).SetReturn(TEST_POLL_DELAY_MS);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        g_current_ms += TEST_POLL_DELAY_MS;
+        umock_c_reset_all_calls();
+
+        // Only the second registration is due
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_DoWork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_device_ll_get_poll_delay(IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_012: [ Prov_Device_Fleet_LL_DoWork shall start the queued registrations while fewer than PROV_FLEET_OPTION_MAX_IN_FLIGHT registrations are in progress. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_max_in_flight_succeed)
+    {
+        //arrange
+        size_t max_in_flight = 1;
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        (void)Prov_Device_Fleet_LL_Register_Device(handle, TEST_REGISTRATION_ID_2, NULL, on_fleet_register_device_callback, NULL, NULL, NULL);
+        (void)Prov_Device_Fleet_LL_SetOption(handle, PROV_FLEET_OPTION_MAX_IN_FLIGHT, &max_in_flight);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        setup_start_registration_mocks(true, TEST_REGISTRATION_ID);
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 2, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_012: [ Prov_Device_Fleet_LL_DoWork shall start the queued registrations while fewer than PROV_FLEET_OPTION_MAX_IN_FLIGHT registrations are in progress. ] */
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_017: [ Prov_Device_Fleet_LL_DoWork shall destroy the provisioning clients of the registrations that completed. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_max_in_flight_starts_next_on_completion_succeed)
+    {
+        //arrange
+        size_t max_in_flight = 1;
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        (void)Prov_Device_Fleet_LL_Register_Device(handle, TEST_REGISTRATION_ID_2, NULL, on_fleet_register_device_callback, NULL, NULL, NULL);
+        (void)Prov_Device_Fleet_LL_SetOption(handle, PROV_FLEET_OPTION_MAX_IN_FLIGHT, &max_in_flight);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        g_register_callback(PROV_DEVICE_RESULT_OK, TEST_IOTHUB, TEST_DEVICE_ID, g_register_ctx);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        setup_start_registration_mocks(true, TEST_REGISTRATION_ID_2);
+        setup_destroy_device_mocks();
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_014: [ Prov_Device_Fleet_LL_DoWork shall apply the stored options and the registration id to the client, then call Prov_Device_LL_Register_Device. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_no_link_applies_options_succeed)
+    {
+        //arrange
+        uint8_t timeout = 30;
+        bool log_trace = true;
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(trans_provider);
+        (void)Prov_Device_Fleet_LL_SetOption(handle, PROV_OPTION_TIMEOUT, &timeout);
+        (void)Prov_Device_Fleet_LL_SetOption(handle, OPTION_TRUSTED_CERT, TEST_TRUSTED_CERT);
+        (void)Prov_Device_Fleet_LL_SetOption(handle, PROV_OPTION_LOG_TRACE, &log_trace);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_SetOption(IGNORED_PTR_ARG, PROV_OPTION_TIMEOUT, IGNORED_PTR_ARG))
+            .ValidateArgumentBuffer(3, &timeout, sizeof(timeout));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_SetOption(IGNORED_PTR_ARG, OPTION_TRUSTED_CERT, IGNORED_PTR_ARG))
+            .ValidateArgumentBuffer(3, TEST_TRUSTED_CERT, strlen(TEST_TRUSTED_CERT) + 1);
+        STRICT_EXPECTED_CALL(Prov_Device_LL_SetOption(IGNORED_PTR_ARG, PROV_OPTION_LOG_TRACE, IGNORED_PTR_ARG))
+            .ValidateArgumentBuffer(3, &log_trace, sizeof(log_trace));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_SetOption(IGNORED_PTR_ARG, PROV_REGISTRATION_ID, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_Register_Device(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_015: [ If a registration cannot be started, its register_callback shall be called with PROV_DEVICE_RESULT_ERROR. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_start_registration_fail)
+    {
+        //arrange
+        int negativeTestsInitResult = umock_c_negative_tests_init();
+        ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).CallCannotFail();
+        setup_start_registration_mocks(true, TEST_REGISTRATION_ID);
+
+        umock_c_negative_tests_snapshot();
+
+        //act
+        size_t count = umock_c_negative_tests_call_count();
+        for (size_t index = 0; index < count; index++)
+        {
+            if (umock_c_negative_tests_can_call_fail(index))
+            {
+                PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+
+                umock_c_negative_tests_reset();
+                umock_c_negative_tests_fail_call(index);
+
+                Prov_Device_Fleet_LL_DoWork(handle);
+
+                // assert
+                ASSERT_ARE_EQUAL(size_t, 0, Prov_Device_Fleet_LL_Get_Pending_Count(handle), "Prov_Device_Fleet_LL_DoWork failure in test %zu/%zu", index, count);
+
+                Prov_Device_Fleet_LL_Destroy(handle);
+            }
+        }
+
+        //cleanup
+        umock_c_negative_tests_deinit();
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_015: [ If a registration cannot be started, its register_callback shall be called with PROV_DEVICE_RESULT_ERROR. ] */
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_017: [ Prov_Device_Fleet_LL_DoWork shall destroy the provisioning clients of the registrations that completed. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_register_device_fail)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_device_ll_create_on_connection(TEST_SCOPE_ID, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_SetOption(IGNORED_PTR_ARG, PROV_REGISTRATION_ID, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_Register_Device(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .SetReturn(PROV_DEVICE_RESULT_ERROR);
+        STRICT_EXPECTED_CALL(on_fleet_register_device_callback(PROV_DEVICE_RESULT_ERROR, NULL, NULL, TEST_USER_CONTEXT));
+        setup_destroy_device_mocks();
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 0, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_028: [ Before registering, Prov_Device_Fleet_LL_DoWork shall give the client the credentials of the device with prov_device_ll_set_symmetric_key or prov_device_ll_set_x509_identity. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_applies_symmetric_key_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_ATTESTATION attestation = { TEST_SYMMETRIC_KEY, NULL, NULL };
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_attested_device(link_provider, &attestation);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_device_ll_create_on_connection(TEST_SCOPE_ID, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_SetOption(IGNORED_PTR_ARG, PROV_REGISTRATION_ID, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_device_ll_set_symmetric_key(IGNORED_PTR_ARG, TEST_REGISTRATION_ID, TEST_SYMMETRIC_KEY));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_Register_Device(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_028: [ Before registering, Prov_Device_Fleet_LL_DoWork shall give the client the credentials of the device with prov_device_ll_set_symmetric_key or prov_device_ll_set_x509_identity. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_applies_x509_identity_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_ATTESTATION attestation = { NULL, TEST_X509_CERT, TEST_X509_PRIVATE_KEY };
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_attested_device(trans_provider, &attestation);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Prov_Device_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_SetOption(IGNORED_PTR_ARG, PROV_REGISTRATION_ID, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_device_ll_set_x509_identity(IGNORED_PTR_ARG, TEST_X509_CERT, TEST_X509_PRIVATE_KEY));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_Register_Device(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_015: [ If a registration cannot be started, its register_callback shall be called with PROV_DEVICE_RESULT_ERROR. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_set_symmetric_key_fail)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_ATTESTATION attestation = { TEST_SYMMETRIC_KEY, NULL, NULL };
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_attested_device(link_provider, &attestation);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_device_ll_create_on_connection(TEST_SCOPE_ID, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Prov_Device_LL_SetOption(IGNORED_PTR_ARG, PROV_REGISTRATION_ID, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(prov_device_ll_set_symmetric_key(IGNORED_PTR_ARG, TEST_REGISTRATION_ID, TEST_SYMMETRIC_KEY))
+            .SetReturn(PROV_DEVICE_RESULT_ERROR);
+        STRICT_EXPECTED_CALL(on_fleet_register_device_callback(PROV_DEVICE_RESULT_ERROR, NULL, NULL, TEST_USER_CONTEXT));
+        setup_destroy_device_mocks();
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 0, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_027: [ A registration that completes while it waits to poll shall be removed from the poll schedule before it is destroyed. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_DoWork_complete_while_waiting_for_poll_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        STRICT_EXPECTED_CALL(prov_device_ll_get_poll_delay(IGNORED_PTR_ARG)).SetReturn(TEST_POLL_DELAY_MS);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        g_register_callback(PROV_DEVICE_RESULT_OK, TEST_IOTHUB, TEST_DEVICE_ID, g_register_ctx);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        setup_destroy_device_mocks();
+        STRICT_EXPECTED_CALL(prov_transport_dowork(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        //act
+        Prov_Device_Fleet_LL_DoWork(handle);
+        g_current_ms += TEST_POLL_DELAY_MS;
+        Prov_Device_Fleet_LL_DoWork(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 0, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_016: [ When the registration of a device completes, its register_callback shall be called with the result, the IoTHub uri and the device id. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_registration_complete_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(on_fleet_register_device_callback(PROV_DEVICE_RESULT_OK, TEST_IOTHUB, TEST_DEVICE_ID, TEST_USER_CONTEXT));
+
+        //act
+        g_register_callback(PROV_DEVICE_RESULT_OK, TEST_IOTHUB, TEST_DEVICE_ID, g_register_ctx);
+
+        //assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 0, Prov_Device_Fleet_LL_Get_Pending_Count(handle));
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_018: [ If handle or optionName is NULL, Prov_Device_Fleet_LL_SetOption shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_SetOption_handle_NULL_fail)
+    {
+        //arrange
+        size_t max_in_flight = 1;
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_SetOption(NULL, PROV_FLEET_OPTION_MAX_IN_FLIGHT, &max_in_flight);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_018: [ If handle or optionName is NULL, Prov_Device_Fleet_LL_SetOption shall return PROV_DEVICE_RESULT_INVALID_ARG. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_SetOption_option_name_NULL_fail)
+    {
+        //arrange
+        size_t max_in_flight = 1;
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_SetOption(handle, NULL, &max_in_flight);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_019: [ PROV_REGISTRATION_ID shall be rejected with PROV_DEVICE_RESULT_INVALID_ARG, the registration id is given to each Prov_Device_Fleet_LL_Register_Device. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_SetOption_registration_id_fail)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_SetOption(handle, PROV_REGISTRATION_ID, TEST_REGISTRATION_ID);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_INVALID_ARG, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_020: [ PROV_OPTION_TIMEOUT and PROV_FLEET_OPTION_MAX_IN_FLIGHT shall be stored and apply to the registrations started afterwards. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_SetOption_max_in_flight_succeed)
+    {
+        //arrange
+        size_t max_in_flight = 1;
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_SetOption(handle, PROV_FLEET_OPTION_MAX_IN_FLIGHT, &max_in_flight);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_021: [ When the registrations share a connection, any other option shall be set on the connection. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_SetOption_shared_trusted_cert_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_set_trusted_cert(IGNORED_PTR_ARG, TEST_TRUSTED_CERT));
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_SetOption(handle, OPTION_TRUSTED_CERT, TEST_TRUSTED_CERT);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_021: [ When the registrations share a connection, any other option shall be set on the connection. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_SetOption_shared_transport_option_fail)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, link_provider);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(prov_transport_set_option(IGNORED_PTR_ARG, TEST_CUSTOM_OPTION, IGNORED_PTR_ARG)).SetReturn(__LINE__);
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_SetOption(handle, TEST_CUSTOM_OPTION, TEST_USER_CONTEXT);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_022: [ Otherwise OPTION_TRUSTED_CERT and PROV_OPTION_LOG_TRACE shall be stored and apply to the registrations started afterwards, and any other option shall fail with PROV_DEVICE_RESULT_ERROR. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_SetOption_no_link_transport_option_fail)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_SetOption(handle, TEST_CUSTOM_OPTION, TEST_USER_CONTEXT);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_ERROR, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_022: [ Otherwise OPTION_TRUSTED_CERT and PROV_OPTION_LOG_TRACE shall be stored and apply to the registrations started afterwards, and any other option shall fail with PROV_DEVICE_RESULT_ERROR. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_SetOption_no_link_trusted_cert_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = Prov_Device_Fleet_LL_Create(TEST_PROV_URI, TEST_SCOPE_ID, trans_provider);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_TRUSTED_CERT));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        //act
+        PROV_DEVICE_RESULT prov_result = Prov_Device_Fleet_LL_SetOption(handle, OPTION_TRUSTED_CERT, TEST_TRUSTED_CERT);
+
+        //assert
+        ASSERT_ARE_EQUAL(PROV_DEVICE_RESULT, PROV_DEVICE_RESULT_OK, prov_result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_023: [ If handle is NULL, Prov_Device_Fleet_LL_Get_Pending_Count shall return 0. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Get_Pending_Count_handle_NULL)
+    {
+        //arrange
+
+        //act
+        size_t pending_count = Prov_Device_Fleet_LL_Get_Pending_Count(NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(size_t, 0, pending_count);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_PROV_DEVICE_FLEET_09_024: [ Prov_Device_Fleet_LL_Get_Pending_Count shall return the number of registrations that are queued or in progress. ] */
+    TEST_FUNCTION(Prov_Device_Fleet_LL_Get_Pending_Count_succeed)
+    {
+        //arrange
+        PROV_DEVICE_FLEET_LL_HANDLE handle = create_fleet_with_device(link_provider);
+        (void)Prov_Device_Fleet_LL_Register_Device(handle, TEST_REGISTRATION_ID_2, NULL, on_fleet_register_device_callback, NULL, NULL, NULL);
+        Prov_Device_Fleet_LL_DoWork(handle);
+        umock_c_reset_all_calls();
+
+        //act
+        size_t pending_count = Prov_Device_Fleet_LL_Get_Pending_Count(handle);
+
+        //assert
+        ASSERT_ARE_EQUAL(size_t, 2, pending_count);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+        Prov_Device_Fleet_LL_Destroy(handle);
+    }
+
+END_TEST_SUITE(prov_device_fleet_ll_client_ut)
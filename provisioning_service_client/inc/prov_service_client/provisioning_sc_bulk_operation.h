@@ -40,8 +40,12 @@ typedef struct PROVISIONING_BULK_OPERATION_ERROR_TAG
     char* registration_id;
     int32_t error_code;
     char* error_status;
+    size_t enrollment_index; //position of the enrollment in the bulk operation (SIZE_MAX if unknown), only set by prov_sc_run_bulk_operation_large
 } PROVISIONING_BULK_OPERATION_ERROR;
 
+//error_code of the enrollments prov_sc_run_bulk_operation_large could not apply, error_status tells why
+#define PROVISIONING_BULK_OPERATION_ERROR_CODE_NOT_APPLIED  -1
+
 typedef struct PROVISIONING_BULK_OPERATION_RESULT_TAG
 {
     bool is_successful;
@@ -65,6 +69,8 @@ MOCKABLE_FUNCTION(, void, bulkOperationResult_free, PROVISIONING_BULK_OPERATION_
 
 /* ---INTERNAL USAGE ONLY--- */
 MOCKABLE_FUNCTION(, PROVISIONING_BULK_OPERATION_ERROR*, bulkOperationError_fromJson, JSON_Object*, root_object);
+MOCKABLE_FUNCTION(, int, bulkOperationResult_merge, PROVISIONING_BULK_OPERATION_RESULT*, bulk_res, PROVISIONING_BULK_OPERATION_RESULT*, chunk_res, const PROVISIONING_BULK_OPERATION*, chunk_op, size_t, first_index);
+MOCKABLE_FUNCTION(, int, bulkOperationResult_addNotAppliedErrors, PROVISIONING_BULK_OPERATION_RESULT*, bulk_res, const PROVISIONING_BULK_OPERATION*, bulk_op, size_t, first_index, size_t, num_enrollments, const char*, error_status);
 
 #ifdef __cplusplus
 }
@@ -65,6 +65,15 @@ MOCKABLE_FUNCTION(, int, prov_sc_set_certificate, PROVISIONING_SERVICE_CLIENT_HA
 */
 MOCKABLE_FUNCTION(, int, prov_sc_set_proxy, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, HTTP_PROXY_OPTIONS*, proxy_options);
 
+/** @brief  Set how long the HTTP connection to the Provisioning Service is kept open between requests.
+*
+* @param    prov_client         The handle used for connecting to the Provisioning Service.
+* @param    idle_timeout_secs   Seconds an idle connection is reused for (default 60). If given as 0, every request opens its own connection.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_set_keep_alive, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, size_t, idle_timeout_secs);
+
 /** @brief Creates or updates an individual device enrollment record on the Provisioning Service, reflecting the changes in the given struct.
 *
 * @param    prov_client         The handle used for connecting to the Provisioning Service.
@@ -125,6 +134,23 @@ MOCKABLE_FUNCTION(, int, prov_sc_query_individual_enrollment, PROVISIONING_SERVI
 */
 MOCKABLE_FUNCTION(, int, prov_sc_run_individual_enrollment_bulk_operation, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_BULK_OPERATION*, bulk_op, PROVISIONING_BULK_OPERATION_RESULT**, bulk_res_ptr);
 
+/** @brief  Performs a bulk operation of any size, split into chunks the provisioning service accepts.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service.
+* @param    bulk_op         A pointer to a bulk operation structure with details about the bulk operation.
+* @param    bulk_res_ptr    A pointer to a bulk operation result pointer that will be filled with the merged results upon completion.
+*                           The enrollment_index of each error is the position of the failed enrollment in bulk_op.
+*
+* @details  Chunks are serialized as they are sent and run concurrently on up to the number of connections set with prov_sc_ll_set_max_connections.
+*           If a chunk cannot be sent or the service rejects it, no further chunks are sent and the chunks already in flight are
+*           waited for. Chunks that completed are not rolled back: the result is returned with is_successful set to false, and every
+*           enrollment of a failed or unsent chunk appears in it as an error with error_code PROVISIONING_BULK_OPERATION_ERROR_CODE_NOT_APPLIED.
+*
+* @return   0 if bulk_res_ptr was filled, even when some chunks failed; a non-zero number if the arguments are invalid or the
+*           result could not be built.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_run_bulk_operation_large, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_BULK_OPERATION*, bulk_op, PROVISIONING_BULK_OPERATION_RESULT**, bulk_res_ptr);
+
 /** @brief  Creates or updates a device enrollment group record on the Provisioning Service.
 *
 * @param    prov_client         The handle used for connecting to the Provisioning Service.
@@ -212,6 +238,243 @@ MOCKABLE_FUNCTION(, int, prov_sc_get_device_registration_state, PROVISIONING_SER
 */
 MOCKABLE_FUNCTION(, int, prov_sc_query_device_registration_state, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_QUERY_SPECIFICATION*, query_spec, char**, cont_token_ptr, PROVISIONING_QUERY_RESPONSE**, query_resp_ptr);
 
+/* Non-blocking API
+*
+* The prov_sc_ll_* functions only queue a request and return. Queued requests are sent by prov_sc_ll_dowork, spread over a pool of
+* connections with one request in flight on each, and the callback given with the request is called from prov_sc_ll_dowork once it completes.
+* Handles, bulk operation results and query responses given to a callback belong to the caller, the same as with the blocking functions.
+* Requests still pending when the handle is destroyed complete with PROV_SC_LL_RESULT_DESTROYED.
+*/
+
+#define PROV_SC_LL_RESULT_VALUES \
+        PROV_SC_LL_RESULT_OK, \
+        PROV_SC_LL_RESULT_ERROR, \
+        PROV_SC_LL_RESULT_HTTP_ERROR, \
+        PROV_SC_LL_RESULT_DESTROYED
+MU_DEFINE_ENUM(PROV_SC_LL_RESULT, PROV_SC_LL_RESULT_VALUES);
+
+typedef void(*PROV_SC_LL_INDIVIDUAL_ENROLLMENT_CALLBACK)(PROV_SC_LL_RESULT result, INDIVIDUAL_ENROLLMENT_HANDLE enrollment, void* user_ctx);
+typedef void(*PROV_SC_LL_ENROLLMENT_GROUP_CALLBACK)(PROV_SC_LL_RESULT result, ENROLLMENT_GROUP_HANDLE enrollment, void* user_ctx);
+typedef void(*PROV_SC_LL_DEVICE_REGISTRATION_STATE_CALLBACK)(PROV_SC_LL_RESULT result, DEVICE_REGISTRATION_STATE_HANDLE reg_state, void* user_ctx);
+typedef void(*PROV_SC_LL_DELETE_CALLBACK)(PROV_SC_LL_RESULT result, void* user_ctx);
+typedef void(*PROV_SC_LL_BULK_OPERATION_CALLBACK)(PROV_SC_LL_RESULT result, PROVISIONING_BULK_OPERATION_RESULT* bulk_res, void* user_ctx);
+typedef void(*PROV_SC_LL_QUERY_CALLBACK)(PROV_SC_LL_RESULT result, PROVISIONING_QUERY_RESPONSE* query_resp, const char* cont_token, void* user_ctx);
+
+/** @brief  Sends queued requests, receives replies and calls the callbacks of the completed requests.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service.
+*/
+MOCKABLE_FUNCTION(, void, prov_sc_ll_dowork, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client);
+
+/** @brief  Sets how many connections prov_sc_ll_dowork may open to send requests concurrently (default 4).
+*
+* @param    prov_client         The handle used for connecting to the Provisioning Service.
+* @param    max_connections     The maximum number of connections, at least 1. Cannot be changed while requests are pending.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_set_max_connections, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, size_t, max_connections);
+
+/** @brief  Gets the number of requests queued or in flight.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service.
+*
+* @return   The number of requests whose callback has not been called yet.
+*/
+MOCKABLE_FUNCTION(, size_t, prov_sc_ll_get_pending_count, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client);
+
+/** @brief  Queues the creation or update of an individual device enrollment record on the Provisioning Service.
+*
+* @param    prov_client             The handle used for connecting to the Provisioning Service.
+* @param    enrollment              The new or updated individual enrollment. It is serialized right away and stays owned by the caller.
+* @param    enrollment_callback     Called with the enrollment record returned by the Provisioning Service.
+* @param    user_ctx                User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_create_or_update_individual_enrollment, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, INDIVIDUAL_ENROLLMENT_HANDLE, enrollment, PROV_SC_LL_INDIVIDUAL_ENROLLMENT_CALLBACK, enrollment_callback, void*, user_ctx);
+
+/** @brief  Queues the deletion of an individual device enrollment record on the Provisioning Service.
+*
+* @param    prov_client         The handle used for connecting to the Provisioning Service.
+* @param    reg_id              The registration id of the target individual enrollment.
+* @param    etag                The etag of the target individual enrollment. If given as "*", will match any etag. If given as NULL, will be ignored.
+* @param    delete_callback     Called once the deletion completes, may be NULL.
+* @param    user_ctx            User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_delete_individual_enrollment_by_param, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, const char*, reg_id, const char*, etag, PROV_SC_LL_DELETE_CALLBACK, delete_callback, void*, user_ctx);
+
+/** @brief  Queues the retrieval of an individual device enrollment record from the Provisioning Service.
+*
+* @param    prov_client             The handle used for connecting to the Provisioning Service.
+* @param    reg_id                  The registration id of the target individual enrollment.
+* @param    enrollment_callback     Called with the retrieved enrollment record.
+* @param    user_ctx                User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_get_individual_enrollment, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, const char*, reg_id, PROV_SC_LL_INDIVIDUAL_ENROLLMENT_CALLBACK, enrollment_callback, void*, user_ctx);
+
+/** @brief  Queues a query of individual device enrollment records on the Provisioning Service.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service.
+* @param    query_spec      The query specification with query details and settings
+* @param    cont_token      The continuation token given to the callback of the previous page, NULL for the first page.
+* @param    query_callback  Called with the query response and the continuation token of the next page, if any.
+* @param    user_ctx        User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_query_individual_enrollment, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_QUERY_SPECIFICATION*, query_spec, const char*, cont_token, PROV_SC_LL_QUERY_CALLBACK, query_callback, void*, user_ctx);
+
+/** @brief  Queues a bulk operation on individual device enrollment records on the Provisioning Service.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service.
+* @param    bulk_op         A pointer to a bulk operation structure, serialized right away.
+* @param    bulk_callback   Called with the results of the bulk operation.
+* @param    user_ctx        User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_run_individual_enrollment_bulk_operation, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_BULK_OPERATION*, bulk_op, PROV_SC_LL_BULK_OPERATION_CALLBACK, bulk_callback, void*, user_ctx);
+
+/** @brief  Queues the creation or update of a device enrollment group record on the Provisioning Service.
+*
+* @param    prov_client             The handle used for connecting to the Provisioning Service.
+* @param    enrollment              The new or updated enrollment group. It is serialized right away and stays owned by the caller.
+* @param    enrollment_callback     Called with the enrollment group record returned by the Provisioning Service.
+* @param    user_ctx                User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_create_or_update_enrollment_group, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, ENROLLMENT_GROUP_HANDLE, enrollment, PROV_SC_LL_ENROLLMENT_GROUP_CALLBACK, enrollment_callback, void*, user_ctx);
+
+/** @brief  Queues the deletion of a device enrollment group record on the Provisioning Service.
+*
+* @param    prov_client         The handle used for connecting to the Provisioning Service.
+* @param    group_id            The enrollment group id of the target enrollment group.
+* @param    etag                The etag of the target enrollment group. If given as "*", will match any etag.
+* @param    delete_callback     Called once the deletion completes, may be NULL.
+* @param    user_ctx            User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_delete_enrollment_group_by_param, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, const char*, group_id, const char*, etag, PROV_SC_LL_DELETE_CALLBACK, delete_callback, void*, user_ctx);
+
+/** @brief  Queues the retrieval of a device enrollment group record from the Provisioning Service.
+*
+* @param    prov_client             The handle used for connecting to the Provisioning Service.
+* @param    group_id                The enrollment group id of the target enrollment group.
+* @param    enrollment_callback     Called with the retrieved enrollment group record.
+* @param    user_ctx                User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_get_enrollment_group, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, const char*, group_id, PROV_SC_LL_ENROLLMENT_GROUP_CALLBACK, enrollment_callback, void*, user_ctx);
+
+/** @brief  Queues a query of enrollment group records on the Provisioning Service.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service.
+* @param    query_spec      The query specification with query details and settings
+* @param    cont_token      The continuation token given to the callback of the previous page, NULL for the first page.
+* @param    query_callback  Called with the query response and the continuation token of the next page, if any.
+* @param    user_ctx        User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_query_enrollment_group, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_QUERY_SPECIFICATION*, query_spec, const char*, cont_token, PROV_SC_LL_QUERY_CALLBACK, query_callback, void*, user_ctx);
+
+/** @brief  Queues the deletion of a device registration state on the Provisioning Service.
+*
+* @param    prov_client         The handle used for connecting to the Provisioning Service.
+* @param    reg_id              The registration id of the target registration state.
+* @param    etag                The etag of the target registration state
+* @param    delete_callback     Called once the deletion completes, may be NULL.
+* @param    user_ctx            User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_delete_device_registration_state_by_param, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, const char*, reg_id, const char*, etag, PROV_SC_LL_DELETE_CALLBACK, delete_callback, void*, user_ctx);
+
+/** @brief  Queues the retrieval of a device registration state from the Provisioning Service.
+*
+* @param    prov_client         The handle used for connecting to the Provisioning Service.
+* @param    reg_id              The registration id of the target registration status.
+* @param    reg_state_callback  Called with the retrieved registration state.
+* @param    user_ctx            User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure.
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_get_device_registration_state, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, const char*, reg_id, PROV_SC_LL_DEVICE_REGISTRATION_STATE_CALLBACK, reg_state_callback, void*, user_ctx);
+
+/** @brief  Queues a query of device registration state records on the Provisioning Service.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service.
+* @param    query_spec      The query specification with query details and settings
+* @param    cont_token      The continuation token given to the callback of the previous page, NULL for the first page.
+* @param    query_callback  Called with the query response and the continuation token of the next page, if any.
+* @param    user_ctx        User context passed to the callback.
+*
+* @return   0 upon success, a non-zero number upon failure
+*/
+MOCKABLE_FUNCTION(, int, prov_sc_ll_query_device_registration_state, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_QUERY_SPECIFICATION*, query_spec, const char*, cont_token, PROV_SC_LL_QUERY_CALLBACK, query_callback, void*, user_ctx);
+
+/* Query iterator
+*
+* Yields the records of a query one at a time. The request for the next page is queued as soon as the caller starts on the current one,
+* and prov_sc_query_iterator_next drives it with prov_sc_ll_dowork, so the next page is received and parsed while the current one is consumed.
+* Because prov_sc_ll_dowork serves the whole queue of prov_client, prov_sc_query_iterator_next also sends and completes any other request
+* queued on the same prov_client, and their callbacks run on the thread calling it.
+* An iterator must not be used after its prov_client is destroyed.
+*/
+
+#define PROV_SC_QUERY_ITERATOR_RESULT_VALUES \
+        PROV_SC_QUERY_ITERATOR_RECORD, \
+        PROV_SC_QUERY_ITERATOR_END, \
+        PROV_SC_QUERY_ITERATOR_ERROR
+MU_DEFINE_ENUM(PROV_SC_QUERY_ITERATOR_RESULT, PROV_SC_QUERY_ITERATOR_RESULT_VALUES);
+
+typedef struct PROV_SC_QUERY_ITERATOR_TAG* PROV_SC_QUERY_ITERATOR_HANDLE;
+
+typedef struct PROVISIONING_QUERY_RECORD_TAG
+{
+    union {
+        INDIVIDUAL_ENROLLMENT_HANDLE ie;
+        ENROLLMENT_GROUP_HANDLE eg;
+        DEVICE_REGISTRATION_STATE_HANDLE drs;
+    } record;
+    PROVISIONING_QUERY_TYPE record_type;
+} PROVISIONING_QUERY_RECORD;
+
+/** @brief  Creates an iterator over the records of a query and queues the request for the first page.
+*
+* @param    prov_client     The handle used for connecting to the Provisioning Service.
+* @param    query_type      The kind of record to query: QUERY_TYPE_INDIVIDUAL_ENROLLMENT, QUERY_TYPE_ENROLLMENT_GROUP or QUERY_TYPE_DEVICE_REGISTRATION_STATE.
+* @param    query_spec      The query specification with query details and settings. It is copied and stays owned by the caller.
+*
+* @return   A handle to the iterator upon success, NULL upon failure.
+*/
+MOCKABLE_FUNCTION(, PROV_SC_QUERY_ITERATOR_HANDLE, prov_sc_query_iterator_create, PROVISIONING_SERVICE_CLIENT_HANDLE, prov_client, PROVISIONING_QUERY_TYPE, query_type, PROVISIONING_QUERY_SPECIFICATION*, query_spec);
+
+/** @brief  Gets the next record of the query, waiting for its page if it has not arrived yet.
+*           While waiting it calls prov_sc_ll_dowork, sleeping briefly between calls, so other requests queued on the same prov_client progress too.
+*
+* @param    iterator    The handle of the query iterator.
+* @param    record      Filled with the next record. The record belongs to the caller, who must destroy it.
+*
+* @return   PROV_SC_QUERY_ITERATOR_RECORD if a record was returned, PROV_SC_QUERY_ITERATOR_END once every record has been returned, or
+*           PROV_SC_QUERY_ITERATOR_ERROR if a page could not be retrieved.
+*/
+MOCKABLE_FUNCTION(, PROV_SC_QUERY_ITERATOR_RESULT, prov_sc_query_iterator_next, PROV_SC_QUERY_ITERATOR_HANDLE, iterator, PROVISIONING_QUERY_RECORD*, record);
+
+/** @brief  Destroys a query iterator and the records it has not returned.
+*
+* @param    iterator    The handle of the query iterator.
+*/
+MOCKABLE_FUNCTION(, void, prov_sc_query_iterator_destroy, PROV_SC_QUERY_ITERATOR_HANDLE, iterator);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -2,6 +2,8 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/gballoc.h"
@@ -240,6 +242,171 @@ PROVISIONING_BULK_OPERATION_RESULT* bulkOperationResult_deserializeFromJson(cons
     return new_result;
 }
 
+static size_t bulkOperation_findEnrollmentIndex(const PROVISIONING_BULK_OPERATION* bulk_op, const char* registration_id)
+{
+    size_t result = SIZE_MAX;
+
+    if (registration_id != NULL)
+    {
+        //in future, add logic here to decide which getter is used depending on bulk_op->type
+        for (size_t i = 0; i < bulk_op->num_enrollments; i++)
+        {
+            const char* enrollment_reg_id = individualEnrollment_getRegistrationId(bulk_op->enrollments.ie[i]);
+            if (enrollment_reg_id != NULL && strcmp(enrollment_reg_id, registration_id) == 0)
+            {
+                result = i;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+int bulkOperationResult_merge(PROVISIONING_BULK_OPERATION_RESULT* bulk_res, PROVISIONING_BULK_OPERATION_RESULT* chunk_res, const PROVISIONING_BULK_OPERATION* chunk_op, size_t first_index)
+{
+    int result;
+
+    if (bulk_res == NULL || chunk_res == NULL || chunk_op == NULL)
+    {
+        LogError("Invalid parameter bulk_res: %p, chunk_res: %p, chunk_op: %p", bulk_res, chunk_res, chunk_op);
+        result = MU_FAILURE;
+    }
+    else if (chunk_res->num_errors == 0)
+    {
+        bulk_res->is_successful = bulk_res->is_successful && chunk_res->is_successful;
+        result = 0;
+    }
+    else
+    {
+        PROVISIONING_BULK_OPERATION_ERROR** errors;
+
+        if ((errors = malloc((bulk_res->num_errors + chunk_res->num_errors) * sizeof(PROVISIONING_BULK_OPERATION_ERROR*))) == NULL)
+        {
+            LogError("Allocation of Bulk Operation Errors failed");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            if (bulk_res->num_errors > 0)
+            {
+                memcpy(errors, bulk_res->errors, bulk_res->num_errors * sizeof(PROVISIONING_BULK_OPERATION_ERROR*));
+                free(bulk_res->errors);
+            }
+
+            //the errors move to bulk_res, chunk_res is left without any
+            for (size_t i = 0; i < chunk_res->num_errors; i++)
+            {
+                PROVISIONING_BULK_OPERATION_ERROR* error = chunk_res->errors[i];
+                size_t index = bulkOperation_findEnrollmentIndex(chunk_op, error->registration_id);
+                error->enrollment_index = (index == SIZE_MAX) ? SIZE_MAX : first_index + index;
+                errors[bulk_res->num_errors++] = error;
+            }
+            free(chunk_res->errors);
+            chunk_res->errors = NULL;
+            chunk_res->num_errors = 0;
+
+            bulk_res->errors = errors;
+            bulk_res->is_successful = bulk_res->is_successful && chunk_res->is_successful;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static PROVISIONING_BULK_OPERATION_ERROR* bulkOperationError_createNotApplied(INDIVIDUAL_ENROLLMENT_HANDLE enrollment, size_t enrollment_index, const char* error_status)
+{
+    PROVISIONING_BULK_OPERATION_ERROR* new_error;
+    //in future, add logic here to decide which getter is used depending on the type of the bulk operation
+    const char* registration_id = individualEnrollment_getRegistrationId(enrollment);
+
+    if ((new_error = malloc(sizeof(PROVISIONING_BULK_OPERATION_ERROR))) == NULL)
+    {
+        LogError("Allocation of Bulk Operation Error failed");
+    }
+    else
+    {
+        memset(new_error, 0, sizeof(PROVISIONING_BULK_OPERATION_ERROR));
+        new_error->error_code = PROVISIONING_BULK_OPERATION_ERROR_CODE_NOT_APPLIED;
+        new_error->enrollment_index = enrollment_index;
+
+        if ((registration_id != NULL && mallocAndStrcpy_s(&(new_error->registration_id), registration_id) != 0) ||
+            mallocAndStrcpy_s(&(new_error->error_status), error_status) != 0)
+        {
+            LogError("Failed to copy the fields of Bulk Operation Error");
+            bulkOperationError_free(new_error);
+            new_error = NULL;
+        }
+    }
+
+    return new_error;
+}
+
+int bulkOperationResult_addNotAppliedErrors(PROVISIONING_BULK_OPERATION_RESULT* bulk_res, const PROVISIONING_BULK_OPERATION* bulk_op, size_t first_index, size_t num_enrollments, const char* error_status)
+{
+    int result;
+
+    if (bulk_res == NULL || bulk_op == NULL || error_status == NULL || first_index > bulk_op->num_enrollments || num_enrollments > bulk_op->num_enrollments - first_index)
+    {
+        LogError("Invalid parameter bulk_res: %p, bulk_op: %p, error_status: %p, first_index: %lu, num_enrollments: %lu", bulk_res, bulk_op, error_status, (unsigned long)first_index, (unsigned long)num_enrollments);
+        result = MU_FAILURE;
+    }
+    else if (num_enrollments == 0)
+    {
+        result = 0;
+    }
+    else
+    {
+        PROVISIONING_BULK_OPERATION_ERROR** errors;
+
+        if ((errors = malloc((bulk_res->num_errors + num_enrollments) * sizeof(PROVISIONING_BULK_OPERATION_ERROR*))) == NULL)
+        {
+            LogError("Allocation of Bulk Operation Errors failed");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            size_t added;
+
+            for (added = 0; added < num_enrollments; added++)
+            {
+                PROVISIONING_BULK_OPERATION_ERROR* error = bulkOperationError_createNotApplied(bulk_op->enrollments.ie[first_index + added], first_index + added, error_status);
+                if (error == NULL)
+                {
+                    break;
+                }
+                errors[bulk_res->num_errors + added] = error;
+            }
+
+            if (added < num_enrollments)
+            {
+                //all or nothing, bulk_res is left unchanged
+                for (size_t i = 0; i < added; i++)
+                {
+                    bulkOperationError_free(errors[bulk_res->num_errors + i]);
+                }
+                free(errors);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                if (bulk_res->num_errors > 0)
+                {
+                    memcpy(errors, bulk_res->errors, bulk_res->num_errors * sizeof(PROVISIONING_BULK_OPERATION_ERROR*));
+                    free(bulk_res->errors);
+                }
+                bulk_res->errors = errors;
+                bulk_res->num_errors += num_enrollments;
+                bulk_res->is_successful = false;
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
 void bulkOperationResult_free(PROVISIONING_BULK_OPERATION_RESULT* bulk_op_result)
 {
     if (bulk_op_result != NULL)
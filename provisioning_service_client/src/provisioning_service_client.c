@@ -9,6 +9,7 @@
 #include "azure_c_shared_utility/string_tokenizer.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/threadapi.h"
 #include "azure_c_shared_utility/sastoken.h"
 #include "azure_c_shared_utility/urlencode.h"
 #include "azure_c_shared_utility/connection_string_parser.h"
@@ -32,6 +33,90 @@ typedef enum HTTP_CONNECTION_STATE_TAG
     HTTP_STATE_ERROR
 } HTTP_CONNECTION_STATE;
 
+typedef enum LL_REQUEST_TYPE_TAG
+{
+    LL_REQUEST_RECORD,
+    LL_REQUEST_DELETE,
+    LL_REQUEST_BULK_OPERATION,
+    LL_REQUEST_QUERY
+} LL_REQUEST_TYPE;
+
+typedef void*(*VECTOR_DESERIALIZE_FROM_JSON)(char*);
+typedef void(*LL_RECORD_CALLBACK)(PROV_SC_LL_RESULT result, void* handle, void* user_ctx);
+
+typedef struct LL_REQUEST_TAG
+{
+    struct LL_REQUEST_TAG* next;
+    LL_REQUEST_TYPE type;
+    HTTP_CLIENT_REQUEST_TYPE operation;
+    STRING_HANDLE registration_path;
+    char* etag;
+    char* content;
+    size_t page_size;
+    char* cont_token;
+    bool on_reused_connection;
+    bool is_sent;
+    bool is_retry;
+
+    VECTOR_DESERIALIZE_FROM_JSON deserializeFromJson;
+    LL_RECORD_CALLBACK record_callback;
+    PROV_SC_LL_DELETE_CALLBACK delete_callback;
+    PROV_SC_LL_BULK_OPERATION_CALLBACK bulk_callback;
+    PROV_SC_LL_QUERY_CALLBACK query_callback;
+    void* user_ctx;
+
+    //Filled in by the reply
+    bool reply_received;
+    unsigned int status_code;
+    char* response;
+    HTTP_HEADERS_HANDLE response_headers;
+} LL_REQUEST;
+
+typedef struct LL_CONNECTION_TAG
+{
+    HTTP_CLIENT_HANDLE http_client;
+    HTTP_CONNECTION_STATE http_state;
+    time_t last_request_time;
+
+    //The request in flight on this connection, NULL while idle
+    LL_REQUEST* request;
+    HTTP_HEADERS_HANDLE request_headers;
+} LL_CONNECTION;
+
+typedef struct LARGE_BULK_OPERATION_TAG
+{
+    const PROVISIONING_BULK_OPERATION* bulk_op;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res;
+    size_t chunks_in_flight;
+    bool has_failed;
+    bool is_incomplete; //some enrollments are missing from bulk_res, it cannot be returned
+} LARGE_BULK_OPERATION;
+
+typedef struct BULK_OPERATION_CHUNK_TAG
+{
+    LARGE_BULK_OPERATION* large_op;
+    PROVISIONING_BULK_OPERATION chunk_op;
+    size_t first_index;
+} BULK_OPERATION_CHUNK;
+
+typedef struct PROV_SC_QUERY_ITERATOR_TAG
+{
+    PROVISIONING_SERVICE_CLIENT_HANDLE prov_client;
+    const char* path_format;
+    PROVISIONING_QUERY_SPECIFICATION query_spec;
+    char* query_string;
+    char* registration_id;
+
+    //The page being handed out, and the one after it once it has arrived
+    PROVISIONING_QUERY_RESPONSE* page;
+    size_t next_record;
+    PROVISIONING_QUERY_RESPONSE* next_page;
+    char* cont_token;
+    bool page_in_flight;
+    bool has_failed;
+    bool is_destroyed;
+} PROV_SC_QUERY_ITERATOR;
+
 //consider substructure representing SharedAccessSignature?
 typedef struct PROVISIONING_SERVICE_CLIENT_TAG
 {
@@ -41,7 +126,12 @@ typedef struct PROVISIONING_SERVICE_CLIENT_TAG
     char* access_key;
 
     //Connection data
+    HTTP_CLIENT_HANDLE http_client;
     HTTP_CONNECTION_STATE http_state;
+    bool request_sent;
+    bool reply_received;
+    time_t request_time;
+    time_t last_request_time;
     char* response;
     HTTP_HEADERS_HANDLE response_headers;
 
@@ -49,11 +139,18 @@ typedef struct PROVISIONING_SERVICE_CLIENT_TAG
     TRACING_STATUS tracing;
     HTTP_PROXY_OPTIONS* proxy_options;
     char* certificate;
+    size_t keep_alive_secs;
+
+    //Non-blocking requests, queued until prov_sc_ll_dowork finds them an idle connection
+    LL_CONNECTION* ll_connections;
+    size_t ll_max_connections;
+    LL_REQUEST* ll_queue_head;
+    LL_REQUEST* ll_queue_tail;
+    size_t ll_pending_count;
 
 } PROV_SERVICE_CLIENT;
 
 typedef char*(*VECTOR_SERIALIZE_TO_JSON)(void*);
-typedef void*(*VECTOR_DESERIALIZE_FROM_JSON)(char*);
 typedef char*(*VECTOR_GET_ID)(void*);
 typedef char*(*VECTOR_GET_ETAG)(void*);
 typedef void(*VECTOR_DESTROY)(void*);
@@ -95,6 +192,15 @@ static const char* const HEADER_VALUE_CONTENT_TYPE =            "application/jso
 #define UID_LENGTH                  37
 #define SAS_TOKEN_DEFAULT_LIFETIME  3600
 #define EPOCH_TIME_T_VALUE          (time_t)0
+// Idle connections are closed before the service or a middlebox drops them on its own
+#define DEFAULT_KEEP_ALIVE_SECS     60
+#define DEFAULT_LL_MAX_CONNECTIONS  4
+#define BULK_OPERATION_CHUNK_SIZE   10  //most enrollments the Provisioning Service accepts in one bulk operation
+#define QUERY_PAGE_WAIT_INTERVAL_IN_MS  1  //yields the CPU while prov_sc_query_iterator_next waits for a page
+
+static const char* const BULK_CHUNK_FAILED_STATUS = "The bulk operation chunk of this enrollment failed";
+static const char* const BULK_CHUNK_NOT_MERGED_STATUS = "The result of the bulk operation chunk of this enrollment could not be read";
+static const char* const BULK_CHUNK_NOT_SENT_STATUS = "The bulk operation chunk of this enrollment was not sent after an earlier chunk failed";
 
 static HANDLE_FUNCTION_VECTOR getVector_individualEnrollment()
 {
@@ -163,38 +269,42 @@ static void on_http_error(void* callback_ctx, HTTP_CALLBACK_REASON error_result)
     }
 }
 
-static void on_http_reply_recv(void* callback_ctx, HTTP_CALLBACK_REASON request_result, const unsigned char* content, size_t content_len, unsigned int status_code, HTTP_HEADERS_HANDLE responseHeadersHandle)
+static void store_reply(const unsigned char* content, size_t content_len, HTTP_HEADERS_HANDLE responseHeadersHandle, char** response, HTTP_HEADERS_HANDLE* response_headers)
 {
-    (void)content_len;
-    if (callback_ctx != NULL)
+    //attach headers to the response
+    if (responseHeadersHandle != NULL)
     {
-        PROV_SERVICE_CLIENT* prov_client = (PROV_SERVICE_CLIENT*)callback_ctx;
-        const char* content_str = (const char*)content;
-
-        //attach headers to prov_client
-        if (responseHeadersHandle != NULL)
+        if ((*response_headers = HTTPHeaders_Clone(responseHeadersHandle)) == NULL)
         {
-            if ((prov_client->response_headers = HTTPHeaders_Clone(responseHeadersHandle)) == NULL)
-            {
-                LogError("Copying response headers failed");
-                prov_client->response_headers = NULL;
-            }
+            LogError("Copying response headers failed");
         }
+    }
 
-        //if there is a json response
-        if (content != NULL)
+    //if there is a json response
+    if (content != NULL)
+    {
+        if ((*response = malloc(content_len + 1)) == NULL)
         {
-            if ((prov_client->response = malloc(content_len + 1)) == NULL)
-            {
-                LogError("Allocating response failed");
-                prov_client->response = NULL;
-            }
-            else
-            {
-                memset(prov_client->response, 0, content_len);
-                memcpy(prov_client->response, content_str, content_len);
-            }
+            LogError("Allocating response failed");
+        }
+        else
+        {
+            memcpy(*response, content, content_len);
+            (*response)[content_len] = '\0';
         }
+    }
+}
+
+static void on_http_reply_recv(void* callback_ctx, HTTP_CALLBACK_REASON request_result, const unsigned char* content, size_t content_len, unsigned int status_code, HTTP_HEADERS_HANDLE responseHeadersHandle)
+{
+    if (callback_ctx != NULL)
+    {
+        PROV_SERVICE_CLIENT* prov_client = (PROV_SERVICE_CLIENT*)callback_ctx;
+
+        // Replies that carry an error status still leave the connection usable
+        prov_client->reply_received = (request_result == HTTP_CALLBACK_REASON_OK);
+
+        store_reply(content, content_len, responseHeadersHandle, &prov_client->response, &prov_client->response_headers);
 
         //update HTTP state
         if (request_result == HTTP_CALLBACK_REASON_OK)
@@ -219,7 +329,7 @@ static void on_http_reply_recv(void* callback_ctx, HTTP_CALLBACK_REASON request_
     }
 }
 
-static HTTP_HEADERS_HANDLE construct_http_headers(const PROV_SERVICE_CLIENT* prov_client, const char* etag, HTTP_CLIENT_REQUEST_TYPE request)
+static HTTP_HEADERS_HANDLE construct_http_headers(PROV_SERVICE_CLIENT* prov_client, const char* etag, HTTP_CLIENT_REQUEST_TYPE request)
 {
     HTTP_HEADERS_HANDLE result;
     if ((result = HTTPHeaders_Alloc()) == NULL)
@@ -228,7 +338,8 @@ static HTTP_HEADERS_HANDLE construct_http_headers(const PROV_SERVICE_CLIENT* pro
     }
     else
     {
-        size_t secSinceEpoch = (size_t)(difftime(get_time(NULL), EPOCH_TIME_T_VALUE) + 0);
+        prov_client->request_time = get_time(NULL);
+        size_t secSinceEpoch = (size_t)(difftime(prov_client->request_time, EPOCH_TIME_T_VALUE) + 0);
         size_t expiryTime = secSinceEpoch + SAS_TOKEN_DEFAULT_LIFETIME;
 
         STRING_HANDLE sas_token = SASToken_CreateString(prov_client->access_key, prov_client->provisioning_service_uri, prov_client->key_name, expiryTime);
@@ -322,10 +433,9 @@ static STRING_HANDLE create_registration_path(const char* path_format, const cha
     return registration_path;
 }
 
-static int get_response_headers(PROV_SERVICE_CLIENT* prov_client, char** cont_token_ptr, const char** resp_type_ptr)
+static int get_response_headers(HTTP_HEADERS_HANDLE resp_headers, char** cont_token_ptr, const char** resp_type_ptr)
 {
     int result = 0;
-    HTTP_HEADERS_HANDLE resp_headers = prov_client->response_headers;
     if (resp_headers == NULL)
     {
         LogError("Unable to retrieve headers");
@@ -359,7 +469,7 @@ static int get_response_headers(PROV_SERVICE_CLIENT* prov_client, char** cont_to
     return result;
 }
 
-static HTTP_CLIENT_HANDLE connect_to_service(PROV_SERVICE_CLIENT* prov_client)
+static HTTP_CLIENT_HANDLE connect_to_service(PROV_SERVICE_CLIENT* prov_client, ON_HTTP_ERROR_CALLBACK on_error, ON_HTTP_OPEN_COMPLETE_CALLBACK on_connected, void* callback_ctx)
 {
     HTTP_CLIENT_HANDLE result;
 
@@ -391,7 +501,7 @@ static HTTP_CLIENT_HANDLE connect_to_service(PROV_SERVICE_CLIENT* prov_client)
         LogError("platform default tlsio is NULL");
         result = NULL;
     }
-    else if ((result = uhttp_client_create(interface_desc, &tls_io_config, on_http_error, prov_client)) == NULL)
+    else if ((result = uhttp_client_create(interface_desc, &tls_io_config, on_error, callback_ctx)) == NULL)
     {
         LogError("Failed creating http object");
     }
@@ -407,7 +517,7 @@ static HTTP_CLIENT_HANDLE connect_to_service(PROV_SERVICE_CLIENT* prov_client)
         uhttp_client_destroy(result);
         result = NULL;
     }
-    else if (uhttp_client_open(result, prov_client->provisioning_service_uri, DEFAULT_HTTPS_PORT, on_http_connected, prov_client) != HTTP_CLIENT_OK)
+    else if (uhttp_client_open(result, prov_client->provisioning_service_uri, DEFAULT_HTTPS_PORT, on_connected, callback_ctx) != HTTP_CLIENT_OK)
     {
         LogError("Failed opening http url %s", prov_client->provisioning_service_uri);
         uhttp_client_destroy(result);
@@ -416,23 +526,36 @@ static HTTP_CLIENT_HANDLE connect_to_service(PROV_SERVICE_CLIENT* prov_client)
     return result;
 }
 
-static int rest_call(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, HTTP_CLIENT_REQUEST_TYPE operation, const char* registration_path, HTTP_HEADERS_HANDLE request_headers, const char* content)
+static void disconnect_from_service(PROV_SERVICE_CLIENT* prov_client)
 {
-    int result;
-    size_t content_len;
-    HTTP_CLIENT_HANDLE http_client;
-
-    if (content == NULL)
+    if (prov_client->http_client != NULL)
     {
-        content_len = 0;
-    }
-    else
-    {
-        content_len = strlen(content);
+        uhttp_client_close(prov_client->http_client, NULL, NULL);
+        uhttp_client_destroy(prov_client->http_client);
+        prov_client->http_client = NULL;
     }
+    prov_client->http_state = HTTP_STATE_DISCONNECTED;
+}
+
+static void clear_response(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client)
+{
+    free(prov_client->response);
+    prov_client->response = NULL;
+    HTTPHeaders_Free(prov_client->response_headers);
+    prov_client->response_headers = NULL;
+}
+
+static bool is_request_resendable(HTTP_CLIENT_REQUEST_TYPE operation, const char* etag)
+{
+    // A request that may already have reached the service is only sent again if running it twice changes nothing
+    return (operation == HTTP_CLIENT_REQUEST_GET || operation == HTTP_CLIENT_REQUEST_DELETE || (operation == HTTP_CLIENT_REQUEST_PUT && etag != NULL));
+}
+
+static int send_request(PROV_SERVICE_CLIENT* prov_client, HTTP_CLIENT_REQUEST_TYPE operation, const char* registration_path, HTTP_HEADERS_HANDLE request_headers, const char* content, size_t content_len)
+{
+    int result;
 
-    http_client = connect_to_service(prov_client);
-    if (http_client == NULL)
+    if (prov_client->http_client == NULL && (prov_client->http_client = connect_to_service(prov_client, on_http_error, on_http_connected, prov_client)) == NULL)
     {
         LogError("Failed connecting to service");
         result = MU_FAILURE;
@@ -440,12 +563,14 @@ static int rest_call(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, HTTP_CLIENT
     else
     {
         result = 0;
+        prov_client->request_sent = false;
+        prov_client->reply_received = false;
         do
         {
-            uhttp_client_dowork(http_client);
+            uhttp_client_dowork(prov_client->http_client);
             if (prov_client->http_state == HTTP_STATE_CONNECTED)
             {
-                if (uhttp_client_execute_request(http_client, operation, registration_path, request_headers, (unsigned char*)content, content_len, on_http_reply_recv, prov_client) != HTTP_CLIENT_OK)
+                if (uhttp_client_execute_request(prov_client->http_client, operation, registration_path, request_headers, (unsigned char*)content, content_len, on_http_reply_recv, prov_client) != HTTP_CLIENT_OK)
                 {
                     LogError("Failure executing http request");
                     prov_client->http_state = HTTP_STATE_ERROR;
@@ -453,6 +578,7 @@ static int rest_call(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, HTTP_CLIENT
                 }
                 else
                 {
+                    prov_client->request_sent = true;
                     prov_client->http_state = HTTP_STATE_REQUEST_SENT;
                 }
             }
@@ -466,21 +592,53 @@ static int rest_call(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, HTTP_CLIENT
                 LogError("HTTP error");
             }
         } while (prov_client->http_state != HTTP_STATE_COMPLETE && prov_client->http_state != HTTP_STATE_ERROR);
-
-        uhttp_client_close(http_client, NULL, NULL);
-        uhttp_client_destroy(http_client);
     }
 
-    prov_client->http_state = HTTP_STATE_DISCONNECTED;
     return result;
 }
 
-static void clear_response(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client)
+static int rest_call(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, HTTP_CLIENT_REQUEST_TYPE operation, const char* registration_path, HTTP_HEADERS_HANDLE request_headers, const char* etag, const char* content)
 {
-    free(prov_client->response);
-    prov_client->response = NULL;
-    HTTPHeaders_Free(prov_client->response_headers);
-    prov_client->response_headers = NULL;
+    int result;
+    size_t content_len;
+    bool is_connection_reused;
+
+    if (content == NULL)
+    {
+        content_len = 0;
+    }
+    else
+    {
+        content_len = strlen(content);
+    }
+
+    if (prov_client->http_client != NULL && difftime(prov_client->request_time, prov_client->last_request_time) >= (double)prov_client->keep_alive_secs)
+    {
+        disconnect_from_service(prov_client);
+    }
+    is_connection_reused = (prov_client->http_client != NULL);
+
+    result = send_request(prov_client, operation, registration_path, request_headers, content, content_len);
+    if (result != 0 && is_connection_reused && !prov_client->reply_received && (!prov_client->request_sent || is_request_resendable(operation, etag)))
+    {
+        // The service may have closed the kept connection while it was idle
+        LogInfo("Request failed on a kept connection, reconnecting");
+        clear_response(prov_client);
+        disconnect_from_service(prov_client);
+        result = send_request(prov_client, operation, registration_path, request_headers, content, content_len);
+    }
+
+    if (prov_client->reply_received && prov_client->keep_alive_secs > 0)
+    {
+        prov_client->last_request_time = prov_client->request_time;
+        prov_client->http_state = HTTP_STATE_CONNECTED;
+    }
+    else
+    {
+        disconnect_from_service(prov_client);
+    }
+
+    return result;
 }
 
 static int prov_sc_create_or_update_record(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, void** handle_ptr, HANDLE_FUNCTION_VECTOR vector, const char* path_format)
@@ -523,14 +681,15 @@ static int prov_sc_create_or_update_record(PROVISIONING_SERVICE_CLIENT_HANDLE pr
             else
             {
                 HTTP_HEADERS_HANDLE request_headers;
-                if ((request_headers = construct_http_headers(prov_client, vector.getEtag(handle), HTTP_CLIENT_REQUEST_PUT)) == NULL)
+                const char* etag = vector.getEtag(handle);
+                if ((request_headers = construct_http_headers(prov_client, etag, HTTP_CLIENT_REQUEST_PUT)) == NULL)
                 {
                     LogError("Failure constructing headers");
                     result = MU_FAILURE;
                 }
                 else
                 {
-                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_PUT, STRING_c_str(registration_path), request_headers, content);
+                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_PUT, STRING_c_str(registration_path), request_headers, etag, content);
 
                     if (result == 0)
                     {
@@ -593,7 +752,7 @@ static int prov_sc_delete_record_by_param(PROVISIONING_SERVICE_CLIENT_HANDLE pro
             }
             else
             {
-                result = rest_call(prov_client, HTTP_CLIENT_REQUEST_DELETE, STRING_c_str(registration_path), request_headers, NULL);
+                result = rest_call(prov_client, HTTP_CLIENT_REQUEST_DELETE, STRING_c_str(registration_path), request_headers, etag, NULL);
                 clear_response(prov_client);
             }
             HTTPHeaders_Free(request_headers);
@@ -641,7 +800,7 @@ static int prov_sc_get_record(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, co
             }
             else
             {
-                result = rest_call(prov_client, HTTP_CLIENT_REQUEST_GET, STRING_c_str(registration_path), request_headers, NULL);
+                result = rest_call(prov_client, HTTP_CLIENT_REQUEST_GET, STRING_c_str(registration_path), request_headers, NULL, NULL);
 
                 if (result == 0)
                 {
@@ -713,7 +872,7 @@ static int prov_sc_run_bulk_operation(PROVISIONING_SERVICE_CLIENT_HANDLE prov_cl
                 }
                 else
                 {
-                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_POST, STRING_c_str(registration_path), request_headers, content);
+                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_POST, STRING_c_str(registration_path), request_headers, NULL, content);
 
                     if (result == 0)
                     {
@@ -796,7 +955,7 @@ static int prov_sc_query_records(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client,
                 }
                 else
                 {
-                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_POST, STRING_c_str(registration_path), request_headers, content);
+                    result = rest_call(prov_client, HTTP_CLIENT_REQUEST_POST, STRING_c_str(registration_path), request_headers, NULL, content);
 
                     if (result == 0)
                     {
@@ -804,7 +963,7 @@ static int prov_sc_query_records(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client,
                         char* new_cont_token = NULL;
                         PROVISIONING_QUERY_TYPE type;
 
-                        if (get_response_headers(prov_client, &new_cont_token, &resp_type) != 0)
+                        if (get_response_headers(prov_client->response_headers, &new_cont_token, &resp_type) != 0)
                         {
                             LogError("Failure reading response headers");
                             result = MU_FAILURE;
@@ -838,163 +997,930 @@ static int prov_sc_query_records(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client,
     return result;
 }
 
-//Exposed functions below
-
-void prov_sc_destroy(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client)
+static void on_ll_http_connected(void* callback_ctx, HTTP_CALLBACK_REASON connect_result)
 {
-    if (prov_client != NULL)
+    if (callback_ctx != NULL)
     {
-        free(prov_client->provisioning_service_uri);
-        free(prov_client->key_name);
-        free(prov_client->access_key);
-        free(prov_client->response);
-        HTTPHeaders_Free(prov_client->response_headers);
-        free(prov_client->certificate);
-        free(prov_client);
+        LL_CONNECTION* connection = (LL_CONNECTION*)callback_ctx;
+        if (connect_result == HTTP_CALLBACK_REASON_OK)
+        {
+            connection->http_state = HTTP_STATE_CONNECTED;
+        }
+        else
+        {
+            connection->http_state = HTTP_STATE_ERROR;
+        }
     }
 }
 
-PROVISIONING_SERVICE_CLIENT_HANDLE prov_sc_create_from_connection_string(const char* conn_string)
+static void on_ll_http_error(void* callback_ctx, HTTP_CALLBACK_REASON error_result)
 {
-    PROV_SERVICE_CLIENT* result;
+    LogError("Failure encountered in http %d", error_result);
+    if (callback_ctx != NULL)
+    {
+        LL_CONNECTION* connection = (LL_CONNECTION*)callback_ctx;
+        connection->http_state = HTTP_STATE_ERROR;
+    }
+}
 
-    if (conn_string == NULL)
+static void on_ll_http_reply_recv(void* callback_ctx, HTTP_CALLBACK_REASON request_result, const unsigned char* content, size_t content_len, unsigned int status_code, HTTP_HEADERS_HANDLE responseHeadersHandle)
+{
+    LL_CONNECTION* connection = (LL_CONNECTION*)callback_ctx;
+    if (connection == NULL || connection->request == NULL)
     {
-        LogError("Input parameter is NULL: conn_string");
-        result = NULL;
+        LogError("Invalid callback context");
     }
     else
     {
-        STRING_HANDLE cs_string;
-        if ((cs_string = STRING_construct(conn_string)) == NULL)
-        {
-            LogError("STRING_construct failed");
-            result = NULL;
-        }
-        else
-        {
-            MAP_HANDLE connection_string_values_map;
-            if ((connection_string_values_map = connectionstringparser_parse(cs_string)) == NULL)
-            {
-                LogError("Tokenizing conn_string failed");
-                result = NULL;
-            }
-            else
-            {
-                const char* hostname = NULL;
-                const char* key_name = NULL;
-                const char* key = NULL;
+        LL_REQUEST* request = connection->request;
+        request->reply_received = (request_result == HTTP_CALLBACK_REASON_OK);
+        request->status_code = status_code;
+        store_reply(content, content_len, responseHeadersHandle, &request->response, &request->response_headers);
 
-                if ((hostname = Map_GetValueFromKey(connection_string_values_map, IOTHUBHOSTNAME)) == NULL)
-                {
-                    LogError("Couldn't find %s in conn_string", IOTHUBHOSTNAME);
-                    result = NULL;
-                }
-                else if ((key_name = Map_GetValueFromKey(connection_string_values_map, IOTHUBSHAREDACESSKEYNAME)) == NULL)
-                {
-                    LogError("Couldn't find %s in conn_string", IOTHUBSHAREDACESSKEYNAME);
-                    result = NULL;
-                }
-                else if ((key = Map_GetValueFromKey(connection_string_values_map, IOTHUBSHAREDACESSKEY)) == NULL)
-                {
-                    LogError("Couldn't find %s in conn_string", IOTHUBSHAREDACESSKEY);
-                    result = NULL;
-                }
-                if (hostname == NULL || key_name == NULL || key == NULL)
-                {
-                    LogError("invalid parameter hostname: %p, key_name: %p, key: %p", hostname, key_name, key);
-                    result = NULL;
-                }
-                else if ((result = malloc(sizeof(PROV_SERVICE_CLIENT))) == NULL)
-                {
-                    LogError("Allocation of provisioning service client failed");
-                    result = NULL;
-                }
-                else
-                {
-                    memset(result, 0, sizeof(PROV_SERVICE_CLIENT));
-                    if (mallocAndStrcpy_s(&result->provisioning_service_uri, hostname) != 0)
-                    {
-                        LogError("Failure allocating of provisioning service uri");
-                        prov_sc_destroy(result);
-                        result = NULL;
-                    }
-                    else if (mallocAndStrcpy_s(&result->key_name, key_name) != 0)
-                    {
-                        LogError("Failure allocating of keyname");
-                        prov_sc_destroy(result);
-                        result = NULL;
-                    }
-                    else if (mallocAndStrcpy_s(&result->access_key, key) != 0)
-                    {
-                        LogError("Failure allocating of access key");
-                        prov_sc_destroy(result);
-                        result = NULL;
-                    }
-                    else
-                    {
-                        result->tracing = TRACING_STATUS_OFF;
-                    }
-                }
-                Map_Destroy(connection_string_values_map);
-            }
-        }
-        STRING_delete(cs_string);
+        //the status code is only looked at when the request completes
+        connection->http_state = request->reply_received ? HTTP_STATE_REQUEST_RECV : HTTP_STATE_ERROR;
     }
-    return result;
 }
 
-void prov_sc_set_trace(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, TRACING_STATUS status)
+static void close_ll_connection(LL_CONNECTION* connection)
 {
-    if (prov_client != NULL)
+    if (connection->http_client != NULL)
     {
-        prov_client->tracing = status;
+        uhttp_client_close(connection->http_client, NULL, NULL);
+        uhttp_client_destroy(connection->http_client);
+        connection->http_client = NULL;
     }
+    connection->http_state = HTTP_STATE_DISCONNECTED;
 }
 
-int prov_sc_set_certificate(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, const char* certificate)
+static void close_idle_ll_connections(PROV_SERVICE_CLIENT* prov_client)
 {
-    int result = 0;
-
-    if (prov_client == NULL)
-    {
-        LogError("Invalid prov_client");
-        result = MU_FAILURE;
-    }
-    else if (certificate == NULL)
-    {
-        free(prov_client->certificate);
-        prov_client->certificate = NULL;
-    }
-    else if (mallocAndStrcpy_overwrite(&prov_client->certificate, (char*)certificate) != 0)
+    if (prov_client->ll_connections != NULL)
     {
-        LogError("Failed allocating memory for certificate");
-        result = MU_FAILURE;
+        for (size_t index = 0; index < prov_client->ll_max_connections; index++)
+        {
+            if (prov_client->ll_connections[index].request == NULL)
+            {
+                close_ll_connection(&prov_client->ll_connections[index]);
+            }
+        }
     }
+}
 
-    return result;
+static void clear_ll_reply(LL_REQUEST* request)
+{
+    request->reply_received = false;
+    request->status_code = 0;
+    free(request->response);
+    request->response = NULL;
+    HTTPHeaders_Free(request->response_headers);
+    request->response_headers = NULL;
 }
 
-int prov_sc_set_proxy(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, HTTP_PROXY_OPTIONS* proxy_options)
+static void destroy_ll_request(LL_REQUEST* request)
 {
-    int result = 0;
+    clear_ll_reply(request);
+    STRING_delete(request->registration_path);
+    free(request->etag);
+    free(request->content);
+    free(request->cont_token);
+    free(request);
+}
 
-    if (prov_client == NULL)
-    {
-        LogError("Invalid prov_client");
-        result = MU_FAILURE;
-    }
-    else if (proxy_options == NULL)
+static LL_REQUEST* create_ll_request(LL_REQUEST_TYPE type, HTTP_CLIENT_REQUEST_TYPE operation, const char* path_format, const char* id, const char* etag, void* user_ctx)
+{
+    LL_REQUEST* result;
+
+    if ((result = malloc(sizeof(LL_REQUEST))) == NULL)
     {
-        LogError("Invalid proxy options");
-        result = MU_FAILURE;
+        LogError("Failure allocating request");
     }
     else
     {
-        if (proxy_options->host_address == NULL)
+        memset(result, 0, sizeof(LL_REQUEST));
+        result->type = type;
+        result->operation = operation;
+        result->user_ctx = user_ctx;
+
+        if ((result->registration_path = create_registration_path(path_format, id)) == NULL)
         {
-            LogError("Null host address in proxy options");
-            result = MU_FAILURE;
+            LogError("Failed to construct a registration path");
+            free(result);
+            result = NULL;
+        }
+        else if (etag != NULL && mallocAndStrcpy_s(&result->etag, etag) != 0)
+        {
+            LogError("Failed copying etag");
+            destroy_ll_request(result);
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+static void queue_ll_request(PROV_SERVICE_CLIENT* prov_client, LL_REQUEST* request)
+{
+    request->next = NULL;
+    if (prov_client->ll_queue_tail == NULL)
+    {
+        prov_client->ll_queue_head = request;
+    }
+    else
+    {
+        prov_client->ll_queue_tail->next = request;
+    }
+    prov_client->ll_queue_tail = request;
+    prov_client->ll_pending_count++;
+}
+
+static void complete_ll_request(PROV_SERVICE_CLIENT* prov_client, LL_REQUEST* request, PROV_SC_LL_RESULT result)
+{
+    if (result == PROV_SC_LL_RESULT_OK && !request->reply_received)
+    {
+        result = PROV_SC_LL_RESULT_ERROR;
+    }
+    else if (result == PROV_SC_LL_RESULT_OK && (request->status_code < 200 || request->status_code > 299))
+    {
+        LogError("Provisioning Service replied with status %u", request->status_code);
+        result = PROV_SC_LL_RESULT_HTTP_ERROR;
+    }
+
+    switch (request->type)
+    {
+        case LL_REQUEST_RECORD:
+        {
+            void* handle = NULL;
+            if (result == PROV_SC_LL_RESULT_OK && (handle = request->deserializeFromJson(request->response)) == NULL)
+            {
+                LogError("Failure constructing new structure from json response");
+                result = PROV_SC_LL_RESULT_ERROR;
+            }
+            request->record_callback(result, handle, request->user_ctx);
+            break;
+        }
+        case LL_REQUEST_DELETE:
+        {
+            if (request->delete_callback != NULL)
+            {
+                request->delete_callback(result, request->user_ctx);
+            }
+            break;
+        }
+        case LL_REQUEST_BULK_OPERATION:
+        {
+            PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+            if (result == PROV_SC_LL_RESULT_OK && (bulk_res = bulkOperationResult_deserializeFromJson(request->response)) == NULL)
+            {
+                LogError("Failure deserializing bulk operation result");
+                result = PROV_SC_LL_RESULT_ERROR;
+            }
+            request->bulk_callback(result, bulk_res, request->user_ctx);
+            break;
+        }
+        case LL_REQUEST_QUERY:
+        {
+            PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+            char* cont_token = NULL;
+            if (result == PROV_SC_LL_RESULT_OK)
+            {
+                const char* resp_type = NULL;
+                PROVISIONING_QUERY_TYPE type;
+
+                if (get_response_headers(request->response_headers, &cont_token, &resp_type) != 0)
+                {
+                    LogError("Failure reading response headers");
+                    result = PROV_SC_LL_RESULT_ERROR;
+                }
+                else if ((type = queryType_stringToEnum(resp_type)) == QUERY_TYPE_INVALID)
+                {
+                    LogError("Failure to parse response type");
+                    result = PROV_SC_LL_RESULT_ERROR;
+                }
+                else if ((query_resp = queryResponse_deserializeFromJson(request->response, type)) == NULL)
+                {
+                    LogError("Failure deserializing query response");
+                    result = PROV_SC_LL_RESULT_ERROR;
+                }
+            }
+            request->query_callback(result, query_resp, cont_token, request->user_ctx);
+            free(cont_token);
+            break;
+        }
+    }
+
+    prov_client->ll_pending_count--;
+    destroy_ll_request(request);
+}
+
+static void finish_ll_request(PROV_SERVICE_CLIENT* prov_client, LL_CONNECTION* connection)
+{
+    LL_REQUEST* request = connection->request;
+    bool keep_connection = request->reply_received && connection->http_state == HTTP_STATE_REQUEST_RECV && prov_client->keep_alive_secs > 0;
+
+    connection->request = NULL;
+    HTTPHeaders_Free(connection->request_headers);
+    connection->request_headers = NULL;
+
+    if (keep_connection)
+    {
+        connection->http_state = HTTP_STATE_CONNECTED;
+    }
+    else
+    {
+        close_ll_connection(connection);
+    }
+
+    if (!request->reply_received && request->on_reused_connection && !request->is_retry && (!request->is_sent || is_request_resendable(request->operation, request->etag)))
+    {
+        // The service may have closed the kept connection while it was idle, send the request again ahead of the queue
+        LogInfo("Request failed on a kept connection, reconnecting");
+        clear_ll_reply(request);
+        request->is_retry = true;
+        request->next = prov_client->ll_queue_head;
+        prov_client->ll_queue_head = request;
+        if (prov_client->ll_queue_tail == NULL)
+        {
+            prov_client->ll_queue_tail = request;
+        }
+    }
+    else
+    {
+        complete_ll_request(prov_client, request, PROV_SC_LL_RESULT_OK);
+    }
+}
+
+static int send_ll_request(PROV_SERVICE_CLIENT* prov_client, LL_CONNECTION* connection)
+{
+    int result;
+    LL_REQUEST* request = connection->request;
+    size_t content_len = (request->content == NULL) ? 0 : strlen(request->content);
+
+    if ((connection->request_headers = construct_http_headers(prov_client, request->etag, request->operation)) == NULL)
+    {
+        LogError("Failure constructing http headers");
+        result = MU_FAILURE;
+    }
+    else if (request->type == LL_REQUEST_QUERY && add_query_headers(connection->request_headers, request->page_size, request->cont_token) != 0)
+    {
+        LogError("Failure adding query headers");
+        result = MU_FAILURE;
+    }
+    else if (uhttp_client_execute_request(connection->http_client, request->operation, STRING_c_str(request->registration_path), connection->request_headers, (unsigned char*)request->content, content_len, on_ll_http_reply_recv, connection) != HTTP_CLIENT_OK)
+    {
+        LogError("Failure executing http request");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        connection->http_state = HTTP_STATE_REQUEST_SENT;
+        connection->last_request_time = prov_client->request_time;
+        request->is_sent = true;
+        result = 0;
+    }
+
+    return result;
+}
+
+static void start_ll_request(PROV_SERVICE_CLIENT* prov_client, LL_CONNECTION* connection)
+{
+    LL_REQUEST* request = prov_client->ll_queue_head;
+
+    prov_client->ll_queue_head = request->next;
+    if (prov_client->ll_queue_head == NULL)
+    {
+        prov_client->ll_queue_tail = NULL;
+    }
+    request->next = NULL;
+    request->on_reused_connection = (connection->http_client != NULL);
+    request->is_sent = false;
+    connection->request = request;
+
+    if (connection->http_client == NULL)
+    {
+        if ((connection->http_client = connect_to_service(prov_client, on_ll_http_error, on_ll_http_connected, connection)) == NULL)
+        {
+            LogError("Failed connecting to service");
+            connection->http_state = HTTP_STATE_ERROR;
+        }
+        else
+        {
+            connection->http_state = HTTP_STATE_CONNECTING;
+        }
+    }
+}
+
+static void process_ll_connection(PROV_SERVICE_CLIENT* prov_client, LL_CONNECTION* connection)
+{
+    if (connection->http_client != NULL)
+    {
+        uhttp_client_dowork(connection->http_client);
+    }
+
+    if (connection->request != NULL)
+    {
+        if (connection->http_state == HTTP_STATE_CONNECTED && send_ll_request(prov_client, connection) != 0)
+        {
+            connection->http_state = HTTP_STATE_ERROR;
+        }
+
+        if (connection->http_state == HTTP_STATE_REQUEST_RECV || connection->http_state == HTTP_STATE_ERROR)
+        {
+            finish_ll_request(prov_client, connection);
+        }
+    }
+}
+
+static int prov_sc_ll_create_or_update_record(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, void* handle, HANDLE_FUNCTION_VECTOR vector, const char* path_format, LL_RECORD_CALLBACK record_callback, void* user_ctx)
+{
+    int result;
+
+    if (prov_client == NULL || handle == NULL || record_callback == NULL)
+    {
+        LogError("Invalid parameter prov_client: %p, handle: %p or NULL callback", prov_client, handle);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        char* content;
+        const char* id;
+        LL_REQUEST* request;
+
+        if ((content = vector.serializeToJson(handle)) == NULL)
+        {
+            LogError("Failure serializing enrollment");
+            result = MU_FAILURE;
+        }
+        else if ((id = vector.getId(handle)) == NULL)
+        {
+            LogError("Given model does not have a valid ID");
+            free(content);
+            result = MU_FAILURE;
+        }
+        else if ((request = create_ll_request(LL_REQUEST_RECORD, HTTP_CLIENT_REQUEST_PUT, path_format, id, vector.getEtag(handle), user_ctx)) == NULL)
+        {
+            LogError("Failure creating request");
+            free(content);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            request->content = content;
+            request->deserializeFromJson = vector.deserializeFromJson;
+            request->record_callback = record_callback;
+            queue_ll_request(prov_client, request);
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int prov_sc_ll_delete_record_by_param(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, const char* id, const char* etag, const char* path_format, PROV_SC_LL_DELETE_CALLBACK delete_callback, void* user_ctx)
+{
+    int result;
+
+    if (prov_client == NULL || id == NULL)
+    {
+        LogError("Invalid parameter prov_client: %p, id: %p", prov_client, id);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        LL_REQUEST* request;
+        if ((request = create_ll_request(LL_REQUEST_DELETE, HTTP_CLIENT_REQUEST_DELETE, path_format, id, etag, user_ctx)) == NULL)
+        {
+            LogError("Failure creating request");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            request->delete_callback = delete_callback;
+            queue_ll_request(prov_client, request);
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int prov_sc_ll_get_record(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, const char* id, HANDLE_FUNCTION_VECTOR vector, const char* path_format, LL_RECORD_CALLBACK record_callback, void* user_ctx)
+{
+    int result;
+
+    if (prov_client == NULL || id == NULL || record_callback == NULL)
+    {
+        LogError("Invalid parameter prov_client: %p, id: %p or NULL callback", prov_client, id);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        LL_REQUEST* request;
+        if ((request = create_ll_request(LL_REQUEST_RECORD, HTTP_CLIENT_REQUEST_GET, path_format, id, NULL, user_ctx)) == NULL)
+        {
+            LogError("Failure creating request");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            request->deserializeFromJson = vector.deserializeFromJson;
+            request->record_callback = record_callback;
+            queue_ll_request(prov_client, request);
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int prov_sc_ll_run_bulk_operation(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_BULK_OPERATION* bulk_op, const char* path_format, PROV_SC_LL_BULK_OPERATION_CALLBACK bulk_callback, void* user_ctx)
+{
+    int result;
+
+    if (prov_client == NULL || bulk_op == NULL || bulk_callback == NULL)
+    {
+        LogError("Invalid parameter prov_client: %p, bulk_op: %p or NULL callback", prov_client, bulk_op);
+        result = MU_FAILURE;
+    }
+    else if (bulk_op->version != PROVISIONING_BULK_OPERATION_VERSION_1)
+    {
+        LogError("Invalid Bulk Op Version #");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        char* content;
+        LL_REQUEST* request;
+
+        if ((content = bulkOperation_serializeToJson(bulk_op)) == NULL)
+        {
+            LogError("Failure serializing bulk operation");
+            result = MU_FAILURE;
+        }
+        else if ((request = create_ll_request(LL_REQUEST_BULK_OPERATION, HTTP_CLIENT_REQUEST_POST, path_format, NULL, NULL, user_ctx)) == NULL)
+        {
+            LogError("Failure creating request");
+            free(content);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            request->content = content;
+            request->bulk_callback = bulk_callback;
+            queue_ll_request(prov_client, request);
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int prov_sc_ll_query_records(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec, const char* cont_token, const char* path_format, PROV_SC_LL_QUERY_CALLBACK query_callback, void* user_ctx)
+{
+    int result;
+
+    if (prov_client == NULL || query_callback == NULL)
+    {
+        LogError("Invalid parameter prov_client: %p or NULL callback", prov_client);
+        result = MU_FAILURE;
+    }
+    else if (query_spec == NULL || query_spec->version != PROVISIONING_QUERY_SPECIFICATION_VERSION_1)
+    {
+        LogError("Invalid Query details");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        char* content = NULL;
+        LL_REQUEST* request;
+
+        //do not serialize the query specification if there is no query_string (i.e. DRS query)
+        if ((query_spec->query_string != NULL) && ((content = querySpecification_serializeToJson(query_spec)) == NULL))
+        {
+            LogError("Failure serializing query specification");
+            result = MU_FAILURE;
+        }
+        else if ((request = create_ll_request(LL_REQUEST_QUERY, HTTP_CLIENT_REQUEST_POST, path_format, query_spec->registration_id, NULL, user_ctx)) == NULL)
+        {
+            LogError("Failure creating request");
+            free(content);
+            result = MU_FAILURE;
+        }
+        else if (cont_token != NULL && mallocAndStrcpy_s(&request->cont_token, cont_token) != 0)
+        {
+            LogError("Failed copying continuation token");
+            destroy_ll_request(request);
+            free(content);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            request->content = content;
+            request->page_size = query_spec->page_size;
+            request->query_callback = query_callback;
+            queue_ll_request(prov_client, request);
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static void on_bulk_chunk_complete(PROV_SC_LL_RESULT result, PROVISIONING_BULK_OPERATION_RESULT* chunk_res, void* user_ctx)
+{
+    BULK_OPERATION_CHUNK* chunk = (BULK_OPERATION_CHUNK*)user_ctx;
+    LARGE_BULK_OPERATION* large_op = chunk->large_op;
+
+    const char* error_status;
+
+    if (result != PROV_SC_LL_RESULT_OK)
+    {
+        LogError("Bulk operation chunk at enrollment %lu failed with result %d", (unsigned long)chunk->first_index, (int)result);
+        error_status = BULK_CHUNK_FAILED_STATUS;
+    }
+    else if (bulkOperationResult_merge(large_op->bulk_res, chunk_res, &chunk->chunk_op, chunk->first_index) != 0)
+    {
+        LogError("Failure merging bulk operation chunk at enrollment %lu", (unsigned long)chunk->first_index);
+        error_status = BULK_CHUNK_NOT_MERGED_STATUS;
+    }
+    else
+    {
+        error_status = NULL;
+    }
+
+    if (error_status != NULL)
+    {
+        //the enrollments of the chunk are reported at their place in the caller's bulk operation
+        if (bulkOperationResult_addNotAppliedErrors(large_op->bulk_res, large_op->bulk_op, chunk->first_index, chunk->chunk_op.num_enrollments, error_status) != 0)
+        {
+            LogError("Failure reporting the enrollments of bulk operation chunk at enrollment %lu", (unsigned long)chunk->first_index);
+            large_op->is_incomplete = true;
+        }
+        large_op->has_failed = true;
+    }
+
+    bulkOperationResult_free(chunk_res);
+    large_op->chunks_in_flight--;
+    free(chunk);
+}
+
+static int queue_bulk_chunk(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, LARGE_BULK_OPERATION* large_op, size_t first_index, size_t num_enrollments)
+{
+    int result;
+    BULK_OPERATION_CHUNK* chunk;
+
+    if ((chunk = malloc(sizeof(BULK_OPERATION_CHUNK))) == NULL)
+    {
+        LogError("Failure allocating bulk operation chunk");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        //the chunk only points into the caller's enrollments, it is serialized when queued
+        chunk->large_op = large_op;
+        chunk->chunk_op = *large_op->bulk_op;
+        chunk->chunk_op.enrollments.ie = &large_op->bulk_op->enrollments.ie[first_index];
+        chunk->chunk_op.num_enrollments = num_enrollments;
+        chunk->first_index = first_index;
+
+        if (prov_sc_ll_run_bulk_operation(prov_client, &chunk->chunk_op, INDV_ENROLL_BULK_PATH_FMT, on_bulk_chunk_complete, chunk) != 0)
+        {
+            LogError("Failure queueing bulk operation chunk at enrollment %lu", (unsigned long)first_index);
+            free(chunk);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            large_op->chunks_in_flight++;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static void destroy_query_iterator(PROV_SC_QUERY_ITERATOR* iterator)
+{
+    queryResponse_free(iterator->page);
+    queryResponse_free(iterator->next_page);
+    free(iterator->cont_token);
+    free(iterator->query_string);
+    free(iterator->registration_id);
+    free(iterator);
+}
+
+static void on_query_page_complete(PROV_SC_LL_RESULT result, PROVISIONING_QUERY_RESPONSE* query_resp, const char* cont_token, void* user_ctx)
+{
+    PROV_SC_QUERY_ITERATOR* iterator = (PROV_SC_QUERY_ITERATOR*)user_ctx;
+
+    iterator->page_in_flight = false;
+    if (iterator->is_destroyed)
+    {
+        queryResponse_free(query_resp);
+        destroy_query_iterator(iterator);
+    }
+    else if (result != PROV_SC_LL_RESULT_OK)
+    {
+        LogError("Query page failed with result %d", (int)result);
+        iterator->has_failed = true;
+    }
+    else if (cont_token != NULL && mallocAndStrcpy_s(&iterator->cont_token, cont_token) != 0)
+    {
+        LogError("Failed copying continuation token");
+        queryResponse_free(query_resp);
+        iterator->has_failed = true;
+    }
+    else
+    {
+        iterator->next_page = query_resp;
+    }
+}
+
+static int queue_query_page(PROV_SC_QUERY_ITERATOR* iterator)
+{
+    int result;
+
+    if (prov_sc_ll_query_records(iterator->prov_client, &iterator->query_spec, iterator->cont_token, iterator->path_format, on_query_page_complete, iterator) != 0)
+    {
+        LogError("Failure queueing query page");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        iterator->page_in_flight = true;
+        result = 0;
+    }
+
+    //the request keeps its own copy of the continuation token
+    free(iterator->cont_token);
+    iterator->cont_token = NULL;
+
+    return result;
+}
+
+static void take_query_record(PROVISIONING_QUERY_RESPONSE* page, size_t index, PROVISIONING_QUERY_RECORD* record)
+{
+    //the record moves to the caller, queryResponse_free skips the emptied slot
+    record->record_type = page->response_arr_type;
+    if (page->response_arr_type == QUERY_TYPE_INDIVIDUAL_ENROLLMENT)
+    {
+        record->record.ie = page->response_arr.ie[index];
+        page->response_arr.ie[index] = NULL;
+    }
+    else if (page->response_arr_type == QUERY_TYPE_ENROLLMENT_GROUP)
+    {
+        record->record.eg = page->response_arr.eg[index];
+        page->response_arr.eg[index] = NULL;
+    }
+    else
+    {
+        record->record.drs = page->response_arr.drs[index];
+        page->response_arr.drs[index] = NULL;
+    }
+}
+
+static int create_ll_connections(PROV_SERVICE_CLIENT* prov_client)
+{
+    int result;
+
+    if ((prov_client->ll_connections = malloc(prov_client->ll_max_connections * sizeof(LL_CONNECTION))) == NULL)
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        memset(prov_client->ll_connections, 0, prov_client->ll_max_connections * sizeof(LL_CONNECTION));
+        result = 0;
+    }
+
+    return result;
+}
+
+static void destroy_ll_requests(PROV_SERVICE_CLIENT* prov_client)
+{
+    if (prov_client->ll_connections != NULL)
+    {
+        for (size_t index = 0; index < prov_client->ll_max_connections; index++)
+        {
+            LL_CONNECTION* connection = &prov_client->ll_connections[index];
+            LL_REQUEST* request = connection->request;
+
+            close_ll_connection(connection);
+            if (request != NULL)
+            {
+                connection->request = NULL;
+                HTTPHeaders_Free(connection->request_headers);
+                connection->request_headers = NULL;
+                complete_ll_request(prov_client, request, PROV_SC_LL_RESULT_DESTROYED);
+            }
+        }
+        free(prov_client->ll_connections);
+        prov_client->ll_connections = NULL;
+    }
+
+    while (prov_client->ll_queue_head != NULL)
+    {
+        LL_REQUEST* request = prov_client->ll_queue_head;
+        prov_client->ll_queue_head = request->next;
+        complete_ll_request(prov_client, request, PROV_SC_LL_RESULT_DESTROYED);
+    }
+    prov_client->ll_queue_tail = NULL;
+}
+
+//Exposed functions below
+
+void prov_sc_destroy(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client)
+{
+    if (prov_client != NULL)
+    {
+        disconnect_from_service(prov_client);
+        destroy_ll_requests(prov_client);
+        free(prov_client->provisioning_service_uri);
+        free(prov_client->key_name);
+        free(prov_client->access_key);
+        free(prov_client->response);
+        HTTPHeaders_Free(prov_client->response_headers);
+        free(prov_client->certificate);
+        free(prov_client);
+    }
+}
+
+PROVISIONING_SERVICE_CLIENT_HANDLE prov_sc_create_from_connection_string(const char* conn_string)
+{
+    PROV_SERVICE_CLIENT* result;
+
+    if (conn_string == NULL)
+    {
+        LogError("Input parameter is NULL: conn_string");
+        result = NULL;
+    }
+    else
+    {
+        STRING_HANDLE cs_string;
+        if ((cs_string = STRING_construct(conn_string)) == NULL)
+        {
+            LogError("STRING_construct failed");
+            result = NULL;
+        }
+        else
+        {
+            MAP_HANDLE connection_string_values_map;
+            if ((connection_string_values_map = connectionstringparser_parse(cs_string)) == NULL)
+            {
+                LogError("Tokenizing conn_string failed");
+                result = NULL;
+            }
+            else
+            {
+                const char* hostname = NULL;
+                const char* key_name = NULL;
+                const char* key = NULL;
+
+                if ((hostname = Map_GetValueFromKey(connection_string_values_map, IOTHUBHOSTNAME)) == NULL)
+                {
+                    LogError("Couldn't find %s in conn_string", IOTHUBHOSTNAME);
+                    result = NULL;
+                }
+                else if ((key_name = Map_GetValueFromKey(connection_string_values_map, IOTHUBSHAREDACESSKEYNAME)) == NULL)
+                {
+                    LogError("Couldn't find %s in conn_string", IOTHUBSHAREDACESSKEYNAME);
+                    result = NULL;
+                }
+                else if ((key = Map_GetValueFromKey(connection_string_values_map, IOTHUBSHAREDACESSKEY)) == NULL)
+                {
+                    LogError("Couldn't find %s in conn_string", IOTHUBSHAREDACESSKEY);
+                    result = NULL;
+                }
+                if (hostname == NULL || key_name == NULL || key == NULL)
+                {
+                    LogError("invalid parameter hostname: %p, key_name: %p, key: %p", hostname, key_name, key);
+                    result = NULL;
+                }
+                else if ((result = malloc(sizeof(PROV_SERVICE_CLIENT))) == NULL)
+                {
+                    LogError("Allocation of provisioning service client failed");
+                    result = NULL;
+                }
+                else
+                {
+                    memset(result, 0, sizeof(PROV_SERVICE_CLIENT));
+                    if (mallocAndStrcpy_s(&result->provisioning_service_uri, hostname) != 0)
+                    {
+                        LogError("Failure allocating of provisioning service uri");
+                        prov_sc_destroy(result);
+                        result = NULL;
+                    }
+                    else if (mallocAndStrcpy_s(&result->key_name, key_name) != 0)
+                    {
+                        LogError("Failure allocating of keyname");
+                        prov_sc_destroy(result);
+                        result = NULL;
+                    }
+                    else if (mallocAndStrcpy_s(&result->access_key, key) != 0)
+                    {
+                        LogError("Failure allocating of access key");
+                        prov_sc_destroy(result);
+                        result = NULL;
+                    }
+                    else
+                    {
+                        result->tracing = TRACING_STATUS_OFF;
+                        result->keep_alive_secs = DEFAULT_KEEP_ALIVE_SECS;
+                        result->ll_max_connections = DEFAULT_LL_MAX_CONNECTIONS;
+                    }
+                }
+                Map_Destroy(connection_string_values_map);
+            }
+        }
+        STRING_delete(cs_string);
+    }
+    return result;
+}
+
+void prov_sc_set_trace(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, TRACING_STATUS status)
+{
+    if (prov_client != NULL)
+    {
+        // The option is applied when the next connection is opened
+        disconnect_from_service(prov_client);
+        close_idle_ll_connections(prov_client);
+        prov_client->tracing = status;
+    }
+}
+
+int prov_sc_set_keep_alive(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, size_t idle_timeout_secs)
+{
+    int result;
+
+    if (prov_client == NULL)
+    {
+        LogError("Invalid prov_client");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (idle_timeout_secs == 0)
+        {
+            disconnect_from_service(prov_client);
+            close_idle_ll_connections(prov_client);
+        }
+        prov_client->keep_alive_secs = idle_timeout_secs;
+        result = 0;
+    }
+
+    return result;
+}
+
+int prov_sc_set_certificate(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, const char* certificate)
+{
+    int result = 0;
+
+    if (prov_client == NULL)
+    {
+        LogError("Invalid prov_client");
+        result = MU_FAILURE;
+    }
+    else if (certificate == NULL)
+    {
+        disconnect_from_service(prov_client);
+        close_idle_ll_connections(prov_client);
+        free(prov_client->certificate);
+        prov_client->certificate = NULL;
+    }
+    else if (mallocAndStrcpy_overwrite(&prov_client->certificate, (char*)certificate) != 0)
+    {
+        LogError("Failed allocating memory for certificate");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        disconnect_from_service(prov_client);
+        close_idle_ll_connections(prov_client);
+    }
+
+    return result;
+}
+
+int prov_sc_set_proxy(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, HTTP_PROXY_OPTIONS* proxy_options)
+{
+    int result = 0;
+
+    if (prov_client == NULL)
+    {
+        LogError("Invalid prov_client");
+        result = MU_FAILURE;
+    }
+    else if (proxy_options == NULL)
+    {
+        LogError("Invalid proxy options");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (proxy_options->host_address == NULL)
+        {
+            LogError("Null host address in proxy options");
+            result = MU_FAILURE;
         }
         else if (((proxy_options->username == NULL) || (proxy_options->password == NULL))
             && (proxy_options->username != proxy_options->password))
@@ -1004,6 +1930,8 @@ int prov_sc_set_proxy(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, HTTP_PROXY
         }
         else
         {
+            disconnect_from_service(prov_client);
+            close_idle_ll_connections(prov_client);
             prov_client->proxy_options = proxy_options;
         }
     }
@@ -1084,4 +2012,398 @@ int prov_sc_get_enrollment_group(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client,
 int prov_sc_query_enrollment_group(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec, char** cont_token_ptr, PROVISIONING_QUERY_RESPONSE** query_resp_ptr)
 {
     return prov_sc_query_records(prov_client, query_spec, cont_token_ptr, query_resp_ptr, ENROLL_GROUP_QUERY_PATH_FMT);
-}
\ No newline at end of file
+}
+
+int prov_sc_ll_set_max_connections(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, size_t max_connections)
+{
+    int result;
+
+    if (prov_client == NULL || max_connections == 0)
+    {
+        LogError("Invalid parameter prov_client: %p, max_connections: %lu", prov_client, (unsigned long)max_connections);
+        result = MU_FAILURE;
+    }
+    else if (prov_client->ll_pending_count > 0)
+    {
+        LogError("Cannot change the connection pool while requests are pending");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (prov_client->ll_connections != NULL)
+        {
+            close_idle_ll_connections(prov_client);
+            free(prov_client->ll_connections);
+            prov_client->ll_connections = NULL;
+        }
+        prov_client->ll_max_connections = max_connections;
+        result = 0;
+    }
+
+    return result;
+}
+
+size_t prov_sc_ll_get_pending_count(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client)
+{
+    size_t result;
+
+    if (prov_client == NULL)
+    {
+        LogError("Invalid prov_client");
+        result = 0;
+    }
+    else
+    {
+        result = prov_client->ll_pending_count;
+    }
+
+    return result;
+}
+
+void prov_sc_ll_dowork(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client)
+{
+    if (prov_client == NULL)
+    {
+        LogError("Invalid prov_client");
+    }
+    else if (prov_client->ll_connections == NULL && prov_client->ll_queue_head != NULL && create_ll_connections(prov_client) != 0)
+    {
+        LogError("Failure allocating connection pool");
+    }
+    else if (prov_client->ll_connections != NULL)
+    {
+        size_t index;
+        time_t current_time = get_time(NULL);
+
+        for (index = 0; index < prov_client->ll_max_connections; index++)
+        {
+            LL_CONNECTION* connection = &prov_client->ll_connections[index];
+            process_ll_connection(prov_client, connection);
+
+            // Kept connections are let go once they have been idle long enough, before they are given another request
+            if (connection->request == NULL && connection->http_client != NULL &&
+                difftime(current_time, connection->last_request_time) >= (double)prov_client->keep_alive_secs)
+            {
+                close_ll_connection(connection);
+            }
+        }
+
+        // Kept connections first, so a handshake is only paid when every open connection is busy
+        for (index = 0; index < prov_client->ll_max_connections && prov_client->ll_queue_head != NULL; index++)
+        {
+            LL_CONNECTION* connection = &prov_client->ll_connections[index];
+            if (connection->request == NULL && connection->http_client != NULL)
+            {
+                start_ll_request(prov_client, connection);
+                process_ll_connection(prov_client, connection);
+            }
+        }
+        for (index = 0; index < prov_client->ll_max_connections && prov_client->ll_queue_head != NULL; index++)
+        {
+            LL_CONNECTION* connection = &prov_client->ll_connections[index];
+            if (connection->request == NULL && connection->http_client == NULL)
+            {
+                start_ll_request(prov_client, connection);
+                if (connection->http_state == HTTP_STATE_ERROR)
+                {
+                    finish_ll_request(prov_client, connection);
+                }
+            }
+        }
+    }
+}
+
+int prov_sc_ll_create_or_update_individual_enrollment(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, INDIVIDUAL_ENROLLMENT_HANDLE enrollment, PROV_SC_LL_INDIVIDUAL_ENROLLMENT_CALLBACK enrollment_callback, void* user_ctx)
+{
+    return prov_sc_ll_create_or_update_record(prov_client, enrollment, getVector_individualEnrollment(), INDV_ENROLL_PROVISION_PATH_FMT, (LL_RECORD_CALLBACK)enrollment_callback, user_ctx);
+}
+
+int prov_sc_ll_delete_individual_enrollment_by_param(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, const char* reg_id, const char* etag, PROV_SC_LL_DELETE_CALLBACK delete_callback, void* user_ctx)
+{
+    return prov_sc_ll_delete_record_by_param(prov_client, reg_id, etag, INDV_ENROLL_PROVISION_PATH_FMT, delete_callback, user_ctx);
+}
+
+int prov_sc_ll_get_individual_enrollment(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, const char* reg_id, PROV_SC_LL_INDIVIDUAL_ENROLLMENT_CALLBACK enrollment_callback, void* user_ctx)
+{
+    return prov_sc_ll_get_record(prov_client, reg_id, getVector_individualEnrollment(), INDV_ENROLL_PROVISION_PATH_FMT, (LL_RECORD_CALLBACK)enrollment_callback, user_ctx);
+}
+
+int prov_sc_ll_query_individual_enrollment(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec, const char* cont_token, PROV_SC_LL_QUERY_CALLBACK query_callback, void* user_ctx)
+{
+    return prov_sc_ll_query_records(prov_client, query_spec, cont_token, INDV_ENROLL_QUERY_PATH_FMT, query_callback, user_ctx);
+}
+
+int prov_sc_ll_run_individual_enrollment_bulk_operation(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_BULK_OPERATION* bulk_op, PROV_SC_LL_BULK_OPERATION_CALLBACK bulk_callback, void* user_ctx)
+{
+    return prov_sc_ll_run_bulk_operation(prov_client, bulk_op, INDV_ENROLL_BULK_PATH_FMT, bulk_callback, user_ctx);
+}
+
+int prov_sc_ll_create_or_update_enrollment_group(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, ENROLLMENT_GROUP_HANDLE enrollment, PROV_SC_LL_ENROLLMENT_GROUP_CALLBACK enrollment_callback, void* user_ctx)
+{
+    return prov_sc_ll_create_or_update_record(prov_client, enrollment, getVector_enrollmentGroup(), ENROLL_GROUP_PROVISION_PATH_FMT, (LL_RECORD_CALLBACK)enrollment_callback, user_ctx);
+}
+
+int prov_sc_ll_delete_enrollment_group_by_param(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, const char* group_id, const char* etag, PROV_SC_LL_DELETE_CALLBACK delete_callback, void* user_ctx)
+{
+    return prov_sc_ll_delete_record_by_param(prov_client, group_id, etag, ENROLL_GROUP_PROVISION_PATH_FMT, delete_callback, user_ctx);
+}
+
+int prov_sc_ll_get_enrollment_group(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, const char* group_id, PROV_SC_LL_ENROLLMENT_GROUP_CALLBACK enrollment_callback, void* user_ctx)
+{
+    return prov_sc_ll_get_record(prov_client, group_id, getVector_enrollmentGroup(), ENROLL_GROUP_PROVISION_PATH_FMT, (LL_RECORD_CALLBACK)enrollment_callback, user_ctx);
+}
+
+int prov_sc_ll_query_enrollment_group(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec, const char* cont_token, PROV_SC_LL_QUERY_CALLBACK query_callback, void* user_ctx)
+{
+    return prov_sc_ll_query_records(prov_client, query_spec, cont_token, ENROLL_GROUP_QUERY_PATH_FMT, query_callback, user_ctx);
+}
+
+int prov_sc_ll_delete_device_registration_state_by_param(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, const char* reg_id, const char* etag, PROV_SC_LL_DELETE_CALLBACK delete_callback, void* user_ctx)
+{
+    return prov_sc_ll_delete_record_by_param(prov_client, reg_id, etag, REG_STATE_PROVISION_PATH_FMT, delete_callback, user_ctx);
+}
+
+int prov_sc_ll_get_device_registration_state(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, const char* reg_id, PROV_SC_LL_DEVICE_REGISTRATION_STATE_CALLBACK reg_state_callback, void* user_ctx)
+{
+    return prov_sc_ll_get_record(prov_client, reg_id, getVector_registrationState(), REG_STATE_PROVISION_PATH_FMT, (LL_RECORD_CALLBACK)reg_state_callback, user_ctx);
+}
+
+int prov_sc_ll_query_device_registration_state(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_SPECIFICATION* query_spec, const char* cont_token, PROV_SC_LL_QUERY_CALLBACK query_callback, void* user_ctx)
+{
+    return prov_sc_ll_query_records(prov_client, query_spec, cont_token, REG_STATE_QUERY_PATH_FMT, query_callback, user_ctx);
+}
+
+int prov_sc_run_bulk_operation_large(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_BULK_OPERATION* bulk_op, PROVISIONING_BULK_OPERATION_RESULT** bulk_res_ptr)
+{
+    int result;
+
+    if (prov_client == NULL || bulk_op == NULL || bulk_res_ptr == NULL)
+    {
+        LogError("Invalid parameter prov_client: %p, bulk_op: %p, bulk_res_ptr: %p", prov_client, bulk_op, bulk_res_ptr);
+        result = MU_FAILURE;
+    }
+    else if (bulk_op->version != PROVISIONING_BULK_OPERATION_VERSION_1 || bulk_op->num_enrollments == 0 || bulk_op->enrollments.ie == NULL)
+    {
+        LogError("Invalid Bulk Op");
+        result = MU_FAILURE;
+    }
+    else if (prov_client->ll_connections == NULL && create_ll_connections(prov_client) != 0)
+    {
+        LogError("Failure allocating connection pool");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        LARGE_BULK_OPERATION large_op;
+        memset(&large_op, 0, sizeof(LARGE_BULK_OPERATION));
+        large_op.bulk_op = bulk_op;
+
+        if ((large_op.bulk_res = malloc(sizeof(PROVISIONING_BULK_OPERATION_RESULT))) == NULL)
+        {
+            LogError("Failure allocating bulk operation result");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            size_t next_index = 0;
+
+            memset(large_op.bulk_res, 0, sizeof(PROVISIONING_BULK_OPERATION_RESULT));
+            large_op.bulk_res->is_successful = true;
+
+            // Only as many chunks as there are connections are serialized at a time, and none are queued after a failure
+            while ((!large_op.has_failed && next_index < bulk_op->num_enrollments) || large_op.chunks_in_flight > 0)
+            {
+                while (!large_op.has_failed && next_index < bulk_op->num_enrollments && large_op.chunks_in_flight < prov_client->ll_max_connections)
+                {
+                    size_t num_enrollments = bulk_op->num_enrollments - next_index;
+                    if (num_enrollments > BULK_OPERATION_CHUNK_SIZE)
+                    {
+                        num_enrollments = BULK_OPERATION_CHUNK_SIZE;
+                    }
+
+                    if (queue_bulk_chunk(prov_client, &large_op, next_index, num_enrollments) != 0)
+                    {
+                        large_op.has_failed = true;
+                    }
+                    else
+                    {
+                        next_index += num_enrollments;
+                    }
+                }
+
+                if (large_op.chunks_in_flight > 0)
+                {
+                    prov_sc_ll_dowork(prov_client);
+                }
+            }
+
+            if (next_index < bulk_op->num_enrollments &&
+                bulkOperationResult_addNotAppliedErrors(large_op.bulk_res, bulk_op, next_index, bulk_op->num_enrollments - next_index, BULK_CHUNK_NOT_SENT_STATUS) != 0)
+            {
+                LogError("Failure reporting the enrollments not sent");
+                large_op.is_incomplete = true;
+            }
+
+            if (large_op.is_incomplete)
+            {
+                bulkOperationResult_free(large_op.bulk_res);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                *bulk_res_ptr = large_op.bulk_res;
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+PROV_SC_QUERY_ITERATOR_HANDLE prov_sc_query_iterator_create(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, PROVISIONING_QUERY_TYPE query_type, PROVISIONING_QUERY_SPECIFICATION* query_spec)
+{
+    PROV_SC_QUERY_ITERATOR* result;
+    const char* path_format;
+
+    if (query_type == QUERY_TYPE_INDIVIDUAL_ENROLLMENT)
+    {
+        path_format = INDV_ENROLL_QUERY_PATH_FMT;
+    }
+    else if (query_type == QUERY_TYPE_ENROLLMENT_GROUP)
+    {
+        path_format = ENROLL_GROUP_QUERY_PATH_FMT;
+    }
+    else if (query_type == QUERY_TYPE_DEVICE_REGISTRATION_STATE)
+    {
+        path_format = REG_STATE_QUERY_PATH_FMT;
+    }
+    else
+    {
+        path_format = NULL;
+    }
+
+    if (prov_client == NULL || path_format == NULL)
+    {
+        LogError("Invalid parameter prov_client: %p, query_type: %d", prov_client, (int)query_type);
+        result = NULL;
+    }
+    else if (query_spec == NULL || query_spec->version != PROVISIONING_QUERY_SPECIFICATION_VERSION_1)
+    {
+        LogError("Invalid Query details");
+        result = NULL;
+    }
+    else if ((result = malloc(sizeof(PROV_SC_QUERY_ITERATOR))) == NULL)
+    {
+        LogError("Failure allocating query iterator");
+    }
+    else
+    {
+        memset(result, 0, sizeof(PROV_SC_QUERY_ITERATOR));
+        result->prov_client = prov_client;
+        result->path_format = path_format;
+        result->query_spec = *query_spec;
+
+        if (query_spec->query_string != NULL && mallocAndStrcpy_s(&result->query_string, query_spec->query_string) != 0)
+        {
+            LogError("Failed copying query string");
+            destroy_query_iterator(result);
+            result = NULL;
+        }
+        else if (query_spec->registration_id != NULL && mallocAndStrcpy_s(&result->registration_id, query_spec->registration_id) != 0)
+        {
+            LogError("Failed copying registration id");
+            destroy_query_iterator(result);
+            result = NULL;
+        }
+        else
+        {
+            result->query_spec.query_string = result->query_string;
+            result->query_spec.registration_id = result->registration_id;
+
+            if (queue_query_page(result) != 0)
+            {
+                destroy_query_iterator(result);
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+PROV_SC_QUERY_ITERATOR_RESULT prov_sc_query_iterator_next(PROV_SC_QUERY_ITERATOR_HANDLE iterator, PROVISIONING_QUERY_RECORD* record)
+{
+    PROV_SC_QUERY_ITERATOR_RESULT result;
+
+    if (iterator == NULL || record == NULL)
+    {
+        LogError("Invalid parameter iterator: %p, record: %p", iterator, record);
+        result = PROV_SC_QUERY_ITERATOR_ERROR;
+    }
+    else
+    {
+        // Keeps the next page moving while the caller works through the current one
+        prov_sc_ll_dowork(iterator->prov_client);
+
+        while (iterator->page == NULL || iterator->next_record >= iterator->page->response_arr_size)
+        {
+            queryResponse_free(iterator->page);
+            iterator->page = NULL;
+
+            if (iterator->next_page != NULL)
+            {
+                iterator->page = iterator->next_page;
+                iterator->next_page = NULL;
+                iterator->next_record = 0;
+
+                if (iterator->cont_token != NULL && queue_query_page(iterator) != 0)
+                {
+                    iterator->has_failed = true;
+                }
+            }
+            else if (iterator->has_failed || !iterator->page_in_flight)
+            {
+                break;
+            }
+            else
+            {
+                // Also moves every other request queued on prov_client
+                prov_sc_ll_dowork(iterator->prov_client);
+                ThreadAPI_Sleep(QUERY_PAGE_WAIT_INTERVAL_IN_MS);
+            }
+        }
+
+        if (iterator->page != NULL)
+        {
+            take_query_record(iterator->page, iterator->next_record, record);
+            iterator->next_record++;
+            result = PROV_SC_QUERY_ITERATOR_RECORD;
+        }
+        else if (iterator->has_failed)
+        {
+            result = PROV_SC_QUERY_ITERATOR_ERROR;
+        }
+        else
+        {
+            result = PROV_SC_QUERY_ITERATOR_END;
+        }
+    }
+
+    return result;
+}
+
+void prov_sc_query_iterator_destroy(PROV_SC_QUERY_ITERATOR_HANDLE iterator)
+{
+    if (iterator != NULL)
+    {
+        if (iterator->page_in_flight)
+        {
+            // The page callback still points here, it frees the iterator once the request completes or prov_client is destroyed
+            iterator->is_destroyed = true;
+        }
+        else
+        {
+            destroy_query_iterator(iterator);
+        }
+    }
+}
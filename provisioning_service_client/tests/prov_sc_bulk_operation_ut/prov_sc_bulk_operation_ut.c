@@ -4,9 +4,11 @@
 #ifdef __cplusplus
 #include <cstdlib>
 #include <cstddef>
+#include <cstdint>
 #else
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
 #endif
 
 void* real_malloc(size_t size)
@@ -139,6 +141,32 @@ static void free_dummy_enrollment_list(INDIVIDUAL_ENROLLMENT_HANDLE* enrollments
     real_free(enrollments);
 }
 
+//the test enrollment handles are their own registration ids
+static const char* my_individualEnrollment_getRegistrationId(INDIVIDUAL_ENROLLMENT_HANDLE enrollment)
+{
+    return (const char*)enrollment;
+}
+
+static PROVISIONING_BULK_OPERATION_RESULT* create_dummy_result(bool is_successful, const char** registration_ids, size_t num_errors)
+{
+    PROVISIONING_BULK_OPERATION_RESULT* ret = (PROVISIONING_BULK_OPERATION_RESULT*)real_malloc(sizeof(PROVISIONING_BULK_OPERATION_RESULT));
+    memset(ret, 0, sizeof(PROVISIONING_BULK_OPERATION_RESULT));
+    ret->is_successful = is_successful;
+    if (num_errors > 0)
+    {
+        ret->errors = (PROVISIONING_BULK_OPERATION_ERROR**)real_malloc(num_errors * sizeof(PROVISIONING_BULK_OPERATION_ERROR*));
+        for (size_t i = 0; i < num_errors; i++)
+        {
+            ret->errors[i] = (PROVISIONING_BULK_OPERATION_ERROR*)real_malloc(sizeof(PROVISIONING_BULK_OPERATION_ERROR));
+            memset(ret->errors[i], 0, sizeof(PROVISIONING_BULK_OPERATION_ERROR));
+            my_mallocAndStrcpy_s(&ret->errors[i]->registration_id, registration_ids[i]);
+            ret->errors[i]->enrollment_index = SIZE_MAX;
+        }
+        ret->num_errors = num_errors;
+    }
+    return ret;
+}
+
 static void register_global_mocks()
 {
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, real_malloc);
@@ -180,11 +208,15 @@ static void register_global_mocks()
     REGISTER_GLOBAL_MOCK_HOOK(copy_json_string_field, my_copy_json_string_field);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(copy_json_string_field, MU_FAILURE);
 
+    //enrollments
+    REGISTER_GLOBAL_MOCK_HOOK(individualEnrollment_getRegistrationId, my_individualEnrollment_getRegistrationId);
+
     //types
     REGISTER_UMOCK_ALIAS_TYPE(TO_JSON_FUNCTION, void*);
     REGISTER_UMOCK_ALIAS_TYPE(FROM_JSON_FUNCTION, void*);
     REGISTER_UMOCK_ALIAS_TYPE(void**, void*);
     REGISTER_UMOCK_ALIAS_TYPE(INDIVIDUAL_ENROLLMENT_HANDLE*, void**);
+    REGISTER_UMOCK_ALIAS_TYPE(INDIVIDUAL_ENROLLMENT_HANDLE, void*);
 }
 
 BEGIN_TEST_SUITE(prov_sc_bulk_operation_ut)
@@ -686,4 +718,343 @@ TEST_FUNCTION(bulkOperationResult_free_no_errors)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
+TEST_FUNCTION(bulkOperationResult_merge_null_bulk_res)
+{
+    //arrange
+    PROVISIONING_BULK_OPERATION_RESULT* chunk_res = create_dummy_result(true, NULL, 0);
+    PROVISIONING_BULK_OPERATION chunk_op;
+    memset(&chunk_op, 0, sizeof(PROVISIONING_BULK_OPERATION));
+    umock_c_reset_all_calls();
+
+    //act
+    int res = bulkOperationResult_merge(NULL, chunk_res, &chunk_op, 0);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    bulkOperationResult_free(chunk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_merge_null_chunk_res)
+{
+    //arrange
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = create_dummy_result(true, NULL, 0);
+    PROVISIONING_BULK_OPERATION chunk_op;
+    memset(&chunk_op, 0, sizeof(PROVISIONING_BULK_OPERATION));
+    umock_c_reset_all_calls();
+
+    //act
+    int res = bulkOperationResult_merge(bulk_res, NULL, &chunk_op, 0);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_merge_null_chunk_op)
+{
+    //arrange
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = create_dummy_result(true, NULL, 0);
+    PROVISIONING_BULK_OPERATION_RESULT* chunk_res = create_dummy_result(true, NULL, 0);
+    umock_c_reset_all_calls();
+
+    //act
+    int res = bulkOperationResult_merge(bulk_res, chunk_res, NULL, 0);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+    bulkOperationResult_free(chunk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_merge_no_errors)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-0", (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-1" };
+    PROVISIONING_BULK_OPERATION chunk_op;
+    memset(&chunk_op, 0, sizeof(PROVISIONING_BULK_OPERATION));
+    chunk_op.enrollments.ie = ie_arr;
+    chunk_op.num_enrollments = 2;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = create_dummy_result(true, NULL, 0);
+    PROVISIONING_BULK_OPERATION_RESULT* chunk_res = create_dummy_result(true, NULL, 0);
+    umock_c_reset_all_calls();
+
+    //act
+    int res = bulkOperationResult_merge(bulk_res, chunk_res, &chunk_op, 10);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 0, bulk_res->num_errors);
+    ASSERT_IS_NULL(bulk_res->errors);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+    bulkOperationResult_free(chunk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_merge_unsuccessful_chunk)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-0", (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-1" };
+    PROVISIONING_BULK_OPERATION chunk_op;
+    memset(&chunk_op, 0, sizeof(PROVISIONING_BULK_OPERATION));
+    chunk_op.enrollments.ie = ie_arr;
+    chunk_op.num_enrollments = 2;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = create_dummy_result(true, NULL, 0);
+    PROVISIONING_BULK_OPERATION_RESULT* chunk_res = create_dummy_result(false, NULL, 0);
+    umock_c_reset_all_calls();
+
+    //act
+    int res = bulkOperationResult_merge(bulk_res, chunk_res, &chunk_op, 10);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_FALSE(bulk_res->is_successful);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+    bulkOperationResult_free(chunk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_merge_with_errors)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[3] = { (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-0", (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-1", (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-2" };
+    PROVISIONING_BULK_OPERATION chunk_op;
+    memset(&chunk_op, 0, sizeof(PROVISIONING_BULK_OPERATION));
+    chunk_op.enrollments.ie = ie_arr;
+    chunk_op.num_enrollments = 3;
+    const char* bulk_reg_ids[1] = { "reg-earlier" };
+    const char* chunk_reg_ids[2] = { "reg-2", "reg-0" };
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = create_dummy_result(false, bulk_reg_ids, 1);
+    PROVISIONING_BULK_OPERATION_RESULT* chunk_res = create_dummy_result(false, chunk_reg_ids, 2);
+    PROVISIONING_BULK_OPERATION_ERROR* earlier_error = bulk_res->errors[0];
+    bulk_res->errors[0]->enrollment_index = 3;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    int res = bulkOperationResult_merge(bulk_res, chunk_res, &chunk_op, 20);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_FALSE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 3, bulk_res->num_errors);
+    ASSERT_ARE_EQUAL(void_ptr, earlier_error, bulk_res->errors[0]);
+    ASSERT_ARE_EQUAL(size_t, 3, bulk_res->errors[0]->enrollment_index);
+    ASSERT_ARE_EQUAL(char_ptr, "reg-2", bulk_res->errors[1]->registration_id);
+    ASSERT_ARE_EQUAL(size_t, 22, bulk_res->errors[1]->enrollment_index);
+    ASSERT_ARE_EQUAL(char_ptr, "reg-0", bulk_res->errors[2]->registration_id);
+    ASSERT_ARE_EQUAL(size_t, 20, bulk_res->errors[2]->enrollment_index);
+    ASSERT_ARE_EQUAL(size_t, 0, chunk_res->num_errors);
+    ASSERT_IS_NULL(chunk_res->errors);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+    bulkOperationResult_free(chunk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_merge_unknown_registration_id)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-0", (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-1" };
+    PROVISIONING_BULK_OPERATION chunk_op;
+    memset(&chunk_op, 0, sizeof(PROVISIONING_BULK_OPERATION));
+    chunk_op.enrollments.ie = ie_arr;
+    chunk_op.num_enrollments = 2;
+    const char* chunk_reg_ids[1] = { "reg-unknown" };
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = create_dummy_result(true, NULL, 0);
+    PROVISIONING_BULK_OPERATION_RESULT* chunk_res = create_dummy_result(false, chunk_reg_ids, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    int res = bulkOperationResult_merge(bulk_res, chunk_res, &chunk_op, 10);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_FALSE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 1, bulk_res->num_errors);
+    ASSERT_ARE_EQUAL(size_t, SIZE_MAX, bulk_res->errors[0]->enrollment_index);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+    bulkOperationResult_free(chunk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_merge_malloc_fail)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-0", (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-1" };
+    PROVISIONING_BULK_OPERATION chunk_op;
+    memset(&chunk_op, 0, sizeof(PROVISIONING_BULK_OPERATION));
+    chunk_op.enrollments.ie = ie_arr;
+    chunk_op.num_enrollments = 2;
+    const char* bulk_reg_ids[1] = { "reg-earlier" };
+    const char* chunk_reg_ids[1] = { "reg-1" };
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = create_dummy_result(true, bulk_reg_ids, 1);
+    PROVISIONING_BULK_OPERATION_RESULT* chunk_res = create_dummy_result(false, chunk_reg_ids, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).SetReturn(NULL);
+
+    //act
+    int res = bulkOperationResult_merge(bulk_res, chunk_res, &chunk_op, 10);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 1, bulk_res->num_errors);
+    ASSERT_ARE_EQUAL(size_t, 1, chunk_res->num_errors);
+    ASSERT_IS_NOT_NULL(chunk_res->errors);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+    bulkOperationResult_free(chunk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_addNotAppliedErrors_null_bulk_res)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-0", (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-1" };
+    PROVISIONING_BULK_OPERATION bulk_op;
+    memset(&bulk_op, 0, sizeof(PROVISIONING_BULK_OPERATION));
+    bulk_op.enrollments.ie = ie_arr;
+    bulk_op.num_enrollments = 2;
+    umock_c_reset_all_calls();
+
+    //act
+    int res = bulkOperationResult_addNotAppliedErrors(NULL, &bulk_op, 0, 2, DUMMY_STRING);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+TEST_FUNCTION(bulkOperationResult_addNotAppliedErrors_out_of_range)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-0", (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-1" };
+    PROVISIONING_BULK_OPERATION bulk_op;
+    memset(&bulk_op, 0, sizeof(PROVISIONING_BULK_OPERATION));
+    bulk_op.enrollments.ie = ie_arr;
+    bulk_op.num_enrollments = 2;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = create_dummy_result(true, NULL, 0);
+    umock_c_reset_all_calls();
+
+    //act
+    int res = bulkOperationResult_addNotAppliedErrors(bulk_res, &bulk_op, 1, 2, DUMMY_STRING);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 0, bulk_res->num_errors);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_addNotAppliedErrors_success)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[3] = { (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-0", (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-1", (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-2" };
+    PROVISIONING_BULK_OPERATION bulk_op;
+    memset(&bulk_op, 0, sizeof(PROVISIONING_BULK_OPERATION));
+    bulk_op.enrollments.ie = ie_arr;
+    bulk_op.num_enrollments = 3;
+    const char* bulk_reg_ids[1] = { "reg-earlier" };
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = create_dummy_result(true, bulk_reg_ids, 1);
+    PROVISIONING_BULK_OPERATION_ERROR* earlier_error = bulk_res->errors[0];
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "reg-1"));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, DUMMY_STRING));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "reg-2"));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, DUMMY_STRING));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    int res = bulkOperationResult_addNotAppliedErrors(bulk_res, &bulk_op, 1, 2, DUMMY_STRING);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_FALSE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 3, bulk_res->num_errors);
+    ASSERT_ARE_EQUAL(void_ptr, earlier_error, bulk_res->errors[0]);
+    ASSERT_ARE_EQUAL(char_ptr, "reg-1", bulk_res->errors[1]->registration_id);
+    ASSERT_ARE_EQUAL(int, PROVISIONING_BULK_OPERATION_ERROR_CODE_NOT_APPLIED, (int)bulk_res->errors[1]->error_code);
+    ASSERT_ARE_EQUAL(char_ptr, DUMMY_STRING, bulk_res->errors[1]->error_status);
+    ASSERT_ARE_EQUAL(size_t, 1, bulk_res->errors[1]->enrollment_index);
+    ASSERT_ARE_EQUAL(char_ptr, "reg-2", bulk_res->errors[2]->registration_id);
+    ASSERT_ARE_EQUAL(size_t, 2, bulk_res->errors[2]->enrollment_index);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+}
+
+TEST_FUNCTION(bulkOperationResult_addNotAppliedErrors_error_fail)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-0", (INDIVIDUAL_ENROLLMENT_HANDLE)"reg-1" };
+    PROVISIONING_BULK_OPERATION bulk_op;
+    memset(&bulk_op, 0, sizeof(PROVISIONING_BULK_OPERATION));
+    bulk_op.enrollments.ie = ie_arr;
+    bulk_op.num_enrollments = 2;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = create_dummy_result(true, NULL, 0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "reg-0"));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, DUMMY_STRING));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    int res = bulkOperationResult_addNotAppliedErrors(bulk_res, &bulk_op, 0, 2, DUMMY_STRING);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 0, bulk_res->num_errors);
+    ASSERT_IS_NULL(bulk_res->errors);
+
+    //cleanup
+    bulkOperationResult_free(bulk_res);
+}
+
 END_TEST_SUITE(prov_sc_bulk_operation_ut);
@@ -0,0 +1,384 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Measures how fast one thread reads enrollments from the Device Provisioning Service, against the
+// in-process stand-in of uhttp and the service in uhttp_stub.c:
+//  - the blocking prov_sc_get_individual_enrollment, one request at a time
+//  - prov_sc_ll_get_individual_enrollment driven by prov_sc_ll_dowork, over one and several connections
+// and how fast it works through the records of a multi-page query, spending a fixed time on every record:
+//  - the blocking prov_sc_query_individual_enrollment, one page after the other
+//  - prov_sc_query_iterator_next, receiving the next page while the current one is processed
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/platform.h"
+
+#include "prov_service_client/provisioning_service_client.h"
+#include "prov_service_client/provisioning_sc_models_serializer.h"
+#include "uhttp_stub.h"
+
+#define REQUEST_COUNT               200
+#define DOWORK_INTERVAL_IN_MS       1
+#define QUERY_PAGE_COUNT            10
+#define QUERY_PAGE_SIZE             50
+#define RECORD_PROCESSING_IN_MS     1
+
+static const char* const STUB_CONNECTION_STRING = "HostName=benchmark.azure-devices-provisioning.net;SharedAccessKeyName=provisioningserviceowner;SharedAccessKey=AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=";
+static const char* const REGISTRATION_ID = "ll-benchmark";
+static const char* const ENDORSEMENT_KEY = "AToAAQALAAMAsgAgg3GXZ0SEs/gakMyNRqXXJP1S124GUgtk8qHaGzMUaaoABgCAAEMAEAgAAAAAAAEAxsj2gUScTk1UjuioeTlfGYZrrimExB+bScH75adUMRIi2UOMxG1kw4y+9RW/IVoMl4e620VxZad0ARX2gUqVjYO7KPVt3dyKhZS3dkcvfBisBhP1XH9B33VqHG9SHnbnQXdBUaCgKAfxome8UmBKfe+naTsE5fkvjb/do3/dD6l4sGBwFCnKRdln4XpM03zLpoHFao8zOwt8l/uP3qUIxmCYv9A7m69Ms+5/pCkTu/rK4mRDsfhZ0QLfbzVI6zQFOKF/rwsfBtFeWlWtcuJMKlXdD8TXWElTzgh7JS4qhFzreL0c1mI0GCj+Aws0usZh7dLIVPnlgZcBhgy1SSDQMQ==";
+
+static const UHTTP_STUB_CONFIG stub_config = { 100, 20, 0 };
+static const UHTTP_STUB_CONFIG query_stub_config = { 100, 20, QUERY_PAGE_COUNT };
+
+typedef struct BENCHMARK_RESULT_TAG
+{
+    size_t completed;
+    size_t succeeded;
+} BENCHMARK_RESULT;
+
+static void on_enrollment_received(PROV_SC_LL_RESULT result, INDIVIDUAL_ENROLLMENT_HANDLE enrollment, void* user_ctx)
+{
+    BENCHMARK_RESULT* benchmark_result = (BENCHMARK_RESULT*)user_ctx;
+
+    benchmark_result->completed++;
+    if (result == PROV_SC_LL_RESULT_OK)
+    {
+        benchmark_result->succeeded++;
+    }
+    individualEnrollment_destroy(enrollment);
+}
+
+static int run_blocking(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, BENCHMARK_RESULT* benchmark_result)
+{
+    int result = 0;
+    size_t i;
+
+    for (i = 0; i < REQUEST_COUNT && result == 0; i++)
+    {
+        INDIVIDUAL_ENROLLMENT_HANDLE enrollment = NULL;
+        if (prov_sc_get_individual_enrollment(prov_client, REGISTRATION_ID, &enrollment) != 0)
+        {
+            LogError("Failed getting enrollment %lu", (unsigned long)i);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            benchmark_result->completed++;
+            benchmark_result->succeeded++;
+            individualEnrollment_destroy(enrollment);
+        }
+    }
+
+    return result;
+}
+
+static int run_non_blocking(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, size_t max_connections, BENCHMARK_RESULT* benchmark_result)
+{
+    int result;
+
+    if (prov_sc_ll_set_max_connections(prov_client, max_connections) != 0)
+    {
+        LogError("Failed setting the maximum connections");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        size_t i;
+
+        result = 0;
+        for (i = 0; i < REQUEST_COUNT && result == 0; i++)
+        {
+            if (prov_sc_ll_get_individual_enrollment(prov_client, REGISTRATION_ID, on_enrollment_received, benchmark_result) != 0)
+            {
+                LogError("Failed queueing enrollment %lu", (unsigned long)i);
+                result = MU_FAILURE;
+            }
+        }
+
+        while (result == 0 && prov_sc_ll_get_pending_count(prov_client) > 0)
+        {
+            prov_sc_ll_dowork(prov_client);
+            ThreadAPI_Sleep(DOWORK_INTERVAL_IN_MS);
+        }
+    }
+
+    return result;
+}
+
+static int run_one_connection(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, BENCHMARK_RESULT* benchmark_result)
+{
+    return run_non_blocking(prov_client, 1, benchmark_result);
+}
+
+static int run_four_connections(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, BENCHMARK_RESULT* benchmark_result)
+{
+    return run_non_blocking(prov_client, 4, benchmark_result);
+}
+
+static int run_sixteen_connections(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, BENCHMARK_RESULT* benchmark_result)
+{
+    return run_non_blocking(prov_client, 16, benchmark_result);
+}
+
+static int run_query_blocking(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, BENCHMARK_RESULT* benchmark_result)
+{
+    int result = 0;
+    char* cont_token = NULL;
+    PROVISIONING_QUERY_SPECIFICATION query_spec = { 0 };
+
+    query_spec.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    query_spec.query_string = "*";
+    query_spec.page_size = QUERY_PAGE_SIZE;
+
+    do
+    {
+        PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+        if (prov_sc_query_individual_enrollment(prov_client, &query_spec, &cont_token, &query_resp) != 0)
+        {
+            LogError("Failed querying page %lu", (unsigned long)(benchmark_result->completed / QUERY_PAGE_SIZE));
+            result = MU_FAILURE;
+        }
+        else
+        {
+            size_t i;
+            for (i = 0; i < query_resp->response_arr_size; i++)
+            {
+                ThreadAPI_Sleep(RECORD_PROCESSING_IN_MS);
+                benchmark_result->completed++;
+                benchmark_result->succeeded++;
+            }
+            queryResponse_free(query_resp);
+        }
+    } while (result == 0 && cont_token != NULL);
+
+    free(cont_token);
+    return result;
+}
+
+static int run_query_iterator(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, BENCHMARK_RESULT* benchmark_result)
+{
+    int result;
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator;
+    PROVISIONING_QUERY_SPECIFICATION query_spec = { 0 };
+
+    query_spec.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    query_spec.query_string = "*";
+    query_spec.page_size = QUERY_PAGE_SIZE;
+
+    if ((iterator = prov_sc_query_iterator_create(prov_client, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, &query_spec)) == NULL)
+    {
+        LogError("Failed creating the query iterator");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        PROVISIONING_QUERY_RECORD record;
+        PROV_SC_QUERY_ITERATOR_RESULT next_result;
+
+        while ((next_result = prov_sc_query_iterator_next(iterator, &record)) == PROV_SC_QUERY_ITERATOR_RECORD)
+        {
+            ThreadAPI_Sleep(RECORD_PROCESSING_IN_MS);
+            benchmark_result->completed++;
+            benchmark_result->succeeded++;
+            individualEnrollment_destroy(record.record.ie);
+        }
+
+        if (next_result != PROV_SC_QUERY_ITERATOR_END)
+        {
+            LogError("Failed iterating over the query");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            result = 0;
+        }
+        prov_sc_query_iterator_destroy(iterator);
+    }
+
+    return result;
+}
+
+typedef struct BENCHMARK_SCENARIO_TAG
+{
+    const char* name;
+    int(*run)(PROVISIONING_SERVICE_CLIENT_HANDLE prov_client, BENCHMARK_RESULT* benchmark_result);
+} BENCHMARK_SCENARIO;
+
+static const BENCHMARK_SCENARIO scenarios[] =
+{
+    { "prov_sc_get_individual_enrollment, blocking", run_blocking },
+    { "prov_sc_ll_get_individual_enrollment, 1 connection", run_one_connection },
+    { "prov_sc_ll_get_individual_enrollment, 4 connections", run_four_connections },
+    { "prov_sc_ll_get_individual_enrollment, 16 connections", run_sixteen_connections }
+};
+
+static const BENCHMARK_SCENARIO query_scenarios[] =
+{
+    { "prov_sc_query_individual_enrollment, page after page", run_query_blocking },
+    { "prov_sc_query_iterator_next, next page prefetched", run_query_iterator }
+};
+
+static char* create_reply(size_t record_count)
+{
+    char* result;
+    ATTESTATION_MECHANISM_HANDLE att_mech;
+    INDIVIDUAL_ENROLLMENT_HANDLE enrollment;
+
+    if ((att_mech = attestationMechanism_createWithTpm(ENDORSEMENT_KEY, NULL)) == NULL)
+    {
+        LogError("Failed creating the attestation mechanism");
+        result = NULL;
+    }
+    else if ((enrollment = individualEnrollment_create(REGISTRATION_ID, att_mech)) == NULL)
+    {
+        LogError("Failed creating the enrollment");
+        attestationMechanism_destroy(att_mech);
+        result = NULL;
+    }
+    else
+    {
+        char* record;
+
+        if ((record = individualEnrollment_serializeToJson(enrollment)) == NULL)
+        {
+            LogError("Failed serializing the enrollment");
+            result = NULL;
+        }
+        else if (record_count == 0)
+        {
+            result = record;
+        }
+        else
+        {
+            // A query page is a JSON array of records
+            size_t record_len = strlen(record);
+            if ((result = (char*)malloc(record_count * (record_len + 1) + 2)) == NULL)
+            {
+                LogError("Failed allocating the query page");
+            }
+            else
+            {
+                size_t i;
+                char* position = result;
+
+                *position++ = '[';
+                for (i = 0; i < record_count; i++)
+                {
+                    (void)memcpy(position, record, record_len);
+                    position += record_len;
+                    *position++ = (i + 1 < record_count) ? ',' : ']';
+                }
+                *position = '\0';
+            }
+            free(record);
+        }
+        individualEnrollment_destroy(enrollment);
+    }
+
+    return result;
+}
+
+static int run_scenarios(TICK_COUNTER_HANDLE tick_counter, const BENCHMARK_SCENARIO* scenario_list, size_t scenario_count, const UHTTP_STUB_CONFIG* config, const char* reply)
+{
+    int result = 0;
+    size_t i;
+
+    for (i = 0; i < scenario_count && result == 0; i++)
+    {
+        BENCHMARK_RESULT benchmark_result = { 0, 0 };
+        PROVISIONING_SERVICE_CLIENT_HANDLE prov_client;
+        tickcounter_ms_t start_ms;
+        tickcounter_ms_t end_ms;
+
+        if (uhttp_stub_configure(config, reply) != 0)
+        {
+            LogError("Failed configuring the stub");
+            result = MU_FAILURE;
+        }
+        else if ((prov_client = prov_sc_create_from_connection_string(STUB_CONNECTION_STRING)) == NULL)
+        {
+            LogError("Failed creating the service client");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            (void)tickcounter_get_current_ms(tick_counter, &start_ms);
+            result = scenario_list[i].run(prov_client, &benchmark_result);
+            (void)tickcounter_get_current_ms(tick_counter, &end_ms);
+
+            if (result == 0)
+            {
+                tickcounter_ms_t elapsed_ms = (end_ms > start_ms) ? end_ms - start_ms : 1;
+                (void)printf("%s: %lu of %lu succeeded in %lu ms (%.1f per sec), %lu handshakes\r\n",
+                    scenario_list[i].name, (unsigned long)benchmark_result.succeeded, (unsigned long)benchmark_result.completed,
+                    (unsigned long)elapsed_ms, (double)benchmark_result.succeeded * 1000.0 / (double)elapsed_ms,
+                    (unsigned long)uhttp_stub_get_handshake_count());
+            }
+
+            prov_sc_destroy(prov_client);
+        }
+    }
+
+    return result;
+}
+
+int main(void)
+{
+    int result;
+    TICK_COUNTER_HANDLE tick_counter;
+    char* reply;
+    char* query_reply;
+
+    if (platform_init() != 0)
+    {
+        LogError("Failed initializing the platform");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if ((reply = create_reply(0)) == NULL)
+        {
+            result = MU_FAILURE;
+        }
+        else if ((query_reply = create_reply(QUERY_PAGE_SIZE)) == NULL)
+        {
+            free(reply);
+            result = MU_FAILURE;
+        }
+        else if ((tick_counter = tickcounter_create()) == NULL)
+        {
+            LogError("Failed creating the tick counter");
+            free(query_reply);
+            free(reply);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            (void)printf("requests: %d, handshake: %lu ms, service latency: %lu ms\r\n",
+                REQUEST_COUNT, (unsigned long)stub_config.handshake_latency_ms, (unsigned long)stub_config.service_latency_ms);
+            result = run_scenarios(tick_counter, scenarios, sizeof(scenarios) / sizeof(scenarios[0]), &stub_config, reply);
+
+            if (result == 0)
+            {
+                (void)printf("query pages: %d of %d records, processing: %d ms per record\r\n",
+                    QUERY_PAGE_COUNT, QUERY_PAGE_SIZE, RECORD_PROCESSING_IN_MS);
+                result = run_scenarios(tick_counter, query_scenarios, sizeof(query_scenarios) / sizeof(query_scenarios[0]), &query_stub_config, query_reply);
+            }
+
+            uhttp_stub_deinit();
+            tickcounter_destroy(tick_counter);
+            free(query_reply);
+            free(reply);
+        }
+
+        platform_deinit();
+    }
+
+    return result;
+}
@@ -0,0 +1,246 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#include "azure_uhttp_c/uhttp.h"
+
+#include "uhttp_stub.h"
+
+#define HTTP_STATUS_OK      200
+#define CONT_TOKEN_SIZE     32
+
+static const char* const HEADER_KEY_CONTINUATION = "x-ms-continuation";
+static const char* const HEADER_KEY_ITEM_TYPE = "x-ms-item-type";
+static const char* const ITEM_TYPE_ENROLLMENT = "Enrollment";
+
+typedef struct HTTP_CLIENT_HANDLE_DATA_TAG
+{
+    bool is_open;
+    bool is_connected;
+    tickcounter_ms_t connected_ms;
+    ON_HTTP_OPEN_COMPLETE_CALLBACK on_connect;
+    void* connect_ctx;
+
+    bool is_request_pending;
+    tickcounter_ms_t reply_ms;
+    ON_HTTP_REQUEST_CALLBACK on_request;
+    void* request_ctx;
+} HTTP_CLIENT_HANDLE_DATA;
+
+static TICK_COUNTER_HANDLE g_tick_counter;
+static UHTTP_STUB_CONFIG g_config;
+static char* g_reply;
+static size_t g_handshake_count;
+static size_t g_query_pages_served;
+
+static tickcounter_ms_t get_current_ms(void)
+{
+    tickcounter_ms_t result;
+    if (tickcounter_get_current_ms(g_tick_counter, &result) != 0)
+    {
+        LogError("Failed reading the tick counter");
+        result = 0;
+    }
+    return result;
+}
+
+int uhttp_stub_configure(const UHTTP_STUB_CONFIG* config, const char* reply)
+{
+    int result;
+
+    uhttp_stub_deinit();
+    if ((g_tick_counter = tickcounter_create()) == NULL)
+    {
+        LogError("Failed creating the tick counter");
+        result = MU_FAILURE;
+    }
+    else if (mallocAndStrcpy_s(&g_reply, reply) != 0)
+    {
+        LogError("Failed copying the reply");
+        uhttp_stub_deinit();
+        result = MU_FAILURE;
+    }
+    else
+    {
+        g_config = *config;
+        g_handshake_count = 0;
+        g_query_pages_served = 0;
+        result = 0;
+    }
+
+    return result;
+}
+
+void uhttp_stub_deinit(void)
+{
+    if (g_tick_counter != NULL)
+    {
+        tickcounter_destroy(g_tick_counter);
+        g_tick_counter = NULL;
+    }
+    free(g_reply);
+    g_reply = NULL;
+}
+
+size_t uhttp_stub_get_handshake_count(void)
+{
+    return g_handshake_count;
+}
+
+static HTTP_HEADERS_HANDLE create_query_headers(void)
+{
+    HTTP_HEADERS_HANDLE result;
+    char cont_token[CONT_TOKEN_SIZE];
+
+    g_query_pages_served++;
+    (void)snprintf(cont_token, sizeof(cont_token), "page-%lu", (unsigned long)g_query_pages_served);
+
+    if ((result = HTTPHeaders_Alloc()) == NULL)
+    {
+        LogError("Failed allocating the reply headers");
+    }
+    else if (HTTPHeaders_AddHeaderNameValuePair(result, HEADER_KEY_ITEM_TYPE, ITEM_TYPE_ENROLLMENT) != HTTP_HEADERS_OK ||
+        (g_query_pages_served < g_config.query_page_count && HTTPHeaders_AddHeaderNameValuePair(result, HEADER_KEY_CONTINUATION, cont_token) != HTTP_HEADERS_OK))
+    {
+        LogError("Failed adding the reply headers");
+        HTTPHeaders_Free(result);
+        result = NULL;
+    }
+
+    return result;
+}
+
+HTTP_CLIENT_HANDLE uhttp_client_create(const IO_INTERFACE_DESCRIPTION* io_interface_desc, const void* xio_param, ON_HTTP_ERROR_CALLBACK on_http_error, void* callback_ctx)
+{
+    HTTP_CLIENT_HANDLE_DATA* result;
+    (void)io_interface_desc;
+    (void)xio_param;
+    (void)on_http_error;
+    (void)callback_ctx;
+
+    if ((result = (HTTP_CLIENT_HANDLE_DATA*)malloc(sizeof(HTTP_CLIENT_HANDLE_DATA))) == NULL)
+    {
+        LogError("Failed allocating the http client");
+    }
+    else
+    {
+        memset(result, 0, sizeof(HTTP_CLIENT_HANDLE_DATA));
+    }
+
+    return result;
+}
+
+void uhttp_client_destroy(HTTP_CLIENT_HANDLE handle)
+{
+    free(handle);
+}
+
+HTTP_CLIENT_RESULT uhttp_client_open(HTTP_CLIENT_HANDLE handle, const char* host, int port_num, ON_HTTP_OPEN_COMPLETE_CALLBACK on_connect, void* callback_ctx)
+{
+    HTTP_CLIENT_RESULT result;
+    (void)host;
+    (void)port_num;
+
+    if (handle == NULL || handle->is_open)
+    {
+        result = HTTP_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        handle->is_open = true;
+        handle->is_connected = false;
+        handle->connected_ms = get_current_ms() + g_config.handshake_latency_ms;
+        handle->on_connect = on_connect;
+        handle->connect_ctx = callback_ctx;
+        g_handshake_count++;
+        result = HTTP_CLIENT_OK;
+    }
+
+    return result;
+}
+
+void uhttp_client_close(HTTP_CLIENT_HANDLE handle, ON_HTTP_CLOSED_CALLBACK on_close_callback, void* callback_ctx)
+{
+    if (handle != NULL)
+    {
+        handle->is_open = false;
+        handle->is_connected = false;
+        handle->is_request_pending = false;
+    }
+    if (on_close_callback != NULL)
+    {
+        on_close_callback(callback_ctx);
+    }
+}
+
+HTTP_CLIENT_RESULT uhttp_client_execute_request(HTTP_CLIENT_HANDLE handle, HTTP_CLIENT_REQUEST_TYPE request_type, const char* relative_path,
+    HTTP_HEADERS_HANDLE http_header_handle, const unsigned char* content, size_t content_len, ON_HTTP_REQUEST_CALLBACK on_request_callback, void* callback_ctx)
+{
+    HTTP_CLIENT_RESULT result;
+    (void)request_type;
+    (void)relative_path;
+    (void)http_header_handle;
+    (void)content;
+    (void)content_len;
+
+    if (handle == NULL || !handle->is_connected || handle->is_request_pending)
+    {
+        result = HTTP_CLIENT_ERROR;
+    }
+    else
+    {
+        handle->is_request_pending = true;
+        handle->reply_ms = get_current_ms() + g_config.service_latency_ms;
+        handle->on_request = on_request_callback;
+        handle->request_ctx = callback_ctx;
+        result = HTTP_CLIENT_OK;
+    }
+
+    return result;
+}
+
+void uhttp_client_dowork(HTTP_CLIENT_HANDLE handle)
+{
+    if (handle != NULL && handle->is_open)
+    {
+        tickcounter_ms_t current_ms = get_current_ms();
+
+        if (!handle->is_connected && current_ms >= handle->connected_ms)
+        {
+            handle->is_connected = true;
+            handle->on_connect(handle->connect_ctx, HTTP_CALLBACK_REASON_OK);
+        }
+        else if (handle->is_request_pending && current_ms >= handle->reply_ms)
+        {
+            HTTP_HEADERS_HANDLE headers = (g_config.query_page_count > 0) ? create_query_headers() : NULL;
+
+            handle->is_request_pending = false;
+            handle->on_request(handle->request_ctx, HTTP_CALLBACK_REASON_OK, (const unsigned char*)g_reply, strlen(g_reply), HTTP_STATUS_OK, headers);
+            HTTPHeaders_Free(headers);
+        }
+    }
+}
+
+HTTP_CLIENT_RESULT uhttp_client_set_trace(HTTP_CLIENT_HANDLE handle, bool trace_on, bool trace_data)
+{
+    (void)handle;
+    (void)trace_on;
+    (void)trace_data;
+    return HTTP_CLIENT_OK;
+}
+
+HTTP_CLIENT_RESULT uhttp_client_set_trusted_cert(HTTP_CLIENT_HANDLE handle, const char* certificate)
+{
+    (void)handle;
+    (void)certificate;
+    return HTTP_CLIENT_OK;
+}
@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// In-process stand-in for uhttp and the Device Provisioning Service, used to measure the service client
+// without the network. Every connection pays a simulated TLS handshake, and every request is answered
+// with the configured reply after a fixed service latency, optionally as one page of a query.
+
+#ifndef UHTTP_STUB_H
+#define UHTTP_STUB_H
+
+#ifdef __cplusplus
+extern "C" {
+#include <cstddef>
+#include <cstdint>
+#else
+#include <stddef.h>
+#include <stdint.h>
+#endif /* __cplusplus */
+
+typedef struct UHTTP_STUB_CONFIG_TAG
+{
+    // Round trips before a new connection can carry requests
+    uint32_t handshake_latency_ms;
+    // Delay between a request and its reply
+    uint32_t service_latency_ms;
+    // If not 0, every reply is a page of individual enrollments and all but the last of these pages carry a continuation token
+    size_t query_page_count;
+} UHTTP_STUB_CONFIG;
+
+extern int uhttp_stub_configure(const UHTTP_STUB_CONFIG* config, const char* reply);
+extern void uhttp_stub_deinit(void);
+extern size_t uhttp_stub_get_handshake_count(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif // UHTTP_STUB_H
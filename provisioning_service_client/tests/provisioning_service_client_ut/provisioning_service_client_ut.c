@@ -32,6 +32,7 @@ static void real_free(void* ptr)
 #include "azure_c_shared_utility/string_tokenizer.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/threadapi.h"
 #include "azure_c_shared_utility/sastoken.h"
 #include "azure_c_shared_utility/urlencode.h"
 #include "azure_c_shared_utility/connection_string_parser.h"
@@ -53,20 +54,43 @@ typedef enum {RESPONSE_ON, RESPONSE_OFF} response_switch;
 typedef enum {CERT, NO_CERT} cert_flag;
 typedef enum {TRACE, NO_TRACE} trace_flag;
 typedef enum { PROXY, NO_PROXY } proxy_flag;
+typedef enum { KEEP_ALIVE, NO_KEEP_ALIVE } keep_alive_flag;
 
 static TEST_MUTEX_HANDLE g_testByTest;
 
-static int g_uhttp_client_dowork_call_count;
+static bool g_http_open_pending;
+static bool g_http_request_pending;
+static size_t g_uhttp_client_open_call_count;
 static ON_HTTP_OPEN_COMPLETE_CALLBACK g_on_http_open;
 static void* g_http_open_ctx;
 static ON_HTTP_REQUEST_CALLBACK g_on_http_reply_recv;
 static void* g_http_reply_recv_ctx;
 
 static response_switch g_response_content_status;
+static unsigned int g_http_status_code;
+static HTTP_CALLBACK_REASON g_http_reply_reason;
+
+static size_t g_bulk_chunk_count;
+static size_t g_bulk_max_chunk_size;
+static size_t g_bulk_enrollment_count;
+static size_t g_bulk_merge_count;
+static size_t g_bulk_not_applied_count;
+static PROVISIONING_SERVICE_CLIENT_HANDLE g_bulk_sc;
+static size_t g_bulk_max_pending;
+
+static size_t g_query_page_count;
+static size_t g_query_page_records;
+static size_t g_query_pages_served;
+static size_t g_sleep_call_count;
+
+static size_t g_ll_callback_count;
+static PROV_SC_LL_RESULT g_ll_result;
+static void* g_ll_handle;
 
 static cert_flag g_cert;
 static trace_flag g_trace;
 static proxy_flag g_proxy;
+static keep_alive_flag g_keep_alive;
 
 
 #ifdef __cplusplus
@@ -139,6 +163,7 @@ static const char* TEST_PROXY_PASSWORD = "my-password";
 static const char* TEST_QUERY_STRING = "*";
 static const char* TEST_CONT_TOKEN = "cont";
 static const char* TEST_CONT_TOKEN2 = "cont2";
+static const char* TEST_HEADER_KEY_CONTINUATION = "x-ms-continuation";
 static int TEST_PROXY_PORT = 123;
 static size_t TEST_REPLY_JSON_LEN = 15;
 static unsigned int STATUS_CODE_SUCCESS = 204;
@@ -176,6 +201,8 @@ static HTTP_CLIENT_RESULT my_uhttp_client_open(HTTP_CLIENT_HANDLE handle, const
     (void)port_num;
     g_on_http_open = on_connect;
     g_http_open_ctx = callback_ctx; //prov_client
+    g_http_open_pending = true;
+    g_uhttp_client_open_call_count++;
 
     //note that a real malloc does occur in this fn, but it can't be mocked since it's in a field of handle
 
@@ -187,6 +214,8 @@ static void my_uhttp_client_close(HTTP_CLIENT_HANDLE handle, ON_HTTP_CLOSED_CALL
     (void)handle;
     (void)on_close_callback;
     (void)callback_ctx;
+    g_http_open_pending = false;
+    g_http_request_pending = false;
 
     //note that a real free does occur in this fn, but it can't be mocked since it's in a field of handle
 }
@@ -202,10 +231,17 @@ static HTTP_CLIENT_RESULT my_uhttp_client_execute_request(HTTP_CLIENT_HANDLE han
     (void)content_len;
     g_on_http_reply_recv = on_request_callback;
     g_http_reply_recv_ctx = callback_ctx;
+    g_http_request_pending = true;
 
     return HTTP_CLIENT_OK;
 }
 
+static void my_ThreadAPI_Sleep(unsigned int milliseconds)
+{
+    (void)milliseconds;
+    g_sleep_call_count++;
+}
+
 static void my_uhttp_client_dowork(HTTP_CLIENT_HANDLE handle)
 {
     (void)handle;
@@ -216,13 +252,16 @@ static void my_uhttp_client_dowork(HTTP_CLIENT_HANDLE handle)
     else
         content = NULL;
 
-    if (g_uhttp_client_dowork_call_count == 0)
+    if (g_http_open_pending)
+    {
+        g_http_open_pending = false;
         g_on_http_open(g_http_open_ctx, HTTP_CALLBACK_REASON_OK);
-    else if (g_uhttp_client_dowork_call_count == 1)
+    }
+    else if (g_http_request_pending)
     {
-        g_on_http_reply_recv(g_http_reply_recv_ctx, HTTP_CALLBACK_REASON_OK, content, 1, STATUS_CODE_SUCCESS, TEST_HTTP_HEADERS_HANDLE);
+        g_http_request_pending = false;
+        g_on_http_reply_recv(g_http_reply_recv_ctx, g_http_reply_reason, content, 1, g_http_status_code, TEST_HTTP_HEADERS_HANDLE);
     }
-    g_uhttp_client_dowork_call_count++;
 }
 
 static const char* my_Map_GetValueFromKey(MAP_HANDLE handle, const char* key)
@@ -289,6 +328,21 @@ static void my_HTTPHeaders_Free(HTTP_HEADERS_HANDLE handle)
     real_free(handle);
 }
 
+//with g_query_page_count set, the service holds that many pages of individual enrollments, linked by continuation tokens
+static const char* my_HTTPHeaders_FindHeaderValue(HTTP_HEADERS_HANDLE handle, const char* name)
+{
+    const char* result;
+    (void)handle;
+
+    if (g_query_page_count == 0)
+        result = NULL;
+    else if (strcmp(name, TEST_HEADER_KEY_CONTINUATION) == 0)
+        result = (g_query_pages_served + 1 < g_query_page_count) ? TEST_CONT_TOKEN : NULL;
+    else
+        result = QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT;
+    return result;
+}
+
 static STRING_HANDLE my_STRING_construct(const char* psz)
 {
     (void)psz;
@@ -356,12 +410,27 @@ static PROVISIONING_BULK_OPERATION_RESULT* my_bulkOperationResult_deserializeFro
 
 static PROVISIONING_QUERY_RESPONSE* my_queryResponse_deserializeFromJson(const char* json_string, PROVISIONING_QUERY_TYPE type)
 {
-    (void)type;
     PROVISIONING_QUERY_RESPONSE* result;
-    if (json_string != NULL)
+    if (json_string == NULL)
+    {
+        result = NULL;
+    }
+    else if (g_query_page_count == 0)
+    {
         result = (PROVISIONING_QUERY_RESPONSE*)real_malloc(1);
+    }
     else
-        result = NULL;
+    {
+        result = (PROVISIONING_QUERY_RESPONSE*)real_malloc(sizeof(PROVISIONING_QUERY_RESPONSE));
+        result->response_arr_type = type;
+        result->response_arr_size = g_query_page_records;
+        result->response_arr.ie = (INDIVIDUAL_ENROLLMENT_HANDLE*)real_malloc(g_query_page_records * sizeof(INDIVIDUAL_ENROLLMENT_HANDLE));
+        for (size_t index = 0; index < g_query_page_records; index++)
+        {
+            result->response_arr.ie[index] = (INDIVIDUAL_ENROLLMENT_HANDLE)real_malloc(1);
+        }
+        g_query_pages_served++;
+    }
     return result;
 }
 
@@ -385,8 +454,36 @@ static void my_bulkOperationResult_free(PROVISIONING_BULK_OPERATION_RESULT* bulk
     real_free(bulk_res);
 }
 
+static int my_bulkOperationResult_merge(PROVISIONING_BULK_OPERATION_RESULT* bulk_res, PROVISIONING_BULK_OPERATION_RESULT* chunk_res, const PROVISIONING_BULK_OPERATION* chunk_op, size_t first_index)
+{
+    (void)bulk_res;
+    (void)chunk_res;
+    (void)chunk_op;
+    (void)first_index;
+    g_bulk_merge_count++;
+    return 0;
+}
+
+static int my_bulkOperationResult_addNotAppliedErrors(PROVISIONING_BULK_OPERATION_RESULT* bulk_res, const PROVISIONING_BULK_OPERATION* bulk_op, size_t first_index, size_t num_enrollments, const char* error_status)
+{
+    (void)bulk_op;
+    (void)first_index;
+    (void)error_status;
+    g_bulk_not_applied_count += num_enrollments;
+    bulk_res->is_successful = false;
+    return 0;
+}
+
 static void my_queryResponse_free(PROVISIONING_QUERY_RESPONSE* query_resp)
 {
+    if (query_resp != NULL && g_query_page_count > 0)
+    {
+        for (size_t index = 0; index < query_resp->response_arr_size; index++)
+        {
+            real_free(query_resp->response_arr.ie[index]);
+        }
+        real_free(query_resp->response_arr.ie);
+    }
     real_free(query_resp);
 }
 
@@ -502,7 +599,18 @@ static char* my_enrollmentGroup_serializeToJson(ENROLLMENT_GROUP_HANDLE handle)
 
 static char* my_bulkOperation_serializeToJson(const PROVISIONING_BULK_OPERATION* bulkop)
 {
-    (void)bulkop;
+    //stands in for the service limit on enrollments per request
+    g_bulk_chunk_count++;
+    g_bulk_enrollment_count += bulkop->num_enrollments;
+    if (g_bulk_sc != NULL && prov_sc_ll_get_pending_count(g_bulk_sc) > g_bulk_max_pending)
+    {
+        g_bulk_max_pending = prov_sc_ll_get_pending_count(g_bulk_sc);
+    }
+    if (bulkop->num_enrollments > g_bulk_max_chunk_size)
+    {
+        g_bulk_max_chunk_size = bulkop->num_enrollments;
+    }
+
     char* result = NULL;
     size_t len = strlen(TEST_ENROLLMENT_JSON);
     result = (char*)real_malloc(len + 1);
@@ -559,6 +667,8 @@ static void register_global_mock_hooks()
 
     REGISTER_GLOBAL_MOCK_HOOK(uhttp_client_destroy, my_uhttp_client_destroy);
 
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Sleep, my_ThreadAPI_Sleep);
+
     REGISTER_GLOBAL_MOCK_HOOK(uhttp_client_execute_request, my_uhttp_client_execute_request);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(uhttp_client_execute_request, HTTP_CLIENT_ERROR);
 
@@ -569,6 +679,7 @@ static void register_global_mock_hooks()
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPHeaders_Clone, NULL);
 
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Free, my_HTTPHeaders_Free);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_FindHeaderValue, my_HTTPHeaders_FindHeaderValue);
 
     REGISTER_GLOBAL_MOCK_HOOK(individualEnrollment_deserializeFromJson, my_individualEnrollment_deserializeFromJson);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(individualEnrollment_deserializeFromJson, NULL);
@@ -622,6 +733,10 @@ static void register_global_mock_hooks()
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(bulkOperationResult_deserializeFromJson, NULL);
 
     REGISTER_GLOBAL_MOCK_HOOK(bulkOperationResult_free, my_bulkOperationResult_free);
+    REGISTER_GLOBAL_MOCK_HOOK(bulkOperationResult_merge, my_bulkOperationResult_merge);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(bulkOperationResult_merge, MU_FAILURE);
+    REGISTER_GLOBAL_MOCK_HOOK(bulkOperationResult_addNotAppliedErrors, my_bulkOperationResult_addNotAppliedErrors);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(bulkOperationResult_addNotAppliedErrors, MU_FAILURE);
 
     REGISTER_GLOBAL_MOCK_HOOK(querySpecification_serializeToJson, my_querySpecification_serializeToJson);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(querySpecification_serializeToJson, NULL);
@@ -716,12 +831,34 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     g_http_open_ctx = NULL;
     g_on_http_reply_recv = NULL;
     g_http_reply_recv_ctx = NULL;
-    g_uhttp_client_dowork_call_count = 0;
+    g_http_open_pending = false;
+    g_http_request_pending = false;
+    g_uhttp_client_open_call_count = 0;
     g_response_content_status = RESPONSE_ON;
+    g_http_status_code = STATUS_CODE_SUCCESS;
+    g_http_reply_reason = HTTP_CALLBACK_REASON_OK;
+
+    g_bulk_chunk_count = 0;
+    g_bulk_max_chunk_size = 0;
+    g_bulk_enrollment_count = 0;
+    g_bulk_merge_count = 0;
+    g_bulk_not_applied_count = 0;
+    g_bulk_sc = NULL;
+    g_bulk_max_pending = 0;
+
+    g_query_page_count = 0;
+    g_query_page_records = 0;
+    g_query_pages_served = 0;
+    g_sleep_call_count = 0;
+
+    g_ll_callback_count = 0;
+    g_ll_result = PROV_SC_LL_RESULT_OK;
+    g_ll_handle = NULL;
 
     g_cert = NO_CERT;
     g_trace = NO_TRACE;
     g_proxy = NO_PROXY;
+    g_keep_alive = KEEP_ALIVE;
 
     umock_c_negative_tests_deinit();
     umock_c_reset_all_calls();
@@ -751,6 +888,49 @@ static void set_response_status(response_switch response)
     g_response_content_status = response;
 }
 
+static void on_ll_individual_enrollment(PROV_SC_LL_RESULT result, INDIVIDUAL_ENROLLMENT_HANDLE enrollment, void* user_ctx)
+{
+    (void)user_ctx;
+    g_ll_callback_count++;
+    g_ll_result = result;
+    g_ll_handle = enrollment;
+    individualEnrollment_destroy(enrollment);
+}
+
+static void on_ll_delete(PROV_SC_LL_RESULT result, void* user_ctx)
+{
+    (void)user_ctx;
+    g_ll_callback_count++;
+    g_ll_result = result;
+}
+
+static void on_ll_bulk_operation(PROV_SC_LL_RESULT result, PROVISIONING_BULK_OPERATION_RESULT* bulk_res, void* user_ctx)
+{
+    (void)user_ctx;
+    g_ll_callback_count++;
+    g_ll_result = result;
+    g_ll_handle = bulk_res;
+    bulkOperationResult_free(bulk_res);
+}
+
+static void on_ll_query(PROV_SC_LL_RESULT result, PROVISIONING_QUERY_RESPONSE* query_resp, const char* cont_token, void* user_ctx)
+{
+    (void)cont_token;
+    (void)user_ctx;
+    g_ll_callback_count++;
+    g_ll_result = result;
+    g_ll_handle = query_resp;
+    queryResponse_free(query_resp);
+}
+
+static void run_ll_dowork(PROVISIONING_SERVICE_CLIENT_HANDLE sc, size_t max_iterations)
+{
+    for (size_t index = 0; index < max_iterations && prov_sc_ll_get_pending_count(sc) > 0; index++)
+    {
+        prov_sc_ll_dowork(sc);
+    }
+}
+
 static void expected_calls_mallocAndStrcpy_overwrite()
 {
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
@@ -828,8 +1008,11 @@ static void expected_calls_rest_call(HTTP_CLIENT_REQUEST_TYPE request_type, resp
     {
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));  //this is also in the callback
     }
-    STRICT_EXPECTED_CALL(uhttp_client_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(uhttp_client_destroy(IGNORED_PTR_ARG)); //does not fail
+    if (g_keep_alive == NO_KEEP_ALIVE)
+    {
+        STRICT_EXPECTED_CALL(uhttp_client_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG)); //does not fail
+        STRICT_EXPECTED_CALL(uhttp_client_destroy(IGNORED_PTR_ARG)); //does not fail
+    }
 }
 
 /* UNIT TESTS BEGIN */
@@ -1266,327 +1449,456 @@ TEST_FUNCTION(prov_sc_set_proxy_GOLDEN_FULL_PROXY)
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_SC_HANDLE)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_003: [ If prov_client is NULL, prov_sc_set_keep_alive shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_set_keep_alive_ERROR_INPUT_NULL)
 {
     //arrange
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-    umock_c_reset_all_calls();
 
     //act
-    int result = prov_sc_create_or_update_individual_enrollment(NULL, &ie);
+    int result = prov_sc_set_keep_alive(NULL, 30);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, result, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
-    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_IE_HANDLE)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_008: [ Upon success, prov_sc_set_keep_alive shall return 0 ] */
+TEST_FUNCTION(prov_sc_set_keep_alive_GOLDEN)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     umock_c_reset_all_calls();
 
     //act
-    int result = prov_sc_create_or_update_individual_enrollment(sc, NULL);
+    int result = prov_sc_set_keep_alive(sc, 30);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_ARE_EQUAL(int, result, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_IE_HANDLE2)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_005: [ If idle_timeout_secs is 0, any open connection shall be closed and every request shall open and close its own connection ] */
+TEST_FUNCTION(prov_sc_set_keep_alive_zero_closes_connection)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
     INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    individualEnrollment_destroy(ie);
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(uhttp_client_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_destroy(IGNORED_PTR_ARG));
+
     //act
-    int result = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+    int result = prov_sc_set_keep_alive(sc, 0);
 
     //assert
-    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_ARE_EQUAL(int, result, 0);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_001: [ If a connection to the Provisioning Service is open, prov_sc_destroy shall close and destroy it ] */
+TEST_FUNCTION(prov_sc_destroy_closes_kept_connection)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    individualEnrollment_destroy(ie);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
-    expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
-    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
     //act
-    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+    prov_sc_destroy(sc);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_002: [ prov_sc_set_trace, prov_sc_set_certificate and prov_sc_set_proxy shall close any open connection so the new setting applies to the next request ] */
+TEST_FUNCTION(prov_sc_set_trace_closes_kept_connection)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    individualEnrollment_destroy(ie);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uhttp_client_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_destroy(IGNORED_PTR_ARG));
+
+    //act
+    prov_sc_set_trace(sc, TRACING_STATUS_ON);
 
     //assert
-    ASSERT_ARE_EQUAL(int, res, 0);
-    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
-    individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN_w_etag)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_004: [ A connection idle for idle_timeout_secs seconds or more shall be closed before the next request and a new one opened ] */
+TEST_FUNCTION(prov_sc_get_individual_enrollment_reuses_connection)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    individualEnrollment_destroy(ie);
+    ie = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Clone(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
 
     //act
-    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
-    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_uhttp_client_open_call_count);
 
     //cleanup
     prov_sc_destroy(sc);
     individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN_ALL_HTTP_OPTIONS)
+TEST_FUNCTION(prov_sc_get_individual_enrollment_1000_requests_open_one_connection)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    int res = 0;
 
-    HTTP_PROXY_OPTIONS proxy_options;
-    proxy_options.host_address = TEST_PROXY_HOSTNAME;
-    proxy_options.port = TEST_PROXY_PORT;
-    proxy_options.username = TEST_PROXY_USERNAME;
-    proxy_options.password = TEST_PROXY_PASSWORD;
+    //act
+    for (size_t index = 0; index < 1000 && res == 0; index++)
+    {
+        INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+        res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+        individualEnrollment_destroy(ie);
+    }
 
-    prov_sc_set_proxy(sc, &proxy_options);
-    prov_sc_set_certificate(sc, TEST_TRUSTED_CERT);
-    prov_sc_set_trace(sc, TRACING_STATUS_ON);
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(size_t, 1, g_uhttp_client_open_call_count);
 
-    g_proxy = PROXY;
-    g_cert = CERT;
-    g_trace = TRACE;
+    //cleanup
+    prov_sc_destroy(sc);
+}
 
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_005: [ If idle_timeout_secs is 0, any open connection shall be closed and every request shall open and close its own connection ] */
+TEST_FUNCTION(prov_sc_get_individual_enrollment_keep_alive_off_opens_every_request)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0);
+    int res = 0;
+
+    //act
+    for (size_t index = 0; index < 3 && res == 0; index++)
+    {
+        INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+        res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+        individualEnrollment_destroy(ie);
+    }
+
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(size_t, 3, g_uhttp_client_open_call_count);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_004: [ A connection idle for idle_timeout_secs seconds or more shall be closed before the next request and a new one opened ] */
+TEST_FUNCTION(prov_sc_get_individual_enrollment_idle_connection_reopened)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    (void)prov_sc_set_keep_alive(sc, 30);
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    individualEnrollment_destroy(ie);
+    ie = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
-    expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL);
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
-    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG)).SetReturn((time_t)30);
 
     //act
-    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
 
     //assert
     ASSERT_ARE_EQUAL(int, res, 0);
-    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, g_uhttp_client_open_call_count);
 
     //cleanup
     prov_sc_destroy(sc);
     individualEnrollment_destroy(ie);
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_null_etag)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_006: [ If a request on a reused connection fails before any reply is received, the connection shall be closed and the request sent once more on a new connection ] */
+TEST_FUNCTION(prov_sc_get_individual_enrollment_dropped_connection_reconnects)
 {
     //arrange
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
-
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
-
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    individualEnrollment_destroy(ie);
+    ie = NULL;
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
-    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
-    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(HTTP_CLIENT_ERROR);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(uhttp_client_destroy(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_GET, RESPONSE);
     STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
-    umock_c_negative_tests_snapshot();
+    //act
+    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
 
-    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 14, 15, 19, 20, 21, 22, 24, 25, 27, 28, 29, 30, 31 };
-    size_t count = umock_c_negative_tests_call_count();
-    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, g_uhttp_client_open_call_count);
 
-    size_t test_num = 0;
-    size_t test_max = count - num_cannot_fail;
+    //cleanup
+    prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
+}
 
-    for (size_t index = 0; index < count; index++)
-    {
-        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
-            continue;
-        test_num++;
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_047: [ A request that was written to the connection before it failed shall only be sent once more if it is a GET, a DELETE or a PUT with an ETag ] */
+TEST_FUNCTION(prov_sc_get_individual_enrollment_lost_reply_resent)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    individualEnrollment_destroy(ie);
+    ie = NULL;
+    g_http_reply_reason = HTTP_CALLBACK_REASON_ERROR;
 
-        char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_create_or_update_individual_enrollment failure in test %zu/%zu", test_num, test_max);
+    //act
+    int res = prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
 
-        umock_c_negative_tests_reset();
-        umock_c_negative_tests_fail_call(index);
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(ie);
+    ASSERT_ARE_EQUAL(size_t, 2, g_uhttp_client_open_call_count);
 
-        //act
-        int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+    //cleanup
+    prov_sc_destroy(sc);
+}
 
-        //assert
-        ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_047: [ A request that was written to the connection before it failed shall only be sent once more if it is a GET, a DELETE or a PUT with an ETag ] */
+TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_lost_reply_not_resent)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    (void)prov_sc_get_individual_enrollment(sc, TEST_REGID, &ie);
+    individualEnrollment_destroy(ie);
+    g_http_reply_reason = HTTP_CALLBACK_REASON_ERROR;
 
-        g_uhttp_client_dowork_call_count = 0;
-    }
+    //act
+    int res = prov_sc_run_individual_enrollment_bulk_operation(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(bulk_res);
+    ASSERT_ARE_EQUAL(size_t, 1, g_uhttp_client_open_call_count);
 
     //cleanup
     prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_SC_HANDLE)
+{
+    //arrange
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+    umock_c_reset_all_calls();
+
+    //act
+    int result = prov_sc_create_or_update_individual_enrollment(NULL, &ie);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
     individualEnrollment_destroy(ie);
-    umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_w_etag)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_IE_HANDLE)
 {
     //arrange
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    umock_c_reset_all_calls();
+
+    //act
+    int result = prov_sc_create_or_update_individual_enrollment(sc, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
 
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_006: [ If prov_client or enrollment_ptr are NULL, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_ERROR_INPUT_NULL_IE_HANDLE2)
+{
+    //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
+    umock_c_reset_all_calls();
+
+    //act
+    int result = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, result, 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
 
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
     umock_c_reset_all_calls();
 
     STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
     expected_calls_construct_registration_path(true);
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)); //cannot fail
-    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
     expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
     STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
-    umock_c_negative_tests_snapshot();
-
-    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 15, 16, 20, 21, 22, 23, 25, 26, 28, 29, 30, 31, 32 };
-    size_t count = umock_c_negative_tests_call_count();
-    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
-
-    size_t test_num = 0;
-    size_t test_max = count - num_cannot_fail;
+    //act
+    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
 
-    for (size_t index = 0; index < count; index++)
-    {
-        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
-            continue;
-        test_num++;
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-        char tmp_msg[128];
-        sprintf(tmp_msg, "prov_sc_create_or_update_individual_enrollment failure in test %zu/%zu", test_num, test_max);
+    //cleanup
+    prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
+}
 
-        umock_c_negative_tests_reset();
-        umock_c_negative_tests_fail_call(index);
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN_w_etag)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
+    umock_c_reset_all_calls();
 
-        //act
-        int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
 
-        //assert
-        ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
+    //act
+    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
 
-        g_uhttp_client_dowork_call_count = 0;
-    }
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
     prov_sc_destroy(sc);
     individualEnrollment_destroy(ie);
-    umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
-TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_ALL_HTTP_OPTIONS)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_007: [ A 'PUT' REST call shall be issued to create/update the enrollment record of a device on the Provisioning Service, using data contained in enrollment_ptr ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_044: [ The data in enrollment_ptr will be updated to reflect new information added by the Provisioning Service ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_009: [ Upon a successful create or update, prov_sc_create_or_update_individual_enrollment shall return 0 ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_GOLDEN_ALL_HTTP_OPTIONS)
 {
     //arrange
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
-
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
 
     HTTP_PROXY_OPTIONS proxy_options;
@@ -1603,6 +1915,49 @@ TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_ALL_HTTP_OPTIO
     g_cert = CERT;
     g_trace = TRACE;
 
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+    INDIVIDUAL_ENROLLMENT_HANDLE old_ie = ie;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL);
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+
+    //act
+    int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, res, 0);
+    ASSERT_IS_TRUE(old_ie != ie); //ie was changed by the function
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_null_etag)
+{
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
 
     umock_c_reset_all_calls();
@@ -1623,7 +1978,7 @@ TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_ALL_HTTP_OPTIO
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 3, 4, 5,  7, 12, 14, 15, 16, 22, 24, 25, 27, 28, 30, 31, 32, 33, 34 };
+    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 14, 15, 19, 20, 21, 22, 24, 25, 27, 28, 29, 30, 31 };
     size_t count = umock_c_negative_tests_call_count();
     size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
 
@@ -1647,8 +2002,6 @@ TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_ALL_HTTP_OPTIO
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -1657,15 +2010,156 @@ TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_ALL_HTTP_OPTIO
     umock_c_negative_tests_deinit();
 }
 
-/* Tests_PROVISIONING_SERVICE_CLIENT_22_010: [ If prov_client or enrollment are NULL, prov_sc_delete_individual_enrollment shall fail and return return a non-zero value ] */
-TEST_FUNCTION(prov_sc_delete_individual_enrollment_ERROR_INPUT_NULL_PROV_SC)
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_w_etag)
 {
     //arrange
-    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
-
-    //act
-    int res = prov_sc_delete_individual_enrollment(NULL, TEST_INDIVIDUAL_ENROLLMENT_HANDLE);
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)); //cannot fail
+    expected_calls_construct_http_headers(ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+
+    umock_c_negative_tests_snapshot();
+
+    size_t calls_cannot_fail[] = { 3, 4, 5, 7, 12, 15, 16, 20, 21, 22, 23, 25, 26, 28, 29, 30, 31, 32 };
+    size_t count = umock_c_negative_tests_call_count();
+    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+
+    size_t test_num = 0;
+    size_t test_max = count - num_cannot_fail;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+            continue;
+        test_num++;
+
+        char tmp_msg[128];
+        sprintf(tmp_msg, "prov_sc_create_or_update_individual_enrollment failure in test %zu/%zu", test_num, test_max);
+
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
+    }
+
+    //cleanup
+    prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_008: [ If the 'PUT' REST call fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_045: [ If receiving the response from the Provisioning Service fails, prov_sc_create_or_update_individual_enrollment shall fail and return a non-zero value. ] */
+TEST_FUNCTION(prov_sc_create_or_update_individual_enrollment_FAIL_ALL_HTTP_OPTIONS)
+{
+    //arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
+
+    HTTP_PROXY_OPTIONS proxy_options;
+    proxy_options.host_address = TEST_PROXY_HOSTNAME;
+    proxy_options.port = TEST_PROXY_PORT;
+    proxy_options.username = TEST_PROXY_USERNAME;
+    proxy_options.password = TEST_PROXY_PASSWORD;
+
+    prov_sc_set_proxy(sc, &proxy_options);
+    prov_sc_set_certificate(sc, TEST_TRUSTED_CERT);
+    prov_sc_set_trace(sc, TRACING_STATUS_ON);
+
+    g_proxy = PROXY;
+    g_cert = CERT;
+    g_trace = TRACE;
+
+    INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(individualEnrollment_serializeToJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+    expected_calls_construct_registration_path(true);
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_PUT);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_rest_call(HTTP_CLIENT_REQUEST_PUT, RESPONSE);
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //cannot fail
+
+    umock_c_negative_tests_snapshot();
+
+    size_t calls_cannot_fail[] = { 3, 4, 5,  7, 12, 14, 15, 16, 22, 24, 25, 27, 28, 30, 31, 32, 33, 34 };
+    size_t count = umock_c_negative_tests_call_count();
+    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+
+    size_t test_num = 0;
+    size_t test_max = count - num_cannot_fail;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+            continue;
+        test_num++;
+
+        char tmp_msg[128];
+        sprintf(tmp_msg, "prov_sc_create_or_update_individual_enrollment failure in test %zu/%zu", test_num, test_max);
+
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = prov_sc_create_or_update_individual_enrollment(sc, &ie);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
+    }
+
+    //cleanup
+    prov_sc_destroy(sc);
+    individualEnrollment_destroy(ie);
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_22_010: [ If prov_client or enrollment are NULL, prov_sc_delete_individual_enrollment shall fail and return return a non-zero value ] */
+TEST_FUNCTION(prov_sc_delete_individual_enrollment_ERROR_INPUT_NULL_PROV_SC)
+{
+    //arrange
+    STRICT_EXPECTED_CALL(individualEnrollment_getEtag(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_getRegistrationId(IGNORED_PTR_ARG));
+
+    //act
+    int res = prov_sc_delete_individual_enrollment(NULL, TEST_INDIVIDUAL_ENROLLMENT_HANDLE);
 
     //assert
     ASSERT_ARE_NOT_EQUAL(int, res, 0);
@@ -1769,6 +2263,8 @@ TEST_FUNCTION(prov_sc_delete_individual_enrollment_FAIL)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     INDIVIDUAL_ENROLLMENT_HANDLE ie = individualEnrollment_create(TEST_REGID, TEST_ATT_MECH_HANDLE);
     set_response_status(RESPONSE_OFF);
 
@@ -1811,8 +2307,6 @@ TEST_FUNCTION(prov_sc_delete_individual_enrollment_FAIL)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -1921,6 +2415,8 @@ TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_FAIL)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     set_response_status(RESPONSE_OFF);
 
     umock_c_reset_all_calls();
@@ -1961,8 +2457,6 @@ TEST_FUNCTION(prov_sc_delete_individual_enrollment_by_param_FAIL)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -2065,6 +2559,8 @@ TEST_FUNCTION(prov_sc_get_individual_enrollment_FAIL)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     INDIVIDUAL_ENROLLMENT_HANDLE ie = NULL;
     umock_c_reset_all_calls();
 
@@ -2104,8 +2600,6 @@ TEST_FUNCTION(prov_sc_get_individual_enrollment_FAIL)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -2256,6 +2750,8 @@ TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_FAIL_no_etag)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
 
     umock_c_reset_all_calls();
@@ -2301,8 +2797,6 @@ TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_FAIL_no_etag)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -2320,6 +2814,8 @@ TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_FAIL_w_etag)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
 
     umock_c_reset_all_calls();
@@ -2365,8 +2861,6 @@ TEST_FUNCTION(prov_sc_create_or_update_enrollment_group_FAIL_w_etag)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -2487,6 +2981,8 @@ TEST_FUNCTION(prov_sc_delete_enrollment_group_FAIL)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     ENROLLMENT_GROUP_HANDLE eg = enrollmentGroup_create(TEST_GROUPID, TEST_ATT_MECH_HANDLE);
     set_response_status(RESPONSE_OFF);
 
@@ -2529,8 +3025,6 @@ TEST_FUNCTION(prov_sc_delete_enrollment_group_FAIL)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -2639,6 +3133,8 @@ TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_FAIL)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     set_response_status(RESPONSE_OFF);
 
     umock_c_reset_all_calls();
@@ -2678,8 +3174,6 @@ TEST_FUNCTION(prov_sc_delete_enrollment_group_by_param_FAIL)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -2782,6 +3276,8 @@ TEST_FUNCTION(prov_sc_get_enrollment_group_FAIL)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     ENROLLMENT_GROUP_HANDLE eg = NULL;
     umock_c_reset_all_calls();
 
@@ -2821,8 +3317,6 @@ TEST_FUNCTION(prov_sc_get_enrollment_group_FAIL)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -2926,6 +3420,8 @@ TEST_FUNCTION(prov_sc_get_device_registration_state_FAIL)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     DEVICE_REGISTRATION_STATE_HANDLE drs = NULL;
     umock_c_reset_all_calls();
 
@@ -2965,8 +3461,6 @@ TEST_FUNCTION(prov_sc_get_device_registration_state_FAIL)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -3083,6 +3577,8 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_FAIL)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     set_response_status(RESPONSE_OFF);
 
     umock_c_reset_all_calls();
@@ -3124,8 +3620,6 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_FAIL)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -3233,6 +3727,8 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_FAIL)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     set_response_status(RESPONSE_OFF);
 
     umock_c_reset_all_calls();
@@ -3272,8 +3768,6 @@ TEST_FUNCTION(prov_sc_delete_device_registration_state_by_param_FAIL)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -3421,6 +3915,8 @@ TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_ERROR)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
     PROVISIONING_BULK_OPERATION bulkop;
     bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
@@ -3468,8 +3964,6 @@ TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_ERROR)
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -3477,143 +3971,438 @@ TEST_FUNCTION(prov_sc_run_individual_enrollment_bulk_operation_ERROR)
     umock_c_negative_tests_deinit();
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_prov_client)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_028: [ If prov_client, bulk_op or bulk_res_ptr are NULL, or bulk_op has an invalid version or no enrollments, prov_sc_run_bulk_operation_large shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_run_bulk_operation_large_NULL_prov_client)
 {
     //arrange
-    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
-    qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.query_string = TEST_QUERY_STRING;
-    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
-
-    char* cont_token = NULL;
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
-    umock_c_reset_all_calls();
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
 
     //act
-    int res = prov_sc_query_individual_enrollment(NULL, &qs, &cont_token, &query_resp);
+    int res = prov_sc_run_bulk_operation_large(NULL, &bulkop, &bulk_res);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_NOT_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(cont_token);
-    ASSERT_IS_NULL(query_resp);
+    ASSERT_IS_NULL(bulk_res);
 
     //cleanup
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_spec)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_028: [ If prov_client, bulk_op or bulk_res_ptr are NULL, or bulk_op has an invalid version or no enrollments, prov_sc_run_bulk_operation_large shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_run_bulk_operation_large_NULL_bulk_op)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-
-    char* cont_token = NULL;
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, NULL, &cont_token, &query_resp);
+    int res = prov_sc_run_bulk_operation_large(sc, NULL, &bulk_res);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_NOT_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(cont_token);
-    ASSERT_IS_NULL(query_resp);
+    ASSERT_IS_NULL(bulk_res);
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_cont_token_ptr)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_028: [ If prov_client, bulk_op or bulk_res_ptr are NULL, or bulk_op has an invalid version or no enrollments, prov_sc_run_bulk_operation_large shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_run_bulk_operation_large_NULL_bulk_res)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
-    qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.query_string = TEST_QUERY_STRING;
-    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
-
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, &qs, NULL, &query_resp);
+    int res = prov_sc_run_bulk_operation_large(sc, &bulkop, NULL);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_NOT_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(query_resp);
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_resp_ptr)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_028: [ If prov_client, bulk_op or bulk_res_ptr are NULL, or bulk_op has an invalid version or no enrollments, prov_sc_run_bulk_operation_large shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_run_bulk_operation_large_no_enrollments)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
-    qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.query_string = TEST_QUERY_STRING;
-    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
-
-    char* cont_token = NULL;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 0;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
     umock_c_reset_all_calls();
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, NULL);
+    int res = prov_sc_run_bulk_operation_large(sc, &bulkop, &bulk_res);
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_NOT_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(cont_token);
+    ASSERT_IS_NULL(bulk_res);
 
     //cleanup
     prov_sc_destroy(sc);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_078: [ If query_spec has invalid values, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_invalid_version)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_029: [ prov_sc_run_bulk_operation_large shall split bulk_op into chunks of at most 10 enrollments, in order, and serialize each chunk only when it is queued ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_030: [ At most as many chunks as the maximum connections of the non-blocking API shall be queued or in flight at a time ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_033: [ Otherwise, bulk_res_ptr shall be set to the merged result and prov_sc_run_bulk_operation_large shall return 0, even if some chunks failed ] */
+TEST_FUNCTION(prov_sc_run_bulk_operation_large_splits_into_chunks)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
-    qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.query_string = TEST_QUERY_STRING;
-    qs.version = 47474;
-
-    char* cont_token = NULL;
-    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
-    umock_c_reset_all_calls();
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[25];
+    for (size_t index = 0; index < 25; index++)
+    {
+        ie_arr[index] = TEST_INDIVIDUAL_ENROLLMENT_HANDLE;
+    }
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 25;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    g_bulk_sc = sc;
 
     //act
-    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+    int res = prov_sc_run_bulk_operation_large(sc, &bulkop, &bulk_res);
 
     //assert
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_NOT_EQUAL(int, 0, res);
-    ASSERT_IS_NULL(cont_token);
-    ASSERT_IS_NULL(query_resp);
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(bulk_res);
+    ASSERT_IS_TRUE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 3, g_bulk_chunk_count);
+    ASSERT_ARE_EQUAL(size_t, 10, g_bulk_max_chunk_size);
+    ASSERT_ARE_EQUAL(size_t, 25, g_bulk_enrollment_count);
+    ASSERT_ARE_EQUAL(size_t, 3, g_bulk_merge_count);
+    ASSERT_ARE_EQUAL(size_t, 0, g_bulk_max_pending);
+    ASSERT_ARE_EQUAL(size_t, 1, g_uhttp_client_open_call_count);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
 
     //cleanup
     prov_sc_destroy(sc);
+    bulkOperationResult_free(bulk_res);
 }
 
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_079: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_081: [ The data from the query response shall populate query_resp_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_083: [ A continuation token (if any) shall populate cont_token_ptr ]*/
-/*Tests_PROVISIONING_SERVICE_CLIENT_22_084: [ Upon success, prov_sc_query_individual_enrollment shall return 0 ]*/
-TEST_FUNCTION(prov_sc_query_individual_enrollment_success_full_results)
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_032: [ If a chunk cannot be queued or completes with any result other than PROV_SC_LL_RESULT_OK, no further chunk shall be queued and the chunks in flight shall be waited for ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_045: [ The enrollments of a chunk that failed or was not sent shall be added to the result as errors at their position in bulk_op, and the result shall be unsuccessful ] */
+TEST_FUNCTION(prov_sc_run_bulk_operation_large_chunk_http_error)
 {
     //arrange
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
-    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
-    qs.page_size = NO_MAX_PAGE_SIZE;
-    qs.query_string = TEST_QUERY_STRING;
-    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[25];
+    for (size_t index = 0; index < 25; index++)
+    {
+        ie_arr[index] = TEST_INDIVIDUAL_ENROLLMENT_HANDLE;
+    }
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 25;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    g_http_status_code = 400;
+
+    //act
+    int res = prov_sc_run_bulk_operation_large(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(bulk_res);
+    ASSERT_IS_FALSE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 1, g_bulk_chunk_count);
+    ASSERT_ARE_EQUAL(size_t, 0, g_bulk_merge_count);
+    ASSERT_ARE_EQUAL(size_t, 25, g_bulk_not_applied_count);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_destroy(sc);
+    bulkOperationResult_free(bulk_res);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_032: [ If a chunk cannot be queued or completes with any result other than PROV_SC_LL_RESULT_OK, no further chunk shall be queued and the chunks in flight shall be waited for ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_045: [ The enrollments of a chunk that failed or was not sent shall be added to the result as errors at their position in bulk_op, and the result shall be unsuccessful ] */
+TEST_FUNCTION(prov_sc_run_bulk_operation_large_serialize_fail)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[25];
+    for (size_t index = 0; index < 25; index++)
+    {
+        ie_arr[index] = TEST_INDIVIDUAL_ENROLLMENT_HANDLE;
+    }
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 25;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    (void)prov_sc_ll_set_max_connections(sc, 2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); //connection pool
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); //result
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); //chunk
+    STRICT_EXPECTED_CALL(bulkOperation_serializeToJson(IGNORED_PTR_ARG)).SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //chunk
+    STRICT_EXPECTED_CALL(bulkOperationResult_addNotAppliedErrors(IGNORED_PTR_ARG, &bulkop, 0, 25, IGNORED_PTR_ARG));
+
+    //act
+    int res = prov_sc_run_bulk_operation_large(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(bulk_res);
+    ASSERT_IS_FALSE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_destroy(sc);
+    bulkOperationResult_free(bulk_res);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_045: [ The enrollments of a chunk that failed or was not sent shall be added to the result as errors at their position in bulk_op, and the result shall be unsuccessful ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_046: [ If the enrollments cannot be added to the result, prov_sc_run_bulk_operation_large shall free the result and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_run_bulk_operation_large_not_applied_errors_fail)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[25];
+    for (size_t index = 0; index < 25; index++)
+    {
+        ie_arr[index] = TEST_INDIVIDUAL_ENROLLMENT_HANDLE;
+    }
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 25;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    (void)prov_sc_ll_set_max_connections(sc, 2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); //connection pool
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); //result
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); //chunk
+    STRICT_EXPECTED_CALL(bulkOperation_serializeToJson(IGNORED_PTR_ARG)).SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //chunk
+    STRICT_EXPECTED_CALL(bulkOperationResult_addNotAppliedErrors(IGNORED_PTR_ARG, &bulkop, 0, 25, IGNORED_PTR_ARG)).SetReturn(MU_FAILURE);
+    STRICT_EXPECTED_CALL(bulkOperationResult_free(IGNORED_PTR_ARG));
+
+    //act
+    int res = prov_sc_run_bulk_operation_large(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(bulk_res);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_031: [ The errors of every chunk shall be merged into one result, with enrollment_index set to the position of the failed enrollment in bulk_op, and the result shall be successful only if every chunk was ] */
+TEST_FUNCTION(prov_sc_run_bulk_operation_large_merge_fail)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    PROVISIONING_BULK_OPERATION_RESULT* bulk_res = NULL;
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(bulkOperationResult_merge(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, 0)).SetReturn(MU_FAILURE);
+
+    //act
+    int res = prov_sc_run_bulk_operation_large(sc, &bulkop, &bulk_res);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_IS_NOT_NULL(bulk_res);
+    ASSERT_IS_FALSE(bulk_res->is_successful);
+    ASSERT_ARE_EQUAL(size_t, 1, g_bulk_chunk_count);
+    ASSERT_ARE_EQUAL(size_t, 2, g_bulk_not_applied_count);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_destroy(sc);
+    bulkOperationResult_free(bulk_res);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_prov_client)
+{
+    //arrange
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    char* cont_token = NULL;
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_query_individual_enrollment(NULL, &qs, &cont_token, &query_resp);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(cont_token);
+    ASSERT_IS_NULL(query_resp);
+
+    //cleanup
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_spec)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+
+    char* cont_token = NULL;
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_query_individual_enrollment(sc, NULL, &cont_token, &query_resp);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(cont_token);
+    ASSERT_IS_NULL(query_resp);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_cont_token_ptr)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_query_individual_enrollment(sc, &qs, NULL, &query_resp);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(query_resp);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_077: [ If prov_client, query_spec, cont_token_ptr or query_resp_ptr are NULL, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_NULL_query_resp_ptr)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    char* cont_token = NULL;
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(cont_token);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_078: [ If query_spec has invalid values, prov_sc_query_individual_enrollment shall fail and return a non-zero value ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_invalid_version)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = 47474;
+
+    char* cont_token = NULL;
+    PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_query_individual_enrollment(sc, &qs, &cont_token, &query_resp);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_IS_NULL(cont_token);
+    ASSERT_IS_NULL(query_resp);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_079: [ A 'POST' REST call shall be issued to run the query operation on the Provisioning Service ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_081: [ The data from the query response shall populate query_resp_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_083: [ A continuation token (if any) shall populate cont_token_ptr ]*/
+/*Tests_PROVISIONING_SERVICE_CLIENT_22_084: [ Upon success, prov_sc_query_individual_enrollment shall return 0 ]*/
+TEST_FUNCTION(prov_sc_query_individual_enrollment_success_full_results)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
 
     char* cont_token = NULL;
     PROVISIONING_QUERY_RESPONSE* query_resp = NULL;
@@ -3821,6 +4610,8 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_t
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = 5;
     qs.query_string = TEST_QUERY_STRING;
@@ -3876,8 +4667,6 @@ TEST_FUNCTION(prov_sc_query_individual_enrollment_success_paging_given_token_w_t
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -4229,6 +5018,8 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = 5;
     qs.query_string = TEST_QUERY_STRING;
@@ -4284,8 +5075,6 @@ TEST_FUNCTION(prov_sc_query_enrollment_group_success_paging_given_token_w_token_
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -4633,6 +5422,8 @@ TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_set_keep_alive(sc, 0); //every failure starts from a new connection
+    g_keep_alive = NO_KEEP_ALIVE;
     PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
     qs.page_size = 5;
     qs.registration_id = TEST_REGID;
@@ -4687,8 +5478,6 @@ TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token
 
         //assert
         ASSERT_ARE_NOT_EQUAL(int, res, 0, tmp_msg);
-
-        g_uhttp_client_dowork_call_count = 0;
     }
 
     //cleanup
@@ -4696,4 +5485,1069 @@ TEST_FUNCTION(prov_sc_query_device_registration_state_success_paging_given_token
     prov_sc_destroy(sc);
 }
 
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_009: [ If prov_client, the id, the enrollment, query_spec or bulk_op is NULL, or the callback of a request other than a delete is NULL, the function shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_ll_get_individual_enrollment_NULL_prov_client)
+{
+    //arrange
+
+    //act
+    int res = prov_sc_ll_get_individual_enrollment(NULL, TEST_REGID, on_ll_individual_enrollment, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_009: [ If prov_client, the id, the enrollment, query_spec or bulk_op is NULL, or the callback of a request other than a delete is NULL, the function shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_ll_get_individual_enrollment_NULL_reg_id)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_ll_get_individual_enrollment(sc, NULL, on_ll_individual_enrollment, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_009: [ If prov_client, the id, the enrollment, query_spec or bulk_op is NULL, or the callback of a request other than a delete is NULL, the function shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_ll_get_individual_enrollment_NULL_callback)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, NULL, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_012: [ Upon success, the request shall be queued without any network I/O and the function shall return 0 ] */
+TEST_FUNCTION(prov_sc_ll_get_individual_enrollment_queues_without_io)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    expected_calls_construct_registration_path(true);
+
+    //act
+    int res = prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, prov_sc_ll_get_pending_count(sc));
+    ASSERT_ARE_EQUAL(size_t, 0, g_uhttp_client_open_call_count);
+    ASSERT_ARE_EQUAL(size_t, 0, g_ll_callback_count);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_011: [ If serializing or copying fails, the function shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_ll_get_individual_enrollment_FAIL)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    umock_c_reset_all_calls();
+
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    expected_calls_construct_registration_path(true);
+
+    umock_c_negative_tests_snapshot();
+
+    size_t calls_cannot_fail[] = { 2, 3 };
+    size_t count = umock_c_negative_tests_call_count();
+    size_t num_cannot_fail = sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0]);
+
+    size_t test_num = 0;
+    size_t test_max = count - num_cannot_fail;
+
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, num_cannot_fail) != 0)
+        {
+            continue;
+        }
+        test_num++;
+
+        char tmp_msg[128];
+        sprintf(tmp_msg, "prov_sc_ll_get_individual_enrollment failure in test %zu/%zu", test_num, test_max);
+
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //act
+        int res = prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, res, tmp_msg);
+        ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc), tmp_msg);
+    }
+
+    //cleanup
+    prov_sc_destroy(sc);
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_013: [ If prov_client is NULL, prov_sc_ll_dowork shall do nothing ] */
+TEST_FUNCTION(prov_sc_ll_dowork_NULL_prov_client)
+{
+    //arrange
+
+    //act
+    prov_sc_ll_dowork(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_013: [ If prov_client is NULL, prov_sc_ll_dowork shall do nothing ] */
+TEST_FUNCTION(prov_sc_ll_dowork_nothing_queued_does_nothing)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    umock_c_reset_all_calls();
+
+    //act
+    prov_sc_ll_dowork(sc);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_015: [ Queued requests shall be started in order, on idle open connections first, then on new connections while fewer than the maximum are open ] */
+TEST_FUNCTION(prov_sc_ll_dowork_first_call_connects)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_connect_to_service();
+
+    //act
+    prov_sc_ll_dowork(sc);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, prov_sc_ll_get_pending_count(sc));
+    ASSERT_ARE_EQUAL(size_t, 0, g_ll_callback_count);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_014: [ prov_sc_ll_dowork shall call uhttp_client_dowork on every open connection of the pool ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_016: [ The headers of a request, including the SAS token, shall be built when the request is sent ] */
+TEST_FUNCTION(prov_sc_ll_dowork_connected_sends_request)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    prov_sc_ll_dowork(sc);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    prov_sc_ll_dowork(sc);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, prov_sc_ll_get_pending_count(sc));
+    ASSERT_ARE_EQUAL(size_t, 0, g_ll_callback_count);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_017: [ When a reply with a 2xx status is received, the callback shall be called with PROV_SC_LL_RESULT_OK and the deserialized record, bulk operation result, or query response and continuation token ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_021: [ A connection that received a reply shall be kept open for the next request, unless the keep-alive timeout is 0; any other connection shall be closed ] */
+TEST_FUNCTION(prov_sc_ll_dowork_reply_completes_request)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    prov_sc_ll_dowork(sc);
+    prov_sc_ll_dowork(sc);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Clone(IGNORED_PTR_ARG)); //this is in a callback for on_ll_http_reply_recv
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); //this is also in the callback
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(individualEnrollment_deserializeFromJson(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(IGNORED_PTR_ARG)); //in the test callback
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    prov_sc_ll_dowork(sc);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+    ASSERT_ARE_EQUAL(size_t, 1, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_OK, g_ll_result);
+    ASSERT_IS_NOT_NULL(g_ll_handle);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_021: [ A connection that received a reply shall be kept open for the next request, unless the keep-alive timeout is 0; any other connection shall be closed ] */
+TEST_FUNCTION(prov_sc_ll_get_individual_enrollment_10_requests_open_one_connection)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    int res = 0;
+    for (size_t index = 0; index < 10 && res == 0; index++)
+    {
+        res = prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    }
+
+    //act
+    run_ll_dowork(sc, 100);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+    ASSERT_ARE_EQUAL(size_t, 10, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_OK, g_ll_result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_uhttp_client_open_call_count);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_021: [ A connection that received a reply shall be kept open for the next request, unless the keep-alive timeout is 0; any other connection shall be closed ] */
+TEST_FUNCTION(prov_sc_ll_get_individual_enrollment_keep_alive_off_opens_every_request)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_set_keep_alive(sc, 0);
+    for (size_t index = 0; index < 3; index++)
+    {
+        (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    }
+
+    //act
+    run_ll_dowork(sc, 100);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 3, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_OK, g_ll_result);
+    ASSERT_ARE_EQUAL(size_t, 3, g_uhttp_client_open_call_count);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_022: [ An idle connection shall be closed once its last request is older than the keep-alive timeout ] */
+TEST_FUNCTION(prov_sc_ll_dowork_idle_connection_closed)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_set_keep_alive(sc, 30);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    run_ll_dowork(sc, 100);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG)).SetReturn((time_t)30);
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_destroy(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    prov_sc_ll_dowork(sc);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_ll_callback_count);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_018: [ When a reply with any other status is received, the callback shall be called with PROV_SC_LL_RESULT_HTTP_ERROR ] */
+TEST_FUNCTION(prov_sc_ll_get_individual_enrollment_http_error)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    g_http_status_code = 404;
+
+    //act
+    run_ll_dowork(sc, 100);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_HTTP_ERROR, g_ll_result);
+    ASSERT_IS_NULL(g_ll_handle);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_019: [ If connecting, sending or deserializing fails, the callback shall be called with PROV_SC_LL_RESULT_ERROR ] */
+TEST_FUNCTION(prov_sc_ll_get_individual_enrollment_connect_fail)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(platform_get_default_tlsio()).SetReturn(NULL);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(individualEnrollment_destroy(NULL)); //in the test callback
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    prov_sc_ll_dowork(sc);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_ERROR, g_ll_result);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_020: [ If a request fails without a reply on a connection kept from a previous request, the connection shall be closed and the request sent once more ahead of the queue ] */
+TEST_FUNCTION(prov_sc_ll_get_individual_enrollment_dropped_connection_reconnects)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    run_ll_dowork(sc, 100);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_construct_http_headers(NO_ETAG, HTTP_CLIENT_REQUEST_GET);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(HTTP_CLIENT_ERROR);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_destroy(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    expected_calls_connect_to_service();
+
+    //act
+    prov_sc_ll_dowork(sc);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(size_t, 1, prov_sc_ll_get_pending_count(sc));
+    ASSERT_ARE_EQUAL(size_t, 2, g_uhttp_client_open_call_count);
+
+    run_ll_dowork(sc, 100);
+    ASSERT_ARE_EQUAL(size_t, 2, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_OK, g_ll_result);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_048: [ A request that was written to the connection before it failed shall only be sent once more if it is a GET, a DELETE or a PUT with an ETag; the callback of any other request shall be called with PROV_SC_LL_RESULT_ERROR ] */
+TEST_FUNCTION(prov_sc_ll_get_individual_enrollment_lost_reply_resent)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    run_ll_dowork(sc, 100);
+    g_http_reply_reason = HTTP_CALLBACK_REASON_ERROR;
+
+    //act
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    run_ll_dowork(sc, 100);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 2, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_ERROR, g_ll_result);
+    ASSERT_ARE_EQUAL(size_t, 2, g_uhttp_client_open_call_count);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_048: [ A request that was written to the connection before it failed shall only be sent once more if it is a GET, a DELETE or a PUT with an ETag; the callback of any other request shall be called with PROV_SC_LL_RESULT_ERROR ] */
+TEST_FUNCTION(prov_sc_ll_run_individual_enrollment_bulk_operation_lost_reply_not_resent)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    run_ll_dowork(sc, 100);
+    g_http_reply_reason = HTTP_CALLBACK_REASON_ERROR;
+
+    //act
+    (void)prov_sc_ll_run_individual_enrollment_bulk_operation(sc, &bulkop, on_ll_bulk_operation, NULL);
+    run_ll_dowork(sc, 100);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 2, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_ERROR, g_ll_result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_uhttp_client_open_call_count);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_017: [ When a reply with a 2xx status is received, the callback shall be called with PROV_SC_LL_RESULT_OK and the deserialized record, bulk operation result, or query response and continuation token ] */
+TEST_FUNCTION(prov_sc_ll_delete_individual_enrollment_by_param_success)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+
+    //act
+    int res = prov_sc_ll_delete_individual_enrollment_by_param(sc, TEST_REGID, TEST_ETAG, on_ll_delete, NULL);
+    run_ll_dowork(sc, 100);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(size_t, 1, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_OK, g_ll_result);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_017: [ When a reply with a 2xx status is received, the callback shall be called with PROV_SC_LL_RESULT_OK and the deserialized record, bulk operation result, or query response and continuation token ] */
+TEST_FUNCTION(prov_sc_ll_run_individual_enrollment_bulk_operation_success)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    INDIVIDUAL_ENROLLMENT_HANDLE ie_arr[2] = { TEST_INDIVIDUAL_ENROLLMENT_HANDLE, TEST_INDIVIDUAL_ENROLLMENT_HANDLE2 };
+    PROVISIONING_BULK_OPERATION bulkop;
+    bulkop.version = PROVISIONING_BULK_OPERATION_VERSION_1;
+    bulkop.enrollments.ie = ie_arr;
+    bulkop.num_enrollments = 2;
+    bulkop.mode = BULK_OP_CREATE;
+    bulkop.type = BULK_OP_INDIVIDUAL_ENROLLMENT;
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+
+    //act
+    int res = prov_sc_ll_run_individual_enrollment_bulk_operation(sc, &bulkop, on_ll_bulk_operation, NULL);
+    run_ll_dowork(sc, 100);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(size_t, 1, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_OK, g_ll_result);
+    ASSERT_IS_NOT_NULL(g_ll_handle);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_017: [ When a reply with a 2xx status is received, the callback shall be called with PROV_SC_LL_RESULT_OK and the deserialized record, bulk operation result, or query response and continuation token ] */
+TEST_FUNCTION(prov_sc_ll_query_individual_enrollment_success)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_ll_query_individual_enrollment(sc, &qs, NULL, on_ll_query, NULL);
+    prov_sc_ll_dowork(sc);
+    prov_sc_ll_dowork(sc);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_dowork(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Clone(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(NULL); //cannot fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT);
+    STRICT_EXPECTED_CALL(queryType_stringToEnum(QUERY_RESPONSE_HEADER_ITEM_TYPE_VALUE_INDIVIDUAL_ENROLLMENT)); //cannot fail
+    STRICT_EXPECTED_CALL(queryResponse_deserializeFromJson(IGNORED_PTR_ARG, QUERY_TYPE_INDIVIDUAL_ENROLLMENT));
+    STRICT_EXPECTED_CALL(queryResponse_free(IGNORED_PTR_ARG)); //in the test callback
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    prov_sc_ll_dowork(sc);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_OK, g_ll_result);
+    ASSERT_IS_NOT_NULL(g_ll_handle);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_027: [ prov_sc_destroy shall close the connections of the pool and call the callback of every pending request with PROV_SC_LL_RESULT_DESTROYED ] */
+TEST_FUNCTION(prov_sc_destroy_pending_ll_requests_destroyed)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    prov_sc_ll_dowork(sc);
+
+    //act
+    prov_sc_destroy(sc);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 2, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_DESTROYED, g_ll_result);
+    ASSERT_IS_FALSE(g_http_open_pending);
+
+    //cleanup
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_023: [ If prov_client is NULL or max_connections is 0, prov_sc_ll_set_max_connections shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_ll_set_max_connections_NULL_prov_client)
+{
+    //arrange
+
+    //act
+    int res = prov_sc_ll_set_max_connections(NULL, 1);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_023: [ If prov_client is NULL or max_connections is 0, prov_sc_ll_set_max_connections shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_ll_set_max_connections_0_fail)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_ll_set_max_connections(sc, 0);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_024: [ If requests are pending, prov_sc_ll_set_max_connections shall fail and return a non-zero value ] */
+TEST_FUNCTION(prov_sc_ll_set_max_connections_pending_requests_fail)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    umock_c_reset_all_calls();
+
+    //act
+    int res = prov_sc_ll_set_max_connections(sc, 2);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_025: [ Otherwise the open connections of the pool shall be closed, the maximum set, and prov_sc_ll_set_max_connections shall return 0 ] */
+TEST_FUNCTION(prov_sc_ll_set_max_connections_closes_pool)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    (void)prov_sc_ll_get_individual_enrollment(sc, TEST_REGID, on_ll_individual_enrollment, NULL);
+    run_ll_dowork(sc, 100);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(uhttp_client_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(uhttp_client_destroy(IGNORED_PTR_ARG)); //does not fail
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); //does not fail
+
+    //act
+    int res = prov_sc_ll_set_max_connections(sc, 2);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, res);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_026: [ prov_sc_ll_get_pending_count shall return the number of requests queued or in flight, or 0 if prov_client is NULL ] */
+TEST_FUNCTION(prov_sc_ll_get_pending_count_NULL_prov_client)
+{
+    //arrange
+
+    //act
+    size_t count = prov_sc_ll_get_pending_count(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 0, count);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_034: [ If prov_client or query_spec is NULL, query_type is not an individual enrollment, enrollment group or device registration state query, or query_spec has an invalid version, prov_sc_query_iterator_create shall fail and return NULL ] */
+TEST_FUNCTION(prov_sc_query_iterator_create_NULL_prov_client)
+{
+    //arrange
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+
+    //act
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(NULL, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, &qs);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(iterator);
+
+    //cleanup
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_034: [ If prov_client or query_spec is NULL, query_type is not an individual enrollment, enrollment group or device registration state query, or query_spec has an invalid version, prov_sc_query_iterator_create shall fail and return NULL ] */
+TEST_FUNCTION(prov_sc_query_iterator_create_invalid_query_type)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    umock_c_reset_all_calls();
+
+    //act
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(sc, QUERY_TYPE_INVALID, &qs);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(iterator);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_034: [ If prov_client or query_spec is NULL, query_type is not an individual enrollment, enrollment group or device registration state query, or query_spec has an invalid version, prov_sc_query_iterator_create shall fail and return NULL ] */
+TEST_FUNCTION(prov_sc_query_iterator_create_NULL_query_spec)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    umock_c_reset_all_calls();
+
+    //act
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(sc, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(iterator);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_035: [ prov_sc_query_iterator_create shall copy query_spec and queue the request for the first page ] */
+TEST_FUNCTION(prov_sc_query_iterator_create_success)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_QUERY_STRING));
+    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(IGNORED_PTR_ARG));
+
+    //act
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(sc, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, &qs);
+
+    //assert
+    ASSERT_IS_NOT_NULL(iterator);
+    ASSERT_ARE_EQUAL(size_t, 1, prov_sc_ll_get_pending_count(sc));
+    ASSERT_ARE_EQUAL(size_t, 0, g_uhttp_client_open_call_count);
+
+    //cleanup
+    prov_sc_query_iterator_destroy(iterator);
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_036: [ If copying or queueing fails, prov_sc_query_iterator_create shall fail and return NULL ] */
+TEST_FUNCTION(prov_sc_query_iterator_create_copy_fail)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_QUERY_STRING)).SetReturn(MU_FAILURE);
+
+    //act
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(sc, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, &qs);
+
+    //assert
+    ASSERT_IS_NULL(iterator);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_036: [ If copying or queueing fails, prov_sc_query_iterator_create shall fail and return NULL ] */
+TEST_FUNCTION(prov_sc_query_iterator_create_queue_fail)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_QUERY_STRING));
+    STRICT_EXPECTED_CALL(querySpecification_serializeToJson(IGNORED_PTR_ARG)).SetReturn(NULL);
+
+    //act
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(sc, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, &qs);
+
+    //assert
+    ASSERT_IS_NULL(iterator);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_037: [ If iterator or record is NULL, prov_sc_query_iterator_next shall return PROV_SC_QUERY_ITERATOR_ERROR ] */
+TEST_FUNCTION(prov_sc_query_iterator_next_NULL_iterator)
+{
+    //arrange
+    PROVISIONING_QUERY_RECORD record;
+
+    //act
+    PROV_SC_QUERY_ITERATOR_RESULT res = prov_sc_query_iterator_next(NULL, &record);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, PROV_SC_QUERY_ITERATOR_ERROR, res);
+
+    //cleanup
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_037: [ If iterator or record is NULL, prov_sc_query_iterator_next shall return PROV_SC_QUERY_ITERATOR_ERROR ] */
+TEST_FUNCTION(prov_sc_query_iterator_next_NULL_record)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(sc, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, &qs);
+    umock_c_reset_all_calls();
+
+    //act
+    PROV_SC_QUERY_ITERATOR_RESULT res = prov_sc_query_iterator_next(iterator, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, PROV_SC_QUERY_ITERATOR_ERROR, res);
+
+    //cleanup
+    prov_sc_query_iterator_destroy(iterator);
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_038: [ prov_sc_query_iterator_next shall call prov_sc_ll_dowork once even when a record is ready, so the request for the next page progresses between records ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_039: [ Once the current page is used up, the next page shall become current and, if it came with a continuation token, the request for the page after it shall be queued right away; if the next page has not arrived, prov_sc_ll_dowork shall be called until it does, with a ThreadAPI_Sleep of 1 millisecond between calls ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_040: [ record shall be set to the next record of the current page, which moves to the caller, and prov_sc_query_iterator_next shall return PROV_SC_QUERY_ITERATOR_RECORD ] */
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_041: [ Once every page has been used up, prov_sc_query_iterator_next shall return PROV_SC_QUERY_ITERATOR_END ] */
+TEST_FUNCTION(prov_sc_query_iterator_next_prefetches_pages)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    g_query_page_count = 3;
+    g_query_page_records = 4;
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(sc, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, &qs);
+    PROVISIONING_QUERY_RECORD record;
+    PROV_SC_QUERY_ITERATOR_RESULT res;
+    size_t record_count = 0;
+    size_t pages_served_at_page_end[3] = { 0 };
+
+    //act
+    while ((res = prov_sc_query_iterator_next(iterator, &record)) == PROV_SC_QUERY_ITERATOR_RECORD)
+    {
+        ASSERT_ARE_EQUAL(int, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, record.record_type);
+        ASSERT_IS_NOT_NULL(record.record.ie);
+        if (record_count % g_query_page_records == g_query_page_records - 1)
+        {
+            pages_served_at_page_end[record_count / g_query_page_records] = g_query_pages_served;
+        }
+        individualEnrollment_destroy(record.record.ie);
+        record_count++;
+    }
+
+    //assert
+    ASSERT_ARE_EQUAL(int, PROV_SC_QUERY_ITERATOR_END, res);
+    ASSERT_ARE_EQUAL(size_t, 12, record_count);
+    ASSERT_ARE_EQUAL(size_t, 3, g_query_pages_served);
+    //the next page had already arrived by the time the caller was done with each page
+    ASSERT_ARE_EQUAL(size_t, 2, pages_served_at_page_end[0]);
+    ASSERT_ARE_EQUAL(size_t, 3, pages_served_at_page_end[1]);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+    ASSERT_ARE_EQUAL(int, PROV_SC_QUERY_ITERATOR_END, prov_sc_query_iterator_next(iterator, &record));
+
+    //cleanup
+    prov_sc_query_iterator_destroy(iterator);
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_039: [ ... if the next page has not arrived, prov_sc_ll_dowork shall be called until it does, with a ThreadAPI_Sleep of 1 millisecond between calls ] */
+TEST_FUNCTION(prov_sc_query_iterator_next_completes_other_queued_requests)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    g_query_page_count = 1;
+    g_query_page_records = 1;
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    //queued ahead of the first page, so it is sent on the only connection first
+    (void)prov_sc_ll_delete_individual_enrollment_by_param(sc, TEST_REGID, TEST_ETAG, on_ll_delete, NULL);
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(sc, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, &qs);
+    PROVISIONING_QUERY_RECORD record;
+
+    //act
+    PROV_SC_QUERY_ITERATOR_RESULT res = prov_sc_query_iterator_next(iterator, &record);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, PROV_SC_QUERY_ITERATOR_RECORD, res);
+    ASSERT_ARE_EQUAL(size_t, 1, g_ll_callback_count);
+    ASSERT_ARE_EQUAL(int, PROV_SC_LL_RESULT_OK, g_ll_result);
+    ASSERT_IS_TRUE(g_sleep_call_count > 0);
+
+    //cleanup
+    individualEnrollment_destroy(record.record.ie);
+    prov_sc_query_iterator_destroy(iterator);
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_042: [ If a page request cannot be queued or completes with any result other than PROV_SC_LL_RESULT_OK, the records already received shall still be returned, and prov_sc_query_iterator_next shall then return PROV_SC_QUERY_ITERATOR_ERROR ] */
+TEST_FUNCTION(prov_sc_query_iterator_next_page_fail)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    g_query_page_count = 3;
+    g_query_page_records = 4;
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(sc, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, &qs);
+    PROVISIONING_QUERY_RECORD record;
+    PROV_SC_QUERY_ITERATOR_RESULT res;
+    size_t record_count = 0;
+
+    ASSERT_ARE_EQUAL(int, PROV_SC_QUERY_ITERATOR_RECORD, prov_sc_query_iterator_next(iterator, &record));
+    individualEnrollment_destroy(record.record.ie);
+    record_count++;
+    g_http_status_code = 400;
+
+    //act
+    while ((res = prov_sc_query_iterator_next(iterator, &record)) == PROV_SC_QUERY_ITERATOR_RECORD)
+    {
+        individualEnrollment_destroy(record.record.ie);
+        record_count++;
+    }
+
+    //assert
+    ASSERT_ARE_EQUAL(int, PROV_SC_QUERY_ITERATOR_ERROR, res);
+    ASSERT_ARE_EQUAL(size_t, 4, record_count);
+    ASSERT_ARE_EQUAL(size_t, 1, g_query_pages_served);
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+
+    //cleanup
+    prov_sc_query_iterator_destroy(iterator);
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_043: [ If iterator is NULL, prov_sc_query_iterator_destroy shall do nothing ] */
+TEST_FUNCTION(prov_sc_query_iterator_destroy_NULL)
+{
+    //arrange
+
+    //act
+    prov_sc_query_iterator_destroy(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_044: [ prov_sc_query_iterator_destroy shall free the records not returned yet and the iterator; if a page request is in flight, the iterator shall be freed once that request completes ] */
+TEST_FUNCTION(prov_sc_query_iterator_destroy_records_left)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    g_query_page_count = 1;
+    g_query_page_records = 4;
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(sc, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, &qs);
+    PROVISIONING_QUERY_RECORD record;
+    ASSERT_ARE_EQUAL(int, PROV_SC_QUERY_ITERATOR_RECORD, prov_sc_query_iterator_next(iterator, &record));
+    individualEnrollment_destroy(record.record.ie);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(queryResponse_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(queryResponse_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    prov_sc_query_iterator_destroy(iterator);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
+/* Tests_PROVISIONING_SERVICE_CLIENT_09_044: [ prov_sc_query_iterator_destroy shall free the records not returned yet and the iterator; if a page request is in flight, the iterator shall be freed once that request completes ] */
+TEST_FUNCTION(prov_sc_query_iterator_destroy_page_in_flight)
+{
+    //arrange
+    PROVISIONING_SERVICE_CLIENT_HANDLE sc = prov_sc_create_from_connection_string(TEST_CONNECTION_STRING);
+    PROVISIONING_QUERY_SPECIFICATION qs = { 0 };
+    qs.page_size = NO_MAX_PAGE_SIZE;
+    qs.query_string = TEST_QUERY_STRING;
+    qs.version = PROVISIONING_QUERY_SPECIFICATION_VERSION_1;
+    g_query_page_count = 2;
+    g_query_page_records = 4;
+    (void)prov_sc_ll_set_max_connections(sc, 1);
+    PROV_SC_QUERY_ITERATOR_HANDLE iterator = prov_sc_query_iterator_create(sc, QUERY_TYPE_INDIVIDUAL_ENROLLMENT, &qs);
+    umock_c_reset_all_calls();
+
+    //act
+    prov_sc_query_iterator_destroy(iterator);
+    run_ll_dowork(sc, 10);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 0, prov_sc_ll_get_pending_count(sc));
+    ASSERT_ARE_EQUAL(size_t, 1, g_query_pages_served);
+
+    //cleanup
+    prov_sc_destroy(sc);
+}
+
 END_TEST_SUITE(provisioning_service_client_ut);
\ No newline at end of file
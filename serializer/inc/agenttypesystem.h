@@ -20,6 +20,7 @@
 #include "azure_c_shared_utility/agenttime.h"
 #include "azure_macro_utils/macro_utils.h"
 #include "azure_c_shared_utility/strings.h"
+#include "jsonencoder.h"
 
 /*Codes_SRS_AGENT_TYPE_SYSTEM_99_001:[ AGENT_TYPE_SYSTEM shall have the following interface]*/
 
@@ -711,6 +712,16 @@ MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, CreateAgentDataType_From_String, co
 
 MOCKABLE_FUNCTION(, COMPLEX_TYPE_FIELD_TYPE*, AgentDataType_GetComplexTypeField, AGENT_DATA_TYPE*, agentData, size_t, index);
 
+/*the following append the JSON representation of a value to destination without building an AGENT_DATA_TYPE first.
+The output is byte for byte the same as AgentDataTypes_ToString would produce for the matching AGENT_DATA_TYPE*/
+MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Int64_ToJSON, JSON_ENCODER_BUFFER*, destination, int64_t, v);
+MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Boolean_ToJSON, JSON_ENCODER_BUFFER*, destination, int, v);
+MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Double_ToJSON, JSON_ENCODER_BUFFER*, destination, double, v);
+MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Float_ToJSON, JSON_ENCODER_BUFFER*, destination, float, v);
+MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Charz_ToJSON, JSON_ENCODER_BUFFER*, destination, const char*, v);
+MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_CharzNoQuotes_ToJSON, JSON_ENCODER_BUFFER*, destination, const char*, v);
+MOCKABLE_FUNCTION(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_ToJSON, JSON_ENCODER_BUFFER*, destination, const AGENT_DATA_TYPE*, value);
+
 #ifdef __cplusplus
 }
 #endif
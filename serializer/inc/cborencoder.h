@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef CBORENCODER_H
+#define CBORENCODER_H
+
+#include "azure_macro_utils/macro_utils.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+#include "multitree.h"
+#include "jsonencoder.h"
+#include "agenttypesystem.h"
+
+#define CBOR_ENCODER_RESULT_VALUES           \
+CBOR_ENCODER_OK,                             \
+CBOR_ENCODER_INVALID_ARG,                    \
+CBOR_ENCODER_MULTITREE_ERROR,                \
+CBOR_ENCODER_UNSUPPORTED_TYPE,               \
+CBOR_ENCODER_ERROR
+
+MU_DEFINE_ENUM(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+
+/*MIME type of the bytes produced by CBOREncoder (RFC 8949)*/
+#define CBOR_ENCODER_CONTENT_TYPE "application/cbor"
+
+#include "umock_c/umock_c_prod.h"
+
+/*appends to destination the CBOR encoding of the tree: every node is a map from child names to children, every leaf holds an AGENT_DATA_TYPE*/
+MOCKABLE_FUNCTION(, CBOR_ENCODER_RESULT, CBOREncoder_EncodeTree, MULTITREE_HANDLE, treeHandle, JSON_ENCODER_BUFFER*, destination);
+MOCKABLE_FUNCTION(, CBOR_ENCODER_RESULT, CBOREncoder_EncodeValue, JSON_ENCODER_BUFFER*, destination, const AGENT_DATA_TYPE*, value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CBORENCODER_H */
@@ -85,6 +85,7 @@ typedef struct REFLECTION_PROPERTY_TAG
     size_t offset;
     size_t size;
     const char* modelName;
+    int(*ToJSON_from_Ptr)(void* param, JSON_ENCODER_BUFFER* destination);
 } REFLECTION_PROPERTY;
 
 
@@ -114,6 +115,7 @@ typedef struct REFLECTION_DESIRED_PROPERTY_TAG
 typedef struct REFLECTION_MODEL_TAG
 {
     const char* name;
+    int(*ToJSON_from_Ptr)(void* param, JSON_ENCODER_BUFFER* destination);
 } REFLECTION_MODEL;
 
 typedef struct REFLECTED_SOMETHING_TAG
@@ -157,10 +159,16 @@ CODEFIRST_AGENT_DATA_TYPE_ERROR,               \
 CODEFIRST_VALUES_FROM_DIFFERENT_DEVICES_ERROR, \
 CODEFIRST_DEVICE_FAILED,                       \
 CODEFIRST_DEVICE_PUBLISH_FAILED,               \
-CODEFIRST_NOT_A_PROPERTY
+CODEFIRST_NOT_A_PROPERTY,                      \
+CODEFIRST_BATCH_FULL
 
 MU_DEFINE_ENUM(CODEFIRST_RESULT, CODEFIRST_RESULT_VALUES)
 
+/*IoT Hub accepts device to cloud messages of up to 256KB; the rest is left for the message properties and the transport framing*/
+#define CODEFIRST_BATCH_IOTHUB_MAX_SIZE (255 * 1024)
+
+typedef struct CODEFIRST_BATCH_TAG* CODEFIRST_BATCH_HANDLE;
+
 #include "umock_c/umock_c_prod.h"
 MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_Init, const char*, overrideSchemaNamespace);
 MOCKABLE_FUNCTION(, void, CodeFirst_Deinit);
@@ -180,10 +188,32 @@ MOCKABLE_FUNCTION(, void, CodeFirst_DestroyDevice, void*, device);
 extern CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destinationSize, size_t numProperties, ...);
 extern CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t* destinationSize, size_t numReportedProperties, ...);
 
+/* Serializes only the reported properties of device that changed since the last acknowledged report. The values
+   sent stay pending under *reportToken until CodeFirst_AcknowledgeReportedProperties is called with that token,
+   typically from the reported state callback of that report on a 2xx status. When nothing changed, *destination
+   is NULL, *destinationSize is 0 and *reportToken is 0. */
+MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_SendAsyncReportedDirty, unsigned char**, destination, size_t*, destinationSize, void*, device, size_t*, reportToken);
+MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_AcknowledgeReportedProperties, void*, device, size_t, reportToken);
+
 MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_IngestDesiredProperties, void*, device, const char*, jsonPayload, bool, parseDesiredNode);
 
 MOCKABLE_FUNCTION(, AGENT_DATA_TYPE_TYPE, CodeFirst_GetPrimitiveType, const char*, typeName);
 
+/* When enabled, CodeFirst_SendAsync writes the JSON of top level properties straight into the destination buffer
+   instead of building AGENT_DATA_TYPEs and a MultiTree. Anything the direct path cannot handle falls back to the
+   transacted path, so the produced bytes do not depend on this setting. */
+MOCKABLE_FUNCTION(, void, CodeFirst_SetDirectJsonEncoding, bool, enabled);
+
+/* A batch collects many snapshots of the same values into one JSON array "[{...},{...}]" so they can be sent as a
+   single message. CodeFirst_AppendToBatch returns CODEFIRST_BATCH_FULL when the next snapshot would take the batch
+   over maxSize; flush it, send the bytes and append the snapshot again. Batches are always JSON: while another encoder
+   is set with SerializeEncoder, CodeFirst_AppendToBatch returns CODEFIRST_ERROR. */
+MOCKABLE_FUNCTION(, CODEFIRST_BATCH_HANDLE, CodeFirst_CreateBatch, size_t, maxSize);
+extern CODEFIRST_RESULT CodeFirst_AppendToBatch(CODEFIRST_BATCH_HANDLE batch, size_t numProperties, ...);
+MOCKABLE_FUNCTION(, CODEFIRST_RESULT, CodeFirst_FlushBatch, CODEFIRST_BATCH_HANDLE, batch, unsigned char**, destination, size_t*, destinationSize);
+MOCKABLE_FUNCTION(, size_t, CodeFirst_GetBatchSnapshotCount, CODEFIRST_BATCH_HANDLE, batch);
+MOCKABLE_FUNCTION(, void, CodeFirst_DestroyBatch, CODEFIRST_BATCH_HANDLE, batch);
+
 #ifdef __cplusplus
 }
 #endif
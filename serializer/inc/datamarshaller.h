@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include "agenttypesystem.h"
 #include "schema.h"
+#include "multitree.h"
 #include "azure_macro_utils/macro_utils.h"
 #include "azure_c_shared_utility/vector.h"
 #ifdef __cplusplus
@@ -25,7 +26,8 @@ DATA_MARSHALLER_JSON_ENCODER_ERROR,             \
 DATA_MARSHALLER_ERROR,                          \
 DATA_MARSHALLER_AGENT_DATA_TYPES_ERROR,         \
 DATA_MARSHALLER_MULTITREE_ERROR,                \
-DATA_MARSHALLER_ONLY_ONE_VALUE_ALLOWED          \
+DATA_MARSHALLER_ONLY_ONE_VALUE_ALLOWED,         \
+DATA_MARSHALLER_ENCODER_ERROR                   \
 
 MU_DEFINE_ENUM(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_RESULT_VALUES);
 
@@ -36,8 +38,25 @@ typedef struct DATA_MARSHALLER_VALUE_TAG
 } DATA_MARSHALLER_VALUE;
 
 typedef struct DATA_MARSHALLER_HANDLE_DATA_TAG* DATA_MARSHALLER_HANDLE;
+
+/*writes the MultiTree built by DataMarshaller_SendData (its leaves hold AGENT_DATA_TYPE*) as the payload of one message,
+*destination is allocated with malloc*/
+typedef DATA_MARSHALLER_RESULT(*DATA_MARSHALLER_ENCODE_FUNC)(MULTITREE_HANDLE treeHandle, unsigned char** destination, size_t* destinationSize);
+
+typedef struct DATA_MARSHALLER_ENCODER_TAG
+{
+    const char* contentType;        /*for IoTHubMessage_SetContentTypeSystemProperty*/
+    const char* contentEncoding;    /*for IoTHubMessage_SetContentEncodingSystemProperty, NULL when it does not apply*/
+    DATA_MARSHALLER_ENCODE_FUNC encode;
+} DATA_MARSHALLER_ENCODER;
+
 #include "umock_c/umock_c_prod.h"
 
+MOCKABLE_FUNCTION(, const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetJSONEncoder);
+MOCKABLE_FUNCTION(, const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetCBOREncoder);
+MOCKABLE_FUNCTION(, void, DataMarshaller_SetEncoder, const DATA_MARSHALLER_ENCODER*, encoder);
+MOCKABLE_FUNCTION(, const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetEncoder);
+
 MOCKABLE_FUNCTION(,DATA_MARSHALLER_HANDLE, DataMarshaller_Create, SCHEMA_MODEL_TYPE_HANDLE, modelHandle, bool, includePropertyPath);
 MOCKABLE_FUNCTION(,void, DataMarshaller_Destroy, DATA_MARSHALLER_HANDLE, dataMarshallerHandle);
 MOCKABLE_FUNCTION(,DATA_MARSHALLER_RESULT, DataMarshaller_SendData, DATA_MARSHALLER_HANDLE, dataMarshallerHandle, size_t, valueCount, const DATA_MARSHALLER_VALUE*, values, unsigned char**, destination, size_t*, destinationSize);
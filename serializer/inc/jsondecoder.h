@@ -22,8 +22,35 @@ typedef enum JSON_DECODER_RESULT_TAG
     JSON_DECODER_ERROR
 } JSON_DECODER_RESULT;
 
+typedef enum JSON_DECODER_VALUE_TYPE_TAG
+{
+    JSON_DECODER_VALUE_STRING,
+    JSON_DECODER_VALUE_NUMBER,
+    JSON_DECODER_VALUE_LITERAL,
+    JSON_DECODER_VALUE_OBJECT,
+    JSON_DECODER_VALUE_ARRAY
+} JSON_DECODER_VALUE_TYPE;
+
+typedef enum JSON_DECODER_ACTION_TAG
+{
+    JSON_DECODER_ACTION_CONTINUE,
+    JSON_DECODER_ACTION_SKIP,
+    JSON_DECODER_ACTION_ABORT
+} JSON_DECODER_ACTION;
+
+/* onValue is called for every object member (name points into the JSON, without quotes) and every array element (name is NULL).
+   Scalar values point into the JSON and keep the quotes of strings. For objects and arrays value points at the opening bracket,
+   valueLength is 0 and returning JSON_DECODER_ACTION_SKIP steps over the whole nested value.
+   onEnd is called when an object or array that was not skipped ends. */
+typedef struct JSON_DECODER_CALLBACKS_TAG
+{
+    JSON_DECODER_ACTION(*onValue)(void* context, const char* name, size_t nameLength, JSON_DECODER_VALUE_TYPE valueType, const char* value, size_t valueLength);
+    JSON_DECODER_ACTION(*onEnd)(void* context);
+} JSON_DECODER_CALLBACKS;
+
 #include "umock_c/umock_c_prod.h"
 MOCKABLE_FUNCTION(, JSON_DECODER_RESULT, JSONDecoder_JSON_To_MultiTree, char*, json, MULTITREE_HANDLE*, multiTreeHandle);
+MOCKABLE_FUNCTION(, JSON_DECODER_RESULT, JSONDecoder_JSON_To_Callbacks, const char*, json, const JSON_DECODER_CALLBACKS*, callbacks, void*, context);
 
 #ifdef __cplusplus
 }
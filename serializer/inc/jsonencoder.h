@@ -35,11 +35,24 @@ MU_DEFINE_ENUM(JSON_ENCODER_TOSTRING_RESULT, JSON_ENCODER_TOSTRING_RESULT_VALUES
 
 typedef JSON_ENCODER_TOSTRING_RESULT(*JSON_ENCODER_TOSTRING_FUNC)(STRING_HANDLE, const void* value);
 
+/*a growable output buffer used by the direct (model to JSON) encoders. The content is not zero terminated.*/
+typedef struct JSON_ENCODER_BUFFER_TAG
+{
+    char* buffer;
+    size_t length;
+    size_t capacity;
+} JSON_ENCODER_BUFFER;
+
 #include "umock_c/umock_c_prod.h"
 
 MOCKABLE_FUNCTION(, JSON_ENCODER_TOSTRING_RESULT, JSONEncoder_CharPtr_ToString, STRING_HANDLE, destination, const void*, value);
 MOCKABLE_FUNCTION(, JSON_ENCODER_RESULT, JSONEncoder_EncodeTree, MULTITREE_HANDLE, treeHandle, STRING_HANDLE, destination, JSON_ENCODER_TOSTRING_FUNC, toStringFunc);
 
+MOCKABLE_FUNCTION(, JSON_ENCODER_RESULT, JSONEncoder_Buffer_Init, JSON_ENCODER_BUFFER*, buffer, size_t, initialCapacity);
+MOCKABLE_FUNCTION(, JSON_ENCODER_RESULT, JSONEncoder_Buffer_Reserve, JSON_ENCODER_BUFFER*, buffer, size_t, additionalLength);
+MOCKABLE_FUNCTION(, JSON_ENCODER_RESULT, JSONEncoder_Buffer_Append, JSON_ENCODER_BUFFER*, buffer, const char*, source, size_t, sourceLength);
+MOCKABLE_FUNCTION(, void, JSONEncoder_Buffer_Deinit, JSON_ENCODER_BUFFER*, buffer);
+
 #ifdef __cplusplus
 }
 #endif
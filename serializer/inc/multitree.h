@@ -33,6 +33,17 @@ MU_DEFINE_ENUM(MULTITREE_RESULT, MULTITREE_RESULT_VALUES);
 typedef void (*MULTITREE_FREE_FUNCTION)(void* value);
 typedef int (*MULTITREE_CLONE_FUNCTION)(void** destination, const void* source);
 
+/*a cursor remembers the parent node of the last leaf added through it, so adding siblings does not walk the path again*/
+typedef struct MULTITREE_CURSOR_TAG
+{
+    MULTITREE_HANDLE treeHandle;
+    MULTITREE_HANDLE parentHandle;
+    char* parentPath;
+    size_t parentPathLength;
+    size_t parentPathCapacity;
+    size_t generation;
+} MULTITREE_CURSOR;
+
 #include "umock_c/umock_c_prod.h"
 MOCKABLE_FUNCTION(, MULTITREE_HANDLE, MultiTree_Create, MULTITREE_CLONE_FUNCTION, cloneFunction, MULTITREE_FREE_FUNCTION, freeFunction);
 MOCKABLE_FUNCTION(, MULTITREE_RESULT, MultiTree_AddLeaf, MULTITREE_HANDLE, treeHandle, const char*, destinationPath, const void*, value);
@@ -46,6 +57,8 @@ MOCKABLE_FUNCTION(, MULTITREE_RESULT, MultiTree_GetLeafValue, MULTITREE_HANDLE,
 MOCKABLE_FUNCTION(, MULTITREE_RESULT, MultiTree_SetValue, MULTITREE_HANDLE, treeHandle, void*, value);
 MOCKABLE_FUNCTION(, void, MultiTree_Destroy, MULTITREE_HANDLE, treeHandle);
 MOCKABLE_FUNCTION(, MULTITREE_RESULT, MultiTree_DeleteChild, MULTITREE_HANDLE, treeHandle, const char*, childName);
+MOCKABLE_FUNCTION(, MULTITREE_RESULT, MultiTree_InitCursor, MULTITREE_HANDLE, treeHandle, MULTITREE_CURSOR*, cursor);
+MOCKABLE_FUNCTION(, MULTITREE_RESULT, MultiTree_AddLeafAtCursor, MULTITREE_CURSOR*, cursor, const char*, destinationPath, const void*, value);
 
 #ifdef __cplusplus
 }
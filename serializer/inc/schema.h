@@ -74,6 +74,9 @@ typedef struct SCHEMA_MODEL_ELEMENT_TAG
 
 MOCKABLE_FUNCTION(, SCHEMA_HANDLE, Schema_Create, const char*, schemaNamespace, void*, metadata);
 MOCKABLE_FUNCTION(, void*, Schema_GetMetadata, SCHEMA_HANDLE, schemaHandle);
+/* Builds hash indexes for the by-name lookups of the models of the schema and for Schema_GetSchemaByNamespace.
+   Call it once the schema is complete; adding to a model afterwards drops the matching index. */
+MOCKABLE_FUNCTION(, SCHEMA_RESULT, Schema_Freeze, SCHEMA_HANDLE, schemaHandle);
 MOCKABLE_FUNCTION(, size_t, Schema_GetSchemaCount);
 MOCKABLE_FUNCTION(, SCHEMA_HANDLE, Schema_GetSchemaByNamespace, const char*, schemaNamespace);
 MOCKABLE_FUNCTION(, SCHEMA_HANDLE, Schema_GetSchemaForModel, const char*, modelName);
@@ -39,7 +39,9 @@ MU_DEFINE_ENUM(SERIALIZER_RESULT, SERIALIZER_RESULT_VALUES);
 
 #define SERIALIZER_CONFIG_VALUES  \
     CommandPollingInterval,     \
-    SerializeDelayedBufferMaxSize
+    SerializeDelayedBufferMaxSize, \
+    SerializeDirectJsonEncoding, \
+    SerializeEncoder
 
 /** @brief Enumeration specifying the option to set on the serializer when
  * calling ::serializer_setconfig.
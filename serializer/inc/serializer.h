@@ -55,6 +55,7 @@
 #include "methodreturn.h"
 #include "schemalib.h"
 #include "codefirst.h"
+#include "datamarshaller.h"
 #include "agenttypesystem.h"
 #include "schema.h"
 
@@ -107,6 +108,7 @@ extern "C"
     /* Codes_SRS_SERIALIZER_99_082:[ DECLARE_STRUCT's field<n>Name argument shall uniquely name a field within the struct.] */ \
     MU_FOR_EACH_2_KEEP_1(REFLECTED_FIELD, name, __VA_ARGS__) \
     TO_AGENT_DATA_TYPE(name, __VA_ARGS__) \
+    TO_JSON(name, __VA_ARGS__) \
     /*Codes_SRS_SERIALIZER_99_042:[ The parameter types are either predefined parameter types (specs SRS_SERIALIZER_99_004-SRS_SERIALIZER_99_014) or a type introduced by DECLARE_STRUCT.]*/ \
     static AGENT_DATA_TYPES_RESULT FromAGENT_DATA_TYPE_##name(const AGENT_DATA_TYPE* source, name* destination) \
     { \
@@ -170,11 +172,14 @@ extern "C"
 #define SERIALIZER_REGISTER_NAMESPACE(NAMESPACE) CodeFirst_RegisterSchema(#NAMESPACE, & ALL_REFLECTED(NAMESPACE))
 
 #define DECLARE_MODEL(name, ...)                                                             \
+    static int ToJSON_Device_##name(void* param, JSON_ENCODER_BUFFER* destination);          \
     REFLECTED_MODEL(name)                                                                    \
     MU_FOR_EACH_1(CREATE_DESIRED_PROPERTY_CALLBACK, __VA_ARGS__)                                \
     typedef struct name { int :1; MU_FOR_EACH_1(BUILD_MODEL_STRUCT, __VA_ARGS__) } name;        \
     MU_FOR_EACH_1_KEEP_1(CREATE_MODEL_ELEMENT, name, __VA_ARGS__)                               \
     TO_AGENT_DATA_TYPE(name, DROP_FIRST_COMMA_FROM_ARGS(EXPAND_MODEL_ARGS(__VA_ARGS__)))     \
+    TO_JSON(name, DROP_FIRST_COMMA_FROM_ARGS(EXPAND_MODEL_ARGS(__VA_ARGS__)))                \
+    TO_JSON_DEVICE(name, DROP_FIRST_COMMA_FROM_ARGS(EXPAND_MODEL_DATA_ARGS(__VA_ARGS__)))    \
     int FromAGENT_DATA_TYPE_##name(const AGENT_DATA_TYPE* source, void* destination)         \
     {                                                                                        \
         (void)source;                                                                        \
@@ -309,6 +314,48 @@ extern "C"
 
 #define SERIALIZE_REPORTED_PROPERTIES(destination, destinationSize,...) CodeFirst_SendAsyncReported(destination, destinationSize, MU_COUNT_ARG(__VA_ARGS__) MU_FOR_EACH_1(ADDRESS_MACRO, __VA_ARGS__))
 
+/**
+ * @def   CREATE_SERIALIZE_BATCH(maxSize)
+ * Creates a batch that collects many SERIALIZE_BATCH snapshots into one JSON
+ * array, never larger than maxSize bytes. CODEFIRST_BATCH_IOTHUB_MAX_SIZE fits
+ * a single IoT Hub device to cloud message.
+ */
+#define CREATE_SERIALIZE_BATCH(maxSize) CodeFirst_CreateBatch(maxSize)
+
+/**
+ * @def   SERIALIZE_BATCH(batch, property1, ...)
+ * Appends to batch a snapshot of the current values of the properties (or of
+ * a whole device). Returns CODEFIRST_BATCH_FULL when the snapshot does not fit
+ * anymore; the batch is then left as it was, ready to be flushed.
+ */
+#define SERIALIZE_BATCH(batch, ...) CodeFirst_AppendToBatch(batch, MU_COUNT_ARG(__VA_ARGS__) MU_FOR_EACH_1(ADDRESS_MACRO, __VA_ARGS__))
+
+/**
+ * @def   FLUSH_SERIALIZE_BATCH(batch, destination, destinationSize)
+ * Hands over the JSON array of all the snapshots in batch and empties it.
+ * *destination is NULL when the batch holds no snapshot.
+ */
+#define FLUSH_SERIALIZE_BATCH(batch, destination, destinationSize) CodeFirst_FlushBatch(batch, destination, destinationSize)
+
+#define DESTROY_SERIALIZE_BATCH(batch) CodeFirst_DestroyBatch(batch)
+
+
+/**
+ * @def   SERIALIZE_REPORTED_PROPERTIES_DIRTY(destination, destinationSize, device, reportToken)
+ * Serializes the reported properties of device (including those of its child
+ * models) that changed since the last acknowledged report and sets *reportToken
+ * to the token that acknowledges them. Nothing is produced (*destination is NULL,
+ * *reportToken is 0) when no reported property changed.
+ */
+#define SERIALIZE_REPORTED_PROPERTIES_DIRTY(destination, destinationSize, device, reportToken) CodeFirst_SendAsyncReportedDirty(destination, destinationSize, device, reportToken)
+
+/**
+ * @def   ACKNOWLEDGE_REPORTED_PROPERTIES(device, reportToken)
+ * Marks the values serialized by the SERIALIZE_REPORTED_PROPERTIES_DIRTY that
+ * returned reportToken as received by the service, so they are not sent again
+ * until they change. A token superseded by a later acknowledgement is ignored.
+ */
+#define ACKNOWLEDGE_REPORTED_PROPERTIES(device, reportToken) CodeFirst_AcknowledgeReportedProperties(device, reportToken)
 
 #define IDENTITY_MACRO(x) ,x
 #define SERIALIZE_REPORTED_PROPERTIES_FROM_POINTERS(destination, destinationSize, ...) CodeFirst_SendAsyncReported(destination, destinationSize, MU_COUNT_ARG(__VA_ARGS__) MU_FOR_EACH_1(IDENTITY_MACRO, __VA_ARGS__))
@@ -397,6 +444,24 @@ Actions are discarded, since no marshalling will be done for those when sending
 #define EXPAND_MODEL_ARGS(...) \
     MU_FOR_EACH_1_COUNTED(TO_AGENT_DT_EXPAND_ELEMENT_ARGS, __VA_ARGS__)
 
+/* These macros expand the same arguments to the WITH_DATA elements only, which are what SERIALIZE sends for a whole device:
+WITH_DATA(x, y), WITH_REPORTED_PROPERTY(x2, y2), WITH_DATA(x3, y3) becomes
+x, y, x3, y3 */
+#define TO_JSON_DEVICE_EXPAND_MODEL_PROPERTY(x, y) ,x,y
+
+#define TO_JSON_DEVICE_EXPAND_MODEL_REPORTED_PROPERTY(x, y)
+
+#define TO_JSON_DEVICE_EXPAND_MODEL_DESIRED_PROPERTY(x, y, ...)
+
+#define TO_JSON_DEVICE_EXPAND_MODEL_ACTION(...)
+
+#define TO_JSON_DEVICE_EXPAND_MODEL_METHOD(...)
+
+#define TO_JSON_DEVICE_EXPAND_ELEMENT_ARGS(N, ...) TO_JSON_DEVICE_EXPAND_##__VA_ARGS__
+
+#define EXPAND_MODEL_DATA_ARGS(...) \
+    MU_FOR_EACH_1_COUNTED(TO_JSON_DEVICE_EXPAND_ELEMENT_ARGS, __VA_ARGS__)
+
 #define TO_AGENT_DATA_TYPE(name, ...) \
     static AGENT_DATA_TYPES_RESULT ToAGENT_DATA_TYPE_##name(AGENT_DATA_TYPE *destination, const name value) \
     { \
@@ -437,6 +502,65 @@ Actions are discarded, since no marshalling will be done for those when sending
 
 #define FIELD_AS_STRING(x,y) memberNames[iMember++] = #y;
 
+/*Codes_SRS_SERIALIZER_H_09_001: [ DECLARE_STRUCT and DECLARE_MODEL shall also generate a function that writes the JSON of the struct (or model) directly into a JSON_ENCODER_BUFFER, producing the same bytes as AgentDataTypes_ToString would for the AGENT_DATA_TYPE built by ToAGENT_DATA_TYPE_name. ]*/
+#define TO_JSON(name, ...) \
+    static AGENT_DATA_TYPES_RESULT ToJSON_##name(JSON_ENCODER_BUFFER* destination, const name value) \
+    { \
+        AGENT_DATA_TYPES_RESULT result = (JSONEncoder_Buffer_Append(destination, "{", 1) == JSON_ENCODER_OK) ? AGENT_DATA_TYPES_OK : AGENT_DATA_TYPES_ERROR; \
+        size_t iMember = 0; \
+        DEFINITION_THAT_CAN_SUSTAIN_A_COMMA_STEAL(phantomName, 5); \
+        (void)value; \
+        MU_FOR_EACH_2(FIELD_TO_JSON, MU_EXPAND_TWICE(__VA_ARGS__)) \
+        {DEFINITION_THAT_CAN_SUSTAIN_A_COMMA_STEAL(phantomName, 6); } \
+        if (iMember == 0) \
+        { \
+            /*Codes_SRS_SERIALIZER_H_09_002: [ For a struct or model without data members the generated function shall return AGENT_DATA_TYPES_NOT_IMPLEMENTED. ]*/ \
+            result = AGENT_DATA_TYPES_NOT_IMPLEMENTED; \
+        } \
+        else if ((result == AGENT_DATA_TYPES_OK) && (JSONEncoder_Buffer_Append(destination, "}", 1) != JSON_ENCODER_OK)) \
+        { \
+            result = AGENT_DATA_TYPES_ERROR; \
+        } \
+        return result; \
+    }
+
+/*Codes_SRS_SERIALIZER_H_09_003: [ DECLARE_MODEL shall also generate a function that writes the JSON SERIALIZE produces for a whole device of the model: its WITH_DATA members, in the order the transacted path publishes them (the reverse of their declaration order). ]*/
+#define TO_JSON_DEVICE(name, ...) \
+    static int ToJSON_Device_##name(void* param, JSON_ENCODER_BUFFER* destination) \
+    { \
+        const name* device = (const name*)param; \
+        AGENT_DATA_TYPES_RESULT result = (JSONEncoder_Buffer_Append(destination, "{", 1) == JSON_ENCODER_OK) ? AGENT_DATA_TYPES_OK : AGENT_DATA_TYPES_ERROR; \
+        size_t iMember = 0; \
+        DEFINITION_THAT_CAN_SUSTAIN_A_COMMA_STEAL(phantomName, 7); \
+        (void)device; \
+        MU_FOR_EACH_2_REVERSE(DEVICE_FIELD_TO_JSON, MU_EXPAND_TWICE(__VA_ARGS__)) \
+        {DEFINITION_THAT_CAN_SUSTAIN_A_COMMA_STEAL(phantomName, 8); } \
+        if (iMember == 0) \
+        { \
+            /*Codes_SRS_SERIALIZER_H_09_004: [ For a model without WITH_DATA members the generated function shall return AGENT_DATA_TYPES_NOT_IMPLEMENTED. ]*/ \
+            result = AGENT_DATA_TYPES_NOT_IMPLEMENTED; \
+        } \
+        else if ((result == AGENT_DATA_TYPES_OK) && (JSONEncoder_Buffer_Append(destination, "}", 1) != JSON_ENCODER_OK)) \
+        { \
+            result = AGENT_DATA_TYPES_ERROR; \
+        } \
+        return result; \
+    }
+
+/*the member name is written as ", \"name\":", without the leading ", " for the first member*/
+#define FIELD_VALUE_TO_JSON(type, name, fieldValue) \
+    if (result == AGENT_DATA_TYPES_OK) \
+    { \
+        result = (JSONEncoder_Buffer_Append(destination, ", \"" #name "\":" + ((iMember == 0) ? 2 : 0), sizeof(", \"" #name "\":") - ((iMember == 0) ? 3 : 1)) == JSON_ENCODER_OK) \
+            ? ToJSON_##type(destination, fieldValue) \
+            : AGENT_DATA_TYPES_ERROR; \
+    } \
+    iMember++;
+
+#define FIELD_TO_JSON(type, name) FIELD_VALUE_TO_JSON(type, name, value.name)
+
+#define DEVICE_FIELD_TO_JSON(type, name) FIELD_VALUE_TO_JSON(type, name, device->name)
+
 #define REFLECTED_LIST_HEAD(name) \
     static const REFLECTED_DATA_FROM_DATAPROVIDER ALL_REFLECTED(name) = { &MU_C2(REFLECTED_, MU_C1(MU_DEC(__COUNTER__))) };
 #define REFLECTED_STRUCT(name) \
@@ -444,9 +568,9 @@ Actions are discarded, since no marshalling will be done for those when sending
 #define REFLECTED_FIELD(XstructName, XfieldType, XfieldName) \
     static const REFLECTED_SOMETHING MU_C2(REFLECTED_, MU_C1(MU_INC(__COUNTER__))) = { REFLECTION_FIELD_TYPE,                &MU_C2(REFLECTED_, MU_C1(MU_DEC(MU_DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {MU_TOSTRING(XfieldName), MU_TOSTRING(XfieldType), MU_TOSTRING(XstructName)}, {0}, {0}, {0} } };
 #define REFLECTED_MODEL(name) \
-    static const REFLECTED_SOMETHING MU_C2(REFLECTED_, MU_C1(MU_INC(__COUNTER__))) = { REFLECTION_MODEL_TYPE,                &MU_C2(REFLECTED_, MU_C1(MU_DEC(MU_DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {0}, {0}, {MU_TOSTRING(name)} } };
+    static const REFLECTED_SOMETHING MU_C2(REFLECTED_, MU_C1(MU_INC(__COUNTER__))) = { REFLECTION_MODEL_TYPE,                &MU_C2(REFLECTED_, MU_C1(MU_DEC(MU_DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {0}, {0}, {MU_TOSTRING(name), ToJSON_Device_##name} } };
 #define REFLECTED_PROPERTY(type, name, modelName) \
-    static const REFLECTED_SOMETHING MU_C2(REFLECTED_, MU_C1(MU_INC(__COUNTER__))) = { REFLECTION_PROPERTY_TYPE,             &MU_C2(REFLECTED_, MU_C1(MU_DEC(MU_DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {MU_TOSTRING(name), MU_TOSTRING(type), Create_AGENT_DATA_TYPE_From_Ptr_##modelName##name, offsetof(modelName, name), sizeof(type), MU_TOSTRING(modelName)}, {0}, {0} } };
+    static const REFLECTED_SOMETHING MU_C2(REFLECTED_, MU_C1(MU_INC(__COUNTER__))) = { REFLECTION_PROPERTY_TYPE,             &MU_C2(REFLECTED_, MU_C1(MU_DEC(MU_DEC(__COUNTER__)))), { {0}, {0}, {0}, {0}, {0}, {MU_TOSTRING(name), MU_TOSTRING(type), Create_AGENT_DATA_TYPE_From_Ptr_##modelName##name, offsetof(modelName, name), sizeof(type), MU_TOSTRING(modelName), ToJSON_From_Ptr_##modelName##name}, {0}, {0} } };
 #define REFLECTED_REPORTED_PROPERTY(type, name, modelName) \
     static const REFLECTED_SOMETHING MU_C2(REFLECTED_, MU_C1(MU_INC(__COUNTER__))) = { REFLECTION_REPORTED_PROPERTY_TYPE,    &MU_C2(REFLECTED_, MU_C1(MU_DEC(MU_DEC(__COUNTER__)))), { {0}, {0}, {MU_TOSTRING(name), MU_TOSTRING(type), Create_AGENT_DATA_TYPE_From_Ptr_##modelName##name, offsetof(modelName, name), sizeof(type), MU_TOSTRING(modelName)}, {0}, {0}, {0}, {0}, {0} } };
 
@@ -539,6 +663,10 @@ Actions are discarded, since no marshalling will be done for those when sending
     { \
         return MU_C1(ToAGENT_DATA_TYPE_##propertyType)(dest, *(propertyType*)param); \
     } \
+    static int ToJSON_From_Ptr_##modelName##propertyName(void* param, JSON_ENCODER_BUFFER* destination) \
+    { \
+        return MU_C1(ToJSON_##propertyType)(destination, *(propertyType*)param); \
+    } \
     REFLECTED_PROPERTY(propertyType, propertyName, modelName)
 
 #define IMPL_REPORTED_PROPERTY(propertyType, propertyName, modelName) \
@@ -831,6 +959,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, double)(AGENT_DATA_TYPE
     return Create_AGENT_DATA_TYPE_from_DOUBLE(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, double)(JSON_ENCODER_BUFFER* destination, double source)
+{
+    return AgentDataTypes_Double_ToJSON(destination, source);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, double)(const AGENT_DATA_TYPE* agentData, double* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -863,6 +996,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, float)(AGENT_DATA_TYPE*
     return Create_AGENT_DATA_TYPE_from_FLOAT(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, float)(JSON_ENCODER_BUFFER* destination, float source)
+{
+    return AgentDataTypes_Float_ToJSON(destination, source);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, float)(const AGENT_DATA_TYPE* agentData, float* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -896,6 +1034,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, int)(AGENT_DATA_TYPE* d
     return Create_AGENT_DATA_TYPE_from_SINT32(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, int)(JSON_ENCODER_BUFFER* destination, int source)
+{
+    return AgentDataTypes_Int64_ToJSON(destination, source);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, int)(const AGENT_DATA_TYPE* agentData, int* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -928,6 +1071,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, long)(AGENT_DATA_TYPE*
     return Create_AGENT_DATA_TYPE_from_SINT64(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, long)(JSON_ENCODER_BUFFER* destination, long source)
+{
+    return AgentDataTypes_Int64_ToJSON(destination, source);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, long)(const AGENT_DATA_TYPE* agentData, long* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -961,6 +1109,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, int8_t)(AGENT_DATA_TYPE
     return Create_AGENT_DATA_TYPE_from_SINT8(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, int8_t)(JSON_ENCODER_BUFFER* destination, int8_t source)
+{
+    return AgentDataTypes_Int64_ToJSON(destination, source);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, int8_t)(const AGENT_DATA_TYPE* agentData, int8_t* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -993,6 +1146,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, uint8_t)(AGENT_DATA_TYP
     return Create_AGENT_DATA_TYPE_from_UINT8(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, uint8_t)(JSON_ENCODER_BUFFER* destination, uint8_t source)
+{
+    return AgentDataTypes_Int64_ToJSON(destination, source);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, uint8_t)(const AGENT_DATA_TYPE* agentData, uint8_t* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1026,6 +1184,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, int16_t)(AGENT_DATA_TYP
     return Create_AGENT_DATA_TYPE_from_SINT16(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, int16_t)(JSON_ENCODER_BUFFER* destination, int16_t source)
+{
+    return AgentDataTypes_Int64_ToJSON(destination, source);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, int16_t)(const AGENT_DATA_TYPE* agentData, int16_t* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1058,6 +1221,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, int32_t)(AGENT_DATA_TYP
     return Create_AGENT_DATA_TYPE_from_SINT32(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, int32_t)(JSON_ENCODER_BUFFER* destination, int32_t source)
+{
+    return AgentDataTypes_Int64_ToJSON(destination, source);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, int32_t)(const AGENT_DATA_TYPE* agentData, int32_t* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1090,6 +1258,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, int64_t)(AGENT_DATA_TYP
     return Create_AGENT_DATA_TYPE_from_SINT64(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, int64_t)(JSON_ENCODER_BUFFER* destination, int64_t source)
+{
+    return AgentDataTypes_Int64_ToJSON(destination, source);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, int64_t)(const AGENT_DATA_TYPE* agentData, int64_t* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1121,6 +1294,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, bool)(AGENT_DATA_TYPE*
     return Create_EDM_BOOLEAN_from_int(dest, source == true);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, bool)(JSON_ENCODER_BUFFER* destination, bool source)
+{
+    return AgentDataTypes_Boolean_ToJSON(destination, source == true);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, bool)(const AGENT_DATA_TYPE* agentData, bool* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1152,6 +1330,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, ascii_char_ptr)(AGENT_D
     return Create_AGENT_DATA_TYPE_from_charz(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, ascii_char_ptr)(JSON_ENCODER_BUFFER* destination, ascii_char_ptr source)
+{
+    return AgentDataTypes_Charz_ToJSON(destination, source);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, ascii_char_ptr)(const AGENT_DATA_TYPE* agentData, ascii_char_ptr* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1199,6 +1382,11 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, ascii_char_ptr_no_quote
     return Create_AGENT_DATA_TYPE_from_charz_no_quotes(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, ascii_char_ptr_no_quotes)(JSON_ENCODER_BUFFER* destination, ascii_char_ptr_no_quotes source)
+{
+    return AgentDataTypes_CharzNoQuotes_ToJSON(destination, source);
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, ascii_char_ptr_no_quotes)(const AGENT_DATA_TYPE* agentData, ascii_char_ptr_no_quotes* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1247,6 +1435,18 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, EDM_DATE_TIME_OFFSET)(A
     return Create_AGENT_DATA_TYPE_from_EDM_DATE_TIME_OFFSET(dest, source);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, EDM_DATE_TIME_OFFSET)(JSON_ENCODER_BUFFER* destination, EDM_DATE_TIME_OFFSET source)
+{
+    AGENT_DATA_TYPES_RESULT result;
+    AGENT_DATA_TYPE agentData;
+    if ((result = MU_C2(ToAGENT_DATA_TYPE_, EDM_DATE_TIME_OFFSET)(&agentData, source)) == AGENT_DATA_TYPES_OK)
+    {
+        result = AgentDataTypes_ToJSON(destination, &agentData);
+        Destroy_AGENT_DATA_TYPE(&agentData);
+    }
+    return result;
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, EDM_DATE_TIME_OFFSET)(const AGENT_DATA_TYPE* agentData, EDM_DATE_TIME_OFFSET* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1279,6 +1479,18 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, EDM_GUID)(AGENT_DATA_TY
     return Create_AGENT_DATA_TYPE_from_EDM_GUID(dest, guid);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, EDM_GUID)(JSON_ENCODER_BUFFER* destination, EDM_GUID guid)
+{
+    AGENT_DATA_TYPES_RESULT result;
+    AGENT_DATA_TYPE agentData;
+    if ((result = MU_C2(ToAGENT_DATA_TYPE_, EDM_GUID)(&agentData, guid)) == AGENT_DATA_TYPES_OK)
+    {
+        result = AgentDataTypes_ToJSON(destination, &agentData);
+        Destroy_AGENT_DATA_TYPE(&agentData);
+    }
+    return result;
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, EDM_GUID)(const AGENT_DATA_TYPE* agentData, EDM_GUID* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1312,6 +1524,18 @@ static AGENT_DATA_TYPES_RESULT MU_C2(ToAGENT_DATA_TYPE_, EDM_BINARY)(AGENT_DATA_
     return Create_AGENT_DATA_TYPE_from_EDM_BINARY(dest, edmBinary);
 }
 
+static AGENT_DATA_TYPES_RESULT MU_C2(ToJSON_, EDM_BINARY)(JSON_ENCODER_BUFFER* destination, EDM_BINARY edmBinary)
+{
+    AGENT_DATA_TYPES_RESULT result;
+    AGENT_DATA_TYPE agentData;
+    if ((result = MU_C2(ToAGENT_DATA_TYPE_, EDM_BINARY)(&agentData, edmBinary)) == AGENT_DATA_TYPES_OK)
+    {
+        result = AgentDataTypes_ToJSON(destination, &agentData);
+        Destroy_AGENT_DATA_TYPE(&agentData);
+    }
+    return result;
+}
+
 static AGENT_DATA_TYPES_RESULT MU_C2(FromAGENT_DATA_TYPE_, EDM_BINARY)(const AGENT_DATA_TYPE* agentData, EDM_BINARY* dest)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -48,23 +48,14 @@
 
 #define GUID_STRING_LENGTH 38
 
-// This is an artificial upper limit on floating point string length
-// (e.g. the size of the string when printing %f). It is set to twice the
-// maximum decimal precision plus 2. 1 for the decimal point and 1 for a
-// sign (+/-)
-// Unfortunately it is quite possible to print a float larger than this.
-// An example of this would be printf("%.*f", MAX_FLOATING_POINT_STRING_LENGTH, 1.3);
-// But currently no explicit requests for this exist in the file nor are
-// any expected to reasonably occur when being used (numbers that hit
-// this limit would be experiencing significant precision loss in storage anyway.
-#define MAX_FLOATING_POINT_STRING_LENGTH (DECIMAL_DIG *2 + 2)
-
-// This maximum length is 11 for 32 bit integers (including the sign)
-// optionally increase to 21 if longs are 64 bit
-#define MAX_LONG_STRING_LENGTH ( 11 + (10 * (sizeof(long)/ 8)))
+// Longest output of writeDouble/writeFloat: a sign, 21 digits and ".0", or a sign, "0.", 5 zeroes and 17 digits
+#define MAX_SHORTEST_FLOATING_POINT_STRING_LENGTH 32
 
 // This is the maximum length for the largest 64 bit number (signed)
-#define MAX_ULONG_LONG_STRING_LENGTH 20
+#define MAX_INT64_STRING_LENGTH 20
+
+// Quotes, 6 date and time fields, the fractional seconds and 2 time zone fields, each with its separator
+#define MAX_DATE_TIME_OFFSET_STRING_LENGTH (2 + 9 * (MAX_INT64_STRING_LENGTH + 1))
 
 MU_DEFINE_ENUM_STRINGS(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT_VALUES);
 
@@ -132,6 +123,481 @@ static char base64b8(unsigned char val)
 };
 
 /*creates an AGENT_DATA_TYPE containing a EDM_BOOLEAN from a int*/
+static const char digitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static size_t countDecimalDigits(uint64_t v)
+{
+    size_t result = 1;
+    while (v >= 10000)
+    {
+        v /= 10000;
+        result += 4;
+    }
+    result += (v >= 10) + (v >= 100) + (v >= 1000);
+    return result;
+}
+
+/*writes v in decimal, left padded with zeroes up to minDigits digits, two digits at a time. Returns the number of characters written (no '\0')*/
+static size_t writeUint64(char* destination, uint64_t v, size_t minDigits)
+{
+    size_t nDigits = countDecimalDigits(v);
+    size_t length = (nDigits < minDigits) ? minDigits : nDigits;
+    size_t pos = length;
+
+    while (v >= 100)
+    {
+        size_t pair = (size_t)(v % 100) * 2;
+        v /= 100;
+        destination[--pos] = digitPairs[pair + 1];
+        destination[--pos] = digitPairs[pair];
+    }
+
+    if (v >= 10)
+    {
+        destination[--pos] = digitPairs[v * 2 + 1];
+        destination[--pos] = digitPairs[v * 2];
+    }
+    else
+    {
+        destination[--pos] = (char)('0' + v);
+    }
+
+    while (pos > 0)
+    {
+        destination[--pos] = '0';
+    }
+
+    return length;
+}
+
+/*same as printf's "%.*d" (or "%+.*d" when forceSign is true) with minDigits as precision*/
+static size_t writeInt64(char* destination, int64_t v, size_t minDigits, bool forceSign)
+{
+    size_t result;
+
+    if (v < 0)
+    {
+        destination[0] = '-';
+        result = 1 + writeUint64(destination + 1, (uint64_t)0 - (uint64_t)v, minDigits);
+    }
+    else if (forceSign)
+    {
+        destination[0] = '+';
+        result = 1 + writeUint64(destination + 1, (uint64_t)v, minDigits);
+    }
+    else
+    {
+        result = writeUint64(destination, (uint64_t)v, minDigits);
+    }
+
+    return result;
+}
+
+/*produces "YYYY-MM-DDTHH:MM:SS[.ffffffffffff](Z|+HH:MM)" between quotes, the same as the sprintf_s formats that were used before*/
+static size_t writeDateTimeOffset(char* destination, const EDM_DATE_TIME_OFFSET* value)
+{
+    size_t pos = 0;
+
+    destination[pos++] = '\"';
+    pos += writeInt64(destination + pos, (int64_t)value->dateTime.tm_year + 1900, 4, false);
+    destination[pos++] = '-';
+    pos += writeInt64(destination + pos, (int64_t)value->dateTime.tm_mon + 1, 2, false);
+    destination[pos++] = '-';
+    pos += writeInt64(destination + pos, value->dateTime.tm_mday, 2, false);
+    destination[pos++] = 'T';
+    pos += writeInt64(destination + pos, value->dateTime.tm_hour, 2, false);
+    destination[pos++] = ':';
+    pos += writeInt64(destination + pos, value->dateTime.tm_min, 2, false);
+    destination[pos++] = ':';
+    pos += writeInt64(destination + pos, value->dateTime.tm_sec, 2, false);
+
+    if (value->hasFractionalSecond)
+    {
+        destination[pos++] = '.';
+        pos += writeUint64(destination + pos, value->fractionalSecond, 12);
+    }
+
+    if (value->hasTimeZone)
+    {
+        pos += writeInt64(destination + pos, value->timeZoneHour, 2, true);
+        destination[pos++] = ':';
+        pos += writeInt64(destination + pos, value->timeZoneMinute, 2, false);
+    }
+    else
+    {
+        destination[pos++] = 'Z';
+    }
+
+    destination[pos++] = '\"';
+    return pos;
+}
+
+#ifndef NO_FLOATS
+/*shortest round trip formatting of floating point numbers is done with the Grisu2 algorithm (Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers", PLDI 2010).*/
+/*It only uses 64 bit integer arithmetic and does not depend on the C locale.*/
+typedef struct DIY_FP_TAG
+{
+    uint64_t f;
+    int e;
+} DIY_FP;
+
+/*normalized 10^-348, 10^-340, ..., 10^340 (f * 2^e, f rounded to 64 bits)*/
+static const uint64_t cachedPowersSignificand[] =
+{
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+    0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+    0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+    0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+    0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+    0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+    0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+    0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+    0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+    0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+    0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+    0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+    0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+    0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+    0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+
+static const int16_t cachedPowersBinaryExponent[] =
+{
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066
+};
+
+static const uint64_t powersOf10[] =
+{
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+    10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+static DIY_FP diyFpNormalize(DIY_FP x)
+{
+    while ((x.f & 0x8000000000000000ULL) == 0)
+    {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
+
+/*returns the upper 64 bits of x.f * y.f (rounded)*/
+static DIY_FP diyFpMultiply(DIY_FP x, DIY_FP y)
+{
+    DIY_FP result;
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & 0xFFFFFFFFULL;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & 0xFFFFFFFFULL;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & 0xFFFFFFFFULL) + (bc & 0xFFFFFFFFULL);
+    tmp += 1ULL << 31;
+    result.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+    result.e = x.e + y.e + 64;
+    return result;
+}
+
+/*picks the cached power of 10 that brings a number with binary exponent e in the [-60, -32] binary exponent range. *K receives the decimal exponent that was used*/
+static DIY_FP getCachedPower(int e, int* K)
+{
+    DIY_FP result;
+    double dk = (-61 - e) * 0.30102999566398114 + 347; /*0.30102999566398114 = log10(2)*/
+    int k = (int)dk;
+    size_t index;
+
+    if (dk - k > 0.0)
+    {
+        k++;
+    }
+
+    index = (size_t)((k >> 3) + 1);
+    *K = -(-348 + (int)(index << 3));
+    result.f = cachedPowersSignificand[index];
+    result.e = cachedPowersBinaryExponent[index];
+    return result;
+}
+
+static void grisuRound(char* buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+    while ((rest < distance) && (delta - rest >= tenKappa) &&
+        ((rest + tenKappa < distance) || (distance - rest > rest + tenKappa - distance)))
+    {
+        buffer[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+/*generates the shortest digits of a number in [Wm, Wp] that is closest to W*/
+static void digitGen(DIY_FP W, DIY_FP Mp, uint64_t delta, char* buffer, int* length, int* K)
+{
+    DIY_FP one;
+    uint64_t distance = Mp.f - W.f;
+    uint32_t p1;
+    uint64_t p2;
+    int kappa;
+
+    one.f = 1ULL << -Mp.e;
+    one.e = Mp.e;
+    p1 = (uint32_t)(Mp.f >> -one.e);
+    p2 = Mp.f & (one.f - 1);
+    kappa = (int)countDecimalDigits(p1);
+    *length = 0;
+
+    while (kappa > 0)
+    {
+        uint32_t d = p1 / (uint32_t)powersOf10[kappa - 1];
+        uint64_t rest;
+        p1 %= (uint32_t)powersOf10[kappa - 1];
+
+        if ((d != 0) || (*length != 0))
+        {
+            buffer[(*length)++] = (char)('0' + d);
+        }
+        kappa--;
+
+        rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta)
+        {
+            *K += kappa;
+            grisuRound(buffer, *length, delta, rest, powersOf10[kappa] << -one.e, distance);
+            return;
+        }
+    }
+
+    for (;;)
+    {
+        char d;
+        p2 *= 10;
+        delta *= 10;
+        d = (char)(p2 >> -one.e);
+        if ((d != 0) || (*length != 0))
+        {
+            buffer[(*length)++] = (char)('0' + d);
+        }
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *K += kappa;
+            grisuRound(buffer, *length, delta, p2, one.f, (-kappa < 20) ? distance * powersOf10[-kappa] : 0);
+            return;
+        }
+    }
+}
+
+static size_t writeExponent(char* destination, int K)
+{
+    size_t pos = 0;
+    if (K < 0)
+    {
+        destination[pos++] = '-';
+        K = -K;
+    }
+    pos += writeUint64(destination + pos, (uint64_t)K, 1);
+    return pos;
+}
+
+/*turns the digits d1d2...dn and the exponent K (value = d1d2...dn * 10^K) into JSON: 1.5, 21.0, 0.001, 1e30, 1.25e-7*/
+static size_t prettify(char* buffer, int length, int K)
+{
+    size_t result;
+    int kk = length + K; /*10^(kk-1) <= value < 10^kk*/
+
+    if ((K >= 0) && (kk <= 21))
+    {
+        /*1234e7 -> 12340000000.0*/
+        int i;
+        for (i = length; i < kk; i++)
+        {
+            buffer[i] = '0';
+        }
+        buffer[kk] = '.';
+        buffer[kk + 1] = '0';
+        result = (size_t)kk + 2;
+    }
+    else if ((kk > 0) && (kk <= 21))
+    {
+        /*1234e-2 -> 12.34*/
+        (void)memmove(&buffer[kk + 1], &buffer[kk], (size_t)(length - kk));
+        buffer[kk] = '.';
+        result = (size_t)length + 1;
+    }
+    else if ((kk > -6) && (kk <= 0))
+    {
+        /*1234e-6 -> 0.001234*/
+        int offset = 2 - kk;
+        int i;
+        (void)memmove(&buffer[offset], &buffer[0], (size_t)length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        for (i = 2; i < offset; i++)
+        {
+            buffer[i] = '0';
+        }
+        result = (size_t)(length + offset);
+    }
+    else if (length == 1)
+    {
+        /*1e30*/
+        buffer[1] = 'e';
+        result = 2 + writeExponent(&buffer[2], kk - 1);
+    }
+    else
+    {
+        /*1234e30 -> 1.234e33*/
+        (void)memmove(&buffer[2], &buffer[1], (size_t)(length - 1));
+        buffer[1] = '.';
+        buffer[length + 1] = 'e';
+        result = (size_t)length + 2 + writeExponent(&buffer[length + 2], kk - 1);
+    }
+
+    return result;
+}
+
+/*writes the shortest decimal that reads back as significand * 2^exponent. hiddenBit is the implicit leading bit of the type (its boundaries are asymmetric at powers of 2)*/
+static size_t writeShortestDecimal(char* destination, uint64_t significand, int exponent, uint64_t hiddenBit)
+{
+    DIY_FP v;
+    DIY_FP plus;
+    DIY_FP minus;
+    DIY_FP cachedPower;
+    DIY_FP W;
+    DIY_FP Wp;
+    DIY_FP Wm;
+    int K;
+    int length;
+
+    v.f = significand;
+    v.e = exponent;
+
+    plus.f = (v.f << 1) + 1;
+    plus.e = v.e - 1;
+    plus = diyFpNormalize(plus);
+
+    if (v.f == hiddenBit)
+    {
+        minus.f = (v.f << 2) - 1;
+        minus.e = v.e - 2;
+    }
+    else
+    {
+        minus.f = (v.f << 1) - 1;
+        minus.e = v.e - 1;
+    }
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    cachedPower = getCachedPower(plus.e, &K);
+    W = diyFpMultiply(diyFpNormalize(v), cachedPower);
+    Wp = diyFpMultiply(plus, cachedPower);
+    Wm = diyFpMultiply(minus, cachedPower);
+    Wm.f++;
+    Wp.f--;
+
+    digitGen(W, Wp, Wp.f - Wm.f, destination, &length, &K);
+    return prettify(destination, length, K);
+}
+
+/*destination needs MAX_SHORTEST_FLOATING_POINT_STRING_LENGTH bytes. NaN and infinities are handled by the callers*/
+static size_t writeDouble(char* destination, double value)
+{
+    size_t result;
+    uint64_t bits;
+    uint64_t significand;
+    int biasedExponent;
+
+    (void)memcpy(&bits, &value, sizeof(bits));
+    significand = bits & 0x000FFFFFFFFFFFFFULL;
+    biasedExponent = (int)((bits >> 52) & 0x7FF);
+
+    result = 0;
+    if ((bits >> 63) != 0)
+    {
+        destination[result++] = '-';
+    }
+
+    if ((biasedExponent == 0) && (significand == 0))
+    {
+        (void)memcpy(destination + result, "0.0", 3);
+        result += 3;
+    }
+    else if (biasedExponent == 0)
+    {
+        result += writeShortestDecimal(destination + result, significand, -1074, 0x0010000000000000ULL);
+    }
+    else
+    {
+        result += writeShortestDecimal(destination + result, significand | 0x0010000000000000ULL, biasedExponent - 1075, 0x0010000000000000ULL);
+    }
+
+    return result;
+}
+
+/*same as writeDouble, but the digits are the shortest that read back as the same float*/
+static size_t writeFloat(char* destination, float value)
+{
+    size_t result;
+    uint32_t bits;
+    uint32_t significand;
+    int biasedExponent;
+
+    (void)memcpy(&bits, &value, sizeof(bits));
+    significand = bits & 0x007FFFFFU;
+    biasedExponent = (int)((bits >> 23) & 0xFF);
+
+    result = 0;
+    if ((bits >> 31) != 0)
+    {
+        destination[result++] = '-';
+    }
+
+    if ((biasedExponent == 0) && (significand == 0))
+    {
+        (void)memcpy(destination + result, "0.0", 3);
+        result += 3;
+    }
+    else if (biasedExponent == 0)
+    {
+        result += writeShortestDecimal(destination + result, significand, -149, 0x00800000U);
+    }
+    else
+    {
+        result += writeShortestDecimal(destination + result, significand | 0x00800000U, biasedExponent - 150, 0x00800000U);
+    }
+
+    return result;
+}
+#endif
+
 AGENT_DATA_TYPES_RESULT Create_EDM_BOOLEAN_from_int(AGENT_DATA_TYPE* agentData, int v)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1370,12 +1836,8 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
             }
             case(EDM_BYTE_TYPE) :
             {
-                char tempbuffer2[4]; /*because bytes can at most be 255 and that is 3 characters + 1 for '\0'*/
-                size_t pos = 0;
-                if (value->value.edmByte.value >= 100) tempbuffer2[pos++] = '0' + (value->value.edmByte.value / 100);
-                if (value->value.edmByte.value >= 10) tempbuffer2[pos++] = '0' + (value->value.edmByte.value % 100) / 10;
-                tempbuffer2[pos++] = '0' + (value->value.edmByte.value % 10);
-                tempbuffer2[pos++] = '\0';
+                char tempbuffer2[MAX_INT64_STRING_LENGTH + 1];
+                tempbuffer2[writeInt64(tempbuffer2, value->value.edmByte.value, 1, false)] = '\0';
 
                 if (STRING_concat(destination, tempbuffer2) != 0)
                 {
@@ -1429,228 +1891,17 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
             {
                 /*Codes_SRS_AGENT_TYPE_SYSTEM_99_019:[ EDM_DATETIMEOFFSET: dateTimeOffsetValue = year "-" month "-" day "T" hour ":" minute [ ":" second [ "." fractionalSeconds ] ] ( "Z" / sign hour ":" minute )]*/
                 /*from ABNF seems like these numbers HAVE to be padded with zeroes*/
-                if (value->value.edmDateTimeOffset.hasTimeZone)
-                {
-                    if (value->value.edmDateTimeOffset.hasFractionalSecond)
-                    {
-                        size_t tempBufferSize = 1 + // \"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // .
-                            MAX_ULONG_LONG_STRING_LENGTH + // %.12llu
-                            1 + MAX_LONG_STRING_LENGTH + // %+.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + //\"
-                            1;  // " (terminating NULL);
-
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d.%.12llu%+.2d:%.2d\"", /*+ in printf forces the sign to appear*/
-                                value->value.edmDateTimeOffset.dateTime.tm_year+1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec,
-                                value->value.edmDateTimeOffset.fractionalSecond,
-                                value->value.edmDateTimeOffset.timeZoneHour,
-                                value->value.edmDateTimeOffset.timeZoneMinute) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
+                char tempBuffer[MAX_DATE_TIME_OFFSET_STRING_LENGTH + 1];
+                tempBuffer[writeDateTimeOffset(tempBuffer, &value->value.edmDateTimeOffset)] = '\0';
 
-                            // Clean up temp buffer if allocated
-                            free(tempBuffer);
-                        }
-                    }
-                    else
-                    {
-                        size_t tempBufferSize = 1 + // \"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + MAX_LONG_STRING_LENGTH + // %+.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // \"
-                            1; // " terminating NULL
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d%+.2d:%.2d\"", /*+ in printf forces the sign to appear*/
-                                value->value.edmDateTimeOffset.dateTime.tm_year + 1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec,
-                                value->value.edmDateTimeOffset.timeZoneHour,
-                                value->value.edmDateTimeOffset.timeZoneMinute) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
-
-                            // Clean up temp buffer if allocated
-                            free(tempBuffer);
-                        }
-                    }
+                if (STRING_concat(destination, tempBuffer) != 0)
+                {
+                    result = AGENT_DATA_TYPES_ERROR;
+                    LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                 }
                 else
                 {
-                    if (value->value.edmDateTimeOffset.hasFractionalSecond)
-                    {
-                        size_t tempBufferSize = 1 + //\"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // .
-                            MAX_ULONG_LONG_STRING_LENGTH + // %.12llu
-                            1 + // Z
-                            1 + // \"
-                            1; // " (terminating NULL)
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2d.%.12lluZ\"", /*+ in printf forces the sign to appear*/
-                                value->value.edmDateTimeOffset.dateTime.tm_year + 1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec,
-                                value->value.edmDateTimeOffset.fractionalSecond) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
-
-                            free(tempBuffer);
-                        }
-                    }
-                    else
-                    {
-                        size_t tempBufferSize = 1 + // \"
-                            MAX_LONG_STRING_LENGTH + // %.4d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // -
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // T
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // :
-                            MAX_LONG_STRING_LENGTH + // %.2d
-                            1 + // Z
-                            1 + // \"
-                            1; // " (terminating null);
-
-                        char* tempBuffer = (char*)malloc(tempBufferSize);
-
-                        if (tempBuffer == NULL)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            if (sprintf_s(tempBuffer, tempBufferSize, "\"%.4d-%.2d-%.2dT%.2d:%.2d:%.2dZ\"",
-                                value->value.edmDateTimeOffset.dateTime.tm_year + 1900,
-                                value->value.edmDateTimeOffset.dateTime.tm_mon+1,
-                                value->value.edmDateTimeOffset.dateTime.tm_mday,
-                                value->value.edmDateTimeOffset.dateTime.tm_hour,
-                                value->value.edmDateTimeOffset.dateTime.tm_min,
-                                value->value.edmDateTimeOffset.dateTime.tm_sec) < 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else if (STRING_concat(destination, tempBuffer) != 0)
-                            {
-                                result = AGENT_DATA_TYPES_ERROR;
-                                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                            }
-                            else
-                            {
-                                result = AGENT_DATA_TYPES_OK;
-                            }
-
-                            free(tempBuffer);
-                        }
-                    }
+                    result = AGENT_DATA_TYPES_OK;
                 }
                 break;
             }
@@ -1670,36 +1921,10 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
             case (EDM_INT16_TYPE) :
             {
                 /*-32768 to +32767*/
-                char buffertemp2[7]; /*because 5 digits and sign and '\0'*/
-                uint16_t positiveValue;
-                size_t pos = 0;
-                uint16_t rank = (uint16_t)10000;
-                bool foundFirstDigit = false;
+                char tempbuffer2[MAX_INT64_STRING_LENGTH + 1];
+                tempbuffer2[writeInt64(tempbuffer2, value->value.edmInt16.value, 1, false)] = '\0';
 
-                if (value->value.edmInt16.value < 0)
-                {
-                    buffertemp2[pos++] = '-';
-                    positiveValue = -value->value.edmInt16.value;
-                }
-                else
-                {
-                    positiveValue = value->value.edmInt16.value;
-                }
-
-                while (rank >= 10)
-                {
-                    if ((foundFirstDigit == true) || (positiveValue / rank) > 0)
-                    {
-                        buffertemp2[pos++] = '0' + (char)(positiveValue / rank);
-                        foundFirstDigit = true;
-                    }
-                    positiveValue %= rank;
-                    rank /= 10;
-                }
-                buffertemp2[pos++] = '0' + (char)(positiveValue);
-                buffertemp2[pos++] = '\0';
-
-                if (STRING_concat(destination, buffertemp2) != 0)
+                if (STRING_concat(destination, tempbuffer2) != 0)
                 {
                     result = AGENT_DATA_TYPES_ERROR;
                     LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
@@ -1713,78 +1938,26 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
             case (EDM_INT32_TYPE) :
             {
                 /*-2147483648 to +2147483647*/
-                char buffertemp2[12]; /*because 10 digits and sign and '\0'*/
-                uint32_t positiveValue;
-                size_t pos = 0;
-                uint32_t rank = 1000000000UL;
-                bool foundFirstDigit = false;
-
-                if (value->value.edmInt32.value < 0)
-                {
-                    buffertemp2[pos++] = '-';
-                    positiveValue = - value->value.edmInt32.value;
-                }
-                else
-                {
-                    positiveValue = value->value.edmInt32.value;
-                }
-
-                while (rank >= 10)
-                {
-                    if ((foundFirstDigit == true) || (positiveValue / rank) > 0)
-                    {
-                        buffertemp2[pos++] = '0' + (char)(positiveValue / rank);
-                        foundFirstDigit = true;
-                    }
-                    positiveValue %= rank;
-                    rank /= 10;
-                }
-                buffertemp2[pos++] = '0' + (char)(positiveValue);
-                buffertemp2[pos++] = '\0';
+                char tempbuffer2[MAX_INT64_STRING_LENGTH + 1];
+                tempbuffer2[writeInt64(tempbuffer2, value->value.edmInt32.value, 1, false)] = '\0';
 
-                if (STRING_concat(destination, buffertemp2) != 0)
+                if (STRING_concat(destination, tempbuffer2) != 0)
                 {
                     result = AGENT_DATA_TYPES_ERROR;
                     LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                 }
                 else
                 {
-                    result = AGENT_DATA_TYPES_OK;
-                }
-                break;
-            }
-            case (EDM_INT64_TYPE):
-            {
-                char buffertemp2[21]; /*because 19 digits and sign and '\0'*/
-                uint64_t positiveValue;
-                size_t pos = 0;
-                uint64_t rank = 10000000000000000000ULL;
-                bool foundFirstDigit = false;
-
-                if (value->value.edmInt64.value < 0)
-                {
-                    buffertemp2[pos++] = '-';
-                    positiveValue = -value->value.edmInt64.value;
-                }
-                else
-                {
-                    positiveValue = value->value.edmInt64.value;
-                }
-
-                while (rank >= 10)
-                {
-                    if ((foundFirstDigit == true) || (positiveValue / rank) > 0)
-                    {
-                        buffertemp2[pos++] = '0' + (char)(positiveValue / rank);
-                        foundFirstDigit = true;
-                    }
-                    positiveValue %= rank;
-                    rank /= 10;
+                    result = AGENT_DATA_TYPES_OK;
                 }
-                buffertemp2[pos++] = '0' + (char)(positiveValue);
-                buffertemp2[pos++] = '\0';
+                break;
+            }
+            case (EDM_INT64_TYPE):
+            {
+                char tempbuffer2[MAX_INT64_STRING_LENGTH + 1];
+                tempbuffer2[writeInt64(tempbuffer2, value->value.edmInt64.value, 1, false)] = '\0';
 
-                if (STRING_concat(destination, buffertemp2) != 0)
+                if (STRING_concat(destination, tempbuffer2) != 0)
                 {
                     result = AGENT_DATA_TYPES_ERROR;
                     LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
@@ -1797,22 +1970,9 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
             }
             case (EDM_SBYTE_TYPE) :
             {
-                char tempbuffer2[5]; /* because '-' and 3 characters for 127 let's say and '\0'*/
-                int absValue = value->value.edmSbyte.value;
-                size_t pos=0;
                 /*Codes_SRS_AGENT_TYPE_SYSTEM_99_026:[ EDM_SBYTE: sbyteValue = [ sign ] 1*3DIGIT  ; numbers in the range from -128 to 127]*/
-
-                if (value->value.edmSbyte.value < 0)
-                {
-                    tempbuffer2[pos++] = '-';
-                    absValue = -absValue;
-                }
-
-                if (absValue >= 100 ) tempbuffer2[pos++] = '0' + (char)(absValue / 100);
-                if (absValue >=10) tempbuffer2[pos++] = '0' + (absValue % 100) / 10;
-                tempbuffer2[pos++] = '0' + (absValue % 10);
-                tempbuffer2[pos++] = '\0';
-
+                char tempbuffer2[MAX_INT64_STRING_LENGTH + 1];
+                tempbuffer2[writeInt64(tempbuffer2, value->value.edmSbyte.value, 1, false)] = '\0';
 
                 if (STRING_concat(destination, tempbuffer2) != 0)
                 {
@@ -1955,8 +2115,6 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                 /*C89 standard says: When a float is promoted to double or long double, or a double is promoted to long double, its value is unchanged*/
                 /*I read that as : when a float is NaN or Inf, it will stay NaN or INF in double representation*/
 
-                /*The sprintf function returns the number of characters written in the array, not counting the terminating null character.*/
-
                 if(ISNAN(value->value.edmSingle.value))
                 {
                     if (STRING_concat(destination, NaN_STRING) != 0)
@@ -1995,43 +2153,29 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                 }
                 else
                 {
-                    size_t tempBufferSize = MAX_FLOATING_POINT_STRING_LENGTH;
-                    char* tempBuffer = (char*)malloc(tempBufferSize);
-                    if (tempBuffer == NULL)
+                    /*Codes_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
+                    char tempBuffer[MAX_SHORTEST_FLOATING_POINT_STRING_LENGTH + 1];
+                    tempBuffer[writeFloat(tempBuffer, value->value.edmSingle.value)] = '\0';
+
+                    if (STRING_concat(destination, tempBuffer) != 0)
                     {
                         result = AGENT_DATA_TYPES_ERROR;
                         LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                     }
                     else
                     {
-                        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", FLT_DIG, (double)(value->value.edmSingle.value)) < 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else if (STRING_concat(destination, tempBuffer) != 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            result = AGENT_DATA_TYPES_OK;
-                        }
-
-                        free(tempBuffer);
+                        result = AGENT_DATA_TYPES_OK;
                     }
                 }
                 break;
             }
             case(EDM_DOUBLE_TYPE):
             {
-                /*The sprintf function returns the number of characters written in the array, not counting the terminating null character.*/
                 /*OData-ABNF says these can be used: nanInfinity = 'NaN' / '-INF' / 'INF'*/
                 /*C90 doesn't declare a NaN or Inf in the standard, however, values might be NaN or Inf...*/
                 /*C99 ... does*/
                 /*C11 is same as C99*/
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
                 if(ISNAN(value->value.edmDouble.value))
                 {
                     if (STRING_concat(destination, NaN_STRING) != 0)
@@ -2044,7 +2188,7 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                         result = AGENT_DATA_TYPES_OK;
                     }
                 }
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
                 else if (ISNEGATIVEINFINITY(value->value.edmDouble.value))
                 {
                     if (STRING_concat(destination, MINUSINF_STRING) != 0)
@@ -2057,7 +2201,7 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                         result = AGENT_DATA_TYPES_OK;
                     }
                 }
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
                 else if (ISPOSITIVEINFINITY(value->value.edmDouble.value))
                 {
                     if (STRING_concat(destination, PLUSINF_STRING) != 0)
@@ -2070,34 +2214,20 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                         result = AGENT_DATA_TYPES_OK;
                     }
                 }
-                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+                /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
                 else
                 {
-                    size_t tempBufferSize = DECIMAL_DIG * 2;
-                    char* tempBuffer = (char*)malloc(tempBufferSize);
-                    if (tempBuffer == NULL)
+                    char tempBuffer[MAX_SHORTEST_FLOATING_POINT_STRING_LENGTH + 1];
+                    tempBuffer[writeDouble(tempBuffer, value->value.edmDouble.value)] = '\0';
+
+                    if (STRING_concat(destination, tempBuffer) != 0)
                     {
                         result = AGENT_DATA_TYPES_ERROR;
                         LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                     }
                     else
                     {
-                        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", DBL_DIG, value->value.edmDouble.value) < 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else if (STRING_concat(destination, tempBuffer) != 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            result = AGENT_DATA_TYPES_OK;
-                        }
-
-                        free(tempBuffer);
+                        result = AGENT_DATA_TYPES_OK;
                     }
                 }
                 break;
@@ -4009,3 +4139,316 @@ COMPLEX_TYPE_FIELD_TYPE* AgentDataType_GetComplexTypeField(AGENT_DATA_TYPE* agen
     return complexField;
 }
 
+
+static AGENT_DATA_TYPES_RESULT AppendToJSON(JSON_ENCODER_BUFFER* destination, const char* source, size_t sourceLength)
+{
+    AGENT_DATA_TYPES_RESULT result;
+
+    if (JSONEncoder_Buffer_Append(destination, source, sourceLength) != JSON_ENCODER_OK)
+    {
+        result = AGENT_DATA_TYPES_ERROR;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    else
+    {
+        result = AGENT_DATA_TYPES_OK;
+    }
+
+    return result;
+}
+
+AGENT_DATA_TYPES_RESULT AgentDataTypes_Int64_ToJSON(JSON_ENCODER_BUFFER* destination, int64_t v)
+{
+    AGENT_DATA_TYPES_RESULT result;
+
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_001: [ If destination is NULL, the AgentDataTypes_..._ToJSON functions shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+    if (destination == NULL)
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    else
+    {
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_09_002: [ AgentDataTypes_Int64_ToJSON shall append v in decimal, with a leading "-" for negative values and without leading zeroes, which is the format AgentDataTypes_ToString uses for EDM_BYTE, EDM_SBYTE, EDM_INT16, EDM_INT32 and EDM_INT64. ]*/
+        if (JSONEncoder_Buffer_Reserve(destination, MAX_INT64_STRING_LENGTH) != JSON_ENCODER_OK)
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_09_005: [ If reserving room in destination fails, AgentDataTypes_Int64_ToJSON, AgentDataTypes_Double_ToJSON and AgentDataTypes_Float_ToJSON shall return AGENT_DATA_TYPES_ERROR. ]*/
+            result = AGENT_DATA_TYPES_ERROR;
+            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+        }
+        else
+        {
+            destination->length += writeInt64(destination->buffer + destination->length, v, 1, false);
+            result = AGENT_DATA_TYPES_OK;
+        }
+    }
+
+    return result;
+}
+
+AGENT_DATA_TYPES_RESULT AgentDataTypes_Boolean_ToJSON(JSON_ENCODER_BUFFER* destination, int v)
+{
+    AGENT_DATA_TYPES_RESULT result;
+
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_001: [ If destination is NULL, the AgentDataTypes_..._ToJSON functions shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+    if (destination == NULL)
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_003: [ AgentDataTypes_Boolean_ToJSON shall append true if v is different than 0 and false otherwise. ]*/
+    else if (v != 0)
+    {
+        result = AppendToJSON(destination, "true", sizeof("true") - 1);
+    }
+    else
+    {
+        result = AppendToJSON(destination, "false", sizeof("false") - 1);
+    }
+
+    return result;
+}
+
+AGENT_DATA_TYPES_RESULT AgentDataTypes_Double_ToJSON(JSON_ENCODER_BUFFER* destination, double v)
+{
+    AGENT_DATA_TYPES_RESULT result;
+
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_001: [ If destination is NULL, the AgentDataTypes_..._ToJSON functions shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+    if (destination == NULL)
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    else
+    {
+#ifndef NO_FLOATS
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_09_004: [ AgentDataTypes_Double_ToJSON and AgentDataTypes_Float_ToJSON shall append NaN, -INF, INF or the shortest decimal that reads back as the same value (the same text AgentDataTypes_ToString produces), written directly into destination. ]*/
+        if (ISNAN(v))
+        {
+            result = AppendToJSON(destination, NaN_STRING, sizeof(NaN_STRING) - 1);
+        }
+        else if (ISNEGATIVEINFINITY(v))
+        {
+            result = AppendToJSON(destination, MINUSINF_STRING, sizeof(MINUSINF_STRING) - 1);
+        }
+        else if (ISPOSITIVEINFINITY(v))
+        {
+            result = AppendToJSON(destination, PLUSINF_STRING, sizeof(PLUSINF_STRING) - 1);
+        }
+        else
+        {
+            if (JSONEncoder_Buffer_Reserve(destination, MAX_SHORTEST_FLOATING_POINT_STRING_LENGTH) != JSON_ENCODER_OK)
+            {
+                /*Codes_SRS_AGENT_TYPE_SYSTEM_09_005: [ If reserving room in destination fails, AgentDataTypes_Int64_ToJSON, AgentDataTypes_Double_ToJSON and AgentDataTypes_Float_ToJSON shall return AGENT_DATA_TYPES_ERROR. ]*/
+                result = AGENT_DATA_TYPES_ERROR;
+                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+            }
+            else
+            {
+                destination->length += writeDouble(destination->buffer + destination->length, v);
+                result = AGENT_DATA_TYPES_OK;
+            }
+        }
+#else
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_09_006: [ When NO_FLOATS is defined, AgentDataTypes_Double_ToJSON and AgentDataTypes_Float_ToJSON shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+        (void)v;
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+#endif
+    }
+
+    return result;
+}
+
+AGENT_DATA_TYPES_RESULT AgentDataTypes_Float_ToJSON(JSON_ENCODER_BUFFER* destination, float v)
+{
+    AGENT_DATA_TYPES_RESULT result;
+
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_001: [ If destination is NULL, the AgentDataTypes_..._ToJSON functions shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+    if (destination == NULL)
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    else
+    {
+#ifndef NO_FLOATS
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_09_004: [ AgentDataTypes_Double_ToJSON and AgentDataTypes_Float_ToJSON shall append NaN, -INF, INF or the shortest decimal that reads back as the same value (the same text AgentDataTypes_ToString produces), written directly into destination. ]*/
+        if (ISNAN(v))
+        {
+            result = AppendToJSON(destination, NaN_STRING, sizeof(NaN_STRING) - 1);
+        }
+        else if (ISNEGATIVEINFINITY(v))
+        {
+            result = AppendToJSON(destination, MINUSINF_STRING, sizeof(MINUSINF_STRING) - 1);
+        }
+        else if (ISPOSITIVEINFINITY(v))
+        {
+            result = AppendToJSON(destination, PLUSINF_STRING, sizeof(PLUSINF_STRING) - 1);
+        }
+        else
+        {
+            if (JSONEncoder_Buffer_Reserve(destination, MAX_SHORTEST_FLOATING_POINT_STRING_LENGTH) != JSON_ENCODER_OK)
+            {
+                /*Codes_SRS_AGENT_TYPE_SYSTEM_09_005: [ If reserving room in destination fails, AgentDataTypes_Int64_ToJSON, AgentDataTypes_Double_ToJSON and AgentDataTypes_Float_ToJSON shall return AGENT_DATA_TYPES_ERROR. ]*/
+                result = AGENT_DATA_TYPES_ERROR;
+                LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+            }
+            else
+            {
+                destination->length += writeFloat(destination->buffer + destination->length, v);
+                result = AGENT_DATA_TYPES_OK;
+            }
+        }
+#else
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_09_006: [ When NO_FLOATS is defined, AgentDataTypes_Double_ToJSON and AgentDataTypes_Float_ToJSON shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+        (void)v;
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+#endif
+    }
+
+    return result;
+}
+
+AGENT_DATA_TYPES_RESULT AgentDataTypes_Charz_ToJSON(JSON_ENCODER_BUFFER* destination, const char* v)
+{
+    AGENT_DATA_TYPES_RESULT result;
+
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_001: [ If destination is NULL, the AgentDataTypes_..._ToJSON functions shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_007: [ If v is NULL, AgentDataTypes_Charz_ToJSON and AgentDataTypes_CharzNoQuotes_ToJSON shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+    if ((destination == NULL) ||
+        (v == NULL))
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    else
+    {
+        size_t i;
+        size_t encodedLength = 2; /*the quotes*/
+
+        for (i = 0; v[i] != '\0'; i++)
+        {
+            if ((unsigned char)v[i] >= 128)
+            {
+                break;
+            }
+            else if (v[i] <= 0x1F)
+            {
+                encodedLength += 6;
+            }
+            else if ((v[i] == '"') ||
+                (v[i] == '\\') ||
+                (v[i] == '/'))
+            {
+                encodedLength += 2;
+            }
+            else
+            {
+                encodedLength++;
+            }
+        }
+
+        if (v[i] != '\0')
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_09_008: [ If v contains characters above 127, AgentDataTypes_Charz_ToJSON shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+            result = AGENT_DATA_TYPES_INVALID_ARG;
+            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+        }
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_09_009: [ AgentDataTypes_Charz_ToJSON shall reserve the exact encoded length once and append v between quotes, escaping control characters as \u00XX and ", \ and / with a backslash. ]*/
+        else if (JSONEncoder_Buffer_Reserve(destination, encodedLength) != JSON_ENCODER_OK)
+        {
+            result = AGENT_DATA_TYPES_ERROR;
+            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+        }
+        else
+        {
+            char* w = destination->buffer + destination->length;
+            *w++ = '"';
+            for (i = 0; v[i] != '\0'; i++)
+            {
+                if (v[i] <= 0x1F)
+                {
+                    *w++ = '\\';
+                    *w++ = 'u';
+                    *w++ = '0';
+                    *w++ = '0';
+                    *w++ = hexToASCII[(v[i] & 0xF0) >> 4]; /*high nibble*/
+                    *w++ = hexToASCII[v[i] & 0x0F]; /*lowNibble nibble*/
+                }
+                else if ((v[i] == '"') ||
+                    (v[i] == '\\') ||
+                    (v[i] == '/'))
+                {
+                    *w++ = '\\';
+                    *w++ = v[i];
+                }
+                else
+                {
+                    *w++ = v[i];
+                }
+            }
+            *w = '"';
+            destination->length += encodedLength;
+            result = AGENT_DATA_TYPES_OK;
+        }
+    }
+
+    return result;
+}
+
+AGENT_DATA_TYPES_RESULT AgentDataTypes_CharzNoQuotes_ToJSON(JSON_ENCODER_BUFFER* destination, const char* v)
+{
+    AGENT_DATA_TYPES_RESULT result;
+
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_001: [ If destination is NULL, the AgentDataTypes_..._ToJSON functions shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_007: [ If v is NULL, AgentDataTypes_Charz_ToJSON and AgentDataTypes_CharzNoQuotes_ToJSON shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+    if ((destination == NULL) ||
+        (v == NULL))
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    else
+    {
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_09_010: [ AgentDataTypes_CharzNoQuotes_ToJSON shall append v as is. ]*/
+        result = AppendToJSON(destination, v, strlen(v));
+    }
+
+    return result;
+}
+
+AGENT_DATA_TYPES_RESULT AgentDataTypes_ToJSON(JSON_ENCODER_BUFFER* destination, const AGENT_DATA_TYPE* value)
+{
+    AGENT_DATA_TYPES_RESULT result;
+
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_001: [ If destination is NULL, the AgentDataTypes_..._ToJSON functions shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+    if (destination == NULL)
+    {
+        result = AGENT_DATA_TYPES_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    else
+    {
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_09_011: [ AgentDataTypes_ToJSON shall append the output of AgentDataTypes_ToString for value. ]*/
+        STRING_HANDLE valueAsString = STRING_new();
+        if (valueAsString == NULL)
+        {
+            result = AGENT_DATA_TYPES_ERROR;
+            LogError("(result = %s)", MU_ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+        }
+        else
+        {
+            /*Codes_SRS_AGENT_TYPE_SYSTEM_09_012: [ If AgentDataTypes_ToString fails, AgentDataTypes_ToJSON shall return the same error. ]*/
+            if ((result = AgentDataTypes_ToString(valueAsString, value)) == AGENT_DATA_TYPES_OK)
+            {
+                const char* valueAsChars = STRING_c_str(valueAsString);
+                result = AppendToJSON(destination, valueAsChars, strlen(valueAsChars));
+            }
+            STRING_delete(valueAsString);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,369 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <float.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include "cborencoder.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/strings.h"
+
+MU_DEFINE_ENUM_STRINGS(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+
+#define LOG_CBOR_ENCODER_ERROR \
+    LogError("(result = %s)", MU_ENUM_TO_STRING(CBOR_ENCODER_RESULT, result));
+
+/*major types of RFC 8949, already shifted in the 3 high bits of the initial byte*/
+#define CBOR_MAJOR_UNSIGNED         0x00
+#define CBOR_MAJOR_NEGATIVE         0x20
+#define CBOR_MAJOR_BYTE_STRING      0x40
+#define CBOR_MAJOR_TEXT_STRING      0x60
+#define CBOR_MAJOR_MAP              0xA0
+#define CBOR_MAJOR_TAG              0xC0
+
+#define CBOR_FALSE                  0xF4
+#define CBOR_TRUE                   0xF5
+#define CBOR_NULL                   0xF6
+#define CBOR_FLOAT32                0xFA
+#define CBOR_FLOAT64                0xFB
+
+#define CBOR_TAG_DATE_TIME_STRING   0
+#define CBOR_TAG_UUID               37
+
+static CBOR_ENCODER_RESULT AppendBytes(JSON_ENCODER_BUFFER* destination, const void* source, size_t sourceLength)
+{
+    return (JSONEncoder_Buffer_Append(destination, (const char*)source, sourceLength) == JSON_ENCODER_OK) ? CBOR_ENCODER_OK : CBOR_ENCODER_ERROR;
+}
+
+/*writes the initial byte of a data item and its argument in the shortest form*/
+static CBOR_ENCODER_RESULT AppendHead(JSON_ENCODER_BUFFER* destination, unsigned char majorType, uint64_t argument)
+{
+    unsigned char head[9];
+    size_t headLength;
+
+    if (argument < 24)
+    {
+        head[0] = (unsigned char)(majorType | argument);
+        headLength = 1;
+    }
+    else if (argument <= UINT8_MAX)
+    {
+        head[0] = (unsigned char)(majorType | 24);
+        head[1] = (unsigned char)argument;
+        headLength = 2;
+    }
+    else if (argument <= UINT16_MAX)
+    {
+        head[0] = (unsigned char)(majorType | 25);
+        head[1] = (unsigned char)(argument >> 8);
+        head[2] = (unsigned char)argument;
+        headLength = 3;
+    }
+    else if (argument <= UINT32_MAX)
+    {
+        head[0] = (unsigned char)(majorType | 26);
+        head[1] = (unsigned char)(argument >> 24);
+        head[2] = (unsigned char)(argument >> 16);
+        head[3] = (unsigned char)(argument >> 8);
+        head[4] = (unsigned char)argument;
+        headLength = 5;
+    }
+    else
+    {
+        size_t i;
+        head[0] = (unsigned char)(majorType | 27);
+        for (i = 0; i < 8; i++)
+        {
+            head[1 + i] = (unsigned char)(argument >> (56 - 8 * i));
+        }
+        headLength = 9;
+    }
+
+    return AppendBytes(destination, head, headLength);
+}
+
+static CBOR_ENCODER_RESULT AppendInteger(JSON_ENCODER_BUFFER* destination, int64_t value)
+{
+    /*negative n is encoded as -1 - n, which does not overflow for INT64_MIN*/
+    return (value >= 0) ?
+        AppendHead(destination, CBOR_MAJOR_UNSIGNED, (uint64_t)value) :
+        AppendHead(destination, CBOR_MAJOR_NEGATIVE, (uint64_t)(-(value + 1)));
+}
+
+static CBOR_ENCODER_RESULT AppendString(JSON_ENCODER_BUFFER* destination, unsigned char majorType, const char* source, size_t sourceLength)
+{
+    CBOR_ENCODER_RESULT result;
+
+    if ((result = AppendHead(destination, majorType, sourceLength)) == CBOR_ENCODER_OK)
+    {
+        result = AppendBytes(destination, source, sourceLength);
+    }
+
+    return result;
+}
+
+static CBOR_ENCODER_RESULT AppendFloat(JSON_ENCODER_BUFFER* destination, float value)
+{
+    unsigned char item[5];
+    uint32_t bits;
+    (void)memcpy(&bits, &value, sizeof(bits));
+    item[0] = CBOR_FLOAT32;
+    item[1] = (unsigned char)(bits >> 24);
+    item[2] = (unsigned char)(bits >> 16);
+    item[3] = (unsigned char)(bits >> 8);
+    item[4] = (unsigned char)bits;
+    return AppendBytes(destination, item, sizeof(item));
+}
+
+static CBOR_ENCODER_RESULT AppendDouble(JSON_ENCODER_BUFFER* destination, double value)
+{
+    CBOR_ENCODER_RESULT result;
+
+    /*a double that survives the round trip through float is sent in half the bytes, the value read back is the same.
+    The range check keeps the conversion defined, NaN and the infinities fail it and go out as doubles*/
+    if ((value >= -FLT_MAX) &&
+        (value <= FLT_MAX) &&
+        ((double)(float)value == value))
+    {
+        result = AppendFloat(destination, (float)value);
+    }
+    else
+    {
+        unsigned char item[9];
+        uint64_t bits;
+        size_t i;
+        (void)memcpy(&bits, &value, sizeof(bits));
+        item[0] = CBOR_FLOAT64;
+        for (i = 0; i < 8; i++)
+        {
+            item[1 + i] = (unsigned char)(bits >> (56 - 8 * i));
+        }
+        result = AppendBytes(destination, item, sizeof(item));
+    }
+
+    return result;
+}
+
+/*the types without a natural CBOR form are sent as the text of their JSON representation, without the quotes*/
+static CBOR_ENCODER_RESULT AppendAsText(JSON_ENCODER_BUFFER* destination, const AGENT_DATA_TYPE* value)
+{
+    CBOR_ENCODER_RESULT result;
+    STRING_HANDLE text;
+
+    if ((text = STRING_new()) == NULL)
+    {
+        result = CBOR_ENCODER_ERROR;
+        LOG_CBOR_ENCODER_ERROR;
+    }
+    else
+    {
+        if (AgentDataTypes_ToString(text, value) != AGENT_DATA_TYPES_OK)
+        {
+            result = CBOR_ENCODER_UNSUPPORTED_TYPE;
+            LOG_CBOR_ENCODER_ERROR;
+        }
+        else
+        {
+            const char* chars = STRING_c_str(text);
+            size_t length = STRING_length(text);
+
+            if ((length >= 2) && (chars[0] == '"') && (chars[length - 1] == '"'))
+            {
+                chars++;
+                length -= 2;
+            }
+
+            result = AppendString(destination, CBOR_MAJOR_TEXT_STRING, chars, length);
+        }
+        STRING_delete(text);
+    }
+
+    return result;
+}
+
+CBOR_ENCODER_RESULT CBOREncoder_EncodeValue(JSON_ENCODER_BUFFER* destination, const AGENT_DATA_TYPE* value)
+{
+    CBOR_ENCODER_RESULT result;
+
+    /*Codes_SRS_CBOR_ENCODER_09_001: [ If destination or value is NULL, CBOREncoder_EncodeValue shall return CBOR_ENCODER_INVALID_ARG. ]*/
+    if ((destination == NULL) ||
+        (value == NULL))
+    {
+        result = CBOR_ENCODER_INVALID_ARG;
+        LOG_CBOR_ENCODER_ERROR;
+    }
+    else
+    {
+        switch (value->type)
+        {
+            /*Codes_SRS_CBOR_ENCODER_09_002: [ Integer types shall be encoded as CBOR unsigned or negative integers in their shortest form. ]*/
+            case EDM_BYTE_TYPE:
+                result = AppendInteger(destination, value->value.edmByte.value);
+                break;
+            case EDM_SBYTE_TYPE:
+                result = AppendInteger(destination, value->value.edmSbyte.value);
+                break;
+            case EDM_INT16_TYPE:
+                result = AppendInteger(destination, value->value.edmInt16.value);
+                break;
+            case EDM_INT32_TYPE:
+                result = AppendInteger(destination, value->value.edmInt32.value);
+                break;
+            case EDM_INT64_TYPE:
+                result = AppendInteger(destination, value->value.edmInt64.value);
+                break;
+            /*Codes_SRS_CBOR_ENCODER_09_003: [ EDM_BOOLEAN_TYPE shall be encoded as CBOR true or false and EDM_NULL_TYPE as CBOR null. ]*/
+            case EDM_BOOLEAN_TYPE:
+            {
+                unsigned char item = (value->value.edmBoolean.value == EDM_TRUE) ? CBOR_TRUE : CBOR_FALSE;
+                result = AppendBytes(destination, &item, 1);
+                break;
+            }
+            case EDM_NULL_TYPE:
+            {
+                unsigned char item = CBOR_NULL;
+                result = AppendBytes(destination, &item, 1);
+                break;
+            }
+            /*Codes_SRS_CBOR_ENCODER_09_004: [ EDM_SINGLE_TYPE shall be encoded as a CBOR single precision float. EDM_DOUBLE_TYPE shall be encoded as a single precision float when that keeps the exact value and as a double precision float otherwise. ]*/
+            case EDM_SINGLE_TYPE:
+                result = AppendFloat(destination, value->value.edmSingle.value);
+                break;
+            case EDM_DOUBLE_TYPE:
+                result = AppendDouble(destination, value->value.edmDouble.value);
+                break;
+            /*Codes_SRS_CBOR_ENCODER_09_005: [ EDM_STRING_TYPE and EDM_STRING_NO_QUOTES_TYPE shall be encoded as CBOR text strings, without any JSON escaping. ]*/
+            case EDM_STRING_TYPE:
+                result = AppendString(destination, CBOR_MAJOR_TEXT_STRING, value->value.edmString.chars, value->value.edmString.length);
+                break;
+            case EDM_STRING_NO_QUOTES_TYPE:
+                result = AppendString(destination, CBOR_MAJOR_TEXT_STRING, value->value.edmStringNoQuotes.chars, value->value.edmStringNoQuotes.length);
+                break;
+            /*Codes_SRS_CBOR_ENCODER_09_006: [ EDM_BINARY_TYPE shall be encoded as a CBOR byte string. ]*/
+            case EDM_BINARY_TYPE:
+                result = AppendString(destination, CBOR_MAJOR_BYTE_STRING, (const char*)value->value.edmBinary.data, value->value.edmBinary.size);
+                break;
+            /*Codes_SRS_CBOR_ENCODER_09_007: [ EDM_GUID_TYPE shall be encoded as tag 37 followed by a byte string of the 16 bytes of the GUID. ]*/
+            case EDM_GUID_TYPE:
+                if ((result = AppendHead(destination, CBOR_MAJOR_TAG, CBOR_TAG_UUID)) == CBOR_ENCODER_OK)
+                {
+                    result = AppendString(destination, CBOR_MAJOR_BYTE_STRING, (const char*)value->value.edmGuid.GUID, sizeof(value->value.edmGuid.GUID));
+                }
+                break;
+            /*Codes_SRS_CBOR_ENCODER_09_008: [ EDM_DATE_TIME_OFFSET_TYPE shall be encoded as tag 0 followed by the text of its JSON representation. ]*/
+            case EDM_DATE_TIME_OFFSET_TYPE:
+                if ((result = AppendHead(destination, CBOR_MAJOR_TAG, CBOR_TAG_DATE_TIME_STRING)) == CBOR_ENCODER_OK)
+                {
+                    result = AppendAsText(destination, value);
+                }
+                break;
+            /*Codes_SRS_CBOR_ENCODER_09_009: [ EDM_COMPLEX_TYPE_TYPE shall be encoded as a CBOR map from the field names to the encoded field values. ]*/
+            case EDM_COMPLEX_TYPE_TYPE:
+            {
+                size_t i;
+                result = AppendHead(destination, CBOR_MAJOR_MAP, value->value.edmComplexType.nMembers);
+                for (i = 0; (i < value->value.edmComplexType.nMembers) && (result == CBOR_ENCODER_OK); i++)
+                {
+                    const COMPLEX_TYPE_FIELD_TYPE* field = &value->value.edmComplexType.fields[i];
+                    if ((result = AppendString(destination, CBOR_MAJOR_TEXT_STRING, field->fieldName, strlen(field->fieldName))) == CBOR_ENCODER_OK)
+                    {
+                        result = CBOREncoder_EncodeValue(destination, field->value);
+                    }
+                }
+                break;
+            }
+            /*Codes_SRS_CBOR_ENCODER_09_010: [ Any other type shall be encoded as a CBOR text string holding its JSON representation as produced by AgentDataTypes_ToString, without the enclosing quotes. ]*/
+            default:
+                result = AppendAsText(destination, value);
+                break;
+        }
+
+        if (result != CBOR_ENCODER_OK)
+        {
+            /*Codes_SRS_CBOR_ENCODER_09_011: [ If any failure occurs, CBOREncoder_EncodeValue shall fail and return CBOR_ENCODER_ERROR or CBOR_ENCODER_UNSUPPORTED_TYPE. ]*/
+            LOG_CBOR_ENCODER_ERROR;
+        }
+    }
+
+    return result;
+}
+
+CBOR_ENCODER_RESULT CBOREncoder_EncodeTree(MULTITREE_HANDLE treeHandle, JSON_ENCODER_BUFFER* destination)
+{
+    CBOR_ENCODER_RESULT result;
+    size_t childCount;
+
+    /*Codes_SRS_CBOR_ENCODER_09_012: [ If treeHandle or destination is NULL, CBOREncoder_EncodeTree shall return CBOR_ENCODER_INVALID_ARG. ]*/
+    if ((treeHandle == NULL) ||
+        (destination == NULL))
+    {
+        result = CBOR_ENCODER_INVALID_ARG;
+        LOG_CBOR_ENCODER_ERROR;
+    }
+    else if (MultiTree_GetChildCount(treeHandle, &childCount) != MULTITREE_OK)
+    {
+        /*Codes_SRS_CBOR_ENCODER_09_015: [ If any MultiTree call fails, CBOREncoder_EncodeTree shall return CBOR_ENCODER_MULTITREE_ERROR. ]*/
+        result = CBOR_ENCODER_MULTITREE_ERROR;
+        LOG_CBOR_ENCODER_ERROR;
+    }
+    /*Codes_SRS_CBOR_ENCODER_09_013: [ CBOREncoder_EncodeTree shall append a CBOR map with one entry per child of treeHandle, keyed by the name of the child, in the order of the children. ]*/
+    else if ((result = AppendHead(destination, CBOR_MAJOR_MAP, childCount)) != CBOR_ENCODER_OK)
+    {
+        LOG_CBOR_ENCODER_ERROR;
+    }
+    else
+    {
+        size_t i;
+
+        for (i = 0; (i < childCount) && (result == CBOR_ENCODER_OK); i++)
+        {
+            MULTITREE_HANDLE childTreeHandle;
+            STRING_HANDLE name;
+            size_t innerChildCount;
+
+            if ((name = STRING_new()) == NULL)
+            {
+                result = CBOR_ENCODER_ERROR;
+                LOG_CBOR_ENCODER_ERROR;
+            }
+            else
+            {
+                if ((MultiTree_GetChild(treeHandle, i, &childTreeHandle) != MULTITREE_OK) ||
+                    (MultiTree_GetName(childTreeHandle, name) != MULTITREE_OK) ||
+                    (MultiTree_GetChildCount(childTreeHandle, &innerChildCount) != MULTITREE_OK))
+                {
+                    result = CBOR_ENCODER_MULTITREE_ERROR;
+                    LOG_CBOR_ENCODER_ERROR;
+                }
+                else if ((result = AppendString(destination, CBOR_MAJOR_TEXT_STRING, STRING_c_str(name), STRING_length(name))) != CBOR_ENCODER_OK)
+                {
+                    LOG_CBOR_ENCODER_ERROR;
+                }
+                /*Codes_SRS_CBOR_ENCODER_09_014: [ A child that has children shall be encoded by CBOREncoder_EncodeTree, a leaf shall be encoded by CBOREncoder_EncodeValue. ]*/
+                else if (innerChildCount > 0)
+                {
+                    result = CBOREncoder_EncodeTree(childTreeHandle, destination);
+                }
+                else
+                {
+                    const void* value;
+                    if (MultiTree_GetValue(childTreeHandle, &value) != MULTITREE_OK)
+                    {
+                        result = CBOR_ENCODER_MULTITREE_ERROR;
+                        LOG_CBOR_ENCODER_ERROR;
+                    }
+                    else
+                    {
+                        result = CBOREncoder_EncodeValue(destination, (const AGENT_DATA_TYPE*)value);
+                    }
+                }
+                STRING_delete(name);
+            }
+        }
+    }
+
+    return result;
+}
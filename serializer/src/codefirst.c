@@ -12,6 +12,7 @@
 #include <stddef.h>
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "iotdevice.h"
+#include "datamarshaller.h"
 
 MU_DEFINE_ENUM_STRINGS(CODEFIRST_RESULT, CODEFIRST_RESULT_VALUES)
 MU_DEFINE_ENUM_STRINGS(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_RESULT_VALUES)
@@ -19,6 +20,26 @@ MU_DEFINE_ENUM_STRINGS(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_RESULT_VALUES)
 #define LOG_CODEFIRST_ERROR \
     LogError("(result = %s)", MU_ENUM_TO_STRING(CODEFIRST_RESULT, result))
 
+/*one reported property that is not itself a model, flattened out of the nested models of a device*/
+typedef struct CODEFIRST_REPORTED_LEAF_TAG
+{
+    STRING_HANDLE path;
+    size_t offset; /*from the start of the device data*/
+    const REFLECTED_SOMETHING* something;
+    STRING_HANDLE acknowledgedValue; /*JSON of the value at the last acknowledged report, NULL if there was none or it is unknown*/
+} CODEFIRST_REPORTED_LEAF;
+
+/*the values carried by one dirty report that is waiting for its acknowledgement. values is indexed like ReportedLeaves, NULL where the report did not carry the leaf*/
+typedef struct CODEFIRST_PENDING_REPORT_TAG
+{
+    size_t token;
+    STRING_HANDLE* values;
+    struct CODEFIRST_PENDING_REPORT_TAG* next;
+} CODEFIRST_PENDING_REPORT;
+
+/*a device that never acknowledges its reports does not keep them forever, the oldest one is dropped*/
+#define CODEFIRST_MAX_PENDING_REPORTS 8
+
 typedef struct DEVICE_HEADER_DATA_TAG
 {
     DEVICE_HANDLE DeviceHandle;
@@ -26,6 +47,14 @@ typedef struct DEVICE_HEADER_DATA_TAG
     SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
     size_t DataSize;
     unsigned char* data;
+    bool IncludePropertyPath;
+    size_t LastJSONSize; /*size of the last payload produced by the direct JSON path, used to size the next buffer*/
+    const struct CODEFIRST_MODEL_INDEX_TAG* ModelIndex; /*index of the device's model, resolved at the first lookup*/
+    CODEFIRST_REPORTED_LEAF* ReportedLeaves; /*built by the first dirty report*/
+    size_t ReportedLeafCount;
+    CODEFIRST_PENDING_REPORT* PendingReports; /*oldest first*/
+    size_t PendingReportCount;
+    size_t LastReportToken;
 } DEVICE_HEADER_DATA;
 
 #define COUNT_OF(A) (sizeof(A) / sizeof((A)[0]))
@@ -80,7 +109,83 @@ MU_DEFINE_ENUM(CODEFIRST_STATE, CODEFIRST_STATE_VALUES)
 static CODEFIRST_STATE g_state = CODEFIRST_STATE_NOT_INIT;
 static const char* g_OverrideSchemaNamespace;
 static size_t g_DeviceCount = 0;
-static DEVICE_HEADER_DATA** g_Devices = NULL;
+static DEVICE_HEADER_DATA** g_Devices = NULL; /*sorted by the address of the device data, so a value can be mapped to its device by binary search*/
+static bool g_DirectJsonEncoding = false;
+
+/*properties (or reported properties) of one model, sorted by offset. childModel is set when the property is itself a model*/
+typedef struct CODEFIRST_PROPERTY_INDEX_ENTRY_TAG
+{
+    size_t offset;
+    size_t size;
+    size_t order; /*position in the reflected data, among properties with the same offset the first declared one wins*/
+    const REFLECTED_SOMETHING* something;
+    const char* name;
+    const char* type;
+    const struct CODEFIRST_MODEL_INDEX_TAG* childModel;
+} CODEFIRST_PROPERTY_INDEX_ENTRY;
+
+/*actions (or methods) of one model, sorted by name: the dispatch table of CodeFirst_InvokeAction and CodeFirst_InvokeMethod*/
+typedef struct CODEFIRST_COMMAND_INDEX_ENTRY_TAG
+{
+    const char* name;
+    const REFLECTED_SOMETHING* something;
+} CODEFIRST_COMMAND_INDEX_ENTRY;
+
+typedef struct CODEFIRST_MODEL_INDEX_TAG
+{
+    const char* name;
+    size_t order;
+    CODEFIRST_PROPERTY_INDEX_ENTRY* properties;
+    size_t propertyCount;
+    CODEFIRST_PROPERTY_INDEX_ENTRY* reportedProperties;
+    size_t reportedPropertyCount;
+    CODEFIRST_COMMAND_INDEX_ENTRY* actions;
+    size_t actionCount;
+    CODEFIRST_COMMAND_INDEX_ENTRY* methods;
+    size_t methodCount;
+} CODEFIRST_MODEL_INDEX;
+
+/*one per REFLECTED_DATA_FROM_DATAPROVIDER, models sorted by name. Header, models, property entries and command entries are a single allocation*/
+typedef struct CODEFIRST_METADATA_INDEX_TAG
+{
+    const REFLECTED_DATA_FROM_DATAPROVIDER* metadata;
+    CODEFIRST_MODEL_INDEX* models;
+    size_t modelCount;
+    struct CODEFIRST_METADATA_INDEX_TAG* next;
+} CODEFIRST_METADATA_INDEX;
+
+static CODEFIRST_METADATA_INDEX* g_MetadataIndexes = NULL;
+
+/*maximum number of values a single CodeFirst_SendAsync call can carry on the direct JSON path, more than that goes transacted*/
+#define DIRECT_JSON_MAX_PROPERTIES 32
+#define DIRECT_JSON_MIN_BUFFER_SIZE 64
+
+/*what the direct JSON path writes for one call: the device and, for every distinct value, its address and its property*/
+typedef struct DIRECT_JSON_PLAN_TAG
+{
+    DEVICE_HEADER_DATA* deviceHeader;
+    const REFLECTED_SOMETHING* model; /*the model of the device when the value is a whole device, NULL otherwise*/
+    size_t valueCount;
+    void* values[DIRECT_JSON_MAX_PROPERTIES];
+    const REFLECTED_SOMETHING* properties[DIRECT_JSON_MAX_PROPERTIES];
+} DIRECT_JSON_PLAN;
+
+/*changes every time a device is created or destroyed, a plan resolved under another generation might point to a dead device*/
+static size_t g_DeviceGeneration = 0;
+
+typedef struct CODEFIRST_BATCH_TAG
+{
+    JSON_ENCODER_BUFFER buffer; /*"[" followed by the snapshots separated by ",", buffer.buffer is NULL until the first snapshot*/
+    size_t maxSize;
+    size_t snapshotCount;
+    size_t lastSize; /*size of the last flushed batch, used to size the next buffer*/
+    /*the plan of the last snapshot and the arguments it was resolved from, reused as long as the same values are appended*/
+    bool hasPlan;
+    size_t planGeneration;
+    size_t argumentCount;
+    void* arguments[DIRECT_JSON_MAX_PROPERTIES];
+    DIRECT_JSON_PLAN plan;
+} CODEFIRST_BATCH;
 
 static void deinitializeDesiredProperties(SCHEMA_MODEL_TYPE_HANDLE model, void* destination)
 {
@@ -153,16 +258,347 @@ static void deinitializeDesiredProperties(SCHEMA_MODEL_TYPE_HANDLE model, void*
     }
 }
 
+static void DestroyPendingReport(CODEFIRST_PENDING_REPORT* report, size_t leafCount)
+{
+    size_t i;
+    for (i = 0; i < leafCount; i++)
+    {
+        if (report->values[i] != NULL)
+        {
+            STRING_delete(report->values[i]);
+        }
+    }
+    free(report->values);
+    free(report);
+}
+
+static void DestroyReportedLeaves(DEVICE_HEADER_DATA* deviceHeader)
+{
+    size_t i;
+    while (deviceHeader->PendingReports != NULL)
+    {
+        CODEFIRST_PENDING_REPORT* next = deviceHeader->PendingReports->next;
+        DestroyPendingReport(deviceHeader->PendingReports, deviceHeader->ReportedLeafCount);
+        deviceHeader->PendingReports = next;
+    }
+    deviceHeader->PendingReportCount = 0;
+
+    for (i = 0; i < deviceHeader->ReportedLeafCount; i++)
+    {
+        STRING_delete(deviceHeader->ReportedLeaves[i].path);
+        if (deviceHeader->ReportedLeaves[i].acknowledgedValue != NULL)
+        {
+            STRING_delete(deviceHeader->ReportedLeaves[i].acknowledgedValue);
+        }
+    }
+    free(deviceHeader->ReportedLeaves);
+    deviceHeader->ReportedLeaves = NULL;
+    deviceHeader->ReportedLeafCount = 0;
+}
+
 static void DestroyDevice(DEVICE_HEADER_DATA* deviceHeader)
 {
     /* Codes_SRS_CODEFIRST_99_085:[CodeFirst_DestroyDevice shall free all resources associated with a device.] */
     /* Codes_SRS_CODEFIRST_99_087:[In order to release the device handle, CodeFirst_DestroyDevice shall call Device_Destroy.] */
 
+    DestroyReportedLeaves(deviceHeader);
     Device_Destroy(deviceHeader->DeviceHandle);
     free(deviceHeader->data);
     free(deviceHeader);
 }
 
+static int compareModelIndexes(const void* left, const void* right)
+{
+    const CODEFIRST_MODEL_INDEX* leftModel = (const CODEFIRST_MODEL_INDEX*)left;
+    const CODEFIRST_MODEL_INDEX* rightModel = (const CODEFIRST_MODEL_INDEX*)right;
+    int result = strcmp(leftModel->name, rightModel->name);
+    if (result == 0)
+    {
+        result = (leftModel->order < rightModel->order) ? -1 : ((leftModel->order > rightModel->order) ? 1 : 0);
+    }
+    return result;
+}
+
+static int comparePropertyIndexEntries(const void* left, const void* right)
+{
+    const CODEFIRST_PROPERTY_INDEX_ENTRY* leftEntry = (const CODEFIRST_PROPERTY_INDEX_ENTRY*)left;
+    const CODEFIRST_PROPERTY_INDEX_ENTRY* rightEntry = (const CODEFIRST_PROPERTY_INDEX_ENTRY*)right;
+    int result;
+    if (leftEntry->offset != rightEntry->offset)
+    {
+        result = (leftEntry->offset < rightEntry->offset) ? -1 : 1;
+    }
+    else
+    {
+        result = (leftEntry->order < rightEntry->order) ? -1 : ((leftEntry->order > rightEntry->order) ? 1 : 0);
+    }
+    return result;
+}
+
+static int compareCommandIndexEntries(const void* left, const void* right)
+{
+    return strcmp(((const CODEFIRST_COMMAND_INDEX_ENTRY*)left)->name, ((const CODEFIRST_COMMAND_INDEX_ENTRY*)right)->name);
+}
+
+/*returns the first declared model called modelName, NULL if there is none*/
+static CODEFIRST_MODEL_INDEX* FindModelIndex(const CODEFIRST_METADATA_INDEX* metadataIndex, const char* modelName)
+{
+    CODEFIRST_MODEL_INDEX* result;
+    size_t low = 0;
+    size_t high = metadataIndex->modelCount;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (strcmp(metadataIndex->models[middle].name, modelName) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if ((low < metadataIndex->modelCount) &&
+        (strcmp(metadataIndex->models[low].name, modelName) == 0))
+    {
+        result = &metadataIndex->models[low];
+    }
+    else
+    {
+        result = NULL;
+    }
+
+    return result;
+}
+
+static CODEFIRST_METADATA_INDEX* CreateMetadataIndex(const REFLECTED_DATA_FROM_DATAPROVIDER* metadata)
+{
+    CODEFIRST_METADATA_INDEX* result;
+    const REFLECTED_SOMETHING* something;
+    size_t modelCount = 0;
+    size_t entryCount = 0;
+    size_t commandCount = 0;
+
+    for (something = metadata->reflectedData; something != NULL; something = something->next)
+    {
+        if (something->type == REFLECTION_MODEL_TYPE)
+        {
+            modelCount++;
+        }
+        else if ((something->type == REFLECTION_PROPERTY_TYPE) ||
+            (something->type == REFLECTION_REPORTED_PROPERTY_TYPE))
+        {
+            entryCount++;
+        }
+        else if ((something->type == REFLECTION_ACTION_TYPE) ||
+            (something->type == REFLECTION_METHOD_TYPE))
+        {
+            commandCount++;
+        }
+    }
+
+    if ((result = (CODEFIRST_METADATA_INDEX*)malloc(sizeof(CODEFIRST_METADATA_INDEX) + modelCount * sizeof(CODEFIRST_MODEL_INDEX) + entryCount * sizeof(CODEFIRST_PROPERTY_INDEX_ENTRY) + commandCount * sizeof(CODEFIRST_COMMAND_INDEX_ENTRY))) == NULL)
+    {
+        LogError("unable to allocate the index of the reflected data");
+    }
+    else
+    {
+        CODEFIRST_PROPERTY_INDEX_ENTRY* entries;
+        CODEFIRST_COMMAND_INDEX_ENTRY* commands;
+        size_t order = 0;
+        size_t i;
+
+        result->metadata = metadata;
+        result->models = (CODEFIRST_MODEL_INDEX*)(result + 1);
+        result->modelCount = 0;
+        result->next = NULL;
+        entries = (CODEFIRST_PROPERTY_INDEX_ENTRY*)(result->models + modelCount);
+        commands = (CODEFIRST_COMMAND_INDEX_ENTRY*)(entries + entryCount);
+
+        for (something = metadata->reflectedData; something != NULL; something = something->next)
+        {
+            if (something->type == REFLECTION_MODEL_TYPE)
+            {
+                CODEFIRST_MODEL_INDEX* model = &result->models[result->modelCount++];
+                model->name = something->what.model.name;
+                model->order = order++;
+                model->properties = NULL;
+                model->propertyCount = 0;
+                model->reportedProperties = NULL;
+                model->reportedPropertyCount = 0;
+                model->actions = NULL;
+                model->actionCount = 0;
+                model->methods = NULL;
+                model->methodCount = 0;
+            }
+        }
+        qsort(result->models, result->modelCount, sizeof(CODEFIRST_MODEL_INDEX), compareModelIndexes);
+
+        /*count the properties of every model first, then give every model its slice of entries*/
+        for (something = metadata->reflectedData; something != NULL; something = something->next)
+        {
+            CODEFIRST_MODEL_INDEX* model;
+            if ((something->type == REFLECTION_PROPERTY_TYPE) &&
+                ((model = FindModelIndex(result, something->what.property.modelName)) != NULL))
+            {
+                model->propertyCount++;
+            }
+            else if ((something->type == REFLECTION_REPORTED_PROPERTY_TYPE) &&
+                ((model = FindModelIndex(result, something->what.reportedProperty.modelName)) != NULL))
+            {
+                model->reportedPropertyCount++;
+            }
+            else if ((something->type == REFLECTION_ACTION_TYPE) &&
+                ((model = FindModelIndex(result, something->what.action.modelName)) != NULL))
+            {
+                model->actionCount++;
+            }
+            else if ((something->type == REFLECTION_METHOD_TYPE) &&
+                ((model = FindModelIndex(result, something->what.method.modelName)) != NULL))
+            {
+                model->methodCount++;
+            }
+        }
+
+        for (i = 0; i < result->modelCount; i++)
+        {
+            result->models[i].properties = entries;
+            entries += result->models[i].propertyCount;
+            result->models[i].propertyCount = 0;
+            result->models[i].reportedProperties = entries;
+            entries += result->models[i].reportedPropertyCount;
+            result->models[i].reportedPropertyCount = 0;
+            result->models[i].actions = commands;
+            commands += result->models[i].actionCount;
+            result->models[i].actionCount = 0;
+            result->models[i].methods = commands;
+            commands += result->models[i].methodCount;
+            result->models[i].methodCount = 0;
+        }
+
+        for (something = metadata->reflectedData; something != NULL; something = something->next)
+        {
+            CODEFIRST_MODEL_INDEX* model;
+            CODEFIRST_PROPERTY_INDEX_ENTRY* entry = NULL;
+            CODEFIRST_COMMAND_INDEX_ENTRY* command = NULL;
+            if ((something->type == REFLECTION_PROPERTY_TYPE) &&
+                ((model = FindModelIndex(result, something->what.property.modelName)) != NULL))
+            {
+                entry = &model->properties[model->propertyCount++];
+                entry->offset = something->what.property.offset;
+                entry->size = something->what.property.size;
+                entry->name = something->what.property.name;
+                entry->type = something->what.property.type;
+            }
+            else if ((something->type == REFLECTION_REPORTED_PROPERTY_TYPE) &&
+                ((model = FindModelIndex(result, something->what.reportedProperty.modelName)) != NULL))
+            {
+                entry = &model->reportedProperties[model->reportedPropertyCount++];
+                entry->offset = something->what.reportedProperty.offset;
+                entry->size = something->what.reportedProperty.size;
+                entry->name = something->what.reportedProperty.name;
+                entry->type = something->what.reportedProperty.type;
+            }
+            else if ((something->type == REFLECTION_ACTION_TYPE) &&
+                ((model = FindModelIndex(result, something->what.action.modelName)) != NULL))
+            {
+                command = &model->actions[model->actionCount++];
+                command->name = something->what.action.name;
+            }
+            else if ((something->type == REFLECTION_METHOD_TYPE) &&
+                ((model = FindModelIndex(result, something->what.method.modelName)) != NULL))
+            {
+                command = &model->methods[model->methodCount++];
+                command->name = something->what.method.name;
+            }
+
+            if (entry != NULL)
+            {
+                entry->order = order;
+                entry->something = something;
+                entry->childModel = NULL;
+            }
+            else if (command != NULL)
+            {
+                command->something = something;
+            }
+            order++;
+        }
+
+        for (i = 0; i < result->modelCount; i++)
+        {
+            CODEFIRST_MODEL_INDEX* model = &result->models[i];
+            size_t j;
+
+            qsort(model->properties, model->propertyCount, sizeof(CODEFIRST_PROPERTY_INDEX_ENTRY), comparePropertyIndexEntries);
+            qsort(model->reportedProperties, model->reportedPropertyCount, sizeof(CODEFIRST_PROPERTY_INDEX_ENTRY), comparePropertyIndexEntries);
+            qsort(model->actions, model->actionCount, sizeof(CODEFIRST_COMMAND_INDEX_ENTRY), compareCommandIndexEntries);
+            qsort(model->methods, model->methodCount, sizeof(CODEFIRST_COMMAND_INDEX_ENTRY), compareCommandIndexEntries);
+
+            for (j = 0; j < model->propertyCount; j++)
+            {
+                model->properties[j].childModel = FindModelIndex(result, model->properties[j].type);
+            }
+            for (j = 0; j < model->reportedPropertyCount; j++)
+            {
+                model->reportedProperties[j].childModel = FindModelIndex(result, model->reportedProperties[j].type);
+            }
+        }
+    }
+
+    return result;
+}
+
+/*returns the index of metadata, building it the first time metadata is seen*/
+static CODEFIRST_METADATA_INDEX* GetMetadataIndex(const REFLECTED_DATA_FROM_DATAPROVIDER* metadata)
+{
+    CODEFIRST_METADATA_INDEX* result;
+
+    for (result = g_MetadataIndexes; result != NULL; result = result->next)
+    {
+        if (result->metadata == metadata)
+        {
+            break;
+        }
+    }
+
+    if ((result == NULL) &&
+        ((result = CreateMetadataIndex(metadata)) != NULL))
+    {
+        result->next = g_MetadataIndexes;
+        g_MetadataIndexes = result;
+    }
+
+    return result;
+}
+
+static void DestroyMetadataIndexes(void)
+{
+    while (g_MetadataIndexes != NULL)
+    {
+        CODEFIRST_METADATA_INDEX* next = g_MetadataIndexes->next;
+        free(g_MetadataIndexes);
+        g_MetadataIndexes = next;
+    }
+}
+
+/*returns the index of the model of the device, NULL when there is no index and the reflected data has to be walked*/
+static const CODEFIRST_MODEL_INDEX* GetDeviceModelIndex(DEVICE_HEADER_DATA* deviceHeader, const char* modelName)
+{
+    if (deviceHeader->ModelIndex == NULL)
+    {
+        CODEFIRST_METADATA_INDEX* metadataIndex = GetMetadataIndex(deviceHeader->ReflectedData);
+        if (metadataIndex != NULL)
+        {
+            deviceHeader->ModelIndex = FindModelIndex(metadataIndex, modelName);
+        }
+    }
+
+    return deviceHeader->ModelIndex;
+}
+
 static CODEFIRST_RESULT buildStructTypes(SCHEMA_HANDLE schemaHandle, const REFLECTED_DATA_FROM_DATAPROVIDER* reflectedData)
 {
     CODEFIRST_RESULT result = CODEFIRST_OK;
@@ -464,6 +900,8 @@ void CodeFirst_Deinit(void)
         free(g_Devices);
         g_Devices = NULL;
         g_DeviceCount = 0;
+        g_DeviceGeneration++;
+        DestroyMetadataIndexes();
 
         g_state = CODEFIRST_STATE_NOT_INIT;
     }
@@ -535,84 +973,204 @@ static const REFLECTED_SOMETHING* FindChildModelInCodeFirstMetadata(const REFLEC
     return result;
 }
 
-EXECUTE_COMMAND_RESULT CodeFirst_InvokeAction(DEVICE_HANDLE deviceHandle, void* callbackUserContext, const char* relativeActionPath, const char* actionName, size_t parameterCount, const AGENT_DATA_TYPE* parameterValues)
+/*walks relativePath ("childModel1/.../childModelN") down from modelIndex through the model typed properties*/
+static const CODEFIRST_MODEL_INDEX* FindChildModelIndex(const CODEFIRST_MODEL_INDEX* modelIndex, const char* relativePath, size_t* offset)
 {
-    EXECUTE_COMMAND_RESULT result;
-    DEVICE_HEADER_DATA* deviceHeader = (DEVICE_HEADER_DATA*)callbackUserContext;
+    const CODEFIRST_MODEL_INDEX* result = modelIndex;
+    *offset = 0;
 
-    /*Codes_SRS_CODEFIRST_99_068:[ If the function is called before CodeFirst is initialized then EXECUTE_COMMAND_ERROR shall be returned.] */
-    if (g_state == CODEFIRST_STATE_NOT_INIT)
-    {
-        result = EXECUTE_COMMAND_ERROR;
-        LogError("CodeFirst_InvokeAction called before init has an error %s ", MU_ENUM_TO_STRING(EXECUTE_COMMAND_RESULT, result));
-    }
-    /*Codes_SRS_CODEFIRST_99_066:[ If actionName, relativeActionPath or deviceHandle is NULL then EXECUTE_COMMAND_ERROR shall be returned*/
-    else if ((actionName == NULL) ||
-        (deviceHandle == NULL) ||
-        (relativeActionPath == NULL))
-    {
-        result = EXECUTE_COMMAND_ERROR;
-        LogError("action Name is NULL %s ", MU_ENUM_TO_STRING(EXECUTE_COMMAND_RESULT, result));
-    }
-    /*Codes_SRS_CODEFIRST_99_067:[ If parameterCount is greater than zero and parameterValues is NULL then EXECUTE_COMMAND_ERROR shall be returned.]*/
-    else if ((parameterCount > 0) && (parameterValues == NULL))
-    {
-        result = EXECUTE_COMMAND_ERROR;
-        LogError("parameterValues error %s ", MU_ENUM_TO_STRING(EXECUTE_COMMAND_RESULT, result));
-    }
-    else
+    while ((*relativePath != 0) && (result != NULL))
     {
-        const REFLECTED_SOMETHING* something;
-        const REFLECTED_SOMETHING* childModel;
-        const char* modelName;
-        size_t offset;
+        size_t i;
+        size_t propertyNameLength;
+        const char* slashPos = strchr(relativePath, '/');
+        if (slashPos == NULL)
+        {
+            slashPos = &relativePath[strlen(relativePath)];
+        }
 
-        modelName = Schema_GetModelName(deviceHeader->ModelHandle);
+        propertyNameLength = slashPos - relativePath;
 
-        if (((childModel = FindModelInCodeFirstMetadata(deviceHeader->ReflectedData->reflectedData, modelName)) == NULL) ||
-            /* Codes_SRS_CODEFIRST_99_138:[The relativeActionPath argument shall be used by CodeFirst_InvokeAction to find the child model where the action is declared.] */
-            ((childModel = FindChildModelInCodeFirstMetadata(deviceHeader->ReflectedData->reflectedData, childModel, relativeActionPath, &offset)) == NULL))
+        for (i = 0; i < result->propertyCount; i++)
         {
-            /*Codes_SRS_CODEFIRST_99_141:[If a child model specified in the relativeActionPath argument cannot be found by CodeFirst_InvokeAction, it shall return EXECUTE_COMMAND_ERROR.] */
-            result = EXECUTE_COMMAND_ERROR;
-            LogError("action %s was not found %s ", actionName, MU_ENUM_TO_STRING(EXECUTE_COMMAND_RESULT, result));
+            if ((strncmp(result->properties[i].name, relativePath, propertyNameLength) == 0) &&
+                (result->properties[i].name[propertyNameLength] == '\0'))
+            {
+                break;
+            }
+        }
+
+        if (i == result->propertyCount)
+        {
+            result = NULL;
         }
         else
         {
-            /* Codes_SRS_CODEFIRST_99_062:[ When CodeFirst_InvokeAction is called it shall look through the codefirst metadata associated with a specific device for a previously declared action (function) named actionName.]*/
-            /* Codes_SRS_CODEFIRST_99_078:[If such a function is not found then the function shall return EXECUTE_COMMAND_ERROR.]*/
-            result = EXECUTE_COMMAND_ERROR;
-            for (something = deviceHeader->ReflectedData->reflectedData; something != NULL; something = something->next)
-            {
-                if ((something->type == REFLECTION_ACTION_TYPE) &&
-                    (strcmp(actionName, something->what.action.name) == 0) &&
-                    (strcmp(childModel->what.model.name, something->what.action.modelName) == 0))
-                {
-                    /*Codes_SRS_CODEFIRST_99_063:[ If the function is found, then CodeFirst shall call the wrapper of the found function inside the data provider. The wrapper is linked in the reflected data to the function name. The wrapper shall be called with the same arguments as CodeFirst_InvokeAction has been called.]*/
-                    /*Codes_SRS_CODEFIRST_99_064:[ If the wrapper call succeeds then CODEFIRST_OK shall be returned. ]*/
-                    /*Codes_SRS_CODEFIRST_99_065:[ For all the other return values CODEFIRST_ACTION_EXECUTION_ERROR shall be returned.]*/
-                    /* Codes_SRS_CODEFIRST_99_140:[CodeFirst_InvokeAction shall pass to the action wrapper that it calls a pointer to the model where the action is defined.] */
-                    /*Codes_SRS_CODEFIRST_02_013: [The wrapper's return value shall be returned.]*/
-                    result = something->what.action.wrapper(deviceHeader->data + offset, parameterCount, parameterValues);
-                    break;
-                }
-            }
+            *offset += result->properties[i].offset;
+            result = result->properties[i].childModel;
         }
+
+        relativePath = slashPos;
     }
 
-    if (result == EXECUTE_COMMAND_ERROR)
+    return result;
+}
+
+static const CODEFIRST_COMMAND_INDEX_ENTRY* FindCommandIndexEntry(const CODEFIRST_COMMAND_INDEX_ENTRY* entries, size_t entryCount, const char* name)
+{
+    const CODEFIRST_COMMAND_INDEX_ENTRY* result = NULL;
+    size_t low = 0;
+    size_t high = entryCount;
+
+    while (low < high)
     {
-        LogError(" %s ", MU_ENUM_TO_STRING(EXECUTE_COMMAND_RESULT, result));
+        size_t middle = low + (high - low) / 2;
+        int comparison = strcmp(entries[middle].name, name);
+        if (comparison == 0)
+        {
+            result = &entries[middle];
+            break;
+        }
+        else if (comparison < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
     }
+
     return result;
 }
 
-METHODRETURN_HANDLE CodeFirst_InvokeMethod(DEVICE_HANDLE deviceHandle, void* callbackUserContext, const char* relativeMethodPath, const char* methodName, size_t parameterCount, const AGENT_DATA_TYPE* parameterValues)
+/*returns the action (or method) called name of the model found at relativePath in the device, offset receives where that model starts in the device data*/
+static const REFLECTED_SOMETHING* FindCommand(DEVICE_HEADER_DATA* deviceHeader, const char* relativePath, const char* name, REFLECTION_TYPE commandType, size_t* offset)
 {
-    METHODRETURN_HANDLE result;
-    DEVICE_HEADER_DATA* deviceHeader = (DEVICE_HEADER_DATA*)callbackUserContext;
+    const REFLECTED_SOMETHING* result;
+    const char* modelName = Schema_GetModelName(deviceHeader->ModelHandle);
+    const CODEFIRST_MODEL_INDEX* modelIndex;
 
-    if (g_state == CODEFIRST_STATE_NOT_INIT)
+    if (modelName == NULL)
+    {
+        LogError("unable to get the name of the model of the device");
+        result = NULL;
+    }
+    /*Codes_SRS_CODEFIRST_09_037: [ CodeFirst_InvokeAction and CodeFirst_InvokeMethod shall find the child model by following the model typed properties of the index of the device's model and the action or method by a binary search over the actions or methods of that model, sorted by name. ]*/
+    else if ((modelIndex = GetDeviceModelIndex(deviceHeader, modelName)) != NULL)
+    {
+        const CODEFIRST_COMMAND_INDEX_ENTRY* command;
+        if ((modelIndex = FindChildModelIndex(modelIndex, relativePath, offset)) == NULL)
+        {
+            LogError("child model %s was not found", relativePath);
+            result = NULL;
+        }
+        else if ((command = (commandType == REFLECTION_ACTION_TYPE) ?
+            FindCommandIndexEntry(modelIndex->actions, modelIndex->actionCount, name) :
+            FindCommandIndexEntry(modelIndex->methods, modelIndex->methodCount, name)) == NULL)
+        {
+            result = NULL;
+        }
+        else
+        {
+            result = command->something;
+        }
+    }
+    else
+    {
+        /*Codes_SRS_CODEFIRST_09_038: [ If there is no index, CodeFirst_InvokeAction and CodeFirst_InvokeMethod shall walk the reflected data. ]*/
+        const REFLECTED_SOMETHING* childModel;
+
+        if (((childModel = FindModelInCodeFirstMetadata(deviceHeader->ReflectedData->reflectedData, modelName)) == NULL) ||
+            /* Codes_SRS_CODEFIRST_99_138:[The relativeActionPath argument shall be used by CodeFirst_InvokeAction to find the child model where the action is declared.] */
+            ((childModel = FindChildModelInCodeFirstMetadata(deviceHeader->ReflectedData->reflectedData, childModel, relativePath, offset)) == NULL))
+        {
+            LogError("child model %s was not found", relativePath);
+            result = NULL;
+        }
+        else
+        {
+            for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
+            {
+                if (result->type == commandType)
+                {
+                    const char* commandName = (commandType == REFLECTION_ACTION_TYPE) ? result->what.action.name : result->what.method.name;
+                    const char* commandModelName = (commandType == REFLECTION_ACTION_TYPE) ? result->what.action.modelName : result->what.method.modelName;
+                    if ((strcmp(name, commandName) == 0) &&
+                        (strcmp(childModel->what.model.name, commandModelName) == 0))
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+EXECUTE_COMMAND_RESULT CodeFirst_InvokeAction(DEVICE_HANDLE deviceHandle, void* callbackUserContext, const char* relativeActionPath, const char* actionName, size_t parameterCount, const AGENT_DATA_TYPE* parameterValues)
+{
+    EXECUTE_COMMAND_RESULT result;
+    DEVICE_HEADER_DATA* deviceHeader = (DEVICE_HEADER_DATA*)callbackUserContext;
+
+    /*Codes_SRS_CODEFIRST_99_068:[ If the function is called before CodeFirst is initialized then EXECUTE_COMMAND_ERROR shall be returned.] */
+    if (g_state == CODEFIRST_STATE_NOT_INIT)
+    {
+        result = EXECUTE_COMMAND_ERROR;
+        LogError("CodeFirst_InvokeAction called before init has an error %s ", MU_ENUM_TO_STRING(EXECUTE_COMMAND_RESULT, result));
+    }
+    /*Codes_SRS_CODEFIRST_99_066:[ If actionName, relativeActionPath or deviceHandle is NULL then EXECUTE_COMMAND_ERROR shall be returned*/
+    else if ((actionName == NULL) ||
+        (deviceHandle == NULL) ||
+        (relativeActionPath == NULL))
+    {
+        result = EXECUTE_COMMAND_ERROR;
+        LogError("action Name is NULL %s ", MU_ENUM_TO_STRING(EXECUTE_COMMAND_RESULT, result));
+    }
+    /*Codes_SRS_CODEFIRST_99_067:[ If parameterCount is greater than zero and parameterValues is NULL then EXECUTE_COMMAND_ERROR shall be returned.]*/
+    else if ((parameterCount > 0) && (parameterValues == NULL))
+    {
+        result = EXECUTE_COMMAND_ERROR;
+        LogError("parameterValues error %s ", MU_ENUM_TO_STRING(EXECUTE_COMMAND_RESULT, result));
+    }
+    else
+    {
+        const REFLECTED_SOMETHING* something;
+        size_t offset;
+
+        /* Codes_SRS_CODEFIRST_99_062:[ When CodeFirst_InvokeAction is called it shall look through the codefirst metadata associated with a specific device for a previously declared action (function) named actionName.]*/
+        if ((something = FindCommand(deviceHeader, relativeActionPath, actionName, REFLECTION_ACTION_TYPE, &offset)) == NULL)
+        {
+            /*Codes_SRS_CODEFIRST_99_141:[If a child model specified in the relativeActionPath argument cannot be found by CodeFirst_InvokeAction, it shall return EXECUTE_COMMAND_ERROR.] */
+            /* Codes_SRS_CODEFIRST_99_078:[If such a function is not found then the function shall return EXECUTE_COMMAND_ERROR.]*/
+            result = EXECUTE_COMMAND_ERROR;
+            LogError("action %s was not found %s ", actionName, MU_ENUM_TO_STRING(EXECUTE_COMMAND_RESULT, result));
+        }
+        else
+        {
+            /*Codes_SRS_CODEFIRST_99_063:[ If the function is found, then CodeFirst shall call the wrapper of the found function inside the data provider. The wrapper is linked in the reflected data to the function name. The wrapper shall be called with the same arguments as CodeFirst_InvokeAction has been called.]*/
+            /*Codes_SRS_CODEFIRST_99_064:[ If the wrapper call succeeds then CODEFIRST_OK shall be returned. ]*/
+            /*Codes_SRS_CODEFIRST_99_065:[ For all the other return values CODEFIRST_ACTION_EXECUTION_ERROR shall be returned.]*/
+            /* Codes_SRS_CODEFIRST_99_140:[CodeFirst_InvokeAction shall pass to the action wrapper that it calls a pointer to the model where the action is defined.] */
+            /*Codes_SRS_CODEFIRST_02_013: [The wrapper's return value shall be returned.]*/
+            result = something->what.action.wrapper(deviceHeader->data + offset, parameterCount, parameterValues);
+        }
+    }
+
+    if (result == EXECUTE_COMMAND_ERROR)
+    {
+        LogError(" %s ", MU_ENUM_TO_STRING(EXECUTE_COMMAND_RESULT, result));
+    }
+    return result;
+}
+
+METHODRETURN_HANDLE CodeFirst_InvokeMethod(DEVICE_HANDLE deviceHandle, void* callbackUserContext, const char* relativeMethodPath, const char* methodName, size_t parameterCount, const AGENT_DATA_TYPE* parameterValues)
+{
+    METHODRETURN_HANDLE result;
+    DEVICE_HEADER_DATA* deviceHeader = (DEVICE_HEADER_DATA*)callbackUserContext;
+
+    if (g_state == CODEFIRST_STATE_NOT_INIT)
     {
         result = NULL;
         LogError("CodeFirst_InvokeMethod called before CodeFirst_Init");
@@ -633,43 +1191,19 @@ METHODRETURN_HANDLE CodeFirst_InvokeMethod(DEVICE_HANDLE deviceHandle, void* cal
     else
     {
         const REFLECTED_SOMETHING* something;
-        const REFLECTED_SOMETHING* childModel;
-        const char* modelName;
         size_t offset;
 
-        modelName = Schema_GetModelName(deviceHeader->ModelHandle);
-
-        if (((childModel = FindModelInCodeFirstMetadata(deviceHeader->ReflectedData->reflectedData, modelName)) == NULL) ||
-            ((childModel = FindChildModelInCodeFirstMetadata(deviceHeader->ReflectedData->reflectedData, childModel, relativeMethodPath, &offset)) == NULL))
+        if ((something = FindCommand(deviceHeader, relativeMethodPath, methodName, REFLECTION_METHOD_TYPE, &offset)) == NULL)
         {
+            LogError("method \"%s\" not found", methodName);
             result = NULL;
-            LogError("method %s was not found", methodName);
         }
         else
         {
-            result = NULL;
-            for (something = deviceHeader->ReflectedData->reflectedData; something != NULL; something = something->next)
-            {
-                if ((something->type == REFLECTION_METHOD_TYPE) &&
-                    (strcmp(methodName, something->what.method.name) == 0) &&
-                    (strcmp(childModel->what.model.name, something->what.method.modelName) == 0))
-                {
-                    break; /*found...*/
-                }
-            }
-
-            if (something == NULL)
-            {
-                LogError("method \"%s\" not found", methodName);
-                result = NULL;
-            }
-            else
+            result = something->what.method.wrapper(deviceHeader->data + offset, parameterCount, parameterValues);
+            if (result == NULL)
             {
-                result = something->what.method.wrapper(deviceHeader->data + offset, parameterCount, parameterValues);
-                if (result == NULL)
-                {
-                    LogError("method \"%s\" execution error (returned NULL)", methodName);
-                }
+                LogError("method \"%s\" execution error (returned NULL)", methodName);
             }
         }
     }
@@ -716,12 +1250,25 @@ SCHEMA_HANDLE CodeFirst_RegisterSchema(const char* schemaNamespace, const REFLEC
                     Schema_Destroy(result);
                     result = NULL;
                 }
+                /*Codes_SRS_CODEFIRST_09_036: [ CodeFirst_RegisterSchema shall call Schema_Freeze on the schema it created. If Schema_Freeze fails, CodeFirst_RegisterSchema shall still succeed. ]*/
+                else if (Schema_Freeze(result) != SCHEMA_OK)
+                {
+                    LogError("unable to freeze schema %s, its elements will be looked up linearly", schemaNamespace);
+                }
                 else
                 {
                     /* do nothing, everything is OK */
                 }
             }
         }
+
+        /*Codes_SRS_CODEFIRST_09_004: [ CodeFirst_RegisterSchema shall index the properties and reported properties of every model in metadata by offset. ]*/
+        /*Codes_SRS_CODEFIRST_09_005: [ If the index cannot be built, CodeFirst_RegisterSchema shall still succeed and properties shall be looked up by walking metadata. ]*/
+        if ((result != NULL) &&
+            (GetMetadataIndex(metadata) == NULL))
+        {
+            LogError("unable to index the reflected data, properties will be looked up by walking it");
+        }
     }
 
     return result;
@@ -876,6 +1423,28 @@ static void initializeDesiredProperties(SCHEMA_MODEL_TYPE_HANDLE model, void* de
     }
 }
 
+/*returns the number of devices whose data starts at or before address*/
+static size_t FindDevicePosition(const void* address)
+{
+    size_t low = 0;
+    size_t high = g_DeviceCount;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (g_Devices[middle]->data <= (const unsigned char*)address)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
 /* Codes_SRS_CODEFIRST_99_079:[CodeFirst_CreateDevice shall create a device and allocate a memory block that should hold the device data.] */
 void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DATA_FROM_DATAPROVIDER* metadata, size_t dataSize, bool includePropertyPath)
 {
@@ -939,14 +1508,25 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                 else
                 {
                     SCHEMA_RESULT schemaResult;
+
+                    /*the array has grown even if the device ends up not being added*/
+                    g_Devices = newDevices;
+
                     deviceHeader->ReflectedData = metadata;
                     deviceHeader->DataSize = dataSize;
                     deviceHeader->ModelHandle = model;
+                    deviceHeader->IncludePropertyPath = includePropertyPath;
+                    deviceHeader->LastJSONSize = 0;
+                    deviceHeader->ModelIndex = NULL;
+                    deviceHeader->ReportedLeaves = NULL;
+                    deviceHeader->ReportedLeafCount = 0;
+                    deviceHeader->PendingReports = NULL;
+                    deviceHeader->PendingReportCount = 0;
+                    deviceHeader->LastReportToken = 0;
                     schemaResult = Schema_AddDeviceRef(model);
                     if (schemaResult != SCHEMA_OK)
                     {
                         Device_Destroy(deviceHeader->DeviceHandle);
-                        free(newDevices);
                         free(deviceHeader->data);
                         free(deviceHeader);
 
@@ -955,9 +1535,12 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                     }
                     else
                     {
-                        g_Devices = newDevices;
-                        g_Devices[g_DeviceCount] = deviceHeader;
+                        /*Codes_SRS_CODEFIRST_09_006: [ CodeFirst_CreateDevice shall keep the devices ordered by the address of their data. ]*/
+                        size_t position = FindDevicePosition(deviceHeader->data);
+                        (void)memmove(&g_Devices[position + 1], &g_Devices[position], (g_DeviceCount - position) * sizeof(DEVICE_HEADER_DATA*));
+                        g_Devices[position] = deviceHeader;
                         g_DeviceCount++;
+                        g_DeviceGeneration++;
 
                         /* Codes_SRS_CODEFIRST_99_101:[On success, CodeFirst_CreateDevice shall return a non NULL pointer to the device data.] */
                         result = deviceHeader->data;
@@ -976,23 +1559,22 @@ void CodeFirst_DestroyDevice(void* device)
     /* Codes_SRS_CODEFIRST_99_086:[If the argument is NULL, CodeFirst_DestroyDevice shall do nothing.] */
     if (device != NULL)
     {
-        size_t i;
+        size_t i = FindDevicePosition(device);
 
-        for (i = 0; i < g_DeviceCount; i++)
+        if ((i > 0) &&
+            (g_Devices[i - 1]->data == device))
         {
-            if (g_Devices[i]->data == device)
-            {
-                deinitializeDesiredProperties(g_Devices[i]->ModelHandle, g_Devices[i]->data);
-                Schema_ReleaseDeviceRef(g_Devices[i]->ModelHandle);
+            i--;
+            deinitializeDesiredProperties(g_Devices[i]->ModelHandle, g_Devices[i]->data);
+            Schema_ReleaseDeviceRef(g_Devices[i]->ModelHandle);
 
-                // Delete the Created Schema if all the devices are unassociated
-                Schema_DestroyIfUnused(g_Devices[i]->ModelHandle);
+            // Delete the Created Schema if all the devices are unassociated
+            Schema_DestroyIfUnused(g_Devices[i]->ModelHandle);
 
-                DestroyDevice(g_Devices[i]);
-                (void)memcpy(&g_Devices[i], &g_Devices[i + 1], (g_DeviceCount - i - 1) * sizeof(DEVICE_HEADER_DATA*));
-                g_DeviceCount--;
-                break;
-            }
+            DestroyDevice(g_Devices[i]);
+            (void)memmove(&g_Devices[i], &g_Devices[i + 1], (g_DeviceCount - i - 1) * sizeof(DEVICE_HEADER_DATA*));
+            g_DeviceCount--;
+            g_DeviceGeneration++;
         }
 
         /*Codes_SRS_CODEFIRST_02_039: [ If the current device count is zero then CodeFirst_DestroyDevice shall deallocate all other used resources. ]*/
@@ -1000,6 +1582,7 @@ void CodeFirst_DestroyDevice(void* device)
         {
             free(g_Devices);
             g_Devices = NULL;
+            DestroyMetadataIndexes();
             g_state = CODEFIRST_STATE_NOT_INIT;
         }
     }
@@ -1007,96 +1590,176 @@ void CodeFirst_DestroyDevice(void* device)
 
 static DEVICE_HEADER_DATA* FindDevice(void* value)
 {
-    size_t i;
-    DEVICE_HEADER_DATA* result = NULL;
+    /*Codes_SRS_CODEFIRST_09_007: [ CodeFirst shall find the device a value belongs to by a binary search over the devices ordered by address. ]*/
+    size_t position = FindDevicePosition(value);
+    DEVICE_HEADER_DATA* result;
+
+    if ((position > 0) &&
+        (g_Devices[position - 1]->data + g_Devices[position - 1]->DataSize > (unsigned char*)value))
+    {
+        result = g_Devices[position - 1];
+    }
+    else
+    {
+        result = NULL;
+    }
+
+    return result;
+}
 
-    for (i = 0; i < g_DeviceCount; i++)
+/*returns the entry whose memory contains valueOffset, NULL when there is none*/
+static const CODEFIRST_PROPERTY_INDEX_ENTRY* FindPropertyIndexEntry(const CODEFIRST_PROPERTY_INDEX_ENTRY* entries, size_t entryCount, size_t valueOffset)
+{
+    const CODEFIRST_PROPERTY_INDEX_ENTRY* result = NULL;
+    size_t low = 0;
+    size_t high = entryCount;
+
+    while (low < high)
     {
-        if ((g_Devices[i]->data <= (unsigned char*)value) &&
-            (g_Devices[i]->data + g_Devices[i]->DataSize > (unsigned char*)value))
+        size_t middle = low + (high - low) / 2;
+        if (entries[middle].offset <= valueOffset)
         {
-            result = g_Devices[i];
-            break;
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low > 0)
+    {
+        /*entries sharing the last offset that is not after valueOffset are tried in declaration order*/
+        size_t first = low - 1;
+        while ((first > 0) &&
+            (entries[first - 1].offset == entries[low - 1].offset))
+        {
+            first--;
+        }
+
+        for (; first < low; first++)
+        {
+            if (entries[first].offset + entries[first].size > valueOffset)
+            {
+                result = &entries[first];
+                break;
+            }
         }
     }
 
     return result;
 }
 
-static const REFLECTED_SOMETHING* FindValue(DEVICE_HEADER_DATA* deviceHeader, void* value, const char* modelName, size_t startOffset, STRING_HANDLE valuePath)
+static const REFLECTED_SOMETHING* FindValue(DEVICE_HEADER_DATA* deviceHeader, const CODEFIRST_MODEL_INDEX* modelIndex, void* value, const char* modelName, size_t startOffset, STRING_HANDLE valuePath)
 {
     const REFLECTED_SOMETHING* result;
+    const CODEFIRST_MODEL_INDEX* childModelIndex = NULL;
     size_t valueOffset = (size_t)((unsigned char*)value - (unsigned char*)deviceHeader->data) - startOffset;
 
-    for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
+    if (modelIndex != NULL)
+    {
+        /*Codes_SRS_CODEFIRST_09_008: [ CodeFirst_SendAsync and CodeFirst_SendAsyncReported shall find the property that holds a value by a binary search over the indexed properties of the model. ]*/
+        const CODEFIRST_PROPERTY_INDEX_ENTRY* entry = FindPropertyIndexEntry(modelIndex->properties, modelIndex->propertyCount, valueOffset);
+        if (entry == NULL)
+        {
+            result = NULL;
+        }
+        else
+        {
+            result = entry->something;
+            childModelIndex = entry->childModel;
+        }
+    }
+    else
     {
-        if (result->type == REFLECTION_PROPERTY_TYPE &&
-            (strcmp(result->what.property.modelName, modelName) == 0) &&
-            (result->what.property.offset <= valueOffset) &&
-            (result->what.property.offset + result->what.property.size > valueOffset))
+        for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
         {
-            if (startOffset != 0)
+            if (result->type == REFLECTION_PROPERTY_TYPE &&
+                (strcmp(result->what.property.modelName, modelName) == 0) &&
+                (result->what.property.offset <= valueOffset) &&
+                (result->what.property.offset + result->what.property.size > valueOffset))
             {
-                STRING_concat(valuePath, "/");
+                break;
             }
-
-            STRING_concat(valuePath, result->what.property.name);
-            break;
         }
     }
 
     if (result != NULL)
     {
+        if (startOffset != 0)
+        {
+            STRING_concat(valuePath, "/");
+        }
+
+        STRING_concat(valuePath, result->what.property.name);
+
         /* Codes_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
         if (result->what.property.offset < valueOffset)
         {
             /* find recursively the property in the inner model, if there is one */
-            result = FindValue(deviceHeader, value, result->what.property.type, startOffset + result->what.property.offset, valuePath);
+            result = FindValue(deviceHeader, childModelIndex, value, result->what.property.type, startOffset + result->what.property.offset, valuePath);
         }
     }
 
     return result;
 }
 
-static const REFLECTED_SOMETHING* FindReportedProperty(DEVICE_HEADER_DATA* deviceHeader, void* value, const char* modelName, size_t startOffset, STRING_HANDLE valuePath)
+static const REFLECTED_SOMETHING* FindReportedProperty(DEVICE_HEADER_DATA* deviceHeader, const CODEFIRST_MODEL_INDEX* modelIndex, void* value, const char* modelName, size_t startOffset, STRING_HANDLE valuePath)
 {
     const REFLECTED_SOMETHING* result;
+    const CODEFIRST_MODEL_INDEX* childModelIndex = NULL;
     size_t valueOffset = (size_t)((unsigned char*)value - (unsigned char*)deviceHeader->data) - startOffset;
 
-    for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
+    if (modelIndex != NULL)
     {
-        if (result->type == REFLECTION_REPORTED_PROPERTY_TYPE &&
-            (strcmp(result->what.reportedProperty.modelName, modelName) == 0) &&
-            (result->what.reportedProperty.offset <= valueOffset) &&
-            (result->what.reportedProperty.offset + result->what.reportedProperty.size > valueOffset))
+        /*Codes_SRS_CODEFIRST_09_008: [ CodeFirst_SendAsync and CodeFirst_SendAsyncReported shall find the property that holds a value by a binary search over the indexed properties of the model. ]*/
+        const CODEFIRST_PROPERTY_INDEX_ENTRY* entry = FindPropertyIndexEntry(modelIndex->reportedProperties, modelIndex->reportedPropertyCount, valueOffset);
+        if (entry == NULL)
         {
-            if (startOffset != 0)
-            {
-                if (STRING_concat(valuePath, "/") != 0)
-                {
-                    LogError("unable to STRING_concat");
-                    result = NULL;
-                    break;
-                }
-            }
-
-            if (STRING_concat(valuePath, result->what.reportedProperty.name) != 0)
+            result = NULL;
+        }
+        else
+        {
+            result = entry->something;
+            childModelIndex = entry->childModel;
+        }
+    }
+    else
+    {
+        for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
+        {
+            if (result->type == REFLECTION_REPORTED_PROPERTY_TYPE &&
+                (strcmp(result->what.reportedProperty.modelName, modelName) == 0) &&
+                (result->what.reportedProperty.offset <= valueOffset) &&
+                (result->what.reportedProperty.offset + result->what.reportedProperty.size > valueOffset))
             {
-                LogError("unable to STRING_concat");
-                result = NULL;
                 break;
             }
-            break;
         }
     }
 
     if (result != NULL)
     {
+        if ((startOffset != 0) &&
+            (STRING_concat(valuePath, "/") != 0))
+        {
+            LogError("unable to STRING_concat");
+            result = NULL;
+        }
+        else if (STRING_concat(valuePath, result->what.reportedProperty.name) != 0)
+        {
+            LogError("unable to STRING_concat");
+            result = NULL;
+        }
         /* Codes_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
-        if (result->what.reportedProperty.offset < valueOffset)
+        else if (result->what.reportedProperty.offset < valueOffset)
         {
             /* find recursively the property in the inner model, if there is one */
-            result = FindReportedProperty(deviceHeader, value, result->what.reportedProperty.type, startOffset + result->what.reportedProperty.offset, valuePath);
+            result = FindReportedProperty(deviceHeader, childModelIndex, value, result->what.reportedProperty.type, startOffset + result->what.reportedProperty.offset, valuePath);
+        }
+        else
+        {
+            /* the value is the reported property itself */
         }
     }
 
@@ -1188,181 +1851,675 @@ static CODEFIRST_RESULT SendAllDeviceReportedProperties(DEVICE_HEADER_DATA* devi
 }
 
 
-/* Codes_SRS_CODEFIRST_99_088:[CodeFirst_SendAsync shall send to the Device module a set of properties, a destination and a destinationSize.]*/
-CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destinationSize, size_t numProperties, ...)
+void CodeFirst_SetDirectJsonEncoding(bool enabled)
 {
-    CODEFIRST_RESULT result;
-    va_list ap;
+    /*Codes_SRS_CODEFIRST_09_001: [ CodeFirst_SetDirectJsonEncoding shall enable or disable the direct JSON path of CodeFirst_SendAsync for all devices. ]*/
+    g_DirectJsonEncoding = enabled;
+}
 
-    if (
-        (numProperties == 0) ||
-        (destination == NULL) ||
-        (destinationSize == NULL)
-        )
+/*returns the top level property that starts exactly at value, or NULL when value is anything else (a child model member, a whole device...)*/
+static const REFLECTED_SOMETHING* FindTopLevelProperty(DEVICE_HEADER_DATA* deviceHeader, void* value, const char* modelName)
+{
+    const REFLECTED_SOMETHING* result;
+    const CODEFIRST_MODEL_INDEX* modelIndex = GetDeviceModelIndex(deviceHeader, modelName);
+    size_t valueOffset = (size_t)((unsigned char*)value - (unsigned char*)deviceHeader->data);
+
+    if (modelIndex != NULL)
     {
-        /* Codes_SRS_CODEFIRST_04_002: [If CodeFirst_SendAsync receives destination or destinationSize NULL, CodeFirst_SendAsync shall return Invalid Argument.]*/
-        /* Codes_SRS_CODEFIRST_99_103:[If CodeFirst_SendAsync is called with numProperties being zero, CODEFIRST_INVALID_ARG shall be returned.] */
-        result = CODEFIRST_INVALID_ARG;
-        LOG_CODEFIRST_ERROR;
+        const CODEFIRST_PROPERTY_INDEX_ENTRY* entry = FindPropertyIndexEntry(modelIndex->properties, modelIndex->propertyCount, valueOffset);
+        result = ((entry != NULL) && (entry->offset == valueOffset)) ? entry->something : NULL;
     }
     else
     {
-        /*Codes_SRS_CODEFIRST_02_040: [ CodeFirst_SendAsync shall call CodeFirst_Init, passing NULL for overrideSchemaNamespace. ]*/
-        (void)CodeFirst_Init_impl(NULL, false); /*lazy init*/
-
-        DEVICE_HEADER_DATA* deviceHeader = NULL;
-        size_t i;
-        TRANSACTION_HANDLE transaction = NULL;
-        result = CODEFIRST_OK;
-
-        /* Codes_SRS_CODEFIRST_99_105:[The properties are passed as pointers to the memory locations where the data exists in the device block allocated by CodeFirst_CreateDevice.] */
-        va_start(ap, numProperties);
-
-        /* Codes_SRS_CODEFIRST_99_089:[The numProperties argument shall indicate how many properties are to be sent.] */
-        for (i = 0; i < numProperties; i++)
+        for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
         {
-            void* value = (void*)va_arg(ap, void*);
-
-            /* Codes_SRS_CODEFIRST_99_095:[For each value passed to it, CodeFirst_SendAsync shall look up to which device the value belongs.] */
-            DEVICE_HEADER_DATA* currentValueDeviceHeader = FindDevice(value);
-            if (currentValueDeviceHeader == NULL)
-            {
-                /* Codes_SRS_CODEFIRST_99_104:[If a property cannot be associated with a device, CodeFirst_SendAsync shall return CODEFIRST_INVALID_ARG.] */
-                result = CODEFIRST_INVALID_ARG;
-                LOG_CODEFIRST_ERROR;
-                break;
-            }
-            else if ((deviceHeader != NULL) &&
-                (currentValueDeviceHeader != deviceHeader))
-            {
-                /* Codes_SRS_CODEFIRST_99_096:[All values have to belong to the same device, otherwise CodeFirst_SendAsync shall return CODEFIRST_VALUES_FROM_DIFFERENT_DEVICES_ERROR.] */
-                result = CODEFIRST_VALUES_FROM_DIFFERENT_DEVICES_ERROR;
-                LOG_CODEFIRST_ERROR;
-                break;
-            }
-            /* Codes_SRS_CODEFIRST_99_090:[All the properties shall be sent together by using the transacted APIs of the device.] */
-            /* Codes_SRS_CODEFIRST_99_091:[CodeFirst_SendAsync shall start a transaction by calling Device_StartTransaction.] */
-            else if ((deviceHeader == NULL) &&
-                ((transaction = Device_StartTransaction(currentValueDeviceHeader->DeviceHandle)) == NULL))
+            if (result->type == REFLECTION_PROPERTY_TYPE &&
+                (result->what.property.offset == valueOffset) &&
+                (strcmp(result->what.property.modelName, modelName) == 0))
             {
-                /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
-                result = CODEFIRST_DEVICE_PUBLISH_FAILED;
-                LOG_CODEFIRST_ERROR;
                 break;
             }
-            else
-            {
-                deviceHeader = currentValueDeviceHeader;
+        }
+    }
 
-                if (value == ((unsigned char*)deviceHeader->data))
-                {
-                    /* we got a full device, send all its state data */
-                    result = SendAllDeviceProperties(deviceHeader, transaction);
-                    if (result != CODEFIRST_OK)
-                    {
-                        LOG_CODEFIRST_ERROR;
-                        break;
-                    }
-                }
-                else
-                {
-                    const REFLECTED_SOMETHING* propertyReflectedData;
-                    const char* modelName;
-                    STRING_HANDLE valuePath;
+    return result;
+}
+
+static bool IsComplexType(DEVICE_HEADER_DATA* deviceHeader, const char* typeName)
+{
+    bool result = false;
+    const REFLECTED_SOMETHING* something;
+
+    for (something = deviceHeader->ReflectedData->reflectedData; something != NULL; something = something->next)
+    {
+        if (((something->type == REFLECTION_STRUCT_TYPE) && (strcmp(something->what.structure.name, typeName) == 0)) ||
+            ((something->type == REFLECTION_MODEL_TYPE) && (strcmp(something->what.model.name, typeName) == 0)))
+        {
+            result = true;
+            break;
+        }
+    }
+
+    return result;
+}
+
+/*resolves the values passed to CodeFirst_SendAsync (or to a batch) into what the direct JSON path writes: the device and, for every
+distinct value, its address and its property. A whole device stands for all its properties, in the order SendAllDeviceProperties
+publishes them. Returns CODEFIRST_OK or CODEFIRST_NOT_A_PROPERTY when the values are not something the direct path handles.*/
+static CODEFIRST_RESULT ResolveDirectJsonPlan(DIRECT_JSON_PLAN* plan, size_t numProperties, void* const* arguments, bool allowWholeDevice)
+{
+    CODEFIRST_RESULT result = CODEFIRST_OK;
+    const char* modelName = NULL;
+    size_t i;
+
+    plan->deviceHeader = NULL;
+    plan->model = NULL;
+    plan->valueCount = 0;
 
-                    if ((valuePath = STRING_new()) == NULL)
+    for (i = 0; i < numProperties; i++)
+    {
+        void* value = arguments[i];
+        DEVICE_HEADER_DATA* currentValueDeviceHeader = FindDevice(value);
+        const REFLECTED_SOMETHING* property;
+
+        if ((currentValueDeviceHeader == NULL) ||
+            ((plan->deviceHeader != NULL) && (currentValueDeviceHeader != plan->deviceHeader)))
+        {
+            result = CODEFIRST_NOT_A_PROPERTY;
+            break;
+        }
+        else if ((modelName == NULL) &&
+            ((modelName = Schema_GetModelName(currentValueDeviceHeader->ModelHandle)) == NULL))
+        {
+            result = CODEFIRST_NOT_A_PROPERTY;
+            break;
+        }
+        else if (value == (void*)currentValueDeviceHeader->data)
+        {
+            const REFLECTED_SOMETHING* something;
+
+            if (!allowWholeDevice || (numProperties != 1))
+            {
+                result = CODEFIRST_NOT_A_PROPERTY;
+                break;
+            }
+
+            plan->deviceHeader = currentValueDeviceHeader;
+            for (something = currentValueDeviceHeader->ReflectedData->reflectedData; something != NULL; something = something->next)
+            {
+                if ((something->type == REFLECTION_PROPERTY_TYPE) &&
+                    (strcmp(something->what.property.modelName, modelName) == 0))
+                {
+                    if ((plan->valueCount == DIRECT_JSON_MAX_PROPERTIES) ||
+                        (something->what.property.ToJSON_from_Ptr == NULL))
                     {
-                        /* Codes_SRS_CODEFIRST_99_134:[If CodeFirst_Notify fails for any other reason it shall return CODEFIRST_ERROR.] */
-                        result = CODEFIRST_ERROR;
-                        LOG_CODEFIRST_ERROR;
+                        result = CODEFIRST_NOT_A_PROPERTY;
                         break;
                     }
-                    else
+                    plan->values[plan->valueCount] = currentValueDeviceHeader->data + something->what.property.offset;
+                    plan->properties[plan->valueCount] = something;
+                    plan->valueCount++;
+                }
+                else if ((something->type == REFLECTION_MODEL_TYPE) &&
+                    (strcmp(something->what.model.name, modelName) == 0))
+                {
+                    plan->model = something;
+                }
+            }
+
+            if ((result == CODEFIRST_OK) && (plan->valueCount == 0))
+            {
+                result = CODEFIRST_NOT_A_PROPERTY;
+            }
+        }
+        else if (((property = FindTopLevelProperty(currentValueDeviceHeader, value, modelName)) == NULL) ||
+            (property->what.property.ToJSON_from_Ptr == NULL))
+        {
+            result = CODEFIRST_NOT_A_PROPERTY;
+            break;
+        }
+        else
+        {
+            size_t j;
+            plan->deviceHeader = currentValueDeviceHeader;
+
+            /*the same value published twice in a transaction keeps its first position, just like DataPublisher does*/
+            for (j = 0; j < plan->valueCount; j++)
+            {
+                if (plan->properties[j] == property)
+                {
+                    break;
+                }
+            }
+
+            if (j == plan->valueCount)
+            {
+                plan->values[plan->valueCount] = value;
+                plan->properties[plan->valueCount] = property;
+                plan->valueCount++;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*appends to buffer the JSON the transacted path would produce for the values of plan*/
+static CODEFIRST_RESULT WriteDirectJson(const DIRECT_JSON_PLAN* plan, JSON_ENCODER_BUFFER* buffer)
+{
+    CODEFIRST_RESULT result = CODEFIRST_OK;
+    size_t i;
+
+    /*a single struct/model value of a device that does not include the property path is sent as the value itself*/
+    if ((plan->valueCount == 1) &&
+        (!plan->deviceHeader->IncludePropertyPath) &&
+        IsComplexType(plan->deviceHeader, plan->properties[0]->what.property.type))
+    {
+        if (plan->properties[0]->what.property.ToJSON_from_Ptr(plan->values[0], buffer) != AGENT_DATA_TYPES_OK)
+        {
+            result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+        }
+    }
+    /*Codes_SRS_CODEFIRST_09_040: [ A whole device shall be written by the ToJSON_Device function DECLARE_MODEL generated for its model. ]*/
+    else if ((plan->model != NULL) && (plan->model->what.model.ToJSON_from_Ptr != NULL))
+    {
+        if (plan->model->what.model.ToJSON_from_Ptr(plan->deviceHeader->data, buffer) != AGENT_DATA_TYPES_OK)
+        {
+            result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+        }
+    }
+    else if (JSONEncoder_Buffer_Append(buffer, "{", 1) != JSON_ENCODER_OK)
+    {
+        result = CODEFIRST_ERROR;
+    }
+    else
+    {
+        for (i = 0; i < plan->valueCount; i++)
+        {
+            const char* name = plan->properties[i]->what.property.name;
+
+            if (((i > 0) && (JSONEncoder_Buffer_Append(buffer, ", ", 2) != JSON_ENCODER_OK)) ||
+                (JSONEncoder_Buffer_Append(buffer, "\"", 1) != JSON_ENCODER_OK) ||
+                (JSONEncoder_Buffer_Append(buffer, name, strlen(name)) != JSON_ENCODER_OK) ||
+                (JSONEncoder_Buffer_Append(buffer, "\":", 2) != JSON_ENCODER_OK))
+            {
+                result = CODEFIRST_ERROR;
+                break;
+            }
+            else if (plan->properties[i]->what.property.ToJSON_from_Ptr(plan->values[i], buffer) != AGENT_DATA_TYPES_OK)
+            {
+                result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                break;
+            }
+        }
+
+        if ((result == CODEFIRST_OK) &&
+            (JSONEncoder_Buffer_Append(buffer, "}", 1) != JSON_ENCODER_OK))
+        {
+            result = CODEFIRST_ERROR;
+        }
+    }
+
+    return result;
+}
+
+/*produces the same JSON as the transacted path (Device_PublishTransacted + Device_EndTransaction) for a set of top level
+properties of one device or for a whole device. Returns CODEFIRST_OK and hands over the buffer on success. Any other result means "not handled here",
+in which case nothing has been allocated and the caller is expected to go through the transacted path, which also takes care of
+producing the right error codes.*/
+static CODEFIRST_RESULT SendAsyncDirectJson(unsigned char** destination, size_t* destinationSize, size_t numProperties, va_list ap)
+{
+    CODEFIRST_RESULT result;
+
+    if (numProperties > DIRECT_JSON_MAX_PROPERTIES)
+    {
+        result = CODEFIRST_NOT_A_PROPERTY;
+    }
+    else
+    {
+        void* arguments[DIRECT_JSON_MAX_PROPERTIES];
+        DIRECT_JSON_PLAN plan;
+        size_t i;
+
+        for (i = 0; i < numProperties; i++)
+        {
+            arguments[i] = (void*)va_arg(ap, void*);
+        }
+
+        if ((result = ResolveDirectJsonPlan(&plan, numProperties, arguments, true)) == CODEFIRST_OK)
+        {
+            JSON_ENCODER_BUFFER buffer;
+            size_t initialCapacity = (plan.deviceHeader->LastJSONSize > DIRECT_JSON_MIN_BUFFER_SIZE) ? plan.deviceHeader->LastJSONSize : DIRECT_JSON_MIN_BUFFER_SIZE;
+
+            if (JSONEncoder_Buffer_Init(&buffer, initialCapacity) != JSON_ENCODER_OK)
+            {
+                result = CODEFIRST_ERROR;
+            }
+            else if ((result = WriteDirectJson(&plan, &buffer)) != CODEFIRST_OK)
+            {
+                JSONEncoder_Buffer_Deinit(&buffer);
+            }
+            else
+            {
+                plan.deviceHeader->LastJSONSize = buffer.length;
+                *destination = (unsigned char*)buffer.buffer;
+                *destinationSize = buffer.length;
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Codes_SRS_CODEFIRST_99_088:[CodeFirst_SendAsync shall send to the Device module a set of properties, a destination and a destinationSize.]*/
+CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destinationSize, size_t numProperties, ...)
+{
+    CODEFIRST_RESULT result;
+    va_list ap;
+
+    if (
+        (numProperties == 0) ||
+        (destination == NULL) ||
+        (destinationSize == NULL)
+        )
+    {
+        /* Codes_SRS_CODEFIRST_04_002: [If CodeFirst_SendAsync receives destination or destinationSize NULL, CodeFirst_SendAsync shall return Invalid Argument.]*/
+        /* Codes_SRS_CODEFIRST_99_103:[If CodeFirst_SendAsync is called with numProperties being zero, CODEFIRST_INVALID_ARG shall be returned.] */
+        result = CODEFIRST_INVALID_ARG;
+        LOG_CODEFIRST_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_CODEFIRST_02_040: [ CodeFirst_SendAsync shall call CodeFirst_Init, passing NULL for overrideSchemaNamespace. ]*/
+        (void)CodeFirst_Init_impl(NULL, false); /*lazy init*/
+
+        if (g_DirectJsonEncoding)
+        {
+            /*Codes_SRS_CODEFIRST_09_002: [ When direct JSON encoding is enabled and all values are top level properties of the same device, or the only value is a whole device, CodeFirst_SendAsync shall write the JSON for them directly into the destination buffer, producing the same bytes as the transacted path. ]*/
+            va_start(ap, numProperties);
+            result = SendAsyncDirectJson(destination, destinationSize, numProperties, ap);
+            va_end(ap);
+        }
+        else
+        {
+            result = CODEFIRST_NOT_A_PROPERTY;
+        }
+
+        if (result == CODEFIRST_OK)
+        {
+            /*sent without a transaction*/
+        }
+        else
+        {
+            /*Codes_SRS_CODEFIRST_09_003: [ If the direct JSON path cannot handle the values or fails, CodeFirst_SendAsync shall send them by using the transacted APIs of the device. ]*/
+            DEVICE_HEADER_DATA* deviceHeader = NULL;
+            size_t i;
+            TRANSACTION_HANDLE transaction = NULL;
+            result = CODEFIRST_OK;
+
+            /* Codes_SRS_CODEFIRST_99_105:[The properties are passed as pointers to the memory locations where the data exists in the device block allocated by CodeFirst_CreateDevice.] */
+            va_start(ap, numProperties);
+
+            /* Codes_SRS_CODEFIRST_99_089:[The numProperties argument shall indicate how many properties are to be sent.] */
+            for (i = 0; i < numProperties; i++)
+            {
+                void* value = (void*)va_arg(ap, void*);
+
+                /* Codes_SRS_CODEFIRST_99_095:[For each value passed to it, CodeFirst_SendAsync shall look up to which device the value belongs.] */
+                DEVICE_HEADER_DATA* currentValueDeviceHeader = FindDevice(value);
+                if (currentValueDeviceHeader == NULL)
+                {
+                    /* Codes_SRS_CODEFIRST_99_104:[If a property cannot be associated with a device, CodeFirst_SendAsync shall return CODEFIRST_INVALID_ARG.] */
+                    result = CODEFIRST_INVALID_ARG;
+                    LOG_CODEFIRST_ERROR;
+                    break;
+                }
+                else if ((deviceHeader != NULL) &&
+                    (currentValueDeviceHeader != deviceHeader))
+                {
+                    /* Codes_SRS_CODEFIRST_99_096:[All values have to belong to the same device, otherwise CodeFirst_SendAsync shall return CODEFIRST_VALUES_FROM_DIFFERENT_DEVICES_ERROR.] */
+                    result = CODEFIRST_VALUES_FROM_DIFFERENT_DEVICES_ERROR;
+                    LOG_CODEFIRST_ERROR;
+                    break;
+                }
+                /* Codes_SRS_CODEFIRST_99_090:[All the properties shall be sent together by using the transacted APIs of the device.] */
+                /* Codes_SRS_CODEFIRST_99_091:[CodeFirst_SendAsync shall start a transaction by calling Device_StartTransaction.] */
+                else if ((deviceHeader == NULL) &&
+                    ((transaction = Device_StartTransaction(currentValueDeviceHeader->DeviceHandle)) == NULL))
+                {
+                    /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
+                    result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                    LOG_CODEFIRST_ERROR;
+                    break;
+                }
+                else
+                {
+                    deviceHeader = currentValueDeviceHeader;
+
+                    if (value == ((unsigned char*)deviceHeader->data))
                     {
-                        if ((modelName = Schema_GetModelName(deviceHeader->ModelHandle)) == NULL)
+                        /* we got a full device, send all its state data */
+                        result = SendAllDeviceProperties(deviceHeader, transaction);
+                        if (result != CODEFIRST_OK)
                         {
-                            /* Codes_SRS_CODEFIRST_99_134:[If CodeFirst_Notify fails for any other reason it shall return CODEFIRST_ERROR.] */
-                            result = CODEFIRST_ERROR;
                             LOG_CODEFIRST_ERROR;
-                            STRING_delete(valuePath);
                             break;
                         }
-                        else if ((propertyReflectedData = FindValue(deviceHeader, value, modelName, 0, valuePath)) == NULL)
+                    }
+                    else
+                    {
+                        const REFLECTED_SOMETHING* propertyReflectedData;
+                        const char* modelName;
+                        STRING_HANDLE valuePath;
+
+                        if ((valuePath = STRING_new()) == NULL)
                         {
-                            /* Codes_SRS_CODEFIRST_99_104:[If a property cannot be associated with a device, CodeFirst_SendAsync shall return CODEFIRST_INVALID_ARG.] */
-                            result = CODEFIRST_INVALID_ARG;
+                            /* Codes_SRS_CODEFIRST_99_134:[If CodeFirst_Notify fails for any other reason it shall return CODEFIRST_ERROR.] */
+                            result = CODEFIRST_ERROR;
                             LOG_CODEFIRST_ERROR;
-                            STRING_delete(valuePath);
                             break;
                         }
                         else
                         {
-                            AGENT_DATA_TYPE agentDataType;
-
-                            /* Codes_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
-                            /* Codes_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
-                            if (propertyReflectedData->what.property.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
+                            if ((modelName = Schema_GetModelName(deviceHeader->ModelHandle)) == NULL)
                             {
-                                /* Codes_SRS_CODEFIRST_99_099:[If Create_AGENT_DATA_TYPE_from_Ptr fails, CodeFirst_SendAsync shall return CODEFIRST_AGENT_DATA_TYPE_ERROR.] */
-                                result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                                /* Codes_SRS_CODEFIRST_99_134:[If CodeFirst_Notify fails for any other reason it shall return CODEFIRST_ERROR.] */
+                                result = CODEFIRST_ERROR;
+                                LOG_CODEFIRST_ERROR;
+                                STRING_delete(valuePath);
+                                break;
+                            }
+                            else if ((propertyReflectedData = FindValue(deviceHeader, GetDeviceModelIndex(deviceHeader, modelName), value, modelName, 0, valuePath)) == NULL)
+                            {
+                                /* Codes_SRS_CODEFIRST_99_104:[If a property cannot be associated with a device, CodeFirst_SendAsync shall return CODEFIRST_INVALID_ARG.] */
+                                result = CODEFIRST_INVALID_ARG;
                                 LOG_CODEFIRST_ERROR;
                                 STRING_delete(valuePath);
                                 break;
                             }
                             else
                             {
-                                /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
-                                /* Codes_SRS_CODEFIRST_99_136:[CodeFirst_SendAsync shall build the full path for each property and then pass it to Device_PublishTransacted.] */
-                                if (Device_PublishTransacted(transaction, STRING_c_str(valuePath), &agentDataType) != DEVICE_OK)
-                                {
-                                    Destroy_AGENT_DATA_TYPE(&agentDataType);
+                                AGENT_DATA_TYPE agentDataType;
 
-                                    /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
-                                    result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                                /* Codes_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
+                                /* Codes_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
+                                if (propertyReflectedData->what.property.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
+                                {
+                                    /* Codes_SRS_CODEFIRST_99_099:[If Create_AGENT_DATA_TYPE_from_Ptr fails, CodeFirst_SendAsync shall return CODEFIRST_AGENT_DATA_TYPE_ERROR.] */
+                                    result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
                                     LOG_CODEFIRST_ERROR;
                                     STRING_delete(valuePath);
                                     break;
                                 }
                                 else
                                 {
-                                    STRING_delete(valuePath); /*anyway*/
-                                }
+                                    /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
+                                    /* Codes_SRS_CODEFIRST_99_136:[CodeFirst_SendAsync shall build the full path for each property and then pass it to Device_PublishTransacted.] */
+                                    if (Device_PublishTransacted(transaction, STRING_c_str(valuePath), &agentDataType) != DEVICE_OK)
+                                    {
+                                        Destroy_AGENT_DATA_TYPE(&agentDataType);
+
+                                        /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
+                                        result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                                        LOG_CODEFIRST_ERROR;
+                                        STRING_delete(valuePath);
+                                        break;
+                                    }
+                                    else
+                                    {
+                                        STRING_delete(valuePath); /*anyway*/
+                                    }
 
-                                Destroy_AGENT_DATA_TYPE(&agentDataType);
+                                    Destroy_AGENT_DATA_TYPE(&agentDataType);
+                                }
                             }
                         }
                     }
                 }
             }
+
+            if (i < numProperties)
+            {
+                if (transaction != NULL)
+                {
+                    (void)Device_CancelTransaction(transaction);
+                }
+            }
+            /* Codes_SRS_CODEFIRST_99_093:[After all values have been published, Device_EndTransaction shall be called.] */
+            else if (Device_EndTransaction(transaction, destination, destinationSize) != DEVICE_OK)
+            {
+                /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
+                result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                LOG_CODEFIRST_ERROR;
+            }
+            else
+            {
+                /* Codes_SRS_CODEFIRST_99_117:[On success, CodeFirst_SendAsync shall return CODEFIRST_OK.] */
+                result = CODEFIRST_OK;
+            }
+
+            va_end(ap);
         }
+    }
 
-        if (i < numProperties)
+    return result;
+}
+
+CODEFIRST_BATCH_HANDLE CodeFirst_CreateBatch(size_t maxSize)
+{
+    CODEFIRST_BATCH* result;
+
+    /*Codes_SRS_CODEFIRST_09_020: [ If maxSize is less than 2 (the size of an empty JSON array), CodeFirst_CreateBatch shall fail and return NULL. ]*/
+    if (maxSize < 2)
+    {
+        LogError("invalid argument size_t maxSize=%lu", (unsigned long)maxSize);
+        result = NULL;
+    }
+    /*Codes_SRS_CODEFIRST_09_019: [ CodeFirst_CreateBatch shall create an empty batch whose serialized form never exceeds maxSize bytes and return a non-NULL handle to it. ]*/
+    else if ((result = (CODEFIRST_BATCH*)malloc(sizeof(CODEFIRST_BATCH))) == NULL)
+    {
+        /*Codes_SRS_CODEFIRST_09_021: [ If any failure occurs, CodeFirst_CreateBatch shall fail and return NULL. ]*/
+        LogError("failure in malloc");
+    }
+    else
+    {
+        result->buffer.buffer = NULL;
+        result->buffer.length = 0;
+        result->buffer.capacity = 0;
+        result->maxSize = maxSize;
+        result->snapshotCount = 0;
+        result->lastSize = 0;
+        result->hasPlan = false;
+    }
+
+    return result;
+}
+
+void CodeFirst_DestroyBatch(CODEFIRST_BATCH_HANDLE batch)
+{
+    /*Codes_SRS_CODEFIRST_09_022: [ CodeFirst_DestroyBatch shall free all resources of batch, discarding the snapshots that were not flushed. If batch is NULL, it shall do nothing. ]*/
+    if (batch != NULL)
+    {
+        if (batch->buffer.buffer != NULL)
         {
-            if (transaction != NULL)
+            JSONEncoder_Buffer_Deinit(&batch->buffer);
+        }
+        free(batch);
+    }
+}
+
+/* Codes_SRS_CODEFIRST_09_023: [ CodeFirst_AppendToBatch shall append to batch one snapshot of the values: the JSON object SERIALIZE would produce for them with SerializeDirectJsonEncoding turned on. ] */
+CODEFIRST_RESULT CodeFirst_AppendToBatch(CODEFIRST_BATCH_HANDLE batch, size_t numProperties, ...)
+{
+    CODEFIRST_RESULT result;
+
+    /*Codes_SRS_CODEFIRST_09_024: [ If batch is NULL or numProperties is 0, CodeFirst_AppendToBatch shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    if ((batch == NULL) ||
+        (numProperties == 0))
+    {
+        result = CODEFIRST_INVALID_ARG;
+        LOG_CODEFIRST_ERROR;
+    }
+    /*Codes_SRS_CODEFIRST_09_039: [ If the encoder set with SerializeEncoder is not the JSON encoder, CodeFirst_AppendToBatch shall fail, leave batch as it was and return CODEFIRST_ERROR. ]*/
+    else if (DataMarshaller_GetEncoder() != DataMarshaller_GetJSONEncoder())
+    {
+        /*a batch is a JSON array*/
+        result = CODEFIRST_ERROR;
+        LOG_CODEFIRST_ERROR;
+    }
+    else if (numProperties > DIRECT_JSON_MAX_PROPERTIES)
+    {
+        /*Codes_SRS_CODEFIRST_09_025: [ If the values are not top level properties of one device, or a whole device, CodeFirst_AppendToBatch shall fail and return CODEFIRST_NOT_A_PROPERTY. ]*/
+        result = CODEFIRST_NOT_A_PROPERTY;
+        LOG_CODEFIRST_ERROR;
+    }
+    else
+    {
+        void* arguments[DIRECT_JSON_MAX_PROPERTIES];
+        va_list ap;
+        size_t i;
+
+        va_start(ap, numProperties);
+        for (i = 0; i < numProperties; i++)
+        {
+            arguments[i] = (void*)va_arg(ap, void*);
+        }
+        va_end(ap);
+
+        /*Codes_SRS_CODEFIRST_09_026: [ When the values are the same as for the previous snapshot of batch and no device has been created or destroyed since, CodeFirst_AppendToBatch shall reuse the properties found for the previous snapshot instead of looking them up again. ]*/
+        if (batch->hasPlan &&
+            (batch->planGeneration == g_DeviceGeneration) &&
+            (batch->argumentCount == numProperties) &&
+            (memcmp(batch->arguments, arguments, numProperties * sizeof(void*)) == 0))
+        {
+            result = CODEFIRST_OK;
+        }
+        else
+        {
+            batch->hasPlan = false;
+            if ((result = ResolveDirectJsonPlan(&batch->plan, numProperties, arguments, true)) != CODEFIRST_OK)
             {
-                (void)Device_CancelTransaction(transaction);
+                /*Codes_SRS_CODEFIRST_09_025: [ If the values are not top level properties of one device, or a whole device, CodeFirst_AppendToBatch shall fail and return CODEFIRST_NOT_A_PROPERTY. ]*/
+                LOG_CODEFIRST_ERROR;
+            }
+            else
+            {
+                batch->hasPlan = true;
+                batch->planGeneration = g_DeviceGeneration;
+                batch->argumentCount = numProperties;
+                (void)memcpy(batch->arguments, arguments, numProperties * sizeof(void*));
+            }
+        }
+
+        if (result == CODEFIRST_OK)
+        {
+            if (batch->buffer.buffer == NULL)
+            {
+                size_t initialCapacity = (batch->lastSize > DIRECT_JSON_MIN_BUFFER_SIZE) ? batch->lastSize : DIRECT_JSON_MIN_BUFFER_SIZE;
+
+                if ((JSONEncoder_Buffer_Init(&batch->buffer, initialCapacity) != JSON_ENCODER_OK) ||
+                    (JSONEncoder_Buffer_Append(&batch->buffer, "[", 1) != JSON_ENCODER_OK))
+                {
+                    /*Codes_SRS_CODEFIRST_09_029: [ If any other failure occurs, CodeFirst_AppendToBatch shall fail, leave batch as it was and return CODEFIRST_ERROR. ]*/
+                    if (batch->buffer.buffer != NULL)
+                    {
+                        JSONEncoder_Buffer_Deinit(&batch->buffer);
+                        batch->buffer.buffer = NULL;
+                    }
+                    result = CODEFIRST_ERROR;
+                    LOG_CODEFIRST_ERROR;
+                }
+            }
+
+            if (result == CODEFIRST_OK)
+            {
+                size_t mark = batch->buffer.length;
+
+                if ((batch->snapshotCount > 0) &&
+                    (JSONEncoder_Buffer_Append(&batch->buffer, ",", 1) != JSON_ENCODER_OK))
+                {
+                    /*Codes_SRS_CODEFIRST_09_029: [ If any other failure occurs, CodeFirst_AppendToBatch shall fail, leave batch as it was and return CODEFIRST_ERROR. ]*/
+                    result = CODEFIRST_ERROR;
+                    LOG_CODEFIRST_ERROR;
+                }
+                else if (WriteDirectJson(&batch->plan, &batch->buffer) != CODEFIRST_OK)
+                {
+                    /*Codes_SRS_CODEFIRST_09_029: [ If any other failure occurs, CodeFirst_AppendToBatch shall fail, leave batch as it was and return CODEFIRST_ERROR. ]*/
+                    result = CODEFIRST_ERROR;
+                    LOG_CODEFIRST_ERROR;
+                }
+                /*room is kept for the closing "]"*/
+                else if (batch->buffer.length + 1 > batch->maxSize)
+                {
+                    /*Codes_SRS_CODEFIRST_09_027: [ If the batch would then exceed its maxSize, CodeFirst_AppendToBatch shall leave batch as it was and return CODEFIRST_BATCH_FULL, so the caller can flush it and append the snapshot again. ]*/
+                    /*Codes_SRS_CODEFIRST_09_028: [ If batch is empty and the snapshot alone exceeds maxSize, CodeFirst_AppendToBatch shall fail and return CODEFIRST_ERROR. ]*/
+                    result = (batch->snapshotCount > 0) ? CODEFIRST_BATCH_FULL : CODEFIRST_ERROR;
+                    LOG_CODEFIRST_ERROR;
+                }
+                else
+                {
+                    /*Codes_SRS_CODEFIRST_09_030: [ On success CodeFirst_AppendToBatch shall return CODEFIRST_OK. ]*/
+                    batch->snapshotCount++;
+                }
+
+                if (result != CODEFIRST_OK)
+                {
+                    batch->buffer.length = mark;
+                }
             }
         }
-        /* Codes_SRS_CODEFIRST_99_093:[After all values have been published, Device_EndTransaction shall be called.] */
-        else if (Device_EndTransaction(transaction, destination, destinationSize) != DEVICE_OK)
-        {
-            /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
-            result = CODEFIRST_DEVICE_PUBLISH_FAILED;
-            LOG_CODEFIRST_ERROR;
-        }
-        else
-        {
-            /* Codes_SRS_CODEFIRST_99_117:[On success, CodeFirst_SendAsync shall return CODEFIRST_OK.] */
-            result = CODEFIRST_OK;
-        }
+    }
 
-        va_end(ap);
+    return result;
+}
+
+CODEFIRST_RESULT CodeFirst_FlushBatch(CODEFIRST_BATCH_HANDLE batch, unsigned char** destination, size_t* destinationSize)
+{
+    CODEFIRST_RESULT result;
 
+    /*Codes_SRS_CODEFIRST_09_031: [ If batch, destination or destinationSize is NULL, CodeFirst_FlushBatch shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    if ((batch == NULL) ||
+        (destination == NULL) ||
+        (destinationSize == NULL))
+    {
+        result = CODEFIRST_INVALID_ARG;
+        LOG_CODEFIRST_ERROR;
+    }
+    else if (batch->snapshotCount == 0)
+    {
+        /*Codes_SRS_CODEFIRST_09_032: [ If batch holds no snapshot, CodeFirst_FlushBatch shall set *destination to NULL and *destinationSize to 0 and return CODEFIRST_OK. ]*/
+        *destination = NULL;
+        *destinationSize = 0;
+        result = CODEFIRST_OK;
+    }
+    else if (JSONEncoder_Buffer_Append(&batch->buffer, "]", 1) != JSON_ENCODER_OK)
+    {
+        /*Codes_SRS_CODEFIRST_09_034: [ If any failure occurs, CodeFirst_FlushBatch shall fail, leave batch as it was and return CODEFIRST_ERROR. ]*/
+        result = CODEFIRST_ERROR;
+        LOG_CODEFIRST_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_CODEFIRST_09_033: [ Otherwise CodeFirst_FlushBatch shall hand over in *destination and *destinationSize the JSON array of all the snapshots appended since the last flush, in the order they were appended, and leave batch empty. ]*/
+        *destination = (unsigned char*)batch->buffer.buffer;
+        *destinationSize = batch->buffer.length;
+        batch->lastSize = batch->buffer.length;
+        batch->buffer.buffer = NULL;
+        batch->buffer.length = 0;
+        batch->buffer.capacity = 0;
+        batch->snapshotCount = 0;
+        result = CODEFIRST_OK;
     }
 
     return result;
 }
 
+size_t CodeFirst_GetBatchSnapshotCount(CODEFIRST_BATCH_HANDLE batch)
+{
+    /*Codes_SRS_CODEFIRST_09_035: [ CodeFirst_GetBatchSnapshotCount shall return the number of snapshots appended to batch since the last flush, or 0 if batch is NULL. ]*/
+    return (batch == NULL) ? 0 : batch->snapshotCount;
+}
+
 CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t* destinationSize, size_t numReportedProperties, ...)
 {
     CODEFIRST_RESULT result;
@@ -1451,7 +2608,7 @@ CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t
                             modelName = Schema_GetModelName(deviceHeader->ModelHandle);
 
                             /*Codes_SRS_CODEFIRST_02_025: [ CodeFirst_SendAsyncReported shall compute for every AGENT_DATA_TYPE the valuePath. ]*/
-                            if ((propertyReflectedData = FindReportedProperty(deviceHeader, value, modelName, 0, valuePath)) == NULL)
+                            if ((propertyReflectedData = FindReportedProperty(deviceHeader, GetDeviceModelIndex(deviceHeader, modelName), value, modelName, 0, valuePath)) == NULL)
                             {
                                 result = CODEFIRST_INVALID_ARG;
                                 LOG_CODEFIRST_ERROR;
@@ -1524,6 +2681,403 @@ CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t
     return result;
 }
 
+static size_t CountReportedLeaves(const CODEFIRST_MODEL_INDEX* modelIndex)
+{
+    size_t result = 0;
+    size_t i;
+
+    for (i = 0; i < modelIndex->reportedPropertyCount; i++)
+    {
+        result += (modelIndex->reportedProperties[i].childModel != NULL) ?
+            CountReportedLeaves(modelIndex->reportedProperties[i].childModel) :
+            1;
+    }
+
+    return result;
+}
+
+/*appends to deviceHeader->ReportedLeaves the reported properties of modelIndex, going down into the reported properties that are models*/
+static int AddReportedLeaves(DEVICE_HEADER_DATA* deviceHeader, const CODEFIRST_MODEL_INDEX* modelIndex, const char* pathPrefix, size_t baseOffset)
+{
+    int result = 0;
+    size_t i;
+
+    for (i = 0; i < modelIndex->reportedPropertyCount; i++)
+    {
+        const CODEFIRST_PROPERTY_INDEX_ENTRY* entry = &modelIndex->reportedProperties[i];
+        STRING_HANDLE path;
+
+        if ((path = STRING_construct(pathPrefix)) == NULL)
+        {
+            LogError("unable to STRING_construct");
+            result = MU_FAILURE;
+        }
+        else if (((*pathPrefix != '\0') && (STRING_concat(path, "/") != 0)) ||
+            (STRING_concat(path, entry->name) != 0))
+        {
+            LogError("unable to STRING_concat");
+            STRING_delete(path);
+            result = MU_FAILURE;
+        }
+        else if (entry->childModel != NULL)
+        {
+            result = AddReportedLeaves(deviceHeader, entry->childModel, STRING_c_str(path), baseOffset + entry->offset);
+            STRING_delete(path);
+        }
+        else
+        {
+            CODEFIRST_REPORTED_LEAF* leaf = &deviceHeader->ReportedLeaves[deviceHeader->ReportedLeafCount++];
+            leaf->path = path;
+            leaf->offset = baseOffset + entry->offset;
+            leaf->something = entry->something;
+            leaf->acknowledgedValue = NULL;
+        }
+
+        if (result != 0)
+        {
+            break;
+        }
+    }
+
+    return result;
+}
+
+static int BuildReportedLeaves(DEVICE_HEADER_DATA* deviceHeader)
+{
+    int result;
+
+    if (deviceHeader->ReportedLeaves != NULL)
+    {
+        result = 0;
+    }
+    else
+    {
+        const char* modelName;
+        const CODEFIRST_MODEL_INDEX* modelIndex;
+        size_t leafCount;
+
+        if ((modelName = Schema_GetModelName(deviceHeader->ModelHandle)) == NULL)
+        {
+            LogError("unable to get the model name of the device");
+            result = MU_FAILURE;
+        }
+        else if ((modelIndex = GetDeviceModelIndex(deviceHeader, modelName)) == NULL)
+        {
+            LogError("unable to get the index of model %s", modelName);
+            result = MU_FAILURE;
+        }
+        else if ((leafCount = CountReportedLeaves(modelIndex)) == 0)
+        {
+            /*a model without reported properties never has anything to report*/
+            result = 0;
+        }
+        else if ((deviceHeader->ReportedLeaves = (CODEFIRST_REPORTED_LEAF*)malloc(leafCount * sizeof(CODEFIRST_REPORTED_LEAF))) == NULL)
+        {
+            LogError("unable to allocate %lu reported properties", (unsigned long)leafCount);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            deviceHeader->ReportedLeafCount = 0;
+            if (AddReportedLeaves(deviceHeader, modelIndex, "", 0) != 0)
+            {
+                DestroyReportedLeaves(deviceHeader);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+static CODEFIRST_PENDING_REPORT* CreatePendingReport(size_t leafCount)
+{
+    CODEFIRST_PENDING_REPORT* result;
+
+    if ((result = (CODEFIRST_PENDING_REPORT*)malloc(sizeof(CODEFIRST_PENDING_REPORT))) == NULL)
+    {
+        LogError("unable to allocate a pending report");
+    }
+    else if ((result->values = (STRING_HANDLE*)malloc(leafCount * sizeof(STRING_HANDLE))) == NULL)
+    {
+        LogError("unable to allocate the values of %lu reported properties", (unsigned long)leafCount);
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        size_t i;
+        for (i = 0; i < leafCount; i++)
+        {
+            result->values[i] = NULL;
+        }
+        result->token = 0;
+        result->next = NULL;
+    }
+
+    return result;
+}
+
+/*a report that leaves the pending list without its own acknowledgement might or might not have reached the service, so the properties it carried are no longer known to be acknowledged*/
+static void DropUnacknowledgedReport(DEVICE_HEADER_DATA* deviceHeader, CODEFIRST_PENDING_REPORT* report)
+{
+    size_t i;
+    for (i = 0; i < deviceHeader->ReportedLeafCount; i++)
+    {
+        if ((report->values[i] != NULL) &&
+            (deviceHeader->ReportedLeaves[i].acknowledgedValue != NULL))
+        {
+            STRING_delete(deviceHeader->ReportedLeaves[i].acknowledgedValue);
+            deviceHeader->ReportedLeaves[i].acknowledgedValue = NULL;
+        }
+    }
+    DestroyPendingReport(report, deviceHeader->ReportedLeafCount);
+    deviceHeader->PendingReportCount--;
+}
+
+static void AppendPendingReport(DEVICE_HEADER_DATA* deviceHeader, CODEFIRST_PENDING_REPORT* report)
+{
+    CODEFIRST_PENDING_REPORT** last = &deviceHeader->PendingReports;
+
+    if (deviceHeader->PendingReportCount == CODEFIRST_MAX_PENDING_REPORTS)
+    {
+        CODEFIRST_PENDING_REPORT* oldest = deviceHeader->PendingReports;
+        deviceHeader->PendingReports = oldest->next;
+        DropUnacknowledgedReport(deviceHeader, oldest);
+    }
+
+    while (*last != NULL)
+    {
+        last = &(*last)->next;
+    }
+
+    /*0 is never a token, it is what a report that sent nothing produces*/
+    deviceHeader->LastReportToken++;
+    if (deviceHeader->LastReportToken == 0)
+    {
+        deviceHeader->LastReportToken++;
+    }
+    report->token = deviceHeader->LastReportToken;
+    *last = report;
+    deviceHeader->PendingReportCount++;
+}
+
+CODEFIRST_RESULT CodeFirst_SendAsyncReportedDirty(unsigned char** destination, size_t* destinationSize, void* device, size_t* reportToken)
+{
+    CODEFIRST_RESULT result;
+    DEVICE_HEADER_DATA* deviceHeader;
+
+    /*Codes_SRS_CODEFIRST_09_009: [ If destination, destinationSize, device or reportToken is NULL then CodeFirst_SendAsyncReportedDirty shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    if ((destination == NULL) ||
+        (destinationSize == NULL) ||
+        (device == NULL) ||
+        (reportToken == NULL))
+    {
+        LogError("invalid argument unsigned char** destination=%p, size_t* destinationSize=%p, void* device=%p, size_t* reportToken=%p", destination, destinationSize, device, reportToken);
+        result = CODEFIRST_INVALID_ARG;
+    }
+    /*Codes_SRS_CODEFIRST_09_010: [ If device is not a pointer returned by CodeFirst_CreateDevice then CodeFirst_SendAsyncReportedDirty shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    else if (((deviceHeader = FindDevice(device)) == NULL) ||
+        (deviceHeader->data != (unsigned char*)device))
+    {
+        result = CODEFIRST_INVALID_ARG;
+        LOG_CODEFIRST_ERROR;
+    }
+    /*Codes_SRS_CODEFIRST_09_011: [ CodeFirst_SendAsyncReportedDirty shall consider every reported property of the model of the device, going down into reported properties that are models. ]*/
+    else if (BuildReportedLeaves(deviceHeader) != 0)
+    {
+        result = CODEFIRST_ERROR;
+        LOG_CODEFIRST_ERROR;
+    }
+    else if (deviceHeader->ReportedLeafCount == 0)
+    {
+        /*Codes_SRS_CODEFIRST_09_014: [ If no reported property is dirty, CodeFirst_SendAsyncReportedDirty shall set *destination to NULL, *destinationSize to 0 and *reportToken to 0 and return CODEFIRST_OK. ]*/
+        *destination = NULL;
+        *destinationSize = 0;
+        *reportToken = 0;
+        result = CODEFIRST_OK;
+    }
+    else
+    {
+        REPORTED_PROPERTIES_TRANSACTION_HANDLE transaction = NULL;
+        CODEFIRST_PENDING_REPORT* report;
+
+        /*Codes_SRS_CODEFIRST_09_019: [ CodeFirst_SendAsyncReportedDirty shall keep the values it sends in a pending report of their own, leaving the pending reports of earlier calls untouched. ]*/
+        if ((report = CreatePendingReport(deviceHeader->ReportedLeafCount)) == NULL)
+        {
+            result = CODEFIRST_ERROR;
+            LOG_CODEFIRST_ERROR;
+        }
+        else
+        {
+            size_t i;
+
+            result = CODEFIRST_OK;
+            for (i = 0; i < deviceHeader->ReportedLeafCount; i++)
+            {
+                CODEFIRST_REPORTED_LEAF* leaf = &deviceHeader->ReportedLeaves[i];
+                AGENT_DATA_TYPE agentDataType;
+                STRING_HANDLE value;
+
+                if ((value = STRING_new()) == NULL)
+                {
+                    result = CODEFIRST_ERROR;
+                    LOG_CODEFIRST_ERROR;
+                }
+                else if (leaf->something->what.reportedProperty.Create_AGENT_DATA_TYPE_from_Ptr(deviceHeader->data + leaf->offset, &agentDataType) != AGENT_DATA_TYPES_OK)
+                {
+                    STRING_delete(value);
+                    result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                    LOG_CODEFIRST_ERROR;
+                }
+                else
+                {
+                    /*Codes_SRS_CODEFIRST_09_012: [ A reported property is dirty when it has never been acknowledged or when its JSON differs from the JSON acknowledged last time. ]*/
+                    if (AgentDataTypes_ToString(value, &agentDataType) != AGENT_DATA_TYPES_OK)
+                    {
+                        STRING_delete(value);
+                        result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                        LOG_CODEFIRST_ERROR;
+                    }
+                    else if ((leaf->acknowledgedValue != NULL) &&
+                        (strcmp(STRING_c_str(leaf->acknowledgedValue), STRING_c_str(value)) == 0))
+                    {
+                        STRING_delete(value);
+                    }
+                    /*Codes_SRS_CODEFIRST_09_013: [ CodeFirst_SendAsyncReportedDirty shall publish only the dirty reported properties, by their full path, in one transaction created by Device_CreateTransaction_ReportedProperties. ]*/
+                    else if ((transaction == NULL) &&
+                        ((transaction = Device_CreateTransaction_ReportedProperties(deviceHeader->DeviceHandle)) == NULL))
+                    {
+                        STRING_delete(value);
+                        result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                        LOG_CODEFIRST_ERROR;
+                    }
+                    else if (Device_PublishTransacted_ReportedProperty(transaction, STRING_c_str(leaf->path), &agentDataType) != DEVICE_OK)
+                    {
+                        STRING_delete(value);
+                        result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                        LOG_CODEFIRST_ERROR;
+                    }
+                    else
+                    {
+                        report->values[i] = value;
+                    }
+
+                    Destroy_AGENT_DATA_TYPE(&agentDataType);
+                }
+
+                if (result != CODEFIRST_OK)
+                {
+                    break;
+                }
+            }
+
+            if (result != CODEFIRST_OK)
+            {
+                /*Codes_SRS_CODEFIRST_09_016: [ If any error occurs, CodeFirst_SendAsyncReportedDirty shall fail and leave the acknowledged state and the pending reports of the device unchanged. ]*/
+                DestroyPendingReport(report, deviceHeader->ReportedLeafCount);
+            }
+            else if (transaction == NULL)
+            {
+                /*Codes_SRS_CODEFIRST_09_014: [ If no reported property is dirty, CodeFirst_SendAsyncReportedDirty shall set *destination to NULL, *destinationSize to 0 and *reportToken to 0 and return CODEFIRST_OK. ]*/
+                DestroyPendingReport(report, deviceHeader->ReportedLeafCount);
+                *destination = NULL;
+                *destinationSize = 0;
+                *reportToken = 0;
+            }
+            /*Codes_SRS_CODEFIRST_09_015: [ CodeFirst_SendAsyncReportedDirty shall commit the transaction by calling Device_CommitTransaction_ReportedProperties. ]*/
+            else if (Device_CommitTransaction_ReportedProperties(transaction, destination, destinationSize) != DEVICE_OK)
+            {
+                DestroyPendingReport(report, deviceHeader->ReportedLeafCount);
+                result = CODEFIRST_DEVICE_PUBLISH_FAILED;
+                LOG_CODEFIRST_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_CODEFIRST_09_020: [ CodeFirst_SendAsyncReportedDirty shall give the pending report a token that is not 0 and larger than the token of any earlier report of the device, set *reportToken to it and return CODEFIRST_OK. ]*/
+                /*Codes_SRS_CODEFIRST_09_021: [ When the device already has CODEFIRST_MAX_PENDING_REPORTS pending reports, CodeFirst_SendAsyncReportedDirty shall drop the oldest one and the reported properties it carried shall be dirty again. ]*/
+                AppendPendingReport(deviceHeader, report);
+                *reportToken = report->token;
+            }
+
+            if (transaction != NULL)
+            {
+                Device_DestroyTransaction_ReportedProperties(transaction);
+            }
+        }
+    }
+
+    return result;
+}
+
+CODEFIRST_RESULT CodeFirst_AcknowledgeReportedProperties(void* device, size_t reportToken)
+{
+    CODEFIRST_RESULT result;
+    DEVICE_HEADER_DATA* deviceHeader;
+
+    /*Codes_SRS_CODEFIRST_09_017: [ If device is NULL or is not a pointer returned by CodeFirst_CreateDevice then CodeFirst_AcknowledgeReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    if ((device == NULL) ||
+        ((deviceHeader = FindDevice(device)) == NULL) ||
+        (deviceHeader->data != (unsigned char*)device))
+    {
+        LogError("invalid argument void* device=%p", device);
+        result = CODEFIRST_INVALID_ARG;
+    }
+    else
+    {
+        CODEFIRST_PENDING_REPORT* report = deviceHeader->PendingReports;
+
+        while ((report != NULL) && (report->token != reportToken))
+        {
+            report = report->next;
+        }
+
+        if (report == NULL)
+        {
+            /*Codes_SRS_CODEFIRST_09_022: [ If reportToken is not the token of a pending report of the device, because it is 0, already acknowledged or superseded by the acknowledgement of a later report, then CodeFirst_AcknowledgeReportedProperties shall leave the device unchanged and return CODEFIRST_OK. ]*/
+        }
+        else
+        {
+            size_t i;
+
+            /*Codes_SRS_CODEFIRST_09_023: [ CodeFirst_AcknowledgeReportedProperties shall drop the pending reports older than the acknowledged one, and the reported properties they carried that the acknowledged report does not carry shall be dirty again. ]*/
+            while (deviceHeader->PendingReports != report)
+            {
+                CODEFIRST_PENDING_REPORT* oldest = deviceHeader->PendingReports;
+                deviceHeader->PendingReports = oldest->next;
+                DropUnacknowledgedReport(deviceHeader, oldest);
+            }
+
+            /*Codes_SRS_CODEFIRST_09_018: [ CodeFirst_AcknowledgeReportedProperties shall make the values sent by the report of reportToken the acknowledged values, so they are no longer dirty, and return CODEFIRST_OK. ]*/
+            for (i = 0; i < deviceHeader->ReportedLeafCount; i++)
+            {
+                CODEFIRST_REPORTED_LEAF* leaf = &deviceHeader->ReportedLeaves[i];
+                if (report->values[i] != NULL)
+                {
+                    if (leaf->acknowledgedValue != NULL)
+                    {
+                        STRING_delete(leaf->acknowledgedValue);
+                    }
+                    leaf->acknowledgedValue = report->values[i];
+                    report->values[i] = NULL;
+                }
+            }
+
+            deviceHeader->PendingReports = report->next;
+            DestroyPendingReport(report, deviceHeader->ReportedLeafCount);
+            deviceHeader->PendingReportCount--;
+        }
+
+        result = CODEFIRST_OK;
+    }
+
+    return result;
+}
+
 EXECUTE_COMMAND_RESULT CodeFirst_ExecuteCommand(void* device, const char* command)
 {
     EXECUTE_COMMAND_RESULT result;
@@ -2,10 +2,14 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <errno.h>
+#include <math.h>
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "commanddecoder.h"
 #include "multitree.h"
@@ -17,6 +21,26 @@
 
 MU_DEFINE_ENUM_STRINGS(COMMANDDECODER_RESULT, COMMANDDECODER_RESULT_VALUES);
 
+/*methods with up to this many arguments decode them into a stack array*/
+#define METHOD_ARGUMENTS_STACK_COUNT 8
+
+/*how one argument of a method is decoded, resolved from the schema the first time the method is executed*/
+typedef struct METHOD_ARGUMENT_DECODER_TAG
+{
+    const char* name;
+    size_t nameLength;
+    const char* type;
+    AGENT_DATA_TYPE_TYPE primitiveType; /*EDM_NO_TYPE for struct arguments*/
+} METHOD_ARGUMENT_DECODER;
+
+typedef struct METHOD_DISPATCH_ENTRY_TAG
+{
+    SCHEMA_METHOD_HANDLE methodHandle;
+    size_t argumentCount;
+    bool hasStructArguments; /*struct arguments are still decoded from a MULTITREE*/
+    METHOD_ARGUMENT_DECODER* arguments;
+} METHOD_DISPATCH_ENTRY;
+
 typedef struct COMMAND_DECODER_HANDLE_DATA_TAG
 {
     METHOD_CALLBACK_FUNC methodCallback;
@@ -24,8 +48,19 @@ typedef struct COMMAND_DECODER_HANDLE_DATA_TAG
     SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
     ACTION_CALLBACK_FUNC ActionCallback;
     void* ActionCallbackContext;
+    METHOD_DISPATCH_ENTRY* methodDispatch; /*sorted by method handle*/
+    size_t methodDispatchCount;
 } COMMAND_DECODER_HANDLE_DATA;
 
+/*the walk of a method payload that has only primitive arguments*/
+typedef struct METHOD_ARGUMENTS_WALK_TAG
+{
+    const METHOD_DISPATCH_ENTRY* entry;
+    AGENT_DATA_TYPE* values; /*EDM_NO_TYPE until the argument has been seen*/
+} METHOD_ARGUMENTS_WALK;
+
+static int DecodePrimitiveValue(const char* value, size_t valueLength, AGENT_DATA_TYPE_TYPE primitiveType, AGENT_DATA_TYPE* output);
+
 static int DecodeValueFromNode(SCHEMA_HANDLE schemaHandle, AGENT_DATA_TYPE* agentDataType, MULTITREE_HANDLE node, const char* edmTypeName)
 {
     /* because "pottentially uninitialized variable on MS compiler" */
@@ -294,7 +329,309 @@ static EXECUTE_COMMAND_RESULT DecodeAndExecuteModelAction(COMMAND_DECODER_HANDLE
     return result;
 }
 
-static METHODRETURN_HANDLE DecodeAndExecuteModelMethod(COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance, SCHEMA_HANDLE schemaHandle, SCHEMA_MODEL_TYPE_HANDLE modelHandle, const char* relativeMethodPath, const char* methodName, MULTITREE_HANDLE methodTree)
+static void DestroyMethodDispatch(COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance)
+{
+    size_t i;
+    for (i = 0; i < commandDecoderInstance->methodDispatchCount; i++)
+    {
+        if (commandDecoderInstance->methodDispatch[i].arguments != NULL)
+        {
+            free(commandDecoderInstance->methodDispatch[i].arguments);
+        }
+    }
+
+    if (commandDecoderInstance->methodDispatch != NULL)
+    {
+        free(commandDecoderInstance->methodDispatch);
+        commandDecoderInstance->methodDispatch = NULL;
+    }
+    commandDecoderInstance->methodDispatchCount = 0;
+}
+
+static int ResolveMethodArguments(METHOD_DISPATCH_ENTRY* entry)
+{
+    int result;
+
+    if (Schema_GetModelMethodArgumentCount(entry->methodHandle, &entry->argumentCount) != SCHEMA_OK)
+    {
+        LogError("Failed reading the argument count of the method from the schema");
+        result = MU_FAILURE;
+    }
+    else if (entry->argumentCount == 0)
+    {
+        entry->arguments = NULL;
+        entry->hasStructArguments = false;
+        result = 0;
+    }
+    else if ((entry->arguments = (METHOD_ARGUMENT_DECODER*)malloc(sizeof(METHOD_ARGUMENT_DECODER) * entry->argumentCount)) == NULL)
+    {
+        LogError("Failed allocating the argument decoders");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        size_t i;
+        entry->hasStructArguments = false;
+
+        for (i = 0; i < entry->argumentCount; i++)
+        {
+            SCHEMA_METHOD_ARGUMENT_HANDLE methodArgumentHandle;
+            METHOD_ARGUMENT_DECODER* argument = &entry->arguments[i];
+
+            if (((methodArgumentHandle = Schema_GetModelMethodArgumentByIndex(entry->methodHandle, i)) == NULL) ||
+                ((argument->name = Schema_GetMethodArgumentName(methodArgumentHandle)) == NULL) ||
+                ((argument->type = Schema_GetMethodArgumentType(methodArgumentHandle)) == NULL))
+            {
+                /*Codes_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
+                LogError("Failed getting the argument information from the schema");
+                break;
+            }
+            else
+            {
+                argument->nameLength = strlen(argument->name);
+                if ((argument->primitiveType = CodeFirst_GetPrimitiveType(argument->type)) == EDM_NO_TYPE)
+                {
+                    entry->hasStructArguments = true;
+                }
+            }
+        }
+
+        if (i < entry->argumentCount)
+        {
+            free(entry->arguments);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+/*returns the dispatch entry of the method, resolving it the first time the method is executed*/
+static const METHOD_DISPATCH_ENTRY* GetMethodDispatchEntry(COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance, SCHEMA_METHOD_HANDLE methodHandle)
+{
+    const METHOD_DISPATCH_ENTRY* result;
+    size_t low = 0;
+    size_t high = commandDecoderInstance->methodDispatchCount;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if ((uintptr_t)commandDecoderInstance->methodDispatch[middle].methodHandle < (uintptr_t)methodHandle)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    /*Codes_SRS_COMMAND_DECODER_09_008: [ The first time a method is executed, CommandDecoder_ExecuteMethod shall resolve the name, type and primitive type of every argument from the Schema and keep them in the dispatch table of the instance. Later executions of the method shall use the dispatch table. ]*/
+    if ((low < commandDecoderInstance->methodDispatchCount) &&
+        (commandDecoderInstance->methodDispatch[low].methodHandle == methodHandle))
+    {
+        result = &commandDecoderInstance->methodDispatch[low];
+    }
+    else
+    {
+        METHOD_DISPATCH_ENTRY entry;
+        METHOD_DISPATCH_ENTRY* newMethodDispatch;
+
+        entry.methodHandle = methodHandle;
+        if (ResolveMethodArguments(&entry) != 0)
+        {
+            result = NULL;
+        }
+        else if ((newMethodDispatch = (METHOD_DISPATCH_ENTRY*)realloc(commandDecoderInstance->methodDispatch, sizeof(METHOD_DISPATCH_ENTRY) * (commandDecoderInstance->methodDispatchCount + 1))) == NULL)
+        {
+            LogError("Failed growing the method dispatch table");
+            free(entry.arguments);
+            result = NULL;
+        }
+        else
+        {
+            (void)memmove(&newMethodDispatch[low + 1], &newMethodDispatch[low], sizeof(METHOD_DISPATCH_ENTRY) * (commandDecoderInstance->methodDispatchCount - low));
+            newMethodDispatch[low] = entry;
+            commandDecoderInstance->methodDispatch = newMethodDispatch;
+            commandDecoderInstance->methodDispatchCount++;
+            result = &newMethodDispatch[low];
+        }
+    }
+
+    return result;
+}
+
+static JSON_DECODER_ACTION OnMethodArgumentValue(void* context, const char* name, size_t nameLength, JSON_DECODER_VALUE_TYPE valueType, const char* value, size_t valueLength)
+{
+    JSON_DECODER_ACTION result;
+    METHOD_ARGUMENTS_WALK* walk = (METHOD_ARGUMENTS_WALK*)context;
+    size_t i;
+
+    if (name == NULL)
+    {
+        LogError("method payload is not a JSON object");
+        result = JSON_DECODER_ACTION_ABORT;
+    }
+    else
+    {
+        for (i = 0; i < walk->entry->argumentCount; i++)
+        {
+            if ((walk->entry->arguments[i].nameLength == nameLength) &&
+                (strncmp(walk->entry->arguments[i].name, name, nameLength) == 0))
+            {
+                break;
+            }
+        }
+
+        if (i == walk->entry->argumentCount)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_010: [ Members of methodPayload that are not arguments of the method shall be skipped. ]*/
+            result = JSON_DECODER_ACTION_SKIP;
+        }
+        else if (walk->values[i].type != EDM_NO_TYPE)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_011: [ If an argument is repeated, missing or its value is an object or an array then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
+            LogError("argument %s is repeated", walk->entry->arguments[i].name);
+            result = JSON_DECODER_ACTION_ABORT;
+        }
+        else if ((valueType == JSON_DECODER_VALUE_OBJECT) || (valueType == JSON_DECODER_VALUE_ARRAY))
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_011: [ If an argument is repeated, missing or its value is an object or an array then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
+            LogError("argument %s is not of a primitive type", walk->entry->arguments[i].name);
+            result = JSON_DECODER_ACTION_ABORT;
+        }
+        else if (DecodePrimitiveValue(value, valueLength, walk->entry->arguments[i].primitiveType, &walk->values[i]) != 0)
+        {
+            LogError("failure decoding argument %s", walk->entry->arguments[i].name);
+            result = JSON_DECODER_ACTION_ABORT;
+        }
+        else
+        {
+            result = JSON_DECODER_ACTION_CONTINUE;
+        }
+    }
+
+    return result;
+}
+
+static JSON_DECODER_ACTION OnMethodArgumentEnd(void* context)
+{
+    /*only reached by containers that are walked into, arguments never are*/
+    (void)context;
+    return JSON_DECODER_ACTION_CONTINUE;
+}
+
+static const JSON_DECODER_CALLBACKS methodArgumentsCallbacks =
+{
+    OnMethodArgumentValue,
+    OnMethodArgumentEnd
+};
+
+/*fills the arguments that have primitive types straight from the payload*/
+static int DecodeMethodArgumentsFromJSON(const METHOD_DISPATCH_ENTRY* entry, const char* methodPayload, AGENT_DATA_TYPE* arguments)
+{
+    int result;
+    METHOD_ARGUMENTS_WALK walk;
+    size_t i;
+
+    walk.entry = entry;
+    walk.values = arguments;
+
+    /*Codes_SRS_COMMAND_DECODER_09_009: [ If the method has no argument of a struct type and methodPayload is not NULL then CommandDecoder_ExecuteMethod shall walk methodPayload once by calling JSONDecoder_JSON_To_Callbacks and build the AGENT_DATA_TYPE of every argument from the member with the same name. ]*/
+    if ((methodPayload != NULL) &&
+        (JSONDecoder_JSON_To_Callbacks(methodPayload, &methodArgumentsCallbacks, &walk) != JSON_DECODER_OK))
+    {
+        LogError("Decoding the method payload failed");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        for (i = 0; i < entry->argumentCount; i++)
+        {
+            if (arguments[i].type == EDM_NO_TYPE)
+            {
+                break;
+            }
+        }
+
+        if (i < entry->argumentCount)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_011: [ If an argument is repeated, missing or its value is an object or an array then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
+            LogError("Missing argument %s", entry->arguments[i].name);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+/*fills all the arguments from a MULTITREE built out of the payload, used when an argument has a struct type*/
+static int DecodeMethodArgumentsFromMultiTree(SCHEMA_HANDLE schemaHandle, const METHOD_DISPATCH_ENTRY* entry, const char* methodPayload, AGENT_DATA_TYPE* arguments)
+{
+    int result;
+    char* methodJSON;
+
+    if (methodPayload == NULL)
+    {
+        /*Codes_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
+        LogError("Missing argument %s", entry->arguments[0].name);
+        result = MU_FAILURE;
+    }
+    /*Codes_SRS_COMMAND_DECODER_02_016: [ If methodPayload is not NULL and the method has an argument of a struct type then CommandDecoder_ExecuteMethod shall build a MULTITREE_HANDLE out of methodPayload. ]*/
+    else if (mallocAndStrcpy_s(&methodJSON, methodPayload) != 0)
+    {
+        LogError("Failed to allocate temporary storage for the method JSON");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        MULTITREE_HANDLE methodTree;
+        if (JSONDecoder_JSON_To_MultiTree(methodJSON, &methodTree) != JSON_DECODER_OK)
+        {
+            LogError("Decoding JSON to a multi tree failed");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            size_t i;
+
+            for (i = 0; i < entry->argumentCount; i++)
+            {
+                MULTITREE_HANDLE argumentNode;
+
+                if (MultiTree_GetChildByName(methodTree, entry->arguments[i].name, &argumentNode) != MULTITREE_OK)
+                {
+                    /*Codes_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
+                    LogError("Missing argument %s", entry->arguments[i].name);
+                    break;
+                }
+                /*Codes_SRS_COMMAND_DECODER_02_021: [ For every argument of methodName, CommandDecoder_ExecuteMethod shall build an AGENT_DATA_TYPE from the node with the same name from the MULTITREE_HANDLE. ]*/
+                else if (DecodeValueFromNode(schemaHandle, &arguments[i], argumentNode, entry->arguments[i].type) != 0)
+                {
+                    /*Codes_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
+                    LogError("failure in DecodeValueFromNode");
+                    break;
+                }
+            }
+
+            result = (i == entry->argumentCount) ? 0 : MU_FAILURE;
+            MultiTree_Destroy(methodTree);
+        }
+        free(methodJSON);
+    }
+
+    return result;
+}
+
+static METHODRETURN_HANDLE DecodeAndExecuteModelMethod(COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance, SCHEMA_HANDLE schemaHandle, SCHEMA_MODEL_TYPE_HANDLE modelHandle, const char* relativeMethodPath, const char* methodName, const char* methodPayload)
 {
     METHODRETURN_HANDLE result;
     size_t strLength = strlen(methodName);
@@ -308,94 +645,71 @@ static METHODRETURN_HANDLE DecodeAndExecuteModelMethod(COMMAND_DECODER_HANDLE_DA
     else
     {
         SCHEMA_METHOD_HANDLE modelMethodHandle;
-        size_t argCount;
-
-#ifdef _MSC_VER
-#pragma warning(suppress: 6324) /* We intentionally use here strncpy */
-#endif
+        const METHOD_DISPATCH_ENTRY* entry;
 
         /*Codes_SRS_COMMAND_DECODER_02_020: [ CommandDecoder_ExecuteMethod shall verify that the model has a method called methodName. ]*/
         if (((modelMethodHandle = Schema_GetModelMethodByName(modelHandle, methodName)) == NULL) ||
-            (Schema_GetModelMethodArgumentCount(modelMethodHandle, &argCount) != SCHEMA_OK))
+            ((entry = GetMethodDispatchEntry(commandDecoderInstance, modelMethodHandle)) == NULL))
         {
             /*Codes_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
             LogError("Failed reading method %s from the schema", methodName);
             result = NULL;
         }
+        else if ((entry->argumentCount == 0) && (methodPayload == NULL))
+        {
+            /*no need for any parameters*/
+            result = commandDecoderInstance->methodCallback(commandDecoderInstance->methodCallbackContext, relativeMethodPath, methodName, 0, NULL);
+        }
         else
         {
-            /*Codes_SRS_COMMAND_DECODER_02_021: [ For every argument of methodName, CommandDecoder_ExecuteMethod shall build an AGENT_DATA_TYPE from the node with the same name from the MULTITREE_HANDLE. ]*/
+            AGENT_DATA_TYPE stackArguments[METHOD_ARGUMENTS_STACK_COUNT];
+            AGENT_DATA_TYPE* arguments = (entry->argumentCount <= METHOD_ARGUMENTS_STACK_COUNT) ? stackArguments : (AGENT_DATA_TYPE*)malloc(sizeof(AGENT_DATA_TYPE) * entry->argumentCount);
 
-            if (argCount == 0)
+            if (arguments == NULL)
             {
-                /*no need for any parameters*/
-                result = commandDecoderInstance->methodCallback(commandDecoderInstance->methodCallbackContext, relativeMethodPath, methodName, 0, NULL);
+                LogError("Failed allocating arguments array");
+                result = NULL;
             }
             else
             {
-                AGENT_DATA_TYPE* arguments;
-                arguments = (AGENT_DATA_TYPE*)malloc(sizeof(AGENT_DATA_TYPE)* argCount);
-                if (arguments == NULL)
+                size_t i;
+                int decodeResult;
+
+                for (i = 0; i < entry->argumentCount; i++)
                 {
-                    LogError("Failed allocating arguments array");
+                    arguments[i].type = EDM_NO_TYPE;
+                }
+
+                decodeResult = entry->hasStructArguments ?
+                    DecodeMethodArgumentsFromMultiTree(schemaHandle, entry, methodPayload, arguments) :
+                    DecodeMethodArgumentsFromJSON(entry, methodPayload, arguments);
+
+                if (decodeResult != 0)
+                {
+                    /*Codes_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
                     result = NULL;
                 }
                 else
                 {
-                    size_t i;
-                    size_t j;
-                    result = NULL;
-
-                    for (i = 0; i < argCount; i++)
-                    {
-                        SCHEMA_METHOD_ARGUMENT_HANDLE methodArgumentHandle;
-                        MULTITREE_HANDLE argumentNode;
-                        const char* argName;
-                        const char* argType;
-
-                        if (((methodArgumentHandle = Schema_GetModelMethodArgumentByIndex(modelMethodHandle, i)) == NULL) ||
-                            ((argName = Schema_GetMethodArgumentName(methodArgumentHandle)) == NULL) ||
-                            ((argType = Schema_GetMethodArgumentType(methodArgumentHandle)) == NULL))
-                        {
-                            /*Codes_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
-                            LogError("Failed getting the argument information from the schema");
-                            result = NULL;
-                            break;
-                        }
-                        else if (MultiTree_GetChildByName(methodTree, argName, &argumentNode) != MULTITREE_OK)
-                        {
-                            /*Codes_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
-                            LogError("Missing argument %s", argName);
-                            result = NULL;
-                            break;
-                        }
-                        else if (DecodeValueFromNode(schemaHandle, &arguments[i], argumentNode, argType) != 0)
-                        {
-                            /*Codes_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
-                            LogError("failure in DecodeValueFromNode");
-                            result = NULL;
-                            break;
-                        }
-                    }
-
-                    if (i == argCount)
-                    {
-                        /*Codes_SRS_COMMAND_DECODER_02_022: [ CommandDecoder_ExecuteMethod shall call methodCallback passing the context, the methodName, number of arguments and the AGENT_DATA_TYPE. ]*/
-                        /*Codes_SRS_COMMAND_DECODER_02_024: [ Otherwise, CommandDecoder_ExecuteMethod shall return what methodCallback returns. ]*/
-                        result = commandDecoderInstance->methodCallback(commandDecoderInstance->methodCallbackContext, relativeMethodPath, methodName, argCount, arguments);
-                    }
+                    /*Codes_SRS_COMMAND_DECODER_02_022: [ CommandDecoder_ExecuteMethod shall call methodCallback passing the context, the methodName, number of arguments and the AGENT_DATA_TYPE. ]*/
+                    /*Codes_SRS_COMMAND_DECODER_02_024: [ Otherwise, CommandDecoder_ExecuteMethod shall return what methodCallback returns. ]*/
+                    result = commandDecoderInstance->methodCallback(commandDecoderInstance->methodCallbackContext, relativeMethodPath, methodName, entry->argumentCount, (entry->argumentCount == 0) ? NULL : arguments);
+                }
 
-                    for (j = 0; j < i; j++)
+                for (i = 0; i < entry->argumentCount; i++)
+                {
+                    if (arguments[i].type != EDM_NO_TYPE)
                     {
-                        Destroy_AGENT_DATA_TYPE(&arguments[j]);
+                        Destroy_AGENT_DATA_TYPE(&arguments[i]);
                     }
+                }
 
+                if (arguments != stackArguments)
+                {
                     free(arguments);
                 }
-
             }
         }
-
     }
     return result;
 }
@@ -486,7 +800,7 @@ static EXECUTE_COMMAND_RESULT ScanActionPathAndExecuteAction(COMMAND_DECODER_HAN
     return result;
 }
 
-static METHODRETURN_HANDLE ScanMethodPathAndExecuteMethod(COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance, SCHEMA_HANDLE schemaHandle, const char* fullMethodName, MULTITREE_HANDLE methodTree)
+static METHODRETURN_HANDLE ScanMethodPathAndExecuteMethod(COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance, SCHEMA_HANDLE schemaHandle, const char* fullMethodName, const char* methodPayload)
 {
     METHODRETURN_HANDLE result;
     char* relativeMethodPath;
@@ -525,7 +839,7 @@ static METHODRETURN_HANDLE ScanMethodPathAndExecuteMethod(COMMAND_DECODER_HANDLE
                 relativeMethodPath[relativeMethodPathLength] = 0;
 
                 /* no slash found, this must be an method */
-                result = DecodeAndExecuteModelMethod(commandDecoderInstance, schemaHandle, modelHandle, relativeMethodPath, methodName, methodTree);
+                result = DecodeAndExecuteModelMethod(commandDecoderInstance, schemaHandle, modelHandle, relativeMethodPath, methodName, methodPayload);
 
                 free(relativeMethodPath);
                 methodName = NULL;
@@ -612,7 +926,7 @@ static EXECUTE_COMMAND_RESULT DecodeCommand(COMMAND_DECODER_HANDLE_DATA* command
     return result;
 }
 
-static METHODRETURN_HANDLE DecodeMethod(COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance, const char* fullMethodName, MULTITREE_HANDLE methodTree)
+static METHODRETURN_HANDLE DecodeMethod(COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance, const char* fullMethodName, const char* methodPayload)
 {
     METHODRETURN_HANDLE result;
     SCHEMA_HANDLE schemaHandle;
@@ -625,7 +939,7 @@ static METHODRETURN_HANDLE DecodeMethod(COMMAND_DECODER_HANDLE_DATA* commandDeco
     }
     else
     {
-        result = ScanMethodPathAndExecuteMethod(commandDecoderInstance, schemaHandle, fullMethodName, methodTree);
+        result = ScanMethodPathAndExecuteMethod(commandDecoderInstance, schemaHandle, fullMethodName, methodPayload);
 
     }
     return result;
@@ -714,36 +1028,8 @@ METHODRETURN_HANDLE CommandDecoder_ExecuteMethod(COMMAND_DECODER_HANDLE handle,
         }
         else
         {
-            /*Codes_SRS_COMMAND_DECODER_02_016: [ If methodPayload is not NULL then CommandDecoder_ExecuteMethod shall build a MULTITREE_HANDLE out of methodPayload. ]*/
-            if (methodPayload == NULL)
-            {
-                result = DecodeMethod(commandDecoderInstance, fullMethodName, NULL);
-            }
-            else
-            {
-                char* methodJSON;
-
-                if (mallocAndStrcpy_s(&methodJSON, methodPayload) != 0)
-                {
-                    LogError("Failed to allocate temporary storage for the method JSON");
-                    result = NULL;
-                }
-                else
-                {
-                    MULTITREE_HANDLE methodTree;
-                    if (JSONDecoder_JSON_To_MultiTree(methodJSON, &methodTree) != JSON_DECODER_OK)
-                    {
-                        LogError("Decoding JSON to a multi tree failed");
-                        result = NULL;
-                    }
-                    else
-                    {
-                        result = DecodeMethod(commandDecoderInstance, fullMethodName, methodTree);
-                        MultiTree_Destroy(methodTree);
-                    }
-                    free(methodJSON);
-                }
-            }
+            /*the payload is decoded once the method and the types of its arguments are known*/
+            result = DecodeMethod(commandDecoderInstance, fullMethodName, methodPayload);
         }
     }
     return result;
@@ -777,6 +1063,8 @@ COMMAND_DECODER_HANDLE CommandDecoder_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandl
             result->ActionCallbackContext = actionCallbackContext;
             result->methodCallback = methodCallback;
             result->methodCallbackContext = methodCallbackContext;
+            result->methodDispatch = NULL;
+            result->methodDispatchCount = 0;
         }
     }
 
@@ -791,194 +1079,1095 @@ void CommandDecoder_Destroy(COMMAND_DECODER_HANDLE commandDecoderHandle)
         COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)commandDecoderHandle;
 
         /* Codes_SRS_COMMAND_DECODER_01_005: [CommandDecoder_Destroy shall free all resources associated with the commandDecoderHandle instance.] */
+        DestroyMethodDispatch(commandDecoderInstance);
         free(commandDecoderInstance);
     }
 }
-
 MU_DEFINE_ENUM_STRINGS(AGENT_DATA_TYPE_TYPE, AGENT_DATA_TYPE_TYPE_VALUES);
 
-/*validates that the multitree (coming from a JSON) is actually a serialization of the model (complete or incomplete)*/
-/*if the serialization contains more than the model, then it fails.*/
-/*if the serialization does not contain mandatory items from the model, it fails*/
-static bool validateModel_vs_Multitree(void* startAddress, SCHEMA_MODEL_TYPE_HANDLE modelHandle, MULTITREE_HANDLE desiredPropertiesTree, size_t offset)
+/*values converted by CreateAgentDataType_From_String that are shorter than this are NUL terminated in a stack buffer*/
+#define DESIRED_PROPERTY_VALUE_STACK_SIZE 64
+/*model element names are C identifiers, a longer JSON name cannot match any of them*/
+#define DESIRED_PROPERTY_NAME_STACK_SIZE 128
+#define DESIRED_PROPERTIES_MAX_NESTING 16
+/*payloads that change up to this many desired properties stage them on the stack*/
+#define DESIRED_PROPERTY_CHANGES_STACK_COUNT 8
+
+/*the C types that are decoded straight from the payload, without going through an AGENT_DATA_TYPE*/
+typedef enum DESIRED_PROPERTY_SCALAR_TYPE_TAG
 {
+    DESIRED_PROPERTY_SCALAR_DOUBLE,
+    DESIRED_PROPERTY_SCALAR_FLOAT,
+    DESIRED_PROPERTY_SCALAR_INT,
+    DESIRED_PROPERTY_SCALAR_LONG,
+    DESIRED_PROPERTY_SCALAR_INT8,
+    DESIRED_PROPERTY_SCALAR_UINT8,
+    DESIRED_PROPERTY_SCALAR_INT16,
+    DESIRED_PROPERTY_SCALAR_INT32,
+    DESIRED_PROPERTY_SCALAR_INT64,
+    DESIRED_PROPERTY_SCALAR_BOOL,
+    DESIRED_PROPERTY_SCALAR_STRING,
+    DESIRED_PROPERTY_SCALAR_STRING_NO_QUOTES
+} DESIRED_PROPERTY_SCALAR_TYPE;
+
+typedef union DESIRED_PROPERTY_SCALAR_TAG
+{
+    double doubleValue;
+    float floatValue;
+    int intValue;
+    long longValue;
+    int8_t int8Value;
+    uint8_t uint8Value;
+    int16_t int16Value;
+    int32_t int32Value;
+    int64_t int64Value;
+    bool boolValue;
+    char* stringValue; /*owned until it is written to the device*/
+} DESIRED_PROPERTY_SCALAR;
+
+typedef struct DESIRED_PROPERTY_SCALAR_TYPE_NAME_TAG
+{
+    const char* typeName;
+    DESIRED_PROPERTY_SCALAR_TYPE scalarType;
+    size_t size;
+} DESIRED_PROPERTY_SCALAR_TYPE_NAME;
+
+/*the type names are the ones CodeFirst_GetPrimitiveType knows, EDM_DATE_TIME_OFFSET, EDM_GUID and EDM_BINARY still go through an AGENT_DATA_TYPE*/
+static const DESIRED_PROPERTY_SCALAR_TYPE_NAME desiredPropertyScalarTypes[] =
+{
+    { "double", DESIRED_PROPERTY_SCALAR_DOUBLE, sizeof(double) },
+    { "float", DESIRED_PROPERTY_SCALAR_FLOAT, sizeof(float) },
+    { "int", DESIRED_PROPERTY_SCALAR_INT, sizeof(int) },
+    { "long", DESIRED_PROPERTY_SCALAR_LONG, sizeof(long) },
+    { "int8_t", DESIRED_PROPERTY_SCALAR_INT8, sizeof(int8_t) },
+    { "uint8_t", DESIRED_PROPERTY_SCALAR_UINT8, sizeof(uint8_t) },
+    { "int16_t", DESIRED_PROPERTY_SCALAR_INT16, sizeof(int16_t) },
+    { "int32_t", DESIRED_PROPERTY_SCALAR_INT32, sizeof(int32_t) },
+    { "int64_t", DESIRED_PROPERTY_SCALAR_INT64, sizeof(int64_t) },
+    { "_Bool", DESIRED_PROPERTY_SCALAR_BOOL, sizeof(bool) },
+    { "bool", DESIRED_PROPERTY_SCALAR_BOOL, sizeof(bool) },
+    { "ascii_char_ptr", DESIRED_PROPERTY_SCALAR_STRING, sizeof(char*) },
+    { "ascii_char_ptr_no_quotes", DESIRED_PROPERTY_SCALAR_STRING_NO_QUOTES, sizeof(char*) }
+};
+
+typedef enum DESIRED_PROPERTY_CHANGE_TYPE_TAG
+{
+    DESIRED_PROPERTY_CHANGE_SCALAR,
+    DESIRED_PROPERTY_CHANGE_AGENT_DATA_TYPE,
+    DESIRED_PROPERTY_CHANGE_NOTIFICATION /*a model in model whose object has been applied, only calls onDesiredProperty*/
+} DESIRED_PROPERTY_CHANGE_TYPE;
+
+/*a decoded value, written to the device once the whole payload has been read*/
+typedef struct DESIRED_PROPERTY_CHANGE_TAG
+{
+    DESIRED_PROPERTY_CHANGE_TYPE type;
+    void* destination;
+    const DESIRED_PROPERTY_SCALAR_TYPE_NAME* scalarType; /*DESIRED_PROPERTY_CHANGE_SCALAR*/
+    DESIRED_PROPERTY_SCALAR scalar;
+    pfDesiredPropertyFromAGENT_DATA_TYPE fromAgentDataType; /*DESIRED_PROPERTY_CHANGE_AGENT_DATA_TYPE*/
+    AGENT_DATA_TYPE agentDataType;
+    pfOnDesiredProperty onDesiredProperty; /*called with modelAddress once the value has been written, can be NULL*/
+    void* modelAddress;
+} DESIRED_PROPERTY_CHANGE;
+
+typedef enum DESIRED_PROPERTIES_SCOPE_TYPE_TAG
+{
+    DESIRED_PROPERTIES_SCOPE_TWIN,
+    DESIRED_PROPERTIES_SCOPE_MODEL,
+    DESIRED_PROPERTIES_SCOPE_STRUCT
+} DESIRED_PROPERTIES_SCOPE_TYPE;
 
-    bool result;
-    size_t nChildren;
-    size_t nProcessedChildren = 0;
-    (void)MultiTree_GetChildCount(desiredPropertiesTree, &nChildren);
-    for (size_t i = 0;i < nChildren;i++)
+/*one scope per JSON object that is being applied*/
+typedef struct DESIRED_PROPERTIES_SCOPE_TAG
+{
+    DESIRED_PROPERTIES_SCOPE_TYPE type;
+    SCHEMA_MODEL_TYPE_HANDLE modelHandle; /*DESIRED_PROPERTIES_SCOPE_MODEL*/
+    size_t offset; /*offset of the model (for a struct: of the model that has the desired property)*/
+    bool isDesiredRoot; /*only the top of the desired properties carries $version*/
+    pfOnDesiredProperty onDesiredProperty; /*model in model: called with the parent model when the scope ends*/
+    size_t parentOffset;
+    const char* typeName; /*DESIRED_PROPERTIES_SCOPE_STRUCT*/
+    size_t memberCount;
+    const char** memberNames;
+    const char** memberTypes;
+    AGENT_DATA_TYPE* memberValues; /*EDM_NO_TYPE until the member has been seen*/
+    SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle; /*NULL when the struct is a member of the enclosing struct*/
+    size_t memberIndex;
+} DESIRED_PROPERTIES_SCOPE;
+
+typedef struct DESIRED_PROPERTIES_DECODER_TAG
+{
+    void* startAddress;
+    SCHEMA_HANDLE schemaHandle;
+    bool foundDesired;
+    size_t depth;
+    DESIRED_PROPERTIES_SCOPE scopes[DESIRED_PROPERTIES_MAX_NESTING];
+    DESIRED_PROPERTY_CHANGE* changes; /*stackChanges until there are more changes than it holds*/
+    size_t changeCount;
+    size_t changeCapacity;
+    DESIRED_PROPERTY_CHANGE stackChanges[DESIRED_PROPERTY_CHANGES_STACK_COUNT];
+} DESIRED_PROPERTIES_DECODER;
+
+static int DecodePrimitiveValue(const char* value, size_t valueLength, AGENT_DATA_TYPE_TYPE primitiveType, AGENT_DATA_TYPE* output)
+{
+    int result;
+    char stackCopy[DESIRED_PROPERTY_VALUE_STACK_SIZE];
+    char* source = (valueLength < sizeof(stackCopy)) ? stackCopy : (char*)malloc(valueLength + 1);
+
+    if (source == NULL)
     {
-        MULTITREE_HANDLE child;
-        if (MultiTree_GetChild(desiredPropertiesTree, i, &child) != MULTITREE_OK)
-        {
-            LogError("failure in MultiTree_GetChild");
-            i = nChildren;
-        }
-        else
+        LogError("failure allocating %lu bytes for a value", (unsigned long)(valueLength + 1));
+        result = MU_FAILURE;
+    }
+    else
+    {
+        (void)memcpy(source, value, valueLength);
+        source[valueLength] = '\0';
+
+        /*Codes_SRS_COMMAND_DECODER_02_007: [ If the desired property has any other primitive type then an AGENT_DATA_TYPE shall be constructed from the member value by CreateAgentDataType_From_String. ]*/
+        if (CreateAgentDataType_From_String(source, primitiveType, output) != AGENT_DATA_TYPES_OK)
+        {
+            LogError("failure parsing value %s", source);
+            result = MU_FAILURE;
+        }
+        else
+        {
+            result = 0;
+        }
+
+        if (source != stackCopy)
+        {
+            free(source);
+        }
+    }
+
+    return result;
+}
+
+static const DESIRED_PROPERTY_SCALAR_TYPE_NAME* GetDesiredPropertyScalarType(const char* typeName)
+{
+    const DESIRED_PROPERTY_SCALAR_TYPE_NAME* result = NULL;
+    size_t i;
+
+    for (i = 0; i < sizeof(desiredPropertyScalarTypes) / sizeof(desiredPropertyScalarTypes[0]); i++)
+    {
+        if (strcmp(desiredPropertyScalarTypes[i].typeName, typeName) == 0)
+        {
+            result = &desiredPropertyScalarTypes[i];
+            break;
+        }
+    }
+
+    return result;
+}
+
+static bool IsJSONToken(const char* value, size_t valueLength, const char* token)
+{
+    return (strlen(token) == valueLength) && (memcmp(value, token, valueLength) == 0);
+}
+
+static int DecodeFloatingPointSpecialValue(const char* value, size_t valueLength, double* output)
+{
+    int result;
+
+    if (IsJSONToken(value, valueLength, "\"NaN\""))
+    {
+        *output = NAN;
+        result = 0;
+    }
+    else if (IsJSONToken(value, valueLength, "\"INF\""))
+    {
+        *output = INFINITY;
+        result = 0;
+    }
+    else if (IsJSONToken(value, valueLength, "\"-INF\""))
+    {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4056) /* Known warning for INIFNITY */
+#endif
+        *output = -INFINITY;
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+        result = 0;
+    }
+    else
+    {
+        result = MU_FAILURE;
+    }
+
+    return result;
+}
+
+/*as CreateAgentDataType_From_String reads EDM_SBYTE, EDM_BYTE and EDM_INT16*/
+static int DecodeSmallInteger(const char* value, long minimum, long maximum, long* output)
+{
+    int result;
+    char* next;
+
+    errno = 0;
+    *output = strtol(value, &next, 10);
+    if ((next == value) || (errno != 0) || (*output < minimum) || (*output > maximum))
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+/*as CreateAgentDataType_From_String reads EDM_INT32 and EDM_INT64: an optional '-' and the magnitude, the whole value being at most maximumLength characters*/
+static int DecodeSignedMagnitude(const char* value, size_t valueLength, size_t maximumLength, unsigned long long maximumPositive, int64_t* output)
+{
+    int result;
+    bool isNegative = (value[0] == '-');
+    const char* digits = isNegative ? value + 1 : value;
+    char* next;
+    unsigned long long magnitude;
+
+    errno = 0;
+    magnitude = strtoull(digits, &next, 10);
+    if ((next == digits) ||
+        (errno != 0) ||
+        (valueLength > maximumLength) ||
+        (magnitude > (isNegative ? maximumPositive + 1 : maximumPositive)))
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (!isNegative)
+        {
+            *output = (int64_t)magnitude;
+        }
+        else if (magnitude == maximumPositive + 1)
+        {
+            *output = -(int64_t)maximumPositive - 1;
+        }
+        else
+        {
+            *output = -(int64_t)magnitude;
+        }
+        result = 0;
+    }
+
+    return result;
+}
+
+/*decodes a value in place, with the rules of CreateAgentDataType_From_String. The JSON decoder hands out scalars that are followed by a delimiter, so the number parsers stop at the end of the value*/
+static int DecodeDesiredPropertyScalar(const char* value, size_t valueLength, DESIRED_PROPERTY_SCALAR_TYPE scalarType, DESIRED_PROPERTY_SCALAR* output)
+{
+    int result;
+    char* next;
+    long smallInteger;
+    int64_t integer;
+
+    switch (scalarType)
+    {
+        default:
+        {
+            result = MU_FAILURE;
+            break;
+        }
+        case DESIRED_PROPERTY_SCALAR_DOUBLE:
+        {
+            if (DecodeFloatingPointSpecialValue(value, valueLength, &output->doubleValue) == 0)
+            {
+                result = 0;
+            }
+            else
+            {
+                errno = 0;
+                output->doubleValue = strtod(value, &next);
+                result = ((next == value) || ((errno != 0) && ((output->doubleValue == HUGE_VAL) || (output->doubleValue == -HUGE_VAL)))) ? MU_FAILURE : 0;
+            }
+            break;
+        }
+        case DESIRED_PROPERTY_SCALAR_FLOAT:
+        {
+            double specialValue;
+            if (DecodeFloatingPointSpecialValue(value, valueLength, &specialValue) == 0)
+            {
+                output->floatValue = (float)specialValue;
+                result = 0;
+            }
+            else
+            {
+                errno = 0;
+                output->floatValue = strtof(value, &next);
+                result = ((next == value) || ((errno != 0) && ((output->floatValue == HUGE_VALF) || (output->floatValue == -HUGE_VALF)))) ? MU_FAILURE : 0;
+            }
+            break;
+        }
+        case DESIRED_PROPERTY_SCALAR_INT8:
+        {
+            result = DecodeSmallInteger(value, -128, 127, &smallInteger);
+            output->int8Value = (int8_t)smallInteger;
+            break;
+        }
+        case DESIRED_PROPERTY_SCALAR_UINT8:
+        {
+            result = DecodeSmallInteger(value, 0, 255, &smallInteger);
+            output->uint8Value = (uint8_t)smallInteger;
+            break;
+        }
+        case DESIRED_PROPERTY_SCALAR_INT16:
+        {
+            result = DecodeSmallInteger(value, -32768, 32767, &smallInteger);
+            output->int16Value = (int16_t)smallInteger;
+            break;
+        }
+        case DESIRED_PROPERTY_SCALAR_INT:
+        case DESIRED_PROPERTY_SCALAR_INT32:
+        {
+            result = DecodeSignedMagnitude(value, valueLength, 11, 2147483647ULL, &integer);
+            if (scalarType == DESIRED_PROPERTY_SCALAR_INT)
+            {
+                output->intValue = (int)integer;
+            }
+            else
+            {
+                output->int32Value = (int32_t)integer;
+            }
+            break;
+        }
+        case DESIRED_PROPERTY_SCALAR_LONG:
+        case DESIRED_PROPERTY_SCALAR_INT64:
+        {
+            result = DecodeSignedMagnitude(value, valueLength, 20, 9223372036854775807ULL, &integer);
+            if (scalarType == DESIRED_PROPERTY_SCALAR_LONG)
+            {
+                output->longValue = (long)integer;
+            }
+            else
+            {
+                output->int64Value = integer;
+            }
+            break;
+        }
+        case DESIRED_PROPERTY_SCALAR_BOOL:
         {
-            STRING_HANDLE childName = STRING_new();
-            if (childName == NULL)
+            if (IsJSONToken(value, valueLength, "true"))
             {
-                LogError("failure to STRING_new");
-                i = nChildren;
+                output->boolValue = true;
+                result = 0;
+            }
+            else if (IsJSONToken(value, valueLength, "false"))
+            {
+                output->boolValue = false;
+                result = 0;
+            }
+            else
+            {
+                result = MU_FAILURE;
+            }
+            break;
+        }
+        case DESIRED_PROPERTY_SCALAR_STRING:
+        {
+            /*the quotes are dropped, escape sequences are kept as they are*/
+            if ((valueLength < 2) ||
+                (value[0] != '"') ||
+                (value[valueLength - 1] != '"'))
+            {
+                result = MU_FAILURE;
+            }
+            else if ((output->stringValue = (char*)malloc(valueLength - 1)) == NULL)
+            {
+                LogError("failure allocating %lu bytes for a string", (unsigned long)(valueLength - 1));
+                result = MU_FAILURE;
+            }
+            else
+            {
+                (void)memcpy(output->stringValue, value + 1, valueLength - 2);
+                output->stringValue[valueLength - 2] = '\0';
+                result = 0;
+            }
+            break;
+        }
+        case DESIRED_PROPERTY_SCALAR_STRING_NO_QUOTES:
+        {
+            if ((output->stringValue = (char*)malloc(valueLength + 1)) == NULL)
+            {
+                LogError("failure allocating %lu bytes for a string", (unsigned long)(valueLength + 1));
+                result = MU_FAILURE;
             }
             else
             {
-                if (MultiTree_GetName(child, childName) != MULTITREE_OK)
+                (void)memcpy(output->stringValue, value, valueLength);
+                output->stringValue[valueLength] = '\0';
+                result = 0;
+            }
+            break;
+        }
+    }
+
+    return result;
+}
+
+/*the member of a struct is handed to Create_AGENT_DATA_TYPE_from_Members, the AGENT_DATA_TYPE takes ownership of a string*/
+static void DesiredPropertyScalarToAgentDataType(DESIRED_PROPERTY_SCALAR_TYPE scalarType, const DESIRED_PROPERTY_SCALAR* scalar, AGENT_DATA_TYPE* output)
+{
+    switch (scalarType)
+    {
+        default:
+        case DESIRED_PROPERTY_SCALAR_DOUBLE:
+            output->type = EDM_DOUBLE_TYPE;
+            output->value.edmDouble.value = scalar->doubleValue;
+            break;
+        case DESIRED_PROPERTY_SCALAR_FLOAT:
+            output->type = EDM_SINGLE_TYPE;
+            output->value.edmSingle.value = scalar->floatValue;
+            break;
+        case DESIRED_PROPERTY_SCALAR_INT:
+            output->type = EDM_INT32_TYPE;
+            output->value.edmInt32.value = (int32_t)scalar->intValue;
+            break;
+        case DESIRED_PROPERTY_SCALAR_INT32:
+            output->type = EDM_INT32_TYPE;
+            output->value.edmInt32.value = scalar->int32Value;
+            break;
+        case DESIRED_PROPERTY_SCALAR_LONG:
+            output->type = EDM_INT64_TYPE;
+            output->value.edmInt64.value = (int64_t)scalar->longValue;
+            break;
+        case DESIRED_PROPERTY_SCALAR_INT64:
+            output->type = EDM_INT64_TYPE;
+            output->value.edmInt64.value = scalar->int64Value;
+            break;
+        case DESIRED_PROPERTY_SCALAR_INT8:
+            output->type = EDM_SBYTE_TYPE;
+            output->value.edmSbyte.value = scalar->int8Value;
+            break;
+        case DESIRED_PROPERTY_SCALAR_UINT8:
+            output->type = EDM_BYTE_TYPE;
+            output->value.edmByte.value = scalar->uint8Value;
+            break;
+        case DESIRED_PROPERTY_SCALAR_INT16:
+            output->type = EDM_INT16_TYPE;
+            output->value.edmInt16.value = scalar->int16Value;
+            break;
+        case DESIRED_PROPERTY_SCALAR_BOOL:
+            output->type = EDM_BOOLEAN_TYPE;
+            output->value.edmBoolean.value = scalar->boolValue ? EDM_TRUE : EDM_FALSE;
+            break;
+        case DESIRED_PROPERTY_SCALAR_STRING:
+            output->type = EDM_STRING_TYPE;
+            output->value.edmString.chars = scalar->stringValue;
+            output->value.edmString.length = strlen(scalar->stringValue);
+            break;
+        case DESIRED_PROPERTY_SCALAR_STRING_NO_QUOTES:
+            output->type = EDM_STRING_NO_QUOTES_TYPE;
+            output->value.edmStringNoQuotes.chars = scalar->stringValue;
+            output->value.edmStringNoQuotes.length = strlen(scalar->stringValue);
+            break;
+    }
+}
+
+static void ReleaseDesiredPropertyChange(DESIRED_PROPERTY_CHANGE* change)
+{
+    if (change->type == DESIRED_PROPERTY_CHANGE_SCALAR)
+    {
+        if ((change->scalarType->scalarType == DESIRED_PROPERTY_SCALAR_STRING) ||
+            (change->scalarType->scalarType == DESIRED_PROPERTY_SCALAR_STRING_NO_QUOTES))
+        {
+            free(change->scalar.stringValue);
+        }
+    }
+    else if (change->type == DESIRED_PROPERTY_CHANGE_AGENT_DATA_TYPE)
+    {
+        Destroy_AGENT_DATA_TYPE(&change->agentDataType);
+    }
+}
+
+static void ReleaseDesiredPropertyChanges(DESIRED_PROPERTIES_DECODER* decoder)
+{
+    size_t i;
+    for (i = 0; i < decoder->changeCount; i++)
+    {
+        ReleaseDesiredPropertyChange(&decoder->changes[i]);
+    }
+    decoder->changeCount = 0;
+}
+
+/*appends a copy of change to the changes of the decoder, which then own its value. On failure the value is released*/
+static int StageDesiredPropertyChange(DESIRED_PROPERTIES_DECODER* decoder, DESIRED_PROPERTY_CHANGE* change)
+{
+    int result;
+
+    if (decoder->changeCount == decoder->changeCapacity)
+    {
+        size_t newCapacity = decoder->changeCapacity * 2;
+        DESIRED_PROPERTY_CHANGE* newChanges = (decoder->changes == decoder->stackChanges) ?
+            (DESIRED_PROPERTY_CHANGE*)malloc(sizeof(DESIRED_PROPERTY_CHANGE) * newCapacity) :
+            (DESIRED_PROPERTY_CHANGE*)realloc(decoder->changes, sizeof(DESIRED_PROPERTY_CHANGE) * newCapacity);
+
+        if (newChanges == NULL)
+        {
+            LogError("Failed growing the staged desired properties to %lu", (unsigned long)newCapacity);
+        }
+        else
+        {
+            if (decoder->changes == decoder->stackChanges)
+            {
+                (void)memcpy(newChanges, decoder->stackChanges, sizeof(DESIRED_PROPERTY_CHANGE) * decoder->changeCount);
+            }
+            decoder->changes = newChanges;
+            decoder->changeCapacity = newCapacity;
+        }
+    }
+
+    if (decoder->changeCount == decoder->changeCapacity)
+    {
+        ReleaseDesiredPropertyChange(change);
+        result = MU_FAILURE;
+    }
+    else
+    {
+        decoder->changes[decoder->changeCount] = *change;
+        decoder->changeCount++;
+        result = 0;
+    }
+
+    return result;
+}
+
+/*stages the value decoded in change for the desired property of the model at modelOffset*/
+static JSON_DECODER_ACTION StageDesiredProperty(DESIRED_PROPERTIES_DECODER* decoder, size_t modelOffset, SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle, DESIRED_PROPERTY_CHANGE* change)
+{
+    change->modelAddress = (char*)decoder->startAddress + modelOffset;
+    change->destination = (char*)change->modelAddress + Schema_GetModelDesiredProperty_offset(desiredPropertyHandle);
+    change->onDesiredProperty = Schema_GetModelDesiredProperty_pfOnDesiredProperty(desiredPropertyHandle);
+    if (change->type == DESIRED_PROPERTY_CHANGE_AGENT_DATA_TYPE)
+    {
+        change->fromAgentDataType = Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(desiredPropertyHandle);
+    }
+
+    return (StageDesiredPropertyChange(decoder, change) == 0) ? JSON_DECODER_ACTION_CONTINUE : JSON_DECODER_ACTION_ABORT;
+}
+
+static void WriteDesiredPropertyScalar(DESIRED_PROPERTY_CHANGE* change)
+{
+    if ((change->scalarType->scalarType == DESIRED_PROPERTY_SCALAR_STRING) ||
+        (change->scalarType->scalarType == DESIRED_PROPERTY_SCALAR_STRING_NO_QUOTES))
+    {
+        char* previousValue;
+        (void)memcpy(&previousValue, change->destination, sizeof(previousValue));
+        free(previousValue);
+    }
+
+    /*every member of the union starts at its address, so one copy of the size of the C type writes any of them*/
+    (void)memcpy(change->destination, &change->scalar, change->scalarType->size);
+}
+
+/*writes the staged values in the order of the payload. If one cannot be converted, the values after it are released without being written*/
+static int CommitDesiredPropertyChanges(DESIRED_PROPERTIES_DECODER* decoder)
+{
+    int result = 0;
+    size_t i;
+
+    for (i = 0; i < decoder->changeCount; i++)
+    {
+        DESIRED_PROPERTY_CHANGE* change = &decoder->changes[i];
+
+        if (result != 0)
+        {
+            ReleaseDesiredPropertyChange(change);
+        }
+        else
+        {
+            if (change->type == DESIRED_PROPERTY_CHANGE_SCALAR)
+            {
+                WriteDesiredPropertyScalar(change);
+            }
+            else if (change->type == DESIRED_PROPERTY_CHANGE_AGENT_DATA_TYPE)
+            {
+                /*Codes_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
+                if (change->fromAgentDataType(&change->agentDataType, change->destination) != 0)
                 {
-                    LogError("failure to MultiTree_GetName");
-                    i = nChildren;
+                    /*Codes_SRS_COMMAND_DECODER_09_016: [ If pfDesiredPropertyFromAGENT_DATA_TYPE fails then the values staged after it shall be released without being written and CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+                    LogError("failure in a function that converts from AGENT_DATA_TYPE to C data");
+                    result = MU_FAILURE;
                 }
-                else
-                {
-                    const char *childName_str = STRING_c_str(childName);
-                    SCHEMA_MODEL_ELEMENT elementType = Schema_GetModelElementByName(modelHandle, childName_str);
-                    switch (elementType.elementType)
-                    {
-                        default:
-                        {
-                            LogError("INTERNAL ERROR: unexpected function return");
-                            i = nChildren;
-                            break;
-                        }
-                        case (SCHEMA_PROPERTY):
-                        {
-                            LogError("cannot ingest name (WITH_DATA instead of WITH_DESIRED_PROPERTY): %s", childName_str);
-                            i = nChildren;
-                            break;
-                        }
-                        case (SCHEMA_REPORTED_PROPERTY):
-                        {
-                            LogError("cannot ingest name (WITH_REPORTED_PROPERTY instead of WITH_DESIRED_PROPERTY): %s", childName_str);
-                            i = nChildren;
-                            break;
-                        }
-                        case (SCHEMA_DESIRED_PROPERTY):
-                        {
-                            /*Codes_SRS_COMMAND_DECODER_02_007: [ If the child name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the MULTITREE node. ]*/
-                            SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle = elementType.elementHandle.desiredPropertyHandle;
+                Destroy_AGENT_DATA_TYPE(&change->agentDataType);
+            }
 
-                            const char* desiredPropertyType = Schema_GetModelDesiredPropertyType(desiredPropertyHandle);
-                            AGENT_DATA_TYPE output;
-                            if (DecodeValueFromNode(Schema_GetSchemaForModelType(modelHandle), &output, child, desiredPropertyType) != 0)
-                            {
-                                LogError("failure in DecodeValueFromNode");
-                                i = nChildren;
-                            }
-                            else
-                            {
-                                /*Codes_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
-                                pfDesiredPropertyFromAGENT_DATA_TYPE leFunction = Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(desiredPropertyHandle);
-                                if (leFunction(&output, (char*)startAddress + offset + Schema_GetModelDesiredProperty_offset(desiredPropertyHandle)) != 0)
-                                {
-                                    LogError("failure in a function that converts from AGENT_DATA_TYPE to C data");
-                                }
-                                else
-                                {
-                                    /*Codes_SRS_COMMAND_DECODER_02_013: [ If the desired property has a non-NULL pfOnDesiredProperty then it shall be called. ]*/
-                                    pfOnDesiredProperty onDesiredProperty = Schema_GetModelDesiredProperty_pfOnDesiredProperty(desiredPropertyHandle);
-                                    if (onDesiredProperty != NULL)
-                                    {
-                                        onDesiredProperty((char*)startAddress + offset);
-                                    }
-                                    nProcessedChildren++;
-                                }
-                                Destroy_AGENT_DATA_TYPE(&output);
-                            }
+            /*Codes_SRS_COMMAND_DECODER_02_013: [ If the desired property has a non-NULL pfOnDesiredProperty then it shall be called. ]*/
+            /*Codes_SRS_COMMAND_DECODER_02_012: [ If the child model in model has a non-NULL pfOnDesiredProperty then pfOnDesiredProperty shall be called after its object has been applied. ]*/
+            if ((result == 0) && (change->onDesiredProperty != NULL))
+            {
+                change->onDesiredProperty(change->modelAddress);
+            }
+        }
+    }
 
-                            break;
-                        }
-                        case(SCHEMA_MODEL_IN_MODEL):
-                        {
-                            SCHEMA_MODEL_TYPE_HANDLE modelModel = elementType.elementHandle.modelHandle;
+    decoder->changeCount = 0;
+    return result;
+}
 
-                            /*Codes_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the function shall call itself recursively. ]*/
-                            if (!validateModel_vs_Multitree(startAddress, modelModel, child, offset + Schema_GetModelModelByName_Offset(modelHandle, childName_str)))
-                            {
-                                LogError("failure in validateModel_vs_Multitree");
-                                i = nChildren;
-                            }
-                            else
-                            {
-                                /*if the model in model so happened to be a WITH_DESIRED_PROPERTY... (only those has non_NULL pfOnDesiredProperty) */
-                                /*Codes_SRS_COMMAND_DECODER_02_012: [ If the child model in model has a non-NULL pfOnDesiredProperty then pfOnDesiredProperty shall be called. ]*/
-                                pfOnDesiredProperty onDesiredProperty = Schema_GetModelModelByName_OnDesiredProperty(modelHandle, childName_str);
-                                if (onDesiredProperty != NULL)
-                                {
-                                    onDesiredProperty((char*)startAddress + offset);
-                                }
+static void ReleaseStructScope(DESIRED_PROPERTIES_SCOPE* scope)
+{
+    size_t i;
+    for (i = 0; i < scope->memberCount; i++)
+    {
+        if (scope->memberValues[i].type != EDM_NO_TYPE)
+        {
+            Destroy_AGENT_DATA_TYPE(&scope->memberValues[i]);
+        }
+    }
+    /*memberNames and memberTypes live in the same allocation*/
+    free(scope->memberValues);
+}
 
-                                nProcessedChildren++;
-                            }
+static DESIRED_PROPERTIES_SCOPE* PushScope(DESIRED_PROPERTIES_DECODER* decoder, DESIRED_PROPERTIES_SCOPE_TYPE type)
+{
+    DESIRED_PROPERTIES_SCOPE* result;
+    if (decoder->depth + 1 >= DESIRED_PROPERTIES_MAX_NESTING)
+    {
+        LogError("desired properties are nested deeper than %d levels", DESIRED_PROPERTIES_MAX_NESTING);
+        result = NULL;
+    }
+    else
+    {
+        decoder->depth++;
+        result = &decoder->scopes[decoder->depth];
+        (void)memset(result, 0, sizeof(DESIRED_PROPERTIES_SCOPE));
+        result->type = type;
+    }
+    return result;
+}
 
-                            break;
-                        }
+static JSON_DECODER_ACTION PushStructScope(DESIRED_PROPERTIES_DECODER* decoder, const char* typeName, size_t modelOffset, SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle, size_t memberIndex)
+{
+    JSON_DECODER_ACTION result;
+    SCHEMA_STRUCT_TYPE_HANDLE structTypeHandle;
+    size_t propertyCount;
+
+    /*Codes_SRS_COMMAND_DECODER_09_004: [ If the desired property has a struct type then the members of its object shall be collected by name, as described by the Schema APIs for structure types, and combined with Create_AGENT_DATA_TYPE_from_Members when the object ends. ]*/
+    if (((structTypeHandle = Schema_GetStructTypeByName(decoder->schemaHandle, typeName)) == NULL) ||
+        (Schema_GetStructTypePropertyCount(structTypeHandle, &propertyCount) != SCHEMA_OK))
+    {
+        LogError("Getting Struct information failed.");
+        result = JSON_DECODER_ACTION_ABORT;
+    }
+    else if (propertyCount == 0)
+    {
+        LogError("Struct type with 0 members is not allowed");
+        result = JSON_DECODER_ACTION_ABORT;
+    }
+    else
+    {
+        AGENT_DATA_TYPE* memberValues = (AGENT_DATA_TYPE*)malloc(propertyCount * (sizeof(AGENT_DATA_TYPE) + 2 * sizeof(const char*)));
+        if (memberValues == NULL)
+        {
+            LogError("Failed allocating member values for struct %s", typeName);
+            result = JSON_DECODER_ACTION_ABORT;
+        }
+        else
+        {
+            const char** memberNames = (const char**)(memberValues + propertyCount);
+            const char** memberTypes = memberNames + propertyCount;
+            size_t i;
+
+            for (i = 0; i < propertyCount; i++)
+            {
+                SCHEMA_PROPERTY_HANDLE propertyHandle;
 
-                    } /*switch*/
+                memberValues[i].type = EDM_NO_TYPE;
+                if (((propertyHandle = Schema_GetStructTypePropertyByIndex(structTypeHandle, i)) == NULL) ||
+                    ((memberNames[i] = Schema_GetPropertyName(propertyHandle)) == NULL) ||
+                    ((memberTypes[i] = Schema_GetPropertyType(propertyHandle)) == NULL))
+                {
+                    LogError("Getting the struct member information failed.");
+                    break;
                 }
-                STRING_delete(childName);
             }
+
+            if (i < propertyCount)
+            {
+                free(memberValues);
+                result = JSON_DECODER_ACTION_ABORT;
+            }
+            else
+            {
+                DESIRED_PROPERTIES_SCOPE* scope = PushScope(decoder, DESIRED_PROPERTIES_SCOPE_STRUCT);
+                if (scope == NULL)
+                {
+                    free(memberValues);
+                    result = JSON_DECODER_ACTION_ABORT;
+                }
+                else
+                {
+                    scope->typeName = typeName;
+                    scope->offset = modelOffset;
+                    scope->memberCount = propertyCount;
+                    scope->memberNames = memberNames;
+                    scope->memberTypes = memberTypes;
+                    scope->memberValues = memberValues;
+                    scope->desiredPropertyHandle = desiredPropertyHandle;
+                    scope->memberIndex = memberIndex;
+                    result = JSON_DECODER_ACTION_CONTINUE;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+static JSON_DECODER_ACTION OnStructMember(DESIRED_PROPERTIES_DECODER* decoder, DESIRED_PROPERTIES_SCOPE* scope, const char* name, size_t nameLength, JSON_DECODER_VALUE_TYPE valueType, const char* value, size_t valueLength)
+{
+    JSON_DECODER_ACTION result;
+    size_t i;
+
+    for (i = 0; i < scope->memberCount; i++)
+    {
+        if ((name != NULL) &&
+            (strncmp(scope->memberNames[i], name, nameLength) == 0) &&
+            (scope->memberNames[i][nameLength] == '\0'))
+        {
+            break;
         }
     }
 
-    if(nProcessedChildren == nChildren)
+    if (i == scope->memberCount)
+    {
+        /*Codes_SRS_COMMAND_DECODER_09_005: [ Members that are not part of the struct shall be skipped. ]*/
+        result = JSON_DECODER_ACTION_SKIP;
+    }
+    else if (scope->memberValues[i].type != EDM_NO_TYPE)
     {
-        /*Codes_SRS_COMMAND_DECODER_02_010: [ If the complete MULTITREE has been parsed then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
-        result = true;
+        /*Codes_SRS_COMMAND_DECODER_09_006: [ If a member of the struct is repeated or missing then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+        LogError("struct member %s appears more than once", scope->memberNames[i]);
+        result = JSON_DECODER_ACTION_ABORT;
     }
     else
     {
-        /*Codes_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
-        LogError("not all constituents of the JSON have been ingested");
-        result = false;
+        const DESIRED_PROPERTY_SCALAR_TYPE_NAME* scalarType = GetDesiredPropertyScalarType(scope->memberTypes[i]);
+        AGENT_DATA_TYPE_TYPE primitiveType = (scalarType != NULL) ? EDM_NO_TYPE : CodeFirst_GetPrimitiveType(scope->memberTypes[i]);
+
+        if ((scalarType == NULL) && (primitiveType == EDM_NO_TYPE))
+        {
+            if (valueType != JSON_DECODER_VALUE_OBJECT)
+            {
+                LogError("struct member %s is not an object", scope->memberNames[i]);
+                result = JSON_DECODER_ACTION_ABORT;
+            }
+            else
+            {
+                result = PushStructScope(decoder, scope->memberTypes[i], scope->offset, NULL, i);
+            }
+        }
+        else if ((valueType == JSON_DECODER_VALUE_OBJECT) || (valueType == JSON_DECODER_VALUE_ARRAY))
+        {
+            LogError("struct member %s is not a primitive value", scope->memberNames[i]);
+            result = JSON_DECODER_ACTION_ABORT;
+        }
+        else if (scalarType != NULL)
+        {
+            DESIRED_PROPERTY_SCALAR scalar;
+
+            /*Codes_SRS_COMMAND_DECODER_09_013: [ If the desired property, or the member of a struct, has one of the types double, float, int, long, int8_t, uint8_t, int16_t, int32_t, int64_t, bool, ascii_char_ptr and ascii_char_ptr_no_quotes then its value shall be decoded in place from jsonPayload into that C type, with the rules of CreateAgentDataType_From_String. ]*/
+            if (DecodeDesiredPropertyScalar(value, valueLength, scalarType->scalarType, &scalar) != 0)
+            {
+                LogError("failure decoding struct member %s", scope->memberNames[i]);
+                result = JSON_DECODER_ACTION_ABORT;
+            }
+            else
+            {
+                DesiredPropertyScalarToAgentDataType(scalarType->scalarType, &scalar, &scope->memberValues[i]);
+                result = JSON_DECODER_ACTION_CONTINUE;
+            }
+        }
+        else if (DecodePrimitiveValue(value, valueLength, primitiveType, &scope->memberValues[i]) != 0)
+        {
+            scope->memberValues[i].type = EDM_NO_TYPE;
+            result = JSON_DECODER_ACTION_ABORT;
+        }
+        else
+        {
+            result = JSON_DECODER_ACTION_CONTINUE;
+        }
     }
+
     return result;
 }
 
-static EXECUTE_COMMAND_RESULT DecodeDesiredProperties(void* startAddress, COMMAND_DECODER_HANDLE_DATA* handle, MULTITREE_HANDLE desiredPropertiesTree)
+static JSON_DECODER_ACTION OnDesiredPropertyMember(DESIRED_PROPERTIES_DECODER* decoder, DESIRED_PROPERTIES_SCOPE* scope, const char* memberName, SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle, JSON_DECODER_VALUE_TYPE valueType, const char* value, size_t valueLength)
 {
-    /*Codes_SRS_COMMAND_DECODER_02_006: [ CommandDecoder_IngestDesiredProperties shall parse the MULTITREEE recursively. ]*/
-    return validateModel_vs_Multitree(startAddress, handle->ModelHandle, desiredPropertiesTree, 0 )?EXECUTE_COMMAND_SUCCESS:EXECUTE_COMMAND_FAILED;
+    JSON_DECODER_ACTION result;
+    const char* desiredPropertyType = Schema_GetModelDesiredPropertyType(desiredPropertyHandle);
+    const DESIRED_PROPERTY_SCALAR_TYPE_NAME* scalarType = GetDesiredPropertyScalarType(desiredPropertyType);
+    AGENT_DATA_TYPE_TYPE primitiveType = (scalarType != NULL) ? EDM_NO_TYPE : CodeFirst_GetPrimitiveType(desiredPropertyType);
+
+    if ((scalarType == NULL) && (primitiveType == EDM_NO_TYPE))
+    {
+        if (valueType != JSON_DECODER_VALUE_OBJECT)
+        {
+            LogError("desired property %s of type %s is not an object", memberName, desiredPropertyType);
+            result = JSON_DECODER_ACTION_ABORT;
+        }
+        else
+        {
+            result = PushStructScope(decoder, desiredPropertyType, scope->offset, desiredPropertyHandle, 0);
+        }
+    }
+    else if ((valueType == JSON_DECODER_VALUE_OBJECT) || (valueType == JSON_DECODER_VALUE_ARRAY))
+    {
+        LogError("desired property %s is not a primitive value", memberName);
+        result = JSON_DECODER_ACTION_ABORT;
+    }
+    else
+    {
+        DESIRED_PROPERTY_CHANGE change;
+        int decodeResult;
+
+        if (scalarType != NULL)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_013: [ If the desired property, or the member of a struct, has one of the types double, float, int, long, int8_t, uint8_t, int16_t, int32_t, int64_t, bool, ascii_char_ptr and ascii_char_ptr_no_quotes then its value shall be decoded in place from jsonPayload into that C type, with the rules of CreateAgentDataType_From_String. ]*/
+            change.type = DESIRED_PROPERTY_CHANGE_SCALAR;
+            change.scalarType = scalarType;
+            decodeResult = DecodeDesiredPropertyScalar(value, valueLength, scalarType->scalarType, &change.scalar);
+        }
+        else
+        {
+            change.type = DESIRED_PROPERTY_CHANGE_AGENT_DATA_TYPE;
+            decodeResult = DecodePrimitiveValue(value, valueLength, primitiveType, &change.agentDataType);
+        }
+
+        if (decodeResult != 0)
+        {
+            LogError("failure decoding desired property %s", memberName);
+            result = JSON_DECODER_ACTION_ABORT;
+        }
+        else
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_014: [ The decoded values shall be staged, and only written to the device once the whole jsonPayload has been walked. ]*/
+            result = StageDesiredProperty(decoder, scope->offset, desiredPropertyHandle, &change);
+        }
+    }
+
+    return result;
 }
 
-/* Raw JSON has properties we don't need; potentially nodes other than "desired" for full TWIN as well as a $version we don't pass to callees */
-static bool RemoveUnneededTwinProperties(MULTITREE_HANDLE initialParsedTree, bool parseDesiredNode, MULTITREE_HANDLE *desiredPropertiesTree)
+static JSON_DECODER_ACTION OnModelMember(DESIRED_PROPERTIES_DECODER* decoder, DESIRED_PROPERTIES_SCOPE* scope, const char* name, size_t nameLength, JSON_DECODER_VALUE_TYPE valueType, const char* value, size_t valueLength)
 {
-    MULTITREE_HANDLE updateTree;
-    bool result;
+    JSON_DECODER_ACTION result;
+    char memberName[DESIRED_PROPERTY_NAME_STACK_SIZE];
 
-    if (parseDesiredNode)
+    if ((name == NULL) || (nameLength >= sizeof(memberName)))
     {
-        /*Codes_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, parse only the `desired` part of JSON tree ]*/
-        if (MultiTree_GetChildByName(initialParsedTree, "desired", &updateTree) != MULTITREE_OK)
+        LogError("cannot ingest a desired property without a model element name");
+        result = JSON_DECODER_ACTION_ABORT;
+    }
+    else
+    {
+        (void)memcpy(memberName, name, nameLength);
+        memberName[nameLength] = '\0';
+
+        if (scope->isDesiredRoot && (strcmp(memberName, "$version") == 0))
         {
-            LogError("Unable to find 'desired' in tree");
-            return false;
+            /*Codes_SRS_COMMAND_DECODER_02_015: [ `$version` at the top of the desired properties shall be skipped. It not being present is not an error. ]*/
+            result = JSON_DECODER_ACTION_SKIP;
+        }
+        else
+        {
+            SCHEMA_MODEL_ELEMENT elementType = Schema_GetModelElementByName(scope->modelHandle, memberName);
+            switch (elementType.elementType)
+            {
+                default:
+                {
+                    /*Codes_SRS_COMMAND_DECODER_09_007: [ If a member is not a desired property or a model in model of the model, or its value does not match the kind of the element, then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+                    LogError("cannot ingest name: %s", memberName);
+                    result = JSON_DECODER_ACTION_ABORT;
+                    break;
+                }
+                case (SCHEMA_PROPERTY):
+                {
+                    LogError("cannot ingest name (WITH_DATA instead of WITH_DESIRED_PROPERTY): %s", memberName);
+                    result = JSON_DECODER_ACTION_ABORT;
+                    break;
+                }
+                case (SCHEMA_REPORTED_PROPERTY):
+                {
+                    LogError("cannot ingest name (WITH_REPORTED_PROPERTY instead of WITH_DESIRED_PROPERTY): %s", memberName);
+                    result = JSON_DECODER_ACTION_ABORT;
+                    break;
+                }
+                case (SCHEMA_DESIRED_PROPERTY):
+                {
+                    result = OnDesiredPropertyMember(decoder, scope, memberName, elementType.elementHandle.desiredPropertyHandle, valueType, value, valueLength);
+                    break;
+                }
+                case (SCHEMA_MODEL_IN_MODEL):
+                {
+                    if (valueType != JSON_DECODER_VALUE_OBJECT)
+                    {
+                        LogError("model in model %s is not an object", memberName);
+                        result = JSON_DECODER_ACTION_ABORT;
+                    }
+                    else
+                    {
+                        /*Codes_SRS_COMMAND_DECODER_02_009: [ If the member name corresponds to a model in model then its object shall be applied to the child model at the child model offset. ]*/
+                        SCHEMA_MODEL_TYPE_HANDLE parentModel = scope->modelHandle;
+                        size_t parentOffset = scope->offset;
+                        DESIRED_PROPERTIES_SCOPE* childScope = PushScope(decoder, DESIRED_PROPERTIES_SCOPE_MODEL);
+                        if (childScope == NULL)
+                        {
+                            result = JSON_DECODER_ACTION_ABORT;
+                        }
+                        else
+                        {
+                            childScope->modelHandle = elementType.elementHandle.modelHandle;
+                            childScope->offset = parentOffset + Schema_GetModelModelByName_Offset(parentModel, memberName);
+                            /*if the model in model so happened to be a WITH_DESIRED_PROPERTY... (only those has non_NULL pfOnDesiredProperty) */
+                            childScope->onDesiredProperty = Schema_GetModelModelByName_OnDesiredProperty(parentModel, memberName);
+                            childScope->parentOffset = parentOffset;
+                            result = JSON_DECODER_ACTION_CONTINUE;
+                        }
+                    }
+                    break;
+                }
+            }
         }
     }
-    else
+
+    return result;
+}
+
+static JSON_DECODER_ACTION OnDesiredPropertiesValue(void* context, const char* name, size_t nameLength, JSON_DECODER_VALUE_TYPE valueType, const char* value, size_t valueLength)
+{
+    JSON_DECODER_ACTION result;
+    DESIRED_PROPERTIES_DECODER* decoder = (DESIRED_PROPERTIES_DECODER*)context;
+    DESIRED_PROPERTIES_SCOPE* scope = &decoder->scopes[decoder->depth];
+
+    switch (scope->type)
     {
-        // Tree already starts on node we want so just use it.
-        updateTree = initialParsedTree;
+        default:
+        case DESIRED_PROPERTIES_SCOPE_TWIN:
+        {
+            if ((name == NULL) ||
+                (nameLength != sizeof("desired") - 1) ||
+                (strncmp(name, "desired", nameLength) != 0))
+            {
+                /*Codes_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, only the members of the `desired` object shall be applied and all other members of jsonPayload shall be skipped. ]*/
+                result = JSON_DECODER_ACTION_SKIP;
+            }
+            else if ((valueType != JSON_DECODER_VALUE_OBJECT) || decoder->foundDesired)
+            {
+                LogError("'desired' is not a single object");
+                result = JSON_DECODER_ACTION_ABORT;
+            }
+            else
+            {
+                SCHEMA_MODEL_TYPE_HANDLE modelHandle = scope->modelHandle;
+                DESIRED_PROPERTIES_SCOPE* desiredScope = PushScope(decoder, DESIRED_PROPERTIES_SCOPE_MODEL);
+                if (desiredScope == NULL)
+                {
+                    result = JSON_DECODER_ACTION_ABORT;
+                }
+                else
+                {
+                    desiredScope->modelHandle = modelHandle;
+                    desiredScope->isDesiredRoot = true;
+                    decoder->foundDesired = true;
+                    result = JSON_DECODER_ACTION_CONTINUE;
+                }
+            }
+            break;
+        }
+        case DESIRED_PROPERTIES_SCOPE_MODEL:
+        {
+            result = OnModelMember(decoder, scope, name, nameLength, valueType, value, valueLength);
+            break;
+        }
+        case DESIRED_PROPERTIES_SCOPE_STRUCT:
+        {
+            result = OnStructMember(decoder, scope, name, nameLength, valueType, value, valueLength);
+            break;
+        }
     }
 
-    /*Codes_COMMAND_DECODER_02_015: [ Remove '$version' string from node, if it is present.  It not being present is not an error ]*/
-    MULTITREE_RESULT deleteChildResult = MultiTree_DeleteChild(updateTree, "$version");
-    if ((deleteChildResult == MULTITREE_OK) || (deleteChildResult == MULTITREE_CHILD_NOT_FOUND))
+    return result;
+}
+
+static JSON_DECODER_ACTION OnDesiredPropertiesEnd(void* context)
+{
+    JSON_DECODER_ACTION result;
+    DESIRED_PROPERTIES_DECODER* decoder = (DESIRED_PROPERTIES_DECODER*)context;
+    DESIRED_PROPERTIES_SCOPE* scope = &decoder->scopes[decoder->depth];
+
+    decoder->depth--;
+
+    if (scope->type == DESIRED_PROPERTIES_SCOPE_MODEL)
     {
-        *desiredPropertiesTree = updateTree;
-        result = true;
+        if (scope->onDesiredProperty != NULL)
+        {
+            /*the callback of the model in model is called after the values of its object have been written*/
+            DESIRED_PROPERTY_CHANGE change;
+            change.type = DESIRED_PROPERTY_CHANGE_NOTIFICATION;
+            change.onDesiredProperty = scope->onDesiredProperty;
+            change.modelAddress = (char*)decoder->startAddress + scope->parentOffset;
+            result = (StageDesiredPropertyChange(decoder, &change) == 0) ? JSON_DECODER_ACTION_CONTINUE : JSON_DECODER_ACTION_ABORT;
+        }
+        else
+        {
+            result = JSON_DECODER_ACTION_CONTINUE;
+        }
     }
     else
     {
-        *desiredPropertiesTree = NULL;
-        result = false;
+        size_t i;
+        DESIRED_PROPERTY_CHANGE change;
+
+        for (i = 0; i < scope->memberCount; i++)
+        {
+            if (scope->memberValues[i].type == EDM_NO_TYPE)
+            {
+                break;
+            }
+        }
+
+        if (i < scope->memberCount)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_006: [ If a member of the struct is repeated or missing then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+            LogError("struct member %s is missing", scope->memberNames[i]);
+            result = JSON_DECODER_ACTION_ABORT;
+        }
+        else if (Create_AGENT_DATA_TYPE_from_Members(&change.agentDataType, scope->typeName, scope->memberCount, (const char* const*)scope->memberNames, scope->memberValues) != AGENT_DATA_TYPES_OK)
+        {
+            LogError("Creating the agent data type from members failed.");
+            result = JSON_DECODER_ACTION_ABORT;
+        }
+        else if (scope->desiredPropertyHandle != NULL)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_014: [ The decoded values shall be staged, and only written to the device once the whole jsonPayload has been walked. ]*/
+            change.type = DESIRED_PROPERTY_CHANGE_AGENT_DATA_TYPE;
+            result = StageDesiredProperty(decoder, scope->offset, scope->desiredPropertyHandle, &change);
+        }
+        else
+        {
+            /*the enclosing struct takes ownership*/
+            decoder->scopes[decoder->depth].memberValues[scope->memberIndex] = change.agentDataType;
+            result = JSON_DECODER_ACTION_CONTINUE;
+        }
+
+        ReleaseStructScope(scope);
     }
 
     return result;
 }
 
+static const JSON_DECODER_CALLBACKS desiredPropertiesCallbacks =
+{
+    OnDesiredPropertiesValue,
+    OnDesiredPropertiesEnd
+};
+
 EXECUTE_COMMAND_RESULT CommandDecoder_IngestDesiredProperties(void* startAddress, COMMAND_DECODER_HANDLE handle, const char* jsonPayload, bool parseDesiredNode)
 {
     EXECUTE_COMMAND_RESULT result;
@@ -997,43 +2186,71 @@ EXECUTE_COMMAND_RESULT CommandDecoder_IngestDesiredProperties(void* startAddress
     }
     else
     {
-        /*Codes_SRS_COMMAND_DECODER_02_004: [ CommandDecoder_IngestDesiredProperties shall clone desiredProperties. ]*/
-        char* copy;
-        if (mallocAndStrcpy_s(&copy, jsonPayload) != 0)
+        COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
+        DESIRED_PROPERTIES_DECODER decoder;
+        JSON_DECODER_RESULT decoderResult;
+
+        decoder.startAddress = startAddress;
+        decoder.schemaHandle = Schema_GetSchemaForModelType(commandDecoderInstance->ModelHandle);
+        decoder.foundDesired = false;
+        decoder.depth = 0;
+        (void)memset(&decoder.scopes[0], 0, sizeof(DESIRED_PROPERTIES_SCOPE));
+        decoder.scopes[0].type = parseDesiredNode ? DESIRED_PROPERTIES_SCOPE_TWIN : DESIRED_PROPERTIES_SCOPE_MODEL;
+        decoder.scopes[0].modelHandle = commandDecoderInstance->ModelHandle;
+        decoder.scopes[0].isDesiredRoot = !parseDesiredNode;
+        decoder.changes = decoder.stackChanges;
+        decoder.changeCount = 0;
+        decoder.changeCapacity = DESIRED_PROPERTY_CHANGES_STACK_COUNT;
+
+        /*Codes_SRS_COMMAND_DECODER_09_001: [ CommandDecoder_IngestDesiredProperties shall walk jsonPayload once with JSONDecoder_JSON_To_Callbacks, without cloning jsonPayload and without building a MULTITREE. ]*/
+        decoderResult = JSONDecoder_JSON_To_Callbacks(jsonPayload, &desiredPropertiesCallbacks, &decoder);
+
+        /*the walk stopped inside structs that were not complete*/
+        while (decoder.depth > 0)
         {
-            LogError("failure in mallocAndStrcpy_s");
+            if (decoder.scopes[decoder.depth].type == DESIRED_PROPERTIES_SCOPE_STRUCT)
+            {
+                ReleaseStructScope(&decoder.scopes[decoder.depth]);
+            }
+            decoder.depth--;
+        }
+
+        if (decoderResult == JSON_DECODER_ERROR)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_015: [ If the walk fails then the staged values shall be released without being written to the device. ]*/
+            /*Codes_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+            LogError("not all constituents of the JSON have been ingested");
+            ReleaseDesiredPropertyChanges(&decoder);
+            result = EXECUTE_COMMAND_FAILED;
+        }
+        else if (decoderResult != JSON_DECODER_OK)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_015: [ If the walk fails then the staged values shall be released without being written to the device. ]*/
+            /*Codes_SRS_COMMAND_DECODER_09_002: [ If jsonPayload is not valid JSON then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+            LogError("Decoding JSON failed");
+            ReleaseDesiredPropertyChanges(&decoder);
+            result = EXECUTE_COMMAND_ERROR;
+        }
+        else if (parseDesiredNode && !decoder.foundDesired)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_003: [ If parseDesiredNode is TRUE and jsonPayload has no `desired` object then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+            LogError("Unable to find 'desired' in JSON");
+            result = EXECUTE_COMMAND_ERROR;
+        }
+        else if (CommitDesiredPropertyChanges(&decoder) != 0)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_016: [ If pfDesiredPropertyFromAGENT_DATA_TYPE fails then the values staged after it shall be released without being written and CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
             result = EXECUTE_COMMAND_FAILED;
         }
         else
         {
-            /*Codes_SRS_COMMAND_DECODER_02_005: [ CommandDecoder_IngestDesiredProperties shall create a MULTITREE_HANDLE ouf of the clone of desiredProperties. ]*/
-            MULTITREE_HANDLE initialParsedTree;
-            MULTITREE_HANDLE desiredPropertiesTree;
-
-            if (JSONDecoder_JSON_To_MultiTree(copy, &initialParsedTree) != JSON_DECODER_OK)
-            {
-                LogError("Decoding JSON to a multi tree failed");
-                result = EXECUTE_COMMAND_ERROR;
-            }
-            else
-            {
-                if (RemoveUnneededTwinProperties(initialParsedTree, parseDesiredNode, &desiredPropertiesTree) == false)
-                {
-                    LogError("Removing unneeded twin properties failed");
-                    result = EXECUTE_COMMAND_ERROR;
-                }
-                else
-                {
-                    COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
-
-                    /*Codes_SRS_COMMAND_DECODER_02_006: [ CommandDecoder_IngestDesiredProperties shall parse the MULTITREEE recursively. ]*/
-                    result = DecodeDesiredProperties(startAddress, commandDecoderInstance, desiredPropertiesTree);
+            /*Codes_SRS_COMMAND_DECODER_02_010: [ If the complete JSON has been applied then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
+            result = EXECUTE_COMMAND_SUCCESS;
+        }
 
-                    // Do NOT free desiredPropertiesTree.  It is only a pointer into initialParsedTree.
-                    MultiTree_Destroy(initialParsedTree);
-                }
-            }
-            free(copy);
+        if (decoder.changes != decoder.stackChanges)
+        {
+            free(decoder.changes);
         }
     }
     return result;
@@ -9,6 +9,7 @@
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "schema.h"
 #include "jsonencoder.h"
+#include "cborencoder.h"
 #include "agenttypesystem.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "parson.h"
@@ -36,6 +37,104 @@ static void NoFreeFunction(void* value)
     (void)value;
 }
 
+static DATA_MARSHALLER_RESULT EncodeTreeAsJSON(MULTITREE_HANDLE treeHandle, unsigned char** destination, size_t* destinationSize)
+{
+    DATA_MARSHALLER_RESULT result;
+    STRING_HANDLE payload = STRING_new();
+    if (payload == NULL)
+    {
+        result = DATA_MARSHALLER_ERROR;
+        LOG_DATA_MARSHALLER_ERROR
+    }
+    else
+    {
+        if (JSONEncoder_EncodeTree(treeHandle, payload, (JSON_ENCODER_TOSTRING_FUNC)AgentDataTypes_ToString) != JSON_ENCODER_OK)
+        {
+            /* Codes_SRS_DATA_MARSHALLER_99_027:[ DATA_MARSHALLER_JSON_ENCODER_ERROR shall be returned when JSONEncoder returns an error code.] */
+            result = DATA_MARSHALLER_JSON_ENCODER_ERROR;
+            LOG_DATA_MARSHALLER_ERROR
+        }
+        else
+        {
+            /*Codes_SRS_DATAMARSHALLER_02_007: [DataMarshaller_SendData shall copy in the output parameters *destination, *destinationSize the content and the content length of the encoded JSON tree.] */
+            size_t resultSize = STRING_length(payload);
+            unsigned char* temp = malloc(resultSize);
+            if (temp == NULL)
+            {
+                /*Codes_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
+                result = DATA_MARSHALLER_ERROR;
+                LOG_DATA_MARSHALLER_ERROR;
+            }
+            else
+            {
+                (void)memcpy(temp, STRING_c_str(payload), resultSize);
+                *destination = temp;
+                *destinationSize = resultSize;
+                result = DATA_MARSHALLER_OK;
+            }
+        }
+        STRING_delete(payload);
+    }
+
+    return result;
+}
+
+static DATA_MARSHALLER_RESULT EncodeTreeAsCBOR(MULTITREE_HANDLE treeHandle, unsigned char** destination, size_t* destinationSize)
+{
+    DATA_MARSHALLER_RESULT result;
+    JSON_ENCODER_BUFFER payload;
+
+    /*the payload of a telemetry message with a handful of properties fits without growing*/
+    if (JSONEncoder_Buffer_Init(&payload, 64) != JSON_ENCODER_OK)
+    {
+        result = DATA_MARSHALLER_ERROR;
+        LOG_DATA_MARSHALLER_ERROR;
+    }
+    else if (CBOREncoder_EncodeTree(treeHandle, &payload) != CBOR_ENCODER_OK)
+    {
+        /*Codes_SRS_DATA_MARSHALLER_09_005: [ If CBOREncoder_EncodeTree fails, the CBOR encoder shall fail and return DATA_MARSHALLER_ENCODER_ERROR. ]*/
+        JSONEncoder_Buffer_Deinit(&payload);
+        result = DATA_MARSHALLER_ENCODER_ERROR;
+        LOG_DATA_MARSHALLER_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_DATA_MARSHALLER_09_004: [ The CBOR encoder shall encode the tree by calling CBOREncoder_EncodeTree and hand over the encoded bytes in destination and destinationSize. ]*/
+        *destination = (unsigned char*)payload.buffer;
+        *destinationSize = payload.length;
+        result = DATA_MARSHALLER_OK;
+    }
+
+    return result;
+}
+
+static const DATA_MARSHALLER_ENCODER g_JSONEncoder = { "application/json", "utf-8", EncodeTreeAsJSON };
+static const DATA_MARSHALLER_ENCODER g_CBOREncoder = { CBOR_ENCODER_CONTENT_TYPE, NULL, EncodeTreeAsCBOR };
+
+/*Codes_SRS_DATA_MARSHALLER_09_001: [ Before any call to DataMarshaller_SetEncoder, DataMarshaller_GetEncoder shall return the JSON encoder. ]*/
+static const DATA_MARSHALLER_ENCODER* g_Encoder = &g_JSONEncoder;
+
+const DATA_MARSHALLER_ENCODER* DataMarshaller_GetJSONEncoder(void)
+{
+    return &g_JSONEncoder;
+}
+
+const DATA_MARSHALLER_ENCODER* DataMarshaller_GetCBOREncoder(void)
+{
+    return &g_CBOREncoder;
+}
+
+void DataMarshaller_SetEncoder(const DATA_MARSHALLER_ENCODER* encoder)
+{
+    /*Codes_SRS_DATA_MARSHALLER_09_002: [ DataMarshaller_SetEncoder shall make encoder the encoder of every DataMarshaller_SendData that follows. If encoder is NULL, the JSON encoder shall be used. ]*/
+    g_Encoder = (encoder == NULL) ? &g_JSONEncoder : encoder;
+}
+
+const DATA_MARSHALLER_ENCODER* DataMarshaller_GetEncoder(void)
+{
+    return g_Encoder;
+}
+
 DATA_MARSHALLER_HANDLE DataMarshaller_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandle, bool includePropertyPath)
 {
     DATA_MARSHALLER_HANDLE_DATA* result;
@@ -130,84 +229,63 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
             else
             {
                 size_t j;
+                MULTITREE_CURSOR cursor;
                 result = DATA_MARSHALLER_OK; /* addressing warning in VS compiler */
-                /* Codes_SRS_DATA_MARSHALLER_99_038:[For each pair in the values argument, a string : value pair shall exist in the JSON object in the form of propertyName : value.] */
-                for (j = 0; j < valueCount; j++)
+
+                /*Codes_SRS_DATA_MARSHALLER_09_007: [ DataMarshaller_SendData shall add the values to the MultiTree through a cursor initialized with MultiTree_InitCursor, so values under the same parent do not walk the property path again. ]*/
+                if (MultiTree_InitCursor(treeHandle, &cursor) != MULTITREE_OK)
+                {
+                    /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
+                    result = DATA_MARSHALLER_MULTITREE_ERROR;
+                    LOG_DATA_MARSHALLER_ERROR
+                }
+                else
                 {
-                    if ((includePropertyPath == false) && (values[j].Value->type == EDM_COMPLEX_TYPE_TYPE))
+                    /* Codes_SRS_DATA_MARSHALLER_99_038:[For each pair in the values argument, a string : value pair shall exist in the JSON object in the form of propertyName : value.] */
+                    for (j = 0; j < valueCount; j++)
                     {
-                        size_t k;
-
-                        /* Codes_SRS_DATAMARSHALLER_01_001: [If the includePropertyPath argument passed to DataMarshaller_Create was false and only one struct is being sent, the relative path of the value passed to DataMarshaller_SendData - including property name - shall be ignored and the value shall be placed at JSON root.] */
-                        for (k = 0; k < values[j].Value->value.edmComplexType.nMembers; k++)
+                        if ((includePropertyPath == false) && (values[j].Value->type == EDM_COMPLEX_TYPE_TYPE))
                         {
-                            /* Codes_SRS_DATAMARSHALLER_01_004: [In this case the members of the struct shall be added as leafs into the MultiTree, each leaf having the name of the struct member.] */
-                            if (MultiTree_AddLeaf(treeHandle, values[j].Value->value.edmComplexType.fields[k].fieldName, (void*)values[j].Value->value.edmComplexType.fields[k].value) != MULTITREE_OK)
+                            size_t k;
+
+                            /* Codes_SRS_DATAMARSHALLER_01_001: [If the includePropertyPath argument passed to DataMarshaller_Create was false and only one struct is being sent, the relative path of the value passed to DataMarshaller_SendData - including property name - shall be ignored and the value shall be placed at JSON root.] */
+                            for (k = 0; k < values[j].Value->value.edmComplexType.nMembers; k++)
                             {
-                                break;
+                                /* Codes_SRS_DATAMARSHALLER_01_004: [In this case the members of the struct shall be added as leafs into the MultiTree, each leaf having the name of the struct member.] */
+                                if (MultiTree_AddLeafAtCursor(&cursor, values[j].Value->value.edmComplexType.fields[k].fieldName, (void*)values[j].Value->value.edmComplexType.fields[k].value) != MULTITREE_OK)
+                                {
+                                    break;
+                                }
                             }
-                        }
-
-                        if (k < values[j].Value->value.edmComplexType.nMembers)
-                        {
-                            /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-                            result = DATA_MARSHALLER_MULTITREE_ERROR;
-                            LOG_DATA_MARSHALLER_ERROR
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        /* Codes_SRS_DATA_MARSHALLER_99_039:[ If the includePropertyPath argument passed to DataMarshaller_Create was true each property shall be placed in the appropriate position in the JSON according to its path in the model.] */
-                        if (MultiTree_AddLeaf(treeHandle, values[j].PropertyPath, (void*)values[j].Value) != MULTITREE_OK)
-                        {
-                            /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-                            result = DATA_MARSHALLER_MULTITREE_ERROR;
-                            LOG_DATA_MARSHALLER_ERROR
-                            break;
-                        }
-                    }
 
-                }
-
-                if (j == valueCount)
-                {
-                    STRING_HANDLE payload = STRING_new();
-                    if (payload == NULL)
-                    {
-                        result = DATA_MARSHALLER_ERROR;
-                        LOG_DATA_MARSHALLER_ERROR
-                    }
-                    else
-                    {
-                        if (JSONEncoder_EncodeTree(treeHandle, payload, (JSON_ENCODER_TOSTRING_FUNC)AgentDataTypes_ToString) != JSON_ENCODER_OK)
-                        {
-                            /* Codes_SRS_DATA_MARSHALLER_99_027:[ DATA_MARSHALLER_JSON_ENCODER_ERROR shall be returned when JSONEncoder returns an error code.] */
-                            result = DATA_MARSHALLER_JSON_ENCODER_ERROR;
-                            LOG_DATA_MARSHALLER_ERROR
+                            if (k < values[j].Value->value.edmComplexType.nMembers)
+                            {
+                                /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
+                                result = DATA_MARSHALLER_MULTITREE_ERROR;
+                                LOG_DATA_MARSHALLER_ERROR
+                                break;
+                            }
                         }
                         else
                         {
-                            /*Codes_SRS_DATAMARSHALLER_02_007: [DataMarshaller_SendData shall copy in the output parameters *destination, *destinationSize the content and the content length of the encoded JSON tree.] */
-                            size_t resultSize = STRING_length(payload);
-                            unsigned char* temp = malloc(resultSize);
-                            if (temp == NULL)
-                            {
-                                /*Codes_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
-                                result = DATA_MARSHALLER_ERROR;
-                                LOG_DATA_MARSHALLER_ERROR;
-                            }
-                            else
+                            /* Codes_SRS_DATA_MARSHALLER_99_039:[ If the includePropertyPath argument passed to DataMarshaller_Create was true each property shall be placed in the appropriate position in the JSON according to its path in the model.] */
+                            if (MultiTree_AddLeafAtCursor(&cursor, values[j].PropertyPath, (void*)values[j].Value) != MULTITREE_OK)
                             {
-                                (void)memcpy(temp, STRING_c_str(payload), resultSize);
-                                *destination = temp;
-                                *destinationSize = resultSize;
-                                result = DATA_MARSHALLER_OK;
+                                /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
+                                result = DATA_MARSHALLER_MULTITREE_ERROR;
+                                LOG_DATA_MARSHALLER_ERROR
+                                break;
                             }
                         }
-                        STRING_delete(payload);
+
                     }
-                } /* if (j==valueCount)*/
+
+                    if (j == valueCount)
+                    {
+                        /*Codes_SRS_DATA_MARSHALLER_09_003: [ DataMarshaller_SendData shall produce destination and destinationSize by calling the encode function of the encoder returned by DataMarshaller_GetEncoder. ]*/
+                        result = g_Encoder->encode(treeHandle, destination, destinationSize);
+                    } /* if (j==valueCount)*/
+                }
                 MultiTree_Destroy(treeHandle);
             } /* MultiTree_Create */
         }
@@ -240,6 +318,7 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData_ReportedProperties(DATA_MARSHALLE
     }
     else
     {
+        /*Codes_SRS_DATA_MARSHALLER_09_006: [ DataMarshaller_SendData_ReportedProperties shall produce JSON whatever encoder DataMarshaller_SetEncoder has set, because the device twin only accepts JSON. ]*/
         /*Codes_SRS_DATA_MARSHALLER_02_012: [ DataMarshaller_SendData_ReportedProperties shall create an empty JSON_Value. ]*/
         JSON_Value* json = json_value_init_object();
         if (json == NULL)
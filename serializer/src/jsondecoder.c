@@ -609,3 +609,212 @@ JSON_DECODER_RESULT JSONDecoder_JSON_To_MultiTree(char* json, MULTITREE_HANDLE*
 
     return result;
 }
+
+static JSON_DECODER_RESULT WalkObjectOrArray(PARSER_STATE* parserState, const JSON_DECODER_CALLBACKS* callbacks, void* context);
+
+/* callbacks is NULL while a skipped value is being stepped over */
+static JSON_DECODER_RESULT WalkValue(PARSER_STATE* parserState, const char* name, size_t nameLength, const JSON_DECODER_CALLBACKS* callbacks, void* context)
+{
+    JSON_DECODER_RESULT result;
+    char* valueBegin;
+
+    SkipWhiteSpaces(parserState);
+    valueBegin = parserState->json;
+
+    if ((*valueBegin == '{') || (*valueBegin == '['))
+    {
+        if (callbacks == NULL)
+        {
+            result = WalkObjectOrArray(parserState, NULL, NULL);
+        }
+        else
+        {
+            /* Codes_SRS_JSON_DECODER_09_006: [ For objects and arrays onValue shall receive a pointer to the opening bracket and a valueLength of 0. ] */
+            JSON_DECODER_ACTION action = callbacks->onValue(context, name, nameLength, (*valueBegin == '{') ? JSON_DECODER_VALUE_OBJECT : JSON_DECODER_VALUE_ARRAY, valueBegin, 0);
+            if (action == JSON_DECODER_ACTION_ABORT)
+            {
+                /* Codes_SRS_JSON_DECODER_09_010: [ If onValue or onEnd returns JSON_DECODER_ACTION_ABORT then JSONDecoder_JSON_To_Callbacks shall stop and return JSON_DECODER_ERROR. ] */
+                result = JSON_DECODER_ERROR;
+            }
+            else if (action == JSON_DECODER_ACTION_SKIP)
+            {
+                /* Codes_SRS_JSON_DECODER_09_007: [ If onValue returns JSON_DECODER_ACTION_SKIP for an object or an array, JSONDecoder_JSON_To_Callbacks shall validate the nested value without calling any callback for it. ] */
+                result = WalkObjectOrArray(parserState, NULL, NULL);
+            }
+            /* Codes_SRS_JSON_DECODER_09_008: [ If onValue returns JSON_DECODER_ACTION_CONTINUE for an object or an array, JSONDecoder_JSON_To_Callbacks shall report its content and then call onEnd. ] */
+            else if ((result = WalkObjectOrArray(parserState, callbacks, context)) != JSON_DECODER_OK)
+            {
+                /* already have error */
+            }
+            else if (callbacks->onEnd(context) == JSON_DECODER_ACTION_ABORT)
+            {
+                /* Codes_SRS_JSON_DECODER_09_010: [ If onValue or onEnd returns JSON_DECODER_ACTION_ABORT then JSONDecoder_JSON_To_Callbacks shall stop and return JSON_DECODER_ERROR. ] */
+                result = JSON_DECODER_ERROR;
+            }
+        }
+    }
+    else
+    {
+        JSON_DECODER_VALUE_TYPE valueType;
+
+        if (*valueBegin == '"')
+        {
+            valueType = JSON_DECODER_VALUE_STRING;
+            result = ParseString(parserState, &valueBegin);
+        }
+        else if (
+            (ISDIGIT(*valueBegin)) ||
+            (*valueBegin == '-'))
+        {
+            valueType = JSON_DECODER_VALUE_NUMBER;
+            result = ParseNumber(parserState);
+        }
+        else
+        {
+            valueType = JSON_DECODER_VALUE_LITERAL;
+            if (strncmp(valueBegin, "false", 5) == 0)
+            {
+                parserState->json += 5;
+                result = JSON_DECODER_OK;
+            }
+            else if ((strncmp(valueBegin, "true", 4) == 0) ||
+                (strncmp(valueBegin, "null", 4) == 0))
+            {
+                parserState->json += 4;
+                result = JSON_DECODER_OK;
+            }
+            else
+            {
+                /* Codes_SRS_JSON_DECODER_09_011: [ If json is malformed then JSONDecoder_JSON_To_Callbacks shall return JSON_DECODER_PARSE_ERROR. ] */
+                result = JSON_DECODER_PARSE_ERROR;
+            }
+        }
+
+        /* Codes_SRS_JSON_DECODER_09_005: [ For strings, numbers and literals onValue shall receive the text of the value as it appears in json (strings keep their quotes) and its length. ] */
+        if ((result == JSON_DECODER_OK) &&
+            (callbacks != NULL) &&
+            (callbacks->onValue(context, name, nameLength, valueType, valueBegin, (size_t)(parserState->json - valueBegin)) == JSON_DECODER_ACTION_ABORT))
+        {
+            /* Codes_SRS_JSON_DECODER_09_010: [ If onValue or onEnd returns JSON_DECODER_ACTION_ABORT then JSONDecoder_JSON_To_Callbacks shall stop and return JSON_DECODER_ERROR. ] */
+            result = JSON_DECODER_ERROR;
+        }
+    }
+
+    return result;
+}
+
+static JSON_DECODER_RESULT WalkObjectOrArray(PARSER_STATE* parserState, const JSON_DECODER_CALLBACKS* callbacks, void* context)
+{
+    JSON_DECODER_RESULT result = JSON_DECODER_OK;
+    char closingChar = (*(parserState->json) == '{') ? '}' : ']';
+
+    parserState->json++;
+    SkipWhiteSpaces(parserState);
+
+    if (*(parserState->json) == closingChar)
+    {
+        parserState->json++;
+    }
+    else
+    {
+        while (result == JSON_DECODER_OK)
+        {
+            const char* name = NULL;
+            size_t nameLength = 0;
+
+            if (closingChar == '}')
+            {
+                char* nameBegin;
+
+                SkipWhiteSpaces(parserState);
+
+                /* Codes_SRS_JSON_DECODER_99_022:[ A name is a string.] */
+                if ((result = ParseString(parserState, &nameBegin)) != JSON_DECODER_OK)
+                {
+                    break;
+                }
+
+                /* Codes_SRS_JSON_DECODER_09_003: [ For each member of an object JSONDecoder_JSON_To_Callbacks shall call onValue with the member name (without quotes) and its length. ] */
+                name = nameBegin + 1;
+                nameLength = (size_t)(parserState->json - nameBegin) - 2;
+
+                if ((result = ParseColon(parserState)) != JSON_DECODER_OK)
+                {
+                    break;
+                }
+            }
+            /* Codes_SRS_JSON_DECODER_09_004: [ For each element of an array JSONDecoder_JSON_To_Callbacks shall call onValue with a NULL name and a nameLength of 0. ] */
+
+            if ((result = WalkValue(parserState, name, nameLength, callbacks, context)) == JSON_DECODER_OK)
+            {
+                SkipWhiteSpaces(parserState);
+
+                /* Codes_SRS_JSON_DECODER_99_024:[ A single comma separates a value from a following name.] */
+                /* Codes_SRS_JSON_DECODER_99_027:[ Elements are separated by commas.] */
+                if (*(parserState->json) == ',')
+                {
+                    parserState->json++;
+                }
+                else if (*(parserState->json) == closingChar)
+                {
+                    parserState->json++;
+                    break;
+                }
+                else
+                {
+                    /* Codes_SRS_JSON_DECODER_09_011: [ If json is malformed then JSONDecoder_JSON_To_Callbacks shall return JSON_DECODER_PARSE_ERROR. ] */
+                    result = JSON_DECODER_PARSE_ERROR;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+JSON_DECODER_RESULT JSONDecoder_JSON_To_Callbacks(const char* json, const JSON_DECODER_CALLBACKS* callbacks, void* context)
+{
+    JSON_DECODER_RESULT result;
+
+    if ((json == NULL) ||
+        (callbacks == NULL) ||
+        (callbacks->onValue == NULL) ||
+        (callbacks->onEnd == NULL))
+    {
+        /* Codes_SRS_JSON_DECODER_09_001: [ If json, callbacks, callbacks->onValue or callbacks->onEnd is NULL then JSONDecoder_JSON_To_Callbacks shall return JSON_DECODER_INVALID_ARG. ] */
+        result = JSON_DECODER_INVALID_ARG;
+    }
+    else
+    {
+        /* Codes_SRS_JSON_DECODER_09_002: [ JSONDecoder_JSON_To_Callbacks shall not modify json and shall not allocate memory. ] */
+        /* the walk only reads through parseState.json */
+        PARSER_STATE parseState;
+        parseState.json = (char*)json;
+
+        SkipWhiteSpaces(&parseState);
+
+        /* Codes_SRS_JSON_DECODER_99_012:[ A JSON text is a serialized object or array.] */
+        if ((*(parseState.json) != '{') && (*(parseState.json) != '['))
+        {
+            /* Codes_SRS_JSON_DECODER_09_011: [ If json is malformed then JSONDecoder_JSON_To_Callbacks shall return JSON_DECODER_PARSE_ERROR. ] */
+            result = JSON_DECODER_PARSE_ERROR;
+        }
+        /* Codes_SRS_JSON_DECODER_09_009: [ The root object or array shall not be reported through onValue or onEnd. ] */
+        else if ((result = WalkObjectOrArray(&parseState, callbacks, context)) == JSON_DECODER_OK)
+        {
+            SkipWhiteSpaces(&parseState);
+            if (*(parseState.json) != '\0')
+            {
+                /* Codes_SRS_JSON_DECODER_09_011: [ If json is malformed then JSONDecoder_JSON_To_Callbacks shall return JSON_DECODER_PARSE_ERROR. ] */
+                result = JSON_DECODER_PARSE_ERROR;
+            }
+            else
+            {
+                /* Codes_SRS_JSON_DECODER_09_012: [ Otherwise JSONDecoder_JSON_To_Callbacks shall return JSON_DECODER_OK. ] */
+                result = JSON_DECODER_OK;
+            }
+        }
+    }
+
+    return result;
+}
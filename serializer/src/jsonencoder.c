@@ -1,6 +1,9 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "jsonencoder.h"
@@ -216,3 +219,123 @@ JSON_ENCODER_TOSTRING_RESULT JSONEncoder_CharPtr_ToString(STRING_HANDLE destinat
 
     return result;
 }
+
+JSON_ENCODER_RESULT JSONEncoder_Buffer_Init(JSON_ENCODER_BUFFER* buffer, size_t initialCapacity)
+{
+    JSON_ENCODER_RESULT result;
+
+    /*Codes_SRS_JSON_ENCODER_09_001: [ If buffer is NULL or initialCapacity is 0, JSONEncoder_Buffer_Init shall return JSON_ENCODER_INVALID_ARG. ]*/
+    if ((buffer == NULL) ||
+        (initialCapacity == 0))
+    {
+        result = JSON_ENCODER_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+    }
+    /*Codes_SRS_JSON_ENCODER_09_002: [ JSONEncoder_Buffer_Init shall allocate initialCapacity bytes and set the length of the buffer to 0. ]*/
+    else if ((buffer->buffer = (char*)malloc(initialCapacity)) == NULL)
+    {
+        /*Codes_SRS_JSON_ENCODER_09_003: [ If allocating the memory fails, JSONEncoder_Buffer_Init shall return JSON_ENCODER_ERROR. ]*/
+        buffer->length = 0;
+        buffer->capacity = 0;
+        result = JSON_ENCODER_ERROR;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+    }
+    else
+    {
+        buffer->length = 0;
+        buffer->capacity = initialCapacity;
+        result = JSON_ENCODER_OK;
+    }
+
+    return result;
+}
+
+JSON_ENCODER_RESULT JSONEncoder_Buffer_Reserve(JSON_ENCODER_BUFFER* buffer, size_t additionalLength)
+{
+    JSON_ENCODER_RESULT result;
+
+    /*Codes_SRS_JSON_ENCODER_09_004: [ If buffer is NULL, JSONEncoder_Buffer_Reserve shall return JSON_ENCODER_INVALID_ARG. ]*/
+    if (buffer == NULL)
+    {
+        result = JSON_ENCODER_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+    }
+    else if (additionalLength > SIZE_MAX - buffer->length)
+    {
+        /*Codes_SRS_JSON_ENCODER_09_007: [ If the required size overflows or growing the buffer fails, JSONEncoder_Buffer_Reserve shall return JSON_ENCODER_ERROR and leave the buffer unchanged. ]*/
+        result = JSON_ENCODER_ERROR;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+    }
+    /*Codes_SRS_JSON_ENCODER_09_005: [ If the buffer already has room for additionalLength more bytes, JSONEncoder_Buffer_Reserve shall return JSON_ENCODER_OK without allocating. ]*/
+    else if (buffer->length + additionalLength <= buffer->capacity)
+    {
+        result = JSON_ENCODER_OK;
+    }
+    else
+    {
+        /*Codes_SRS_JSON_ENCODER_09_006: [ Otherwise JSONEncoder_Buffer_Reserve shall grow the buffer to at least twice its capacity, or to the required size if that is larger. ]*/
+        size_t requiredCapacity = buffer->length + additionalLength;
+        size_t newCapacity = (buffer->capacity > SIZE_MAX / 2) ? SIZE_MAX : (buffer->capacity * 2);
+        char* newBuffer;
+
+        if (newCapacity < requiredCapacity)
+        {
+            newCapacity = requiredCapacity;
+        }
+
+        if ((newBuffer = (char*)realloc(buffer->buffer, newCapacity)) == NULL)
+        {
+            /*Codes_SRS_JSON_ENCODER_09_007: [ If the required size overflows or growing the buffer fails, JSONEncoder_Buffer_Reserve shall return JSON_ENCODER_ERROR and leave the buffer unchanged. ]*/
+            result = JSON_ENCODER_ERROR;
+            LogError("(result = %s)", MU_ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+        }
+        else
+        {
+            buffer->buffer = newBuffer;
+            buffer->capacity = newCapacity;
+            result = JSON_ENCODER_OK;
+        }
+    }
+
+    return result;
+}
+
+JSON_ENCODER_RESULT JSONEncoder_Buffer_Append(JSON_ENCODER_BUFFER* buffer, const char* source, size_t sourceLength)
+{
+    JSON_ENCODER_RESULT result;
+
+    /*Codes_SRS_JSON_ENCODER_09_008: [ If buffer or source is NULL, JSONEncoder_Buffer_Append shall return JSON_ENCODER_INVALID_ARG. ]*/
+    if ((buffer == NULL) ||
+        (source == NULL))
+    {
+        result = JSON_ENCODER_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+    }
+    /*Codes_SRS_JSON_ENCODER_09_009: [ JSONEncoder_Buffer_Append shall call JSONEncoder_Buffer_Reserve for sourceLength bytes and then copy sourceLength bytes from source at the end of the buffer. ]*/
+    else if ((result = JSONEncoder_Buffer_Reserve(buffer, sourceLength)) != JSON_ENCODER_OK)
+    {
+        /*Codes_SRS_JSON_ENCODER_09_010: [ If JSONEncoder_Buffer_Reserve fails, JSONEncoder_Buffer_Append shall fail and return the same error. ]*/
+        LogError("(result = %s)", MU_ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+    }
+    else
+    {
+        (void)memcpy(buffer->buffer + buffer->length, source, sourceLength);
+        buffer->length += sourceLength;
+        result = JSON_ENCODER_OK;
+    }
+
+    return result;
+}
+
+void JSONEncoder_Buffer_Deinit(JSON_ENCODER_BUFFER* buffer)
+{
+    /*Codes_SRS_JSON_ENCODER_09_011: [ If buffer is NULL, JSONEncoder_Buffer_Deinit shall do nothing. ]*/
+    if (buffer != NULL)
+    {
+        /*Codes_SRS_JSON_ENCODER_09_012: [ JSONEncoder_Buffer_Deinit shall free the memory held by the buffer and set its length and capacity to 0. ]*/
+        free(buffer->buffer);
+        buffer->buffer = NULL;
+        buffer->length = 0;
+        buffer->capacity = 0;
+    }
+}
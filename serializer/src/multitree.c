@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdint.h>
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "multitree.h"
@@ -11,70 +12,286 @@
 #include "azure_macro_utils/macro_utils.h"
 #include "azure_c_shared_utility/const_defines.h"
 
-/*assume a name cannot be longer than 100 characters*/
-#define INNER_NODE_NAME_SIZE 128
+/*bytes of arena that come with the MultiTree_Create allocation, enough for a handful of nodes*/
+#define MULTITREE_ARENA_INITIAL_SIZE 256
+/*arena chunks double in size up to this many bytes*/
+#define MULTITREE_ARENA_MAX_CHUNK_SIZE 8192
+#define MULTITREE_ARENA_ALIGN(size) (((size) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
+#define MULTITREE_NAMES_INITIAL_CAPACITY 16
+#define MULTITREE_CHILDREN_INITIAL_CAPACITY 4
+/*nodes with more children than this get a hashed index of their children*/
+#define MULTITREE_CHILD_INDEX_THRESHOLD 8
+#define MULTITREE_CHILD_INDEX_INITIAL_SIZE 32
 
 MU_DEFINE_ENUM_STRINGS(MULTITREE_RESULT, MULTITREE_RESULT_VALUES);
 
-typedef struct MULTITREE_HANDLE_DATA_TAG
+typedef struct MULTITREE_ARENA_CHUNK_TAG
+{
+    struct MULTITREE_ARENA_CHUNK_TAG* next;
+    size_t size;
+    size_t used;
+    /*followed by size bytes*/
+}MULTITREE_ARENA_CHUNK;
+
+typedef struct MULTITREE_NAME_ENTRY_TAG
+{
+    size_t hash;
+    const char* name;
+}MULTITREE_NAME_ENTRY;
+
+/*state shared by all the nodes of a tree. Nodes and names live in the arena until the tree is destroyed*/
+typedef struct MULTITREE_TREE_TAG
 {
-    char* name;
-    void* value;
     MULTITREE_CLONE_FUNCTION cloneFunction;
     MULTITREE_FREE_FUNCTION freeFunction;
+    MULTITREE_ARENA_CHUNK* chunks; /*newest first, the last one is part of the MultiTree_Create allocation*/
+    MULTITREE_NAME_ENTRY* names; /*open addressed set of all the names in the tree*/
+    size_t nameCount;
+    size_t nameCapacity;
+    size_t generation; /*changes when nodes are deleted, invalidates cursors*/
+}MULTITREE_TREE;
+
+typedef struct MULTITREE_HANDLE_DATA_TAG
+{
+    const char* name; /*interned, NULL for the root*/
+    size_t nameHash;
+    void* value;
+    MULTITREE_TREE* tree;
     size_t nChildren;
+    size_t childrenCapacity;
     struct MULTITREE_HANDLE_DATA_TAG** children; /*an array of nChildren count of MULTITREE_HANDLE_DATA*   */
+    size_t* childIndex; /*open addressed, each slot is a position in children + 1, 0 is an empty slot*/
+    size_t childIndexSize;
 }MULTITREE_HANDLE_DATA;
 
+typedef struct MULTITREE_ROOT_TAG
+{
+    MULTITREE_HANDLE_DATA root; /*must be first, the root handle is the allocation*/
+    MULTITREE_TREE tree;
+    MULTITREE_ARENA_CHUNK firstChunk;
+    unsigned char firstChunkData[MULTITREE_ARENA_INITIAL_SIZE];
+}MULTITREE_ROOT;
 
-MULTITREE_HANDLE MultiTree_Create(MULTITREE_CLONE_FUNCTION cloneFunction, MULTITREE_FREE_FUNCTION freeFunction)
+static void* arenaAllocate(MULTITREE_TREE* tree, size_t size)
 {
-    MULTITREE_HANDLE_DATA* result;
+    void* result;
+    MULTITREE_ARENA_CHUNK* chunk = tree->chunks;
 
-    /* Codes_SRS_MULTITREE_99_052:[If any of the arguments passed to MultiTree_Create is NULL, the call shall return NULL.]*/
-    if ((cloneFunction == NULL) ||
-        (freeFunction == NULL))
+    size = MULTITREE_ARENA_ALIGN(size);
+    if (chunk->size - chunk->used < size)
     {
-        LogError("CloneFunction or FreeFunction is Null.");
+        size_t chunkSize = (chunk->size < MULTITREE_ARENA_MAX_CHUNK_SIZE / 2) ? chunk->size * 2 : MULTITREE_ARENA_MAX_CHUNK_SIZE;
+        if (chunkSize < size)
+        {
+            chunkSize = size;
+        }
+
+        if (chunkSize > SIZE_MAX - sizeof(MULTITREE_ARENA_CHUNK))
+        {
+            chunk = NULL;
+        }
+        else
+        {
+            chunk = (MULTITREE_ARENA_CHUNK*)malloc(sizeof(MULTITREE_ARENA_CHUNK) + chunkSize);
+        }
+
+        if (chunk != NULL)
+        {
+            chunk->next = tree->chunks;
+            chunk->size = chunkSize;
+            chunk->used = 0;
+            tree->chunks = chunk;
+        }
+    }
+
+    if (chunk == NULL)
+    {
+        LogError("failure growing the tree arena by %lu bytes", (unsigned long)size);
         result = NULL;
     }
     else
     {
-        /*Codes_SRS_MULTITREE_99_005:[ MultiTree_Create creates a new tree.]*/
-        /*Codes_SRS_MULTITREE_99_006:[MultiTree_Create returns a non - NULL pointer if the tree has been successfully created.]*/
-        /*Codes_SRS_MULTITREE_99_007:[MultiTree_Create returns NULL if the tree has not been successfully created.]*/
-        result = (MULTITREE_HANDLE_DATA*)malloc(sizeof(MULTITREE_HANDLE_DATA));
-        if (result != NULL)
+        result = (unsigned char*)(chunk + 1) + chunk->used;
+        chunk->used += size;
+    }
+
+    return result;
+}
+
+static size_t hashName(const char* name, size_t nameLength)
+{
+    /*FNV-1a*/
+    size_t result = 2166136261u;
+    size_t i;
+    for (i = 0; i < nameLength; i++)
+    {
+        result ^= (unsigned char)name[i];
+        result *= 16777619u;
+    }
+    return result;
+}
+
+/*returns the interned copy of name or NULL if no node of the tree ever had that name*/
+static const char* findName(const MULTITREE_TREE* tree, const char* name, size_t nameLength, size_t hash)
+{
+    const char* result = NULL;
+    if (tree->names != NULL)
+    {
+        size_t mask = tree->nameCapacity - 1;
+        size_t slot = hash & mask;
+        while (tree->names[slot].name != NULL)
         {
-            result->name = NULL;
-            result->value = NULL;
-            result->cloneFunction = cloneFunction;
-            result->freeFunction = freeFunction;
-            result->nChildren = 0;
-            result->children = NULL;
+            if ((tree->names[slot].hash == hash) &&
+                (strncmp(tree->names[slot].name, name, nameLength) == 0) &&
+                (tree->names[slot].name[nameLength] == '\0'))
+            {
+                result = tree->names[slot].name;
+                break;
+            }
+            slot = (slot + 1) & mask;
         }
-        else
+    }
+    return result;
+}
+
+static void insertName(MULTITREE_NAME_ENTRY* names, size_t capacity, size_t hash, const char* name)
+{
+    size_t slot = hash & (capacity - 1);
+    while (names[slot].name != NULL)
+    {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    names[slot].hash = hash;
+    names[slot].name = name;
+}
+
+/*returns the interned copy of name, adding it to the tree if needed. Returns NULL on failure*/
+static const char* internName(MULTITREE_TREE* tree, const char* name, size_t nameLength, size_t hash)
+{
+    const char* result = findName(tree, name, nameLength, hash);
+    if (result == NULL)
+    {
+        if ((tree->nameCount + 1) * 2 > tree->nameCapacity)
         {
-            LogError("MultiTree_Create failed because malloc failed");
+            size_t newCapacity = (tree->nameCapacity == 0) ? MULTITREE_NAMES_INITIAL_CAPACITY : tree->nameCapacity * 2;
+            MULTITREE_NAME_ENTRY* newNames;
+            if (newCapacity > SIZE_MAX / sizeof(MULTITREE_NAME_ENTRY))
+            {
+                newNames = NULL;
+            }
+            else
+            {
+                newNames = (MULTITREE_NAME_ENTRY*)malloc(newCapacity * sizeof(MULTITREE_NAME_ENTRY));
+            }
+
+            if (newNames == NULL)
+            {
+                LogError("failure growing the name table of the tree");
+            }
+            else
+            {
+                size_t i;
+                (void)memset(newNames, 0, newCapacity * sizeof(MULTITREE_NAME_ENTRY));
+                for (i = 0; i < tree->nameCapacity; i++)
+                {
+                    if (tree->names[i].name != NULL)
+                    {
+                        insertName(newNames, newCapacity, tree->names[i].hash, tree->names[i].name);
+                    }
+                }
+                free(tree->names);
+                tree->names = newNames;
+                tree->nameCapacity = newCapacity;
+            }
         }
-    }
 
-    return (MULTITREE_HANDLE)result;
+        if ((tree->nameCount + 1) * 2 <= tree->nameCapacity)
+        {
+            char* copy = (char*)arenaAllocate(tree, nameLength + 1);
+            if (copy != NULL)
+            {
+                (void)memcpy(copy, name, nameLength);
+                copy[nameLength] = '\0';
+                insertName(tree->names, tree->nameCapacity, hash, copy);
+                tree->nameCount++;
+                result = copy;
+            }
+        }
+    }
+    return result;
 }
 
+/*builds the child index with at least size slots. The index is only a speed up: when it cannot be allocated lookups are linear*/
+static void rebuildChildIndex(MULTITREE_HANDLE_DATA* node, size_t size)
+{
+    free(node->childIndex);
+    node->childIndex = NULL;
+    node->childIndexSize = 0;
+
+    while (size < node->nChildren * 2)
+    {
+        size *= 2;
+    }
+
+    if (size <= SIZE_MAX / sizeof(size_t))
+    {
+        node->childIndex = (size_t*)malloc(size * sizeof(size_t));
+    }
+
+    if (node->childIndex != NULL)
+    {
+        size_t i;
+        (void)memset(node->childIndex, 0, size * sizeof(size_t));
+        node->childIndexSize = size;
+        for (i = 0; i < node->nChildren; i++)
+        {
+            size_t slot = node->children[i]->nameHash & (size - 1);
+            while (node->childIndex[slot] != 0)
+            {
+                slot = (slot + 1) & (size - 1);
+            }
+            node->childIndex[slot] = i + 1;
+        }
+    }
+}
 
 /*return NULL if a child with the name "name" doesn't exists*/
 /*returns a pointer to the existing child (if any)*/
-static MULTITREE_HANDLE_DATA* getChildByName(MULTITREE_HANDLE_DATA* node, const char* name)
+static MULTITREE_HANDLE_DATA* getChildByName(MULTITREE_HANDLE_DATA* node, const char* name, size_t nameLength)
 {
     MULTITREE_HANDLE_DATA* result = NULL;
-    size_t i;
-    for (i = 0; i < node->nChildren; i++)
+    size_t hash = hashName(name, nameLength);
+    /*names are interned, a name that is not in the tree cannot be the name of a child*/
+    const char* internedName = findName(node->tree, name, nameLength, hash);
+    if (internedName != NULL)
     {
-        if (strcmp(node->children[i]->name, name) == 0)
+        if (node->childIndex != NULL)
         {
-            result = node->children[i];
-            break;
+            size_t mask = node->childIndexSize - 1;
+            size_t slot = hash & mask;
+            while (node->childIndex[slot] != 0)
+            {
+                MULTITREE_HANDLE_DATA* child = node->children[node->childIndex[slot] - 1];
+                if (child->name == internedName)
+                {
+                    result = child;
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+        else
+        {
+            size_t i;
+            for (i = 0; i < node->nChildren; i++)
+            {
+                if (node->children[i]->name == internedName)
+                {
+                    result = node->children[i];
+                    break;
+                }
+            }
         }
     }
     return result;
@@ -102,31 +319,35 @@ static STATIC_VAR_UNUSED const char* CreateLeaf_ResultAsString[CREATELEAF_RESULT
 };
 
 /*name cannot be empty, value can be empty or NULL*/
-#ifdef __APPLE__
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wconditional-uninitialized"
-#endif
-#ifdef _MSC_VER
-#pragma warning(disable: 4701) /* potentially uninitialized local variable 'result' used */ /* the scanner cannot track linked "newNode" and "result" therefore the warning*/
-#endif
-static CREATELEAF_RESULT createLeaf(MULTITREE_HANDLE_DATA* node, const char*name, const char*value, MULTITREE_HANDLE_DATA** childNode)
+static CREATELEAF_RESULT createLeaf(MULTITREE_HANDLE_DATA* node, const char* name, size_t nameLength, const void* value, MULTITREE_HANDLE_DATA** childNode)
 {
     CREATELEAF_RESULT result;
     /*can only create it if it doesn't exist*/
-    if (strlen(name) == 0)
+    if (nameLength == 0)
     {
         /*Codes_SRS_MULTITREE_99_024:[ if a child name is empty (such as in  "/child1//child12"), MULTITREE_EMPTY_CHILD_NAME shall be returned.]*/
         result = CREATELEAF_EMPTY_NAME;
         LogError("(result = %s)", CreateLeaf_ResultAsString[result]);
     }
-    else if (getChildByName(node, name) != NULL)
+    else if (getChildByName(node, name, nameLength) != NULL)
     {
         result = CREATELEAF_ALREADY_EXISTS;
         LogError("(result = %s)", CreateLeaf_ResultAsString[result]);
     }
+    else if ((node->nChildren == node->childrenCapacity) &&
+        (node->childrenCapacity > SIZE_MAX / (2 * sizeof(MULTITREE_HANDLE_DATA*))))
+    {
+        result = CREATELEAF_ERROR;
+        LogError("(result = %s)", CreateLeaf_ResultAsString[result]);
+    }
     else
     {
-        MULTITREE_HANDLE_DATA* newNode = (MULTITREE_HANDLE_DATA*)malloc(sizeof(MULTITREE_HANDLE_DATA));
+        MULTITREE_TREE* tree = node->tree;
+        size_t hash = hashName(name, nameLength);
+        /*Codes_SRS_MULTITREE_09_001: [ Nodes and their names shall be allocated from an arena owned by the tree and released all at once by MultiTree_Destroy on the root of the tree. ]*/
+        /*Codes_SRS_MULTITREE_09_002: [ Equal names shall be stored once per tree. ]*/
+        const char* internedName = internName(tree, name, nameLength, hash);
+        MULTITREE_HANDLE_DATA* newNode = (internedName == NULL) ? NULL : (MULTITREE_HANDLE_DATA*)arenaAllocate(tree, sizeof(MULTITREE_HANDLE_DATA));
         if (newNode == NULL)
         {
             result = CREATELEAF_ERROR;
@@ -134,61 +355,73 @@ static CREATELEAF_RESULT createLeaf(MULTITREE_HANDLE_DATA* node, const char*name
         }
         else
         {
+            newNode->name = internedName;
+            newNode->nameHash = hash;
+            newNode->value = NULL;
+            newNode->tree = tree;
             newNode->nChildren = 0;
+            newNode->childrenCapacity = 0;
             newNode->children = NULL;
-            if (mallocAndStrcpy_s(&(newNode->name), name) != 0)
+            newNode->childIndex = NULL;
+            newNode->childIndexSize = 0;
+
+            if ((value != NULL) &&
+                (tree->cloneFunction(&(newNode->value), value) != 0))
             {
-                /*not nice*/
-                free(newNode);
-                newNode = NULL;
+                /*the node stays in the arena until the tree is destroyed*/
+                newNode->value = NULL;
                 result = CREATELEAF_ERROR;
                 LogError("(result = %s)", CreateLeaf_ResultAsString[result]);
             }
             else
             {
-                newNode->cloneFunction = node->cloneFunction;
-                newNode->freeFunction = node->freeFunction;
-
-                if (value == NULL)
-                {
-                    newNode->value = NULL;
-                }
-                else if (node->cloneFunction(&(newNode->value), value) != 0)
-                {
-                    free(newNode->name);
-                    newNode->name = NULL;
-                    free(newNode);
-                    newNode = NULL;
-                    result = CREATELEAF_ERROR;
-                    LogError("(result = %s)", CreateLeaf_ResultAsString[result]);
-                }
-                else
+                if (node->nChildren == node->childrenCapacity)
                 {
-                    /*all is fine until now*/
+                    /*allocate space in the father node*/
+                    size_t newCapacity = (node->childrenCapacity == 0) ? MULTITREE_CHILDREN_INITIAL_CAPACITY : node->childrenCapacity * 2;
+                    MULTITREE_HANDLE_DATA** newChildren = (MULTITREE_HANDLE_DATA**)realloc(node->children, newCapacity * sizeof(MULTITREE_HANDLE_DATA*));
+                    if (newChildren != NULL)
+                    {
+                        node->children = newChildren;
+                        node->childrenCapacity = newCapacity;
+                    }
                 }
-            }
 
-
-            if (newNode!=NULL)
-            {
-                /*allocate space in the father node*/
-                MULTITREE_HANDLE_DATA** newChildren = (MULTITREE_HANDLE_DATA**)realloc(node->children, (node->nChildren + 1)*sizeof(MULTITREE_HANDLE_DATA*));
-                if (newChildren == NULL)
+                if (node->nChildren == node->childrenCapacity)
                 {
                     /*no space for the new node*/
-                    newNode->value = NULL;
-                    free(newNode->name);
-                    newNode->name = NULL;
-                    free(newNode);
-                    newNode = NULL;
+                    if (newNode->value != NULL)
+                    {
+                        tree->freeFunction(newNode->value);
+                        newNode->value = NULL;
+                    }
                     result = CREATELEAF_ERROR;
                     LogError("(result = %s)", CreateLeaf_ResultAsString[result]);
                 }
                 else
                 {
-                    node->children = newChildren;
                     node->children[node->nChildren] = newNode;
                     node->nChildren++;
+
+                    /*Codes_SRS_MULTITREE_09_003: [ Once a node has more than 8 children, looking up a child by name shall use a hash index of the children instead of comparing against every child. ]*/
+                    if (node->nChildren > MULTITREE_CHILD_INDEX_THRESHOLD)
+                    {
+                        if ((node->childIndex == NULL) ||
+                            (node->nChildren * 2 > node->childIndexSize))
+                        {
+                            rebuildChildIndex(node, (node->childIndexSize == 0) ? MULTITREE_CHILD_INDEX_INITIAL_SIZE : node->childIndexSize * 2);
+                        }
+                        else
+                        {
+                            size_t slot = hash & (node->childIndexSize - 1);
+                            while (node->childIndex[slot] != 0)
+                            {
+                                slot = (slot + 1) & (node->childIndexSize - 1);
+                            }
+                            node->childIndex[slot] = node->nChildren;
+                        }
+                    }
+
                     if (childNode != NULL)
                     {
                         *childNode = newNode;
@@ -200,12 +433,150 @@ static CREATELEAF_RESULT createLeaf(MULTITREE_HANDLE_DATA* node, const char*name
     }
 
     return result;
-#ifdef _MSC_VER
-#pragma warning(default: 4701) /* potentially uninitialized local variable 'result' used */ /* the scanner cannot track linked "newNode" and "result" therefore the warning*/
-#endif
-#ifdef __APPLE__
-#pragma clang diagnostic pop
-#endif
+}
+
+MULTITREE_HANDLE MultiTree_Create(MULTITREE_CLONE_FUNCTION cloneFunction, MULTITREE_FREE_FUNCTION freeFunction)
+{
+    MULTITREE_HANDLE_DATA* result;
+
+    /* Codes_SRS_MULTITREE_99_052:[If any of the arguments passed to MultiTree_Create is NULL, the call shall return NULL.]*/
+    if ((cloneFunction == NULL) ||
+        (freeFunction == NULL))
+    {
+        LogError("CloneFunction or FreeFunction is Null.");
+        result = NULL;
+    }
+    else
+    {
+        /*Codes_SRS_MULTITREE_99_005:[ MultiTree_Create creates a new tree.]*/
+        /*Codes_SRS_MULTITREE_99_006:[MultiTree_Create returns a non - NULL pointer if the tree has been successfully created.]*/
+        /*Codes_SRS_MULTITREE_99_007:[MultiTree_Create returns NULL if the tree has not been successfully created.]*/
+        MULTITREE_ROOT* root = (MULTITREE_ROOT*)malloc(sizeof(MULTITREE_ROOT));
+        if (root != NULL)
+        {
+            root->tree.cloneFunction = cloneFunction;
+            root->tree.freeFunction = freeFunction;
+            root->tree.chunks = &root->firstChunk;
+            root->tree.names = NULL;
+            root->tree.nameCount = 0;
+            root->tree.nameCapacity = 0;
+            root->tree.generation = 0;
+            root->firstChunk.next = NULL;
+            root->firstChunk.size = sizeof(root->firstChunkData);
+            root->firstChunk.used = 0;
+
+            result = &root->root;
+            result->name = NULL;
+            result->nameHash = 0;
+            result->value = NULL;
+            result->tree = &root->tree;
+            result->nChildren = 0;
+            result->childrenCapacity = 0;
+            result->children = NULL;
+            result->childIndex = NULL;
+            result->childIndexSize = 0;
+        }
+        else
+        {
+            result = NULL;
+            LogError("MultiTree_Create failed because malloc failed");
+        }
+    }
+
+    return (MULTITREE_HANDLE)result;
+}
+
+/*walks pathLength characters of path (segments separated by '/') from node, creating the children that do not exist*/
+static MULTITREE_RESULT getOrCreatePath(MULTITREE_HANDLE_DATA* node, const char* path, size_t pathLength, MULTITREE_HANDLE_DATA** destination)
+{
+    MULTITREE_RESULT result = MULTITREE_OK;
+    const char* end = path + pathLength;
+
+    if (pathLength > 0)
+    {
+        for (;;)
+        {
+            const char* whereIsDelimiter = path;
+            MULTITREE_HANDLE_DATA* child;
+            while ((whereIsDelimiter < end) && (*whereIsDelimiter != '/'))
+            {
+                whereIsDelimiter++;
+            }
+
+            child = getChildByName(node, path, whereIsDelimiter - path);
+            if (child == NULL)
+            {
+                /*Codes_SRS_MULTITREE_99_022:[ If a child along the path does not exist, it shall be created.] */
+                /*Codes_SRS_MULTITREE_99_023:[ The newly created children along the path shall have a NULL value by default.]*/
+                CREATELEAF_RESULT res = createLeaf(node, path, whereIsDelimiter - path, NULL, &child);
+                if (res == CREATELEAF_EMPTY_NAME)
+                {
+                    /*Codes_SRS_MULTITREE_99_024:[ if a child name is empty (such as in  "/child1//child12"), MULTITREE_EMPTY_CHILD_NAME shall be returned.]*/
+                    result = MULTITREE_EMPTY_CHILD_NAME;
+                    LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
+                    break;
+                }
+                else if (res != CREATELEAF_OK)
+                {
+                    /*Codes_SRS_MULTITREE_99_025:[The function shall return MULTITREE_ERROR to indicate any other error not specified here.]*/
+                    result = MULTITREE_ERROR;
+                    LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
+                    break;
+                }
+            }
+
+            node = child;
+            if (whereIsDelimiter == end)
+            {
+                break;
+            }
+            path = whereIsDelimiter + 1;
+        }
+    }
+
+    if (result == MULTITREE_OK)
+    {
+        *destination = node;
+    }
+    return result;
+}
+
+static MULTITREE_RESULT addLeafToParent(MULTITREE_HANDLE_DATA* parent, const char* name, const void* value)
+{
+    MULTITREE_RESULT result;
+    /*Codes_SRS_MULTITREE_99_017:[ Subsequent names designate hierarchical children in the tree. The last child designates the child that will receive the value.]*/
+    CREATELEAF_RESULT res = createLeaf(parent, name, strlen(name), value, NULL);
+    switch (res)
+    {
+        default:
+        {
+            /*Codes_SRS_MULTITREE_99_025:[The function shall return MULTITREE_ERROR to indicate any other error not specified here.]*/
+            result = MULTITREE_ERROR;
+            LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
+            break;
+        }
+        case CREATELEAF_ALREADY_EXISTS:
+        {
+            /*Codes_SRS_MULTITREE_99_021:[ If the node already has a value assigned to it, MULTITREE_ALREADY_HAS_A_VALUE shall be returned and the existing value shall not be changed.]*/
+            result = MULTITREE_ALREADY_HAS_A_VALUE;
+            LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
+            break;
+        }
+        case CREATELEAF_OK:
+        {
+            /*Codes_SRS_MULTITREE_99_034:[ The function returns MULTITREE_OK when data has been stored in the tree.]*/
+            result = MULTITREE_OK;
+            break;
+        }
+        case CREATELEAF_EMPTY_NAME:
+        {
+            /*Codes_SRS_MULTITREE_99_024:[ if a child name is empty (such as in  "/child1//child12"), MULTITREE_EMPTY_CHILD_NAME shall be returned.]*/
+            result = MULTITREE_EMPTY_CHILD_NAME;
+            LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
+            break;
+        }
+    }
+    return result;
 }
 
 MULTITREE_RESULT MultiTree_AddLeaf(MULTITREE_HANDLE treeHandle, const char* destinationPath, const void* value)
@@ -230,114 +601,30 @@ MULTITREE_RESULT MultiTree_AddLeaf(MULTITREE_HANDLE treeHandle, const char* dest
         LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
     }
     /*Codes_SRS_MULTITREE_99_050:[ If destinationPath a string with zero characters, MULTITREE_INVALID_ARG shall be returned.]*/
-    else if (strlen(destinationPath) == 0)
+    else if (destinationPath[0] == '\0')
     {
         result = MULTITREE_EMPTY_CHILD_NAME;
         LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
     }
     else
     {
-        /*break the path into components*/
-        /*find the first child name*/
-        MULTITREE_HANDLE_DATA * node = (MULTITREE_HANDLE_DATA *)treeHandle;
-        char * whereIsDelimiter;
+        MULTITREE_HANDLE_DATA* parent;
+        const char* leafName;
         /*if first character is / then skip it*/
         /*Codes_SRS_MULTITREE_99_014:[DestinationPath is a string in the following format: /child1/child12 or child1/child12] */
         if (destinationPath[0] == '/')
         {
             destinationPath++;
         }
-        /*if there's just a string, it needs to be created here*/
-        whereIsDelimiter = (char*)strchr(destinationPath, '/');
-        if (whereIsDelimiter == NULL)
-        {
-            /*Codes_SRS_MULTITREE_99_017:[ Subsequent names designate hierarchical children in the tree. The last child designates the child that will receive the value.]*/
-            CREATELEAF_RESULT res = createLeaf(node, destinationPath, (const char*)value, NULL);
-            switch (res)
-            {
-                default:
-                {
-                    /*Codes_SRS_MULTITREE_99_025:[The function shall return MULTITREE_ERROR to indicate any other error not specified here.]*/
-                    result = MULTITREE_ERROR;
-                    LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
-                    break;
-                }
-                case CREATELEAF_ALREADY_EXISTS:
-                {
-                    /*Codes_SRS_MULTITREE_99_021:[ If the node already has a value assigned to it, MULTITREE_ALREADY_HAS_A_VALUE shall be returned and the existing value shall not be changed.]*/
-                    result = MULTITREE_ALREADY_HAS_A_VALUE;
-                    LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
-                    break;
-                }
-                case CREATELEAF_OK:
-                {
-                    /*Codes_SRS_MULTITREE_99_034:[ The function returns MULTITREE_OK when data has been stored in the tree.]*/
-                    result = MULTITREE_OK;
-                    break;
-                }
-                case CREATELEAF_EMPTY_NAME:
-                {
-                    /*Codes_SRS_MULTITREE_99_024:[ if a child name is empty (such as in  "/child1//child12"), MULTITREE_EMPTY_CHILD_NAME shall be returned.]*/
-                    result = MULTITREE_EMPTY_CHILD_NAME;
-                    LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
-                    break;
-                }
-            }
-        }
-        else
+
+        leafName = strrchr(destinationPath, '/');
+        leafName = (leafName == NULL) ? destinationPath : leafName + 1;
+
+        /*Codes_SRS_MULTITREE_99_017:[ Subsequent names designate hierarchical children in the tree. The last child designates the child that will receive the value.]*/
+        result = getOrCreatePath((MULTITREE_HANDLE_DATA*)treeHandle, destinationPath, (leafName == destinationPath) ? 0 : (size_t)(leafName - destinationPath - 1), &parent);
+        if (result == MULTITREE_OK)
         {
-            /*if there's more or 1 delimiter in the path... */
-            /*Codes_SRS_MULTITREE_99_017:[ Subsequent names designate hierarchical children in the tree. The last child designates the child that will receive the value.]*/
-            char firstInnerNodeName[INNER_NODE_NAME_SIZE];
-            if ((whereIsDelimiter - destinationPath) >= INNER_NODE_NAME_SIZE)
-            {
-                /*Codes_SRS_MULTITREE_99_025:[ The function shall return MULTITREE_ERROR to indicate any other error not specified here.]*/
-                result = MULTITREE_ERROR;
-                LogError("Destination path is too large %lu", (unsigned long)(whereIsDelimiter - destinationPath));
-            }
-            else if (memcpy(firstInnerNodeName, destinationPath, whereIsDelimiter - destinationPath) == NULL)
-            {
-                /*Codes_SRS_MULTITREE_99_025:[ The function shall return MULTITREE_ERROR to indicate any other error not specified here.]*/
-                result = MULTITREE_ERROR;
-                LogError("(result = MULTITREE_ERROR)");
-            }
-            else
-            {
-                firstInnerNodeName[whereIsDelimiter - destinationPath] = 0;
-                MULTITREE_HANDLE_DATA *child = getChildByName(node, firstInnerNodeName);
-                if (child == NULL)
-                {
-                    /*Codes_SRS_MULTITREE_99_022:[ If a child along the path does not exist, it shall be created.] */
-                    /*Codes_SRS_MULTITREE_99_023:[ The newly created children along the path shall have a NULL value by default.]*/
-                    CREATELEAF_RESULT res = createLeaf(node, firstInnerNodeName, NULL, NULL);
-                    switch (res)
-                    {
-                        default:
-                        {
-                            result = MULTITREE_ERROR;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
-                            break;
-                        }
-                        case(CREATELEAF_EMPTY_NAME):
-                        {
-                            /*Codes_SRS_MULTITREE_99_024:[ if a child name is empty (such as in  "/child1//child12"), MULTITREE_EMPTY_CHILD_NAME shall be returned.]*/
-                            result = MULTITREE_EMPTY_CHILD_NAME;
-                            LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
-                            break;
-                        }
-                        case(CREATELEAF_OK):
-                        {
-                            MULTITREE_HANDLE_DATA *createdChild = getChildByName(node, firstInnerNodeName);
-                            result = MultiTree_AddLeaf(createdChild, whereIsDelimiter, value);
-                            break;
-                        }
-                    };
-                }
-                else
-                {
-                    result = MultiTree_AddLeaf(child, whereIsDelimiter, value);
-                }
-            }
+            result = addLeafToParent(parent, leafName, value);
         }
     }
     return result;
@@ -360,7 +647,7 @@ MULTITREE_RESULT MultiTree_AddChild(MULTITREE_HANDLE treeHandle, const char* chi
         MULTITREE_HANDLE_DATA* childNode;
 
         /* Codes_SRS_MULTITREE_99_060:[ The value associated with the new node shall be NULL.] */
-        CREATELEAF_RESULT res = createLeaf((MULTITREE_HANDLE_DATA*)treeHandle, childName, NULL, &childNode);
+        CREATELEAF_RESULT res = createLeaf((MULTITREE_HANDLE_DATA*)treeHandle, childName, strlen(childName), NULL, &childNode);
         switch (res)
         {
             default:
@@ -514,18 +801,10 @@ MULTITREE_RESULT MultiTree_GetChildByName(MULTITREE_HANDLE treeHandle, const cha
     }
     else
     {
-        MULTITREE_HANDLE_DATA * node = (MULTITREE_HANDLE_DATA *)treeHandle;
-        size_t i;
+        /*Codes_SRS_MULTITREE_09_003: [ Once a node has more than 8 children, looking up a child by name shall use a hash index of the children instead of comparing against every child. ]*/
+        MULTITREE_HANDLE_DATA* child = getChildByName((MULTITREE_HANDLE_DATA*)treeHandle, childName, strlen(childName));
 
-        for (i = 0; i < node->nChildren; i++)
-        {
-            if (strcmp(node->children[i]->name, childName) == 0)
-            {
-                break;
-            }
-        }
-
-        if (i == node->nChildren)
+        if (child == NULL)
         {
             /* Codes_SRS_MULTITREE_99_068:[ If the specified child is not found, MultiTree_GetChildByName shall return MULTITREE_CHILD_NOT_FOUND.] */
             result = MULTITREE_CHILD_NOT_FOUND;
@@ -534,7 +813,7 @@ MULTITREE_RESULT MultiTree_GetChildByName(MULTITREE_HANDLE treeHandle, const cha
         else
         {
             /* Codes_SRS_MULTITREE_99_067:[ The child node handle shall be returned in the childHandle argument.] */
-            *childHandle = node->children[i];
+            *childHandle = child;
 
             /* Codes_SRS_MULTITREE_99_064:[ On success, MultiTree_GetChildByName shall return MULTITREE_OK.] */
             result = MULTITREE_OK;
@@ -600,7 +879,7 @@ MULTITREE_RESULT MultiTree_SetValue(MULTITREE_HANDLE treeHandle, void* value)
         else
         {
             /* Codes_SRS_MULTITREE_99_072:[ MultiTree_SetValue shall set the value of the node indicated by the treeHandle argument to the value of the argument value.] */
-            if (node->cloneFunction(&node->value, value) != 0)
+            if (node->tree->cloneFunction(&node->value, value) != 0)
             {
                 /* Codes_SRS_MULTITREE_99_075:[ MultiTree_SetValue shall return MULTITREE_ERROR to indicate any other error.] */
                 result = MULTITREE_ERROR;
@@ -616,40 +895,69 @@ MULTITREE_RESULT MultiTree_SetValue(MULTITREE_HANDLE treeHandle, void* value)
     return result;
 }
 
+/*releases what a node owns outside of the arena: its value and the arrays of its children, recursively*/
+static void releaseNode(MULTITREE_HANDLE_DATA* node)
+{
+    size_t i;
+    for (i = 0; i < node->nChildren; i++)
+    {
+        /*Codes_SRS_MULTITREE_99_047:[ This function frees any system resource used by the tree designated by parameter treeHandle]*/
+        releaseNode(node->children[i]);
+    }
+    /*Codes_SRS_MULTITREE_99_047:[ This function frees any system resource used by the tree designated by parameter treeHandle]*/
+    if (node->children != NULL)
+    {
+        free(node->children);
+        node->children = NULL;
+    }
+    node->nChildren = 0;
+    node->childrenCapacity = 0;
+
+    if (node->childIndex != NULL)
+    {
+        free(node->childIndex);
+        node->childIndex = NULL;
+    }
+    node->childIndexSize = 0;
+
+    /*Codes_SRS_MULTITREE_99_047:[ This function frees any system resource used by the tree designated by parameter treeHandle]*/
+    if (node->value != NULL)
+    {
+        node->tree->freeFunction(node->value);
+        node->value = NULL;
+    }
+}
+
 void MultiTree_Destroy(MULTITREE_HANDLE treeHandle)
 {
     if (treeHandle != NULL)
     {
         MULTITREE_HANDLE_DATA* node = (MULTITREE_HANDLE_DATA*)treeHandle;
-        size_t i;
-        for (i = 0; i < node->nChildren;i++)
-        {
-            /*Codes_SRS_MULTITREE_99_047:[ This function frees any system resource used by the tree designated by parameter treeHandle]*/
-            MultiTree_Destroy(node->children[i]);
-        }
-        /*Codes_SRS_MULTITREE_99_047:[ This function frees any system resource used by the tree designated by parameter treeHandle]*/
-        if (node->children != NULL)
-        {
-            free(node->children);
-            node->children = NULL;
-        }
+        releaseNode(node);
 
-        /*Codes_SRS_MULTITREE_99_047:[ This function frees any system resource used by the tree designated by parameter treeHandle]*/
-        if (node->name != NULL)
+        /*only the root owns the arena, other nodes stay in it until the root is destroyed*/
+        if (node->name == NULL)
         {
-            free(node->name);
-            node->name = NULL;
-        }
+            MULTITREE_TREE* tree = node->tree;
+            MULTITREE_ARENA_CHUNK* chunk = tree->chunks;
 
-        /*Codes_SRS_MULTITREE_99_047:[ This function frees any system resource used by the tree designated by parameter treeHandle]*/
-        if (node->value != NULL)
-        {
-            node->freeFunction(node->value);
-            node->value = NULL;
-        }
+            /*Codes_SRS_MULTITREE_09_001: [ Nodes and their names shall be allocated from an arena owned by the tree and released all at once by MultiTree_Destroy on the root of the tree. ]*/
+            while (chunk->next != NULL)
+            {
+                MULTITREE_ARENA_CHUNK* next = chunk->next;
+                free(chunk);
+                chunk = next;
+            }
 
-        /*Codes_SRS_MULTITREE_99_047:[ This function frees any system resource used by the tree designated by parameter treeHandle]*/
-        free(node);
+            if (tree->names != NULL)
+            {
+                free(tree->names);
+                tree->names = NULL;
+            }
+
+            /*Codes_SRS_MULTITREE_99_047:[ This function frees any system resource used by the tree designated by parameter treeHandle]*/
+            free(node);
+        }
     }
 }
 
@@ -699,8 +1007,7 @@ MULTITREE_RESULT MultiTree_GetLeafValue(MULTITREE_HANDLE treeHandle, const char*
             /* Codes_SRS_MULTITREE_99_058:[ The last child designates the child that will receive the value.] */
             while (*pos != '\0')
             {
-                size_t i;
-                size_t childCount = node->nChildren;
+                MULTITREE_HANDLE_DATA* child;
 
                 whereIsDelimiter = pos;
 
@@ -716,7 +1023,7 @@ MULTITREE_RESULT MultiTree_GetLeafValue(MULTITREE_HANDLE treeHandle, const char*
                     LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
                     break;
                 }
-                else if (childCount == 0)
+                else if ((child = getChildByName(node, pos, whereIsDelimiter - pos)) == NULL)
                 {
                     /* Codes_SRS_MULTITREE_99_071:[ When the child node is not found, MultiTree_GetLeafValue shall return MULTITREE_CHILD_NOT_FOUND.] */
                     result = MULTITREE_CHILD_NOT_FOUND;
@@ -725,35 +1032,17 @@ MULTITREE_RESULT MultiTree_GetLeafValue(MULTITREE_HANDLE treeHandle, const char*
                 }
                 else
                 {
-                    for (i = 0; i < childCount; i++)
-                    {
-                        if (strncmp(node->children[i]->name, pos, whereIsDelimiter - pos) == 0)
-                        {
-                            /* Codes_SRS_MULTITREE_99_057:[ Subsequent names designate hierarchical children in the tree.] */
-                            node = node->children[i];
-                            break;
-                        }
-                    }
-
-                    if (i == childCount)
+                    /* Codes_SRS_MULTITREE_99_057:[ Subsequent names designate hierarchical children in the tree.] */
+                    node = child;
+                    if (*whereIsDelimiter == '/')
                     {
-                        /* Codes_SRS_MULTITREE_99_071:[ When the child node is not found, MultiTree_GetLeafValue shall return MULTITREE_CHILD_NOT_FOUND.] */
-                        result = MULTITREE_CHILD_NOT_FOUND;
-                        LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
-                        break;
+                        pos = whereIsDelimiter + 1;
                     }
                     else
                     {
-                        if (*whereIsDelimiter == '/')
-                        {
-                            pos = whereIsDelimiter + 1;
-                        }
-                        else
-                        {
-                            /* end of path */
-                            pos = whereIsDelimiter;
-                            break;
-                        }
+                        /* end of path */
+                        pos = whereIsDelimiter;
+                        break;
                     }
                 }
             }
@@ -793,20 +1082,9 @@ MULTITREE_RESULT MultiTree_DeleteChild(MULTITREE_HANDLE treeHandle, const char*
     else
     {
         size_t i;
-        size_t childToRemove = treeHandle->nChildren;
-        MULTITREE_HANDLE treeToRemove = NULL;
-
-        for (i = 0; i < treeHandle->nChildren; i++)
-        {
-            if (0 == strcmp(treeHandle->children[i]->name, childName))
-            {
-                childToRemove = i;
-                treeToRemove = treeHandle->children[childToRemove];
-                break;
-            }
-        }
+        MULTITREE_HANDLE treeToRemove = getChildByName(treeHandle, childName, strlen(childName));
 
-        if (i == treeHandle->nChildren)
+        if (treeToRemove == NULL)
         {
             /* Codes_SRS_MULTITREE_99_079:[If childName is not found, MultiTree_DeleteChild shall return MULTITREE_CHILD_NOT_FOUND.] */
             result = MULTITREE_CHILD_NOT_FOUND;
@@ -814,7 +1092,11 @@ MULTITREE_RESULT MultiTree_DeleteChild(MULTITREE_HANDLE treeHandle, const char*
         }
         else
         {
-            for (i = childToRemove; i < treeHandle->nChildren - 1; i++)
+            for (i = 0; treeHandle->children[i] != treeToRemove; i++)
+            {
+            }
+
+            for (; i < treeHandle->nChildren - 1; i++)
             {
                 treeHandle->children[i] = treeHandle->children[i+1];
             }
@@ -826,6 +1108,24 @@ MULTITREE_RESULT MultiTree_DeleteChild(MULTITREE_HANDLE treeHandle, const char*
             treeHandle->children[treeHandle->nChildren - 1] = NULL;
             treeHandle->nChildren = treeHandle->nChildren - 1;
 
+            /*positions of the children after the deleted one have changed*/
+            if (treeHandle->childIndex != NULL)
+            {
+                if (treeHandle->nChildren > MULTITREE_CHILD_INDEX_THRESHOLD)
+                {
+                    rebuildChildIndex(treeHandle, treeHandle->childIndexSize);
+                }
+                else
+                {
+                    free(treeHandle->childIndex);
+                    treeHandle->childIndex = NULL;
+                    treeHandle->childIndexSize = 0;
+                }
+            }
+
+            /*Codes_SRS_MULTITREE_09_011: [ MultiTree_DeleteChild shall invalidate all cursors of the tree. ]*/
+            treeHandle->tree->generation++;
+
             result = MULTITREE_OK;
         }
     }
@@ -833,3 +1133,107 @@ MULTITREE_RESULT MultiTree_DeleteChild(MULTITREE_HANDLE treeHandle, const char*
     return result;
 }
 
+/*Codes_SRS_MULTITREE_09_004: [ MultiTree_InitCursor shall make cursor add leaves under treeHandle. ]*/
+MULTITREE_RESULT MultiTree_InitCursor(MULTITREE_HANDLE treeHandle, MULTITREE_CURSOR* cursor)
+{
+    MULTITREE_RESULT result;
+    /*Codes_SRS_MULTITREE_09_005: [ If any argument is NULL, MultiTree_InitCursor shall return MULTITREE_INVALID_ARG. ]*/
+    if ((treeHandle == NULL) ||
+        (cursor == NULL))
+    {
+        result = MULTITREE_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
+    }
+    else
+    {
+        cursor->treeHandle = treeHandle;
+        cursor->parentHandle = NULL;
+        cursor->parentPath = NULL;
+        cursor->parentPathLength = 0;
+        cursor->parentPathCapacity = 0;
+        cursor->generation = treeHandle->tree->generation;
+        result = MULTITREE_OK;
+    }
+    return result;
+}
+
+MULTITREE_RESULT MultiTree_AddLeafAtCursor(MULTITREE_CURSOR* cursor, const char* destinationPath, const void* value)
+{
+    MULTITREE_RESULT result;
+    /*Codes_SRS_MULTITREE_09_006: [ If cursor, destinationPath or value is NULL, or cursor has not been initialized by MultiTree_InitCursor, MultiTree_AddLeafAtCursor shall return MULTITREE_INVALID_ARG. ]*/
+    if ((cursor == NULL) ||
+        (cursor->treeHandle == NULL) ||
+        (destinationPath == NULL) ||
+        (value == NULL))
+    {
+        result = MULTITREE_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(MULTITREE_RESULT, result));
+    }
+    else
+    {
+        MULTITREE_HANDLE_DATA* parent;
+        const char* leafName;
+        size_t parentPathLength;
+        MULTITREE_TREE* tree = cursor->treeHandle->tree;
+
+        /*Codes_SRS_MULTITREE_09_007: [ MultiTree_AddLeafAtCursor shall add value at destinationPath relative to the node of the cursor, exactly like MultiTree_AddLeaf does. ]*/
+        if (destinationPath[0] == '/')
+        {
+            destinationPath++;
+        }
+
+        leafName = strrchr(destinationPath, '/');
+        leafName = (leafName == NULL) ? destinationPath : leafName + 1;
+        parentPathLength = (leafName == destinationPath) ? 0 : (size_t)(leafName - destinationPath - 1);
+
+        if ((cursor->parentHandle != NULL) &&
+            (cursor->generation == tree->generation) &&
+            (cursor->parentPathLength == parentPathLength) &&
+            (memcmp(cursor->parentPath, destinationPath, parentPathLength) == 0))
+        {
+            /*Codes_SRS_MULTITREE_09_008: [ If the parent path of destinationPath is the same as in the previous call, MultiTree_AddLeafAtCursor shall add the leaf to the same parent node without walking the path again. ]*/
+            parent = cursor->parentHandle;
+            result = MULTITREE_OK;
+        }
+        else
+        {
+            /*Codes_SRS_MULTITREE_09_009: [ Otherwise MultiTree_AddLeafAtCursor shall walk the parent path, creating the nodes that do not exist, and remember the parent node in cursor. ]*/
+            result = getOrCreatePath(cursor->treeHandle, destinationPath, parentPathLength, &parent);
+            if (result == MULTITREE_OK)
+            {
+                /*Codes_SRS_MULTITREE_09_012: [ MultiTree_AddLeafAtCursor shall keep the parent path in a buffer of the cursor that is reused while the path fits in it, and only grown (doubling) when it does not. ]*/
+                if (parentPathLength + 1 > cursor->parentPathCapacity)
+                {
+                    /*the buffer lives in the arena (so it lives as long as the nodes it leads to), an outgrown buffer is abandoned there*/
+                    size_t capacity = (2 * cursor->parentPathCapacity > parentPathLength + 1) ? 2 * cursor->parentPathCapacity : parentPathLength + 1;
+                    char* parentPath = (char*)arenaAllocate(tree, capacity);
+                    if (parentPath != NULL)
+                    {
+                        cursor->parentPath = parentPath;
+                        cursor->parentPathCapacity = capacity;
+                    }
+                }
+
+                if (parentPathLength + 1 > cursor->parentPathCapacity)
+                {
+                    cursor->parentHandle = NULL;
+                }
+                else
+                {
+                    (void)memcpy(cursor->parentPath, destinationPath, parentPathLength);
+                    cursor->parentPath[parentPathLength] = '\0';
+                    cursor->parentHandle = parent;
+                    cursor->parentPathLength = parentPathLength;
+                    cursor->generation = tree->generation;
+                }
+            }
+        }
+
+        if (result == MULTITREE_OK)
+        {
+            /*Codes_SRS_MULTITREE_09_010: [ MultiTree_AddLeafAtCursor shall return the same results as MultiTree_AddLeaf. ]*/
+            result = addLeafToParent(parent, leafName, value);
+        }
+    }
+    return result;
+}
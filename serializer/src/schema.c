@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "schema.h"
@@ -60,6 +61,19 @@ typedef struct SCHEMA_METHOD_HANDLE_DATA_TAG
     VECTOR_HANDLE methodArguments; /*holds SCHEMA_METHOD_ARGUMENT_HANDLE*/
 } SCHEMA_METHOD_HANDLE_DATA;
 
+/*open addressing hash table from names to elements, built by Schema_Freeze. Names are not copied, they belong to the elements*/
+typedef struct SCHEMA_NAME_INDEX_SLOT_TAG
+{
+    const char* name;
+    void* element;
+} SCHEMA_NAME_INDEX_SLOT;
+
+typedef struct SCHEMA_NAME_INDEX_TAG
+{
+    size_t mask; /*slot count - 1, the slot count is a power of 2 at least twice the number of names*/
+    SCHEMA_NAME_INDEX_SLOT* slots;
+} SCHEMA_NAME_INDEX;
+
 typedef struct MODEL_IN_MODEL_TAG
 {
     pfOnDesiredProperty onDesiredProperty; /*is NULL if not specified or if the model in model is not WITH_DESIRED_PROPERTY*/
@@ -81,6 +95,13 @@ typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
     size_t ActionCount;
     VECTOR_HANDLE models;
     size_t DeviceCount;
+    /*built by Schema_Freeze, dropped when an element of the same kind is added. NULL means "search linearly"*/
+    SCHEMA_NAME_INDEX* PropertyIndex;
+    SCHEMA_NAME_INDEX* ReportedPropertyIndex;
+    SCHEMA_NAME_INDEX* ActionIndex;
+    SCHEMA_NAME_INDEX* MethodIndex;
+    SCHEMA_NAME_INDEX* DesiredPropertyIndex;
+    SCHEMA_NAME_INDEX* ModelIndex;
 } SCHEMA_MODEL_TYPE_HANDLE_DATA;
 
 typedef struct SCHEMA_STRUCT_TYPE_HANDLE_DATA_TAG
@@ -101,6 +122,170 @@ typedef struct SCHEMA_HANDLE_DATA_TAG
 } SCHEMA_HANDLE_DATA;
 
 static VECTOR_HANDLE g_schemas = NULL;
+static SCHEMA_NAME_INDEX* g_namespaceIndex = NULL; /*built by Schema_Freeze, dropped when a schema is created or destroyed*/
+
+/*FNV-1a*/
+static size_t HashName(const char* name)
+{
+    size_t result = (size_t)2166136261u;
+    const unsigned char* c;
+
+    for (c = (const unsigned char*)name; *c != '\0'; c++)
+    {
+        result = (result ^ *c) * (size_t)16777619u;
+    }
+
+    return result;
+}
+
+static SCHEMA_NAME_INDEX* NameIndex_Create(size_t nameCount)
+{
+    SCHEMA_NAME_INDEX* result;
+    size_t slotCount = 4;
+
+    while (slotCount < 2 * nameCount)
+    {
+        slotCount *= 2;
+    }
+
+    if ((result = (SCHEMA_NAME_INDEX*)malloc(sizeof(SCHEMA_NAME_INDEX))) == NULL)
+    {
+        LogError("unable to malloc");
+    }
+    else if ((result->slots = (SCHEMA_NAME_INDEX_SLOT*)malloc(slotCount * sizeof(SCHEMA_NAME_INDEX_SLOT))) == NULL)
+    {
+        LogError("unable to malloc %lu slots", (unsigned long)slotCount);
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        (void)memset(result->slots, 0, slotCount * sizeof(SCHEMA_NAME_INDEX_SLOT));
+        result->mask = slotCount - 1;
+    }
+
+    return result;
+}
+
+static void NameIndex_Destroy(SCHEMA_NAME_INDEX** index)
+{
+    if (*index != NULL)
+    {
+        free((*index)->slots);
+        free(*index);
+        *index = NULL;
+    }
+}
+
+/*never fails: the index has at least twice as many slots as names, and names are unique*/
+static void NameIndex_Add(SCHEMA_NAME_INDEX* index, const char* name, void* element)
+{
+    size_t i = HashName(name) & index->mask;
+
+    while (index->slots[i].name != NULL)
+    {
+        i = (i + 1) & index->mask;
+    }
+
+    index->slots[i].name = name;
+    index->slots[i].element = element;
+}
+
+static void* NameIndex_Find(const SCHEMA_NAME_INDEX* index, const char* name)
+{
+    void* result = NULL;
+    size_t i = HashName(name) & index->mask;
+
+    while (index->slots[i].name != NULL)
+    {
+        if (strcmp(index->slots[i].name, name) == 0)
+        {
+            result = index->slots[i].element;
+            break;
+        }
+        i = (i + 1) & index->mask;
+    }
+
+    return result;
+}
+
+static void DropModelIndexes(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType)
+{
+    NameIndex_Destroy(&modelType->PropertyIndex);
+    NameIndex_Destroy(&modelType->ReportedPropertyIndex);
+    NameIndex_Destroy(&modelType->ActionIndex);
+    NameIndex_Destroy(&modelType->MethodIndex);
+    NameIndex_Destroy(&modelType->DesiredPropertyIndex);
+    NameIndex_Destroy(&modelType->ModelIndex);
+}
+
+/*an index is either complete or NULL, so a failure here only leaves lookups linear*/
+static SCHEMA_RESULT FreezeModel(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType)
+{
+    SCHEMA_RESULT result;
+    size_t nReportedProperties = VECTOR_size(modelType->reportedProperties);
+    size_t nMethods = VECTOR_size(modelType->methods);
+    size_t nDesiredProperties = VECTOR_size(modelType->desiredProperties);
+    size_t nModels = VECTOR_size(modelType->models);
+
+    DropModelIndexes(modelType);
+
+    if (((modelType->PropertyIndex = NameIndex_Create(modelType->PropertyCount)) == NULL) ||
+        ((modelType->ReportedPropertyIndex = NameIndex_Create(nReportedProperties)) == NULL) ||
+        ((modelType->ActionIndex = NameIndex_Create(modelType->ActionCount)) == NULL) ||
+        ((modelType->MethodIndex = NameIndex_Create(nMethods)) == NULL) ||
+        ((modelType->DesiredPropertyIndex = NameIndex_Create(nDesiredProperties)) == NULL) ||
+        ((modelType->ModelIndex = NameIndex_Create(nModels)) == NULL))
+    {
+        LogError("unable to index model %s", modelType->Name);
+        DropModelIndexes(modelType);
+        result = SCHEMA_ERROR;
+    }
+    else
+    {
+        size_t i;
+
+        for (i = 0; i < modelType->PropertyCount; i++)
+        {
+            NameIndex_Add(modelType->PropertyIndex, ((SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i])->PropertyName, modelType->Properties[i]);
+        }
+
+        /*reported property handles are the addresses of the vector elements, see Schema_GetModelReportedPropertyByIndex*/
+        for (i = 0; i < nReportedProperties; i++)
+        {
+            SCHEMA_REPORTED_PROPERTY_HANDLE_DATA** reportedProperty = (SCHEMA_REPORTED_PROPERTY_HANDLE_DATA**)VECTOR_element(modelType->reportedProperties, i);
+            NameIndex_Add(modelType->ReportedPropertyIndex, (*reportedProperty)->reportedPropertyName, reportedProperty);
+        }
+
+        for (i = 0; i < modelType->ActionCount; i++)
+        {
+            NameIndex_Add(modelType->ActionIndex, ((SCHEMA_ACTION_HANDLE_DATA*)modelType->Actions[i])->ActionName, modelType->Actions[i]);
+        }
+
+        for (i = 0; i < nMethods; i++)
+        {
+            SCHEMA_METHOD_HANDLE method = *(SCHEMA_METHOD_HANDLE*)VECTOR_element(modelType->methods, i);
+            NameIndex_Add(modelType->MethodIndex, method->methodName, method);
+        }
+
+        /*like the reported properties, desired properties and models in model are found by the address of their vector element*/
+        for (i = 0; i < nDesiredProperties; i++)
+        {
+            SCHEMA_DESIRED_PROPERTY_HANDLE_DATA** desiredProperty = (SCHEMA_DESIRED_PROPERTY_HANDLE_DATA**)VECTOR_element(modelType->desiredProperties, i);
+            NameIndex_Add(modelType->DesiredPropertyIndex, (*desiredProperty)->desiredPropertyName, desiredProperty);
+        }
+
+        for (i = 0; i < nModels; i++)
+        {
+            MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
+            NameIndex_Add(modelType->ModelIndex, modelInModel->propertyName, modelInModel);
+        }
+
+        result = SCHEMA_OK;
+    }
+
+    return result;
+}
 
 static void DestroyProperty(SCHEMA_PROPERTY_HANDLE propertyHandle)
 {
@@ -243,6 +428,8 @@ static void DestroyModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
     VECTOR_clear(modelType->models);
     VECTOR_destroy(modelType->models);
 
+    DropModelIndexes(modelType);
+
     free(modelType->Actions);
     free(modelType);
 }
@@ -319,6 +506,7 @@ static SCHEMA_RESULT AddModelProperty(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType,
                     {
                         modelType->Properties[modelType->PropertyCount] = (SCHEMA_PROPERTY_HANDLE)newProperty;
                         modelType->PropertyCount++;
+                        NameIndex_Destroy(&modelType->PropertyIndex);
 
                         /* Codes_SRS_SCHEMA_99_012:[On success, Schema_AddModelProperty shall return SCHEMA_OK.] */
                         result = SCHEMA_OK;
@@ -414,12 +602,65 @@ SCHEMA_HANDLE Schema_Create(const char* schemaNamespace, void* metadata)
             result->StructTypes = NULL;
             result->StructTypeCount = 0;
             result->metadata = metadata;
+            NameIndex_Destroy(&g_namespaceIndex);
         }
     }
 
     return (SCHEMA_HANDLE)result;
 }
 
+SCHEMA_RESULT Schema_Freeze(SCHEMA_HANDLE schemaHandle)
+{
+    SCHEMA_RESULT result;
+
+    /*Codes_SRS_SCHEMA_09_001: [ If schemaHandle is NULL, Schema_Freeze shall fail and return SCHEMA_INVALID_ARG. ]*/
+    if (schemaHandle == NULL)
+    {
+        result = SCHEMA_INVALID_ARG;
+        LogError("(result = %s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, result));
+    }
+    else
+    {
+        SCHEMA_HANDLE_DATA* schema = (SCHEMA_HANDLE_DATA*)schemaHandle;
+        size_t i;
+
+        result = SCHEMA_OK;
+
+        /*Codes_SRS_SCHEMA_09_002: [ Schema_Freeze shall index by name the properties, reported properties, desired properties, actions, methods and model properties of every model of the schema. ]*/
+        for (i = 0; i < schema->ModelTypeCount; i++)
+        {
+            if (FreezeModel((SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i]) != SCHEMA_OK)
+            {
+                result = SCHEMA_ERROR;
+            }
+        }
+
+        /*Codes_SRS_SCHEMA_09_003: [ Schema_Freeze shall index by namespace all the active schemas. ]*/
+        NameIndex_Destroy(&g_namespaceIndex);
+        if ((g_namespaceIndex = NameIndex_Create(VECTOR_size(g_schemas))) == NULL)
+        {
+            result = SCHEMA_ERROR;
+        }
+        else
+        {
+            size_t nSchemas = VECTOR_size(g_schemas);
+            for (i = 0; i < nSchemas; i++)
+            {
+                SCHEMA_HANDLE_DATA* activeSchema = *(SCHEMA_HANDLE_DATA**)VECTOR_element(g_schemas, i);
+                NameIndex_Add(g_namespaceIndex, activeSchema->Namespace, activeSchema);
+            }
+        }
+
+        /*Codes_SRS_SCHEMA_09_004: [ If any index cannot be built, Schema_Freeze shall return SCHEMA_ERROR and the lookups it would have served shall keep searching linearly. Otherwise it shall return SCHEMA_OK. ]*/
+        if (result != SCHEMA_OK)
+        {
+            LogError("(result = %s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, result));
+        }
+    }
+
+    return result;
+}
+
 size_t Schema_GetSchemaCount(void)
 {
     /* Codes_SRS_SCHEMA_99_153: [Schema_GetSchemaCount shall return the number of "active" schemas (all schemas created with Schema_Create
@@ -433,7 +674,16 @@ SCHEMA_HANDLE Schema_GetSchemaByNamespace(const char* schemaNamespace)
     SCHEMA_HANDLE result = NULL;
 
     /* Codes_SRS_SCHEMA_99_150: [If the schemaNamespace argument is NULL, Schema_GetSchemaByNamespace shall return NULL.] */
-    if (schemaNamespace != NULL)
+    if (schemaNamespace == NULL)
+    {
+        /*return as is*/
+    }
+    /*Codes_SRS_SCHEMA_09_006: [ Once Schema_Freeze has been called, Schema_GetSchemaByNamespace shall find the schema by a hash of schemaNamespace until a schema is created or destroyed. ]*/
+    else if (g_namespaceIndex != NULL)
+    {
+        result = (SCHEMA_HANDLE)NameIndex_Find(g_namespaceIndex, schemaNamespace);
+    }
+    else
     {
         SCHEMA_HANDLE* handle = (g_schemas==NULL)?NULL:(SCHEMA_HANDLE*)VECTOR_find_if(g_schemas, (PREDICATE_FUNCTION)SchemaNamespacesMatch, schemaNamespace);
         if (handle != NULL)
@@ -490,6 +740,7 @@ void Schema_Destroy(SCHEMA_HANDLE schemaHandle)
         free(schema->StructTypes);
         free((void*)schema->Namespace);
         free(schema);
+        NameIndex_Destroy(&g_namespaceIndex);
 
         schema = (SCHEMA_HANDLE_DATA*)VECTOR_find_if(g_schemas, (PREDICATE_FUNCTION)SchemaHandlesMatch, &schemaHandle);
         if (schema != NULL)
@@ -712,6 +963,12 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_CreateModelType(SCHEMA_HANDLE schemaHandle, cons
                                     modelType->Actions = NULL;
                                     modelType->SchemaHandle = schemaHandle;
                                     modelType->DeviceCount = 0;
+                                    modelType->PropertyIndex = NULL;
+                                    modelType->ReportedPropertyIndex = NULL;
+                                    modelType->ActionIndex = NULL;
+                                    modelType->MethodIndex = NULL;
+                                    modelType->DesiredPropertyIndex = NULL;
+                                    modelType->ModelIndex = NULL;
 
                                     schema->ModelTypes[schema->ModelTypeCount] = modelType;
                                     schema->ModelTypeCount++;
@@ -773,6 +1030,14 @@ static bool reportedPropertyExists(const void* element, const void* value)
     return (strcmp(reportedProperty->reportedPropertyName, value) == 0);
 }
 
+static SCHEMA_REPORTED_PROPERTY_HANDLE* FindModelReportedProperty(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* reportedPropertyName)
+{
+    /*Codes_SRS_SCHEMA_09_005: [ Once Schema_Freeze has been called, Schema_GetModelPropertyByName, Schema_GetModelReportedPropertyByName, Schema_GetModelActionByName and Schema_GetModelMethodByName shall find the element by a hash of its name until an element of the same kind is added to the model. ]*/
+    return (modelType->ReportedPropertyIndex != NULL) ?
+        (SCHEMA_REPORTED_PROPERTY_HANDLE*)NameIndex_Find(modelType->ReportedPropertyIndex, reportedPropertyName) :
+        (SCHEMA_REPORTED_PROPERTY_HANDLE*)VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyName);
+}
+
 SCHEMA_RESULT Schema_AddModelReportedProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* reportedPropertyName, const char* reportedPropertyType)
 {
     SCHEMA_RESULT result;
@@ -840,6 +1105,7 @@ SCHEMA_RESULT Schema_AddModelReportedProperty(SCHEMA_MODEL_TYPE_HANDLE modelType
                         else
                         {
                             /*Codes_SRS_SCHEMA_02_007: [ Otherwise Schema_AddModelReportedProperty shall succeed and return SCHEMA_OK. ]*/
+                            NameIndex_Destroy(&modelType->ReportedPropertyIndex);
                             result = SCHEMA_OK;
                         }
                     }
@@ -919,6 +1185,7 @@ SCHEMA_ACTION_HANDLE Schema_CreateModelAction(SCHEMA_MODEL_TYPE_HANDLE modelType
 
                         modelType->Actions[modelType->ActionCount] = newAction;
                         modelType->ActionCount++;
+                        NameIndex_Destroy(&modelType->ActionIndex);
                         result = (SCHEMA_ACTION_HANDLE)(newAction);
                     }
 
@@ -1024,7 +1291,7 @@ SCHEMA_METHOD_HANDLE Schema_CreateModelMethod(SCHEMA_MODEL_TYPE_HANDLE modelType
                         else
                         {
                             /*Codes_SRS_SCHEMA_02_104: [ Otherwise, Schema_CreateModelMethod shall succeed and return a non-NULL SCHEMA_METHOD_HANDLE. ]*/
-                            /*return as is*/
+                            NameIndex_Destroy(&modelTypeHandle->MethodIndex);
                         }
                     }
                 }
@@ -1230,21 +1497,18 @@ SCHEMA_RESULT Schema_AddModelMethodArgument(SCHEMA_METHOD_HANDLE methodHandle, c
     return result;
 }
 
-SCHEMA_PROPERTY_HANDLE Schema_GetModelPropertyByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* propertyName)
+static SCHEMA_PROPERTY_HANDLE FindModelProperty(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* propertyName)
 {
     SCHEMA_PROPERTY_HANDLE result;
 
-    /* Codes_SRS_SCHEMA_99_038:[Schema_GetModelPropertyByName shall return NULL if unable to find a matching property or if any of the arguments are NULL.] */
-    if ((modelTypeHandle == NULL) ||
-        (propertyName == NULL))
+    /*Codes_SRS_SCHEMA_09_005: [ Once Schema_Freeze has been called, Schema_GetModelPropertyByName, Schema_GetModelReportedPropertyByName, Schema_GetModelActionByName and Schema_GetModelMethodByName shall find the element by a hash of its name until an element of the same kind is added to the model. ]*/
+    if (modelType->PropertyIndex != NULL)
     {
-        result = NULL;
-        LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_INVALID_ARG));
+        result = (SCHEMA_PROPERTY_HANDLE)NameIndex_Find(modelType->PropertyIndex, propertyName);
     }
     else
     {
         size_t i;
-        SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
         /* Codes_SRS_SCHEMA_99_036:[Schema_GetModelPropertyByName shall return a non-NULL SCHEMA_PROPERTY_HANDLE corresponding to the model type identified by modelTypeHandle and matching the propertyName argument value.] */
         for (i = 0; i < modelType->PropertyCount; i++)
@@ -1256,16 +1520,31 @@ SCHEMA_PROPERTY_HANDLE Schema_GetModelPropertyByName(SCHEMA_MODEL_TYPE_HANDLE mo
             }
         }
 
-        if (i == modelType->PropertyCount)
-        {
-            /* Codes_SRS_SCHEMA_99_038:[Schema_GetModelPropertyByName shall return NULL if unable to find a matching property or if any of the arguments are NULL.] */
-            result = NULL;
-            LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
-        }
-        else
-        {
-            result = (SCHEMA_PROPERTY_HANDLE)(modelType->Properties[i]);
-        }
+        result = (i == modelType->PropertyCount) ? NULL : (SCHEMA_PROPERTY_HANDLE)(modelType->Properties[i]);
+    }
+
+    return result;
+}
+
+SCHEMA_PROPERTY_HANDLE Schema_GetModelPropertyByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* propertyName)
+{
+    SCHEMA_PROPERTY_HANDLE result;
+
+    /* Codes_SRS_SCHEMA_99_038:[Schema_GetModelPropertyByName shall return NULL if unable to find a matching property or if any of the arguments are NULL.] */
+    if ((modelTypeHandle == NULL) ||
+        (propertyName == NULL))
+    {
+        result = NULL;
+        LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_INVALID_ARG));
+    }
+    else if ((result = FindModelProperty((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, propertyName)) == NULL)
+    {
+        /* Codes_SRS_SCHEMA_99_038:[Schema_GetModelPropertyByName shall return NULL if unable to find a matching property or if any of the arguments are NULL.] */
+        LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
+    }
+    else
+    {
+        /*return as is*/
     }
 
     return result;
@@ -1337,7 +1616,7 @@ SCHEMA_REPORTED_PROPERTY_HANDLE Schema_GetModelReportedPropertyByName(SCHEMA_MOD
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_02_013: [ If reported property by the name reportedPropertyName exists then Schema_GetModelReportedPropertyByName shall succeed and return a non-NULL value. ]*/
         /*Codes_SRS_SCHEMA_02_014: [ Otherwise Schema_GetModelReportedPropertyByName shall fail and return NULL. ]*/
-        if((result = VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyName))==NULL)
+        if ((result = (SCHEMA_REPORTED_PROPERTY_HANDLE)FindModelReportedProperty(modelType, reportedPropertyName)) == NULL)
         {
             LogError("a reported property with name \"%s\" does not exist", reportedPropertyName);
         }
@@ -1398,21 +1677,18 @@ SCHEMA_PROPERTY_HANDLE Schema_GetModelPropertyByIndex(SCHEMA_MODEL_TYPE_HANDLE m
     return result;
 }
 
-SCHEMA_ACTION_HANDLE Schema_GetModelActionByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* actionName)
+static SCHEMA_ACTION_HANDLE FindModelAction(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* actionName)
 {
     SCHEMA_ACTION_HANDLE result;
 
-    /* Codes_SRS_SCHEMA_99_041:[Schema_GetModelActionByName shall return NULL if unable to find a matching action, if any of the arguments are NULL.] */
-    if ((modelTypeHandle == NULL) ||
-        (actionName == NULL))
+    /*Codes_SRS_SCHEMA_09_005: [ Once Schema_Freeze has been called, Schema_GetModelPropertyByName, Schema_GetModelReportedPropertyByName, Schema_GetModelActionByName and Schema_GetModelMethodByName shall find the element by a hash of its name until an element of the same kind is added to the model. ]*/
+    if (modelType->ActionIndex != NULL)
     {
-        result = NULL;
-        LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_INVALID_ARG));
+        result = (SCHEMA_ACTION_HANDLE)NameIndex_Find(modelType->ActionIndex, actionName);
     }
     else
     {
         size_t i;
-        SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
         /* Codes_SRS_SCHEMA_99_040:[Schema_GetModelActionByName shall return a non-NULL SCHEMA_ACTION_HANDLE corresponding to the model type identified by modelTypeHandle and matching the actionName argument value.] */
         for (i = 0; i < modelType->ActionCount; i++)
@@ -1424,16 +1700,31 @@ SCHEMA_ACTION_HANDLE Schema_GetModelActionByName(SCHEMA_MODEL_TYPE_HANDLE modelT
             }
         }
 
-        if (i == modelType->ActionCount)
-        {
-            /* Codes_SRS_SCHEMA_99_041:[Schema_GetModelActionByName shall return NULL if unable to find a matching action, if any of the arguments are NULL.] */
-            result = NULL;
-            LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
-        }
-        else
-        {
-            result = modelType->Actions[i];
-        }
+        result = (i == modelType->ActionCount) ? NULL : modelType->Actions[i];
+    }
+
+    return result;
+}
+
+SCHEMA_ACTION_HANDLE Schema_GetModelActionByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* actionName)
+{
+    SCHEMA_ACTION_HANDLE result;
+
+    /* Codes_SRS_SCHEMA_99_041:[Schema_GetModelActionByName shall return NULL if unable to find a matching action, if any of the arguments are NULL.] */
+    if ((modelTypeHandle == NULL) ||
+        (actionName == NULL))
+    {
+        result = NULL;
+        LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_INVALID_ARG));
+    }
+    else if ((result = FindModelAction((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle, actionName)) == NULL)
+    {
+        /* Codes_SRS_SCHEMA_99_041:[Schema_GetModelActionByName shall return NULL if unable to find a matching action, if any of the arguments are NULL.] */
+        LogError("(Error code:%s)", MU_ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
+    }
+    else
+    {
+        /*return as is*/
     }
 
     return result;
@@ -1461,17 +1752,22 @@ SCHEMA_METHOD_HANDLE Schema_GetModelMethodByName(SCHEMA_MODEL_TYPE_HANDLE modelT
     }
     else
     {
-        /*Codes_SRS_SCHEMA_02_117: [ If a method with the name methodName exists then Schema_GetModelMethodByName shall succeed and returns its handle. ]*/
-        SCHEMA_METHOD_HANDLE* found = VECTOR_find_if(modelTypeHandle->methods, matchModelMethod, methodName);
-        if (found == NULL)
+        /*Codes_SRS_SCHEMA_09_005: [ Once Schema_Freeze has been called, Schema_GetModelPropertyByName, Schema_GetModelReportedPropertyByName, Schema_GetModelActionByName and Schema_GetModelMethodByName shall find the element by a hash of its name until an element of the same kind is added to the model. ]*/
+        if (modelTypeHandle->MethodIndex != NULL)
         {
-            /*Codes_SRS_SCHEMA_02_118: [ Otherwise, Schema_GetModelMethodByName shall fail and return NULL. ]*/
-            LogError("no such method by name = %s", methodName);
-            result = NULL;
+            result = (SCHEMA_METHOD_HANDLE)NameIndex_Find(modelTypeHandle->MethodIndex, methodName);
         }
         else
         {
-            result = *found;
+            /*Codes_SRS_SCHEMA_02_117: [ If a method with the name methodName exists then Schema_GetModelMethodByName shall succeed and returns its handle. ]*/
+            SCHEMA_METHOD_HANDLE* found = VECTOR_find_if(modelTypeHandle->methods, matchModelMethod, methodName);
+            result = (found == NULL) ? NULL : *found;
+        }
+
+        if (result == NULL)
+        {
+            /*Codes_SRS_SCHEMA_02_118: [ Otherwise, Schema_GetModelMethodByName shall fail and return NULL. ]*/
+            LogError("no such method by name = %s", methodName);
         }
     }
 
@@ -2332,7 +2628,7 @@ SCHEMA_RESULT Schema_AddModelModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, con
         else
         {
             /*Codes_SRS_SCHEMA_99_164: [If the function succeeds, then the return value shall be SCHEMA_OK.]*/
-
+            NameIndex_Destroy(&parentModel->ModelIndex);
             result = SCHEMA_OK;
         }
     }
@@ -2370,6 +2666,14 @@ static bool matchModelName(const void* element, const void* value)
     return (strcmp(decodedElement->propertyName, name) == 0);
 }
 
+static MODEL_IN_MODEL* FindModelInModel(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* propertyName)
+{
+    /*Codes_SRS_SCHEMA_09_007: [ Once Schema_Freeze has been called, Schema_GetModelDesiredPropertyByName, Schema_GetModelModelByName, Schema_GetModelModelByName_Offset, Schema_GetModelModelByName_OnDesiredProperty and Schema_GetModelElementByName shall find the element by a hash of its name until an element of the same kind is added to the model. ]*/
+    return (modelType->ModelIndex != NULL) ?
+        (MODEL_IN_MODEL*)NameIndex_Find(modelType->ModelIndex, propertyName) :
+        (MODEL_IN_MODEL*)VECTOR_find_if(modelType->models, matchModelName, propertyName);
+}
+
 SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* propertyName)
 {
     SCHEMA_MODEL_TYPE_HANDLE result;
@@ -2387,7 +2691,7 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE mod
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_99_170: [Schema_GetModelModelByName shall return a handle to the model identified by the property with the name propertyName in the model identified by the handle modelTypeHandle.]*/
         /*Codes_SRS_SCHEMA_99_171: [If Schema_GetModelModelByName is unable to provide the handle it shall return NULL.]*/
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        void* temp = FindModelInModel(model, propertyName);
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2419,7 +2723,7 @@ size_t Schema_GetModelModelByName_Offset(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandl
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_02_056: [ If propertyName is not a model then Schema_GetModelModelByName_Offset shall fail and return 0. ]*/
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        void* temp = FindModelInModel(model, propertyName);
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2450,7 +2754,7 @@ pfOnDesiredProperty Schema_GetModelModelByName_OnDesiredProperty(SCHEMA_MODEL_TY
     else
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        void* temp = FindModelInModel(model, propertyName);
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2732,6 +3036,14 @@ static bool desiredPropertyExists(const void* element, const void* value)
     return (strcmp(desiredProperty->desiredPropertyName, value) == 0);
 }
 
+static SCHEMA_DESIRED_PROPERTY_HANDLE* FindModelDesiredProperty(const SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* desiredPropertyName)
+{
+    /*Codes_SRS_SCHEMA_09_007: [ Once Schema_Freeze has been called, Schema_GetModelDesiredPropertyByName, Schema_GetModelModelByName, Schema_GetModelModelByName_Offset, Schema_GetModelModelByName_OnDesiredProperty and Schema_GetModelElementByName shall find the element by a hash of its name until an element of the same kind is added to the model. ]*/
+    return (modelType->DesiredPropertyIndex != NULL) ?
+        (SCHEMA_DESIRED_PROPERTY_HANDLE*)NameIndex_Find(modelType->DesiredPropertyIndex, desiredPropertyName) :
+        (SCHEMA_DESIRED_PROPERTY_HANDLE*)VECTOR_find_if(modelType->desiredProperties, desiredPropertyExists, desiredPropertyName);
+}
+
 SCHEMA_RESULT Schema_AddModelDesiredProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* desiredPropertyName, const char* desiredPropertyType, pfDesiredPropertyFromAGENT_DATA_TYPE desiredPropertyFromAGENT_DATA_TYPE, pfDesiredPropertyInitialize desiredPropertyInitialize, pfDesiredPropertyDeinitialize desiredPropertyDeinitialize, size_t offset, pfOnDesiredProperty onDesiredProperty)
 {
     SCHEMA_RESULT result;
@@ -2811,6 +3123,7 @@ SCHEMA_RESULT Schema_AddModelDesiredProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
                             desiredProperty->desiredPropertDeinitialize = desiredPropertyDeinitialize;
                             desiredProperty->onDesiredProperty = onDesiredProperty; /*NULL is a perfectly fine value*/
                             desiredProperty->offset = offset;
+                            NameIndex_Destroy(&handleData->DesiredPropertyIndex);
                             result = SCHEMA_OK;
                         }
                     }
@@ -2863,7 +3176,7 @@ SCHEMA_DESIRED_PROPERTY_HANDLE Schema_GetModelDesiredPropertyByName(SCHEMA_MODEL
         /*Codes_SRS_SCHEMA_02_036: [ If a desired property having the name desiredPropertyName exists then Schema_GetModelDesiredPropertyByName shall succeed and return a non-NULL value. ]*/
         /*Codes_SRS_SCHEMA_02_037: [ Otherwise, Schema_GetModelDesiredPropertyByName shall fail and return NULL. ]*/
         SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        SCHEMA_DESIRED_PROPERTY_HANDLE* temp = VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, desiredPropertyName);
+        SCHEMA_DESIRED_PROPERTY_HANDLE* temp = FindModelDesiredProperty(handleData, desiredPropertyName);
         if (temp == NULL)
         {
             LogError("no such desired property by name %s", desiredPropertyName);
@@ -3059,12 +3372,6 @@ size_t Schema_GetModelDesiredProperty_offset(SCHEMA_DESIRED_PROPERTY_HANDLE desi
     return result;
 }
 
-static bool modelInModelExists(const void* element, const void* value)
-{
-    MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)element;
-    return (strcmp(modelInModel->propertyName, value) == 0);
-}
-
 SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* elementName)
 {
     SCHEMA_MODEL_ELEMENT result;
@@ -3082,7 +3389,7 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
-        SCHEMA_DESIRED_PROPERTY_HANDLE* desiredPropertyHandle = VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, elementName);
+        SCHEMA_DESIRED_PROPERTY_HANDLE* desiredPropertyHandle = FindModelDesiredProperty(handleData, elementName);
         if (desiredPropertyHandle != NULL)
         {
             /*Codes_SRS_SCHEMA_02_080: [ If elementName is a desired property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_DESIRED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.desiredPropertyHandle to the handle of the desired property. ]*/
@@ -3091,22 +3398,8 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
         }
         else
         {
-            size_t nProcessedProperties = 0;
-            SCHEMA_PROPERTY_HANDLE_DATA* property = NULL;
-            for (size_t i = 0; i < handleData->PropertyCount;i++)
-            {
-                property = (SCHEMA_PROPERTY_HANDLE_DATA*)(handleData->Properties[i]);
-                if (strcmp(property->PropertyName, elementName) == 0)
-                {
-                    i = handleData->PropertyCount; /*found it*/
-                }
-                else
-                {
-                    nProcessedProperties++;
-                }
-            }
-
-            if (nProcessedProperties < handleData->PropertyCount)
+            SCHEMA_PROPERTY_HANDLE property = FindModelProperty(handleData, elementName);
+            if (property != NULL)
             {
                 /*Codes_SRS_SCHEMA_02_078: [ If elementName is a property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.propertyHandle to the handle of the property. ]*/
                 result.elementType = SCHEMA_PROPERTY;
@@ -3115,7 +3408,7 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
             else
             {
 
-                SCHEMA_REPORTED_PROPERTY_HANDLE* reportedPropertyHandle = VECTOR_find_if(handleData->reportedProperties, reportedPropertyExists, elementName);
+                SCHEMA_REPORTED_PROPERTY_HANDLE* reportedPropertyHandle = FindModelReportedProperty(handleData, elementName);
                 if (reportedPropertyHandle != NULL)
                 {
                     /*Codes_SRS_SCHEMA_02_079: [ If elementName is a reported property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_REPORTED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.reportedPropertyHandle to the handle of the reported property. ]*/
@@ -3125,30 +3418,16 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
                 else
                 {
 
-                    size_t nProcessedActions = 0;
-                    SCHEMA_ACTION_HANDLE_DATA* actionHandleData = NULL;
-                    for (size_t i = 0;i < handleData->ActionCount; i++)
-                    {
-                        actionHandleData = (SCHEMA_ACTION_HANDLE_DATA*)(handleData->Actions[i]);
-                        if (strcmp(actionHandleData->ActionName, elementName) == 0)
-                        {
-                            i = handleData->ActionCount; /*get out quickly*/
-                        }
-                        else
-                        {
-                            nProcessedActions++;
-                        }
-                    }
-
-                    if (nProcessedActions < handleData->ActionCount)
+                    SCHEMA_ACTION_HANDLE actionHandle = FindModelAction(handleData, elementName);
+                    if (actionHandle != NULL)
                     {
                         /*Codes_SRS_SCHEMA_02_081: [ If elementName is a model action then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_ACTION and SCHEMA_MODEL_ELEMENT.elementHandle.actionHandle to the handle of the action. ]*/
                         result.elementType = SCHEMA_MODEL_ACTION;
-                        result.elementHandle.actionHandle = actionHandleData;
+                        result.elementHandle.actionHandle = actionHandle;
                     }
                     else
                     {
-                        MODEL_IN_MODEL* modelInModel = VECTOR_find_if(handleData->models, modelInModelExists, elementName);
+                        MODEL_IN_MODEL* modelInModel = FindModelInModel(handleData, elementName);
                         if (modelInModel != NULL)
                         {
                             /*Codes_SRS_SCHEMA_02_082: [ If elementName is a model in model then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_IN_MODEL and SCHEMA_MODEL_ELEMENT.elementHandle.modelHandle to the handle of the model. ]*/
@@ -84,6 +84,41 @@ SERIALIZER_RESULT serializer_setconfig(SERIALIZER_CONFIG which, void* value)
         DataPublisher_SetMaxBufferSize(*(size_t*)value);
         result = SERIALIZER_OK;
     }
+    /* Codes_SRS_SCHEMALIB_09_001: [ When the which argument is SerializeDirectJsonEncoding, serializer_setconfig shall invoke CodeFirst_SetDirectJsonEncoding with the dereferenced value argument (a bool), and shall return SERIALIZER_OK. ] */
+    else if (which == SerializeDirectJsonEncoding)
+    {
+        /* Codes_SRS_SCHEMALIB_09_003: [ If the value is true and the encoder returned by DataMarshaller_GetEncoder is not the JSON encoder, serializer_setconfig shall return SERIALIZER_INVALID_ARG. ] */
+        if (*(bool*)value && (DataMarshaller_GetEncoder() != DataMarshaller_GetJSONEncoder()))
+        {
+            LogError("SerializeDirectJsonEncoding needs the JSON encoder");
+            result = SERIALIZER_INVALID_ARG;
+        }
+        else
+        {
+            CodeFirst_SetDirectJsonEncoding(*(bool*)value);
+            result = SERIALIZER_OK;
+        }
+    }
+    /* Codes_SRS_SCHEMALIB_09_002: [ When the which argument is SerializeEncoder, serializer_setconfig shall invoke DataMarshaller_SetEncoder with the value argument (a const DATA_MARSHALLER_ENCODER*), and shall return SERIALIZER_OK. ] */
+    else if (which == SerializeEncoder)
+    {
+        const DATA_MARSHALLER_ENCODER* encoder = (const DATA_MARSHALLER_ENCODER*)value;
+        if (encoder->encode == NULL)
+        {
+            LogError("the encoder has no encode function");
+            result = SERIALIZER_INVALID_ARG;
+        }
+        else
+        {
+            /* Codes_SRS_SCHEMALIB_09_004: [ When the encoder is not the JSON encoder, serializer_setconfig shall also turn off the direct JSON path by calling CodeFirst_SetDirectJsonEncoding with false. ] */
+            if (encoder != DataMarshaller_GetJSONEncoder())
+            {
+                CodeFirst_SetDirectJsonEncoding(false);
+            }
+            DataMarshaller_SetEncoder(encoder);
+            result = SERIALIZER_OK;
+        }
+    }
     /* Codes_SRS_SCHEMALIB_99_138:[ If the which argument is not one of the declared members of the SERIALIZER_CONFIG enum, serializer_setconfig shall return SERIALIZER_INVALID_ARG.] */
     else
     {
@@ -31,6 +31,14 @@ AGENT_DATA_TYPES_RESULT Create_AGENT_DATA_TYPE_from_EDM_DATE_TIME_OFFSET(AGENT_D
 AGENT_DATA_TYPES_RESULT Create_AGENT_DATA_TYPE_from_EDM_GUID(AGENT_DATA_TYPE*, EDM_GUID) { return AGENT_DATA_TYPES_ERROR; }
 AGENT_DATA_TYPES_RESULT Create_AGENT_DATA_TYPE_from_EDM_BINARY(AGENT_DATA_TYPE*, EDM_BINARY) { return AGENT_DATA_TYPES_ERROR; }
 AGENT_DATA_TYPES_RESULT Create_AGENT_DATA_TYPE_from_FLOAT(AGENT_DATA_TYPE*, float) { return AGENT_DATA_TYPES_ERROR; }
+AGENT_DATA_TYPES_RESULT AgentDataTypes_Int64_ToJSON(JSON_ENCODER_BUFFER*, int64_t) { return AGENT_DATA_TYPES_ERROR; }
+AGENT_DATA_TYPES_RESULT AgentDataTypes_Boolean_ToJSON(JSON_ENCODER_BUFFER*, int) { return AGENT_DATA_TYPES_ERROR; }
+AGENT_DATA_TYPES_RESULT AgentDataTypes_Double_ToJSON(JSON_ENCODER_BUFFER*, double) { return AGENT_DATA_TYPES_ERROR; }
+AGENT_DATA_TYPES_RESULT AgentDataTypes_Float_ToJSON(JSON_ENCODER_BUFFER*, float) { return AGENT_DATA_TYPES_ERROR; }
+AGENT_DATA_TYPES_RESULT AgentDataTypes_Charz_ToJSON(JSON_ENCODER_BUFFER*, const char*) { return AGENT_DATA_TYPES_ERROR; }
+AGENT_DATA_TYPES_RESULT AgentDataTypes_CharzNoQuotes_ToJSON(JSON_ENCODER_BUFFER*, const char*) { return AGENT_DATA_TYPES_ERROR; }
+AGENT_DATA_TYPES_RESULT AgentDataTypes_ToJSON(JSON_ENCODER_BUFFER*, const AGENT_DATA_TYPE*) { return AGENT_DATA_TYPES_ERROR; }
+JSON_ENCODER_RESULT JSONEncoder_Buffer_Append(JSON_ENCODER_BUFFER*, const char*, size_t) { return JSON_ENCODER_ERROR; }
 
 TRANSACTION_HANDLE Device_StartTransaction(DEVICE_HANDLE) { return NULL; }
 DEVICE_RESULT Device_PublishTransacted(TRANSACTION_HANDLE, const char*, const AGENT_DATA_TYPE*) { return DEVICE_ERROR; }
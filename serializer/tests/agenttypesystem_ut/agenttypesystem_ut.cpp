@@ -6,6 +6,7 @@
 #include <cstddef>
 #include <climits>
 #include <cfloat>
+#include <string>
 
 #define CTEST_USE_STDINT
 
@@ -204,6 +205,43 @@ public:
     MOCK_METHOD_END(JSON_ENCODER_RESULT, JSON_ENCODER_OK)
     MOCK_STATIC_METHOD_2(, JSON_ENCODER_TOSTRING_RESULT, JSONEncoder_CharPtr_ToString, STRING_HANDLE, destination, const void*, value)
     MOCK_METHOD_END(JSON_ENCODER_TOSTRING_RESULT, JSON_ENCODER_TOSTRING_OK)
+    MOCK_STATIC_METHOD_2(, JSON_ENCODER_RESULT, JSONEncoder_Buffer_Reserve, JSON_ENCODER_BUFFER*, buffer, size_t, additionalLength)
+        JSON_ENCODER_RESULT result2 = JSON_ENCODER_OK;
+        if (buffer->length + additionalLength > buffer->capacity)
+        {
+            char* newBuffer = (char*)realloc(buffer->buffer, buffer->length + additionalLength);
+            if (newBuffer == NULL)
+            {
+                result2 = JSON_ENCODER_ERROR;
+            }
+            else
+            {
+                buffer->buffer = newBuffer;
+                buffer->capacity = buffer->length + additionalLength;
+            }
+        }
+    MOCK_METHOD_END(JSON_ENCODER_RESULT, result2)
+    MOCK_STATIC_METHOD_3(, JSON_ENCODER_RESULT, JSONEncoder_Buffer_Append, JSON_ENCODER_BUFFER*, buffer, const char*, source, size_t, sourceLength)
+        JSON_ENCODER_RESULT result2 = JSON_ENCODER_OK;
+        if (buffer->length + sourceLength > buffer->capacity)
+        {
+            char* newBuffer = (char*)realloc(buffer->buffer, buffer->length + sourceLength);
+            if (newBuffer == NULL)
+            {
+                result2 = JSON_ENCODER_ERROR;
+            }
+            else
+            {
+                buffer->buffer = newBuffer;
+                buffer->capacity = buffer->length + sourceLength;
+            }
+        }
+        if (result2 == JSON_ENCODER_OK)
+        {
+            (void)memcpy(buffer->buffer + buffer->length, source, sourceLength);
+            buffer->length += sourceLength;
+        }
+    MOCK_METHOD_END(JSON_ENCODER_RESULT, result2)
 };
 
 DECLARE_GLOBAL_MOCK_METHOD_1(CMocksForAgentTypeSytem, , struct tm*, get_gmtime, time_t*, currentTime);
@@ -213,6 +251,8 @@ DECLARE_GLOBAL_MOCK_METHOD_3(CMocksForAgentTypeSytem, , MULTITREE_RESULT, MultiT
 
 DECLARE_GLOBAL_MOCK_METHOD_3(CMocksForAgentTypeSytem, , JSON_ENCODER_RESULT, JSONEncoder_EncodeTree, MULTITREE_HANDLE, treeHandle, STRING_HANDLE, buffer, JSON_ENCODER_TOSTRING_FUNC, toStringFunc);
 DECLARE_GLOBAL_MOCK_METHOD_2(CMocksForAgentTypeSytem, , JSON_ENCODER_TOSTRING_RESULT, JSONEncoder_CharPtr_ToString, STRING_HANDLE, destination, const void*, value);
+DECLARE_GLOBAL_MOCK_METHOD_2(CMocksForAgentTypeSytem, , JSON_ENCODER_RESULT, JSONEncoder_Buffer_Reserve, JSON_ENCODER_BUFFER*, buffer, size_t, additionalLength);
+DECLARE_GLOBAL_MOCK_METHOD_3(CMocksForAgentTypeSytem, , JSON_ENCODER_RESULT, JSONEncoder_Buffer_Append, JSON_ENCODER_BUFFER*, buffer, const char*, source, size_t, sourceLength);
                              
 DECLARE_GLOBAL_MOCK_METHOD_0(CMocksForAgentTypeSytem, , STRING_HANDLE, STRING_new);
 DECLARE_GLOBAL_MOCK_METHOD_1(CMocksForAgentTypeSytem, , void, STRING_delete, STRING_HANDLE, s);
@@ -4269,7 +4309,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             Destroy_AGENT_DATA_TYPE(&ag);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_SignallingNan_succeeds)
         {
             ///arrange
@@ -4282,7 +4322,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "NaN", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_SignallingNan_insuficient_buffer_fails)
         {
             ///arrange
@@ -4295,7 +4335,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_QuietNan_succeeds)
         {
             ///arrange
@@ -4308,7 +4348,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "NaN", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_QuietNan_insuficient_buffer_fails)
         {
             ///arrange
@@ -4321,7 +4361,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_minusInf_succeeds)
         {
             ///arrange
@@ -4334,7 +4374,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "-INF", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_minusInf_insuficient_buffer_fails)
         {
             ///arrange
@@ -4348,7 +4388,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_plusInf_succeeds)
         {
             ///arrange
@@ -4361,7 +4401,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "INF", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_with_plusInf_insuficient_buffer_fails)
         {
             ///arrange
@@ -4374,7 +4414,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_succeeds_1)
         {
             ///arrange
@@ -4387,7 +4427,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(double, TEST_DOUBLE_1, atof(STRING_c_str(global_bufferTemp)));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
         TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_succeeds_2)
         {
             ///arrange
@@ -4496,7 +4536,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             Destroy_AGENT_DATA_TYPE(&ag);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_SignallingNan_succeeds)
         {
             ///arrange
@@ -4509,7 +4549,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "NaN", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_SignallingNan_insuficient_buffer_fails)
         {
             ///arrange
@@ -4523,7 +4563,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_QuietNan_succeeds)
         {
             ///arrange
@@ -4536,7 +4576,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "NaN", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_QuietNan_insuficient_buffer_fails)
         {
             ///arrange
@@ -4551,7 +4591,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
 
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_minusInf_succeeds)
         {
             ///arrange
@@ -4564,7 +4604,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "-INF", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_minusInf_insuficient_buffer_fails)
         {
             ///arrange
@@ -4580,7 +4620,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
 
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_plusInf_succeeds)
         {
             ///arrange
@@ -4593,7 +4633,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(char_ptr, "INF", STRING_c_str(global_bufferTemp));
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_with_plusInf_insuficient_buffer_fails)
         {
             ///arrange
@@ -4607,7 +4647,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_succeeds_1)
         {
             ///arrange
@@ -4621,7 +4661,7 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
 
         }
 
-        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representatiuon shall use FLT_DIG.]*/
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
         TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_succeeds_2)
         {
             ///arrange
@@ -4634,6 +4674,92 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(float, TEST_FLOAT_2, (float)atof(STRING_c_str(global_bufferTemp)));
 
         }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall be the shortest decimal that reads back as the same double*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_produces_the_shortest_representation)
+        {
+            static const struct
+            {
+                double value;
+                const char* expected;
+            } values[] =
+            {
+                { 0.0, "0.0" },
+                { -0.0, "-0.0" },
+                { 3.0, "3.0" },
+                { 1.5, "1.5" },
+                { -3.25, "-3.25" },
+                { 0.1, "0.1" },
+                { 0.001, "0.001" },
+                { 1e-7, "1e-7" },
+                { 1.25e-7, "1.25e-7" },
+                { 1e21, "1e21" },
+                { 123456789012345678.0, "123456789012345680.0" },
+                { 1e300, "1e300" },
+                { 5e-324, "5e-324" },
+                { 1.7976931348623157e308, "1.7976931348623157e308" },
+                { 328647.47547929373980211, "328647.47547929373" }
+            };
+            size_t i;
+
+            for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            {
+                ///arrange
+                AGENT_DATA_TYPE ag;
+                STRING_HANDLE text = BASEIMPLEMENTATION::STRING_new();
+                (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, values[i].value);
+
+                ///act
+                auto res = AgentDataTypes_ToString(text, &ag);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+                ASSERT_ARE_EQUAL(char_ptr, values[i].expected, BASEIMPLEMENTATION::STRING_c_str(text));
+
+                ///cleanup
+                BASEIMPLEMENTATION::STRING_delete(text);
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_027:[ EDM_SINGLE: singleValue = doubleValue ; IEEE 754 binary32 floating-point number (6-9 decimal digits). The representation shall be the shortest decimal that reads back as the same float.]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_produces_the_shortest_representation)
+        {
+            static const struct
+            {
+                float value;
+                const char* expected;
+            } values[] =
+            {
+                { 0.0f, "0.0" },
+                { 42.5f, "42.5" },
+                { 42.589123f, "42.589123" },
+                { 0.1f, "0.1" },
+                { 1013.25f, "1013.25" },
+                { 3.4028235e38f, "3.4028235e38" },
+                { 1e-45f, "1e-45" }
+            };
+            size_t i;
+
+            for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            {
+                ///arrange
+                AGENT_DATA_TYPE ag;
+                STRING_HANDLE text = BASEIMPLEMENTATION::STRING_new();
+                (void)Create_AGENT_DATA_TYPE_from_FLOAT(&ag, values[i].value);
+
+                ///act
+                auto res = AgentDataTypes_ToString(text, &ag);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+                ASSERT_ARE_EQUAL(char_ptr, values[i].expected, BASEIMPLEMENTATION::STRING_c_str(text));
+
+                ///cleanup
+                BASEIMPLEMENTATION::STRING_delete(text);
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
 #endif
 
         /*Tests_SRS_AGENT_TYPE_SYSTEM_99_043:[ Creates an AGENT_DATA_TYPE containing an EDM_INT16 from int16_t]*/
@@ -13726,4 +13852,214 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
         }
 
 
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_001: [ If destination is NULL, the AgentDataTypes_..._ToJSON functions shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+        TEST_FUNCTION(AgentDataTypes_Int64_ToJSON_with_NULL_destination_fails)
+        {
+            ///act
+            auto res = AgentDataTypes_Int64_ToJSON(NULL, 42);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, res);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_002: [ AgentDataTypes_Int64_ToJSON shall append v in decimal, with a leading "-" for negative values and without leading zeroes, which is the format AgentDataTypes_ToString uses for EDM_BYTE, EDM_SBYTE, EDM_INT16, EDM_INT32 and EDM_INT64. ]*/
+        TEST_FUNCTION(AgentDataTypes_Int64_ToJSON_produces_the_same_text_as_AgentDataTypes_ToString)
+        {
+            static const int64_t values[] = { 0, 1, -1, 10, -10, INT64_MAX, INT64_MIN };
+            size_t i;
+
+            for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            {
+                ///arrange
+                AGENT_DATA_TYPE ag;
+                JSON_ENCODER_BUFFER buffer = { NULL, 0, 0 };
+                STRING_HANDLE expected = BASEIMPLEMENTATION::STRING_new();
+                (void)Create_AGENT_DATA_TYPE_from_SINT64(&ag, values[i]);
+                (void)AgentDataTypes_ToString(expected, &ag);
+
+                ///act
+                auto res = AgentDataTypes_Int64_ToJSON(&buffer, values[i]);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+                ASSERT_ARE_EQUAL(char_ptr, BASEIMPLEMENTATION::STRING_c_str(expected), std::string(buffer.buffer, buffer.length).c_str());
+
+                ///cleanup
+                free(buffer.buffer);
+                BASEIMPLEMENTATION::STRING_delete(expected);
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_003: [ AgentDataTypes_Boolean_ToJSON shall append true if v is different than 0 and false otherwise. ]*/
+        TEST_FUNCTION(AgentDataTypes_Boolean_ToJSON_appends_true_and_false)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer = { NULL, 0, 0 };
+
+            ///act
+            auto res1 = AgentDataTypes_Boolean_ToJSON(&buffer, 2);
+            auto res2 = AgentDataTypes_Boolean_ToJSON(&buffer, 0);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res1);
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res2);
+            ASSERT_ARE_EQUAL(char_ptr, "truefalse", std::string(buffer.buffer, buffer.length).c_str());
+
+            ///cleanup
+            free(buffer.buffer);
+        }
+
+#ifndef NO_FLOATS
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_004: [ AgentDataTypes_Double_ToJSON and AgentDataTypes_Float_ToJSON shall append NaN, -INF, INF or the shortest decimal that reads back as the same value (the same text AgentDataTypes_ToString produces), written directly into destination. ]*/
+        TEST_FUNCTION(AgentDataTypes_Double_ToJSON_and_Float_ToJSON_produce_the_same_text_as_AgentDataTypes_ToString)
+        {
+            static const double values[] = { 0.0, 1.5, -3.25, 3.141592653589793, 1e300, -1e-300 };
+            size_t i;
+
+            for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            {
+                ///arrange
+                AGENT_DATA_TYPE agDouble;
+                AGENT_DATA_TYPE agFloat;
+                JSON_ENCODER_BUFFER doubleBuffer = { NULL, 0, 0 };
+                JSON_ENCODER_BUFFER floatBuffer = { NULL, 0, 0 };
+                STRING_HANDLE expectedDouble = BASEIMPLEMENTATION::STRING_new();
+                STRING_HANDLE expectedFloat = BASEIMPLEMENTATION::STRING_new();
+                (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&agDouble, values[i]);
+                (void)Create_AGENT_DATA_TYPE_from_FLOAT(&agFloat, (float)values[i]);
+                (void)AgentDataTypes_ToString(expectedDouble, &agDouble);
+                (void)AgentDataTypes_ToString(expectedFloat, &agFloat);
+
+                ///act
+                auto res1 = AgentDataTypes_Double_ToJSON(&doubleBuffer, values[i]);
+                auto res2 = AgentDataTypes_Float_ToJSON(&floatBuffer, (float)values[i]);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res1);
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res2);
+                ASSERT_ARE_EQUAL(char_ptr, BASEIMPLEMENTATION::STRING_c_str(expectedDouble), std::string(doubleBuffer.buffer, doubleBuffer.length).c_str());
+                ASSERT_ARE_EQUAL(char_ptr, BASEIMPLEMENTATION::STRING_c_str(expectedFloat), std::string(floatBuffer.buffer, floatBuffer.length).c_str());
+
+                ///cleanup
+                free(doubleBuffer.buffer);
+                free(floatBuffer.buffer);
+                BASEIMPLEMENTATION::STRING_delete(expectedDouble);
+                BASEIMPLEMENTATION::STRING_delete(expectedFloat);
+                Destroy_AGENT_DATA_TYPE(&agDouble);
+                Destroy_AGENT_DATA_TYPE(&agFloat);
+            }
+        }
+#endif
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_007: [ If v is NULL, AgentDataTypes_Charz_ToJSON and AgentDataTypes_CharzNoQuotes_ToJSON shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+        TEST_FUNCTION(AgentDataTypes_Charz_ToJSON_with_NULL_value_fails)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer = { NULL, 0, 0 };
+
+            ///act
+            auto res = AgentDataTypes_Charz_ToJSON(&buffer, NULL);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(size_t, 0, buffer.length);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_008: [ If v contains characters above 127, AgentDataTypes_Charz_ToJSON shall return AGENT_DATA_TYPES_INVALID_ARG. ]*/
+        TEST_FUNCTION(AgentDataTypes_Charz_ToJSON_with_non_ASCII_value_fails_and_appends_nothing)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer = { NULL, 0, 0 };
+
+            ///act
+            auto res = AgentDataTypes_Charz_ToJSON(&buffer, "a\xC3\xA9");
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(size_t, 0, buffer.length);
+
+            ///cleanup
+            free(buffer.buffer);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_009: [ AgentDataTypes_Charz_ToJSON shall reserve the exact encoded length once and append v between quotes, escaping control characters as \u00XX and ", \ and / with a backslash. ]*/
+        TEST_FUNCTION(AgentDataTypes_Charz_ToJSON_produces_the_same_text_as_AgentDataTypes_ToString)
+        {
+            ///arrange
+            static const char value[] = "a\"b\\c/d\x01\x1F\te";
+            AGENT_DATA_TYPE ag;
+            JSON_ENCODER_BUFFER buffer = { NULL, 0, 0 };
+            STRING_HANDLE expected = BASEIMPLEMENTATION::STRING_new();
+            (void)Create_AGENT_DATA_TYPE_from_charz(&ag, value);
+            (void)AgentDataTypes_ToString(expected, &ag);
+            mocks->ResetAllCalls();
+
+            STRICT_EXPECTED_CALL((*mocks), JSONEncoder_Buffer_Reserve(&buffer, BASEIMPLEMENTATION::STRING_length(expected)));
+
+            ///act
+            auto res = AgentDataTypes_Charz_ToJSON(&buffer, value);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, BASEIMPLEMENTATION::STRING_c_str(expected), std::string(buffer.buffer, buffer.length).c_str());
+            mocks->AssertActualAndExpectedCalls();
+
+            ///cleanup
+            free(buffer.buffer);
+            BASEIMPLEMENTATION::STRING_delete(expected);
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_010: [ AgentDataTypes_CharzNoQuotes_ToJSON shall append v as is. ]*/
+        TEST_FUNCTION(AgentDataTypes_CharzNoQuotes_ToJSON_appends_the_value_as_is)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer = { NULL, 0, 0 };
+
+            ///act
+            auto res = AgentDataTypes_CharzNoQuotes_ToJSON(&buffer, "{\"a\":1}");
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "{\"a\":1}", std::string(buffer.buffer, buffer.length).c_str());
+
+            ///cleanup
+            free(buffer.buffer);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_011: [ AgentDataTypes_ToJSON shall append the output of AgentDataTypes_ToString for value. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToJSON_appends_the_output_of_AgentDataTypes_ToString)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            JSON_ENCODER_BUFFER buffer = { NULL, 0, 0 };
+            (void)Create_EDM_BOOLEAN_from_int(&ag, 1);
+
+            ///act
+            auto res = AgentDataTypes_ToJSON(&buffer, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "true", std::string(buffer.buffer, buffer.length).c_str());
+
+            ///cleanup
+            free(buffer.buffer);
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_012: [ If AgentDataTypes_ToString fails, AgentDataTypes_ToJSON shall return the same error. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToJSON_with_NULL_value_fails)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer = { NULL, 0, 0 };
+
+            ///act
+            auto res = AgentDataTypes_ToJSON(&buffer, NULL);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(size_t, 0, buffer.length);
+        }
+
 END_TEST_SUITE(AgentTypeSystem_ut)
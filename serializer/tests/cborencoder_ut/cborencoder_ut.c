@@ -0,0 +1,653 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+#endif
+
+#include "umock_c/umock_c.h"
+#include "umock_c/umocktypes_charptr.h"
+#include "umock_c/umocktypes_stdint.h"
+
+#include "azure_c_shared_utility/optimize_size.h"
+
+#define ENABLE_MOCKS
+#include "multitree.h"
+#include "jsonencoder.h"
+#include "agenttypesystem.h"
+#include "azure_c_shared_utility/strings.h"
+#undef ENABLE_MOCKS
+
+#include "real_strings.h"
+
+#include "testrunnerswitcher.h"
+#include "cborencoder.h"
+
+IMPLEMENT_UMOCK_C_ENUM_TYPE(MULTITREE_RESULT, MULTITREE_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT_VALUES);
+TEST_DEFINE_ENUM_TYPE(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+
+MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", MU_ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+/*a tiny tree standing in for MultiTree, the MULTITREE_HANDLEs given to CBOREncoder point to these*/
+typedef struct TEST_NODE_TAG
+{
+    const char* name;
+    const AGENT_DATA_TYPE* value;
+    size_t childCount;
+    struct TEST_NODE_TAG* children;
+} TEST_NODE;
+
+static MULTITREE_RESULT my_MultiTree_GetChildCount(MULTITREE_HANDLE treeHandle, size_t* count)
+{
+    *count = ((TEST_NODE*)treeHandle)->childCount;
+    return MULTITREE_OK;
+}
+
+static MULTITREE_RESULT my_MultiTree_GetChild(MULTITREE_HANDLE treeHandle, size_t index, MULTITREE_HANDLE* childHandle)
+{
+    *childHandle = (MULTITREE_HANDLE)&((TEST_NODE*)treeHandle)->children[index];
+    return MULTITREE_OK;
+}
+
+static MULTITREE_RESULT my_MultiTree_GetName(MULTITREE_HANDLE treeHandle, STRING_HANDLE destination)
+{
+    return (real_STRING_concat(destination, ((TEST_NODE*)treeHandle)->name) == 0) ? MULTITREE_OK : MULTITREE_ERROR;
+}
+
+static MULTITREE_RESULT my_MultiTree_GetValue(MULTITREE_HANDLE treeHandle, const void** destination)
+{
+    *destination = ((TEST_NODE*)treeHandle)->value;
+    return MULTITREE_OK;
+}
+
+static unsigned char g_output[256];
+
+static JSON_ENCODER_RESULT my_JSONEncoder_Buffer_Append(JSON_ENCODER_BUFFER* buffer, const char* source, size_t sourceLength)
+{
+    JSON_ENCODER_RESULT result;
+    if (buffer->length + sourceLength > sizeof(g_output))
+    {
+        result = JSON_ENCODER_ERROR;
+    }
+    else
+    {
+        (void)memcpy(g_output + buffer->length, source, sourceLength);
+        buffer->length += sourceLength;
+        result = JSON_ENCODER_OK;
+    }
+    return result;
+}
+
+static const char* g_toStringText;
+
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
+{
+    (void)value;
+    return (real_STRING_concat(destination, g_toStringText) == 0) ? AGENT_DATA_TYPES_OK : AGENT_DATA_TYPES_ERROR;
+}
+
+static JSON_ENCODER_BUFFER g_buffer;
+
+static void assert_output(const unsigned char* expected, size_t expectedLength)
+{
+    ASSERT_ARE_EQUAL(size_t, expectedLength, g_buffer.length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(expected, g_output, expectedLength));
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+
+BEGIN_TEST_SUITE(cborencoder_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+    (void)umocktypes_charptr_register_types();
+    (void)umocktypes_stdint_register_types();
+
+    REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_TYPE(MULTITREE_RESULT, MULTITREE_RESULT);
+    REGISTER_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT);
+    REGISTER_TYPE(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT);
+
+    REGISTER_STRING_GLOBAL_MOCK_HOOK;
+
+    REGISTER_GLOBAL_MOCK_HOOK(MultiTree_GetChildCount, my_MultiTree_GetChildCount);
+    REGISTER_GLOBAL_MOCK_HOOK(MultiTree_GetChild, my_MultiTree_GetChild);
+    REGISTER_GLOBAL_MOCK_HOOK(MultiTree_GetName, my_MultiTree_GetName);
+    REGISTER_GLOBAL_MOCK_HOOK(MultiTree_GetValue, my_MultiTree_GetValue);
+    REGISTER_GLOBAL_MOCK_HOOK(JSONEncoder_Buffer_Append, my_JSONEncoder_Buffer_Append);
+    REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToString, my_AgentDataTypes_ToString);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    (void)memset(g_output, 0, sizeof(g_output));
+    g_buffer.buffer = (char*)g_output;
+    g_buffer.length = 0;
+    g_buffer.capacity = sizeof(g_output);
+    g_toStringText = "";
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_001: [ If destination or value is NULL, CBOREncoder_EncodeValue shall return CBOR_ENCODER_INVALID_ARG. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_with_NULL_destination_fails)
+{
+    ///arrange
+    AGENT_DATA_TYPE value;
+    value.type = EDM_NULL_TYPE;
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(NULL, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_001: [ If destination or value is NULL, CBOREncoder_EncodeValue shall return CBOR_ENCODER_INVALID_ARG. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_with_NULL_value_fails)
+{
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_002: [ Integer types shall be encoded as CBOR unsigned or negative integers in their shortest form. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_small_unsigned_integer_is_one_byte)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0x17 };
+    AGENT_DATA_TYPE value;
+    value.type = EDM_INT32_TYPE;
+    value.value.edmInt32.value = 23;
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_002: [ Integer types shall be encoded as CBOR unsigned or negative integers in their shortest form. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_integers_use_the_shortest_argument)
+{
+    ///arrange
+    static const unsigned char expected[] = {
+        0x18, 0x18,                                                 /*24*/
+        0x19, 0x01, 0x00,                                           /*256*/
+        0x1A, 0x00, 0x01, 0x00, 0x00,                               /*65536*/
+        0x1B, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00        /*4294967296*/
+    };
+    AGENT_DATA_TYPE value;
+    CBOR_ENCODER_RESULT result[4];
+
+    ///act
+    value.type = EDM_BYTE_TYPE;
+    value.value.edmByte.value = 24;
+    result[0] = CBOREncoder_EncodeValue(&g_buffer, &value);
+    value.type = EDM_INT16_TYPE;
+    value.value.edmInt16.value = 256;
+    result[1] = CBOREncoder_EncodeValue(&g_buffer, &value);
+    value.type = EDM_INT32_TYPE;
+    value.value.edmInt32.value = 65536;
+    result[2] = CBOREncoder_EncodeValue(&g_buffer, &value);
+    value.type = EDM_INT64_TYPE;
+    value.value.edmInt64.value = 4294967296LL;
+    result[3] = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result[0]);
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result[1]);
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result[2]);
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result[3]);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_002: [ Integer types shall be encoded as CBOR unsigned or negative integers in their shortest form. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_negative_integers_succeed)
+{
+    ///arrange
+    static const unsigned char expected[] = {
+        0x20,                                                       /*-1*/
+        0x38, 0x63,                                                 /*-100*/
+        0x3B, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF        /*INT64_MIN*/
+    };
+    AGENT_DATA_TYPE value;
+    CBOR_ENCODER_RESULT result[3];
+
+    ///act
+    value.type = EDM_SBYTE_TYPE;
+    value.value.edmSbyte.value = -1;
+    result[0] = CBOREncoder_EncodeValue(&g_buffer, &value);
+    value.value.edmSbyte.value = -100;
+    result[1] = CBOREncoder_EncodeValue(&g_buffer, &value);
+    value.type = EDM_INT64_TYPE;
+    value.value.edmInt64.value = INT64_MIN;
+    result[2] = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result[0]);
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result[1]);
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result[2]);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_003: [ EDM_BOOLEAN_TYPE shall be encoded as CBOR true or false and EDM_NULL_TYPE as CBOR null. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_bool_and_null_succeed)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xF5, 0xF4, 0xF6 };
+    AGENT_DATA_TYPE value;
+    CBOR_ENCODER_RESULT result[3];
+
+    ///act
+    value.type = EDM_BOOLEAN_TYPE;
+    value.value.edmBoolean.value = EDM_TRUE;
+    result[0] = CBOREncoder_EncodeValue(&g_buffer, &value);
+    value.value.edmBoolean.value = EDM_FALSE;
+    result[1] = CBOREncoder_EncodeValue(&g_buffer, &value);
+    value.type = EDM_NULL_TYPE;
+    result[2] = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result[0]);
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result[1]);
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result[2]);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_004: [ EDM_SINGLE_TYPE shall be encoded as a CBOR single precision float. EDM_DOUBLE_TYPE shall be encoded as a single precision float when that keeps the exact value and as a double precision float otherwise. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_single_is_float32)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xFA, 0x3F, 0xC0, 0x00, 0x00 };
+    AGENT_DATA_TYPE value;
+    value.type = EDM_SINGLE_TYPE;
+    value.value.edmSingle.value = 1.5f;
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_004: [ EDM_SINGLE_TYPE shall be encoded as a CBOR single precision float. EDM_DOUBLE_TYPE shall be encoded as a single precision float when that keeps the exact value and as a double precision float otherwise. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_double_that_fits_a_float_is_float32)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xFA, 0xC0, 0x90, 0x00, 0x00 };
+    AGENT_DATA_TYPE value;
+    value.type = EDM_DOUBLE_TYPE;
+    value.value.edmDouble.value = -4.5;
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_004: [ EDM_SINGLE_TYPE shall be encoded as a CBOR single precision float. EDM_DOUBLE_TYPE shall be encoded as a single precision float when that keeps the exact value and as a double precision float otherwise. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_double_that_does_not_fit_a_float_is_float64)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xFB, 0x3F, 0xB9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A };
+    AGENT_DATA_TYPE value;
+    value.type = EDM_DOUBLE_TYPE;
+    value.value.edmDouble.value = 0.1;
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_005: [ EDM_STRING_TYPE and EDM_STRING_NO_QUOTES_TYPE shall be encoded as CBOR text strings, without any JSON escaping. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_string_is_not_escaped)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0x64, 'a', '"', '\\', 'b' };
+    AGENT_DATA_TYPE value;
+    value.type = EDM_STRING_TYPE;
+    value.value.edmString.chars = (char*)"a\"\\b";
+    value.value.edmString.length = 4;
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_005: [ EDM_STRING_TYPE and EDM_STRING_NO_QUOTES_TYPE shall be encoded as CBOR text strings, without any JSON escaping. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_string_no_quotes_succeeds)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0x62, '{', '}' };
+    AGENT_DATA_TYPE value;
+    value.type = EDM_STRING_NO_QUOTES_TYPE;
+    value.value.edmStringNoQuotes.chars = (char*)"{}";
+    value.value.edmStringNoQuotes.length = 2;
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_006: [ EDM_BINARY_TYPE shall be encoded as a CBOR byte string. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_binary_is_a_byte_string)
+{
+    ///arrange
+    static unsigned char data[] = { 0x00, 0xFF, 0x10 };
+    static const unsigned char expected[] = { 0x43, 0x00, 0xFF, 0x10 };
+    AGENT_DATA_TYPE value;
+    value.type = EDM_BINARY_TYPE;
+    value.value.edmBinary.data = data;
+    value.value.edmBinary.size = sizeof(data);
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_007: [ EDM_GUID_TYPE shall be encoded as tag 37 followed by a byte string of the 16 bytes of the GUID. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_guid_is_tagged_byte_string)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xD8, 0x25, 0x50, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+    AGENT_DATA_TYPE value;
+    size_t i;
+    value.type = EDM_GUID_TYPE;
+    for (i = 0; i < 16; i++)
+    {
+        value.value.edmGuid.GUID[i] = (uint8_t)i;
+    }
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_008: [ EDM_DATE_TIME_OFFSET_TYPE shall be encoded as tag 0 followed by the text of its JSON representation. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_date_time_offset_is_tagged_text)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xC0, 0x74, '2', '0', '1', '6', '-', '0', '1', '-', '0', '2', 'T', '0', '3', ':', '0', '4', ':', '0', '5', 'Z' };
+    AGENT_DATA_TYPE value;
+    value.type = EDM_DATE_TIME_OFFSET_TYPE;
+    g_toStringText = "\"2016-01-02T03:04:05Z\"";
+
+    STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(&g_buffer, IGNORED_PTR_ARG, 1));
+    STRICT_EXPECTED_CALL(STRING_new());
+    STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, &value));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(&g_buffer, IGNORED_PTR_ARG, 1));
+    STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(&g_buffer, IGNORED_PTR_ARG, 20));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_009: [ EDM_COMPLEX_TYPE_TYPE shall be encoded as a CBOR map from the field names to the encoded field values. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_complex_type_is_a_map)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xA2, 0x61, 'x', 0x01, 0x61, 'y', 0xF5 };
+    AGENT_DATA_TYPE x;
+    AGENT_DATA_TYPE y;
+    COMPLEX_TYPE_FIELD_TYPE fields[2];
+    AGENT_DATA_TYPE value;
+    x.type = EDM_INT32_TYPE;
+    x.value.edmInt32.value = 1;
+    y.type = EDM_BOOLEAN_TYPE;
+    y.value.edmBoolean.value = EDM_TRUE;
+    fields[0].fieldName = "x";
+    fields[0].value = &x;
+    fields[1].fieldName = "y";
+    fields[1].value = &y;
+    value.type = EDM_COMPLEX_TYPE_TYPE;
+    value.value.edmComplexType.nMembers = 2;
+    value.value.edmComplexType.fields = fields;
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_010: [ Any other type shall be encoded as a CBOR text string holding its JSON representation as produced by AgentDataTypes_ToString, without the enclosing quotes. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_other_types_are_text)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0x63, '1', '.', '5' };
+    AGENT_DATA_TYPE value;
+    value.type = EDM_DECIMAL_TYPE;
+    g_toStringText = "1.5";
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_011: [ If any failure occurs, CBOREncoder_EncodeValue shall fail and return CBOR_ENCODER_ERROR or CBOR_ENCODER_UNSUPPORTED_TYPE. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_when_AgentDataTypes_ToString_fails_it_fails)
+{
+    ///arrange
+    AGENT_DATA_TYPE value;
+    value.type = EDM_DECIMAL_TYPE;
+    STRICT_EXPECTED_CALL(STRING_new());
+    STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, &value))
+        .SetReturn(AGENT_DATA_TYPES_ERROR);
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_UNSUPPORTED_TYPE, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_011: [ If any failure occurs, CBOREncoder_EncodeValue shall fail and return CBOR_ENCODER_ERROR or CBOR_ENCODER_UNSUPPORTED_TYPE. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeValue_when_JSONEncoder_Buffer_Append_fails_it_fails)
+{
+    ///arrange
+    AGENT_DATA_TYPE value;
+    value.type = EDM_INT32_TYPE;
+    value.value.edmInt32.value = 1;
+    STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(&g_buffer, IGNORED_PTR_ARG, 1))
+        .SetReturn(JSON_ENCODER_ERROR);
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeValue(&g_buffer, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_012: [ If treeHandle or destination is NULL, CBOREncoder_EncodeTree shall return CBOR_ENCODER_INVALID_ARG. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_with_NULL_treeHandle_fails)
+{
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree(NULL, &g_buffer);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_012: [ If treeHandle or destination is NULL, CBOREncoder_EncodeTree shall return CBOR_ENCODER_INVALID_ARG. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_with_NULL_destination_fails)
+{
+    ///arrange
+    TEST_NODE root = { NULL, NULL, 0, NULL };
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree((MULTITREE_HANDLE)&root, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_013: [ CBOREncoder_EncodeTree shall append a CBOR map with one entry per child of treeHandle, keyed by the name of the child, in the order of the children. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_with_empty_tree_is_an_empty_map)
+{
+    ///arrange
+    static const unsigned char expected[] = { 0xA0 };
+    TEST_NODE root = { NULL, NULL, 0, NULL };
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree((MULTITREE_HANDLE)&root, &g_buffer);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_013: [ CBOREncoder_EncodeTree shall append a CBOR map with one entry per child of treeHandle, keyed by the name of the child, in the order of the children. ]*/
+/*Tests_SRS_CBOR_ENCODER_09_014: [ A child that has children shall be encoded by CBOREncoder_EncodeTree, a leaf shall be encoded by CBOREncoder_EncodeValue. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_with_nested_children_succeeds)
+{
+    ///arrange
+    static const unsigned char expected[] = {
+        0xA2,
+            0x61, 'a', 0x05,
+            0x61, 'b', 0xA1,
+                0x61, 'c', 0xF6
+    };
+    AGENT_DATA_TYPE five;
+    AGENT_DATA_TYPE null;
+    TEST_NODE c[1];
+    TEST_NODE children[2];
+    TEST_NODE root;
+    five.type = EDM_INT32_TYPE;
+    five.value.edmInt32.value = 5;
+    null.type = EDM_NULL_TYPE;
+    c[0].name = "c"; c[0].value = &null; c[0].childCount = 0; c[0].children = NULL;
+    children[0].name = "a"; children[0].value = &five; children[0].childCount = 0; children[0].children = NULL;
+    children[1].name = "b"; children[1].value = NULL; children[1].childCount = 1; children[1].children = c;
+    root.name = NULL; root.value = NULL; root.childCount = 2; root.children = children;
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree((MULTITREE_HANDLE)&root, &g_buffer);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_OK, result);
+    assert_output(expected, sizeof(expected));
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_015: [ If any MultiTree call fails, CBOREncoder_EncodeTree shall return CBOR_ENCODER_MULTITREE_ERROR. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_when_MultiTree_GetChildCount_fails_it_fails)
+{
+    ///arrange
+    TEST_NODE root = { NULL, NULL, 0, NULL };
+    STRICT_EXPECTED_CALL(MultiTree_GetChildCount((MULTITREE_HANDLE)&root, IGNORED_PTR_ARG))
+        .SetReturn(MULTITREE_ERROR);
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree((MULTITREE_HANDLE)&root, &g_buffer);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_MULTITREE_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_CBOR_ENCODER_09_015: [ If any MultiTree call fails, CBOREncoder_EncodeTree shall return CBOR_ENCODER_MULTITREE_ERROR. ]*/
+TEST_FUNCTION(CBOREncoder_EncodeTree_when_MultiTree_GetName_fails_it_fails)
+{
+    ///arrange
+    AGENT_DATA_TYPE null;
+    TEST_NODE child;
+    TEST_NODE root;
+    null.type = EDM_NULL_TYPE;
+    child.name = "a"; child.value = &null; child.childCount = 0; child.children = NULL;
+    root.name = NULL; root.value = NULL; root.childCount = 1; root.children = &child;
+
+    STRICT_EXPECTED_CALL(MultiTree_GetChildCount((MULTITREE_HANDLE)&root, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(&g_buffer, IGNORED_PTR_ARG, 1));
+    STRICT_EXPECTED_CALL(STRING_new());
+    STRICT_EXPECTED_CALL(MultiTree_GetChild((MULTITREE_HANDLE)&root, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(MultiTree_GetName((MULTITREE_HANDLE)&child, IGNORED_PTR_ARG))
+        .SetReturn(MULTITREE_ERROR);
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+
+    ///act
+    CBOR_ENCODER_RESULT result = CBOREncoder_EncodeTree((MULTITREE_HANDLE)&root, &g_buffer);
+
+    ///assert
+    ASSERT_ARE_EQUAL(CBOR_ENCODER_RESULT, CBOR_ENCODER_MULTITREE_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+END_TEST_SUITE(cborencoder_ut)
@@ -36,6 +36,7 @@ void my_gballoc_free(void * t)
 #include "agenttypesystem.h"
 #include "schema.h"
 #include "iotdevice.h"
+#include "datamarshaller.h"
 #include "azure_c_shared_utility/strings.h"
 #undef ENABLE_MOCKS
 
@@ -55,6 +56,7 @@ IMPLEMENT_UMOCK_C_ENUM_TYPE(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_RESULT_VALUE
 IMPLEMENT_UMOCK_C_ENUM_TYPE(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT_VALUES);
 //TEST_DEFINE_ENUM_TYPE(SCHEMA_RESULT, SCHEMA_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(SCHEMA_RESULT, SCHEMA_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
 
 MU_DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
 
@@ -154,6 +156,8 @@ WITH_DESIRED_PROPERTY(EDM_BINARY, desired_this_is_EdmBinary)
 END_NAMESPACE(DummyDataProvider)
 
 static const char TEST_MODEL_NAME[] = "SimpleDevice_Model";
+static const DATA_MARSHALLER_ENCODER TEST_JSON_ENCODER = { "application/json", "utf-8", NULL };
+static const DATA_MARSHALLER_ENCODER TEST_CBOR_ENCODER = { "application/cbor", NULL, NULL };
 
 bool DummyDataProvider_reset_wasCalled;
 EXECUTE_COMMAND_RESULT reset(TruckType* device)
@@ -422,8 +426,9 @@ static int EDM_BINARY_Compare(EDM_BINARY e, EDM_BINARY fe)
 
 static AGENT_DATA_TYPES_RESULT my_Create_AGENT_DATA_TYPE_from_DOUBLE(AGENT_DATA_TYPE* agentData, double v)
 {
-    (void)v;
     Create_AGENT_DATA_TYPE_from_DOUBLE_agentData = agentData;
+    agentData->type = EDM_DOUBLE_TYPE;
+    agentData->value.edmDouble.value = v;
     return AGENT_DATA_TYPES_OK;
 }
 
@@ -496,11 +501,27 @@ static void my_Destroy_AGENT_DATA_TYPE(AGENT_DATA_TYPE* agentData)
 
 static AGENT_DATA_TYPES_RESULT my_Create_AGENT_DATA_TYPE_from_SINT32(AGENT_DATA_TYPE* agentData, int32_t v)
 {
-    (void)(v);
     Create_AGENT_DATA_TYPE_from_SINT32_agentData = agentData;
+    agentData->type = EDM_INT32_TYPE;
+    agentData->value.edmInt32.value = v;
     return AGENT_DATA_TYPES_OK;
 }
 
+/*only knows the types the hooks above produce, that is enough to tell changed values apart*/
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
+{
+    char temp[64];
+    if (value->type == EDM_INT32_TYPE)
+    {
+        (void)sprintf(temp, "%" PRId32, value->value.edmInt32.value);
+    }
+    else
+    {
+        (void)sprintf(temp, "%f", value->value.edmDouble.value);
+    }
+    return (real_STRING_concat(destination, temp) == 0) ? AGENT_DATA_TYPES_OK : AGENT_DATA_TYPES_ERROR;
+}
+
 static void* toBeCleaned = NULL; /*this variable exists because bad semantics in _CancelTransaction/EndTransaction.*/
 static TRANSACTION_HANDLE my_Device_StartTransaction(DEVICE_HANDLE deviceHandle)
 {
@@ -714,6 +735,46 @@ static SCHEMA_RESULT my_Schema_GetModelModelCount(SCHEMA_MODEL_TYPE_HANDLE model
     return SCHEMA_OK;
 }
 
+static JSON_ENCODER_RESULT my_JSONEncoder_Buffer_Init(JSON_ENCODER_BUFFER* buffer, size_t initialCapacity)
+{
+    buffer->buffer = (char*)malloc(initialCapacity);
+    buffer->length = 0;
+    buffer->capacity = initialCapacity;
+    return JSON_ENCODER_OK;
+}
+
+static JSON_ENCODER_RESULT my_JSONEncoder_Buffer_Append(JSON_ENCODER_BUFFER* buffer, const char* source, size_t sourceLength)
+{
+    if (buffer->length + sourceLength > buffer->capacity)
+    {
+        buffer->capacity = buffer->length + sourceLength;
+        buffer->buffer = (char*)realloc(buffer->buffer, buffer->capacity);
+    }
+    (void)memcpy(buffer->buffer + buffer->length, source, sourceLength);
+    buffer->length += sourceLength;
+    return JSON_ENCODER_OK;
+}
+
+static void my_JSONEncoder_Buffer_Deinit(JSON_ENCODER_BUFFER* buffer)
+{
+    free(buffer->buffer);
+    buffer->buffer = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_Double_ToJSON(JSON_ENCODER_BUFFER* destination, double v)
+{
+    (void)v;
+    return (my_JSONEncoder_Buffer_Append(destination, "42.0", 4) == JSON_ENCODER_OK) ? AGENT_DATA_TYPES_OK : AGENT_DATA_TYPES_ERROR;
+}
+
+static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_Int64_ToJSON(JSON_ENCODER_BUFFER* destination, int64_t v)
+{
+    (void)v;
+    return (my_JSONEncoder_Buffer_Append(destination, "1", 1) == JSON_ENCODER_OK) ? AGENT_DATA_TYPES_OK : AGENT_DATA_TYPES_ERROR;
+}
+
 #define TEST_SCHEMA_METADATA ((void*)(0x42))
 
 BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
@@ -745,9 +806,21 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         REGISTER_UMOCK_ALIAS_TYPE(pfOnDesiredProperty, void*);
         REGISTER_UMOCK_ALIAS_TYPE(pfDeviceMethodCallback, void*);
         REGISTER_UMOCK_ALIAS_TYPE(METHODRETURN_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(JSON_ENCODER_BUFFER*, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(const DATA_MARSHALLER_ENCODER*, void*);
+        REGISTER_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT);
+
+        REGISTER_GLOBAL_MOCK_HOOK(JSONEncoder_Buffer_Init, my_JSONEncoder_Buffer_Init);
+        REGISTER_GLOBAL_MOCK_HOOK(JSONEncoder_Buffer_Append, my_JSONEncoder_Buffer_Append);
+        REGISTER_GLOBAL_MOCK_HOOK(JSONEncoder_Buffer_Deinit, my_JSONEncoder_Buffer_Deinit);
+        REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_Double_ToJSON, my_AgentDataTypes_Double_ToJSON);
+        REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_Int64_ToJSON, my_AgentDataTypes_Int64_ToJSON);
+        REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToString, my_AgentDataTypes_ToString);
 
 
         REGISTER_GLOBAL_MOCK_RETURN(Schema_GetModelName, TEST_MODEL_NAME);
+        REGISTER_GLOBAL_MOCK_RETURN(DataMarshaller_GetEncoder, &TEST_JSON_ENCODER);
+        REGISTER_GLOBAL_MOCK_RETURN(DataMarshaller_GetJSONEncoder, &TEST_JSON_ENCODER);
         REGISTER_GLOBAL_MOCK_HOOK(Create_AGENT_DATA_TYPE_from_DOUBLE, my_Create_AGENT_DATA_TYPE_from_DOUBLE);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(Create_AGENT_DATA_TYPE_from_DOUBLE, AGENT_DATA_TYPES_JSON_ENCODER_ERRROR);
 
@@ -925,6 +998,8 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         DummyDataProvider_test1_P14.data = NULL;
         DummyDataProvider_test1_P14.size = 0;
 
+        CodeFirst_SetDirectJsonEncoding(false);
+
         TEST_MUTEX_RELEASE(g_testByTest);
     }
 
@@ -2825,6 +2900,137 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
+    /*Tests_SRS_CODEFIRST_09_006: [ CodeFirst_CreateDevice shall keep the devices ordered by the address of their data. ]*/
+    /*Tests_SRS_CODEFIRST_09_007: [ CodeFirst shall find the device a value belongs to by a binary search over the devices ordered by address. ]*/
+    /*Tests_SRS_CODEFIRST_09_008: [ CodeFirst_SendAsync and CodeFirst_SendAsyncReported shall find the property that holds a value by a binary search over the indexed properties of the model. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_With_One_Property_Of_One_Of_Many_Devices_Succeeds)
+    {
+        // arrange
+        SimpleDevice_Model* devices[5];
+        size_t i;
+        unsigned char* destination;
+        size_t destinationSize;
+        (void)CodeFirst_Init(NULL);
+        for (i = 0; i < 5; i++)
+        {
+            devices[i] = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        }
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_handle()
+            .IgnoreArgument_s2();
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(3);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(2)
+            .IgnoreArgument(3);
+        devices[2]->this_is_double_Property = 42.0;
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 1, &devices[2]->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        for (i = 0; i < 5; i++)
+        {
+            CodeFirst_DestroyDevice(devices[i]);
+        }
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_007: [ CodeFirst shall find the device a value belongs to by a binary search over the devices ordered by address. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_With_Properties_Of_The_First_And_The_Last_Of_Many_Devices_Fails)
+    {
+        // arrange
+        SimpleDevice_Model* devices[5];
+        SimpleDevice_Model* first;
+        SimpleDevice_Model* last;
+        size_t i;
+        unsigned char* destination;
+        size_t destinationSize;
+        (void)CodeFirst_Init(NULL);
+        for (i = 0; i < 5; i++)
+        {
+            devices[i] = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        }
+        first = devices[0];
+        last = devices[0];
+        for (i = 1; i < 5; i++)
+        {
+            if ((unsigned char*)devices[i] < (unsigned char*)first)
+            {
+                first = devices[i];
+            }
+            if ((unsigned char*)devices[i] > (unsigned char*)last)
+            {
+                last = devices[i];
+            }
+        }
+        umock_c_reset_all_calls();
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 2, &first->this_is_double_Property, &last->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_VALUES_FROM_DIFFERENT_DEVICES_ERROR, result);
+
+        // cleanup
+        for (i = 0; i < 5; i++)
+        {
+            CodeFirst_DestroyDevice(devices[i]);
+        }
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_006: [ CodeFirst_CreateDevice shall keep the devices ordered by the address of their data. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_After_Destroying_Some_Devices_Finds_The_Remaining_Ones)
+    {
+        // arrange
+        SimpleDevice_Model* devices[5];
+        size_t i;
+        unsigned char* destination;
+        size_t destinationSize;
+        (void)CodeFirst_Init(NULL);
+        for (i = 0; i < 5; i++)
+        {
+            devices[i] = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        }
+        CodeFirst_DestroyDevice(devices[1]);
+        CodeFirst_DestroyDevice(devices[3]);
+        umock_c_reset_all_calls();
+
+        // act
+        CODEFIRST_RESULT result0 = CodeFirst_SendAsync(&destination, &destinationSize, 2, &devices[0]->this_is_double_Property, &devices[0]->this_is_int_Property);
+        CODEFIRST_RESULT result2 = CodeFirst_SendAsync(&destination, &destinationSize, 2, &devices[2]->this_is_double_Property, &devices[2]->this_is_int_Property);
+        CODEFIRST_RESULT result4 = CodeFirst_SendAsync(&destination, &destinationSize, 2, &devices[4]->this_is_double_Property, &devices[4]->this_is_int_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result0);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result2);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result4);
+
+        // cleanup
+        CodeFirst_DestroyDevice(devices[0]);
+        CodeFirst_DestroyDevice(devices[2]);
+        CodeFirst_DestroyDevice(devices[4]);
+        CodeFirst_Deinit();
+    }
+
     /* Tests_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
     /* Tests_SRS_CODEFIRST_99_136:[CodeFirst_SendAsync shall build the full path for each property and then pass it to Device_PublishTransacted.] */
     TEST_FUNCTION(CodeFirst_SendAsync_Can_Send_The_Last_Property_From_A_Child_Model_With_2_Properties)
@@ -2960,119 +3166,733 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
-    /* CodeFirst_RegisterSchema */
-    /* Tests_SRS_CODEFIRST_99_002:[ CodeFirst_RegisterSchema shall create the schema information and give it to the Schema module for one schema, identified by the metadata argument. On success, it shall return a handle to the model.] */
-    TEST_FUNCTION(CodeFirst_RegisterSchema_succeeds)
+    /*Tests_SRS_CODEFIRST_09_001: [ CodeFirst_SetDirectJsonEncoding shall enable or disable the direct JSON path of CodeFirst_SendAsync for all devices. ]*/
+    /*Tests_SRS_CODEFIRST_09_002: [ When direct JSON encoding is enabled and all values are top level properties of the same device, or the only value is a whole device, CodeFirst_SendAsync shall write the JSON for them directly into the destination buffer, producing the same bytes as the transacted path. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_with_direct_JSON_encoding_2_Properties_Succeeds)
     {
-        static const SCHEMA_STRUCT_TYPE_HANDLE TEST_CAR_BEHIND_VAN_HANDLE = (SCHEMA_STRUCT_TYPE_HANDLE)0x7001;
-
-        ///arrange
+        // arrange
+        static const char expectedJSON[] = "{\"this_is_double_Property\":42.0, \"this_is_int_Property\":1}";
         (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        unsigned char* destination;
+        size_t destinationSize;
+        CodeFirst_SetDirectJsonEncoding(true);
         umock_c_reset_all_calls();
-        STRICT_EXPECTED_CALL(Schema_GetSchemaByNamespace("TestSchema"));
-        STRICT_EXPECTED_CALL(Schema_Create("TestSchema", IGNORED_PTR_ARG))
-            .IgnoreArgument_metadata();
-        STRICT_EXPECTED_CALL(Schema_CreateStructType(TEST_SCHEMA_HANDLE, "theCarIsBehindTheVan_Struct"))
-            .SetReturn(TEST_CAR_BEHIND_VAN_HANDLE);
-        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_CAR_BEHIND_VAN_HANDLE, "whereIsMyCar_Field", "whereIsMyDevice_Struct"));
-        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_CAR_BEHIND_VAN_HANDLE, "Alt_Field", "int"));
-        STRICT_EXPECTED_CALL(Schema_CreateStructType(TEST_SCHEMA_HANDLE, "whereIsMyDevice_Struct"));
-        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_STRUCT_TYPE_HANDLE, "Long_Field", "double"));
-        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_STRUCT_TYPE_HANDLE, "Lat_Field", "double"));
-        STRICT_EXPECTED_CALL(Schema_CreateModelType(TEST_SCHEMA_HANDLE, "SimpleDevice_Model"))
-            .SetReturn(TEST_TRUCKTYPE_MODEL_HANDLE);
-        STRICT_EXPECTED_CALL(Schema_CreateModelType(TEST_SCHEMA_HANDLE, "truckType_Model"));
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "SimpleDevice_Model")).SetReturn(TEST_TRUCKTYPE_MODEL_HANDLE);
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "double")).SetReturn(NULL);
-        STRICT_EXPECTED_CALL(Schema_AddModelReportedProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "new_reported_this_is_double", "double"));
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int")).SetReturn(NULL);
-        STRICT_EXPECTED_CALL(Schema_AddModelReportedProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "new_reported_this_is_int", "int"));
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int")).SetReturn(NULL);
-        STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "this_is_int_Property", "int"));
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "double")).SetReturn(NULL);
-        STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "this_is_double_Property", "double"));
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "truckType_Model")).SetReturn(TEST_MODEL_HANDLE);
-        STRICT_EXPECTED_CALL(Schema_CreateModelAction(TEST_MODEL_HANDLE, "setSpeed_Action"))
-            .SetReturn(SETSPEED_ACTION_HANDLE);
-        STRICT_EXPECTED_CALL(Schema_AddModelActionArgument(SETSPEED_ACTION_HANDLE, "theSpeed", "double"));
-        STRICT_EXPECTED_CALL(Schema_CreateModelAction(TEST_MODEL_HANDLE, "reset_Action"))
-            .SetReturn(RESET_ACTION_HANDLE);
 
-        ///act
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Init(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "{", 1))
+            .IgnoreArgument_buffer();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "this_is_double_Property", sizeof("this_is_double_Property") - 1))
+            .IgnoreArgument_buffer();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(AgentDataTypes_Double_ToJSON(IGNORED_PTR_ARG, 42.0))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, ", ", 2))
+            .IgnoreArgument_buffer();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "this_is_int_Property", sizeof("this_is_int_Property") - 1))
+            .IgnoreArgument_buffer();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(AgentDataTypes_Int64_ToJSON(IGNORED_PTR_ARG, 1))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "}", 1))
+            .IgnoreArgument_buffer();
+        device->this_is_double_Property = 42.0;
+        device->this_is_int_Property = 1;
 
-        SCHEMA_HANDLE result = CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testReflectedData));
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 2, &device->this_is_double_Property, &device->this_is_int_Property);
 
-        ///assert
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-        ASSERT_ARE_EQUAL(void_ptr, TEST_SCHEMA_HANDLE, result);
+        ASSERT_ARE_EQUAL(size_t, sizeof(expectedJSON) - 1, destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expectedJSON, destination, destinationSize));
 
-        ///cleanup
+        // cleanup
+        free(destination);
+        CodeFirst_DestroyDevice(device);
         CodeFirst_Deinit();
-
     }
 
-    /* Tests_SRS_CODEFIRST_99_002:[ CodeFirst_RegisterSchema shall create the schema information and give it to the Schema module for one schema, identified by the metadata argument. On success, it shall return a handle to the model.] */
-    TEST_FUNCTION(CodeFirst_RegisterSchema_With_Model_In_Model_succeeds)
+    /*Tests_SRS_CODEFIRST_09_003: [ If the direct JSON path cannot handle the values or fails, CodeFirst_SendAsync shall send them by using the transacted APIs of the device. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_with_direct_JSON_encoding_falls_back_to_transaction_when_ToJSON_fails)
     {
-        static const SCHEMA_STRUCT_TYPE_HANDLE TEST_CAR_BEHIND_VAN_HANDLE = (SCHEMA_STRUCT_TYPE_HANDLE)0x7001;
-
-        ///arrange
+        // arrange
         (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        unsigned char* destination;
+        size_t destinationSize;
+        CodeFirst_SetDirectJsonEncoding(true);
         umock_c_reset_all_calls();
-        STRICT_EXPECTED_CALL(Schema_GetSchemaByNamespace("TestSchema"));
-        STRICT_EXPECTED_CALL(Schema_Create("TestSchema", TEST_SCHEMA_METADATA))
-            .IgnoreArgument_metadata();
-        STRICT_EXPECTED_CALL(Schema_CreateModelType(TEST_SCHEMA_HANDLE, "OuterType"))
-            .SetReturn(TEST_OUTERTYPE_MODEL_HANDLE);
-        STRICT_EXPECTED_CALL(Schema_CreateModelType(TEST_SCHEMA_HANDLE, "InnerType"))
-            .SetReturn(TEST_INNERTYPE_MODEL_HANDLE);
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "OuterType"))
-            .SetReturn(TEST_OUTERTYPE_MODEL_HANDLE);
-        STRICT_EXPECTED_CALL(Schema_CreateModelAction(TEST_OUTERTYPE_MODEL_HANDLE, "OuterType_reset_Action"));
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "InnerType"))
-            .SetReturn(TEST_INNERTYPE_MODEL_HANDLE);
-        STRICT_EXPECTED_CALL(Schema_AddModelModel(TEST_OUTERTYPE_MODEL_HANDLE, "Inner", TEST_INNERTYPE_MODEL_HANDLE, 8, NULL));
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "InnerType"))
-            .SetReturn(TEST_INNERTYPE_MODEL_HANDLE);
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int"));
-        STRICT_EXPECTED_CALL(Schema_AddModelDesiredProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_desired_int_Property_2", "int", IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, NULL))
-            .IgnoreArgument_desiredPropertyDeinitialize()
-            .IgnoreArgument_desiredPropertyInitialize()
-            .IgnoreArgument_desiredPropertyFromAGENT_DATA_TYPE()
-            .IgnoreArgument_offset();
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int"));
-        STRICT_EXPECTED_CALL(Schema_AddModelReportedProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_reported_int_Property_2", "int"));
-        STRICT_EXPECTED_CALL(Schema_CreateModelAction(TEST_INNERTYPE_MODEL_HANDLE, "InnerType_reset_Action"));
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "double"));
-        STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_double2", "double"));
-        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int"));
-        STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_int2", "int"));
 
-        ///act
-        SCHEMA_HANDLE result = CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testModelInModelReflected));
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Init(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(AgentDataTypes_Double_ToJSON(IGNORED_PTR_ARG, 42.0))
+            .IgnoreArgument_destination()
+            .SetReturn(AGENT_DATA_TYPES_ERROR);
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Deinit(IGNORED_PTR_ARG));
 
-        ///assert
+        STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_handle()
+            .IgnoreArgument_s2();
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(3);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(2)
+            .IgnoreArgument(3);
+        device->this_is_double_Property = 42.0;
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 1, &device->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-        ASSERT_ARE_EQUAL(void_ptr, TEST_SCHEMA_HANDLE, result);
 
-        ///cleanup
+        // cleanup
+        CodeFirst_DestroyDevice(device);
         CodeFirst_Deinit();
-
     }
 
-    /* Tests_SRS_CODEFIRST_99_076:[If any Schema APIs fail, CodeFirst_RegisterSchema shall return NULL.] */
-    TEST_FUNCTION(When_Schema_Create_Fails_Then_CodeFirst_RegisterSchema_Fails)
+    /*Tests_SRS_CODEFIRST_09_003: [ If the direct JSON path cannot handle the values or fails, CodeFirst_SendAsync shall send them by using the transacted APIs of the device. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_with_direct_JSON_encoding_sends_a_property_from_a_child_model_transacted)
     {
-
-        ///arrange
+        // arrange
         (void)CodeFirst_Init(NULL);
+        OuterType* device = (OuterType*)CodeFirst_CreateDevice(TEST_OUTERTYPE_MODEL_HANDLE, &ALL_REFLECTED(testModelInModelReflected), sizeof(OuterType), false);
+        unsigned char* destination;
+        size_t destinationSize;
+        CodeFirst_SetDirectJsonEncoding(true);
         umock_c_reset_all_calls();
-        STRICT_EXPECTED_CALL(Schema_GetSchemaByNamespace("TestSchema"));
-        STRICT_EXPECTED_CALL(Schema_Create("TestSchema", TEST_SCHEMA_METADATA))
-            .SetReturn((SCHEMA_HANDLE)NULL);
 
-        ///act
-        SCHEMA_HANDLE result = CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testReflectedData));
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
+
+        STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_handle()
+            .IgnoreArgument_s2();
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_handle()
+            .IgnoreArgument_s2();
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_handle()
+            .IgnoreArgument_s2();
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, (double)(IGNORED_NUM_ARG)));
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "Inner/this_is_double2", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(3);
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(2)
+            .IgnoreArgument(3);
+        device->Inner.this_is_double2 = 42.0;
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 1, &device->Inner.this_is_double2);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_002: [ When direct JSON encoding is enabled and all values are top level properties of the same device, or the only value is a whole device, CodeFirst_SendAsync shall write the JSON for them directly into the destination buffer, producing the same bytes as the transacted path. ]*/
+    /*Tests_SRS_CODEFIRST_09_040: [ A whole device shall be written by the ToJSON_Device function DECLARE_MODEL generated for its model. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_with_direct_JSON_encoding_a_whole_device_Succeeds)
+    {
+        // arrange
+        static const char expectedJSON[] = "{\"this_is_int_Property\":1, \"this_is_double_Property\":42.0}";
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        unsigned char* destination;
+        size_t destinationSize;
+        CodeFirst_SetDirectJsonEncoding(true);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Init(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "{", 1))
+            .IgnoreArgument_buffer();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "\"this_is_int_Property\":", sizeof("\"this_is_int_Property\":") - 1))
+            .IgnoreArgument_buffer();
+        STRICT_EXPECTED_CALL(AgentDataTypes_Int64_ToJSON(IGNORED_PTR_ARG, 1))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, ", \"this_is_double_Property\":", sizeof(", \"this_is_double_Property\":") - 1))
+            .IgnoreArgument_buffer();
+        STRICT_EXPECTED_CALL(AgentDataTypes_Double_ToJSON(IGNORED_PTR_ARG, 42.0))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "}", 1))
+            .IgnoreArgument_buffer();
+        device->this_is_double_Property = 42.0;
+        device->this_is_int_Property = 1;
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 1, device);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, sizeof(expectedJSON) - 1, destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expectedJSON, destination, destinationSize));
+
+        // cleanup
+        free(destination);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_003: [ If the direct JSON path cannot handle the values or fails, CodeFirst_SendAsync shall send them by using the transacted APIs of the device. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsync_with_direct_JSON_encoding_a_whole_device_falls_back_to_transaction_when_ToJSON_fails)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        unsigned char* destination;
+        size_t destinationSize;
+        CodeFirst_SetDirectJsonEncoding(true);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Init(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "{", 1))
+            .IgnoreArgument_buffer();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(AgentDataTypes_Int64_ToJSON(IGNORED_PTR_ARG, 1))
+            .IgnoreArgument_destination()
+            .SetReturn(AGENT_DATA_TYPES_ERROR);
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Deinit(IGNORED_PTR_ARG));
+
+        STRICT_EXPECTED_CALL(Device_StartTransaction(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, 0));
+        STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_int_Property", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(3);
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 0.0));
+        STRICT_EXPECTED_CALL(Device_PublishTransacted(IGNORED_PTR_ARG, "this_is_double_Property", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(3);
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Device_EndTransaction(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument(2)
+            .IgnoreArgument(3);
+        device->this_is_double_Property = 42.0;
+        device->this_is_int_Property = 1;
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_SendAsync(&destination, &destinationSize, 1, device);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_020: [ If maxSize is less than 2 (the size of an empty JSON array), CodeFirst_CreateBatch shall fail and return NULL. ]*/
+    TEST_FUNCTION(CodeFirst_CreateBatch_with_maxSize_1_fails)
+    {
+        // arrange
+
+        // act
+        CODEFIRST_BATCH_HANDLE batch = CodeFirst_CreateBatch(1);
+
+        // assert
+        ASSERT_IS_NULL(batch);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_CODEFIRST_09_024: [ If batch is NULL or numProperties is 0, CodeFirst_AppendToBatch shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_AppendToBatch_with_NULL_batch_fails)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        umock_c_reset_all_calls();
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_AppendToBatch(NULL, 1, &device->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_039: [ If the encoder set with SerializeEncoder is not the JSON encoder, CodeFirst_AppendToBatch shall fail, leave batch as it was and return CODEFIRST_ERROR. ]*/
+    TEST_FUNCTION(CodeFirst_AppendToBatch_with_a_non_JSON_encoder_fails)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        CODEFIRST_BATCH_HANDLE batch = CodeFirst_CreateBatch(CODEFIRST_BATCH_IOTHUB_MAX_SIZE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(DataMarshaller_GetEncoder())
+            .SetReturn(&TEST_CBOR_ENCODER);
+        STRICT_EXPECTED_CALL(DataMarshaller_GetJSONEncoder());
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_AppendToBatch(batch, 1, &device->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 0, CodeFirst_GetBatchSnapshotCount(batch));
+
+        // cleanup
+        CodeFirst_DestroyBatch(batch);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_025: [ If the values are not top level properties of one device, or a whole device, CodeFirst_AppendToBatch shall fail and return CODEFIRST_NOT_A_PROPERTY. ]*/
+    TEST_FUNCTION(CodeFirst_AppendToBatch_with_a_property_from_a_child_model_fails)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        OuterType* device = (OuterType*)CodeFirst_CreateDevice(TEST_OUTERTYPE_MODEL_HANDLE, &ALL_REFLECTED(testModelInModelReflected), sizeof(OuterType), false);
+        CODEFIRST_BATCH_HANDLE batch = CodeFirst_CreateBatch(CODEFIRST_BATCH_IOTHUB_MAX_SIZE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(DataMarshaller_GetEncoder());
+        STRICT_EXPECTED_CALL(DataMarshaller_GetJSONEncoder());
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_OUTERTYPE_MODEL_HANDLE)).SetReturn("OuterType");
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_AppendToBatch(batch, 1, &device->Inner.this_is_double2);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_NOT_A_PROPERTY, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 0, CodeFirst_GetBatchSnapshotCount(batch));
+
+        // cleanup
+        CodeFirst_DestroyBatch(batch);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_019: [ CodeFirst_CreateBatch shall create an empty batch whose serialized form never exceeds maxSize bytes and return a non-NULL handle to it. ]*/
+    /*Tests_SRS_CODEFIRST_09_023: [ CodeFirst_AppendToBatch shall append to batch one snapshot of the values: the JSON object SERIALIZE would produce for them with SerializeDirectJsonEncoding turned on. ]*/
+    /*Tests_SRS_CODEFIRST_09_030: [ On success CodeFirst_AppendToBatch shall return CODEFIRST_OK. ]*/
+    /*Tests_SRS_CODEFIRST_09_033: [ Otherwise CodeFirst_FlushBatch shall hand over in *destination and *destinationSize the JSON array of all the snapshots appended since the last flush, in the order they were appended, and leave batch empty. ]*/
+    TEST_FUNCTION(CodeFirst_FlushBatch_after_2_snapshots_produces_a_JSON_array)
+    {
+        // arrange
+        static const char expectedJSON[] = "[{\"this_is_double_Property\":42.0, \"this_is_int_Property\":1},{\"this_is_double_Property\":42.0, \"this_is_int_Property\":1}]";
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        CODEFIRST_BATCH_HANDLE batch = CodeFirst_CreateBatch(CODEFIRST_BATCH_IOTHUB_MAX_SIZE);
+        unsigned char* destination;
+        size_t destinationSize;
+        device->this_is_double_Property = 42.0;
+        device->this_is_int_Property = 1;
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AppendToBatch(batch, 2, &device->this_is_double_Property, &device->this_is_int_Property));
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AppendToBatch(batch, 2, &device->this_is_double_Property, &device->this_is_int_Property));
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "]", 1))
+            .IgnoreArgument_buffer();
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_FlushBatch(batch, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, sizeof(expectedJSON) - 1, destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expectedJSON, destination, destinationSize));
+        ASSERT_ARE_EQUAL(size_t, 0, CodeFirst_GetBatchSnapshotCount(batch));
+
+        // cleanup
+        free(destination);
+        CodeFirst_DestroyBatch(batch);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_026: [ When the values are the same as for the previous snapshot of batch and no device has been created or destroyed since, CodeFirst_AppendToBatch shall reuse the properties found for the previous snapshot instead of looking them up again. ]*/
+    TEST_FUNCTION(CodeFirst_AppendToBatch_the_same_values_again_does_not_look_up_the_model)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        CODEFIRST_BATCH_HANDLE batch = CodeFirst_CreateBatch(CODEFIRST_BATCH_IOTHUB_MAX_SIZE);
+        device->this_is_double_Property = 42.0;
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AppendToBatch(batch, 1, &device->this_is_double_Property));
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(DataMarshaller_GetEncoder());
+        STRICT_EXPECTED_CALL(DataMarshaller_GetJSONEncoder());
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, ",", 1))
+            .IgnoreArgument_buffer();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "{", 1))
+            .IgnoreArgument_buffer();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "this_is_double_Property", sizeof("this_is_double_Property") - 1))
+            .IgnoreArgument_buffer();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(AgentDataTypes_Double_ToJSON(IGNORED_PTR_ARG, 42.0))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, "}", 1))
+            .IgnoreArgument_buffer();
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_AppendToBatch(batch, 1, &device->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 2, CodeFirst_GetBatchSnapshotCount(batch));
+
+        // cleanup
+        CodeFirst_DestroyBatch(batch);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_023: [ CodeFirst_AppendToBatch shall append to batch one snapshot of the values: the JSON object SERIALIZE would produce for them with SerializeDirectJsonEncoding turned on. ]*/
+    /*Tests_SRS_CODEFIRST_09_040: [ A whole device shall be written by the ToJSON_Device function DECLARE_MODEL generated for its model. ]*/
+    TEST_FUNCTION(CodeFirst_AppendToBatch_with_a_whole_device_Succeeds)
+    {
+        // arrange
+        static const char expectedJSON[] = "[{\"this_is_int_Property\":1, \"this_is_double_Property\":42.0}]";
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        CODEFIRST_BATCH_HANDLE batch = CodeFirst_CreateBatch(CODEFIRST_BATCH_IOTHUB_MAX_SIZE);
+        unsigned char* destination;
+        size_t destinationSize;
+        device->this_is_double_Property = 42.0;
+        device->this_is_int_Property = 1;
+        umock_c_reset_all_calls();
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_AppendToBatch(batch, 1, device);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_FlushBatch(batch, &destination, &destinationSize));
+        ASSERT_ARE_EQUAL(size_t, sizeof(expectedJSON) - 1, destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expectedJSON, destination, destinationSize));
+
+        // cleanup
+        free(destination);
+        CodeFirst_DestroyBatch(batch);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_027: [ If the batch would then exceed its maxSize, CodeFirst_AppendToBatch shall leave batch as it was and return CODEFIRST_BATCH_FULL, so the caller can flush it and append the snapshot again. ]*/
+    TEST_FUNCTION(CodeFirst_AppendToBatch_when_the_snapshot_does_not_fit_returns_CODEFIRST_BATCH_FULL)
+    {
+        // arrange
+        static const char expectedJSON[] = "[{\"this_is_double_Property\":42.0}]";
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        CODEFIRST_BATCH_HANDLE batch = CodeFirst_CreateBatch(sizeof(expectedJSON) - 1);
+        unsigned char* destination;
+        size_t destinationSize;
+        device->this_is_double_Property = 42.0;
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AppendToBatch(batch, 1, &device->this_is_double_Property));
+        umock_c_reset_all_calls();
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_AppendToBatch(batch, 1, &device->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_BATCH_FULL, result);
+        ASSERT_ARE_EQUAL(size_t, 1, CodeFirst_GetBatchSnapshotCount(batch));
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_FlushBatch(batch, &destination, &destinationSize));
+        ASSERT_ARE_EQUAL(size_t, sizeof(expectedJSON) - 1, destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expectedJSON, destination, destinationSize));
+
+        // cleanup
+        free(destination);
+        CodeFirst_DestroyBatch(batch);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_028: [ If batch is empty and the snapshot alone exceeds maxSize, CodeFirst_AppendToBatch shall fail and return CODEFIRST_ERROR. ]*/
+    TEST_FUNCTION(CodeFirst_AppendToBatch_when_a_single_snapshot_does_not_fit_fails)
+    {
+        // arrange
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        CODEFIRST_BATCH_HANDLE batch = CodeFirst_CreateBatch(sizeof("[{\"this_is_double_Property\":42.0}]") - 2);
+        device->this_is_double_Property = 42.0;
+        umock_c_reset_all_calls();
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_AppendToBatch(batch, 1, &device->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_ERROR, result);
+        ASSERT_ARE_EQUAL(size_t, 0, CodeFirst_GetBatchSnapshotCount(batch));
+
+        // cleanup
+        CodeFirst_DestroyBatch(batch);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_029: [ If any other failure occurs, CodeFirst_AppendToBatch shall fail, leave batch as it was and return CODEFIRST_ERROR. ]*/
+    TEST_FUNCTION(CodeFirst_AppendToBatch_when_ToJSON_fails_leaves_the_batch_as_it_was)
+    {
+        // arrange
+        static const char expectedJSON[] = "[{\"this_is_double_Property\":42.0}]";
+        (void)CodeFirst_Init(NULL);
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        CODEFIRST_BATCH_HANDLE batch = CodeFirst_CreateBatch(CODEFIRST_BATCH_IOTHUB_MAX_SIZE);
+        unsigned char* destination;
+        size_t destinationSize;
+        device->this_is_double_Property = 42.0;
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AppendToBatch(batch, 1, &device->this_is_double_Property));
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(DataMarshaller_GetEncoder());
+        STRICT_EXPECTED_CALL(DataMarshaller_GetJSONEncoder());
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Append(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(AgentDataTypes_Double_ToJSON(IGNORED_PTR_ARG, 42.0))
+            .IgnoreArgument_destination()
+            .SetReturn(AGENT_DATA_TYPES_ERROR);
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_AppendToBatch(batch, 1, &device->this_is_double_Property);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, CodeFirst_GetBatchSnapshotCount(batch));
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_FlushBatch(batch, &destination, &destinationSize));
+        ASSERT_ARE_EQUAL(size_t, sizeof(expectedJSON) - 1, destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expectedJSON, destination, destinationSize));
+
+        // cleanup
+        free(destination);
+        CodeFirst_DestroyBatch(batch);
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_031: [ If batch, destination or destinationSize is NULL, CodeFirst_FlushBatch shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_FlushBatch_with_NULL_arguments_fails)
+    {
+        // arrange
+        CODEFIRST_BATCH_HANDLE batch = CodeFirst_CreateBatch(CODEFIRST_BATCH_IOTHUB_MAX_SIZE);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+
+        // act
+        CODEFIRST_RESULT result1 = CodeFirst_FlushBatch(NULL, &destination, &destinationSize);
+        CODEFIRST_RESULT result2 = CodeFirst_FlushBatch(batch, NULL, &destinationSize);
+        CODEFIRST_RESULT result3 = CodeFirst_FlushBatch(batch, &destination, NULL);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result1);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result2);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result3);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        // cleanup
+        CodeFirst_DestroyBatch(batch);
+    }
+
+    /*Tests_SRS_CODEFIRST_09_032: [ If batch holds no snapshot, CodeFirst_FlushBatch shall set *destination to NULL and *destinationSize to 0 and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(CodeFirst_FlushBatch_of_an_empty_batch_produces_nothing)
+    {
+        // arrange
+        CODEFIRST_BATCH_HANDLE batch = CodeFirst_CreateBatch(CODEFIRST_BATCH_IOTHUB_MAX_SIZE);
+        unsigned char* destination = (unsigned char*)0x42;
+        size_t destinationSize = 42;
+        umock_c_reset_all_calls();
+
+        // act
+        CODEFIRST_RESULT result = CodeFirst_FlushBatch(batch, &destination, &destinationSize);
+
+        // assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_IS_NULL(destination);
+        ASSERT_ARE_EQUAL(size_t, 0, destinationSize);
+
+        // cleanup
+        CodeFirst_DestroyBatch(batch);
+    }
+
+    /* CodeFirst_RegisterSchema */
+    /* Tests_SRS_CODEFIRST_99_002:[ CodeFirst_RegisterSchema shall create the schema information and give it to the Schema module for one schema, identified by the metadata argument. On success, it shall return a handle to the model.] */
+    /*Tests_SRS_CODEFIRST_09_036: [ CodeFirst_RegisterSchema shall call Schema_Freeze on the schema it created. If Schema_Freeze fails, CodeFirst_RegisterSchema shall still succeed. ]*/
+    TEST_FUNCTION(CodeFirst_RegisterSchema_succeeds)
+    {
+        static const SCHEMA_STRUCT_TYPE_HANDLE TEST_CAR_BEHIND_VAN_HANDLE = (SCHEMA_STRUCT_TYPE_HANDLE)0x7001;
+
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        umock_c_reset_all_calls();
+        STRICT_EXPECTED_CALL(Schema_GetSchemaByNamespace("TestSchema"));
+        STRICT_EXPECTED_CALL(Schema_Create("TestSchema", IGNORED_PTR_ARG))
+            .IgnoreArgument_metadata();
+        STRICT_EXPECTED_CALL(Schema_CreateStructType(TEST_SCHEMA_HANDLE, "theCarIsBehindTheVan_Struct"))
+            .SetReturn(TEST_CAR_BEHIND_VAN_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_CAR_BEHIND_VAN_HANDLE, "whereIsMyCar_Field", "whereIsMyDevice_Struct"));
+        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_CAR_BEHIND_VAN_HANDLE, "Alt_Field", "int"));
+        STRICT_EXPECTED_CALL(Schema_CreateStructType(TEST_SCHEMA_HANDLE, "whereIsMyDevice_Struct"));
+        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_STRUCT_TYPE_HANDLE, "Long_Field", "double"));
+        STRICT_EXPECTED_CALL(Schema_AddStructTypeProperty(TEST_STRUCT_TYPE_HANDLE, "Lat_Field", "double"));
+        STRICT_EXPECTED_CALL(Schema_CreateModelType(TEST_SCHEMA_HANDLE, "SimpleDevice_Model"))
+            .SetReturn(TEST_TRUCKTYPE_MODEL_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_CreateModelType(TEST_SCHEMA_HANDLE, "truckType_Model"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "SimpleDevice_Model")).SetReturn(TEST_TRUCKTYPE_MODEL_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "double")).SetReturn(NULL);
+        STRICT_EXPECTED_CALL(Schema_AddModelReportedProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "new_reported_this_is_double", "double"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int")).SetReturn(NULL);
+        STRICT_EXPECTED_CALL(Schema_AddModelReportedProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "new_reported_this_is_int", "int"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int")).SetReturn(NULL);
+        STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "this_is_int_Property", "int"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "double")).SetReturn(NULL);
+        STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_TRUCKTYPE_MODEL_HANDLE, "this_is_double_Property", "double"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "truckType_Model")).SetReturn(TEST_MODEL_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_CreateModelAction(TEST_MODEL_HANDLE, "setSpeed_Action"))
+            .SetReturn(SETSPEED_ACTION_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_AddModelActionArgument(SETSPEED_ACTION_HANDLE, "theSpeed", "double"));
+        STRICT_EXPECTED_CALL(Schema_CreateModelAction(TEST_MODEL_HANDLE, "reset_Action"))
+            .SetReturn(RESET_ACTION_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_Freeze(TEST_SCHEMA_HANDLE));
+
+        ///act
+
+        SCHEMA_HANDLE result = CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testReflectedData));
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(void_ptr, TEST_SCHEMA_HANDLE, result);
+
+        ///cleanup
+        CodeFirst_Deinit();
+
+    }
+
+    /* Tests_SRS_CODEFIRST_99_002:[ CodeFirst_RegisterSchema shall create the schema information and give it to the Schema module for one schema, identified by the metadata argument. On success, it shall return a handle to the model.] */
+    TEST_FUNCTION(CodeFirst_RegisterSchema_With_Model_In_Model_succeeds)
+    {
+        static const SCHEMA_STRUCT_TYPE_HANDLE TEST_CAR_BEHIND_VAN_HANDLE = (SCHEMA_STRUCT_TYPE_HANDLE)0x7001;
+
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        umock_c_reset_all_calls();
+        STRICT_EXPECTED_CALL(Schema_GetSchemaByNamespace("TestSchema"));
+        STRICT_EXPECTED_CALL(Schema_Create("TestSchema", TEST_SCHEMA_METADATA))
+            .IgnoreArgument_metadata();
+        STRICT_EXPECTED_CALL(Schema_CreateModelType(TEST_SCHEMA_HANDLE, "OuterType"))
+            .SetReturn(TEST_OUTERTYPE_MODEL_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_CreateModelType(TEST_SCHEMA_HANDLE, "InnerType"))
+            .SetReturn(TEST_INNERTYPE_MODEL_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "OuterType"))
+            .SetReturn(TEST_OUTERTYPE_MODEL_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_CreateModelAction(TEST_OUTERTYPE_MODEL_HANDLE, "OuterType_reset_Action"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "InnerType"))
+            .SetReturn(TEST_INNERTYPE_MODEL_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_AddModelModel(TEST_OUTERTYPE_MODEL_HANDLE, "Inner", TEST_INNERTYPE_MODEL_HANDLE, 8, NULL));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "InnerType"))
+            .SetReturn(TEST_INNERTYPE_MODEL_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int"));
+        STRICT_EXPECTED_CALL(Schema_AddModelDesiredProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_desired_int_Property_2", "int", IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, NULL))
+            .IgnoreArgument_desiredPropertyDeinitialize()
+            .IgnoreArgument_desiredPropertyInitialize()
+            .IgnoreArgument_desiredPropertyFromAGENT_DATA_TYPE()
+            .IgnoreArgument_offset();
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int"));
+        STRICT_EXPECTED_CALL(Schema_AddModelReportedProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_reported_int_Property_2", "int"));
+        STRICT_EXPECTED_CALL(Schema_CreateModelAction(TEST_INNERTYPE_MODEL_HANDLE, "InnerType_reset_Action"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "double"));
+        STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_double2", "double"));
+        STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int"));
+        STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_int2", "int"));
+        STRICT_EXPECTED_CALL(Schema_Freeze(TEST_SCHEMA_HANDLE));
+
+        ///act
+        SCHEMA_HANDLE result = CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testModelInModelReflected));
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(void_ptr, TEST_SCHEMA_HANDLE, result);
+
+        ///cleanup
+        CodeFirst_Deinit();
+
+    }
+
+    /* Tests_SRS_CODEFIRST_99_076:[If any Schema APIs fail, CodeFirst_RegisterSchema shall return NULL.] */
+    TEST_FUNCTION(When_Schema_Create_Fails_Then_CodeFirst_RegisterSchema_Fails)
+    {
+
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        umock_c_reset_all_calls();
+        STRICT_EXPECTED_CALL(Schema_GetSchemaByNamespace("TestSchema"));
+        STRICT_EXPECTED_CALL(Schema_Create("TestSchema", TEST_SCHEMA_METADATA))
+            .SetReturn((SCHEMA_HANDLE)NULL);
+
+        ///act
+        SCHEMA_HANDLE result = CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testReflectedData));
 
         ///assert
         ASSERT_IS_NULL(result);
@@ -3859,6 +4679,427 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         CodeFirst_Deinit();
     }
 
+    static int count_actual_calls(const char* callPrefix)
+    {
+        int result = 0;
+        const char* actualCalls = umock_c_get_actual_calls();
+        const char* where;
+        for (where = strstr(actualCalls, callPrefix); where != NULL; where = strstr(where + 1, callPrefix))
+        {
+            result++;
+        }
+        return result;
+    }
+
+    static void CodeFirst_SendAsyncReportedDirty_build_leaves_inert_path(void)
+    {
+        STRICT_EXPECTED_CALL(Schema_GetModelName(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_construct(""));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "new_reported_this_is_int"))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_construct(""));
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "new_reported_this_is_double"))
+            .IgnoreArgument_handle();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_009: [ If destination, destinationSize, device or reportToken is NULL then CodeFirst_SendAsyncReportedDirty shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDirty_with_NULL_arguments_fails)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 0;
+        unsigned char *destination = NULL;
+        size_t reportToken = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result1 = CodeFirst_SendAsyncReportedDirty(NULL, &destinationSize, device, &reportToken);
+        CODEFIRST_RESULT result2 = CodeFirst_SendAsyncReportedDirty(&destination, NULL, device, &reportToken);
+        CODEFIRST_RESULT result3 = CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, NULL, &reportToken);
+        CODEFIRST_RESULT result4 = CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result1);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result2);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result3);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result4);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_010: [ If device is not a pointer returned by CodeFirst_CreateDevice then CodeFirst_SendAsyncReportedDirty shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDirty_with_a_property_instead_of_the_device_fails)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 0;
+        unsigned char *destination = NULL;
+        size_t reportToken = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, &device->new_reported_this_is_int, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_011: [ CodeFirst_SendAsyncReportedDirty shall consider every reported property of the model of the device, going down into reported properties that are models. ]*/
+    /*Tests_SRS_CODEFIRST_09_012: [ A reported property is dirty when it has never been acknowledged or when its JSON differs from the JSON acknowledged last time. ]*/
+    /*Tests_SRS_CODEFIRST_09_013: [ CodeFirst_SendAsyncReportedDirty shall publish only the dirty reported properties, by their full path, in one transaction created by Device_CreateTransaction_ReportedProperties. ]*/
+    /*Tests_SRS_CODEFIRST_09_015: [ CodeFirst_SendAsyncReportedDirty shall commit the transaction by calling Device_CommitTransaction_ReportedProperties. ]*/
+    /*Tests_SRS_CODEFIRST_09_020: [ CodeFirst_SendAsyncReportedDirty shall give the pending report a token that is not 0 and larger than the token of any earlier report of the device, set *reportToken to it and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDirty_first_report_sends_all_reported_properties)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 0;
+        unsigned char *destination = NULL;
+        size_t reportToken = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 5.5;
+        umock_c_reset_all_calls();
+
+        CodeFirst_SendAsyncReportedDirty_build_leaves_inert_path();
+
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_SINT32(IGNORED_PTR_ARG, -5))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(Device_CreateTransaction_ReportedProperties(TEST_DEVICE_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(Device_PublishTransacted_ReportedProperty(IGNORED_PTR_ARG, "new_reported_this_is_int", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument_data();
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_DOUBLE(IGNORED_PTR_ARG, 5.5))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments();
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(Device_PublishTransacted_ReportedProperty(IGNORED_PTR_ARG, "new_reported_this_is_double", IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle()
+            .IgnoreArgument_data();
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+
+        STRICT_EXPECTED_CALL(Device_CommitTransaction_ReportedProperties(IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_transactionHandle();
+        STRICT_EXPECTED_CALL(Device_DestroyTransaction_ReportedProperties(IGNORED_PTR_ARG))
+            .IgnoreArgument_transactionHandle();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_NOT_EQUAL(size_t, 0, reportToken);
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_014: [ If no reported property is dirty, CodeFirst_SendAsyncReportedDirty shall set *destination to NULL, *destinationSize to 0 and *reportToken to 0 and return CODEFIRST_OK. ]*/
+    /*Tests_SRS_CODEFIRST_09_018: [ CodeFirst_AcknowledgeReportedProperties shall make the values sent by the report of reportToken the acknowledged values, so they are no longer dirty, and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDirty_after_acknowledge_with_no_change_sends_nothing)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 0;
+        unsigned char *destination = NULL;
+        size_t reportToken = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 5.5;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AcknowledgeReportedProperties(device, reportToken));
+        destination = (unsigned char*)0x1;
+        destinationSize = 1;
+        reportToken = 42;
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_IS_NULL(destination);
+        ASSERT_ARE_EQUAL(size_t, 0, destinationSize);
+        ASSERT_ARE_EQUAL(size_t, 0, reportToken);
+        ASSERT_ARE_EQUAL(int, 0, count_actual_calls("Device_CreateTransaction_ReportedProperties("));
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_012: [ A reported property is dirty when it has never been acknowledged or when its JSON differs from the JSON acknowledged last time. ]*/
+    /*Tests_SRS_CODEFIRST_09_013: [ CodeFirst_SendAsyncReportedDirty shall publish only the dirty reported properties, by their full path, in one transaction created by Device_CreateTransaction_ReportedProperties. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDirty_after_acknowledge_sends_only_the_changed_property)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 0;
+        unsigned char *destination = NULL;
+        size_t reportToken = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 5.5;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+        (void)CodeFirst_AcknowledgeReportedProperties(device, reportToken);
+        device->new_reported_this_is_double = 6.5;
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(int, 1, count_actual_calls("Device_PublishTransacted_ReportedProperty("));
+        ASSERT_ARE_EQUAL(int, 1, count_actual_calls("\"new_reported_this_is_double\""));
+        ASSERT_ARE_EQUAL(int, 1, count_actual_calls("Device_CommitTransaction_ReportedProperties("));
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_016: [ If any error occurs, CodeFirst_SendAsyncReportedDirty shall fail and leave the acknowledged state and the pending reports of the device unchanged. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDirty_when_commit_fails_keeps_the_properties_dirty)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 0;
+        unsigned char *destination = NULL;
+        size_t reportToken = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Device_CommitTransaction_ReportedProperties(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreAllArguments()
+            .SetReturn(DEVICE_ERROR);
+        CODEFIRST_RESULT result1 = CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+        (void)CodeFirst_AcknowledgeReportedProperties(device, reportToken);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result2 = CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_DEVICE_PUBLISH_FAILED, result1);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result2);
+        ASSERT_ARE_EQUAL(int, 2, count_actual_calls("Device_PublishTransacted_ReportedProperty("));
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_019: [ CodeFirst_SendAsyncReportedDirty shall keep the values it sends in a pending report of their own, leaving the pending reports of earlier calls untouched. ]*/
+    /*Tests_SRS_CODEFIRST_09_020: [ CodeFirst_SendAsyncReportedDirty shall give the pending report a token that is not 0 and larger than the token of any earlier report of the device, set *reportToken to it and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDirty_second_report_gets_a_larger_token)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 0;
+        unsigned char *destination = NULL;
+        size_t firstReportToken = 0;
+        size_t secondReportToken = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 5.5;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &firstReportToken);
+        device->new_reported_this_is_double = 6.5;
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &secondReportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_NOT_EQUAL(size_t, 0, firstReportToken);
+        ASSERT_IS_TRUE(secondReportToken > firstReportToken);
+        ASSERT_ARE_EQUAL(int, 2, count_actual_calls("Device_PublishTransacted_ReportedProperty("));
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_018: [ CodeFirst_AcknowledgeReportedProperties shall make the values sent by the report of reportToken the acknowledged values, so they are no longer dirty, and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(CodeFirst_AcknowledgeReportedProperties_of_an_earlier_report_keeps_the_later_changes_dirty)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 0;
+        unsigned char *destination = NULL;
+        size_t firstReportToken = 0;
+        size_t secondReportToken = 0;
+        size_t reportToken = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 5.5;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &firstReportToken);
+        device->new_reported_this_is_double = 6.5;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &secondReportToken);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_AcknowledgeReportedProperties(device, firstReportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken));
+        ASSERT_ARE_EQUAL(int, 1, count_actual_calls("Device_PublishTransacted_ReportedProperty("));
+        ASSERT_ARE_EQUAL(int, 1, count_actual_calls("\"new_reported_this_is_double\""));
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_022: [ If reportToken is not the token of a pending report of the device, because it is 0, already acknowledged or superseded by the acknowledgement of a later report, then CodeFirst_AcknowledgeReportedProperties shall leave the device unchanged and return CODEFIRST_OK. ]*/
+    TEST_FUNCTION(CodeFirst_AcknowledgeReportedProperties_late_for_an_earlier_report_does_not_undo_the_later_one)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 0;
+        unsigned char *destination = NULL;
+        size_t firstReportToken = 0;
+        size_t secondReportToken = 0;
+        size_t reportToken = 42;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 5.5;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &firstReportToken);
+        device->new_reported_this_is_double = 6.5;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &secondReportToken);
+        (void)CodeFirst_AcknowledgeReportedProperties(device, secondReportToken);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_AcknowledgeReportedProperties(device, firstReportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken));
+        ASSERT_ARE_EQUAL(size_t, 0, reportToken);
+        ASSERT_ARE_EQUAL(int, 0, count_actual_calls("Device_CreateTransaction_ReportedProperties("));
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_023: [ CodeFirst_AcknowledgeReportedProperties shall drop the pending reports older than the acknowledged one, and the reported properties they carried that the acknowledged report does not carry shall be dirty again. ]*/
+    TEST_FUNCTION(CodeFirst_AcknowledgeReportedProperties_makes_the_properties_of_skipped_reports_dirty_again)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 0;
+        unsigned char *destination = NULL;
+        size_t reportToken = 0;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 5.5;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+        (void)CodeFirst_AcknowledgeReportedProperties(device, reportToken);
+        device->new_reported_this_is_int = -6;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 6.5;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_AcknowledgeReportedProperties(device, reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken));
+        ASSERT_ARE_EQUAL(int, 1, count_actual_calls("Device_PublishTransacted_ReportedProperty("));
+        ASSERT_ARE_EQUAL(int, 1, count_actual_calls("\"new_reported_this_is_int\""));
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_021: [ When the device already has CODEFIRST_MAX_PENDING_REPORTS pending reports, CodeFirst_SendAsyncReportedDirty shall drop the oldest one and the reported properties it carried shall be dirty again. ]*/
+    TEST_FUNCTION(CodeFirst_SendAsyncReportedDirty_with_too_many_pending_reports_drops_the_oldest)
+    {
+        ///arrange
+        (void)CodeFirst_Init(NULL);
+        size_t destinationSize = 0;
+        unsigned char *destination = NULL;
+        size_t reportToken = 0;
+        int i;
+        SimpleDevice_Model* device = (SimpleDevice_Model*)CodeFirst_CreateDevice(TEST_MODEL_HANDLE, &ALL_REFLECTED(testReflectedData), sizeof(SimpleDevice_Model), false);
+        device->new_reported_this_is_int = -5;
+        device->new_reported_this_is_double = 5.5;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+        (void)CodeFirst_AcknowledgeReportedProperties(device, reportToken);
+        /*CODEFIRST_MAX_PENDING_REPORTS is 8, the first of these carries only new_reported_this_is_int*/
+        device->new_reported_this_is_int = 1;
+        (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+        device->new_reported_this_is_int = -5;
+        for (i = 0; i < 7; i++)
+        {
+            device->new_reported_this_is_double = 6.5 + i;
+            (void)CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+        }
+        device->new_reported_this_is_double = 20.5;
+        umock_c_reset_all_calls();
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(int, 1, count_actual_calls("\"new_reported_this_is_double\""));
+        ASSERT_ARE_EQUAL(int, 0, count_actual_calls("\"new_reported_this_is_int\""));
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_AcknowledgeReportedProperties(device, reportToken));
+        umock_c_reset_all_calls();
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, CodeFirst_SendAsyncReportedDirty(&destination, &destinationSize, device, &reportToken));
+        ASSERT_ARE_EQUAL(int, 1, count_actual_calls("Device_PublishTransacted_ReportedProperty("));
+        ASSERT_ARE_EQUAL(int, 1, count_actual_calls("\"new_reported_this_is_int\""));
+
+        ///clean
+        CodeFirst_DestroyDevice(device);
+        CodeFirst_Deinit();
+    }
+
+    /*Tests_SRS_CODEFIRST_09_017: [ If device is NULL or is not a pointer returned by CodeFirst_CreateDevice then CodeFirst_AcknowledgeReportedProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
+    TEST_FUNCTION(CodeFirst_AcknowledgeReportedProperties_with_NULL_device_fails)
+    {
+        ///arrange
+
+        ///act
+        CODEFIRST_RESULT result = CodeFirst_AcknowledgeReportedProperties(NULL, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_INVALID_ARG, result);
+
+        ///clean
+    }
+
     /*Tests_SRS_CODEFIRST_02_030: [ If argument device is NULL then CodeFirst_IngestDesiredProperties shall fail and return CODEFIRST_INVALID_ARG. ]*/
     TEST_FUNCTION(CodeFirst_IngestDesiredProperties_with_NULL_device_fails)
     {
@@ -3969,6 +5210,7 @@ BEGIN_TEST_SUITE(CodeFirst_ut_Dummy_Data_Provider)
         STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_double2_onDesiredProperty", "double"));
         STRICT_EXPECTED_CALL(Schema_GetModelByName(TEST_SCHEMA_HANDLE, "int"));
         STRICT_EXPECTED_CALL(Schema_AddModelProperty(TEST_INNERTYPE_MODEL_HANDLE, "this_is_int2_onDesiredProperty", "int"));
+        STRICT_EXPECTED_CALL(Schema_Freeze(TEST_SCHEMA_HANDLE));
 
         ///act
         SCHEMA_HANDLE result = CodeFirst_RegisterSchema("TestSchema", &ALL_REFLECTED(testModelInModelReflected_with_onDesiredProperty));
@@ -18,6 +18,11 @@ static void* my_gballoc_malloc(size_t t)
     return malloc(t);
 }
 
+static void* my_gballoc_realloc(void* p, size_t t)
+{
+    return realloc(p, t);
+}
+
 static void my_gballoc_free(void * t)
 {
     free(t);
@@ -58,6 +63,7 @@ static const SCHEMA_MODEL_TYPE_HANDLE TEST_CHILD_MODEL_HANDLE = (SCHEMA_MODEL_TY
 static const MULTITREE_HANDLE TEST_NESTED_STRUCT_NODE = (MULTITREE_HANDLE)0x4283;
 static const SCHEMA_PROPERTY_HANDLE memberNestedComplexTypeProperty = (SCHEMA_PROPERTY_HANDLE)0x4403;
 static char lastMemberNames[100][100][100];
+static AGENT_DATA_TYPE lastMemberValues[100][10];
 static AGENT_DATA_TYPE LatAgentDataType;
 static AGENT_DATA_TYPE LongAgentDataType;
 static const MULTITREE_HANDLE TEST_MEMBER1_NODE = (MULTITREE_HANDLE)0x4401;
@@ -135,6 +141,7 @@ static void* TEST_CALLBACK_CONTEXT_VALUE = (void*)0x4242;
 static bool isIoTHubMessage_GetData_writing_to_outputs = true;
 static size_t nCall = 0;
 static AGENT_DATA_TYPE StateAgentDataType;
+static AGENT_DATA_TYPE methodArgumentAgentDataType; /*what CreateAgentDataType_From_String produces for a method argument*/
 
 static SCHEMA_METHOD_HANDLE TEST_MODEL_METHOD_HANDLE = (SCHEMA_METHOD_HANDLE)0x56;
 static SCHEMA_METHOD_ARGUMENT_HANDLE TEST_METHOD_ARGUMENT_HANDLE_0 = (SCHEMA_METHOD_ARGUMENT_HANDLE)0x57;
@@ -185,6 +192,70 @@ static JSON_DECODER_RESULT my_JSONDecoder_JSON_To_MultiTree(char* json, MULTITRE
     return JSON_DECODER_OK;
 }
 
+/*a member with a NULL value closes the last object or array that was not skipped*/
+typedef struct TEST_JSON_EVENT_TAG
+{
+    const char* name;
+    JSON_DECODER_VALUE_TYPE valueType;
+    const char* value;
+} TEST_JSON_EVENT;
+
+static const TEST_JSON_EVENT* testJsonEvents;
+static size_t testJsonEventCount;
+
+static void set_test_json_events(const TEST_JSON_EVENT* events, size_t count)
+{
+    testJsonEvents = events;
+    testJsonEventCount = count;
+}
+
+static JSON_DECODER_RESULT my_JSONDecoder_JSON_To_Callbacks(const char* json, const JSON_DECODER_CALLBACKS* callbacks, void* context)
+{
+    JSON_DECODER_RESULT result = JSON_DECODER_OK;
+    size_t i;
+    (void)json;
+
+    for (i = 0; i < testJsonEventCount; i++)
+    {
+        const TEST_JSON_EVENT* event = &testJsonEvents[i];
+        JSON_DECODER_ACTION action;
+        bool isContainer = (event->valueType == JSON_DECODER_VALUE_OBJECT) || (event->valueType == JSON_DECODER_VALUE_ARRAY);
+
+        if (event->value == NULL)
+        {
+            action = callbacks->onEnd(context);
+        }
+        else
+        {
+            action = callbacks->onValue(context, event->name, (event->name == NULL) ? 0 : strlen(event->name), event->valueType, event->value, isContainer ? 0 : strlen(event->value));
+        }
+
+        if (action == JSON_DECODER_ACTION_ABORT)
+        {
+            result = JSON_DECODER_ERROR;
+            break;
+        }
+        else if ((action == JSON_DECODER_ACTION_SKIP) && isContainer && (event->value != NULL))
+        {
+            /*step over the nested events like the real decoder does*/
+            size_t depth = 1;
+            while ((depth > 0) && (++i < testJsonEventCount))
+            {
+                if (testJsonEvents[i].value == NULL)
+                {
+                    depth--;
+                }
+                else if ((testJsonEvents[i].valueType == JSON_DECODER_VALUE_OBJECT) || (testJsonEvents[i].valueType == JSON_DECODER_VALUE_ARRAY))
+                {
+                    depth++;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
 static void my_MultiTree_Destroy(MULTITREE_HANDLE treeHandle)
 {
     (void)(treeHandle);
@@ -193,12 +264,15 @@ static void my_MultiTree_Destroy(MULTITREE_HANDLE treeHandle)
 
 static AGENT_DATA_TYPES_RESULT my_Create_AGENT_DATA_TYPE_from_Members(AGENT_DATA_TYPE* agentData, const char* typeName, size_t nMembers, const char* const * memberNames, const AGENT_DATA_TYPE* memberValues)
 {
-    (void)memberValues;
     (void)typeName;
     (void)agentData;
     for (size_t i = 0; i < nMembers; i++)
     {
         strcpy(lastMemberNames[nCall][i], memberNames[i]);
+        if (i < 10)
+        {
+            lastMemberValues[nCall][i] = memberValues[i];
+        }
     }
     nCall++;
     return AGENT_DATA_TYPES_OK;
@@ -294,6 +368,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
         REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
 
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_MODEL_TYPE_HANDLE, void*);
@@ -309,6 +385,7 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         REGISTER_UMOCK_ALIAS_TYPE(pfOnDesiredProperty, void*);
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_METHOD_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(SCHEMA_METHOD_ARGUMENT_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(const JSON_DECODER_CALLBACKS*, void*);
 
 
         REGISTER_UMOCK_ALIAS_TYPE(JSON_DECODER_RESULT, int);
@@ -328,9 +405,13 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
         REGISTER_GLOBAL_MOCK_HOOK(JSONDecoder_JSON_To_MultiTree, my_JSONDecoder_JSON_To_MultiTree);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONDecoder_JSON_To_MultiTree, JSON_DECODER_ERROR);
+        REGISTER_GLOBAL_MOCK_HOOK(JSONDecoder_JSON_To_Callbacks, my_JSONDecoder_JSON_To_Callbacks);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONDecoder_JSON_To_Callbacks, JSON_DECODER_ERROR);
         REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Destroy, my_MultiTree_Destroy);
 
         REGISTER_GLOBAL_MOCK_HOOK(Create_AGENT_DATA_TYPE_from_Members, my_Create_AGENT_DATA_TYPE_from_Members);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(Create_AGENT_DATA_TYPE_from_Members, AGENT_DATA_TYPES_ERROR);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(Schema_GetStructTypePropertyCount, SCHEMA_ERROR);
 
         REGISTER_GLOBAL_MOCK_RETURN(Schema_GetSchemaForModelType, TEST_SCHEMA_HANDLE);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(Schema_GetSchemaForModelType, NULL);
@@ -392,6 +473,7 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
         nCall = 0;
         memset(lastMemberNames, 0, sizeof(lastMemberNames));
+        memset(lastMemberValues, 0, sizeof(lastMemberValues));
 
         StateAgentDataType.type = EDM_BOOLEAN_TYPE;
         StateAgentDataType.value.edmBoolean.value = EDM_TRUE;
@@ -2978,95 +3060,82 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    void CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, const char* three, size_t one, MULTITREE_HANDLE childHandle, bool desiredPropertyHasCallback)
+    static void run_negative_tests(COMMAND_DECODER_HANDLE commandDecoderHandle, unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, bool parseDesiredNode, const size_t* calls_that_cannot_fail, size_t count_of_calls_that_cannot_fail)
     {
-        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
-            .IgnoreArgument_destination();
+        for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+        {
+            size_t j;
+            umock_c_negative_tests_reset();
 
-        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_json()
-            .IgnoreArgument_multiTreeHandle();
+            for (j = 0; j < count_of_calls_that_cannot_fail; j++) /*not running the tests that cannot fail*/
+            {
+                if (calls_that_cannot_fail[j] == i)
+                    break;
+            }
 
-        STRICT_EXPECTED_CALL(MultiTree_DeleteChild(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_childName();
+            if (j == count_of_calls_that_cannot_fail)
+            {
+                umock_c_negative_tests_fail_call(i);
+                char temp_str[128];
+                sprintf(temp_str, "On failed call %lu", (unsigned long)i);
 
-        STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*2*/
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_count(&one, sizeof(one));
+                ///act
+                EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, parseDesiredNode);
 
-        STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
+                ///assert
+                ASSERT_ARE_NOT_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result, temp_str);
+            }
+        }
+    }
 
-        STRICT_EXPECTED_CALL(STRING_new())
-            .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
+    /*the payload is walked once, the values are written after the walk*/
+    static void setup_ingest_desired_properties_walk(const char* desiredPropertiesJSON)
+    {
+        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Callbacks(desiredPropertiesJSON, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_callbacks()
+            .IgnoreArgument_context();
+    }
 
-        STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "int_field"*/
+    static int read_int_field(const unsigned char* deviceMemoryArea, size_t offset)
+    {
+        int value;
+        (void)memcpy(&value, deviceMemoryArea + offset, sizeof(value));
+        return value;
+    }
 
-        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*6*/
-            .SetReturn("int_field");
+    static const TEST_JSON_EVENT int_field_events[] =
+    {
+        { "int_field", JSON_DECODER_VALUE_NUMBER, "3" }
+    };
 
-        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "int_field"))
+    static void CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, size_t modelOffset, SCHEMA_MODEL_TYPE_HANDLE modelHandle, bool desiredPropertyHasCallback)
+    {
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(modelHandle, "int_field"))
             .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
 
+        /*"int" is decoded straight into the field, without CreateAgentDataType_From_String and pfDesiredPropertyFromAGENT_DATA_TYPE*/
         STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
             .SetReturn("int");
 
-        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE))
-            .SetReturn(TEST_SCHEMA);
-
-        /*this is DecodeValueFromNode expected calls*/
-
-        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
-            .SetReturn(EDM_INT32_TYPE);
-
-        STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_destination(&three, sizeof(three));
-
-        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(IGNORED_PTR_ARG, EDM_INT32_TYPE, IGNORED_PTR_ARG))
-            .IgnoreArgument_source()
-            .IgnoreArgument_agentData()
-            .SetReturn(AGENT_DATA_TYPES_OK);
-
-        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
-            .SetReturn(int_pfDesiredPropertyFromAGENT_DATA_TYPE);
-
         STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
             .SetReturn(2);
 
-        STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + 2))
-            .IgnoreArgument_source();
-
-        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(IGNORED_PTR_ARG))
-            .IgnoreArgument_desiredPropertyHandle()
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
             .SetReturn(desiredPropertyHasCallback ? onDesiredPropertySimpleProperty : NULL);
 
         if (desiredPropertyHasCallback)
         {
-            STRICT_EXPECTED_CALL(onDesiredPropertySimpleProperty(IGNORED_PTR_ARG))
-                .IgnoreArgument_v();
+            STRICT_EXPECTED_CALL(onDesiredPropertySimpleProperty((unsigned char*)deviceMemoryArea + modelOffset));
         }
-
-        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
-            .IgnoreArgument_agentData();
-
-        STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
-
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
     }
 
     /*case1: a simple property (non-recursive) is ingested*/
     /*the property is called "int_field" and shall have the value 3*/
-    /*Tests_SRS_COMMAND_DECODER_02_005: [ CommandDecoder_IngestDesiredProperties shall create a MULTITREE_HANDLE ouf of the clone of desiredProperties. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_007: [ If the child name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the MULTITREE node. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_010: [ If the complete MULTITREE has been parsed then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_001: [ CommandDecoder_IngestDesiredProperties shall walk jsonPayload once with JSONDecoder_JSON_To_Callbacks, without cloning jsonPayload and without building a MULTITREE. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_013: [ If the desired property, or the member of a struct, has one of the types double, float, int, long, int8_t, uint8_t, int16_t, int32_t, int64_t, bool, ascii_char_ptr and ascii_char_ptr_no_quotes then its value shall be decoded in place from jsonPayload into that C type, with the rules of CreateAgentDataType_From_String. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_014: [ The decoded values shall be staged, and only written to the device once the whole jsonPayload has been walked. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_010: [ If the complete JSON has been applied then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
     TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_happy_path)
     {
         ///arrange
@@ -3074,11 +3143,10 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        set_test_json_events(int_field_events, COUNT_OF(int_field_events));
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        setup_ingest_desired_properties_walk(desiredPropertiesJSON);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, 0, TEST_MODEL_HANDLE, false);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3086,10 +3154,10 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+        ASSERT_ARE_EQUAL(int, 3, read_int_field(deviceMemoryArea, 2));
 
         ///clean
         CommandDecoder_Destroy(commandDecoderHandle);
-
     }
 
     /*Tests_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
@@ -3099,60 +3167,24 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        set_test_json_events(int_field_events, COUNT_OF(int_field_events));
         (void)umock_c_negative_tests_init();
         umock_c_reset_all_calls();
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        setup_ingest_desired_properties_walk(desiredPropertiesJSON);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, 0, TEST_MODEL_HANDLE, false);
 
         umock_c_negative_tests_snapshot();
 
         size_t calls_that_cannot_fail[] =
         {
-            2, /*MultiTree_DeleteChild*/
-
-            3,/*MultiTree_GetChildCount*/
-            7, /*STRING_c_str*/
-
-            9, /*Schema_GetModelDesiredPropertyType*/
-            10, /*Schema_GetSchemaForModelType*/
-            11, /*CodeFirst_GetPrimitiveType*/
-            14, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
-            15, /*Schema_GetModelDesiredProperty_offset*/
-            17, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
-            18, /*Destroy_AGENT_DATA_TYPE*/
-            19, /*STRING_delete*/
-            20, /*MultiTree_Destroy*/
-            21 /*gballoc_free*/
+            0, /*Schema_GetSchemaForModelType*/
+            3, /*Schema_GetModelDesiredPropertyType*/
+            4, /*Schema_GetModelDesiredProperty_offset*/
+            5 /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
         };
 
-        for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
-        {
-            size_t j;
-            umock_c_negative_tests_reset();
-
-            for (j = 0;j<sizeof(calls_that_cannot_fail) / sizeof(calls_that_cannot_fail[0]);j++) /*not running the tests that cannot fail*/
-            {
-                if (calls_that_cannot_fail[j] == i)
-                    break;
-            }
-
-            if (j == sizeof(calls_that_cannot_fail) / sizeof(calls_that_cannot_fail[0]))
-            {
-
-                umock_c_negative_tests_fail_call(i);
-                char temp_str[128];
-                sprintf(temp_str, "On failed call %lu", (unsigned long)i);
-
-                ///act
-                EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
-
-                ///assert
-                ASSERT_ARE_NOT_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result, temp_str);
-            }
-        }
+        run_negative_tests(commandDecoderHandle, deviceMemoryArea, desiredPropertiesJSON, false, calls_that_cannot_fail, COUNT_OF(calls_that_cannot_fail));
 
         umock_c_negative_tests_deinit();
 
@@ -3160,129 +3192,37 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    void CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, const char* three, size_t one, MULTITREE_HANDLE childHandle, bool desiredPropertiesHaveCallbacks)
+    static const TEST_JSON_EVENT model_in_model_events[] =
     {
-        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
-            .IgnoreArgument_destination();
-
-        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_json()
-            .IgnoreArgument_multiTreeHandle();
-
-        STRICT_EXPECTED_CALL(MultiTree_DeleteChild(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_childName();
+        { "modelInModel", JSON_DECODER_VALUE_OBJECT, "{" },
+        { "int_field", JSON_DECODER_VALUE_NUMBER, "3" },
+        { NULL, JSON_DECODER_VALUE_OBJECT, NULL }
+    };
 
-        STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*2*/
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_count(&one, sizeof(one));
-
-        STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
-
-        STRICT_EXPECTED_CALL(STRING_new())
-            .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
-
-        STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "modelInModel"*/
-
-        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*6*/
-            .SetReturn("modelInModel");
+    static void CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, bool desiredPropertiesHaveCallbacks)
+    {
+        setup_ingest_desired_properties_walk(desiredPropertiesJSON);
 
         STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "modelInModel"))
             .SetReturn(Schema_GetModelElementByName_modelInModel);
 
-        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_Offset(TEST_MODEL_HANDLE, "modelInModel")) /*9*/
+        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_Offset(TEST_MODEL_HANDLE, "modelInModel")) /*3*/
             .SetReturn(10);
 
-        /*here recursion happens*/
-
-        {
-            STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*10*/
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_count(&one, sizeof(one));
-
-            STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
-
-            STRICT_EXPECTED_CALL(STRING_new())
-                .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
-
-            STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*13*/ /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "int_field"*/
-
-            STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*14*/
-                .SetReturn("int_field");
-
-            STRICT_EXPECTED_CALL(Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL, "int_field"))
-                .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
-
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*17*/
-                .SetReturn("int");
-
-            STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL)) /*18*/
-                .SetReturn(TEST_SCHEMA);
-
-            /*this is DecodeValueFromNodea expected calls*/
-
-            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int")) /*19*/
-                .SetReturn(EDM_INT32_TYPE);
-
-            STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_destination(&three, sizeof(three));
-
-            STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(IGNORED_PTR_ARG, EDM_INT32_TYPE, IGNORED_PTR_ARG))
-                .IgnoreArgument_source()
-                .IgnoreArgument_agentData()
-                .SetReturn(AGENT_DATA_TYPES_OK);
-
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*22*/
-                .SetReturn(int_pfDesiredPropertyFromAGENT_DATA_TYPE);
-
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*23*/
-                .SetReturn(2);
-
-            STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + 12))  /*notice here the new offset (2+10)*/
-                .IgnoreArgument_source();
-
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(IGNORED_PTR_ARG)) /*24*/
-                .IgnoreArgument_desiredPropertyHandle()
-                .SetReturn(desiredPropertiesHaveCallbacks ? onDesiredPropertySimpleProperty : NULL);
-
-            if (desiredPropertiesHaveCallbacks)
-            {
-                STRICT_EXPECTED_CALL(onDesiredPropertySimpleProperty(IGNORED_PTR_ARG))
-                    .IgnoreArgument_v();
-            }
-
-
-            STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
-                .IgnoreArgument_agentData();
-
-            STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
-        }
-
-        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_OnDesiredProperty(IGNORED_PTR_ARG, "modelInModel")) /*27*/
-            .IgnoreArgument_modelTypeHandle()
+        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_OnDesiredProperty(TEST_MODEL_HANDLE, "modelInModel")) /*4*/
             .SetReturn(desiredPropertiesHaveCallbacks ? onDesiredPropertyModelInModel : NULL);
 
+        /*notice here the new offset (2+10)*/
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, 10, SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL, desiredPropertiesHaveCallbacks);
+
+        /*the callback of the model in model is called after the values of its object have been written*/
         if (desiredPropertiesHaveCallbacks)
         {
-            STRICT_EXPECTED_CALL(onDesiredPropertyModelInModel(IGNORED_PTR_ARG))
-                .IgnoreArgument_v();
+            STRICT_EXPECTED_CALL(onDesiredPropertyModelInModel(deviceMemoryArea));
         }
-
-        STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
-
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the function shall call itself recursively. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_009: [ If the member name corresponds to a model in model then its object shall be applied to the child model at the child model offset. ]*/
     TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_happy_path)
     {
         ///arrange
@@ -3290,11 +3230,9 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        set_test_json_events(model_in_model_events, COUNT_OF(model_in_model_events));
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, false);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3302,10 +3240,10 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+        ASSERT_ARE_EQUAL(int, 3, read_int_field(deviceMemoryArea, 10 + 2));
 
         ///clean
         CommandDecoder_Destroy(commandDecoderHandle);
-
     }
 
     /*Tests_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
@@ -3315,65 +3253,25 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        set_test_json_events(model_in_model_events, COUNT_OF(model_in_model_events));
         (void)umock_c_negative_tests_init();
         umock_c_reset_all_calls();
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, false);
 
         umock_c_negative_tests_snapshot();
 
         size_t calls_that_cannot_fail[] =
         {
-            2, /*MultiTree_DeleteChild*/
-            3, /*MultiTree_GetChildCount*/
-            7, /*STRING_c_str*/
-            9, /*Schema_GetModelModelByName_Offset*/
-            10, /*MultiTree_GetChildCount*/
-            13, /*MultiTree_GetName*/
-            14, /*STRING_c_str*/
-            16, /*Schema_GetModelDesiredPropertyType*/
-            17, /*Schema_GetSchemaForModelType*/
-            18, /*CodeFirst_GetPrimitiveType*/
-            21, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
-            22, /*Schema_GetModelDesiredProperty_offset*/
-            24, /*Destroy_AGENT_DATA_TYPE*/
-            25, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
-            26, /*STRING_delete*/
-            27, /*STRING_delete*/
-            28, /*Schema_GetModelModelByName_OnDesiredProperty*/
-            29, /*MultiTree_Destroy*/
-            30, /*gballoc_free*/
+            0, /*Schema_GetSchemaForModelType*/
+            3, /*Schema_GetModelModelByName_Offset*/
+            4, /*Schema_GetModelModelByName_OnDesiredProperty*/
+            6, /*Schema_GetModelDesiredPropertyType*/
+            7, /*Schema_GetModelDesiredProperty_offset*/
+            8 /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
         };
 
-        for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
-        {
-            size_t j;
-            umock_c_negative_tests_reset();
-
-            for (j = 0;j<sizeof(calls_that_cannot_fail) / sizeof(calls_that_cannot_fail[0]);j++) /*not running the tests that cannot fail*/
-            {
-                if (calls_that_cannot_fail[j] == i)
-                    break;
-            }
-
-            if (j == sizeof(calls_that_cannot_fail) / sizeof(calls_that_cannot_fail[0]))
-            {
-
-                umock_c_negative_tests_fail_call(i);
-                char temp_str[128];
-                sprintf(temp_str, "On failed call %lu", (unsigned long)i);
-
-                ///act
-                EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
-
-                ///assert
-                ASSERT_ARE_NOT_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result, temp_str);
-            }
-
-        }
+        run_negative_tests(commandDecoderHandle, deviceMemoryArea, desiredPropertiesJSON, false, calls_that_cannot_fail, COUNT_OF(calls_that_cannot_fail));
 
         umock_c_negative_tests_deinit();
 
@@ -3389,11 +3287,10 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        set_test_json_events(int_field_events, COUNT_OF(int_field_events));
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, true);
+        setup_ingest_desired_properties_walk(desiredPropertiesJSON);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, 0, TEST_MODEL_HANDLE, true);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3404,23 +3301,19 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
         ///clean
         CommandDecoder_Destroy(commandDecoderHandle);
-
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_012: [ If the child model in model has a non-NULL pfOnDesiredProperty then pfOnDesiredProperty shall be called. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_012: [ If the child model in model has a non-NULL pfOnDesiredProperty then pfOnDesiredProperty shall be called after its object has been applied. ]*/
     TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_1_model_in_model_desired_property_calls_onDesiredProperty_happy_path)
     {
-
         ///arrange
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
+        set_test_json_events(model_in_model_events, COUNT_OF(model_in_model_events));
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, true);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, true);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3431,63 +3324,438 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
         ///clean
         CommandDecoder_Destroy(commandDecoderHandle);
-
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_014: [ If handle is NULL then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
-    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_handle_fails)
+    /*Tests_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, only the members of the `desired` object shall be applied and all other members of jsonPayload shall be skipped. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_015: [ `$version` at the top of the desired properties shall be skipped. It not being present is not an error. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_full_twin_applies_only_desired_happy_path)
     {
         ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"desired\":{\"$version\":4,\"int_field\":3},\"reported\":{\"int_field\":5}}";
+        static const TEST_JSON_EVENT full_twin_events[] =
+        {
+            { "desired", JSON_DECODER_VALUE_OBJECT, "{" },
+            { "$version", JSON_DECODER_VALUE_NUMBER, "4" },
+            { "int_field", JSON_DECODER_VALUE_NUMBER, "3" },
+            { NULL, JSON_DECODER_VALUE_OBJECT, NULL },
+            { "reported", JSON_DECODER_VALUE_OBJECT, "{" },
+            { "int_field", JSON_DECODER_VALUE_NUMBER, "5" },
+            { NULL, JSON_DECODER_VALUE_OBJECT, NULL }
+        };
+        set_test_json_events(full_twin_events, COUNT_OF(full_twin_events));
+
+        setup_ingest_desired_properties_walk(desiredPropertiesJSON);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, 0, TEST_MODEL_HANDLE, false);
 
         ///act
-        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(NULL, "methodA", "{\"a\":1}");
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, true);
 
         ///assert
-        ASSERT_IS_NULL(methodReturn);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
 
         ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_015: [ If fulMethodName is NULL then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
-    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_fulMethodName_fails)
+    /*Tests_SRS_COMMAND_DECODER_09_003: [ If parseDesiredNode is TRUE and jsonPayload has no `desired` object then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_full_twin_without_desired_fails)
     {
         ///arrange
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"reported\":{\"int_field\":5}}";
+        static const TEST_JSON_EVENT reported_only_events[] =
+        {
+            { "reported", JSON_DECODER_VALUE_OBJECT, "{" },
+            { "int_field", JSON_DECODER_VALUE_NUMBER, "5" },
+            { NULL, JSON_DECODER_VALUE_OBJECT, NULL }
+        };
+        set_test_json_events(reported_only_events, COUNT_OF(reported_only_events));
+
+        setup_ingest_desired_properties_walk(desiredPropertiesJSON);
 
         ///act
-        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, NULL, "{\"a\":1}");
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, true);
 
         ///assert
-        ASSERT_IS_NULL(methodReturn);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
 
-        ///cleanup
+        ///clean
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_025: [ If methodCallback is NULL then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
-    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_methodCallback_fails)
+    /*Tests_SRS_COMMAND_DECODER_09_015: [ If the walk fails then the staged values shall be released without being written to the device. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_full_twin_with_2_desired_fails_before_applying_anything)
     {
         ///arrange
-        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, NULL, TEST_CALLBACK_CONTEXT_VALUE);
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"desired\":{\"int_field\":3},\"desired\":{\"int_field\":5}}";
+        static const TEST_JSON_EVENT two_desired_events[] =
+        {
+            { "desired", JSON_DECODER_VALUE_OBJECT, "{" },
+            { "int_field", JSON_DECODER_VALUE_NUMBER, "3" },
+            { NULL, JSON_DECODER_VALUE_OBJECT, NULL },
+            { "desired", JSON_DECODER_VALUE_OBJECT, "{" },
+            { "int_field", JSON_DECODER_VALUE_NUMBER, "5" },
+            { NULL, JSON_DECODER_VALUE_OBJECT, NULL }
+        };
+        set_test_json_events(two_desired_events, COUNT_OF(two_desired_events));
+        (void)memset(deviceMemoryArea, 0xAA, sizeof(deviceMemoryArea));
+
+        /*the walk stops at the second desired, the staged int_field is never written*/
+        setup_ingest_desired_properties_walk(desiredPropertiesJSON);
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "int_field"))
+            .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn("int");
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(2);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(onDesiredPropertySimpleProperty);
 
         ///act
-        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", "{\"a\":1}");
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, true);
 
         ///assert
-        ASSERT_IS_NULL(methodReturn);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+        ASSERT_ARE_EQUAL(int, (int)0xAAAAAAAA, read_int_field(deviceMemoryArea, 2));
 
-        ///cleanup
+        ///clean
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_015: [ If fullMethodName is NULL then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
-    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_fullMethodName_fails)
+    /*Tests_SRS_COMMAND_DECODER_09_002: [ If jsonPayload is not valid JSON then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_malformed_JSON_fails)
     {
         ///arrange
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":";
 
-        ///act
-        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, NULL, "{\"a\":1}");
+        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Callbacks(desiredPropertiesJSON, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_callbacks()
+            .IgnoreArgument_context()
+            .SetReturn(JSON_DECODER_PARSE_ERROR);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_007: [ If a member is not a desired property or a model in model of the model, or its value does not match the kind of the element, then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_unknown_member_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"unknown\":3}";
+        static const TEST_JSON_EVENT unknown_events[] =
+        {
+            { "unknown", JSON_DECODER_VALUE_NUMBER, "3" }
+        };
+        set_test_json_events(unknown_events, COUNT_OF(unknown_events));
+
+        setup_ingest_desired_properties_walk(desiredPropertiesJSON);
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "unknown"))
+            .SetReturn(Schema_GetModelElementByName_notFound);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_014: [ The decoded values shall be staged, and only written to the device once the whole jsonPayload has been walked. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_015: [ If the walk fails then the staged values shall be released without being written to the device. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_unknown_member_after_a_desired_property_does_not_write_it)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":3,\"unknown\":4}";
+        static const TEST_JSON_EVENT late_unknown_events[] =
+        {
+            { "int_field", JSON_DECODER_VALUE_NUMBER, "3" },
+            { "unknown", JSON_DECODER_VALUE_NUMBER, "4" }
+        };
+        set_test_json_events(late_unknown_events, COUNT_OF(late_unknown_events));
+        (void)memset(deviceMemoryArea, 0xAA, sizeof(deviceMemoryArea));
+
+        setup_ingest_desired_properties_walk(desiredPropertiesJSON);
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "int_field"))
+            .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn("int");
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(2);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(onDesiredPropertySimpleProperty);
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "unknown"))
+            .SetReturn(Schema_GetModelElementByName_notFound);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+        ASSERT_ARE_EQUAL(int, (int)0xAAAAAAAA, read_int_field(deviceMemoryArea, 2));
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    static const TEST_JSON_EVENT struct_events[] =
+    {
+        { "int_field", JSON_DECODER_VALUE_OBJECT, "{" },
+        { "Long", JSON_DECODER_VALUE_NUMBER, "2" },
+        { "Extra", JSON_DECODER_VALUE_ARRAY, "[" },
+        { NULL, JSON_DECODER_VALUE_NUMBER, "7" },
+        { NULL, JSON_DECODER_VALUE_ARRAY, NULL },
+        { "Lat", JSON_DECODER_VALUE_NUMBER, "1" },
+        { NULL, JSON_DECODER_VALUE_OBJECT, NULL }
+    };
+
+    static void setup_ingest_desired_properties_GeoLocation_scope(void)
+    {
+        size_t two = 2;
+
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "int_field"))
+            .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn("GeoLocation");
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("GeoLocation"))
+            .SetReturn(EDM_NO_TYPE);
+        STRICT_EXPECTED_CALL(Schema_GetStructTypeByName(TEST_SCHEMA_HANDLE, "GeoLocation")) /*5*/
+            .SetReturn(TEST_STRUCT_1_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyCount(TEST_STRUCT_1_HANDLE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_propertyCount(&two, sizeof(two));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(TEST_STRUCT_1_HANDLE, 0)) /*8*/
+            .SetReturn(memberProperty1);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyName(memberProperty1))
+            .SetReturn("Lat");
+        STRICT_EXPECTED_CALL(Schema_GetPropertyType(memberProperty1))
+            .SetReturn("double");
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(TEST_STRUCT_1_HANDLE, 1))
+            .SetReturn(memberProperty2);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyName(memberProperty2))
+            .SetReturn("Long");
+        STRICT_EXPECTED_CALL(Schema_GetPropertyType(memberProperty2))
+            .SetReturn("double");
+    }
+
+    static void CommandDecoder_IngestDesiredProperties_with_struct_desired_property_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON)
+    {
+        setup_ingest_desired_properties_walk(desiredPropertiesJSON);
+        setup_ingest_desired_properties_GeoLocation_scope();
+
+        /*"Long" comes first in the JSON, "Extra" is not a member of the struct and is skipped. The double members are decoded in place*/
+        STRICT_EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_Members(IGNORED_PTR_ARG, "GeoLocation", 2, IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*14*/
+            .IgnoreArgument_agentData()
+            .IgnoreArgument_memberNames()
+            .IgnoreArgument_memberValues();
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(2);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD));
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*17*/
+            .SetReturn(int_pfDesiredPropertyFromAGENT_DATA_TYPE);
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG)) /*Lat*/
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG)) /*Long*/
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*20*/
+            .IgnoreArgument_ptr();
+
+        /*the walk is over, the struct is written*/
+        STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + 2))
+            .IgnoreArgument_source();
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG)) /*22, the struct*/
+            .IgnoreArgument_agentData();
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_004: [ If the desired property has a struct type then the members of its object shall be collected by name, as described by the Schema APIs for structure types, and combined with Create_AGENT_DATA_TYPE_from_Members when the object ends. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_005: [ Members that are not part of the struct shall be skipped. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_013: [ If the desired property, or the member of a struct, has one of the types double, float, int, long, int8_t, uint8_t, int16_t, int32_t, int64_t, bool, ascii_char_ptr and ascii_char_ptr_no_quotes then its value shall be decoded in place from jsonPayload into that C type, with the rules of CreateAgentDataType_From_String. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_struct_desired_property_happy_path)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":{\"Long\":2,\"Extra\":[7],\"Lat\":1}}";
+        set_test_json_events(struct_events, COUNT_OF(struct_events));
+
+        CommandDecoder_IngestDesiredProperties_with_struct_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+        ASSERT_ARE_EQUAL(int, EDM_DOUBLE_TYPE, lastMemberValues[0][0].type);
+        ASSERT_ARE_EQUAL(double, 1.0, lastMemberValues[0][0].value.edmDouble.value);
+        ASSERT_ARE_EQUAL(int, EDM_DOUBLE_TYPE, lastMemberValues[0][1].type);
+        ASSERT_ARE_EQUAL(double, 2.0, lastMemberValues[0][1].value.edmDouble.value);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_016: [ If pfDesiredPropertyFromAGENT_DATA_TYPE fails then the values staged after it shall be released without being written and CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_struct_desired_property_unhappy_paths)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":{\"Long\":2,\"Extra\":[7],\"Lat\":1}}";
+        set_test_json_events(struct_events, COUNT_OF(struct_events));
+        (void)umock_c_negative_tests_init();
+        umock_c_reset_all_calls();
+
+        CommandDecoder_IngestDesiredProperties_with_struct_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON);
+
+        umock_c_negative_tests_snapshot();
+
+        size_t calls_that_cannot_fail[] =
+        {
+            0, /*Schema_GetSchemaForModelType*/
+            3, /*Schema_GetModelDesiredPropertyType*/
+            4, /*CodeFirst_GetPrimitiveType*/
+            15, /*Schema_GetModelDesiredProperty_offset*/
+            16, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
+            17, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
+            18, /*Destroy_AGENT_DATA_TYPE*/
+            19, /*Destroy_AGENT_DATA_TYPE*/
+            20, /*gballoc_free*/
+            22 /*Destroy_AGENT_DATA_TYPE*/
+        };
+
+        run_negative_tests(commandDecoderHandle, deviceMemoryArea, desiredPropertiesJSON, false, calls_that_cannot_fail, COUNT_OF(calls_that_cannot_fail));
+
+        umock_c_negative_tests_deinit();
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_006: [ If a member of the struct is repeated or missing then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_struct_desired_property_missing_member_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":{\"Long\":2}}";
+        static const TEST_JSON_EVENT missing_member_events[] =
+        {
+            { "int_field", JSON_DECODER_VALUE_OBJECT, "{" },
+            { "Long", JSON_DECODER_VALUE_NUMBER, "2" },
+            { NULL, JSON_DECODER_VALUE_OBJECT, NULL }
+        };
+        set_test_json_events(missing_member_events, COUNT_OF(missing_member_events));
+
+        setup_ingest_desired_properties_walk(desiredPropertiesJSON);
+        setup_ingest_desired_properties_GeoLocation_scope();
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG)) /*Long*/
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_014: [ If handle is NULL then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_handle_fails)
+    {
+        ///arrange
+
+        ///act
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(NULL, "methodA", "{\"a\":1}");
+
+        ///assert
+        ASSERT_IS_NULL(methodReturn);
+
+        ///clean
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_015: [ If fulMethodName is NULL then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_fulMethodName_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+
+        ///act
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, NULL, "{\"a\":1}");
+
+        ///assert
+        ASSERT_IS_NULL(methodReturn);
+
+        ///cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_025: [ If methodCallback is NULL then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_methodCallback_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, NULL, TEST_CALLBACK_CONTEXT_VALUE);
+
+        ///act
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", "{\"a\":1}");
+
+        ///assert
+        ASSERT_IS_NULL(methodReturn);
+
+        ///cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_015: [ If fullMethodName is NULL then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_fullMethodName_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+
+        ///act
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, NULL, "{\"a\":1}");
 
         ///assert
         ASSERT_IS_NULL(methodReturn);
@@ -3505,18 +3773,18 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
             .IgnoreArgument_methodHandle()
             .IgnoreArgument_argumentCount()
             .CopyOutArgumentBuffer_argumentCount(zero, sizeof(*zero));
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*this is the method dispatch table*/
+            .IgnoreArgument_size();
 
         STRICT_EXPECTED_CALL(methodCallbackMock(TEST_CALLBACK_CONTEXT_VALUE, "", "methodA", 0, NULL));
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the relativeMethodPath*/
             .IgnoreArgument_ptr();
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_016: [ If methodPayload is not NULL then CommandDecoder_ExecuteMethod shall build a MULTITREE_HANDLE out of methodPayload. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_017: [ CommandDecoder_ExecuteMethod shall get the SCHEMA_HANDLE associated with the modelHandle passed at CommandDecoder_Create. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_018: [ CommandDecoder_ExecuteMethod shall validate that consecutive segments of the fullMethodName exist in the model. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_019: [ CommandDecoder_ExecuteMethod shall locate the final model to which the methodName applies. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_020: [ CommandDecoder_ExecuteMethod shall verify that the model has a method called methodName. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_021: [ For every argument of methodName, CommandDecoder_ExecuteMethod shall build an AGENT_DATA_TYPE from the node with the same name from the MULTITREE_HANDLE. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_022: [ CommandDecoder_ExecuteMethod shall call methodCallback passing the context, the methodName, number of arguments and the AGENT_DATA_TYPE. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_024: [ Otherwise, CommandDecoder_ExecuteMethod shall return what methodCallback returns. ]*/
     TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_payload_hapy_path)
@@ -3531,130 +3799,479 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_ExecuteMethod_with_NULL_payload_inert_path(&zero);
 
         ///act
-        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", NULL);
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(void_ptr, g_methodReturnValue, methodReturn);
+
+        ///cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_payload_unhapy_paths)
+    {
+        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes no arguments*/
+
+        ///arrange
+        size_t zero = 0;
+
+        umock_c_negative_tests_init();
+        CommandDecoder_ExecuteMethod_with_NULL_payload_inert_path(&zero);
+        umock_c_negative_tests_snapshot();
+
+        for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+        {
+            if (
+                (i != 6) /*gballoc_free*/
+                )
+            {
+                /*a new instance every time, the dispatch table of the previous one already knows the method*/
+                COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+                umock_c_negative_tests_reset();
+                umock_c_negative_tests_fail_call(i);
+
+                ///act
+                METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", NULL);
+
+                ///assert
+                ASSERT_IS_NULL(methodReturn);
+
+                ///cleanup
+                CommandDecoder_Destroy(commandDecoderHandle);
+            }
+        }
+
+        ///cleanup
+        umock_c_negative_tests_deinit();
+    }
+
+    static void CommandDecoder_ExecuteMethod_with_1_arg_payload_inert_path(size_t* one, const char* methodPayload)
+    {
+        static const TEST_JSON_EVENT events[] =
+        {
+            { "a", JSON_DECODER_VALUE_NUMBER, "2" }
+        };
+        set_test_json_events(events, sizeof(events) / sizeof(events[0]));
+        methodArgumentAgentDataType.type = EDM_INT32_TYPE;
+
+        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(gballoc_malloc(1)); /*this is the string "" for relative relativeMethodPath*/
+        STRICT_EXPECTED_CALL(Schema_GetModelMethodByName(TEST_MODEL_HANDLE, "methodA"));
+        STRICT_EXPECTED_CALL(Schema_GetModelMethodArgumentCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_methodHandle()
+            .IgnoreArgument_argumentCount()
+            .CopyOutArgumentBuffer_argumentCount(one, sizeof(*one));
+
+        { /*scope for resolving the arguments into the dispatch table*/
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the array holding 1 x METHOD_ARGUMENT_DECODER */
+                .IgnoreArgument_size();
+            STRICT_EXPECTED_CALL(Schema_GetModelMethodArgumentByIndex(TEST_MODEL_METHOD_HANDLE, 0))
+                .SetReturn(TEST_METHOD_ARGUMENT_HANDLE_0);
+            STRICT_EXPECTED_CALL(Schema_GetMethodArgumentName(TEST_METHOD_ARGUMENT_HANDLE_0))
+                .SetReturn("a");
+            STRICT_EXPECTED_CALL(Schema_GetMethodArgumentType(TEST_METHOD_ARGUMENT_HANDLE_0))
+                .SetReturn("int");
+            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
+                .SetReturn(EDM_INT32_TYPE);
+            STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*this is the method dispatch table*/
+                .IgnoreArgument_size();
+        }
+
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Callbacks(methodPayload, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_callbacks()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("2", EDM_INT32_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_agentData(&methodArgumentAgentDataType, sizeof(methodArgumentAgentDataType));
+
+        STRICT_EXPECTED_CALL(methodCallbackMock(TEST_CALLBACK_CONTEXT_VALUE, "", "methodA", 1, IGNORED_PTR_ARG))
+            .IgnoreArgument_parameterValues();
+
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
+            .IgnoreArgument_agentData();
+
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the relativeMethodPath*/
+            .IgnoreArgument_ptr();
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_017: [ CommandDecoder_ExecuteMethod shall get the SCHEMA_HANDLE associated with the modelHandle passed at CommandDecoder_Create. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_018: [ CommandDecoder_ExecuteMethod shall validate that consecutive segments of the fullMethodName exist in the model. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_019: [ CommandDecoder_ExecuteMethod shall locate the final model to which the methodName applies. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_020: [ CommandDecoder_ExecuteMethod shall verify that the model has a method called methodName. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_022: [ CommandDecoder_ExecuteMethod shall call methodCallback passing the context, the methodName, number of arguments and the AGENT_DATA_TYPE. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_024: [ Otherwise, CommandDecoder_ExecuteMethod shall return what methodCallback returns. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_008: [ The first time a method is executed, CommandDecoder_ExecuteMethod shall resolve the name, type and primitive type of every argument from the Schema and keep them in the dispatch table of the instance. Later executions of the method shall use the dispatch table. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_009: [ If the method has no argument of a struct type and methodPayload is not NULL then CommandDecoder_ExecuteMethod shall walk methodPayload once by calling JSONDecoder_JSON_To_Callbacks and build the AGENT_DATA_TYPE of every argument from the member with the same name. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_1_arg_payload_hapy_path)
+    {
+        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes 1x arguments*/
+
+        ///arrange
+        size_t one = 1;
+        const char* methodPayload = "{\"a\":2}";
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        CommandDecoder_ExecuteMethod_with_1_arg_payload_inert_path(&one, methodPayload);
+
+        ///act
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", methodPayload);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(void_ptr, g_methodReturnValue, methodReturn);
+
+        ///cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+
+    /*Tests_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_1_arg_payload_unhapy_paths)
+    {
+        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes 1x arguments*/
+
+        ///arrange
+        size_t one = 1;
+        const char* methodPayload = "{\"a\":2}";
+
+        umock_c_negative_tests_init();
+        CommandDecoder_ExecuteMethod_with_1_arg_payload_inert_path(&one, methodPayload);
+        umock_c_negative_tests_snapshot();
+
+        for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+        {
+            if (
+                (i != 8) && /*CodeFirst_GetPrimitiveType*/
+                (i != 13) && /*Destroy_AGENT_DATA_TYPE*/
+                (i != 14) /*gballoc_free*/
+                )
+            {
+                COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+                umock_c_negative_tests_reset();
+                umock_c_negative_tests_fail_call(i);
+
+                ///act
+                METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", methodPayload);
+
+                ///assert
+                ASSERT_IS_NULL(methodReturn);
+
+                ///cleanup
+                CommandDecoder_Destroy(commandDecoderHandle);
+            }
+        }
+
+        ///cleanup
+        umock_c_negative_tests_deinit();
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_008: [ The first time a method is executed, CommandDecoder_ExecuteMethod shall resolve the name, type and primitive type of every argument from the Schema and keep them in the dispatch table of the instance. Later executions of the method shall use the dispatch table. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_second_execution_uses_the_dispatch_table)
+    {
+        ///arrange
+        size_t one = 1;
+        const char* methodPayload = "{\"a\":2}";
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        CommandDecoder_ExecuteMethod_with_1_arg_payload_inert_path(&one, methodPayload);
+        (void)CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", methodPayload);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(gballoc_malloc(1)); /*this is the string "" for relative relativeMethodPath*/
+        STRICT_EXPECTED_CALL(Schema_GetModelMethodByName(TEST_MODEL_HANDLE, "methodA"));
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Callbacks(methodPayload, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_callbacks()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("2", EDM_INT32_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_agentData(&methodArgumentAgentDataType, sizeof(methodArgumentAgentDataType));
+        STRICT_EXPECTED_CALL(methodCallbackMock(TEST_CALLBACK_CONTEXT_VALUE, "", "methodA", 1, IGNORED_PTR_ARG))
+            .IgnoreArgument_parameterValues();
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the relativeMethodPath*/
+            .IgnoreArgument_ptr();
+
+        ///act
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", methodPayload);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(void_ptr, g_methodReturnValue, methodReturn);
+
+        ///cleanup
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    static METHODRETURN_HANDLE CommandDecoder_ExecuteMethod_with_1_arg_events(const TEST_JSON_EVENT* events, size_t eventCount)
+    {
+        size_t one = 1;
+        const char* methodPayload = "{\"a\":2}";
+        METHODRETURN_HANDLE result;
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+
+        /*resolves the method, then walks the events instead of the payload*/
+        CommandDecoder_ExecuteMethod_with_1_arg_payload_inert_path(&one, methodPayload);
+        set_test_json_events(events, eventCount);
+
+        result = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", methodPayload);
+
+        CommandDecoder_Destroy(commandDecoderHandle);
+        return result;
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_010: [ Members of methodPayload that are not arguments of the method shall be skipped. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_skips_members_that_are_not_arguments)
+    {
+        ///arrange
+        static const TEST_JSON_EVENT events[] =
+        {
+            { "extra", JSON_DECODER_VALUE_OBJECT, "{" },
+                { "z", JSON_DECODER_VALUE_NUMBER, "1" },
+            { NULL, JSON_DECODER_VALUE_OBJECT, NULL },
+            { "a", JSON_DECODER_VALUE_NUMBER, "2" },
+            { "b", JSON_DECODER_VALUE_STRING, "\"x\"" }
+        };
+
+        ///act
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod_with_1_arg_events(events, sizeof(events) / sizeof(events[0]));
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, g_methodReturnValue, methodReturn);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_011: [ If an argument is repeated, missing or its value is an object or an array then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_a_repeated_argument_fails)
+    {
+        ///arrange
+        static const TEST_JSON_EVENT events[] =
+        {
+            { "a", JSON_DECODER_VALUE_NUMBER, "2" },
+            { "a", JSON_DECODER_VALUE_NUMBER, "3" }
+        };
+
+        ///act
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod_with_1_arg_events(events, sizeof(events) / sizeof(events[0]));
+
+        ///assert
+        ASSERT_IS_NULL(methodReturn);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_011: [ If an argument is repeated, missing or its value is an object or an array then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_a_missing_argument_fails)
+    {
+        ///arrange
+        static const TEST_JSON_EVENT events[] =
+        {
+            { "b", JSON_DECODER_VALUE_NUMBER, "2" }
+        };
+
+        ///act
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod_with_1_arg_events(events, sizeof(events) / sizeof(events[0]));
+
+        ///assert
+        ASSERT_IS_NULL(methodReturn);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_011: [ If an argument is repeated, missing or its value is an object or an array then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_an_object_argument_fails)
+    {
+        ///arrange
+        static const TEST_JSON_EVENT events[] =
+        {
+            { "a", JSON_DECODER_VALUE_OBJECT, "{" },
+            { NULL, JSON_DECODER_VALUE_OBJECT, NULL }
+        };
+
+        ///act
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod_with_1_arg_events(events, sizeof(events) / sizeof(events[0]));
+
+        ///assert
+        ASSERT_IS_NULL(methodReturn);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_016: [ If methodPayload is not NULL and the method has an argument of a struct type then CommandDecoder_ExecuteMethod shall build a MULTITREE_HANDLE out of methodPayload. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_021: [ For every argument of methodName, CommandDecoder_ExecuteMethod shall build an AGENT_DATA_TYPE from the node with the same name from the MULTITREE_HANDLE. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_a_struct_argument_decodes_a_MULTITREE)
+    {
+        ///arrange
+        size_t one = 1;
+        const char* methodPayload = "{\"p\":{\"Lat\":1, \"Long\":2}}";
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE));
+        STRICT_EXPECTED_CALL(gballoc_malloc(1)); /*this is the string "" for relative relativeMethodPath*/
+        STRICT_EXPECTED_CALL(Schema_GetModelMethodByName(TEST_MODEL_HANDLE, "methodA"));
+        STRICT_EXPECTED_CALL(Schema_GetModelMethodArgumentCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_methodHandle()
+            .IgnoreArgument_argumentCount()
+            .CopyOutArgumentBuffer_argumentCount(&one, sizeof(one));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the array holding 1 x METHOD_ARGUMENT_DECODER */
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(Schema_GetModelMethodArgumentByIndex(TEST_MODEL_METHOD_HANDLE, 0))
+            .SetReturn(TEST_METHOD_ARGUMENT_HANDLE_0);
+        STRICT_EXPECTED_CALL(Schema_GetMethodArgumentName(TEST_METHOD_ARGUMENT_HANDLE_0))
+            .SetReturn("p");
+        STRICT_EXPECTED_CALL(Schema_GetMethodArgumentType(TEST_METHOD_ARGUMENT_HANDLE_0))
+            .SetReturn("GeoLocation");
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("GeoLocation"))
+            .SetReturn(EDM_NO_TYPE);
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*this is the method dispatch table*/
+            .IgnoreArgument_size();
+
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, methodPayload))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_json()
+            .IgnoreArgument_multiTreeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_GetChildByName(IGNORED_PTR_ARG, "p", IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle()
+            .IgnoreArgument_childHandle()
+            .SetReturn(MULTITREE_ERROR);
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the payload*/
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the relativeMethodPath*/
+            .IgnoreArgument_ptr();
+
+        ///act
+        METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", methodPayload);
 
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-        ASSERT_ARE_EQUAL(void_ptr, g_methodReturnValue, methodReturn);
+        ASSERT_IS_NULL(methodReturn);
 
         ///cleanup
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
-    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_payload_unhapy_paths)
+    /*Tests_SRS_COMMAND_DECODER_02_016: [ If methodPayload is not NULL and the method has an argument of a struct type then CommandDecoder_ExecuteMethod shall build a MULTITREE_HANDLE out of methodPayload. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_021: [ For every argument of methodName, CommandDecoder_ExecuteMethod shall build an AGENT_DATA_TYPE from the node with the same name from the MULTITREE_HANDLE. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_022: [ CommandDecoder_ExecuteMethod shall call methodCallback passing the context, the methodName, number of arguments and the AGENT_DATA_TYPE. ]*/
+    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_a_struct_and_a_primitive_argument_decodes_both_from_a_MULTITREE)
     {
-        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes no arguments*/
-
         ///arrange
-        size_t zero = 0;
+        size_t two = 2;
+        size_t memberCount = 2;
+        const char* argumentValue = "2";
+        const char* latValue = "42.42";
+        const char* longValue = "1.2";
+        const char* methodPayload = "{\"a\":2, \"p\":{\"Lat\":42.42, \"Long\":1.2}}";
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
         umock_c_reset_all_calls();
+        methodArgumentAgentDataType.type = EDM_INT32_TYPE;
 
-        umock_c_negative_tests_init();
-        CommandDecoder_ExecuteMethod_with_NULL_payload_inert_path(&zero);
-        umock_c_negative_tests_snapshot();
-
-        for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
-        {
-            if (
-                (i!=5) /*gballoc_free*/
-                )
-            {
-                umock_c_negative_tests_reset();
-                umock_c_negative_tests_fail_call(i);
-
-                ///act
-                METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", NULL);
-
-                ///assert
-                ASSERT_IS_NULL(methodReturn);
-            }
-        }
-
-        ///cleanup
-        CommandDecoder_Destroy(commandDecoderHandle);
-        umock_c_negative_tests_deinit();
-    }
-
-    static void CommandDecoder_ExecuteMethod_with_1_arg_payload_inert_path(size_t* one, const char* methodPayload, const char** aValue)
-    {
-        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, methodPayload))
-            .IgnoreArgument_destination();
-        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_json()
-            .IgnoreArgument_multiTreeHandle();
         STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE));
         STRICT_EXPECTED_CALL(gballoc_malloc(1)); /*this is the string "" for relative relativeMethodPath*/
         STRICT_EXPECTED_CALL(Schema_GetModelMethodByName(TEST_MODEL_HANDLE, "methodA"));
         STRICT_EXPECTED_CALL(Schema_GetModelMethodArgumentCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_methodHandle()
             .IgnoreArgument_argumentCount()
-            .CopyOutArgumentBuffer_argumentCount(one, sizeof(*one));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the array holding 1 x AGENT_DATA_TYPE */
+            .CopyOutArgumentBuffer_argumentCount(&two, sizeof(two));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the array holding 2 x METHOD_ARGUMENT_DECODER */
             .IgnoreArgument_size();
-
         STRICT_EXPECTED_CALL(Schema_GetModelMethodArgumentByIndex(TEST_MODEL_METHOD_HANDLE, 0))
             .SetReturn(TEST_METHOD_ARGUMENT_HANDLE_0);
         STRICT_EXPECTED_CALL(Schema_GetMethodArgumentName(TEST_METHOD_ARGUMENT_HANDLE_0))
             .SetReturn("a");
         STRICT_EXPECTED_CALL(Schema_GetMethodArgumentType(TEST_METHOD_ARGUMENT_HANDLE_0))
             .SetReturn("int");
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
+            .SetReturn(EDM_INT32_TYPE);
+        STRICT_EXPECTED_CALL(Schema_GetModelMethodArgumentByIndex(TEST_MODEL_METHOD_HANDLE, 1))
+            .SetReturn(TEST_METHOD_ARGUMENT_HANDLE_1);
+        STRICT_EXPECTED_CALL(Schema_GetMethodArgumentName(TEST_METHOD_ARGUMENT_HANDLE_1))
+            .SetReturn("p");
+        STRICT_EXPECTED_CALL(Schema_GetMethodArgumentType(TEST_METHOD_ARGUMENT_HANDLE_1))
+            .SetReturn("GeoLocation");
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("GeoLocation"))
+            .SetReturn(EDM_NO_TYPE);
+        STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*this is the method dispatch table*/
+            .IgnoreArgument_size();
 
+        /*the primitive argument is not walked out of the payload, it is read from the same MULTITREE as the struct*/
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, methodPayload))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_json()
+            .IgnoreArgument_multiTreeHandle();
         STRICT_EXPECTED_CALL(MultiTree_GetChildByName(IGNORED_PTR_ARG, "a", IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle()
-            .IgnoreArgument_childHandle();
+            .CopyOutArgumentBuffer(3, &TEST_ARG2_NODE, sizeof(TEST_ARG2_NODE));
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
+            .SetReturn(EDM_INT32_TYPE);
+        STRICT_EXPECTED_CALL(MultiTree_GetValue(TEST_ARG2_NODE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(2, &argumentValue, sizeof(argumentValue));
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(argumentValue, EDM_INT32_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_agentData(&methodArgumentAgentDataType, sizeof(methodArgumentAgentDataType));
 
-        { /*scope for DecodeValueFromNode*/
-            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
-                .SetReturn(EDM_INT32_TYPE);
-            STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .IgnoreArgument_destination()
-                .CopyOutArgumentBuffer_destination(aValue, sizeof(aValue));
-            STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("2", EDM_INT32_TYPE, IGNORED_PTR_ARG))
-                .IgnoreArgument_agentData();
-        }
+        STRICT_EXPECTED_CALL(MultiTree_GetChildByName(IGNORED_PTR_ARG, "p", IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle()
+            .CopyOutArgumentBuffer(3, &TEST_ARG1_NODE, sizeof(TEST_ARG1_NODE));
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("GeoLocation"))
+            .SetReturn(EDM_NO_TYPE);
+        STRICT_EXPECTED_CALL(Schema_GetStructTypeByName(TEST_SCHEMA_HANDLE, "GeoLocation"))
+            .SetReturn(TEST_STRUCT_1_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyCount(TEST_STRUCT_1_HANDLE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(2, &memberCount, sizeof(memberCount));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is allocating the member values of the struct*/
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is allocating the member names of the struct*/
+            .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(methodCallbackMock(TEST_CALLBACK_CONTEXT_VALUE, "", "methodA", 1, IGNORED_PTR_ARG))
-            .IgnoreArgument_parameterValues();
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(TEST_STRUCT_1_HANDLE, 0))
+            .SetReturn(memberProperty1);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyName(memberProperty1))
+            .SetReturn("Lat");
+        STRICT_EXPECTED_CALL(Schema_GetPropertyType(memberProperty1))
+            .SetReturn("double");
+        STRICT_EXPECTED_CALL(MultiTree_GetChildByName(TEST_ARG1_NODE, "Lat", IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(3, &TEST_MEMBER1_NODE, sizeof(TEST_MEMBER1_NODE));
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("double"))
+            .SetReturn(EDM_DOUBLE_TYPE);
+        STRICT_EXPECTED_CALL(MultiTree_GetValue(TEST_MEMBER1_NODE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(2, &latValue, sizeof(latValue));
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(latValue, EDM_DOUBLE_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(3, &LatAgentDataType, sizeof(LatAgentDataType));
 
-        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
-            .IgnoreArgument_agentData();
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(TEST_STRUCT_1_HANDLE, 1))
+            .SetReturn(memberProperty2);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyName(memberProperty2))
+            .SetReturn("Long");
+        STRICT_EXPECTED_CALL(Schema_GetPropertyType(memberProperty2))
+            .SetReturn("double");
+        STRICT_EXPECTED_CALL(MultiTree_GetChildByName(TEST_ARG1_NODE, "Long", IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(3, &TEST_MEMBER2_NODE, sizeof(TEST_MEMBER2_NODE));
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("double"))
+            .SetReturn(EDM_DOUBLE_TYPE);
+        STRICT_EXPECTED_CALL(MultiTree_GetValue(TEST_MEMBER2_NODE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(2, &longValue, sizeof(longValue));
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(longValue, EDM_DOUBLE_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer(3, &LongAgentDataType, sizeof(LongAgentDataType));
 
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the relativeMethodPath*/
-            .IgnoreArgument_ptr();
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_Members(IGNORED_PTR_ARG, "GeoLocation", 2, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .ValidateArgument(2).ValidateArgument(3);
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the member names of the struct*/
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the member values of the struct*/
+            .IgnoreArgument(1);
 
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the payload*/
             .IgnoreArgument_ptr();
 
-    }
-
-    /*Tests_SRS_COMMAND_DECODER_02_016: [ If methodPayload is not NULL then CommandDecoder_ExecuteMethod shall build a MULTITREE_HANDLE out of methodPayload. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_017: [ CommandDecoder_ExecuteMethod shall get the SCHEMA_HANDLE associated with the modelHandle passed at CommandDecoder_Create. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_018: [ CommandDecoder_ExecuteMethod shall validate that consecutive segments of the fullMethodName exist in the model. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_019: [ CommandDecoder_ExecuteMethod shall locate the final model to which the methodName applies. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_020: [ CommandDecoder_ExecuteMethod shall verify that the model has a method called methodName. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_021: [ For every argument of methodName, CommandDecoder_ExecuteMethod shall build an AGENT_DATA_TYPE from the node with the same name from the MULTITREE_HANDLE. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_022: [ CommandDecoder_ExecuteMethod shall call methodCallback passing the context, the methodName, number of arguments and the AGENT_DATA_TYPE. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_024: [ Otherwise, CommandDecoder_ExecuteMethod shall return what methodCallback returns. ]*/
-    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_1_arg_payload_hapy_path)
-    {
-        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes 1x arguments*/
-
-        ///arrange
-        size_t one = 1;
-        const char* aValue = "2";
-        const char* methodPayload = "{\"a\":2}";
-        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
-        umock_c_reset_all_calls();
-
-        CommandDecoder_ExecuteMethod_with_1_arg_payload_inert_path(&one, methodPayload, &aValue);
+        STRICT_EXPECTED_CALL(methodCallbackMock(TEST_CALLBACK_CONTEXT_VALUE, "", "methodA", 2, IGNORED_PTR_ARG))
+            .IgnoreArgument_parameterValues();
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG)) /*the int argument, the mocked Create_AGENT_DATA_TYPE_from_Members leaves the struct argument as EDM_NO_TYPE*/
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the relativeMethodPath*/
+            .IgnoreArgument_ptr();
 
         ///act
         METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", methodPayload);
@@ -3662,63 +4279,23 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         ASSERT_ARE_EQUAL(void_ptr, g_methodReturnValue, methodReturn);
+        ASSERT_ARE_EQUAL(char_ptr, "Lat", lastMemberNames[0][0]);
+        ASSERT_ARE_EQUAL(char_ptr, "Long", lastMemberNames[0][1]);
 
         ///cleanup
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-
-    /*Tests_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
-    TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_1_arg_payload_unhapy_paths)
+    static void CommandDecoder_ExecuteMethod_with_2_arg_payload_inert_path(size_t* two, const char* methodPayload)
     {
-        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes 1x arguments*/
-
-        ///arrange
-        size_t one = 1;
-        const char* aValue = "2";
-        const char* methodPayload = "{\"a\":2}";
-        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
-        umock_c_reset_all_calls();
-
-        umock_c_negative_tests_init();
-        CommandDecoder_ExecuteMethod_with_1_arg_payload_inert_path(&one, methodPayload, &aValue);
-        umock_c_negative_tests_snapshot();
-
-        for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
+        static const TEST_JSON_EVENT events[] =
         {
-            if (
-                (i != 11)&& /*gballoc_free*/
-                (i != 15) && /*Destroy_AGENT_DATA_TYPE*/
-                (i != 16) && /*gballoc_free*/
-                (i != 17) && /*gballoc_free*/
-                (i != 18) && /*MultiTree_Destroy*/
-                (i != 19)  /*gballoc_free*/
-                )
-            {
-                umock_c_negative_tests_reset();
-                umock_c_negative_tests_fail_call(i);
-
-                ///act
-                METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", methodPayload);
-
-                ///assert
-                ASSERT_IS_NULL(methodReturn);
-            }
-        }
-
-        ///cleanup
-        CommandDecoder_Destroy(commandDecoderHandle);
-        umock_c_negative_tests_deinit();
-    }
-
+            { "a", JSON_DECODER_VALUE_NUMBER, "2" },
+            { "b", JSON_DECODER_VALUE_NUMBER, "3" }
+        };
+        set_test_json_events(events, sizeof(events) / sizeof(events[0]));
+        methodArgumentAgentDataType.type = EDM_INT32_TYPE;
 
-    static void CommandDecoder_ExecuteMethod_with_2_arg_payload_inert_path(size_t* two, const char* methodPayload, const char** aValue, const char** bValue)
-    {
-        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, methodPayload))
-            .IgnoreArgument_destination();
-        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_json()
-            .IgnoreArgument_multiTreeHandle();
         STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE));
         STRICT_EXPECTED_CALL(gballoc_malloc(1)); /*this is the string "" for relative relativeMethodPath*/
         STRICT_EXPECTED_CALL(Schema_GetModelMethodByName(TEST_MODEL_HANDLE, "methodA"));
@@ -3727,55 +4304,37 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
             .IgnoreArgument_argumentCount()
             .CopyOutArgumentBuffer_argumentCount(two, sizeof(*two));
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the array holding 1 x AGENT_DATA_TYPE */
-            .IgnoreArgument_size();
-
-        { /*scope for processing every individual argument*/
+        { /*scope for resolving the arguments into the dispatch table*/
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the array holding 2 x METHOD_ARGUMENT_DECODER */
+                .IgnoreArgument_size();
             STRICT_EXPECTED_CALL(Schema_GetModelMethodArgumentByIndex(TEST_MODEL_METHOD_HANDLE, 0))
                 .SetReturn(TEST_METHOD_ARGUMENT_HANDLE_0);
             STRICT_EXPECTED_CALL(Schema_GetMethodArgumentName(TEST_METHOD_ARGUMENT_HANDLE_0))
                 .SetReturn("a");
             STRICT_EXPECTED_CALL(Schema_GetMethodArgumentType(TEST_METHOD_ARGUMENT_HANDLE_0))
                 .SetReturn("int");
-
-            STRICT_EXPECTED_CALL(MultiTree_GetChildByName(IGNORED_PTR_ARG, "a", IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .IgnoreArgument_childHandle();
-
-            { /*scope for DecodeValueFromNode*/
-                STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
-                    .SetReturn(EDM_INT32_TYPE);
-                STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                    .IgnoreArgument_treeHandle()
-                    .IgnoreArgument_destination()
-                    .CopyOutArgumentBuffer_destination(aValue, sizeof(aValue));
-                STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("2", EDM_INT32_TYPE, IGNORED_PTR_ARG))
-                    .IgnoreArgument_agentData();
-            }
-
+            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
+                .SetReturn(EDM_INT32_TYPE);
             STRICT_EXPECTED_CALL(Schema_GetModelMethodArgumentByIndex(TEST_MODEL_METHOD_HANDLE, 1))
                 .SetReturn(TEST_METHOD_ARGUMENT_HANDLE_1);
             STRICT_EXPECTED_CALL(Schema_GetMethodArgumentName(TEST_METHOD_ARGUMENT_HANDLE_1))
                 .SetReturn("b");
             STRICT_EXPECTED_CALL(Schema_GetMethodArgumentType(TEST_METHOD_ARGUMENT_HANDLE_1))
                 .SetReturn("int");
-
-            STRICT_EXPECTED_CALL(MultiTree_GetChildByName(IGNORED_PTR_ARG, "b", IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .IgnoreArgument_childHandle();
-
-            { /*scope for DecodeValueFromNode*/
-                STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
-                    .SetReturn(EDM_INT32_TYPE);
-                STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                    .IgnoreArgument_treeHandle()
-                    .IgnoreArgument_destination()
-                    .CopyOutArgumentBuffer_destination(bValue, sizeof(bValue));
-                STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("3", EDM_INT32_TYPE, IGNORED_PTR_ARG)) /*20*/
-                    .IgnoreArgument_agentData();
-            }
+            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
+                .SetReturn(EDM_INT32_TYPE);
+            STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*this is the method dispatch table*/
+                .IgnoreArgument_size();
         }
 
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Callbacks(methodPayload, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_callbacks()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("2", EDM_INT32_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_agentData(&methodArgumentAgentDataType, sizeof(methodArgumentAgentDataType));
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("3", EDM_INT32_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_agentData(&methodArgumentAgentDataType, sizeof(methodArgumentAgentDataType));
+
         STRICT_EXPECTED_CALL(methodCallbackMock(TEST_CALLBACK_CONTEXT_VALUE, "", "methodA", 2, IGNORED_PTR_ARG))
             .IgnoreArgument_parameterValues();
 
@@ -3783,40 +4342,29 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
             .IgnoreArgument_agentData();
         STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
             .IgnoreArgument_agentData();
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
 
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the relativeMethodPath*/
             .IgnoreArgument_ptr();
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
-
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_016: [ If methodPayload is not NULL then CommandDecoder_ExecuteMethod shall build a MULTITREE_HANDLE out of methodPayload. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_017: [ CommandDecoder_ExecuteMethod shall get the SCHEMA_HANDLE associated with the modelHandle passed at CommandDecoder_Create. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_018: [ CommandDecoder_ExecuteMethod shall validate that consecutive segments of the fullMethodName exist in the model. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_019: [ CommandDecoder_ExecuteMethod shall locate the final model to which the methodName applies. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_020: [ CommandDecoder_ExecuteMethod shall verify that the model has a method called methodName. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_021: [ For every argument of methodName, CommandDecoder_ExecuteMethod shall build an AGENT_DATA_TYPE from the node with the same name from the MULTITREE_HANDLE. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_022: [ CommandDecoder_ExecuteMethod shall call methodCallback passing the context, the methodName, number of arguments and the AGENT_DATA_TYPE. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_024: [ Otherwise, CommandDecoder_ExecuteMethod shall return what methodCallback returns. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_009: [ If the method has no argument of a struct type and methodPayload is not NULL then CommandDecoder_ExecuteMethod shall walk methodPayload once by calling JSONDecoder_JSON_To_Callbacks and build the AGENT_DATA_TYPE of every argument from the member with the same name. ]*/
     TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_2_arg_payload_hapy_path)
     {
-        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes 1x arguments*/
+        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes 2x arguments*/
 
         ///arrange
         size_t two = 2;
-        const char* aValue = "2";
-        const char* bValue = "3";
         const char* methodPayload = "{\"a\":2, \"b\":3}";
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
         umock_c_reset_all_calls();
 
-        CommandDecoder_ExecuteMethod_with_2_arg_payload_inert_path(&two, methodPayload, &aValue, &bValue);
+        CommandDecoder_ExecuteMethod_with_2_arg_payload_inert_path(&two, methodPayload);
 
         ///act
         METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "methodA", methodPayload);
@@ -3833,32 +4381,27 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
     /*Tests_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
     TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_2_arg_payload_unhapy_paths)
     {
-        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes 1x arguments*/
+        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes 2x arguments*/
 
         ///arrange
         size_t two = 2;
-        const char* aValue = "2";
-        const char* bValue = "3";
         const char* methodPayload = "{\"a\":2, \"b\":3}";
-        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
-        umock_c_reset_all_calls();
 
         umock_c_negative_tests_init();
-        CommandDecoder_ExecuteMethod_with_2_arg_payload_inert_path(&two, methodPayload, &aValue, &bValue);
+        CommandDecoder_ExecuteMethod_with_2_arg_payload_inert_path(&two, methodPayload);
         umock_c_negative_tests_snapshot();
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
         {
             if (
-                (i != 11) && /*CodeFirst_GetPrimitiveType*/
-                (i != 22) && /*Destroy_AGENT_DATA_TYPE*/
-                (i != 23) && /*gballoc_free*/
-                (i != 24) && /*gballoc_free*/
-                (i != 25) && /*MultiTree_Destroy*/
-                (i != 26) && /*MultiTree_Destroy*/
-                (i != 27)  /*gballoc_free*/
+                (i != 8) && /*CodeFirst_GetPrimitiveType*/
+                (i != 12) && /*CodeFirst_GetPrimitiveType*/
+                (i != 18) && /*Destroy_AGENT_DATA_TYPE*/
+                (i != 19) && /*Destroy_AGENT_DATA_TYPE*/
+                (i != 20)  /*gballoc_free*/
                 )
             {
+                COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
                 umock_c_negative_tests_reset();
                 umock_c_negative_tests_fail_call(i);
 
@@ -3867,21 +4410,26 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
                 ///assert
                 ASSERT_IS_NULL(methodReturn);
+
+                ///cleanup
+                CommandDecoder_Destroy(commandDecoderHandle);
             }
         }
 
         ///cleanup
-        CommandDecoder_Destroy(commandDecoderHandle);
         umock_c_negative_tests_deinit();
     }
 
-    static void CommandDecoder_ExecuteMethod_model_in_model_with_2_arg_payload_inert_path(size_t* two, const char* methodPayload, const char** aValue, const char** bValue)
+    static void CommandDecoder_ExecuteMethod_model_in_model_with_2_arg_payload_inert_path(size_t* two, const char* methodPayload)
     {
-        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, methodPayload))
-            .IgnoreArgument_destination();
-        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_json()
-            .IgnoreArgument_multiTreeHandle();
+        static const TEST_JSON_EVENT events[] =
+        {
+            { "a", JSON_DECODER_VALUE_NUMBER, "2" },
+            { "b", JSON_DECODER_VALUE_NUMBER, "3" }
+        };
+        set_test_json_events(events, sizeof(events) / sizeof(events[0]));
+        methodArgumentAgentDataType.type = EDM_INT32_TYPE;
+
         STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE));
         STRICT_EXPECTED_CALL(gballoc_malloc(11)); /*this is the string "innermodel" for relative relativeMethodPath*/
         STRICT_EXPECTED_CALL(Schema_GetModelModelByName(TEST_MODEL_HANDLE, "innermodel"));
@@ -3896,55 +4444,37 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
             .IgnoreArgument_argumentCount()
             .CopyOutArgumentBuffer_argumentCount(two, sizeof(*two));
 
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the array holding 1 x AGENT_DATA_TYPE */
-            .IgnoreArgument_size();
-
-        { /*scope for processing every individual argument*/
+        { /*scope for resolving the arguments into the dispatch table*/
+            STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the array holding 2 x METHOD_ARGUMENT_DECODER */
+                .IgnoreArgument_size();
             STRICT_EXPECTED_CALL(Schema_GetModelMethodArgumentByIndex(TEST_MODEL_METHOD_HANDLE, 0))
                 .SetReturn(TEST_METHOD_ARGUMENT_HANDLE_0);
             STRICT_EXPECTED_CALL(Schema_GetMethodArgumentName(TEST_METHOD_ARGUMENT_HANDLE_0))
                 .SetReturn("a");
             STRICT_EXPECTED_CALL(Schema_GetMethodArgumentType(TEST_METHOD_ARGUMENT_HANDLE_0))
                 .SetReturn("int");
-
-            STRICT_EXPECTED_CALL(MultiTree_GetChildByName(IGNORED_PTR_ARG, "a", IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .IgnoreArgument_childHandle();
-
-            { /*scope for DecodeValueFromNode*/
-                STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
-                    .SetReturn(EDM_INT32_TYPE);
-                STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                    .IgnoreArgument_treeHandle()
-                    .IgnoreArgument_destination()
-                    .CopyOutArgumentBuffer_destination(aValue, sizeof(aValue));
-                STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("2", EDM_INT32_TYPE, IGNORED_PTR_ARG))
-                    .IgnoreArgument_agentData();
-            }
-
+            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
+                .SetReturn(EDM_INT32_TYPE);
             STRICT_EXPECTED_CALL(Schema_GetModelMethodArgumentByIndex(TEST_MODEL_METHOD_HANDLE, 1))
                 .SetReturn(TEST_METHOD_ARGUMENT_HANDLE_1);
             STRICT_EXPECTED_CALL(Schema_GetMethodArgumentName(TEST_METHOD_ARGUMENT_HANDLE_1))
                 .SetReturn("b");
             STRICT_EXPECTED_CALL(Schema_GetMethodArgumentType(TEST_METHOD_ARGUMENT_HANDLE_1))
                 .SetReturn("int");
-
-            STRICT_EXPECTED_CALL(MultiTree_GetChildByName(IGNORED_PTR_ARG, "b", IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .IgnoreArgument_childHandle();
-
-            { /*scope for DecodeValueFromNode*/
-                STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
-                    .SetReturn(EDM_INT32_TYPE);
-                STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                    .IgnoreArgument_treeHandle()
-                    .IgnoreArgument_destination()
-                    .CopyOutArgumentBuffer_destination(bValue, sizeof(bValue));
-                STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("3", EDM_INT32_TYPE, IGNORED_PTR_ARG)) /*23*/
-                    .IgnoreArgument_agentData();
-            }
+            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
+                .SetReturn(EDM_INT32_TYPE);
+            STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*this is the method dispatch table*/
+                .IgnoreArgument_size();
         }
 
+        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_Callbacks(methodPayload, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_callbacks()
+            .IgnoreArgument_context();
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("2", EDM_INT32_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_agentData(&methodArgumentAgentDataType, sizeof(methodArgumentAgentDataType));
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("3", EDM_INT32_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_agentData(&methodArgumentAgentDataType, sizeof(methodArgumentAgentDataType));
+
         STRICT_EXPECTED_CALL(methodCallbackMock(TEST_CALLBACK_CONTEXT_VALUE, "innermodel", "methodA", 2, IGNORED_PTR_ARG))
             .IgnoreArgument_parameterValues();
 
@@ -3952,40 +4482,28 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
             .IgnoreArgument_agentData();
         STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
             .IgnoreArgument_agentData();
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
 
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the relativeMethodPath*/
             .IgnoreArgument_ptr();
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
-
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_016: [ If methodPayload is not NULL then CommandDecoder_ExecuteMethod shall build a MULTITREE_HANDLE out of methodPayload. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_017: [ CommandDecoder_ExecuteMethod shall get the SCHEMA_HANDLE associated with the modelHandle passed at CommandDecoder_Create. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_018: [ CommandDecoder_ExecuteMethod shall validate that consecutive segments of the fullMethodName exist in the model. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_019: [ CommandDecoder_ExecuteMethod shall locate the final model to which the methodName applies. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_020: [ CommandDecoder_ExecuteMethod shall verify that the model has a method called methodName. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_021: [ For every argument of methodName, CommandDecoder_ExecuteMethod shall build an AGENT_DATA_TYPE from the node with the same name from the MULTITREE_HANDLE. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_022: [ CommandDecoder_ExecuteMethod shall call methodCallback passing the context, the methodName, number of arguments and the AGENT_DATA_TYPE. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_024: [ Otherwise, CommandDecoder_ExecuteMethod shall return what methodCallback returns. ]*/
     TEST_FUNCTION(CommandDecoder_ExecuteMethod_model_in_model_with_2_arg_payload_hapy_path)
     {
-        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes 1x arguments*/
+        /*this TEST_FUNCTION assumes that there is a method in the model "innermodel" called "methodA" that takes 2x arguments*/
 
         ///arrange
         size_t two = 2;
-        const char* aValue = "2";
-        const char* bValue = "3";
         const char* methodPayload = "{\"a\":2, \"b\":3}";
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
         umock_c_reset_all_calls();
 
-        CommandDecoder_ExecuteMethod_model_in_model_with_2_arg_payload_inert_path(&two, methodPayload, &aValue, &bValue);
+        CommandDecoder_ExecuteMethod_model_in_model_with_2_arg_payload_inert_path(&two, methodPayload);
 
         ///act
         METHODRETURN_HANDLE methodReturn = CommandDecoder_ExecuteMethod(commandDecoderHandle, "innermodel/methodA", methodPayload);
@@ -4002,34 +4520,28 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
     /*Tests_SRS_COMMAND_DECODER_02_023: [ If any of the previous operations fail, then CommandDecoder_ExecuteMethod shall return NULL. ]*/
     TEST_FUNCTION(CommandDecoder_ExecuteMethod_model_in_model_with_2_arg_payload_unhapy_paths)
     {
-        /*this TEST_FUNCTION assumes that there is a method in the root model called "methodA" that takes 1x arguments*/
+        /*this TEST_FUNCTION assumes that there is a method in the model "innermodel" called "methodA" that takes 2x arguments*/
 
         ///arrange
         size_t two = 2;
-        const char* aValue = "2";
-        const char* bValue = "3";
         const char* methodPayload = "{\"a\":2, \"b\":3}";
-        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
-        umock_c_reset_all_calls();
 
         umock_c_negative_tests_init();
-        CommandDecoder_ExecuteMethod_model_in_model_with_2_arg_payload_inert_path(&two, methodPayload, &aValue, &bValue);
+        CommandDecoder_ExecuteMethod_model_in_model_with_2_arg_payload_inert_path(&two, methodPayload);
         umock_c_negative_tests_snapshot();
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
         {
             if (
-                (i!=5)  && /*gballoc_free*/
+                (i != 3) && /*gballoc_free*/
+                (i != 11) && /*CodeFirst_GetPrimitiveType*/
                 (i != 15) && /*CodeFirst_GetPrimitiveType*/
-                (i != 25) && /*CodeFirst_GetPrimitiveType*/
-                (i != 26) && /*Destroy_AGENT_DATA_TYPE*/
-                (i != 27) && /*gballoc_free*/
-                (i != 28) && /*gballoc_free*/
-                (i != 29) && /*MultiTree_Destroy*/
-                (i != 30) && /*MultiTree_Destroy*/
-                (i != 31)  /*gballoc_free*/
+                (i != 21) && /*Destroy_AGENT_DATA_TYPE*/
+                (i != 22) && /*Destroy_AGENT_DATA_TYPE*/
+                (i != 23)  /*gballoc_free*/
                 )
             {
+                COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
                 umock_c_negative_tests_reset();
                 umock_c_negative_tests_fail_call(i);
 
@@ -4038,11 +4550,13 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
                 ///assert
                 ASSERT_IS_NULL(methodReturn);
+
+                ///cleanup
+                CommandDecoder_Destroy(commandDecoderHandle);
             }
         }
 
         ///cleanup
-        CommandDecoder_Destroy(commandDecoderHandle);
         umock_c_negative_tests_deinit();
     }
 
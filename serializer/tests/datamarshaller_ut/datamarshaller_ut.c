@@ -30,6 +30,7 @@ static void my_gballoc_free(void* s)
 
 #define ENABLE_MOCKS
 #include "jsonencoder.h"
+#include "cborencoder.h"
 #include "multitree.h"
 #include "schema.h"
 #include "azure_c_shared_utility/optimize_size.h"
@@ -131,6 +132,8 @@ IMPLEMENT_UMOCK_C_ENUM_TYPE(MULTITREE_RESULT, MULTITREE_RESULT_VALUES);
 TEST_DEFINE_ENUM_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
 
+IMPLEMENT_UMOCK_C_ENUM_TYPE(CBOR_ENCODER_RESULT, CBOR_ENCODER_RESULT_VALUES);
+
 #define DEFAULT_PROPERTY_NAME_2 "blahBlah"
 
 static MULTITREE_HANDLE my_MultiTree_Create(MULTITREE_CLONE_FUNCTION cloneFunction, MULTITREE_FREE_FUNCTION freeFunction)
@@ -162,6 +165,27 @@ static AGENT_DATA_TYPES_RESULT my_AgentDataTypes_ToString(STRING_HANDLE destinat
     return AGENT_DATA_TYPES_OK;
 }
 
+static JSON_ENCODER_RESULT my_JSONEncoder_Buffer_Init(JSON_ENCODER_BUFFER* buffer, size_t initialCapacity)
+{
+    buffer->buffer = (char*)my_gballoc_malloc(initialCapacity);
+    buffer->length = 0;
+    buffer->capacity = initialCapacity;
+    return JSON_ENCODER_OK;
+}
+
+static void my_JSONEncoder_Buffer_Deinit(JSON_ENCODER_BUFFER* buffer)
+{
+    my_gballoc_free(buffer->buffer);
+}
+
+static CBOR_ENCODER_RESULT my_CBOREncoder_EncodeTree(MULTITREE_HANDLE treeHandle, JSON_ENCODER_BUFFER* destination)
+{
+    (void)treeHandle;
+    destination->buffer[0] = (char)0xA0;
+    destination->length = 1;
+    return CBOR_ENCODER_OK;
+}
+
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 {
     char temp_str[256];
@@ -196,6 +220,7 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_CLONE_FUNCTION, void*);
         REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_FREE_FUNCTION, void*);
         REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_CURSOR*, void*);
         REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(JSON_ENCODER_TOSTRING_FUNC, void*);
         REGISTER_UMOCK_ALIAS_TYPE(VECTOR_HANDLE, void*);
@@ -204,10 +229,16 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(DATA_MARSHALLER_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(JSON_ENCODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(CBOR_ENCODER_RESULT, int);
+        REGISTER_UMOCK_ALIAS_TYPE(JSON_ENCODER_BUFFER*, void*);
 
         REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Create, my_MultiTree_Create);
         REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Destroy, my_MultiTree_Destroy);
 
+        REGISTER_GLOBAL_MOCK_HOOK(JSONEncoder_Buffer_Init, my_JSONEncoder_Buffer_Init);
+        REGISTER_GLOBAL_MOCK_HOOK(JSONEncoder_Buffer_Deinit, my_JSONEncoder_Buffer_Deinit);
+        REGISTER_GLOBAL_MOCK_HOOK(CBOREncoder_EncodeTree, my_CBOREncoder_EncodeTree);
+
         REGISTER_STRING_GLOBAL_MOCK_HOOK;
 
         REGISTER_GLOBAL_MOCK_HOOK(AgentDataTypes_ToString, my_AgentDataTypes_ToString);
@@ -263,7 +294,7 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         }
 
         umock_c_reset_all_calls();
-
+        DataMarshaller_SetEncoder(NULL);
     }
 
     TEST_FUNCTION_CLEANUP(TestMethodCleanup)
@@ -572,6 +603,78 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DataMarshaller_Destroy(handle);
     }
 
+    /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
+    TEST_FUNCTION(DataMarshaller_SendData_When_MultiTree_InitCursor_Fails_Then_Fails)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .SetReturn(MULTITREE_ERROR);
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
+    /*Tests_SRS_DATA_MARSHALLER_09_007: [ DataMarshaller_SendData shall add the values to the MultiTree through a cursor initialized with MultiTree_InitCursor, so values under the same parent do not walk the property path again. ]*/
+    TEST_FUNCTION(DataMarshaller_SendData_adds_all_the_values_through_one_cursor)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        umock_c_reset_all_calls();
+        AGENT_DATA_TYPE floatValid2;
+        DATA_MARSHALLER_VALUE value[] = { { "a/" DEFAULT_PROPERTY_NAME, &floatValid }, { "a/" DEFAULT_PROPERTY_NAME_2, &floatValid2 } };
+        char json_payload[] = "Test";
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, "a/" DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_cursor();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, "a/" DEFAULT_PROPERTY_NAME_2, &floatValid2))
+            .IgnoreArgument_cursor();
+        EXPECTED_CALL(STRING_new());
+        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
+            .SetReturn(strlen(json_payload));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .IgnoreArgument_size();
+        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+            .SetReturn(json_payload);
+        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_treeHandle();
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, sizeof(value) / sizeof(value[0]), value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(size_t, strlen(json_payload), destinationSize);
+
+        ///cleanup
+        free(destination);
+        DataMarshaller_Destroy(handle);
+    }
+
     /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
     TEST_FUNCTION(DataMarshaller_SendData_When_MultiTree_AddLeaf_With_Property_Value_Fails_Then_Fails)
     {
@@ -586,9 +689,10 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         STRICT_EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_cloneFunction()
             .IgnoreArgument_freeFunction();
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle()
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_cursor()
             .SetReturn(MULTITREE_ERROR);
 
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
@@ -623,11 +727,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         values[1].Value = &floatValid2;
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &floatValid2))
-            .IgnoreArgument_treeHandle()
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_cursor();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &floatValid2))
+            .IgnoreArgument_cursor()
             .SetReturn(MULTITREE_ERROR);
 
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
@@ -655,9 +760,10 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_cursor();
         STRICT_EXPECTED_CALL(STRING_new());
         EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle()
@@ -696,11 +802,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_cursor();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
+            .IgnoreArgument_cursor();
         EXPECTED_CALL(STRING_new());
         EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle()
@@ -747,11 +854,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_cursor();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
+            .IgnoreArgument_cursor();
         EXPECTED_CALL(STRING_new());
         EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle()
@@ -795,11 +903,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &floatValid))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_cursor();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &floatValid))
+            .IgnoreArgument_cursor();
         EXPECTED_CALL(STRING_new());
         EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle()
@@ -843,9 +952,10 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_cursor();
         EXPECTED_CALL(STRING_new());
         EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle()
@@ -890,11 +1000,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         char json_payload[] = "Test";
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "y", structTypeValue2Members.value.edmComplexType.fields[1].value))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
+            .IgnoreArgument_cursor();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, "y", structTypeValue2Members.value.edmComplexType.fields[1].value))
+            .IgnoreArgument_cursor();
         EXPECTED_CALL(STRING_new());
         EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument_treeHandle()
@@ -936,9 +1047,10 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle()
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
+            .IgnoreArgument_cursor()
             .SetReturn(MULTITREE_ERROR);
 
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
@@ -966,11 +1078,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "y", structTypeValue2Members.value.edmComplexType.fields[1].value))
-            .IgnoreArgument_treeHandle()
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
+            .IgnoreArgument_cursor();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, "y", structTypeValue2Members.value.edmComplexType.fields[1].value))
+            .IgnoreArgument_cursor()
             .SetReturn(MULTITREE_ERROR);
 
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
@@ -998,9 +1111,10 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
 
         EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_cursor();
         EXPECTED_CALL(STRING_new())
             .SetReturn(NULL);
         STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
@@ -1017,6 +1131,99 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DataMarshaller_Destroy(handle);
     }
 
+    /*Tests_SRS_DATA_MARSHALLER_09_002: [ DataMarshaller_SetEncoder shall make encoder the encoder of every DataMarshaller_SendData that follows. If encoder is NULL, the JSON encoder shall be used. ]*/
+    TEST_FUNCTION(DataMarshaller_SetEncoder_with_NULL_selects_the_JSON_encoder)
+    {
+        ///arrange
+        DataMarshaller_SetEncoder(DataMarshaller_GetCBOREncoder());
+
+        ///act
+        DataMarshaller_SetEncoder(NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, (void*)DataMarshaller_GetJSONEncoder(), (void*)DataMarshaller_GetEncoder());
+        ASSERT_ARE_EQUAL(char_ptr, "application/json", DataMarshaller_GetEncoder()->contentType);
+        ASSERT_ARE_EQUAL(char_ptr, "utf-8", DataMarshaller_GetEncoder()->contentEncoding);
+    }
+
+    /*Tests_SRS_DATA_MARSHALLER_09_002: [ DataMarshaller_SetEncoder shall make encoder the encoder of every DataMarshaller_SendData that follows. If encoder is NULL, the JSON encoder shall be used. ]*/
+    TEST_FUNCTION(DataMarshaller_SetEncoder_selects_the_CBOR_encoder)
+    {
+        ///act
+        DataMarshaller_SetEncoder(DataMarshaller_GetCBOREncoder());
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, (void*)DataMarshaller_GetCBOREncoder(), (void*)DataMarshaller_GetEncoder());
+        ASSERT_ARE_EQUAL(char_ptr, CBOR_ENCODER_CONTENT_TYPE, DataMarshaller_GetEncoder()->contentType);
+        ASSERT_IS_NULL(DataMarshaller_GetEncoder()->contentEncoding);
+    }
+
+    /*Tests_SRS_DATA_MARSHALLER_09_003: [ DataMarshaller_SendData shall produce destination and destinationSize by calling the encode function of the encoder returned by DataMarshaller_GetEncoder. ]*/
+    /*Tests_SRS_DATA_MARSHALLER_09_004: [ The CBOR encoder shall encode the tree by calling CBOREncoder_EncodeTree and hand over the encoded bytes in destination and destinationSize. ]*/
+    TEST_FUNCTION(DataMarshaller_SendData_with_the_CBOR_encoder_succeeds)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid } };
+        DataMarshaller_SetEncoder(DataMarshaller_GetCBOREncoder());
+        umock_c_reset_all_calls();
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_cursor();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Init(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(CBOREncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG));
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(size_t, 1, destinationSize);
+        ASSERT_ARE_EQUAL(int, 0xA0, destination[0]);
+
+        ///cleanup
+        free(destination);
+        DataMarshaller_Destroy(handle);
+    }
+
+    /*Tests_SRS_DATA_MARSHALLER_09_005: [ If CBOREncoder_EncodeTree fails, the CBOR encoder shall fail and return DATA_MARSHALLER_ENCODER_ERROR. ]*/
+    TEST_FUNCTION(DataMarshaller_SendData_when_CBOREncoder_EncodeTree_fails_it_fails)
+    {
+        ///arrange
+        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        unsigned char* destination;
+        size_t destinationSize;
+        DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid } };
+        DataMarshaller_SetEncoder(DataMarshaller_GetCBOREncoder());
+        umock_c_reset_all_calls();
+
+        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        EXPECTED_CALL(MultiTree_InitCursor(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_AddLeafAtCursor(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
+            .IgnoreArgument_cursor();
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Init(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(CBOREncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .SetReturn(CBOR_ENCODER_ERROR);
+        STRICT_EXPECTED_CALL(JSONEncoder_Buffer_Deinit(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG));
+
+        ///act
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, value, &destination, &destinationSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_ENCODER_ERROR, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        DataMarshaller_Destroy(handle);
+    }
+
     /*Tests_SRS_DATA_MARSHALLER_02_021: [ If argument dataMarshallerHandle is NULL then DataMarshaller_SendData_ReportedProperties shall fail and return DATA_MARSHALLER_INVALID_ARG. ]*/
     TEST_FUNCTION(DataMarshaller_SendData_ReportedProperties_with_NULL_dataMarshallerHandle_fails)
     {
@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <cstdlib>
+#include <cstring>
 #include "testrunnerswitcher.h"
 #include "micromock.h"
 #include "micromockcharstararenullterminatedstrings.h"
@@ -2583,4 +2584,232 @@ TEST_FUNCTION(JSONDecoder_When_String_Has_Several_Escaped_Chars_Decoding_Succeed
     TestSpecialCharacter_Success(json);
 }
 
+typedef struct TEST_CALLBACKS_CONTEXT_TAG
+{
+    char log[256];
+    const char* nameToSkip;
+    const char* nameToAbort;
+    bool abortOnEnd;
+} TEST_CALLBACKS_CONTEXT;
+
+static void TestCallbacks_Append(TEST_CALLBACKS_CONTEXT* testContext, const char* text, size_t length)
+{
+    size_t used = strlen(testContext->log);
+    if (used + length < sizeof(testContext->log))
+    {
+        (void)memcpy(testContext->log + used, text, length);
+        testContext->log[used + length] = '\0';
+    }
+}
+
+static bool TestCallbacks_NameIs(const char* expected, const char* name, size_t nameLength)
+{
+    return (expected != NULL) && (name != NULL) && (strlen(expected) == nameLength) && (strncmp(expected, name, nameLength) == 0);
+}
+
+/*records every event as name:value| (a NULL name is recorded as -, an object or array as its bracket)*/
+static JSON_DECODER_ACTION TestCallbacks_OnValue(void* context, const char* name, size_t nameLength, JSON_DECODER_VALUE_TYPE valueType, const char* value, size_t valueLength)
+{
+    TEST_CALLBACKS_CONTEXT* testContext = (TEST_CALLBACKS_CONTEXT*)context;
+    JSON_DECODER_ACTION result;
+
+    if (name == NULL)
+    {
+        ASSERT_ARE_EQUAL(size_t, 0, nameLength);
+        TestCallbacks_Append(testContext, "-", 1);
+    }
+    else
+    {
+        TestCallbacks_Append(testContext, name, nameLength);
+    }
+    TestCallbacks_Append(testContext, ":", 1);
+
+    if ((valueType == JSON_DECODER_VALUE_OBJECT) || (valueType == JSON_DECODER_VALUE_ARRAY))
+    {
+        ASSERT_ARE_EQUAL(size_t, 0, valueLength);
+        TestCallbacks_Append(testContext, value, 1);
+    }
+    else
+    {
+        TestCallbacks_Append(testContext, value, valueLength);
+    }
+    TestCallbacks_Append(testContext, "|", 1);
+
+    if (TestCallbacks_NameIs(testContext->nameToAbort, name, nameLength))
+    {
+        result = JSON_DECODER_ACTION_ABORT;
+    }
+    else if (TestCallbacks_NameIs(testContext->nameToSkip, name, nameLength))
+    {
+        result = JSON_DECODER_ACTION_SKIP;
+    }
+    else
+    {
+        result = JSON_DECODER_ACTION_CONTINUE;
+    }
+
+    return result;
+}
+
+static JSON_DECODER_ACTION TestCallbacks_OnEnd(void* context)
+{
+    TEST_CALLBACKS_CONTEXT* testContext = (TEST_CALLBACKS_CONTEXT*)context;
+    TestCallbacks_Append(testContext, "end|", 4);
+    return testContext->abortOnEnd ? JSON_DECODER_ACTION_ABORT : JSON_DECODER_ACTION_CONTINUE;
+}
+
+static const JSON_DECODER_CALLBACKS testCallbacks = { TestCallbacks_OnValue, TestCallbacks_OnEnd };
+
+/* Tests_SRS_JSON_DECODER_09_001: [ If json, callbacks, callbacks->onValue or callbacks->onEnd is NULL then JSONDecoder_JSON_To_Callbacks shall return JSON_DECODER_INVALID_ARG. ] */
+TEST_FUNCTION(JSONDecoder_JSON_To_Callbacks_with_NULL_json_fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    TEST_CALLBACKS_CONTEXT testContext = { "", NULL, NULL, false };
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Callbacks(NULL, &testCallbacks, &testContext);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, result);
+}
+
+/* Tests_SRS_JSON_DECODER_09_001: [ If json, callbacks, callbacks->onValue or callbacks->onEnd is NULL then JSONDecoder_JSON_To_Callbacks shall return JSON_DECODER_INVALID_ARG. ] */
+TEST_FUNCTION(JSONDecoder_JSON_To_Callbacks_with_NULL_callbacks_fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    TEST_CALLBACKS_CONTEXT testContext = { "", NULL, NULL, false };
+    const JSON_DECODER_CALLBACKS noOnValue = { NULL, TestCallbacks_OnEnd };
+    const JSON_DECODER_CALLBACKS noOnEnd = { TestCallbacks_OnValue, NULL };
+
+    ///act
+    JSON_DECODER_RESULT result1 = JSONDecoder_JSON_To_Callbacks("{}", NULL, &testContext);
+    JSON_DECODER_RESULT result2 = JSONDecoder_JSON_To_Callbacks("{}", &noOnValue, &testContext);
+    JSON_DECODER_RESULT result3 = JSONDecoder_JSON_To_Callbacks("{}", &noOnEnd, &testContext);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, result3);
+}
+
+/* Tests_SRS_JSON_DECODER_09_002: [ JSONDecoder_JSON_To_Callbacks shall not modify json and shall not allocate memory. ] */
+/* Tests_SRS_JSON_DECODER_09_003: [ For each member of an object JSONDecoder_JSON_To_Callbacks shall call onValue with the member name (without quotes) and its length. ] */
+/* Tests_SRS_JSON_DECODER_09_004: [ For each element of an array JSONDecoder_JSON_To_Callbacks shall call onValue with a NULL name and a nameLength of 0. ] */
+/* Tests_SRS_JSON_DECODER_09_005: [ For strings, numbers and literals onValue shall receive the text of the value as it appears in json (strings keep their quotes) and its length. ] */
+/* Tests_SRS_JSON_DECODER_09_006: [ For objects and arrays onValue shall receive a pointer to the opening bracket and a valueLength of 0. ] */
+/* Tests_SRS_JSON_DECODER_09_008: [ If onValue returns JSON_DECODER_ACTION_CONTINUE for an object or an array, JSONDecoder_JSON_To_Callbacks shall report its content and then call onEnd. ] */
+/* Tests_SRS_JSON_DECODER_09_009: [ The root object or array shall not be reported through onValue or onEnd. ] */
+/* Tests_SRS_JSON_DECODER_09_012: [ Otherwise JSONDecoder_JSON_To_Callbacks shall return JSON_DECODER_OK. ] */
+TEST_FUNCTION(JSONDecoder_JSON_To_Callbacks_reports_all_values)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    TEST_CALLBACKS_CONTEXT testContext = { "", NULL, NULL, false };
+    const char* json = " { \"a\" : \"x\\\"y\", \"b\":-1.5e3, \"c\":[true, null, {}], \"d\":{\"e\":false} } ";
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Callbacks(json, &testCallbacks, &testContext);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, "a:\"x\\\"y\"|b:-1.5e3|c:[|-:true|-:null|-:{|end|end|d:{|e:false|end|", testContext.log);
+    mocks.AssertActualAndExpectedCalls();
+}
+
+/* Tests_SRS_JSON_DECODER_09_007: [ If onValue returns JSON_DECODER_ACTION_SKIP for an object or an array, JSONDecoder_JSON_To_Callbacks shall validate the nested value without calling any callback for it. ] */
+TEST_FUNCTION(JSONDecoder_JSON_To_Callbacks_skips_nested_value)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    TEST_CALLBACKS_CONTEXT testContext = { "", "reported", NULL, false };
+    const char* json = "{\"reported\":{\"x\":[1,{\"y\":2}]},\"desired\":{\"z\":3}}";
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Callbacks(json, &testCallbacks, &testContext);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, "reported:{|desired:{|z:3|end|", testContext.log);
+}
+
+/* Tests_SRS_JSON_DECODER_09_011: [ If json is malformed then JSONDecoder_JSON_To_Callbacks shall return JSON_DECODER_PARSE_ERROR. Values that come before the malformed part have already been reported. ] */
+TEST_FUNCTION(JSONDecoder_JSON_To_Callbacks_with_malformed_skipped_value_fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    TEST_CALLBACKS_CONTEXT testContext = { "", "reported", NULL, false };
+    const char* json = "{\"reported\":{\"x\":[1,]},\"desired\":{\"z\":3}}";
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Callbacks(json, &testCallbacks, &testContext);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_PARSE_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, "reported:{|", testContext.log);
+}
+
+/* Tests_SRS_JSON_DECODER_09_010: [ If onValue or onEnd returns JSON_DECODER_ACTION_ABORT then JSONDecoder_JSON_To_Callbacks shall stop and return JSON_DECODER_ERROR. ] */
+TEST_FUNCTION(JSONDecoder_JSON_To_Callbacks_stops_when_onValue_aborts)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    TEST_CALLBACKS_CONTEXT testContext = { "", NULL, "b", false };
+    const char* json = "{\"a\":1,\"b\":2,\"c\":3}";
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Callbacks(json, &testCallbacks, &testContext);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, "a:1|b:2|", testContext.log);
+}
+
+/* Tests_SRS_JSON_DECODER_09_010: [ If onValue or onEnd returns JSON_DECODER_ACTION_ABORT then JSONDecoder_JSON_To_Callbacks shall stop and return JSON_DECODER_ERROR. ] */
+TEST_FUNCTION(JSONDecoder_JSON_To_Callbacks_stops_when_onEnd_aborts)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    TEST_CALLBACKS_CONTEXT testContext = { "", NULL, NULL, true };
+    const char* json = "{\"a\":{\"b\":1},\"c\":3}";
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Callbacks(json, &testCallbacks, &testContext);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, "a:{|b:1|end|", testContext.log);
+}
+
+/* Tests_SRS_JSON_DECODER_09_011: [ If json is malformed then JSONDecoder_JSON_To_Callbacks shall return JSON_DECODER_PARSE_ERROR. Values that come before the malformed part have already been reported. ] */
+TEST_FUNCTION(JSONDecoder_JSON_To_Callbacks_with_malformed_json_fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    const char* malformed[] =
+    {
+        "",
+        "  ",
+        "3",
+        "{\"a\":1,}",
+        "{\"a\" 1}",
+        "{\"a\":1 \"b\":2}",
+        "[1,2",
+        "{\"a\":tru}",
+        "{\"a\":1}x"
+    };
+
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++)
+    {
+        TEST_CALLBACKS_CONTEXT testContext = { "", NULL, NULL, false };
+
+        ///act
+        JSON_DECODER_RESULT result = JSONDecoder_JSON_To_Callbacks(malformed[i], &testCallbacks, &testContext);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_PARSE_ERROR, result, malformed[i]);
+    }
+}
+
 END_TEST_SUITE(JSONDecoder_ut)
@@ -3,6 +3,7 @@
 
 #include <cstdlib>
 #include <cstddef>
+#include <cstdint>
 #include "testrunnerswitcher.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
@@ -6423,4 +6424,181 @@ BEGIN_TEST_SUITE(JSONEncoder_ut)
             ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
         }
 
+        /* JSONEncoder_Buffer */
+
+        /*Tests_SRS_JSON_ENCODER_09_001: [ If buffer is NULL or initialCapacity is 0, JSONEncoder_Buffer_Init shall return JSON_ENCODER_INVALID_ARG. ]*/
+        TEST_FUNCTION(JSONEncoder_Buffer_Init_with_NULL_buffer_fails)
+        {
+            ///act
+            auto result = JSONEncoder_Buffer_Init(NULL, 16);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_001: [ If buffer is NULL or initialCapacity is 0, JSONEncoder_Buffer_Init shall return JSON_ENCODER_INVALID_ARG. ]*/
+        TEST_FUNCTION(JSONEncoder_Buffer_Init_with_0_initialCapacity_fails)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer;
+
+            ///act
+            auto result = JSONEncoder_Buffer_Init(&buffer, 0);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_002: [ JSONEncoder_Buffer_Init shall allocate initialCapacity bytes and set the length of the buffer to 0. ]*/
+        TEST_FUNCTION(JSONEncoder_Buffer_Init_succeeds)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer;
+
+            ///act
+            auto result = JSONEncoder_Buffer_Init(&buffer, 16);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result);
+            ASSERT_IS_NOT_NULL(buffer.buffer);
+            ASSERT_ARE_EQUAL(size_t, 0, buffer.length);
+            ASSERT_ARE_EQUAL(size_t, 16, buffer.capacity);
+
+            ///cleanup
+            JSONEncoder_Buffer_Deinit(&buffer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_004: [ If buffer is NULL, JSONEncoder_Buffer_Reserve shall return JSON_ENCODER_INVALID_ARG. ]*/
+        TEST_FUNCTION(JSONEncoder_Buffer_Reserve_with_NULL_buffer_fails)
+        {
+            ///act
+            auto result = JSONEncoder_Buffer_Reserve(NULL, 16);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_005: [ If the buffer already has room for additionalLength more bytes, JSONEncoder_Buffer_Reserve shall return JSON_ENCODER_OK without allocating. ]*/
+        TEST_FUNCTION(JSONEncoder_Buffer_Reserve_within_capacity_keeps_the_memory)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer;
+            (void)JSONEncoder_Buffer_Init(&buffer, 16);
+            char* before = buffer.buffer;
+
+            ///act
+            auto result = JSONEncoder_Buffer_Reserve(&buffer, 16);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result);
+            ASSERT_ARE_EQUAL(void_ptr, before, buffer.buffer);
+            ASSERT_ARE_EQUAL(size_t, 16, buffer.capacity);
+
+            ///cleanup
+            JSONEncoder_Buffer_Deinit(&buffer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_006: [ Otherwise JSONEncoder_Buffer_Reserve shall grow the buffer to at least twice its capacity, or to the required size if that is larger. ]*/
+        TEST_FUNCTION(JSONEncoder_Buffer_Reserve_doubles_the_capacity)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer;
+            (void)JSONEncoder_Buffer_Init(&buffer, 16);
+            (void)JSONEncoder_Buffer_Append(&buffer, "0123456789", 10);
+
+            ///act
+            auto result1 = JSONEncoder_Buffer_Reserve(&buffer, 7);
+            size_t capacity1 = buffer.capacity;
+            auto result2 = JSONEncoder_Buffer_Reserve(&buffer, 100);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result1);
+            ASSERT_ARE_EQUAL(size_t, 32, capacity1);
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result2);
+            ASSERT_ARE_EQUAL(size_t, 110, buffer.capacity);
+            ASSERT_ARE_EQUAL(size_t, 10, buffer.length);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(buffer.buffer, "0123456789", 10));
+
+            ///cleanup
+            JSONEncoder_Buffer_Deinit(&buffer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_007: [ If the required size overflows or growing the buffer fails, JSONEncoder_Buffer_Reserve shall return JSON_ENCODER_ERROR and leave the buffer unchanged. ]*/
+        TEST_FUNCTION(JSONEncoder_Buffer_Reserve_fails_when_the_size_overflows)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer;
+            (void)JSONEncoder_Buffer_Init(&buffer, 16);
+            (void)JSONEncoder_Buffer_Append(&buffer, "01", 2);
+
+            ///act
+            auto result = JSONEncoder_Buffer_Reserve(&buffer, SIZE_MAX);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_ERROR, result);
+            ASSERT_ARE_EQUAL(size_t, 2, buffer.length);
+            ASSERT_ARE_EQUAL(size_t, 16, buffer.capacity);
+
+            ///cleanup
+            JSONEncoder_Buffer_Deinit(&buffer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_008: [ If buffer or source is NULL, JSONEncoder_Buffer_Append shall return JSON_ENCODER_INVALID_ARG. ]*/
+        TEST_FUNCTION(JSONEncoder_Buffer_Append_with_NULL_source_fails)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer;
+            (void)JSONEncoder_Buffer_Init(&buffer, 16);
+
+            ///act
+            auto result = JSONEncoder_Buffer_Append(&buffer, NULL, 1);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+            ASSERT_ARE_EQUAL(size_t, 0, buffer.length);
+
+            ///cleanup
+            JSONEncoder_Buffer_Deinit(&buffer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_009: [ JSONEncoder_Buffer_Append shall call JSONEncoder_Buffer_Reserve for sourceLength bytes and then copy sourceLength bytes from source at the end of the buffer. ]*/
+        TEST_FUNCTION(JSONEncoder_Buffer_Append_past_the_initial_capacity_succeeds)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer;
+            (void)JSONEncoder_Buffer_Init(&buffer, 4);
+
+            ///act
+            auto result1 = JSONEncoder_Buffer_Append(&buffer, "{\"a\":", 5);
+            auto result2 = JSONEncoder_Buffer_Append(&buffer, "42}", 3);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result1);
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result2);
+            ASSERT_ARE_EQUAL(size_t, 8, buffer.length);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(buffer.buffer, "{\"a\":42}", 8));
+
+            ///cleanup
+            JSONEncoder_Buffer_Deinit(&buffer);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_011: [ If buffer is NULL, JSONEncoder_Buffer_Deinit shall do nothing. ]*/
+        /*Tests_SRS_JSON_ENCODER_09_012: [ JSONEncoder_Buffer_Deinit shall free the memory held by the buffer and set its length and capacity to 0. ]*/
+        TEST_FUNCTION(JSONEncoder_Buffer_Deinit_frees_the_memory)
+        {
+            ///arrange
+            JSON_ENCODER_BUFFER buffer;
+            (void)JSONEncoder_Buffer_Init(&buffer, 4);
+            (void)JSONEncoder_Buffer_Append(&buffer, "42", 2);
+
+            ///act
+            JSONEncoder_Buffer_Deinit(NULL);
+            JSONEncoder_Buffer_Deinit(&buffer);
+
+            ///assert
+            ASSERT_IS_NULL(buffer.buffer);
+            ASSERT_ARE_EQUAL(size_t, 0, buffer.length);
+            ASSERT_ARE_EQUAL(size_t, 0, buffer.capacity);
+        }
+
 END_TEST_SUITE(JSONEncoder_ut)
@@ -1678,16 +1678,14 @@ TEST_FUNCTION(MultiTree_AddChild_With_Correct_Arguments_Succeeds)
         .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*because MultiTree_Destroy*/
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(mocks, gballoc_malloc(0)) /*because create the child*/
+    STRICT_EXPECTED_CALL(mocks, gballoc_malloc(0)) /*because the name table of the tree*/
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*because destroy the child*/
+    STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*because the name table of the tree*/
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(mocks, gballoc_realloc(NULL, sizeof(MULTITREE_HANDLE))); /*because insertion of child node in the array of children in the parent*/
+    STRICT_EXPECTED_CALL(mocks, gballoc_realloc(NULL, 4 * sizeof(MULTITREE_HANDLE))); /*because insertion of child node in the array of children in the parent*/
     STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*because insertion of child node in the array of children in the parent*/
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(mocks, gballoc_malloc(6)); /*this is clone of "child" string*/
-    STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*this is clone of "child" string*/
-        .IgnoreArgument(1);
+    /*the child node and its name come from the arena of the tree*/
 
     MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
     MULTITREE_HANDLE childHandle;
@@ -1755,28 +1753,14 @@ TEST_FUNCTION(MultiTree_AddChild_With_2_Different_Child_Names_Succeeds)
         .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*because MultiTree_Destroy*/
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(mocks, gballoc_malloc(0)) /*because create the child 1 */
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*because destroy the child 1 */
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(mocks, gballoc_realloc(NULL, sizeof(MULTITREE_HANDLE))); /*because insertion of child 1 node in the array of children in the parent*/
-    STRICT_EXPECTED_CALL(mocks, gballoc_malloc(sizeof("childName1"))); /*this is clone of "childName1" string*/
-    STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*this is clone of "childName1" string*/
-        .IgnoreArgument(1);
-
-    STRICT_EXPECTED_CALL(mocks, gballoc_malloc(0)) /*because create the child 2 */
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*because destroy the child 2*/
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(mocks, gballoc_realloc(IGNORED_PTR_ARG, 2 * sizeof(MULTITREE_HANDLE))) /*because insertion of child 2 node in the array of children in the parent*/
+    STRICT_EXPECTED_CALL(mocks, gballoc_malloc(0)) /*because the name table of the tree*/
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(mocks, gballoc_malloc(sizeof("childName2"))); /*this is clone of "child" string*/
-    STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*this is clone of "child" string*/
+    STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*because the name table of the tree*/
         .IgnoreArgument(1);
-
-    STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*because realloc of children only has 1 free*/
+    STRICT_EXPECTED_CALL(mocks, gballoc_realloc(NULL, 4 * sizeof(MULTITREE_HANDLE))); /*because insertion of child 1 node in the array of children in the parent, child 2 fits in the same array*/
+    STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG)) /*because the array of children in the parent*/
         .IgnoreArgument(1);
-
+    /*both child nodes and their names come from the arena of the tree*/
 
     MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
     MULTITREE_HANDLE childHandle;
@@ -2442,6 +2426,306 @@ TEST_FUNCTION(MultiTree_DeleteChild_With_Only_Node_Succeeds)
     mocks.ResetAllCalls();
 }
 
+/* Tests_SRS_MULTITREE_09_003: [ Once a node has more than 8 children, looking up a child by name shall use a hash index of the children instead of comparing against every child. ] */
+TEST_FUNCTION(MultiTree_GetChildByName_With_Many_Children_Finds_Every_Child)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    MULTITREE_HANDLE childHandles[100];
+    char childName[32];
+    size_t i;
+
+    for (i = 0; i < 100; i++)
+    {
+        (void)sprintf(childName, "child%lu", (unsigned long)i);
+        ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_AddChild(treeHandle, childName, &childHandles[i]));
+    }
+
+    ///act
+    for (i = 0; i < 100; i++)
+    {
+        MULTITREE_HANDLE childHandle;
+        (void)sprintf(childName, "child%lu", (unsigned long)i);
+
+        MULTITREE_RESULT result = MultiTree_GetChildByName(treeHandle, childName, &childHandle);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result);
+        ASSERT_ARE_EQUAL(void_ptr, childHandles[i], childHandle);
+    }
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_ALREADY_HAS_A_VALUE, MultiTree_AddChild(treeHandle, "child42", &childHandles[0]));
+
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/* Tests_SRS_MULTITREE_09_003: [ Once a node has more than 8 children, looking up a child by name shall use a hash index of the children instead of comparing against every child. ] */
+/* Tests_SRS_MULTITREE_99_077:[ MultiTree_DeleteChild shall remove the direct children node (no recursive search) set by childName.] */
+TEST_FUNCTION(MultiTree_DeleteChild_With_Many_Children_Keeps_The_Other_Children)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    char childName[32];
+    char childValue[32];
+    size_t i;
+    size_t count;
+
+    for (i = 0; i < 20; i++)
+    {
+        (void)sprintf(childName, "child%lu", (unsigned long)i);
+        (void)sprintf(childValue, "value%lu", (unsigned long)i);
+        ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_AddLeaf(treeHandle, childName, childValue));
+    }
+
+    ///act
+    MULTITREE_RESULT result = MultiTree_DeleteChild(treeHandle, "child3");
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetChildCount(treeHandle, &count));
+    ASSERT_ARE_EQUAL(size_t, 19, count);
+    for (i = 0; i < 20; i++)
+    {
+        const void* value;
+        (void)sprintf(childName, "child%lu", (unsigned long)i);
+        (void)sprintf(childValue, "value%lu", (unsigned long)i);
+        if (i == 3)
+        {
+            ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_CHILD_NOT_FOUND, MultiTree_GetLeafValue(treeHandle, childName, &value));
+        }
+        else
+        {
+            ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetLeafValue(treeHandle, childName, &value));
+            ASSERT_ARE_EQUAL(char_ptr, childValue, (const char*)value);
+        }
+    }
+
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/* Tests_SRS_MULTITREE_99_071:[ When the child node is not found, MultiTree_GetLeafValue shall return MULTITREE_CHILD_NOT_FOUND.] */
+TEST_FUNCTION(MultiTree_GetLeafValue_With_A_Prefix_Of_A_Child_Name_Fails)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    const void* value;
+    (void)MultiTree_AddLeaf(treeHandle, "child1/child11", (void*)"value");
+
+    ///act
+    MULTITREE_RESULT result = MultiTree_GetLeafValue(treeHandle, "child/child11", &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_CHILD_NOT_FOUND, result);
+
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/* Tests_SRS_MULTITREE_09_001: [ Nodes and their names shall be allocated from an arena owned by the tree and released all at once by MultiTree_Destroy on the root of the tree. ] */
+/* Tests_SRS_MULTITREE_09_002: [ Equal names shall be stored once per tree. ] */
+TEST_FUNCTION(MultiTree_AddChild_With_The_Same_Name_Under_Different_Parents_Succeeds)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    MULTITREE_HANDLE childHandle;
+    MULTITREE_HANDLE childChildHandle;
+    MULTITREE_HANDLE foundHandle;
+
+    ///act
+    MULTITREE_RESULT result1 = MultiTree_AddChild(treeHandle, "name", &childHandle);
+    MULTITREE_RESULT result2 = MultiTree_AddChild(childHandle, "name", &childChildHandle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result1);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result2);
+    ASSERT_ARE_NOT_EQUAL(void_ptr, childHandle, childChildHandle);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetChildByName(childHandle, "name", &foundHandle));
+    ASSERT_ARE_EQUAL(void_ptr, childChildHandle, foundHandle);
+    STRING_empty(global_bufferTemp);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetName(childChildHandle, global_bufferTemp));
+    ASSERT_ARE_EQUAL(char_ptr, "name", STRING_c_str(global_bufferTemp));
+
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/* Tests_SRS_MULTITREE_09_005: [ If any argument is NULL, MultiTree_InitCursor shall return MULTITREE_INVALID_ARG. ] */
+TEST_FUNCTION(MultiTree_InitCursor_With_NULL_Arguments_Fails)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    MULTITREE_CURSOR cursor;
+
+    ///act
+    MULTITREE_RESULT result1 = MultiTree_InitCursor(NULL, &cursor);
+    MULTITREE_RESULT result2 = MultiTree_InitCursor(treeHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_INVALID_ARG, result2);
+
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/* Tests_SRS_MULTITREE_09_006: [ If cursor, destinationPath or value is NULL, or cursor has not been initialized by MultiTree_InitCursor, MultiTree_AddLeafAtCursor shall return MULTITREE_INVALID_ARG. ] */
+TEST_FUNCTION(MultiTree_AddLeafAtCursor_With_NULL_Arguments_Fails)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    MULTITREE_CURSOR cursor;
+    MULTITREE_CURSOR uninitializedCursor = { NULL, NULL, NULL, 0, 0, 0 };
+    (void)MultiTree_InitCursor(treeHandle, &cursor);
+
+    ///act
+    MULTITREE_RESULT result1 = MultiTree_AddLeafAtCursor(NULL, "child", (void*)"value");
+    MULTITREE_RESULT result2 = MultiTree_AddLeafAtCursor(&cursor, NULL, (void*)"value");
+    MULTITREE_RESULT result3 = MultiTree_AddLeafAtCursor(&cursor, "child", NULL);
+    MULTITREE_RESULT result4 = MultiTree_AddLeafAtCursor(&uninitializedCursor, "child", (void*)"value");
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_INVALID_ARG, result2);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_INVALID_ARG, result3);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_INVALID_ARG, result4);
+
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/* Tests_SRS_MULTITREE_09_004: [ MultiTree_InitCursor shall make cursor add leaves under treeHandle. ] */
+/* Tests_SRS_MULTITREE_09_007: [ MultiTree_AddLeafAtCursor shall add value at destinationPath relative to the node of the cursor, exactly like MultiTree_AddLeaf does. ] */
+/* Tests_SRS_MULTITREE_09_008: [ If the parent path of destinationPath is the same as in the previous call, MultiTree_AddLeafAtCursor shall add the leaf to the same parent node without walking the path again. ] */
+TEST_FUNCTION(MultiTree_AddLeafAtCursor_With_Siblings_Reuses_The_Parent)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    MULTITREE_CURSOR cursor;
+    MULTITREE_HANDLE parentHandle;
+    const void* value;
+    (void)MultiTree_InitCursor(treeHandle, &cursor);
+
+    ///act
+    MULTITREE_RESULT result1 = MultiTree_AddLeafAtCursor(&cursor, "/child1/child11/leaf1", (void*)"value1");
+    parentHandle = cursor.parentHandle;
+    MULTITREE_RESULT result2 = MultiTree_AddLeafAtCursor(&cursor, "child1/child11/leaf2", (void*)"value2");
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result1);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result2);
+    ASSERT_IS_NOT_NULL(parentHandle);
+    ASSERT_ARE_EQUAL(void_ptr, parentHandle, cursor.parentHandle);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetLeafValue(treeHandle, "child1/child11/leaf1", &value));
+    ASSERT_ARE_EQUAL(char_ptr, "value1", (const char*)value);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetLeafValue(treeHandle, "child1/child11/leaf2", &value));
+    ASSERT_ARE_EQUAL(char_ptr, "value2", (const char*)value);
+
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/* Tests_SRS_MULTITREE_09_009: [ Otherwise MultiTree_AddLeafAtCursor shall walk the parent path, creating the nodes that do not exist, and remember the parent node in cursor. ] */
+/* Tests_SRS_MULTITREE_09_010: [ MultiTree_AddLeafAtCursor shall return the same results as MultiTree_AddLeaf. ] */
+TEST_FUNCTION(MultiTree_AddLeafAtCursor_With_Different_Parents_Succeeds)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    MULTITREE_CURSOR cursor;
+    const void* value;
+    (void)MultiTree_InitCursor(treeHandle, &cursor);
+
+    ///act
+    MULTITREE_RESULT result1 = MultiTree_AddLeafAtCursor(&cursor, "child1/leaf", (void*)"value1");
+    MULTITREE_RESULT result2 = MultiTree_AddLeafAtCursor(&cursor, "child2/leaf", (void*)"value2");
+    MULTITREE_RESULT result3 = MultiTree_AddLeafAtCursor(&cursor, "leaf", (void*)"value3");
+    MULTITREE_RESULT result4 = MultiTree_AddLeafAtCursor(&cursor, "child2/leaf", (void*)"value4");
+    MULTITREE_RESULT result5 = MultiTree_AddLeafAtCursor(&cursor, "child2//leaf", (void*)"value5");
+    MULTITREE_RESULT result6 = MultiTree_AddLeafAtCursor(&cursor, "child2/", (void*)"value6");
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result1);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result2);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result3);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_ALREADY_HAS_A_VALUE, result4);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_EMPTY_CHILD_NAME, result5);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_EMPTY_CHILD_NAME, result6);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetLeafValue(treeHandle, "child1/leaf", &value));
+    ASSERT_ARE_EQUAL(char_ptr, "value1", (const char*)value);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetLeafValue(treeHandle, "child2/leaf", &value));
+    ASSERT_ARE_EQUAL(char_ptr, "value2", (const char*)value);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetLeafValue(treeHandle, "leaf", &value));
+    ASSERT_ARE_EQUAL(char_ptr, "value3", (const char*)value);
+
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/* Tests_SRS_MULTITREE_09_011: [ MultiTree_DeleteChild shall invalidate all cursors of the tree. ] */
+TEST_FUNCTION(MultiTree_AddLeafAtCursor_After_DeleteChild_Walks_The_Path_Again)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    MULTITREE_CURSOR cursor;
+    const void* value;
+    (void)MultiTree_InitCursor(treeHandle, &cursor);
+    (void)MultiTree_AddLeafAtCursor(&cursor, "child1/leaf1", (void*)"value1");
+    (void)MultiTree_DeleteChild(treeHandle, "child1");
+
+    ///act
+    MULTITREE_RESULT result = MultiTree_AddLeafAtCursor(&cursor, "child1/leaf2", (void*)"value2");
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_CHILD_NOT_FOUND, MultiTree_GetLeafValue(treeHandle, "child1/leaf1", &value));
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetLeafValue(treeHandle, "child1/leaf2", &value));
+    ASSERT_ARE_EQUAL(char_ptr, "value2", (const char*)value);
+
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
+
+/* Tests_SRS_MULTITREE_09_012: [ MultiTree_AddLeafAtCursor shall keep the parent path in a buffer of the cursor that is reused while the path fits in it, and only grown (doubling) when it does not. ] */
+TEST_FUNCTION(MultiTree_AddLeafAtCursor_Reuses_The_Parent_Path_Buffer)
+{
+    ///arrange
+    CMultiTreeMocks mocks;
+    MULTITREE_HANDLE treeHandle = MultiTree_Create(StringClone, StringFree);
+    MULTITREE_CURSOR cursor;
+    char* parentPath;
+    size_t parentPathCapacity;
+    const void* value;
+    (void)MultiTree_InitCursor(treeHandle, &cursor);
+    (void)MultiTree_AddLeafAtCursor(&cursor, "child1/child11/leaf", (void*)"value1");
+    parentPath = cursor.parentPath;
+    parentPathCapacity = cursor.parentPathCapacity;
+
+    ///act
+    MULTITREE_RESULT result1 = MultiTree_AddLeafAtCursor(&cursor, "child2/leaf", (void*)"value2");
+    MULTITREE_RESULT result2 = MultiTree_AddLeafAtCursor(&cursor, "child1/child12/leaf", (void*)"value3");
+
+    ///assert
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result1);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, result2);
+    ASSERT_ARE_EQUAL(void_ptr, parentPath, cursor.parentPath);
+    ASSERT_ARE_EQUAL(size_t, parentPathCapacity, cursor.parentPathCapacity);
+    ASSERT_ARE_EQUAL(char_ptr, "child1/child12", cursor.parentPath);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetLeafValue(treeHandle, "child2/leaf", &value));
+    ASSERT_ARE_EQUAL(char_ptr, "value2", (const char*)value);
+    ASSERT_ARE_EQUAL(MULTITREE_RESULT, MULTITREE_OK, MultiTree_GetLeafValue(treeHandle, "child1/child12/leaf", &value));
+    ASSERT_ARE_EQUAL(char_ptr, "value3", (const char*)value);
 
+    MultiTree_Destroy(treeHandle);
+    mocks.ResetAllCalls();
+}
 
 END_TEST_SUITE(MultiTree_ut)
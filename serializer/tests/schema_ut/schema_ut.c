@@ -6463,4 +6463,178 @@ BEGIN_TEST_SUITE(Schema_ut)
         ///clean
         Schema_Destroy(schemaHandle);
     }
+
+    /*Tests_SRS_SCHEMA_09_001: [ If schemaHandle is NULL, Schema_Freeze shall fail and return SCHEMA_INVALID_ARG. ]*/
+    TEST_FUNCTION(Schema_Freeze_with_NULL_schemaHandle_fails)
+    {
+        ///arrange
+
+        ///act
+        SCHEMA_RESULT result = Schema_Freeze(NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_SCHEMA_09_002: [ Schema_Freeze shall index by name the properties, reported properties, desired properties, actions, methods and model properties of every model of the schema. ]*/
+    /*Tests_SRS_SCHEMA_09_004: [ ... Otherwise it shall return SCHEMA_OK. ]*/
+    /*Tests_SRS_SCHEMA_09_005: [ Once Schema_Freeze has been called, Schema_GetModelPropertyByName, Schema_GetModelReportedPropertyByName, Schema_GetModelActionByName and Schema_GetModelMethodByName shall find the element by a hash of its name until an element of the same kind is added to the model. ]*/
+    TEST_FUNCTION(Schema_Freeze_lookups_return_the_same_handles_as_before)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE model = Schema_CreateModelType(schemaHandle, "model");
+        (void)Schema_AddModelProperty(model, "p1", "int");
+        (void)Schema_AddModelProperty(model, "p2", "int");
+        (void)Schema_AddModelReportedProperty(model, "r1", "int");
+        (void)Schema_AddModelReportedProperty(model, "r2", "int");
+        SCHEMA_ACTION_HANDLE action = Schema_CreateModelAction(model, "a1");
+        SCHEMA_METHOD_HANDLE method = Schema_CreateModelMethod(model, "m1");
+        SCHEMA_PROPERTY_HANDLE p2 = Schema_GetModelPropertyByName(model, "p2");
+        SCHEMA_REPORTED_PROPERTY_HANDLE r2 = Schema_GetModelReportedPropertyByName(model, "r2");
+
+        ///act
+        SCHEMA_RESULT result = Schema_Freeze(schemaHandle);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result);
+        ASSERT_ARE_EQUAL(void_ptr, p2, Schema_GetModelPropertyByName(model, "p2"));
+        ASSERT_ARE_EQUAL(void_ptr, r2, Schema_GetModelReportedPropertyByName(model, "r2"));
+        ASSERT_ARE_EQUAL(void_ptr, action, Schema_GetModelActionByName(model, "a1"));
+        ASSERT_ARE_EQUAL(void_ptr, method, Schema_GetModelMethodByName(model, "m1"));
+        ASSERT_IS_NULL(Schema_GetModelPropertyByName(model, "p3"));
+        ASSERT_IS_NULL(Schema_GetModelReportedPropertyByName(model, "p1"));
+        ASSERT_IS_NULL(Schema_GetModelActionByName(model, "m1"));
+        ASSERT_IS_NULL(Schema_GetModelMethodByName(model, "a1"));
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    /*Tests_SRS_SCHEMA_09_005: [ ... until an element of the same kind is added to the model. ]*/
+    TEST_FUNCTION(Schema_Freeze_property_added_after_freeze_is_found)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE model = Schema_CreateModelType(schemaHandle, "model");
+        (void)Schema_AddModelProperty(model, "p1", "int");
+        (void)Schema_AddModelReportedProperty(model, "r1", "int");
+        (void)Schema_Freeze(schemaHandle);
+
+        ///act
+        SCHEMA_RESULT result1 = Schema_AddModelProperty(model, "p2", "int");
+        SCHEMA_RESULT result2 = Schema_AddModelReportedProperty(model, "r2", "int");
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result1);
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result2);
+        ASSERT_IS_NOT_NULL(Schema_GetModelPropertyByName(model, "p1"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelPropertyByName(model, "p2"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelReportedPropertyByName(model, "r1"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelReportedPropertyByName(model, "r2"));
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    /*Tests_SRS_SCHEMA_09_002: [ Schema_Freeze shall index by name the properties, reported properties, desired properties, actions, methods and model properties of every model of the schema. ]*/
+    /*Tests_SRS_SCHEMA_09_007: [ Once Schema_Freeze has been called, Schema_GetModelDesiredPropertyByName, Schema_GetModelModelByName, Schema_GetModelModelByName_Offset, Schema_GetModelModelByName_OnDesiredProperty and Schema_GetModelElementByName shall find the element by a hash of its name until an element of the same kind is added to the model. ]*/
+    TEST_FUNCTION(Schema_Freeze_element_lookups_return_the_same_handles_as_before)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE model = Schema_CreateModelType(schemaHandle, "model");
+        SCHEMA_MODEL_TYPE_HANDLE minerModel = Schema_CreateModelType(schemaHandle, "someMinerModel");
+        (void)Schema_AddModelDesiredProperty(model, "d1", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 3, NULL);
+        (void)Schema_AddModelDesiredProperty(model, "d2", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 4, NULL);
+        (void)Schema_AddModelReportedProperty(model, "r1", "int");
+        (void)Schema_AddModelProperty(model, "p1", "int");
+        SCHEMA_ACTION_HANDLE action = Schema_CreateModelAction(model, "a1");
+        (void)Schema_AddModelModel(model, "ManicMiner", minerModel, 5, NULL);
+        SCHEMA_DESIRED_PROPERTY_HANDLE d2 = Schema_GetModelDesiredPropertyByName(model, "d2");
+        SCHEMA_REPORTED_PROPERTY_HANDLE r1 = Schema_GetModelReportedPropertyByName(model, "r1");
+        SCHEMA_PROPERTY_HANDLE p1 = Schema_GetModelPropertyByName(model, "p1");
+
+        ///act
+        SCHEMA_RESULT result = Schema_Freeze(schemaHandle);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result);
+        ASSERT_ARE_EQUAL(void_ptr, d2, Schema_GetModelDesiredPropertyByName(model, "d2"));
+        ASSERT_IS_NULL(Schema_GetModelDesiredPropertyByName(model, "r1"));
+        ASSERT_ARE_EQUAL(void_ptr, minerModel, Schema_GetModelModelByName(model, "ManicMiner"));
+        ASSERT_ARE_EQUAL(size_t, 5, Schema_GetModelModelByName_Offset(model, "ManicMiner"));
+        ASSERT_IS_NULL(Schema_GetModelModelByName(model, "p1"));
+
+        SCHEMA_MODEL_ELEMENT element = Schema_GetModelElementByName(model, "d2");
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_DESIRED_PROPERTY, element.elementType);
+        ASSERT_ARE_EQUAL(void_ptr, d2, element.elementHandle.desiredPropertyHandle);
+        element = Schema_GetModelElementByName(model, "p1");
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_PROPERTY, element.elementType);
+        ASSERT_ARE_EQUAL(void_ptr, p1, element.elementHandle.propertyHandle);
+        element = Schema_GetModelElementByName(model, "r1");
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_REPORTED_PROPERTY, element.elementType);
+        ASSERT_ARE_EQUAL(void_ptr, *(SCHEMA_REPORTED_PROPERTY_HANDLE*)r1, element.elementHandle.reportedPropertyHandle);
+        element = Schema_GetModelElementByName(model, "a1");
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_MODEL_ACTION, element.elementType);
+        ASSERT_ARE_EQUAL(void_ptr, action, element.elementHandle.actionHandle);
+        element = Schema_GetModelElementByName(model, "ManicMiner");
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_MODEL_IN_MODEL, element.elementType);
+        ASSERT_ARE_EQUAL(void_ptr, minerModel, element.elementHandle.modelHandle);
+        element = Schema_GetModelElementByName(model, "x");
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_NOT_FOUND, element.elementType);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    /*Tests_SRS_SCHEMA_09_007: [ ... until an element of the same kind is added to the model. ]*/
+    TEST_FUNCTION(Schema_Freeze_desired_property_and_model_added_after_freeze_are_found)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE model = Schema_CreateModelType(schemaHandle, "model");
+        SCHEMA_MODEL_TYPE_HANDLE minerModel = Schema_CreateModelType(schemaHandle, "someMinerModel");
+        (void)Schema_AddModelDesiredProperty(model, "d1", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 3, NULL);
+        (void)Schema_AddModelModel(model, "m1", minerModel, 5, NULL);
+        (void)Schema_Freeze(schemaHandle);
+
+        ///act
+        SCHEMA_RESULT result1 = Schema_AddModelDesiredProperty(model, "d2", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 4, NULL);
+        SCHEMA_RESULT result2 = Schema_AddModelModel(model, "m2", minerModel, 6, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result1);
+        ASSERT_ARE_EQUAL(SCHEMA_RESULT, SCHEMA_OK, result2);
+        ASSERT_IS_NOT_NULL(Schema_GetModelDesiredPropertyByName(model, "d1"));
+        ASSERT_IS_NOT_NULL(Schema_GetModelDesiredPropertyByName(model, "d2"));
+        ASSERT_ARE_EQUAL(size_t, 5, Schema_GetModelModelByName_Offset(model, "m1"));
+        ASSERT_ARE_EQUAL(size_t, 6, Schema_GetModelModelByName_Offset(model, "m2"));
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_DESIRED_PROPERTY, Schema_GetModelElementByName(model, "d2").elementType);
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_MODEL_IN_MODEL, Schema_GetModelElementByName(model, "m2").elementType);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    /*Tests_SRS_SCHEMA_09_003: [ Schema_Freeze shall index by namespace all the active schemas. ]*/
+    /*Tests_SRS_SCHEMA_09_006: [ Once Schema_Freeze has been called, Schema_GetSchemaByNamespace shall find the schema by a hash of schemaNamespace until a schema is created or destroyed. ]*/
+    TEST_FUNCTION(Schema_Freeze_GetSchemaByNamespace_finds_the_schema)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        (void)Schema_Freeze(schemaHandle);
+
+        ///act
+        SCHEMA_HANDLE found = Schema_GetSchemaByNamespace(SCHEMA_NAMESPACE);
+        SCHEMA_HANDLE notFound = Schema_GetSchemaByNamespace("NotTheNamespace");
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, schemaHandle, found);
+        ASSERT_IS_NULL(notFound);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+        ASSERT_IS_NULL(Schema_GetSchemaByNamespace(SCHEMA_NAMESPACE));
+    }
 END_TEST_SUITE(Schema_ut)
@@ -37,6 +37,10 @@ static MICROMOCK_MUTEX_HANDLE g_testByTest;
 #define TEST_BUFFER_STORAGE_HANDLE_1 ((BUFFER_STORAGE_HANDLE)0x4242)
 
 static const size_t actionCount = 42;
+
+static const DATA_MARSHALLER_ENCODER TEST_JSON_ENCODER = { "application/json", "utf-8", (DATA_MARSHALLER_ENCODE_FUNC)0x4244 };
+static const DATA_MARSHALLER_ENCODER TEST_CBOR_ENCODER = { "application/cbor", NULL, (DATA_MARSHALLER_ENCODE_FUNC)0x4245 };
+static const DATA_MARSHALLER_ENCODER* currentEncoder = &TEST_JSON_ENCODER;
 static const DEVICE_HANDLE TEST_DEVICE_HANDLE = (DEVICE_HANDLE)0x4747;
 
 DEFINE_MICROMOCK_ENUM_TO_STRING(SERIALIZER_RESULT, SERIALIZER_RESULT_VALUES);
@@ -365,11 +369,37 @@ public:
     /* DataMarshaller mocks */
     MOCK_STATIC_METHOD_1(, void, DataMarshaller_SetMaxBufferSize, size_t, bytes)
     MOCK_VOID_METHOD_END()
+    MOCK_STATIC_METHOD_0(, const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetJSONEncoder)
+    MOCK_METHOD_END(const DATA_MARSHALLER_ENCODER*, &TEST_JSON_ENCODER);
+    MOCK_STATIC_METHOD_0(, const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetEncoder)
+    MOCK_METHOD_END(const DATA_MARSHALLER_ENCODER*, currentEncoder);
+    MOCK_STATIC_METHOD_1(, void, DataMarshaller_SetEncoder, const DATA_MARSHALLER_ENCODER*, encoder)
+    MOCK_VOID_METHOD_END()
 
     /* DataPublisher mocks */
     MOCK_STATIC_METHOD_1(, void, DataPublisher_SetMaxBufferSize, size_t, bytes)
     MOCK_VOID_METHOD_END()
 
+    MOCK_STATIC_METHOD_1(, void, CodeFirst_SetDirectJsonEncoding, bool, enabled)
+    MOCK_VOID_METHOD_END()
+
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Int64_ToJSON, JSON_ENCODER_BUFFER*, destination, int64_t, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Boolean_ToJSON, JSON_ENCODER_BUFFER*, destination, int, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Double_ToJSON, JSON_ENCODER_BUFFER*, destination, double, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Float_ToJSON, JSON_ENCODER_BUFFER*, destination, float, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Charz_ToJSON, JSON_ENCODER_BUFFER*, destination, const char*, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_CharzNoQuotes_ToJSON, JSON_ENCODER_BUFFER*, destination, const char*, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_ToJSON, JSON_ENCODER_BUFFER*, destination, const AGENT_DATA_TYPE*, value)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_3(, JSON_ENCODER_RESULT, JSONEncoder_Buffer_Append, JSON_ENCODER_BUFFER*, buffer, const char*, source, size_t, sourceLength)
+    MOCK_METHOD_END(JSON_ENCODER_RESULT, JSON_ENCODER_OK);
+
     MOCK_STATIC_METHOD_2(, int, mallocAndStrcpy_s, char**, destination, const char*, source);
         int result2 = BASEIMPLEMENTATION::mallocAndStrcpy_s(destination, source);
     MOCK_METHOD_END(int, result2);
@@ -403,7 +433,19 @@ DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT
 DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_EDM_BINARY, AGENT_DATA_TYPE*, agentData, EDM_BINARY, v);
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, BufferProcess_SetRetryInterval, uint64_t, milliseconds);
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, DataMarshaller_SetMaxBufferSize, size_t, bytes);
+DECLARE_GLOBAL_MOCK_METHOD_0(CIoTHubSchemaClientMocks, , const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetJSONEncoder);
+DECLARE_GLOBAL_MOCK_METHOD_0(CIoTHubSchemaClientMocks, , const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetEncoder);
+DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, DataMarshaller_SetEncoder, const DATA_MARSHALLER_ENCODER*, encoder);
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, DataPublisher_SetMaxBufferSize, size_t, bytes);
+DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, CodeFirst_SetDirectJsonEncoding, bool, enabled);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_Int64_ToJSON, JSON_ENCODER_BUFFER*, destination, int64_t, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_Boolean_ToJSON, JSON_ENCODER_BUFFER*, destination, int, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_Double_ToJSON, JSON_ENCODER_BUFFER*, destination, double, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_Float_ToJSON, JSON_ENCODER_BUFFER*, destination, float, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_Charz_ToJSON, JSON_ENCODER_BUFFER*, destination, const char*, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_CharzNoQuotes_ToJSON, JSON_ENCODER_BUFFER*, destination, const char*, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_ToJSON, JSON_ENCODER_BUFFER*, destination, const AGENT_DATA_TYPE*, value);
+DECLARE_GLOBAL_MOCK_METHOD_3(CIoTHubSchemaClientMocks, , JSON_ENCODER_RESULT, JSONEncoder_Buffer_Append, JSON_ENCODER_BUFFER*, buffer, const char*, source, size_t, sourceLength);
 
 DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , int, mallocAndStrcpy_s, char**, destination, const char*, source);
 
@@ -640,4 +682,95 @@ BEGIN_TEST_SUITE(serializer_ut)
             ASSERT_ARE_EQUAL(SERIALIZER_RESULT, SERIALIZER_OK, result);
         }
 
+        /* Tests_SRS_SCHEMALIB_09_001: [ When the which argument is SerializeDirectJsonEncoding, serializer_setconfig shall invoke CodeFirst_SetDirectJsonEncoding with the dereferenced value argument (a bool), and shall return SERIALIZER_OK. ] */
+        TEST_FUNCTION(serializer_setconfig_passes_the_direct_json_encoding_switch_to_codefirst)
+        {
+            // arrange
+            CNiceCallComparer<CIoTHubSchemaClientMocks> mocks;
+            bool enabled = true;
+
+            STRICT_EXPECTED_CALL(mocks, CodeFirst_SetDirectJsonEncoding(true));
+
+            // act
+            SERIALIZER_RESULT result = serializer_setconfig(SerializeDirectJsonEncoding, &enabled);
+
+            // assert
+            ASSERT_ARE_EQUAL(SERIALIZER_RESULT, SERIALIZER_OK, result);
+        }
+
+        /* Tests_SRS_SCHEMALIB_09_003: [ If the value is true and the encoder returned by DataMarshaller_GetEncoder is not the JSON encoder, serializer_setconfig shall return SERIALIZER_INVALID_ARG. ] */
+        TEST_FUNCTION(serializer_setconfig_refuses_direct_json_encoding_when_the_encoder_is_not_json)
+        {
+            // arrange
+            CNiceCallComparer<CIoTHubSchemaClientMocks> mocks;
+            bool enabled = true;
+            currentEncoder = &TEST_CBOR_ENCODER;
+
+            STRICT_EXPECTED_CALL(mocks, CodeFirst_SetDirectJsonEncoding(true))
+                .NeverInvoked();
+
+            // act
+            SERIALIZER_RESULT result = serializer_setconfig(SerializeDirectJsonEncoding, &enabled);
+
+            // assert
+            ASSERT_ARE_EQUAL(SERIALIZER_RESULT, SERIALIZER_INVALID_ARG, result);
+
+            // cleanup
+            currentEncoder = &TEST_JSON_ENCODER;
+        }
+
+        /* Tests_SRS_SCHEMALIB_09_003: [ If the value is true and the encoder returned by DataMarshaller_GetEncoder is not the JSON encoder, serializer_setconfig shall return SERIALIZER_INVALID_ARG. ] */
+        TEST_FUNCTION(serializer_setconfig_allows_turning_direct_json_encoding_off_whatever_the_encoder)
+        {
+            // arrange
+            CNiceCallComparer<CIoTHubSchemaClientMocks> mocks;
+            bool enabled = false;
+            currentEncoder = &TEST_CBOR_ENCODER;
+
+            STRICT_EXPECTED_CALL(mocks, CodeFirst_SetDirectJsonEncoding(false));
+
+            // act
+            SERIALIZER_RESULT result = serializer_setconfig(SerializeDirectJsonEncoding, &enabled);
+
+            // assert
+            ASSERT_ARE_EQUAL(SERIALIZER_RESULT, SERIALIZER_OK, result);
+
+            // cleanup
+            currentEncoder = &TEST_JSON_ENCODER;
+        }
+
+        /* Tests_SRS_SCHEMALIB_09_002: [ When the which argument is SerializeEncoder, serializer_setconfig shall invoke DataMarshaller_SetEncoder with the value argument (a const DATA_MARSHALLER_ENCODER*), and shall return SERIALIZER_OK. ] */
+        /* Tests_SRS_SCHEMALIB_09_004: [ When the encoder is not the JSON encoder, serializer_setconfig shall also turn off the direct JSON path by calling CodeFirst_SetDirectJsonEncoding with false. ] */
+        TEST_FUNCTION(serializer_setconfig_with_a_non_json_encoder_sets_it_and_turns_off_direct_json_encoding)
+        {
+            // arrange
+            CNiceCallComparer<CIoTHubSchemaClientMocks> mocks;
+
+            STRICT_EXPECTED_CALL(mocks, CodeFirst_SetDirectJsonEncoding(false));
+            STRICT_EXPECTED_CALL(mocks, DataMarshaller_SetEncoder(&TEST_CBOR_ENCODER));
+
+            // act
+            SERIALIZER_RESULT result = serializer_setconfig(SerializeEncoder, (void*)&TEST_CBOR_ENCODER);
+
+            // assert
+            ASSERT_ARE_EQUAL(SERIALIZER_RESULT, SERIALIZER_OK, result);
+        }
+
+        /* Tests_SRS_SCHEMALIB_09_002: [ When the which argument is SerializeEncoder, serializer_setconfig shall invoke DataMarshaller_SetEncoder with the value argument (a const DATA_MARSHALLER_ENCODER*), and shall return SERIALIZER_OK. ] */
+        TEST_FUNCTION(serializer_setconfig_with_the_json_encoder_leaves_direct_json_encoding_alone)
+        {
+            // arrange
+            CNiceCallComparer<CIoTHubSchemaClientMocks> mocks;
+
+            STRICT_EXPECTED_CALL(mocks, CodeFirst_SetDirectJsonEncoding(false))
+                .NeverInvoked();
+            STRICT_EXPECTED_CALL(mocks, DataMarshaller_SetEncoder(&TEST_JSON_ENCODER));
+
+            // act
+            SERIALIZER_RESULT result = serializer_setconfig(SerializeEncoder, (void*)&TEST_JSON_ENCODER);
+
+            // assert
+            ASSERT_ARE_EQUAL(SERIALIZER_RESULT, SERIALIZER_OK, result);
+        }
+
 END_TEST_SUITE(serializer_ut)
@@ -315,6 +315,34 @@ public:
     MOCK_STATIC_METHOD_1(, void, DataPublisher_SetMaxBufferSize, size_t, bytes)
     MOCK_VOID_METHOD_END()
 
+    MOCK_STATIC_METHOD_1(, void, CodeFirst_SetDirectJsonEncoding, bool, enabled)
+    MOCK_VOID_METHOD_END()
+
+    /* DataMarshaller mocks */
+    MOCK_STATIC_METHOD_0(, const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetJSONEncoder)
+    MOCK_METHOD_END(const DATA_MARSHALLER_ENCODER*, (const DATA_MARSHALLER_ENCODER*)NULL);
+    MOCK_STATIC_METHOD_0(, const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetEncoder)
+    MOCK_METHOD_END(const DATA_MARSHALLER_ENCODER*, (const DATA_MARSHALLER_ENCODER*)NULL);
+    MOCK_STATIC_METHOD_1(, void, DataMarshaller_SetEncoder, const DATA_MARSHALLER_ENCODER*, encoder)
+    MOCK_VOID_METHOD_END()
+
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Int64_ToJSON, JSON_ENCODER_BUFFER*, destination, int64_t, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Boolean_ToJSON, JSON_ENCODER_BUFFER*, destination, int, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Double_ToJSON, JSON_ENCODER_BUFFER*, destination, double, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Float_ToJSON, JSON_ENCODER_BUFFER*, destination, float, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_Charz_ToJSON, JSON_ENCODER_BUFFER*, destination, const char*, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_CharzNoQuotes_ToJSON, JSON_ENCODER_BUFFER*, destination, const char*, v)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_2(, AGENT_DATA_TYPES_RESULT, AgentDataTypes_ToJSON, JSON_ENCODER_BUFFER*, destination, const AGENT_DATA_TYPE*, value)
+    MOCK_METHOD_END(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK);
+    MOCK_STATIC_METHOD_3(, JSON_ENCODER_RESULT, JSONEncoder_Buffer_Append, JSON_ENCODER_BUFFER*, buffer, const char*, source, size_t, sourceLength)
+    MOCK_METHOD_END(JSON_ENCODER_RESULT, JSON_ENCODER_OK);
+
     MOCK_STATIC_METHOD_2(, int, mallocAndStrcpy_s, char**, destination, const char*, source);
     int result2 = BASEIMPLEMENTATION::mallocAndStrcpy_s(destination, source);
     MOCK_METHOD_END(int, result2);
@@ -354,6 +382,18 @@ DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , DEVICE_RESULT, Device_E
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , DEVICE_RESULT, Device_CancelTransaction, TRANSACTION_HANDLE, transactionHandle);
 
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, DataPublisher_SetMaxBufferSize, size_t, bytes);
+DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, CodeFirst_SetDirectJsonEncoding, bool, enabled);
+DECLARE_GLOBAL_MOCK_METHOD_0(CIoTHubSchemaClientMocks, , const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetJSONEncoder);
+DECLARE_GLOBAL_MOCK_METHOD_0(CIoTHubSchemaClientMocks, , const DATA_MARSHALLER_ENCODER*, DataMarshaller_GetEncoder);
+DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, DataMarshaller_SetEncoder, const DATA_MARSHALLER_ENCODER*, encoder);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_Int64_ToJSON, JSON_ENCODER_BUFFER*, destination, int64_t, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_Boolean_ToJSON, JSON_ENCODER_BUFFER*, destination, int, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_Double_ToJSON, JSON_ENCODER_BUFFER*, destination, double, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_Float_ToJSON, JSON_ENCODER_BUFFER*, destination, float, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_Charz_ToJSON, JSON_ENCODER_BUFFER*, destination, const char*, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_CharzNoQuotes_ToJSON, JSON_ENCODER_BUFFER*, destination, const char*, v);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, AgentDataTypes_ToJSON, JSON_ENCODER_BUFFER*, destination, const AGENT_DATA_TYPE*, value);
+DECLARE_GLOBAL_MOCK_METHOD_3(CIoTHubSchemaClientMocks, , JSON_ENCODER_RESULT, JSONEncoder_Buffer_Append, JSON_ENCODER_BUFFER*, buffer, const char*, source, size_t, sourceLength);
 
 DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , int, mallocAndStrcpy_s, char**, destination, const char*, source);
 /* Requirements tested by the virtue of using the exposed API:
@@ -0,0 +1,336 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+// Measures the cost of SERIALIZE for a typical telemetry model, once through the transacted
+// MultiTree path, once with SerializeDirectJsonEncoding turned on, once with the CBOR encoder and
+// once appending every snapshot to a SERIALIZE_BATCH that is flushed when full.
+// Before timing, both JSON paths are checked to produce the same bytes, and the size of the
+// CBOR payload is printed next to the size of the JSON payload.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "serializer.h"
+
+#define ITERATION_COUNT         200000
+
+BEGIN_NAMESPACE(BenchmarkNamespace);
+
+DECLARE_MODEL(Telemetry,
+    WITH_DATA(ascii_char_ptr, deviceId),
+    WITH_DATA(int, sequence),
+    WITH_DATA(double, temperature),
+    WITH_DATA(double, humidity),
+    WITH_DATA(float, pressure),
+    WITH_DATA(bool, temperatureAlert)
+);
+
+END_NAMESPACE(BenchmarkNamespace);
+
+typedef struct BENCHMARK_SCENARIO_TAG
+{
+    const char* name;
+    bool direct_json_encoding;
+    bool cbor_encoding;
+    bool batch;
+} BENCHMARK_SCENARIO;
+
+static const BENCHMARK_SCENARIO scenarios[] =
+{
+    { "SERIALIZE 6 properties (transacted)", false, false, false },
+    { "SERIALIZE 6 properties (SerializeDirectJsonEncoding)", true, false, false },
+    { "SERIALIZE 6 properties (CBOR encoder)", false, true, false },
+    { "SERIALIZE_BATCH 6 properties (IoT Hub sized batches)", false, false, true }
+};
+
+static int serialize_once(Telemetry* telemetry, unsigned char** destination, size_t* destinationSize)
+{
+    int result;
+
+    if (SERIALIZE(destination, destinationSize, telemetry->deviceId, telemetry->sequence, telemetry->temperature,
+        telemetry->humidity, telemetry->pressure, telemetry->temperatureAlert) != CODEFIRST_OK)
+    {
+        LogError("Failed serializing the telemetry");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static int serialize_batched(Telemetry* telemetry, CODEFIRST_BATCH_HANDLE batch, size_t* messageCount)
+{
+    int result;
+    CODEFIRST_RESULT appendResult = SERIALIZE_BATCH(batch, telemetry->deviceId, telemetry->sequence, telemetry->temperature,
+        telemetry->humidity, telemetry->pressure, telemetry->temperatureAlert);
+
+    if (appendResult == CODEFIRST_BATCH_FULL)
+    {
+        unsigned char* destination;
+        size_t destinationSize;
+
+        if (FLUSH_SERIALIZE_BATCH(batch, &destination, &destinationSize) != CODEFIRST_OK)
+        {
+            LogError("Failed flushing the batch");
+            appendResult = CODEFIRST_ERROR;
+        }
+        else
+        {
+            free(destination);
+            (*messageCount)++;
+            appendResult = SERIALIZE_BATCH(batch, telemetry->deviceId, telemetry->sequence, telemetry->temperature,
+                telemetry->humidity, telemetry->pressure, telemetry->temperatureAlert);
+        }
+    }
+
+    if (appendResult != CODEFIRST_OK)
+    {
+        LogError("Failed batching the telemetry");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static int set_direct_json_encoding(bool enabled)
+{
+    int result;
+
+    if (serializer_setconfig(SerializeDirectJsonEncoding, &enabled) != SERIALIZER_OK)
+    {
+        LogError("Failed setting SerializeDirectJsonEncoding");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static int set_cbor_encoding(bool enabled)
+{
+    int result;
+    const DATA_MARSHALLER_ENCODER* encoder = enabled ? DataMarshaller_GetCBOREncoder() : DataMarshaller_GetJSONEncoder();
+
+    if (serializer_setconfig(SerializeEncoder, (void*)encoder) != SERIALIZER_OK)
+    {
+        LogError("Failed setting SerializeEncoder");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static int print_cbor_size(Telemetry* telemetry)
+{
+    int result;
+    unsigned char* cbor;
+    size_t cborSize;
+
+    if (set_cbor_encoding(true) != 0 ||
+        serialize_once(telemetry, &cbor, &cborSize) != 0)
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        (void)printf("CBOR payload (%s): %lu bytes\r\n", DataMarshaller_GetEncoder()->contentType, (unsigned long)cborSize);
+        free(cbor);
+        result = 0;
+    }
+
+    (void)set_cbor_encoding(false);
+
+    return result;
+}
+
+static int check_same_output(Telemetry* telemetry)
+{
+    int result;
+    unsigned char* transacted;
+    size_t transactedSize;
+    unsigned char* direct;
+    size_t directSize;
+
+    if (set_direct_json_encoding(false) != 0 ||
+        serialize_once(telemetry, &transacted, &transactedSize) != 0)
+    {
+        result = MU_FAILURE;
+    }
+    else
+    {
+        if (set_direct_json_encoding(true) != 0 ||
+            serialize_once(telemetry, &direct, &directSize) != 0)
+        {
+            result = MU_FAILURE;
+        }
+        else
+        {
+            if (transactedSize != directSize || memcmp(transacted, direct, directSize) != 0)
+            {
+                LogError("Direct JSON encoding produced %.*s, expected %.*s", (int)directSize, direct, (int)transactedSize, transacted);
+                result = MU_FAILURE;
+            }
+            else
+            {
+                (void)printf("payload (%lu bytes): %.*s\r\n", (unsigned long)directSize, (int)directSize, direct);
+                result = 0;
+            }
+
+            free(direct);
+        }
+
+        free(transacted);
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int result;
+    TICK_COUNTER_HANDLE tick_counter;
+
+    (void)argc;
+
+    if (serializer_init(NULL) != SERIALIZER_OK)
+    {
+        LogError("Failed on serializer_init");
+        result = MU_FAILURE;
+    }
+    else
+    {
+        Telemetry* telemetry;
+
+        if ((telemetry = CREATE_MODEL_INSTANCE(BenchmarkNamespace, Telemetry)) == NULL)
+        {
+            LogError("Failed on CREATE_MODEL_INSTANCE");
+            result = MU_FAILURE;
+        }
+        else
+        {
+            telemetry->deviceId = "benchmark-device-0042";
+            telemetry->sequence = 17;
+            telemetry->temperature = 21.5;
+            telemetry->humidity = 48.25;
+            telemetry->pressure = 1013.25f;
+            telemetry->temperatureAlert = false;
+
+            if (check_same_output(telemetry) != 0 ||
+                print_cbor_size(telemetry) != 0)
+            {
+                result = MU_FAILURE;
+            }
+            else if ((tick_counter = tickcounter_create()) == NULL)
+            {
+                LogError("Failed creating the tick counter");
+                result = MU_FAILURE;
+            }
+            else
+            {
+                size_t i;
+
+                result = 0;
+
+                (void)printf("%s: %d iterations\r\n", argv[0], ITERATION_COUNT);
+
+                for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]) && result == 0; i++)
+                {
+                    tickcounter_ms_t start_ms;
+                    tickcounter_ms_t end_ms;
+                    size_t iteration;
+                    size_t messageCount = 0;
+                    CODEFIRST_BATCH_HANDLE batch = NULL;
+
+                    /*the encoder goes first, the direct JSON path is refused while CBOR is selected*/
+                    if ((result = set_cbor_encoding(scenarios[i].cbor_encoding)) == 0)
+                    {
+                        result = set_direct_json_encoding(scenarios[i].direct_json_encoding);
+                    }
+
+                    if (result == 0 &&
+                        scenarios[i].batch &&
+                        (batch = CREATE_SERIALIZE_BATCH(CODEFIRST_BATCH_IOTHUB_MAX_SIZE)) == NULL)
+                    {
+                        LogError("Failed creating the batch");
+                        result = MU_FAILURE;
+                    }
+
+                    (void)tickcounter_get_current_ms(tick_counter, &start_ms);
+
+                    for (iteration = 0; iteration < ITERATION_COUNT && result == 0; iteration++)
+                    {
+                        unsigned char* destination;
+                        size_t destinationSize;
+
+                        telemetry->sequence = (int)iteration;
+
+                        if (batch != NULL)
+                        {
+                            result = serialize_batched(telemetry, batch, &messageCount);
+                        }
+                        else if ((result = serialize_once(telemetry, &destination, &destinationSize)) == 0)
+                        {
+                            free(destination);
+                            messageCount++;
+                        }
+                    }
+
+                    if (batch != NULL)
+                    {
+                        unsigned char* destination;
+                        size_t destinationSize;
+
+                        if (result == 0)
+                        {
+                            if (FLUSH_SERIALIZE_BATCH(batch, &destination, &destinationSize) != CODEFIRST_OK)
+                            {
+                                LogError("Failed flushing the batch");
+                                result = MU_FAILURE;
+                            }
+                            else if (destination != NULL)
+                            {
+                                free(destination);
+                                messageCount++;
+                            }
+                        }
+
+                        DESTROY_SERIALIZE_BATCH(batch);
+                    }
+
+                    (void)tickcounter_get_current_ms(tick_counter, &end_ms);
+
+                    if (result == 0)
+                    {
+                        (void)printf("%-70s %8lu ms %8.1f ns/iteration %8lu messages\r\n", scenarios[i].name,
+                            (unsigned long)(end_ms - start_ms), (double)(end_ms - start_ms) * 1000000.0 / ITERATION_COUNT, (unsigned long)messageCount);
+                    }
+                }
+
+                tickcounter_destroy(tick_counter);
+            }
+
+            DESTROY_MODEL_INSTANCE(telemetry);
+        }
+
+        serializer_deinit();
+    }
+
+    return result;
+}